@@ -0,0 +1,74 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the lowering time with the memo of arith::Analyzer::Simplify.
+
+It lowers a large PrimFunc with symbolic shapes, a chain of tiled elementwise and reduction
+stages whose index expressions come up again in many passes, with and without the memo.
+"""
+import argparse
+import time
+
+import tvm
+from tvm import te
+
+
+def make_schedule(num_stages):
+    n = te.var("n")
+    m = te.var("m")
+    A = te.placeholder((n, m), name="A")
+    stages = [A]
+    for i in range(num_stages):
+        prev = stages[-1]
+        if i % 4 == 3:
+            k = te.reduce_axis((0, 4), name="k")
+            stage = te.compute(
+                (n, m),
+                lambda x, y: te.sum(prev[x, te.min(y + k, m - 1)], axis=k),
+                name="S%d" % i,
+            )
+        else:
+            stage = te.compute((n, m), lambda x, y: prev[x, y] * 2.0 + 1.0, name="S%d" % i)
+        stages.append(stage)
+    s = te.create_schedule(stages[-1].op)
+    for stage in stages[1:]:
+        x, y = s[stage].op.axis
+        xo, xi = s[stage].split(x, factor=8)
+        yo, yi = s[stage].split(y, factor=16)
+        s[stage].reorder(xo, yo, xi, yi)
+    return s, [A, stages[-1]]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--stages", type=int, default=64)
+    parser.add_argument("--cache-size", type=int, default=1 << 16)
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+
+    sch, tensors = make_schedule(args.stages)
+    for cache_size in [0, args.cache_size]:
+        best = float("inf")
+        for _ in range(args.repeat):
+            with tvm.transform.PassContext(config={"arith.simplify_cache_size": cache_size}):
+                start = time.perf_counter()
+                tvm.lower(sch, tensors, name="main")
+                best = min(best, time.perf_counter() - start)
+        print(f"cache size {cache_size:>8}: lowering {best * 1e3:10.2f} ms")
+
+
+if __name__ == "__main__":
+    main()
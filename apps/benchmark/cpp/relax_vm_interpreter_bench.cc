@@ -0,0 +1,177 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relax_vm_interpreter_bench.cc
+ * \brief Microbenchmarks of the interpreter overhead of the Relax VM per instruction.
+ *
+ *  Every benchmark runs a function of kNumInstrs instructions of one kind, so the reported time
+ *  per instruction is dominated by the dispatch in VirtualMachine::RunLoop. Build the cppbench
+ *  target with USE_GOOGLE_BENCHMARK=ON and run, e.g.
+ *
+ *    build/cppbench --benchmark_filter=RelaxVM --benchmark_format=json
+ */
+#include <benchmark/benchmark.h>
+#include <tvm/relax/exec_builder.h>
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/memory_manager.h>
+
+#include <functional>
+#include <string>
+
+namespace tvm {
+namespace relax {
+namespace {
+
+using vm::Instruction;
+using vm::RegName;
+
+/*! \brief The number of timed instructions in every benchmarked function. */
+constexpr int kNumInstrs = 1024;
+
+TVM_REGISTER_GLOBAL("bench.relax_vm.empty")
+    .set_body([](runtime::TVMArgs args, runtime::TVMRetValue* rv) {});
+
+Instruction::Arg Reg(RegName reg) { return Instruction::Arg(Instruction::kRegister, reg); }
+
+/*!
+ * \brief Build an executable with the given builder callback and load it into a CPU VM.
+ * \return The "main" function of the VM.
+ */
+runtime::PackedFunc LoadVM(std::function<void(ExecBuilderNode*)> build) {
+  ExecBuilder builder = ExecBuilderNode::Create();
+  build(builder.operator->());
+  runtime::Module exec(builder->Get());
+  runtime::Module vm = exec.GetFunction("vm_load_executable")();
+  vm.GetFunction("vm_initialization")(static_cast<int>(kDLCPU), 0,
+                                      static_cast<int>(vm::AllocatorType::kPooled));
+  return vm.GetFunction("main");
+}
+
+/*! \brief Report the time and the number of the instructions run. */
+void SetInstructionCounters(benchmark::State& state) {
+  state.SetItemsProcessed(state.iterations() * kNumInstrs);
+  state.counters["time/instr"] =
+      benchmark::Counter(static_cast<double>(state.iterations()) * kNumInstrs,
+                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+void RelaxVMEmptyPackedCall(benchmark::State& state) {
+  runtime::PackedFunc main = LoadVM([](ExecBuilderNode* builder) {
+    builder->EmitFunction("main", 1, {"x"});
+    for (int i = 0; i < kNumInstrs; ++i) {
+      builder->EmitCall("bench.relax_vm.empty", {Reg(0)}, 1);
+    }
+    builder->EmitRet(0);
+  });
+  for (auto _ : state) {
+    main(0);
+  }
+  SetInstructionCounters(state);
+}
+BENCHMARK(RelaxVMEmptyPackedCall);
+
+void RelaxVMRegisterMove(benchmark::State& state) {
+  runtime::PackedFunc main = LoadVM([](ExecBuilderNode* builder) {
+    builder->EmitFunction("main", 1, {"x"});
+    for (int i = 0; i < kNumInstrs; ++i) {
+      builder->EmitMove(Reg(i % 2), i % 2 + 1);
+    }
+    builder->EmitRet(0);
+  });
+  runtime::NDArray x = runtime::NDArray::Empty({1}, DataType::Float(32), Device{kDLCPU, 0});
+  for (auto _ : state) {
+    main(x);
+  }
+  SetInstructionCounters(state);
+}
+BENCHMARK(RelaxVMRegisterMove);
+
+void RelaxVMIfGoto(benchmark::State& state) {
+  runtime::PackedFunc main = LoadVM([](ExecBuilderNode* builder) {
+    builder->EmitFunction("main", 1, {"cond"});
+    // Pairs of a taken If and a Goto to the next instruction.
+    for (int i = 0; i < kNumInstrs; i += 2) {
+      builder->EmitIf(0, 2);
+      builder->EmitGoto(1);
+    }
+    builder->EmitRet(0);
+  });
+  for (auto _ : state) {
+    main(1);
+  }
+  SetInstructionCounters(state);
+}
+BENCHMARK(RelaxVMIfGoto);
+
+void RelaxVMClosureCall(benchmark::State& state) {
+  runtime::PackedFunc main = LoadVM([](ExecBuilderNode* builder) {
+    builder->EmitFunction("callee", 2, {"env", "x"});
+    builder->EmitRet(1);
+    builder->EmitFunction("main", 1, {"x"});
+    runtime::TVMRetValue callee;
+    callee = runtime::String("callee");
+    vm::Index callee_idx = builder->EmitConstant(callee);
+    Instruction::Arg vm_reg = Reg(Instruction::kVMRegister);
+    builder->EmitCall("vm.builtin.alloc_closure",
+                      {vm_reg, Instruction::Arg(Instruction::kConstIdx, callee_idx), Reg(0)}, 1);
+    for (int i = 0; i < kNumInstrs; ++i) {
+      builder->EmitCall("vm.builtin.invoke_closure", {vm_reg, Reg(1), Reg(0)}, 2);
+    }
+    builder->EmitRet(2);
+  });
+  for (auto _ : state) {
+    main(0);
+  }
+  SetInstructionCounters(state);
+}
+BENCHMARK(RelaxVMClosureCall);
+
+void RelaxVMShapeHeap(benchmark::State& state) {
+  runtime::PackedFunc main = LoadVM([](ExecBuilderNode* builder) {
+    builder->EmitFunction("main", 1, {"x"});
+    runtime::TVMRetValue heap_size, indexes;
+    heap_size = runtime::ShapeTuple({4});
+    indexes = runtime::ShapeTuple({0, 1});
+    Instruction::Arg heap_size_arg(Instruction::kConstIdx, builder->EmitConstant(heap_size));
+    Instruction::Arg indexes_arg(Instruction::kConstIdx, builder->EmitConstant(indexes));
+    builder->EmitCall("vm.builtin.alloc_shape_heap", {Reg(Instruction::kVMRegister), heap_size_arg},
+                      1);
+    builder->EmitCall("vm.builtin.shape_of", {Reg(0)}, 2);
+    // Pairs of a store of the shape of x into the heap and a load of it back.
+    for (int i = 0; i < kNumInstrs; i += 2) {
+      builder->EmitCall("vm.builtin.store_shape", {Reg(2), Reg(1), indexes_arg}, 3);
+      builder->EmitCall("vm.builtin.load_shape", {Reg(1), indexes_arg}, 2);
+    }
+    builder->EmitRet(2);
+  });
+  runtime::NDArray x = runtime::NDArray::Empty({2, 3}, DataType::Float(32), Device{kDLCPU, 0});
+  for (auto _ : state) {
+    main(x);
+  }
+  SetInstructionCounters(state);
+}
+BENCHMARK(RelaxVMShapeHeap);
+
+}  // namespace
+}  // namespace relax
+}  // namespace tvm
@@ -0,0 +1,82 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the embedding bag kernel on CPU.
+
+It times the sum of the rows of a large embedding table gathered at random indices, as the
+sparse features of recommendation models are, with:
+
+- the default lowering of the reduction, on one thread;
+- the batches of bags run by the threads, with the embedding dimension vectorized;
+- the same schedule with the rows of the later indices of a bag prefetched.
+
+The prefetching pays off once the table is much larger than the last level cache.
+"""
+import argparse
+
+import numpy as np
+import tvm
+from tvm import te, tir, topi
+
+
+def build(num_embeddings, dim, num_bags, bag_size, rows=None, prefetch_distance=None):
+    weight = te.placeholder((num_embeddings, dim), name="weight")
+    indices = te.placeholder((num_bags, bag_size), dtype="int64", name="indices")
+    out = topi.nn.embedding_bag(weight, indices)
+    sch = tir.Schedule(te.create_prim_func([weight, indices, out]))
+    if rows is not None:
+        b, d, l = sch.get_loops(sch.get_block("embedding_bag"))
+        b_o, b_i = sch.split(b, [None, rows])
+        d_o, d_i = sch.split(d, [None, 16])
+        sch.reorder(b_o, b_i, l, d_o, d_i)
+        sch.parallel(b_o)
+        sch.vectorize(d_i)
+        if prefetch_distance is not None:
+            sch.annotate(l, "software_prefetch_distance", prefetch_distance)
+    return tvm.build(sch.mod, target="llvm -mcpu=native")
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--num-embeddings", type=int, default=4_000_000)
+    parser.add_argument("--dim", type=int, default=64)
+    parser.add_argument("--num-bags", type=int, default=2048)
+    parser.add_argument("--bag-size", type=int, default=80)
+    parser.add_argument("--rows", type=int, default=16, help="the bags of a batch of a thread")
+    parser.add_argument("--prefetch-distance", type=int, nargs="+", default=[2, 4, 8])
+    args = parser.parse_args()
+
+    dev = tvm.cpu()
+    weight = tvm.nd.array(np.random.rand(args.num_embeddings, args.dim).astype("float32"), dev)
+    indices = np.random.randint(0, args.num_embeddings, size=(args.num_bags, args.bag_size))
+    indices = tvm.nd.array(indices.astype("int64"), dev)
+    out = tvm.nd.empty((args.num_bags, args.dim), "float32", dev)
+    shape = (args.num_embeddings, args.dim, args.num_bags, args.bag_size)
+    variants = [("default", {}), ("batched", {"rows": args.rows})]
+    for distance in args.prefetch_distance:
+        kwargs = {"rows": args.rows, "prefetch_distance": distance}
+        variants.append((f"prefetch {distance}", kwargs))
+    for name, kwargs in variants:
+        func = build(*shape, **kwargs)
+        seconds = func.time_evaluator(func.entry_name, dev, number=10, repeat=3)(
+            weight, indices, out
+        ).mean
+        rows_per_sec = args.num_bags * args.bag_size / seconds
+        print(f"{name:<12}: {seconds * 1e3:8.3f} ms, {rows_per_sec / 1e6:8.2f} M rows/s")
+
+
+if __name__ == "__main__":
+    main()
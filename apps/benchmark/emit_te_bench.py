@@ -0,0 +1,69 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of building Relax models with emit_te.
+
+It builds a stack of layers of matmul, bias add and relu with emit_te, with the layers of each
+width repeated so that most of the emitted computes are identical, and times building the model
+with the TE computes lowered as they are emitted and deferred to be lowered in parallel.
+"""
+import argparse
+import time
+
+import tvm
+from tvm import relax, topi
+
+
+def build_model(num_layers, widths, defer_te_lowering):
+    bb = relax.BlockBuilder(defer_te_lowering=defer_te_lowering)
+    x = relax.Var("x", (1, widths[0]), relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x]):
+        with bb.dataflow():
+            out = x
+            for i in range(num_layers):
+                width = widths[i % len(widths)]
+                in_width = int(out.shape[1])
+                w = relax.const(tvm.nd.empty((in_width, width), "float32"))
+                b = relax.const(tvm.nd.empty((1, width), "float32"))
+                out = bb.emit_te(topi.nn.matmul, out, w)
+                out = bb.emit_te(topi.add, out, b)
+                out = bb.emit_te(topi.nn.relu, out)
+            out = bb.emit_output(out)
+        bb.emit_func_output(out)
+    return bb.get()
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--layers", type=int, nargs="+", default=[100, 1000])
+    parser.add_argument("--widths", type=int, nargs="+", default=[64, 128, 256])
+    args = parser.parse_args()
+
+    for num_layers in args.layers:
+        for defer in [False, True]:
+            start = time.perf_counter()
+            mod = build_model(num_layers, args.widths, defer)
+            seconds = time.perf_counter() - start
+            num_prim_funcs = len(mod.functions) - 1
+            print(
+                f"{num_layers:>6} layers, {'deferred' if defer else 'eager':<8}: "
+                f"{seconds:8.3f} s, {seconds * 1e6 / (3 * num_layers):8.2f} us per emit_te, "
+                f"{num_prim_funcs} PrimFuncs"
+            )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,117 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the pass pipeline time on IRModules of many functions.
+
+It builds modules with a Relax main function calling N PrimFuncs, like the ones left by FuseTIR,
+and times the module updates done by the passes as N grows:
+
+- a pipeline of passes which change no function, so only the overhead of the pass manager and
+  of the module updates is measured;
+- a pipeline of Relax passes over the whole module;
+- updating every function one by one with update_func against one batch with update_funcs.
+
+The time per function stays flat as N grows when the updates do not copy the module.
+"""
+import argparse
+import time
+
+import tvm
+from tvm import relax, te, topi
+
+
+def build_module(num_funcs):
+    A = te.placeholder((16, 16), name="A")
+    B = topi.add(A, A)
+    prim_func = te.create_prim_func([A, B])
+
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [16, 16], relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x]):
+        out = x
+        for i in range(num_funcs):
+            name = "add%d" % i
+            gv = bb.add_func(prim_func.with_attr("global_symbol", name), name)
+            out = bb.emit(relax.call_tir(gv, (out,), (16, 16), dtype="float32"))
+        bb.emit_func_output(out)
+    return bb.get()
+
+
+@relax.transform.function_pass(opt_level=0)
+def relax_identity(func, mod, ctx):
+    return func
+
+
+@tvm.tir.transform.prim_func_pass(opt_level=0)
+def tir_identity(func, mod, ctx):
+    return func
+
+
+def best_time(func, repeat):
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        func()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--num-funcs", type=int, nargs="+", default=[100, 1000, 5000])
+    parser.add_argument("--num-passes", type=int, default=20)
+    parser.add_argument("--repeat", type=int, default=3)
+    args = parser.parse_args()
+
+    identity = tvm.transform.Sequential([relax_identity, tir_identity] * args.num_passes)
+    pipeline = tvm.transform.Sequential(
+        [
+            relax.transform.Normalize(),
+            relax.transform.AnnotateTIROpPattern(),
+            relax.transform.DeadCodeElimination(),
+            relax.transform.RemoveUnusedFunctions(),
+        ]
+    )
+    for num_funcs in args.num_funcs:
+        mod = build_module(num_funcs)
+        updates = {gv: func for gv, func in mod.functions.items()}
+
+        def update_one_by_one():
+            updated = tvm.IRModule(mod.functions)
+            for gv, func in updates.items():
+                updated.update_func(gv, func.with_attr("updated", True))
+
+        def update_batch():
+            updated = tvm.IRModule(mod.functions)
+            updated.update_funcs(
+                {gv: func.with_attr("updated", True) for gv, func in updates.items()}
+            )
+
+        results = {
+            "identity passes": best_time(lambda: identity(mod), args.repeat),
+            "relax pipeline": best_time(lambda: pipeline(mod), args.repeat),
+            "update_func": best_time(update_one_by_one, args.repeat),
+            "update_funcs": best_time(update_batch, args.repeat),
+        }
+        for name, seconds in results.items():
+            print(
+                f"{num_funcs:>6} functions, {name:<16}: {seconds * 1e3:10.2f} ms, "
+                f"{seconds * 1e6 / num_funcs:8.2f} us per function"
+            )
+
+
+if __name__ == "__main__":
+    main()
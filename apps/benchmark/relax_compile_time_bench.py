@@ -0,0 +1,172 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the compile time of the Relax build pipeline.
+
+It compiles the models of apps/relax_examples (ResNet and MLP) and synthetic deep graphs with
+the fusion passes and relax.vm.build, and reports the wall time and the peak resident memory
+of every stage as JSON, so compile-time regressions show up between releases:
+
+    python apps/benchmark/relax_compile_time_bench.py --models mlp resnet18 deep1000 -o out.json
+
+Each model is compiled in its own process, so the peak memory of a model is not hidden by the
+models compiled before it. The peak memory after a stage is the peak of the process so far.
+"""
+import argparse
+import json
+import multiprocessing
+import os
+import resource
+import sys
+import time
+
+import tvm
+from tvm import relax, tir
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "relax_examples"))
+
+# pylint: disable=wrong-import-position
+from fuse_ops_compile_time import build_deep_model
+from mlp import build_mlp
+
+
+def peak_rss_mb():
+    """The peak resident memory of the process in MB, ru_maxrss is in KB on Linux."""
+    return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss / 1024.0
+
+
+@tvm.instrument.pass_instrument
+class PassTimer:
+    """Time the passes run by relax.vm.build, the passes of a Sequential are timed one by one."""
+
+    def __init__(self):
+        self.stack = []
+        self.times = {}
+
+    def run_before_pass(self, mod, info):
+        self.stack.append((info.name, time.perf_counter()))
+
+    def run_after_pass(self, mod, info):
+        name, start = self.stack.pop()
+        # Passes nested in other passes than a Sequential are included in their parent.
+        parents = [parent for parent, _ in self.stack if parent != "sequential"]
+        if name != "sequential" and not parents:
+            self.times[name] = self.times.get(name, 0.0) + time.perf_counter() - start
+
+
+def load_model(name):
+    """Return the Relax module of a model and whether it is translated from Relay."""
+    if name == "mlp":
+        n, m = tir.Var("n", "int64"), tir.Var("m", "int64")
+        data = relax.Var("data", [n, m], relax.DynTensorType(2, "float32"))
+        weight = relax.Var("weight", [m, n], relax.DynTensorType(2, "float32"))
+        return relax.transform.AnnotateTIROpPattern()(build_mlp(data, weight))
+    if name.startswith("resnet"):
+        from tvm.relax.testing import relay_translator  # pylint: disable=import-outside-toplevel
+        from tvm.relay import testing  # pylint: disable=import-outside-toplevel
+
+        num_layers = int(name[len("resnet") :])
+        relay_mod, _ = testing.resnet.get_workload(num_layers=num_layers, batch_size=1)
+        return relay_translator.from_relay(relay_mod["main"], "llvm")
+    if name.startswith("deep"):
+        return build_deep_model(int(name[len("deep") :]))
+    raise ValueError("Unknown model %s, expected mlp, resnet<layers> or deep<layers>" % name)
+
+
+def compile_model(name, target, queue):
+    """Compile a model and put its report into the queue."""
+    target = tvm.target.Target(target, host="llvm")
+    stages = []
+
+    def record(stage, start):
+        stages.append(
+            {
+                "stage": stage,
+                "seconds": time.perf_counter() - start,
+                "peak_rss_mb": peak_rss_mb(),
+            }
+        )
+
+    start = time.perf_counter()
+    mod = load_model(name)
+    record("load", start)
+    for stage, fpass in [
+        ("FuseOps", relax.transform.FuseOps()),
+        ("FuseTIR", relax.transform.FuseTIR()),
+        ("FoldConstant", relax.transform.FoldConstant()),
+    ]:
+        start = time.perf_counter()
+        mod = fpass(mod)
+        record(stage, start)
+
+    timer = PassTimer()
+    start = time.perf_counter()
+    with tvm.transform.PassContext(opt_level=3, instruments=[timer]):
+        relax.vm.build(mod, target)
+    total = time.perf_counter() - start
+    peak = peak_rss_mb()
+    for stage, seconds in timer.times.items():
+        stages.append({"stage": "vm.build/" + stage, "seconds": seconds, "peak_rss_mb": peak})
+    # The rest of vm.build is the code generation of the kernels and of the VM bytecode.
+    codegen = total - sum(timer.times.values())
+    stages.append({"stage": "vm.build/codegen", "seconds": codegen, "peak_rss_mb": peak})
+    queue.put(
+        {
+            "model": name,
+            "target": str(target),
+            "total_seconds": sum(stage["seconds"] for stage in stages),
+            "peak_rss_mb": peak,
+            "stages": stages,
+        }
+    )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark the compile time of Relax models.")
+    parser.add_argument(
+        "--models",
+        nargs="+",
+        default=["mlp", "resnet18", "resnet50", "deep1000", "deep5000"],
+        help="mlp, resnet<layers> or deep<layers>, a synthetic graph of residual layers",
+    )
+    parser.add_argument("--target", default="llvm")
+    parser.add_argument("-o", "--output", help="The JSON file of the reports, default to stdout")
+    args = parser.parse_args()
+
+    context = multiprocessing.get_context("spawn")
+    reports = []
+    for name in args.models:
+        queue = context.Queue()
+        process = context.Process(target=compile_model, args=(name, args.target, queue))
+        process.start()
+        report = queue.get()
+        process.join()
+        print(
+            "%-12s %8.3f s, peak %8.1f MB" % (name, report["total_seconds"], report["peak_rss_mb"]),
+            file=sys.stderr,
+        )
+        reports.append(report)
+
+    result = json.dumps({"tvm_version": tvm.__version__, "reports": reports}, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(result)
+    else:
+        print(result)
+
+
+if __name__ == "__main__":
+    main()
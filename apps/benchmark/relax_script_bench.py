@@ -0,0 +1,78 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of printing and parsing the TVMScript of large Relax modules.
+
+It prints the synthetic deep models of apps/relax_examples, before and after FuseOps and
+FuseTIR so that the module also has a function per fused group, and times:
+
+- printing the script to a string with astext, with and without the meta data;
+- writing the script to a file with save_script, which prints one function at a time;
+- parsing the script back with from_source.
+
+The time per binding should stay flat as the number of layers grows.
+"""
+import argparse
+import os
+import sys
+import time
+
+import tvm
+from tvm import relax
+from tvm.contrib import utils
+from tvm.script import relax as R
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "relax_examples"))
+
+# pylint: disable=wrong-import-position
+from fuse_ops_compile_time import build_deep_model
+
+
+def timed(func):
+    start = time.perf_counter()
+    result = func()
+    return result, time.perf_counter() - start
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--layers", type=int, nargs="+", default=[100, 1000, 5000])
+    parser.add_argument("--no-parse", action="store_true", help="only measure the printer")
+    args = parser.parse_args()
+
+    path = utils.tempdir().relpath("mod.py")
+    for num_layers in args.layers:
+        num_bindings = 4 * num_layers
+        deep = build_deep_model(num_layers)
+        fused = relax.transform.FuseTIR()(relax.transform.FuseOps()(deep))
+        for name, mod in [("deep", deep), ("fused", fused)]:
+            text, print_time = timed(lambda: R.parser.astext(mod))
+            _, meta_time = timed(lambda: R.parser.astext(mod, show_meta_data=True))
+            _, save_time = timed(lambda: R.parser.save_script(mod, path))
+            line = (
+                f"{num_layers:>6} layers {name:<5} {len(text) / 1e6:8.2f} MB: "
+                f"astext {print_time:8.3f} s, with meta data {meta_time:8.3f} s, "
+                f"save_script {save_time:8.3f} s"
+            )
+            if not args.no_parse:
+                _, parse_time = timed(lambda: R.parser.from_source(text))
+                line += f", from_source {parse_time:8.3f} s"
+                line += f", {parse_time / num_bindings * 1e6:8.2f} us per binding to parse"
+            print(line)
+
+
+if __name__ == "__main__":
+    main()
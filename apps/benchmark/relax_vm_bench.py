@@ -0,0 +1,242 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark of the end-to-end latency and throughput of the Relax VM.
+
+It runs an MLP with static shapes, compiled once per batch size, and with a symbolic batch
+size, compiled once for all, and a model with control flow and closures, and reports as JSON:
+
+- the latency percentiles of a single VM,
+- the throughput of N threads, each running its own VM of the same executable,
+- the VM overhead, i.e. the time spent outside of the kernels, measured by the profiling VM.
+
+    python apps/benchmark/relax_vm_bench.py --target llvm --batches 1 8 64 --threads 1 4
+    python apps/benchmark/relax_vm_bench.py --target cuda -o cuda.json
+"""
+import argparse
+import json
+import sys
+import threading
+import time
+
+import numpy as np
+import tvm
+from tvm import relax, tir, topi
+from tvm.script import relax as R, tir as T
+
+HIDDEN = 256
+
+
+def build_mlp(batch, num_layers):
+    """An MLP of num_layers dense, bias add and relu layers, batch is an int or a tir.Var."""
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", (batch, HIDDEN), relax.DynTensorType(2, "float32"))
+    w = relax.Var("w", (HIDDEN, HIDDEN), relax.DynTensorType(2, "float32"))
+    b = relax.Var("b", (HIDDEN,), relax.DynTensorType(1, "float32"))
+    with bb.function("main", [x, w, b]):
+        with bb.dataflow():
+            lv = x
+            for _ in range(num_layers):
+                lv = bb.emit_te(topi.nn.dense, lv, w)
+                lv = bb.emit_te(topi.add, lv, b)
+                lv = bb.emit_te(topi.nn.relu, lv)
+            gv = bb.emit_output(lv)
+        bb.emit_func_output(gv)
+    mod = relax.transform.AnnotateTIROpPattern()(bb.get())
+    return relax.transform.FuseTIR()(relax.transform.FuseOps()(mod))
+
+
+@tvm.script.ir_module
+class ControlFlowModule:
+    @T.prim_func
+    def scale(a: T.handle, b: T.handle):
+        T.func_attr({"global_symbol": "scale", "tir.noalias": True})
+        A = T.match_buffer(a, (1, 256), "float32")
+        B = T.match_buffer(b, (1, 256), "float32")
+        for i, j in T.grid(1, 256):
+            with T.block("scale"):
+                vi, vj = T.axis.remap("SS", [i, j])
+                B[vi, vj] = A[vi, vj] * T.float32(0.5)
+
+    @T.prim_func
+    def add(a: T.handle, b: T.handle, c: T.handle):
+        T.func_attr({"global_symbol": "add", "tir.noalias": True})
+        A = T.match_buffer(a, (1, 256), "float32")
+        B = T.match_buffer(b, (1, 256), "float32")
+        C = T.match_buffer(c, (1, 256), "float32")
+        for i, j in T.grid(1, 256):
+            with T.block("add"):
+                vi, vj = T.axis.remap("SS", [i, j])
+                C[vi, vj] = A[vi, vj] + B[vi, vj]
+
+    @R.function
+    def lifted_add(x: Tensor((1, 256), "float32"), env: Tensor((1, 256), "float32")):
+        y = R.call_tir(add, (x, env), (1, 256), dtype="float32")
+        return y
+
+    @R.function
+    def main(
+        cond: Tensor((), "bool"), x: Tensor((1, 256), "float32"), y: Tensor((1, 256), "float32")
+    ):
+        if cond:
+            z = R.call_tir(scale, (x,), (1, 256), dtype="float32")
+        else:
+            z = R.call_tir(add, (x, y), (1, 256), dtype="float32")
+        clo = relax.make_closure(lifted_add, (y,))
+        res = relax.invoke_closure(clo, (z,), type_args=(Tensor))
+        return res
+
+
+def schedule_for_gpu(mod):
+    """Bind the spatial loops of every block to GPU threads, the reductions stay serial."""
+    for gv, func in mod.functions.items():
+        if not isinstance(func, tir.PrimFunc):
+            continue
+        sch = tir.Schedule(func)
+        for block in sch.get_child_blocks(sch.get_block("root")):
+            num_spatial = sum(
+                iter_var.iter_type == tir.IterVar.DataPar for iter_var in sch.get(block).iter_vars
+            )
+            loop = sch.fuse(*sch.get_loops(block)[:num_spatial])
+            bx, tx = sch.split(loop, [None, 128])
+            sch.bind(bx, "blockIdx.x")
+            sch.bind(tx, "threadIdx.x")
+        mod[gv] = sch.mod["main"].with_attr("global_symbol", gv.name_hint)
+    return mod
+
+
+def measure_latency(vm, dev, args, number):
+    """Return the latency of each run in milliseconds."""
+    vm["main"](*args)
+    latencies = []
+    for _ in range(number):
+        start = time.perf_counter()
+        vm["main"](*args)
+        dev.sync()
+        latencies.append((time.perf_counter() - start) * 1e3)
+    return latencies
+
+
+def measure_throughput(ex, dev, args, num_threads, seconds):
+    """Return the runs per second of num_threads threads, each running its own VM."""
+    vms = [relax.VirtualMachine(ex, dev) for _ in range(num_threads)]
+    counts = [0] * num_threads
+    barrier = threading.Barrier(num_threads + 1)
+    deadline = []
+
+    def worker(index):
+        vm = vms[index]
+        vm["main"](*args)
+        barrier.wait()
+        while time.perf_counter() < deadline[0]:
+            vm["main"](*args)
+            counts[index] += 1
+        dev.sync()
+
+    threads = [threading.Thread(target=worker, args=(i,)) for i in range(num_threads)]
+    for thread in threads:
+        thread.start()
+    deadline.append(time.perf_counter() + seconds)
+    start = time.perf_counter()
+    barrier.wait()
+    for thread in threads:
+        thread.join()
+    return sum(counts) / (time.perf_counter() - start)
+
+
+def measure_vm_overhead(ex, dev, args):
+    """Return the run time and the time outside of the kernels in microseconds."""
+    vm = relax.VirtualMachine(ex, dev, profile=True)
+    report = json.loads(vm.profile("main", *args).json())
+    total = sum(
+        metrics["Duration (us)"]["microseconds"] for metrics in report["device_metrics"].values()
+    )
+    kernels = sum(
+        call["Duration (us)"]["microseconds"]
+        for call in report["calls"]
+        if not call["Name"]["string"].startswith("vm.builtin.")
+    )
+    return total, total - kernels
+
+
+def benchmark(name, ex, dev, args, batch, cli_args):
+    latencies = measure_latency(relax.VirtualMachine(ex, dev), dev, args, cli_args.number)
+    p50, p90, p99 = np.percentile(latencies, [50, 90, 99])
+    total_us, overhead_us = measure_vm_overhead(ex, dev, args)
+    result = {
+        "model": name,
+        "batch": batch,
+        "latency_ms": {"mean": float(np.mean(latencies)), "p50": p50, "p90": p90, "p99": p99},
+        "throughput_samples_per_s": {
+            str(num_threads): batch
+            * measure_throughput(ex, dev, args, num_threads, cli_args.seconds)
+            for num_threads in cli_args.threads
+        },
+        "profiled_us": total_us,
+        "vm_overhead_us": overhead_us,
+    }
+    print(
+        "%-16s batch %3d: p50 %8.3f ms, p99 %8.3f ms, VM overhead %6.1f%%"
+        % (name, batch, p50, p99, overhead_us / total_us * 100),
+        file=sys.stderr,
+    )
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark the Relax VM end to end.")
+    parser.add_argument("--target", default="llvm", help="llvm or a GPU target, e.g. cuda")
+    parser.add_argument("--batches", type=int, nargs="+", default=[1, 2, 4, 8, 16, 32, 64])
+    parser.add_argument("--layers", type=int, default=8)
+    parser.add_argument("--threads", type=int, nargs="+", default=[1, 2, 4])
+    parser.add_argument("--number", type=int, default=200, help="The runs timed for latency")
+    parser.add_argument("--seconds", type=float, default=2.0, help="The duration of throughput")
+    parser.add_argument("-o", "--output", help="The JSON file of the results, default to stdout")
+    args = parser.parse_args()
+
+    target = tvm.target.Target(args.target, host="llvm")
+    dev = tvm.device(target.kind.name, 0)
+    is_gpu = target.kind.name != "llvm"
+
+    def build(mod):
+        return relax.vm.build(schedule_for_gpu(mod) if is_gpu else mod, target)
+
+    def mlp_args(batch):
+        shapes = [(batch, HIDDEN), (HIDDEN, HIDDEN), (HIDDEN,)]
+        return [tvm.nd.array(np.random.rand(*s).astype("float32") * 0.1, dev) for s in shapes]
+
+    results = []
+    for batch in args.batches:
+        ex = build(build_mlp(batch, args.layers))
+        results.append(benchmark("mlp_static", ex, dev, mlp_args(batch), batch, args))
+    ex = build(build_mlp(tir.Var("n", "int64"), args.layers))
+    for batch in args.batches:
+        results.append(benchmark("mlp_dynamic", ex, dev, mlp_args(batch), batch, args))
+    ex = build(ControlFlowModule)
+    x, y = [tvm.nd.array(np.random.rand(1, HIDDEN).astype("float32"), dev) for _ in range(2)]
+    for cond in [True, False]:
+        results.append(benchmark("control_flow_%s" % cond, ex, dev, [cond, x, y], 1, args))
+
+    result = json.dumps({"target": str(target), "results": results}, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(result)
+    else:
+        print(result)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,89 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Microbenchmark of the task schedule modes of the runtime thread pool.
+
+It measures the launch overhead with a tiny parallel loop, and the load balance with a
+triangular parallel loop whose iterations get more expensive towards the end.
+"""
+import argparse
+
+import numpy as np
+import tvm
+from tvm.script import tir as T
+
+SCHEDULE_MODES = {"static": 0, "work_stealing": 1}
+
+
+@tvm.script.ir_module
+class ThreadPoolBenchModule:
+    @T.prim_func
+    def launch(a: T.handle, b: T.handle, n: T.int32):
+        T.func_attr({"global_symbol": "launch", "tir.noalias": True})
+        A = T.match_buffer(a, (n,), dtype="float32")
+        B = T.match_buffer(b, (n,), dtype="float32")
+        for i in T.parallel(n):
+            B[i] = A[i] + T.float32(1)
+
+    @T.prim_func
+    def triangular(a: T.handle, b: T.handle, n: T.int32):
+        T.func_attr({"global_symbol": "triangular", "tir.noalias": True})
+        A = T.match_buffer(a, (n, n), dtype="float32")
+        B = T.match_buffer(b, (n,), dtype="float32")
+        for i in T.parallel(n):
+            B[i] = T.float32(0)
+            for j in T.serial(0, i + 1):
+                B[i] = B[i] + A[i, j]
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--size", type=int, default=4096, help="The size of the triangular loop")
+    parser.add_argument("--chunks-per-worker", type=int, default=4)
+    parser.add_argument("--number", type=int, default=100)
+    parser.add_argument("--repeat", type=int, default=5)
+    args = parser.parse_args()
+
+    dev = tvm.cpu()
+    lib = tvm.build(ThreadPoolBenchModule, target="llvm")
+    config_schedule = tvm.get_global_func("runtime.config_threadpool_schedule")
+    num_threads = tvm.get_global_func("runtime.NumThreads")()
+
+    n_launch = num_threads
+    launch_args = [
+        tvm.nd.array(np.random.uniform(size=n_launch).astype("float32"), dev),
+        tvm.nd.empty((n_launch,), "float32", dev),
+        n_launch,
+    ]
+    n = args.size
+    triangular_args = [
+        tvm.nd.array(np.random.uniform(size=(n, n)).astype("float32"), dev),
+        tvm.nd.empty((n,), "float32", dev),
+        n,
+    ]
+    print(f"Threads: {num_threads}, chunks per worker: {args.chunks_per_worker}")
+    for name, mode in SCHEDULE_MODES.items():
+        config_schedule(mode, args.chunks_per_worker)
+        results = []
+        for func_name, func_args in [("launch", launch_args), ("triangular", triangular_args)]:
+            evaluator = lib.time_evaluator(func_name, dev, number=args.number, repeat=args.repeat)
+            results.append(evaluator(*func_args).mean * 1e6)
+        print(f"{name:>14}: launch {results[0]:10.2f} us, triangular {results[1]:10.2f} us")
+    config_schedule(SCHEDULE_MODES["static"], args.chunks_per_worker)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,70 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# Measure the throughput of the BlockBuilder on synthetic models of many ops: emitting fresh
+# calls, which deduces their shape and type, and re-emitting the already normalized calls, as
+# the translators and passes do. Both rates should stay flat as the number of ops grows.
+#
+#   python apps/relax_examples/block_builder_throughput.py --ops 1000 10000 100000
+
+
+import argparse
+import time
+
+from tvm import relax
+
+
+def emit_chain(num_ops, values=None):
+    """Emit a chain of num_ops adds in one dataflow block, or re-emit the given values.
+
+    Returns
+    -------
+    values: List[relax.Call]
+        The emitted calls, normalized by the builder.
+    elapsed: float
+        The time spent emitting, in seconds.
+    """
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", (16, 16), relax.DynTensorType(2, "float32"))
+    emitted = []
+    with bb.function("main", [x]):
+        with bb.dataflow():
+            start = time.perf_counter()
+            lv = x
+            for i in range(num_ops):
+                lv = bb.emit(values[i] if values else relax.add(lv, x))
+                emitted.append(bb.lookup_binding(lv))
+            elapsed = time.perf_counter() - start
+            gv = bb.emit_output(lv)
+        bb.emit_func_output(gv)
+    return emitted, elapsed
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure the throughput of the BlockBuilder.")
+    parser.add_argument("--ops", type=int, nargs="+", default=[1000, 10000, 100000])
+    args = parser.parse_args()
+    for num_ops in args.ops:
+        values, fresh = emit_chain(num_ops)
+        _, normalized = emit_chain(num_ops, values)
+        print(
+            "%7d ops: %10.0f fresh emits/s, %10.0f normalized emits/s"
+            % (num_ops, num_ops / fresh, num_ops / normalized)
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,85 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+# Measure the compile time of FuseOps on synthetic deep graphs, e.g. unrolled LLM layers.
+# The time per binding should stay flat as the number of layers grows.
+#
+#   python apps/relax_examples/fuse_ops_compile_time.py --layers 100 1000 10000
+
+
+import argparse
+import time
+
+import tvm
+from tvm import relax, te, topi
+
+
+def build_deep_model(num_layers, hidden=64):
+    """Build a main function of num_layers residual blocks: dense, bias add, relu and add.
+
+    Every kernel is added once and called by all the layers, so building stays cheap and the
+    module has 4 * num_layers bindings in one dataflow block.
+    """
+    bb = relax.BlockBuilder()
+    shape = (1, hidden)
+    x = relax.Var("x", shape, relax.DynTensorType(2, "float32"))
+    w = relax.Var("w", (hidden, hidden), relax.DynTensorType(2, "float32"))
+    b = relax.Var("b", shape, relax.DynTensorType(2, "float32"))
+
+    def prim_func(fcompute, *shapes):
+        args = [te.placeholder(s, "float32") for s in shapes]
+        return te.create_prim_func(args + [fcompute(*args)])
+
+    dense = bb.add_func(prim_func(topi.nn.matmul, shape, (hidden, hidden)), "dense")
+    add = bb.add_func(prim_func(topi.add, shape, shape), "add")
+    relu = bb.add_func(prim_func(topi.nn.relu, shape), "relu")
+
+    def call(gv, *args):
+        return bb.emit(relax.call_tir(gv, list(args), shape, "float32"))
+
+    with bb.function("main", [x, w, b]):
+        with bb.dataflow():
+            lv = x
+            for _ in range(num_layers):
+                lv0 = call(dense, lv, w)
+                lv1 = call(add, lv0, b)
+                lv2 = call(relu, lv1)
+                lv = call(add, lv2, lv)
+            gv = bb.emit_output(lv)
+        bb.emit_func_output(gv)
+    return relax.transform.AnnotateTIROpPattern()(bb.get())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure the compile time of FuseOps.")
+    parser.add_argument("--layers", type=int, nargs="+", default=[100, 1000, 5000, 12500])
+    args = parser.parse_args()
+    for num_layers in args.layers:
+        mod = build_deep_model(num_layers)
+        num_bindings = 4 * num_layers
+        start = time.perf_counter()
+        mod = relax.transform.FuseOps()(mod)
+        elapsed = time.perf_counter() - start
+        num_funcs = sum(isinstance(f, relax.Function) for f in mod.functions.values())
+        print(
+            "%6d bindings: FuseOps %8.3f s, %6.2f us per binding, %d functions"
+            % (num_bindings, elapsed, elapsed / num_bindings * 1e6, num_funcs)
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,72 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# Measure the throughput of structural hashing on large PrimFuncs and IRModules, with and
+# without the hash cache. The cached rate is that of the repeated queries of the same objects,
+# e.g. the deduplication of the functions added to a BlockBuilder.
+#
+#   python apps/relax_examples/structural_hash_throughput.py --funcs 10 100 --depth 100
+
+
+import argparse
+import time
+
+import tvm
+from tvm import te
+
+
+def make_prim_func(depth, index):
+    """Create an elementwise PrimFunc of a chain of depth ops."""
+    x = te.placeholder((128, 128), name="x")
+    out = x
+    for i in range(depth):
+        out = te.compute(out.shape, lambda a, b, t=out, i=i: t[a, b] * (i + index) + 1.0)
+    return te.create_prim_func([x, out])
+
+
+def measure(objects, repeat, cached):
+    """Hash every object repeat times, returning the number of hashes per second."""
+    tvm.runtime._ffi_node_api.StructuralHashCacheClear()
+    start = time.perf_counter()
+    for _ in range(repeat):
+        for obj in objects:
+            tvm.ir.structural_hash(obj, cached=cached)
+    return repeat * len(objects) / (time.perf_counter() - start)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure the throughput of structural hashing.")
+    parser.add_argument("--funcs", type=int, nargs="+", default=[10, 100])
+    parser.add_argument("--depth", type=int, default=100)
+    parser.add_argument("--repeat", type=int, default=10)
+    args = parser.parse_args()
+    for num_funcs in args.funcs:
+        funcs = [make_prim_func(args.depth, i) for i in range(num_funcs)]
+        mod = tvm.IRModule({"func%d" % i: func for i, func in enumerate(funcs)})
+        for name, objects in [("PrimFuncs", funcs), ("IRModule", [mod])]:
+            print(
+                "%5d funcs, %9s: %10.1f uncached hashes/s, %10.1f cached hashes/s"
+                % (
+                    num_funcs,
+                    name,
+                    measure(objects, args.repeat, False),
+                    measure(objects, args.repeat, True),
+                )
+            )
+
+
+if __name__ == "__main__":
+    main()
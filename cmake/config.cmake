@@ -210,6 +210,12 @@ set(USE_CUDNN OFF)
 # Whether use cuBLAS
 set(USE_CUBLAS OFF)
 
+# Whether use NCCL for the collective communication among the CUDA devices of the Relax VM
+# - ON: enable NCCL with cmake's auto search
+# - OFF: disable NCCL
+# - /path/to/nccl: use specific path to NCCL
+set(USE_NCCL OFF)
+
 # Whether use MIOpen
 set(USE_MIOPEN OFF)
 
@@ -369,6 +375,11 @@ set(USE_PAPI OFF)
 # predefined variables to specify the path to the GTest package if needed.
 set(USE_GTEST AUTO)
 
+# Whether to use Google Benchmark for the C++ microbenchmarks in apps/benchmark/cpp. When
+# enabled, the generated build file will have a target "cppbench", and the package `benchmark`
+# will be required for cmake to succeed.
+set(USE_GOOGLE_BENCHMARK OFF)
+
 # Enable using CUTLASS as a BYOC backend
 # Need to have USE_CUDA=ON
 set(USE_CUTLASS OFF)
@@ -68,6 +68,7 @@ function(add_lib_info src_file)
     TVM_INFO_USE_DNNL="${USE_DNNL}"
     TVM_INFO_USE_ETHOSN="${USE_ETHOSN}"
     TVM_INFO_USE_FALLBACK_STL_MAP="${USE_FALLBACK_STL_MAP}"
+    TVM_INFO_USE_GOOGLE_BENCHMARK="${USE_GOOGLE_BENCHMARK}"
     TVM_INFO_USE_GRAPH_EXECUTOR_CUDA_GRAPH="${USE_GRAPH_EXECUTOR_CUDA_GRAPH}"
     TVM_INFO_USE_GRAPH_EXECUTOR="${USE_GRAPH_EXECUTOR}"
     TVM_INFO_USE_GTEST="${USE_GTEST}"
@@ -86,6 +87,7 @@ function(add_lib_info src_file)
     TVM_INFO_USE_MIOPEN="${USE_MIOPEN}"
     TVM_INFO_USE_MKL="${USE_MKL}"
     TVM_INFO_USE_MSVC_MT="${USE_MSVC_MT}"
+    TVM_INFO_USE_NCCL="${USE_NCCL}"
     TVM_INFO_USE_NNPACK="${USE_NNPACK}"
     TVM_INFO_USE_OPENCL="${USE_OPENCL}"
     TVM_INFO_USE_OPENCL_GTEST="${USE_OPENCL_GTEST}"
@@ -43,6 +43,7 @@ if(USE_MICRO)
          "src/runtime/crt/memory *.c -> src/runtime/crt/memory"
          "src/runtime/crt/microtvm_rpc_common *.cc -> src/runtime/crt/microtvm_rpc_common"
          "src/runtime/crt/microtvm_rpc_server *.cc -> src/runtime/crt/microtvm_rpc_server"
+         "src/runtime/crt/relax_vm *.c -> src/runtime/crt/relax_vm"
          "src/runtime/minrpc *.h -> src/runtime/minrpc"
          "src/support generic_arena.h -> src/support"
          "src/runtime/crt crt_config-template.h -> template"
@@ -28,6 +28,7 @@
 #include <tvm/ir/expr.h>
 #include <tvm/support/with.h>
 
+#include <functional>
 #include <limits>
 #include <memory>
 #include <unordered_map>
@@ -354,6 +355,9 @@ class ConstraintContext {
   PrimExpr constraint_;
   /*! \brief function to be called in recovery */
   std::vector<std::function<void()>> recovery_functions_;
+  /*! \brief The state version of the analyzer and its number of bindings when entering. */
+  uint64_t saved_version_{0};
+  uint64_t saved_num_bindings_{0};
 };
 
 /*!
@@ -533,6 +537,64 @@ class TVM_DLL Analyzer {
    * \note Analyzer will call into sub-analyzers to get the result.
    */
   PrimExpr Simplify(const PrimExpr& expr, int steps = 2);
+  /*!
+   * \brief Memoize the results of Simplify.
+   *
+   *  The results are keyed by the expression and the state of the sub-analyzers, which
+   *  Bind and the constraint contexts change. The state of the enclosing scope is restored
+   *  when a constraint context without bindings exits, so that the results computed in one
+   *  scope are reused in its sibling scopes.
+   *
+   *  The memo is enabled by default when the "arith.simplify_cache_size" option of the pass
+   *  context is positive.
+   *
+   * \param max_entries The maximal number of memoized results, 0 disables the memo.
+   * \note Call InvalidateSimplifyCache after updating a sub-analyzer directly.
+   */
+  void EnableSimplifyCache(size_t max_entries);
+  /*!
+   * \brief Notify the memo of Simplify that the state of the sub-analyzers has changed.
+   */
+  void InvalidateSimplifyCache();
+  /*! \brief The number of memo hits and misses of Simplify. */
+  int64_t simplify_cache_hits{0};
+  int64_t simplify_cache_misses{0};
+
+ private:
+  friend class ConstraintContext;
+  /*! \brief Simplify without the memo. */
+  PrimExpr SimplifyUncached(const PrimExpr& expr, int steps);
+  /*! \brief A memoized result of Simplify. */
+  struct SimplifyCacheKey {
+    const Object* expr;
+    int steps;
+    uint64_t version;
+    bool operator==(const SimplifyCacheKey& other) const {
+      return expr == other.expr && steps == other.steps && version == other.version;
+    }
+  };
+  struct SimplifyCacheKeyHash {
+    size_t operator()(const SimplifyCacheKey& key) const {
+      size_t hash = std::hash<const Object*>()(key.expr);
+      hash ^= std::hash<uint64_t>()(key.version) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+      return hash ^ static_cast<size_t>(key.steps);
+    }
+  };
+  /*! \brief The input, kept alive so that its address is not reused, and the result. */
+  struct SimplifyCacheEntry {
+    PrimExpr expr;
+    PrimExpr result;
+  };
+  /*! \brief The memo of Simplify. */
+  std::unordered_map<SimplifyCacheKey, SimplifyCacheEntry, SimplifyCacheKeyHash> simplify_cache_;
+  /*! \brief The maximal number of entries in the memo, 0 if it is disabled. */
+  size_t simplify_cache_capacity_{0};
+  /*! \brief The version of the state of the sub-analyzers, and the last version given. */
+  uint64_t state_version_{0};
+  uint64_t last_version_{0};
+  /*! \brief The number of bindings made, a constraint context restores the version only if
+   *  no binding was made in it. */
+  uint64_t num_bindings_{0};
 };
 
 }  // namespace arith
@@ -183,6 +183,16 @@ class IRModuleNode : public Object {
    */
   TVM_DLL void Update(const GlobalVar& var, const BaseFunc& func);
 
+  /*!
+   * \brief Update a batch of functions in the global environment.
+   * \param updates The map from the global functions to their new functions, which may also
+   *  add new global functions.
+   *
+   * \note The functions which are the same as the ones in the module are skipped, so that the
+   *  function map is only copied when a function changes and the module shares the map.
+   */
+  TVM_DLL void UpdateFunctions(const Map<GlobalVar, BaseFunc>& updates);
+
   /*!
    * \brief Update a type definition in the global environment.
    * \param var The name of the global type definition to update.
@@ -288,7 +298,8 @@ class IRModuleNode : public Object {
 
   /*!
    * \brief Create a shallow copy of this IRModule.
-   * \returns The shallow copy of the IRModule.
+   * \returns The shallow copy of the IRModule, which shares the maps of this module until either
+   *  of them is updated.
    */
   TVM_DLL IRModule ShallowCopy();
 
@@ -136,6 +136,13 @@ class Builder : public runtime::ObjectRef {
    * \return The Builder created.
    */
   static Builder PyBuilder(BuilderNode::FBuild f_build);
+  /*!
+   * \brief Create a builder which builds in the current process on a thread pool, keeping the
+   *  built modules in memory. Its artifacts can only be run in the same process.
+   * \param max_workers The number of threads to build with.
+   * \return The Builder created.
+   */
+  TVM_DLL static Builder InProcessBuilder(int max_workers);
   TVM_DEFINE_MUTABLE_NOTNULLABLE_OBJECT_REF_METHODS(Builder, runtime::ObjectRef, BuilderNode);
 };
 
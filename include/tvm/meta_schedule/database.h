@@ -98,6 +98,32 @@ struct WorkloadEqual {
   }
 };
 
+/*!
+ * \brief The process-wide table of workloads, shared by the MetaSchedule and the Relax tuning
+ * databases. Interning returns the canonical workload of the structurally equal modules, so that
+ * every database holds one copy of a module, which is hashed once and compared by address.
+ */
+class WorkloadRegistry {
+ public:
+  /*!
+   * \brief Get the canonical workload of a module, adding it to the table if missing.
+   * \param mod The module.
+   * \return The canonical workload.
+   */
+  TVM_DLL static Workload Intern(const IRModule& mod);
+  /*!
+   * \brief Get the canonical workload of a workload, e.g. loaded from a database, adding it to
+   * the table if missing.
+   * \param workload The workload.
+   * \return The canonical workload.
+   */
+  TVM_DLL static Workload Intern(const Workload& workload);
+  /*! \brief The number of workloads in the table. */
+  TVM_DLL static int64_t Size();
+  /*! \brief Remove every workload from the table. */
+  TVM_DLL static void Clear();
+};
+
 /*! \brief The class of measure candidates. */
 class MeasureCandidate;
 
@@ -50,6 +50,19 @@ class FeatureExtractorNode : public runtime::Object {
   virtual Array<tvm::runtime::NDArray> ExtractFrom(const TuneContext& context,
                                                    const Array<MeasureCandidate>& candidates) = 0;
 
+  /*!
+   * \brief Extract features from the given measure candidates into one contiguous matrix.
+   * \param context The tuning context for feature extraction.
+   * \param candidates The measure candidates to extract features from.
+   * \return A pair of ndarrays: the float32 feature matrix, whose rows are the feature vectors of
+   * all the candidates one after another, and the int64 row offsets of length
+   * `candidates.size() + 1`, where the rows of the i-th candidate are in
+   * `[row_offsets[i], row_offsets[i + 1])`.
+   * \note The default implementation concatenates the results of `ExtractFrom`.
+   */
+  virtual Array<tvm::runtime::NDArray> ExtractBatchedFrom(
+      const TuneContext& context, const Array<MeasureCandidate>& candidates);
+
   static constexpr const char* _type_key = "meta_schedule.FeatureExtractor";
   TVM_DECLARE_BASE_OBJECT_INFO(FeatureExtractorNode, Object);
 };
@@ -102,12 +115,15 @@ class FeatureExtractor : public runtime::ObjectRef {
    * curve.
    * \param cache_line_bytes The number of bytes in a cache line.
    * \param extract_workload Whether to extract features in the workload in tuning context or not.
+   * \param feature_cache_size The max number of deduplicated candidates to keep the features of,
+   * so that structurally equal candidates are not extracted again. 0 disables the cache.
    * \return The feature extractor created.
    */
   TVM_DLL static FeatureExtractor PerStoreFeature(int buffers_per_store = 5,
                                                   int arith_intensity_curve_num_samples = 10,
                                                   int cache_line_bytes = 64,
-                                                  bool extract_workload = false);
+                                                  bool extract_workload = false,
+                                                  int feature_cache_size = 4096);
   /*!
    * \brief Create a feature extractor with customized methods on the python-side.
    * \param f_extract_from The packed function of `ExtractFrom`.
@@ -150,6 +150,12 @@ class Postproc : public runtime::ObjectRef {
    * \return The postprocessor created.
    */
   TVM_DLL static Postproc RewriteTensorize(bool vectorize_init_loop = false);
+  /*!
+   * \brief Create a postprocessor that pipelines the global to shared memory copies of the loops
+   *  with the async copies on CUDA sm_80 and newer.
+   * \return The postprocessor created.
+   */
+  TVM_DLL static Postproc RewriteSoftwarePipeline();
   /*!
    * \brief Creates a postprocessor that verifies if the GPU code is correct
    * \return The postprocessor created
@@ -58,10 +58,19 @@ class ProfilerNode : public runtime::Object {
   std::unordered_map<std::string, double> stats_sec;
   /*! \brief Counter for the total time used */
   runtime::PackedFunc total_timer;
+  /*! \brief The segments profiled in the scope of each task, by the name of the task */
+  std::unordered_map<std::string, std::unordered_map<std::string, double>> task_stats_sec;
+  /*! \brief The number of trials measured for each task */
+  std::unordered_map<std::string, int64_t> task_trials;
+  /*! \brief The task the segments are attributed to, empty outside of the scope of a task */
+  std::string current_task;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     // `stats_sec` is not visited.
     // `total_timer` is not visited.
+    // `task_stats_sec` is not visited.
+    // `task_trials` is not visited.
+    // `current_task` is not visited.
   }
 
   static constexpr const char* _type_key = "meta_schedule.Profiler";
@@ -72,6 +81,11 @@ class ProfilerNode : public runtime::Object {
   Map<String, FloatImm> Get() const;
   /*! \brief Return a summary of profiling results as table format */
   String Table() const;
+  /*!
+   * \brief Return the profiling results as a JSON object, with the time of the segments of each
+   * task, its number of trials measured and their throughput in trials per second.
+   */
+  String JSON() const;
 };
 
 /*!
@@ -95,6 +109,18 @@ class Profiler : public runtime::ObjectRef {
    * \return A scope timer for time profiling.
    */
   static ScopedTimer TimedScope(String name);
+  /*!
+   * \brief Attribute the segments profiled in the given scope to a task, whose total time is the
+   * time spent in its scopes.
+   * \param task_name Name of the task.
+   * \return A scope timer for time profiling.
+   */
+  static ScopedTimer TaskScope(String task_name);
+  /*!
+   * \brief Count the trials measured for the current task.
+   * \param num_trials The number of trials.
+   */
+  static void CountTrials(int64_t num_trials);
 };
 
 }  // namespace meta_schedule
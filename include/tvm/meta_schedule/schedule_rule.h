@@ -190,6 +190,15 @@ class ScheduleRule : public runtime::ObjectRef {
    * \return The schedule rule created
    */
   TVM_DLL static ScheduleRule CrossThreadReduction(Array<Integer> thread_extents);
+  /*!
+   * \brief Create a schedule rule which splits the long reduction of the skinny GEMM-like blocks
+   * into partial sums computed by separate thread blocks, followed by a cross-block reduction
+   * \param split_factors Candidates of the number of the splits (values are required to be
+   * greater than 1).
+   * \param thread_extents Candidates of thread axis extent (values are required to be positive).
+   * \return The schedule rule created
+   */
+  TVM_DLL static ScheduleRule SplitK(Array<Integer> split_factors, Array<Integer> thread_extents);
   /*!
    * \brief A rule that randomly select a compute-at location for a free block
    * \return The schedule rule created
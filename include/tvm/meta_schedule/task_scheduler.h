@@ -237,6 +237,9 @@ class TaskScheduler : public runtime::ObjectRef {
    * \param alpha The parameter alpha to control gradient computation.
    * \param window_size The parameter to control backward window size.
    * \param seed The random seed.
+   * \param num_inflight_tasks The maximum number of tasks built and measured at once. With more
+   * than one, the candidates of a task are built and sent to the runner in the background while
+   * the candidates of the next task picked by the gradients are generated.
    * \return The task scheduler created.
    */
   TVM_DLL static TaskScheduler GradientBased(Array<TuneContext> tasks,
@@ -250,7 +253,8 @@ class TaskScheduler : public runtime::ObjectRef {
                                              PackedFunc logging_func,                             //
                                              double alpha,                                        //
                                              int window_size,                                     //
-                                             support::LinearCongruentialEngine::TRandState seed);
+                                             support::LinearCongruentialEngine::TRandState seed,  //
+                                             int num_inflight_tasks = 1);
   /*!
    * \brief Create a task scheduler with customized methods on the python-side.
    * \param tasks The tasks to be tuned.
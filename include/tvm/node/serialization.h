@@ -29,6 +29,10 @@
 
 #include <string>
 
+namespace dmlc {
+class Stream;
+}  // namespace dmlc
+
 namespace tvm {
 /*!
  * \brief save the node as well as all the node it depends on as json.
@@ -47,5 +51,58 @@ TVM_DLL std::string SaveJSON(const runtime::ObjectRef& node);
  */
 TVM_DLL runtime::ObjectRef LoadJSON(std::string json_str);
 
+/*!
+ * \brief Save the node as well as all the nodes it depends on in the binary format, which is
+ *  more compact and faster to load than json. The NDArrays are kept out of the graph as raw
+ *  bytes aligned in the output, so that a loaded file can be memory mapped.
+ * \param node The node to be saved.
+ * \param strm The output stream, written in one pass.
+ */
+TVM_DLL void SaveBinary(const runtime::ObjectRef& node, dmlc::Stream* strm);
+
+/*!
+ * \brief Save the node in the binary format.
+ * \param node The node to be saved.
+ * \return The bytes of the binary format.
+ */
+TVM_DLL std::string SaveBinary(const runtime::ObjectRef& node);
+
+/*!
+ * \brief Load a node saved in the binary format.
+ * \param strm The input stream, read in one pass.
+ * \return The loaded node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinary(dmlc::Stream* strm);
+
+/*!
+ * \brief Load a node saved in the binary format.
+ * \param data The bytes of the binary format.
+ * \return The loaded node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinary(const std::string& data);
+
+/*!
+ * \brief Check whether the bytes are in the binary format rather than json.
+ * \param data The bytes.
+ * \return Whether the bytes start with the magic number of the binary format.
+ */
+TVM_DLL bool IsBinaryFormat(const std::string& data);
+
+/*!
+ * \brief Save the node to a file in the binary format.
+ * \param node The node to be saved.
+ * \param path The path of the file.
+ */
+TVM_DLL void SaveBinaryToFile(const runtime::ObjectRef& node, const std::string& path);
+
+/*!
+ * \brief Load a node from a file in the binary format.
+ * \param path The path of the file.
+ * \param use_mmap Whether to memory map the file, in which case the NDArrays of the node refer
+ *  to the private mapping in place instead of being read.
+ * \return The loaded node.
+ */
+TVM_DLL runtime::ObjectRef LoadBinaryFromFile(const std::string& path, bool use_mmap = true);
+
 }  // namespace tvm
 #endif  // TVM_NODE_SERIALIZATION_H_
@@ -91,6 +91,29 @@ class StructuralEqual : public BaseValueEqual {
   TVM_DLL bool operator()(const ObjectRef& lhs, const ObjectRef& rhs) const;
 };
 
+/*!
+ * \brief Structural equality which short-circuits on the identity of the operands and on their
+ *  structural hash values memoized by the global StructuralHashCache, a companion of
+ *  CachedStructuralHash for the containers and lookups which compare the same objects repeatedly.
+ *
+ *  Objects with different hash values are not structurally equal, so the full comparison only
+ *  runs for the objects whose hash values match, i.e. the equal ones and the hash collisions.
+ *
+ * \note Unlike StructuralEqual, two floats differing within the tolerance of BaseValueEqual
+ *  compare unequal, as they hash differently.
+ */
+class CachedStructuralEqual : public BaseValueEqual {
+ public:
+  using BaseValueEqual::operator();
+  /*!
+   * \brief Compare objects via strutural equal.
+   * \param lhs The left operand.
+   * \param rhs The right operand.
+   * \return The comparison result.
+   */
+  TVM_DLL bool operator()(const ObjectRef& lhs, const ObjectRef& rhs) const;
+};
+
 /*!
  * \brief A Reducer class to reduce the structural equality result of two objects.
  *
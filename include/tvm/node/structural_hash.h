@@ -28,7 +28,9 @@
 #include <tvm/runtime/ndarray.h>
 
 #include <functional>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace tvm {
 
@@ -84,6 +86,70 @@ class StructuralHash : public BaseValueHash {
   TVM_DLL size_t operator()(const ObjectRef& key) const;
 };
 
+/*!
+ * \brief A cache of the structural hash values of objects, keyed by their identity.
+ *
+ *  IR nodes are immutable once shared, so the hash value of an object never needs to be
+ *  invalidated: the cache holds a reference to each object it hashed, which keeps any
+ *  copy-on-write from mutating it in place and keeps its address from being reused. The cache
+ *  is cleared when it reaches its capacity, bounding the memory it keeps alive.
+ *
+ * \note Only the hash value of the hashed root is cached, as the hash values of the children
+ *  depend on the context of the root, e.g. the order of the free vars and graph nodes.
+ */
+class StructuralHashCache {
+ public:
+  /*!
+   * \brief Constructor.
+   * \param capacity The maximum number of objects cached.
+   */
+  explicit StructuralHashCache(size_t capacity = 4096) : capacity_(capacity) {}
+
+  /*!
+   * \brief Get the structural hash value of an object, computing it on the first query.
+   * \param object The object to hash.
+   * \param map_free_vars Whether to map the free variables, see StructuralHash.
+   * \return The hash value.
+   */
+  TVM_DLL size_t Hash(const ObjectRef& object, bool map_free_vars = false);
+
+  /*! \brief Remove the cached entries. */
+  TVM_DLL void Clear();
+
+  /*! \brief The number of cache hits and misses since the cache was created. */
+  size_t num_hits() const { return num_hits_; }
+  size_t num_misses() const { return num_misses_; }
+
+  /*! \brief The cache shared by the process, used by CachedStructuralHash. */
+  TVM_DLL static StructuralHashCache* Global();
+
+ private:
+  struct Entry {
+    ObjectRef object;
+    size_t hash[2];
+    bool hashed[2];
+  };
+
+  size_t capacity_;
+  size_t num_hits_{0};
+  size_t num_misses_{0};
+  std::mutex mutex_;
+  std::unordered_map<const Object*, Entry> entries_;
+};
+
+/*!
+ * \brief Structural hashing memoized by the global StructuralHashCache, a drop-in replacement of
+ *  StructuralHash for the containers which repeatedly hash the same objects, e.g. the functions
+ *  deduplicated across passes.
+ */
+class CachedStructuralHash : public BaseValueHash {
+ public:
+  using BaseValueHash::operator();
+  size_t operator()(const ObjectRef& key) const {
+    return StructuralHashCache::Global()->Hash(key, false);
+  }
+};
+
 /*!
  * \brief A Reducer class to reduce the structural hash value.
  *
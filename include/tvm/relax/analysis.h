@@ -25,6 +25,7 @@
 #define TVM_RELAX_ANALYSIS_H_
 
 #include <tvm/ir/diagnostic.h>
+#include <tvm/ir/instrument.h>
 #include <tvm/ir/module.h>
 #include <tvm/relax/expr.h>
 #include <tvm/relay/op_attr_types.h>
@@ -43,6 +44,19 @@ namespace relax {
 TVM_DLL bool WellFormed(const IRModule& m,
                         Optional<DiagnosticContext> diag_ctx = Optional<DiagnosticContext>());
 
+/*!
+ * \brief Create a pass instrument which checks that the input and output IRModules of the passes
+ * are well formed.
+ *
+ * \param skip_passes The names of the passes whose modules are not checked.
+ * \param incremental Whether to only check the functions which changed since the last check. A
+ * function is skipped while it is the same object as a function found well formed, and the
+ * GlobalVars of that check are still defined.
+ * \return The pass instrument.
+ */
+TVM_DLL instrument::PassInstrument WellFormedInstrument(Array<String> skip_passes,
+                                                        bool incremental = true);
+
 /*!
  * \brief Annotate Op Pattern Kind for PrimFunc, which is used in relax FuseOps.
  *
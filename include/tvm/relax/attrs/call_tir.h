@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file tvm/relax/attrs/call_tir.h
+ * \brief Attributes for call_tir.
+ */
+#ifndef TVM_RELAX_ATTRS_CALL_TIR_H_
+#define TVM_RELAX_ATTRS_CALL_TIR_H_
+
+#include <tvm/ir/attrs.h>
+
+namespace tvm {
+namespace relax {
+/*!
+ * \brief Attributes for call_tir computing some outputs in place.
+ */
+struct CallTIRInplaceAttrs : public tvm::AttrsNode<CallTIRInplaceAttrs> {
+  Array<Integer> inplace_indices;
+
+  TVM_DECLARE_ATTRS(CallTIRInplaceAttrs, "relax.attrs.CallTIRInplaceAttrs") {
+    TVM_ATTR_FIELD(inplace_indices)
+        .describe(
+            "For each output, the index of the input argument whose tensor is overwritten by the "
+            "output, or -1 if the output is a fresh tensor.");
+  }
+};
+
+/*!
+ * \brief Attributes for call_tir running on a given device of the VM.
+ */
+struct CallTIRDeviceAttrs : public tvm::AttrsNode<CallTIRDeviceAttrs> {
+  int runtime_device_index;
+
+  TVM_DECLARE_ATTRS(CallTIRDeviceAttrs, "relax.attrs.CallTIRDeviceAttrs") {
+    TVM_ATTR_FIELD(runtime_device_index)
+        .describe(
+            "The index of the VM device the outputs are allocated on, which the kernel runs on "
+            "as its arguments are on the device.");
+  }
+};
+
+}  // namespace relax
+}  // namespace tvm
+#endif  // TVM_RELAX_ATTRS_CALL_TIR_H_
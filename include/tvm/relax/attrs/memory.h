@@ -35,6 +35,7 @@ namespace relax {
 struct AllocTensorAttrs : public tvm::AttrsNode<AllocTensorAttrs> {
   DataType dtype;
   int64_t runtime_device_index;
+  String mem_scope;
 
   TVM_DECLARE_ATTRS(AllocTensorAttrs, "relax.attrs.AllocTensorAttrs") {
     TVM_ATTR_FIELD(dtype).describe("The datatype of the tensor to be allocated.");
@@ -43,6 +44,9 @@ struct AllocTensorAttrs : public tvm::AttrsNode<AllocTensorAttrs> {
             "The device index indicating on which device the tensor is to be allocated at runtime. "
             "Index -1 is reserved for the host device.")
         .set_default(-1);
+    TVM_ATTR_FIELD(mem_scope)
+        .describe("The memory scope of the tensor, e.g. global.texture for the image memory.")
+        .set_default("global");
   }
 };
 
@@ -52,6 +56,7 @@ struct AllocTensorAttrs : public tvm::AttrsNode<AllocTensorAttrs> {
 struct VMAllocStorageAttrs : public tvm::AttrsNode<VMAllocStorageAttrs> {
   DataType dtype;
   int64_t runtime_device_index;
+  String mem_scope;
 
   TVM_DECLARE_ATTRS(VMAllocStorageAttrs, "relax.attrs.VMAllocStorageAttrs") {
     TVM_ATTR_FIELD(dtype)
@@ -62,6 +67,12 @@ struct VMAllocStorageAttrs : public tvm::AttrsNode<VMAllocStorageAttrs> {
             "The device index indicating on which device the tensor is to be allocated at runtime. "
             "Index -1 is reserved for the host device.")
         .set_default(-1);
+    TVM_ATTR_FIELD(mem_scope)
+        .describe(
+            "The memory scope of the storage. The size is given in bytes for the global scope, "
+            "as the shape of the tensor held by the storage for the texture scopes, and as the "
+            "flat number of elements of the dtype for the other scopes.")
+        .set_default("global");
   }
 };
 
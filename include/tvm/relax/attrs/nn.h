@@ -0,0 +1,57 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/relax/attrs/nn.h
+ * \brief Attributes for neural network operators.
+ */
+#ifndef TVM_RELAX_ATTRS_NN_H_
+#define TVM_RELAX_ATTRS_NN_H_
+
+#include <tvm/ir/attrs.h>
+
+namespace tvm {
+namespace relax {
+
+/*!
+ * \brief Attributes for the fused attention operator.
+ */
+struct AttentionAttrs : public tvm::AttrsNode<AttentionAttrs> {
+  Optional<FloatImm> scale;
+
+  TVM_DECLARE_ATTRS(AttentionAttrs, "relax.attrs.AttentionAttrs") {
+    TVM_ATTR_FIELD(scale).describe(
+        "The scale of the scores before the softmax, 1 / sqrt(head_dim) if not defined.");
+  }
+};
+
+/*!
+ * \brief Attributes for the embedding bag operator.
+ */
+struct EmbeddingBagAttrs : public tvm::AttrsNode<EmbeddingBagAttrs> {
+  String mode;
+
+  TVM_DECLARE_ATTRS(EmbeddingBagAttrs, "relax.attrs.EmbeddingBagAttrs") {
+    TVM_ATTR_FIELD(mode).describe("The pooling of the rows of a bag, sum, mean or max.");
+  }
+};
+
+}  // namespace relax
+}  // namespace tvm
+#endif  // TVM_RELAX_ATTRS_NN_H_
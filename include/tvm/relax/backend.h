@@ -30,6 +30,24 @@ namespace tvm {
 namespace relax {
 namespace transform {
 
+/*!
+ * \brief Hoist the global-scope, static-shape buffers allocated by the root block of the kernels
+ * called in destination-passing style to trailing workspace parameters, allocated by the callers
+ * with relax.builtin.alloc_tensor, so that they are planned together with the other tensors.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass HoistWorkspace();
+
+/*!
+ * \brief Plan the storage of static-shape tensors allocated by relax.builtin.alloc_tensor
+ * using liveness analysis, so that tensors whose lifetimes never overlap share one
+ * relax.vm.builtin.alloc_storage per device at different offsets.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass StaticPlanBlockMemory();
+
 /*!
  * \brief Perform memory lowering. Lowers the relax.builtin.alloc_tensor intrinsic to VM intrinsics.
  *
@@ -195,7 +195,7 @@ class BlockBuilderNode : public Object {
    * \brief A hashmap to store the mapping of Relax functions and TIR PrimFuncs
    * in \p _context_mod to their GlobalVar to avoid generating duplicated functions.
    */
-  std::unordered_map<BaseFunc, GlobalVar, StructuralHash, StructuralEqual> func_map_;
+  std::unordered_map<BaseFunc, GlobalVar, CachedStructuralHash, CachedStructuralEqual> func_map_;
 
  protected:
   /*!
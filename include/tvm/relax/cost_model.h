@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/relax/cost_model.h
+ * \brief The latency oracle of the kernels called by Relax programs, for the graph-level passes.
+ */
+#ifndef TVM_RELAX_COST_MODEL_H_
+#define TVM_RELAX_COST_MODEL_H_
+
+#include <tvm/ir/module.h>
+#include <tvm/meta_schedule/database.h>
+#include <tvm/relax/expr.h>
+#include <tvm/target/target.h>
+#include <tvm/tir/function.h>
+
+#include <unordered_map>
+
+namespace tvm {
+namespace relax {
+
+/*!
+ * \brief Estimate the latency of the kernels called with call_tir, so that the graph-level
+ *  passes, e.g. fusion or the choice between a library and a tuned kernel, can compare their
+ *  options per shape.
+ *
+ *  The latency of a kernel is the mean of the measured run time of its best record in the
+ *  MetaSchedule database. The kernels without a record fall back to the given function, e.g. a
+ *  learned cost model, and otherwise to a throughput fit on the measured records of the target:
+ *  latency = scale * flops ^ exponent, fit by least squares in the log space.
+ *
+ *  The model is exposed to the passes by the "relax.kernel_cost_model" pass config.
+ */
+class KernelCostModelNode : public Object {
+ public:
+  /*! \brief The database of the measured tuning records. */
+  meta_schedule::Database database{nullptr};
+  /*! \brief The target the kernels run on. */
+  Target target;
+  /*!
+   * \brief The estimation of the kernels without a measured record, a PackedFunc taking the
+   *  PrimFunc and returning its latency in seconds, or a negative value when it has none.
+   */
+  Optional<runtime::PackedFunc> f_fallback;
+  /*! \brief The log of the scale of the throughput fit, if any record could be fit. */
+  double log_scale = 0.0;
+  /*! \brief The exponent of the flops in the throughput fit, 0 when there is no fit. */
+  double exponent = 0.0;
+  /*! \brief The number of the measured records the throughput is fit on. */
+  int num_fit_records = 0;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("database", &database);
+    v->Visit("target", &target);
+    v->Visit("f_fallback", &f_fallback);
+    v->Visit("log_scale", &log_scale);
+    v->Visit("exponent", &exponent);
+    v->Visit("num_fit_records", &num_fit_records);
+  }
+
+  /*!
+   * \brief The measured latency of the kernel, from its best record in the database.
+   * \param func The kernel.
+   * \return The latency in seconds, or a negative value when the kernel has no measured record.
+   */
+  TVM_DLL double QueryMeasured(const tir::PrimFunc& func) const;
+  /*!
+   * \brief Estimate the latency of the kernel, measured or else by the fallbacks.
+   * \param func The kernel.
+   * \return The latency in seconds, or a negative value when no estimation applies.
+   */
+  TVM_DLL double Estimate(const tir::PrimFunc& func) const;
+  /*!
+   * \brief Estimate the latency of a call_tir of the module.
+   * \param mod The module defining the callee.
+   * \param call The call_tir.
+   * \return The latency in seconds, or a negative value when the callee is not a PrimFunc of the
+   *  module or no estimation applies.
+   */
+  TVM_DLL double EstimateCallTIR(const IRModule& mod, const Call& call) const;
+
+  static constexpr const char* _type_key = "relax.KernelCostModel";
+  TVM_DECLARE_FINAL_OBJECT_INFO(KernelCostModelNode, Object);
+
+ private:
+  /*! \brief The estimations made, by the kernels. */
+  mutable std::unordered_map<tir::PrimFunc, double, StructuralHash, StructuralEqual> cache_;
+};
+
+/*!
+ * \brief Managed reference to KernelCostModelNode.
+ * \sa KernelCostModelNode
+ */
+class KernelCostModel : public ObjectRef {
+ public:
+  /*!
+   * \brief Create the cost model and fit the throughput of the target on the database.
+   * \param database The database of the measured tuning records.
+   * \param target The target the kernels run on.
+   * \param f_fallback The estimation of the kernels without a measured record.
+   */
+  TVM_DLL explicit KernelCostModel(meta_schedule::Database database, Target target,
+                                   Optional<runtime::PackedFunc> f_fallback);
+  /*! \return The cost model of the current pass context, if any. */
+  TVM_DLL static Optional<KernelCostModel> Current();
+
+  TVM_DEFINE_OBJECT_REF_METHODS(KernelCostModel, ObjectRef, KernelCostModelNode);
+};
+
+}  // namespace relax
+}  // namespace tvm
+
+#endif  // TVM_RELAX_COST_MODEL_H_
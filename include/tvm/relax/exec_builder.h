@@ -24,14 +24,19 @@
 #define TVM_RELAX_EXEC_BUILDER_H_
 
 #include <tvm/ir/expr.h>
+#include <tvm/ir/span.h>
 #include <tvm/node/reflection.h>
 #include <tvm/node/repr_printer.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/runtime/object.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/runtime/relax_vm/bytecode.h>
 #include <tvm/runtime/relax_vm/executable.h>
 
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace tvm {
@@ -55,6 +60,16 @@ class ExecBuilderNode : public Object {
    * \param param_names The function parameter names.
    */
   void EmitFunction(std::string func, int64_t num_inputs, Array<String> param_names);
+  /*!
+   * \brief Declare a function compiled into a host function of the kernel library.
+   * \param func The function name.
+   * \param num_inputs The number of inputs.
+   * \param param_names The function parameter names.
+   * \return The index of the function in the global function table.
+   * \note The register file size of the function is left to the compiler, which sets it
+   *  once the function is generated.
+   */
+  vm::Index EmitCompiledFunction(std::string func, int64_t num_inputs, Array<String> param_names);
   /*!
    * \brief Emit a call instruction for a packed function.
    * \param func The packed function name.
@@ -62,6 +77,13 @@ class ExecBuilderNode : public Object {
    * \param ret The return register.
    */
   void EmitCall(std::string func, std::vector<vm::Instruction::Arg> args, vm::RegName ret);
+  /*!
+   * \brief Emit a tail call instruction, which returns the result of the call.
+   * \param func The name of the function, a bytecode function or vm.builtin.invoke_closure
+   *  reuses the frame of the caller.
+   * \param args The arguments of the function.
+   */
+  void EmitTailCall(std::string func, std::vector<vm::Instruction::Arg> args);
   /*!
    * \brief Emit a ret instruction.
    * \param result The return result.
@@ -78,12 +100,43 @@ class ExecBuilderNode : public Object {
    * \param false_offset The program counter offset for the false branch.
    */
   void EmitIf(vm::RegName cond, vm::Index false_offset);
+  /*!
+   * \brief Emit a KillRegister instruction.
+   * \param reg The register whose value is dead after this point.
+   */
+  void EmitKillRegister(vm::RegName reg);
+  /*!
+   * \brief Emit a Move instruction.
+   * \param src The source register, immediate or constant.
+   * \param dst The destination register.
+   */
+  void EmitMove(vm::Instruction::Arg src, vm::RegName dst);
   /*!
    * \brief Emit a constant value to the constant pool.
    * \param obj The constant value to be emitted
    * \return The index that represents the constant.
+   * \note An NDArray or string constant equal to a previously emitted one reuses its index.
    */
   vm::Index EmitConstant(TVMRetValue obj);
+  /*!
+   * \brief Set the source span of the instructions emitted from now on.
+   * \param span The source span, or an undefined span when the source is unknown.
+   * \note The spans are recorded as the pc-to-source index of the executable.
+   */
+  void SetSourceSpan(Span span);
+  /*!
+   * \brief Optimize the emitted instructions of the bytecode functions with peephole rewrites:
+   *  jump threading, move coalescing, copy propagation and the removal of redundant shape_of
+   *  calls. The registers freed by the rewrites are reclaimed when the executable is formalized.
+   * \note It must be called after all the instructions are emitted and before Get.
+   */
+  void Optimize();
+  /*!
+   * \brief Allocate the registers of the bytecode functions, so that registers whose live
+   *  intervals do not overlap share a slot of the register file.
+   * \note It must be called after all the instructions are emitted, and after Optimize if any.
+   */
+  void AllocateRegisters();
   /*!
    * \brief Get the built executable.
    * \return The built executable.
@@ -111,6 +164,36 @@ class ExecBuilderNode : public Object {
    * \brief Formalize the executable.
    */
   void Formalize();
+  /*!
+   * \brief Get the end of the instructions of a function.
+   * \param func The function.
+   * \return The index after the last instruction of the function.
+   */
+  size_t FunctionEnd(const vm::VMFunction& func) const;
+  /*!
+   * \brief Start a new instruction, recording its source location when it changed.
+   */
+  void BeginInstruction();
+  /*!
+   * \brief Get the index of a function in the function table, adding it when it is new.
+   * \param func The function name.
+   * \return The index of the function.
+   */
+  vm::Index GetFuncIndex(const std::string& func);
+
+  /*!
+   * \brief The constant pool index of each emitted NDArray and string constant.
+   * \note Constants are deduplicated by content, so identical weights are stored once.
+   */
+  std::unordered_map<ObjectRef, vm::Index, StructuralHash, StructuralEqual> const_dedup_map_;
+  /*! \brief The source location of the instructions emitted next. */
+  std::string source_location_;
+  /*! \brief The source location recorded for the last emitted instruction. */
+  std::string recorded_location_;
+  /*! \brief The pc and the source location of each run of instructions, ascending in pc. */
+  std::vector<std::pair<vm::Index, std::string>> source_locations_;
+  /*! \brief The number of source_locations_ already recorded in the executable. */
+  size_t num_flushed_locations_{0};
 };
 
 class ExecBuilder : public ObjectRef {
@@ -479,6 +479,20 @@ constexpr const char* kCodegen = "Codegen";
 constexpr const char* kComposite = "Composite";
 /*! \brief Indicate the function was created by the Pattern Partitioning Pass. */
 constexpr const char* kPartitionedFromPattern = "PartitionedFromPattern";
+/*!
+ * \brief The variants of a kernel with symbolic shapes, each tuned for a range of a dimension,
+ *  which the VM picks from at runtime. A map with "dim", the parameter index and the axis of
+ *  the dimension, "extents", the sorted extents which the variants serve the dimensions up to,
+ *  and "variants", the names of the variants. Larger dimensions are served by the kernel itself.
+ *  The module given to the VM codegen maps the kernel names to their tables under the same key.
+ */
+constexpr const char* kKernelDispatchTable = "relax.kernel_dispatch_table";
+/*!
+ * \brief Memoize the calls to the Relax function, which must be pure and depend on its inputs
+ *  only: the VM keeps the outputs of the last calls, as many as the integer value of the
+ *  attribute, keyed by the inputs, and serves the calls with the same inputs from them.
+ */
+constexpr const char* kMemoize = "relax.memoize";
 }  // namespace attr
 
 /*! \brief The extern function, which can represent packed function. */
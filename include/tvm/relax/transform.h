@@ -27,6 +27,7 @@
 #include <tvm/ir/transform.h>
 #include <tvm/meta_schedule/apply_history_best.h>
 #include <tvm/meta_schedule/database.h>
+#include <tvm/relax/dataflow_pattern.h>
 #include <tvm/relax/expr.h>
 
 namespace tvm {
@@ -102,6 +103,15 @@ TVM_DLL Pass ToNonDataflow();
  */
 TVM_DLL Pass CallTIRRewrite();
 
+/*!
+ * \brief Mark the elementwise call_tir whose input has the shape and dtype of the output and
+ * is dead after the call as computed in place on that input, so that CallTIRRewrite reuses the
+ * input tensor instead of allocating the output.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass InplaceCallTIR();
+
 /*!
  * \brief Transform Relax IR to normal form: transform AST to A-normal form, and fill the
  * checked_type_ and shape_ of expressions.
@@ -114,6 +124,9 @@ TVM_DLL Pass Normalize();
  * \brief Apply the best schedule from tuning database.
  *
  * \return The Pass.
+ *
+ * \note The kernels which have no record in \p database are looked up in the Relax tuning
+ * database of the pass context, if any, and replaced by the replay of their best tuning record.
  */
 TVM_DLL Pass MetaScheduleApplyHistoryBest(const tvm::meta_schedule::Database& database,
                                           Target target);
@@ -128,10 +141,45 @@ TVM_DLL Pass MetaScheduleApplyHistoryBest(const tvm::meta_schedule::Database& da
  */
 TVM_DLL Pass BindParams(String name, Map<String, runtime::NDArray> params);
 
+/*!
+ * \brief Bind params of function of the module to constant tensors stored in a file, without
+ *  reading the file into memory. The file holds the map from param name to tensor in the binary
+ *  format (see SaveBinaryToFile) and is memory mapped, so that the constants are views of the
+ *  mapping and a tensor is only read from disk when a pass, e.g. FoldConstant, reads its data or
+ *  when the executable is saved.
+ *
+ * \param func_name The name of the function to bind parameters.
+ * \param path The path of the param file.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass BindParamsFromFile(String func_name, String path);
+
+/*!
+ * \brief Specialize a function for the buckets of a symbolic dimension. The function is
+ * replaced by a dispatcher that pads the inputs to the smallest bucket the dimension fits in,
+ * calls the static-shape variant of the bucket and slices the outputs back to the dimension.
+ * Inputs beyond the largest bucket call the original function.
+ *
+ * \param func_name The name of the function to specialize.
+ * \param dim_name The name of the symbolic dimension in the parameter shapes.
+ * \param buckets The extents the dimension is specialized to.
+ *
+ * \return The Pass.
+ *
+ * \note The entries padded along the dimension are zeros, so the function must compute each
+ * entry of the outputs along it independently of the others, e.g. as for a batch dimension.
+ */
+TVM_DLL Pass BucketSymbolicDim(String func_name, String dim_name, Array<Integer> buckets);
+
 /*!
  * \brief Fold constant expressions.
  *
  * \return The Pass.
+ *
+ * \note When the pass config "relax.FoldConstant.cache_dir" names a directory, the folded tensors
+ * are cached there, keyed by the structural hash of the PrimFunc and a hash of the contents of
+ * its inputs, so that recompiling a model with the same parameters skips the evaluation.
  */
 TVM_DLL Pass FoldConstant();
 
@@ -154,6 +202,11 @@ TVM_DLL Pass AnnotateTIROpPattern();
  * \param fuse_opt_level The level of fuse optimization.
  *        -1 indicates that the level will be inferred from pass context.
  * \return The Pass.
+ *
+ * \note Unless the pass config "relax.FuseOps.fuse_reduction_chains" is false, a reduction is
+ * fused with the elementwise and broadcast ops and the further reductions which consume it, so a
+ * chain such as a softmax becomes one group, and an injective op such as a gather is fused into
+ * the reduction which consumes it, e.g. the lookup of an embedding bag into its pooling.
  */
 TVM_DLL Pass FuseOps(int fuse_opt_level = -1);
 
@@ -162,9 +215,143 @@ TVM_DLL Pass FuseOps(int fuse_opt_level = -1);
     this pass works together with FuseOps to perform operator fusion.
 
  * \return The Pass.
+ *
+ * \note Unless the pass config "relax.FuseTIR.localize_reduction_chains" is false, the blocks of
+ * a fused function with several reductions are computed at the outer loop of its last block, so
+ * that the intermediate buffers hold a single row.
  */
 TVM_DLL Pass FuseTIR();
 
+/*!
+ * \brief Run the compute-bound kernels, e.g. dense, matmul or conv, on float16 or bfloat16
+ * inputs. The kernels cast the loaded elements back to float32, so they accumulate and write
+ * float32 as before. The constant inputs are converted ahead of time, which halves the size of
+ * the weights, and the other inputs are cast by an emitted kernel.
+ *
+ * \param dtype The low precision type, "float16" or "bfloat16".
+ * \param policy The map from kernel names to "always" or "never" converting them. A kernel
+ * not in the map is converted iff its op pattern is kOutEWiseFusable, so the numerically
+ * sensitive kernels like reductions and softmax stay in float32.
+ * \return The Pass.
+ */
+TVM_DLL Pass ToMixedPrecision(String dtype, Map<String, String> policy);
+
+/*!
+ * \brief Store the constant 2-D float32 weights of the compute-bound kernels, e.g. dense or
+ * matmul, as int8 values, or int4 values packed in pairs along the last axis, and the float32
+ * scales of their output channels. The calls use a copy of the kernel which dequantizes the
+ * elements of the weight as it loads them, so only the quantized weight is read from memory.
+ *
+ * \param bits The number of bits of the quantized values, 8 or 4.
+ * \param group_size The number of rows of the reduction axis sharing a scale in a channel,
+ * 0 for one scale per channel.
+ * \param fcalibrate The function choosing the group size of each weight instead, it is called
+ * with the kernel name, the weight and its reduction axis and returns the group size, or -1 to
+ * keep the weight in float32.
+ * \return The Pass.
+ */
+TVM_DLL Pass QuantizeWeights(int bits, int group_size, Optional<runtime::PackedFunc> fcalibrate);
+
+/*!
+ * \brief Move the weight layout rewrite blocks of the kernels scheduled with RewriteLayout, as
+ * in RemoveWeightLayoutRewriteBlock, into kernels of their own called before the kernels, so that
+ * FoldConstant rewrites the layout of the constant weights at build time instead of every call.
+ * MetaScheduleApplyHistoryBest runs this pass on the kernels it schedules.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass SplitLayoutRewritePreproc();
+
+/*!
+ * \brief Fuse the independent call_tirs of the same kernel in a dataflow block, e.g. the
+ * projections of the heads of an attention or parallel branches, into one call_tir of a kernel
+ * whose outer loop runs one of the calls per iteration. Binding that loop to a thread axis
+ * launches the calls at once.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass HorizontalFusion();
+
+/*!
+ * \brief Bound the activation memory of every dataflow block by recomputing intermediate tensors
+ * instead of keeping them live. While the tensors of a block live at a binding exceed the budget,
+ * a tensor live across that binding and computed by an elementwise, broadcast or injective
+ * kernel, per the op pattern of the kernel, is recomputed right before its next use.
+ *
+ * \param memory_budget The maximal number of bytes of the tensors of static shape defined in a
+ * block which are live at once.
+ * \return The Pass.
+ *
+ * \note The recomputed bindings whose tensor is no longer used are left to DeadCodeElimination.
+ */
+TVM_DLL Pass Rematerialize(int64_t memory_budget);
+
+/*!
+ * \brief Group the bindings of every dataflow block matched by a pattern into a function with the
+ * attribute Composite=<pattern name>, and replace them with a call to it. The patterns are tried
+ * in order, against the bindings from the last one up, so earlier and longer patterns win.
+ *
+ * \param pattern_names The names of the patterns, e.g. "relax.conv2d_relu".
+ * \param patterns The patterns, matched by the dataflow pattern matcher.
+ * \param codegen When defined, each composite function is inlined into a function with the
+ * attributes Codegen=<codegen> and a global symbol, offloaded to the codegen by RunCodegen.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass FuseOpsByPattern(Array<runtime::String> pattern_names, Array<DFPattern> patterns,
+                              Optional<runtime::String> codegen);
+
+/*!
+ * \brief Offload the bindings of every dataflow block matched by the patterns of the codegens, or
+ * keep them with TVM, so that the estimated latency of the block is minimal, after the Collage
+ * search of Relay. Every match and every binding alone is measured running with its codegen and
+ * with TVM, and the cheapest covering of the block by non-overlapping candidates is offloaded like
+ * FuseOpsByPattern does.
+ *
+ * \param pattern_names The names of the patterns, e.g. "cublas.matmul_bias".
+ * \param patterns The patterns, matched by the dataflow pattern matcher.
+ * \param codegens The codegen offloading the matches of each pattern.
+ * \param estimate_latency The latency in seconds of the main function of a module holding the
+ * bindings of one candidate, the estimates are cached by the structure of the modules.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass CollagePartition(Array<runtime::String> pattern_names, Array<DFPattern> patterns,
+                              Array<runtime::String> codegens,
+                              runtime::TypedPackedFunc<double(IRModule)> estimate_latency);
+
+/*!
+ * \brief Remove the bindings of dataflow blocks whose results contribute to no output of the
+ * block. Dataflow blocks are side-effect free, so the removal does not change the semantics.
+ *
+ * \return The Pass.
+ */
+TVM_DLL Pass DeadCodeElimination();
+
+/*!
+ * \brief Reuse the var of an earlier binding of a dataflow block for the later bindings of a
+ * structurally equal value, e.g. duplicated shape computations or call_tirs on the same inputs.
+ *
+ * \return The Pass.
+ *
+ * \note The duplicate bindings of dataflow vars are dropped, run DeadCodeElimination afterwards
+ * to remove the computations that became unused.
+ */
+TVM_DLL Pass EliminateCommonSubexpr();
+
+/*!
+ * \brief Remove the arithmetic with identity constants, matched by dataflow patterns seeing
+ * through the bindings of the constants: x * 1, 1 * x, x + 0 and 0 + x become x unless the
+ * constant broadcasts x, and ewise_fma becomes an add with a constant 1 factor or a multiply with
+ * a constant 0 addend.
+ *
+ * \return The Pass.
+ *
+ * \note The simplified bindings of dataflow vars are dropped, run DeadCodeElimination afterwards
+ * to remove the constants that became unused.
+ */
+TVM_DLL Pass SimplifyAlgebra();
+
 /*!
  * \brief Remove unused global relax functions in a IRModule.
  * \param entry_functions list of entry functions
@@ -381,6 +381,14 @@ class Database : public runtime::ObjectRef {
    */
   TVM_DLL static Database JSONDatabase(String path_workload, String path_tuning_record,
                                        String path_measurement_record, bool allow_missing);
+  /*!
+   * \brief Create a database storing the records in a compact binary format, in an append-only
+   * log with a persistent hash index on the workload and target. It is opened without decoding the
+   * records, and is safe to share between concurrent tuners on one machine.
+   * \param path The directory of the database.
+   * \param allow_missing Whether to create the database when the given path is not found.
+   */
+  TVM_DLL static Database IndexedDatabase(String path, bool allow_missing);
   TVM_DEFINE_MUTABLE_NOTNULLABLE_OBJECT_REF_METHODS(Database, runtime::ObjectRef, DatabaseNode);
 };
 
@@ -166,6 +166,41 @@ TVM_DLL int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv);
  */
 TVM_DLL int TVMBackendRunOnce(void** handle, int (*f)(void*), void* cdata, int nbytes);
 
+/*!
+ * \brief Pass an item of an anylist as an argument of a packed call, without copying it.
+ *
+ *  An anylist is an array of TVMRetValue, e.g. the register file of a Relax VM function.
+ *
+ * \param anylist The anylist.
+ * \param index The index of the item.
+ * \param args The argument value stack.
+ * \param type_codes The argument type code stack.
+ * \param arg_offset The position of the argument in the stacks.
+ * \return 0 when no error is thrown, -1 when failure happens
+ */
+TVM_DLL int TVMBackendAnyListSetPackedArg(void* anylist, int index, TVMValue* args,
+                                          int* type_codes, int arg_offset);
+
+/*!
+ * \brief Reset an item of an anylist, releasing the value it holds.
+ * \param anylist The anylist.
+ * \param index The index of the item.
+ * \return 0 when no error is thrown, -1 when failure happens
+ */
+TVM_DLL int TVMBackendAnyListResetItem(void* anylist, int index);
+
+/*!
+ * \brief Move the return value of a packed call into an item of an anylist.
+ * \param anylist The anylist.
+ * \param index The index of the item.
+ * \param args The value stack holding the return value.
+ * \param type_codes The type code stack holding the return type code.
+ * \param ret_offset The position of the return value in the stacks.
+ * \return 0 when no error is thrown, -1 when failure happens
+ */
+TVM_DLL int TVMBackendAnyListMoveFromPackedReturn(void* anylist, int index, TVMValue* args,
+                                                  int* type_codes, int ret_offset);
+
 #ifdef __cplusplus
 }  // TVM_EXTERN_C
 #endif
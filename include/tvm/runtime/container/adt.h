@@ -24,6 +24,7 @@
 #ifndef TVM_RUNTIME_CONTAINER_ADT_H_
 #define TVM_RUNTIME_CONTAINER_ADT_H_
 
+#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -139,6 +140,23 @@ class ADT : public ObjectRef {
     return ADT(0, std::forward<Args>(args)...);
   }
 
+  /*!
+   * \brief Construct a tuple object allocated from the thread-local object pool, for the tuples
+   *  created on the hot paths, e.g. on every call of a function.
+   *
+   * \param begin The begin iterator to the start of the fields array.
+   * \param end The end iterator to the end of the fields array.
+   * \return ADT The tuple object reference.
+   */
+  template <typename Iterator>
+  static ADT PooledTuple(Iterator begin, Iterator end) {
+    size_t num_elems = std::distance(begin, end);
+    auto ptr = make_pooled_inplace_array_object<ADTObj, ObjectRef>(num_elems);
+    ptr->tag = 0;
+    ptr->Init(begin, end);
+    return ADT(ObjectPtr<Object>(std::move(ptr)));
+  }
+
   TVM_DEFINE_OBJECT_REF_METHODS(ADT, ObjectRef, ADTObj);
 };
 }  // namespace runtime
@@ -24,6 +24,8 @@
 #ifndef TVM_RUNTIME_CONTAINER_SHAPE_TUPLE_H_
 #define TVM_RUNTIME_CONTAINER_SHAPE_TUPLE_H_
 
+#include <algorithm>
+#include <iterator>
 #include <utility>
 #include <vector>
 
@@ -49,6 +51,8 @@ class ShapeTupleObj : public Object {
  private:
   /*! \brief ShapeTuple object which is moved from std::vector container. */
   class FromStd;
+  /*! \brief ShapeTuple object whose elements follow it in memory. */
+  class Inplace;
 
   friend class ShapeTuple;
 };
@@ -75,6 +79,9 @@ class ShapeTupleObj::FromStd : public ShapeTupleObj {
   friend class ShapeTuple;
 };
 
+/*! \brief An object representing shape tuple whose elements follow the object in memory. */
+class ShapeTupleObj::Inplace : public ShapeTupleObj {};
+
 /*!
  * \brief Reference to shape tuple objects.
  */
@@ -113,6 +120,17 @@ class ShapeTuple : public ObjectRef {
    */
   ShapeTuple(std::vector<index_type> shape);  // NOLINT(*)
 
+  /*!
+   * \brief Construct a shape tuple whose object and elements are one block of the thread-local
+   *  object pool, for the shapes created on the hot paths, e.g. on every call of a function.
+   * \param begin begin of iterator
+   * \param end end of iterator
+   * \tparam IterType The type of iterator
+   * \return The shape tuple.
+   */
+  template <typename IterType>
+  static ShapeTuple Pooled(IterType begin, IterType end);
+
   /*!
    * \brief Return the data pointer
    *
@@ -170,6 +188,16 @@ inline ShapeTuple::ShapeTuple(std::vector<index_type> shape) {
   data_ = std::move(ptr);
 }
 
+template <typename IterType>
+inline ShapeTuple ShapeTuple::Pooled(IterType begin, IterType end) {
+  size_t size = std::distance(begin, end);
+  auto ptr = make_pooled_inplace_array_object<ShapeTupleObj::Inplace, index_type>(size);
+  ptr->size = size;
+  ptr->data = reinterpret_cast<index_type*>(ptr.get() + 1);
+  std::copy(begin, end, ptr->data);
+  return ShapeTuple(ObjectPtr<Object>(std::move(ptr)));
+}
+
 }  // namespace runtime
 
 // expose the functions to the root namespace.
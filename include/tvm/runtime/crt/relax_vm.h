@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file relax_vm.h
+ * \brief A minimal interpreter of the Relax VM executables for the CRT.
+ *
+ * The executable, exported by `Executable.export_crt` in the flat format of relax_vm_format.h,
+ * is read in place. The storages of the tensors are statically planned at export time, and
+ * allocated once with the registers when the VM is created, so running a function allocates
+ * no memory. The supported executables have static shapes, control flow and calls among
+ * the Relax functions, and call the kernels of the given module.
+ */
+#ifndef TVM_RUNTIME_CRT_RELAX_VM_H_
+#define TVM_RUNTIME_CRT_RELAX_VM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <dlpack/dlpack.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/crt/relax_vm_format.h>
+
+/*! \brief The type code of the shape values, which point to their TVMRelaxVMConstant. */
+#define kTVMRelaxVMShape kTVMExtBegin
+
+/*! \brief The kinds of the called functions. */
+typedef enum {
+  kTVMRelaxVMCallKernel = 0,
+  kTVMRelaxVMCallFunction = 1,
+  kTVMRelaxVMCallAllocStorage = 2,
+  kTVMRelaxVMCallAllocTensor = 3,
+  kTVMRelaxVMCallAllocStorageAndTensor = 4,
+  kTVMRelaxVMCallAllocOutputTensor = 5,
+  kTVMRelaxVMCallReadIfCond = 6,
+  kTVMRelaxVMCallCopy = 7,
+} TVMRelaxVMCallKind;
+
+/*! \brief A function called by the instructions. */
+typedef struct TVMRelaxVMCallee {
+  /*! \brief The TVMRelaxVMCallKind of the function. */
+  int kind;
+  /*! \brief The index of a Relax function. */
+  int64_t function_index;
+  /*! \brief The handle of a kernel. */
+  TVMFunctionHandle kernel;
+} TVMRelaxVMCallee;
+
+typedef struct TVMRelaxVM {
+  /*! \brief The executable. */
+  const uint8_t* exec;
+  /*! \brief The header of the executable. */
+  const TVMRelaxVMHeader* header;
+  /*! \brief The module of the kernels. */
+  TVMModuleHandle module_handle;
+  /*! \brief The device of the storages, only supports device type kDLCPU, index 0. */
+  DLDevice device;
+  /*! \brief The function called for each function name. */
+  TVMRelaxVMCallee* callees;
+  /*! \brief The tensors of the NDArray constants, by constant index. */
+  DLTensor* constant_tensors;
+  /*! \brief The tensors, by tensor index. */
+  DLTensor* tensors;
+  /*! \brief The start of the storages, aligned to TVM_RELAX_VM_CRT_ALIGNMENT. */
+  uint8_t* storage;
+  /*! \brief The allocation holding the storages. */
+  void* storage_alloc;
+  /*!
+   * \brief The values of the registers of the active frames, which hold the registers of
+   *  TVM_CRT_RELAX_VM_MAX_CALL_DEPTH frames of the largest function.
+   */
+  TVMValue* reg_values;
+  /*! \brief The type codes of the registers of the active frames. */
+  int* reg_tcodes;
+  /*! \brief The number of registers. */
+  int64_t num_registers;
+  /*! \brief The first register free for the next frame. */
+  int64_t reg_top;
+} TVMRelaxVM;
+
+/*!
+ * \brief Allocate a new Relax VM with TVMPlatformMemoryAllocate and initialize it.
+ *
+ * \param module_handle TVM Module that exposes the kernels to call.
+ * \param exec The executable, 8-byte aligned, which must outlive the VM.
+ * \param device Runtime execution device, only supports device type kDLCPU, index 0.
+ * \param vm Pointer which receives a pointer to the newly-created instance.
+ * \return 0 if successful.
+ */
+int TVMRelaxVM_Create(TVMModuleHandle module_handle, const uint8_t* exec, const DLDevice device,
+                      TVMRelaxVM** vm);
+
+/*!
+ * \brief Release the Relax VM created by TVMRelaxVM_Create().
+ *
+ * \param vm Pointer to VM instance, created by TVMRelaxVM_Create().
+ * \return 0 if successful.
+ */
+int TVMRelaxVM_Release(TVMRelaxVM* vm);
+
+/*!
+ * \brief Return the index of a Relax function.
+ *
+ * \param vm Pointer to VM instance, created by TVMRelaxVM_Create().
+ * \param name The function name.
+ * \return The function index, or -1 if not found.
+ */
+int64_t TVMRelaxVM_GetFunctionIndex(TVMRelaxVM* vm, const char* name);
+
+/*!
+ * \brief Invoke a Relax function.
+ *
+ * \param vm Pointer to VM instance, created by TVMRelaxVM_Create().
+ * \param function_index The index of the function, from TVMRelaxVM_GetFunctionIndex().
+ * \param args The argument values, e.g. DLTensor handles.
+ * \param tcodes The argument type codes.
+ * \param num_args The number of arguments.
+ * \param ret The return value. A returned tensor lives in the storage of the VM and is
+ *  overwritten by the next invocation.
+ * \param ret_tcode The type code of the return value.
+ * \return 0 if successful.
+ */
+int TVMRelaxVM_Invoke(TVMRelaxVM* vm, int64_t function_index, const TVMValue* args,
+                      const int* tcodes, int num_args, TVMValue* ret, int* ret_tcode);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TVM_RUNTIME_CRT_RELAX_VM_H_
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file relax_vm_format.h
+ * \brief The flat format of the Relax VM executables run by the CRT.
+ *
+ * The format is read in place, e.g. from flash, so that loading an executable copies nothing.
+ * It starts with a TVMRelaxVMHeader, and every section is 8-byte aligned at the byte offset
+ * recorded in the header from the start of the executable. The instructions keep the encoding
+ * of the Relax VM bytecode.
+ */
+#ifndef TVM_RUNTIME_CRT_RELAX_VM_FORMAT_H_
+#define TVM_RUNTIME_CRT_RELAX_VM_FORMAT_H_
+
+#include <dlpack/dlpack.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! \brief The magic number of the format, "RXVM" in little endian. */
+#define TVM_RELAX_VM_CRT_MAGIC 0x4D565852U
+
+/*! \brief The version of the format. */
+#define TVM_RELAX_VM_CRT_VERSION 1U
+
+/*! \brief The alignment of the storages and of the NDArray constant data in bytes. */
+#define TVM_RELAX_VM_CRT_ALIGNMENT 128U
+
+/*! \brief The kinds of the constants. */
+typedef enum {
+  kTVMRelaxVMConstInt = 0,
+  kTVMRelaxVMConstFloat = 1,
+  kTVMRelaxVMConstDataType = 2,
+  kTVMRelaxVMConstShape = 3,
+  kTVMRelaxVMConstString = 4,
+  kTVMRelaxVMConstNDArray = 5,
+} TVMRelaxVMConstKind;
+
+/*! \brief The header of an executable. */
+typedef struct TVMRelaxVMHeader {
+  /*! \brief TVM_RELAX_VM_CRT_MAGIC. */
+  uint32_t magic;
+  /*! \brief TVM_RELAX_VM_CRT_VERSION. */
+  uint32_t version;
+  /*! \brief The number of Relax functions. */
+  uint32_t num_functions;
+  /*! \brief The number of names of the called functions, kernels, builtins or Relax functions. */
+  uint32_t num_func_names;
+  /*! \brief The number of constants. */
+  uint32_t num_constants;
+  /*! \brief The number of instructions. */
+  uint32_t num_instrs;
+  /*! \brief The number of storages, one per storage allocating instruction. */
+  uint32_t num_storages;
+  /*! \brief The number of tensors, one per tensor allocating instruction. */
+  uint32_t num_tensors;
+  /*! \brief The largest register file of the functions. */
+  uint32_t max_num_registers;
+  /*! \brief Reserved, 0. */
+  uint32_t reserved;
+  /*! \brief The total size of the storages in bytes, including their alignment. */
+  uint64_t storage_bytes;
+  /*! \brief The offset of the TVMRelaxVMFunction array. */
+  uint64_t functions_offset;
+  /*! \brief The offset of the uint64_t offsets of the NUL-terminated function names. */
+  uint64_t func_names_offset;
+  /*! \brief The offset of the TVMRelaxVMConstant array. */
+  uint64_t constants_offset;
+  /*! \brief The offset of the int64_t word offset of each instruction in the code. */
+  uint64_t instr_offsets_offset;
+  /*!
+   * \brief The offset of the int32_t storage index and tensor index of each instruction, -1
+   *  for the instructions that allocate none.
+   */
+  uint64_t slots_offset;
+  /*! \brief The offset of the uint64_t byte offset of each storage in the storage memory. */
+  uint64_t storage_offsets_offset;
+  /*! \brief The offset of the int64_t words of the instructions. */
+  uint64_t code_offset;
+} TVMRelaxVMHeader;
+
+/*! \brief A Relax function. */
+typedef struct TVMRelaxVMFunction {
+  /*! \brief The offset of the NUL-terminated name. */
+  uint64_t name_offset;
+  /*! \brief The index of the first instruction. */
+  int64_t start_instr;
+  /*! \brief The number of arguments. */
+  int64_t num_args;
+  /*! \brief The number of registers. */
+  int64_t register_file_size;
+} TVMRelaxVMFunction;
+
+/*! \brief A constant. */
+typedef struct TVMRelaxVMConstant {
+  /*! \brief The TVMRelaxVMConstKind of the constant. */
+  uint32_t kind;
+  /*! \brief The number of dimensions of a shape or an NDArray. */
+  uint32_t ndim;
+  /*! \brief The value of a data type, or the dtype of an NDArray. */
+  DLDataType dtype;
+  /*! \brief Reserved, 0. */
+  uint32_t reserved;
+  /*!
+   * \brief The value of an integer or a float, or the offset of the int64_t dims of a shape or
+   *  an NDArray, or of the NUL-terminated string.
+   */
+  union {
+    int64_t v_int64;
+    double v_float64;
+    uint64_t offset;
+  } value;
+  /*! \brief The offset of the data of an NDArray, aligned to TVM_RELAX_VM_CRT_ALIGNMENT. */
+  uint64_t data_offset;
+} TVMRelaxVMConstant;
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // TVM_RUNTIME_CRT_RELAX_VM_FORMAT_H_
@@ -25,7 +25,9 @@
 
 #include <tvm/runtime/object.h>
 
+#include <cstddef>
 #include <cstdlib>
+#include <new>
 #include <type_traits>
 #include <utility>
 
@@ -40,6 +42,15 @@ namespace runtime {
 template <typename T, typename... Args>
 inline ObjectPtr<T> make_object(Args&&... args);
 
+/*!
+ * \brief Allocate an object using the thread-local object pool, see PoolObjAllocator.
+ * \param args arguments to the constructor.
+ * \tparam T the node type.
+ * \return The ObjectPtr to the allocated object.
+ */
+template <typename T, typename... Args>
+inline ObjectPtr<T> make_pooled_object(Args&&... args);
+
 // Detail implementations after this
 //
 // The current design allows swapping the
@@ -47,7 +58,6 @@ inline ObjectPtr<T> make_object(Args&&... args);
 //
 // Possible future allocator optimizations:
 // - Arena allocator that gives ownership of memory to arena (deleter_= nullptr)
-// - Thread-local object pools: one pool per size and alignment requirement.
 // - Can specialize by type of object to give the specific allocator to each object.
 
 /*!
@@ -191,17 +201,183 @@ class SimpleObjAllocator : public ObjAllocatorBase<SimpleObjAllocator> {
   };
 };
 
+/*!
+ * \brief Allocator recycling the memory of small objects through thread-local free lists, one per
+ *  size class of kSizeClassBytes up to kMaxPooledBytes, to take malloc off the paths creating
+ *  many short-lived objects, e.g. the shapes, storages, tuples and closures created on every call
+ *  of a Relax VM function.
+ *
+ *  A block freed on another thread than the one it is allocated on joins the free lists of the
+ *  freeing thread. Each free list keeps at most kMaxCachedBlocks blocks, which are released when
+ *  the thread exits. The larger objects use new/delete.
+ */
+class PoolObjAllocator : public ObjAllocatorBase<PoolObjAllocator> {
+ public:
+  /*! \brief The granularity of the size classes. */
+  static constexpr size_t kSizeClassBytes = 16;
+  /*! \brief The size of the largest pooled block. */
+  static constexpr size_t kMaxPooledBytes = 256;
+  /*! \brief The maximal number of free blocks kept by each size class of a thread. */
+  static constexpr size_t kMaxCachedBlocks = 1024;
+
+  /*! \brief Allocate a block of at least \p size bytes aligned as std::max_align_t. */
+  static void* Alloc(size_t size) {
+    ThreadPool* pool = GetThreadPool();
+    if (size > kMaxPooledBytes || pool == nullptr) return ::operator new(size);
+    size_t cls = SizeClass(size);
+    FreeBlock* block = pool->heads[cls];
+    if (block == nullptr) return ::operator new((cls + 1) * kSizeClassBytes);
+    pool->heads[cls] = block->next;
+    --pool->counts[cls];
+    return block;
+  }
+
+  /*! \brief Free a block allocated by Alloc(\p size). */
+  static void Free(void* ptr, size_t size) {
+    ThreadPool* pool = GetThreadPool();
+    if (size > kMaxPooledBytes || pool == nullptr) {
+      ::operator delete(ptr);
+      return;
+    }
+    size_t cls = SizeClass(size);
+    if (pool->counts[cls] == kMaxCachedBlocks) {
+      ::operator delete(ptr);
+      return;
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = pool->heads[cls];
+    pool->heads[cls] = block;
+    ++pool->counts[cls];
+  }
+
+  template <typename T>
+  class Handler {
+   public:
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned objects are not pooled");
+
+    template <typename... Args>
+    static T* New(PoolObjAllocator*, Args&&... args) {
+      void* data = Alloc(sizeof(T));
+      new (data) T(std::forward<Args>(args)...);
+      return static_cast<T*>(data);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static void Deleter_(Object* objptr) {
+      T* tptr = static_cast<T*>(objptr);
+      tptr->T::~T();
+      Free(tptr, sizeof(T));
+    }
+  };
+
+  // The size of an array object is kept in a header before the object, as the deleter does not
+  // know the number of elements.
+  template <typename ArrayType, typename ElemType>
+  class ArrayHandler {
+   public:
+    static_assert(alignof(ArrayType) <= alignof(std::max_align_t),
+                  "over-aligned objects are not pooled");
+    static_assert(alignof(ArrayType) % alignof(ElemType) == 0 &&
+                      sizeof(ArrayType) % alignof(ElemType) == 0,
+                  "element alignment constraint");
+
+    template <typename... Args>
+    static ArrayType* New(PoolObjAllocator*, size_t num_elems, Args&&... args) {
+      size_t size = kHeaderBytes + sizeof(ArrayType) + num_elems * sizeof(ElemType);
+      char* data = static_cast<char*>(Alloc(size));
+      *reinterpret_cast<size_t*>(data) = size;
+      new (data + kHeaderBytes) ArrayType(std::forward<Args>(args)...);
+      return reinterpret_cast<ArrayType*>(data + kHeaderBytes);
+    }
+
+    static Object::FDeleter Deleter() { return Deleter_; }
+
+   private:
+    static constexpr size_t kHeaderBytes = alignof(std::max_align_t);
+
+    static void Deleter_(Object* objptr) {
+      ArrayType* tptr = static_cast<ArrayType*>(objptr);
+      tptr->ArrayType::~ArrayType();
+      char* data = reinterpret_cast<char*>(tptr) - kHeaderBytes;
+      Free(data, *reinterpret_cast<size_t*>(data));
+    }
+  };
+
+ private:
+  /*! \brief A block in a free list. */
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  /*! \brief The free lists of a thread. */
+  struct ThreadPool {
+    FreeBlock* heads[kMaxPooledBytes / kSizeClassBytes] = {};
+    size_t counts[kMaxPooledBytes / kSizeClassBytes] = {};
+
+    ~ThreadPool() {
+      // The objects freed later on the exiting thread, e.g. by the destructors of other
+      // thread-local or static variables, are released to the system directly.
+      ThreadPoolDestroyed() = true;
+      for (FreeBlock* block : heads) {
+        while (block != nullptr) {
+          FreeBlock* next = block->next;
+          ::operator delete(block);
+          block = next;
+        }
+      }
+    }
+  };
+
+  static size_t SizeClass(size_t size) {
+    return size == 0 ? 0 : (size + kSizeClassBytes - 1) / kSizeClassBytes - 1;
+  }
+
+  static bool& ThreadPoolDestroyed() {
+    static thread_local bool destroyed = false;
+    return destroyed;
+  }
+
+  /*! \return The free lists of the current thread, nullptr once they are destroyed. */
+  static ThreadPool* GetThreadPool() {
+    if (ThreadPoolDestroyed()) return nullptr;
+    static thread_local ThreadPool pool;
+    return &pool;
+  }
+};
+
 template <typename T, typename... Args>
 inline ObjectPtr<T> make_object(Args&&... args) {
   return SimpleObjAllocator().make_object<T>(std::forward<Args>(args)...);
 }
 
+template <typename T, typename... Args>
+inline ObjectPtr<T> make_pooled_object(Args&&... args) {
+  return PoolObjAllocator().make_object<T>(std::forward<Args>(args)...);
+}
+
 template <typename ArrayType, typename ElemType, typename... Args>
 inline ObjectPtr<ArrayType> make_inplace_array_object(size_t num_elems, Args&&... args) {
   return SimpleObjAllocator().make_inplace_array<ArrayType, ElemType>(num_elems,
                                                                       std::forward<Args>(args)...);
 }
 
+/*!
+ * \brief Allocate an inplace array object using the thread-local object pool, see
+ *  PoolObjAllocator.
+ * \param num_elems The number of array elements.
+ * \param args arguments to the constructor.
+ * \tparam ArrayType The type to be allocated.
+ * \tparam ElemType The type of array element.
+ * \return The ObjectPtr to the allocated array.
+ */
+template <typename ArrayType, typename ElemType, typename... Args>
+inline ObjectPtr<ArrayType> make_pooled_inplace_array_object(size_t num_elems, Args&&... args) {
+  return PoolObjAllocator().make_inplace_array<ArrayType, ElemType>(num_elems,
+                                                                    std::forward<Args>(args)...);
+}
+
 }  // namespace runtime
 }  // namespace tvm
 #endif  // TVM_RUNTIME_MEMORY_H_
@@ -261,6 +261,11 @@ constexpr const char* tvm_set_device = "__tvm_set_device";
 constexpr const char* tvm_global_barrier_state = "__tvm_global_barrier_state";
 /*! \brief Prepare the global barrier before kernels that uses global barrier. */
 constexpr const char* tvm_prepare_global_barrier = "__tvm_prepare_global_barrier";
+/*!
+ * \brief The table of the packed functions of a shared library, a TVMFuncRegistry of the C runtime,
+ *  so that loading the library resolves its functions without a symbol lookup each.
+ */
+constexpr const char* tvm_func_registry = "__tvm_func_registry";
 /*! \brief Placeholder for the module's entry function. */
 constexpr const char* tvm_module_main = "__tvm_main__";
 /*! \brief Prefix for parameter symbols emitted into the main program. */
@@ -52,6 +52,10 @@ constexpr DLDeviceType kInvalidDeviceType = static_cast<DLDeviceType>(-1);
 
 namespace runtime {
 
+namespace relax_vm {
+class Allocator;
+}  // namespace relax_vm
+
 /*!
  * \brief Managed NDArray.
  *  The array is backed by reference counted blocks.
@@ -155,6 +159,17 @@ class NDArray : public ObjectRef {
    */
   TVM_DLL static NDArray Empty(ShapeTuple shape, DLDataType dtype, Device dev,
                                Optional<String> mem_scope = NullOpt);
+  /*!
+   * \brief Create an empty NDArray from an allocator of the Relax VM, e.g. to share the pooled
+   *  memory of the VM. The allocator must outlive the array.
+   * \param shape The shape of the new array.
+   * \param dtype The data type of the new array.
+   * \param dev The device of the array.
+   * \param allocator The allocator of the device, the device API is used when it is null.
+   * \return The created Array
+   */
+  TVM_DLL static NDArray Empty(ShapeTuple shape, DLDataType dtype, Device dev,
+                               relax_vm::Allocator* allocator);
   /*!
    * \brief Create a NDArray backed by an external DLTensor without memory copying.
    *
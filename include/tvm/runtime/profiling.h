@@ -251,6 +251,14 @@ class ReportNode : public Object {
    * \endcode
    */
   String AsJSON() const;
+  /*! \brief Convert the calls of this report to a timeline in the Chrome trace event format,
+   *  which chrome://tracing and Perfetto load.
+   *
+   * The calls of each device are laid out one after another on a track of the device, in the
+   * order they were made, as the report records the durations of the calls but not when they
+   * started. The metrics of a call other than its name and duration are its arguments.
+   */
+  String AsChromeTrace() const;
 
   static constexpr const char* _type_key = "runtime.profiling.Report";
   TVM_DECLARE_FINAL_OBJECT_INFO(ReportNode, Object);
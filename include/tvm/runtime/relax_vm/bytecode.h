@@ -58,6 +58,9 @@ enum class Opcode {
   Ret = 2U,
   Goto = 3U,
   If = 4U,
+  KillRegister = 5U,
+  Move = 6U,
+  TailCall = 7U,
 };
 
 /*! \brief A single virtual machine instruction.
@@ -117,10 +120,10 @@ struct Instruction {
   };
   /*! \brief The instruction opcode. */
   Opcode op;
-  /*! \brief The destination register. */
+  /*! \brief The destination register, or the register to free for KillRegister. */
   RegName dst;
   union {
-    struct /* Call */ {
+    struct /* Call, TailCall */ {
       /*! \brief The index into the packed function table. */
       Index func_idx;
       /*! \brief The number of arguments to the packed function. */
@@ -142,6 +145,10 @@ struct Instruction {
       /*! \brief The program counter offset for the false branch. */
       Index false_offset;
     };
+    struct /* Move */ {
+      /*! \brief The raw data of the source argument. */
+      ExecWord src;
+    };
   };
   /*!
    * \brief Construct a Call instruction.
@@ -171,6 +178,32 @@ struct Instruction {
    * \return The If instruction.
    */
   static Instruction If(RegName cond, Index false_offset);
+  /*!
+   * \brief Construct a KillRegister instruction, which releases the value held by a register
+   *  that has no later use so that its storage can be reclaimed early.
+   * \param reg The register to be released.
+   * \return The KillRegister instruction.
+   */
+  static Instruction KillRegister(RegName reg);
+  /*!
+   * \brief Construct a Move instruction, which copies a register, immediate or constant
+   *  into the destination register without going through a PackedFunc.
+   * \param src The source argument.
+   * \param dst The destination register.
+   * \return The Move instruction.
+   */
+  static Instruction Move(Arg src, RegName dst);
+  /*!
+   * \brief Construct a TailCall instruction, which calls a function and returns its result.
+   *  A bytecode function is run in the frame of the caller, so that recursive calls in tail
+   *  position take no extra frame.
+   * \param func_idx The index of the function to call.
+   * \param num_args The number of arguments.
+   * \param args The input arguments.
+   * \return The tail call instruction.
+   * \note The instruction is laid out as a Call whose destination is void.
+   */
+  static Instruction TailCall(Index func_idx, Index num_args, Arg* args);
 };
 
 }  // namespace relax_vm
@@ -27,6 +27,8 @@
 #include <tvm/runtime/object.h>
 #include <tvm/runtime/registry.h>
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,6 +36,9 @@
 #include "./bytecode.h"
 
 namespace tvm {
+namespace support {
+class MappedFile;
+}  // namespace support
 namespace runtime {
 namespace relax_vm {
 
@@ -49,6 +54,11 @@ class VMClosureObj : public ClosureObj {
   String func_name;
   /*! \brief The free variables of the closure. */
   Array<ObjectRef> free_vars;
+  /*!
+   * \brief The index of the function in the global function table of the executable that
+   *  allocated the closure, -1 if it is not resolved.
+   */
+  Index func_idx{-1};
 
   static constexpr const uint32_t _type_index = TypeIndex::kDynamic;
   static constexpr const char* _type_key = "relax.vm.Closure";
@@ -58,10 +68,24 @@ class VMClosureObj : public ClosureObj {
 /*! \brief reference to closure. */
 class VMClosure : public Closure {
  public:
-  VMClosure(String func_name, Array<ObjectRef> free_vars);
+  VMClosure(String func_name, Array<ObjectRef> free_vars, Index func_idx = -1);
   TVM_DEFINE_OBJECT_REF_METHODS(VMClosure, Closure, VMClosureObj);
 };
 
+/*! \brief The way a Relax function is executed by the VM. */
+enum class VMFuncKind : int {
+  /*! \brief The function is interpreted from the VM instructions. */
+  kVMFunc = 0,
+  /*!
+   * \brief The function is compiled ahead of time into a host function of the kernel library,
+   *  named with kVMTIRFuncPrefix, which runs on the register file of the VM frame.
+   */
+  kVMTIRFunc = 1,
+};
+
+/*! \brief The name prefix of the compiled host function of a kVMTIRFunc function. */
+constexpr const char* kVMTIRFuncPrefix = "__vmtir__";
+
 /*!
  * \brief A representation of a Relax function in the VM.
  *
@@ -71,11 +95,16 @@ class VMClosure : public Closure {
 struct VMFunction {
   /*! \brief The function's name. */
   std::string name;
+  /*! \brief The way the function is executed. */
+  VMFuncKind kind{VMFuncKind::kVMFunc};
   /*! \brief The start instruction index of the function. */
   Index start_instr;
   /*! \brief The number of arguments of the function. */
   Index num_args;
-  /*! \brief The register file size of the function. */
+  /*!
+   * \brief The register file size of the function.
+   * \note The register right after the parameters holds the return value of a kVMTIRFunc.
+   */
   Index register_file_size;
   /*! \brief The function parameter names.*/
   std::vector<std::string> param_names;
@@ -102,6 +131,14 @@ class Executable : public runtime::ModuleNode {
    * \return The statistics represented by a string.
    */
   std::string Stats() const;
+  /*!
+   * \brief Get the statistics of the executable in a machine-readable form.
+   * \return A JSON object holding the number of instructions and the register file size of
+   *  each function, the bytes of NDArray constants on each device, the number of unique packed
+   *  functions and the estimated peak storage in bytes, i.e. the largest storage statically
+   *  allocated by a function. Storage sized at runtime is not estimated but counted.
+   */
+  std::string StatsJSON() const;
   /*!
    * \brief Get the i-th instruction from the executable.
    * \param i The index of the instruction to be fetched.
@@ -146,8 +183,42 @@ class Executable : public runtime::ModuleNode {
    * \brief Load Executable from the file.
    * \param file_name The path of the file that load the executable from.
    * \return The loaded executable, in the form of a `runtime::Module`.
+   * \note The file is memory-mapped when the platform supports it, and NDArray constants
+   *  whose data is aligned in the file reference the mapping in place instead of being copied.
    */
   static Module LoadFromFile(const std::string& file_name);
+  /*!
+   * \brief Write the Executable and its kernel library to a single bundle file.
+   * \param file_name The name of the bundle file. It is replaced atomically.
+   * \param lib_path The path of the kernel library exported as a shared library to embed, or
+   *  "system_lib" to resolve the kernels from the system library of the loading process, or an
+   *  empty string when the executable has no kernel library.
+   */
+  void SaveBundle(const std::string& file_name, const std::string& lib_path);
+  /*!
+   * \brief Load an Executable and its kernel library from a bundle file.
+   * \param file_name The path of the bundle file.
+   * \return The loaded executable, which imports the kernel library.
+   * \note The file is mapped once, the executable is loaded from the mapping as in LoadFromFile
+   *  and the embedded shared library is opened from memory when the platform supports it.
+   */
+  static Module LoadBundle(const std::string& file_name);
+  /*!
+   * \brief Record the source location of the instructions from the given one on.
+   * \param pc The index of the first instruction at the location.
+   * \param location The source location, e.g. "model.py:12:4", or an empty string when the
+   *  instructions have no known source.
+   * \note The locations must be recorded in the ascending order of pc.
+   */
+  void SetSourceLocation(Index pc, std::string location);
+  /*!
+   * \brief Get the source location of an instruction.
+   * \param pc The index of the instruction.
+   * \return The source location, or an empty string when it is unknown.
+   * \note The debug section of a loaded executable is only parsed on the first call, so that
+   *  loading does not pay for the debug information.
+   */
+  std::string GetSourceLocation(Index pc);
 
   /*! \brief The virtual machine's function table. */
   std::vector<VMFunction> global_funcs;
@@ -181,7 +252,7 @@ class Executable : public runtime::ModuleNode {
    * \brief Save the constant pool.
    * \param strm The input stream.
    */
-  void SaveConstantSection(dmlc::Stream* strm);
+  void SaveConstantSection(dmlc::SeekStream* strm);
   /*!
    * \brief Save the instructions.
    * \param strm The input stream.
@@ -200,8 +271,10 @@ class Executable : public runtime::ModuleNode {
   /*!
    * \brief Load the constant pool.
    * \param strm The input stream.
+   * \param mapped_file The mapped file that strm reads from, or nullptr when it reads from memory.
    */
-  void LoadConstantSection(dmlc::Stream* strm);
+  void LoadConstantSection(dmlc::SeekStream* strm,
+                           const std::shared_ptr<support::MappedFile>& mapped_file);
   /*!
    * \brief Load the instructions.
    * \param strm The input stream.
@@ -212,6 +285,42 @@ class Executable : public runtime::ModuleNode {
    * \param strm The input stream.
    */
   void LoadPackedFuncNames(dmlc::Stream* strm);
+  /*!
+   * \brief Save the source locations as an optional debug section, if there is any.
+   * \param strm The input stream.
+   */
+  void SaveDebugSection(dmlc::Stream* strm);
+  /*!
+   * \brief Load the optional debug section, keeping it serialized until it is needed.
+   * \param strm The input stream.
+   */
+  void LoadDebugSection(dmlc::Stream* strm);
+  /*!
+   * \brief Parse the serialized debug section into the source location table.
+   * \note It must be called with debug_mutex_ held.
+   */
+  void ParseDebugSection();
+  /*!
+   * \brief Load all the sections of a serialized executable.
+   * \param strm The input stream, positioned at the header.
+   * \param mapped_file The mapped file that strm reads from, or nullptr when it reads from memory.
+   * \return The loaded executable.
+   */
+  static ObjectPtr<Executable> LoadSections(
+      dmlc::SeekStream* strm, const std::shared_ptr<support::MappedFile>& mapped_file);
+
+  /*! \brief The distinct source locations of the instructions. */
+  std::vector<std::string> source_locations_;
+  /*! \brief The first instruction of each run of instructions at the same location, ascending. */
+  std::vector<Index> location_pcs_;
+  /*! \brief The index in source_locations_ of each run. */
+  std::vector<Index> location_ids_;
+  /*! \brief The index of each location in source_locations_, used while recording. */
+  std::unordered_map<std::string, Index> location_index_;
+  /*! \brief The serialized debug section which is not parsed yet. */
+  std::string debug_section_;
+  /*! \brief The mutex guarding the lazy parsing of the debug section. */
+  std::mutex debug_mutex_;
 };
 
 }  // namespace relax_vm
@@ -25,11 +25,14 @@
 #define TVM_RUNTIME_RELAX_VM_MEMORY_MANAGER_H_
 
 #include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/container/shape_tuple.h>
 #include <tvm/runtime/ndarray.h>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -44,11 +47,31 @@ struct Buffer {
   size_t size{0};
   /*! \brief The device of the allocated buffers. */
   Device device;
+  /*! \brief The memory scope of the buffer, empty for the flat memory of the global scope. */
+  std::string mem_scope;
+  /*! \brief The shape which the buffer of a non-global memory scope is laid out for. */
+  ShapeTuple shape;
 };
 
 enum AllocatorType {
   kNaive = 1,
   kPooled,
+  kSizeClass,
+  kStreamOrdered,
+};
+
+/*! \brief The memory usage statistics of an allocator. */
+struct AllocatorStats {
+  /*! \brief The bytes handed out by the allocator and not freed yet. */
+  size_t live_bytes{0};
+  /*! \brief The bytes freed by users but kept by the allocator for reuse. */
+  size_t cached_bytes{0};
+  /*! \brief The peak of the bytes held from the device (live and cached). */
+  size_t peak_bytes{0};
+  /*! \brief The number of allocation requests. */
+  size_t num_allocs{0};
+  /*! \brief The number of allocation requests served from the cache. */
+  size_t num_cache_hits{0};
 };
 
 class Allocator {
@@ -71,10 +94,35 @@ class Allocator {
    *  \return A sized allocation in the form of a buffer.
    */
   virtual Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) = 0;
+  /*! \brief Allocate a buffer for a tensor in a memory scope.
+   *  \param dev The device of the buffer.
+   *  \param shape The shape of the tensor.
+   *  \param type_hint The datatype of the tensor.
+   *  \param mem_scope The memory scope, e.g. "global.texture" for the image memory of OpenCL.
+   *  \return The buffer. The global scope gets a flat buffer from the allocator, the other scopes
+   *   get a buffer laid out for the shape by the device API, which is never pooled.
+   */
+  Buffer Alloc(Device dev, ShapeTuple shape, DLDataType type_hint, const std::string& mem_scope);
   /*! \brief Free a buffer allocated by the allocator.
    *  \param buffer The buffer to free.
    */
   virtual void Free(const Buffer& buffer) = 0;
+  /*! \brief Return the memory usage statistics of the allocator. */
+  virtual AllocatorStats Stats() = 0;
+  /*! \brief Return the bytes held from the device for the allocator, live and cached. */
+  virtual size_t HeldBytes() {
+    AllocatorStats stats = Stats();
+    return stats.live_bytes + stats.cached_bytes;
+  }
+  /*! \brief Free the buffers cached for reuse back to the device. */
+  virtual void ReleaseCache() {}
+
+ protected:
+  /*! \brief Free the buffer if it belongs to a non-global memory scope.
+   *  \param buffer The buffer.
+   *  \return Whether the buffer was freed.
+   */
+  static bool FreeScopedBuffer(const Buffer& buffer);
 
  private:
   AllocatorType type_;
@@ -96,13 +144,61 @@ class MemoryManager {
    * \return The memory allocator.
    */
   static Allocator* GetAllocator(Device dev);
+  /*!
+   * \brief Get or create the allocator of a tenant on a device, which holds at most a quota of
+   *  bytes from the device, apart from the allocators of the other tenants.
+   * \param tenant The name of the tenant.
+   * \param dev The TVM device
+   * \param type The type of the allocator wrapped by the quota.
+   * \param quota_bytes The quota, which replaces the quota of an existing allocator.
+   * \param hard Whether an allocation exceeding the quota fails, otherwise it is only logged.
+   * \return The memory allocator.
+   */
+  static Allocator* GetOrCreateTenantAllocator(const std::string& tenant, Device dev,
+                                               AllocatorType type, size_t quota_bytes, bool hard);
+  /*!
+   * \brief Get the allocator of a tenant on a device.
+   * \param tenant The name of the tenant.
+   * \param dev The TVM device
+   * \return The memory allocator.
+   */
+  static Allocator* GetTenantAllocator(const std::string& tenant, Device dev);
 
  private:
   MemoryManager() {}
+  /*!
+   * \brief Create an allocator.
+   * \param dev The TVM device
+   * \param type The allocator type
+   * \return The memory allocator.
+   */
+  static std::unique_ptr<Allocator> CreateAllocator(Device dev, AllocatorType type);
+  /*!
+   * \brief Get the slot of the allocator of a device in the lookup table.
+   * \param dev The TVM device
+   * \return The slot, nullptr if the device is out of the range of the table, e.g. an RPC device.
+   */
+  std::atomic<Allocator*>* TableSlot(Device dev);
+
+  /*! \brief The number of device types in the lookup table, the types below the RPC mask. */
+  static constexpr int kMaxDeviceTypes = 128;
+  /*! \brief The number of device ids per device type in the lookup table. */
+  static constexpr int kMaxDeviceIds = 16;
 
  private:
   std::mutex mutex_;
   std::unordered_map<Device, std::unique_ptr<Allocator>> allocators_;
+  /*!
+   * \brief The allocators of the tenants, never removed since the storages allocated by a VM
+   *  may outlive it.
+   */
+  std::unordered_map<std::string, std::unordered_map<Device, std::unique_ptr<Allocator>>>
+      tenant_allocators_;
+  /*!
+   * \brief The allocators of allocators_ indexed by device type and id, published once created
+   *  and never removed, so that the lookups, e.g. on every free of a storage, take no lock.
+   */
+  std::atomic<Allocator*> table_[kMaxDeviceTypes][kMaxDeviceIds] = {};
 };
 
 /*! \brief An object representing a storage allocation. */
@@ -110,6 +206,8 @@ class StorageObj : public Object {
  public:
   /*! \brief The index into the VM function table. */
   Buffer buffer;
+  /*! \brief The allocator of the buffer, which frees it, looked up by its device if not set. */
+  Allocator* allocator{nullptr};
 
   /*! \brief Allocate an NDArray from a given piece of storage. */
   runtime::NDArray AllocNDArray(uint64_t offset, ShapeTuple shape, DLDataType dtype);
@@ -118,7 +216,8 @@ class StorageObj : public Object {
   static void Deleter(Object* ptr);
 
   ~StorageObj() {
-    auto alloc = MemoryManager::Global()->GetAllocator(buffer.device);
+    Allocator* alloc = allocator;
+    if (alloc == nullptr) alloc = MemoryManager::GetAllocator(buffer.device);
     alloc->Free(buffer);
   }
 
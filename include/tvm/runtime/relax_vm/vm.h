@@ -24,12 +24,16 @@
 #define TVM_RUNTIME_RELAX_VM_VM_H_
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "./bytecode.h"
 #include "./executable.h"
 #include "./memory_manager.h"
+#include "./vm_hooks.h"
 
 namespace tvm {
 namespace runtime {
@@ -61,11 +65,95 @@ struct VMFrame {
   std::vector<TVMValue> call_arg_values;
   /*! \brief Temporary argument tcode stack for packed func call. */
   std::vector<int> call_arg_tcodes;
+  /*!
+   * \brief Temporary argument value stack for the kernel invoked by a builtin,
+   *  e.g. vm.call_tir_dyn, while call_arg_values still holds the builtin's own arguments.
+   */
+  std::vector<TVMValue> kernel_arg_values;
+  /*! \brief Temporary argument tcode stack for the kernel invoked by a builtin. */
+  std::vector<int> kernel_arg_tcodes;
+  /*! \brief Temporary argument stack for a direct call of a VMBuiltin. */
+  std::vector<const RegType*> builtin_args;
+  /*! \brief The storage of the immediate arguments of a direct call of a VMBuiltin. */
+  std::vector<RegType> builtin_imms;
 
   VMFrame(Index pc, Index register_file_size)
       : return_pc(pc), register_file(register_file_size), caller_return_register(0) {}
 };
 
+/*!
+ * \brief A straight-line run of call instructions, grouped into levels such that every
+ *  instruction only depends on instructions of earlier levels.
+ */
+struct ParallelRegion {
+  /*! \brief One level of the region. */
+  struct Level {
+    /*! \brief The instructions touching the state of the VM, run in sequence. */
+    std::vector<Index> serial;
+    /*! \brief The kernel calls, run concurrently after the serial instructions. */
+    std::vector<Index> kernels;
+  };
+  /*! \brief The levels in execution order. */
+  std::vector<Level> levels;
+  /*! \brief The program counter following the region. */
+  Index end_pc;
+};
+
+/*!
+ * \brief The arguments of a VMBuiltin. Each argument refers to its register, constant or
+ *  immediate in place, so nothing is packed or copied for the call.
+ */
+class VMBuiltinArgs {
+ public:
+  VMBuiltinArgs(const RegType* const* values, int num_args)
+      : values_(values), num_args_(num_args) {}
+  /*! \return The number of arguments. */
+  int size() const { return num_args_; }
+  /*! \return The i-th argument. */
+  const RegType& operator[](int i) const { return *values_[i]; }
+
+ private:
+  const RegType* const* values_;
+  int num_args_;
+};
+
+/*!
+ * \brief A builtin called by the VM directly on the arguments of a call instruction, bypassing
+ *  the PackedFunc calling convention. The arguments are the same as the ones of the PackedFunc
+ *  registered under the same name, which remains the entry for every other caller.
+ */
+using VMBuiltin = void (*)(VMBuiltinArgs args, RegType* rv);
+
+/*!
+ * \brief Register the direct-call entry of a VM builtin.
+ * \param name The name of the PackedFunc of the builtin.
+ * \param func The direct-call entry.
+ * \return Whether the builtin is registered.
+ */
+TVM_DLL bool RegisterVMBuiltin(const std::string& name, VMBuiltin func);
+
+/*!
+ * \brief Get the direct-call entry of a VM builtin.
+ * \param name The name of the PackedFunc of the builtin.
+ * \return The entry, nullptr if the builtin has none.
+ */
+TVM_DLL VMBuiltin GetVMBuiltin(const std::string& name);
+
+/*!
+ * \brief Register the direct-call entry of a VM builtin, next to its TVM_REGISTER_GLOBAL.
+ * \param Name The name of the PackedFunc of the builtin.
+ * \param Func The VMBuiltin.
+ */
+#define TVM_REGISTER_VM_BUILTIN(Name, Func)                                        \
+  static TVM_ATTRIBUTE_UNUSED bool TVM_STR_CONCAT(__make_VMBuiltin, __COUNTER__) = \
+      ::tvm::runtime::relax_vm::RegisterVMBuiltin(Name, Func)
+
+class ConstantUploader;
+class KernelCapture;
+class KernelJIT;
+class TraceSink;
+struct FunctionLatencyStats;
+
 /*!
  * \brief The virtual machine.
  *
@@ -76,6 +164,9 @@ struct VMFrame {
  * enabling one to easily pass around VMs, execute them on
  * multiple threads, or serialize them to disk or over the
  * wire.
+ *
+ * A VM runs one invocation at a time, concurrent invocations
+ * should each use a session created by CreateSession.
  */
 class VirtualMachine : public runtime::ModuleNode {
  public:
@@ -107,9 +198,15 @@ class VirtualMachine : public runtime::ModuleNode {
    *   If the function needs resource from the module(e.g. late linking),
    *   it should capture sptr_to_self.
    */
-  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) override;
 
-  ~VirtualMachine() final {}
+  /*!
+   * \brief Constructor.
+   * \note The constructor and the destructor are defined where ConstantUploader is complete.
+   */
+  VirtualMachine();
+
+  ~VirtualMachine() override;
 
   const char* type_key() const final { return "relax.VirtualMachine"; }
 
@@ -119,6 +216,163 @@ class VirtualMachine : public runtime::ModuleNode {
   std::vector<Allocator*> allocators;
   /*! \brief Runtime physical device list. */
   std::vector<Device> devices;
+  /*!
+   * \brief The communicator of this process among the processes of a distributed run, created
+   *  by vm_initialization from the communicator config, undefined in a single process.
+   */
+  ObjectRef ccl_comm;
+
+  /*!
+   * \brief Register the callbacks of the events of the VM, shared by the sessions created
+   *  afterwards.
+   * \param hooks The callbacks, null to unregister them.
+   */
+  void SetHooks(std::shared_ptr<VMHooks> hooks) { hooks_ = std::move(hooks); }
+  /*! \brief The callbacks of the events of the VM, null if none is registered. */
+  VMHooks* hooks() const { return hooks_.get(); }
+  /*!
+   * \brief Get the storage cache slot of the instruction being executed.
+   * \return The storage cached for the current program counter, undefined if none.
+   * \note vm.builtin.alloc_storage uses the slot to reuse the storage of the same
+   *       instruction across invocations once all tensors allocated from it are dead.
+   */
+  Storage& CurrentStorageCacheSlot() { return storage_cache_[pc_]; }
+  /*!
+   * \brief Record the storages served by vm.builtin.alloc_storage from now on.
+   * \param storages The list to append the storages to, null to stop recording.
+   * \note The recorded storages stay alive and so are never reused by the storage cache.
+   */
+  void SetStorageRecorder(std::vector<Storage>* storages) { storage_recorder_ = storages; }
+  /*! \brief The list the storages are recorded to, null if none. */
+  std::vector<Storage>* storage_recorder() const { return storage_recorder_; }
+  /*!
+   * \brief Allocate the shape heap for the instruction being executed.
+   * \param size The number of int64 slots of the heap.
+   * \return An int64 array on the host, which the shape functions read and write.
+   * \note The heap of an instruction is reused across invocations once the previous one is
+   *       dead, so a function does not allocate its shape heap on every call.
+   */
+  NDArray AllocShapeHeap(int64_t size);
+  /*!
+   * \brief Resolve a kernel by name from the kernel library or the global registry.
+   * \param func_name The name of the kernel.
+   * \return The kernel, cached for the instruction being executed.
+   * \note The cache is keyed by pc and validated against the name object, which is a
+   *       constant of the executable for calls emitted by the codegen.
+   */
+  const PackedFunc& LookupKernel(const String& func_name);
+  /*!
+   * \brief Pick the variant of a kernel tuned for the range which a dimension falls in.
+   * \param extents The sorted extents of the variants, a variant serves the dimensions up to its
+   *  extent.
+   * \param names The names of the variants, followed by the name of the kernel serving the
+   *  dimensions beyond the last extent.
+   * \param dim The dimension.
+   * \return The kernel, found by a binary search over the extents.
+   * \note The kernels are resolved once per instruction and cached as in LookupKernel, keyed by
+   *  the extents object.
+   */
+  const PackedFunc& LookupKernelVariant(const ShapeTuple& extents, TVMArgs names, int64_t dim);
+  /*!
+   * \brief Resolve a Relax function of the executable by name.
+   * \param func_name The name of the function.
+   * \return The index of the function in the global function table, cached for the
+   *  instruction being executed in the same way as LookupKernel.
+   */
+  Index LookupVMFunctionIndex(const String& func_name);
+  /*!
+   * \brief Invoke a closure.
+   * \param closure The closure.
+   * \param args The arguments, the free variables of the closure are passed after them.
+   * \param rv The return value.
+   * \note The arguments are written to the callee frame directly, and the function is not
+   *  looked up by name when the closure was allocated by vm.builtin.alloc_closure of this VM.
+   */
+  void InvokeClosure(const VMClosure& closure, TVMArgs args, TVMRetValue* rv);
+  /*!
+   * \brief Run a Relax function as the step of a loop, each step taking the loop-carried states
+   *  and returning their next values.
+   * \param gf_idx The index of the step function.
+   * \param num_steps The number of steps.
+   * \param states The initial states.
+   * \return The states after the last step, as an ADT tuple.
+   * \note The states of two steps ago are dead, their buffers are given to the step as output
+   *  buffers, so that the loop-carried tensors are double buffered instead of allocated at
+   *  every step.
+   */
+  RegType Scan(Index gf_idx, int64_t num_steps, std::vector<RegType> states);
+  /*!
+   * \brief Create a session of the VM for concurrent execution.
+   * \return A VM that shares the executable, the devices and allocators, the function table and
+   *  the constant pools with this VM, and has its own frames, program counter and caches.
+   * \note Sessions are cheap to create, each thread serving requests should use its own one.
+   */
+  ObjectPtr<VirtualMachine> CreateSession();
+  /*!
+   * \brief Get the output buffer provided by the caller of invoke_with_outputs.
+   * \param output_index The index of the output of the invoked function.
+   * \return The buffer, undefined if none is provided or a nested function is running.
+   */
+  NDArray GetOutputBuffer(Index output_index) const {
+    if (frames_.size() != output_buffers_depth_ ||
+        output_index >= static_cast<Index>(output_buffers_.size())) {
+      return NDArray();
+    }
+    return output_buffers_[output_index];
+  }
+  /*!
+   * \brief Map a runtime device index to a position in devices.
+   * \param device_index The runtime device index, -1 stands for the host.
+   * \return The position of the device in devices.
+   */
+  Index ResolveDeviceIndex(Index device_index) const;
+  /*!
+   * \brief Copy an NDArray to a device of the VM.
+   * \param src The source array.
+   * \param device_index The runtime device index of the destination, -1 stands for the host.
+   * \return The array on the destination device, src itself if it is already there.
+   * \note Copies of constants are cached in a per-device constant pool.
+   */
+  NDArray CopyToDevice(NDArray src, Index device_index);
+  /*!
+   * \brief Get the state slot kept by a builtin across invocations, e.g. a captured CUDA graph.
+   * \param key The key of the state, conventionally prefixed with the builtin name.
+   * \return The state slot, undefined if the builtin has not stored anything yet.
+   */
+  ObjectRef& BuiltinStateSlot(const std::string& key) { return builtin_state_[key]; }
+  /*!
+   * \brief Get the state slot of the builtin being executed, resolved once per instruction.
+   * \param prefix The prefix of the key, conventionally the builtin name.
+   * \param name The rest of the key, the same object in every execution of the instruction,
+   *        e.g. a constant.
+   * \return The state slot of the key prefix + name, see BuiltinStateSlot.
+   */
+  ObjectRef& CurrentBuiltinStateSlot(const char* prefix, const String& name);
+  /*!
+   * \brief Get a stream of a device of the VM.
+   * \param device_index The runtime device index, -1 stands for the host.
+   * \param stream_index The index of the stream, 0 is the default stream of the device.
+   * \return The stream, created on first use and owned by the VM.
+   */
+  TVMStreamHandle GetStream(Index device_index, Index stream_index);
+  /*!
+   * \brief Replace the default stream of a device, e.g. by the current stream of the framework
+   *  feeding the VM, so that its work and the kernels of the VM are ordered without a sync.
+   * \param device_index The runtime device index, -1 stands for the host.
+   * \param stream The stream, owned by the caller, nullptr restores the default stream.
+   */
+  void SetDefaultStream(Index device_index, TVMStreamHandle stream);
+  /*! \brief The index of the stream used to copy inputs in set_input. */
+  static constexpr Index kInputCopyStream = 1;
+  /*! \brief The index of the stream the collective communication builtins run on. */
+  static constexpr Index kCCLStream = 2;
+  /*! \return The frame of the function being executed. */
+  VMFrame* CurrentFrame() { return frames_.back().get(); }
+  /*!
+   * \brief Get the JIT specializing the kernels of vm.call_tir_dyn for their hot shapes.
+   * \return The JIT, nullptr unless it is enabled by enable_shape_jit.
+   */
+  KernelJIT* GetKernelJIT() const { return kernel_jit_.get(); }
 
  protected:
   /*!
@@ -146,10 +400,16 @@ class VirtualMachine : public runtime::ModuleNode {
    */
   inline RegType ReadRegister(VMFrame* frame, RegName reg) const;
   /*!
-   * \brief Prepare function table so that func_table_[func_index] is populated.
-   * \param func_index The function index.
+   * \brief Resolve all the packed functions used by the executable into func_table_.
+   * \note Called once in vm_initialization so that no lookup happens during execution.
    */
-  inline void PrepareFuncTable(Index func_index);
+  void InitFuncTable();
+  /*!
+   * \brief Find a kernel by name in the kernel library or the global registry.
+   * \param func_name The name of the kernel.
+   * \return The kernel.
+   */
+  PackedFunc FindKernel(const String& func_name);
   /*!
    * \brief Invoke a VM function.
    * \param fidx The function index.
@@ -160,12 +420,131 @@ class VirtualMachine : public runtime::ModuleNode {
 
   /*! \brief Run VM dispatch loop. */
   void RunLoop();
+  /*!
+   * \brief The dispatch loop, recording the instructions it runs into trace_sink_ if kTrace.
+   * \tparam kTrace Whether to trace, so that the untraced loop carries no tracing code.
+   */
+  template <bool kTrace>
+  void RunLoopImpl();
+  /*!
+   * \brief Start tracing an instruction about to run, see TraceInstr.
+   * \param pc The program counter of the instruction.
+   * \return The time it begins, as given by TraceSink::Now, 0 if the invocation is not traced.
+   */
+  double BeginTraceInstr(Index pc);
+  /*!
+   * \brief Record an instruction which has run into trace_sink_, and report it to the
+   *  instruction hooks.
+   * \param pc The program counter of the instruction.
+   * \param begin The time it began, as given by BeginTraceInstr.
+   */
+  void TraceInstr(Index pc, double begin);
+  /*! \brief The name of an instruction, the function called by a call, the opcode otherwise. */
+  const std::string& InstrName(Index pc) const;
+  /*! \brief Whether the hooks of the instructions are registered. */
+  bool HasInstrHooks() const { return hooks_ != nullptr && hooks_->instruction_hooks; }
+  /*!
+   * \brief Invoke the packed function of a traced call instruction, recording the time its
+   *  kernel takes on the device of its first tensor argument which is not on the host.
+   * \param func_idx The index of the function in the function table.
+   * \param args The arguments.
+   * \param rv The return value.
+   */
+  void InvokeTracedPacked(Index func_idx, TVMArgs args, TVMRetValue* rv);
+  /*!
+   * \brief Run a function compiled into the kernel library on the frame pushed for it, and pop
+   *  the frame.
+   * \param gf_idx The function index.
+   */
+  void RunCompiledFunction(Index gf_idx);
+  /*!
+   * \brief Read a constant of the constant pool, waiting for its upload if it is in progress.
+   * \param index The index of the constant.
+   * \return The constant.
+   */
+  const TVMRetValue& ReadConstant(Index index) {
+    if (constant_uploader_ != nullptr) WaitForConstant(index);
+    return constants[index];
+  }
+  /*! \brief Wait for the upload of a constant in progress, see ReadConstant. */
+  void WaitForConstant(Index index);
+  /*!
+   * \brief Wait for the upload of all the constants in progress to finish, and index them, for
+   *  the code reading the constant pool as a whole.
+   */
+  void FinishConstantUpload();
   /*!
    * \brief Run call instruction.
    * \param curr_frame The current frame.
    * \param inst The call instruction.
    */
-  inline void RunInstrCall(VMFrame* curr_frame, Instruction inst);
+  inline void RunInstrCall(VMFrame* curr_frame, const Instruction& inst);
+  /*!
+   * \brief Set up the arguments of a call or tail call instruction and invoke its function.
+   * \param curr_frame The current frame.
+   * \param inst The instruction.
+   * \param rv The return value.
+   */
+  void InvokeInstr(VMFrame* curr_frame, const Instruction& inst, TVMRetValue* rv);
+  /*!
+   * \brief Call the VMBuiltin of a call or tail call instruction on its arguments in place.
+   * \param curr_frame The current frame.
+   * \param inst The instruction.
+   * \param builtin The builtin.
+   * \param rv The return value.
+   */
+  void InvokeBuiltin(VMFrame* curr_frame, const Instruction& inst, VMBuiltin builtin,
+                     TVMRetValue* rv);
+  /*!
+   * \brief Run a tail call instruction. A bytecode function, called directly or through
+   *  vm.builtin.invoke_closure, reuses the current frame and the program counter moves to its
+   *  start. Any other function is invoked as by a call, its result left in return_value_.
+   * \param curr_frame The current frame.
+   * \param inst The tail call instruction.
+   * \return Whether the current frame is reused, otherwise the caller returns return_value_.
+   */
+  bool RunInstrTailCall(VMFrame* curr_frame, const Instruction& inst);
+  /*!
+   * \brief Invoke the packed function of a call instruction.
+   * \param func_idx The index of the function in the function table.
+   * \param func The packed function.
+   * \param args The arguments.
+   * \param rv The return value.
+   * \note Subclasses override this to instrument calls, e.g. the profiling VM.
+   */
+  virtual void InvokePacked(Index func_idx, const PackedFunc& func, TVMArgs args,
+                            TVMRetValue* rv);
+  /*!
+   * \brief Whether the builtins with a VMBuiltin entry are called directly, without going through
+   *  InvokePacked.
+   * \note Subclasses instrumenting every call in InvokePacked turn it off.
+   */
+  bool direct_builtin_calls_{true};
+  /*!
+   * \brief Set the maximal number of kernels run concurrently.
+   * \param max_parallelism The limit, 1 runs every instruction in sequence.
+   * \note The dependencies between the instructions are analyzed when the limit is first
+   *  raised, which requires the function table to be initialized.
+   */
+  void SetMaxParallelism(int max_parallelism);
+  /*!
+   * \brief Find the straight-line runs of call instructions whose kernels can run concurrently
+   *  and record their dependency levels in parallel_regions_.
+   */
+  void AnalyzeParallelRegions();
+  /*!
+   * \brief Run a parallel region level by level and move the program counter past it.
+   * \param curr_frame The current frame.
+   * \param region The region starting at the program counter.
+   */
+  void RunParallelRegion(VMFrame* curr_frame, const ParallelRegion& region);
+  /*!
+   * \brief Run a call instruction of a kernel without touching the state of the VM, so that
+   *  independent kernel calls can run on different threads.
+   * \param curr_frame The current frame.
+   * \param instr The call instruction, none of its arguments is the VM.
+   */
+  void RunKernelCall(VMFrame* curr_frame, const Instruction& instr);
 
   /*!
    * \brief Set inputs to a function.
@@ -186,9 +565,10 @@ class VirtualMachine : public runtime::ModuleNode {
    * of NDArray, they will be converted.
    * \param index The input tensor index in the function arguments.
    * \param dev device to copy to if needed.
+   * \param stream The stream to copy on.
    */
   void SetInputTensorWithIndex(std::vector<RegType>& func_args, const TVMArgValue& inp_tensor,
-                               int index, Device dev);
+                               int index, Device dev, TVMStreamHandle stream);
 
   /*!
    * \brief Look up whether the VM has a function by the given name.
@@ -197,30 +577,161 @@ class VirtualMachine : public runtime::ModuleNode {
    */
   VMFunction LookupVMFunction(const std::string& func_name);
 
- private:
+  /*!
+   * \brief Record the signature of the arguments of the first invocation of a global function.
+   * \param gf_idx The index of the global function.
+   * \param args The arguments.
+   */
+  void RecordSignature(Index gf_idx, const std::vector<RegType>& args);
+
+  /*!
+   * \brief Get the warm state of the VM, which another process running the same executable can
+   *  restore to skip the warmup: the shapes specialized by the shape JIT, and the signatures of
+   *  the first invocations of the global functions, which restoring invokes once on zeros.
+   * \return The snapshot, as a JSON string.
+   */
+  std::string GetSnapshot();
+
   /*! \brief The loaded executable. */
   ObjectPtr<Executable> exec_;
+
+ private:
   /*!
    * \brief Internal function table cache to speedup execution.
-   * \note This is used to cache functions so we do not need
-   *       to look up by name every time.
+   * \note This is populated for every function name of the executable
+   *       in vm_initialization so we do not need to look up by name every time.
    *       It does mean that the definition of the function
    *       cannot change when the vm get loaded.
    */
   std::vector<PackedFunc> func_table_;
+  /*!
+   * \brief The global function index of each entry of func_table_ which is a function of the
+   *  executable, kInvokeClosureTarget for vm.builtin.invoke_closure and -1 otherwise.
+   * \note A tail call to one of them runs in the frame of the caller.
+   */
+  std::vector<Index> tail_call_targets_;
+  /*!
+   * \brief The direct-call entry of each entry of func_table_ which is a VM builtin, nullptr for
+   *  the functions called through the PackedFunc.
+   */
+  std::vector<VMBuiltin> builtin_table_;
+  /*! \brief The value of the VM argument of the direct calls. */
+  RegType vm_handle_;
+  /*! \brief The marker of vm.builtin.invoke_closure in tail_call_targets_. */
+  static constexpr Index kInvokeClosureTarget = -2;
+  /*! \brief The arguments of a tail call, read out before the frame is reused. */
+  std::vector<RegType> tail_call_args_;
+  /*!
+   * \brief The host functions of the functions compiled into the kernel library, indexed by
+   *  function index, nullptr for the functions run by the dispatch loop.
+   */
+  std::vector<PackedFunc> compiled_funcs_;
+  /*! \brief A closure of every global function, the function pool of compiled functions. */
+  std::vector<TVMRetValue> func_pool_;
+  /*!
+   * \brief The instructions of the executable decoded into fixed-size records.
+   * \note Decoded and checked once in LoadExecutable, so that the dispatch loop neither decodes
+   *       nor bounds-checks at every step. The last record is a sentinel which reports a
+   *       control flow that runs past the end of the code section.
+   */
+  std::vector<Instruction> instrs_;
   /*!
    * \brief The current stack of call frames.
    * \note: Use unique ptr to avoid re-allocation and copy when frames_ get resized.
    */
   std::vector<std::unique_ptr<VMFrame>> frames_;
+  /*!
+   * \brief The popped frames kept for reuse, with their registers released.
+   * \note The register files and argument stacks of pooled frames keep their capacity, so
+   *       repeated and recursive calls do not allocate a frame once the pool is warm.
+   */
+  std::vector<std::unique_ptr<VMFrame>> frame_pool_;
+  /*! \brief The maximal number of frames kept in frame_pool_. */
+  static constexpr size_t kMaxPooledFrames = 64;
   /*! \brief The virtual machine PC. */
   Index pc_{0};
   /*! \brief The special return register. */
   RegType return_value_;
-  /*! \brief The global constant pool */
+  /*! \brief The global constant pool, NDArrays are placed on devices[0]. */
   std::vector<TVMRetValue> constants;
+  /*! \brief The index of each NDArray constant in the constant pool. */
+  std::unordered_map<const Object*, Index> constant_index_;
+  /*! \brief The constants copied to each device, keyed by constant index. */
+  struct DeviceConstantPools {
+    std::mutex mu;
+    std::vector<std::unordered_map<Index, NDArray>> pools;
+  };
+  /*! \brief The device constant pools, shared by the sessions of the VM. */
+  std::shared_ptr<DeviceConstantPools> device_constants_;
   /*! \brief The function name to input register mapping. */
   std::unordered_map<std::string, std::vector<RegType>> inputs_;
+  /*! \brief The function name to the result of its last invoke_stateful call. */
+  std::unordered_map<std::string, RegType> outputs_;
+  /*! \brief The storage allocated by each alloc_storage instruction, keyed by pc. */
+  std::unordered_map<Index, Storage> storage_cache_;
+  /*! \brief The list the served storages are recorded to, null if none. */
+  std::vector<Storage>* storage_recorder_{nullptr};
+  /*! \brief The shape heap allocated by each alloc_shape_heap instruction, keyed by pc. */
+  std::unordered_map<Index, NDArray> shape_heap_cache_;
+  /*! \brief The output buffers provided to the ongoing invoke_with_outputs call or scan step. */
+  std::vector<NDArray> output_buffers_;
+  /*! \brief The depth of the frame of the function which output_buffers_ are provided to. */
+  size_t output_buffers_depth_ = 1;
+  /*! \brief The streams created for each device, stream 0 is the default stream. */
+  std::vector<std::vector<TVMStreamHandle>> streams_;
+  /*! \brief The state kept by builtins across invocations. */
+  std::unordered_map<std::string, ObjectRef> builtin_state_;
+  /*! \brief The builtin state slots resolved by CurrentBuiltinStateSlot, keyed by pc. */
+  std::unordered_map<Index, std::pair<String, ObjectRef*>> builtin_state_cache_;
+  /*! \brief The kernels resolved by LookupKernel, keyed by pc. */
+  std::unordered_map<Index, std::pair<String, PackedFunc>> kernel_cache_;
+  /*! \brief The kernel variants resolved by LookupKernelVariant, keyed by pc. */
+  std::unordered_map<Index, std::pair<ShapeTuple, std::vector<PackedFunc>>> kernel_variant_cache_;
+  /*! \brief The functions resolved by LookupVMFunctionIndex, keyed by pc. */
+  std::unordered_map<Index, std::pair<String, Index>> func_index_cache_;
+  /*! \brief The maximal number of kernels run concurrently. */
+  int max_parallelism_{1};
+  /*!
+   * \brief Whether to run the functions in persistent parallel regions of the thread pool, so
+   *  that the workers spin between the parallel kernels instead of going to sleep.
+   */
+  bool persistent_parallel_region_{false};
+  /*!
+   * \brief Whether to serve the workspaces of the kernels from the bump-pointer arena of the
+   *  workspace pools, which is compacted after each invocation.
+   */
+  bool workspace_arena_{false};
+  /*! \brief The regions found by AnalyzeParallelRegions. */
+  std::vector<ParallelRegion> parallel_regions_;
+  /*! \brief The index of the region starting at each pc, -1 if none. */
+  std::vector<int> region_of_pc_;
+  /*! \brief The JIT of the hot shapes, shared by the sessions of the VM. */
+  std::shared_ptr<KernelJIT> kernel_jit_;
+  /*! \brief The sink of the timeline of the sampled invocations, shared by the sessions. */
+  std::shared_ptr<TraceSink> trace_sink_;
+  /*! \brief Whether the current invocation is traced. */
+  bool tracing_{false};
+  /*! \brief The latency histograms of the functions, shared by the sessions, if enabled. */
+  std::shared_ptr<FunctionLatencyStats> latency_stats_;
+  /*! \brief The capture of the outputs of the selected kernels, shared by the sessions. */
+  std::shared_ptr<KernelCapture> kernel_capture_;
+  /*!
+   * \brief The signatures of the first invocations of the global functions, in JSON, empty for a
+   *  function not invoked yet, see GetSnapshot.
+   */
+  std::vector<std::string> signatures_;
+  /*!
+   * \brief The upload of the constants in the background of the first invocations, null once
+   *  it is finished or when the constants are uploaded by vm_initialization.
+   */
+  std::unique_ptr<ConstantUploader> constant_uploader_;
+  /*! \brief The callbacks of the events, shared by the sessions, see SetHooks. */
+  std::shared_ptr<VMHooks> hooks_;
+  /*!
+   * \brief The functions tail called by the ongoing invocations, innermost last. A tail call is
+   *  reported to the hooks as an invocation nested in the one whose frame it replaces.
+   */
+  std::vector<const std::string*> hooked_tail_calls_;
 };
 
 }  // namespace relax_vm
@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/runtime/relax_vm/vm_hooks.h
+ * \brief The callbacks of the events of the Relax VM, for external tracing systems.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_VM_HOOKS_H_
+#define TVM_RUNTIME_RELAX_VM_VM_HOOKS_H_
+
+#include <tvm/runtime/c_runtime_api.h>
+
+#include <string>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief The callbacks of the events of a VM, registered by VirtualMachine::SetHooks.
+ *
+ *  The callbacks run on the thread of the VM, in the middle of the invocation, so they should
+ *  only record the event, e.g. open or close a span. The VM checks for the hooks once per
+ *  invocation and per allocation, and runs the instructions without any check unless
+ *  instruction_hooks is set.
+ */
+class VMHooks {
+ public:
+  virtual ~VMHooks() = default;
+  /*!
+   * \brief Called when a global function is invoked, before it runs.
+   * \param func_name The name of the function.
+   */
+  virtual void OnInvokeBegin(const std::string& func_name) {}
+  /*!
+   * \brief Called when a global function returns.
+   * \param func_name The name of the function.
+   */
+  virtual void OnInvokeEnd(const std::string& func_name) {}
+  /*!
+   * \brief Called before an instruction runs, when instruction_hooks is set.
+   * \param pc The program counter of the instruction.
+   * \param name The function called by a call instruction, the opcode of the others.
+   */
+  virtual void OnInstrBegin(int64_t pc, const std::string& name) {}
+  /*!
+   * \brief Called after an instruction has run, when instruction_hooks is set.
+   * \param pc The program counter of the instruction.
+   * \param name The function called by a call instruction, the opcode of the others.
+   */
+  virtual void OnInstrEnd(int64_t pc, const std::string& name) {}
+  /*!
+   * \brief Called when the VM allocates a storage from its allocators, the storages reused
+   *  across invocations are not reported again.
+   * \param dev The device of the storage.
+   * \param nbytes The size of the storage in bytes.
+   * \param mem_scope The memory scope of the storage, empty for the global memory.
+   */
+  virtual void OnAlloc(Device dev, size_t nbytes, const std::string& mem_scope) {}
+
+  /*! \brief Whether to call the hooks of the instructions, which slows down the dispatch. */
+  bool instruction_hooks{false};
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_VM_HOOKS_H_
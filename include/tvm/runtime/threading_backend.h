@@ -24,6 +24,7 @@
 #ifndef TVM_RUNTIME_THREADING_BACKEND_H_
 #define TVM_RUNTIME_THREADING_BACKEND_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -89,6 +90,11 @@ class ThreadGroup {
     kSpecifyOneCorePerThread = -2,
     /*All threads will get the same core group affinity.*/
     kSpecifyThreadShareAllCore = -3,
+    /*
+     * The ids are NUMA nodes. Different threads will get different cores of these nodes, and the
+     * CPU memory allocated by the configuring thread is bound to these nodes.
+     */
+    kSpecifyNumaNodes = -4,
   };
   /*!
    * \brief configure the CPU id affinity
@@ -133,13 +139,98 @@ void ResetThreadPool();
 /*!
  * \brief Configuring the CPU affinity mode for the working threads.
  * \param mode The preferred CPU type (1 = big, -1 = little, -2 = kSpecifyOneCorePerThread,
- *  -3 = kSpecifyThreadShareAllCore).
+ *  -3 = kSpecifyThreadShareAllCore, -4 = kSpecifyNumaNodes).
  * \param nthreads The number of threads to use (0 = use all).
- * \param cpus A list of CPUs is used to set the 'cpu affinity' for the worker threads.
+ * \param cpus A list of CPUs is used to set the 'cpu affinity' for the worker threads, or a list
+ *  of NUMA nodes for kSpecifyNumaNodes.
  */
 void Configure(tvm::runtime::threading::ThreadGroup::AffinityMode mode, int nthreads,
                std::vector<unsigned int> cpus);
 
+/*!
+ * \brief Begin a persistent parallel region on the thread pool of the calling thread. Until the
+ *  region ends, the idle workers keep spinning for the next parallel launch instead of going to
+ *  sleep, which saves the wake-up latency between consecutive small parallel kernels at the cost
+ *  of busy CPUs. Regions can be nested.
+ */
+void BeginPersistentRegion();
+
+/*! \brief End the persistent parallel region begun last by the calling thread. */
+void EndPersistentRegion();
+
+/*!
+ * \brief Configure the persistent parallel regions of the thread pool of the calling thread.
+ * \param spin_count The number of iterations the idle workers spin in a region before they go to
+ *  sleep anyway. The default comes from the environment variable
+ *  TVM_THREAD_POOL_REGION_SPIN_COUNT.
+ */
+void ConfigurePersistentRegion(uint32_t spin_count);
+
+/*! \brief A RAII scope of a persistent parallel region. */
+class PersistentRegionScope {
+ public:
+  /*! \param enable Whether to begin a region, so that the scope can be conditional. */
+  explicit PersistentRegionScope(bool enable = true) : enable_(enable) {
+    if (enable_) {
+      BeginPersistentRegion();
+    }
+  }
+  ~PersistentRegionScope() {
+    if (enable_) {
+      EndPersistentRegion();
+    }
+  }
+  PersistentRegionScope(const PersistentRegionScope&) = delete;
+  PersistentRegionScope& operator=(const PersistentRegionScope&) = delete;
+
+ private:
+  bool enable_;
+};
+
+/*!
+ * \brief Get the CPUs of NUMA nodes.
+ * \param nodes The ids of the NUMA nodes.
+ * \return The ids of the CPUs of these nodes, in ascending order.
+ */
+std::vector<unsigned int> NumaNodeCpus(const std::vector<unsigned int>& nodes);
+
+/*!
+ * \brief Bind the CPU memory allocated by the calling thread to NUMA nodes.
+ * \param nodes The ids of the NUMA nodes, empty to not bind the memory.
+ */
+void SetMemoryNumaNodes(std::vector<unsigned int> nodes);
+
+/*! \return The NUMA nodes the CPU memory allocated by the calling thread is bound to. */
+const std::vector<unsigned int>& GetMemoryNumaNodes();
+
+/*! \brief How the thread pool distributes the tasks of a parallel launch to the workers. */
+enum class TaskScheduleMode : int {
+  /*! \brief Each worker runs one task, i.e. the work is split statically. */
+  kStatic = 0,
+  /*!
+   * \brief The work is split into several chunks per worker. Each worker runs its own chunks
+   *  first, then steals the chunks left to the others, which balances imbalanced iterations.
+   *  TVMBackendParallelBarrier is not supported in this mode.
+   */
+  kWorkStealing = 1,
+};
+
+/*!
+ * \brief Configure how the thread pool of the calling thread distributes the tasks.
+ * \param mode The task schedule mode.
+ * \param chunks_per_worker The number of chunks per worker in the work-stealing mode, used when
+ *  a launch does not request a number of tasks.
+ * \note The defaults come from the environment variables TVM_THREAD_POOL_SCHEDULE
+ *  ("static" or "work_stealing") and TVM_THREAD_POOL_CHUNKS_PER_WORKER.
+ */
+void ConfigureTaskSchedule(TaskScheduleMode mode, int chunks_per_worker);
+
+/*! \return The task schedule mode of the thread pool of the calling thread. */
+TaskScheduleMode GetTaskScheduleMode();
+
+/*! \return The number of chunks per worker in the work-stealing mode. */
+int ChunksPerWorker();
+
 /*!
  * \brief Get the number of threads being used by the TVM runtime
  * \returns The number of threads used.
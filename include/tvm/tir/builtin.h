@@ -720,6 +720,31 @@ TVM_DLL const Op& texture2d_load();
  */
 TVM_DLL const Op& mem_copy();
 
+/*!
+ * \brief Get an item of an anylist, i.e. an array of TVMRetValue such as the register file of
+ *  a Relax VM function.
+ *
+ *  handle anylist_getitem(handle anylist, int index)
+ *
+ *  It is only valid as an argument of tvm_call_packed or anylist_setitem_call_packed, where it
+ *  is lowered to TVMBackendAnyListSetPackedArg which passes the item without copying it.
+ */
+TVM_DLL const Op& anylist_getitem();
+
+/*!
+ * \brief Reset an item of an anylist, releasing the value it holds.
+ *
+ *  int anylist_resetitem(handle anylist, int index)
+ */
+TVM_DLL const Op& anylist_resetitem();
+
+/*!
+ * \brief Call a packed function by name and move its return value into an anylist item.
+ *
+ *  int anylist_setitem_call_packed(handle anylist, int index, name, args...)
+ */
+TVM_DLL const Op& anylist_setitem_call_packed();
+
 /*! \brief The kind of structure field info used in intrinsic */
 enum TVMStructFieldKind : int {
   // array head address
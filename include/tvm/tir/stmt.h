@@ -1477,12 +1477,30 @@ constexpr const char* script_parsing_detect_access = "tir.script_parsing_detect_
  */
 constexpr const char* pragma_loop_partition_hint = "pragma_loop_partition_hint";
 
+/*!
+ * \brief Mark that the loop should be vectorized by the backend with scalable vectors
+ *  (ARM SVE, RISC-V V), so the code is agnostic of the vector length of the hardware.
+ */
+constexpr const char* pragma_scalable_vectorize = "pragma_scalable_vectorize";
+
 /*! \brief Mark the stage of a statement in the software pipeline */
 constexpr const char* software_pipeline_stage = "software_pipeline_stage";
 
 /*! \brief Mark the order of a statement in the software pipeline */
 constexpr const char* software_pipeline_order = "software_pipeline_order";
 
+/*!
+ * \brief Mark the stages of the software pipeline whose global to shared memory copies are
+ *  asynchronous, the copies of each iteration are committed as a group of PTX async copies.
+ */
+constexpr const char* software_pipeline_async_stages = "software_pipeline_async_stages";
+
+/*!
+ * \brief Mark the number of iterations ahead of which a loop prefetches the rows gathered by its
+ *  indirect loads, see InjectSoftwarePrefetch.
+ */
+constexpr const char* software_prefetch_distance = "software_prefetch_distance";
+
 /*! \brief Mark the buffers which is const access and can be transformed layout. */
 constexpr const char* layout_free_buffers = "layout_free_buffers";
 
@@ -624,6 +624,16 @@ TVM_DLL Pass UnifiedStaticMemoryPlanner();
  */
 TVM_DLL Pass InjectSoftwarePipeline();
 
+/*!
+ * \brief Prefetch the rows gathered by the indirect loads of the loops annotated with
+ *  "software_prefetch_distance" k, e.g. weight[indices[b, l], d] of an embedding bag. The body of
+ *  such a loop first prefetches the row its indirect loads read k iterations later, clamped to
+ *  the last iteration, so that the random reads of the rows overlap with the computation.
+ *
+ * \return The IR transform pass.
+ */
+TVM_DLL Pass InjectSoftwarePrefetch();
+
 TVM_DLL Pass BindParams(const Array<runtime::NDArray>& constants);
 
 /*!
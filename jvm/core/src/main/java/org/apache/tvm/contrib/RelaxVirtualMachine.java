@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+package org.apache.tvm.contrib;
+
+import java.util.HashMap;
+import java.util.Map;
+
+import org.apache.tvm.Device;
+import org.apache.tvm.Function;
+import org.apache.tvm.Module;
+import org.apache.tvm.NDArrayBase;
+
+/**
+ * Wrapper of the Relax virtual machine running an executable built by relax.vm.build.
+ * The arrays passed in are handed to the VM as they are, without copies,
+ * so the inputs and the preallocated outputs on the device of the VM are aliased.
+ */
+public class RelaxVirtualMachine {
+  /** The allocator allocating and freeing every array on the device. */
+  public static final int NAIVE_ALLOCATOR = 1;
+  /** The allocator reusing the freed arrays of the same size. */
+  public static final int POOLED_ALLOCATOR = 2;
+
+  private Module module;
+  private Function finvokeWithOutputs;
+  private final Map<String, Function> functions = new HashMap<String, Function>();
+
+  /**
+   * Create a VM running the executable on the device with the pooled allocator.
+   * @param exec The executable, e.g. loaded from the library exported by the executable.
+   * @param dev The device to run on.
+   */
+  public RelaxVirtualMachine(Module exec, Device dev) {
+    this(exec, dev, POOLED_ALLOCATOR);
+  }
+
+  /**
+   * Create a VM running the executable on the device.
+   * @param exec The executable, e.g. loaded from the library exported by the executable.
+   * @param dev The device to run on.
+   * @param allocType The allocator of the device, NAIVE_ALLOCATOR or POOLED_ALLOCATOR.
+   */
+  public RelaxVirtualMachine(Module exec, Device dev, int allocType) {
+    Function fload = exec.getFunction("vm_load_executable");
+    module = fload.invoke().asModule();
+    fload.release();
+    Function finit = module.getFunction("vm_initialization");
+    finit.pushArg(dev.deviceType).pushArg(dev.deviceId).pushArg(allocType);
+    // The shape functions run on the host, which comes last.
+    if (dev.deviceType != Device.cpu().deviceType) {
+      finit.pushArg(Device.cpu().deviceType).pushArg(0).pushArg(allocType);
+    }
+    finit.invoke();
+    finit.release();
+    finvokeWithOutputs = module.getFunction("invoke_with_outputs");
+  }
+
+  /**
+   * Release the RelaxVirtualMachine.
+   * <p>
+   * We highly recommend you to do this manually since the GC strategy is lazy.
+   * </p>
+   */
+  public void release() {
+    for (Function func : functions.values()) {
+      func.release();
+    }
+    functions.clear();
+    finvokeWithOutputs.release();
+    module.release();
+  }
+
+  /**
+   * Invoke a function returning a single array.
+   * @param funcName The name of the function.
+   * @param inputs The inputs of the function.
+   * @return The output, owned by the VM until it is copied out with copyTo.
+   */
+  public NDArrayBase invoke(String funcName, NDArrayBase... inputs) {
+    Function func = functions.get(funcName);
+    if (func == null) {
+      func = module.getFunction(funcName);
+      functions.put(funcName, func);
+    }
+    for (NDArrayBase input : inputs) {
+      func.pushArg(input);
+    }
+    return func.invoke().asNDArray();
+  }
+
+  /**
+   * Invoke a function writing its outputs into preallocated arrays.
+   * The outputs computed in place by the function take no copy.
+   * @param funcName The name of the function.
+   * @param inputs The inputs of the function.
+   * @param outputs The arrays receiving the outputs, one for each output of the function.
+   */
+  public void invokeWithOutputs(String funcName, NDArrayBase[] inputs, NDArrayBase[] outputs) {
+    finvokeWithOutputs.pushArg(funcName);
+    for (NDArrayBase input : inputs) {
+      finvokeWithOutputs.pushArg(input);
+    }
+    for (NDArrayBase output : outputs) {
+      finvokeWithOutputs.pushArg(output);
+    }
+    finvokeWithOutputs.invoke();
+  }
+
+  /**
+   * Get internal module function.
+   * @param key The key to the module.
+   * @return The function.
+   * @throws IllegalArgumentException if function does not exist.
+   */
+  public Function getFunction(String key) {
+    return module.getFunction(key);
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+package org.apache.tvm.contrib;
+
+import org.apache.tvm.Device;
+import org.apache.tvm.Module;
+import org.apache.tvm.NDArray;
+import org.apache.tvm.NDArrayBase;
+import org.junit.BeforeClass;
+import org.junit.Test;
+
+import java.io.File;
+
+import static org.junit.Assert.assertArrayEquals;
+
+public class RelaxVirtualMachineTest {
+  private static String loadingDir;
+
+  @BeforeClass
+  public static void beforeClass() {
+    loadingDir = System.getProperty("test.tempdir");
+  }
+
+  @Test
+  public void test_add_one() {
+    Module exec = Module.load(loadingDir + File.separator + "relax_addone.so");
+    Device dev = Device.cpu();
+    RelaxVirtualMachine vm = new RelaxVirtualMachine(exec, dev);
+
+    long[] shape = new long[]{4};
+    NDArray arr = NDArray.empty(shape, dev);
+    arr.copyFrom(new float[]{1f, 2f, 3f, 4f});
+
+    NDArray out = NDArray.empty(shape, dev);
+    NDArrayBase res = vm.invoke("main", arr);
+    res.copyTo(out);
+    res.release();
+    assertArrayEquals(new float[]{2f, 3f, 4f, 5f}, out.asFloatArray(), 1e-3f);
+
+    NDArray preallocated = NDArray.empty(shape, dev);
+    vm.invokeWithOutputs("main", new NDArrayBase[]{arr}, new NDArrayBase[]{preallocated});
+    assertArrayEquals(new float[]{2f, 3f, 4f, 5f}, preallocated.asFloatArray(), 1e-3f);
+
+    arr.release();
+    out.release();
+    preallocated.release();
+    vm.release();
+    exec.release();
+  }
+}
@@ -0,0 +1,40 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import os
+
+import tvm
+from tvm import relax, topi
+
+
+def dump_relax_exec(target_dir):
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [4], relax.DynTensorType(1, "float32"))
+    with bb.function("main", [x]):
+        with bb.dataflow():
+            gv = bb.emit_output(bb.call_te(topi.add, x, relax.const(1.0, "float32")))
+        bb.emit_func_output(gv)
+
+    ex = relax.vm.build(bb.get(), tvm.target.Target("llvm", host="llvm"))
+    ex.mod.export_library(os.path.join(target_dir, "relax_addone.so"))
+
+
+if __name__ == "__main__":
+    import sys
+
+    if len(sys.argv) != 2:
+        sys.exit(-1)
+    dump_relax_exec(sys.argv[1])
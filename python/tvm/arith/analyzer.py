@@ -91,6 +91,8 @@ class Analyzer:
         self._int_set = _mod("int_set")
         self._enter_constraint_context = _mod("enter_constraint_context")
         self._can_prove_equal = _mod("can_prove_equal")
+        self._enable_simplify_cache = _mod("enable_simplify_cache")
+        self._simplify_cache_stats = _mod("simplify_cache_stats")
 
     def const_int_bound(self, expr):
         """Find constant integer bound for expr.
@@ -270,3 +272,28 @@ class Analyzer:
             Whether we can prove that lhs == rhs
         """
         return self._can_prove_equal(lhs, rhs)
+
+    def enable_simplify_cache(self, max_entries: int):
+        """Memoize the results of simplify
+
+        The results are keyed by the expression and the bindings and constraints in effect.
+        The memo is enabled by default in the analyzers created while the
+        "arith.simplify_cache_size" option of the pass context is positive.
+
+        Parameters
+        ----------
+        max_entries: int
+            The maximal number of memoized results, 0 disables the memo
+        """
+        self._enable_simplify_cache(max_entries)
+
+    def simplify_cache_stats(self):
+        """The number of hits and misses of the memo of simplify
+
+        Returns
+        -------
+        stats: Tuple[int, int]
+            The number of hits and the number of misses
+        """
+        hits, misses = self._simplify_cache_stats()
+        return int(hits), int(misses)
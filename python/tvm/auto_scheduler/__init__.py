@@ -24,6 +24,7 @@ from . import (
     loop_state,
     measure,
     measure_record,
+    relax_integration,
     relay_integration,
     search_policy,
     search_task,
@@ -0,0 +1,331 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+
+"""
+Integrate auto_scheduler into relax. It implements the following items:
+1. Recover the TE compute of the kernels of a relax program, which were created from TE
+2. Extract search tasks from a relax program
+3. Replace the kernels of a relax program by their history best auto_scheduler schedule
+
+The kernels are recovered as the TE computes the relay integration traces, so the tuning logs
+of the same workloads are shared by relay and relax.
+"""
+
+import logging
+
+import tvm
+from tvm import te, tir
+from tvm.ir import IRModule, Range
+from tvm.target import Target
+
+from .compute_dag import ComputeDAG, LayoutRewriteOption
+from .dispatcher import ApplyHistoryBest, DispatchContext
+from .relay_integration import traverse_to_get_io_tensors
+from .search_task import SearchTask
+from .workload_registry import register_workload_tensors
+
+logger = logging.getLogger("auto_scheduler")
+
+# The annotation create_prim_func adds to every block, which is not an attribute of the compute.
+_SCRIPT_PARSING_ATTR = "script_parsing_detect_access"
+
+
+class _Unsupported(Exception):
+    """A PrimFunc which has no TE compute equivalent."""
+
+
+def _static_shape(buffer):
+    if not all(isinstance(dim, tir.IntImm) for dim in buffer.shape):
+        raise _Unsupported("dynamic shape")
+    return [int(dim) for dim in buffer.shape]
+
+
+def _reducer_of(init, update, buffer, indices):
+    """The TE reducer and the reduced value of a block, from its init and update stores."""
+    for op_type, reducer, identity in [
+        (tir.Add, te.sum, lambda dtype: tir.const(0, dtype)),
+        (tir.Max, te.max, te.min_value),
+        (tir.Min, te.min, te.max_value),
+    ]:
+        if not isinstance(update, op_type):
+            continue
+        lhs = update.a
+        if not (
+            isinstance(lhs, tir.BufferLoad)
+            and lhs.buffer.same_as(buffer)
+            and tvm.ir.structural_equal(list(lhs.indices), indices)
+        ):
+            break
+        # The init of the block must be the identity of the reducer.
+        if not tvm.ir.structural_equal(init, identity(init.dtype)):
+            break
+        return reducer, update.b
+    raise _Unsupported("reducer")
+
+
+def prim_func_to_te(func):
+    """Recover the TE compute of a PrimFunc created by te.create_prim_func.
+
+    Every block of the PrimFunc is turned back to the ComputeOp it was created from: the data
+    parallel blocks store their value, the reduction blocks initialize then combine the value with
+    a sum, max or min. The inputs are the placeholders the relay integration traces, so that the
+    workload keys of the relay and relax programs agree.
+
+    Parameters
+    ----------
+    func : PrimFunc
+        The PrimFunc, of static shape.
+
+    Returns
+    -------
+    tensors : Optional[List[Tensor]]
+        The input and output tensors in the order of the parameters of the PrimFunc,
+        None if the PrimFunc has a dynamic shape, or a block which is not a TE compute.
+    """
+    try:
+        return _prim_func_to_te(func)
+    except _Unsupported as err:
+        logger.debug("The PrimFunc is not a TE compute: %s", err)
+        return None
+
+
+def _prim_func_to_te(func):
+    root = func.body
+    if not isinstance(root, tir.BlockRealize):
+        raise _Unsupported("no root block")
+    params = []
+    for param in func.params:
+        if param not in func.buffer_map:
+            raise _Unsupported("scalar parameter")
+        params.append(func.buffer_map[param])
+
+    blocks = []
+    tir.stmt_functor.post_order_visit(
+        root.block.body, lambda node: blocks.append(node) if isinstance(node, tir.Block) else None
+    )
+    written = set()
+    for block in blocks:
+        if not isinstance(block.body, tir.BufferStore):
+            raise _Unsupported("block %s is not a single store" % block.name_hint)
+        written.add(block.body.buffer)
+
+    tensors = {}
+    for buffer in params:
+        if buffer not in written:
+            tensors[buffer] = te.placeholder(_static_shape(buffer), buffer.dtype, "placeholder")
+
+    def to_tensor_loads(expr):
+        def f_load(load):
+            if load.buffer not in tensors:
+                raise _Unsupported("read of %s before it is computed" % load.buffer.name)
+            return tir.ProducerLoad(tensors[load.buffer], list(load.indices))
+
+        return tir.stmt_functor.ir_transform(
+            tir.Evaluate(expr), None, f_load, ["tir.BufferLoad"]
+        ).value
+
+    for block in blocks:
+        store = block.body
+        _static_shape(store.buffer)
+        axis = [iv for iv in block.iter_vars if iv.iter_type == tir.IterVar.DataPar]
+        reduce_axis = [iv for iv in block.iter_vars if iv.iter_type == tir.IterVar.CommReduce]
+        if len(axis) + len(reduce_axis) != len(block.iter_vars):
+            raise _Unsupported("block %s has an opaque iterator" % block.name_hint)
+        if not store.indices and len(axis) == 1 and int(axis[0].dom.extent) == 1:
+            # The scalar computes have a block iterator of extent 1.
+            axis = []
+        indices = [iv.var for iv in axis]
+        if not tvm.ir.structural_equal(list(store.indices), indices):
+            raise _Unsupported("block %s does not store to its iterators" % block.name_hint)
+
+        if block.init is None:
+            if reduce_axis:
+                raise _Unsupported("block %s reduces without init" % block.name_hint)
+            body = to_tensor_loads(store.value)
+        else:
+            if not isinstance(block.init, tir.BufferStore):
+                raise _Unsupported("block %s reduces several values" % block.name_hint)
+            reducer, source = _reducer_of(block.init.value, store.value, store.buffer, indices)
+            reduce_axis = [
+                tir.IterVar(Range.from_min_extent(iv.dom.min, iv.dom.extent), iv.var, iv.iter_type)
+                for iv in reduce_axis
+            ]
+            body = reducer(to_tensor_loads(source), axis=reduce_axis)
+
+        attrs = {
+            key: value
+            for key, value in block.annotations.items()
+            if key != _SCRIPT_PARSING_ATTR and not isinstance(value, (tir.Buffer, tvm.ir.Array))
+        }
+        op = te._ffi_api.ComputeOp(  # pylint: disable=protected-access
+            store.buffer.name,
+            "",
+            attrs,
+            [
+                tir.IterVar(Range.from_min_extent(iv.dom.min, iv.dom.extent), iv.var, iv.iter_type)
+                for iv in axis
+            ],
+            [body],
+        )
+        tensors[store.buffer] = op.output(0)
+
+    return [tensors[buffer] for buffer in params]
+
+
+class _RelaxWorkload:
+    """The auto_scheduler workload of a kernel of a relax program."""
+
+    def __init__(self, func):
+        self.args = prim_func_to_te(func)
+        self.key = None
+        if self.args is None:
+            return
+        outs = [tensor for tensor in self.args if not isinstance(tensor.op, te.PlaceholderOp)]
+        # The tensors are ordered as the relay integration does to compute the workload key.
+        io_tensors, _, self.has_complex_op = traverse_to_get_io_tensors(outs)
+        if not io_tensors:
+            self.args = None
+            return
+        try:
+            self.dag = ComputeDAG(io_tensors)
+        except tvm.error.TVMError as err:
+            logger.info("Failed to create a ComputeDAG for auto_scheduler: %s", str(err))
+            self.args = None
+            return
+        self.key = register_workload_tensors(self.dag.workload_key(), io_tensors)
+
+
+def extract_tasks(
+    mod,
+    target,
+    params=None,
+    hardware_params=None,
+    include_simple_tasks=False,
+):
+    """Extract tuning tasks from a relax program.
+
+    The tasks are the kernels called with call_tir whose TE compute is recovered by
+    prim_func_to_te, weighted by their number of calls. The kernels of the same workload key are
+    one task.
+
+    Parameters
+    ----------
+    mod: tvm.IRModule or relax.Function
+        The module or function to tune
+    target: Union[tvm.target.Target, str]
+        The compilation target
+    params: Optional[Dict[str, NDArray]]
+        The params to bind to the main function
+    hardware_params : Optional[HardwareParams]
+        Hardware parameters used for the search tasks
+    include_simple_tasks: bool
+        Whether to extract simple tasks that do not include complicated ops.
+
+    Returns
+    -------
+    tasks: List[SearchTask]
+        The tasks in this program
+    weights: List[int]
+        The weight (i.e. the number of calls) of extracted tasks
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm.meta_schedule.relax_integration import extract_task_from_relax
+
+    if not isinstance(target, Target):
+        target = Target(target)
+
+    key_to_task = {}
+    for extracted in extract_task_from_relax(mod, target, params):
+        (func,) = extracted.mod.functions.values()
+        workload = _RelaxWorkload(func)
+        if workload.key is None or not (workload.has_complex_op or include_simple_tasks):
+            continue
+        if workload.key in key_to_task:
+            weight, names = key_to_task[workload.key]
+            key_to_task[workload.key] = (weight + extracted.weight, names + [extracted.task_name])
+        else:
+            key_to_task[workload.key] = (extracted.weight, [extracted.task_name])
+
+    tasks = []
+    weights = []
+    for key, (weight, names) in key_to_task.items():
+        tasks.append(
+            SearchTask(
+                workload_key=key,
+                target=target,
+                hardware_params=hardware_params,
+                # The layout of the parameters of a relax kernel is fixed by its callers.
+                layout_rewrite_option=LayoutRewriteOption.NO_REWRITE,
+                desc=",".join(names),
+            )
+        )
+        weights.append(int(weight))
+    return tasks, weights
+
+
+def apply_history_best(mod, target, records=None):
+    """Replace the kernels of a relax program by their history best auto_scheduler schedule.
+
+    Every kernel whose TE compute is recovered is looked up by its workload key, then scheduled
+    with the best state found and lowered in place. The other kernels are kept, to be built as
+    they are or tuned with MetaSchedule.
+
+    Parameters
+    ----------
+    mod: tvm.IRModule
+        The relax program
+    target: Union[tvm.target.Target, str]
+        The compilation target
+    records : Optional[Union[str, List[str], ApplyHistoryBest]]
+        The tuning log files or the ApplyHistoryBest context to look the schedules up in.
+        Defaults to the current dispatch context.
+
+    Returns
+    -------
+    mod: tvm.IRModule
+        The relax program with the scheduled kernels
+    """
+    if not isinstance(target, Target):
+        target = Target(target)
+    if records is None:
+        dispatch_ctx = DispatchContext.current
+    elif isinstance(records, DispatchContext):
+        dispatch_ctx = records
+    else:
+        dispatch_ctx = ApplyHistoryBest(records)
+
+    updates = {}
+    for gv, func in mod.functions.items():
+        if not isinstance(func, tir.PrimFunc):
+            continue
+        workload = _RelaxWorkload(func)
+        if workload.key is None:
+            continue
+        state = dispatch_ctx.query(
+            target, workload.key, workload.has_complex_op, workload.dag, gv.name_hint
+        )
+        if state is None:
+            continue
+        sch, _ = workload.dag.apply_steps_from_state(state)
+        with target:
+            lowered = tvm.lower(sch, workload.args, name=gv.name_hint)
+        updates[gv] = lowered[gv.name_hint]
+
+    if not updates:
+        return mod
+    return IRModule({gv: updates.get(gv, func) for gv, func in mod.functions.items()})
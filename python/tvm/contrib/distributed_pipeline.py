@@ -0,0 +1,160 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Pipeline-parallel execution of Relax VM stages on the hosts of RPC servers.
+
+Each host runs the VM of one stage, and the outputs of a stage move to the host of the next
+stage through a socket channel between the two hosts, so only the inputs of the first stage
+and the outputs of the last stage go through the driver.
+"""
+import os
+import threading
+from typing import List, NamedTuple, Optional, Sequence
+
+import numpy as np
+import tvm
+from tvm.contrib import utils
+from tvm.rpc.client import RPCSession
+
+
+class DistributedStage(NamedTuple):
+    """A stage of a distributed pipeline.
+
+    Parameters
+    ----------
+    session : RPCSession
+        The RPC session of the host which runs the stage.
+
+    executable : tvm.relax.vm.Executable
+        The executable of the stage, built for the device of the host.
+
+    device : Device
+        The device of the session to run the stage on, e.g. session.cuda(0).
+
+    host : str
+        The address the host of the previous stage connects to the host of this stage with.
+    """
+
+    session: RPCSession
+    executable: "tvm.relax.vm.Executable"
+    device: tvm.runtime.Device
+    host: str
+
+
+class DistributedPipeline(object):
+    """A pipeline whose stages are Relax VM functions running on different hosts.
+
+    The outputs of a stage are the inputs of the next stage in order. The driver runs the
+    stages of every batch in order and the stages of different batches at the same time, so
+    that a stage works on a batch while the next stage works on the previous batch.
+
+    Parameters
+    ----------
+    stages : Sequence[DistributedStage]
+        The stages in order.
+
+    func_name : str
+        The name of the function run by every stage.
+
+    port : int
+        The first port the hosts listen on for the channels of the stages.
+
+    port_end : int
+        The end of the ports the hosts listen on.
+    """
+
+    def __init__(
+        self,
+        stages: Sequence[DistributedStage],
+        func_name: str = "main",
+        port: int = 9200,
+        port_end: int = 9300,
+    ):
+        if not stages:
+            raise ValueError("The pipeline has no stage.")
+        self._stages = list(stages)
+        self._modules = []
+        temp = utils.tempdir()
+        for i, stage in enumerate(self._stages):
+            path = temp.relpath(f"distributed_stage{i}.so")
+            stage.executable.mod.export_library(path)
+            stage.session.upload(path)
+            rexec = stage.session.load_module(os.path.basename(path))
+            vm = tvm.relax.VirtualMachine(rexec, stage.device)
+            create_stage = stage.session.get_function("tvm.pipeline_executor.relax_vm_stage")
+            self._modules.append(create_stage(vm.module, func_name))
+        # the channel i links the stage i to the stage i + 1
+        self._senders = []
+        self._receivers = []
+        for sender, receiver in zip(self._stages[:-1], self._stages[1:]):
+            listen = receiver.session.get_function("tvm.pipeline_executor.tensor_channel_listen")
+            connect = sender.session.get_function("tvm.pipeline_executor.tensor_channel_connect")
+            recv_channel = listen(receiver.host, port, port_end)
+            self._senders.append(connect(receiver.host, recv_channel["port"]()))
+            recv_channel["accept"]()
+            self._receivers.append(recv_channel)
+
+    def run(self, batches: List[List[np.ndarray]]) -> List[List[np.ndarray]]:
+        """Run the pipeline on the batches.
+
+        Parameters
+        ----------
+        batches : List[List[np.ndarray]]
+            The inputs of the first stage for every batch.
+
+        Returns
+        -------
+        outputs : List[List[np.ndarray]]
+            The outputs of the last stage for every batch.
+        """
+        outputs: List[Optional[List[np.ndarray]]] = [None] * len(batches)
+        errors: List[BaseException] = []
+        threads = [
+            threading.Thread(target=self._run_stage, args=(i, batches, outputs, errors))
+            for i in range(len(self._stages))
+        ]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        if errors:
+            raise errors[0]
+        return outputs
+
+    def _run_stage(self, index, batches, outputs, errors):
+        stage = self._stages[index]
+        module = self._modules[index]
+        is_last = index == len(self._stages) - 1
+        try:
+            for batch_index, batch in enumerate(batches):
+                if index == 0:
+                    for i, data in enumerate(batch):
+                        module["set_input_by_reference"](i, tvm.nd.array(data, stage.device))
+                else:
+                    self._receivers[index - 1]["recv_inputs"](module, stage.device)
+                module["run"]()
+                if is_last:
+                    num_outputs = module["get_num_outputs"]()
+                    get_output = module["get_output"]
+                    outputs[batch_index] = [get_output(i).numpy() for i in range(num_outputs)]
+                else:
+                    self._senders[index]["send_outputs"](module)
+        except BaseException as err:  # pylint: disable=broad-except
+            # the error is raised by the driver, the other stages stop once their channels break
+            errors.append(err)
+            channels = self._senders[index : index + 1] + self._receivers[max(index - 1, 0) : index]
+            for channel in channels:
+                channel["close"]()
@@ -162,6 +162,7 @@ class GraphModule(object):
         self._get_num_inputs = module["get_num_inputs"]
         self._load_params = module["load_params"]
         self._share_params = module["share_params"]
+        self._share_storage = module["share_storage"]
 
     def set_input(self, key=None, value=None, **params):
         """Set inputs to the module via kwargs
@@ -335,9 +336,36 @@ class GraphModule(object):
             it's parameters.
         params_bytes : bytearray
             The serialized parameter dict (used only for the parameter names).
+
+        Note
+        ----
+        Only the parameters that ``other`` holds with the same name, shape and dtype are shared,
+        so the variants of one model can share the parameters they have in common. The other
+        parameters keep the values given by ``load_params``.
         """
         self._share_params(other.module, bytearray(params_bytes))
 
+    def share_storage(self, other):
+        """Share the storage of the intermediate tensors with another GraphExecutor instance.
+
+        All the executors sharing the storage use one buffer per device, sized to the largest
+        requirement among them, instead of a storage pool each. The inputs, the outputs and the
+        parameters keep their own storage.
+
+        Parameters
+        ----------
+        other: GraphModule
+            The GraphExecutor instance to share the storage with, which may already share its
+            storage with other instances.
+
+        Note
+        ----
+        The executors sharing the storage must not run concurrently, e.g. use one group of
+        executors per thread. Set zero-copy inputs and outputs after all the executors of the
+        group joined, since joining a larger executor rebinds the operators of the others.
+        """
+        self._share_storage(other.module)
+
     def __getitem__(self, key):
         """Get internal module function
 
@@ -33,6 +33,30 @@ def pipeline_executor_enabled():
     return get_global_func("tvm.pipeline_executor.create", allow_missing=True) is not None
 
 
+def relax_vm_stage(vm, func_name="main"):
+    """Create a pipeline stage which runs a function of a Relax virtual machine.
+
+    The stage can be used in the module list of "tvm.pipeline_executor.create" in place of
+    a graph executor module. Its outputs are new NDArrays in every run, so they are forwarded
+    to the next stage by reference instead of by a copy.
+
+    Parameters
+    ----------
+    vm : tvm.relax.VirtualMachine
+        The initialized virtual machine, each stage should use its own virtual machine.
+
+    func_name : str
+        The name of the function run by the stage.
+
+    Returns
+    -------
+    stage : Module
+        The stage module.
+    """
+    create_stage = get_global_func("tvm.pipeline_executor.relax_vm_stage", allow_missing=False)
+    return create_stage(vm.module, func_name)
+
+
 class PipelineModule(object):
     """Wrapper of runtime module, caller can use this module to set parameters and get outputs.
 
@@ -16,7 +16,18 @@
 # under the License.
 # pylint: disable=unused-import
 """Common data structures across all IR variants."""
-from .base import SourceName, Span, Node, EnvFunc, load_json, save_json
+from .base import (
+    SourceName,
+    Span,
+    Node,
+    EnvFunc,
+    load_json,
+    save_json,
+    load_binary,
+    save_binary,
+    load_binary_file,
+    save_binary_file,
+)
 from .base import structural_equal, assert_structural_equal, structural_hash
 from .type import Type, TypeKind, PrimType, PointerType, TypeVar, GlobalTypeVar, TupleType
 from .type import TypeConstraint, FuncType, IncompleteType, RelayRefType
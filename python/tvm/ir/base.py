@@ -157,7 +157,73 @@ def save_json(node):
     return tvm.runtime._ffi_node_api.SaveJSON(node)
 
 
-def structural_equal(lhs, rhs, map_free_vars=False):
+def save_binary(node):
+    """Save tvm object in the binary format, which is more compact and faster to load than json.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    Returns
+    -------
+    data : bytearray
+        The saved bytes.
+    """
+    return tvm.runtime._ffi_node_api.SaveBinary(node)
+
+
+def load_binary(data):
+    """Load tvm object from the bytes of the binary format.
+
+    Parameters
+    ----------
+    data : Union[bytes, bytearray]
+        The saved bytes.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinary(bytearray(data))
+
+
+def save_binary_file(node, path):
+    """Save tvm object to a file in the binary format, without holding the bytes in memory.
+
+    Parameters
+    ----------
+    node : Object
+        A TVM object to be saved.
+
+    path : str
+        The path of the file.
+    """
+    tvm.runtime._ffi_node_api.SaveBinaryToFile(node, path)
+
+
+def load_binary_file(path, use_mmap=True):
+    """Load tvm object from a file in the binary format.
+
+    Parameters
+    ----------
+    path : str
+        The path of the file.
+
+    use_mmap : bool
+        Whether to memory map the file, so that the NDArrays of the object refer to its private
+        mapping in place and are only read from disk when first touched.
+
+    Returns
+    -------
+    node : Object
+        The loaded tvm node.
+    """
+    return tvm.runtime._ffi_node_api.LoadBinaryFromFile(path, use_mmap)
+
+
+def structural_equal(lhs, rhs, map_free_vars=False, cached=False):
     """Check structural equality of lhs and rhs.
 
     The structural equality is recursively defined in the DAG of IRNodes.
@@ -194,6 +260,12 @@ def structural_equal(lhs, rhs, map_free_vars=False):
         Whether or not shall we map free vars that does
         not bound to any definitions as equal to each other.
 
+    cached : bool
+        If cached is set to true, the operands are first compared by identity and
+        by their structural hash values cached as in structural_hash, so that the
+        full comparison only runs when the hash values match.
+        Floats differing within the tolerance of the comparison then compare unequal.
+
     Return
     ------
     result : bool
@@ -206,6 +278,8 @@ def structural_equal(lhs, rhs, map_free_vars=False):
     """
     lhs = tvm.runtime.convert(lhs)
     rhs = tvm.runtime.convert(rhs)
+    if cached:
+        return bool(tvm.runtime._ffi_node_api.CachedStructuralEqual(lhs, rhs, map_free_vars))
     return bool(tvm.runtime._ffi_node_api.StructuralEqual(lhs, rhs, False, map_free_vars))
 
 
@@ -237,7 +311,7 @@ def assert_structural_equal(lhs, rhs, map_free_vars=False):
     tvm.runtime._ffi_node_api.StructuralEqual(lhs, rhs, True, map_free_vars)
 
 
-def structural_hash(node, map_free_vars=False):
+def structural_hash(node, map_free_vars=False, cached=False):
     """Compute structural hash of node
 
     The structural hash value is recursively defined in the DAG of IRNodes.
@@ -267,6 +341,11 @@ def structural_hash(node, map_free_vars=False):
         by the order of their occurences. Otherwise, we will hash by
         their in-memory pointer address.
 
+    cached : bool
+        If cached is set to true, the hash value is memoized by the identity of
+        the node, so that hashing the same node again does not revisit it.
+        As IR nodes are immutable, the cached value never goes stale.
+
     Return
     ------
     result : int
@@ -276,4 +355,6 @@ def structural_hash(node, map_free_vars=False):
     --------
     structrual_equal
     """
+    if cached:
+        return tvm.runtime._ffi_node_api.CachedStructuralHash(node, map_free_vars)
     return tvm.runtime._ffi_node_api.StructuralHash(node, map_free_vars)
@@ -146,6 +146,17 @@ class IRModule(Node):
         """
         return _ffi_api.Module_UpdateFunction(self, var, func)
 
+    def update_funcs(self, funcs):
+        """Update a batch of functions in the module. The functions which are unchanged are
+        skipped, so the function map is only copied when a function changes.
+
+        Parameters
+        ----------
+        funcs: Dict[GlobalVar, BaseFunc]
+            The map from the global variables to their new functions.
+        """
+        return _ffi_api.Module_UpdateFunctions(self, funcs)
+
     def get_global_var(self, name):
         """Get a global variable in the function by name.
 
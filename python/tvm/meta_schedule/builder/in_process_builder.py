@@ -0,0 +1,66 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""In-process builder keeping the built modules in memory"""
+from typing import Optional
+
+from tvm._ffi import register_object
+from tvm.runtime import Module
+
+from .. import _ffi_api
+from ..utils import cpu_count
+from .builder import Builder
+
+IN_MEMORY_ARTIFACT_PREFIX = "memory://"
+
+
+@register_object("meta_schedule.InProcessBuilder")
+class InProcessBuilder(Builder):
+    """A builder which lowers and compiles the candidates on a thread pool of the current
+    process, and keeps the built modules in memory instead of exporting them.
+
+    It saves the process startup and the library export of LocalBuilder, but a crash or a hang
+    in compilation is not isolated. The artifacts can only be run by a runner in the same
+    process, e.g. LocalRunner, and are released by `remove_in_memory_artifact`.
+
+    Parameters
+    ----------
+    max_workers : Optional[int]
+        The number of threads to build with. Defaults to the number of physical CPU cores.
+    """
+
+    def __init__(self, max_workers: Optional[int] = None) -> None:
+        if max_workers is None:
+            max_workers = cpu_count(logical=False)
+        self.__init_handle_by_constructor__(
+            _ffi_api.BuilderInProcessBuilder,  # type: ignore # pylint: disable=no-member
+            max_workers,
+        )
+
+
+def is_in_memory_artifact(artifact_path: str) -> bool:
+    """Check if an artifact is a module kept in memory by InProcessBuilder."""
+    return str(artifact_path).startswith(IN_MEMORY_ARTIFACT_PREFIX)
+
+
+def load_in_memory_artifact(artifact_path: str) -> Module:
+    """Get the module of an in-memory artifact."""
+    return _ffi_api.InMemoryArtifactGet(artifact_path)  # type: ignore # pylint: disable=no-member
+
+
+def remove_in_memory_artifact(artifact_path: str) -> None:
+    """Release the module of an in-memory artifact."""
+    _ffi_api.InMemoryArtifactRemove(artifact_path)  # type: ignore # pylint: disable=no-member
@@ -27,9 +27,9 @@ from typing import TYPE_CHECKING, Any, Callable, Dict, List, NamedTuple, Optiona
 import numpy as np  # type: ignore
 
 from ...contrib.tar import tar, untar
-from ...runtime import NDArray
 from ..cost_model import PyCostModel
 from ..feature_extractor import FeatureExtractor
+from ..profiler import Profiler
 from ..runner import RunnerResult
 from ..search_strategy import MeasureCandidate
 from ..utils import cpu_count, derived_object, shash2hex
@@ -59,6 +59,17 @@ def make_metric_sorter(focused_metric):
     return sort_key
 
 
+def _extract_features(
+    extractor: FeatureExtractor,
+    context: "TuneContext",
+    candidates: List[MeasureCandidate],
+) -> List[np.ndarray]:
+    """Extract the float32 features of each candidate, as views of one batched feature matrix."""
+    with Profiler.timeit("XGBModel/FeatureExtraction"):
+        features, row_offsets = extractor.extract_batched_from(context, candidates)
+    return np.split(features.numpy(), row_offsets.numpy()[1:-1])
+
+
 class PackSum:
     """The pack-sum format
 
@@ -300,6 +311,10 @@ class XGBModel(PyCostModel):
         The number to calculate average peak score.
     adaptive_training : bool
         Whether use adpative training to reduce tuning time.
+    online_fine_tune : bool
+        Whether to retrain a loaded model on the results of the session. When False, a model
+        loaded from a previous session, e.g. to warm-start the tuning of a new model, is kept
+        as is, and the results are only recorded for saving.
     """
 
     # feature extractor
@@ -319,6 +334,7 @@ class XGBModel(PyCostModel):
     # adaptive training
     adaptive_training: bool
     last_train_size: int
+    online_fine_tune: bool
 
     def __init__(
         self,
@@ -334,6 +350,7 @@ class XGBModel(PyCostModel):
         verbose_eval: int = 25,
         average_peak_n: int = 32,
         adaptive_training: bool = True,
+        online_fine_tune: bool = True,
     ):
         super().__init__()
         # feature extractor
@@ -356,6 +373,7 @@ class XGBModel(PyCostModel):
         # adaptive training
         self.adaptive_training = adaptive_training
         self.last_train_size = 0
+        self.online_fine_tune = online_fine_tune
 
     def load(self, path: str) -> None:
         """Load the cost model from given file location.
@@ -389,14 +407,15 @@ class XGBModel(PyCostModel):
                 )
                 data_size += len(costs)
             # Step 3. Load the model
+            booster = None
             if os.path.exists(model_path):
                 booster = xgb.Booster()
                 booster.load_model(model_path)
-            else:
-                self.booster = None
         self.data = data
         self.data_size = data_size
         self.booster = booster
+        # The loaded data is trained on, so only new results count towards adaptive training.
+        self.last_train_size = data_size
 
     def save(self, path: str) -> None:
         """Save the cost model to given file location.
@@ -464,15 +483,12 @@ class XGBModel(PyCostModel):
         group = self.data.get(new_group_hash, None)
 
         # Step 2. Extract features
-        def _feature(x: NDArray) -> np.ndarray:
-            return x.numpy().astype("float32")
-
         def _mean_cost(x: RunnerResult) -> float:
             if not x.run_secs:
                 return 1e10
             return float(np.median([float(s) for s in x.run_secs]))
 
-        new_features = [_feature(x) for x in self.extractor.extract_from(context, candidates)]
+        new_features = _extract_features(self.extractor, context, candidates)
         new_mean_costs = np.array([_mean_cost(x) for x in results]).astype("float32")
 
         # Steps 3. Run validation
@@ -500,6 +516,8 @@ class XGBModel(PyCostModel):
         self.data[new_group_hash] = group
         self.data_size += len(new_features)
 
+        if not self.online_fine_tune and self.booster is not None:
+            return
         if (
             self.adaptive_training
             and self.data_size - self.last_train_size < self.last_train_size / 5
@@ -510,13 +528,14 @@ class XGBModel(PyCostModel):
         self.last_train_size = self.data_size
 
         # Step 5. Re-train the model
-        self._train(
-            xs=list(itertools_chain.from_iterable([g.features for g in self.data.values()])),
-            ys=np.concatenate(
-                [g.min_cost / g.costs for g in self.data.values()],
-                axis=0,
-            ),
-        )
+        with Profiler.timeit("XGBModel/Train"):
+            self._train(
+                xs=list(itertools_chain.from_iterable([g.features for g in self.data.values()])),
+                ys=np.concatenate(
+                    [g.min_cost / g.costs for g in self.data.values()],
+                    axis=0,
+                ),
+            )
 
     def predict(
         self,
@@ -538,15 +557,9 @@ class XGBModel(PyCostModel):
             The predicted normalized score.
         """
         if self.data_size >= self.num_warmup_samples and self.booster is not None:
-            ret = self._predict(
-                xs=[
-                    x.numpy().astype("float32")
-                    for x in self.extractor.extract_from(
-                        context,
-                        candidates,
-                    )
-                ]
-            )
+            features = _extract_features(self.extractor, context, candidates)
+            with Profiler.timeit("XGBModel/Predict"):
+                ret = self._predict(xs=features)
         else:
             ret = np.random.uniform(
                 low=0,
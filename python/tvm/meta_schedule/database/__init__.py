@@ -18,6 +18,6 @@
 The tvm.meta_schedule.database package.
 The database that stores serialized tuning records and workloads
 """
-from .database import Database, PyDatabase, TuningRecord, Workload
+from .database import Database, PyDatabase, TuningRecord, Workload, WorkloadRegistry
 from .json_database import JSONDatabase
 from .memory_database import MemoryDatabase
@@ -74,6 +74,37 @@ class Workload(Object):
         return _ffi_api.WorkloadFromJSON(json_obj)  # type: ignore # pylint: disable=no-member
 
 
+class WorkloadRegistry:
+    """The process-wide table of workloads, shared by the MetaSchedule and the Relax tuning
+    databases, so that they hold one copy of each module, hashed once."""
+
+    @staticmethod
+    def intern(mod: IRModule) -> Workload:
+        """Get the canonical workload of a module, adding it to the table if missing.
+
+        Parameters
+        ----------
+        mod : IRModule
+            The module.
+
+        Returns
+        -------
+        workload : Workload
+            The canonical workload, shared by every module structurally equal to mod.
+        """
+        return _ffi_api.WorkloadRegistryIntern(mod)  # type: ignore # pylint: disable=no-member
+
+    @staticmethod
+    def size() -> int:
+        """The number of workloads in the table."""
+        return _ffi_api.WorkloadRegistrySize()  # type: ignore # pylint: disable=no-member
+
+    @staticmethod
+    def clear() -> None:
+        """Remove every workload from the table."""
+        _ffi_api.WorkloadRegistryClear()  # type: ignore # pylint: disable=no-member
+
+
 @register_object("meta_schedule.TuningRecord")
 class TuningRecord(Object):
     """The class of tuning records.
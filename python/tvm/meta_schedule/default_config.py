@@ -142,13 +142,21 @@ def callbacks(  # pylint: disable=redefined-outer-name
 def cost_model(
     cost_model: Optional[CostModel],  # pylint: disable=redefined-outer-name
     adpative_training: Optional[bool],
+    warm_start: Optional[str] = None,
+    online_fine_tune: bool = True,
 ) -> CostModel:
-    """Normalize the input to tvm.meta_schedule.CostModel"""
+    """Normalize the input to tvm.meta_schedule.CostModel. The default model is loaded from
+    `warm_start` if it names an existing file."""
     if cost_model is None:
-        return XGBModel(  # type: ignore
+        model = XGBModel(  # type: ignore
             extractor=PerStoreFeature(),
             adaptive_training=adpative_training is None or adpative_training,
+            online_fine_tune=online_fine_tune,
         )
+        if warm_start is not None and osp.exists(warm_start):
+            logger.info("Warm-starting the cost model from: %s", warm_start)
+            model.load(warm_start)
+        return model
     if not isinstance(cost_model, CostModel):
         raise TypeError(f"Expected `cost_model` to be CostModel, but gets: {cost_model}")
     return cost_model
@@ -179,6 +187,9 @@ def schedule_rules(  # pylint: disable=redefined-outer-name
     if sch_rules is not None:
         raise TypeError(f"Expected `sch_rules` to be None or callable, but gets: {sch_rules}")
     if target.kind.name == "llvm":
+        amx_intrins = _amx_intrins(target)
+        if amx_intrins:
+            return _DefaultLLVMAMX.schedule_rules(amx_intrins)
         return _DefaultLLVM.schedule_rules()
     if target.kind.name in ["cuda", "rocm", "vulkan"]:
         return _DefaultCUDA.schedule_rules()
@@ -195,6 +206,8 @@ def postproc(  # pylint: disable=redefined-outer-name
     if postproc is not None:
         raise TypeError(f"Expected `postproc` to be None or callable, but gets: {postproc}")
     if target.kind.name == "llvm":
+        if _amx_intrins(target):
+            return _DefaultLLVMAMX.postprocs()
         return _DefaultLLVM.postprocs()
     if target.kind.name in ["cuda", "rocm", "vulkan"]:
         return _DefaultCUDA.postprocs()
@@ -281,6 +294,56 @@ class _DefaultLLVM:
         }
 
 
+def _amx_intrins(target: Target) -> List[str]:
+    """The AMX tensor intrinsics supported by the target."""
+    from tvm.tir.tensor_intrin import x86  # pylint: disable=import-outside-toplevel
+
+    mattr = [str(attr) for attr in target.attrs.get("mattr", [])]
+    sapphirerapids = target.attrs.get("mcpu", "") == "sapphirerapids"
+    intrins = []
+    if sapphirerapids or "+amx-int8" in mattr:
+        intrins.append(x86.AMX_DOT_16x16x64_INT8_INTRIN)
+    if sapphirerapids or "+amx-bf16" in mattr:
+        intrins.append(x86.AMX_DOT_16x16x32_BF16_INTRIN)
+    return intrins
+
+
+class _DefaultLLVMAMX:
+    """Default tuning configuration for LLVM with the AMX tiles of x86."""
+
+    @staticmethod
+    def schedule_rules(intrins: List[str]) -> List[ScheduleRule]:
+        from tvm.meta_schedule import schedule_rule as M
+
+        rules = _DefaultLLVM.schedule_rules()
+        # The blocks matching an intrinsic are tiled for it, the others by MultiLevelTiling.
+        tiling_index = [isinstance(rule, M.MultiLevelTiling) for rule in rules].index(True)
+        for i, intrin in enumerate(intrins):
+            rules.insert(
+                tiling_index + i,
+                M.MultiLevelTilingWithIntrin(
+                    intrin,
+                    structure="SSRSRS",
+                    tile_binds=None,
+                    max_innermost_factor=64,
+                    vector_load_lens=None,
+                    reuse_read=None,
+                    reuse_write=M.ReuseType(
+                        req="may",
+                        levels=[1, 2],
+                        scope="global",
+                    ),
+                ),
+            )
+        return rules
+
+    @staticmethod
+    def postprocs() -> List[Postproc]:
+        from tvm.meta_schedule import postproc as M
+
+        return _DefaultLLVM.postprocs() + [M.RewriteTensorize(vectorize_init_loop=True)]
+
+
 class _DefaultCUDA:
     """Default tuning configuration for CUDA."""
 
@@ -289,6 +352,10 @@ class _DefaultCUDA:
         from tvm.meta_schedule import schedule_rule as M
 
         return [
+            M.SplitK(
+                split_factors=[2, 4, 8, 16],
+                thread_extents=[32, 64, 128, 256],
+            ),
             M.MultiLevelTiling(
                 structure="SSSRRSRS",
                 tile_binds=["blockIdx.x", "vthread.x", "threadIdx.x"],
@@ -337,6 +404,7 @@ class _DefaultCUDA:
             M.RewriteUnboundBlock(),
             M.RewriteParallelVectorizeUnroll(),
             M.RewriteReductionBlock(),
+            M.RewriteSoftwarePipeline(),
             M.VerifyGPUCode(),
         ]
 
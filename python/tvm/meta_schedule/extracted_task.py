@@ -15,8 +15,9 @@
 # specific language governing permissions and limitations
 # under the License.
 """Extracted tasks from high-level IR."""
-from typing import List
+from typing import Dict, List
 
+from tvm import tir
 from tvm._ffi import register_object
 from tvm.ir import IRModule
 from tvm.runtime import Object
@@ -64,3 +65,63 @@ class ExtractedTask(Object):
             dispatched,
             weight,
         )
+
+    def _prim_func(self) -> tir.PrimFunc:
+        funcs = [f for f in self.dispatched[0].functions.values() if isinstance(f, tir.PrimFunc)]
+        assert len(funcs) == 1, "A task is expected to dispatch to a single PrimFunc"
+        return funcs[0]
+
+    def symbolic_vars(self) -> List[str]:
+        """The names of the symbolic variables in the buffer shapes of the task.
+
+        Returns
+        -------
+        names : List[str]
+            The names, in the order of the parameters. Empty if the task is static.
+        """
+        names: List[str] = []
+        func = self._prim_func()
+        for param in func.params:
+            if param not in func.buffer_map:
+                continue
+            for dim in func.buffer_map[param].shape:
+                if isinstance(dim, tir.Var) and dim.name not in names:
+                    names.append(dim.name)
+        return names
+
+    def specialize(self, bindings: Dict[str, int], weight: int) -> "ExtractedTask":
+        """Specialize the symbolic shapes of the task with concrete values.
+
+        Parameters
+        ----------
+        bindings : Dict[str, int]
+            The values of the symbolic variables, by name.
+        weight : int
+            The weight of the specialized task.
+
+        Returns
+        -------
+        task : ExtractedTask
+            The task of the specialized PrimFunc, named after the task and the values.
+        """
+        func = self._prim_func()
+        param_map = {}
+        for param in func.params:
+            if param not in func.buffer_map:
+                if param.name in bindings:
+                    param_map[param] = tir.IntImm(param.dtype, bindings[param.name])
+                continue
+            buf = func.buffer_map[param]
+            if not any(isinstance(d, tir.Var) and d.name in bindings for d in buf.shape):
+                continue
+            shape = [
+                tir.IntImm(d.dtype, bindings[d.name])
+                if isinstance(d, tir.Var) and d.name in bindings
+                else d
+                for d in buf.shape
+            ]
+            param_map[param] = tir.decl_buffer(shape, buf.dtype, buf.name)
+        (gvar,) = self.dispatched[0].get_global_vars()
+        mod = IRModule({gvar: func.specialize(param_map)})
+        suffix = "_".join(f"{name}{value}" for name, value in sorted(bindings.items()))
+        return ExtractedTask(f"{self.task_name}_{suffix}", mod, self.target, [mod], weight)
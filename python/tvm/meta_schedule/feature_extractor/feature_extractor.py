@@ -15,7 +15,7 @@
 # specific language governing permissions and limitations
 # under the License.
 """Meta Schedule FeatureExtractor."""
-from typing import Callable, List
+from typing import Callable, List, Tuple
 
 from tvm._ffi import register_object
 from tvm.runtime import Object
@@ -53,6 +53,33 @@ class FeatureExtractor(Object):
         )
         return result
 
+    def extract_batched_from(
+        self, context: TuneContext, candidates: List[MeasureCandidate]
+    ) -> Tuple[NDArray, NDArray]:
+        """Extract features from the given measure candidates into one contiguous matrix.
+
+        Parameters
+        ----------
+        context : TuneContext
+            The tuning context for feature extraction.
+        candidates : List[MeasureCandidate]
+            The measure candidates to extract features from.
+
+        Returns
+        -------
+        features : NDArray
+            The float32 feature matrix, whose rows are the feature vectors of all the candidates
+            one after another.
+        row_offsets : NDArray
+            The int64 row offsets of length `len(candidates) + 1`, where the rows of the i-th
+            candidate are `features[row_offsets[i] : row_offsets[i + 1]]`.
+        """
+        # pylint: disable=no-member
+        features, row_offsets = _ffi_api.FeatureExtractorExtractBatchedFrom(  # type: ignore
+            self, context, candidates
+        )
+        return features, row_offsets
+
 
 @register_object("meta_schedule.PyFeatureExtractor")
 class _PyFeatureExtractor(FeatureExtractor):
@@ -37,6 +37,9 @@ class PerStoreFeature(FeatureExtractor):
         The number of bytes in a cache line.
     extract_workload : bool
         Whether to extract features in the workload in tuning context or not.
+    feature_cache_size : int
+        The max number of deduplicated candidates to keep the features of, so that structurally
+        equal candidates are not extracted again. 0 disables the cache.
     """
 
     buffers_per_store: int
@@ -47,6 +50,8 @@ class PerStoreFeature(FeatureExtractor):
     """The number of bytes in a cache line."""
     extract_workload: bool
     """Whether to extract features in the workload in tuning context or not."""
+    feature_cache_size: int
+    """The max number of deduplicated candidates to keep the features of."""
     feature_vector_length: int
     """Length of the feature vector."""
 
@@ -56,6 +61,7 @@ class PerStoreFeature(FeatureExtractor):
         arith_intensity_curve_num_samples: int = 10,
         cache_line_bytes: int = 64,
         extract_workload: bool = False,
+        feature_cache_size: int = 4096,
     ):
         self.__init_handle_by_constructor__(
             _ffi_api.FeatureExtractorPerStoreFeature,  # type: ignore # pylint: disable=no-member
@@ -63,4 +69,5 @@ class PerStoreFeature(FeatureExtractor):
             arith_intensity_curve_num_samples,
             cache_line_bytes,
             extract_workload,
+            feature_cache_size,
         )
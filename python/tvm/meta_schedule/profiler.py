@@ -16,9 +16,10 @@
 # under the License.
 """A context manager that profiles tuning time cost for different parts."""
 
+import json
 import logging
 from contextlib import contextmanager
-from typing import Dict, Optional
+from typing import Any, Dict, Optional
 
 from tvm._ffi import register_object
 from tvm.runtime import Object
@@ -45,6 +46,26 @@ class Profiler(Object):
         """Get the profiling results in a table format"""
         return _ffi_api.ProfilerTable(self)  # type: ignore # pylint: disable=no-member
 
+    def json(self) -> Dict[str, Any]:
+        """Get the profiling results in seconds, with the breakdown of each task, in the format of
+
+        .. code-block:: python
+
+            {
+                "stats_sec": {"Total": ..., "SendToBuilder": ..., ...},
+                "tasks": {
+                    "<task name>": {
+                        "stats_sec": {"Total": ..., "SendToBuilder": ..., ...},
+                        "num_trials": ...,
+                        "trials_per_sec": ...,
+                    },
+                },
+            }
+
+        where the total time of a task is the time the scheduler spent on it.
+        """
+        return json.loads(_ffi_api.ProfilerJSON(self))  # type: ignore # pylint: disable=no-member
+
     def __enter__(self) -> "Profiler":
         """Entering the scope of the context manager"""
         _ffi_api.ProfilerEnterWithScope(self)  # type: ignore # pylint: disable=no-member
@@ -73,3 +94,18 @@ class Profiler(Object):
                     f()
 
         return _timeit()
+
+    @staticmethod
+    def task(name: str):
+        """Attribute the blocks of code timed in the scope to a task"""
+
+        @contextmanager
+        def _task():
+            try:
+                f = _ffi_api.ProfilerTaskScope(name)  # type: ignore # pylint: disable=no-member
+                yield
+            finally:
+                if f:
+                    f()
+
+        return _task()
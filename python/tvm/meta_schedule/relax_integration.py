@@ -23,12 +23,14 @@ from tvm.meta_schedule import ExtractedTask
 from tvm.target import Target
 
 from tvm.runtime import NDArray
+from tvm.runtime.profiling import Report
 
 
 def extract_task_from_relax(
     mod: IRModule,
     target: Target,
     params: Optional[Dict[str, NDArray]] = None,
+    profile: Optional[Report] = None,
 ) -> List[ExtractedTask]:
     """Extract tuning tasks from a relax program.
 
@@ -38,6 +40,12 @@ def extract_task_from_relax(
         The module or function to tune
     target : tvm.target.Target
         The compilation target
+    params : Optional[Dict[str, NDArray]]
+        The params to bind to the main function
+    profile : Optional[tvm.runtime.profiling.Report]
+        A report of VirtualMachine.profile on a representative input. When given, the weight of
+        a task is the number of calls of its kernels in the report rather than the number of
+        call sites, so that loops and the dynamic shapes actually run are accounted for.
 
     Returns
     -------
@@ -64,4 +72,4 @@ def extract_task_from_relax(
     if params:
         mod = BindParams("main", params)(mod)
 
-    return list(extract_task_func(mod, target))
+    return list(extract_task_func(mod, target, profile))
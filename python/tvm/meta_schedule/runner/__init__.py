@@ -20,5 +20,6 @@ Meta Schedule runners that runs an artifact either locally or through the RPC in
 """
 from .config import EvaluatorConfig, RPCConfig
 from .rpc_runner import RPCRunner
+from .persistent_rpc_runner import PersistentRPCRunner
 from .local_runner import LocalRunner, LocalRunnerFuture
 from .runner import PyRunner, Runner, RunnerFuture, RunnerInput, RunnerResult, PyRunnerFuture
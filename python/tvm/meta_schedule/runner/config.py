@@ -41,6 +41,17 @@ class EvaluatorConfig(NamedTuple):
         increase the number of runs to the given time (in ms) to reduce the measurement error.
     enable_cpu_cache_flush: bool
         Whether to flush the cache on CPU.
+    adaptive_max_repeat: int
+        The maximum number of repeats per set of arguments in adaptive evaluation, which is
+        enabled when it is larger than `repeat`. A candidate is measured `repeat` times first,
+        then again `repeat` times at a go until it has `adaptive_max_repeat` costs per set of
+        arguments, unless it is dropped as clearly slower than the best candidate so far.
+    adaptive_margin: float
+        The relative margin by which the lower confidence bound of the latency of a candidate
+        must exceed the latency of the best candidate so far for its measurement to stop.
+    reference_sec: Optional[float]
+        The latency of the best candidate so far of the workload in adaptive evaluation.
+        The runners set it for each candidate.
 
     Note
     ----
@@ -52,6 +63,14 @@ class EvaluatorConfig(NamedTuple):
     repeat: int = 1
     min_repeat_ms: int = 100
     enable_cpu_cache_flush: bool = False
+    adaptive_max_repeat: int = 0
+    adaptive_margin: float = 0.1
+    reference_sec: Optional[float] = None
+
+    @property
+    def adaptive(self) -> bool:
+        """Whether the evaluation is adaptive."""
+        return self.adaptive_max_repeat > self.repeat
 
     @staticmethod
     def _normalized(config: Optional["EvaluatorConfig"]) -> "EvaluatorConfig":
@@ -62,6 +81,9 @@ class EvaluatorConfig(NamedTuple):
             repeat=config.repeat,
             min_repeat_ms=config.min_repeat_ms,
             enable_cpu_cache_flush=config.enable_cpu_cache_flush,
+            adaptive_max_repeat=config.adaptive_max_repeat,
+            adaptive_margin=config.adaptive_margin,
+            reference_sec=config.reference_sec,
         )
         return config
 
@@ -23,6 +23,7 @@ import tvm
 
 from ...contrib.popen_pool import PopenPoolExecutor
 from ...runtime import Device, Module
+from ..builder.in_process_builder import is_in_memory_artifact, load_in_memory_artifact
 from ..profiler import Profiler
 from ..utils import derived_object, get_global_func_with_default_on_worker
 from .config import EvaluatorConfig
@@ -30,6 +31,7 @@ from .runner import PyRunner, PyRunnerFuture, RunnerFuture, RunnerInput, RunnerR
 from .utils import (
     T_ARG_INFO_JSON_OBJ_LIST,
     T_ARGUMENT_LIST,
+    BestCostTracker,
     alloc_argument_common,
     run_evaluator_common,
 )
@@ -143,7 +145,10 @@ def _worker_func(
     with resource_handler():
         # Step 1: create the local runtime module
         with Profiler.timeit("LocalRunner/load_module"):
-            rt_mod = tvm.runtime.load_module(artifact_path)
+            if is_in_memory_artifact(artifact_path):
+                rt_mod = load_in_memory_artifact(artifact_path)
+            else:
+                rt_mod = tvm.runtime.load_module(artifact_path)
         # Step 2: Allocate input arguments
         with Profiler.timeit("LocalRunner/alloc_argument"):
             device = tvm.runtime.device(dev_type=device_type, dev_id=0)
@@ -271,6 +276,7 @@ class LocalRunner(PyRunner):
         self.f_alloc_argument = f_alloc_argument
         self.f_run_evaluator = f_run_evaluator
         self.f_cleanup = f_cleanup
+        self._best_costs = BestCostTracker()
 
         logger.info("LocalRunner: max_workers = 1")
         self.pool = PopenPoolExecutor(
@@ -283,19 +289,25 @@ class LocalRunner(PyRunner):
     def run(self, runner_inputs: List[RunnerInput]) -> List[RunnerFuture]:
         results: List[RunnerFuture] = []
         for runner_input in runner_inputs:
-            future = self.pool.submit(
-                _worker_func,
+            args_info = tuple(arg_info.as_json() for arg_info in runner_input.args_info)
+            key = BestCostTracker.workload_key(str(runner_input.device_type), args_info)
+            args = (
                 self.f_alloc_argument,
                 self.f_run_evaluator,
                 self.f_cleanup,
-                self.evaluator_config,
+                self._best_costs.config_for(key, self.evaluator_config),
                 self.alloc_repeat,
                 str(runner_input.artifact_path),
                 str(runner_input.device_type),
-                tuple(arg_info.as_json() for arg_info in runner_input.args_info),
+                args_info,
             )
             try:
-                result: List[float] = future.result()
+                if is_in_memory_artifact(runner_input.artifact_path):
+                    # Modules built by InProcessBuilder only live in this process,
+                    # so they are run here, without the timeout of the worker
+                    result: List[float] = _worker_func(*args)
+                else:
+                    result = self.pool.submit(_worker_func, *args).result()
                 error_message: str = None
             except TimeoutError:
                 result = None
@@ -303,6 +315,7 @@ class LocalRunner(PyRunner):
             except Exception as exception:  # pylint: disable=broad-except
                 result = None
                 error_message = "LocalRunner: An exception occurred\n" + str(exception)
+            self._best_costs.update(key, result)
             local_future = LocalRunnerFuture(res=result, error_message=error_message)
             results.append(local_future)  # type: ignore
         return results
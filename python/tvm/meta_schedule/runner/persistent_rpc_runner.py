@@ -0,0 +1,375 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""RPC Runner keeping its sessions alive across batches"""
+import concurrent.futures
+import logging
+import os.path as osp
+import queue
+import struct
+import threading
+from typing import Callable, Dict, List, Optional, Tuple, Union
+
+from tvm.rpc import RPCSession
+from tvm.rpc.base import RPC_SESS_MASK
+from tvm.runtime import Device, Module
+
+from ..profiler import Profiler
+from ..utils import derived_object, get_global_func_on_rpc_session
+from .config import EvaluatorConfig, RPCConfig
+from .runner import PyRunner, PyRunnerFuture, RunnerFuture, RunnerInput, RunnerResult
+from .utils import (
+    T_ARG_INFO_JSON_OBJ_LIST,
+    T_ARGUMENT_LIST,
+    BestCostTracker,
+    alloc_argument_common,
+    run_evaluator_common,
+)
+
+logger = logging.getLogger(__name__)  # pylint: disable=invalid-name
+
+T_CREATE_SESSION = Callable[  # pylint: disable=invalid-name
+    [RPCConfig],  # The RPC configuration
+    RPCSession,  # The RPC Session
+]
+# The artifact path, the device type and the argument information of a candidate
+T_CANDIDATE = Tuple[str, str, T_ARG_INFO_JSON_OBJ_LIST]  # pylint: disable=invalid-name
+# The costs of a candidate, or the error message of its failure
+T_CANDIDATE_RESULT = Union[List[float], str]  # pylint: disable=invalid-name
+
+
+class _Batch:
+    """A batch of candidates measured on one session, started when a session is free"""
+
+    def __init__(self) -> None:
+        self.started = threading.Event()
+        self.future: Optional[concurrent.futures.Future] = None
+
+
+@derived_object
+class PersistentRPCRunnerFuture(PyRunnerFuture):
+    """The future of a candidate measured by PersistentRPCRunner
+
+    Parameters
+    ----------
+    batch: _Batch
+        The batch the candidate is measured in.
+    index: int
+        The index of the candidate in the batch.
+    timeout_sec: float
+        The timeout of the batch in seconds, counted from the time it starts.
+    """
+
+    batch: _Batch
+    index: int
+    timeout_sec: float
+
+    def __init__(self, batch: _Batch, index: int, timeout_sec: float) -> None:
+        """Constructor
+
+        Parameters
+        ----------
+        batch: _Batch
+            The batch the candidate is measured in.
+        index: int
+            The index of the candidate in the batch.
+        timeout_sec: float
+            The timeout of the batch in seconds, counted from the time it starts.
+        """
+        super().__init__()
+        self.batch = batch
+        self.index = index
+        self.timeout_sec = timeout_sec
+
+    def done(self) -> bool:
+        return self.batch.future.done()
+
+    def result(self) -> RunnerResult:
+        self.batch.started.wait()
+        try:
+            results: List[T_CANDIDATE_RESULT] = self.batch.future.result(timeout=self.timeout_sec)
+        except concurrent.futures.TimeoutError:
+            return RunnerResult(
+                None,
+                error_msg=f"PersistentRPCRunner: Timeout, batch not done after "
+                f"{self.timeout_sec} seconds",
+            )
+        except Exception as exception:  # pylint: disable=broad-except
+            return RunnerResult(
+                None,
+                error_msg="PersistentRPCRunner: An exception occurred\n" + str(exception),
+            )
+        result = results[self.index]
+        if isinstance(result, str):
+            return RunnerResult(None, error_msg="PersistentRPCRunner: " + result)
+        return RunnerResult(result, None)
+
+
+@derived_object
+class PersistentRPCRunner(PyRunner):
+    """RPC based runner which keeps its sessions alive across batches.
+
+    Unlike RPCRunner, which opens a session per candidate, the runner holds `num_sessions`
+    sessions, e.g. one per remote board, for its whole lifetime and reconnects a session only
+    after it fails. The candidates of a `run` call are split into batches of at most
+    `batch_size`, each staged on a free session: all of its artifacts are uploaded, loaded and
+    given arguments first, then measured by a single remote call of
+    "runtime.RPCBatchTimeEvaluate", so that no upload competes with a measurement on the device.
+    The batches on different sessions are pipelined, one staging while another measures.
+    Adaptive evaluation decides after each measurement whether to go on, so it measures the
+    candidates one by one instead.
+
+    Parameters
+    ----------
+    rpc_config: RPCConfig
+        The rpc configuration. Its `session_timeout_sec` bounds the time of each candidate.
+    evaluator_config: EvaluatorConfig
+        The evaluator configuration.
+    alloc_repeat: int
+        The number of times to repeat the allocation.
+    num_sessions: int
+        The number of persistent sessions.
+    batch_size: int
+        The maximum number of candidates measured by one remote call.
+    f_create_session: Optional[T_CREATE_SESSION]
+        The function to create a session.
+    """
+
+    rpc_config: RPCConfig
+    evaluator_config: EvaluatorConfig
+    alloc_repeat: int
+    num_sessions: int
+    batch_size: int
+    f_create_session: Optional[T_CREATE_SESSION]
+
+    def __init__(
+        self,
+        rpc_config: Optional[RPCConfig] = None,
+        evaluator_config: Optional[EvaluatorConfig] = None,
+        alloc_repeat: int = 1,
+        num_sessions: int = 1,
+        batch_size: int = 16,
+        f_create_session: Optional[T_CREATE_SESSION] = None,
+    ) -> None:
+        """Constructor
+
+        Parameters
+        ----------
+        rpc_config: RPCConfig
+            The rpc configuration.
+        evaluator_config: EvaluatorConfig
+            The evaluator configuration.
+        alloc_repeat: int
+            The number of times to random fill the allocation.
+        num_sessions: int
+            The number of persistent sessions.
+        batch_size: int
+            The maximum number of candidates measured by one remote call.
+        f_create_session: Optional[T_CREATE_SESSION]
+            The function to create a session. Defaults to requesting a session without a
+            server-side time limit from the tracker.
+        """
+        super().__init__()
+        assert num_sessions > 0, "num_sessions must be positive"
+        assert batch_size > 0, "batch_size must be positive"
+        self.rpc_config = RPCConfig._normalized(rpc_config)
+        self.evaluator_config = EvaluatorConfig._normalized(evaluator_config)
+        self.alloc_repeat = alloc_repeat
+        self.num_sessions = num_sessions
+        self.batch_size = batch_size
+        self.f_create_session = f_create_session
+        logger.info("PersistentRPCRunner: num_sessions = %d", num_sessions)
+        # The idle sessions, where None stands for a session to be (re)connected
+        self._sessions: queue.Queue = queue.Queue()
+        for _ in range(num_sessions):
+            self._sessions.put(None)
+        self._pool = concurrent.futures.ThreadPoolExecutor(max_workers=num_sessions)
+        self._best_costs = BestCostTracker()
+
+    def run(self, runner_inputs: List[RunnerInput]) -> List[RunnerFuture]:
+        results: List[RunnerFuture] = []
+        timeout_sec = self.rpc_config.session_timeout_sec
+        for begin in range(0, len(runner_inputs), self.batch_size):
+            candidates: List[T_CANDIDATE] = [
+                (
+                    str(runner_input.artifact_path),
+                    str(runner_input.device_type),
+                    tuple(arg_info.as_json() for arg_info in runner_input.args_info),
+                )
+                for runner_input in runner_inputs[begin : begin + self.batch_size]
+            ]
+            batch = _Batch()
+            batch.future = self._pool.submit(self._run_batch, batch, candidates)
+            for index in range(len(candidates)):
+                results.append(
+                    PersistentRPCRunnerFuture(
+                        batch,
+                        index,
+                        timeout_sec=timeout_sec * len(candidates),
+                    )
+                )
+        return results
+
+    def _create_session(self) -> RPCSession:
+        if self.f_create_session is not None:
+            return self.f_create_session(self.rpc_config)
+        return self.rpc_config.connect_tracker().request(
+            key=self.rpc_config.tracker_key,
+            priority=self.rpc_config.session_priority,
+            session_timeout=0,
+        )
+
+    def _run_batch(self, batch: _Batch, candidates: List[T_CANDIDATE]) -> List[T_CANDIDATE_RESULT]:
+        session: Optional[RPCSession] = self._sessions.get()
+        batch.started.set()
+        healthy = False
+        try:
+            if session is None:
+                with Profiler.timeit("PersistentRPCRunner/create_session"):
+                    session = self._create_session()
+            keys = [
+                BestCostTracker.workload_key(device_type, args_info)
+                for _, device_type, args_info in candidates
+            ]
+            results, healthy = _measure_batch(
+                session,
+                [self._best_costs.config_for(key, self.evaluator_config) for key in keys],
+                self.alloc_repeat,
+                candidates,
+            )
+            for key, result in zip(keys, results):
+                if not isinstance(result, str):
+                    self._best_costs.update(key, result)
+            return results
+        finally:
+            # A session which saw a failure is dropped and reconnected by the next batch
+            self._sessions.put(session if healthy else None)
+
+
+def _measure_batch(
+    session: RPCSession,
+    evaluator_configs: List[EvaluatorConfig],
+    alloc_repeat: int,
+    candidates: List[T_CANDIDATE],
+) -> Tuple[List[T_CANDIDATE_RESULT], bool]:
+    """Measure a batch of candidates on a session, given the evaluator config of each.
+
+    Returns
+    -------
+    results: List[T_CANDIDATE_RESULT]
+        The costs or the error message of each candidate.
+    healthy: bool
+        Whether no failure occurred, hence the session can be reused.
+    """
+    results: List[T_CANDIDATE_RESULT] = [""] * len(candidates)
+    healthy = True
+    f_random_fill = get_global_func_on_rpc_session(
+        session,
+        "tvm.contrib.random.random_fill_for_measure",
+        "Please make sure 'USE_RANDOM' is turned ON in the config.cmake on the RPC server.",
+    )
+    # Step 1. Stage every candidate: upload, load and allocate its arguments
+    staged: Dict[int, Tuple[Module, Device, List[T_ARGUMENT_LIST]]] = {}
+    remote_paths: List[str] = []
+    with Profiler.timeit("PersistentRPCRunner/stage"):
+        for index, (artifact_path, device_type, args_info) in enumerate(candidates):
+            try:
+                _, remote_path = osp.split(artifact_path)
+                session.upload(artifact_path, remote_path)
+                remote_paths.append(remote_path)
+                rt_mod: Module = session.load_module(remote_path)
+                device = session.device(dev_type=device_type, dev_id=0)
+                repeated_args = alloc_argument_common(
+                    f_random_fill, device, args_info, alloc_repeat
+                )
+                staged[index] = (rt_mod, device, repeated_args)
+            except Exception as exception:  # pylint: disable=broad-except
+                results[index] = "An exception occurred when staging\n" + str(exception)
+                healthy = False
+    # Step 2. Measure the staged candidates in one remote call
+    with Profiler.timeit("PersistentRPCRunner/run_evaluator"):
+        try:
+            if evaluator_configs and evaluator_configs[0].adaptive:
+                results_of_staged = None
+            else:
+                results_of_staged = _batch_time_evaluate(session, evaluator_configs[0], staged)
+        except AttributeError:
+            # The server predates the batch call
+            results_of_staged = None
+        except Exception:  # pylint: disable=broad-except
+            # Measure the candidates one by one to tell the failing ones
+            results_of_staged = None
+            healthy = False
+        for index, (rt_mod, device, repeated_args) in staged.items():
+            if results_of_staged is not None:
+                results[index] = results_of_staged[index]
+                continue
+            try:
+                results[index] = run_evaluator_common(
+                    rt_mod, device, evaluator_configs[index], repeated_args
+                )
+            except Exception as exception:  # pylint: disable=broad-except
+                results[index] = "An exception occurred when running\n" + str(exception)
+                healthy = False
+    # Final step. Remove the artifacts, but keep the session and its workspace
+    with Profiler.timeit("PersistentRPCRunner/cleanup"):
+        try:
+            for remote_path in remote_paths:
+                session.remove(remote_path)
+                session.remove(remote_path + ".so")
+        except Exception:  # pylint: disable=broad-except
+            healthy = False
+    return results, healthy
+
+
+def _batch_time_evaluate(
+    session: RPCSession,
+    evaluator_config: EvaluatorConfig,
+    staged: Dict[int, Tuple[Module, Device, List[T_ARGUMENT_LIST]]],
+) -> Dict[int, List[float]]:
+    """Time the staged candidates by one remote call per device."""
+    f_batch = session.get_function("runtime.RPCBatchTimeEvaluate")
+    f_preproc = "cache_flush_cpu_non_first_arg" if evaluator_config.enable_cpu_cache_flush else ""
+    by_device: Dict[Tuple[int, int], List[int]] = {}
+    for index, (_, device, _) in staged.items():
+        by_device.setdefault((device.device_type, device.device_id), []).append(index)
+    results: Dict[int, List[float]] = {}
+    for (device_type, device_id), indices in by_device.items():
+        call_args: list = [
+            device_type % RPC_SESS_MASK,
+            device_id,
+            evaluator_config.number,
+            evaluator_config.repeat,
+            evaluator_config.min_repeat_ms,
+            0,  # cooldown_interval_ms
+            1,  # repeats_to_cooldown
+            f_preproc,
+            sum(len(staged[index][2]) for index in indices),
+        ]
+        for index in indices:
+            rt_mod, _, repeated_args = staged[index]
+            for args in repeated_args:
+                call_args.append(rt_mod)
+                call_args.append(len(args))
+                call_args.extend(args)
+        blob = bytearray(f_batch(*call_args))
+        costs = struct.unpack(f"{len(blob) // 8}d", blob)
+        begin = 0
+        for index in indices:
+            num_costs = len(staged[index][2]) * evaluator_config.repeat
+            results[index] = [float(cost) for cost in costs[begin : begin + num_costs]]
+            begin += num_costs
+    return results
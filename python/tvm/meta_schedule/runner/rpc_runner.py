@@ -16,6 +16,7 @@
 # under the License.
 """RPC Runner"""
 import concurrent.futures
+import functools
 import logging
 import os.path as osp
 from contextlib import contextmanager
@@ -37,6 +38,7 @@ from .runner import PyRunner, PyRunnerFuture, RunnerFuture, RunnerInput, RunnerR
 from .utils import (
     T_ARG_INFO_JSON_OBJ_LIST,
     T_ARGUMENT_LIST,
+    BestCostTracker,
     alloc_argument_common,
     run_evaluator_common,
 )
@@ -94,12 +96,20 @@ class RPCRunnerFuture(PyRunnerFuture):
         The concurrent function to check when the function is done and to return the result.
     timeout_sec: float
         The timeout in seconds.
+    f_on_result: Optional[Callable[[List[float]], None]]
+        The function called with the costs once the run succeeds.
     """
 
     future: concurrent.futures.Future
     timeout_sec: float
+    f_on_result: Optional[Callable[[List[float]], None]]
 
-    def __init__(self, future: concurrent.futures.Future, timeout_sec: float) -> None:
+    def __init__(
+        self,
+        future: concurrent.futures.Future,
+        timeout_sec: float,
+        f_on_result: Optional[Callable[[List[float]], None]] = None,
+    ) -> None:
         """Constructor
 
         Parameters
@@ -108,10 +118,13 @@ class RPCRunnerFuture(PyRunnerFuture):
             The concurrent function to check when the function is done and to return the result.
         timeout_sec: float
             The timeout in seconds.
+        f_on_result: Optional[Callable[[List[float]], None]]
+            The function called with the costs once the run succeeds.
         """
         super().__init__()
         self.future = future
         self.timeout_sec = timeout_sec
+        self.f_on_result = f_on_result
 
     def done(self) -> bool:
         return self.future.done()
@@ -129,6 +142,8 @@ class RPCRunnerFuture(PyRunnerFuture):
                 None,
                 error_msg="RPCRunner: An exception occurred\n" + str(exception),
             )
+        if self.f_on_result is not None:
+            self.f_on_result(run_secs)
         return RunnerResult(run_secs, None)
 
 
@@ -284,6 +299,7 @@ class RPCRunner(PyRunner):
         self.f_alloc_argument = f_alloc_argument
         self.f_run_evaluator = f_run_evaluator
         self.f_cleanup = f_cleanup
+        self._best_costs = BestCostTracker()
         if max_workers is None:
             max_workers = cpu_count(logical=True)
         logger.info("RPCRunner: max_workers = %d", max_workers)
@@ -297,6 +313,8 @@ class RPCRunner(PyRunner):
     def run(self, runner_inputs: List[RunnerInput]) -> List[RunnerFuture]:
         results: List[RunnerFuture] = []
         for runner_input in runner_inputs:
+            args_info = tuple(arg_info.as_json() for arg_info in runner_input.args_info)
+            key = BestCostTracker.workload_key(str(runner_input.device_type), args_info)
             future = RPCRunnerFuture(
                 future=self.pool.submit(
                     _worker_func,
@@ -306,13 +324,14 @@ class RPCRunner(PyRunner):
                     self.f_run_evaluator,
                     self.f_cleanup,
                     self.rpc_config,
-                    self.evaluator_config,
+                    self._best_costs.config_for(key, self.evaluator_config),
                     self.alloc_repeat,
                     str(runner_input.artifact_path),
                     str(runner_input.device_type),
-                    tuple(arg_info.as_json() for arg_info in runner_input.args_info),
+                    args_info,
                 ),
                 timeout_sec=self.rpc_config.session_timeout_sec,
+                f_on_result=functools.partial(self._best_costs.update, key),
             )
             results.append(future)  # type: ignore
         return results
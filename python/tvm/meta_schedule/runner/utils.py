@@ -15,8 +15,11 @@
 # specific language governing permissions and limitations
 # under the License.
 """Runner utility functions"""
-import itertools
-from typing import Any, Callable, Dict, List
+import json
+import math
+import statistics
+import threading
+from typing import Any, Callable, Dict, List, Optional
 
 from ...runtime import Device, Module, ndarray
 from .config import EvaluatorConfig
@@ -111,10 +114,65 @@ def run_evaluator_common(
         if evaluator_config.enable_cpu_cache_flush
         else "",
     )
-    repeated_costs: List[List[float]] = []
-    for args in repeated_args:
+    costs: List[float] = []
+
+    def measure(args: T_ARGUMENT_LIST) -> bool:
+        """Measure once more, and return whether to go on measuring."""
         device.sync()
         profile_result = evaluator(*args)
-        repeated_costs.append(profile_result.results)
-    costs = [float(cost) for cost in itertools.chain.from_iterable(repeated_costs)]
+        costs.extend(float(cost) for cost in profile_result.results)
+        return not evaluator_config.adaptive or not _is_clearly_worse(costs, evaluator_config)
+
+    for args in repeated_args:
+        if not measure(args):
+            return costs
+    if evaluator_config.adaptive:
+        # Spend the extra repeats on the candidates which may beat the best so far
+        max_num_costs = evaluator_config.adaptive_max_repeat * len(repeated_args)
+        i = 0
+        while len(costs) < max_num_costs and measure(repeated_args[i % len(repeated_args)]):
+            i += 1
     return costs
+
+
+def _is_clearly_worse(costs: List[float], evaluator_config: EvaluatorConfig) -> bool:
+    """Check if the lower 95% confidence bound of the mean cost exceeds the reference latency
+    by the margin. A single cost is taken as its own bound."""
+    if evaluator_config.reference_sec is None:
+        return False
+    lower_bound = costs[0]
+    if len(costs) > 1:
+        stderr = statistics.stdev(costs) / math.sqrt(len(costs))
+        lower_bound = statistics.mean(costs) - 1.96 * stderr
+    return lower_bound > evaluator_config.reference_sec * (1.0 + evaluator_config.adaptive_margin)
+
+
+class BestCostTracker:
+    """The mean cost of the best candidate measured so far of each workload, as the reference of
+    adaptive evaluation. A runner cannot see the tasks, so the workloads are told apart by the
+    device type and the argument information of the candidates."""
+
+    def __init__(self) -> None:
+        self._lock = threading.Lock()
+        self._best_secs: Dict[str, float] = {}
+
+    @staticmethod
+    def workload_key(device_type: str, args_info: T_ARG_INFO_JSON_OBJ_LIST) -> str:
+        """Get the key telling the workload of a candidate."""
+        return json.dumps([device_type, args_info], default=str)
+
+    def config_for(self, key: str, evaluator_config: EvaluatorConfig) -> EvaluatorConfig:
+        """Get the evaluator config for a candidate of the workload."""
+        if not evaluator_config.adaptive:
+            return evaluator_config
+        with self._lock:
+            return evaluator_config._replace(reference_sec=self._best_secs.get(key))
+
+    def update(self, key: str, costs: Optional[List[float]]) -> None:
+        """Record the costs of a measured candidate of the workload."""
+        if not costs:
+            return
+        mean_sec = statistics.mean(float(cost) for cost in costs)
+        with self._lock:
+            if key not in self._best_secs or mean_sec < self._best_secs[key]:
+                self._best_secs[key] = mean_sec
@@ -0,0 +1,45 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Rules which split the long reductions of the skinny GEMM-like blocks across thread blocks"""
+from typing import List
+
+from tvm._ffi import register_object
+
+from .. import _ffi_api
+from .schedule_rule import ScheduleRule
+
+
+@register_object("meta_schedule.SplitK")
+class SplitK(ScheduleRule):
+    """A schedule rule which splits the long reduction of the skinny GEMM-like blocks, e.g. the
+    matmuls with 1 to 8 rows, into partial sums computed by separate thread blocks. The partial
+    sums are stored in global memory and summed up by a cross-block reduction kernel.
+
+    Parameters
+    ----------
+    split_factors: List[int]
+        Candidates of the number of the splits (values are required to be greater than 1).
+    thread_extents: List[int]
+        Candidates of thread axis extent (values are required to be positive).
+    """
+
+    def __init__(self, split_factors: List[int], thread_extents: List[int]) -> None:
+        self.__init_handle_by_constructor__(
+            _ffi_api.ScheduleRuleSplitK,  # type: ignore # pylint: disable=no-member
+            split_factors,
+            thread_extents,
+        )
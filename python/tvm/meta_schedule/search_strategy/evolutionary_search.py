@@ -47,6 +47,9 @@ class EvolutionarySearch(SearchStrategy):
         The maximum number to retry mutation.
     eps_greedy : float
         The ratio of greedy selected samples in the final picks.
+    trace_cache_size : int
+        The number of trace prefixes whose schedules each thread caches, so that a mutated trace
+        only replays from its first changed decision. 0 disables the cache.
     """
 
     num_trials_per_iter: int
@@ -58,6 +61,7 @@ class EvolutionarySearch(SearchStrategy):
     genetic_mutate_prob: float
     genetic_max_fail_count: int
     eps_greedy: float
+    trace_cache_size: int
 
     def __init__(
         self,
@@ -71,6 +75,7 @@ class EvolutionarySearch(SearchStrategy):
         genetic_mutate_prob: float = 0.85,
         genetic_max_fail_count: int = 10,
         eps_greedy: float = 0.05,
+        trace_cache_size: int = 1024,
     ) -> None:
         """Constructor"""
         self.__init_handle_by_constructor__(
@@ -84,4 +89,5 @@ class EvolutionarySearch(SearchStrategy):
             genetic_mutate_prob,
             genetic_max_fail_count,
             eps_greedy,
+            trace_cache_size,
         )
@@ -53,6 +53,7 @@ class GradientBased(TaskScheduler):
         alpha: float = 0.2,
         window_size: int = 3,
         seed: int = -1,
+        num_inflight_tasks: int = 1,
     ) -> None:
         """Constructor.
 
@@ -80,6 +81,10 @@ class GradientBased(TaskScheduler):
             The parameter to control backward window size in gradient computation.
         seed : int = -1
             The random seed.
+        num_inflight_tasks : int = 1
+            The maximum number of tasks built and measured at once. With more than one, the
+            candidates of a task are built and sent to the runner in the background, while the
+            candidates of the next task picked by the gradients are generated.
         """
         self.__init_handle_by_constructor__(
             _ffi_api.TaskSchedulerGradientBased,  # type: ignore # pylint: disable=no-member
@@ -95,4 +100,5 @@ class GradientBased(TaskScheduler):
             alpha,
             window_size,
             seed,
+            num_inflight_tasks,
         )
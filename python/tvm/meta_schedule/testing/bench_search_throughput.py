@@ -0,0 +1,123 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Benchmark the throughput of the evolutionary search in candidates per second per thread,
+with and without the trace prefix cache."""
+# pylint: disable=missing-docstring
+import argparse
+import time
+
+import tvm
+from tvm import meta_schedule as ms
+from tvm.meta_schedule.testing.te_workload import create_te_workload
+from tvm.target import Target
+
+
+def _parse_args():
+    args = argparse.ArgumentParser()
+    args.add_argument(
+        "--workload",
+        type=str,
+        default="GMM",
+    )
+    args.add_argument(
+        "--target",
+        type=str,
+        default="llvm --num-cores=4",
+    )
+    args.add_argument(
+        "--num-threads",
+        type=int,
+        default=4,
+    )
+    args.add_argument(
+        "--population-size",
+        type=int,
+        default=512,
+    )
+    args.add_argument(
+        "--genetic-num-iters",
+        type=int,
+        default=4,
+    )
+    args.add_argument(
+        "--trace-cache-sizes",
+        type=int,
+        nargs="+",
+        default=[0, 1024],
+    )
+    parsed = args.parse_args()
+    parsed.target = Target(parsed.target)
+    return parsed
+
+
+ARGS = _parse_args()
+
+
+def bench(trace_cache_size: int) -> float:
+    """Evolve a population once, and return the candidates per second per thread."""
+    sample_init_population = tvm.get_global_func(
+        "meta_schedule.SearchStrategyEvolutionarySearchSampleInitPopulation"
+    )
+    evolve_with_cost_model = tvm.get_global_func(
+        "meta_schedule.SearchStrategyEvolutionarySearchEvolveWithCostModel"
+    )
+    strategy = ms.search_strategy.EvolutionarySearch(
+        num_trials_per_iter=64,
+        max_trials_per_task=64,
+        population_size=ARGS.population_size,
+        init_measured_ratio=0.0,
+        genetic_num_iters=ARGS.genetic_num_iters,
+        trace_cache_size=trace_cache_size,
+    )
+    mod = tvm.IRModule({"main": create_te_workload(ARGS.workload, 0)})
+    context = ms.TuneContext(
+        mod=mod,
+        target=ARGS.target,
+        space_generator=ms.space_generator.PostOrderApply(),
+        search_strategy=strategy,
+        sch_rules=ms.default_config.schedule_rules(None, ARGS.target),
+        postprocs=ms.default_config.postproc(None, ARGS.target),
+        mutator_probs=ms.default_config.mutator_probs(None, ARGS.target),
+        task_name=ARGS.workload,
+        num_threads=ARGS.num_threads,
+        rand_state=0,
+    )
+    context.pre_tuning(
+        context.generate_design_space(),
+        database=ms.database.MemoryDatabase(),
+        cost_model=ms.cost_model.RandomModel(),  # type: ignore
+    )
+    population = sample_init_population(strategy, ARGS.population_size)
+    start = time.perf_counter()
+    evolve_with_cost_model(strategy, population, len(population))
+    elapsed = time.perf_counter() - start
+    # Each iteration of the genetic algorithm replays a whole population
+    num_candidates = ARGS.population_size * ARGS.genetic_num_iters
+    return num_candidates / elapsed / ARGS.num_threads
+
+
+def main():
+    for trace_cache_size in ARGS.trace_cache_sizes:
+        throughput = bench(trace_cache_size)
+        print(
+            f"Workload: {ARGS.workload}, trace_cache_size: {trace_cache_size}, "
+            f"throughput: {throughput:.2f} candidates/sec/thread"
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -25,6 +25,7 @@ from tvm.meta_schedule.schedule_rule import (
     RandomComputeLocation,
     ReuseType,
     ScheduleRule,
+    SplitK,
 )
 from tvm.target import Target
 
@@ -75,6 +76,13 @@ def cross_thread_reduction(target: Target) -> ScheduleRule:
     raise NotImplementedError(f"{target.kind.name} is not supported")
 
 
+def split_k(target: Target) -> ScheduleRule:
+    """Default schedule rules for with split-k reduction"""
+    if target.kind.name == "cuda":
+        return SplitK(split_factors=[2, 4, 8, 16], thread_extents=[32, 64, 128, 256])
+    raise NotImplementedError(f"{target.kind.name} is not supported")
+
+
 def multi_level_tiling(target: Target) -> ScheduleRule:
     """Default schedule rules for with multi-level tiling and reuse"""
     if target.kind.name == "llvm":
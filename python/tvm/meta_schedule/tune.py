@@ -16,11 +16,12 @@
 # under the License.
 """User-facing Tuning API"""
 # pylint: disable=import-outside-toplevel
+import hashlib
 import logging
 import logging.config
 import os
 from os import path as osp
-from typing import Any, Callable, Dict, List, NamedTuple, Optional, Union
+from typing import Any, Callable, Dict, List, NamedTuple, Optional, Tuple, Union
 
 from tvm.ir import IRModule
 from tvm.ir.transform import PassContext
@@ -236,6 +237,79 @@ class TuneConfig(NamedTuple):
         global_logger.info("Logging directory: %s", log_dir)
 
 
+def cost_model_path(cost_model_dir: str, target: Target) -> str:
+    """The path of the cost model of a target in a directory of cost models, which persists the
+    models trained by tuning sessions, one per target, to warm-start the next sessions.
+
+    Parameters
+    ----------
+    cost_model_dir : str
+        The directory of cost models.
+    target : Target
+        The target.
+
+    Returns
+    -------
+    path : str
+        The path, named after the target kind and a hash of the target.
+    """
+    target_hash = hashlib.sha256(str(target).encode("utf-8")).hexdigest()[:16]
+    return osp.join(cost_model_dir, f"{target.kind.name}_{target_hash}.tar")
+
+
+class TuningHits(NamedTuple):
+    """The tasks of a model which have a tuning record in a database.
+
+    Parameters
+    ----------
+    hits : List[ExtractedTask]
+        The tasks with a tuning record.
+    misses : List[ExtractedTask]
+        The tasks without, i.e. new or changed workloads.
+    """
+
+    hits: List[ExtractedTask]
+    misses: List[ExtractedTask]
+
+    @property
+    def hit_rate(self) -> float:
+        """The fraction of the tasks with a tuning record."""
+        total = len(self.hits) + len(self.misses)
+        return len(self.hits) / total if total else 1.0
+
+    @property
+    def weighted_hit_rate(self) -> float:
+        """The fraction of the task weights with a tuning record."""
+        hit_weight = sum(task.weight for task in self.hits)
+        total = hit_weight + sum(task.weight for task in self.misses)
+        return hit_weight / total if total else 1.0
+
+
+def query_tuned_tasks(extracted_tasks: List[ExtractedTask], database: Database) -> TuningHits:
+    """Split the tasks by whether the database has a tuning record of their workload.
+
+    Parameters
+    ----------
+    extracted_tasks : List[ExtractedTask]
+        The tasks.
+    database : Database
+        The database.
+
+    Returns
+    -------
+    hits : TuningHits
+        The tasks with and without a tuning record.
+    """
+    hits, misses = [], []
+    for task in extracted_tasks:
+        mod = default_config.mod(task.dispatched[0])
+        tuned = database.has_workload(mod) and database.get_top_k(
+            database.commit_workload(mod), 1
+        )
+        (hits if tuned else misses).append(task)
+    return TuningHits(hits, misses)
+
+
 def tune_extracted_tasks(
     extracted_tasks: List[ExtractedTask],
     config: TuneConfig,
@@ -251,6 +325,9 @@ def tune_extracted_tasks(
     postprocs: Optional[FnPostproc] = None,
     mutator_probs: Optional[FnMutatorProb] = None,
     num_threads: Optional[int] = None,
+    incremental: bool = False,
+    cost_model_dir: Optional[str] = None,
+    online_fine_tune: bool = True,
 ) -> Database:
     """Tune extracted tasks with a given target.
 
@@ -284,6 +361,15 @@ def tune_extracted_tasks(
         The probability distribution to use different mutators.
     num_threads : Optional[int]
         The number of threads to use.
+    incremental : bool
+        Whether to only tune the tasks whose workload has no tuning record in the database, e.g.
+        the new and changed workloads after a small change of a model. The hit rates are logged.
+    cost_model_dir : Optional[str]
+        A directory of cost models, one per target, shared across tuning sessions and models.
+        The default cost model is warm-started from the model of the target, with its features
+        and results, and the directory is updated after tuning.
+    online_fine_tune : bool
+        Whether the warm-started cost model is retrained on the results of this session.
 
     Returns
     -------
@@ -295,6 +381,19 @@ def tune_extracted_tasks(
     # logging directory is set to `work_dir/logs` by default
     log_dir = osp.join(work_dir, "logs")
     os.makedirs(log_dir, exist_ok=True)
+    database = default_config.database(database, work_dir)
+    if incremental:
+        tuned = query_tuned_tasks(extracted_tasks, database)
+        logger.info(
+            "Incremental tuning: %d of %d tasks are tuned (hit rate %.2f, weighted %.2f)",
+            len(tuned.hits),
+            len(extracted_tasks),
+            tuned.hit_rate,
+            tuned.weighted_hit_rate,
+        )
+        extracted_tasks = tuned.misses
+        if not extracted_tasks:
+            return database
     max_width = len(str(len(extracted_tasks) - 1))
     logger_name_pattern = __name__ + ".task_{task_id:0" + f"{max_width}" + "d}_{task_name}"
 
@@ -310,10 +409,15 @@ def tune_extracted_tasks(
     )
 
     logger.info("Working directory: %s", work_dir)
-    database = default_config.database(database, work_dir)
     builder = default_config.builder(builder)
     runner = default_config.runner(runner)
-    cost_model = default_config.cost_model(cost_model, config.adaptive_training)
+    shared_cost_model = None
+    if cost_model_dir is not None and cost_model is None:
+        os.makedirs(cost_model_dir, exist_ok=True)
+        shared_cost_model = cost_model_path(cost_model_dir, extracted_tasks[0].target)
+    cost_model = default_config.cost_model(
+        cost_model, config.adaptive_training, shared_cost_model, online_fine_tune
+    )
     measure_callbacks = default_config.callbacks(measure_callbacks)
     # parse the tuning contexts
     tune_contexts = []
@@ -349,9 +453,112 @@ def tune_extracted_tasks(
     if config.max_trials_global > 0:
         task_scheduler.tune()
         cost_model.save(osp.join(work_dir, "cost_model.xgb"))
+        if shared_cost_model is not None:
+            cost_model.save(shared_cost_model)
     return database
 
 
+ShapeDistribution = List[Tuple[Dict[str, int], float]]
+
+
+def specialize_symbolic_tasks(
+    extracted_tasks: List[ExtractedTask],
+    shape_distribution: ShapeDistribution,
+) -> Tuple[List[ExtractedTask], List[Tuple[ExtractedTask, List[Tuple[ExtractedTask, float]]]]]:
+    """Replace each task with symbolic shapes by its specializations to the representative
+    shapes of a distribution, so that they can be built and measured.
+
+    Parameters
+    ----------
+    extracted_tasks : List[ExtractedTask]
+        The tasks.
+    shape_distribution : List[Tuple[Dict[str, int], float]]
+        The representative values of the symbolic variables, by name, and their frequencies.
+
+    Returns
+    -------
+    tasks : List[ExtractedTask]
+        The static tasks and the specialized tasks, whose weights are the weight of their task
+        split by the normalized frequencies.
+    groups : List[Tuple[ExtractedTask, List[Tuple[ExtractedTask, float]]]]
+        Each symbolic task, with its specialized tasks and their normalized frequencies.
+    """
+    total = sum(freq for _, freq in shape_distribution)
+    assert total > 0, "The frequencies of the shape distribution must sum to a positive value"
+    tasks: List[ExtractedTask] = []
+    groups = []
+    for task in extracted_tasks:
+        names = task.symbolic_vars()
+        if not names:
+            tasks.append(task)
+            continue
+        specialized = []
+        for bindings, freq in shape_distribution:
+            if freq <= 0 or not all(name in bindings for name in names):
+                continue
+            weight = max(1, round(task.weight * freq / total))
+            bindings = {name: bindings[name] for name in names}
+            specialized.append((task.specialize(bindings, weight), freq / total))
+        if not specialized:
+            logger.warning("No representative shape for the symbolic task %s", task.task_name)
+            tasks.append(task)
+            continue
+        tasks.extend(spec for spec, _ in specialized)
+        groups.append((task, specialized))
+    return tasks, groups
+
+
+def commit_symbolic_records(
+    database: Database,
+    groups: List[Tuple[ExtractedTask, List[Tuple[ExtractedTask, float]]]],
+) -> None:
+    """Commit a schedule of each symbolic task, chosen among the best schedules of its
+    specializations. The schedules are tried in the decreasing order of the share of the run time
+    which their specialization accounts for, and the first one which applies to the symbolic
+    PrimFunc and to every specialization is committed, with the run time of its specialization.
+
+    Parameters
+    ----------
+    database : Database
+        The database holding the records of the specialized tasks.
+    groups : List[Tuple[ExtractedTask, List[Tuple[ExtractedTask, float]]]]
+        The groups returned by `specialize_symbolic_tasks`.
+    """
+
+    def applies(trace, mod: IRModule) -> bool:
+        try:
+            trace.apply_to_schedule(Schedule(mod), remove_postproc=False)
+            return True
+        except Exception:  # pylint: disable=broad-except
+            return False
+
+    for task, specialized in groups:
+        candidates = []
+        for spec, freq in specialized:
+            records = database.get_top_k(database.commit_workload(spec.dispatched[0]), 1)
+            if records and records[0].run_secs:
+                mean = sum(float(sec) for sec in records[0].run_secs) / len(records[0].run_secs)
+                candidates.append((freq * mean, records[0]))
+        candidates.sort(key=lambda candidate: -candidate[0])
+        mod = task.dispatched[0]
+        for _, record in candidates:
+            if applies(record.trace, mod) and all(
+                applies(record.trace, spec.dispatched[0]) for spec, _ in specialized
+            ):
+                database.commit_tuning_record(
+                    TuningRecord(
+                        record.trace,
+                        database.commit_workload(mod),
+                        record.run_secs,
+                        record.target,
+                        None,
+                    )
+                )
+                break
+        else:
+            logger.warning("No schedule applies to every shape of the task %s", task.task_name)
+
+
 def tune_tir(
     mod: Union[IRModule, PrimFunc],
     target: Union[str, Target],
@@ -616,6 +823,9 @@ def tune_relax(
     postprocs: Optional[FnPostproc] = None,
     mutator_probs: Optional[FnMutatorProb] = None,
     num_threads: Optional[int] = None,
+    shape_distribution: Optional[ShapeDistribution] = None,
+    incremental: bool = False,
+    cost_model_dir: Optional[str] = None,
 ) -> Module:
     """Tune a TIR IRModule with a given target.
 
@@ -639,6 +849,15 @@ def tune_relax(
         The database to use.
     measure_callbacks : Optional[List[MeasureCallback]]
         The callbacks used during tuning.
+    shape_distribution : Optional[List[Tuple[Dict[str, int], float]]]
+        The representative values of the symbolic shape variables, e.g. [({"n": 128}, 0.7),
+        ({"n": 512}, 0.3)], and their frequencies. The tasks with symbolic shapes are tuned as
+        one specialization per representative shape, weighted by its frequency, and the symbolic
+        PrimFunc gets the schedule of a specialization which applies to all of them.
+    incremental : bool
+        Whether to only tune the tasks whose workload has no tuning record in the database.
+    cost_model_dir : Optional[str]
+        A directory of cost models, one per target, to warm-start the cost model from.
 
     Returns
     -------
@@ -655,6 +874,11 @@ def tune_relax(
     target = default_config.target(target)
     # parse the tuning contexts
     extracted_tasks = extract_task_from_relax(mod, target)
+    symbolic_groups = []
+    if shape_distribution:
+        extracted_tasks, symbolic_groups = specialize_symbolic_tasks(
+            extracted_tasks, shape_distribution
+        )
     database = tune_extracted_tasks(
         extracted_tasks,
         config,
@@ -669,7 +893,10 @@ def tune_relax(
         postprocs=postprocs,
         mutator_probs=mutator_probs,
         num_threads=num_threads,
+        incremental=incremental,
+        cost_model_dir=cost_model_dir,
     )
+    commit_symbolic_records(database, symbolic_groups)
 
     with PassContext(opt_level=3):
         relax_mod = MetaScheduleApplyHistoryBest(database, target)(mod)
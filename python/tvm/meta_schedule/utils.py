@@ -263,7 +263,10 @@ def get_global_func_on_rpc_session(
 
 @register_func("meta_schedule.remove_build_dir")
 def remove_build_dir(artifact_path: str) -> None:
-    """Clean up the build directory"""
+    """Clean up the build directory, or release the module of an in-memory artifact"""
+    if artifact_path.startswith("memory://"):
+        get_global_func("meta_schedule.InMemoryArtifactRemove")(artifact_path)
+        return
     shutil.rmtree(os.path.dirname(artifact_path))
 
 
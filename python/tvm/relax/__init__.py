@@ -25,6 +25,8 @@ from . import op
 from . import analysis
 from . import transform
 from . import expr_functor
+from . import backend
+from . import cost_model
 
 # Expr
 Expr = expr.Expr
@@ -63,6 +65,9 @@ DimType = ty.DimType
 TupleType = ty.TupleType
 FuncType = ty.FuncType
 
+# Cost model
+KernelCostModel = cost_model.KernelCostModel
+
 # VM
 ExecBuilder = exec_builder.ExecBuilder
 VirtualMachine = vm.VirtualMachine
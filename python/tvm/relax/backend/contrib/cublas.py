@@ -0,0 +1,58 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Pattern table and partitioning for the cuBLAS codegen."""
+from tvm.relax.dpl import is_op, wildcard
+
+from ... import transform
+
+
+def get_patterns():
+    """Get the patterns offloaded to cuBLAS, in order of priority.
+
+    Returns
+    -------
+    patterns: List[Tuple[str, DFPattern]]
+        The names and patterns of the composite functions. A matmul followed by a bias add and
+        an activation runs as a single cuBLASLt matmul whose epilogue computes the bias and the
+        activation.
+    """
+    matmul = is_op("relax.matmul")(wildcard(), wildcard())
+    matmul_bias = is_op("relax.add")(matmul, wildcard())
+    return [
+        ("cublas.matmul_bias_relu", is_op("relax.nn.relu")(matmul_bias)),
+        ("cublas.matmul_bias_gelu", is_op("relax.nn.gelu")(matmul_bias)),
+        ("cublas.matmul_bias", matmul_bias),
+        ("cublas.matmul", matmul),
+    ]
+
+
+def partition_for_cublas(mod):
+    """Partition the matmuls of the module, with their bias and activation epilogues, into
+    functions offloaded to cuBLAS.
+
+    Parameters
+    ----------
+    mod: tvm.IRModule
+        The module to partition.
+
+    Returns
+    -------
+    mod: tvm.IRModule
+        The module with the matmuls grouped into functions of attribute Codegen="cublas", to be
+        compiled by RunCodegen.
+    """
+    return transform.FuseOpsByPattern(get_patterns(), codegen="cublas")(mod)
@@ -127,6 +127,21 @@ class BlockBuilder(Object):
             params = [data] + model.parameters()
             builder.emit_func_output(output, params=params)
         mod = bb.get()
+
+    With defer_te_lowering, the TE computes emitted in a function are recorded rather than lowered
+    when they are emitted. They are lowered to PrimFuncs in parallel at emit_func_output, and the
+    identical PrimFuncs are added to the module once. The PrimFuncs are then only in the module
+    once the function is emitted.
+
+    .. code-block:: python
+
+        bb = rx.BlockBuilder(defer_te_lowering=True)
+        with bb.function("main", [x]):
+            lv0 = bb.emit_te(topi.nn.relu, x)
+            lv1 = bb.emit_te(topi.nn.relu, lv0)
+            bb.emit_func_output(lv1)
+        # one PrimFunc relu is called twice
+        mod = bb.get()
     """
 
     _current = None
@@ -136,10 +151,13 @@ class BlockBuilder(Object):
         """Returns the current BlockBuilder."""
         return BlockBuilder._current
 
-    def __init__(self, mod: IRModule = None):
+    def __init__(self, mod: IRModule = None, defer_te_lowering: bool = False):
         self._blocks = []
         # a boolean flag that tracks if emit_func_output has been called
         self._is_emit_func_output_called = False
+        self._defer_te_lowering = defer_te_lowering
+        # the TE computes deferred in the current function: global var, args and tir vars
+        self._deferred_te = []
         self.__init_handle_by_constructor__(_ffi_api.BlockBuilderCreate, mod)
 
     def _begin_dataflow_block(self) -> None:
@@ -166,6 +184,7 @@ class BlockBuilder(Object):
                 raise RuntimeError("emit_func_output must be called in a relax function.")
 
         self._blocks = []
+        self._deferred_te = []
         self._is_emit_func_output_called = False
         BlockBuilder._current = None
 
@@ -348,12 +367,14 @@ class BlockBuilder(Object):
         unbound_tir_vars = self._get_unbound_tir_vars(te_args + outs)
 
         inputs = [*te_args] + outs
-        tir_func = tvm.te.create_prim_func(inputs, unbound_tir_vars)
-
-        if primfunc_name_hint:
-            gvar = self.add_func(tir_func, primfunc_name_hint)
+        name_hint = primfunc_name_hint if primfunc_name_hint else func.__name__
+        if getattr(self, "_defer_te_lowering", False) and BlockBuilder.current() is self:
+            # The call is bound to the added PrimFunc at emit_func_output.
+            gvar = GlobalVar(name_hint)
+            self._deferred_te.append((gvar, inputs, unbound_tir_vars))
         else:
-            gvar = self.add_func(tir_func, func.__name__)
+            tir_func = tvm.te.create_prim_func(inputs, unbound_tir_vars)
+            gvar = self.add_func(tir_func, name_hint)
 
         call_args = [x.op.value for x in te_args]
 
@@ -589,6 +610,10 @@ class BlockBuilder(Object):
         func = func.with_attr("global_symbol", self._func_name)
         for key, value in self._func_attrs.items():
             func = func.with_attr(key, value)
+        if self._deferred_te:
+            gvars, args, tir_vars = zip(*self._deferred_te)
+            self._deferred_te = []
+            func = _ffi_api.LowerDeferredTE(self, func, gvars, args, tir_vars)
         self.add_func(func, self._func_name)
 
     def normalize(self, expr: Expr) -> Expr:
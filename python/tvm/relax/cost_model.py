@@ -0,0 +1,92 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""The latency oracle of the kernels called by Relax programs, for the graph-level passes."""
+from typing import Callable, Optional, Union
+
+import tvm
+from tvm.ir import IRModule
+from tvm.runtime import Object
+from tvm.target import Target
+from tvm.tir import PrimFunc
+
+from . import _ffi_api
+from .expr import Call
+
+
+@tvm._ffi.register_object("relax.KernelCostModel")
+class KernelCostModel(Object):
+    """Estimate the latency of the kernels called with call_tir, so that the graph-level passes,
+    e.g. fusion or the choice between a library and a tuned kernel, compare their options per
+    shape.
+
+    The latency of a kernel is the mean of the measured run time of its best record in the
+    MetaSchedule database. A kernel without a record falls back to f_fallback, e.g. a learned
+    cost model, and otherwise to a throughput fit on the measured records of the target:
+    latency = scale * flops ^ exponent.
+
+    The passes get the model of the pass context with KernelCostModel.current(), set as the
+    "relax.kernel_cost_model" config:
+
+    .. code-block:: python
+
+        model = relax.KernelCostModel(database, target)
+        with tvm.transform.PassContext(config={"relax.kernel_cost_model": model}):
+            mod = relax.transform.FuseOps()(mod)
+
+    Parameters
+    ----------
+    database : tvm.meta_schedule.database.Database
+        The database of the measured tuning records.
+    target : Union[str, Target]
+        The target the kernels run on.
+    f_fallback : Optional[Callable[[PrimFunc], float]]
+        The latency in seconds of a kernel without a measured record, or a negative value when
+        it has no estimation either.
+    """
+
+    def __init__(
+        self,
+        database: "tvm.meta_schedule.database.Database",
+        target: Union[str, Target],
+        f_fallback: Optional[Callable[[PrimFunc], float]] = None,
+    ):
+        if isinstance(target, str):
+            target = Target(target)
+        self.__init_handle_by_constructor__(
+            _ffi_api.KernelCostModel, database, target, f_fallback  # type: ignore
+        )
+
+    def query_measured(self, func: PrimFunc) -> Optional[float]:
+        """The measured latency of the kernel in seconds, None if it has no measured record."""
+        secs = _ffi_api.KernelCostModelQueryMeasured(self, func)  # type: ignore
+        return secs if secs >= 0 else None
+
+    def estimate(self, func: PrimFunc) -> Optional[float]:
+        """The estimated latency of the kernel in seconds, None if no estimation applies."""
+        secs = _ffi_api.KernelCostModelEstimate(self, func)  # type: ignore
+        return secs if secs >= 0 else None
+
+    def estimate_call_tir(self, mod: IRModule, call: Call) -> Optional[float]:
+        """The estimated latency in seconds of a call_tir to a PrimFunc of the module, None if no
+        estimation applies."""
+        secs = _ffi_api.KernelCostModelEstimateCallTIR(self, mod, call)  # type: ignore
+        return secs if secs >= 0 else None
+
+    @staticmethod
+    def current() -> Optional["KernelCostModel"]:
+        """The cost model of the current pass context, if any."""
+        return _ffi_api.KernelCostModelCurrent()  # type: ignore
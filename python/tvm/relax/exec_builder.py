@@ -95,6 +95,18 @@ class ExecBuilder(Object):
         self._check_scope()
         if dst is None:
             dst = SpecialReg.VOID_ARG
+        _ffi_api.ExecBuilderEmitCall(self, name, self._convert_args(args), dst)
+
+    def emit_tail_call(
+        self,
+        name: str,
+        args: Optional[List[Union[tvm.nd.NDArray, tvm.DataType]]] = None,
+    ) -> None:
+        """emit a tail call instruction which calls a function and returns its result."""
+        self._check_scope()
+        _ffi_api.ExecBuilderEmitTailCall(self, name, self._convert_args(args))
+
+    def _convert_args(self, args) -> List[int]:
         args_ = []
         if args is not None:
             for arg in args:
@@ -107,7 +119,7 @@ class ExecBuilder(Object):
                     args_.append(new_arg)
                 else:
                     args_.append(arg)
-        _ffi_api.ExecBuilderEmitCall(self, name, args_, dst)
+        return args_
 
     def emit_ret(self, result: int) -> None:
         """emit a return instruction"""
@@ -124,6 +136,28 @@ class ExecBuilder(Object):
         self._check_scope()
         _ffi_api.ExecBuilderEmitIf(self, cond, false_offset)
 
+    def emit_kill_register(self, reg):
+        """emit a kill register instruction which releases the value held by reg"""
+        self._check_scope()
+        _ffi_api.ExecBuilderEmitKillRegister(self, reg)
+
+    def emit_move(self, src, dst):
+        """emit a move instruction which copies a register, immediate or constant into dst"""
+        self._check_scope()
+        _ffi_api.ExecBuilderEmitMove(self, src, dst)
+
+    def optimize(self) -> None:
+        """optimize the emitted instructions with peephole rewrites, must precede get"""
+        _ffi_api.ExecBuilderOptimize(self)
+
+    def allocate_registers(self) -> None:
+        """let the registers whose live intervals do not overlap share a slot"""
+        _ffi_api.ExecBuilderAllocateRegisters(self)
+
+    def set_source_span(self, span: Optional[tvm.ir.Span]) -> None:
+        """set the source span of the instructions emitted from now on"""
+        _ffi_api.ExecBuilderSetSourceSpan(self, span)
+
     def get(self) -> Executable:
         """return the executable"""
         return Executable(_ffi_api.ExecBuilderGet(self))
@@ -17,6 +17,9 @@
 """Common relax pass instrumentation across IR variants."""
 import tvm
 from tvm import relax
+from tvm.relax.analysis import _ffi_api as _analysis_ffi_api
+from tvm.ir.instrument import PassInstrument
+from . import _ffi_api
 
 
 @tvm.instrument.pass_instrument
@@ -35,3 +38,58 @@ class WellFormedInstrument:
     def run_after_pass(self, mod, pass_info):
         if pass_info.name not in self.skip_pass_name:
             assert relax.analysis.well_formed(mod)
+
+
+def IncrementalWellFormedInstrument(skip_passes=None) -> tvm.instrument.PassInstrument:
+    """An instrument that checks the input/output IRModule of the Pass is
+    well formed, only re-checking the functions the passes changed.
+
+    A function which is the same object as a function found well formed
+    before is skipped, as IR nodes are immutable, so the cost of the check
+    follows the number of functions the passes rewrite rather than the size
+    of the module.
+
+    Parameters
+    ----------
+    skip_passes : Optional[List[str]]
+        The names of the passes whose modules are not checked, Normalize and
+        ResolveGlobals by default.
+
+    Returns
+    -------
+    instrument : tvm.instrument.PassInstrument
+        The pass instrument.
+    """
+    if skip_passes is None:
+        skip_passes = ["Normalize", "ResolveGlobals"]
+    return _analysis_ffi_api.WellFormedInstrument(skip_passes, True)  # type: ignore
+
+
+@tvm._ffi.register_object("relax.instrument.PassProfilingInstrument")
+class PassProfilingInstrument(PassInstrument):
+    """An instrument implemented in C++ that records the wall time, the peak
+    RSS and the IR size (functions and bindings) before and after each pass
+    run in its PassContext, nested passes included.
+
+    Examples
+    --------
+
+    .. code-block:: python
+
+        profiler = PassProfilingInstrument()
+        with tvm.transform.PassContext(instruments=[profiler]):
+            mod = relax.transform.FuseOps()(mod)
+            mod = relax.transform.FuseTIR()(mod)
+        print(profiler.as_table())
+    """
+
+    def __init__(self):  # pylint: disable=super-init-not-called
+        self.__init_handle_by_constructor__(_ffi_api.PassProfilingInstrument)  # type: ignore
+
+    def as_table(self) -> str:
+        """Render the records of the passes as a table."""
+        return _ffi_api.PassProfilingInstrumentAsTable(self)  # type: ignore
+
+    def as_json(self) -> str:
+        """Render the records of the passes as a JSON list, one object per pass run."""
+        return _ffi_api.PassProfilingInstrumentAsJSON(self)  # type: ignore
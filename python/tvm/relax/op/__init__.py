@@ -21,3 +21,4 @@
 from .base import *
 from .tensor import *
 from .op_attrs import *
+from . import nn
@@ -30,6 +30,8 @@ def call_tir(
     shape: Union[Tuple, ShapeExpr, List[int]],
     dtype: Union[str, List[str]],
     tir_vars: Optional[ShapeExpr] = None,
+    inplace_indices: Optional[List[int]] = None,
+    runtime_device_index: Optional[int] = None,
 ) -> Call:
     """
     Call a destination-passing-style function and return the output.
@@ -51,6 +53,14 @@ def call_tir(
     tir_vars : ShapeExpr, optional
         ShapeExpr representing a tuple of integers to unpack when calling func. Is null if not used
 
+    inplace_indices : List[int], optional
+        For each output, the index of the input argument whose tensor the output overwrites, or
+        -1 if the output is a fresh tensor. An overwritten input must not be used after the call.
+
+    runtime_device_index : int, optional
+        The index of the VM device the outputs are allocated on, which the kernel runs on when
+        its inputs are on the device too. The outputs are on the first device by default.
+
     Returns
     -------
     ret: Call
@@ -71,7 +81,9 @@ def call_tir(
     else:
         raise TypeError("Not supported dtype for call_tir: " + str(type(dtype)))
 
-    return _ffi_api.call_tir(func, args, shape, output_type, tir_vars)
+    return _ffi_api.call_tir(
+        func, args, shape, output_type, tir_vars, inplace_indices, runtime_device_index
+    )
 
 
 def make_closure(
@@ -128,3 +140,42 @@ def invoke_closure(
         args = Tuple(args)
 
     return _ffi_api.invoke_closure(closure, args)
+
+
+def scan(
+    func: Expr,
+    num_steps: Union[ShapeExpr, List[int]],
+    init: Union[Tuple, List[Expr]],
+) -> Expr:
+    """
+    Run a loop whose steps call a Relax function on the loop-carried states.
+
+    Parameters
+    ----------
+    func : Expr
+        The GlobalVar of the step function, which takes the states and returns a tuple of the
+        next states, or the next state when there is a single one.
+
+    num_steps : Union[ShapeExpr, List[int]]
+        The number of steps, as a shape of one dimension which may be symbolic.
+
+    init : Union[Tuple, List[Expr]]
+        The initial states.
+
+    Returns
+    -------
+    ret: Expr
+        The tuple of the states after the last step.
+
+    Note
+    ----
+    The loop runs in the VM, which double buffers the loop-carried tensors: the buffers of the
+    states of two steps ago are reused for the outputs of the step.
+    """
+
+    if isinstance(num_steps, (list, tuple)):
+        num_steps = ShapeExpr(num_steps)
+    if isinstance(init, (list, tuple)):
+        init = Tuple(init)
+
+    return _ffi_api.scan(func, num_steps, init)
@@ -0,0 +1,180 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Relax neural network operators."""
+from typing import List, Optional, Union
+
+from tvm.tir import FloatImm
+
+from . import _ffi_api
+from ...expr import Expr
+
+
+def relu(data: Expr) -> Expr:
+    """Elementwise rectified linear unit, max(data, 0)."""
+    return _ffi_api.relu(data)
+
+
+def gelu(data: Expr) -> Expr:
+    """Elementwise Gaussian error linear unit, data * Phi(data)."""
+    return _ffi_api.gelu(data)
+
+
+def softmax(data: Expr, axis: int = -1) -> Expr:
+    """Softmax of data along an axis."""
+    return _ffi_api.softmax(data, axis)
+
+
+def conv2d(
+    data: Expr,
+    weight: Expr,
+    strides: Union[int, List[int]] = (1, 1),
+    padding: Union[int, List[int]] = (0, 0),
+    dilation: Union[int, List[int]] = (1, 1),
+    groups: int = 1,
+    out_dtype: str = "",
+) -> Expr:
+    """2-D convolution of NCHW data with an OIHW weight.
+
+    Parameters
+    ----------
+    data : Expr
+        The input of shape (N, C, H, W).
+
+    weight : Expr
+        The weight of shape (O, C / groups, KH, KW).
+
+    strides : Union[int, List[int]]
+        The strides along the height and the width.
+
+    padding : Union[int, List[int]]
+        The padding, either one value for all sides, (height, width), or
+        (top, left, bottom, right).
+
+    dilation : Union[int, List[int]]
+        The dilation along the height and the width.
+
+    groups : int
+        The number of groups the channels are split into.
+
+    out_dtype : str
+        The data type of the output, that of the data if empty.
+
+    Returns
+    -------
+    result : Expr
+        The output of shape (N, O, OH, OW).
+    """
+    if isinstance(strides, int):
+        strides = (strides, strides)
+    if isinstance(padding, int):
+        padding = (padding,)
+    if isinstance(dilation, int):
+        dilation = (dilation, dilation)
+    return _ffi_api.conv2d(data, weight, strides, padding, dilation, groups, out_dtype)
+
+
+def layer_norm(
+    data: Expr,
+    gamma: Expr,
+    beta: Expr,
+    axis: int = -1,
+    epsilon: float = 1e-5,
+    center: bool = True,
+    scale: bool = True,
+) -> Expr:
+    """Layer normalization of data along an axis, scaled by gamma and offset by beta.
+
+    Parameters
+    ----------
+    data : Expr
+        The input tensor.
+
+    gamma : Expr
+        The 1-D scale, of the length of the normalized axis, ignored if not scale.
+
+    beta : Expr
+        The 1-D offset, of the length of the normalized axis, ignored if not center.
+
+    axis : int
+        The normalized axis.
+
+    epsilon : float
+        The value added to the variance to avoid dividing by zero.
+
+    center : bool
+        Whether to offset the normalized tensor by beta.
+
+    scale : bool
+        Whether to scale the normalized tensor by gamma.
+
+    Returns
+    -------
+    result : Expr
+        The normalized tensor.
+    """
+    return _ffi_api.layer_norm(data, gamma, beta, axis, epsilon, center, scale)
+
+
+def attention(query: Expr, key: Expr, value: Expr, scale: Optional[float] = None) -> Expr:
+    """Attention softmax(query @ key * scale) @ value, computed by one fused kernel which keeps
+    the scores on chip. The sequence lengths can be dynamic.
+
+    Parameters
+    ----------
+    query : Expr
+        The queries of shape (..., seq_q, head_dim).
+
+    key : Expr
+        The transposed keys of shape (..., head_dim, seq_kv).
+
+    value : Expr
+        The values of shape (..., seq_kv, value_dim).
+
+    scale : Optional[float]
+        The scale of the scores before the softmax, 1 / sqrt(head_dim) by default.
+
+    Returns
+    -------
+    result : Expr
+        The output of shape (..., seq_q, value_dim).
+    """
+    if scale is not None:
+        scale = FloatImm("float64", scale)
+    return _ffi_api.attention(query, key, value, scale)
+
+
+def embedding_bag(weight: Expr, indices: Expr, mode: str = "sum") -> Expr:
+    """Gather the rows of the embedding table at the indices of every bag and pool them, as the
+    sparse features of recommendation models are, without materializing the gathered rows.
+
+    Parameters
+    ----------
+    weight : Expr
+        The embedding table of shape (num_embeddings, embedding_dim).
+
+    indices : Expr
+        The integer indices of shape (num_bags, bag_size).
+
+    mode : str
+        The pooling of the rows of a bag, "sum", "mean" or "max".
+
+    Returns
+    -------
+    result : Expr
+        The pooled rows of shape (num_bags, embedding_dim).
+    """
+    return _ffi_api.embedding_bag(weight, indices, mode)
@@ -32,3 +32,8 @@ class VMAllocStorageAttrs(Attrs):
 @tvm._ffi.register_object("relax.attrs.VMAllocTensorAttrs")
 class VMAllocTensorAttrs(Attrs):
     """Attributes used in VM alloc_tensor operators"""
+
+
+@tvm._ffi.register_object("relax.attrs.AttentionAttrs")
+class AttentionAttrs(Attrs):
+    """Attributes used in the attention operator"""
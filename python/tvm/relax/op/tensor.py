@@ -14,9 +14,6 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 """Basic tensor operations."""
-import numpy as np
-import tvm
-
 from . import _ffi_api
 from ..expr import Expr
 
@@ -29,27 +26,109 @@ def multiply(lhs: Expr, rhs: Expr) -> Expr:
     return _ffi_api.multiply(lhs, rhs)
 
 
-@tvm.register_func("relax.run.unique")
+def matmul(a: Expr, b: Expr) -> Expr:
+    """Matrix product of the last two dimensions of a of shape (..., M, K) and b of shape
+    (..., K, N). The leading dimensions are batched, those of the operand with fewer dimensions
+    are broadcast."""
+    return _ffi_api.matmul(a, b)
+
+
+def sparse_dense(data: Expr, weight_data: Expr, weight_indices: Expr, weight_indptr: Expr) -> Expr:
+    """Matrix product of data of shape (M, K) and the transpose of the sparse weight of shape
+    (N, K), of shape (M, N).
+
+    The weight is given by its compressed rows: in CSR, its values of shape (nnz,), their
+    columns of shape (nnz,) and the offsets of the rows of shape (N + 1,); in BSR, its blocks of
+    shape (nnz_blocks, bs_r, bs_c), their block columns and the offsets of the rows of blocks of
+    shape (N / bs_r + 1,). The number of nonzeros may be symbolic."""
+    return _ffi_api.sparse_dense(data, weight_data, weight_indices, weight_indptr)
+
+
+def sparse_add(dense: Expr, sparse_data: Expr, sparse_indices: Expr, sparse_indptr: Expr) -> Expr:
+    """Sum of dense of shape (M, N) and the CSR matrix of the same shape given by its values,
+    their columns and the offsets of its rows, see sparse_dense."""
+    return _ffi_api.sparse_add(dense, sparse_data, sparse_indices, sparse_indptr)
+
+
 def unique(
-    a: tvm.nd.array,
-    sort: int,
-    return_inverse: int,
-    return_counts: int,
-    dim: int,
-) -> tvm.nd.array:
-    """Returns the unique elements of the input tensor.
-
-    Uses numpy.unique to compute unique elements.
+    data: Expr,
+    sorted: bool = True,  # pylint: disable=redefined-builtin
+    return_inverse: bool = False,
+    return_counts: bool = False,
+    dim: int = -1,
+) -> Expr:
+    """The unique elements of the flattened data, of a size known at runtime only.
+
+    The elements are computed on the device of the data: hash based and in parallel on CPU, and
+    sort based with Thrust on GPU when TVM is built with it.
+
+    Parameters
+    ----------
+    data : Expr
+        The input tensor.
+
+    sorted : bool
+        Whether the elements are sorted ascending, otherwise they are in the reverse order of
+        their first occurrences.
+
+    return_inverse : bool
+        Not supported yet, must be False.
+
+    return_counts : bool
+        Not supported yet, must be False.
+
+    dim : int
+        Not supported yet, the data is flattened, must be negative.
+
+    Returns
+    -------
+    result : Expr
+        The 1-D unique elements.
+    """
+    return _ffi_api.unique(data, sorted, return_inverse, return_counts, dim)
+
+
+def unique_bounded(data: Expr, sorted: bool = True) -> Expr:  # pylint: disable=redefined-builtin
+    """The unique elements of the flattened data, allocated at the upper bound of their number.
+
+    Unlike unique, the host does not wait for the number of the elements: they are the leading
+    entries of a 1-D buffer of the size of the data, and their number is written to a 1-D int64
+    extent on the device of the data. The buffer may be consumed by the kernels as is, and
+    resolve_bound views its valid entries where their size is needed.
+
+    Parameters
+    ----------
+    data : Expr
+        The input tensor.
+
+    sorted : bool
+        Whether the elements are sorted ascending, otherwise they are in the reverse order of
+        their first occurrences.
+
+    Returns
+    -------
+    result : Expr
+        The tuple of the buffer of the elements and of their extent.
+    """
+    return _ffi_api.unique_bounded(data, sorted)
+
+
+def resolve_bound(data: Expr, extent: Expr) -> Expr:
+    """The leading entries of the data allocated at an upper bound along its first axis.
+
+    The extent is read on the host, which waits for the kernels writing it.
+
+    Parameters
+    ----------
+    data : Expr
+        The tensor allocated at the bound.
+
+    extent : Expr
+        The 1-D int64 number of the valid entries, such as the one of unique_bounded.
+
+    Returns
+    -------
+    result : Expr
+        The view of the valid entries, of a size known at runtime only.
     """
-    # TODO(prakalp): add support for returning a tuple when return_inverse or return_counts is True
-    if bool(return_inverse) or bool(return_counts):
-        raise NotImplementedError("missing support return_inverse or return_counts set to true")
-    if dim < 0:
-        dim = None
-    a_numpy = a.numpy()
-    # TODO(prakalp): use torch.unique instead of numpy when torch is installed in ci.
-    output_sorted_numpy, indices = np.unique(a_numpy, return_index=True)
-    if sort:
-        return tvm.nd.array(output_sorted_numpy)
-    output_numpy = [a_numpy.flatten()[index] for index in sorted(indices, reverse=True)]
-    return tvm.nd.array(output_numpy)
+    return _ffi_api.resolve_bound(data, extent)
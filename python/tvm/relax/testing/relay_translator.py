@@ -38,6 +38,7 @@ def from_relay(
     pass_config: Optional[Dict[str, Any]] = None,
     disabled_pass: Optional[List[str]] = None,
     translate_op_with_tir: Optional[Dict[str, tvm.tir.PrimFunc]] = None,
+    desired_layouts: Optional[Dict[str, List[str]]] = None,
 ) -> IRModule:
     """Convert a Relay function into a Relax program.
 
@@ -65,6 +66,12 @@ def from_relay(
         Dict that maps op names to user-defined PrimFuncs.
         Takes relay operator names and forces them to user-defined PrimFuncs during translation.
 
+    desired_layouts: Optional[Dict[str, List[str]]]
+        Dict that maps op names to their desired data and kernel layouts, e.g.
+        {"nn.conv2d": ["NHWC", "default"]}. The ops are converted to the layouts before
+        translation, with the minimal number of layout_transforms between the converted and
+        the other ops. The transforms of the bound parameters are folded into constants.
+
     Returns
     -------
     mod : tvm.IRModule
@@ -72,6 +79,10 @@ def from_relay(
     """
     # A map to store the mapping of Relay Expr to its corresponding Relax var
     var_map = {}
+    # A cache of the lowered calls keyed by the op, the attrs and the static input and output
+    # types. Each value holds the attrs, the first call_tir emitted for the key, and the position
+    # of each call_tir input in the relax arguments of that call.
+    lowered_calls = {}
     # The output of the function
     output_var = None
 
@@ -102,6 +113,56 @@ def from_relay(
                 ret.append(dim)
         return ret
 
+    def static_type_key(types):
+        """The hashable key of a list of tensor types, or None if any shape is symbolic."""
+        key = []
+        for ty in types:
+            if isinstance(ty, relay.TupleType):
+                fields = static_type_key(ty.fields)
+                if fields is None:
+                    return None
+                key.append(fields)
+            elif isinstance(ty, relay.TensorType):
+                if not all(isinstance(dim, tvm.tir.IntImm) for dim in ty.shape):
+                    return None
+                key.append((tuple(int(dim) for dim in ty.shape), ty.dtype))
+            else:
+                return None
+        return tuple(key)
+
+    def lowering_cache_key(node, new_args):
+        """The key to reuse the lowering of an earlier call, or None if it can not be reused."""
+        if len(new_args) != len(node.args):
+            return None
+        type_key = static_type_key([arg.checked_type for arg in node.args] + [node.checked_type])
+        if type_key is None:
+            return None
+        attrs_hash = tvm.ir.structural_hash(node.attrs) if node.attrs is not None else 0
+        return (node.op.name, attrs_hash, type_key)
+
+    def emit_cached_call(key, attrs, new_args):
+        """Emit the call_tir of an earlier call with the same key on the new arguments."""
+        cached_attrs, call, input_indices = lowered_calls[key]
+        if not tvm.ir.structural_equal(cached_attrs, attrs):
+            return None
+        inputs = relax.Tuple([new_args[i] for i in input_indices])
+        new_args = [call.args[0], inputs] + list(call.args[2:])
+        new_call = relax.Call(call.op, new_args, call.attrs, call.type_args)
+        return bb.emit(new_call)
+
+    def record_lowered_call(key, attrs, new_args, var):
+        """Record the call_tir bound to var, if its inputs are among the relax arguments."""
+        call = bb.lookup_binding(var)
+        if not isinstance(call, relax.Call) or not isinstance(call.args[1], relax.Tuple):
+            return
+        input_indices = []
+        for field in call.args[1].fields:
+            matched = [i for i, arg in enumerate(new_args) if arg.same_as(field)]
+            if not matched:
+                return
+            input_indices.append(matched[0])
+        lowered_calls[key] = (attrs, call, input_indices)
+
     def visit_func(node):
         nonlocal output_var
         if isinstance(node, relay.Var):
@@ -132,19 +193,31 @@ def from_relay(
                 call = relax.call_tir(tir_gvar, new_args, out_type.shape, out_type.dtype)
                 var = bb.emit(call)
             else:
-                best_impl, outputs = select_implementation(
-                    node.op,
-                    attrs,
-                    te_inputs,
-                    out_type,
-                    target,
-                    use_autotvm=False,
-                )
-                compute_func = best_impl.compute
-                name_hint = op_name.split(".")[-1]
-                var = bb.emit_te(
-                    compute_func, attrs, new_args, node.checked_type, primfunc_name_hint=name_hint
-                )
+                # Reuse the TE lowering of an earlier call of the same op, attrs and types.
+                key = lowering_cache_key(node, new_args)
+                var = None
+                if key is not None and key in lowered_calls:
+                    var = emit_cached_call(key, attrs, new_args)
+                if var is None:
+                    best_impl, outputs = select_implementation(
+                        node.op,
+                        attrs,
+                        te_inputs,
+                        out_type,
+                        target,
+                        use_autotvm=False,
+                    )
+                    compute_func = best_impl.compute
+                    name_hint = op_name.split(".")[-1]
+                    var = bb.emit_te(
+                        compute_func,
+                        attrs,
+                        new_args,
+                        node.checked_type,
+                        primfunc_name_hint=name_hint,
+                    )
+                    if key is not None and key not in lowered_calls:
+                        record_lowered_call(key, attrs, new_args, var)
 
             output_var = var
             var_map[node] = var
@@ -193,6 +266,9 @@ def from_relay(
         opt_level=opt_level, config=pass_config, disabled_pass=disabled_pass
     ):
         mod = tvm.IRModule.from_expr(func)
+        if desired_layouts:
+            # The pass prefix folds the layout transforms of the bound parameters.
+            mod = relay.transform.ConvertLayout(desired_layouts)(mod)
         mod = seq(mod)
         bb = relax.BlockBuilder()
         with bb.function("main"):
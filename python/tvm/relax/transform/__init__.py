@@ -19,3 +19,9 @@
 
 from .transform import *
 from .fma_rewrite import *
+from .legalize_ops import *
+from .op_strategy import register_strategy, get_strategies
+from .fuse_attention import *
+from .dispatch_kernels import *
+from .tensor_parallel import *
+from .collage import measure_latency
@@ -0,0 +1,80 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""The measured latency of the candidates of CollagePartition"""
+from typing import Callable
+
+import numpy as np
+
+import tvm
+from tvm.ir import IRModule
+from tvm.runtime import Device
+from tvm.target import Target
+
+
+def measure_latency(
+    target: Target, device: Device, number: int = 10, repeat: int = 3
+) -> Callable[[IRModule], float]:
+    """The estimator of CollagePartition running the candidates on the device: the offloaded
+    functions are compiled by their codegen, the other operators are legalized, and the main
+    function is timed on random inputs.
+
+    Parameters
+    ----------
+    target : tvm.target.Target
+        The target the candidates are built for.
+
+    device : tvm.runtime.Device
+        The device the candidates run on.
+
+    number : int
+        The number of runs averaged in one repeat.
+
+    repeat : int
+        The number of repeats, the latency is their median.
+
+    Returns
+    -------
+    estimate_latency : Callable[[tvm.IRModule], float]
+        The latency in seconds of the main function of a module. The parameters must be tensors
+        of static shapes.
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm import relax
+    from .legalize_ops import LegalizeOps
+    from .transform import RemoveUnusedFunctions, RunCodegen
+
+    def estimate_latency(mod: IRModule) -> float:
+        mod = RunCodegen()(mod)
+        mod = RemoveUnusedFunctions()(mod)
+        mod = LegalizeOps()(mod)
+        with tvm.transform.PassContext(opt_level=3):
+            ex = relax.vm.build(mod, target)
+        vm = relax.VirtualMachine(ex, device)
+        args = []
+        for param in mod["main"].params:
+            shape = param.shape
+            if not isinstance(shape, relax.ShapeExpr) or not all(
+                isinstance(dim, tvm.tir.IntImm) for dim in shape.values
+            ):
+                raise ValueError(f"The candidate takes the parameter {param} of a dynamic shape")
+            dtype = param.checked_type.dtype
+            data = np.random.uniform(size=[int(dim) for dim in shape.values]).astype(dtype)
+            args.append(tvm.nd.array(data, device))
+        return vm.time_evaluator("main", device, number=number, repeat=repeat)(*args).median
+
+    return estimate_latency
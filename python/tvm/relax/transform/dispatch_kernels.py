@@ -0,0 +1,122 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Add the variants of the kernels with symbolic shapes tuned for ranges of a dimension"""
+import logging
+from typing import List, Optional, Tuple
+
+import tvm
+from tvm import tir
+from tvm.ir.module import IRModule
+from tvm.ir.transform import module_pass
+from tvm.target import Target
+from tvm.tir import PrimFunc, Schedule
+
+logger = logging.getLogger(__name__)  # pylint: disable=invalid-name
+
+
+def _find_dim(func: PrimFunc, dim_name: str) -> Optional[Tuple[int, int]]:
+    """The parameter index and the axis of the first buffer dimension named dim_name."""
+    for index, param in enumerate(func.params):
+        if param not in func.buffer_map:
+            continue
+        for axis, dim in enumerate(func.buffer_map[param].shape):
+            if isinstance(dim, tir.Var) and dim.name == dim_name:
+                return index, axis
+    return None
+
+
+def DispatchKernelsByShape(
+    database: "tvm.meta_schedule.database.Database",
+    target: Target,
+    dim_name: str,
+    extents: List[int],
+) -> tvm.ir.transform.Pass:
+    """Add the variants of the kernels with a symbolic dimension, tuned at the given extents of
+    the dimension, for the VM to pick from at each call.
+
+    For every extent, the best record in the database of the kernel specialized to the extent,
+    e.g. as tuned with `meta_schedule.tune.specialize_symbolic_tasks`, is replayed on the
+    symbolic kernel. The variant serves the dimensions larger than the previous extent and up to
+    its own, and the kernel itself serves the dimensions beyond the largest extent. The VM finds
+    the variant by a binary search over the extents. The extents without a record, or whose
+    record does not apply to the symbolic kernel, have no variant.
+
+    Parameters
+    ----------
+    database : tvm.meta_schedule.database.Database
+        The tuning database.
+
+    target : Target
+        The target the kernels are tuned for.
+
+    dim_name : str
+        The name of the symbolic dimension in the buffer shapes of the kernels.
+
+    extents : List[int]
+        The extents the kernels are tuned at.
+
+    Returns
+    -------
+    ret : tvm.ir.transform.Pass
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm.meta_schedule.extracted_task import ExtractedTask
+
+    extents = sorted(set(int(extent) for extent in extents))
+
+    def variant(name: str, func: PrimFunc, extent: int) -> Optional[PrimFunc]:
+        mod = IRModule({"main": func})
+        task = ExtractedTask(name, mod, target, [mod], 1)
+        workload_mod = task.specialize({dim_name: extent}, 1).dispatched[0]
+        if not database.has_workload(workload_mod):
+            return None
+        records = database.get_top_k(database.commit_workload(workload_mod), 1)
+        if not records:
+            return None
+        sch = Schedule(mod)
+        try:
+            records[0].trace.apply_to_schedule(sch, remove_postproc=False)
+        except Exception:  # pylint: disable=broad-except
+            logger.warning("The schedule of %s at %s=%d does not apply", name, dim_name, extent)
+            return None
+        return sch.mod["main"]
+
+    def transform_module(mod: IRModule, ctx: tvm.transform.PassContext) -> IRModule:
+        mod = IRModule({gv: mod[gv] for gv in mod.get_global_vars()}, attrs=mod.attrs)
+        for gv in mod.get_global_vars():
+            func = mod[gv]
+            if not isinstance(func, PrimFunc):
+                continue
+            dim = _find_dim(func, dim_name)
+            if dim is None:
+                continue
+            table_extents, variants = [], []
+            for extent in extents:
+                scheduled = variant(gv.name_hint, func, extent)
+                if scheduled is None:
+                    continue
+                name = f"{gv.name_hint}_{dim_name}{extent}"
+                mod[tvm.ir.GlobalVar(name)] = scheduled.with_attr("global_symbol", name)
+                table_extents.append(extent)
+                variants.append(name)
+            if variants:
+                table = {"dim": list(dim), "extents": table_extents, "variants": variants}
+                mod[gv] = func.with_attr("relax.kernel_dispatch_table", table)
+        return mod
+
+    return module_pass(transform_module, opt_level=0, name="DispatchKernelsByShape")
@@ -0,0 +1,103 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Rewrite the matmul-softmax-matmul chains of attention into the fused attention operator"""
+from typing import Optional
+
+from tvm.ir import Op
+from ..expr_functor import ExprMutator
+from ..expr import Call, Constant, Expr
+from ..op.nn import attention
+from ..transform import dataflowblock_pass
+
+
+class AttentionRewriter(ExprMutator):
+    """Rewrites the matmul whose lhs is the softmax of the scores of the queries and the
+    transposed keys into a call to relax.nn.attention, whose legalization keeps the scores on
+    chip instead of materializing them in memory.
+
+    Example
+    --------
+    lv0 = relax.matmul(q, k_t)
+    lv1 = relax.multiply(lv0, scale)
+    lv2 = relax.nn.softmax(lv1, axis=-1)
+    lv3 = relax.matmul(lv2, v)
+    -->
+    lv3 = relax.nn.attention(q, k_t, v, scale)
+    """
+
+    def _lookup_call(self, expr: Expr, op_name: str) -> Optional[Call]:
+        value = self.lookup_binding(expr)
+        if isinstance(value, Call) and value.op == Op.get(op_name):
+            return value
+        return None
+
+    @staticmethod
+    def _scalar(expr: Expr) -> Optional[float]:
+        if isinstance(expr, Constant) and expr.data.numpy().size == 1:
+            return float(expr.data.numpy().reshape(()))
+        return None
+
+    def visit_call_(self, call_node: Call) -> Expr:
+        call = self.builder_.normalize(ExprMutator.visit_call_(self, call_node))
+        if call.op != Op.get("relax.matmul"):
+            return call
+        softmax = self._lookup_call(call.args[0], "relax.nn.softmax")
+        if softmax is None:
+            return call
+        ndim = softmax.args[0].checked_type.ndim
+        if softmax.attrs.axis not in (-1, ndim - 1):
+            return call
+        scores = softmax.args[0]
+        scale = 1.0
+        multiply = self._lookup_call(scores, "relax.multiply")
+        if multiply is not None:
+            for lhs, rhs in [multiply.args, reversed(multiply.args)]:
+                if self._scalar(rhs) is not None:
+                    scale, scores = self._scalar(rhs), lhs
+                    break
+            else:
+                return call
+        qk = self._lookup_call(scores, "relax.matmul")
+        if qk is None:
+            return call
+        query, key = qk.args
+        value = call.args[1]
+        if not query.checked_type.ndim == key.checked_type.ndim == value.checked_type.ndim == ndim:
+            return call
+        return attention(query, key, value, scale)
+
+
+@dataflowblock_pass(opt_level=0, name="FuseAttention")
+class _FuseAttention:
+    """The wrapper for the AttentionRewriter pass."""
+
+    def transform_dataflowblock(self, block, mod, ctx):
+        return AttentionRewriter().visit_binding_block(block)
+
+
+def FuseAttention():
+    """Rewrite the attention spelled as matmul(softmax(matmul(query, key_t) * scale), value) in
+    the dataflow blocks into relax.nn.attention, whose legalization computes it in one tiled
+    kernel with an online softmax. The scale is optional and must be a scalar constant. Run
+    DeadCodeElimination afterwards to remove the intermediate bindings.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _FuseAttention()
@@ -0,0 +1,266 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Lower the high-level Relax operators to call_tirs of TOPI-based PrimFuncs"""
+import math
+from typing import Callable, Dict, Optional
+
+import tvm
+from tvm import te, topi
+from tvm.ir import Op
+from tvm.ir.module import IRModule
+from tvm.ir.transform import module_pass
+from tvm.target import Target
+from ..block_builder import BlockBuilder
+from ..expr import Call, Expr, Function
+from ..expr_functor import ExprMutator
+from .op_strategy import get_strategies
+
+# A legalization function takes the block builder and a call to an operator, and returns the
+# expression computing the call, typically a call_tir created by BlockBuilder.call_te.
+LegalizeFunc = Callable[[BlockBuilder, Call], Expr]
+
+
+def _binary(te_func: Callable) -> LegalizeFunc:
+    return lambda bb, call: bb.call_te(te_func, call.args[0], call.args[1])
+
+
+def _unary(te_func: Callable) -> LegalizeFunc:
+    return lambda bb, call: bb.call_te(te_func, call.args[0])
+
+
+def _ewise_fma(bb: BlockBuilder, call: Call) -> Expr:
+    def ewise_fma(a, b, c):
+        return topi.add(topi.multiply(a, b), c)
+
+    return bb.call_te(ewise_fma, *call.args)
+
+
+def _matmul(bb: BlockBuilder, call: Call) -> Expr:
+    def matmul(a, b):
+        # The batch dimensions are those of the operand with more dimensions, the other operand
+        # is broadcast.
+        batch = list(a.shape[:-2] if len(a.shape) >= len(b.shape) else b.shape[:-2])
+        k = te.reduce_axis((0, a.shape[-1]), name="k")
+
+        def fcompute(*idx):
+            batch_idx, i, j = idx[:-2], idx[-2], idx[-1]
+            a_idx = list(batch_idx[len(batch_idx) - (len(a.shape) - 2) :]) + [i, k]
+            b_idx = list(batch_idx[len(batch_idx) - (len(b.shape) - 2) :]) + [k, j]
+            return te.sum(a(*a_idx) * b(*b_idx), axis=k)
+
+        return te.compute(batch + [a.shape[-2], b.shape[-1]], fcompute, name="matmul")
+
+    return bb.call_te(matmul, call.args[0], call.args[1])
+
+
+def _gelu(bb: BlockBuilder, call: Call) -> Expr:
+    def gelu(x):
+        half = tvm.tir.const(0.5, x.dtype)
+        one = tvm.tir.const(1.0, x.dtype)
+        rsqrt2 = tvm.tir.const(1.0 / math.sqrt(2.0), x.dtype)
+        return te.compute(
+            x.shape, lambda *i: x(*i) * half * (one + te.erf(x(*i) * rsqrt2)), name="gelu"
+        )
+
+    return bb.call_te(gelu, call.args[0])
+
+
+def _softmax(bb: BlockBuilder, call: Call) -> Expr:
+    return bb.call_te(topi.nn.softmax, call.args[0], call.attrs.axis)
+
+
+def _conv2d(bb: BlockBuilder, call: Call) -> Expr:
+    attrs = call.attrs
+    out_dtype = str(attrs.out_dtype)
+    out_dtype = None if out_dtype in ("", "void") else out_dtype
+    if attrs.groups == 1:
+        return bb.call_te(
+            topi.nn.conv2d,
+            call.args[0],
+            call.args[1],
+            attrs.strides,
+            attrs.padding,
+            attrs.dilation,
+            "NCHW",
+            out_dtype,
+        )
+    return bb.call_te(
+        topi.nn.group_conv2d_nchw,
+        call.args[0],
+        call.args[1],
+        attrs.strides,
+        attrs.padding,
+        attrs.dilation,
+        attrs.groups,
+        out_dtype,
+    )
+
+
+def _layer_norm(bb: BlockBuilder, call: Call) -> Expr:
+    attrs = call.attrs
+
+    def layer_norm(data, gamma, beta):
+        ndim = len(data.shape)
+        axis = attrs.axis + ndim if attrs.axis < 0 else attrs.axis
+        num_elem = tvm.tir.Cast(data.dtype, data.shape[axis])
+        mean = topi.divide(topi.sum(data, axis=axis, keepdims=True), num_elem)
+        centered = topi.subtract(data, mean)
+        var = topi.divide(
+            topi.sum(topi.multiply(centered, centered), axis=axis, keepdims=True), num_elem
+        )
+        epsilon = tvm.tir.const(attrs.epsilon, data.dtype)
+        out = topi.divide(centered, topi.sqrt(topi.add(var, epsilon)))
+        # Broadcast the 1-D scale and offset along the normalized axis.
+        param_shape = [data.shape[i] if i == axis else 1 for i in range(ndim)]
+        if attrs.scale:
+            out = topi.multiply(out, topi.reshape(gamma, param_shape))
+        if attrs.center:
+            out = topi.add(out, topi.reshape(beta, param_shape))
+        return out
+
+    return bb.call_te(layer_norm, *call.args)
+
+
+def _attention(bb: BlockBuilder, call: Call) -> Expr:
+    scale = call.attrs.scale
+    scale = None if scale is None else scale.value
+    return bb.call_te(topi.nn.flash_attention, *call.args, scale)
+
+
+def _embedding_bag(bb: BlockBuilder, call: Call) -> Expr:
+    return bb.call_te(topi.nn.embedding_bag, *call.args, str(call.attrs.mode))
+
+
+def _sparse(te_func: Callable) -> LegalizeFunc:
+    return lambda bb, call: bb.call_te(te_func, *call.args)
+
+
+DEFAULT_LEGALIZE_MAP: Dict[str, LegalizeFunc] = {
+    "relax.add": _binary(topi.add),
+    "relax.multiply": _binary(topi.multiply),
+    "relax.ewise_fma": _ewise_fma,
+    "relax.matmul": _matmul,
+    "relax.sparse_dense": _sparse(topi.nn.sparse_dense_extern),
+    "relax.sparse_add": _sparse(topi.nn.sparse_add),
+    "relax.nn.relu": _unary(topi.nn.relu),
+    "relax.nn.gelu": _gelu,
+    "relax.nn.softmax": _softmax,
+    "relax.nn.conv2d": _conv2d,
+    "relax.nn.layer_norm": _layer_norm,
+    "relax.nn.attention": _attention,
+    "relax.nn.embedding_bag": _embedding_bag,
+}
+
+
+class OpLegalizer(ExprMutator):
+    """Replace the calls to the operators of a legalization map by the expressions computing
+    them, the PrimFuncs created are added to the module.
+
+    Example
+    --------
+    lv0 = relax.add(x, y)
+    -->
+    lv0 = relax.call_tir(add, (x, y), (m, n), dtype="float32")
+    """
+
+    def __init__(
+        self,
+        mod: IRModule,
+        legalize_map: Dict[str, LegalizeFunc],
+        target: Optional[Target] = None,
+        database: Optional["tvm.meta_schedule.database.Database"] = None,
+    ) -> None:
+        super().__init__(mod)
+        self.mod_ = mod
+        self.legalize_map_ = legalize_map
+        self.target_ = target
+        self.database_ = database
+
+    def transform(self) -> IRModule:
+        for global_var, func in self.mod_.functions.items():
+            if isinstance(func, Function):
+                new_func = self.visit_expr(func)
+                if not new_func.same_as(func):
+                    self.builder_.update_func(global_var, new_func)
+        return self.builder_.get()
+
+    def visit_call_(self, call_node: Call) -> Expr:
+        call = ExprMutator.visit_call_(self, call_node)
+        if not isinstance(call.op, Op):
+            return call
+        if self.target_ is not None and not self._is_tuned(call):
+            for _, impl in get_strategies(call.op.name, self.target_):
+                expr = impl(self.builder_, call, self.target_)
+                if expr is not None:
+                    return expr
+        if call.op.name in self.legalize_map_:
+            return self.legalize_map_[call.op.name](self.builder_, call)
+        return call
+
+    def _is_tuned(self, call: Call) -> bool:
+        """Whether the default kernel of the call has a record in the tuning database."""
+        if self.database_ is None or call.op.name not in self.legalize_map_:
+            return False
+        # The kernel is created in a scratch module, to be compared with the tuned workloads.
+        scratch = BlockBuilder()
+        self.legalize_map_[call.op.name](scratch, call)
+        kernels = list(scratch.get().functions.values())
+        if len(kernels) != 1:
+            return False
+        return self.database_.has_workload(IRModule({"main": kernels[0]}))
+
+
+def LegalizeOps(
+    customize_legalize_map: Optional[Dict[str, LegalizeFunc]] = None,
+    target: Optional[Target] = None,
+    database: Optional["tvm.meta_schedule.database.Database"] = None,
+) -> tvm.ir.transform.Pass:
+    """Lower the calls to the high-level operators, e.g. relax.nn.conv2d or relax.matmul, to
+    call_tirs of PrimFuncs created from their TOPI compute definitions, so that the module can
+    be built once the passes reasoning about the operators have run.
+
+    With a target, the implementations registered for the operator and the kind of the target
+    by register_strategy, e.g. the BLAS libraries for relax.matmul, are tried first, unless the
+    TOPI-based kernel of the call has a record in the tuning database. An untuned deployment
+    then runs the vendor kernels rather than the default schedules.
+
+    Parameters
+    ----------
+    customize_legalize_map : Optional[Dict[str, LegalizeFunc]]
+        The legalization functions overriding or extending DEFAULT_LEGALIZE_MAP, keyed by
+        operator name. A legalization function takes the block builder and the call, and
+        returns the expression computing the call, e.g. bb.call_te(topi_func, *call.args).
+
+    target : Optional[Target]
+        The target whose implementations of the operators are tried first.
+
+    database : Optional[tvm.meta_schedule.database.Database]
+        The tuning database, whose tuned kernels are kept over the target implementations.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    legalize_map = dict(DEFAULT_LEGALIZE_MAP)
+    if customize_legalize_map is not None:
+        legalize_map.update(customize_legalize_map)
+
+    def transform_module(mod: IRModule, ctx: tvm.transform.PassContext) -> IRModule:
+        return OpLegalizer(mod, legalize_map, target, database).transform()
+
+    return module_pass(transform_module, opt_level=0, name="LegalizeOps")
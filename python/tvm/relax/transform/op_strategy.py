@@ -0,0 +1,164 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""The target-specific implementations of the Relax operators, tried by LegalizeOps before the
+TOPI-based default of an operator when the default kernel has no tuning record"""
+import importlib
+from typing import Callable, Dict, List, Optional, Tuple
+
+import tvm
+from tvm.target import Target
+from ..block_builder import BlockBuilder
+from ..expr import Call, Expr, ShapeExpr
+
+# An implementation takes the block builder, a call to an operator and the target, and returns
+# the expression computing the call, or None when it does not support the call.
+OpImplementation = Callable[[BlockBuilder, Call, Target], Optional[Expr]]
+
+# The implementations of each operator and target kind, by decreasing priority.
+OP_STRATEGY_TABLE: Dict[Tuple[str, str], List[Tuple[int, str, OpImplementation]]] = {}
+
+
+def register_strategy(
+    op_name: str, target_kind: str, name: str, priority: int = 10
+) -> Callable[[OpImplementation], OpImplementation]:
+    """Register an implementation of an operator for a kind of target.
+
+    Parameters
+    ----------
+    op_name : str
+        The name of the operator, e.g. "relax.matmul".
+
+    target_kind : str
+        The kind of the target, e.g. "llvm" or "cuda".
+
+    name : str
+        The name of the implementation, which replaces the implementation of the same name.
+
+    priority : int
+        The implementations of higher priorities are tried first.
+
+    Returns
+    -------
+    register : Callable[[OpImplementation], OpImplementation]
+        The decorator registering the implementation.
+    """
+
+    def register(impl: OpImplementation) -> OpImplementation:
+        impls = OP_STRATEGY_TABLE.setdefault((op_name, target_kind), [])
+        impls[:] = [entry for entry in impls if entry[1] != name]
+        impls.append((priority, name, impl))
+        impls.sort(key=lambda entry: -entry[0])
+        return impl
+
+    return register
+
+
+def get_strategies(op_name: str, target: Target) -> List[Tuple[str, OpImplementation]]:
+    """Get the implementations of an operator for a target, by decreasing priority."""
+    impls = OP_STRATEGY_TABLE.get((op_name, target.kind.name), [])
+    return [(name, impl) for _, name, impl in impls]
+
+
+def _enabled(func_name: str) -> bool:
+    """Whether the packed function of a vendor library is in this build of TVM."""
+    return tvm.get_global_func(func_name, allow_missing=True) is not None
+
+
+def _static_shape(expr: Expr) -> Optional[List[int]]:
+    """The shape of a tensor if it is known at compile time."""
+    shape = expr.shape
+    if not isinstance(shape, ShapeExpr):
+        return None
+    if not all(isinstance(dim, tvm.tir.IntImm) for dim in shape.values):
+        return None
+    return [int(dim) for dim in shape.values]
+
+
+def _matmul_operands(call: Call, dtypes: List[str]) -> Optional[int]:
+    """The rank of the operands of a matmul the BLAS libraries compute, i.e. two matrices or two
+    batches of matrices of the same size, else None."""
+    lhs, rhs = call.args
+    lhs_type, rhs_type = lhs.checked_type, rhs.checked_type
+    if lhs_type.dtype != rhs_type.dtype or lhs_type.dtype not in dtypes:
+        return None
+    if lhs_type.ndim != rhs_type.ndim or lhs_type.ndim not in (2, 3):
+        return None
+    if lhs_type.ndim == 3:
+        if not isinstance(lhs.shape, ShapeExpr) or not isinstance(rhs.shape, ShapeExpr):
+            return None
+        analyzer = tvm.arith.Analyzer()
+        if not analyzer.can_prove_equal(lhs.shape.values[0], rhs.shape.values[0]):
+            return None
+    return lhs_type.ndim
+
+
+def _blas_matmul(library: str, dtypes: List[str]) -> OpImplementation:
+    def matmul(bb: BlockBuilder, call: Call, target: Target) -> Optional[Expr]:
+        ndim = _matmul_operands(call, dtypes)
+        if ndim is None:
+            return None
+        func_name = "matmul" if ndim == 2 else "batch_matmul"
+        if not _enabled(f"tvm.contrib.{library}.{func_name}"):
+            return None
+        module = importlib.import_module(f"tvm.contrib.{library}")
+        return bb.call_te(getattr(module, func_name), call.args[0], call.args[1])
+
+    return matmul
+
+
+register_strategy("relax.matmul", "llvm", "matmul.cblas")(
+    _blas_matmul("cblas", ["float32", "float64"])
+)
+register_strategy("relax.matmul", "cuda", "matmul.cublas")(
+    _blas_matmul("cublas", ["float16", "float32"])
+)
+register_strategy("relax.matmul", "rocm", "matmul.rocblas")(_blas_matmul("rocblas", ["float32"]))
+
+
+@register_strategy("relax.nn.conv2d", "cuda", "conv2d.cudnn")
+def _cudnn_conv2d(bb: BlockBuilder, call: Call, target: Target) -> Optional[Expr]:
+    # pylint: disable=import-outside-toplevel
+    from tvm.contrib import cudnn
+
+    attrs = call.attrs
+    data, weight = call.args
+    if data.checked_type.dtype not in ("float16", "float32") or not _enabled(
+        "tvm.contrib.cudnn.conv2d.forward"
+    ):
+        return None
+    # cuDNN pads symmetrically, and picks the algorithm for the static shapes.
+    padding = [int(pad) for pad in attrs.padding]
+    if padding[0] != padding[2] or padding[1] != padding[3]:
+        return None
+    if _static_shape(data) is None or _static_shape(weight) is None:
+        return None
+    out_dtype = str(attrs.out_dtype)
+    conv_dtype = data.checked_type.dtype if out_dtype in ("", "void") else out_dtype
+    return bb.call_te(
+        cudnn.conv_forward,
+        data,
+        weight,
+        padding[:2],
+        [int(stride) for stride in attrs.strides],
+        [int(dilation) for dilation in attrs.dilation],
+        1,  # CUDNN_CROSS_CORRELATION
+        0,  # CUDNN_TENSOR_NCHW
+        -1,  # the fastest algorithm
+        conv_dtype,
+        int(attrs.groups),
+    )
@@ -0,0 +1,506 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Shard the call_tirs of Relax functions among the devices of the VM for tensor parallelism"""
+from typing import Dict, List, NamedTuple, Optional, Union
+
+import numpy as np
+
+import tvm
+from tvm import tir
+from tvm.ir import Op, Range
+from tvm.ir.module import IRModule
+from tvm.ir.transform import module_pass
+from tvm.tir import PrimFunc
+from ..expr import (
+    Call,
+    DataflowVar,
+    Expr,
+    ExternFunc,
+    Function,
+    GlobalVar,
+    ShapeExpr,
+    Tuple,
+    TupleGetItem,
+    Var,
+    VarBinding,
+)
+from ..expr_functor import ExprMutator
+from ..op.base import call_tir
+from ..ty import DynTensorType, TupleType
+
+# The distributions of a value among the devices, each of them is a tuple of one tensor per
+# device, the tensor of the i-th device is computed on the i-th device of the VM.
+# The slices of the value split along an axis.
+SHARD = "shard"
+# The partial sums of the value.
+PARTIAL = "partial"
+# The copies of the value.
+REPLICA = "replica"
+
+
+class _Dist(NamedTuple):
+    """A value distributed among the devices."""
+
+    kind: str
+    axis: Optional[int]
+    shards: Expr
+    shape: List[int]
+
+
+class _Kernel(NamedTuple):
+    """A PrimFunc computing its output by a single block, under a nest of loops."""
+
+    func: PrimFunc
+    loops: List[tir.For]
+    realize: tir.BlockRealize
+    accesses: list
+
+
+def _uses_var(node, var: tir.Var) -> bool:
+    found = []
+    tir.stmt_functor.post_order_visit(
+        node, lambda n: found.append(n) if isinstance(n, tir.Var) and n.same_as(var) else None
+    )
+    return bool(found)
+
+
+def _as_kernel(func: PrimFunc, num_args: int) -> Optional[_Kernel]:
+    if len(func.params) != num_args or any(p not in func.buffer_map for p in func.params):
+        return None
+    root = func.body
+    if not isinstance(root, tir.BlockRealize) or root.block.alloc_buffers:
+        return None
+    stmt, loops = root.block.body, []
+    while isinstance(stmt, tir.For):
+        loops.append(stmt)
+        stmt = stmt.body
+    if not isinstance(stmt, tir.BlockRealize):
+        return None
+    if not isinstance(stmt.predicate, tir.IntImm) or not stmt.predicate.value:
+        return None
+    block = stmt.block
+    accesses, nested = [], []
+
+    def fvisit(node):
+        if isinstance(node, (tir.BufferLoad, tir.BufferStore)):
+            accesses.append((node.buffer, list(node.indices)))
+        elif isinstance(node, tir.Block):
+            nested.append(node)
+
+    tir.stmt_functor.post_order_visit(block.body, fvisit)
+    if block.init is not None:
+        tir.stmt_functor.post_order_visit(block.init, fvisit)
+    if nested or block.alloc_buffers or block.match_buffers:
+        return None
+    return _Kernel(func, loops, stmt, accesses)
+
+
+def _buffer_axes(kernel: _Kernel, iter_index: int) -> Optional[List[Optional[int]]]:
+    """The axis of each parameter buffer indexed by the block iter var, None for the buffers not
+    indexed by it. Returns None if the iter var cannot be split, i.e. it is not bound to a whole
+    loop, or it is used otherwise than as a buffer index."""
+    func, realize = kernel.func, kernel.realize
+    iter_var = realize.block.iter_vars[iter_index]
+    loop_var = realize.iter_values[iter_index]
+    dom = iter_var.dom
+    if not isinstance(dom.extent, tir.IntImm) or not isinstance(dom.min, tir.IntImm):
+        return None
+    loops = [loop for loop in kernel.loops if loop.loop_var.same_as(loop_var)]
+    if dom.min.value != 0 or len(loops) != 1:
+        return None
+    loop = loops[0]
+    if not isinstance(loop.min, tir.IntImm) or loop.min.value != 0:
+        return None
+    if not isinstance(loop.extent, tir.IntImm) or loop.extent.value != dom.extent.value:
+        return None
+    other_values = [value for i, value in enumerate(realize.iter_values) if i != iter_index]
+    if any(_uses_var(value, loop_var) for value in other_values):
+        return None
+    axis_of = {}
+    for buffer, indices in kernel.accesses:
+        axes = [axis for axis, index in enumerate(indices) if index.same_as(iter_var.var)]
+        axis = axes[0] if len(axes) == 1 else None
+        if len(axes) > 1 or axis_of.get(buffer, axis) != axis:
+            return None
+        axis_of[buffer] = axis
+    # The iter var must not be used in any other way, e.g. in the value computed.
+    zero = tir.const(0, iter_var.var.dtype)
+
+    def mask(node):
+        indices = [zero if index.same_as(iter_var.var) else index for index in node.indices]
+        if isinstance(node, tir.BufferLoad):
+            return tir.BufferLoad(node.buffer, indices)
+        return tir.BufferStore(node.buffer, node.value, indices)
+
+    block = realize.block
+    for stmt in [block.body] + ([block.init] if block.init is not None else []):
+        masked = tir.stmt_functor.ir_transform(
+            stmt, None, mask, ["tir.BufferLoad", "tir.BufferStore"]
+        )
+        if _uses_var(masked, iter_var.var):
+            return None
+    axes = [axis_of.get(func.buffer_map[param]) for param in func.params]
+    for param, axis in zip(func.params, axes):
+        if axis is not None:
+            dim = func.buffer_map[param].shape[axis]
+            if not isinstance(dim, tir.IntImm) or dim.value != iter_var.dom.extent.value:
+                return None
+    return axes
+
+
+def _is_sum_reduction(block: tir.Block, buffer: tir.Buffer) -> bool:
+    """Whether the block sums into the buffer, starting from zero."""
+    init, body = block.init, block.body
+    if not isinstance(init, tir.BufferStore) or not isinstance(body, tir.BufferStore):
+        return False
+    if not init.buffer.same_as(buffer) or not body.buffer.same_as(buffer):
+        return False
+    if not isinstance(init.value, (tir.IntImm, tir.FloatImm)) or init.value.value != 0:
+        return False
+    value = body.value
+    return (
+        isinstance(value, tir.Add)
+        and isinstance(value.a, tir.BufferLoad)
+        and value.a.buffer.same_as(buffer)
+        and tvm.ir.structural_equal(list(value.a.indices), list(body.indices))
+    )
+
+
+def _shard_kernel(
+    kernel: _Kernel, iter_index: int, axes: List[Optional[int]], num_shards: int
+) -> PrimFunc:
+    """Split the loop of the block iter var, and the buffer axes it indexes, into the shards."""
+    func, realize = kernel.func, kernel.realize
+    iter_var = realize.block.iter_vars[iter_index]
+    loop_var = realize.iter_values[iter_index]
+    full_extent = iter_var.dom.extent.value
+    extent = full_extent // num_shards
+    buffer_map, buffer_remap, axis_of = {}, {}, {}
+    for param, axis in zip(func.params, axes):
+        buffer = func.buffer_map[param]
+        if axis is not None:
+            shape = list(buffer.shape)
+            shape[axis] = tir.IntImm(shape[axis].dtype, extent)
+            new_buffer = tir.decl_buffer(shape, buffer.dtype, buffer.name)
+            buffer_remap[buffer] = new_buffer
+            axis_of[new_buffer] = axis
+            buffer = new_buffer
+        buffer_map[param] = buffer
+
+    def remap_region(region: tir.BufferRegion) -> tir.BufferRegion:
+        if region.buffer not in buffer_remap:
+            return region
+        buffer = buffer_remap[region.buffer]
+        ranges = list(region.region)
+        axis = axis_of[buffer]
+        dim = ranges[axis]
+        if isinstance(dim.extent, tir.IntImm) and dim.extent.value == full_extent:
+            ranges[axis] = Range.from_min_extent(dim.min, tir.IntImm(dim.extent.dtype, extent))
+        return tir.BufferRegion(buffer, ranges)
+
+    def postorder(node):
+        if isinstance(node, tir.For) and node.loop_var.same_as(loop_var):
+            return tir.For(
+                node.loop_var,
+                node.min,
+                tir.IntImm(node.extent.dtype, extent),
+                node.kind,
+                node.body,
+                node.thread_binding,
+                node.annotations,
+            )
+        if isinstance(node, tir.BufferLoad) and node.buffer in buffer_remap:
+            return tir.BufferLoad(buffer_remap[node.buffer], node.indices)
+        if isinstance(node, tir.BufferStore) and node.buffer in buffer_remap:
+            return tir.BufferStore(buffer_remap[node.buffer], node.value, node.indices)
+        if isinstance(node, tir.Block):
+            iter_vars = [
+                tir.IterVar(
+                    Range.from_min_extent(v.dom.min, tir.IntImm(v.dom.extent.dtype, extent)),
+                    v.var,
+                    v.iter_type,
+                    v.thread_tag,
+                )
+                if v.var.same_as(iter_var.var)
+                else v
+                for v in node.iter_vars
+            ]
+            return tir.Block(
+                iter_vars,
+                [remap_region(region) for region in node.reads],
+                [remap_region(region) for region in node.writes],
+                node.name_hint,
+                node.body,
+                node.init,
+                node.alloc_buffers,
+                node.match_buffers,
+                node.annotations,
+            )
+        return None
+
+    body = tir.stmt_functor.ir_transform(
+        func.body, None, postorder, ["tir.For", "tir.Block", "tir.BufferLoad", "tir.BufferStore"]
+    )
+    return PrimFunc(func.params, body, func.ret_type, buffer_map, attrs=func.attrs)
+
+
+def _static_shape(shape: Expr) -> Optional[List[int]]:
+    if not isinstance(shape, ShapeExpr) or not all(isinstance(v, tir.IntImm) for v in shape.values):
+        return None
+    return [int(v) for v in shape.values]
+
+
+class TensorParallelSharder(ExprMutator):
+    """Shard the call_tirs of the functions annotated with "relax.sharding" among the devices,
+    and insert the collective communication between the shards of the values.
+
+    The annotation maps the names of the parameters to shard to their split axes. A sharded
+    parameter is passed as a tuple of the slices of the tensor, the i-th slice on the i-th device
+    of the VM. A call_tir reading a sharded value runs on every device when the kernel computes
+    its output by a single block, and one of the block iter vars is only used to index the
+    sharded axis: the loop of the iter var is split among the devices, and so are the axes of the
+    other buffers it indexes. The other inputs are replicated on the devices. The output is
+    sharded along the axis indexed by the iter var, or holds the partial sums of the devices
+    when the iter var is a sum reduction. The values used otherwise, e.g. by the calls which
+    cannot be sharded and the returned values, are gathered on the first device.
+
+    Example
+    --------
+    # relax.sharding: {"w": 1}
+    lv0 = relax.call_tir(matmul, (x, w), (m, n), dtype="float32")
+    -->
+    lv1 = vm.builtin.ccl.broadcast(x, (2,))
+    lv0_0 = relax.call_tir(matmul_shard, (lv1[0], w[0]), (m, n / 2), runtime_device_index=0)
+    lv0_1 = relax.call_tir(matmul_shard, (lv1[1], w[1]), (m, n / 2), runtime_device_index=1)
+    lv0 = (lv0_0, lv0_1)
+    """
+
+    def __init__(self, mod: IRModule, num_shards: int) -> None:
+        super().__init__(mod)
+        self.mod_ = mod
+        self.num_shards_ = num_shards
+        self.call_tir_op_ = Op.get("relax.call_tir")
+        # The distributed values, keyed by the id of their vars.
+        self.dists_: Dict[object, _Dist] = {}
+        # The values gathered in the current binding block.
+        self.gathered_: Dict[object, Var] = {}
+        self.sharded_kernels_: Dict[tuple, GlobalVar] = {}
+
+    def transform(self) -> IRModule:
+        for global_var, func in self.mod_.functions.items():
+            if isinstance(func, Function) and func.attrs and "relax.sharding" in func.attrs:
+                self.builder_.update_func(global_var, self._shard_function(func))
+        return self.builder_.get()
+
+    def _shard_function(self, func: Function) -> Function:
+        sharding = {str(name): int(axis) for name, axis in func.attrs["relax.sharding"].items()}
+        params = []
+        for param in func.params:
+            if param.name_hint not in sharding:
+                params.append(param)
+                continue
+            axis = sharding.pop(param.name_hint)
+            shape = _static_shape(param.shape_)
+            if shape is None or not 0 <= axis < len(shape) or shape[axis] % self.num_shards_:
+                raise ValueError(
+                    f"The parameter {param.name_hint} cannot be split into {self.num_shards_} "
+                    f"shards along the axis {axis}, only the static shapes can be sharded"
+                )
+            shards = Var(param.name_hint, None, TupleType([param.checked_type] * self.num_shards_))
+            self.dists_[param.vid] = _Dist(SHARD, axis, shards, shape)
+            params.append(shards)
+        if sharding:
+            raise ValueError(f"The parameters {list(sharding)} to shard are not found")
+        body = self.visit_with_new_scope(func.body)
+        new_func = Function(params, body, func.ret_type, func.attrs, func.span)
+        return new_func.without_attr("relax.sharding")
+
+    def visit_binding_block(self, block):
+        self.gathered_ = {}
+        ret = super().visit_binding_block(block)
+        self.gathered_ = {}
+        return ret
+
+    def visit_with_new_scope(self, expr: Expr) -> Expr:
+        outer, self.gathered_ = self.gathered_, {}
+        ret = super().visit_with_new_scope(expr)
+        self.gathered_ = outer
+        return ret
+
+    def visit_var_(self, op: Var) -> Expr:
+        if op.vid in self.dists_:
+            return self._gather_var(op)
+        return super().visit_var_(op)
+
+    def visit_dataflow_var_(self, op: DataflowVar) -> Expr:
+        if op.vid in self.dists_:
+            return self._gather_var(op)
+        return super().visit_dataflow_var_(op)
+
+    def visit_var_binding_(self, binding: VarBinding) -> None:
+        dist = self._shard_call_tir(binding.value)
+        if dist is None:
+            super().visit_var_binding_(binding)
+        elif isinstance(binding.var, DataflowVar):
+            self.dists_[binding.var.vid] = dist
+        else:
+            # The outputs of the dataflow blocks are gathered for the later blocks.
+            value = self._gather(dist)
+            if self.builder_.current_block_is_dataflow():
+                self.builder_.emit_output_var_binding(VarBinding(binding.var, value))
+            else:
+                self.builder_.emit_var_binding(VarBinding(binding.var, value))
+
+    def _ccl(self, name: str, args: List[Expr], ret_type: TupleType) -> Var:
+        func = ExternFunc("vm.builtin.ccl." + name)
+        return self.builder_.emit(Call(func, args, None, [ret_type]))
+
+    def _gather(self, dist: _Dist) -> Var:
+        """Gather a distributed value to a tensor on the first device."""
+        shards = dist.shards
+        if dist.kind == PARTIAL:
+            shards = self._ccl("allreduce", [shards], shards.checked_type)
+        elif dist.kind == SHARD:
+            shards = self._ccl("allgather", [shards, ShapeExpr([dist.axis])], shards.checked_type)
+        return self.builder_.emit(TupleGetItem(shards, 0))
+
+    def _gather_var(self, var: Var) -> Var:
+        if var.vid not in self.gathered_:
+            self.gathered_[var.vid] = self._gather(self.dists_[var.vid])
+        return self.gathered_[var.vid]
+
+    def _distribute(self, arg: Expr, dist: Optional[_Dist], axis: Optional[int]) -> Expr:
+        """Distribute an input of a sharded call, split along the axis or replicated if None."""
+        num_shards = self.num_shards_
+        if axis is not None:
+            if dist is not None and dist.kind == SHARD and dist.axis == axis:
+                return dist.shards
+            value = self.visit_expr(arg)
+            ret_type = TupleType([value.checked_type] * num_shards)
+            return self._ccl("scatter", [value, ShapeExpr([axis, num_shards])], ret_type)
+        if dist is None:
+            value = self.visit_expr(arg)
+            ret_type = TupleType([value.checked_type] * num_shards)
+            return self._ccl("broadcast", [value, ShapeExpr([num_shards])], ret_type)
+        if dist.kind == PARTIAL:
+            return self._ccl("allreduce", [dist.shards], dist.shards.checked_type)
+        if dist.kind == SHARD:
+            args = [dist.shards, ShapeExpr([dist.axis])]
+            return self._ccl("allgather", args, dist.shards.checked_type)
+        return dist.shards
+
+    def _shard_call_tir(self, call: Expr) -> Optional[_Dist]:
+        """Shard a call_tir reading a value sharded by an iter var of the kernel, if it can."""
+        if not isinstance(call, Call) or not call.op.same_as(self.call_tir_op_):
+            return None
+        # The calls with symbolic variables or attributes, e.g. placed on a device, are kept.
+        if len(call.args) != 3 or call.attrs is not None:
+            return None
+        gvar, args, shape = call.args
+        args = list(args.fields) if isinstance(args, Tuple) else [args]
+        dists = [self.dists_.get(arg.vid) if isinstance(arg, Var) else None for arg in args]
+        out_shape = _static_shape(shape)
+        if not any(dists) or out_shape is None or not isinstance(gvar, GlobalVar):
+            return None
+        func = self.mod_[gvar]
+        if not isinstance(func, PrimFunc) or not isinstance(call.checked_type, DynTensorType):
+            return None
+        kernel = _as_kernel(func, len(args) + 1)
+        if kernel is None:
+            return None
+        block = kernel.realize.block
+        # Split the iter var indexing the split axis of a sharded input.
+        iter_index = axes = None
+        for param, dist in zip(func.params, dists):
+            if axes is not None or dist is None or dist.kind != SHARD:
+                continue
+            buffer = func.buffer_map[param]
+            index = next(idx[dist.axis] for buf, idx in kernel.accesses if buf.same_as(buffer))
+            for i, iter_var in enumerate(block.iter_vars):
+                if index.same_as(iter_var.var):
+                    iter_index, axes = i, _buffer_axes(kernel, i)
+        if axes is None or block.iter_vars[iter_index].dom.extent.value % self.num_shards_:
+            return None
+        out_axis = axes[-1]
+        if out_axis is not None:
+            kind = SHARD
+            out_shape[out_axis] //= self.num_shards_
+        elif block.iter_vars[iter_index].iter_type == tir.IterVar.CommReduce and _is_sum_reduction(
+            block, func.buffer_map[func.params[-1]]
+        ):
+            kind = PARTIAL
+        else:
+            return None
+
+        key = (gvar, iter_index)
+        if key not in self.sharded_kernels_:
+            sharded = _shard_kernel(kernel, iter_index, axes, self.num_shards_)
+            self.sharded_kernels_[key] = self.builder_.add_func(sharded, gvar.name_hint + "_shard")
+        sharded_gvar = self.sharded_kernels_[key]
+        inputs = [self._distribute(arg, d, a) for arg, d, a in zip(args, dists, axes[:-1])]
+        dtype = call.checked_type.dtype
+        outs = []
+        for i in range(self.num_shards_):
+            shard_args = [self.builder_.emit(TupleGetItem(value, i)) for value in inputs]
+            outs.append(
+                self.builder_.emit(
+                    call_tir(sharded_gvar, shard_args, out_shape, dtype, runtime_device_index=i)
+                )
+            )
+        full_shape = [int(v) for v in shape.values]
+        return _Dist(kind, out_axis, self.builder_.emit(Tuple(outs)), full_shape)
+
+
+def ShardTensorParallel(num_shards: int) -> tvm.ir.transform.Pass:
+    """Shard the call_tirs of the functions annotated with "relax.sharding" among the first
+    num_shards devices of the VM, for the models too large for one device. See
+    TensorParallelSharder for how the values are sharded.
+
+    The annotation maps the names of the parameters to shard to their split axes, e.g. the
+    column-split weights of a matmul. The VM runs the shards of a call on their devices, and the
+    values move between the devices through the vm.builtin.ccl builtins, backed by NCCL when TVM
+    is built with USE_NCCL and all the devices are CUDA GPUs. The VM must be created on at least
+    num_shards devices, the host aside. It is applied before the module is built by vm.build.
+
+    Parameters
+    ----------
+    num_shards : int
+        The number of devices to shard the calls among.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+
+    def transform_module(mod: IRModule, ctx: tvm.transform.PassContext) -> IRModule:
+        return TensorParallelSharder(mod, num_shards).transform()
+
+    return module_pass(transform_module, opt_level=0, name="ShardTensorParallel")
+
+
+def shard_tensor(
+    data: Union[np.ndarray, tvm.nd.NDArray], axis: int, devices: List[tvm.runtime.Device]
+) -> tvm.runtime.container.ADT:
+    """Split a tensor along the axis into the shards of a parameter sharded by
+    ShardTensorParallel, the i-th shard is placed on the i-th device."""
+    if isinstance(data, tvm.nd.NDArray):
+        data = data.numpy()
+    shards = np.split(data, len(devices), axis=axis)
+    return tvm.runtime.container.tuple_object(
+        [tvm.nd.array(np.ascontiguousarray(shard), dev) for shard, dev in zip(shards, devices)]
+    )
@@ -103,6 +103,63 @@ def CallTIRRewrite() -> tvm.ir.transform.Pass:
     return _ffi_api.CallTIRRewrite()
 
 
+def InplaceCallTIR() -> tvm.ir.transform.Pass:
+    """Mark the elementwise call_tir whose input has the shape and dtype of the output and is
+    dead after the call as computed in place on that input. CallTIRRewrite then reuses the
+    input tensor instead of allocating the output.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.InplaceCallTIR()
+
+
+def HoistWorkspace() -> tvm.ir.transform.Pass:
+    """Hoist the global scratch buffers allocated by the root block of the kernels to trailing
+    workspace parameters. Every call of such a kernel passes a tensor allocated by
+    relax.builtin.alloc_tensor for each workspace, so that StaticPlanBlockMemory reuses the
+    workspace storage across kernels instead of allocating it in every launch. The pass runs
+    after CallTIRRewrite, and the kernels referred to otherwise than by a call are left intact.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.HoistWorkspace()
+
+
+def StaticPlanBlockMemory() -> tvm.ir.transform.Pass:
+    """Plan the storage of static-shape tensors allocated by relax.builtin.alloc_tensor.
+    Tensors whose lifetimes never overlap share one relax.vm.builtin.alloc_storage per device
+    at different offsets. Tensors that may escape the function are left for VMMemoryLower.
+
+    The offsets are assigned first-fit in binding order by default. The pass config
+    "relax.StaticPlanBlockMemory.algorithm" selects one of the USMP algorithms ("greedy_by_size",
+    "greedy_by_conflicts", "hill_climb") instead, which plan the tensors from their liveness
+    conflicts. With "relax.StaticPlanBlockMemory.pool_size_bytes", the first pool of each device
+    is bounded to the given size and the tensors that do not fit go to a second pool.
+    The algorithm "token_reuse" is the storage token reuse of the graph memory planning of
+    Relay: every tensor gets a storage of its own, which the later tensors of the same device
+    and of a size within a factor of 16 reuse once it dies, so models moved from Relay keep
+    their memory footprint.
+
+    With "relax.StaticPlanBlockMemory.vtcm_capacity_bytes", the tensors with the shortest live
+    intervals, such as the intermediates passed between consecutive fused kernels, are placed
+    in a "global.vtcm" storage per device within the capacity, so that the kernels on Hexagon
+    exchange them through the VTCM instead of the DDR.
+
+    Tensors with symbolic shapes are planned at their worst-case size when the function has the
+    attribute "tir_var_upper_bound" mapping every symbolic variable of the shape to its upper
+    bound, e.g. ``func.with_attr("tir_var_upper_bound", {"seq_len": 2048})``.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.StaticPlanBlockMemory()
+
+
 def VMMemoryLower() -> tvm.ir.transform.Pass:
     """Perform memory lowering. Lowers the relax.builtin.alloc_tensor intrinsic to VM intrinsics.
 
@@ -151,7 +208,9 @@ def MetaScheduleApplyHistoryBest(
     database: PyDatabase,
     target: Target,
 ) -> tvm.ir.transform.Pass:
-    """Apply the best schedule from tuning database.
+    """Apply the best schedule from tuning database. The kernels which have no record in the
+    database are looked up in the Relax tuning database of the pass context, if any, and
+    replaced by the replay of their best tuning record.
 
     Parameters
     ----------
@@ -166,6 +225,40 @@ def MetaScheduleApplyHistoryBest(
     return _ffi_api.MetaScheduleApplyHistoryBest(database, target)
 
 
+def AutoSchedulerApplyHistoryBest(
+    records: Union[str, List[str], "tvm.auto_scheduler.ApplyHistoryBest"],
+    target: Target,
+) -> tvm.ir.transform.Pass:
+    """Apply the best auto_scheduler schedule from tuning logs. The kernels whose TE compute is
+    recovered are looked up by their workload key, so the logs of the same workloads tuned with
+    relay apply, and lowered with the best schedule found. The other kernels are kept.
+
+    Parameters
+    ----------
+    records : Union[str, List[str], tvm.auto_scheduler.ApplyHistoryBest]
+        The tuning log files, or the ApplyHistoryBest context loaded from them.
+    target: target info
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+
+    """
+    # pylint: disable=import-outside-toplevel
+    from tvm import auto_scheduler
+    from tvm.auto_scheduler import relax_integration
+
+    if not isinstance(records, auto_scheduler.DispatchContext):
+        records = auto_scheduler.ApplyHistoryBest(records)
+
+    def transform_module(mod, _ctx):
+        return relax_integration.apply_history_best(mod, target, records)
+
+    return tvm.ir.transform.module_pass(
+        transform_module, opt_level=0, name="AutoSchedulerApplyHistoryBest"
+    )
+
+
 def BindParams(
     func_name: str,
     params: Dict[str, Union[tvm.runtime.NDArray, np.ndarray]],
@@ -197,6 +290,258 @@ def BindParams(
     return _ffi_api.BindParams(func_name, tvm_params)
 
 
+def BindParamsFromFile(func_name: str, path: str) -> tvm.ir.transform.Pass:
+    """Bind params of function of the module to constant tensors stored in a file, without
+    reading the whole file into memory.
+
+    The file holds the dict from param name to tensor, saved with `tvm.ir.save_binary_file`.
+    It is memory mapped, so that the constants refer to the mapping and a tensor is only read
+    from disk once its data is used, e.g. by FoldConstant or when the executable is saved.
+
+    Parameters
+    ----------
+
+    func_name: str
+        The function name to be bound
+
+    path : str
+        The path of the param file.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.BindParamsFromFile(func_name, path)
+
+
+def BucketSymbolicDim(func_name: str, dim_name: str, buckets: List[int]) -> tvm.ir.transform.Pass:
+    """Specialize a function for the buckets of a symbolic dimension.
+
+    The function is replaced by a dispatcher that pads the inputs to the smallest bucket the
+    dimension fits in, calls the static-shape variant of that bucket and slices the outputs back.
+    Inputs beyond the largest bucket call the original function, kept as `<func_name>_dynamic`.
+    The padded entries are zeros, so each entry of the outputs along the dimension must be
+    computed independently of the others, e.g. as for a batch dimension.
+
+    Parameters
+    ----------
+    func_name: str
+        The name of the function to specialize.
+
+    dim_name: str
+        The name of the symbolic dimension in the parameter shapes.
+
+    buckets: List[int]
+        The extents the dimension is specialized to.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.BucketSymbolicDim(func_name, dim_name, buckets)
+
+
+def ToMixedPrecision(
+    dtype: str = "float16", policy: Optional[Dict[str, str]] = None
+) -> tvm.ir.transform.Pass:
+    """Run the compute-bound kernels, e.g. dense, matmul or conv, on float16 or bfloat16
+    inputs. The kernels cast the loaded elements back to float32, so they accumulate and write
+    float32 as before. The constant inputs are converted ahead of time, which halves the size of
+    the weights, and the other inputs are cast by an emitted kernel.
+
+    Parameters
+    ----------
+    dtype: str
+        The low precision type, "float16" or "bfloat16".
+
+    policy: Optional[Dict[str, str]]
+        The map from kernel names to "always" or "never" converting them. A kernel not in the
+        map is converted iff its op pattern is kOutEWiseFusable, so the numerically sensitive
+        kernels like reductions and softmax stay in float32.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.ToMixedPrecision(dtype, policy or {})
+
+
+def QuantizeWeights(
+    bits: int = 8, group_size: int = 0, fcalibrate: Optional[Callable] = None
+) -> tvm.ir.transform.Pass:
+    """Store the constant 2-D float32 weights of the compute-bound kernels, e.g. dense or
+    matmul, as int8 values, or int4 values packed in pairs along the last axis, and the float32
+    scales of their output channels. The calls use a copy of the kernel which dequantizes the
+    elements of the weight as it loads them, so only the quantized weight is read from memory.
+
+    Parameters
+    ----------
+    bits: int
+        The number of bits of the quantized values, 8 or 4.
+
+    group_size: int
+        The number of rows of the reduction axis sharing a scale in a channel, 0 for one scale
+        per channel.
+
+    fcalibrate: Optional[Callable[[str, tvm.nd.NDArray, int], int]]
+        The function choosing the group size of each weight instead. It is called with the
+        kernel name, the weight and its reduction axis and returns the group size, or -1 to keep
+        the weight in float32.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.QuantizeWeights(bits, group_size, fcalibrate)
+
+
+def SplitLayoutRewritePreproc() -> tvm.ir.transform.Pass:
+    """Move the weight layout rewrite blocks of the kernels scheduled with RewriteLayout into
+    kernels of their own, called before the kernels on their weights. FoldConstant then rewrites
+    the layout of the constant weights at build time, so that the inference never repacks them.
+    MetaScheduleApplyHistoryBest runs this pass on the kernels it schedules.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.SplitLayoutRewritePreproc()
+
+
+def HorizontalFusion() -> tvm.ir.transform.Pass:
+    """Fuse the independent call_tirs of the same kernel in a dataflow block, e.g. the
+    projections of the heads of an attention or parallel branches, into one call_tir of a kernel
+    whose outer loop runs one of the calls per iteration. Binding that loop to a thread axis
+    launches the calls at once.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.HorizontalFusion()
+
+
+def Rematerialize(memory_budget: int) -> tvm.ir.transform.Pass:
+    """Bound the activation memory of every dataflow block by recomputing intermediate tensors
+    instead of keeping them live. While the tensors of a block live at a binding exceed the
+    budget, a tensor live across that binding and computed by an elementwise, broadcast or
+    injective kernel, per the op pattern of the kernel, is recomputed right before its next use.
+    Cheaper patterns are chosen first, then larger tensors.
+
+    Parameters
+    ----------
+    memory_budget : int
+        The maximal number of bytes of the tensors of static shape defined in a block which are
+        live at once.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+
+    Note
+    ----
+    The recomputed bindings whose tensor is no longer used are left to DeadCodeElimination.
+    """
+    return _ffi_api.Rematerialize(memory_budget)
+
+
+def FuseOpsByPattern(
+    patterns: List[tuple], codegen: Optional[str] = None
+) -> tvm.ir.transform.Pass:
+    """Group the bindings of every dataflow block matched by a pattern into a function with the
+    attribute Composite=<pattern name>, and replace them with a call to it. The patterns are
+    tried in order, against the bindings from the last one up, so earlier and longer patterns
+    win. A match is only grouped if its intermediate results are used within the match only.
+
+    Parameters
+    ----------
+    patterns : List[Tuple[str, tvm.relax.dpl.DFPattern]]
+        The names of the patterns, e.g. "relax.conv2d_relu", and the patterns.
+
+    codegen : Optional[str]
+        When given, each composite function is inlined into a function with the attributes
+        Codegen=<codegen> and a global symbol, offloaded to the codegen by RunCodegen.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    pattern_names = [name for name, _ in patterns]
+    dfpatterns = [pattern for _, pattern in patterns]
+    return _ffi_api.FuseOpsByPattern(pattern_names, dfpatterns, codegen)
+
+
+def CollagePartition(
+    backends: Dict[str, List[tuple]], estimate_latency: Callable[[tvm.IRModule], float]
+) -> tvm.ir.transform.Pass:
+    """Offload the bindings of every dataflow block matched by the patterns of the codegens, or
+    keep them with TVM, so that the estimated latency of the block is minimal, after the Collage
+    search of Relay. Every match and every binding alone is measured running with its codegen and
+    with TVM, and the cheapest covering of the block by non-overlapping candidates is offloaded
+    like FuseOpsByPattern does, the other bindings are left to FuseOps.
+
+    Parameters
+    ----------
+    backends : Dict[str, List[Tuple[str, tvm.relax.dpl.DFPattern]]]
+        The names and patterns of the composite functions offloaded to each codegen, e.g.
+        {"cublas": relax.backend.contrib.cublas.get_patterns()}.
+
+    estimate_latency : Callable[[tvm.IRModule], float]
+        The latency in seconds of the main function of a module holding the bindings of one
+        candidate, calling a function of attribute Codegen=<codegen> when the candidate is
+        offloaded, e.g. measure_latency(target, device). The estimates are cached by the
+        structure of the modules.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    pattern_names, dfpatterns, codegens = [], [], []
+    for codegen, patterns in backends.items():
+        for name, pattern in patterns:
+            pattern_names.append(name)
+            dfpatterns.append(pattern)
+            codegens.append(codegen)
+    return _ffi_api.CollagePartition(pattern_names, dfpatterns, codegens, estimate_latency)
+
+
+def DeadCodeElimination() -> tvm.ir.transform.Pass:
+    """Remove the bindings of dataflow blocks whose results contribute to no output of the
+    block. Dataflow blocks are side-effect free, so the removal keeps the semantics.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.DeadCodeElimination()
+
+
+def EliminateCommonSubexpr() -> tvm.ir.transform.Pass:
+    """Reuse the var of an earlier binding of a dataflow block for the later bindings of a
+    structurally equal value, e.g. duplicated shape computations or call_tirs on the same
+    inputs. Run DeadCodeElimination afterwards to remove the computations that became unused.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.EliminateCommonSubexpr()
+
+
+def SimplifyAlgebra() -> tvm.ir.transform.Pass:
+    """Remove the arithmetic with identity constants, matched by dataflow patterns seeing through
+    the bindings of the constants: x * 1, 1 * x, x + 0 and 0 + x become x unless the constant
+    broadcasts x, and ewise_fma becomes an add with a constant 1 factor or a multiply with a
+    constant 0 addend. Run DeadCodeElimination afterwards to remove the constants that became
+    unused.
+
+    Returns
+    -------
+    ret: tvm.ir.transform.Pass
+    """
+    return _ffi_api.SimplifyAlgebra()
+
+
 def RemoveUnusedFunctions(entry_functions: Optional[List[str]] = None) -> tvm.ir.transform.Pass:
     """Remove unused relax/prim functions without external linkage in a IRModule.
 
@@ -240,6 +585,11 @@ def RunCodegen(
 def FoldConstant() -> tvm.ir.transform.Pass:
     """Fold constant expressions.
 
+    The folded tensors are cached on disk when the pass config
+    ``relax.FoldConstant.cache_dir`` names a directory. The cache is keyed by the structural
+    hash of the PrimFunc and a hash of the contents of its inputs, so recompiling a model with
+    the same parameters skips the evaluation.
+
     Returns
     -------
     ret: tvm.ir.transform.Pass
@@ -265,6 +615,11 @@ def FuseOps(fuse_opt_level=-1) -> tvm.ir.transform.Pass:
 
     A follow-up pass named "FuseTIR" will generate a TIR PrimFunc for each grouped function.
 
+    Unless the pass config "relax.FuseOps.fuse_reduction_chains" is False, a reduction is fused
+    with the elementwise and broadcast ops and the further reductions which consume it, so that a
+    chain such as a softmax becomes one group, and an injective op such as a gather is fused into
+    the reduction which consumes it, e.g. the lookup of an embedding bag into its pooling.
+
     Parameters
     ----------
     fuse_opt_level : int
@@ -282,6 +637,10 @@ def FuseOps(fuse_opt_level=-1) -> tvm.ir.transform.Pass:
 def FuseTIR() -> tvm.ir.transform.Pass:
     """Fuse primitive relax function into a larger TIR function if possible
 
+    Unless the pass config "relax.FuseTIR.localize_reduction_chains" is False, the blocks of a
+    fused function with several reductions are computed at the outer loop of its last block, so
+    that the intermediate buffers hold a single row.
+
     Returns
     -------
     ret : tvm.transform.Pass
@@ -333,6 +692,10 @@ def function_pass(
     is provided. Otherwise, it returns the created function pass using the
     given optimization function.
 
+    The pass runs over the functions of the module one at a time, or in parallel when the
+    "relax.FunctionPass.parallel" config of the PassContext is set, in which case pass_func
+    must not depend on a shared state nor on PassContext.current().
+
     Parameters
     ----------
     pass_func : Optional[Callable[(Function, Module, PassContext) -> Function]]
@@ -20,3 +20,4 @@
 from .primitives import *
 from .default_functions import *
 from .database import *
+from .fusion import *
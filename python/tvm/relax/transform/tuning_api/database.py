@@ -271,3 +271,35 @@ class JSONDatabase(Database):
             path_measurement_record,
             allow_missing,
         )
+
+
+@register_object("relax.tuning_api.IndexedDatabase")
+class IndexedDatabase(Database):
+    """The class of indexed database. The records are stored in a compact binary format, in an
+    append-only log with a persistent hash index on the workload and target, so that opening the
+    database and looking records up do not decode every record. The database is safe to share
+    between concurrent tuners on one machine.
+
+    Parameters
+    ----------
+    path : str
+        The directory of the database.
+    """
+
+    path: str
+
+    def __init__(self, path: str, allow_missing: bool = True) -> None:
+        """Constructor.
+
+        Parameters
+        ----------
+        path : str
+            The directory of the database.
+        allow_missing : bool
+            Whether to create the database when the given path is not found.
+        """
+        self.__init_handle_by_constructor__(
+            _ffi_api.DatabaseIndexedDatabase,  # type: ignore # pylint: disable=no-member
+            path,
+            allow_missing,
+        )
@@ -146,9 +146,13 @@ def default_evaluate(
     params: Optional[Dict[str, np.ndarray]] = None,
     builder: Optional[meta_schedule.builder.Builder] = None,
     runner: Optional[meta_schedule.runner.Runner] = None,
+    max_workers: Optional[int] = None,
 ) -> None:
     """
     Default function to evaluate a set of candidate traces by using MetaSchedule builder/runner.
+    The candidates are built as a batch, concurrently in the process pool of the builder, and
+    every build is submitted to the runner before any result is awaited, so that a runner with
+    several devices, e.g. an RPC runner, measures them concurrently as well.
 
     Parameters
     ----------
@@ -162,6 +166,8 @@ def default_evaluate(
         builder function. If not provided, default local builder will be used.
     runner: Optional[meta_schedule.runner.Runner]
         runner function. If not provided, default local runner will be used.
+    max_workers: Optional[int]
+        The number of processes of the default local builder. Defaults to the number of CPUs.
     """
 
     ctx = PassContext.current()
@@ -180,7 +186,7 @@ def default_evaluate(
             relax_exec = tvm.relax.vm.build(mod, target)
             return relax_exec.mod
 
-        builder = LocalBuilder(f_build=relax_build)
+        builder = LocalBuilder(f_build=relax_build, max_workers=max_workers)
 
     # Setup default local runner if not provided
     if runner is None:
@@ -218,54 +224,68 @@ def default_evaluate(
 
     # Keep track of number of evaluations (mostly for the debugging purpose)
     num_evals = 0
-    # Evaluation
+    # The measured costs of the candidates, and the candidates to measure, one per workload.
+    candidate_secs = []
+    to_measure = {}
     for candidate in candidates:
         # If this candidate is already evaluated, skip the measurement
         if candidate.perf != -1:
             continue
 
-        # Evaluate candidates
         num_evals += 1
         mod = candidate.out_mod
         workload = database.commit_workload(mod)
 
         # If this workload and target pair has measured before, fetch its data.
         if database.has_measurement_record(workload, target):
-            run_secs = database.get_measurement_record(workload, target)
-        # Otherwise, measure it.
+            candidate_secs.append((candidate, database.get_measurement_record(workload, target)))
         else:
-            # Build candidate
-            (builder_result,) = builder.build([BuilderInput(mod, target, params)])
-
-            if builder_result.artifact_path is None:
-                # Build error
-                # Assign the worst performance and move on to the next candidate.
-                logger.warning(builder_result.error_msg)
+            to_measure.setdefault(tvm.ir.structural_hash(mod), []).append((candidate, workload))
+
+    # Build all the new workloads at once, so that the builder compiles them concurrently.
+    measured = list(to_measure.values())
+    builder_results = builder.build(
+        [BuilderInput(group[0][0].out_mod, target, params) for group in measured]
+    )
+
+    # Submit every build to the runner before waiting for any result.
+    runner_futures = []
+    for group, builder_result in zip(measured, builder_results):
+        if builder_result.artifact_path is None:
+            runner_futures.append(None)
+            continue
+        mod = group[0][0].out_mod
+        args_info = [
+            TensorInfo(shape=[int(i) for i in p.shape], dtype=p.checked_type.dtype)
+            for p in mod["main"].params
+        ]  # convert list[Var] to list[TensorInfo]
+        runner_input = RunnerInput(builder_result.artifact_path, target_str, args_info=args_info)
+        (runner_future,) = runner.run([runner_input])
+        runner_futures.append(runner_future)
+
+    for group, builder_result, runner_future in zip(measured, builder_results, runner_futures):
+        if runner_future is None:
+            # Build error
+            # Assign the worst performance and move on to the next candidate.
+            logger.warning(builder_result.error_msg)
+            run_secs = [1e100]
+        else:
+            runner_result = runner_future.result()
+            run_secs = runner_result.run_secs
+            # Runtime error
+            # Assign the worst performance and move on to the next candidate.
+            if runner_result.error_msg is not None:
+                logger.warning(runner_result.error_msg)
                 run_secs = [1e100]
-            else:
-                # If build passes, set up runner input and measure the performance.
-                args_info = [
-                    TensorInfo(shape=[int(i) for i in p.shape], dtype=p.checked_type.dtype)
-                    for p in mod["main"].params
-                ]  # convert list[Var] to list[TensorInfo]
-                runner_input = RunnerInput(
-                    builder_result.artifact_path, target_str, args_info=args_info
-                )
-                (runner_future,) = runner.run([runner_input])
-                runner_result = runner_future.result()
-
-                run_secs = runner_result.run_secs
-                # Runtime error
-                # Assign the worst performance and move on to the next candidate.
-                if runner_result.error_msg is not None:
-                    logger.warning(runner_result.error_msg)
-                    run_secs = [1e100]
-
-                database.commit_measurement_record(workload, target, run_secs)
 
+            database.commit_measurement_record(group[0][1], target, run_secs)
             # Clean up the artifact
             f_clean_build(builder_result.artifact_path)
 
+        for candidate, _ in group:
+            candidate_secs.append((candidate, run_secs))
+
+    for candidate, run_secs in candidate_secs:
         # For valid measurments, compute the average and update the trace performance.
         perfs = []
         for result in run_secs:
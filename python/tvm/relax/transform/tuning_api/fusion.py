@@ -0,0 +1,227 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+"""Relax Tuning Pass API for the fusion decisions, chosen by the tuned latency of the kernels"""
+from typing import Callable, Dict, List, Optional, Union
+import logging
+
+import numpy as np
+
+import tvm
+from tvm.ir.module import IRModule
+from tvm.ir.transform import PassContext, Pass
+from tvm.target import Target
+from tvm import meta_schedule
+from tvm.meta_schedule import default_config
+from tvm.meta_schedule.relax_integration import extract_task_from_relax
+from tvm.meta_schedule.tune import TuneConfig, tune_extracted_tasks
+from tvm.relax.cost_model import KernelCostModel
+from .primitives import Choice, Knob, Trace
+from .default_functions import default_generate_candidate, select_best_candidate
+
+logger = logging.getLogger("TuningAPI")  # pylint: disable=invalid-name
+
+# The fusion settings of the default knob: the opt level, the max depth of a fused group and
+# whether to fuse the chains of reductions, see FuseOps.
+DEFAULT_FUSION_CHOICES = {
+    "no_fusion": (0, 256, False),
+    "fuse_depth_4": (1, 4, False),
+    "fuse_no_reduction_chains": (1, 256, False),
+    "fuse_all": (1, 256, True),
+}
+
+
+def fusion_knob(choices: Optional[Dict[str, tuple]] = None) -> Knob:
+    """Create the knob of the fusion decisions. Every choice runs FuseOps with its settings, then
+    FuseTIR, so that a candidate has the fused kernels to be tuned.
+
+    Parameters
+    ----------
+    choices : Optional[Dict[str, tuple]]
+        The map from the decision names to the settings of FuseOps, tuples of opt_level,
+        max_fuse_depth and fuse_reduction_chains. Defaults to DEFAULT_FUSION_CHOICES.
+
+    Returns
+    -------
+    knob : Knob
+        The knob of the fusion decisions.
+    """
+    if choices is None:
+        choices = DEFAULT_FUSION_CHOICES
+    return Knob(
+        "FuseOps",
+        {
+            name: Choice("relax.tuning_api.fuse_ops", [int(level), int(depth), bool(chains)])
+            for name, (level, depth, chains) in choices.items()
+        },
+    )
+
+
+def tuned_kernel_latency(
+    mod: IRModule, target: Target, database: meta_schedule.database.Database
+) -> float:
+    """The latency of a module estimated by the tuning records of its kernels: the sum of the
+    best measured latency of every kernel, weighted by its number of calls. A kernel without a
+    valid record is estimated by the KernelCostModel of the pass context, if any.
+
+    Parameters
+    ----------
+    mod : IRModule
+        The module, whose functions call their kernels with call_tir.
+    target : Target
+        The target of the tuning records.
+    database : meta_schedule.database.Database
+        The database of the tuning records.
+
+    Returns
+    -------
+    latency : float
+        The estimated latency in seconds, 1e100 if a kernel has neither a valid tuning record
+        nor an estimation.
+    """
+    cost_model = KernelCostModel.current()
+    latency = 0.0
+    for task in extract_task_from_relax(mod, target):
+        workload_mod = default_config.mod(task.dispatched[0])
+        records = database.has_workload(workload_mod) and database.get_top_k(
+            database.commit_workload(workload_mod), 1
+        )
+        if records and records[0].run_secs:
+            run_secs = [float(sec) for sec in records[0].run_secs]
+            latency += task.weight * float(np.mean(run_secs))
+            continue
+        secs = cost_model.estimate(workload_mod["main"]) if cost_model is not None else None
+        if secs is None:
+            logger.warning("No valid tuning record of the kernel %s", task.task_name)
+            return 1e100
+        latency += task.weight * secs
+    return latency
+
+
+def evaluate_with_tuned_kernels(
+    candidates: List[Trace],
+    target: Union[str, Target],
+    config: TuneConfig,
+    work_dir: str,
+    database: meta_schedule.database.Database,
+    **tune_kwargs,
+) -> None:
+    """Evaluate the candidates by the latency of their kernels tuned with MetaSchedule.
+
+    The kernels of all the candidates are tuned into the database, the ones with a tuning record
+    already are not tuned again, so a kernel shared by several candidates is tuned once. The
+    performance of a candidate is then the latency estimated by tuned_kernel_latency.
+
+    Parameters
+    ----------
+    candidates : List[Trace]
+        The traces to evaluate.
+    target : Union[str, Target]
+        The target to tune for.
+    config : TuneConfig
+        The search strategy config of every round of tuning.
+    work_dir : str
+        The working directory of MetaSchedule.
+    database : meta_schedule.database.Database
+        The database of the tuning records, shared by the candidates and the later builds.
+    tune_kwargs : Dict
+        The other arguments of tune_extracted_tasks, e.g. the builder and the runner.
+    """
+    target = default_config.target(target)
+    num_evals = 0
+    for candidate in candidates:
+        # If this candidate is already evaluated, skip the tuning.
+        if candidate.perf != -1:
+            continue
+        num_evals += 1
+        tasks = extract_task_from_relax(candidate.out_mod, target)
+        tune_extracted_tasks(
+            tasks, config, work_dir, database=database, incremental=True, **tune_kwargs
+        )
+        candidate.set_perf(tuned_kernel_latency(candidate.out_mod, target, database))
+    PassContext.current().inc_num_evals(num_evals)
+
+
+@tvm.ir.transform.module_pass(opt_level=0, traceable=True)
+class FuseOpsTuningPass:
+    """A tuning pass which chooses how to fuse the operators, by the latency of the fused
+    kernels once they are tuned with MetaSchedule, rather than greedily as FuseOps does.
+
+    Every decision of the knob is a candidate, fused with FuseOps then FuseTIR. The kernels of the
+    candidates are tuned into the database, shared across the candidates, and the candidate of the
+    lowest estimated latency is kept. The chosen module is to be built with the records of the
+    database, e.g. with MetaScheduleApplyHistoryBest.
+
+    The pass runs within a pass context with a trace, as the other tuning passes do.
+
+    Parameters
+    ----------
+    target : Union[str, Target]
+        The target to tune for.
+    config : TuneConfig
+        The search strategy config of the tuning of each candidate.
+    work_dir : str
+        The working directory of MetaSchedule.
+    database : Optional[meta_schedule.database.Database]
+        The database of the tuning records, created in the work_dir if not given.
+    knob : Optional[Knob]
+        The fusion decisions to choose from. Defaults to fusion_knob().
+    f_generate_candidate : Optional[Callable]
+        The function generating the candidates, default_generate_candidate if not given.
+    f_evaluate : Optional[Callable]
+        The function evaluating the candidates, called with the candidates and the target.
+        Defaults to evaluate_with_tuned_kernels with the database.
+    eval_passes : Optional[List[Pass]]
+        The passes to consider to evaluate each candidate, for joint-optimization.
+    tune_kwargs : Dict
+        The other arguments of tune_extracted_tasks, e.g. the builder and the runner.
+    """
+
+    def __init__(
+        self,
+        target: Union[str, Target],
+        config: TuneConfig,
+        work_dir: str,
+        database: Optional[meta_schedule.database.Database] = None,
+        knob: Optional[Knob] = None,
+        f_generate_candidate: Optional[Callable] = None,
+        f_evaluate: Optional[Callable] = None,
+        eval_passes: Optional[List[Pass]] = None,
+        **tune_kwargs,
+    ):
+        self.target = default_config.target(target)
+        self.database = default_config.database(database, work_dir)
+        self.knob = knob if knob is not None else fusion_knob()
+        self.f_generate_candidate = (
+            f_generate_candidate if f_generate_candidate else default_generate_candidate
+        )
+        if f_evaluate is None:
+
+            def f_evaluate(candidates, target):
+                evaluate_with_tuned_kernels(
+                    candidates, target, config, work_dir, self.database, **tune_kwargs
+                )
+
+        self.f_evaluate = f_evaluate
+        self.eval_passes = eval_passes
+
+    def transform_module(self, mod: IRModule, ctx: PassContext) -> IRModule:
+        trace = ctx.pop_trace()
+        candidates = self.f_generate_candidate([self.knob], trace, self.eval_passes)
+        self.f_evaluate(candidates, self.target)
+        best_trace = select_best_candidate(candidates)
+        ctx.push_trace(best_trace)
+        return best_trace.out_mod
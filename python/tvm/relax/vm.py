@@ -16,17 +16,16 @@
 # under the License.
 # pylint: disable=invalid-name, redefined-builtin, no-else-return
 """The Relax virtual machine"""
-from typing import List, Optional, Union, Dict, Tuple
+import ctypes
+import json
+from typing import Any, Callable, List, Optional, Tuple, Union, Dict
 from tvm._ffi import base as _base
 import numpy as np
 
 import tvm
-from tvm import relax
-from tvm.ir.module import IRModule
 from tvm.relay import Any
 from tvm.runtime import Device, Module, PackedFunc, container
 from tvm.runtime.object import Object
-from tvm.tir.function import PrimFunc
 from . import _ffi_api
 from ..rpc.base import RPC_SESS_MASK
 
@@ -37,13 +36,30 @@ class Executable(object):
     def __init__(self, mod: Module):
         self.mod = mod
         self._stats = self.mod["stats"]
+        self._stats_json = self.mod["stats_json"]
         self._as_text = self.mod["as_text"]
         self._as_python = self.mod["as_python"]
+        self._get_source_location = self.mod["get_source_location"]
 
     def stats(self) -> str:
         """print the detailed statistics of the executable."""
         return self._stats()
 
+    def stats_dict(self) -> Dict[str, Union[int, Dict[str, int]]]:
+        """Get the statistics of the executable.
+
+        Returns
+        -------
+        stats : Dict[str, Union[int, Dict[str, int]]]
+            The number of instructions ("num_instructions") and the register file size
+            ("register_file_size") of each function, the bytes of NDArray constants on each
+            device ("constant_bytes"), the number of unique packed functions
+            ("num_packed_funcs"), the largest storage statically allocated by a function
+            ("peak_storage_bytes") and the number of storages sized at runtime
+            ("num_dynamic_storages").
+        """
+        return json.loads(self._stats_json())
+
     def as_text(self) -> str:
         """print the instructions as text format."""
         return self._as_text()
@@ -52,18 +68,104 @@ class Executable(object):
         """print the instructions as python program."""
         return self._as_python()
 
+    def source_location(self, pc: int) -> str:
+        """Get the source location of an instruction, e.g. for profiling reports.
+
+        Parameters
+        ----------
+        pc : int
+            The index of the instruction.
+
+        Returns
+        -------
+        location : str
+            The source location as "name:line:column", or an empty string when it is unknown.
+            The debug section of a loaded executable is only parsed on the first query.
+        """
+        return self._get_source_location(pc)
+
+    def save_bundle(self, path: str, system_lib: bool = False) -> None:
+        """Save the executable and its kernel library to a single file.
+
+        Parameters
+        ----------
+        path : str
+            The path of the bundle file. An existing file is replaced atomically.
+
+        system_lib : bool
+            Whether the kernels are resolved from the system library of the loading process
+            instead of being embedded in the file.
+        """
+        if system_lib:
+            _ffi_api.ExecutableSaveBundle(self.mod, path, "system_lib")
+            return
+        if not self.mod.imported_modules:
+            _ffi_api.ExecutableSaveBundle(self.mod, path, "")
+            return
+        from tvm.contrib import utils  # pylint: disable=import-outside-toplevel
+
+        temp_dir = utils.tempdir()
+        lib_path = temp_dir.relpath("lib.so")
+        self.mod.imported_modules[0].export_library(lib_path)
+        _ffi_api.ExecutableSaveBundle(self.mod, path, lib_path)
+
+    def export_crt(self, path: Optional[str] = None) -> bytearray:
+        """Export the executable for the Relax VM of the CRT.
+
+        The storages are planned at export, so the executable must have static shapes, and
+        only calls kernels, the Relax functions and the allocation and control flow builtins.
+        The kernels are resolved from the module given to the CRT VM, e.g. the system library.
+
+        Parameters
+        ----------
+        path : Optional[str]
+            The path of the file to write the executable to, e.g. to be placed in flash.
+
+        Returns
+        -------
+        data : bytearray
+            The executable in the format of include/tvm/runtime/crt/relax_vm_format.h.
+        """
+        data = _ffi_api.ExecutableExportCRT(self.mod)
+        if path is not None:
+            with open(path, "wb") as f:
+                f.write(data)
+        return data
+
+
+def load_bundle(path: str) -> Executable:
+    """Load an executable saved by Executable.save_bundle.
+
+    Parameters
+    ----------
+    path : str
+        The path of the bundle file.
+
+    Returns
+    -------
+    exec : Executable
+        The executable, which imports its kernel library.
+    """
+    return Executable(_ffi_api.ExecutableLoadBundle(path))
+
 
 class VirtualMachine(object):
     """Relax VM runtime."""
 
     NAIVE_ALLOCATOR = 1
     POOLED_ALLOCATOR = 2
+    SIZE_CLASS_ALLOCATOR = 3
+    STREAM_ORDERED_ALLOCATOR = 4
 
     def __init__(
         self,
         exec: Union[Executable, Module],
         device: Union[Device, List[Device]],
         memory_cfg: Optional[Union[str, Dict[Device, str]]] = None,
+        profile: bool = False,
+        ccl_config: Optional[Dict[str, Any]] = None,
+        memory_quota: Optional[Dict[str, Any]] = None,
+        async_constant_upload: bool = False,
     ) -> None:
         """
         Construct a VirtualMachine wrapper object.
@@ -78,24 +180,379 @@ class VirtualMachine(object):
 
         memory_cfg : Optional[Union[str, Dict[Device, str]]]
             Config the type of memory allocator. The allocator type can be ["naive",
-            "pooled"]. If memory_cfg is None, all devices will use pooled allocator
-            by default. If memory_cfg is string, all devices will use the specified
-            allocator type. If memory_cfg is a dict, each device uses the allocator
-            type specified in the dict, or pooled allocator if not specified in the
-            dict.
-        """
-        self.module = (
-            exec.mod["vm_load_executable"]()
-            if isinstance(exec, Executable)
-            else exec["vm_load_executable"]()
-        )
+            "pooled", "size_class", "stream_ordered"], the last one for CUDA devices only, which
+            allocates and frees in the order of the compute stream with cudaMallocAsync. If
+            memory_cfg is None, all devices will use pooled allocator by default. If memory_cfg
+            is string, all devices will use the specified allocator type. If memory_cfg is a
+            dict, each device uses the allocator type specified in the dict, or pooled allocator
+            if not specified in the dict.
+
+        profile : bool
+            Whether to create a profiling VM, which supports the profile method.
+
+        ccl_config : Optional[Dict[str, Any]]
+            The communicator of this process in a distributed run, with the "rank" and the
+            "world_size" of the process, the "unique_id" shared by the processes of the run, see
+            ccl_unique_id, and optionally the "backend", "nccl" by default. The collective
+            communication builtins then work across the processes. The communicator is created
+            on the first device.
+
+        memory_quota : Optional[Dict[str, Any]]
+            The memory of the "tenant" of the VM, whose VMs allocate from allocators of their
+            own, apart from the other tenants, which hold at most "quota_bytes" on each device.
+            An allocation over the quota first frees the buffers the allocator caches for
+            reuse, then fails when the "policy" is "hard", the default, or is logged when it
+            is "soft". See tenant_memory_stats.
+
+        async_constant_upload : bool
+            Whether to upload the constants to the device in the background, in the order they
+            are first used, instead of before the construction returns. The first invocations
+            then wait for each constant as they use it, overlapping the upload of the weights
+            with the start of the first inference.
+        """
+        mod = exec.mod if isinstance(exec, Executable) else exec
+        if profile:
+            self.module = _ffi_api.VirtualMachineProfiler(mod)
+        else:
+            self.module = mod["vm_load_executable"]()
+        self._setup_functions()
+        self._setup_device(device, memory_cfg, ccl_config, memory_quota, async_constant_upload)
+
+    def _setup_functions(self) -> None:
+        """look up the packed functions of the vm module."""
         self._invoke_closure = self.module["invoke_closure"]
         self._set_input = self.module["set_input"]
         self._get_function_arity = self.module["get_function_arity"]
         self._get_function_param_name = self.module["get_function_param_name"]
-        self._setup_device(device, memory_cfg)
+        # The functions looked up by name, and the parameter names of the functions, so that an
+        # invocation does not cross the FFI to find them again.
+        self._functions: Dict[str, PackedFunc] = {}
+        self._param_names: Dict[str, List[str]] = {}
+        # The stream set by set_stream, handed to the producers of the DLPack inputs.
+        self._stream: Optional[int] = None
+
+    def create_session(self) -> "VirtualMachine":
+        """Create a session of the VM for concurrent execution.
+
+        The session shares the executable, the devices, the allocators and the device
+        constants with this VM, and has its own call stack, so that different threads
+        can run their sessions at the same time without duplicating the weights.
+
+        Returns
+        -------
+        session : VirtualMachine
+            The new session, ready to be invoked.
+        """
+        session = VirtualMachine.__new__(VirtualMachine)
+        session.module = self.module["create_session"]()
+        session._setup_functions()
+        return session
+
+    def set_max_parallelism(self, max_parallelism: int) -> None:
+        """Set the maximal number of kernels the VM runs concurrently.
+
+        Kernels in a straight-line run of calls that do not depend on one another, such as
+        the branches of a multi-branch model, run on the runtime thread pool. Builtins that
+        touch the VM state still run in sequence. A kernel that parallelizes its own loops
+        runs them on the thread running it.
+
+        Parameters
+        ----------
+        max_parallelism : int
+            The limit. 1, the default, runs every call in sequence.
+        """
+        self.module["set_max_parallelism"](max_parallelism)
+
+    def set_persistent_parallel_region(self, enable: bool, spin_count: int = 0) -> None:
+        """Run the functions in persistent parallel regions of the runtime thread pool.
+
+        In a region, the idle workers of the thread pool keep spinning for the next parallel
+        kernel instead of going to sleep, which saves the wake-up latency when a function runs
+        many small parallel kernels one after another, at the cost of busy CPUs.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to run the functions in persistent parallel regions.
+        spin_count : int
+            The number of iterations the idle workers spin in a region before they go to sleep
+            anyway. 0 keeps the current one, by default TVM_THREAD_POOL_REGION_SPIN_COUNT.
+        """
+        self.module["set_persistent_parallel_region"](enable, spin_count)
+
+    def set_workspace_arena(self, enable: bool) -> None:
+        """Serve the temporary workspaces of the kernels from a bump-pointer arena.
+
+        The arena of each thread grows in chunks during an invocation and is compacted into a
+        single chunk once its workspaces are released, so the steady state allocates no device
+        memory and needs no free-list search. The statistics of the workspace pools can be
+        queried with the "runtime.WorkspacePoolStats" global function.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to serve the workspaces from the arena.
+        """
+        self.module["set_workspace_arena"](enable)
+
+    def enable_shape_jit(
+        self,
+        mod: tvm.IRModule,
+        target: Union[str, tvm.target.Target],
+        threshold: int = 100,
+        max_shapes: int = 64,
+    ) -> None:
+        """Specialize the symbolic kernels for the shapes they are hot on.
+
+        Every call of a kernel with symbolic variables records their values. Once a kernel
+        was called threshold times with the same values, a kernel specialized to them is
+        built in a background thread, and runs the later calls with these values. The sessions
+        of the VM share the specialized kernels.
+
+        Parameters
+        ----------
+        mod : tvm.IRModule
+            The module the executable was built from, which holds the kernels.
+
+        target : Union[str, tvm.target.Target]
+            The target the executable was built for.
+
+        threshold : int
+            The number of calls after which a shape is hot.
+
+        max_shapes : int
+            The maximal number of shapes recorded per kernel, bounding the cost of a long
+            tail of cold shapes.
+        """
+        if isinstance(target, str):
+            target = tvm.target.Target(target)
+        compile_func = _ffi_api.VMShapeJITCompiler(mod, target)
+        self.module["enable_shape_jit"](compile_func, threshold, max_shapes)
+
+    def shape_jit_stats(self) -> Dict[str, int]:
+        """Get the statistics of the shape JIT enabled by enable_shape_jit.
+
+        Returns
+        -------
+        stats : Dict[str, int]
+            The number of kernels and shapes recorded, of the shapes specialized, failed and
+            pending, and of the calls run by specialized and by generic kernels.
+        """
+        return json.loads(self.module["shape_jit_stats"]())
+
+    def save_snapshot(self) -> str:
+        """Save the warm state of the VM, for the workers running the same executable to restore
+        with load_snapshot instead of warming up on their first requests.
+
+        The snapshot holds the shapes specialized by the shape JIT, and the shapes, dtypes and
+        devices of the arguments of the first invocation of each global function. The engines
+        built by BYOC runtimes are kept by their own caches, e.g. TVM_TENSORRT_CACHE_DIR.
+
+        Returns
+        -------
+        snapshot : str
+            The snapshot, as a JSON string.
+        """
+        return self.module["get_snapshot"]()
+
+    def load_snapshot(self, snapshot: str, warmup: bool = True) -> None:
+        """Restore the warm state saved by save_snapshot.
+
+        The shapes of the snapshot are specialized by the shape JIT, which enable_shape_jit must
+        have enabled, without waiting for them to get hot. With warmup, every function of the
+        snapshot is invoked once on zeros of its recorded arguments, which loads the kernel modules
+        on the devices, builds the engines of the BYOC runtimes and fills the memory pools, and the
+        specializations are waited for.
+
+        Parameters
+        ----------
+        snapshot : str
+            The snapshot, as a JSON string.
+
+        warmup : bool
+            Whether to invoke the functions once and wait for the specializations.
+        """
+        state = json.loads(snapshot)
+        if state.get("version") != 1:
+            raise ValueError("Unsupported snapshot version: %s" % state.get("version"))
+        for kernel, values in state["shape_jit"]:
+            self.module["shape_jit_preload"](kernel, tvm.runtime.ShapeTuple(values))
+        if not warmup:
+            return
+
+        def _zeros(signature):
+            if isinstance(signature, list):
+                return [_zeros(field) for field in signature]
+            device = tvm.runtime.device(*signature["device"])
+            return tvm.nd.array(np.zeros(signature["shape"], signature["dtype"]), device)
+
+        def _complete(signature):
+            if isinstance(signature, list):
+                return all(_complete(field) for field in signature)
+            return signature is not None
+
+        for func_name, signature in state["functions"].items():
+            # The functions taking other arguments than tensors cannot be warmed up.
+            if _complete(signature):
+                self[func_name](*_zeros(signature))
+        if state["shape_jit"]:
+            self.module["shape_jit_wait"]()
+
+    def set_stream(self, stream: Optional[int], device_index: int = 0) -> None:
+        """Run the kernels of the VM on a given stream of a device, e.g. the current stream of
+        PyTorch, torch.cuda.current_stream().cuda_stream, instead of the default stream.
+
+        The work queued on the stream by the framework and the VM is then ordered by the stream
+        itself, so that neither waits for the other on the host. The DLPack inputs are exported to
+        the stream, see invoke_dlpack, and the inputs set by set_input are copied before it runs.
+
+        Parameters
+        ----------
+        stream : Optional[int]
+            The raw handle of the stream, owned by the caller, None restores the default stream.
 
-    def _setup_device(self, dev: Device, memory_cfg: Union[str, Dict[Device, str]]) -> None:
+        device_index : int
+            The index of the device of the stream.
+        """
+        self._stream = stream
+        self.module["set_stream"](device_index, ctypes.c_void_p(stream))
+
+    def set_trace(self, sample_every: int = 1, max_events: int = 1 << 20) -> None:
+        """Record a timeline of the invocations, see get_trace.
+
+        The begin and the end of every instruction are recorded on the host thread running it,
+        and the kernels called on a device other than the host are timed on a track of the
+        device. One of every sample_every invocations is traced and the events beyond
+        max_events are dropped, which bounds the overhead when tracing in production.
+
+        Parameters
+        ----------
+        sample_every : int
+            Trace one of every sample_every invocations, 0 disables tracing and drops the
+            recorded events.
+
+        max_events : int
+            The maximal number of events kept.
+        """
+        self.module["set_trace"](sample_every, max_events)
+
+    def get_trace(self, clear: bool = False) -> str:
+        """Get the timeline recorded since set_trace.
+
+        Parameters
+        ----------
+        clear : bool
+            Whether to drop the returned events.
+
+        Returns
+        -------
+        trace : str
+            The timeline in the Chrome trace event JSON format, which chrome://tracing and
+            Perfetto load. The number of dropped events is in "otherData".
+        """
+        return self.module["get_trace"](clear)
+
+    def set_latency_stats(self, enable: bool) -> None:
+        """Record the latency of every invocation of the functions of the VM.
+
+        The latencies are counted in lock-free histograms with log-linear buckets, which
+        costs a few atomic increments per invocation, so that they can stay enabled in
+        production. The sessions of the VM share the histograms. Enabling resets them.
+
+        Parameters
+        ----------
+        enable : bool
+            Whether to record the latencies.
+        """
+        self.module["set_latency_stats"](enable)
+
+    def get_stats(self) -> Dict[str, Dict[str, Any]]:
+        """Get the latency statistics recorded since set_latency_stats.
+
+        Returns
+        -------
+        stats : Dict[str, Dict[str, Any]]
+            The statistics of each function called, keyed by name: "count", "mean_us",
+            "p50_us", "p90_us", "p99_us", "p999_us", "max_us", and the non-empty "buckets" as
+            pairs of the upper bound of the bucket in microseconds and its count.
+        """
+        return json.loads(self.module["get_stats"]())
+
+    def set_kernel_capture(self, pattern: str, capacity: int) -> None:
+        """Keep the outputs of the last calls to the kernels whose names match a pattern, to
+        debug the numerics of a model under real load.
+
+        The output of a kernel called by call_tir, its last tensor argument, is copied into a
+        ring of arrays reused while the shapes stay the same. A disabled capture costs a
+        single branch per call. The sessions of the VM share the ring. Enabling resets it.
+
+        Parameters
+        ----------
+        pattern : str
+            The regular expression searched in the names of the kernels.
+        capacity : int
+            The number of outputs kept. 0 disables the capture.
+        """
+        self.module["set_kernel_capture"](pattern, capacity)
+
+    def get_kernel_capture(self) -> List[Tuple[str, tvm.nd.NDArray]]:
+        """Get the outputs captured since set_kernel_capture.
+
+        Returns
+        -------
+        records : List[Tuple[str, tvm.nd.NDArray]]
+            The name of the kernel and a copy of its output for the captured calls, from the
+            oldest one.
+        """
+        return [(str(name), data) for name, data in self.module["get_kernel_capture"]()]
+
+    def set_hooks(
+        self, callback: Optional[Callable[[str, str, int], None]], instructions: bool = False
+    ) -> None:
+        """Register a callback of the events of the VM, e.g. to open and close the spans of an
+        external tracing system. The sessions created afterwards share it.
+
+        The callback is called with the event, a name and a value: "invoke_begin" and
+        "invoke_end" with the name of a global function, "instr_begin" and "instr_end" with the
+        name of an instruction and its pc, and "alloc" with the device of a storage and its
+        size in bytes. Without a callback, the VM checks for it once per invocation.
+
+        Parameters
+        ----------
+        callback : Optional[Callable[[str, str, int], None]]
+            The callback, None to unregister it.
+        instructions : bool
+            Whether to report the instructions, which slows down the dispatch.
+        """
+        self.module["set_hooks"](callback, instructions)
+
+    def memoize_stats(self, func_name: str) -> Dict[str, int]:
+        """Get the statistics of the cache of a function memoized by the "relax.memoize"
+        attribute, whose value is the number of calls the VM keeps the outputs of. The calls
+        with the same inputs, compared by value, are served from the cache.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the memoized function.
+
+        Returns
+        -------
+        stats : Dict[str, int]
+            The number of entries of the cache ("num_entries"), and the number of calls served
+            by it ("num_hits"), computed and cached ("num_misses"), and computed without
+            caching ("num_bypasses"), when an input is a large tensor.
+        """
+        return json.loads(_ffi_api.VMGetMemoizeStats(self.module, func_name))
+
+    def _setup_device(
+        self,
+        dev: Device,
+        memory_cfg: Union[str, Dict[Device, str]],
+        ccl_config: Optional[Dict[str, Any]] = None,
+        memory_quota: Optional[Dict[str, Any]] = None,
+        async_constant_upload: bool = False,
+    ) -> None:
         """init devices and allocators."""
         devs = dev
         if not isinstance(dev, (list, tuple)):
@@ -119,10 +576,20 @@ class VirtualMachine(object):
         if memory_cfg is None:
             memory_cfg = {}
         elif isinstance(memory_cfg, str):
-            assert memory_cfg in ["naive", "pooled"]
+            assert memory_cfg in ["naive", "pooled", "size_class", "stream_ordered"]
             if memory_cfg == "naive":
                 default_alloc_type = VirtualMachine.NAIVE_ALLOCATOR
-            memory_cfg = {}
+            elif memory_cfg == "size_class":
+                default_alloc_type = VirtualMachine.SIZE_CLASS_ALLOCATOR
+            if memory_cfg == "stream_ordered":
+                # The host keeps the pooled allocator.
+                memory_cfg = {
+                    dev: VirtualMachine.STREAM_ORDERED_ALLOCATOR
+                    for dev in devs
+                    if dev.device_type % RPC_SESS_MASK == tvm.cuda().device_type
+                }
+            else:
+                memory_cfg = {}
         elif not isinstance(memory_cfg, dict):
             raise TypeError(
                 "memory_cfg is expected be string or dictionary, "
@@ -134,10 +601,102 @@ class VirtualMachine(object):
             init_args.append(device.device_id)
             alloc_type = memory_cfg[device] if device in memory_cfg else default_alloc_type
             init_args.append(alloc_type)
+        if ccl_config is not None:
+            init_args.append(ccl_config.get("backend", "nccl"))
+            init_args.append(tvm.runtime.ShapeTuple([ccl_config["rank"], ccl_config["world_size"]]))
+            init_args.append(ccl_config["unique_id"])
+        if memory_quota is not None:
+            policy = memory_quota.get("policy", "hard")
+            assert policy in ["hard", "soft"]
+            init_args.append("memory_quota")
+            init_args.append(memory_quota["tenant"])
+            init_args.append(memory_quota["quota_bytes"])
+            init_args.append(policy)
+        if async_constant_upload:
+            init_args.append("async_constant_upload")
+            init_args.append(True)
         self.module["vm_initialization"](*init_args)
 
     def __getitem__(self, key: str) -> PackedFunc:
-        return self.module[key]
+        """Look up a function of the VM, cached by name.
+
+        The arguments of a global function are converted in C++: an NDArray or an Object is passed
+        as is, a DLTensor is viewed without a copy, and a nested tuple or list of them becomes a
+        tuple, so that no argument is converted in Python.
+        """
+        func = self._functions.get(key)
+        if func is None:
+            func = self.module[key]
+            self._functions[key] = func
+        return func
+
+    @staticmethod
+    def memory_stats(device: Device) -> Dict[str, Union[int, float]]:
+        """Get the memory usage statistics of the allocator of a device.
+
+        Parameters
+        ----------
+        device : Device
+            The device whose allocator is queried.
+
+        Returns
+        -------
+        stats : Dict[str, Union[int, float]]
+            The live, cached and peak bytes, the number of allocations, the number of
+            allocations served from the cache, and the cache hit rate.
+        """
+        return json.loads(_ffi_api.VMGetAllocatorStats(device.device_type, device.device_id))
+
+    @staticmethod
+    def tenant_memory_stats(tenant: str, device: Device) -> Dict[str, Union[int, float]]:
+        """Get the memory usage statistics of the allocator of a tenant on a device.
+
+        Parameters
+        ----------
+        tenant : str
+            The tenant given in the memory_quota of its VMs.
+
+        device : Device
+            The device whose allocator is queried.
+
+        Returns
+        -------
+        stats : Dict[str, Union[int, float]]
+            The statistics of memory_stats, along with the bytes held from the device, the
+            quota, the number of allocations which freed the cache, and the number of
+            allocations which exceeded the quota.
+        """
+        return json.loads(
+            _ffi_api.VMGetTenantAllocatorStats(tenant, device.device_type, device.device_id)
+        )
+
+    @staticmethod
+    def shared_constant_stats() -> Dict[str, int]:
+        """Get the statistics of the device copies of constants shared by all the VMs in the
+        process.
+
+        Returns
+        -------
+        stats : Dict[str, int]
+            The number and total bytes of the shared device copies, and the number of
+            constant uploads served by an existing copy.
+        """
+        return json.loads(_ffi_api.VMGetSharedConstantStats())
+
+    @staticmethod
+    def set_cache_limit(device: Device, cache_limit: int) -> None:
+        """Set the maximal number of freed bytes the size class allocator of a device keeps
+        for reuse.
+
+        Parameters
+        ----------
+        device : Device
+            The device whose allocator is configured.
+
+        cache_limit : int
+            The cache limit in bytes.
+        """
+        _ffi_api.VMSetAllocatorCacheLimit(device.device_type, device.device_id, cache_limit)
 
     def invoke_closure(self, closure: Object, *args: Any) -> Object:
         """Invoke a closure.
@@ -157,31 +716,61 @@ class VirtualMachine(object):
         """
         return self._invoke_closure(closure, *args)
 
-    def _convert(self, arg: Any, cargs: List) -> None:
-        """helper function to convert arguments to vm function."""
+    def invoke_cuda_graph(self, func_name: str, *args: Any) -> Object:
+        """Invoke a function through a CUDA graph. The kernels launched by the function are
+        captured into a CUDA graph at the first invocation and replayed afterwards.
 
-        def _gettype(arg):
-            if isinstance(arg, np.float16):
-                return "float16"
-            elif isinstance(arg, (_base.integer_types, bool)):
-                return "int32"
-            else:
-                return "float32"
+        The function must have static shapes, since its host-side work only runs at capture
+        time. The inputs are copied into static buffers before each replay, and all replays
+        return the same output tensors, which are overwritten by the next invocation.
 
-        if isinstance(arg, Object):
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        args : list[tvm.runtime.NDArray]
+            The arguments to the function, on a CUDA device.
+
+        Returns
+        -------
+        result : Object
+            The output.
+        """
+        return self.module["invoke_cuda_graph"](func_name, *args)
+
+    @staticmethod
+    def _gettype(arg: Any) -> str:
+        if isinstance(arg, np.float16):
+            return "float16"
+        elif isinstance(arg, (_base.integer_types, bool)):
+            return "int32"
+        else:
+            return "float32"
+
+    def _convert(self, arg: Any, cargs: List) -> None:
+        """helper function to convert arguments to vm function."""
+        # The common arguments first, they need no conversion.
+        if isinstance(arg, (tvm.runtime.NDArray, Object)):
             cargs.append(arg)
+        elif hasattr(arg, "__dlpack__") and not isinstance(arg, np.ndarray):
+            # alias tensors of other frameworks without copying, the producer orders its pending
+            # work before the stream of the VM
+            if self._stream is None:
+                capsule = arg.__dlpack__()
+            else:
+                capsule = arg.__dlpack__(stream=self._stream)
+            cargs.append(tvm.nd.from_dlpack(capsule))
         elif isinstance(arg, np.ndarray):
             nd_arr = tvm.nd.array(arg, device=tvm.cpu(0))
             cargs.append(nd_arr)
-        elif isinstance(arg, tvm.runtime.NDArray):
-            cargs.append(arg)
         elif isinstance(arg, (tuple, list)):
             field_args = []
             for field in arg:
                 self._convert(field, field_args)
             cargs.append(container.tuple_object(field_args))
         elif isinstance(arg, (_base.numeric_types, bool)):
-            dtype = _gettype(arg)
+            dtype = self._gettype(arg)
             value = tvm.nd.array(np.array(arg, dtype=dtype), device=tvm.cpu(0))
             cargs.append(value)
         elif isinstance(arg, str):
@@ -209,8 +798,13 @@ class VirtualMachine(object):
         if kwargs:
             # kwargs can be a super set of the required function parameters.
             # We only find the ones that are needed.
-            func_arity = self._get_function_arity(func_name)
-            func_params = [self._get_function_param_name(func_name, i) for i in range(func_arity)]
+            func_params = self._param_names.get(func_name)
+            if func_params is None:
+                func_arity = self._get_function_arity(func_name)
+                func_params = [
+                    self._get_function_param_name(func_name, i) for i in range(func_arity)
+                ]
+                self._param_names[func_name] = func_params
             new_args = [None] * len(func_params)
             cnt = 0
             for k in kwargs:
@@ -231,11 +825,450 @@ class VirtualMachine(object):
 
         self._set_input(func_name, *cargs)
 
+    def invoke_with_outputs(
+        self, func_name: str, inputs: List[Any], outputs: List[tvm.runtime.NDArray]
+    ) -> None:
+        """Invoke a function and write its results into the output buffers of the caller.
+
+        The tensors returned by the function are allocated directly in the output buffers
+        when their shapes, dtypes and devices match, so the kernels write the results in
+        place. Other results are copied into the output buffers.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        inputs : List[Any]
+            The arguments to the function.
+
+        outputs : List[tvm.runtime.NDArray]
+            The output buffers, one per output of the function.
+        """
+        cargs = []
+        for arg in inputs:
+            self._convert(arg, cargs)
+        self.module["invoke_with_outputs"](func_name, *cargs, *outputs)
+
+    def profile(self, func_name: str, *args: Any, collectors: Optional[List[Object]] = None):
+        """Profile a function call. Every packed function call, including the kernels, is
+        timed. The function is run once as warmup before the profiled run.
+
+        The VM must be created with profile=True.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        args: List[tvm.runtime.NDArray] or List[np.ndarray]
+            The arguments to the function. If no argument is given, the inputs set by
+            set_input are used.
+
+        collectors : Optional[List[tvm.runtime.profiling.MetricCollector]]
+            Extra metrics to collect, e.g. hardware counters through PAPI. Every call reports
+            the bytes of its arguments and the resulting bandwidth. With the FLOP counter
+            (PAPI_FP_OPS, PAPI_SP_OPS or PAPI_DP_OPS), the GFLOPS and the arithmetic intensity
+            are derived too, and with the cache miss counter (perf::CACHE-MISSES, PAPI_L3_TCM
+            or PAPI_L2_TCM), the memory bandwidth, which tell memory-bound kernels from
+            compute-bound ones.
+
+        Returns
+        -------
+        report : tvm.runtime.profiling.Report
+            The per call timing report.
+        """
+        cargs = []
+        for arg in args:
+            self._convert(arg, cargs)
+        return self.module["profile"](func_name, collectors, *cargs)
+
+    def invoke_stateful(self, func_name: str) -> None:
+        """Invoke a function on the inputs given by set_input. The result is kept by the VM
+        and read by get_outputs, so that no tensor crosses the RPC boundary per call.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+        """
+        self.module["invoke_stateful"](func_name)
+
+    def invoke_dlpack(self, func_name: str, *args: Any) -> Any:
+        """Invoke a function on the tensors of another framework, e.g. PyTorch, without copies.
+
+        The inputs with __dlpack__ are aliased, and the outputs are returned as DLPack capsules
+        sharing the storage of the VM, in the nested tuples of the result, ready for e.g.
+        torch.utils.dlpack.from_dlpack. With set_stream, the inputs are exported to the stream of
+        the VM and the outputs are ready on it, so that no sync is needed when the framework uses
+        the same stream.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        args : List[Any]
+            The arguments to the function.
+
+        Returns
+        -------
+        result : Any
+            The DLPack capsules of the output tensors, or tuples of them, and the other objects of
+            the output as is.
+        """
+        cargs: List[Any] = []
+        for arg in args:
+            self._convert(arg, cargs)
+        return _to_dlpack(self[func_name](*cargs))
+
+    def get_outputs(self, func_name: str) -> Object:
+        """Get the result of the last invoke_stateful call of a function.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        Returns
+        -------
+        ret : Object
+            The result of the function.
+        """
+        return self.module["get_output"](func_name)
+
+    def time_evaluator(
+        self,
+        func_name: str,
+        dev: Device,
+        number: int = 10,
+        repeat: int = 1,
+        min_repeat_ms: int = 0,
+        cooldown_interval_ms: int = 0,
+        repeats_to_cooldown: int = 1,
+        f_preproc: str = "",
+    ) -> Callable[..., tvm.runtime.module.BenchmarkResult]:
+        """Get an evaluator that measures the time cost of a function, see
+        tvm.runtime.Module.time_evaluator for the meaning of the parameters.
+
+        The inputs are set once before the measurement, and every run invokes the function
+        through invoke_stateful, so the timing excludes the argument conversion and works on
+        a VM over RPC.
+
+        Parameters
+        ----------
+        func_name : str
+            The name of the function.
+
+        dev : Device
+            The device to synchronize after the runs.
+
+        number : int
+            The number of runs averaged in one repeat.
+
+        repeat : int
+            The number of repeats.
+
+        min_repeat_ms : int
+            The minimum duration of one repeat in milliseconds.
+
+        cooldown_interval_ms : int
+            The cooldown interval in milliseconds between the repeats.
+
+        repeats_to_cooldown : int
+            The number of repeats before a cooldown.
+
+        f_preproc : str
+            The function to run before each repeat, e.g. to flush the caches.
+
+        Returns
+        -------
+        ftimer : Callable[..., tvm.runtime.module.BenchmarkResult]
+            The function that takes the arguments of the function, or no argument to use the
+            inputs given by set_input, and returns the mean/median/std of the repeats.
+
+        Examples
+        --------
+        .. code-block:: python
+
+            timing_res = vm.time_evaluator("main", tvm.cpu(), number=100, repeat=3)(data)
+            print(timing_res.mean, timing_res.median, timing_res.std)
+        """
+        feval = self.module.time_evaluator(
+            "invoke_stateful",
+            dev,
+            number=number,
+            repeat=repeat,
+            min_repeat_ms=min_repeat_ms,
+            cooldown_interval_ms=cooldown_interval_ms,
+            repeats_to_cooldown=repeats_to_cooldown,
+            f_preproc=f_preproc,
+        )
+
+        def evaluator(*args: Any, **kwargs: Any) -> tvm.runtime.module.BenchmarkResult:
+            if args or kwargs:
+                self.set_input(func_name, *args, **kwargs)
+            return feval(func_name)
+
+        return evaluator
+
+
+def _to_dlpack(value: Any) -> Any:
+    """The DLPack capsules of the tensors of a VM result, keeping its nested tuples."""
+    if isinstance(value, tvm.nd.NDArray):
+        return value.to_dlpack()
+    if isinstance(value, container.ADT):
+        return tuple(_to_dlpack(value[i]) for i in range(len(value)))
+    return value
+
+
+def ccl_unique_id(backend: str = "nccl") -> str:
+    """Create the id of the communicators of a distributed run, on one process of the run. The
+    id is then handed to every process of the run in the ccl_config of its VirtualMachine.
+
+    Parameters
+    ----------
+    backend : str
+        The collective communication backend.
+
+    Returns
+    -------
+    unique_id : str
+        The id of the communicators.
+    """
+    return tvm.get_global_func(f"runtime.relax_vm.{backend}.unique_id")()
+
+
+def pooled_empty(shape, dtype: str, device: Device) -> tvm.nd.NDArray:
+    """Create an empty array from the pooled allocator of the Relax VM on a device.
+
+    The memory of the array returns to the pool when it is freed, so that helpers which
+    repeatedly create large temporary arrays share the pooled memory of the VM instead of
+    allocating from the device every time.
+
+    Parameters
+    ----------
+    shape : Union[tvm.runtime.ShapeTuple, Sequence[int]]
+        The shape of the array.
+    dtype : str
+        The data type of the array.
+    device : Device
+        The device of the array.
+
+    Returns
+    -------
+    arr : tvm.nd.NDArray
+        The empty array.
+    """
+    return _ffi_api.VMAllocatorEmpty(tvm.runtime.ShapeTuple(shape), dtype, device)
+
+
+class DynamicBatcher(object):
+    """Batch the calls of many threads to a VM function with a symbolic batch dimension.
+
+    The inputs of the queued requests are concatenated along their leading dimension until
+    max_batch_size rows are gathered or the first request waited timeout_us microseconds,
+    the function is invoked once on the batch, and the rows of its outputs are scattered
+    back to the requests.
+
+    Parameters
+    ----------
+    vm : VirtualMachine
+        The VM running the function. It should not be used by other threads while the
+        batcher runs, e.g. pass a session created by create_session.
+
+    func_name : str
+        The function to batch, whose inputs and outputs are batched along their leading
+        dimension.
+
+    max_batch_size : int
+        The maximal number of rows of a batch.
+
+    timeout_us : int
+        How long the first request of a batch waits for more requests, in microseconds.
+    """
+
+    def __init__(
+        self, vm: VirtualMachine, func_name: str, max_batch_size: int, timeout_us: int = 1000
+    ) -> None:
+        self.module = _ffi_api.VMDynamicBatcher(vm.module, func_name, max_batch_size, timeout_us)
+        self._submit = self.module["submit"]
+        self._stats = self.module["stats"]
+
+    def __call__(self, *args: tvm.runtime.NDArray) -> Object:
+        """Submit a request and wait for its result.
+
+        Parameters
+        ----------
+        args : List[tvm.runtime.NDArray]
+            The inputs of the request, which have the same leading dimension.
+
+        Returns
+        -------
+        result : Object
+            The rows of the outputs of the batch which belong to the request.
+        """
+        return self._submit(*args)
+
+    def stats(self) -> Dict[str, Union[int, float]]:
+        """Get the batching statistics.
+
+        Returns
+        -------
+        stats : Dict[str, Union[int, float]]
+            The number of requests and batches, the average batch size, and the average
+            queueing latency per request and compute latency per batch in microseconds.
+        """
+        return json.loads(self._stats())
+
+
+class VMPipeline(object):
+    """Pipeline the calls to a VM function, so that the host work of a request overlaps with
+    the device kernels of the previous ones.
+
+    A thread copies the inputs of the next requests to the device, a thread invokes the
+    function, which runs its host instructions and launches its kernels asynchronously, and a
+    thread waits for the kernels of the earliest request in flight and returns its outputs.
+
+    Parameters
+    ----------
+    vm : VirtualMachine
+        The VM running the function. It should not be used by other threads while the
+        pipeline runs, e.g. pass a session created by create_session.
+
+    func_name : str
+        The function to pipeline.
+
+    depth : int
+        The maximal number of requests queued between two stages of the pipeline.
+    """
+
+    def __init__(self, vm: VirtualMachine, func_name: str, depth: int = 2) -> None:
+        self.module = _ffi_api.VMPipeline(vm.module, func_name, depth)
+        self._submit = self.module["submit"]
+        self._run_all = self.module["run_all"]
+        self._stats = self.module["stats"]
+
+    def __call__(self, *args: Object) -> Object:
+        """Submit a request and wait for its result.
+
+        Parameters
+        ----------
+        args : List[Object]
+            The inputs of the request.
+
+        Returns
+        -------
+        result : Object
+            The outputs of the function.
+        """
+        return self._submit(*args)
+
+    def run_all(self, requests: List[List[Object]]) -> List[Object]:
+        """Run many requests at once, overlapping each other through the pipeline.
+
+        Parameters
+        ----------
+        requests : List[List[Object]]
+            The inputs of every request.
+
+        Returns
+        -------
+        results : List[Object]
+            The outputs of every request, in order.
+        """
+        return list(self._run_all(requests))
+
+    def stats(self) -> Dict[str, Union[int, float]]:
+        """Get the pipeline statistics.
+
+        Returns
+        -------
+        stats : Dict[str, Union[int, float]]
+            The number of requests, the average time the invocation of a request takes on the
+            host, and the average latency from the submission to the outputs, in microseconds.
+        """
+        return json.loads(self._stats())
+
+
+class ContinuousBatcher(object):
+    """Generate the tokens of many requests by steps of a VM decode function over the batch of
+    the active sequences, which join the batch and leave it at every step.
+
+    The decode function takes the paged KV cache, the ShapeTuple of the ids of the sequences of
+    the batch, the ShapeTuple of their numbers of new tokens and the int32 new tokens of the
+    sequences in order. It appends their keys and values to the cache, and returns the int32
+    next token of every sequence. The first step of a sequence feeds its prompt, the later steps
+    its last token. A request joins the batch once the cache has the blocks of its prompt and of
+    its maximal number of new tokens.
+
+    Parameters
+    ----------
+    vm : VirtualMachine
+        The VM running the decode function. It should not be used by other threads while the
+        batcher runs, e.g. pass a session created by create_session.
+
+    func_name : str
+        The decode function.
+
+    cache : Object
+        The paged KV cache created by vm.builtin.paged_kv_cache_create, only used by the
+        batcher while it runs.
+
+    max_batch_size : int
+        The maximal number of sequences of a step.
+    """
+
+    def __init__(
+        self, vm: VirtualMachine, func_name: str, cache: Object, max_batch_size: int = 8
+    ) -> None:
+        self.module = _ffi_api.VMContinuousBatcher(vm.module, func_name, cache, max_batch_size)
+        self._generate = self.module["generate"]
+        self._stats = self.module["stats"]
+
+    def generate(
+        self, prompt: Union[np.ndarray, tvm.nd.NDArray], max_new_tokens: int, stop_token: int = -1
+    ) -> tvm.nd.NDArray:
+        """Submit a request and wait for its tokens.
+
+        Parameters
+        ----------
+        prompt : Union[numpy.ndarray, tvm.nd.NDArray]
+            The 1-D int32 tokens of the prompt.
+
+        max_new_tokens : int
+            The maximal number of tokens to generate.
+
+        stop_token : int
+            The token ending the generation, included in the result, or -1 for none.
+
+        Returns
+        -------
+        tokens : tvm.nd.NDArray
+            The generated tokens.
+        """
+        if not isinstance(prompt, tvm.nd.NDArray):
+            prompt = tvm.nd.array(np.asarray(prompt, dtype="int32"))
+        return self._generate(prompt, max_new_tokens, stop_token)
+
+    def stats(self) -> Dict[str, Union[int, float]]:
+        """Get the batcher statistics.
+
+        Returns
+        -------
+        stats : Dict[str, Union[int, float]]
+            The number of requests, steps and generated tokens, the average batch size, the
+            generated tokens per second of the steps, and the average queueing latency per
+            request in microseconds.
+        """
+        return json.loads(self._stats())
+
 
 def build(
     mod: tvm.IRModule,
     target: Union[str, tvm.target.Target],
     params: Optional[Dict[str, list]] = None,
+    exec_mode: str = "bytecode",
 ) -> Executable:
     """
     Build an IRModule to VM executable.
@@ -258,6 +1291,12 @@ def build(
     params: Optional[Dict[str, list]]
         Parameters for the input IRModule that will be bound.
 
+    exec_mode: str
+        The execution mode of the Relax functions, either "bytecode", in which they are
+        interpreted by the VM, or "compiled", in which they are compiled into host functions
+        of the kernel library that call the kernels directly. The executables of both modes
+        are loaded and run in the same way.
+
     Returns
     -------
     ex: tvm.relax.vm.Executable
@@ -279,40 +1318,8 @@ def build(
     """
     if isinstance(target, str):
         target = tvm.target.Target(target)
-
-    passes = [relax.transform.ToNonDataflow()]
-    passes.append(relax.transform.CallTIRRewrite())
-    passes.append(relax.transform.VMMemoryLower())
-    passes.append(relax.transform.VMShapeLower())
-    seq = tvm.transform.Sequential(passes)
-    new_mod = seq(mod)
-
-    # split primfunc and relax function
-    rx_mod, tir_mod = _split_tir_relax(new_mod)
-    lib = tvm.build(tir_mod, target=target)
-
-    ext_libs = []
-    if mod.attrs and "external_mods" in mod.attrs:
-        ext_libs = mod.attrs["external_mods"]
-
     if params is None:
         params = {}
-
-    return Executable(_ffi_api.VMCodeGen(rx_mod, lib, ext_libs, target, params))
-
-
-def _split_tir_relax(mod: tvm.IRModule) -> Tuple[tvm.IRModule, tvm.IRModule]:
-    rx_mod = IRModule({})
-    tir_mod = IRModule({})
-    for gv in mod.get_global_vars():
-        if isinstance(mod[gv], PrimFunc):
-            tir_mod[gv] = mod[gv]
-        elif isinstance(mod[gv], relax.Function):
-            rx_mod[gv] = mod[gv]
-        else:
-            raise TypeError(
-                "IRModule is expected to contain PrimFunc or Function, but gets {}".format(
-                    type(mod[gv])
-                )
-            )
-    return rx_mod, tir_mod
+    # The Relax functions are lowered to the VM and split from their kernels, whose library is
+    # compiled while the bytecode is generated, all in one call.
+    return Executable(_ffi_api.VMBuild(mod, target, params, exec_mode))
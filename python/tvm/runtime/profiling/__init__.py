@@ -155,6 +155,20 @@ class Report(Object):
         """
         return _ffi_api.AsJSON(self)
 
+    def chrome_trace(self):
+        """Convert the calls of this profiling report into a timeline.
+
+        The calls of each device are laid out one after another on a track of the device, as
+        the report records their durations but not when they started.
+
+        Returns
+        -------
+        trace : str
+            The timeline in the Chrome trace event JSON format, which chrome://tracing and
+            Perfetto load.
+        """
+        return _ffi_api.AsChromeTrace(self)
+
     @classmethod
     def from_json(cls, s):
         """Deserialize a report from JSON.
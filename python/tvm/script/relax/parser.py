@@ -1782,3 +1782,24 @@ def astext(node, show_meta_data=False) -> str:
         of the the return string.
     """
     return tvm.script._ffi_api.AsRelaxScript(node, show_meta_data)
+
+
+def save_script(node, path, show_meta_data=False) -> None:
+    """Writes the Relax text format representation of the given Relax IR node to a file.
+
+    The functions of an IRModule are printed and written one at a time, so the text of a large
+    module is not built in memory, unless meta data is shown.
+
+    Parameters
+    ----------
+    node : Union[tvm.IRModule, relax.Function, tir.PrimFunc]
+        The Relax IR node to print.
+
+    path : str
+        The path of the file to write.
+
+    show_meta_data : bool
+        Whether to include meta data section in the text
+        if there is meta data.
+    """
+    tvm.script._ffi_api.SaveRelaxScript(node, path, show_meta_data)
@@ -16,6 +16,7 @@
 # under the License.
 # pylint: disable=invalid-name,missing-function-docstring
 """Intrinsics for x86 tensorization."""
+from tvm.runtime import DataType
 from tvm.script import tir as T
 from .. import TensorIntrin
 
@@ -73,3 +74,115 @@ VNNI_DOT_16x4_INTRIN = "dot_16x4_vnni"
 TensorIntrin.register(
     VNNI_DOT_16x4_INTRIN, dot_product_16x4_u8i8i32_desc, dot_product_16x4_u8i8i32_vnni
 )
+
+
+# Tensorized intrinsic description and AMX-specific implementation. An AMX tile holds up to 16
+# rows of 64 bytes, the columns of B are packed with the groups of K which fit in 32 bits, i.e.
+# B[k // group, j, k % group]. The code generator of x86-64 configures the tiles of the functions
+# which use these intrinsics.
+
+
+def get_amx_dot_intrin(a_dtype, b_dtype, out_dtype, compute_intrin):
+    """Generate the description and the AMX implementation of C[16, 16] += A[16, K] * B[K, 16]."""
+    in_bits = DataType(a_dtype).bits
+    group = 32 // in_bits
+    k_dim = 16 * group
+    a_bytes = in_bits // 8
+    out_bytes = DataType(out_dtype).bits // 8
+
+    @T.prim_func
+    def amx_dot_desc(a: T.handle, b: T.handle, c: T.handle) -> None:
+        A = T.match_buffer(a, (16, k_dim), a_dtype, offset_factor=1)
+        B = T.match_buffer(b, (16, 16, group), b_dtype, offset_factor=1)
+        C = T.match_buffer(c, (16, 16), out_dtype, offset_factor=1)
+
+        with T.block("root"):
+            T.reads(C[0:16, 0:16], A[0:16, 0:k_dim], B[0:16, 0:16, 0:group])
+            T.writes(C[0:16, 0:16])
+            for i, j, k in T.grid(16, 16, k_dim):
+                with T.block("update"):
+                    vi, vj, vk = T.axis.remap("SSR", [i, j, k])
+                    C[vi, vj] = C[vi, vj] + T.cast(A[vi, vk], out_dtype) * T.cast(
+                        B[vk // group, vj, vk % group], out_dtype
+                    )
+
+    @T.prim_func
+    def amx_dot_impl(a: T.handle, b: T.handle, c: T.handle) -> None:
+        sa = T.var("int32")
+        sb = T.var("int32")
+        sc = T.var("int32")
+        A = T.match_buffer(a, (16, k_dim), a_dtype, offset_factor=1, strides=[sa, 1])
+        B = T.match_buffer(b, (16, 16, group), b_dtype, offset_factor=1, strides=[sb, group, 1])
+        C = T.match_buffer(c, (16, 16), out_dtype, offset_factor=1, strides=[sc, 1])
+
+        with T.block("root"):
+            T.reads(C[0:16, 0:16], A[0:16, 0:k_dim], B[0:16, 0:16, 0:group])
+            T.writes(C[0:16, 0:16])
+            # The tiles 0, 1 and 2 hold C, A and B respectively, the strides are in bytes.
+            T.evaluate(
+                T.call_llvm_intrin(
+                    T.llvm_lookup_intrinsic_id("llvm.x86.tileloadd64"),
+                    T.uint32(0),
+                    T.uint8(0),
+                    C.access_ptr("r"),
+                    T.cast(sc, "int64") * out_bytes,
+                    dtype="",
+                )
+            )
+            T.evaluate(
+                T.call_llvm_intrin(
+                    T.llvm_lookup_intrinsic_id("llvm.x86.tileloadd64"),
+                    T.uint32(0),
+                    T.uint8(1),
+                    A.access_ptr("r"),
+                    T.cast(sa, "int64") * a_bytes,
+                    dtype="",
+                )
+            )
+            T.evaluate(
+                T.call_llvm_intrin(
+                    T.llvm_lookup_intrinsic_id("llvm.x86.tileloadd64"),
+                    T.uint32(0),
+                    T.uint8(2),
+                    B.access_ptr("r"),
+                    T.cast(sb, "int64") * a_bytes,
+                    dtype="",
+                )
+            )
+            T.evaluate(
+                T.call_llvm_intrin(
+                    T.llvm_lookup_intrinsic_id(compute_intrin),
+                    T.uint32(0),
+                    T.uint8(0),
+                    T.uint8(1),
+                    T.uint8(2),
+                    dtype="",
+                )
+            )
+            T.evaluate(
+                T.call_llvm_intrin(
+                    T.llvm_lookup_intrinsic_id("llvm.x86.tilestored64"),
+                    T.uint32(0),
+                    T.uint8(0),
+                    C.access_ptr("w"),
+                    T.cast(sc, "int64") * out_bytes,
+                    dtype="",
+                )
+            )
+
+    return amx_dot_desc, amx_dot_impl
+
+
+AMX_DOT_16x16x64_INT8_INTRIN = "dot_16x16x64_amx_int8"
+
+TensorIntrin.register(
+    AMX_DOT_16x16x64_INT8_INTRIN,
+    *get_amx_dot_intrin("uint8", "int8", "int32", "llvm.x86.tdpbusd"),
+)
+
+AMX_DOT_16x16x32_BF16_INTRIN = "dot_16x16x32_amx_bf16"
+
+TensorIntrin.register(
+    AMX_DOT_16x16x32_BF16_INTRIN,
+    *get_amx_dot_intrin("bfloat16", "bfloat16", "float32", "llvm.x86.tdpbf16ps"),
+)
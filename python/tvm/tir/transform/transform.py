@@ -838,6 +838,19 @@ def InjectSoftwarePipeline():
     return _ffi_api.InjectSoftwarePipeline()  # type: ignore
 
 
+def InjectSoftwarePrefetch():
+    """Prefetch the rows gathered by the indirect loads of the loops annotated with
+    "software_prefetch_distance" k, e.g. weight[indices[b, l], d] of an embedding bag, k
+    iterations ahead.
+
+    Returns
+    -------
+    fpass : tvm.transform.Pass
+        The result pass
+    """
+    return _ffi_api.InjectSoftwarePrefetch()  # type: ignore
+
+
 def ExtractPrimFuncConstants():
     """Collects and unificates tir non-scalar constants to module's attr 'Constants' array.
 
@@ -52,3 +52,5 @@ from .space_to_batch_nd import *
 from .batch_to_space_nd import *
 from .loss import *
 from .lstm import *
+from .attention import *
+from .embedding import *
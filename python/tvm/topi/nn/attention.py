@@ -0,0 +1,313 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name, too-many-locals, too-many-statements
+"""Fused attention computed with an online softmax, tile by tile or through paged KV caches."""
+import math
+
+import tvm
+from tvm import te
+from ..utils import ceil_div, prod
+
+
+def _attention_ir(query, key, value, out, scale, tile_size, use_gpu):
+    """Compute softmax(query @ key * scale) @ value over the tiles of the keys. For each query
+    row, the maximum and the sum of the exponentials of the scores seen so far are carried
+    across the tiles, and the partial output is rescaled whenever the maximum grows, so that only
+    one tile of the scores is ever alive, in registers."""
+    seq_q, head_dim = query.shape[-2], query.shape[-1]
+    seq_kv, value_dim = value.shape[-2], value.shape[-1]
+    batch = prod(query.shape[:-2])
+    acc_dtype = "float32"
+
+    ib = tvm.tir.ir_builder.create()
+    q_ptr = ib.buffer_ptr(query)
+    k_ptr = ib.buffer_ptr(key)
+    v_ptr = ib.buffer_ptr(value)
+    out_ptr = ib.buffer_ptr(out)
+
+    def load_key(b, d, j):
+        return k_ptr[(b * head_dim + d) * seq_kv + j].astype(acc_dtype)
+
+    def load_value(b, j, e):
+        return v_ptr[(b * seq_kv + j) * value_dim + e].astype(acc_dtype)
+
+    def sync():
+        ib.emit(tvm.tir.Call(None, "tir.tvm_storage_sync", tvm.runtime.convert(["shared"])))
+
+    def emit_row(b, i, tx=None):
+        """Emit the computation of the query row i, cooperating with the other rows of the
+        thread block on GPU, where tx is the thread index."""
+        row_max = ib.allocate(acc_dtype, (1,), name="row_max", scope="local")
+        row_sum = ib.allocate(acc_dtype, (1,), name="row_sum", scope="local")
+        new_max = ib.allocate(acc_dtype, (1,), name="new_max", scope="local")
+        acc = ib.allocate(acc_dtype, (value_dim,), name="acc", scope="local")
+        scores = ib.allocate(acc_dtype, (tile_size,), name="scores", scope="local")
+        if tx is not None:
+            # The tiles of the keys and the values are shared by the rows of the thread block.
+            key_tile = ib.allocate(
+                acc_dtype, (head_dim * tile_size,), name="key_tile", scope="shared"
+            )
+            value_tile = ib.allocate(
+                acc_dtype, (tile_size * value_dim,), name="value_tile", scope="shared"
+            )
+        row_max[0] = tvm.tir.min_value(acc_dtype)
+        row_sum[0] = tvm.tir.const(0, acc_dtype)
+        with ib.for_range(0, value_dim, name="e") as e:
+            acc[e] = tvm.tir.const(0, acc_dtype)
+
+        with ib.for_range(0, ceil_div(seq_kv, tile_size), name="t") as t:
+            if tx is not None:
+                # Load the tiles cooperatively, zero-padded beyond the sequence.
+                j = t * tile_size + tx
+                with ib.for_range(0, head_dim, name="d") as d:
+                    key_tile[d * tile_size + tx] = tvm.tir.if_then_else(
+                        j < seq_kv, load_key(b, d, j), tvm.tir.const(0, acc_dtype)
+                    )
+                with ib.for_range(0, value_dim, name="e") as e:
+                    value_tile[tx * value_dim + e] = tvm.tir.if_then_else(
+                        j < seq_kv, load_value(b, j, e), tvm.tir.const(0, acc_dtype)
+                    )
+                sync()
+
+                def get_key(d, jj):
+                    return key_tile[d * tile_size + jj]
+
+                def get_value(jj, e):
+                    return value_tile[jj * value_dim + e]
+
+            else:
+
+                def get_key(d, jj):
+                    return load_key(b, d, t * tile_size + jj)
+
+                def get_value(jj, e):
+                    return load_value(b, t * tile_size + jj, e)
+
+            with ib.if_scope(i < seq_q):
+                new_max[0] = row_max[0]
+                with ib.for_range(0, tile_size, name="jj") as jj:
+                    with ib.if_scope(t * tile_size + jj < seq_kv):
+                        scores[jj] = tvm.tir.const(0, acc_dtype)
+                        with ib.for_range(0, head_dim, name="d") as d:
+                            q = q_ptr[(b * seq_q + i) * head_dim + d].astype(acc_dtype)
+                            scores[jj] += q * get_key(d, jj)
+                        scores[jj] *= tvm.tir.const(scale, acc_dtype)
+                        new_max[0] = tvm.te.max(new_max[0], scores[jj])
+                # Rescale the partial results to the new maximum.
+                correction = tvm.te.exp(row_max[0] - new_max[0])
+                row_sum[0] *= correction
+                with ib.for_range(0, value_dim, name="e") as e:
+                    acc[e] *= correction
+                with ib.for_range(0, tile_size, name="jj") as jj:
+                    with ib.if_scope(t * tile_size + jj < seq_kv):
+                        p = tvm.te.exp(scores[jj] - new_max[0])
+                        row_sum[0] += p
+                        with ib.for_range(0, value_dim, name="e") as e:
+                            acc[e] += p * get_value(jj, e)
+                row_max[0] = new_max[0]
+            if tx is not None:
+                sync()
+
+        with ib.if_scope(i < seq_q):
+            with ib.for_range(0, value_dim, name="e") as e:
+                out_ptr[(b * seq_q + i) * value_dim + e] = (acc[e] / row_sum[0]).astype(out.dtype)
+
+    if use_gpu:
+        num_q_tiles = ceil_div(seq_q, tile_size)
+        tx = te.thread_axis("threadIdx.x")
+        bx = te.thread_axis("blockIdx.x")
+        ib.scope_attr(tx, "thread_extent", tile_size)
+        ib.scope_attr(bx, "thread_extent", batch * num_q_tiles)
+        emit_row(bx // num_q_tiles, bx % num_q_tiles * tile_size + tx, tx)
+    else:
+        with ib.for_range(0, batch * seq_q, kind="parallel", name="bi") as bi:
+            emit_row(bi // seq_q, bi % seq_q)
+    return ib.get()
+
+
+def flash_attention(query, key, value, scale=None, tile_size=None, target=None):
+    """Attention softmax(query @ key * scale) @ value fused into one kernel, which walks the keys
+    and the values tile by tile with an online softmax, so that the scores of the full sequence
+    are never materialized in memory. The sequence lengths can be dynamic.
+
+    Parameters
+    ----------
+    query : tvm.te.Tensor
+        The queries of shape (..., seq_q, head_dim).
+
+    key : tvm.te.Tensor
+        The transposed keys of shape (..., head_dim, seq_kv).
+
+    value : tvm.te.Tensor
+        The values of shape (..., seq_kv, value_dim).
+
+    scale : Optional[float]
+        The scale of the scores, 1 / sqrt(head_dim) by default.
+
+    tile_size : Optional[int]
+        The number of keys of a tile, and on GPU the number of query rows of a thread block.
+        Defaults to 32 on GPU and 64 on CPU.
+
+    target : Optional[tvm.target.Target]
+        The target, the current target by default. The kernel is bound to GPU threads, with the
+        tiles staged in shared memory, if the target is a GPU.
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        The output of shape (..., seq_q, value_dim).
+    """
+    if target is None:
+        target = tvm.target.Target.current(allow_none=True)
+    use_gpu = target is not None and "gpu" in target.keys
+    if tile_size is None:
+        tile_size = 32 if use_gpu else 64
+    head_dim, value_dim = query.shape[-1], value.shape[-1]
+    if not isinstance(head_dim, tvm.tir.IntImm) or not isinstance(value_dim, tvm.tir.IntImm):
+        raise ValueError("flash_attention requires static head dimensions")
+    if scale is None:
+        scale = 1.0 / math.sqrt(int(head_dim))
+    out_shape = list(query.shape[:-1]) + [value_dim]
+    return te.extern(
+        [out_shape],
+        [query, key, value],
+        lambda ins, outs: _attention_ir(
+            ins[0], ins[1], ins[2], outs[0], float(scale), tile_size, use_gpu
+        ),
+        dtype=[query.dtype],
+        name="flash_attention",
+        tag="flash_attention",
+    )
+
+
+def _paged_attention_ir(query, k_pool, v_pool, block_table, seq_lens, out, scale, use_gpu):
+    """Compute the attention of every query row over the keys and the values of its sequence,
+    found in the pools through the block table of the sequence, with an online softmax over the
+    tokens, so that only the running maximum, sum and output of the row are alive."""
+    batch, num_heads, head_dim = query.shape
+    block_size = k_pool.shape[1]
+    acc_dtype = "float32"
+
+    ib = tvm.tir.ir_builder.create()
+    q_ptr = ib.buffer_ptr(query)
+    k_ptr = ib.buffer_ptr(k_pool)
+    v_ptr = ib.buffer_ptr(v_pool)
+    table_ptr = ib.buffer_ptr(block_table)
+    lens_ptr = ib.buffer_ptr(seq_lens)
+    out_ptr = ib.buffer_ptr(out)
+    max_blocks = block_table.shape[1]
+
+    def emit_row(bh):
+        b = bh // num_heads
+        h = bh % num_heads
+        row_max = ib.allocate(acc_dtype, (1,), name="row_max", scope="local")
+        row_sum = ib.allocate(acc_dtype, (1,), name="row_sum", scope="local")
+        score = ib.allocate(acc_dtype, (1,), name="score", scope="local")
+        new_max = ib.allocate(acc_dtype, (1,), name="new_max", scope="local")
+        acc = ib.allocate(acc_dtype, (head_dim,), name="acc", scope="local")
+        row_max[0] = tvm.tir.min_value(acc_dtype)
+        row_sum[0] = tvm.tir.const(0, acc_dtype)
+        with ib.for_range(0, head_dim, name="d") as d:
+            acc[d] = tvm.tir.const(0, acc_dtype)
+        with ib.for_range(0, lens_ptr[b], name="t") as t:
+            block = table_ptr[b * max_blocks + t // block_size].astype("int64")
+            # The row of the token in the pools, laid out (num_blocks, block_size, heads, dim).
+            row = ((block * block_size + t % block_size) * num_heads + h) * head_dim
+            score[0] = tvm.tir.const(0, acc_dtype)
+            with ib.for_range(0, head_dim, name="d") as d:
+                q = q_ptr[bh * head_dim + d].astype(acc_dtype)
+                score[0] += q * k_ptr[row + d].astype(acc_dtype)
+            score[0] *= tvm.tir.const(scale, acc_dtype)
+            new_max[0] = tvm.te.max(row_max[0], score[0])
+            # Rescale the partial results to the new maximum.
+            correction = tvm.te.exp(row_max[0] - new_max[0])
+            p = tvm.te.exp(score[0] - new_max[0])
+            row_sum[0] = row_sum[0] * correction + p
+            with ib.for_range(0, head_dim, name="d") as d:
+                acc[d] = acc[d] * correction + p * v_ptr[row + d].astype(acc_dtype)
+            row_max[0] = new_max[0]
+        with ib.for_range(0, head_dim, name="d") as d:
+            out_ptr[bh * head_dim + d] = tvm.tir.if_then_else(
+                lens_ptr[b] > 0, acc[d] / row_sum[0], tvm.tir.const(0, acc_dtype)
+            ).astype(out.dtype)
+
+    num_rows = batch * num_heads
+    if use_gpu:
+        num_threads = 64
+        tx = te.thread_axis("threadIdx.x")
+        bx = te.thread_axis("blockIdx.x")
+        ib.scope_attr(tx, "thread_extent", num_threads)
+        ib.scope_attr(bx, "thread_extent", ceil_div(num_rows, num_threads))
+        bh = bx * num_threads + tx
+        with ib.if_scope(bh < num_rows):
+            emit_row(bh)
+    else:
+        with ib.for_range(0, num_rows, kind="parallel", name="bh") as bh:
+            emit_row(bh)
+    return ib.get()
+
+
+def paged_attention(query, k_pool, v_pool, block_table, seq_lens, scale=None, target=None):
+    """The attention of the decoded token of every sequence over its cached keys and values,
+    which are stored in fixed-size blocks of shared pools, the blocks of a sequence listed by
+    its row of the block table, e.g. as given by vm.builtin.paged_kv_cache_block_table.
+
+    Parameters
+    ----------
+    query : tvm.te.Tensor
+        The queries of shape (batch, num_heads, head_dim), one token per sequence.
+
+    k_pool : tvm.te.Tensor
+        The key pool of shape (num_blocks, block_size, num_heads, head_dim).
+
+    v_pool : tvm.te.Tensor
+        The value pool of the shape of the key pool.
+
+    block_table : tvm.te.Tensor
+        The int32 blocks of every sequence, of shape (batch, max_blocks_per_sequence).
+
+    seq_lens : tvm.te.Tensor
+        The int32 number of the cached tokens of every sequence, of shape (batch,).
+
+    scale : Optional[float]
+        The scale of the scores, 1 / sqrt(head_dim) by default.
+
+    target : Optional[tvm.target.Target]
+        The target, the current target by default. A thread computes a head of a sequence on
+        GPU, the heads of the sequences are parallelized on CPU.
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        The output of shape (batch, num_heads, head_dim).
+    """
+    if target is None:
+        target = tvm.target.Target.current(allow_none=True)
+    use_gpu = target is not None and "gpu" in target.keys
+    head_dim = query.shape[-1]
+    if not isinstance(head_dim, tvm.tir.IntImm) or not isinstance(k_pool.shape[1], tvm.tir.IntImm):
+        raise ValueError("paged_attention requires a static head dimension and block size")
+    if scale is None:
+        scale = 1.0 / math.sqrt(int(head_dim))
+    return te.extern(
+        [query.shape],
+        [query, k_pool, v_pool, block_table, seq_lens],
+        lambda ins, outs: _paged_attention_ir(*ins, outs[0], float(scale), use_gpu),
+        dtype=[query.dtype],
+        name="paged_attention",
+        tag="paged_attention",
+    )
@@ -0,0 +1,73 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=invalid-name
+"""Embedding bag: the rows of an embedding table gathered and pooled per bag."""
+import tvm
+from tvm import te
+
+
+def embedding_bag(weight, indices, mode="sum", target=None):
+    """Gather the rows of the embedding table at the indices of every bag and pool them, in one
+    reduction: out[b, d] = reduce_l weight[indices[b, l], d], so that the gathered rows are never
+    materialized.
+
+    The reduction is annotated with the MetaSchedule rule "meta_schedule.embedding_bag.<target
+    kind>" of the target, the one of llvm runs batches of bags per thread and prefetches the rows
+    of the later indices of a bag.
+
+    Parameters
+    ----------
+    weight : tvm.te.Tensor
+        The embedding table of shape (num_embeddings, embedding_dim).
+
+    indices : tvm.te.Tensor
+        The integer indices of shape (num_bags, bag_size).
+
+    mode : str
+        The pooling of the rows of a bag, "sum", "mean" or "max".
+
+    target : Optional[tvm.target.Target]
+        The target picking the schedule rule, the current target by default. The reduction has no
+        schedule rule without a target.
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        The pooled rows of shape (num_bags, embedding_dim).
+    """
+    if target is None:
+        target = tvm.target.Target.current(allow_none=True)
+    num_bags, bag_size = indices.shape
+    embedding_dim = weight.shape[1]
+    l = te.reduce_axis((0, bag_size), name="l")
+    attrs = {}
+    if target is not None:
+        attrs["schedule_rule"] = "meta_schedule.embedding_bag." + target.kind.name
+
+    if mode not in ("sum", "mean", "max"):
+        raise ValueError(f"embedding_bag expects the mode sum, mean or max, but got {mode}")
+
+    def reduce(b, d):
+        row = weight[indices[b, l], d]
+        if mode == "mean":
+            # The rows are scaled in the reduction, so that the pooling stays a single block.
+            row = row / bag_size.astype(weight.dtype)
+        return (te.max if mode == "max" else te.sum)(row, axis=l)
+
+    return te.compute(
+        (num_bags, embedding_dim), reduce, name="embedding_bag", tag="embedding_bag", attrs=attrs
+    )
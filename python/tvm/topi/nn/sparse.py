@@ -133,6 +133,77 @@ def sparse_dense(dense_data, sparse_data, sparse_indices, sparse_indptr, sparse_
         return sparse_dense_sp_rhs(dense_data, sparse_data, sparse_indices, sparse_indptr)
 
 
+def sparse_dense_extern(dense_data, sparse_data, sparse_indices, sparse_indptr):
+    """
+    Computes sparse-dense matrix multiplication of `data` and
+    `(weight_data, weight_indices, weight_indptr).T` with an extern kernel looping over the
+    nonzeros of each row of the weight.
+
+    Unlike sparse_dense, the reduction has no data dependent bound, so the kernel lowers through
+    te.create_prim_func and the number of nonzeros may be symbolic.
+
+    Parameters
+    ----------
+    dense_data : tvm.te.Tensor
+        2-D with shape [M, K]
+
+    sparse_data : tvm.te.Tensor
+        1-D with shape [nnz] (CSR) or
+        3-D with shape [num_blocks, bs_r, bs_c] (BSR)
+
+    sparse_indices : tvm.te.Tensor
+        1-D with shape [nnz] (CSR) or
+        1-D with shape [num_blocks] (BSR)
+
+    sparse_indptr : tvm.te.Tensor
+        1-D with shape [N + 1] (CSR) or
+        1-D with shape [N // bs_r + 1] (BSR)
+
+    Returns
+    -------
+    output : tvm.te.Tensor
+        2-D with shape [M, N]
+    """
+    is_csr = len(sparse_data.shape) == 1
+    bs_r, bs_c = (1, 1) if is_csr else sparse_data.shape[1:]
+    num_rows = sparse_indptr.shape[0] - 1
+    oshape = (dense_data.shape[0], num_rows * bs_r)
+
+    def _sparse_dense_ir(dense, data, indices, indptr, out):
+        irb = tvm.tir.ir_builder.create()
+        dense_ptr = irb.buffer_ptr(dense)
+        data_ptr = irb.buffer_ptr(data)
+        indices_ptr = irb.buffer_ptr(indices)
+        indptr_ptr = irb.buffer_ptr(indptr)
+        out_ptr = irb.buffer_ptr(out)
+
+        with irb.for_range(0, num_rows, kind="parallel", name="row") as row:
+            with irb.for_range(0, oshape[0], name="i") as i:
+                with irb.for_range(0, bs_r, name="r") as r:
+                    out_ptr[i, row * bs_r + r] = tvm.tir.const(0, out.dtype)
+                row_start = indptr_ptr[row]
+                with irb.for_range(0, indptr_ptr[row + 1] - row_start, name="idx") as idx:
+                    elem = row_start + idx
+                    col = indices_ptr[elem]
+                    with irb.for_range(0, bs_r, name="r") as r:
+                        with irb.for_range(0, bs_c, name="c") as c:
+                            value = data_ptr[elem] if is_csr else data_ptr[elem, r, c]
+                            out_ptr[i, row * bs_r + r] = (
+                                out_ptr[i, row * bs_r + r] + value * dense_ptr[i, col * bs_c + c]
+                            )
+
+        return irb.get()
+
+    return te.extern(
+        shape=oshape,
+        inputs=[dense_data, sparse_data, sparse_indices, sparse_indptr],
+        fcompute=lambda ins, outs: _sparse_dense_ir(ins[0], ins[1], ins[2], ins[3], outs[0]),
+        tag="sparse_dense_extern",
+        dtype=dense_data.dtype,
+        name="out",
+    )
+
+
 def _sparse_dense_sp_lhs_csrmm(data_data, data_indices, data_indptr, weight):
     oshape = (get_const_tuple(data_indptr.shape)[0] - 1, get_const_tuple(weight.shape)[0])
 
@@ -58,6 +58,7 @@ pub mod map;
 pub mod module;
 pub mod ndarray;
 pub mod object;
+pub mod relax_vm;
 pub mod string;
 mod to_function;
 
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+use std::convert::TryInto;
+
+use crate::{function::Result, ArgValue, Device, DeviceType, Function, Module, NDArray};
+
+/// The allocator the Relax virtual machine allocates the tensors of a device with.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+#[repr(i32)]
+pub enum AllocatorType {
+    /// Allocate and free every tensor on the device.
+    Naive = 1,
+    /// Reuse the freed tensors of the same size.
+    Pooled = 2,
+}
+
+/// An instance of the Relax virtual machine.
+///
+/// The inputs and the preallocated outputs of a call are passed to the VM as they are, so the
+/// tensors already on the device of the VM are aliased instead of copied.
+pub struct RelaxVm {
+    /// The backing virtual machine module which exposes a set of packed functions
+    /// which can be invoked by a client.
+    ///
+    /// In the virtual machine module, every function of the executable is exposed by its name,
+    /// along with invoke_with_outputs.
+    module: Module,
+    /// The functions of the executable looked up so far.
+    functions: std::collections::HashMap<String, Function>,
+}
+
+impl RelaxVm {
+    /// Create a virtual machine running an executable on a device, with the pooled allocator.
+    ///
+    /// The executable is the module built by `relax.vm.build`, e.g. loaded from the library
+    /// exported by `Executable.mod.export_library`.
+    pub fn new(exec: &Module, dev: Device) -> Result<RelaxVm> {
+        Self::with_allocator(exec, dev, AllocatorType::Pooled)
+    }
+
+    /// Create a virtual machine running an executable on a device with an allocator.
+    pub fn with_allocator(
+        exec: &Module,
+        dev: Device,
+        alloc_type: AllocatorType,
+    ) -> Result<RelaxVm> {
+        let load_fn = exec.get_function("vm_load_executable", false)?;
+        let module: Module = load_fn.invoke(vec![])?.try_into()?;
+
+        let mut devices = vec![dev];
+        // The CPU runs the shape functions, so it is always the last device.
+        if dev.device_type != DeviceType::CPU {
+            devices.push(Device::cpu(0));
+        }
+        let mut init_args: Vec<ArgValue> = vec![];
+        for device in devices.iter() {
+            init_args.push((&device.device_type).into());
+            // NOTE you must pass the device id in as i32 because that's what TVM expects
+            init_args.push((device.device_id as i32).into());
+            init_args.push((alloc_type as i32).into());
+        }
+        module
+            .get_function("vm_initialization", false)?
+            .invoke(init_args)?;
+
+        Ok(Self {
+            module,
+            functions: std::collections::HashMap::new(),
+        })
+    }
+
+    fn get_function(&mut self, name: &str) -> Result<&Function> {
+        if !self.functions.contains_key(name) {
+            let function = self.module.get_function(name, false)?;
+            self.functions.insert(name.to_string(), function);
+        }
+        Ok(&self.functions[name])
+    }
+
+    /// Invoke a function returning a single tensor on the inputs.
+    pub fn invoke(&mut self, name: &str, inputs: &[NDArray]) -> Result<NDArray> {
+        let function = self.get_function(name)?;
+        let args: Vec<ArgValue> = inputs.iter().map(|input| input.into()).collect();
+        function.invoke(args)?.try_into()
+    }
+
+    /// Invoke a function on the inputs and write its outputs into the preallocated tensors.
+    ///
+    /// The outputs computed in place, e.g. by the last kernel of the function, take no copy.
+    pub fn invoke_into(
+        &mut self,
+        name: &str,
+        inputs: &[NDArray],
+        outputs: &[NDArray],
+    ) -> Result<()> {
+        let invoke_fn = self.get_function("invoke_with_outputs")?;
+        let mut args: Vec<ArgValue> = vec![name.into()];
+        args.extend(inputs.iter().map(|input| input.into()));
+        args.extend(outputs.iter().map(|output| output.into()));
+        invoke_fn.invoke(args)?;
+        Ok(())
+    }
+}
@@ -21,6 +21,7 @@
  * \file tvm/arith/analyzer.cc
  */
 #include <tvm/arith/analyzer.h>
+#include <tvm/ir/transform.h>
 #include <tvm/runtime/registry.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/op.h>
@@ -28,14 +29,33 @@
 namespace tvm {
 namespace arith {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("arith.simplify_cache_size", Integer);
+
 Analyzer::Analyzer()
     : const_int_bound(this),
       modular_set(this),
       rewrite_simplify(this),
       canonical_simplify(this),
-      int_set(this) {}
+      int_set(this) {
+  Optional<Integer> cache_size =
+      transform::PassContext::Current()->GetConfig<Integer>("arith.simplify_cache_size");
+  if (cache_size.defined() && cache_size.value()->value > 0) {
+    this->EnableSimplifyCache(cache_size.value()->value);
+  }
+}
+
+void Analyzer::EnableSimplifyCache(size_t max_entries) {
+  simplify_cache_capacity_ = max_entries;
+  simplify_cache_.clear();
+}
+
+void Analyzer::InvalidateSimplifyCache() {
+  ++num_bindings_;
+  state_version_ = ++last_version_;
+}
 
 void Analyzer::Bind(const Var& var, const PrimExpr& expr, bool allow_override) {
+  this->InvalidateSimplifyCache();
   PrimExpr new_expr = expr;
   new_expr = this->canonical_simplify(new_expr);
   new_expr = this->rewrite_simplify(new_expr);
@@ -52,6 +72,7 @@ void Analyzer::Bind(const Var& var, const Range& range, bool allow_override) {
   if (tir::is_one(range->extent)) {
     this->Bind(var, range->min, allow_override);
   } else {
+    this->InvalidateSimplifyCache();
     this->const_int_bound.Bind(var, range, allow_override);
     this->int_set.Bind(var, range, allow_override);
   }
@@ -68,6 +89,9 @@ void Analyzer::Bind(const Map<Var, Range>& variables, bool allow_override) {
 void ConstraintContext::EnterWithScope() {
   ICHECK(recovery_functions_.size() == 0);
   // entering the scope.
+  saved_version_ = analyzer_->state_version_;
+  saved_num_bindings_ = analyzer_->num_bindings_;
+  analyzer_->state_version_ = ++analyzer_->last_version_;
   recovery_functions_.push_back(analyzer_->const_int_bound.EnterConstraint(constraint_));
   recovery_functions_.push_back(analyzer_->modular_set.EnterConstraint(constraint_));
   recovery_functions_.push_back(analyzer_->rewrite_simplify.EnterConstraint(constraint_));
@@ -82,6 +106,12 @@ void ConstraintContext::ExitWithScope() {
     }
     recovery_functions_.pop_back();
   }
+  // The state of the enclosing scope is back, unless a binding was made in the scope.
+  if (analyzer_->num_bindings_ == saved_num_bindings_) {
+    analyzer_->state_version_ = saved_version_;
+  } else {
+    analyzer_->InvalidateSimplifyCache();
+  }
 }
 
 bool Analyzer::CanProveGreaterEqual(const PrimExpr& expr, int64_t lower_bound) {
@@ -124,6 +154,28 @@ bool Analyzer::CanProve(const PrimExpr& expr) {
 }
 
 PrimExpr Analyzer::Simplify(const PrimExpr& expr, int steps) {
+  if (simplify_cache_capacity_ == 0 || tir::is_const_int(expr)) {
+    return SimplifyUncached(expr, steps);
+  }
+  SimplifyCacheKey key{expr.get(), steps, state_version_};
+  auto it = simplify_cache_.find(key);
+  if (it != simplify_cache_.end()) {
+    ++simplify_cache_hits;
+    return it->second.result;
+  }
+  ++simplify_cache_misses;
+  PrimExpr res = SimplifyUncached(expr, steps);
+  // The simplifiers bind the variables of the inlined lets, the result holds in the new state.
+  if (state_version_ == key.version) {
+    if (simplify_cache_.size() >= simplify_cache_capacity_) {
+      simplify_cache_.clear();
+    }
+    simplify_cache_.emplace(key, SimplifyCacheEntry{expr, res});
+  }
+  return res;
+}
+
+PrimExpr Analyzer::SimplifyUncached(const PrimExpr& expr, int steps) {
   PrimExpr res = expr;
 
   for (int i = 0; i < steps; ++i) {
@@ -154,6 +206,18 @@ TVM_REGISTER_GLOBAL("arith.CreateAnalyzer").set_body([](TVMArgs args, TVMRetValu
     } else if (name == "const_int_bound_update") {
       return PackedFunc([self](TVMArgs args, TVMRetValue* ret) {
         self->const_int_bound.Update(args[0], args[1], args[2]);
+        self->InvalidateSimplifyCache();
+      });
+    } else if (name == "enable_simplify_cache") {
+      return PackedFunc([self](TVMArgs args, TVMRetValue* ret) {
+        int64_t max_entries = args[0];
+        CHECK_GE(max_entries, 0) << "ValueError: the size of the memo can not be negative";
+        self->EnableSimplifyCache(max_entries);
+      });
+    } else if (name == "simplify_cache_stats") {
+      return PackedFunc([self](TVMArgs args, TVMRetValue* ret) {
+        *ret = Array<Integer>{Integer(self->simplify_cache_hits),
+                              Integer(self->simplify_cache_misses)};
       });
     } else if (name == "Simplify") {
       return PackedFunc([self](TVMArgs args, TVMRetValue* ret) {
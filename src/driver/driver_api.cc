@@ -36,6 +36,9 @@
 #include <mutex>
 #include <stack>
 
+#include "../tir/transforms/ir_utils.h"
+#include "kernel_cache.h"
+
 namespace tvm {
 
 // Register build pipeline related options
@@ -202,6 +205,7 @@ Array<tvm::transform::Pass> CreatePassList(bool disable_loop_partition) {
   pass_list.push_back(tir::transform::CompactBufferAllocation());
   pass_list.push_back(tir::transform::LowerMatchBuffer());
   pass_list.push_back(tir::transform::InjectSoftwarePipeline());
+  pass_list.push_back(tir::transform::InjectSoftwarePrefetch());
   pass_list.push_back(tir::transform::FlattenBuffer());
   pass_list.push_back(tir::transform::LowerVtcmAlloc());
   pass_list.push_back(tir::transform::BF16Legalize());
@@ -449,18 +453,18 @@ runtime::Module TIRToRuntime(const Map<Target, IRModule>& inputs_arg,
       bool overrides_host_target = target->kind->device_type == target_host->kind->device_type;
       bool non_host_target_kind = target->kind != target_host->kind;
       if (overrides_host_target && non_host_target_kind) {
-        device_modules.push_back(codegen::Build(host_mod, it.first));
+        device_modules.push_back(BuildWithKernelCache(host_mod, it.first));
       } else {
         mhost_all->Update(host_mod);
       }
 
       if (device_mod->functions.size() != 0) {
-        device_modules.push_back(codegen::Build(device_mod, it.first));
+        device_modules.push_back(BuildWithKernelCache(device_mod, it.first));
       }
     }
   }
 
-  runtime::Module mhost = codegen::Build(mhost_all, target_host);
+  runtime::Module mhost = BuildWithKernelCache(mhost_all, target_host);
   for (const auto& it : device_modules) {
     if (it.operator->()) {
       mhost.Import(it);
@@ -534,8 +538,12 @@ transform::Sequential MixedModulePassManager(IRModule mixed_mod, Target target)
   mixed_pass_list.push_back(tir::transform::InferFragment());
   mixed_pass_list.push_back(tir::transform::LowerThreadAllreduce());
 
-  bool use_ptx_async_copy =
-      pass_ctx->GetConfig<Bool>("tir.use_ptx_async_copy", Bool(false)).value();
+  // The async copies are available by default on sm_80 and newer, where the software pipelines
+  // with async stages rely on them.
+  bool use_ptx_async_copy = pass_ctx
+                                ->GetConfig<Bool>("tir.use_ptx_async_copy",
+                                                  Bool(tir::TargetHasPTXAsyncCopy(target)))
+                                .value();
 
   if (use_ptx_async_copy) {
     mixed_pass_list.push_back(tir::transform::InjectPTXAsyncCopy());
@@ -0,0 +1,186 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file src/driver/kernel_cache.cc
+ * \brief A persistent cache of the modules built by the code generators.
+ */
+#include "kernel_cache.h"
+
+#include <tvm/ir/transform.h>
+#include <tvm/node/serialization.h>
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/target/codegen.h>
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+#include "../runtime/file_utils.h"
+
+namespace tvm {
+
+TVM_REGISTER_PASS_CONFIG_OPTION("driver.kernel_cache_dir", String);
+
+namespace {
+
+std::atomic<int64_t> num_hits{0};
+std::atomic<int64_t> num_misses{0};
+
+/*! \brief The version of the compiler, which the built modules depend on. */
+const std::string& CompilerVersion() {
+  static const std::string version = []() {
+    std::string version = TVM_VERSION;
+    if (const runtime::PackedFunc* f = runtime::Registry::Get("support.GetLibInfo")) {
+      Map<String, String> info = (*f)();
+      version += " " + info["GIT_COMMIT_HASH"] + " " + info["LLVM_VERSION"];
+    }
+    return version;
+  }();
+  return version;
+}
+
+/*! \brief The format to save a built module in, empty if it cannot be loaded back. */
+std::string CacheFormat(runtime::Module mod) {
+  std::string type_key = mod->type_key();
+  if (type_key == "llvm") {
+    return "ll";
+  } else if (type_key == "cuda") {
+    return mod->GetFormat();
+  }
+  return "";
+}
+
+/*! \brief Rename a file, removing the source if it fails. */
+bool RenameFile(const std::string& from, const std::string& to) {
+  if (std::rename(from.c_str(), to.c_str()) != 0) {
+    std::remove(from.c_str());
+    return false;
+  }
+  return true;
+}
+
+class KernelCache {
+ public:
+  KernelCache(std::string dir, const IRModule& mod, const Target& target) : dir_(dir), mod_(mod) {
+    uint64_t mod_hash = StructuralHash()(mod);
+    std::ostringstream key;
+    key << std::hex << std::setfill('0') << std::setw(16) << mod_hash << "_" << std::setw(16)
+        << static_cast<uint64_t>(
+               std::hash<std::string>()(target->str() + "\n" + CompilerVersion()));
+    path_ = dir_ + "/" + key.str();
+  }
+
+  /*! \brief Load the cached module, nullptr if it is absent. */
+  runtime::Module Load() {
+    // The entry holds the format of the module, then the input it was built from.
+    std::ifstream entry(path_ + ".entry");
+    if (!entry.good()) return runtime::Module();
+    std::string fmt;
+    std::getline(entry, fmt);
+    std::string json((std::istreambuf_iterator<char>(entry)), std::istreambuf_iterator<char>());
+    try {
+      if (!StructuralEqual()(LoadJSON(json), mod_)) {
+        LOG(WARNING) << "The kernel cache entry " << path_ << " is built from another module";
+        return runtime::Module();
+      }
+      return runtime::Module::LoadFromFile(path_ + "." + fmt, fmt);
+    } catch (const std::exception& e) {
+      LOG(WARNING) << "Cannot load the kernel cache entry " << path_ << ": " << e.what();
+    }
+    return runtime::Module();
+  }
+
+  /*! \brief Save a built module, skipping the modules which cannot be loaded back. */
+  void Save(runtime::Module built) {
+    std::string fmt = CacheFormat(built);
+    if (fmt.empty() || !built->imports().empty()) return;
+#ifdef _WIN32
+    _mkdir(dir_.c_str());
+#else
+    mkdir(dir_.c_str(), 0755);
+#endif
+    // Concurrent builds write to their own temporary files, the entry file is renamed last so
+    // that a complete entry is never observed half-written.
+    std::ostringstream tmp;
+    tmp << path_ << ".tmp" << std::hex << std::random_device()();
+    std::string tmp_path = tmp.str();
+    built->SaveToFile(tmp_path + "." + fmt, fmt);
+    std::string tmp_meta = runtime::GetMetaFilePath(tmp_path + "." + fmt);
+    if (std::ifstream(tmp_meta).good() &&
+        !RenameFile(tmp_meta, runtime::GetMetaFilePath(path_ + "." + fmt))) {
+      LOG(WARNING) << "Cannot write the kernel cache entry " << path_;
+      return;
+    }
+    if (!RenameFile(tmp_path + "." + fmt, path_ + "." + fmt)) {
+      LOG(WARNING) << "Cannot write the kernel cache entry " << path_;
+      return;
+    }
+    runtime::SaveBinaryToFile(tmp_path + ".entry", fmt + "\n" + SaveJSON(mod_));
+    if (!RenameFile(tmp_path + ".entry", path_ + ".entry")) {
+      LOG(WARNING) << "Cannot write the kernel cache entry " << path_;
+    }
+  }
+
+ private:
+  std::string dir_;
+  IRModule mod_;
+  /*! \brief The path of the entry without the extension. */
+  std::string path_;
+};
+
+}  // namespace
+
+runtime::Module BuildWithKernelCache(const IRModule& mod, const Target& target) {
+  Optional<String> dir =
+      transform::PassContext::Current()->GetConfig<String>("driver.kernel_cache_dir");
+  if (!dir.defined() || dir.value().empty() || mod->functions.empty()) {
+    return codegen::Build(mod, target);
+  }
+  KernelCache cache(dir.value(), mod, target);
+  runtime::Module cached = cache.Load();
+  if (cached.defined()) {
+    ++num_hits;
+    return cached;
+  }
+  ++num_misses;
+  runtime::Module built = codegen::Build(mod, target);
+  cache.Save(built);
+  return built;
+}
+
+TVM_REGISTER_GLOBAL("driver.kernel_cache_stats").set_body_typed([]() {
+  return Map<String, Integer>{{"hits", Integer(num_hits.load())},
+                              {"misses", Integer(num_misses.load())}};
+});
+
+}  // namespace tvm
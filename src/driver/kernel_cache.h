@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file src/driver/kernel_cache.h
+ * \brief A persistent cache of the modules built by the code generators.
+ */
+#ifndef TVM_DRIVER_KERNEL_CACHE_H_
+#define TVM_DRIVER_KERNEL_CACHE_H_
+
+#include <tvm/ir/module.h>
+#include <tvm/runtime/module.h>
+#include <tvm/target/target.h>
+
+#include <string>
+
+namespace tvm {
+
+/*!
+ * \brief Build a lowered module for a target with codegen::Build, reusing the module built
+ *  from the same input by an earlier build when the kernel cache is enabled.
+ *
+ * The cache is enabled by the "driver.kernel_cache_dir" option of the pass context. Its entries
+ * are content addressed by the structural hash of the lowered module, the target, and the
+ * version of TVM and LLVM, and hold the built module in a format it can be loaded from, e.g.
+ * LLVM IR for llvm modules and PTX for cuda modules. The input is saved alongside and compared
+ * structurally on a hit, so that a hash collision is a miss. The modules which cannot be saved
+ * and loaded back, and the modules with imports, are built every time.
+ *
+ * \param mod The lowered module.
+ * \param target The target.
+ * \return The built module.
+ */
+runtime::Module BuildWithKernelCache(const IRModule& mod, const Target& target);
+
+}  // namespace tvm
+
+#endif  // TVM_DRIVER_KERNEL_CACHE_H_
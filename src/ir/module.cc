@@ -223,13 +223,11 @@ void IRModuleNode::AddUnchecked(const GlobalVar& var, const BaseFunc& func) {
 
   auto it = global_var_map_.find(var->name_hint);
   if (it != global_var_map_.end()) {
-    ICHECK_EQ((*it).second, var);
+    ICHECK_EQ((*it).second, var) << "Duplicate global function name " << PrettyPrint(var);
   } else {
-    ICHECK(global_var_map_.count(var->name_hint) == 0)
-        << "Duplicate global function name " << PrettyPrint(var);
+    // only set the name of a new function, so that updates do not copy a shared name map
+    global_var_map_.Set(var->name_hint, var);
   }
-
-  global_var_map_.Set(var->name_hint, var);
 }
 
 void IRModuleNode::RegisterConstructors(const GlobalTypeVar& var, const TypeData& type) {
@@ -266,6 +264,14 @@ void IRModuleNode::Update(const GlobalVar& var, const BaseFunc& func) {
   this->Add(var, func, true);
 }
 
+void IRModuleNode::UpdateFunctions(const Map<GlobalVar, BaseFunc>& updates) {
+  for (const auto& kv : updates) {
+    auto it = functions.find(kv.first);
+    if (it != functions.end() && (*it).second.same_as(kv.second)) continue;
+    this->Add(kv.first, kv.second, true);
+  }
+}
+
 void IRModuleNode::UpdateTypeDef(const GlobalTypeVar& var, const TypeData& type) {
   this->AddTypeDef(var, type, true);
 }
@@ -387,8 +393,9 @@ void IRModuleNode::Update(const IRModule& mod) {
 }
 
 IRModule IRModuleNode::ShallowCopy() {
-  return IRModule(this->functions, this->type_definitions, this->Imports(), this->source_map,
-                  this->attrs);
+  // copy the node rather than rebuilding the name maps from the functions, the maps are shared
+  // and only copied on the first update of either module.
+  return IRModule(make_object<IRModuleNode>(*this));
 }
 
 std::pair<IRModule, GlobalVar> IRModule::FromExprInContext(
@@ -536,6 +543,11 @@ TVM_REGISTER_GLOBAL("ir.Module_Update").set_body_typed([](IRModule mod, IRModule
 TVM_REGISTER_GLOBAL("ir.Module_UpdateFunction")
     .set_body_typed([](IRModule mod, GlobalVar gv, BaseFunc func) { mod->Update(gv, func); });
 
+TVM_REGISTER_GLOBAL("ir.Module_UpdateFunctions")
+    .set_body_typed([](IRModule mod, Map<GlobalVar, BaseFunc> updates) {
+      mod->UpdateFunctions(updates);
+    });
+
 TVM_REGISTER_GLOBAL("ir.Module_Import").set_body_typed([](IRModule mod, String path) {
   mod->Import(path);
 });
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <tvm/driver/driver_api.h>
+
+#include <mutex>
+#include <unordered_map>
+
+#include "../utils.h"
+
+namespace tvm {
+namespace meta_schedule {
+
+/*!
+ * \brief The built modules kept in memory, each named by an artifact path with the prefix
+ * `kInMemoryArtifactPrefix`, so that they can go through the runner interface as artifacts.
+ */
+class InMemoryArtifactStore {
+ public:
+  static InMemoryArtifactStore* Global() {
+    static InMemoryArtifactStore* inst = new InMemoryArtifactStore();
+    return inst;
+  }
+
+  String Add(runtime::Module mod) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    String path = kInMemoryArtifactPrefix + std::to_string(next_id_++);
+    modules_.emplace(path, std::move(mod));
+    return path;
+  }
+
+  runtime::Module Get(const String& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = modules_.find(path);
+    CHECK(it != modules_.end()) << "ValueError: Unknown in-memory artifact: " << path
+                                << ". It may have been removed, or built in another process";
+    return it->second;
+  }
+
+  void Remove(const String& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    modules_.erase(path);
+  }
+
+  int64_t Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return modules_.size();
+  }
+
+  /*! \brief The prefix of the paths of the in-memory artifacts. */
+  static constexpr const char* kInMemoryArtifactPrefix = "memory://";
+
+ private:
+  std::mutex mutex_;
+  int64_t next_id_ = 0;
+  std::unordered_map<String, runtime::Module> modules_;
+};
+
+/*!
+ * \brief A builder lowering and compiling a batch of candidates on a thread pool of the calling
+ * process, instead of a subprocess per candidate, and keeping the results in memory instead of
+ * exporting them as libraries. Each compilation creates its own LLVM context, so the threads share
+ * no LLVM state. The artifacts can only be run in this process, e.g. by LocalRunner.
+ */
+class InProcessBuilderNode : public BuilderNode {
+ public:
+  /*! \brief The number of threads to build with. */
+  int max_workers;
+
+  void VisitAttrs(tvm::AttrVisitor* v) { v->Visit("max_workers", &max_workers); }
+
+  Array<BuilderResult> Build(const Array<BuilderInput>& build_inputs) final {
+    int n = build_inputs.size();
+    std::vector<Optional<String>> artifact_paths(n, NullOpt);
+    std::vector<Optional<String>> error_msgs(n, NullOpt);
+    auto f_build = [&](int thread_id, int task_id) -> void {
+      const BuilderInput& input = build_inputs[task_id];
+      try {
+        IRModule mod = tir::transform::RemoveWeightLayoutRewriteBlock()(input->mod);
+        Target target = input->target;
+        Target target_host = target->GetHost().value_or(target);
+        runtime::Module rt_mod = tvm::build(mod, target, target_host);
+        artifact_paths[task_id] = InMemoryArtifactStore::Global()->Add(rt_mod);
+      } catch (const std::exception& e) {
+        error_msgs[task_id] = String("InProcessBuilder: An exception occurred\n") + e.what();
+      }
+    };
+    {
+      auto _ = Profiler::TimedScope("InProcessBuilder/build");
+      support::parallel_for_dynamic(0, n, max_workers, f_build);
+    }
+    Array<BuilderResult> results;
+    results.reserve(n);
+    for (int i = 0; i < n; ++i) {
+      results.push_back(BuilderResult(artifact_paths[i], error_msgs[i]));
+    }
+    return results;
+  }
+
+  static constexpr const char* _type_key = "meta_schedule.InProcessBuilder";
+  TVM_DECLARE_FINAL_OBJECT_INFO(InProcessBuilderNode, BuilderNode);
+};
+
+Builder Builder::InProcessBuilder(int max_workers) {
+  CHECK_GT(max_workers, 0) << "ValueError: max_workers must be positive, but got " << max_workers;
+  ObjectPtr<InProcessBuilderNode> n = make_object<InProcessBuilderNode>();
+  n->max_workers = max_workers;
+  return Builder(std::move(n));
+}
+
+TVM_REGISTER_NODE_TYPE(InProcessBuilderNode);
+TVM_REGISTER_GLOBAL("meta_schedule.BuilderInProcessBuilder")
+    .set_body_typed(Builder::InProcessBuilder);
+TVM_REGISTER_GLOBAL("meta_schedule.InMemoryArtifactGet").set_body_typed([](String path) {
+  return InMemoryArtifactStore::Global()->Get(path);
+});
+TVM_REGISTER_GLOBAL("meta_schedule.InMemoryArtifactRemove").set_body_typed([](String path) {
+  InMemoryArtifactStore::Global()->Remove(path);
+});
+TVM_REGISTER_GLOBAL("meta_schedule.InMemoryArtifactSize").set_body_typed([]() {
+  return InMemoryArtifactStore::Global()->Size();
+});
+
+}  // namespace meta_schedule
+}  // namespace tvm
@@ -16,6 +16,11 @@
  * specific language governing permissions and limitations
  * under the License.
  */
+#include <tvm/node/structural_hash.h>
+
+#include <mutex>
+#include <unordered_set>
+
 #include "../utils.h"
 
 namespace tvm {
@@ -37,11 +42,47 @@ Workload::Workload(IRModule mod, Workload::THashCode shash) {
   data_ = std::move(n);
 }
 
+/******** WorkloadRegistry ********/
+
+/*! \brief The table of the workload registry. */
+struct WorkloadTable {
+  std::mutex mutex;
+  std::unordered_set<Workload, WorkloadHash, WorkloadEqual> workloads;
+
+  static WorkloadTable* Global() {
+    static WorkloadTable* table = new WorkloadTable();
+    return table;
+  }
+};
+
+Workload WorkloadRegistry::Intern(const IRModule& mod) {
+  // The cache hashes a module object once, however many databases it is committed to.
+  return Intern(Workload(mod, StructuralHashCache::Global()->Hash(mod)));
+}
+
+Workload WorkloadRegistry::Intern(const Workload& workload) {
+  WorkloadTable* table = WorkloadTable::Global();
+  std::lock_guard<std::mutex> lock(table->mutex);
+  return *table->workloads.insert(workload).first;
+}
+
+int64_t WorkloadRegistry::Size() {
+  WorkloadTable* table = WorkloadTable::Global();
+  std::lock_guard<std::mutex> lock(table->mutex);
+  return table->workloads.size();
+}
+
+void WorkloadRegistry::Clear() {
+  WorkloadTable* table = WorkloadTable::Global();
+  std::lock_guard<std::mutex> lock(table->mutex);
+  table->workloads.clear();
+}
+
 ObjectRef WorkloadNode::AsJSON() const {
-  // Convert `this->mod` to JSON
-  std::string json_mod = tvm::SaveJSON(this->mod);
-  // Dump the JSON string to base64
-  std::string b64_mod = Base64Encode(json_mod);
+  // Convert `this->mod` to the binary format, which is more compact and faster to load than JSON
+  std::string bin_mod = tvm::SaveBinary(this->mod);
+  // Dump the binary string to base64
+  std::string b64_mod = Base64Encode(bin_mod);
   // Output
   return Array<ObjectRef>{SHash2Str(this->shash), String(b64_mod)};
 }
@@ -57,8 +98,9 @@ Workload Workload::FromJSON(const ObjectRef& json_obj) {
     // Load json[1] => mod
     {
       String b64_mod = Downcast<String>(json_array->at(1));
-      std::string json_mod = Base64Decode(b64_mod);
-      mod = Downcast<IRModule>(LoadJSON(json_mod));
+      std::string data = Base64Decode(b64_mod);
+      // The workloads saved before the binary format are JSON
+      mod = Downcast<IRModule>(IsBinaryFormat(data) ? LoadBinary(data) : LoadJSON(data));
     }
     // Verify SHash(mod) == shash
     shash = tvm::StructuralHash()(mod);
@@ -184,6 +226,11 @@ TVM_REGISTER_GLOBAL("meta_schedule.Workload").set_body_typed([](IRModule mod) {
 TVM_REGISTER_GLOBAL("meta_schedule.WorkloadAsJSON")
     .set_body_method<Workload>(&WorkloadNode::AsJSON);
 TVM_REGISTER_GLOBAL("meta_schedule.WorkloadFromJSON").set_body_typed(&Workload::FromJSON);
+TVM_REGISTER_GLOBAL("meta_schedule.WorkloadRegistryIntern").set_body_typed([](IRModule mod) {
+  return WorkloadRegistry::Intern(mod);
+});
+TVM_REGISTER_GLOBAL("meta_schedule.WorkloadRegistrySize").set_body_typed(WorkloadRegistry::Size);
+TVM_REGISTER_GLOBAL("meta_schedule.WorkloadRegistryClear").set_body_typed(WorkloadRegistry::Clear);
 TVM_REGISTER_GLOBAL("meta_schedule.TuningRecord")
     .set_body_typed([](tir::Trace trace, Workload workload, Optional<Array<FloatImm>> run_secs,
                        Optional<Target> target, Optional<Array<ArgInfo>> args_info) {
@@ -56,12 +56,18 @@ class JSONDatabaseNode : public DatabaseNode {
   std::unordered_map<Workload, int, WorkloadHash, WorkloadEqual> workloads2idx_;
   /*! \brief All the tuning records in the database */
   std::multiset<TuningRecord, SortTuningRecordByMeanRunSecs> tuning_records_;
+  /*!
+   * \brief The tuning records of each workload, by the index of the workload, so that GetTopK
+   * only visits the records it returns.
+   */
+  std::vector<std::multiset<TuningRecord, SortTuningRecordByMeanRunSecs>> workload_records_;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("path_workload", &path_workload);
     v->Visit("path_tuning_record", &path_tuning_record);
     // `workloads2idx_` is not visited
     // `tuning_records_` is not visited
+    // `workload_records_` is not visited
   }
 
   static constexpr const char* _type_key = "meta_schedule.JSONDatabase";
@@ -69,7 +75,7 @@ class JSONDatabaseNode : public DatabaseNode {
 
  public:
   bool HasWorkload(const IRModule& mod) {
-    return workloads2idx_.find(Workload(mod, tvm::StructuralHash()(mod))) != workloads2idx_.end();
+    return workloads2idx_.find(WorkloadRegistry::Intern(mod)) != workloads2idx_.end();
   }
 
   Workload CommitWorkload(const IRModule& mod) {
@@ -77,7 +83,7 @@ class JSONDatabaseNode : public DatabaseNode {
     decltype(this->workloads2idx_)::iterator it;
     bool inserted = false;
     std::tie(it, inserted) =
-        this->workloads2idx_.emplace(Workload(mod, tvm::StructuralHash()(mod)), -1);
+        this->workloads2idx_.emplace(WorkloadRegistry::Intern(mod), -1);
     Workload workload = it->first;
     // If `mod` is new in `workloads2idx_`, append it to the workload file
     if (inserted) {
@@ -88,28 +94,41 @@ class JSONDatabaseNode : public DatabaseNode {
   }
 
   void CommitTuningRecord(const TuningRecord& record) {
-    this->tuning_records_.insert(record);
+    int workload_idx = this->workloads2idx_.at(record->workload);
+    this->InsertTuningRecord(workload_idx, record);
     JSONFileAppendLine(this->path_tuning_record,
                        JSONDumps(Array<ObjectRef>{
-                           /*workload_index=*/Integer(this->workloads2idx_.at(record->workload)),
+                           /*workload_index=*/Integer(workload_idx),
                            /*tuning_record=*/record->AsJSON()  //
                        }));
   }
 
+  /*! \brief Insert a tuning record of the workload of the given index into the tables */
+  void InsertTuningRecord(int workload_idx, const TuningRecord& record) {
+    this->tuning_records_.insert(record);
+    if (workload_idx >= static_cast<int>(this->workload_records_.size())) {
+      this->workload_records_.resize(workload_idx + 1);
+    }
+    this->workload_records_[workload_idx].insert(record);
+  }
+
   Array<TuningRecord> GetTopK(const Workload& workload, int top_k) {
     CHECK_GE(top_k, 0) << "ValueError: top_k must be non-negative";
     if (top_k == 0) {
       return {};
     }
+    auto it = this->workloads2idx_.find(workload);
+    if (it == this->workloads2idx_.end() ||
+        it->second >= static_cast<int>(this->workload_records_.size())) {
+      return {};
+    }
+    const auto& records = this->workload_records_[it->second];
     Array<TuningRecord> results;
-    results.reserve(top_k);
-    int counter = 0;
-    for (const TuningRecord& record : this->tuning_records_) {
-      if (WorkloadEqual()(record->workload, workload)) {
-        results.push_back(record);
-        if (++counter == top_k) {
-          break;
-        }
+    results.reserve(std::min<size_t>(top_k, records.size()));
+    for (const TuningRecord& record : records) {
+      results.push_back(record);
+      if (static_cast<int>(results.size()) == top_k) {
+        break;
       }
     }
     return results;
@@ -139,7 +158,7 @@ Database Database::JSONDatabase(String path_workload, String path_tuning_record,
     n->workloads2idx_.reserve(n_objs);
     workloads.reserve(n_objs);
     for (int i = 0; i < n_objs; ++i) {
-      Workload workload = Workload::FromJSON(json_objs[i]);
+      Workload workload = WorkloadRegistry::Intern(Workload::FromJSON(json_objs[i]));
       n->workloads2idx_.emplace(workload, i);
       workloads.push_back(workload);
     }
@@ -148,6 +167,7 @@ Database Database::JSONDatabase(String path_workload, String path_tuning_record,
   {
     std::vector<ObjectRef> json_objs =
         JSONFileReadLines(path_tuning_record, num_threads, allow_missing);
+    std::vector<int> workload_idxs(json_objs.size(), -1);
     std::vector<TuningRecord> records;
     records.resize(json_objs.size(), TuningRecord{nullptr});
     support::parallel_for_dynamic(
@@ -157,7 +177,8 @@ Database Database::JSONDatabase(String path_workload, String path_tuning_record,
           try {
             const ArrayNode* arr = json_obj.as<ArrayNode>();
             ICHECK_EQ(arr->size(), 2);
-            workload = workloads[Downcast<Integer>(arr->at(0)).IntValue()];
+            workload_idxs[task_id] = Downcast<Integer>(arr->at(0)).IntValue();
+            workload = workloads[workload_idxs[task_id]];
             records[task_id] = TuningRecord::FromJSON(arr->at(1), workload);
           } catch (std::runtime_error& e) {
             LOG(FATAL) << "ValueError: Unable to parse TuningRecord, on line " << (task_id + 1)
@@ -168,8 +189,9 @@ Database Database::JSONDatabase(String path_workload, String path_tuning_record,
                        << e.what();
           }
         });
-    for (const TuningRecord& record : records) {
-      n->tuning_records_.insert(record);
+    n->workload_records_.resize(workloads.size());
+    for (int i = 0, n_records = records.size(); i < n_records; ++i) {
+      n->InsertTuningRecord(workload_idxs[i], records[i]);
     }
   }
   n->path_workload = path_workload;
@@ -21,6 +21,48 @@
 namespace tvm {
 namespace meta_schedule {
 
+Array<tvm::runtime::NDArray> FeatureExtractorNode::ExtractBatchedFrom(
+    const TuneContext& context, const Array<MeasureCandidate>& candidates) {
+  Array<tvm::runtime::NDArray> features = this->ExtractFrom(context, candidates);
+  ICHECK_EQ(features.size(), candidates.size());
+  int n = features.size();
+  int64_t num_rows = 0;
+  int64_t row_len = -1;
+  for (const tvm::runtime::NDArray& feature : features) {
+    ICHECK_EQ(feature->ndim, 2) << "ValueError: Expect 2-dimensional features";
+    ICHECK(feature->dtype.code == kDLFloat && feature->dtype.lanes == 1 &&
+           (feature->dtype.bits == 32 || feature->dtype.bits == 64))
+        << "ValueError: Expect float32 or float64 features";
+    if (row_len == -1) {
+      row_len = feature->shape[1];
+    }
+    ICHECK_EQ(feature->shape[1], row_len) << "ValueError: Features are of different lengths";
+    num_rows += feature->shape[0];
+  }
+  tvm::runtime::NDArray matrix = tvm::runtime::NDArray::Empty(
+      {num_rows, std::max<int64_t>(row_len, 0)}, DLDataType{kDLFloat, 32, 1}, {kDLCPU, 0});
+  tvm::runtime::NDArray row_offsets =
+      tvm::runtime::NDArray::Empty({n + 1}, DLDataType{kDLInt, 64, 1}, {kDLCPU, 0});
+  float* dst = static_cast<float*>(matrix->data);
+  int64_t* offsets = static_cast<int64_t*>(row_offsets->data);
+  offsets[0] = 0;
+  for (int i = 0; i < n; ++i) {
+    tvm::runtime::NDArray feature = features[i];
+    if (feature->device.device_type != kDLCPU) {
+      feature = feature.CopyTo({kDLCPU, 0});
+    }
+    int64_t size = feature->shape[0] * feature->shape[1];
+    if (feature->dtype.bits == 32) {
+      std::copy_n(static_cast<const float*>(feature->data), size, dst);
+    } else {
+      std::copy_n(static_cast<const double*>(feature->data), size, dst);
+    }
+    dst += size;
+    offsets[i + 1] = offsets[i] + feature->shape[0];
+  }
+  return {matrix, row_offsets};
+}
+
 Array<tvm::runtime::NDArray> PyFeatureExtractorNode::ExtractFrom(
     const TuneContext& context, const Array<MeasureCandidate>& candidates) {
   ICHECK(f_extract_from != nullptr) << "PyFeatureExtractor's ExtractFrom method not implemented!";
@@ -50,6 +92,8 @@ TVM_REGISTER_NODE_TYPE(PyFeatureExtractorNode);
 
 TVM_REGISTER_GLOBAL("meta_schedule.FeatureExtractorExtractFrom")
     .set_body_method<FeatureExtractor>(&FeatureExtractorNode::ExtractFrom);
+TVM_REGISTER_GLOBAL("meta_schedule.FeatureExtractorExtractBatchedFrom")
+    .set_body_method<FeatureExtractor>(&FeatureExtractorNode::ExtractBatchedFrom);
 TVM_REGISTER_GLOBAL("meta_schedule.FeatureExtractorPyFeatureExtractor")
     .set_body_typed(FeatureExtractor::PyFeatureExtractor);
 
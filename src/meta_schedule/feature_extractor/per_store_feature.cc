@@ -19,7 +19,9 @@
 #include <tvm/tir/transform.h>
 
 #include <cmath>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <string>
 #include <unordered_map>
@@ -215,25 +217,32 @@ int64_t GetVarStride(const std::vector<MultiIndex>& multi_indices, const IntVec&
 }
 
 /*!
- * \brief Converts a 2-dimensional STL vector to a TVM NDArray
- * \param src The source 2-dimensional STL vector
- * \return The converted TVM NDArray
+ * \brief Copies the rows of a row-major feature matrix, appending the same suffix to each row
+ * \param src The source matrix, whose rows are of length `row_len`
+ * \param row_len The length of the source rows
+ * \param suffix The features appended to each row
+ * \param dst The destination, whose rows are of length `row_len + suffix.size()`
+ * \return The end of the destination rows
  */
-runtime::NDArray AsNDArray(const std::vector<std::vector<double>>& src) {
-  ICHECK(!src.empty());
-  int n = src.size();
-  int m = src[0].size();
-  runtime::NDArray tgt = runtime::NDArray::Empty(
-      /*shape=*/{n, m},
-      /*dtype=*/DLDataType{kDLFloat, 64, 1},
-      /*ctx=*/DLDevice{kDLCPU, 0});
-  double* data = static_cast<double*>(tgt->data);
-  for (const std::vector<double>& row : src) {
-    for (double v : row) {
-      *data++ = v;
+template <class T>
+T* CopyRows(const std::vector<double>& src, int row_len, const std::vector<double>& suffix,
+            T* dst) {
+  int suffix_len = suffix.size();
+  int n_rows = src.size() / row_len;
+  const double* src_row = src.data();
+  const double* suffix_data = suffix.data();
+  // Plain loops over contiguous memory without branches, so that they are vectorized
+  for (int i = 0; i < n_rows; ++i, src_row += row_len) {
+    for (int j = 0; j < row_len; ++j) {
+      dst[j] = static_cast<T>(src_row[j]);
     }
+    dst += row_len;
+    for (int j = 0; j < suffix_len; ++j) {
+      dst[j] = static_cast<T>(suffix_data[j]);
+    }
+    dst += suffix_len;
   }
-  return tgt;
+  return dst;
 }
 
 }  // namespace utils
@@ -1344,70 +1353,182 @@ class PerStoreFeatureNode : public FeatureExtractorNode {
   int arith_intensity_curve_num_samples;
   int cache_line_bytes;
   bool extract_workload;
+  int feature_cache_size;
   int feature_vector_length;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     v->Visit("buffers_per_store", &buffers_per_store);
     v->Visit("arith_intensity_curve_num_samples", &arith_intensity_curve_num_samples);
     v->Visit("cache_line_bytes", &cache_line_bytes);
+    v->Visit("feature_cache_size", &feature_cache_size);
     v->Visit("feature_vector_length", &feature_vector_length);
   }
 
-  void ExtractSingle(IRModule mod, bool is_gpu, std::vector<std::vector<double>>* results) {
+  /*! \brief The features of a candidate without the workload ones, as a row-major matrix */
+  using CandidateFeature = std::shared_ptr<const std::vector<double>>;
+
+  /*! \brief The length of the features extracted from a candidate itself */
+  int CandidateFeatureLength() const {
+    return extract_workload ? feature_vector_length - tir::group6::Feature::kCount
+                            : feature_vector_length;
+  }
+
+  void ExtractSingle(IRModule mod, bool is_gpu, std::vector<double>* results) {
     static transform::Sequential passes = tir::transform::PassListForPerStoreFeature();
     mod = passes(std::move(mod));
     std::vector<tir::Feature> features = tir::PerStoreFeatureCollector::Collect(
         is_gpu, this->cache_line_bytes, this->arith_intensity_curve_num_samples, mod);
-    int n_features = features.size();
-    results->resize(n_features);
-    for (int i = 0; i < n_features; ++i) {
-      const tir::Feature& feature = features[i];
-      std::vector<double>& result = (*results)[i];
-      result.reserve(feature_vector_length);
-      feature.group1->Export(&result);
-      feature.group2->Export(&result, this->buffers_per_store);
-      feature.group3->Export(&result);
-      feature.group4->Export(&result, feature.group5->outer_prod);
-      feature.group5->Export(&result);
+    results->clear();
+    results->reserve(features.size() * CandidateFeatureLength());
+    for (const tir::Feature& feature : features) {
+      feature.group1->Export(results);
+      feature.group2->Export(results, this->buffers_per_store);
+      feature.group3->Export(results);
+      feature.group4->Export(results, feature.group5->outer_prod);
+      feature.group5->Export(results);
     }
+    ICHECK_EQ(results->size(), features.size() * CandidateFeatureLength());
   }
 
-  Array<runtime::NDArray> ExtractFrom(const TuneContext& tune_context,
-                                      const Array<MeasureCandidate>& candidates) {
+  /*!
+   * \brief Extract the features of the candidates, only once for each group of structurally
+   * equal candidates, and reusing the cached ones
+   */
+  std::vector<CandidateFeature> ExtractCandidates(const TuneContext& tune_context,
+                                                  const Array<MeasureCandidate>& candidates) {
     bool is_gpu = tune_context->target.value()->kind->name == "cuda";
-    std::vector<runtime::NDArray> results;
-    results.resize(candidates.size());
-    std::unique_ptr<tir::group6::Feature> feature_group6 = nullptr;
-    if (extract_workload) {
-      feature_group6 = std::make_unique<tir::group6::Feature>(tune_context->mod.value());
-    }
-    auto f = [this, is_gpu, &feature_group6, &candidates, &results](int, int task_id) -> void {
-      const auto& candidate = candidates[task_id];
-      std::vector<std::vector<double>> features;
-      ExtractSingle(DeepCopyIRModule(candidate->sch->mod()), is_gpu, &features);
-      if (extract_workload) {
-        for (auto& feature : features) {
-          feature_group6->Export(&feature);
+    int n = candidates.size();
+    std::vector<CandidateFeature> results(n, nullptr);
+    std::vector<size_t> shashes(n);
+    // The index of the first candidate structurally equal to each candidate
+    std::vector<int> sources(n);
+    std::vector<int> to_extract;
+    // Step 1. Deduplicate the candidates, and look up the cache
+    {
+      IRModuleMap<int> first_occurrences;
+      std::lock_guard<std::mutex> lock(cache_mutex_);
+      for (int i = 0; i < n; ++i) {
+        IRModule mod = candidates[i]->sch->mod();
+        shashes[i] = StructuralHash()(mod);
+        if (const int* first = first_occurrences.Find(mod, shashes[i])) {
+          sources[i] = *first;
+          continue;
+        }
+        first_occurrences.Set(mod, shashes[i], i);
+        sources[i] = i;
+        if (const CandidateFeature* cached = cache_.Find(mod, shashes[i])) {
+          results[i] = *cached;
+        } else {
+          to_extract.push_back(i);
         }
       }
-      results[task_id] = tir::utils::AsNDArray(features);
+    }
+    // Step 2. Extract the features of the rest
+    auto f = [this, is_gpu, &candidates, &to_extract, &results](int, int task_id) -> void {
+      int i = to_extract[task_id];
+      auto feature = std::make_shared<std::vector<double>>();
+      ExtractSingle(DeepCopyIRModule(candidates[i]->sch->mod()), is_gpu, feature.get());
+      results[i] = std::move(feature);
     };
-    support::parallel_for_dynamic(0, candidates.size(), tune_context->num_threads, f);
+    support::parallel_for_dynamic(0, to_extract.size(), tune_context->num_threads, f);
+    // Step 3. Cache the newly extracted features, evicting the oldest ones
+    if (feature_cache_size > 0) {
+      std::lock_guard<std::mutex> lock(cache_mutex_);
+      for (int i : to_extract) {
+        IRModule mod = candidates[i]->sch->mod();
+        if (cache_.Find(mod, shashes[i]) != nullptr) {
+          continue;
+        }
+        cache_.Set(mod, shashes[i], results[i]);
+        cache_order_.push_back(IRModuleKey{mod, shashes[i]});
+        while (static_cast<int>(cache_order_.size()) > feature_cache_size) {
+          cache_.Erase(cache_order_.front().mod, cache_order_.front().shash);
+          cache_order_.pop_front();
+        }
+      }
+    }
+    for (int i = 0; i < n; ++i) {
+      results[i] = results[sources[i]];
+    }
     return results;
   }
 
+  /*! \brief The workload features appended to each feature vector, if any */
+  std::vector<double> WorkloadFeature(const TuneContext& tune_context) {
+    std::vector<double> result;
+    if (extract_workload) {
+      tir::group6::Feature(tune_context->mod.value()).Export(&result);
+    }
+    return result;
+  }
+
+  Array<runtime::NDArray> ExtractFrom(const TuneContext& tune_context,
+                                      const Array<MeasureCandidate>& candidates) final {
+    std::vector<double> workload = WorkloadFeature(tune_context);
+    std::vector<CandidateFeature> features = ExtractCandidates(tune_context, candidates);
+    int row_len = CandidateFeatureLength();
+    Array<runtime::NDArray> results;
+    results.reserve(features.size());
+    for (const CandidateFeature& feature : features) {
+      int64_t n_rows = feature->size() / row_len;
+      runtime::NDArray result = runtime::NDArray::Empty(
+          /*shape=*/{n_rows, feature_vector_length},
+          /*dtype=*/DLDataType{kDLFloat, 64, 1},
+          /*ctx=*/DLDevice{kDLCPU, 0});
+      tir::utils::CopyRows(*feature, row_len, workload, static_cast<double*>(result->data));
+      results.push_back(result);
+    }
+    return results;
+  }
+
+  Array<runtime::NDArray> ExtractBatchedFrom(const TuneContext& tune_context,
+                                             const Array<MeasureCandidate>& candidates) final {
+    std::vector<double> workload = WorkloadFeature(tune_context);
+    std::vector<CandidateFeature> features = ExtractCandidates(tune_context, candidates);
+    int n = features.size();
+    int row_len = CandidateFeatureLength();
+    runtime::NDArray row_offsets = runtime::NDArray::Empty(
+        /*shape=*/{n + 1},
+        /*dtype=*/DLDataType{kDLInt, 64, 1},
+        /*ctx=*/DLDevice{kDLCPU, 0});
+    int64_t* offsets = static_cast<int64_t*>(row_offsets->data);
+    offsets[0] = 0;
+    for (int i = 0; i < n; ++i) {
+      offsets[i + 1] = offsets[i] + static_cast<int64_t>(features[i]->size() / row_len);
+    }
+    runtime::NDArray matrix = runtime::NDArray::Empty(
+        /*shape=*/{offsets[n], feature_vector_length},
+        /*dtype=*/DLDataType{kDLFloat, 32, 1},
+        /*ctx=*/DLDevice{kDLCPU, 0});
+    float* dst = static_cast<float*>(matrix->data);
+    for (const CandidateFeature& feature : features) {
+      dst = tir::utils::CopyRows(*feature, row_len, workload, dst);
+    }
+    return {matrix, row_offsets};
+  }
+
   static constexpr const char* _type_key = "meta_schedule.PerStoreFeature";
   TVM_DECLARE_FINAL_OBJECT_INFO(PerStoreFeatureNode, FeatureExtractorNode);
+
+ private:
+  /*! \brief The features of the deduplicated candidates extracted before */
+  IRModuleMap<CandidateFeature> cache_;
+  /*! \brief The candidates in the cache, from the oldest to the newest */
+  std::deque<IRModuleKey> cache_order_;
+  /*! \brief The mutex guarding the cache */
+  std::mutex cache_mutex_;
 };
 
 FeatureExtractor FeatureExtractor::PerStoreFeature(int buffers_per_store,
                                                    int arith_intensity_curve_num_samples,
-                                                   int cache_line_bytes, bool extract_workload) {
+                                                   int cache_line_bytes, bool extract_workload,
+                                                   int feature_cache_size) {
   ObjectPtr<PerStoreFeatureNode> n = make_object<PerStoreFeatureNode>();
   n->buffers_per_store = buffers_per_store;
   n->arith_intensity_curve_num_samples = arith_intensity_curve_num_samples;
   n->cache_line_bytes = cache_line_bytes;
   n->extract_workload = extract_workload;
+  n->feature_cache_size = feature_cache_size;
   n->feature_vector_length = tir::group1::Feature::kCount +                                  //
                              tir::group2::Feature::SubFeature::kCount * buffers_per_store +  //
                              arith_intensity_curve_num_samples +                             //
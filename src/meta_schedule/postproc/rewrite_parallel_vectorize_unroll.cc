@@ -16,6 +16,7 @@
  * specific language governing permissions and limitations
  * under the License.
  */
+#include "../../tir/transforms/ir_utils.h"
 #include "../utils.h"
 
 namespace tvm {
@@ -145,7 +146,8 @@ void RemoveParsedAnn(const Schedule& sch, const BlockRV& block_rv, const ParsedA
 }
 
 void AdjustParallelVectorize(const Schedule& sch, const BlockRV& block_rv,
-                             const Array<LoopRV>& loop_rvs, ParsedAnnotation* parsed) {
+                             const Array<LoopRV>& loop_rvs, bool scalable_vectors,
+                             ParsedAnnotation* parsed) {
   StmtSRef block_sref = sch->GetSRef(block_rv);
   if (parsed->max_parallel_extent == -1 && parsed->max_vectorize_extent == -1) {
     return;
@@ -279,9 +281,10 @@ void AdjustParallelVectorize(const Schedule& sch, const BlockRV& block_rv,
       if (extent == nullptr) {
         break;
       }
-      // Check if the extent is still in a good range
+      // Check if the extent is still in a good range. A vector-length-agnostic loop runs any
+      // number of iterations without wasting lanes, so it is only limited by the contiguity.
       prod_extent *= *extent;
-      if (prod_extent > max_extent) {
+      if (prod_extent > max_extent && !scalable_vectors) {
         break;
       }
       ++num_fusible;
@@ -323,11 +326,17 @@ void RewriteParallel(const Schedule& sch, size_t n, Array<LoopRV>* loop_rvs) {
   }
 }
 
-void RewriteVectorize(const Schedule& sch, size_t n, Array<LoopRV>* loop_rvs) {
+void RewriteVectorize(const Schedule& sch, size_t n, bool scalable_vectors,
+                      Array<LoopRV>* loop_rvs) {
   size_t n_loops = loop_rvs->size();
   ICHECK_LE(n, n_loops);
   LoopRV fused = sch->Fuse({loop_rvs->end() - n, loop_rvs->end()});
-  sch->Vectorize(fused);
+  if (scalable_vectors) {
+    // Leaving the loop to the backend, which vectorizes it with scalable vectors.
+    sch->Annotate(fused, attr::pragma_scalable_vectorize, Integer(1));
+  } else {
+    sch->Vectorize(fused);
+  }
   for (size_t i = n_loops - n; i < n_loops; ++i) {
     loop_rvs->Set(i, fused);
   }
@@ -348,7 +357,11 @@ using tir::Schedule;
 
 class RewriteParallelVectorizeUnrollNode : public PostprocNode {
  public:
-  void InitializeWithTuneContext(const TuneContext& context) final {}
+  void InitializeWithTuneContext(const TuneContext& context) final {
+    if (context->target.defined()) {
+      this->scalable_vectors_ = tir::TargetHasScalableVectors(context->target.value());
+    }
+  }
 
   bool Apply(const Schedule& sch) final {
     tir::ParsedAnnotation parsed_root;
@@ -360,14 +373,14 @@ class RewriteParallelVectorizeUnrollNode : public PostprocNode {
           continue;
         }
         tir::ParsedAnnotation parsed = parsed_root;
-        tir::AdjustParallelVectorize(sch, block_rv, loop_rvs, &parsed);
+        tir::AdjustParallelVectorize(sch, block_rv, loop_rvs, scalable_vectors_, &parsed);
         // Parallel
         if (parsed.num_parallel_loops > 0) {
           tir::RewriteParallel(sch, parsed.num_parallel_loops, &loop_rvs);
         }
         // Vectorize
         if (parsed.num_vectorize_loops > 0) {
-          tir::RewriteVectorize(sch, parsed.num_vectorize_loops, &loop_rvs);
+          tir::RewriteVectorize(sch, parsed.num_vectorize_loops, scalable_vectors_, &loop_rvs);
         }
         // AutoUnroll
         if (parsed.unroll_explicit != -1 || parsed.unroll_implicit != -1) {
@@ -383,6 +396,10 @@ class RewriteParallelVectorizeUnrollNode : public PostprocNode {
 
   static constexpr const char* _type_key = "meta_schedule.RewriteParallelVectorizeUnroll";
   TVM_DECLARE_FINAL_OBJECT_INFO(RewriteParallelVectorizeUnrollNode, PostprocNode);
+
+ private:
+  /*! \brief Whether the target has scalable vectors, whose loops are vector-length agnostic. */
+  bool scalable_vectors_{false};
 };
 
 Postproc Postproc::RewriteParallelVectorizeUnroll() {
@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "../utils.h"
+#include "../../tir/transforms/ir_utils.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace tir {
+
+/*! \brief The visitor that finds the loops whose global to shared memory copies can be pipelined */
+class SoftwarePipelineLoopFinder : private StmtVisitor {
+ public:
+  /*! \brief A loop to be pipelined */
+  struct Candidate {
+    /*! \brief The loop to be pipelined */
+    StmtSRef loop_sref;
+    /*! \brief A block under the loop, used to retrieve the loop in the schedule */
+    StmtSRef block_sref;
+    /*! \brief The name of the function the loop is in */
+    String global_var_name;
+    /*! \brief The number of the copy statements at the beginning of the loop body */
+    int num_copies;
+  };
+
+  static std::vector<Candidate> Find(const ScheduleState& self) {
+    std::vector<Candidate> results;
+    for (const auto& kv : self->mod->functions) {
+      if (const auto* prim_func = kv.second.as<PrimFuncNode>()) {
+        SoftwarePipelineLoopFinder finder(self, kv.first->name_hint, &results);
+        finder(prim_func->body);
+      }
+    }
+    return results;
+  }
+
+ private:
+  explicit SoftwarePipelineLoopFinder(const ScheduleState& self, String global_var_name,
+                                      std::vector<Candidate>* results)
+      : self_(self), global_var_name_(global_var_name), results_(results) {}
+
+  void VisitStmt_(const ForNode* loop) final {
+    const auto* extent = loop->extent.as<IntImmNode>();
+    bool annotated = loop->annotations.count(attr::software_pipeline_stage) ||
+                     loop->annotations.count(attr::software_pipeline_order);
+    if (annotated) {
+      return;
+    }
+    if (loop->kind == ForKind::kSerial && extent != nullptr && extent->value > 1) {
+      if (const auto* seq = loop->body.as<SeqStmtNode>()) {
+        int n = seq->seq.size();
+        std::unordered_set<const BufferNode*> shared_buffers;
+        int num_copies = 0;
+        while (num_copies < n - 1 && IsCopyToShared(seq->seq[num_copies], &shared_buffers)) {
+          ++num_copies;
+        }
+        const BlockNode* consumer = nullptr;
+        if (num_copies > 0 && num_copies == n - 1 &&
+            ReadsBuffers(seq->seq[n - 1], shared_buffers, &consumer)) {
+          results_->push_back(Candidate{self_->stmt2ref.at(loop), self_->stmt2ref.at(consumer),
+                                        global_var_name_, num_copies});
+          return;
+        }
+      }
+    }
+    StmtVisitor::VisitStmt_(loop);
+  }
+
+  /*!
+   * \brief Check if a statement only contains blocks directly copying global memory to shared
+   *  memory, and collect the shared memory buffers written.
+   */
+  static bool IsCopyToShared(const Stmt& stmt,
+                             std::unordered_set<const BufferNode*>* shared_buffers) {
+    bool is_copy = true;
+    int num_blocks = 0;
+    PreOrderVisit(stmt, [&](const ObjectRef& obj) -> bool {
+      if (!is_copy) {
+        return false;
+      }
+      const auto* block = obj.as<BlockNode>();
+      if (block == nullptr) {
+        return true;
+      }
+      ++num_blocks;
+      const auto* store = block->body.as<BufferStoreNode>();
+      const auto* load = store ? store->value.as<BufferLoadNode>() : nullptr;
+      if (load == nullptr || block->writes.size() != 1 || block->reads.size() != 1) {
+        is_copy = false;
+        return false;
+      }
+      String dst_scope = store->buffer.scope();
+      if ((dst_scope != "shared" && dst_scope != "shared.dyn") ||
+          load->buffer.scope() != "global") {
+        is_copy = false;
+        return false;
+      }
+      shared_buffers->insert(store->buffer.get());
+      return false;
+    });
+    return is_copy && num_blocks > 0;
+  }
+
+  /*! \brief Check if a statement reads any of the buffers, and find a block in it */
+  static bool ReadsBuffers(const Stmt& stmt, const std::unordered_set<const BufferNode*>& buffers,
+                           const BlockNode** block) {
+    bool reads = false;
+    PreOrderVisit(stmt, [&](const ObjectRef& obj) -> bool {
+      if (const auto* node = obj.as<BlockNode>()) {
+        if (*block == nullptr) {
+          *block = node;
+        }
+        for (const BufferRegion& read : node->reads) {
+          reads = reads || buffers.count(read->buffer.get());
+        }
+      }
+      return true;
+    });
+    return reads && *block != nullptr;
+  }
+
+  /*! \brief The schedule state */
+  const ScheduleState& self_;
+  /*! \brief The name of the function being visited */
+  String global_var_name_;
+  /*! \brief The results of the collection */
+  std::vector<Candidate>* results_;
+};
+
+}  // namespace tir
+
+namespace meta_schedule {
+
+/*!
+ * \brief Pipeline the global to shared memory copies of the loops with the async copies on
+ *  sm_80 and newer, so that the copies of the next iteration overlap with the computation.
+ */
+class RewriteSoftwarePipelineNode : public PostprocNode {
+ public:
+  // Inherited from PostprocNode
+  void InitializeWithTuneContext(const TuneContext& context) final {
+    if (context->target.defined()) {
+      this->enabled_ = tir::TargetHasPTXAsyncCopy(context->target.value());
+    }
+  }
+  // Inherited from PostprocNode
+  bool Apply(const tir::Schedule& sch) final;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {}
+
+  /*! \brief Whether the target has the async copies */
+  bool enabled_ = false;
+
+  static constexpr const char* _type_key = "meta_schedule.RewriteSoftwarePipeline";
+  TVM_DECLARE_FINAL_OBJECT_INFO(RewriteSoftwarePipelineNode, PostprocNode);
+};
+
+bool RewriteSoftwarePipelineNode::Apply(const tir::Schedule& sch) {
+  if (!enabled_) {
+    return true;
+  }
+  using tir::LoopRV;
+  for (const auto& candidate : tir::SoftwarePipelineLoopFinder::Find(sch->state())) {
+    tir::BlockRV block_rv = GetRVFromSRef(sch, candidate.block_sref, candidate.global_var_name);
+    for (const LoopRV& loop_rv : sch->GetLoops(block_rv)) {
+      if (!sch->GetSRef(loop_rv).same_as(candidate.loop_sref)) {
+        continue;
+      }
+      // The copies are in the async stage 0, and the consumer reads them one iteration later.
+      Array<Integer> stages(candidate.num_copies, Integer(0));
+      Array<Integer> orders;
+      stages.push_back(Integer(1));
+      for (int i = 0; i <= candidate.num_copies; ++i) {
+        orders.push_back(Integer(i));
+      }
+      sch->Annotate(loop_rv, tir::attr::software_pipeline_stage, stages);
+      sch->Annotate(loop_rv, tir::attr::software_pipeline_order, orders);
+      sch->Annotate(loop_rv, tir::attr::software_pipeline_async_stages,
+                    Array<Integer>{Integer(0)});
+      break;
+    }
+  }
+  return true;
+}
+
+Postproc Postproc::RewriteSoftwarePipeline() {
+  ObjectPtr<RewriteSoftwarePipelineNode> n = make_object<RewriteSoftwarePipelineNode>();
+  return Postproc(n);
+}
+
+TVM_REGISTER_NODE_TYPE(RewriteSoftwarePipelineNode);
+TVM_REGISTER_GLOBAL("meta_schedule.PostprocRewriteSoftwarePipeline")
+    .set_body_typed(Postproc::RewriteSoftwarePipeline);
+
+}  // namespace meta_schedule
+}  // namespace tvm
@@ -23,12 +23,20 @@
 namespace tvm {
 namespace tir {
 
+/*!
+ * \brief Check the thread extents of the scheduled TIR before it is lowered, rejecting the
+ * candidates which can be told invalid from their thread bindings and annotations alone.
+ *
+ * The threads of a loop nest all run in the same thread block, so the product of the extents of
+ * the threadIdx loops enclosing a statement is a lower bound of the threads per block of its
+ * kernel, which the lowering passes do not decrease.
+ */
 class ThreadExtentChecker : private StmtVisitor {
  public:
-  static bool Check(const Stmt& stmt, int thread_warp_size) {
+  static bool Check(const Stmt& stmt, int thread_warp_size, int64_t max_threads_per_block) {
     try {
       ICHECK(thread_warp_size > 0);
-      ThreadExtentChecker checker(thread_warp_size);
+      ThreadExtentChecker checker(thread_warp_size, max_threads_per_block);
       checker.VisitStmt(stmt);
       return true;
     } catch (const dmlc::Error& e) {
@@ -37,13 +45,21 @@ class ThreadExtentChecker : private StmtVisitor {
   }
 
  private:
-  explicit ThreadExtentChecker(int thread_warp_size) : thread_warp_size_(thread_warp_size) {}
+  explicit ThreadExtentChecker(int thread_warp_size, int64_t max_threads_per_block)
+      : thread_warp_size_(thread_warp_size), max_threads_per_block_(max_threads_per_block) {}
 
   void VisitStmt_(const ForNode* loop) {
     runtime::ThreadScope thread_scope = GetThreadScope(loop);
     if (IsThreadIdx(thread_scope)) {
       if (const int64_t* p_ext = GetLoopIntExtent(loop)) {
         int64_t ext = *p_ext;
+        int64_t threads = ext;
+        threads *= thread_scope.dim_index == 0 ? 1 : thread_idx_x;
+        threads *= thread_scope.dim_index == 1 ? 1 : thread_idx_y;
+        threads *= thread_scope.dim_index == 2 ? 1 : thread_idx_z;
+        if (threads > max_threads_per_block_) {
+          throw dmlc::Error("Threads per block");
+        }
         if (thread_scope.dim_index == 0) {
           std::swap(thread_idx_x, ext);
           StmtVisitor::VisitStmt_(loop);
@@ -92,6 +108,7 @@ class ThreadExtentChecker : private StmtVisitor {
   int64_t thread_idx_y = 1;
   int64_t thread_idx_z = 1;
   int thread_warp_size_ = -1;
+  int64_t max_threads_per_block_ = -1;
 };
 
 }  // namespace tir
@@ -115,6 +132,7 @@ class VerifyGPUCodeNode : public PostprocNode {
  public:
   Map<String, PrimExpr> target_constraints_{nullptr};
   int thread_warp_size_ = -1;
+  int64_t max_threads_per_block_ = -1;
 
   void InitializeWithTuneContext(const TuneContext& context) final {
     ICHECK(context->target.defined());
@@ -126,6 +144,7 @@ class VerifyGPUCodeNode : public PostprocNode {
         {"max_vector_bytes", Integer(16)},
     };
     thread_warp_size_ = Extract(target, "thread_warp_size").IntValue();
+    max_threads_per_block_ = Extract(target, "max_threads_per_block").IntValue();
   }
 
   bool Verify(const IRModule& mod) const {
@@ -145,7 +164,9 @@ class VerifyGPUCodeNode : public PostprocNode {
       const GlobalVar& g_var = kv.first;
       const BaseFunc& base_func = kv.second;
       if (const auto* prim_func = base_func.as<tir::PrimFuncNode>()) {
-        if (!tir::ThreadExtentChecker::Check(prim_func->body, thread_warp_size_)) {
+        // Reject the candidates invalid before lowering, which is most of the cost.
+        if (!tir::ThreadExtentChecker::Check(prim_func->body, thread_warp_size_,
+                                             max_threads_per_block_)) {
           return false;
         }
         IRModule lowered{nullptr};
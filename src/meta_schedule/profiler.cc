@@ -16,7 +16,10 @@
  * specific language governing permissions and limitations
  * under the License.
  */
+#include <dmlc/json.h>
+
 #include <algorithm>
+#include <map>
 
 #include "./utils.h"
 
@@ -67,6 +70,39 @@ String ProfilerNode::Table() const {
   return p.AsStr();
 }
 
+String ProfilerNode::JSON() const {
+  // The time and the throughput of a task.
+  struct TaskEntry {
+    std::map<std::string, double> stats_sec;
+    int64_t num_trials = 0;
+
+    void Save(dmlc::JSONWriter* writer) const {
+      auto it = stats_sec.find("Total");
+      double total = it == stats_sec.end() ? 0.0 : it->second;
+      writer->BeginObject();
+      writer->WriteObjectKeyValue("stats_sec", stats_sec);
+      writer->WriteObjectKeyValue("num_trials", num_trials);
+      writer->WriteObjectKeyValue("trials_per_sec", total > 0.0 ? num_trials / total : 0.0);
+      writer->EndObject();
+    }
+  };
+  std::map<std::string, TaskEntry> tasks;
+  for (const auto& kv : task_stats_sec) {
+    tasks[kv.first].stats_sec.insert(kv.second.begin(), kv.second.end());
+  }
+  for (const auto& kv : task_trials) {
+    tasks[kv.first].num_trials = kv.second;
+  }
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.BeginObject();
+  writer.WriteObjectKeyValue("stats_sec",
+                             std::map<std::string, double>(stats_sec.begin(), stats_sec.end()));
+  writer.WriteObjectKeyValue("tasks", tasks);
+  writer.EndObject();
+  return os.str();
+}
+
 Profiler::Profiler() {
   ObjectPtr<ProfilerNode> n = make_object<ProfilerNode>();
   n->stats_sec.clear();
@@ -74,15 +110,24 @@ Profiler::Profiler() {
   data_ = n;
 }
 
+/*! \brief The seconds elapsed since the given time point */
+inline double SecondsSince(std::chrono::high_resolution_clock::time_point tik) {
+  auto tok = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(tok - tik).count() / 1e9;
+}
+
 PackedFunc ProfilerTimedScope(String name) {
   if (Optional<Profiler> opt_profiler = Profiler::Current()) {
-    return TypedPackedFunc<void()>([profiler = opt_profiler.value(),                  //
+    Profiler profiler = opt_profiler.value();
+    return TypedPackedFunc<void()>([profiler,                                         //
+                                    task = profiler->current_task,                    //
                                     tik = std::chrono::high_resolution_clock::now(),  //
                                     name = std::move(name)]() {
-      auto tok = std::chrono::high_resolution_clock::now();
-      double duration =
-          std::chrono::duration_cast<std::chrono::nanoseconds>(tok - tik).count() / 1e9;
+      double duration = SecondsSince(tik);
       profiler->stats_sec[name] += duration;
+      if (!task.empty()) {
+        profiler->task_stats_sec[task][name] += duration;
+      }
     });
   }
   return nullptr;
@@ -90,6 +135,35 @@ PackedFunc ProfilerTimedScope(String name) {
 
 ScopedTimer Profiler::TimedScope(String name) { return ScopedTimer(ProfilerTimedScope(name)); }
 
+PackedFunc ProfilerTaskScope(String task_name) {
+  Optional<Profiler> opt_profiler = Profiler::Current();
+  // The nested scopes of the same task are counted once.
+  if (!opt_profiler.defined() || opt_profiler.value()->current_task == task_name) {
+    return nullptr;
+  }
+  Profiler profiler = opt_profiler.value();
+  std::string outer_task = std::move(profiler->current_task);
+  profiler->current_task = task_name;
+  return TypedPackedFunc<void()>([profiler,                                         //
+                                  outer_task = std::move(outer_task),               //
+                                  tik = std::chrono::high_resolution_clock::now()]() {
+    profiler->task_stats_sec[profiler->current_task]["Total"] += SecondsSince(tik);
+    profiler->current_task = outer_task;
+  });
+}
+
+ScopedTimer Profiler::TaskScope(String task_name) {
+  return ScopedTimer(ProfilerTaskScope(task_name));
+}
+
+void Profiler::CountTrials(int64_t num_trials) {
+  Optional<Profiler> opt_profiler = Profiler::Current();
+  if (opt_profiler.defined() && !opt_profiler.value()->current_task.empty()) {
+    Profiler profiler = opt_profiler.value();
+    profiler->task_trials[profiler->current_task] += num_trials;
+  }
+}
+
 /**************** Context Manager ****************/
 
 std::vector<Profiler>* ThreadLocalProfilers() {
@@ -130,7 +204,10 @@ TVM_REGISTER_GLOBAL("meta_schedule.ProfilerExitWithScope")
 TVM_REGISTER_GLOBAL("meta_schedule.ProfilerCurrent").set_body_typed(Profiler::Current);
 TVM_REGISTER_GLOBAL("meta_schedule.ProfilerGet").set_body_method<Profiler>(&ProfilerNode::Get);
 TVM_REGISTER_GLOBAL("meta_schedule.ProfilerTable").set_body_method<Profiler>(&ProfilerNode::Table);
+TVM_REGISTER_GLOBAL("meta_schedule.ProfilerJSON").set_body_method<Profiler>(&ProfilerNode::JSON);
 TVM_REGISTER_GLOBAL("meta_schedule.ProfilerTimedScope").set_body_typed(ProfilerTimedScope);
+TVM_REGISTER_GLOBAL("meta_schedule.ProfilerTaskScope").set_body_typed(ProfilerTaskScope);
+TVM_REGISTER_GLOBAL("meta_schedule.ProfilerCountTrials").set_body_typed(Profiler::CountTrials);
 
 }  // namespace meta_schedule
 }  // namespace tvm
@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "../utils.h"
+
+namespace tvm {
+namespace meta_schedule {
+
+using namespace tvm::tir;
+
+/*!
+ * \brief Schedule the embedding bag out[b, d] = reduce_l weight[indices[b, l], d] on CPU: the bags
+ *  are split into batches of rows run by the threads, each bag walks its indices with the
+ *  embedding dimension innermost and vectorized, and the rows of the indices a few iterations
+ *  ahead are prefetched, see InjectSoftwarePrefetch, so that the random reads of the rows overlap.
+ *  The number of rows of a batch and the prefetch distance are sampled.
+ */
+TVM_REGISTER_GLOBAL("meta_schedule.embedding_bag.llvm")
+    .set_body_typed([](Schedule sch, BlockRV block) -> Array<Schedule> {
+      Array<LoopRV> loops = sch->GetLoops(block);
+      ICHECK_EQ(loops.size(), 3) << "ValueError: expects the loops of the bags, of the embedding "
+                                    "dimension and of the indices of a bag";
+      LoopRV bag = loops[0], dim = loops[1], index = loops[2];
+
+      auto f_sample = [&](const Array<Integer>& candidates) {
+        Array<FloatImm> probs(candidates.size(),
+                              FloatImm(DataType::Float(64), 1.0 / candidates.size()));
+        return sch->SampleCategorical(candidates, probs);
+      };
+      Array<LoopRV> rows = sch->Split(bag, {NullOpt, f_sample({1, 4, 16, 64})});
+      Array<LoopRV> order{rows[0], rows[1], index};
+      Optional<LoopRV> vectorized = NullOpt;
+      if (tir::GetLoopIntExtent(sch->GetSRef(dim)) != nullptr) {
+        Array<ExprRV> factors = sch->SamplePerfectTile(dim, /*n=*/2, /*max_innermost_factor=*/16);
+        Array<LoopRV> lanes = sch->Split(dim, {factors.begin(), factors.end()});
+        order.push_back(lanes[0]);
+        order.push_back(lanes[1]);
+        vectorized = lanes[1];
+      } else {
+        order.push_back(dim);
+      }
+      sch->Reorder(order);
+      sch->Parallel(rows[0]);
+      if (vectorized.defined()) {
+        sch->Vectorize(vectorized.value());
+      }
+      sch->Annotate(index, tir::attr::software_prefetch_distance, f_sample({2, 4, 8}));
+      return {sch};
+    });
+
+}  // namespace meta_schedule
+}  // namespace tvm
@@ -92,6 +92,11 @@ Array<Schedule> MultiLevelTilingNode::Apply(const Schedule& sch, const BlockRV&
   if (!NeedsMultiLevelTiling(sch->state(), sch->GetSRef(block_rv))) {
     return {sch};
   }
+  // The block is already tiled by a previous rule, e.g. for a tensor intrinsic.
+  if (tir::GetAnn<String>(sch->GetSRef(block_rv), tir::attr::meta_schedule_tiling_structure)
+          .defined()) {
+    return {sch};
+  }
   sch->Annotate(block_rv, tir::attr::meta_schedule_tiling_structure, structure);
 
   Array<Schedule> results;
@@ -40,6 +40,18 @@ tir::BlockRV TileForIntrin(tir::Schedule sch, tir::BlockRV block, const std::str
  * \brief Extension of MultiLevelTiling for auto-tensorizing with a single intrinsic.
  */
 class MultiLevelTilingWithIntrinNode : public MultiLevelTilingNode {
+ public:
+  // Inherited from ScheduleRuleNode
+  Array<tir::Schedule> Apply(const tir::Schedule& sch, const tir::BlockRV& block_rv) final {
+    // Leaving the blocks which do not match the intrinsic to the following rules.
+    if (!tir::GetTensorizeLoopMapping(sch->state(), sch->GetSRef(block_rv),
+                                      tir::TensorIntrin::Get(intrin_name)->desc)
+             .defined()) {
+      return {sch};
+    }
+    return MultiLevelTilingNode::Apply(sch, block_rv);
+  }
+
  protected:
   // Override ApplySubRules to tile the inner loops according to the given tensor intrinsic, then
   // tile the outerloops.
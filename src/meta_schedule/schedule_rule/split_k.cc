@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "../utils.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace tir {
+
+/*!
+ * \brief Check if a block is a GEMM-like reduction whose spatial loops are too skinny to fill the
+ *  GPU, i.e. all the spatial loops but the largest one have a tiny extent while the reduction is
+ *  long, for example the matmuls with 1 to 8 rows in LLM decoding.
+ * \param self The schedule state
+ * \param block_sref The block to be checked
+ * \param max_skinny_extent The maximum product of the extents of the spatial loops but the largest
+ * \return The cumulative reduction length if the block is skinny, or -1 otherwise
+ */
+int64_t GetSkinnyReductionLength(const ScheduleState& self, const StmtSRef& block_sref,
+                                 int64_t max_skinny_extent) {
+  const BlockNode* block = TVM_SREF_TO_BLOCK(block, block_sref);
+  // Only the GEMM-like blocks which multiply two operands.
+  if (block->writes.size() != 1 || block->reads.size() < 2) {
+    return -1;
+  }
+  const StmtSRef& scope_sref = GetScopeRoot(self, block_sref, /*require_stage_pipeline=*/false);
+  if (!IsReductionBlock(self, block_sref, scope_sref) || !IsTrivialBinding(self, block_sref) ||
+      HasBeenMultiLevelTiled(block_sref)) {
+    return -1;
+  }
+  int64_t cum_space_len, cum_reduce_len;
+  std::tie(cum_space_len, cum_reduce_len) = GetCumulativeSpaceAndReductionLength(self, block_sref);
+  if (cum_space_len == -1 || cum_reduce_len <= 1) {
+    return -1;
+  }
+  int num_spatial_loops = 0;
+  int64_t max_space_extent = 1;
+  for (const StmtSRef& loop_sref : GetLoops(block_sref)) {
+    if (GetLoopIterType(loop_sref) == kDataPar) {
+      max_space_extent = std::max(max_space_extent, *GetLoopIntExtent(loop_sref));
+      ++num_spatial_loops;
+    }
+  }
+  if (num_spatial_loops < 2 || cum_space_len / max_space_extent > max_skinny_extent) {
+    return -1;
+  }
+  return cum_reduce_len;
+}
+
+}  // namespace tir
+
+namespace meta_schedule {
+
+class SplitKNode : public ScheduleRuleNode {
+ public:
+  // Inherited from ScheduleRuleNode
+  void InitializeWithTuneContext(const TuneContext& context) final {
+    ICHECK(context->target.defined());
+    Target target = context->target.value();
+    max_threads_per_block_ =
+        target->GetAttr<Integer>("max_threads_per_block").value_or(Integer(-1))->value;
+  }
+
+  // Inherited from ScheduleRuleNode
+  Array<tir::Schedule> Apply(const tir::Schedule& sch, const tir::BlockRV& block_rv) final;
+
+ public:
+  /*! \brief Candidates of the number of the splits of the reduction. */
+  Array<Integer> split_factors;
+  /*! \brief Candidates of the extent of threadIdx.x. */
+  Array<Integer> thread_extents;
+  /*! \brief The maximum number of threads per block of the target. */
+  int64_t max_threads_per_block_ = -1;
+
+  /*! \brief The maximum product of the extents of the spatial loops but the largest. */
+  static constexpr int64_t kMaxSkinnyExtent = 8;
+  /*! \brief The minimum length of the reduction left in each split. */
+  static constexpr int64_t kMinSplitReductionLength = 64;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("split_factors", &split_factors);
+    v->Visit("thread_extents", &thread_extents);
+    // `max_threads_per_block_` is not visited
+  }
+
+  static constexpr const char* _type_key = "meta_schedule.SplitK";
+  TVM_DECLARE_FINAL_OBJECT_INFO(SplitKNode, ScheduleRuleNode);
+
+ private:
+  /*!
+   * \brief Fuse the spatial loops of a block, split out the threads and bind them.
+   * \param sch The schedule
+   * \param loops The spatial loops
+   * \param thread_extent The extent of threadIdx.x
+   * \return The loop bound to blockIdx.x
+   */
+  tir::LoopRV BindSpatialLoops(const tir::Schedule& sch, const Array<tir::LoopRV>& loops,
+                               const tir::ExprRV& thread_extent) {
+    tir::LoopRV fused = sch->Fuse(loops);
+    Array<tir::LoopRV> split = sch->Split(fused, {NullOpt, thread_extent});
+    sch->Bind(split[0], "blockIdx.x");
+    sch->Bind(split[1], "threadIdx.x");
+    return split[0];
+  }
+};
+
+ScheduleRule ScheduleRule::SplitK(Array<Integer> split_factors, Array<Integer> thread_extents) {
+  for (const Integer& factor : split_factors) {
+    CHECK(factor->value > 1) << "ValueError: The split factors are required to be greater than 1";
+  }
+  for (const Integer& extent : thread_extents) {
+    CHECK(extent->value > 0) << "ValueError: The thread extents are required to be positive";
+  }
+  ObjectPtr<SplitKNode> n = make_object<SplitKNode>();
+  n->split_factors = split_factors;
+  n->thread_extents = thread_extents;
+  return ScheduleRule(n);
+}
+
+Array<tir::Schedule> SplitKNode::Apply(const tir::Schedule& sch, const tir::BlockRV& block_rv) {
+  // Step 0. Check the conditions of this rule.
+  if (max_threads_per_block_ == -1) {
+    return {sch};
+  }
+  int64_t reduce_len =
+      tir::GetSkinnyReductionLength(sch->state(), sch->GetSRef(block_rv), kMaxSkinnyExtent);
+  if (reduce_len == -1) {
+    return {sch};
+  }
+  Array<Integer> splits;
+  for (const Integer& factor : split_factors) {
+    if (reduce_len % factor->value == 0 && reduce_len / factor->value >= kMinSplitReductionLength) {
+      splits.push_back(factor);
+    }
+  }
+  Array<Integer> threads;
+  for (const Integer& extent : thread_extents) {
+    if (extent->value <= max_threads_per_block_) {
+      threads.push_back(extent);
+    }
+  }
+  if (splits.empty() || threads.empty()) {
+    return {sch};
+  }
+
+  // Step 1. Make a copy of the original schedule. The new copy is used for scheduling.
+  tir::Schedule tmp_sch = sch->Copy();
+  tmp_sch->Seed(sch->ForkSeed());
+
+  // Step 2. Fuse the reduction loops, and split out the outer loop of the splits of the reduction.
+  size_t num_spatial_loops;
+  tir::LoopRV fused_reduce_loop;
+  ReorderAndFuseReductionLoops(tmp_sch, block_rv, &fused_reduce_loop, &num_spatial_loops);
+  auto f_sample = [&tmp_sch](const Array<Integer>& candidates) {
+    int n = candidates.size();
+    Array<FloatImm> probs(n, FloatImm(DataType::Float(64), 1.0 / n));
+    return tmp_sch->SampleCategorical(candidates, probs);
+  };
+  tir::ExprRV split_factor = f_sample(splits);
+  tir::ExprRV thread_extent = f_sample(threads);
+  Array<tir::LoopRV> split_res = tmp_sch->Split(fused_reduce_loop, {split_factor, NullOpt});
+
+  // Step 3. Each split computes a partial sum of its part of the reduction in its own thread
+  // blocks, into the rfactor buffer in global memory.
+  tir::BlockRV block_rf{nullptr};
+  try {
+    block_rf = tmp_sch->RFactor(split_res[0], /*factor_axis=*/0);
+  } catch (const tvm::runtime::Error& e) {
+    return {sch};
+  }
+  Array<tir::LoopRV> rf_loops = tmp_sch->GetLoops(block_rf);
+  ICHECK_EQ(rf_loops.size(), num_spatial_loops + 2);
+  tir::LoopRV split_loop = rf_loops[num_spatial_loops];
+  Array<tir::LoopRV> rf_spatial_loops{rf_loops.begin(), rf_loops.begin() + num_spatial_loops};
+  Array<tir::LoopRV> new_order{split_loop};
+  new_order.insert(new_order.end(), rf_spatial_loops.begin(), rf_spatial_loops.end());
+  tmp_sch->Reorder(new_order);
+  BindSpatialLoops(tmp_sch, rf_spatial_loops, thread_extent);
+  tmp_sch->Bind(split_loop, "blockIdx.y");
+
+  // Step 4. The write-back block sums up the partial sums in a separate kernel, which is the
+  // cross-block reduction epilogue.
+  Array<tir::LoopRV> wb_loops = tmp_sch->GetLoops(block_rv);
+  ICHECK_EQ(wb_loops.size(), num_spatial_loops + 1);
+  BindSpatialLoops(tmp_sch, {wb_loops.begin(), wb_loops.begin() + num_spatial_loops},
+                   thread_extent);
+  // Both blocks are fully scheduled, so the other rules should skip the write-back block.
+  tmp_sch->Annotate(block_rv, "schedule_rule", String("None"));
+  return {tmp_sch, sch};
+}
+
+TVM_REGISTER_NODE_TYPE(SplitKNode);
+TVM_REGISTER_GLOBAL("meta_schedule.ScheduleRuleSplitK").set_body_typed(ScheduleRule::SplitK);
+
+}  // namespace meta_schedule
+}  // namespace tvm
@@ -30,30 +30,6 @@ using tir::Schedule;
 
 /**************** Data Structure ****************/
 
-/*! \brief An auxiliary data structure to help deduplicate IRModules */
-class IRModuleSet {
- public:
-  /*! \brief Add an IRModule to the set */
-  void Add(const IRModule& mod, size_t shash) { tab_.insert(Item{mod, shash}); }
-  /*! \brief Check if the IRModule is in the set */
-  bool Has(const IRModule& mod, size_t shash) const { return tab_.count(Item{mod, shash}); }
-
- private:
-  struct Item {
-    IRModule mod;
-    size_t shash;
-  };
-  struct ItemHash {
-    size_t operator()(const Item& hash) const { return hash.shash; }
-  };
-  struct ItemEqual {
-    bool operator()(const Item& lhs, const Item& rhs) const {
-      return lhs.shash == rhs.shash && StructuralEqual()(lhs.mod, rhs.mod);
-    }
-  };
-  std::unordered_set<Item, ItemHash, ItemEqual> tab_;
-};
-
 /*!
  * \brief A heap with a size up-limit. If overflow happens, it evicted the worst items.
  * \note It maintains a min heap in terms of `Item::score`. Therefore, when
@@ -104,6 +80,7 @@ struct PerThreadData {
   TRandState rand_state{-1};
   std::function<int32_t()> trace_sampler = nullptr;
   std::function<Optional<Mutator>()> mutator_sampler = nullptr;
+  TracePrefixCache trace_cache;
 
   /*!
    * \brief Set the value for the trace and mutator samplers per thread.
@@ -273,6 +250,7 @@ class EvolutionarySearchNode : public SearchStrategyNode {
       for (PerThreadData& data : this->per_thread_data_) {
         data.mod = DeepCopyIRModule(mod);
         data.rand_state = ForkSeed(&self->rand_state_);
+        data.trace_cache = TracePrefixCache(self->trace_cache_size);
       }
       this->database_ = database;
       this->cost_model_ = cost_model;
@@ -313,6 +291,10 @@ class EvolutionarySearchNode : public SearchStrategyNode {
     /*! \brief An interface method to be called by it's counterpart in EvolutionarySearchNode */
     inline void NotifyRunnerResults(const Array<MeasureCandidate>& measure_candidates,
                                     const Array<RunnerResult>& results);
+    /*! \brief The trace prefix cache of a thread to replay with, or nullptr if disabled. */
+    TracePrefixCache* TraceCache(PerThreadData* data) const {
+      return self->trace_cache_size > 0 ? &data->trace_cache : nullptr;
+    }
   };
 
   /*! \brief The tuning context of the evolutionary search strategy. */
@@ -349,6 +331,9 @@ class EvolutionarySearchNode : public SearchStrategyNode {
   /*** Configuration: pick states for measurement ***/
   /*! \brief The ratio of measurements to use randomly sampled states. */
   double eps_greedy;
+  /*** Configuration: trace replay ***/
+  /*! \brief The number of trace prefixes whose schedules each thread caches, 0 to disable. */
+  int trace_cache_size;
 
   void VisitAttrs(tvm::AttrVisitor* v) {
     // `context_` is not visited
@@ -369,6 +354,8 @@ class EvolutionarySearchNode : public SearchStrategyNode {
     v->Visit("genetic_max_fail_count", &genetic_max_fail_count);
     /*** Configuration: pick states for measurement ***/
     v->Visit("eps_greedy", &eps_greedy);
+    /*** Configuration: trace replay ***/
+    v->Visit("trace_cache_size", &trace_cache_size);
   }
 
   static constexpr const char* _type_key = "meta_schedule.EvolutionarySearch";
@@ -452,7 +439,7 @@ std::vector<Schedule> EvolutionarySearchNode::State::PickBestFromDatabase(int nu
     tir::Trace trace = measured_traces.at(trace_id);
     Schedule& result = results.at(trace_id);
     ICHECK(!result.defined());
-    if (Optional<Schedule> sch = pp.Apply(mod, trace, rand_state)) {
+    if (Optional<Schedule> sch = pp.Apply(mod, trace, rand_state, this->TraceCache(&data))) {
       result = sch.value();
     } else {
       LOG(FATAL) << "ValueError: Cannot postprocess the trace:\n" << trace;
@@ -554,7 +541,8 @@ std::vector<Schedule> EvolutionarySearchNode::State::EvolveWithCostModel(
             // Decision: mutate
             Mutator mutator = opt_mutator.value();
             if (Optional<tir::Trace> new_trace = mutator->Apply(trace, rand_state)) {
-              if (Optional<Schedule> sch = pp.Apply(mod, new_trace.value(), rand_state)) {
+              if (Optional<Schedule> sch =
+                      pp.Apply(mod, new_trace.value(), rand_state, this->TraceCache(&data))) {
                 // note that sch's trace is different from new_trace
                 // because it contains post-processing information
                 result = sch.value();
@@ -575,9 +563,15 @@ std::vector<Schedule> EvolutionarySearchNode::State::EvolveWithCostModel(
                                     f_find_candidate);
 
       population.swap(next_population);
+      int64_t num_hits = 0, num_misses = 0;
+      for (const PerThreadData& data : this->per_thread_data_) {
+        num_hits += data.trace_cache.num_hits;
+        num_misses += data.trace_cache.num_misses;
+      }
       TVM_PY_LOG(INFO, self->context_->logging_func)
           << "Evolve iter #" << iter << " done. Summary:\n"
-          << pp.SummarizeFailures();
+          << pp.SummarizeFailures() << "\nTrace prefix cache: " << num_hits << " hit(s), "
+          << num_misses << " miss(es)";
     }
   }
   // Return the best states from the heap, sorting from higher score to lower ones
@@ -706,7 +700,8 @@ SearchStrategy SearchStrategy::EvolutionarySearch(int num_trials_per_iter,     /
                                                   int genetic_num_iters,       //
                                                   double genetic_mutate_prob,  //
                                                   int genetic_max_fail_count,  //
-                                                  double eps_greedy) {
+                                                  double eps_greedy,           //
+                                                  int trace_cache_size) {
   TVM_META_SCHEDULE_CHECK_PROB_RANGE(init_measured_ratio, "Initial measured ratio");
   TVM_META_SCHEDULE_CHECK_PROB_RANGE(genetic_mutate_prob, "Mutation probability");
   TVM_META_SCHEDULE_CHECK_PROB_RANGE(eps_greedy, "Greedy pick probability");
@@ -721,6 +716,7 @@ SearchStrategy SearchStrategy::EvolutionarySearch(int num_trials_per_iter,     /
   n->genetic_max_fail_count = genetic_max_fail_count;
   n->genetic_mutate_prob = genetic_mutate_prob;
   n->eps_greedy = eps_greedy;
+  n->trace_cache_size = trace_cache_size;
   return SearchStrategy(n);
 }
 
@@ -16,6 +16,9 @@
  * specific language governing permissions and limitations
  * under the License.
  */
+#include <deque>
+#include <future>
+
 #include "../utils.h"
 
 namespace tvm {
@@ -35,6 +38,8 @@ class GradientBasedNode final : public TaskSchedulerNode {
   // Parameters used in gradient computation
   double alpha;
   int window_size;
+  // The maximum number of tasks built and measured at once, see TunePipelined
+  int num_inflight_tasks;
 
   std::vector<TaskRecord> task_records_;
   std::vector<double> best_time_cost_per_task_;  // in ms
@@ -45,6 +50,7 @@ class GradientBasedNode final : public TaskSchedulerNode {
     TaskSchedulerNode::VisitAttrs(v);
     v->Visit("alpha", &alpha);
     v->Visit("window_size", &window_size);
+    v->Visit("num_inflight_tasks", &num_inflight_tasks);
     // `task_records_` is not visited.
     // `best_time_cost_per_task_` is not visited.
     // `num_rounds_already_` is not visited.
@@ -135,8 +141,17 @@ class GradientBasedNode final : public TaskSchedulerNode {
     if (tasks_alive.empty()) {
       return -1;
     }
+    int task_id = PickTask(tasks_alive);
+    if (tasks[task_id]->runner_futures.defined()) {
+      JoinRunningTask(task_id);
+    }
+    return task_id;
+  }
+
+  /*! \brief Pick the task of the largest weighted gradient among the given ones. */
+  int PickTask(const std::vector<int>& tasks_alive) {
     std::vector<double> grad;
-    grad.reserve(n_tasks);
+    grad.reserve(tasks_alive.size());
     for (int task_id : tasks_alive) {
       const TaskRecord& record = task_records_[task_id];
       const int w = this->window_size;
@@ -155,16 +170,110 @@ class GradientBasedNode final : public TaskSchedulerNode {
     }
     auto max_grad = std::max_element(grad.begin(), grad.end());
     auto min_grad = std::min_element(grad.begin(), grad.end());
-    int task_id = -1;
     if (*max_grad == *min_grad) {
-      task_id = tasks_alive[tir::SampleInt(&rand_state_, 0, tasks_alive.size())];
+      return tasks_alive[tir::SampleInt(&rand_state_, 0, tasks_alive.size())];
+    }
+    return tasks_alive[std::distance(grad.begin(), max_grad)];
+  }
+
+  void Tune() final {
+    if (num_inflight_tasks <= 1) {
+      TaskSchedulerNode::Tune();
     } else {
-      task_id = tasks_alive[std::distance(grad.begin(), max_grad)];
+      TunePipelined();
     }
-    if (tasks[task_id]->runner_futures.defined()) {
-      JoinRunningTask(task_id);
+  }
+
+  /*!
+   * \brief Tune with up to num_inflight_tasks tasks in flight: the candidates of a task are built
+   *  and sent to the runner in the background, while the candidates of the next task picked by
+   *  the gradients are generated, so that the builder and the runner are kept busy across tasks.
+   *  A task is picked again once its measurements are joined, the tasks never measured first.
+   * \note The search strategies, the cost model and the measure callbacks are only used by the
+   *  calling thread, the background only calls the builder and the runner.
+   */
+  void TunePipelined() {
+    int n_tasks = tasks.size();
+    for (int task_id = 0; task_id < n_tasks; ++task_id) {
+      InitializeTask(task_id);
+    }
+    TVM_PY_LOG(INFO, this->logging_func) << "\n" << this->TuningStatistics();
+    // The tasks in flight in the order they were sent, with their background build and run.
+    std::deque<std::pair<int, std::future<void>>> inflight;
+    std::vector<bool> is_inflight(n_tasks, false);
+    auto f_join = [this, &is_inflight](std::pair<int, std::future<void>>* entry) {
+      // Rethrows the errors of the builder and of the runner.
+      entry->second.get();
+      JoinRunningTask(entry->first);
+      is_inflight[entry->first] = false;
+    };
+    int running_tasks = n_tasks;
+    while (true) {
+      for (auto it = inflight.begin(); it != inflight.end();) {
+        bool done = it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        if (done) {
+          for (const RunnerFuture& future : tasks[it->first]->runner_futures.value()) {
+            done = done && future->Done();
+          }
+        }
+        if (done) {
+          f_join(&*it);
+          it = inflight.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      std::vector<int> idle_tasks;
+      int never_measured = -1;
+      for (int task_id = 0; task_id < n_tasks; ++task_id) {
+        if (tasks[task_id]->is_terminated || is_inflight[task_id]) continue;
+        idle_tasks.push_back(task_id);
+        if (never_measured == -1 && task_records_[task_id].best_time_cost_history.empty()) {
+          never_measured = task_id;
+        }
+      }
+      if (num_trials_already < max_trials && !idle_tasks.empty() &&
+          static_cast<int>(inflight.size()) < num_inflight_tasks) {
+        int task_id = never_measured != -1 ? never_measured : PickTask(idle_tasks);
+        TVM_PY_LOG(INFO, this->logging_func)
+            << "Scheduler picks Task #" << task_id << ": " << tasks[task_id]->task_name;
+        TuneContext task = tasks[task_id];
+        auto _task = Profiler::TaskScope(TaskProfileName(task, task_id));
+        if (Optional<Array<MeasureCandidate>> candidates =
+                task->search_strategy.value()->GenerateMeasureCandidates()) {
+          int num_candidates = candidates.value().size();
+          task->_SetMeasureCandidates(candidates.value());
+          num_trials_already += num_candidates;
+          TVM_PY_LOG(INFO, this->logging_func)
+              << "Sending " << num_candidates << " sample(s) to builder and runner";
+          is_inflight[task_id] = true;
+          inflight.emplace_back(task_id, std::async(std::launch::async, [this, task]() {
+                                  task->_SendToBuilder(this->builder);
+                                  task->_SendToRunner(this->runner);
+                                }));
+        } else {
+          task->is_terminated = true;
+          --running_tasks;
+          TVM_PY_LOG(INFO, this->logging_func)
+              << "Task #" << task_id << " has finished. Remaining task(s): " << running_tasks;
+        }
+        continue;
+      }
+      if (inflight.empty()) break;
+      // Nothing more to send for now, wait for the oldest task in flight.
+      f_join(&inflight.front());
+      inflight.pop_front();
+    }
+    for (int task_id = 0; task_id < n_tasks; ++task_id) {
+      TuneContext task = tasks[task_id];
+      if (!task->is_terminated) {
+        task->is_terminated = true;
+        --running_tasks;
+        TVM_PY_LOG(INFO, this->logging_func)
+            << "Task #" << task_id << " has finished. Remaining task(s): " << running_tasks;
+      }
+      task->search_strategy.value()->PostTuning();
     }
-    return task_id;
   }
 
   Array<RunnerResult> JoinRunningTask(int task_id) final {
@@ -196,7 +305,8 @@ TaskScheduler TaskScheduler::GradientBased(Array<TuneContext> tasks,
                                            PackedFunc logging_func,                             //
                                            double alpha,                                        //
                                            int window_size,                                     //
-                                           support::LinearCongruentialEngine::TRandState seed) {
+                                           support::LinearCongruentialEngine::TRandState seed,  //
+                                           int num_inflight_tasks) {
   CHECK_EQ(tasks.size(), task_weights.size())
       << "The size of `tasks` should have the same as `task_weights`.";
   int n_tasks = tasks.size();
@@ -223,6 +333,7 @@ TaskScheduler TaskScheduler::GradientBased(Array<TuneContext> tasks,
   n->num_trials_already = 0;
   n->alpha = alpha;
   n->window_size = window_size;
+  n->num_inflight_tasks = num_inflight_tasks;
   n->task_records_ = std::move(task_records);
   n->best_time_cost_per_task_ = std::vector<double>(n_tasks, 1e100);
   n->num_rounds_already_ = 0;
@@ -22,8 +22,9 @@ namespace tvm {
 namespace meta_schedule {
 
 void TaskSchedulerNode::InitializeTask(int task_id) {
-  auto _ = Profiler::TimedScope("InitializeTask");
   TuneContext task = this->tasks[task_id];
+  auto _task = Profiler::TaskScope(TaskProfileName(task, task_id));
+  auto _ = Profiler::TimedScope("InitializeTask");
   TVM_PY_LOG(INFO, this->logging_func)
       << "Initializing Task #" << task_id << ": " << task->task_name;
   TVM_PY_LOG(INFO, task->logging_func)
@@ -60,6 +61,7 @@ void TaskSchedulerNode::Tune() {
     TVM_PY_LOG(INFO, this->logging_func)
         << "Scheduler picks Task #" << task_id << ": " << tasks[task_id]->task_name;
     TuneContext task = tasks[task_id];
+    auto _task = Profiler::TaskScope(TaskProfileName(task, task_id));
     ICHECK(!task->is_terminated);
     ICHECK(!task->runner_futures.defined());
     if (Optional<Array<MeasureCandidate>> candidates =
@@ -110,7 +112,9 @@ void TaskSchedulerNode::TouchTask(int task_id) {
 
 Array<RunnerResult> TaskSchedulerNode::JoinRunningTask(int task_id) {
   TuneContext task = tasks[task_id];
+  auto _task = Profiler::TaskScope(TaskProfileName(task, task_id));
   Array<RunnerResult> results = task->_Join();
+  Profiler::CountTrials(results.size());
   for (const MeasureCallback& callback : this->measure_callbacks) {
     callback->Apply(GetRef<TaskScheduler>(this), task_id, task->measure_candidates.value(),
                     task->builder_results.value(), results);
@@ -44,7 +44,10 @@
 #include <tvm/tir/transform.h>
 
 #include <algorithm>
+#include <deque>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "../printer/text_printer.h"
@@ -174,6 +177,16 @@ inline String SHash2Hex(const ObjectRef& obj) {
   return os.str();
 }
 
+/*!
+ * \brief The name a task is profiled under, see Profiler::TaskScope.
+ * \param task The task.
+ * \param task_id The index of the task in its scheduler.
+ * \return The task name, or its index when it has no name.
+ */
+inline String TaskProfileName(const TuneContext& task, int task_id) {
+  return task->task_name.value_or("Task #" + std::to_string(task_id));
+}
+
 /*!
  * \brief Fork a random state into another, i.e. PRNG splitting.
  * The given random state is also mutated.
@@ -208,9 +221,61 @@ inline std::vector<support::LinearCongruentialEngine::TRandState> ForkSeed(
  * \return The deep copy of the IRModule.
  */
 inline IRModule DeepCopyIRModule(IRModule mod) {
-  return Downcast<IRModule>(LoadJSON(SaveJSON(mod)));
+  return Downcast<IRModule>(LoadBinary(SaveBinary(mod)));
 }
 
+/*! \brief An IRModule with its structural hash, the key of the IRModule containers below */
+struct IRModuleKey {
+  IRModule mod;
+  size_t shash;
+
+  struct Hash {
+    size_t operator()(const IRModuleKey& key) const { return key.shash; }
+  };
+  struct Equal {
+    bool operator()(const IRModuleKey& lhs, const IRModuleKey& rhs) const {
+      return lhs.shash == rhs.shash && StructuralEqual()(lhs.mod, rhs.mod);
+    }
+  };
+};
+
+/*! \brief An auxiliary data structure to help deduplicate IRModules */
+class IRModuleSet {
+ public:
+  /*! \brief Add an IRModule to the set */
+  void Add(const IRModule& mod, size_t shash) { tab_.insert(IRModuleKey{mod, shash}); }
+  /*! \brief Check if the IRModule is in the set */
+  bool Has(const IRModule& mod, size_t shash) const { return tab_.count(IRModuleKey{mod, shash}); }
+
+ private:
+  std::unordered_set<IRModuleKey, IRModuleKey::Hash, IRModuleKey::Equal> tab_;
+};
+
+/*!
+ * \brief An auxiliary data structure mapping structurally equal IRModules to the same value
+ * \tparam TValue The type of the values
+ */
+template <class TValue>
+class IRModuleMap {
+ public:
+  /*! \brief Find the value of an IRModule, or nullptr if it is not in the map */
+  TValue* Find(const IRModule& mod, size_t shash) {
+    auto it = tab_.find(IRModuleKey{mod, shash});
+    return it == tab_.end() ? nullptr : &it->second;
+  }
+  /*! \brief Set the value of an IRModule, overwriting the existing one if any */
+  void Set(const IRModule& mod, size_t shash, TValue value) {
+    tab_[IRModuleKey{mod, shash}] = std::move(value);
+  }
+  /*! \brief Remove an IRModule from the map */
+  void Erase(const IRModule& mod, size_t shash) { tab_.erase(IRModuleKey{mod, shash}); }
+  /*! \brief The number of IRModules in the map */
+  size_t size() const { return tab_.size(); }
+
+ private:
+  std::unordered_map<IRModuleKey, TValue, IRModuleKey::Hash, IRModuleKey::Equal> tab_;
+};
+
 /*!
  * \brief Concatenate strings
  * \param strs The strings to concatenate
@@ -242,6 +307,169 @@ inline tir::BlockRV GetRVFromSRef(const tir::Schedule& sch, const tir::StmtSRef&
   return sch->GetBlock(block->name_hint, global_var_name);
 }
 
+/*!
+ * \brief A cache of the schedules replaying the prefixes of traces on a module, so that replaying a
+ * trace sharing a prefix with one replayed before, e.g. one of its mutations, only replays the
+ * rest. A snapshot is taken before each instruction with a decision, where mutations differ, as
+ * long as no earlier sampling is left to chance. Prefixes are matched by the structure of their
+ * instructions and decisions, so traces apart from the one which made the snapshot can hit it.
+ * \note It is not thread-safe, and is meant to be owned by a thread.
+ */
+class TracePrefixCache {
+ public:
+  /*!
+   * \brief Constructor
+   * \param max_size The maximum number of snapshots kept, the oldest evicted first
+   */
+  explicit TracePrefixCache(int max_size = 1024) : max_size_(max_size) {}
+
+  /*!
+   * \brief Replay a trace on a module, without its postprocessing instructions
+   * \param mod The module to replay the trace on
+   * \param trace The trace to replay
+   * \param rand_state The random state to seed the schedule with
+   * \return The schedule replaying the trace
+   */
+  tir::Schedule Replay(const IRModule& mod, const tir::Trace& trace, TRandState* rand_state) {
+    if (!mod.same_as(mod_)) {
+      entries_.clear();
+      order_.clear();
+      mod_ = mod;
+      base_ = tir::Schedule{nullptr};
+    }
+    Array<ObjectRef> json = Downcast<Array<ObjectRef>>(trace->AsJSON(/*remove_postproc=*/true));
+    Array<ObjectRef> json_insts = Downcast<Array<ObjectRef>>(json[0]);
+    int n = json_insts.size();
+    Array<ObjectRef> json_decisions(n, ObjectRef(nullptr));
+    for (const ObjectRef& item : Downcast<Array<ObjectRef>>(json[1])) {
+      Array<ObjectRef> index_and_decision = Downcast<Array<ObjectRef>>(item);
+      json_decisions.Set(Downcast<Integer>(index_and_decision[0])->value, index_and_decision[1]);
+    }
+    // `keys[i]` is the hash of the prefix of the first `i` instructions
+    std::vector<size_t> keys(n + 1, 0);
+    for (int i = 0; i < n; ++i) {
+      keys[i + 1] = support::HashCombine(keys[i], StructuralHash()(json_insts[i]));
+      if (json_decisions[i].defined()) {
+        keys[i + 1] = support::HashCombine(keys[i + 1], StructuralHash()(json_decisions[i]));
+      }
+    }
+    // Resume from the longest cached prefix
+    int begin = 0;
+    const Entry* hit = nullptr;
+    for (int i = n - 1; i > 0 && hit == nullptr; --i) {
+      if (!json_decisions[i].defined()) {
+        continue;
+      }
+      auto it = entries_.find(keys[i]);
+      if (it != entries_.end() && it->second.Match(json_insts, json_decisions, i)) {
+        hit = &it->second;
+        begin = i;
+      }
+    }
+    tir::Schedule sch{nullptr};
+    std::vector<Array<ObjectRef>> outputs;
+    std::unordered_map<const Object*, const Object*> rv_map;
+    if (hit != nullptr) {
+      ++num_hits;
+      sch = hit->sch->Copy();
+      sch->Seed(ForkSeed(rand_state));
+      outputs = hit->outputs;
+      for (int i = 0; i < begin; ++i) {
+        tir::TranslateAddOutputRVs(trace->insts[i]->outputs, outputs[i], &rv_map);
+      }
+    } else {
+      ++num_misses;
+      // Copying the schedule of the module skips rebuilding its sref tree and block scopes
+      if (!base_.defined()) {
+        base_ = tir::Schedule::Traced(mod,
+                                      /*rand_state=*/-1,
+                                      /*debug_mode=*/0,
+                                      /*error_render_level=*/tir::ScheduleErrorRenderLevel::kNone);
+      }
+      sch = base_->Copy();
+      sch->Seed(ForkSeed(rand_state));
+    }
+    bool cacheable = true;
+    for (int i = begin; i < n; ++i) {
+      const tir::Instruction& inst = trace->insts[i];
+      Optional<ObjectRef> decision = trace->GetDecision(inst);
+      if (cacheable && decision.defined() && i > begin && !entries_.count(keys[i])) {
+        Put(keys[i], Entry{json_insts, json_decisions, i, sch->Copy(), outputs});
+      }
+      Array<ObjectRef> inputs = tir::TranslateInputRVs(inst->inputs, rv_map);
+      Array<ObjectRef> new_outputs =
+          inst->kind->f_apply_to_schedule(sch, inputs, inst->attrs, decision);
+      tir::TranslateAddOutputRVs(inst->outputs, new_outputs, &rv_map);
+      outputs.push_back(new_outputs);
+      if (!decision.defined()) {
+        // A sampling without a decision makes the rest of the replay random
+        tir::Trace sch_trace = sch->trace().value();
+        if (sch_trace->GetDecision(sch_trace->insts.back()).defined()) {
+          cacheable = false;
+        }
+      }
+    }
+    return sch;
+  }
+
+  /*! \brief The number of replays resumed from a snapshot. */
+  int64_t num_hits = 0;
+  /*! \brief The number of replays from scratch. */
+  int64_t num_misses = 0;
+
+ private:
+  /*! \brief A snapshot of the schedule after a prefix of a trace. */
+  struct Entry {
+    /*! \brief The JSON instructions of the trace, of which the prefix is the first `length`. */
+    Array<ObjectRef> json_insts;
+    /*! \brief The JSON decision of each instruction of the trace, or nullptr if none. */
+    Array<ObjectRef> json_decisions;
+    /*! \brief The length of the prefix. */
+    int length;
+    /*! \brief The schedule after replaying the prefix. */
+    tir::Schedule sch;
+    /*! \brief The outputs of each instruction of the prefix on the schedule. */
+    std::vector<Array<ObjectRef>> outputs;
+
+    /*! \brief Check if the prefix is the first `length` instructions of a trace. */
+    bool Match(const Array<ObjectRef>& insts, const Array<ObjectRef>& decisions, int length) const {
+      if (length != this->length) {
+        return false;
+      }
+      StructuralEqual equal;
+      for (int i = 0; i < length; ++i) {
+        if (!equal(insts[i], json_insts[i]) || !equal(decisions[i], json_decisions[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+  };
+
+  void Put(size_t key, Entry entry) {
+    if (max_size_ <= 0) {
+      return;
+    }
+    if (static_cast<int>(order_.size()) >= max_size_) {
+      entries_.erase(order_.front());
+      order_.pop_front();
+    }
+    entries_.emplace(key, std::move(entry));
+    order_.push_back(key);
+  }
+
+  /*! \brief The maximum number of snapshots kept. */
+  int max_size_;
+  /*! \brief The module the snapshots are taken on. */
+  IRModule mod_{nullptr};
+  /*! \brief The schedule of the module before any instruction, copied by the replays anew. */
+  tir::Schedule base_{nullptr};
+  /*! \brief The snapshots, keyed by the hash of their prefixes. */
+  std::unordered_map<size_t, Entry> entries_;
+  /*! \brief The keys of the snapshots, from the oldest to the newest. */
+  std::deque<size_t> order_;
+};
+
 /*!
  * \brief A helper data structure that replays a trace and collects failure counts
  * for each postprocessor
@@ -264,17 +492,21 @@ struct ThreadedTraceApply {
    * \param mod The IRModule to be applied
    * \param trace The trace to apply to the IRModule
    * \param rand_state The random seed
+   * \param cache The cache of the replayed trace prefixes to replay with, if any
    * \return The schedule created, or NullOpt if any postprocessor fails
    */
   Optional<tir::Schedule> Apply(const IRModule& mod, const tir::Trace& trace,
-                                TRandState* rand_state) {
-    tir::Schedule sch =
-        tir::Schedule::Traced(mod,
-                              /*rand_state=*/ForkSeed(rand_state),
-                              /*debug_mode=*/0,
-                              /*error_render_level=*/tir::ScheduleErrorRenderLevel::kNone);
-
-    trace->ApplyToSchedule(sch, /*remove_postproc=*/true);
+                                TRandState* rand_state, TracePrefixCache* cache = nullptr) {
+    tir::Schedule sch{nullptr};
+    if (cache != nullptr) {
+      sch = cache->Replay(mod, trace, rand_state);
+    } else {
+      sch = tir::Schedule::Traced(mod,
+                                  /*rand_state=*/ForkSeed(rand_state),
+                                  /*debug_mode=*/0,
+                                  /*error_render_level=*/tir::ScheduleErrorRenderLevel::kNone);
+      trace->ApplyToSchedule(sch, /*remove_postproc=*/true);
+    }
     sch->EnterPostproc();
 
     for (int i = 0; i < n_; ++i) {
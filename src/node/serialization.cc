@@ -33,11 +33,17 @@
 #include <tvm/runtime/registry.h>
 
 #include <cctype>
+#include <cstring>
+#include <fstream>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "../runtime/object_internal.h"
 #include "../support/base64.h"
+#include "../support/mapped_file.h"
 
 namespace tvm {
 
@@ -500,7 +506,13 @@ struct JSONGraph {
     helper.ReadAllFields(reader);
   }
 
-  static JSONGraph Create(const ObjectRef& root) {
+  /*!
+   * \brief Create the graph of an object.
+   * \param root The object.
+   * \param tensors The tensors of the graph in the order of their indices, which are kept out
+   *  of the graph when given, instead of as base64 strings.
+   */
+  static JSONGraph Create(const ObjectRef& root, std::vector<DLTensor*>* tensors = nullptr) {
     JSONGraph g;
     NodeIndexer indexer;
     indexer.MakeIndex(const_cast<Object*>(root.get()));
@@ -515,6 +527,10 @@ struct JSONGraph {
     }
     g.attrs["tvm_version"] = TVM_VERSION;
     g.root = indexer.node_index_.at(const_cast<Object*>(root.get()));
+    if (tensors != nullptr) {
+      *tensors = indexer.tensor_list_;
+      return g;
+    }
     // serialize tensor
     for (DLTensor* tensor : indexer.tensor_list_) {
       std::string blob;
@@ -563,6 +579,40 @@ struct JSONGraph {
   }
 };
 
+
+/*! \brief Create the objects of a graph, given the tensors it refers to by index. */
+ObjectRef CreateObjects(JSONGraph* jgraph, const std::vector<runtime::NDArray>& tensors) {
+  ReflectionVTable* reflection = ReflectionVTable::Global();
+  size_t n_nodes = jgraph->nodes.size();
+  // Pass 1: create all non-container objects
+  std::vector<ObjectPtr<Object>> nodes(n_nodes, nullptr);
+  for (size_t i = 0; i < n_nodes; ++i) {
+    const JSONNode& jnode = jgraph->nodes[i];
+    if (jnode.type_key.length() != 0) {
+      nodes[i] = reflection->CreateInitObject(jnode.type_key, jnode.repr_bytes);
+    }
+  }
+  // Pass 2: figure out all field dependency
+  {
+    FieldDependencyFinder dep_finder;
+    for (size_t i = 0; i < n_nodes; ++i) {
+      dep_finder.Find(nodes[i].get(), &jgraph->nodes[i]);
+    }
+  }
+  // Pass 3: topo sort
+  std::vector<size_t> topo_order = jgraph->TopoSort();
+  // Pass 4: set all values
+  {
+    JSONAttrSetter setter;
+    setter.node_list_ = &nodes;
+    setter.tensor_list_ = &tensors;
+    for (size_t i : topo_order) {
+      setter.Set(&nodes[i], &jgraph->nodes[i]);
+    }
+  }
+  return ObjectRef(nodes.at(jgraph->root));
+}
+
 std::string SaveJSON(const ObjectRef& n) {
   auto jgraph = JSONGraph::Create(n);
   std::ostringstream os;
@@ -572,7 +622,6 @@ std::string SaveJSON(const ObjectRef& n) {
 }
 
 ObjectRef LoadJSON(std::string json_str) {
-  ReflectionVTable* reflection = ReflectionVTable::Global();
   JSONGraph jgraph;
   {
     // load in json graph.
@@ -580,7 +629,6 @@ ObjectRef LoadJSON(std::string json_str) {
     dmlc::JSONReader reader(&is);
     jgraph.Load(&reader);
   }
-  size_t n_nodes = jgraph.nodes.size();
   std::vector<runtime::NDArray> tensors;
   {
     // load in tensors
@@ -593,36 +641,301 @@ ObjectRef LoadJSON(std::string json_str) {
       tensors.emplace_back(std::move(temp));
     }
   }
-  // Pass 1: create all non-container objects
-  std::vector<ObjectPtr<Object>> nodes(n_nodes, nullptr);
-  for (size_t i = 0; i < n_nodes; ++i) {
-    const JSONNode& jnode = jgraph.nodes[i];
-    if (jnode.type_key.length() != 0) {
-      nodes[i] = reflection->CreateInitObject(jnode.type_key, jnode.repr_bytes);
-    }
+  return CreateObjects(&jgraph, tensors);
+}
+
+/*!
+ * The binary format holds the same graph as the json format:
+ *
+ *  - The magic number, the version and the header, which has the graph with its type keys and
+ *    attribute keys interned in a string table, and the entries of the tensors.
+ *  - The raw bytes of the tensors, each aligned to kBinaryTensorAlignment from the start of the
+ *    format, so that the tensors of a mapped file can reference the mapping in place.
+ */
+constexpr uint64_t kTVMBinaryGraphMagic = 0xF7E58D4F0A3B21C9;
+constexpr uint64_t kTVMBinaryGraphVersion = 1;
+constexpr uint64_t kBinaryTensorAlignment = 64;
+/*! \brief The size of the magic number, the version and the header length. */
+constexpr uint64_t kBinaryPrefixBytes = 3 * sizeof(uint64_t);
+
+inline uint64_t AlignTensorOffset(uint64_t offset) {
+  return (offset + kBinaryTensorAlignment - 1) / kBinaryTensorAlignment * kBinaryTensorAlignment;
+}
+
+/*! \brief The entry of a tensor in the binary format. */
+struct BinaryTensorEntry {
+  DLDataType dtype;
+  std::vector<int64_t> shape;
+  /*! \brief The offset of the bytes from the first aligned position after the header. */
+  uint64_t offset;
+  uint64_t num_bytes;
+
+  void Save(dmlc::Stream* strm) const {
+    strm->Write(dtype);
+    strm->Write(shape);
+    strm->Write(offset);
+    strm->Write(num_bytes);
   }
-  // Pass 2: figure out all field dependency
-  {
-    FieldDependencyFinder dep_finder;
-    for (size_t i = 0; i < n_nodes; ++i) {
-      dep_finder.Find(nodes[i].get(), &jgraph.nodes[i]);
+
+  bool Load(dmlc::Stream* strm) {
+    return strm->Read(&dtype) && strm->Read(&shape) && strm->Read(&offset) &&
+           strm->Read(&num_bytes);
+  }
+};
+
+/*! \brief The header of the binary format. */
+struct BinaryGraphHeader {
+  JSONGraph graph;
+  std::vector<BinaryTensorEntry> tensors;
+
+  void Save(dmlc::Stream* strm) const {
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint64_t> string_index;
+    auto intern = [&](const std::string& str) {
+      auto it = string_index.emplace(str, strings.size()).first;
+      if (it->second == strings.size()) strings.push_back(str);
+      return it->second;
+    };
+    // The nodes are written after the string table, which is complete once they are written.
+    std::string nodes;
+    dmlc::MemoryStringStream nodes_strm(&nodes);
+    nodes_strm.Write(static_cast<uint64_t>(graph.nodes.size()));
+    for (const JSONNode& jnode : graph.nodes) {
+      nodes_strm.Write(intern(jnode.type_key));
+      nodes_strm.Write(jnode.repr_bytes);
+      nodes_strm.Write(static_cast<uint64_t>(jnode.attrs.size()));
+      for (const auto& kv : jnode.attrs) {
+        nodes_strm.Write(intern(kv.first));
+        nodes_strm.Write(kv.second);
+      }
+      std::vector<uint64_t> keys;
+      for (const std::string& key : jnode.keys) keys.push_back(intern(key));
+      nodes_strm.Write(keys);
+      nodes_strm.Write(std::vector<uint64_t>(jnode.data.begin(), jnode.data.end()));
+    }
+    strm->Write(static_cast<uint64_t>(graph.root));
+    strm->Write(static_cast<uint64_t>(graph.attrs.size()));
+    for (const auto& kv : graph.attrs) {
+      strm->Write(kv.first);
+      strm->Write(kv.second);
+    }
+    strm->Write(strings);
+    strm->Write(nodes.data(), nodes.size());
+    strm->Write(static_cast<uint64_t>(tensors.size()));
+    for (const BinaryTensorEntry& entry : tensors) entry.Save(strm);
+  }
+
+  bool Load(dmlc::Stream* strm) {
+    uint64_t root, num_attrs, num_nodes, num_tensors;
+    if (!strm->Read(&root) || !strm->Read(&num_attrs)) return false;
+    graph.root = root;
+    for (uint64_t i = 0; i < num_attrs; ++i) {
+      std::string key, value;
+      if (!strm->Read(&key) || !strm->Read(&value)) return false;
+      graph.attrs[key] = value;
+    }
+    std::vector<std::string> strings;
+    if (!strm->Read(&strings) || !strm->Read(&num_nodes)) return false;
+    auto lookup = [&](uint64_t index) -> const std::string& {
+      ICHECK_LT(index, strings.size()) << "Invalid string index in the binary format";
+      return strings[index];
+    };
+    graph.nodes.resize(num_nodes);
+    for (JSONNode& jnode : graph.nodes) {
+      uint64_t type_key, num_node_attrs;
+      if (!strm->Read(&type_key) || !strm->Read(&jnode.repr_bytes)) return false;
+      jnode.type_key = lookup(type_key);
+      if (!strm->Read(&num_node_attrs)) return false;
+      for (uint64_t i = 0; i < num_node_attrs; ++i) {
+        uint64_t key;
+        std::string value;
+        if (!strm->Read(&key) || !strm->Read(&value)) return false;
+        jnode.attrs[lookup(key)] = std::move(value);
+      }
+      std::vector<uint64_t> keys, data;
+      if (!strm->Read(&keys) || !strm->Read(&data)) return false;
+      for (uint64_t key : keys) jnode.keys.push_back(lookup(key));
+      jnode.data.assign(data.begin(), data.end());
+    }
+    if (!strm->Read(&num_tensors)) return false;
+    tensors.resize(num_tensors);
+    for (BinaryTensorEntry& entry : tensors) {
+      if (!entry.Load(strm)) return false;
     }
+    return true;
   }
-  // Pass 3: topo sort
-  std::vector<size_t> topo_order = jgraph.TopoSort();
-  // Pass 4: set all values
+};
+
+/*! \brief Read the header of the binary format, returning the position after the header. */
+uint64_t ReadBinaryHeader(dmlc::Stream* strm, BinaryGraphHeader* header) {
+  uint64_t magic, version;
+  std::string header_bytes;
+  ICHECK(strm->Read(&magic) && magic == kTVMBinaryGraphMagic)
+      << "The data is not in the binary format of TVM objects";
+  ICHECK(strm->Read(&version) && version == kTVMBinaryGraphVersion)
+      << "Unsupported version " << version << " of the binary format of TVM objects";
+  ICHECK(strm->Read(&header_bytes)) << "Invalid header of the binary format of TVM objects";
+  dmlc::MemoryStringStream header_strm(&header_bytes);
+  ICHECK(header->Load(&header_strm)) << "Invalid header of the binary format of TVM objects";
+  return kBinaryPrefixBytes + header_bytes.size();
+}
+
+void SaveBinary(const ObjectRef& n, dmlc::Stream* strm) {
+  std::vector<DLTensor*> tensors;
+  BinaryGraphHeader header;
+  header.graph = JSONGraph::Create(n, &tensors);
+  uint64_t offset = 0;
+  for (DLTensor* tensor : tensors) {
+    BinaryTensorEntry entry;
+    entry.dtype = tensor->dtype;
+    entry.shape.assign(tensor->shape, tensor->shape + tensor->ndim);
+    entry.offset = offset;
+    entry.num_bytes = runtime::GetDataSize(*tensor);
+    offset = AlignTensorOffset(offset + entry.num_bytes);
+    header.tensors.push_back(std::move(entry));
+  }
+  std::string header_bytes;
   {
-    JSONAttrSetter setter;
-    setter.node_list_ = &nodes;
-    setter.tensor_list_ = &tensors;
-    for (size_t i : topo_order) {
-      setter.Set(&nodes[i], &jgraph.nodes[i]);
+    dmlc::MemoryStringStream header_strm(&header_bytes);
+    header.Save(&header_strm);
+  }
+  strm->Write(kTVMBinaryGraphMagic);
+  strm->Write(kTVMBinaryGraphVersion);
+  strm->Write(header_bytes);
+  uint64_t pos = kBinaryPrefixBytes + header_bytes.size();
+  const uint64_t base = AlignTensorOffset(pos);
+  const std::string padding(kBinaryTensorAlignment, '\0');
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    const BinaryTensorEntry& entry = header.tensors[i];
+    strm->Write(padding.data(), base + entry.offset - pos);
+    // The bytes of the host tensors are written from the tensors themselves.
+    DLTensor* tensor = tensors[i];
+    runtime::NDArray staged;
+    if (tensor->device.device_type != kDLCPU || !runtime::IsContiguous(*tensor) ||
+        !DMLC_IO_NO_ENDIAN_SWAP) {
+      staged = runtime::NDArray::Empty(entry.shape, tensor->dtype, Device{kDLCPU, 0});
+      staged.CopyFrom(tensor);
+      if (!DMLC_IO_NO_ENDIAN_SWAP) {
+        dmlc::ByteSwap(staged->data, (entry.dtype.bits + 7) / 8,
+                       entry.num_bytes / ((entry.dtype.bits + 7) / 8));
+      }
+      tensor = const_cast<DLTensor*>(staged.operator->());
     }
+    strm->Write(static_cast<char*>(tensor->data) + tensor->byte_offset, entry.num_bytes);
+    pos = base + entry.offset + entry.num_bytes;
+  }
+}
+
+ObjectRef LoadBinary(dmlc::Stream* strm) {
+  BinaryGraphHeader header;
+  uint64_t pos = ReadBinaryHeader(strm, &header);
+  const uint64_t base = AlignTensorOffset(pos);
+  std::vector<runtime::NDArray> tensors;
+  std::string padding(kBinaryTensorAlignment, '\0');
+  for (const BinaryTensorEntry& entry : header.tensors) {
+    uint64_t padding_bytes = base + entry.offset - pos;
+    ICHECK(padding_bytes <= padding.size() &&
+           strm->Read(&padding[0], padding_bytes) == padding_bytes)
+        << "Invalid tensor offset in the binary format of TVM objects";
+    runtime::NDArray tensor = runtime::NDArray::Empty(entry.shape, entry.dtype, Device{kDLCPU, 0});
+    ICHECK_EQ(runtime::GetDataSize(*tensor.operator->()), entry.num_bytes);
+    ICHECK_EQ(strm->Read(tensor->data, entry.num_bytes), entry.num_bytes)
+        << "The tensor data is truncated in the binary format of TVM objects";
+    if (!DMLC_IO_NO_ENDIAN_SWAP) {
+      dmlc::ByteSwap(tensor->data, (entry.dtype.bits + 7) / 8,
+                     entry.num_bytes / ((entry.dtype.bits + 7) / 8));
+    }
+    tensors.push_back(tensor);
+    pos = base + entry.offset + entry.num_bytes;
+  }
+  return CreateObjects(&header.graph, tensors);
+}
+
+std::string SaveBinary(const ObjectRef& n) {
+  std::string data;
+  dmlc::MemoryStringStream strm(&data);
+  SaveBinary(n, &strm);
+  return data;
+}
+
+ObjectRef LoadBinary(const std::string& data) {
+  dmlc::MemoryFixedSizeStream strm(const_cast<char*>(data.data()), data.size());
+  return LoadBinary(&strm);
+}
+
+bool IsBinaryFormat(const std::string& data) {
+  uint64_t magic;
+  if (data.size() < sizeof(magic)) return false;
+  std::memcpy(&magic, data.data(), sizeof(magic));
+  return magic == kTVMBinaryGraphMagic;
+}
+
+namespace {
+/*! \brief A stream over a file, so that the tensors are not held in memory twice. */
+class FileStream : public dmlc::Stream {
+ public:
+  FileStream(const std::string& path, std::ios::openmode mode) : fs_(path, mode) {
+    ICHECK(!fs_.fail()) << "Cannot open " << path;
+  }
+  size_t Read(void* ptr, size_t size) final {
+    fs_.read(static_cast<char*>(ptr), size);
+    return fs_.gcount();
+  }
+  void Write(const void* ptr, size_t size) final {
+    fs_.write(static_cast<const char*>(ptr), size);
+    ICHECK(!fs_.fail()) << "Failed to write the file";
   }
-  return ObjectRef(nodes.at(jgraph.root));
+  using dmlc::Stream::Read;
+  using dmlc::Stream::Write;
+
+ private:
+  std::fstream fs_;
+};
+}  // namespace
+
+void SaveBinaryToFile(const ObjectRef& n, const std::string& path) {
+  FileStream strm(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  SaveBinary(n, &strm);
+}
+
+ObjectRef LoadBinaryFromFile(const std::string& path, bool use_mmap) {
+  std::shared_ptr<support::MappedFile> mapped_file =
+      use_mmap ? support::MappedFile::Open(path) : nullptr;
+  if (mapped_file == nullptr || !DMLC_IO_NO_ENDIAN_SWAP) {
+    FileStream strm(path, std::ios::in | std::ios::binary);
+    return LoadBinary(&strm);
+  }
+  // The tensors reference the mapping, so that the pages are only read when first touched.
+  dmlc::MemoryFixedSizeStream strm(mapped_file->data, mapped_file->size);
+  BinaryGraphHeader header;
+  const uint64_t base = AlignTensorOffset(ReadBinaryHeader(&strm, &header));
+  std::vector<runtime::NDArray> tensors;
+  for (const BinaryTensorEntry& entry : header.tensors) {
+    ICHECK_LE(base + entry.offset + entry.num_bytes, mapped_file->size)
+        << "The tensor data is truncated in the binary format of TVM objects";
+    char* data = mapped_file->data + base + entry.offset;
+    tensors.push_back(support::ViewMappedNDArray(mapped_file, data, entry.shape, entry.dtype));
+  }
+  return CreateObjects(&header.graph, tensors);
 }
 
 TVM_REGISTER_GLOBAL("node.SaveJSON").set_body_typed(SaveJSON);
 
 TVM_REGISTER_GLOBAL("node.LoadJSON").set_body_typed(LoadJSON);
+
+TVM_REGISTER_GLOBAL("node.SaveBinary").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::string data = SaveBinary(args[0].operator ObjectRef());
+  TVMByteArray arr;
+  arr.data = data.data();
+  arr.size = data.size();
+  *rv = arr;
+});
+
+TVM_REGISTER_GLOBAL("node.LoadBinary").set_body_typed([](std::string data) {
+  return LoadBinary(data);
+});
+
+TVM_REGISTER_GLOBAL("node.SaveBinaryToFile").set_body_typed(SaveBinaryToFile);
+
+TVM_REGISTER_GLOBAL("node.LoadBinaryFromFile").set_body_typed(LoadBinaryFromFile);
 }  // namespace tvm
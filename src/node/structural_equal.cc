@@ -24,6 +24,7 @@
 #include <tvm/node/node.h>
 #include <tvm/node/reflection.h>
 #include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
 #include <tvm/runtime/registry.h>
 
 #include <unordered_map>
@@ -234,4 +235,27 @@ bool StructuralEqual::operator()(const ObjectRef& lhs, const ObjectRef& rhs) con
   return RemapVarSEqualHandler(false).Equal(lhs, rhs, false);
 }
 
+/*!
+ * \brief Structural equality short-circuited by the identity and the cached hash values.
+ *
+ *  An object is equal to itself whether the free vars are mapped or not, and the hash values of
+ *  structurally equal objects, with the same map_free_vars, are equal.
+ */
+static bool CachedEqual(const ObjectRef& lhs, const ObjectRef& rhs, bool map_free_vars) {
+  if (lhs.same_as(rhs)) return true;
+  if (!lhs.defined() || !rhs.defined() || lhs->type_index() != rhs->type_index()) return false;
+  StructuralHashCache* cache = StructuralHashCache::Global();
+  if (cache->Hash(lhs, map_free_vars) != cache->Hash(rhs, map_free_vars)) return false;
+  return RemapVarSEqualHandler(false).Equal(lhs, rhs, map_free_vars);
+}
+
+TVM_REGISTER_GLOBAL("node.CachedStructuralEqual")
+    .set_body_typed([](const ObjectRef& lhs, const ObjectRef& rhs, bool map_free_vars) {
+      return CachedEqual(lhs, rhs, map_free_vars);
+    });
+
+bool CachedStructuralEqual::operator()(const ObjectRef& lhs, const ObjectRef& rhs) const {
+  return CachedEqual(lhs, rhs, false);
+}
+
 }  // namespace tvm
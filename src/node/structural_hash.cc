@@ -265,6 +265,46 @@ size_t StructuralHash::operator()(const ObjectRef& object) const {
   return VarCountingSHashHandler().Hash(object, false);
 }
 
+size_t StructuralHashCache::Hash(const ObjectRef& object, bool map_free_vars) {
+  if (!object.defined()) return VarCountingSHashHandler().Hash(object, map_free_vars);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(object.get());
+    if (it != entries_.end() && it->second.hashed[map_free_vars]) {
+      ++num_hits_;
+      return it->second.hash[map_free_vars];
+    }
+  }
+  // Hash outside of the lock, so that threads hashing different objects do not wait.
+  size_t hash_value = VarCountingSHashHandler().Hash(object, map_free_vars);
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++num_misses_;
+  if (entries_.size() >= capacity_ && !entries_.count(object.get())) entries_.clear();
+  auto it = entries_.emplace(object.get(), Entry{object, {0, 0}, {false, false}}).first;
+  it->second.hash[map_free_vars] = hash_value;
+  it->second.hashed[map_free_vars] = true;
+  return hash_value;
+}
+
+void StructuralHashCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.clear();
+}
+
+StructuralHashCache* StructuralHashCache::Global() {
+  static StructuralHashCache* inst = new StructuralHashCache();
+  return inst;
+}
+
+TVM_REGISTER_GLOBAL("node.CachedStructuralHash")
+    .set_body_typed([](const ObjectRef& object, bool map_free_vars) -> int64_t {
+      return static_cast<int64_t>(StructuralHashCache::Global()->Hash(object, map_free_vars));
+    });
+
+TVM_REGISTER_GLOBAL("node.StructuralHashCacheClear").set_body_typed([]() {
+  StructuralHashCache::Global()->Clear();
+});
+
 // SEQualReduce traits for runtime containers.
 struct StringObjTrait {
   static constexpr const std::nullptr_t VisitAttrs = nullptr;
@@ -96,16 +96,20 @@ Doc& Doc::operator<<(const DocAtom& right) {
 
 std::string Doc::str() {
   std::ostringstream os;
-  for (auto atom : this->stream_) {
+  this->Write(os);
+  return os.str();
+}
+
+void Doc::Write(std::ostream& os, int indent) const {
+  for (const DocAtom& atom : this->stream_) {
     if (auto* text = atom.as<DocTextNode>()) {
       os << text->str;
     } else if (auto* line = atom.as<DocLineNode>()) {
-      os << "\n" << std::string(line->indent, ' ');
+      os << "\n" << std::string(indent + line->indent, ' ');
     } else {
       LOG(FATAL) << "do not expect type " << atom->GetTypeKey();
     }
   }
-  return os.str();
 }
 
 Doc Doc::NewLine(int indent) { return Doc() << DocLine(indent); }
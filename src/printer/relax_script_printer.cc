@@ -27,6 +27,8 @@
 #include <tvm/relax/utils.h>
 
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 #include <utility>
 
 #include "doc.h"
@@ -51,6 +53,14 @@ Doc RelaxScriptPrinter::Print(const ObjectRef& node) {
   }
 }
 
+void RelaxScriptPrinter::Print(const ObjectRef& node, std::ostream& os) {
+  if (node->IsInstance<IRModuleNode>()) {
+    PrintIRModule(Downcast<IRModule>(node), os);
+  } else {
+    Print(node).Write(os);
+  }
+}
+
 Doc RelaxScriptPrinter::VisitNode_(const relay::TupleNode* op) {
   size_t num_fields = op->fields.size();
 
@@ -491,6 +501,23 @@ Doc RelaxScriptPrinter::VisitAttr_(const tir::FloatImmNode* op) {
 }
 
 Doc RelaxScriptPrinter::PrintIRModule(const IRModule& mod) {
+  Doc doc = PrintModuleHeader();
+  for (const std::pair<GlobalVar, BaseFunc>& pr : mod->functions) {
+    doc << Doc::Indent(4, Doc::NewLine() << PrintModuleFunction(pr.first, pr.second));
+  }
+  return doc;
+}
+
+void RelaxScriptPrinter::PrintIRModule(const IRModule& mod, std::ostream& os) {
+  PrintModuleHeader().Write(os);
+  for (const std::pair<GlobalVar, BaseFunc>& pr : mod->functions) {
+    // the Doc of a function is dropped once it is written
+    os << "\n" << std::string(4, ' ');
+    PrintModuleFunction(pr.first, pr.second).Write(os, 4);
+  }
+}
+
+Doc RelaxScriptPrinter::PrintModuleHeader() {
   Doc doc;
   if (ShowMetaData()) {
     doc << "@tvm.script.ir_module(metadata=metadata)" << Doc::NewLine();
@@ -498,18 +525,16 @@ Doc RelaxScriptPrinter::PrintIRModule(const IRModule& mod) {
     doc << "@tvm.script.ir_module" << Doc::NewLine();
   }
   doc << "class Module:";
-  for (const std::pair<GlobalVar, BaseFunc>& pr : mod->functions) {
-    Doc func;
-    if (pr.second.as<tir::PrimFuncNode>()) {
-      func = PrintPrimFunc(pr.first->name_hint, Downcast<tir::PrimFunc>(pr.second));
-    } else {
-      func = Print(pr.second);
-    }
-    doc << Doc::Indent(4, Doc::NewLine() << func);
-  }
   return doc;
 }
 
+Doc RelaxScriptPrinter::PrintModuleFunction(const GlobalVar& gv, const BaseFunc& func) {
+  if (func.as<tir::PrimFuncNode>()) {
+    return PrintPrimFunc(gv->name_hint, Downcast<tir::PrimFunc>(func));
+  }
+  return Print(func);
+}
+
 Doc RelaxScriptPrinter::PrintPrimFunc(const String& name, const tir::PrimFunc& func) {
   // we need the mod for TVMScriptPrinter to properly print the function name - maybe it's worth
   // refactoring to avoid this?
@@ -654,15 +679,27 @@ Doc RelaxScriptPrinter::GetUniqueName(std::string prefix, std::string fallback =
 bool RelaxScriptPrinter::ShowMetaData() { return show_meta_data_; }
 
 String AsRelaxScript(const ObjectRef& mod, bool show_meta_data) {
+  std::ostringstream os;
+  WriteRelaxScript(mod, show_meta_data, os);
+  return os.str();
+}
+
+void WriteRelaxScript(const ObjectRef& mod, bool show_meta_data, std::ostream& os) {
   ICHECK(mod->IsInstance<IRModuleNode>() || mod->IsInstance<relax::FunctionNode>() ||
          mod->IsInstance<tir::PrimFuncNode>());
-  Doc doc;
   runtime::TypedPackedFunc<std::string(ObjectRef)> ftyped = nullptr;
-  doc << TextPrinter(show_meta_data, ftyped).PrintRelax(mod);
-  return doc.str();
+  TextPrinter(show_meta_data, ftyped).PrintRelax(mod, os);
 }
 
 TVM_REGISTER_GLOBAL("script.AsRelaxScript").set_body_typed(AsRelaxScript);
 
+TVM_REGISTER_GLOBAL("script.SaveRelaxScript")
+    .set_body_typed([](const ObjectRef& mod, String path, bool show_meta_data) {
+      std::ofstream fs(path);
+      ICHECK(fs) << "Cannot open " << path << " to write the Relax script.";
+      WriteRelaxScript(mod, show_meta_data, fs);
+      ICHECK(fs) << "Failed to write the Relax script to " << path;
+    });
+
 }  // namespace relax
 }  // namespace tvm
@@ -38,6 +38,7 @@
 #include <tvm/tir/stmt_functor.h>
 #include <tvm/tir/var.h>
 
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -247,6 +248,13 @@ class RelaxScriptPrinter : public relax::IRFunctor<Doc(const ObjectRef&)>,
   explicit RelaxScriptPrinter(bool show_meta_data, TextMetaDataContext* meta)
       : show_meta_data_(show_meta_data), meta_(meta) {}
   TVM_DLL Doc Print(const ObjectRef& node);
+  /*!
+   * \brief Print the node to the output stream. The functions of an IRModule are printed and
+   *  written one at a time, so the Doc of the whole module is never built.
+   * \param node The node to be printed.
+   * \param os The output stream.
+   */
+  TVM_DLL void Print(const ObjectRef& node, std::ostream& os);
   bool ShowMetaData();
 
  private:
@@ -294,6 +302,9 @@ class RelaxScriptPrinter : public relax::IRFunctor<Doc(const ObjectRef&)>,
   Doc VisitExpr_(const tir::MaxNode* op) override;
 
   Doc PrintIRModule(const IRModule& mod);
+  void PrintIRModule(const IRModule& mod, std::ostream& os);
+  Doc PrintModuleHeader();
+  Doc PrintModuleFunction(const GlobalVar& gv, const BaseFunc& func);
   Doc PrintPrimFunc(const String& name, const tir::PrimFunc& func);
 
   Doc PrintIfStmt(const relax::Var& var, const relay::If& ite);
@@ -361,6 +372,15 @@ class RelaxScriptPrinter : public relax::IRFunctor<Doc(const ObjectRef&)>,
 
 String AsRelaxScript(const ObjectRef& mod, bool show_meta_data);
 
+/*!
+ * \brief Write the Relax script of the node to the output stream, without building the whole
+ *  script in memory when there is no meta data to show.
+ * \param mod The node to be printed.
+ * \param show_meta_data Whether to print the meta data section.
+ * \param os The output stream.
+ */
+void WriteRelaxScript(const ObjectRef& mod, bool show_meta_data, std::ostream& os);
+
 }  // namespace relax
 }  // namespace tvm
 
@@ -620,6 +640,23 @@ class TextPrinter {
     return doc;
   }
 
+  void PrintRelax(const ObjectRef& node, std::ostream& os) {
+    if (!show_meta_data_) {
+      relax_text_printer_.Print(node, os);
+      return;
+    }
+    // the meta data section goes first but is only complete once the node is printed, the node
+    // is printed once to a buffered string rather than twice as Docs.
+    std::ostringstream body;
+    relax_text_printer_.Print(node, body);
+    if (!meta_.empty()) {
+      os << "metadata = ";
+      meta_.GetMetaSection().Write(os);
+      os << "\n";
+    }
+    os << body.str();
+  }
+
   Doc PrintMod(const IRModule& mod);
 };
 }  // namespace tvm
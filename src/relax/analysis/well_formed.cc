@@ -40,7 +40,9 @@
 #include <tvm/relax/expr_functor.h>
 #include <tvm/tir/expr_functor.h>
 
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace tvm {
 namespace relax {
@@ -319,5 +321,117 @@ TVM_REGISTER_GLOBAL(("relax.analysis.well_formed")).set_body_typed([](IRModule m
   return WellFormed(m);
 });
 
+/*!
+ * \brief Check the modules of a pass pipeline, skipping the functions found well formed by a
+ * previous check. The functions are immutable, so a function which is the same object as a
+ * function found well formed is still well formed, as long as the GlobalVars it may refer to are
+ * still defined.
+ */
+class IncrementalWellFormedChecker {
+ public:
+  bool Check(const IRModule& m) {
+    std::unordered_set<const GlobalVarNode*> global_vars;
+    for (const auto& it : m->functions) global_vars.insert(it.first.get());
+    // A removed GlobalVar may be referred to by the functions checked before.
+    for (const GlobalVar& var : checked_global_vars_) {
+      if (!global_vars.count(var.get())) {
+        checked_.clear();
+        break;
+      }
+    }
+
+    WellFormedChecker checker(NullOpt);
+    for (const auto& it : m->functions) checker.RegisterGlobalVar(it.first);
+    std::unordered_map<const FunctionNode*, Function> checked;
+    bool well_formed = true;
+    for (const auto& it : m->functions) {
+      const auto* func = it.second.as<FunctionNode>();
+      if (func == nullptr) continue;
+      auto cached = checked_.find(func);
+      if (cached != checked_.end()) {
+        checked.insert(*cached);
+        continue;
+      }
+      checker.well_formed = true;
+      checker.VisitExpr(GetRef<Function>(func));
+      if (checker.well_formed) {
+        checked.emplace(func, GetRef<Function>(func));
+      } else {
+        well_formed = false;
+      }
+    }
+
+    // Only the functions of the last module are kept, which keeps their addresses from being
+    // reused by new functions.
+    checked_ = std::move(checked);
+    checked_global_vars_.clear();
+    for (const auto& it : m->functions) checked_global_vars_.push_back(it.first);
+    return well_formed;
+  }
+
+ private:
+  /*! \brief The functions found well formed, held to keep them alive. */
+  std::unordered_map<const FunctionNode*, Function> checked_;
+  /*! \brief The GlobalVars defined at the last check. */
+  std::vector<GlobalVar> checked_global_vars_;
+};
+
+/*! \brief A pass instrument checking the input and output modules of the passes. */
+class WellFormedInstrumentNode : public instrument::PassInstrumentNode {
+ public:
+  /*! \brief The names of the passes whose modules are not checked. */
+  Array<String> skip_passes;
+  /*! \brief Whether to only check the functions which changed since the last check. */
+  bool incremental;
+
+  void VisitAttrs(AttrVisitor* v) {
+    v->Visit("name", &name);
+    v->Visit("skip_passes", &skip_passes);
+    v->Visit("incremental", &incremental);
+  }
+
+  void EnterPassContext() const final { checker_ = IncrementalWellFormedChecker(); }
+
+  void ExitPassContext() const final { checker_ = IncrementalWellFormedChecker(); }
+
+  bool ShouldRun(const IRModule& mod, const transform::PassInfo& info) const final { return true; }
+
+  void RunBeforePass(const IRModule& mod, const transform::PassInfo& info) const final {
+    Check(mod, info, "input");
+  }
+
+  void RunAfterPass(const IRModule& mod, const transform::PassInfo& info) const final {
+    Check(mod, info, "output");
+  }
+
+  static constexpr const char* _type_key = "relax.instrument.WellFormedInstrument";
+  TVM_DECLARE_FINAL_OBJECT_INFO(WellFormedInstrumentNode, PassInstrumentNode);
+
+ private:
+  void Check(const IRModule& mod, const transform::PassInfo& info, const char* kind) const {
+    for (const String& pass : skip_passes) {
+      if (pass == info->name) return;
+    }
+    bool well_formed = incremental ? checker_.Check(mod) : WellFormed(mod);
+    ICHECK(well_formed) << "The " << kind << " module of pass " << info->name
+                        << " is not well formed";
+  }
+
+  /*! \brief The checker memoizing the functions found well formed. */
+  mutable IncrementalWellFormedChecker checker_;
+};
+
+instrument::PassInstrument WellFormedInstrument(Array<String> skip_passes, bool incremental) {
+  auto n = make_object<WellFormedInstrumentNode>();
+  n->name = "WellFormedInstrument";
+  n->skip_passes = std::move(skip_passes);
+  n->incremental = incremental;
+  return instrument::PassInstrument(n);
+}
+
+TVM_REGISTER_NODE_TYPE(WellFormedInstrumentNode);
+
+TVM_REGISTER_GLOBAL("relax.analysis.WellFormedInstrument").set_body_typed(WellFormedInstrument);
+
 }  // namespace relax
 }  // namespace tvm
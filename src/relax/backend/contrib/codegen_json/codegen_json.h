@@ -167,6 +167,9 @@ class JSONSerializer
   /*!\brief Return the required params. */
   Array<String> GetParams() const { return params_; }
 
+  /*!\brief Return the values of the required params. */
+  Array<runtime::NDArray> GetConstants() const { return constants_; }
+
   /*!\brief Return the generated json. */
   std::string GetJSON() {
     std::ostringstream os;
@@ -328,6 +331,7 @@ class JSONSerializer
   std::vector<JSONGraphNodeEntry> VisitExpr_(const ConstantNode* cn) {
     std::string name = symbol_ + "_const_" + std::to_string(params_.size());
     params_.push_back(name);
+    constants_.push_back(cn->data);
     auto node = std::make_shared<JSONGraphNode>(name, "const" /* op_type_ */);
     return AddNode(node, GetRef<Expr>(cn));
   }
@@ -421,6 +425,8 @@ class JSONSerializer
   std::vector<JSONGraphNodeEntry> heads_;
   /*! \brief The list of required constants. */
   Array<String> params_;
+  /*! \brief The values of the required constants. */
+  Array<runtime::NDArray> constants_;
 };
 
 }  // namespace contrib
@@ -0,0 +1,147 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/backend/contrib/cublas/codegen.cc
+ * \brief Implementation of the cuBLAS JSON serializer.
+ */
+#include <tvm/ir/module.h>
+#include <tvm/relax/type.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../codegen_json/codegen_json.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace relax {
+namespace contrib {
+
+using JSONGraphNode = tvm::runtime::json::JSONGraphNode;
+using JSONGraphNodeEntry = tvm::runtime::json::JSONGraphNodeEntry;
+using JSONSerializer = backend::contrib::JSONSerializer;
+
+/*!
+ * \brief Generates a cuBLAS JSON runtime module from a relax function. Each call to a "Composite"
+ * function of a matmul, optionally followed by a bias add and an activation, becomes a single
+ * cuBLASLt matmul node named cublas.matmul[_bias][_relu|_gelu], the bias and the activation
+ * running as the epilogue of the matmul.
+ */
+class CublasJSONSerializer : public JSONSerializer {
+ public:
+  CublasJSONSerializer(const std::string& symbol, const Expr& expr)
+      : JSONSerializer(symbol, expr) {}
+
+  using JSONSerializer::VisitExpr_;
+
+  std::vector<JSONGraphNodeEntry> VisitExpr_(const CallNode* call_node) final {
+    const auto* function_node = call_node->op.as<FunctionNode>();
+    CHECK(function_node != nullptr && function_node->GetAttr<String>(attr::kComposite).defined())
+        << "cuBLAS JSON runtime only supports composite functions.";
+    Function func = GetRef<Function>(function_node);
+    std::unordered_map<const VarNode*, size_t> param_index;
+    for (size_t i = 0; i < func->params.size(); ++i) param_index[func->params[i].get()] = i;
+    auto get_arg = [&](const Expr& expr) {
+      auto it = param_index.find(expr.as<VarNode>());
+      CHECK(it != param_index.end()) << "cuBLAS codegen expects the operands of the composite "
+                                     << "function to be its parameters";
+      return VisitExpr(call_node->args[it->second]);
+    };
+
+    // The ops of the composite function, in binding order.
+    static const Op& matmul_op = Op::Get("relax.matmul");
+    static const Op& add_op = Op::Get("relax.add");
+    static const Op& relu_op = Op::Get("relax.nn.relu");
+    static const Op& gelu_op = Op::Get("relax.nn.gelu");
+    std::vector<JSONGraphNodeEntry> inputs;
+    std::string name;
+    const VarNode* product = nullptr;
+    for (const VarBinding& binding : GetBindings(func)) {
+      const auto* call = binding->value.as<CallNode>();
+      CHECK(call != nullptr) << "cuBLAS codegen expects a chain of calls";
+      if (call->op == matmul_op) {
+        CHECK(name.empty()) << "Only one matmul can be offloaded per composite function";
+        for (const Expr& arg : call->args) {
+          auto entries = get_arg(arg);
+          inputs.insert(inputs.end(), entries.begin(), entries.end());
+        }
+        name = "cublas.matmul";
+      } else if (call->op == add_op && name == "cublas.matmul") {
+        // The bias is the operand of the add which is not the product.
+        const Expr& bias = call->args[0].get() == product ? call->args[1] : call->args[0];
+        auto entries = get_arg(bias);
+        inputs.insert(inputs.end(), entries.begin(), entries.end());
+        name += "_bias";
+      } else if ((call->op == relu_op || call->op == gelu_op) && name == "cublas.matmul_bias") {
+        name += call->op == relu_op ? "_relu" : "_gelu";
+      } else {
+        LOG(FATAL) << "cuBLAS codegen does not support " << binding->value << " after " << name;
+      }
+      product = binding->var.get();
+    }
+
+    auto node = std::make_shared<JSONGraphNode>(name,     /* name_ */
+                                                "kernel", /* op_type_ */
+                                                inputs, 1 /* num_outputs_ */);
+    return AddNode(node, GetRef<Expr>(call_node));
+  }
+
+ private:
+  /*! \brief Get the bindings of the body of the composite function \p func. */
+  static std::vector<VarBinding> GetBindings(const Function& func) {
+    const auto* seq = func->body.as<SeqExprNode>();
+    CHECK(seq != nullptr) << "cuBLAS codegen expects composite functions of a SeqExpr body";
+    std::vector<VarBinding> bindings;
+    for (const BindingBlock& block : seq->blocks) {
+      for (const Binding& binding : block->bindings) {
+        bindings.push_back(Downcast<VarBinding>(binding));
+      }
+    }
+    return bindings;
+  }
+};
+
+/*!
+ * \brief Create a runtime module for cuBLAS.
+ * \param ref The relax function to be executed by cuBLAS.
+ * \return A runtime module.
+ */
+runtime::Module CublasCompiler(const ObjectRef& ref) {
+  ICHECK(ref->IsInstance<FunctionNode>()) << "The input ref is expected to be a Relax function.";
+  Function func = Downcast<Function>(ref);
+  std::string func_name = backend::GetExtSymbol(func);
+
+  VLOG(1) << "cuBLAS partition:" << std::endl << PrettyPrint(func);
+  CublasJSONSerializer serializer(func_name, func);
+  serializer.serialize();
+  std::string graph_json = serializer.GetJSON();
+  VLOG(1) << "cuBLAS JSON:" << std::endl << graph_json;
+  const auto* pf = runtime::Registry::Get("runtime.CublasJSONRuntimeCreate");
+  ICHECK(pf != nullptr) << "Cannot find cuBLAS JSON runtime module create function.";
+  return (*pf)(func_name, graph_json, serializer.GetParams());
+}
+
+TVM_REGISTER_GLOBAL("relax.ext.cublas").set_body_typed(CublasCompiler);
+
+}  // namespace contrib
+}  // namespace relax
+}  // namespace tvm
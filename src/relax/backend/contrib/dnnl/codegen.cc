@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/backend/contrib/dnnl/codegen.cc
+ * \brief Implementation of the DNNL JSON serializer.
+ */
+#include <tvm/ir/module.h>
+#include <tvm/relax/type.h>
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../codegen_json/codegen_json.h"
+#include "../utils.h"
+
+namespace tvm {
+namespace relax {
+namespace contrib {
+
+using JSONGraphNode = tvm::runtime::json::JSONGraphNode;
+using JSONGraphNodeEntry = tvm::runtime::json::JSONGraphNodeEntry;
+using JSONSerializer = backend::contrib::JSONSerializer;
+
+/*!
+ * \brief Generates a DNNL JSON runtime module from a relax function by serializing it to a json
+ * representation, each operator becoming a DNNL primitive. The calls to "Composite" functions,
+ * e.g. created by FuseOpsByPattern, are serialized as the operators of the composite body.
+ */
+class DNNLJSONSerializer : public JSONSerializer {
+ public:
+  DNNLJSONSerializer(const std::string& symbol, const Expr& expr) : JSONSerializer(symbol, expr) {}
+
+  using JSONSerializer::VisitExpr_;
+
+  std::vector<JSONGraphNodeEntry> VisitExpr_(const CallNode* call_node) final {
+    if (const auto* function_node = call_node->op.as<FunctionNode>()) {
+      ICHECK(function_node->GetAttr<String>(attr::kComposite).defined())
+          << "DNNL JSON runtime only supports composite functions.";
+      ICHECK(function_node->params.empty() || !memo_.count(function_node->params[0]))
+          << "A composite function is expected to be called once.";
+      // Serialize the body with the params bound to the entries of the arguments.
+      for (size_t i = 0; i < call_node->args.size(); ++i) {
+        memo_[function_node->params[i]] = VisitExpr(call_node->args[i]);
+      }
+      return VisitExpr(function_node->body);
+    }
+
+    const auto* op_node = call_node->op.as<OpNode>();
+    ICHECK(op_node != nullptr) << "DNNL JSON runtime does not support calls to "
+                               << call_node->op->GetTypeKey();
+    // The DNNL runtime names the operators without the "relax." prefix.
+    static const std::unordered_set<std::string> supported_ops = {"add", "multiply"};
+    std::string name = op_node->name;
+    if (name.compare(0, 6, "relax.") == 0) name = name.substr(6);
+    CHECK(supported_ops.count(name)) << "DNNL codegen does not support " << op_node->name;
+
+    std::vector<JSONGraphNodeEntry> inputs;
+    for (const auto& arg : call_node->args) {
+      auto res = VisitExpr(arg);
+      inputs.insert(inputs.end(), res.begin(), res.end());
+    }
+    auto node = std::make_shared<JSONGraphNode>(name,     /* name_ */
+                                                "kernel", /* op_type_ */
+                                                inputs, 1 /* num_outputs_ */);
+    SetCallNodeAttribute(node, call_node);
+    return AddNode(node, GetRef<Expr>(call_node));
+  }
+};
+
+/*!
+ * \brief Create a runtime module for DNNL.
+ * \param ref The relax function to be executed by DNNL.
+ * \return A runtime module.
+ */
+runtime::Module DNNLCompiler(const ObjectRef& ref) {
+  ICHECK(ref->IsInstance<FunctionNode>()) << "The input ref is expected to be a Relax function.";
+  Function func = Downcast<Function>(ref);
+  std::string func_name = backend::GetExtSymbol(func);
+
+  VLOG(1) << "DNNL partition:" << std::endl << PrettyPrint(func);
+  DNNLJSONSerializer serializer(func_name, func);
+  serializer.serialize();
+  std::string graph_json = serializer.GetJSON();
+  VLOG(1) << "DNNL JSON:" << std::endl << graph_json;
+  const auto* pf = runtime::Registry::Get("runtime.DNNLJSONRuntimeCreate");
+  ICHECK(pf != nullptr) << "Cannot find DNNL JSON runtime module create function.";
+  return (*pf)(func_name, graph_json, serializer.GetParams());
+}
+
+TVM_REGISTER_GLOBAL("relax.ext.dnnl").set_body_typed(DNNLCompiler);
+
+}  // namespace contrib
+}  // namespace relax
+}  // namespace tvm
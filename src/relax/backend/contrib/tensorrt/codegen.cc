@@ -49,6 +49,7 @@ struct TensorRTCompilerConfigNode : public tvm::AttrsNode<TensorRTCompilerConfig
   bool remove_no_mac_subgraphs;
   bool use_fp16;
   bool use_uint8;
+  String engine_cache_dir;
 
   TVM_DECLARE_ATTRS(TensorRTCompilerConfigNode, "relax.ext.attrs.TensorRTCompilerConfigNode") {
     TVM_ATTR_FIELD(tensorrt_version)
@@ -59,6 +60,12 @@ struct TensorRTCompilerConfigNode : public tvm::AttrsNode<TensorRTCompilerConfig
     TVM_ATTR_FIELD(remove_no_mac_subgraphs).set_default(false);
     TVM_ATTR_FIELD(use_fp16).set_default(false);
     TVM_ATTR_FIELD(use_uint8).set_default(false);
+    TVM_ATTR_FIELD(engine_cache_dir)
+        .describe(
+            "When non-empty, build the engines at compile time and cache them to the directory, "
+            "e.g. the one the library is exported to, for the runtime to load them from "
+            "TVM_TENSORRT_CACHE_DIR instead of building them on first use.")
+        .set_default("");
   }
 };
 
@@ -312,6 +319,18 @@ void CollectFromCompositeFunctionBody::VisitExpr_(const CallNode* call_node) {
   ExprVisitor::VisitExpr_(call_node);
 }
 
+/*!
+ * \brief Check whether TensorRT graph executor is enabled.
+ * \return True if enabled, False if not.
+ */
+inline constexpr bool IsTensorRTRuntimeEnabled() {
+#if TVM_GRAPH_EXECUTOR_TENSORRT
+  return true;
+#else
+  return false;
+#endif  // TVM_GRAPH_EXECUTOR_TENSORRT
+}
+
 /*!
  * \brief Create a runtime module for TensorRT.
  * \param ref The ext_func Relay expression/module to be executed using extern ops.
@@ -332,23 +351,24 @@ runtime::Module TensorRTCompiler(const ObjectRef& ref) {
   ICHECK(pf != nullptr) << "Cannot find TensorRT runtime module create function.";
   VLOG(1) << "Creating tensorrt runtime::Module for '" << func_name << "'";
   runtime::Module lib = (*pf)(func_name, graph_json, param_names);
+
+  auto cfg = transform::PassContext::Current()->GetConfig<TensorRTCompilerConfig>(
+      "relax.ext.tensorrt.options");
+  if (cfg.defined() && !cfg.value()->engine_cache_dir.empty()) {
+    if (IsTensorRTRuntimeEnabled()) {
+      VLOG(1) << "Prebuilding the TensorRT engine of '" << func_name << "'";
+      lib.GetFunction("__init_" + func_name)(serializer.GetConstants());
+      lib.GetFunction("build_engine")(cfg.value()->engine_cache_dir);
+    } else {
+      LOG(WARNING) << "The TensorRT engine of '" << func_name
+                   << "' is not prebuilt as the TensorRT runtime is not enabled";
+    }
+  }
   return lib;
 }
 
 TVM_REGISTER_GLOBAL("relax.ext.tensorrt").set_body_typed(TensorRTCompiler);
 
-/*!
- * \brief Check whether TensorRT graph executor is enabled.
- * \return True if enabled, False if not.
- */
-inline constexpr bool IsTensorRTRuntimeEnabled() {
-#if TVM_GRAPH_EXECUTOR_TENSORRT
-  return true;
-#else
-  return false;
-#endif  // TVM_GRAPH_EXECUTOR_TENSORRT
-}
-
 /*!
  * \brief Get TensorRT version that TVM is built against.
  * \return Array of three integers for major, minor, and patch, or empty array if TensorRT graph
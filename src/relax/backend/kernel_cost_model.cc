@@ -0,0 +1,150 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/backend/kernel_cost_model.cc
+ * \brief The latency oracle of the kernels called by Relax programs.
+ */
+#include <tvm/ir/transform.h>
+#include <tvm/relax/cost_model.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
+
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+TVM_REGISTER_NODE_TYPE(KernelCostModelNode);
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.kernel_cost_model", KernelCostModel);
+
+/*! \brief The mean of the measured run time, negative if the record has none. */
+static double MeanRunSecs(const meta_schedule::TuningRecord& record) {
+  if (!record->run_secs.defined() || record->run_secs.value().empty()) return -1.0;
+  double sum = 0.0;
+  for (const FloatImm& sec : record->run_secs.value()) {
+    sum += sec->value;
+  }
+  double mean = sum / record->run_secs.value().size();
+  // the failed measurements are recorded with a huge run time
+  return mean < 1e9 ? mean : -1.0;
+}
+
+/*! \brief The workload of a kernel, as the tasks extracted from Relax are committed. */
+static IRModule WorkloadMod(const tir::PrimFunc& func) {
+  return IRModule(Map<GlobalVar, BaseFunc>({{GlobalVar("main"), func}}));
+}
+
+KernelCostModel::KernelCostModel(meta_schedule::Database database, Target target,
+                                 Optional<runtime::PackedFunc> f_fallback) {
+  ObjectPtr<KernelCostModelNode> n = make_object<KernelCostModelNode>();
+  // The best latency of every workload measured on the target, to fit the throughput on.
+  std::unordered_map<const Object*, std::pair<double, double>> best;
+  for (const meta_schedule::TuningRecord& record : database->GetAllTuningRecords()) {
+    if (!record->target.defined() || record->target.value()->str() != target->str()) continue;
+    double secs = MeanRunSecs(record);
+    if (secs <= 0) continue;
+    auto it = best.find(record->workload.get());
+    if (it == best.end()) {
+      double flops = tir::EstimateTIRFlops(record->workload->mod);
+      if (flops <= 0) continue;
+      best.emplace(record->workload.get(), std::make_pair(std::log(flops), std::log(secs)));
+    } else {
+      it->second.second = std::min(it->second.second, std::log(secs));
+    }
+  }
+  // least squares of log(secs) = log_scale + exponent * log(flops)
+  double mean_x = 0.0, mean_y = 0.0;
+  for (const auto& kv : best) {
+    mean_x += kv.second.first;
+    mean_y += kv.second.second;
+  }
+  if (!best.empty()) {
+    mean_x /= best.size();
+    mean_y /= best.size();
+    double cov = 0.0, var = 0.0;
+    for (const auto& kv : best) {
+      cov += (kv.second.first - mean_x) * (kv.second.second - mean_y);
+      var += (kv.second.first - mean_x) * (kv.second.first - mean_x);
+    }
+    // a single point, or points of the same flops, only tell the throughput
+    n->exponent = var > 1e-12 ? cov / var : 1.0;
+    n->log_scale = mean_y - n->exponent * mean_x;
+  }
+  n->num_fit_records = best.size();
+  n->database = std::move(database);
+  n->target = std::move(target);
+  n->f_fallback = std::move(f_fallback);
+  data_ = std::move(n);
+}
+
+Optional<KernelCostModel> KernelCostModel::Current() {
+  return transform::PassContext::Current()->GetConfig<KernelCostModel>("relax.kernel_cost_model");
+}
+
+double KernelCostModelNode::QueryMeasured(const tir::PrimFunc& func) const {
+  IRModule mod = WorkloadMod(func);
+  if (!database->HasWorkload(mod)) return -1.0;
+  Array<meta_schedule::TuningRecord> records = database->GetTopK(database->CommitWorkload(mod), 1);
+  if (records.empty()) return -1.0;
+  return MeanRunSecs(records[0]);
+}
+
+double KernelCostModelNode::Estimate(const tir::PrimFunc& func) const {
+  auto it = cache_.find(func);
+  if (it != cache_.end()) return it->second;
+  double secs = QueryMeasured(func);
+  if (secs < 0 && f_fallback.defined()) {
+    secs = f_fallback.value()(func);
+  }
+  if (secs < 0 && num_fit_records > 0) {
+    double flops = tir::EstimateTIRFlops(WorkloadMod(func));
+    if (flops > 0) secs = std::exp(log_scale + exponent * std::log(flops));
+  }
+  cache_[func] = secs;
+  return secs;
+}
+
+double KernelCostModelNode::EstimateCallTIR(const IRModule& mod, const Call& call) const {
+  static const Op& call_tir_op = Op::Get("relax.call_tir");
+  if (!call->op.same_as(call_tir_op)) return -1.0;
+  const auto* gv = call->args[0].as<GlobalVarNode>();
+  if (gv == nullptr) return -1.0;
+  auto it = mod->functions.find(GetRef<GlobalVar>(gv));
+  if (it == mod->functions.end() || !(*it).second->IsInstance<tir::PrimFuncNode>()) return -1.0;
+  return Estimate(Downcast<tir::PrimFunc>((*it).second));
+}
+
+TVM_REGISTER_GLOBAL("relax.KernelCostModel")
+    .set_body_typed([](meta_schedule::Database database, Target target,
+                       Optional<runtime::PackedFunc> f_fallback) {
+      return KernelCostModel(database, target, f_fallback);
+    });
+TVM_REGISTER_GLOBAL("relax.KernelCostModelCurrent").set_body_typed(KernelCostModel::Current);
+TVM_REGISTER_GLOBAL("relax.KernelCostModelQueryMeasured")
+    .set_body_method<KernelCostModel>(&KernelCostModelNode::QueryMeasured);
+TVM_REGISTER_GLOBAL("relax.KernelCostModelEstimate")
+    .set_body_method<KernelCostModel>(&KernelCostModelNode::Estimate);
+TVM_REGISTER_GLOBAL("relax.KernelCostModelEstimateCallTIR")
+    .set_body_method<KernelCostModel>(&KernelCostModelNode::EstimateCallTIR);
+
+}  // namespace relax
+}  // namespace tvm
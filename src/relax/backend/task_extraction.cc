@@ -20,9 +20,13 @@
 #include <tvm/meta_schedule/extracted_task.h>
 #include <tvm/relax/expr.h>
 #include <tvm/relax/expr_functor.h>
+#include <tvm/runtime/profiling.h>
 #include <tvm/target/target.h>
 #include <tvm/tir/function.h>
 
+#include <unordered_map>
+#include <unordered_set>
+
 namespace tvm {
 namespace relax {
 namespace backend {
@@ -40,18 +44,44 @@ using tvm::meta_schedule::ExtractedTask;
  *   Suppose `fn1` is called by 5 Call-TIR ops among all Relax function,
  *   `fn2` is called by 3 Call-TIR and `fn3` is called by 5 Call-TIR.
  *   Then we will have a ExtractedTask for all three functions, whose weight
- *   is 5 + 3 + 2 = 10.
+ *   is 5 + 3 + 5 = 13.
+ *   3. When a profile report of the Relax VM is given, the weight of a task
+ *   is instead the number of calls of its PrimFuncs in the report, which
+ *   accounts for loops, recursion and the dynamic shapes actually run. The
+ *   task schedulers multiply the weight by the tuned latency of the task, so
+ *   the budget goes where the profiled time goes. The tasks which are not in
+ *   the report keep a weight of 1.
  */
 class TaskExtractor : public ExprVisitor {
  public:
-  static Array<ExtractedTask> ExtractTask(IRModule mod, Target target) {
+  static Array<ExtractedTask> ExtractTask(IRModule mod, Target target,
+                                          Optional<runtime::profiling::Report> profile) {
     TaskExtractor extracor(mod, target);
+    if (profile.defined()) {
+      extracor.use_profile_ = true;
+      for (const Map<String, ObjectRef>& call : profile.value()->calls) {
+        auto it = call.find("Name");
+        if (it == call.end() || !(*it).second->IsInstance<StringObj>()) continue;
+        int64_t count = 1;
+        if (Optional<ObjectRef> n = call.Get("Count")) {
+          if (const auto* count_node = n.value().as<runtime::profiling::CountNode>()) {
+            count = count_node->value;
+          }
+        }
+        extracor.profiled_calls_[Downcast<String>((*it).second)] += count;
+      }
+    }
     // We go through each Relax function in the module.
     for (const auto& kv : mod->functions) {
       if (const auto* func = kv.second.as<FunctionNode>()) {
         extracor(GetRef<Function>(func));
       }
     }
+    if (extracor.use_profile_) {
+      for (ExtractedTask task : extracor.tasks_) {
+        if (task->weight == 0) task->weight = 1;
+      }
+    }
     return std::move(extracor.tasks_);
   }
 
@@ -59,6 +89,15 @@ class TaskExtractor : public ExprVisitor {
   explicit TaskExtractor(IRModule mod, Target target)
       : mod_(std::move(mod)), target_(std::move(target)) {}
 
+  /*! \brief The weight a call site of a PrimFunc adds to its task. */
+  int64_t SiteWeight(const GlobalVar& global_var) {
+    if (!use_profile_) return 1;
+    // The profiled calls of a PrimFunc are added once, however many call sites it has.
+    if (!visited_.insert(global_var->name_hint).second) return 0;
+    auto it = profiled_calls_.find(global_var->name_hint);
+    return it == profiled_calls_.end() ? 0 : it->second;
+  }
+
   void VisitExpr_(const CallNode* call) final {
     static const Op& call_tir_op = Op::Get("relax.call_tir");
     if (!call->op.same_as(call_tir_op)) {
@@ -70,9 +109,10 @@ class TaskExtractor : public ExprVisitor {
     const GlobalVar& global_var = Downcast<GlobalVar>(call->args[0]);
     const tir::PrimFunc& func = Downcast<tir::PrimFunc>(mod_->Lookup(global_var));
 
+    int64_t weight = SiteWeight(global_var);
     auto it = func2task_.find(func);
     if (it != func2task_.end()) {
-      it->second->weight += 1;
+      it->second->weight += weight;
       return;
     }
 
@@ -81,7 +121,7 @@ class TaskExtractor : public ExprVisitor {
                        /*mod=*/tir_mod,                      //
                        /*target=*/target_,                   //
                        /*dispatched=*/{tir_mod},             //
-                       /*weight=*/1);
+                       /*weight=*/weight);
     tasks_.push_back(task);
     func2task_.emplace(func, task);
   }
@@ -90,11 +130,17 @@ class TaskExtractor : public ExprVisitor {
   Target target_;
   Array<ExtractedTask> tasks_;
   std::unordered_map<tir::PrimFunc, ExtractedTask, StructuralHash, StructuralEqual> func2task_;
+  /*! \brief Whether the weights come from a profile report. */
+  bool use_profile_ = false;
+  /*! \brief The number of profiled calls of each kernel, by name. */
+  std::unordered_map<std::string, int64_t> profiled_calls_;
+  /*! \brief The names of the PrimFuncs whose profiled calls are added to their task. */
+  std::unordered_set<std::string> visited_;
 };
 
 TVM_REGISTER_GLOBAL("relax.backend.MetaScheduleExtractTask")
-    .set_body_typed([](IRModule mod, Target target) {
-      return TaskExtractor::ExtractTask(std::move(mod), std::move(target));
+    .set_body_typed([](IRModule mod, Target target, Optional<runtime::profiling::Report> profile) {
+      return TaskExtractor::ExtractTask(std::move(mod), std::move(target), std::move(profile));
     });
 
 }  // namespace backend
@@ -25,6 +25,7 @@
 #include "codegen_vm.h"
 
 #include <tvm/driver/driver_api.h>
+#include <tvm/ir/transform.h>
 #include <tvm/relax/attrs/memory.h>
 #include <tvm/relax/attrs/shape.h>
 #include <tvm/relax/expr_functor.h>
@@ -32,8 +33,10 @@
 #include <tvm/target/target.h>
 #include <tvm/tir/function.h>
 
+#include <algorithm>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "../../../target/metadata_module.h"
@@ -43,6 +46,23 @@ namespace tvm {
 namespace relax {
 namespace relax_vm {
 
+/*! \brief The pass config option enabling the peephole optimization of the emitted bytecode. */
+constexpr const char* kVMCodeGenPeepholeOption = "relax.VMCodeGen.peephole";
+/*!
+ * \brief The pass config option enabling the register allocation, which lets registers whose
+ *  values are not live at the same time share a slot of the register file.
+ */
+constexpr const char* kVMCodeGenRegisterAllocationOption = "relax.VMCodeGen.register_allocation";
+/*!
+ * \brief The pass config option enabling tail calls, which run the Relax functions called in tail
+ *  position in the frame of the caller, so that recursive loops take constant memory.
+ */
+constexpr const char* kVMCodeGenTailCallOption = "relax.VMCodeGen.tail_call";
+
+TVM_REGISTER_PASS_CONFIG_OPTION(kVMCodeGenPeepholeOption, Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION(kVMCodeGenRegisterAllocationOption, Bool);
+TVM_REGISTER_PASS_CONFIG_OPTION(kVMCodeGenTailCallOption, Bool);
+
 using namespace relax;
 
 // Helper function to get the function name of the registered packed function implementation of
@@ -58,15 +78,50 @@ FCallPacked GetPackedFuncName(const Call& call) {
   return {};
 }
 
+bool ExternFuncTakesVM(const std::string& name) {
+  return name == "vm.builtin.alloc_shape_heap" || name.compare(0, 15, "vm.builtin.ccl.") == 0;
+}
+
 /*!
  * \brief A class to generate VM executable for Relax functions.
  */
 class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
  public:
-  explicit CodeGenVM(ExecBuilderNode* builder) { builder_ = GetRef<ExecBuilder>(builder); }
+  CodeGenVM(ExecBuilderNode* builder, IRModule mod, bool tail_call)
+      : mod_(mod), tail_call_(tail_call) {
+    builder_ = GetRef<ExecBuilder>(builder);
+  }
 
  protected:
   size_t NewRegister() { return registers_num_++; }
+  /*! \brief Whether the expression being visited is in tail position, which is reset on read. */
+  bool TakeTailPosition() {
+    bool tail = tail_position_;
+    tail_position_ = false;
+    return tail;
+  }
+  /*! \brief Whether the callee is a Relax function of the module, rather than a kernel. */
+  bool IsRelaxFunction(const Expr& op) const {
+    const auto* gvar = op.as<GlobalVarNode>();
+    if (gvar == nullptr) return false;
+    auto it = mod_->functions.find(GetRef<GlobalVar>(gvar));
+    return it != mod_->functions.end() && (*it).second->IsInstance<FunctionNode>();
+  }
+  /*!
+   * \brief Visit an expression in tail position when it is a sequence.
+   * \param expr The expression.
+   * \param returned Set to whether all the paths of the expression have returned.
+   * \return The register of the result when the expression has not returned.
+   */
+  Instruction::Arg VisitTailExpr(const Expr& expr, bool* returned) {
+    tail_position_ = tail_call_ && expr->IsInstance<SeqExprNode>();
+    returned_ = false;
+    Instruction::Arg ret = this->VisitExpr(expr);
+    tail_position_ = false;
+    *returned = returned_;
+    returned_ = false;
+    return ret;
+  }
   Instruction::Arg VisitExpr_(const FunctionNode* func_node) {
     Optional<String> gsymbol = func_node->GetAttr<String>(tvm::attr::kGlobalSymbol);
     ICHECK(gsymbol.defined()) << "there should be no local functions in Relax VM codegen phase. "
@@ -78,33 +133,136 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
     }
 
     builder_->EmitFunction(gsymbol.value(), func_node->params.size(), param_names);
+    builder_->SetSourceSpan(func_node->span);
 
     for (Var param : func_node->params) {
       Instruction::Arg reg = this->VisitExpr(param);
       this->var_register_map_.insert({param, reg.data});
     }
-    Instruction::Arg ret = ExprFunctor::VisitExpr(func_node->body);
-    builder_->EmitRet(ret.data);
+    // Record the variables returned by the function, whose allocations can be served by output
+    // buffers provided by the caller. A returned variable is usually an alias of the tensor,
+    // e.g. `alloc = alloc_tensor(...); z = alloc` as produced by CallTIRRewrite, so resolve it
+    // back through the var-to-var bindings to the variable bound to the allocation.
+    output_index_map_.clear();
+    if (const auto* seq = func_node->body.as<SeqExprNode>()) {
+      std::unordered_map<const VarNode*, const VarNode*> alias_of;
+      for (const BindingBlock& block : seq->blocks) {
+        for (const Binding& binding : block->bindings) {
+          const auto* var_binding = binding.as<VarBindingNode>();
+          if (var_binding == nullptr) continue;
+          if (const auto* value = var_binding->value.as<VarNode>()) {
+            alias_of[var_binding->var.get()] = value;
+          }
+        }
+      }
+      auto record_output = [&](const VarNode* var, int64_t index) {
+        output_index_map_.emplace(var, index);
+        for (auto it = alias_of.find(var); it != alias_of.end(); it = alias_of.find(var)) {
+          var = it->second;
+          output_index_map_.emplace(var, index);
+        }
+      };
+      if (const auto* var = seq->body.as<VarNode>()) {
+        record_output(var, 0);
+      } else if (const auto* tuple = seq->body.as<TupleNode>()) {
+        for (size_t i = 0; i < tuple->fields.size(); ++i) {
+          if (const auto* var = tuple->fields[i].as<VarNode>()) record_output(var, i);
+        }
+      }
+    }
+    bool returned;
+    Instruction::Arg ret = VisitTailExpr(func_node->body, &returned);
+    if (!returned) builder_->EmitRet(ret.data);
     registers_num_ = 0;
     return ret;
   }
 
   Instruction::Arg VisitExpr_(const SeqExprNode* op) {
+    bool tail = TakeTailPosition();
+    // Compute the index of the last binding that uses each variable, the body counts as the
+    // binding after the last one. Also count the number of bindings using each variable.
+    std::unordered_map<const VarNode*, size_t> last_use;
+    std::unordered_map<const VarNode*, size_t> num_using_bindings;
+    std::vector<VarBinding> bindings;
+    auto record_use = [&](const Expr& expr, size_t index) {
+      PostOrderVisit(expr, [&](const Expr& e) {
+        if (const auto* var = e.as<VarNode>()) {
+          auto it = last_use.find(var);
+          if (it == last_use.end() || it->second != index) ++num_using_bindings[var];
+          last_use[var] = index;
+        }
+      });
+    };
     for (auto block : op->blocks) {
       for (Binding binding : block->bindings) {
         ICHECK(binding->IsInstance<VarBindingNode>());
-        Expr value = Downcast<VarBinding>(binding)->value;
-        Var var = Downcast<VarBinding>(binding)->var;
+        bindings.push_back(Downcast<VarBinding>(binding));
+        record_use(bindings.back()->value, bindings.size() - 1);
+      }
+    }
+    const size_t num_bindings = bindings.size();
+    record_use(op->body, num_bindings);
+
+    // Registers created before this sequence belong to the enclosing scope and are never killed
+    // here. A register can be shared by several variables (e.g. `y = x`), so it is only killed
+    // after the last use of all of them.
+    const size_t first_owned_register = registers_num_;
+    std::unordered_map<RegName, size_t> register_last_use;
+    std::vector<std::vector<RegName>> kill_after(num_bindings);
+    for (size_t index = 0; index < num_bindings; ++index) {
+      Expr value = bindings[index]->value;
+      Var var = bindings[index]->var;
+      if (index + 1 < num_bindings && num_using_bindings[var.get()] == 1 &&
+          last_use[var.get()] == index + 1 &&
+          IsFusibleAllocStorage(bindings[index], bindings[index + 1])) {
+        // The storage is only used by the alloc_tensor that follows, both are emitted as a single
+        // call when generating the alloc_tensor.
+        fused_storage_var_ = var.get();
+        fused_storage_call_ = Downcast<Call>(value);
+        // The arguments of the storage are read by the fused call, defer releasing them.
+        for (RegName dead : kill_after[index]) {
+          if (register_last_use[dead] != index) continue;
+          register_last_use[dead] = index + 1;
+          kill_after[index + 1].push_back(dead);
+        }
+        kill_after[index].clear();
+      } else {
+        // Attribute the instructions of the binding to its source, for the pc-to-source index.
+        builder_->SetSourceSpan(bindings[index]->span.defined() ? bindings[index]->span
+                                                                : value->span);
+        binding_var_ = var.get();
+        // The last binding is in tail position when it defines the result of the sequence.
+        if (tail && index + 1 == num_bindings && op->body.same_as(var) &&
+            (value->IsInstance<CallNode>() || value->IsInstance<IfNode>())) {
+          tail_position_ = true;
+        }
         Instruction::Arg reg = this->VisitExpr(value);
+        tail_position_ = false;
+        binding_var_ = nullptr;
+        if (returned_) return reg;
         this->var_register_map_.insert({var, reg.data});
+        if (reg.kind() == Instruction::kRegister &&
+            static_cast<size_t>(reg.value()) >= first_owned_register &&
+            !(var->checked_type_.defined() && IsVoidType(var->checked_type_))) {
+          auto it = last_use.find(var.get());
+          size_t var_last_use = it != last_use.end() ? it->second : index;
+          size_t& reg_last_use = register_last_use[reg.value()];
+          reg_last_use = std::max(reg_last_use, var_last_use);
+          if (reg_last_use < num_bindings) kill_after[reg_last_use].push_back(reg.value());
+        }
+      }
+      for (RegName dead : kill_after[index]) {
+        if (register_last_use[dead] == index) builder_->EmitKillRegister(dead);
       }
     }
 
+    builder_->SetSourceSpan(op->body->span);
     Instruction::Arg ret_reg = this->VisitExpr(op->body);
     return ret_reg;
   }
 
   Instruction::Arg VisitExpr_(const CallNode* call_node) {
+    bool tail = TakeTailPosition();
     if (call_node->op.as<OpNode>()) {
       // special case generate for the intrinsics whose attribute fields
       // cannot be represented by args in the CallNode
@@ -125,7 +283,9 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
       } else if (call_node->op == make_closure_op_) {
         return EmitAllocClosure(call);
       } else if (call_node->op == invoke_closure_op_) {
-        return EmitInvokeClosure(call);
+        return EmitInvokeClosure(call, tail);
+      } else if (call_node->op == scan_op_) {
+        return EmitScan(call);
       } else {
         // every "normal" operator is lowered to a global var in the IR module. The Attrs for those
         // ops are handled in a pass when lowering them to TIR.
@@ -142,23 +302,42 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
       LOG(FATAL) << "CodeGenVM does not support calls to " << call_node->op->GetTypeKey();
     }
     std::vector<Instruction::Arg> args;
-    // TODO(prakalp): For extern function `vm.builtin.alloc_shape_heap` we must pass vm register as
-    // well to find the device in which shape heap must be allocated.
-    if (name == "vm.builtin.alloc_shape_heap") {
+    // The builtins such as `vm.builtin.alloc_shape_heap` find their devices through the VM.
+    if (ExternFuncTakesVM(name)) {
       args.push_back(Instruction::Arg(Instruction::kRegister, Instruction::kVMRegister));
     }
+    if (Optional<Map<String, ObjectRef>> table = GetKernelDispatchTable(name)) {
+      EmitKernelDispatchArgs(table.value(), name, &args);
+      name = "vm.builtin.dispatch_kernel";
+    }
+    Optional<Integer> memoize = GetMemoizeCapacity(call_node->op);
+    if (memoize.defined()) {
+      // The calls are served from the cache of the function kept by the VM.
+      TVMRetValue func_name;
+      func_name = name;
+      args.push_back(Instruction::Arg(Instruction::kVMRegister));
+      args.push_back(Instruction::Arg(Instruction::kConstIdx, builder_->EmitConstant(func_name)));
+      args.push_back(Instruction::Arg(Instruction::kImmediate, memoize.value()->value));
+      name = "vm.builtin.memoize";
+    }
     for (auto arg : call_node->args) {
       args.push_back(this->VisitExpr(arg));
     }
+    if (tail && !memoize.defined() && IsRelaxFunction(call_node->op)) {
+      builder_->EmitTailCall(name, args);
+      returned_ = true;
+      return Instruction::Arg();
+    }
     size_t arg_register = NewRegister();
     builder_->EmitCall(name, args, arg_register);
     return Instruction::Arg(Instruction::kRegister, arg_register);
   }
 
   Instruction::Arg VisitExpr_(const IfNode* op) {
+    bool tail = TakeTailPosition();
     const If& ife = GetRef<If>(op);
-    // Get the executable from exec_builder
-    ObjectPtr<Executable> exec_ = builder_->Get();
+    // Get the executable under construction from exec_builder
+    ObjectPtr<Executable> exec_ = builder_->exec;
 
     // Visit the condition expression
     Instruction::Arg cond_reg = this->VisitExpr(ife->cond);
@@ -167,31 +346,43 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
 
     builder_->EmitIf(cond_reg.value(), 3);
     size_t num_instr = exec_->instr_offset.size();
-    Instruction::Arg true_reg = this->VisitExpr(ife->true_branch);
+    // In tail position, a branch ending with a tail call has returned, it neither moves its
+    // result to the merge register nor jumps over the false branch.
+    bool true_returned = false;
+    bool false_returned = false;
+    Instruction::Arg true_reg = tail ? VisitTailExpr(ife->true_branch, &true_returned)
+                                     : this->VisitExpr(ife->true_branch);
     // Reserve a register for return
     size_t merge_register = NewRegister();
-    // Copy the output from true branch to merge register
-    builder_->EmitCall("vm.builtin.copy", {true_reg}, merge_register);
-
-    // Record the offset of Goto instruction
-    size_t goto_offset = exec_->instr_offset.size();
-
-    builder_->EmitGoto(1);
+    size_t goto_offset = 0;
+    if (!true_returned) {
+      // Move the output from true branch to merge register
+      builder_->EmitMove(true_reg, merge_register);
+      // Record the offset of Goto instruction
+      goto_offset = exec_->instr_offset.size();
+      builder_->EmitGoto(1);
+    }
 
     // Calculate the false offset of If
     size_t false_offset = exec_->instr_offset.size() - num_instr + 1;
 
-    Instruction::Arg false_reg = this->VisitExpr(ife->false_branch);
-    // Copy the output data of false branch to merge register
-    builder_->EmitCall("vm.builtin.copy", {false_reg}, merge_register);
+    Instruction::Arg false_reg = tail ? VisitTailExpr(ife->false_branch, &false_returned)
+                                      : this->VisitExpr(ife->false_branch);
+    if (!false_returned) {
+      // Move the output of false branch to merge register
+      builder_->EmitMove(false_reg, merge_register);
+    }
 
     // Update the offsets of the If instruction emitted above
     // Jump to the behind of the next goto instruction
     exec_->SetInstructionData(if_offset, 2, static_cast<ExecWord>(false_offset));
-    // Update the pc_offset of Goto instruction
-    // Jump over the false branch
-    size_t pc_offset = exec_->instr_offset.size() - goto_offset;
-    exec_->SetInstructionData(goto_offset, 1, static_cast<ExecWord>(pc_offset));
+    if (!true_returned) {
+      // Update the pc_offset of Goto instruction
+      // Jump over the false branch
+      size_t pc_offset = exec_->instr_offset.size() - goto_offset;
+      exec_->SetInstructionData(goto_offset, 1, static_cast<ExecWord>(pc_offset));
+    }
+    returned_ = true_returned && false_returned;
     return Instruction::Arg(Instruction::kRegister, merge_register);
   }
 
@@ -255,7 +446,21 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
     return Instruction::Arg(Instruction::kRegister, arg_register);
   }
 
-  Instruction::Arg EmitAllocStorage(const Call& call_node) {
+  /*!
+   * \brief Check whether a binding is an alloc_storage that can be fused into the alloc_tensor
+   *  bound next, which must allocate a tensor that is not a function output from it.
+   */
+  bool IsFusibleAllocStorage(const VarBinding& binding, const VarBinding& next) {
+    const auto* storage_call = binding->value.as<CallNode>();
+    const auto* tensor_call = next->value.as<CallNode>();
+    if (storage_call == nullptr || storage_call->op != alloc_storage_op_) return false;
+    if (tensor_call == nullptr || tensor_call->op != alloc_tensor_op_) return false;
+    return tensor_call->args[0].same_as(binding->var) &&
+           output_index_map_.find(next->var.get()) == output_index_map_.end();
+  }
+
+  /*! \brief Get the arguments of vm.builtin.alloc_storage for an alloc_storage call. */
+  std::vector<Instruction::Arg> AllocStorageArgs(const Call& call_node) {
     // Handle args of the call
     std::vector<Instruction::Arg> args;
     args.push_back(Instruction::Arg(Instruction::kVMRegister));
@@ -273,7 +478,29 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
     data_type = dtype;
     Index index = this->builder_->EmitConstant(data_type);
     args.push_back(Instruction::Arg(Instruction::kConstIdx, index));
+    return args;
+  }
 
+  /*! \brief Whether the storage is allocated in a memory scope other than the global one. */
+  static bool IsScopedStorage(const Call& alloc_storage) {
+    const auto* attrs = alloc_storage->attrs.as<VMAllocStorageAttrs>();
+    return attrs != nullptr && !attrs->mem_scope.empty() && attrs->mem_scope != "global";
+  }
+
+  /*! \brief Append the memory scope of a storage, which is omitted for the global scope. */
+  void PushMemScopeArg(const Call& alloc_storage, std::vector<Instruction::Arg>* args) {
+    if (!IsScopedStorage(alloc_storage)) return;
+    TVMRetValue mem_scope;
+    mem_scope = alloc_storage->attrs.as<VMAllocStorageAttrs>()->mem_scope;
+    args->push_back(Instruction::Arg(Instruction::kConstIdx, builder_->EmitConstant(mem_scope)));
+  }
+
+  Instruction::Arg EmitAllocStorage(const Call& call_node) {
+    std::vector<Instruction::Arg> args = AllocStorageArgs(call_node);
+    PushMemScopeArg(call_node, &args);
+    if (binding_var_ != nullptr && IsScopedStorage(call_node)) {
+      scoped_storage_vars_.insert(binding_var_);
+    }
     size_t arg_register = NewRegister();
     builder_->EmitCall("vm.builtin.alloc_storage", args, arg_register);
     return Instruction::Arg(Instruction::kRegister, arg_register);
@@ -281,10 +508,20 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
 
   Instruction::Arg EmitAllocTensor(const Call& call_node) {
     ICHECK_EQ(call_node->args.size(), 2);
+    // The storage has no other use when fused, allocate it and the tensor in a single call.
+    bool fused = fused_storage_var_ != nullptr && call_node->args[0].get() == fused_storage_var_;
     std::vector<Instruction::Arg> args;
-    args.reserve(4);
-    // Handle `self`
-    args.push_back(ConvertArg(call_node->args[0]));
+    Call fused_storage_call = fused_storage_call_;
+    // A tensor of another memory scope than the global one cannot alias the output buffers.
+    bool scoped = scoped_storage_vars_.count(call_node->args[0].as<VarNode>());
+    if (fused) {
+      args = AllocStorageArgs(fused_storage_call_);
+      fused_storage_var_ = nullptr;
+      fused_storage_call_ = Call();
+    } else {
+      // Handle `self`
+      args.push_back(ConvertArg(call_node->args[0]));
+    }
     // Handle `offset`
     auto alloc_attrs = call_node->attrs.as<VMAllocTensorAttrs>();
     ICHECK(alloc_attrs != nullptr) << "must be VMAllocTensorAttrs";
@@ -299,7 +536,18 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
     Index index = this->builder_->EmitConstant(data_type);
     args.push_back(Instruction::Arg(Instruction::kConstIdx, index));
     size_t arg_register = NewRegister();
-    builder_->EmitCall("vm.builtin.alloc_tensor", args, arg_register);
+    auto it = output_index_map_.find(binding_var_);
+    if (fused) {
+      PushMemScopeArg(fused_storage_call, &args);
+      builder_->EmitCall("vm.builtin.alloc_storage_and_tensor", args, arg_register);
+    } else if (binding_var_ != nullptr && it != output_index_map_.end() && !scoped) {
+      // The tensor is returned by the function, use the output buffer of the caller if any.
+      args.insert(args.begin(), Instruction::Arg(Instruction::kVMRegister));
+      args.push_back(Instruction::Arg(Instruction::kImmediate, it->second));
+      builder_->EmitCall("vm.builtin.alloc_output_tensor", args, arg_register);
+    } else {
+      builder_->EmitCall("vm.builtin.alloc_tensor", args, arg_register);
+    }
     return Instruction::Arg(Instruction::kRegister, arg_register);
   }
 
@@ -332,6 +580,48 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
     return Instruction::Arg(Instruction::kRegister, arg_register);
   }
 
+  /*! \brief The dispatch table of a kernel, defined when the VM picks among tuned variants. */
+  Optional<Map<String, ObjectRef>> GetKernelDispatchTable(const String& name) const {
+    auto tables = mod_->GetAttr<Map<String, Map<String, ObjectRef>>>(attr::kKernelDispatchTable);
+    if (!tables.defined()) return NullOpt;
+    return tables.value().Get(name);
+  }
+
+  /*! \brief The memoization capacity of the Relax function called, defined when it is memoized. */
+  Optional<Integer> GetMemoizeCapacity(const Expr& op) const {
+    if (!IsRelaxFunction(op)) return NullOpt;
+    BaseFunc func = mod_->Lookup(Downcast<GlobalVar>(op));
+    return func->GetAttr<Integer>(attr::kMemoize);
+  }
+
+  /*!
+   * \brief Emit the leading arguments of vm.builtin.dispatch_kernel for a kernel call.
+   * \param table The dispatch table of the kernel.
+   * \param name The name of the kernel, which serves the dimensions beyond the table.
+   * \param args The arguments of the call.
+   */
+  void EmitKernelDispatchArgs(const Map<String, ObjectRef>& table, const String& name,
+                              std::vector<Instruction::Arg>* args) {
+    args->push_back(Instruction::Arg(Instruction::kVMRegister));
+    for (const char* key : {"dim", "extents"}) {
+      std::vector<int64_t> values;
+      for (const Integer& value : Downcast<Array<Integer>>(table[key])) {
+        values.push_back(value->value);
+      }
+      TVMRetValue shape;
+      shape = ShapeTuple(values);
+      args->push_back(Instruction::Arg(Instruction::kConstIdx, builder_->EmitConstant(shape)));
+    }
+    Array<String> names = Downcast<Array<String>>(table["variants"]);
+    names.push_back(name);
+    for (const String& kernel : names) {
+      TVMRetValue kernel_name;
+      kernel_name = kernel;
+      Index index = builder_->EmitConstant(kernel_name);
+      args->push_back(Instruction::Arg(Instruction::kConstIdx, index));
+    }
+  }
+
   Instruction::Arg EmitTirDynOp(const Call& call_node) {
     ICHECK(call_node->args.size() == 2);
     ICHECK(call_node->args[0]->IsInstance<GlobalVarNode>());
@@ -371,8 +661,8 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
     auto attrs = call_node->attrs;
     if (!attrs.defined()) return;
 
-    if (call_node->op == unique_op_) {
-      auto unique_attrs = call_node->attrs.as<UniqueAttrs>();
+    // relax.unique and relax.unique_bounded.
+    if (const auto* unique_attrs = call_node->attrs.as<UniqueAttrs>()) {
       args.push_back(EmitConstantFromValue(unique_attrs->sorted));
       args.push_back(EmitConstantFromValue(unique_attrs->return_inverse));
       args.push_back(EmitConstantFromValue(unique_attrs->return_counts));
@@ -409,6 +699,8 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
     auto func_name_index = builder_->EmitConstant(func_name_constant);
 
     std::vector<Instruction::Arg> args;
+    // The VM resolves the function index of the closure at allocation.
+    args.push_back(Instruction::Arg(Instruction::kRegister, Instruction::kVMRegister));
     args.push_back(Instruction::Arg(Instruction::kConstIdx, func_name_index));
     for (Expr arg : closure_args->fields) {
       args.push_back(ConvertArg(arg));
@@ -419,7 +711,7 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
     return Instruction::Arg(Instruction::kRegister, dst_register);
   }
 
-  Instruction::Arg EmitInvokeClosure(const Call& call_node) {
+  Instruction::Arg EmitInvokeClosure(const Call& call_node, bool tail) {
     ICHECK(call_node->args.size() == 2);
     ICHECK(call_node->args[0]->IsInstance<VarNode>());
     ICHECK(call_node->args[1]->IsInstance<TupleNode>());
@@ -442,11 +734,37 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
       args.push_back(ConvertArg(arg));
     }
 
+    if (tail) {
+      builder_->EmitTailCall("vm.builtin.invoke_closure", args);
+      returned_ = true;
+      return Instruction::Arg();
+    }
     size_t dst_register = NewRegister();
     builder_->EmitCall("vm.builtin.invoke_closure", args, dst_register);
     return Instruction::Arg(Instruction::kRegister, dst_register);
   }
 
+  Instruction::Arg EmitScan(const Call& call_node) {
+    ICHECK(call_node->args.size() == 3);
+    ICHECK(call_node->args[0]->IsInstance<GlobalVarNode>())
+        << "The step function of scan should be a global function";
+    ICHECK(call_node->args[2]->IsInstance<TupleNode>());
+    TVMRetValue func_name;
+    func_name = Downcast<GlobalVar>(call_node->args[0])->name_hint;
+
+    std::vector<Instruction::Arg> args;
+    // The VM runs the loop, the states are passed after the function and the number of steps.
+    args.push_back(Instruction::Arg(Instruction::kVMRegister));
+    args.push_back(Instruction::Arg(Instruction::kConstIdx, builder_->EmitConstant(func_name)));
+    args.push_back(ConvertArg(call_node->args[1]));
+    for (Expr state : Downcast<Tuple>(call_node->args[2])->fields) {
+      args.push_back(ConvertArg(state));
+    }
+    size_t dst_register = NewRegister();
+    builder_->EmitCall("vm.builtin.scan", args, dst_register);
+    return Instruction::Arg(Instruction::kRegister, dst_register);
+  }
+
   bool IsConstantShape(ShapeExpr shape) const {
     for (PrimExpr e : shape->values) {
       if (!e->IsInstance<IntImmNode>()) {
@@ -503,39 +821,61 @@ class CodeGenVM : public ExprFunctor<Instruction::Arg(const Expr&)> {
   size_t registers_num_ = 0;
   /*! \brief Map from var to register number. */
   std::unordered_map<Var, RegName, ObjectPtrHash, ObjectPtrEqual> var_register_map_;
+  /*! \brief The module being generated, to tell the Relax functions from the kernels. */
+  IRModule mod_;
+  /*! \brief Whether to emit tail calls. */
+  bool tail_call_;
+  /*! \brief Whether the expression visited next is in tail position. */
+  bool tail_position_ = false;
+  /*! \brief Whether all the paths of the expression in tail position have returned. */
+  bool returned_ = false;
+  /*! \brief Map from the vars returned by the current function to their output index. */
+  std::unordered_map<const VarNode*, int64_t> output_index_map_;
+  /*! \brief The var bound by the binding being generated, nullptr outside bindings. */
+  const VarNode* binding_var_ = nullptr;
+  /*! \brief The storage var whose alloc_storage is fused into the next alloc_tensor, if any. */
+  const VarNode* fused_storage_var_ = nullptr;
+  /*! \brief The alloc_storage call of fused_storage_var_. */
+  Call fused_storage_call_;
+  /*! \brief The storage vars allocated in a memory scope other than the global one. */
+  std::unordered_set<const VarNode*> scoped_storage_vars_;
   /*! \brief Cache ops that need to be frequently used later to reduce lookup overhead. */
   const Op& alloc_storage_op_ = Op::Get("relax.vm.builtin.alloc_storage");
   const Op& alloc_tensor_op_ = Op::Get("relax.vm.builtin.alloc_tensor");
   const Op& store_shape_op_ = Op::Get("relax.vm.builtin.store_shape");
   const Op& load_shape_op_ = Op::Get("relax.vm.builtin.load_shape");
   const Op& call_tir_dyn_op_ = Op::Get("relax.vm.call_tir_dyn");
-  const Op& unique_op_ = Op::Get("relax.unique");
   const Op& make_closure_op_ = Op::Get("relax.make_closure");
   const Op& invoke_closure_op_ = Op::Get("relax.invoke_closure");
+  const Op& scan_op_ = Op::Get("relax.scan");
 };
 
 void VMCodeGen::CodeGen(IRModule rx_mod) {
   builder_ = relax::ExecBuilderNode::Create();
-  CodeGenVM codegen(builder_.operator->());
+  transform::PassContext pass_ctx = transform::PassContext::Current();
+  bool tail_call = pass_ctx->GetConfig<Bool>(kVMCodeGenTailCallOption, Bool(true)).value();
+  CodeGenVM codegen(builder_.operator->(), rx_mod, tail_call);
   for (auto& p : rx_mod->functions) {
     codegen.VisitExpr(p.second);
   }
+  if (pass_ctx->GetConfig<Bool>(kVMCodeGenPeepholeOption, Bool(true)).value()) {
+    builder_->Optimize();
+  }
+  if (pass_ctx->GetConfig<Bool>(kVMCodeGenRegisterAllocationOption, Bool(true)).value()) {
+    builder_->AllocateRegisters();
+  }
 }
 
 ObjectPtr<Executable> VMCodeGen::GetExec() { return builder_->Get(); }
 
 /*!
- * \brief Create the Relax VM executable from an IRModule of Relax function(s) and, possibly, a
- * kernel library.
- * \param mod The IRModule containing Relax function(s).
- * \param lib The kernel library.
+ * \brief Link an executable with the kernel library.
+ * \param executable The executable.
+ * \param lib The kernel library, which also contains the compiled Relax functions if any.
  * \return The constructed Relax VM executable.
  */
-Module CodeGen(IRModule mod, Optional<Module> lib, Array<Module> ext_libs, Target target,
-               Map<String, runtime::NDArray> params) {
-  VMCodeGen codegen;
-  codegen.CodeGen(mod);
-  ObjectPtr<Executable> executable = codegen.GetExec();
+Module LinkExecutable(ObjectPtr<Executable> executable, Optional<Module> lib,
+                      Array<Module> ext_libs, Target target, Map<String, runtime::NDArray> params) {
   if (!lib.defined()) {
     lib = codegen::CSourceModuleCreate(";", "", Array<String>{});
   }
@@ -556,8 +896,36 @@ Module CodeGen(IRModule mod, Optional<Module> lib, Array<Module> ext_libs, Targe
   return Module(executable);
 }
 
+/*!
+ * \brief Create the Relax VM executable from an IRModule of Relax function(s) and, possibly, a
+ * kernel library.
+ * \param mod The IRModule containing Relax function(s).
+ * \param lib The kernel library.
+ * \return The constructed Relax VM executable.
+ */
+Module CodeGen(IRModule mod, Optional<Module> lib, Array<Module> ext_libs, Target target,
+               Map<String, runtime::NDArray> params) {
+  VMCodeGen codegen;
+  codegen.CodeGen(mod);
+  return LinkExecutable(codegen.GetExec(), lib, ext_libs, target, params);
+}
+
+/*!
+ * \brief Create the Relax VM executable from an ExecBuilder whose functions are compiled into
+ * the kernel library.
+ * \param builder The ExecBuilder in which the functions are declared.
+ * \param lib The kernel library.
+ * \return The constructed Relax VM executable.
+ */
+Module Link(ExecBuilder builder, Optional<Module> lib, Array<Module> ext_libs, Target target,
+            Map<String, runtime::NDArray> params) {
+  return LinkExecutable(builder->Get(), lib, ext_libs, target, params);
+}
+
 TVM_REGISTER_GLOBAL("relax.VMCodeGen").set_body_typed(CodeGen);
 
+TVM_REGISTER_GLOBAL("relax.VMLink").set_body_typed(Link);
+
 }  // namespace relax_vm
 }  // namespace relax
 }  // namespace tvm
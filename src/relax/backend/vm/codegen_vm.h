@@ -27,6 +27,8 @@
 
 #include <tvm/ir/module.h>
 #include <tvm/relax/exec_builder.h>
+#include <tvm/relax/expr.h>
+#include <tvm/relax/op_attr_types.h>
 #include <tvm/runtime/relax_vm/executable.h>
 #include <tvm/target/target.h>
 
@@ -40,6 +42,41 @@ using tvm::Target;
 using namespace tvm::runtime::relax_vm;
 using namespace tvm::runtime;
 
+/*!
+ * \brief Get the name of the packed function implementing a relax operator.
+ * \param call The call to the operator.
+ * \return The name of the packed function, empty if the operator has none.
+ */
+FCallPacked GetPackedFuncName(const Call& call);
+
+/*!
+ * \brief Whether an extern function takes the VM as its first argument, which the calls in the IR
+ *  leave out, e.g. vm.builtin.alloc_shape_heap and the collective communication builtins.
+ * \param name The name of the extern function.
+ * \return Whether the VM is passed to the function.
+ */
+bool ExternFuncTakesVM(const std::string& name);
+
+/*!
+ * \brief Link an executable with the kernel library.
+ * \param executable The executable.
+ * \param lib The kernel library, which also contains the compiled Relax functions if any.
+ * \param ext_libs The external libraries of the offloaded functions.
+ * \param target The target of the kernel library.
+ * \param params The parameters bound to the executable.
+ * \return The constructed Relax VM executable.
+ */
+Module LinkExecutable(ObjectPtr<Executable> executable, Optional<Module> lib,
+                      Array<Module> ext_libs, Target target, Map<String, runtime::NDArray> params);
+
+/*!
+ * \brief Compile the Relax functions of a module into host TIR functions.
+ * \param builder The ExecBuilder in which the functions are declared.
+ * \param mod The IRModule containing Relax function(s), after VM memory and shape lowering.
+ * \return The module of the generated PrimFuncs, to be built with the kernel library.
+ */
+IRModule VMTIRCodeGen(ExecBuilder builder, IRModule mod);
+
 class VMCodeGen : public Object {
  public:
   /*!
@@ -0,0 +1,572 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/backend/vm/codegen_vm_tir.cc
+ * \brief A codegen to compile relax functions into host TIR functions which are built together
+ *  with the kernel library, instead of into VM bytecode.
+ *
+ *  A relax function `name` becomes the PrimFunc `__vmtir__name(ctx_ptr, r, c, f)`, where ctx_ptr
+ *  is the VM, r is the register file of the call frame, c is the constant pool and f is the pool
+ *  of closures of the global functions. r, c and f are anylists, i.e. arrays of TVMRetValue.
+ */
+
+#include <tvm/relax/attrs/memory.h>
+#include <tvm/relax/attrs/shape.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/expr.h>
+#include <tvm/tir/function.h>
+#include <tvm/tir/stmt.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "codegen_vm.h"
+
+namespace tvm {
+namespace relax {
+namespace relax_vm {
+
+/*!
+ * \brief A class to generate host TIR functions for Relax functions.
+ *
+ *  The values of the function live in the register file of its VM frame, so that objects are
+ *  reference counted exactly as in the bytecode interpreter, while the dispatch of every
+ *  instruction is replaced by a direct packed call in the generated code.
+ */
+class CodeGenVMTIR : public ExprFunctor<Optional<PrimExpr>(const Expr&)> {
+ public:
+  explicit CodeGenVMTIR(relax::ExecBuilder builder, IRModule ctx_mod)
+      : builder_(builder), ctx_mod_(ctx_mod) {}
+
+  static IRModule Run(relax::ExecBuilder builder, IRModule mod) {
+    IRModule res_mod = IRModule(Map<GlobalVar, BaseFunc>());
+    CodeGenVMTIR codegen(builder, mod);
+    // Declare all the functions first, so that they can call each other regardless of order.
+    for (auto& p : mod->functions) {
+      if (const auto* func = p.second.as<FunctionNode>()) {
+        codegen.DeclareFunction(GetRef<Function>(func));
+      }
+    }
+    for (auto& p : mod->functions) {
+      if (const auto* func = p.second.as<FunctionNode>()) {
+        tir::PrimFunc tir_func = codegen.Codegen(GetRef<Function>(func));
+        String gsymbol = tir_func->GetAttr<String>(tvm::attr::kGlobalSymbol).value();
+        res_mod->Add(GlobalVar(gsymbol), tir_func);
+      }
+    }
+    return res_mod;
+  }
+
+ protected:
+  int64_t NewRegister() { return registers_num_++; }
+
+  static String GetGlobalSymbol(const Function& func) {
+    Optional<String> gsymbol = func->GetAttr<String>(tvm::attr::kGlobalSymbol);
+    ICHECK(gsymbol.defined()) << "there should be no local functions in Relax VM codegen phase. "
+                                 "Did you forget to apply LambdaLift pass?";
+    return gsymbol.value();
+  }
+
+  void DeclareFunction(const Function& func) {
+    Array<String> param_names;
+    for (Var param : func->params) {
+      param_names.push_back(param->name_hint());
+    }
+    builder_->EmitCompiledFunction(GetGlobalSymbol(func), func->params.size(), param_names);
+  }
+
+  tir::PrimFunc Codegen(const Function& func) {
+    String name = GetGlobalSymbol(func);
+    auto it = builder_->exec->global_map.find(name);
+    ICHECK(it != builder_->exec->global_map.end());
+    Index func_index = it->second;
+
+    ctx_ptr_ = tir::Var("ctx_ptr", DataType::Handle());
+    reg_anylist_handle_ = tir::Var("r", DataType::Handle());
+    const_anylist_handle_ = tir::Var("c", DataType::Handle());
+    func_anylist_handle_ = tir::Var("f", DataType::Handle());
+    registers_num_ = 0;
+    var_map_.clear();
+
+    for (Var param : func->params) {
+      var_map_.insert({param, RegListGet(NewRegister())});
+    }
+    // The value returned by the function is placed right after the parameters, where the VM
+    // reads it back.
+    int64_t ret_register = NewRegister();
+    output_index_map_.clear();
+    if (const auto* seq = func->body.as<SeqExprNode>()) {
+      if (const auto* var = seq->body.as<VarNode>()) {
+        output_index_map_[var] = 0;
+      } else if (const auto* tuple = seq->body.as<TupleNode>()) {
+        for (size_t i = 0; i < tuple->fields.size(); ++i) {
+          if (const auto* var = tuple->fields[i].as<VarNode>()) output_index_map_.emplace(var, i);
+        }
+      }
+    }
+
+    this->EnterScope();
+    Optional<PrimExpr> ret = this->VisitExpr(func->body);
+    ICHECK(ret.defined()) << "The function " << name << " must return a value";
+    this->EmitCallPacked("vm.builtin.copy", {ret.value()}, ret_register);
+    tir::Stmt body = this->ExitScope();
+
+    builder_->exec->global_funcs[func_index].register_file_size = registers_num_;
+    std::string symbol = std::string(kVMTIRFuncPrefix) + name.operator std::string();
+    Map<String, ObjectRef> attrs;
+    attrs.Set(tvm::attr::kGlobalSymbol, String(symbol));
+    Array<tir::Var> params = {ctx_ptr_, reg_anylist_handle_, const_anylist_handle_,
+                              func_anylist_handle_};
+    return tir::PrimFunc(params, body, VoidType(), Map<tir::Var, tir::Buffer>(), NullOpt,
+                         DictAttrs(attrs));
+  }
+
+  void EnterScope() { stmt_stack_.push_back({}); }
+
+  tir::Stmt ExitScope() {
+    ICHECK(!stmt_stack_.empty());
+    Array<tir::Stmt> stmts = stmt_stack_.back();
+    stmt_stack_.pop_back();
+    return tir::SeqStmt::Flatten(stmts);
+  }
+
+  void EmitStmt(tir::Stmt stmt) {
+    ICHECK(!stmt_stack_.empty());
+    stmt_stack_.back().push_back(stmt);
+  }
+
+  /*! \brief Emit a call to a packed function whose result is moved into a register. */
+  void EmitCallPacked(String name, const Array<PrimExpr>& args, int64_t dst_register) {
+    Array<PrimExpr> all_args = {reg_anylist_handle_, ConstInt32(dst_register),
+                                tir::StringImm(name)};
+    for (PrimExpr arg : args) {
+      all_args.push_back(arg);
+    }
+    this->EmitStmt(tir::Evaluate(
+        tir::Call(DataType::Int(32), tir::builtin::anylist_setitem_call_packed(), all_args)));
+  }
+
+  /*! \brief Emit a call to a packed function and return the register holding its result. */
+  PrimExpr EmitCallPackedToNewRegister(String name, const Array<PrimExpr>& args) {
+    int64_t dst_register = NewRegister();
+    this->EmitCallPacked(name, args, dst_register);
+    return RegListGet(dst_register);
+  }
+
+  static PrimExpr ConstInt32(int64_t value) { return IntImm(DataType::Int(32), value); }
+
+  static PrimExpr ConstInt64(int64_t value) { return IntImm(DataType::Int(64), value); }
+
+  PrimExpr RegListGet(int64_t slot) const {
+    return tir::Call(DataType::Handle(), tir::builtin::anylist_getitem(),
+                     {reg_anylist_handle_, ConstInt32(slot)});
+  }
+
+  PrimExpr ConstListGet(int64_t slot) const {
+    return tir::Call(DataType::Handle(), tir::builtin::anylist_getitem(),
+                     {const_anylist_handle_, ConstInt32(slot)});
+  }
+
+  PrimExpr FuncListGet(int64_t slot) const {
+    return tir::Call(DataType::Handle(), tir::builtin::anylist_getitem(),
+                     {func_anylist_handle_, ConstInt32(slot)});
+  }
+
+  /*! \brief Get the register read by an expression, or -1 if it does not read a register. */
+  int64_t GetRegister(const PrimExpr& expr) const {
+    const auto* call = expr.as<tir::CallNode>();
+    if (call == nullptr || !call->op.same_as(tir::builtin::anylist_getitem()) ||
+        !call->args[0].same_as(reg_anylist_handle_)) {
+      return -1;
+    }
+    return Downcast<IntImm>(call->args[1])->value;
+  }
+
+  template <typename T>
+  PrimExpr EmitConstantFromValue(T value) {
+    TVMRetValue tvm_value;
+    tvm_value = value;
+    Index index = builder_->EmitConstant(tvm_value);
+    return ConstListGet(Instruction::Arg(index).value());
+  }
+
+  Optional<PrimExpr> VisitExpr_(const SeqExprNode* op) final {
+    // Release the registers after the last binding using them, as the bytecode codegen does
+    // with KillRegister. The body counts as the binding after the last one.
+    std::unordered_map<const VarNode*, size_t> last_use;
+    std::vector<VarBinding> bindings;
+    auto record_use = [&](const Expr& expr, size_t index) {
+      PostOrderVisit(expr, [&](const Expr& e) {
+        if (const auto* var = e.as<VarNode>()) last_use[var] = index;
+      });
+    };
+    for (auto block : op->blocks) {
+      for (Binding binding : block->bindings) {
+        ICHECK(binding->IsInstance<VarBindingNode>());
+        bindings.push_back(Downcast<VarBinding>(binding));
+        record_use(bindings.back()->value, bindings.size() - 1);
+      }
+    }
+    const size_t num_bindings = bindings.size();
+    record_use(op->body, num_bindings);
+
+    const int64_t first_owned_register = registers_num_;
+    std::unordered_map<int64_t, size_t> register_last_use;
+    std::vector<std::vector<int64_t>> release_after(num_bindings);
+    for (size_t index = 0; index < num_bindings; ++index) {
+      Var var = bindings[index]->var;
+      binding_var_ = var.get();
+      Optional<PrimExpr> value = this->VisitExpr(bindings[index]->value);
+      binding_var_ = nullptr;
+      if (value.defined()) {
+        var_map_.insert({var, value.value()});
+        int64_t reg = GetRegister(value.value());
+        if (reg >= first_owned_register) {
+          auto it = last_use.find(var.get());
+          size_t var_last_use = it != last_use.end() ? it->second : index;
+          size_t& reg_last_use = register_last_use[reg];
+          reg_last_use = std::max(reg_last_use, var_last_use);
+          if (reg_last_use < num_bindings) release_after[reg_last_use].push_back(reg);
+        }
+      }
+      for (int64_t dead : release_after[index]) {
+        if (register_last_use[dead] != index) continue;
+        this->EmitStmt(tir::Evaluate(tir::Call(DataType::Int(32),
+                                               tir::builtin::anylist_resetitem(),
+                                               {reg_anylist_handle_, ConstInt32(dead)})));
+      }
+    }
+    return this->VisitExpr(op->body);
+  }
+
+  Optional<PrimExpr> VisitExpr_(const CallNode* call_node) final {
+    Call call = GetRef<Call>(call_node);
+    if (call_node->op.as<OpNode>()) {
+      FCallPacked name = GetPackedFuncName(call);
+      if (!name.empty()) {
+        return EmitPackedFuncCall(call, name);
+      } else if (call_node->op == alloc_storage_op_) {
+        return EmitAllocStorage(call);
+      } else if (call_node->op == alloc_tensor_op_) {
+        return EmitAllocTensor(call);
+      } else if (call_node->op == store_shape_op_ || call_node->op == load_shape_op_) {
+        return EmitShape(call);
+      } else if (call_node->op == call_tir_dyn_op_) {
+        return EmitTirDynOp(call);
+      } else if (call_node->op == make_closure_op_) {
+        return EmitAllocClosure(call);
+      } else if (call_node->op == invoke_closure_op_) {
+        return EmitInvokeClosure(call);
+      } else if (call_node->op == scan_op_) {
+        return EmitScan(call);
+      } else {
+        LOG(FATAL) << "CodeGenVMTIR cannot handle this intrinsic now:\n" << call_node->op;
+      }
+    }
+    Array<PrimExpr> args;
+    String name;
+    if (const auto* extern_func = call_node->op.as<ExternFuncNode>()) {
+      name = extern_func->global_symbol;
+      if (ExternFuncTakesVM(name)) args.push_back(ctx_ptr_);
+    } else if (const auto* gvar = call_node->op.as<GlobalVarNode>()) {
+      Optional<BaseFunc> callee = ctx_mod_->functions.Get(GetRef<GlobalVar>(gvar));
+      if (callee.defined() && callee.value()->IsInstance<FunctionNode>()) {
+        // Relax functions are invoked through the VM, which runs them compiled or interpreted.
+        auto it = builder_->exec->global_map.find(gvar->name_hint);
+        ICHECK(it != builder_->exec->global_map.end()) << "No such function " << gvar->name_hint;
+        name = "vm.builtin.invoke_closure";
+        args.push_back(ctx_ptr_);
+        args.push_back(FuncListGet(it->second));
+      } else if (Optional<Map<String, ObjectRef>> table = GetKernelDispatchTable(gvar->name_hint)) {
+        // The VM picks the variant of the kernel tuned for the shape.
+        name = "vm.builtin.dispatch_kernel";
+        EmitKernelDispatchArgs(table.value(), gvar->name_hint, &args);
+      } else {
+        // Kernels are called directly by name.
+        name = gvar->name_hint;
+      }
+    } else {
+      LOG(FATAL) << "CodeGenVMTIR does not support calls to " << call_node->op->GetTypeKey();
+    }
+    for (Expr arg : call_node->args) {
+      args.push_back(this->VisitExpr(arg).value());
+    }
+    return EmitCallPackedToNewRegister(name, args);
+  }
+
+  Optional<PrimExpr> VisitExpr_(const IfNode* op) final {
+    PrimExpr cond = this->VisitExpr(op->cond).value();
+    cond = tir::Call(DataType::Bool(), tir::builtin::tvm_call_packed(),
+                     {tir::StringImm("vm.builtin.read_if_cond"), cond});
+    int64_t merge_register = NewRegister();
+
+    this->EnterScope();
+    Optional<PrimExpr> true_value = this->VisitExpr(op->true_branch);
+    this->EmitCallPacked("vm.builtin.copy", {true_value.value()}, merge_register);
+    tir::Stmt true_branch = this->ExitScope();
+
+    this->EnterScope();
+    Optional<PrimExpr> false_value = this->VisitExpr(op->false_branch);
+    this->EmitCallPacked("vm.builtin.copy", {false_value.value()}, merge_register);
+    tir::Stmt false_branch = this->ExitScope();
+
+    this->EmitStmt(tir::IfThenElse(cond, true_branch, false_branch));
+    return RegListGet(merge_register);
+  }
+
+  Optional<PrimExpr> VisitExpr_(const VarNode* op) final {
+    auto it = var_map_.find(GetRef<Var>(op));
+    ICHECK(it != var_map_.end()) << op->name_hint() << " is not defined";
+    return it->second;
+  }
+
+  Optional<PrimExpr> VisitExpr_(const ConstantNode* op) final {
+    return EmitConstantFromValue(op->data);
+  }
+
+  Optional<PrimExpr> VisitExpr_(const ShapeExprNode* op) final {
+    std::vector<int64_t> shape;
+    for (PrimExpr e : op->values) {
+      const auto* int_imm = e.as<IntImmNode>();
+      ICHECK(int_imm != nullptr) << "should only use constant shape after shape lowering: "
+                                 << op->values;
+      shape.push_back(int_imm->value);
+    }
+    return EmitConstantFromValue(ShapeTuple(shape));
+  }
+
+  Optional<PrimExpr> VisitExpr_(const TupleNode* op) final {
+    Array<PrimExpr> args;
+    for (Expr arg : op->fields) {
+      args.push_back(this->VisitExpr(arg).value());
+    }
+    return EmitCallPackedToNewRegister("runtime.Tuple", args);
+  }
+
+  Optional<PrimExpr> VisitExpr_(const TupleGetItemNode* op) final {
+    Array<PrimExpr> args = {this->VisitExpr(op->tuple).value(),
+                            EmitConstantFromValue(ShapeTuple({op->index}))};
+    return EmitCallPackedToNewRegister("vm.runtime.TupleGetItem", args);
+  }
+
+  Optional<PrimExpr> EmitAllocStorage(const Call& call_node) {
+    auto alloc_attrs = call_node->attrs.as<VMAllocStorageAttrs>();
+    ICHECK(alloc_attrs != nullptr) << "must be VMAllocStorageAttrs";
+    Array<PrimExpr> args = {ctx_ptr_};
+    for (Expr arg : call_node->args) {
+      args.push_back(this->VisitExpr(arg).value());
+    }
+    args.push_back(ConstInt64(alloc_attrs->runtime_device_index));
+    args.push_back(EmitConstantFromValue(alloc_attrs->dtype));
+    if (!alloc_attrs->mem_scope.empty() && alloc_attrs->mem_scope != "global") {
+      // The memory scope is omitted for the global scope.
+      args.push_back(EmitConstantFromValue(alloc_attrs->mem_scope));
+      if (binding_var_ != nullptr) scoped_storage_vars_.insert(binding_var_);
+    }
+    return EmitCallPackedToNewRegister("vm.builtin.alloc_storage", args);
+  }
+
+  Optional<PrimExpr> EmitAllocTensor(const Call& call_node) {
+    ICHECK_EQ(call_node->args.size(), 2);
+    auto alloc_attrs = call_node->attrs.as<VMAllocTensorAttrs>();
+    ICHECK(alloc_attrs != nullptr) << "must be VMAllocTensorAttrs";
+    Array<PrimExpr> args = {this->VisitExpr(call_node->args[0]).value(),
+                            ConstInt64(alloc_attrs->offset),
+                            this->VisitExpr(call_node->args[1]).value(),
+                            EmitConstantFromValue(alloc_attrs->dtype)};
+    auto it = output_index_map_.find(binding_var_);
+    // A tensor of another memory scope than the global one cannot alias the output buffers.
+    bool scoped = scoped_storage_vars_.count(call_node->args[0].as<VarNode>());
+    if (binding_var_ != nullptr && it != output_index_map_.end() && !scoped) {
+      // The tensor is returned by the function, use the output buffer of the caller if any.
+      args.insert(args.begin(), ctx_ptr_);
+      args.push_back(ConstInt64(it->second));
+      return EmitCallPackedToNewRegister("vm.builtin.alloc_output_tensor", args);
+    }
+    return EmitCallPackedToNewRegister("vm.builtin.alloc_tensor", args);
+  }
+
+  Optional<PrimExpr> EmitShape(const Call& call_node) {
+    auto shape_attrs = call_node->attrs.as<ShapeHeapAttrs>();
+    ICHECK(shape_attrs != nullptr) << "must be ShapeHeapAttrs";
+    Array<PrimExpr> args;
+    for (Expr arg : call_node->args) {
+      args.push_back(this->VisitExpr(arg).value());
+    }
+    std::vector<int64_t> indices;
+    for (Integer ind : shape_attrs->indices) {
+      indices.push_back(ind.IntValue());
+    }
+    args.push_back(EmitConstantFromValue(ShapeTuple(indices)));
+    String name =
+        call_node->op == store_shape_op_ ? "vm.builtin.store_shape" : "vm.builtin.load_shape";
+    return EmitCallPackedToNewRegister(name, args);
+  }
+
+  /*! \brief The dispatch table of a kernel, defined when the VM picks among tuned variants. */
+  Optional<Map<String, ObjectRef>> GetKernelDispatchTable(const String& name) const {
+    auto tables =
+        ctx_mod_->GetAttr<Map<String, Map<String, ObjectRef>>>(attr::kKernelDispatchTable);
+    if (!tables.defined()) return NullOpt;
+    return tables.value().Get(name);
+  }
+
+  /*! \brief Emit the leading arguments of vm.builtin.dispatch_kernel for a kernel call. */
+  void EmitKernelDispatchArgs(const Map<String, ObjectRef>& table, const String& name,
+                              Array<PrimExpr>* args) {
+    args->push_back(ctx_ptr_);
+    for (const char* key : {"dim", "extents"}) {
+      std::vector<int64_t> values;
+      for (const Integer& value : Downcast<Array<Integer>>(table[key])) {
+        values.push_back(value->value);
+      }
+      args->push_back(EmitConstantFromValue(ShapeTuple(values)));
+    }
+    for (const String& kernel : Downcast<Array<String>>(table["variants"])) {
+      args->push_back(EmitConstantFromValue(kernel));
+    }
+    args->push_back(EmitConstantFromValue(name));
+  }
+
+  Optional<PrimExpr> EmitTirDynOp(const Call& call_node) {
+    ICHECK(call_node->args.size() == 2);
+    ICHECK(call_node->args[0]->IsInstance<GlobalVarNode>());
+    ICHECK(call_node->args[1]->IsInstance<TupleNode>());
+    auto gv = Downcast<GlobalVar>(call_node->args[0]);
+    auto tir_args = Downcast<Tuple>(call_node->args[1]);
+    Array<PrimExpr> args = {ctx_ptr_, EmitConstantFromValue(gv->name_hint)};
+    for (Expr arg : tir_args->fields) {
+      args.push_back(this->VisitExpr(arg).value());
+    }
+    return EmitCallPackedToNewRegister("vm.call_tir_dyn", args);
+  }
+
+  Optional<PrimExpr> EmitPackedFuncCall(const Call& call_node, const FCallPacked& name) {
+    Array<PrimExpr> args;
+    for (Expr arg : call_node->args) {
+      args.push_back(this->VisitExpr(arg).value());
+    }
+    if (call_node->attrs.defined()) {
+      auto unique_attrs = call_node->attrs.as<UniqueAttrs>();
+      // relax.unique and relax.unique_bounded.
+      ICHECK(unique_attrs != nullptr)
+          << "Support for attributes of Op " << call_node->op << " has not been implemented yet.";
+      args.push_back(EmitConstantFromValue(unique_attrs->sorted));
+      args.push_back(EmitConstantFromValue(unique_attrs->return_inverse));
+      args.push_back(EmitConstantFromValue(unique_attrs->return_counts));
+      args.push_back(EmitConstantFromValue(unique_attrs->dim));
+    }
+    return EmitCallPackedToNewRegister(name, args);
+  }
+
+  Optional<PrimExpr> EmitAllocClosure(const Call& call_node) {
+    ICHECK(call_node->args.size() == 2);
+    ICHECK(call_node->args[0]->IsInstance<GlobalVarNode>());
+    ICHECK(call_node->args[1]->IsInstance<TupleNode>());
+    auto gv = Downcast<GlobalVar>(call_node->args[0]);
+    auto closure_args = Downcast<Tuple>(call_node->args[1]);
+    // The VM resolves the function index of the closure at allocation.
+    Array<PrimExpr> args = {ctx_ptr_, EmitConstantFromValue(gv->name_hint)};
+    for (Expr arg : closure_args->fields) {
+      args.push_back(this->VisitExpr(arg).value());
+    }
+    return EmitCallPackedToNewRegister("vm.builtin.alloc_closure", args);
+  }
+
+  Optional<PrimExpr> EmitInvokeClosure(const Call& call_node) {
+    ICHECK(call_node->args.size() == 2);
+    ICHECK(call_node->args[0]->IsInstance<VarNode>());
+    ICHECK(call_node->args[1]->IsInstance<TupleNode>());
+    Array<PrimExpr> args = {ctx_ptr_, this->VisitExpr(call_node->args[0]).value()};
+    auto invoke_closure_args = Downcast<Tuple>(call_node->args[1]);
+    for (Expr arg : invoke_closure_args->fields) {
+      args.push_back(this->VisitExpr(arg).value());
+    }
+    return EmitCallPackedToNewRegister("vm.builtin.invoke_closure", args);
+  }
+
+  Optional<PrimExpr> EmitScan(const Call& call_node) {
+    ICHECK(call_node->args.size() == 3);
+    ICHECK(call_node->args[0]->IsInstance<GlobalVarNode>());
+    ICHECK(call_node->args[2]->IsInstance<TupleNode>());
+    auto gv = Downcast<GlobalVar>(call_node->args[0]);
+    // The VM runs the loop, the states are passed after the function and the number of steps.
+    Array<PrimExpr> args = {ctx_ptr_, EmitConstantFromValue(gv->name_hint),
+                            this->VisitExpr(call_node->args[1]).value()};
+    for (Expr state : Downcast<Tuple>(call_node->args[2])->fields) {
+      args.push_back(this->VisitExpr(state).value());
+    }
+    return EmitCallPackedToNewRegister("vm.builtin.scan", args);
+  }
+
+  /*! \brief Internal ExecBuilder. */
+  relax::ExecBuilder builder_;
+  /*! \brief The module of the functions being compiled. */
+  IRModule ctx_mod_;
+  /*! \brief The VM context parameter of the current function. */
+  tir::Var ctx_ptr_;
+  /*! \brief The register file parameter of the current function. */
+  tir::Var reg_anylist_handle_;
+  /*! \brief The constant pool parameter of the current function. */
+  tir::Var const_anylist_handle_;
+  /*! \brief The function pool parameter of the current function. */
+  tir::Var func_anylist_handle_;
+  /*! \brief Total number of registers allocated in the current function. */
+  int64_t registers_num_ = 0;
+  /*! \brief The statements of the enclosing scopes. */
+  std::vector<Array<tir::Stmt>> stmt_stack_;
+  /*! \brief Map from var to the expression reading its value. */
+  std::unordered_map<Var, PrimExpr, ObjectPtrHash, ObjectPtrEqual> var_map_;
+  /*! \brief Map from the vars returned by the current function to their output index. */
+  std::unordered_map<const VarNode*, int64_t> output_index_map_;
+  /*! \brief The var bound by the binding being generated, nullptr outside bindings. */
+  const VarNode* binding_var_ = nullptr;
+  /*! \brief The storage vars allocated in a memory scope other than the global one. */
+  std::unordered_set<const VarNode*> scoped_storage_vars_;
+  /*! \brief Cache ops that need to be frequently used later to reduce lookup overhead. */
+  const Op& alloc_storage_op_ = Op::Get("relax.vm.builtin.alloc_storage");
+  const Op& alloc_tensor_op_ = Op::Get("relax.vm.builtin.alloc_tensor");
+  const Op& store_shape_op_ = Op::Get("relax.vm.builtin.store_shape");
+  const Op& load_shape_op_ = Op::Get("relax.vm.builtin.load_shape");
+  const Op& call_tir_dyn_op_ = Op::Get("relax.vm.call_tir_dyn");
+  const Op& make_closure_op_ = Op::Get("relax.make_closure");
+  const Op& invoke_closure_op_ = Op::Get("relax.invoke_closure");
+  const Op& scan_op_ = Op::Get("relax.scan");
+};
+
+/*!
+ * \brief Compile the Relax functions of a module into host TIR functions.
+ * \param builder The ExecBuilder in which the functions are declared.
+ * \param mod The IRModule containing Relax function(s), after VM memory and shape lowering.
+ * \return The module of the generated PrimFuncs, to be built with the kernel library.
+ */
+IRModule VMTIRCodeGen(ExecBuilder builder, IRModule mod) {
+  return CodeGenVMTIR::Run(builder, mod);
+}
+
+TVM_REGISTER_GLOBAL("relax.VMTIRCodeGen").set_body_typed(VMTIRCodeGen);
+
+}  // namespace relax_vm
+}  // namespace relax
+}  // namespace tvm
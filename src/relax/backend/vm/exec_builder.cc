@@ -22,7 +22,11 @@
  */
 #include <tvm/relax/exec_builder.h>
 
+#include <algorithm>
+#include <set>
 #include <sstream>
+#include <tuple>
+#include <utility>
 
 namespace tvm {
 namespace relax {
@@ -38,8 +42,27 @@ ExecBuilder ExecBuilderNode::Create() {
 }
 
 vm::Index ExecBuilderNode::EmitConstant(TVMRetValue obj) {
+  // Only host tensors can be compared by content.
+  ObjectRef key;
+  if (obj.type_code() == kTVMStr || obj.IsObjectRef<String>()) {
+    key = obj.operator String();
+  } else if (obj.type_code() == kTVMNDArrayHandle) {
+    runtime::NDArray ndarray = obj.operator runtime::NDArray();
+    if (ndarray->device.device_type == kDLCPU && ndarray.IsContiguous()) {
+      key = ndarray;
+    }
+  }
+  if (key.defined()) {
+    auto it = const_dedup_map_.find(key);
+    if (it != const_dedup_map_.end()) {
+      return vm::Instruction::Arg(vm::Instruction::kConstIdx, it->second).data;
+    }
+  }
   vm::Index idx = exec->constants.size();
   exec->constants.push_back(obj);
+  if (key.defined()) {
+    const_dedup_map_.emplace(key, idx);
+  }
   return vm::Instruction::Arg(vm::Instruction::kConstIdx, idx).data;
 }
 
@@ -60,15 +83,49 @@ void ExecBuilderNode::EmitFunction(std::string func_name, int64_t num_inputs,
   exec->global_funcs.push_back(vmfunc);
 }
 
-void ExecBuilderNode::EmitCall(std::string func, std::vector<Instruction::Arg> args, RegName dst) {
-  // store function
+vm::Index ExecBuilderNode::EmitCompiledFunction(std::string func_name, int64_t num_inputs,
+                                                Array<String> param_names) {
+  this->EmitFunction(func_name, num_inputs, param_names);
+  VMFunction& vmfunc = exec->global_funcs.back();
+  vmfunc.kind = VMFuncKind::kVMTIRFunc;
+  // The parameters and the return value.
+  vmfunc.register_file_size = num_inputs + 1;
+  return exec->global_funcs.size() - 1;
+}
+
+void ExecBuilderNode::SetSourceSpan(Span span) {
+  if (!span.defined()) {
+    source_location_.clear();
+    return;
+  }
+  std::ostringstream os;
+  os << (span->source_name.defined() ? span->source_name->name : String("")) << ":" << span->line
+     << ":" << span->column;
+  source_location_ = os.str();
+}
+
+void ExecBuilderNode::BeginInstruction() {
+  Index pc = exec->instr_offset.size();
+  exec->instr_offset.push_back(exec->instr_data.size());
+  if (source_location_ != recorded_location_) {
+    source_locations_.emplace_back(pc, source_location_);
+    recorded_location_ = source_location_;
+  }
+}
+
+Index ExecBuilderNode::GetFuncIndex(const std::string& func) {
   if (exec->func2idx.find(func) == exec->func2idx.end()) {
     exec->func2idx[func] = exec->func_names.size();
     exec->func_names.push_back(func);
   }
-  Index func_idx = exec->func2idx[func];
+  return exec->func2idx[func];
+}
+
+void ExecBuilderNode::EmitCall(std::string func, std::vector<Instruction::Arg> args, RegName dst) {
+  // store function
+  Index func_idx = GetFuncIndex(func);
   // store instruction
-  exec->instr_offset.push_back(exec->instr_data.size());
+  BeginInstruction();
   exec->instr_data.push_back(static_cast<ExecWord>(Opcode::Call));
   exec->instr_data.push_back(dst);
   exec->instr_data.push_back(func_idx);
@@ -78,27 +135,53 @@ void ExecBuilderNode::EmitCall(std::string func, std::vector<Instruction::Arg> a
                  [](Instruction::Arg arg) { return arg.data; });
 }
 
+void ExecBuilderNode::EmitTailCall(std::string func, std::vector<Instruction::Arg> args) {
+  Index func_idx = GetFuncIndex(func);
+  // laid out as a call with a void destination
+  BeginInstruction();
+  exec->instr_data.push_back(static_cast<ExecWord>(Opcode::TailCall));
+  exec->instr_data.push_back(Instruction::kVoidArg);
+  exec->instr_data.push_back(func_idx);
+  exec->instr_data.push_back(args.size());
+  std::transform(args.cbegin(), args.cend(), std::back_inserter(exec->instr_data),
+                 [](Instruction::Arg arg) { return arg.data; });
+}
+
 void ExecBuilderNode::EmitRet(RegName result) {
-  exec->instr_offset.push_back(exec->instr_data.size());
+  BeginInstruction();
   exec->instr_data.push_back(static_cast<ExecWord>(Opcode::Ret));
   exec->instr_data.push_back(result);
 }
 
 void ExecBuilderNode::EmitGoto(Index pc_offset) {
-  exec->instr_offset.push_back(exec->instr_data.size());
+  BeginInstruction();
   exec->instr_data.push_back(static_cast<ExecWord>(Opcode::Goto));
   exec->instr_data.push_back(pc_offset);
 }
 
 void ExecBuilderNode::EmitIf(vm::RegName cond, vm::Index false_offset) {
-  exec->instr_offset.push_back(exec->instr_data.size());
+  BeginInstruction();
   exec->instr_data.push_back(static_cast<ExecWord>(Opcode::If));
   exec->instr_data.push_back(cond);
   exec->instr_data.push_back(false_offset);
 }
 
+void ExecBuilderNode::EmitKillRegister(vm::RegName reg) {
+  BeginInstruction();
+  exec->instr_data.push_back(static_cast<ExecWord>(Opcode::KillRegister));
+  exec->instr_data.push_back(reg);
+}
+
+void ExecBuilderNode::EmitMove(Instruction::Arg src, vm::RegName dst) {
+  BeginInstruction();
+  exec->instr_data.push_back(static_cast<ExecWord>(Opcode::Move));
+  exec->instr_data.push_back(dst);
+  exec->instr_data.push_back(src.data);
+}
+
 void ExecBuilderNode::CheckExecutable() {
   for (auto it = exec->global_funcs.cbegin(); it != exec->global_funcs.cend(); ++it) {
+    if (it->kind == VMFuncKind::kVMTIRFunc) continue;
     Index num_inputs = it->num_args;
     std::unordered_set<RegName> dst_registers;
     std::unordered_set<RegName> arg_registers;
@@ -107,6 +190,7 @@ void ExecBuilderNode::CheckExecutable() {
     for (size_t idx = start_instr; idx < end_instr; ++idx) {
       Instruction instr = exec->GetInstruction(idx);
       switch (instr.op) {
+        case Opcode::TailCall:
         case Opcode::Call: {
           for (int i = 0; i < instr.num_args; ++i) {
             if (instr.args[i].kind() == Instruction::kRegister &&
@@ -142,10 +226,31 @@ void ExecBuilderNode::CheckExecutable() {
           break;
         }
         case Opcode::If: {
-          ICHECK_GT(instr.false_offset, 1);
+          // The true branch may be empty once the instructions are optimized.
+          ICHECK_GT(instr.false_offset, 0);
           arg_registers.emplace(instr.cond);
           break;
         }
+        case Opcode::KillRegister: {
+          if (instr.dst >= num_inputs && dst_registers.find(instr.dst) == dst_registers.end()) {
+            LOG(FATAL) << "register r(" << instr.dst << ") in VM function \"" << it->name
+                       << "\" is killed before it is defined.\n";
+          }
+          break;
+        }
+        case Opcode::Move: {
+          Instruction::Arg src(instr.src);
+          if (src.kind() == Instruction::kRegister) {
+            if (src.value() >= num_inputs &&
+                dst_registers.find(src.value()) == dst_registers.end()) {
+              LOG(FATAL) << "register r(" << src.value() << ") in VM function \"" << it->name
+                         << "\" is moved before it is defined.\n";
+            }
+            arg_registers.emplace(src.value());
+          }
+          dst_registers.emplace(instr.dst);
+          break;
+        }
         default:
           LOG(FATAL) << "should never hit this case: " << static_cast<int>(instr.op);
           break;
@@ -157,22 +262,474 @@ void ExecBuilderNode::CheckExecutable() {
 ObjectPtr<Executable> ExecBuilderNode::Get() {
   this->CheckExecutable();
   this->Formalize();
+  for (; num_flushed_locations_ < source_locations_.size(); ++num_flushed_locations_) {
+    const auto& location = source_locations_[num_flushed_locations_];
+    exec->SetSourceLocation(location.first, location.second);
+  }
   return this->exec;
 }
 
+namespace {
+
+/*! \brief The words of an instruction, laid out as in Executable::instr_data. */
+using InstrWords = std::vector<ExecWord>;
+
+/*!
+ * \brief Peephole rewrites of the instructions of one VM function. The instructions are rewritten
+ *  in place and the removed ones are only marked, so the jump offsets stay in terms of the
+ *  original instructions until the code is compacted.
+ */
+class PeepholeOptimizer {
+ public:
+  PeepholeOptimizer(std::vector<InstrWords>* code, std::vector<bool>* removed, Index num_inputs,
+                    Index shape_of_idx)
+      : code_(*code), removed_(*removed), num_inputs_(num_inputs), shape_of_idx_(shape_of_idx) {}
+
+  void Run() {
+    ThreadJumps();
+    // The data flow rewrites rely on the order of the instructions being an order of execution,
+    // which holds when all the jumps are forward.
+    for (size_t i = 0; i < code_.size(); ++i) {
+      if ((Op(i) == Opcode::Goto && code_[i][1] <= 0) ||
+          (Op(i) == Opcode::If && code_[i][2] <= 0)) {
+        return;
+      }
+    }
+    FindBlockLeaders();
+    RemoveRedundantShapeOf();
+    CoalesceMoves();
+    PropagateCopies();
+  }
+
+ private:
+  Opcode Op(size_t i) const { return static_cast<Opcode>(code_[i][0]); }
+
+  static bool IsSpecial(RegName reg) {
+    return reg == Instruction::kVMRegister || reg == Instruction::kVoidArg;
+  }
+
+  /*! \brief Get the register defined by an instruction, or kVoidArg. */
+  RegName Def(size_t i) const {
+    if (Op(i) == Opcode::Call || Op(i) == Opcode::Move) return code_[i][1];
+    return Instruction::kVoidArg;
+  }
+
+  /*!
+   * \brief Call f on the register and the word of each register read by an instruction.
+   * \note The words of Call arguments and of Move sources are encoded Instruction::Arg, the
+   *  others are register names.
+   */
+  template <typename F>
+  void ForEachUse(size_t i, F f) {
+    InstrWords& words = code_[i];
+    auto visit_arg = [&](ExecWord* word) {
+      Instruction::Arg arg(*word);
+      if (arg.kind() == Instruction::kRegister && !IsSpecial(arg.value())) {
+        f(arg.value(), word, true);
+      }
+    };
+    switch (Op(i)) {
+      case Opcode::Call:
+      case Opcode::TailCall:
+        for (size_t j = 4; j < words.size(); ++j) visit_arg(&words[j]);
+        break;
+      case Opcode::Move:
+        visit_arg(&words[2]);
+        break;
+      case Opcode::Ret:
+        f(words[1], &words[1], false);
+        break;
+      case Opcode::If:
+        f(words[1], &words[1], false);
+        break;
+      default:
+        break;
+    }
+  }
+
+  /*! \brief Count the definitions of each register and record the last one. */
+  void CountDefs() {
+    num_defs_.clear();
+    def_pc_.clear();
+    for (size_t i = 0; i < code_.size(); ++i) {
+      RegName def = Def(i);
+      if (removed_[i] || def == Instruction::kVoidArg) continue;
+      ++num_defs_[def];
+      def_pc_[def] = i;
+    }
+  }
+
+  /*! \brief Whether the register holds a single value in the whole function. */
+  bool IsSingleValue(RegName reg) {
+    return reg < num_inputs_ ? num_defs_[reg] == 0 : num_defs_[reg] == 1;
+  }
+
+  /*! \brief Follow the Goto instructions from a pc, bounded so that cycles of Gotos terminate. */
+  Index FollowGotos(Index pc) const {
+    for (size_t n = 0; n < code_.size(); ++n) {
+      if (pc < 0 || static_cast<size_t>(pc) >= code_.size() || Op(pc) != Opcode::Goto) break;
+      pc += code_[pc][1];
+    }
+    return pc;
+  }
+
+  /*! \brief Retarget the jumps to Gotos, and remove the Gotos to the next instruction. */
+  void ThreadJumps() {
+    for (size_t i = 0; i < code_.size(); ++i) {
+      Index pc = static_cast<Index>(i);
+      if (Op(i) == Opcode::Goto) {
+        Index offset = FollowGotos(pc + code_[i][1]) - pc;
+        if (offset != 0) code_[i][1] = offset;
+        if (code_[i][1] == 1) removed_[i] = true;
+      } else if (Op(i) == Opcode::If) {
+        Index offset = FollowGotos(pc + code_[i][2]) - pc;
+        if (offset > 1) code_[i][2] = offset;
+      }
+    }
+  }
+
+  /*! \brief Mark the first instruction of each basic block. */
+  void FindBlockLeaders() {
+    leader_.assign(code_.size() + 1, false);
+    leader_[0] = true;
+    for (size_t i = 0; i < code_.size(); ++i) {
+      Opcode op = Op(i);
+      if (op == Opcode::Goto || op == Opcode::If || op == Opcode::Ret || op == Opcode::TailCall) {
+        leader_[i + 1] = true;
+      }
+      if (op == Opcode::Goto) leader_[i + code_[i][1]] = true;
+      if (op == Opcode::If) leader_[i + code_[i][2]] = true;
+    }
+  }
+
+  /*!
+   * \brief Turn a shape_of of a tensor whose shape is already held by a register in the same
+   *  basic block into a Move, which is propagated afterwards.
+   */
+  void RemoveRedundantShapeOf() {
+    if (shape_of_idx_ < 0) return;
+    CountDefs();
+    // The register holding the shape of each tensor register in the current block.
+    std::unordered_map<RegName, RegName> shape_reg;
+    for (size_t i = 0; i < code_.size(); ++i) {
+      if (leader_[i]) shape_reg.clear();
+      InstrWords& words = code_[i];
+      if (removed_[i] || Op(i) != Opcode::Call || words[2] != shape_of_idx_ || words[3] != 1) {
+        continue;
+      }
+      Instruction::Arg tensor(words[4]);
+      RegName dst = words[1];
+      if (tensor.kind() != Instruction::kRegister || IsSpecial(tensor.value()) ||
+          IsSpecial(dst) || dst < num_inputs_ || !IsSingleValue(tensor.value()) ||
+          !IsSingleValue(dst)) {
+        continue;
+      }
+      auto it = shape_reg.find(tensor.value());
+      if (it != shape_reg.end()) {
+        RegName shape = it->second;
+        words = {static_cast<ExecWord>(Opcode::Move), dst,
+                 Instruction::Arg(Instruction::kRegister, shape).data};
+        // The shape register is read again, it must outlive the kills in between.
+        for (size_t j = def_pc_[shape] + 1; j < i; ++j) {
+          if (Op(j) == Opcode::KillRegister && static_cast<RegName>(code_[j][1]) == shape) {
+            removed_[j] = true;
+          }
+        }
+      } else {
+        shape_reg[tensor.value()] = dst;
+      }
+    }
+  }
+
+  /*!
+   * \brief Compute the source of a Move directly into its destination, when the source has no
+   *  other use and the destination is untouched in between, e.g. the result of a branch moved
+   *  into the merge register.
+   */
+  void CoalesceMoves() {
+    CountDefs();
+    std::unordered_map<RegName, int> num_uses;
+    for (size_t i = 0; i < code_.size(); ++i) {
+      if (removed_[i]) continue;
+      ForEachUse(i, [&](RegName reg, ExecWord* word, bool is_arg) { ++num_uses[reg]; });
+    }
+    for (size_t i = 0; i < code_.size(); ++i) {
+      if (removed_[i] || Op(i) != Opcode::Move) continue;
+      Instruction::Arg src(code_[i][2]);
+      RegName dst = code_[i][1];
+      if (src.kind() != Instruction::kRegister || IsSpecial(src.value())) continue;
+      RegName tmp = src.value();
+      if (tmp == dst) {
+        removed_[i] = true;
+        continue;
+      }
+      if (tmp < num_inputs_ || num_defs_[tmp] != 1 || num_uses[tmp] != 1 || def_pc_[tmp] > i) {
+        continue;
+      }
+      size_t def = def_pc_[tmp];
+      bool coalescible = !leader_[i];
+      for (size_t j = def + 1; j < i && coalescible; ++j) {
+        if (removed_[j]) continue;
+        if (leader_[j] || Def(j) == dst ||
+            (Op(j) == Opcode::KillRegister && static_cast<RegName>(code_[j][1]) == dst)) {
+          coalescible = false;
+        }
+        ForEachUse(j, [&](RegName reg, ExecWord* word, bool is_arg) {
+          if (reg == dst) coalescible = false;
+        });
+      }
+      if (!coalescible) continue;
+      code_[def][1] = dst;
+      removed_[i] = true;
+      def_pc_[dst] = def;
+      for (size_t j = 0; j < code_.size(); ++j) {
+        if (Op(j) == Opcode::KillRegister && static_cast<RegName>(code_[j][1]) == tmp) {
+          removed_[j] = true;
+        }
+      }
+      num_defs_[tmp] = 0;
+      num_uses[tmp] = 0;
+    }
+  }
+
+  /*!
+   * \brief Replace the uses of the destination of a Move by its source, when both hold a single
+   *  value. The kills of the source before its new last use are removed.
+   */
+  void PropagateCopies() {
+    CountDefs();
+    for (size_t i = 0; i < code_.size(); ++i) {
+      if (removed_[i] || Op(i) != Opcode::Move) continue;
+      Instruction::Arg src_arg(code_[i][2]);
+      RegName dst = code_[i][1];
+      if (src_arg.kind() != Instruction::kRegister || IsSpecial(src_arg.value())) continue;
+      RegName src = src_arg.value();
+      if (src == dst || dst < num_inputs_ || num_defs_[dst] != 1 || !IsSingleValue(src) ||
+          (src >= num_inputs_ && def_pc_[src] > i)) {
+        continue;
+      }
+      removed_[i] = true;
+      num_defs_[dst] = 0;
+      size_t last_use = 0;
+      for (size_t j = 0; j < code_.size(); ++j) {
+        if (removed_[j]) continue;
+        if (Op(j) == Opcode::KillRegister && static_cast<RegName>(code_[j][1]) == dst) {
+          code_[j][1] = src;
+        }
+        ForEachUse(j, [&](RegName reg, ExecWord* word, bool is_arg) {
+          if (reg == dst) *word = is_arg ? Instruction::Arg(Instruction::kRegister, src).data : src;
+          if (reg == dst || reg == src) last_use = j;
+        });
+      }
+      for (size_t j = 0; j < last_use; ++j) {
+        if (Op(j) == Opcode::KillRegister && static_cast<RegName>(code_[j][1]) == src) {
+          removed_[j] = true;
+        }
+      }
+    }
+  }
+
+  std::vector<InstrWords>& code_;
+  std::vector<bool>& removed_;
+  Index num_inputs_;
+  Index shape_of_idx_;
+  std::vector<bool> leader_;
+  std::unordered_map<RegName, int> num_defs_;
+  std::unordered_map<RegName, size_t> def_pc_;
+};
+
+}  // namespace
+
+size_t ExecBuilderNode::FunctionEnd(const VMFunction& func) const {
+  // A function spans up to the start of the next function.
+  size_t end = exec->instr_offset.size();
+  for (const VMFunction& other : exec->global_funcs) {
+    if (other.start_instr > func.start_instr) {
+      end = std::min(end, static_cast<size_t>(other.start_instr));
+    }
+  }
+  return end;
+}
+
+void ExecBuilderNode::Optimize() {
+  ICHECK_EQ(num_flushed_locations_, 0) << "The executable must be optimized before Get";
+  const size_t num_instrs = exec->instr_offset.size();
+  std::vector<InstrWords> code(num_instrs);
+  for (size_t i = 0; i < num_instrs; ++i) {
+    size_t end = i + 1 < num_instrs ? exec->instr_offset[i + 1] : exec->instr_data.size();
+    code[i].assign(exec->instr_data.begin() + exec->instr_offset[i],
+                   exec->instr_data.begin() + end);
+  }
+  auto it = exec->func2idx.find("vm.builtin.shape_of");
+  Index shape_of_idx = it != exec->func2idx.end() ? it->second : -1;
+
+  std::vector<bool> removed(num_instrs, false);
+  for (const VMFunction& func : exec->global_funcs) {
+    if (func.kind == VMFuncKind::kVMTIRFunc) continue;
+    size_t begin = func.start_instr;
+    size_t end = FunctionEnd(func);
+    std::vector<InstrWords> func_code(code.begin() + begin, code.begin() + end);
+    std::vector<bool> func_removed(end - begin, false);
+    PeepholeOptimizer(&func_code, &func_removed, func.num_args, shape_of_idx).Run();
+    std::copy(func_code.begin(), func_code.end(), code.begin() + begin);
+    std::copy(func_removed.begin(), func_removed.end(), removed.begin() + begin);
+  }
+
+  // Compact the code. A jump to a removed instruction lands on the next kept one.
+  std::vector<Index> new_pc(num_instrs + 1, 0);
+  for (size_t i = 0; i < num_instrs; ++i) new_pc[i + 1] = new_pc[i] + (removed[i] ? 0 : 1);
+  exec->instr_offset.clear();
+  exec->instr_data.clear();
+  for (size_t i = 0; i < num_instrs; ++i) {
+    if (removed[i]) continue;
+    InstrWords& words = code[i];
+    Opcode op = static_cast<Opcode>(words[0]);
+    if (op == Opcode::Goto || op == Opcode::If) {
+      ExecWord& offset = words[op == Opcode::Goto ? 1 : 2];
+      offset = new_pc[i + offset] - new_pc[i];
+    }
+    exec->instr_offset.push_back(exec->instr_data.size());
+    exec->instr_data.insert(exec->instr_data.end(), words.begin(), words.end());
+  }
+  for (VMFunction& func : exec->global_funcs) func.start_instr = new_pc[func.start_instr];
+  std::vector<std::pair<Index, std::string>> locations;
+  for (const auto& location : source_locations_) {
+    Index pc = new_pc[location.first];
+    if (static_cast<size_t>(pc) >= exec->instr_offset.size()) break;
+    if (!locations.empty() && locations.back().first == pc) locations.pop_back();
+    locations.emplace_back(pc, location.second);
+  }
+  source_locations_ = std::move(locations);
+}
+
+void ExecBuilderNode::AllocateRegisters() {
+  for (const VMFunction& func : exec->global_funcs) {
+    if (func.kind == VMFuncKind::kVMTIRFunc) continue;
+    size_t begin = func.start_instr;
+    size_t end = FunctionEnd(func);
+    // The live interval of each register from its first definition to its last access, which
+    // covers its liveness as the order of the instructions is an order of execution when all the
+    // jumps are forward. Do nothing otherwise.
+    bool forward_only = true;
+    std::unordered_map<RegName, std::pair<size_t, size_t>> intervals;
+    auto access = [&](RegName reg, size_t idx) {
+      if (reg < func.num_args || reg == Instruction::kVMRegister || reg == Instruction::kVoidArg) {
+        return;
+      }
+      auto it = intervals.emplace(reg, std::make_pair(idx, idx)).first;
+      it->second.second = idx;
+    };
+    auto access_arg = [&](Instruction::Arg arg, size_t idx) {
+      if (arg.kind() == Instruction::kRegister) access(arg.value(), idx);
+    };
+    for (size_t idx = begin; idx < end; ++idx) {
+      Instruction instr = exec->GetInstruction(idx);
+      switch (instr.op) {
+        case Opcode::Call:
+        case Opcode::TailCall:
+          for (int i = 0; i < instr.num_args; ++i) access_arg(instr.args[i], idx);
+          access(instr.dst, idx);
+          break;
+        case Opcode::Ret:
+          access(instr.result, idx);
+          break;
+        case Opcode::Goto:
+          forward_only = forward_only && instr.pc_offset > 0;
+          break;
+        case Opcode::If:
+          forward_only = forward_only && instr.false_offset > 0;
+          access(instr.cond, idx);
+          break;
+        case Opcode::KillRegister:
+          access(instr.dst, idx);
+          break;
+        case Opcode::Move:
+          access_arg(Instruction::Arg(instr.src), idx);
+          access(instr.dst, idx);
+          break;
+        default:
+          LOG(FATAL) << "should never hit this case: " << static_cast<int>(instr.op);
+          break;
+      }
+    }
+    if (!forward_only) continue;
+
+    // Linear scan: a register takes the lowest slot whose previous register is no longer live.
+    std::vector<std::tuple<size_t, size_t, RegName>> order;
+    for (const auto& kv : intervals) {
+      order.emplace_back(kv.second.first, kv.second.second, kv.first);
+    }
+    std::sort(order.begin(), order.end());
+    std::set<std::pair<size_t, RegName>> active;  // (interval end, slot)
+    std::set<RegName> free_slots;
+    RegName num_slots = func.num_args;
+    std::unordered_map<RegName, RegName> slot_of;
+    for (const auto& interval : order) {
+      while (!active.empty() && active.begin()->first < std::get<0>(interval)) {
+        free_slots.insert(active.begin()->second);
+        active.erase(active.begin());
+      }
+      RegName slot;
+      if (free_slots.empty()) {
+        slot = num_slots++;
+      } else {
+        slot = *free_slots.begin();
+        free_slots.erase(free_slots.begin());
+      }
+      slot_of[std::get<2>(interval)] = slot;
+      active.emplace(std::get<1>(interval), slot);
+    }
+
+    auto rename = [&](ExecWord* word) {
+      auto it = slot_of.find(*word);
+      if (it != slot_of.end()) *word = it->second;
+    };
+    auto rename_arg = [&](ExecWord* word) {
+      Instruction::Arg arg(*word);
+      auto it = slot_of.find(arg.value());
+      if (arg.kind() == Instruction::kRegister && it != slot_of.end()) {
+        *word = Instruction::Arg(Instruction::kRegister, it->second).data;
+      }
+    };
+    for (size_t idx = begin; idx < end; ++idx) {
+      ExecWord* words = &exec->instr_data[exec->instr_offset[idx]];
+      switch (static_cast<Opcode>(words[0])) {
+        case Opcode::Call:
+        case Opcode::TailCall:
+          for (ExecWord i = 0; i < words[3]; ++i) rename_arg(&words[4 + i]);
+          rename(&words[1]);
+          break;
+        case Opcode::Ret:
+        case Opcode::If:
+        case Opcode::KillRegister:
+          rename(&words[1]);
+          break;
+        case Opcode::Move:
+          rename_arg(&words[2]);
+          rename(&words[1]);
+          break;
+        default:
+          break;
+      }
+    }
+  }
+}
+
 void ExecBuilderNode::Formalize() {
   // a pass to formalize user-specified register indexes in the order of use
   // and decide the number of registers to allocate for each VMFunction in the Executable
   for (auto it = this->exec->global_funcs.begin(); it != this->exec->global_funcs.end(); ++it) {
+    if (it->kind == VMFuncKind::kVMTIRFunc) continue;
     Index num_inputs = it->num_args;
     RegName register_idx = num_inputs;
     std::unordered_map<RegName, RegName> register_map;
     size_t start_instr = it->start_instr;
-    size_t end_instr = this->exec->instr_offset.size();
+    size_t end_instr = FunctionEnd(*it);
     for (size_t idx = start_instr; idx < end_instr; ++idx) {
       Instruction instr = this->exec->GetInstruction(idx);
       switch (instr.op) {
-        case Opcode::Call: {
+        case Opcode::Call:
+        case Opcode::TailCall: {
           for (int i = 0; i < instr.num_args; ++i) {
             if (instr.args[i].kind() == Instruction::kRegister &&
                 register_map.find(instr.args[i].value()) != register_map.end()) {
@@ -197,6 +754,27 @@ void ExecBuilderNode::Formalize() {
           break;
         }
         case Opcode::If: {
+          if (register_map.find(instr.cond) != register_map.end()) {
+            this->exec->instr_data[this->exec->instr_offset[idx] + 1] = register_map[instr.cond];
+          }
+          break;
+        }
+        case Opcode::KillRegister: {
+          if (register_map.find(instr.dst) != register_map.end()) {
+            this->exec->instr_data[this->exec->instr_offset[idx] + 1] = register_map[instr.dst];
+          }
+          break;
+        }
+        case Opcode::Move: {
+          Instruction::Arg src(instr.src);
+          if (src.kind() == Instruction::kRegister &&
+              register_map.find(src.value()) != register_map.end()) {
+            this->exec->instr_data[this->exec->instr_offset[idx] + 2] = register_map[src.value()];
+          }
+          if (instr.dst >= num_inputs && register_map.find(instr.dst) == register_map.end()) {
+            this->exec->instr_data[this->exec->instr_offset[idx] + 1] = register_idx;
+            register_map[instr.dst] = register_idx++;
+          }
           break;
         }
         default:
@@ -231,6 +809,15 @@ TVM_REGISTER_GLOBAL("relax.ExecBuilderEmitCall")
       builder->EmitCall(name, args_, dst_.value());
     });
 
+TVM_REGISTER_GLOBAL("relax.ExecBuilderEmitTailCall")
+    .set_body_typed([](ExecBuilder builder, String name, Array<IntImm> args) {
+      std::vector<Instruction::Arg> args_;
+      for (size_t i = 0; i < args.size(); ++i) {
+        args_.push_back(static_cast<Instruction::Arg>(args[i]->value));
+      }
+      builder->EmitTailCall(name, args_);
+    });
+
 TVM_REGISTER_GLOBAL("relax.ExecBuilderEmitRet")
     .set_body_method<ExecBuilder>(&ExecBuilderNode::EmitRet);
 
@@ -240,6 +827,25 @@ TVM_REGISTER_GLOBAL("relax.ExecBuilderEmitGoto")
 TVM_REGISTER_GLOBAL("relax.ExecBuilderEmitIf")
     .set_body_method<ExecBuilder>(&ExecBuilderNode::EmitIf);
 
+TVM_REGISTER_GLOBAL("relax.ExecBuilderEmitKillRegister")
+    .set_body_method<ExecBuilder>(&ExecBuilderNode::EmitKillRegister);
+
+TVM_REGISTER_GLOBAL("relax.ExecBuilderEmitMove")
+    .set_body_typed([](ExecBuilder builder, int64_t src, int64_t dst) {
+      Instruction::Arg dst_(dst);
+      CHECK_EQ(dst_.kind(), Instruction::ArgKind::kRegister);
+      builder->EmitMove(Instruction::Arg(src), dst_.value());
+    });
+
+TVM_REGISTER_GLOBAL("relax.ExecBuilderOptimize")
+    .set_body_method<ExecBuilder>(&ExecBuilderNode::Optimize);
+
+TVM_REGISTER_GLOBAL("relax.ExecBuilderAllocateRegisters")
+    .set_body_method<ExecBuilder>(&ExecBuilderNode::AllocateRegisters);
+
+TVM_REGISTER_GLOBAL("relax.ExecBuilderSetSourceSpan")
+    .set_body_method<ExecBuilder>(&ExecBuilderNode::SetSourceSpan);
+
 TVM_REGISTER_GLOBAL("relax.ExecBuilderR").set_body_typed([](ExecBuilder builder, int64_t value) {
   return Instruction::Arg(Instruction::kRegister, value).data;
 });
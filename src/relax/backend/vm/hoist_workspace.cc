@@ -0,0 +1,199 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/backend/vm/hoist_workspace.cc
+ * \brief Hoist the global scratch buffers of the kernels into workspace arguments allocated by
+ * the calling Relax functions, so that they join the static storage plan.
+ */
+#include <tvm/relax/attrs/memory.h>
+#include <tvm/relax/backend.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/tir/function.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt.h>
+
+#include <unordered_map>
+#include <utility>
+
+namespace tvm {
+namespace relax {
+
+// ==================
+// WorkspaceHoister
+// Move the global-scope, static-shape buffers allocated by the root block of a kernel to new
+// trailing buffer parameters, and let every call of the kernel pass a freshly allocated tensor
+// for each of them. The pass runs after CallTIRRewrite, when the kernels are called in
+// destination-passing style, so the trailing parameters never collide with the outputs.
+// Kernels referred to in any other way than such a call are left intact.
+// Example:
+// rx.call_packed(fused_matmul_add, x, w, b, out)   # fused_matmul_add allocates T.alloc_buffer
+// -->
+// ws = rx.call("relax.builtin.alloc_tensor", (m, n), dtype="float32")
+// rx.call_packed(fused_matmul_add, x, w, b, out, ws)
+class WorkspaceHoister : public ExprMutator {
+ public:
+  explicit WorkspaceHoister(IRModule mod) : mod_(std::move(mod)) {}
+
+  IRModule Hoist() {
+    CollectHoistableKernels();
+    if (workspaces_.empty()) return mod_;
+    IRModuleNode* new_module = mod_.CopyOnWrite();
+    for (const auto& kv : kernels_) {
+      new_module->Update(GetRef<GlobalVar>(kv.first), kv.second);
+    }
+    Map<GlobalVar, BaseFunc> functions = mod_->functions;
+    for (const auto& func_pr : functions) {
+      if (const auto* func = func_pr.second.as<FunctionNode>()) {
+        new_module->Update(func_pr.first, Downcast<Function>(VisitExpr(GetRef<Function>(func))));
+      }
+    }
+    return GetRef<IRModule>(new_module);
+  }
+
+  Expr VisitExpr_(const CallNode* call) override {
+    static const Op& call_tir_dyn_op = Op::Get("relax.vm.call_tir_dyn");
+    Call new_call = Downcast<Call>(ExprMutator::VisitExpr_(call));
+    if (const auto* gv = new_call->op.as<GlobalVarNode>()) {
+      auto it = workspaces_.find(gv);
+      if (it == workspaces_.end()) return std::move(new_call);
+      Array<Expr> args = new_call->args;
+      for (const tir::Buffer& buffer : it->second) {
+        args.push_back(EmitWorkspace(buffer));
+      }
+      new_call.CopyOnWrite()->args = args;
+    } else if (new_call->op == call_tir_dyn_op) {
+      auto it = workspaces_.find(new_call->args[0].as<GlobalVarNode>());
+      if (it == workspaces_.end()) return std::move(new_call);
+      Array<Expr> fields = Downcast<Tuple>(new_call->args[1])->fields;
+      for (const tir::Buffer& buffer : it->second) {
+        fields.push_back(EmitWorkspace(buffer));
+      }
+      new_call.CopyOnWrite()->args = {new_call->args[0], Tuple(fields)};
+    }
+    return std::move(new_call);
+  }
+
+ private:
+  /*!
+   * \brief Find the kernels whose every reference is a destination-passing style call, and
+   *  hoist their workspace buffers.
+   */
+  void CollectHoistableKernels() {
+    static const Op& call_tir_dyn_op = Op::Get("relax.vm.call_tir_dyn");
+    std::unordered_map<const GlobalVarNode*, int> num_refs;
+    std::unordered_map<const GlobalVarNode*, int> num_calls;
+    for (const auto& func_pr : mod_->functions) {
+      if (!func_pr.second->IsInstance<FunctionNode>()) continue;
+      PostOrderVisit(func_pr.second, [&](const Expr& e) {
+        if (const auto* gv = e.as<GlobalVarNode>()) {
+          ++num_refs[gv];
+        } else if (const auto* call = e.as<CallNode>()) {
+          if (const auto* gv = call->op.as<GlobalVarNode>()) {
+            ++num_calls[gv];
+          } else if (call->op == call_tir_dyn_op && call->args[1]->IsInstance<TupleNode>()) {
+            if (const auto* gv = call->args[0].as<GlobalVarNode>()) ++num_calls[gv];
+          }
+        }
+      });
+    }
+    for (const auto& func_pr : mod_->functions) {
+      const auto* prim_func = func_pr.second.as<tir::PrimFuncNode>();
+      const GlobalVarNode* gv = func_pr.first.get();
+      if (prim_func == nullptr || !num_calls.count(gv) || num_calls.at(gv) != num_refs.at(gv)) {
+        continue;
+      }
+      Array<tir::Buffer> workspaces;
+      tir::PrimFunc new_func = HoistWorkspaceBuffers(GetRef<tir::PrimFunc>(prim_func), &workspaces);
+      if (workspaces.empty()) continue;
+      kernels_[gv] = new_func;
+      workspaces_[gv] = workspaces;
+    }
+  }
+
+  /*! \brief Whether the buffer is a global scratch buffer of static shape. */
+  static bool IsHoistable(const tir::Buffer& buffer) {
+    if (buffer.scope() != "global" || buffer->dtype.is_void()) return false;
+    for (const PrimExpr& dim : buffer->shape) {
+      if (!dim->IsInstance<IntImmNode>()) return false;
+    }
+    return true;
+  }
+
+  /*! \brief Turn the hoistable root block allocations of the kernel into trailing parameters. */
+  static tir::PrimFunc HoistWorkspaceBuffers(tir::PrimFunc func, Array<tir::Buffer>* workspaces) {
+    const auto* realize = func->body.as<tir::BlockRealizeNode>();
+    if (realize == nullptr) return func;
+    tir::Block root = realize->block;
+    Array<tir::Buffer> alloc_buffers;
+    for (const tir::Buffer& buffer : root->alloc_buffers) {
+      if (IsHoistable(buffer)) {
+        workspaces->push_back(buffer);
+      } else {
+        alloc_buffers.push_back(buffer);
+      }
+    }
+    if (workspaces->empty()) return func;
+    root.CopyOnWrite()->alloc_buffers = alloc_buffers;
+    tir::BlockRealize new_realize = GetRef<tir::BlockRealize>(realize);
+    new_realize.CopyOnWrite()->block = root;
+
+    tir::PrimFuncNode* n = func.CopyOnWrite();
+    n->body = new_realize;
+    for (const tir::Buffer& buffer : *workspaces) {
+      tir::Var param(buffer->name + "_handle", DataType::Handle());
+      n->params.push_back(param);
+      n->buffer_map.Set(param, buffer);
+    }
+    return func;
+  }
+
+  /*! \brief Allocate a tensor for the workspace buffer right before the call. */
+  Var EmitWorkspace(const tir::Buffer& buffer) {
+    static const Op& alloc_tensor_op = Op::Get("relax.builtin.alloc_tensor");
+    Array<PrimExpr> shape;
+    for (const PrimExpr& dim : buffer->shape) {
+      shape.push_back(IntImm(DataType::Int(64), Downcast<IntImm>(dim)->value));
+    }
+    auto attrs = make_object<AllocTensorAttrs>();
+    attrs->dtype = buffer->dtype;
+    attrs->runtime_device_index = 0;
+    return builder_->Emit(Call(alloc_tensor_op, {ShapeExpr(shape)}, Attrs(attrs)), "workspace");
+  }
+
+  /*! \brief The module being rewritten. */
+  IRModule mod_;
+  /*! \brief The rewritten kernels. */
+  std::unordered_map<const GlobalVarNode*, tir::PrimFunc> kernels_;
+  /*! \brief The hoisted workspace buffers of each rewritten kernel, in parameter order. */
+  std::unordered_map<const GlobalVarNode*, Array<tir::Buffer>> workspaces_;
+};
+
+namespace transform {
+
+Pass HoistWorkspace() {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule mod, PassContext pc) { return WorkspaceHoister(std::move(mod)).Hoist(); };
+  return CreateModulePass(pass_func, 0, "HoistWorkspace", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.HoistWorkspace").set_body_typed(HoistWorkspace);
+
+}  // namespace transform
+}  // namespace relax
+}  // namespace tvm
@@ -0,0 +1,74 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/backend/vm/shape_jit.cc
+ * \brief The compile function of the JIT which specializes the VM kernels for hot shapes.
+ */
+#include <tvm/driver/driver_api.h>
+#include <tvm/ir/module.h>
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/target/target.h>
+#include <tvm/tir/function.h>
+
+#include <sstream>
+#include <string>
+
+namespace tvm {
+namespace relax {
+namespace relax_vm {
+
+/*!
+ * \brief Create the compile function of the shape JIT of the VM.
+ * \param mod The module holding the kernels called by vm.call_tir_dyn.
+ * \param target The target to build the specialized kernels for.
+ * \return A function which takes a kernel name and the values of the symbolic variables which
+ *  vm.call_tir_dyn unpacks into the trailing params of the kernel, binds the params to the
+ *  values, and builds the specialized kernel, nullptr if the kernel is not in the module.
+ */
+PackedFunc ShapeJITCompiler(IRModule mod, Target target) {
+  return TypedPackedFunc<PackedFunc(String, ShapeTuple)>(
+      [mod, target](String kernel, ShapeTuple values) -> PackedFunc {
+        if (!mod->ContainGlobalVar(kernel)) return nullptr;
+        const auto* func = mod->Lookup(kernel).as<tir::PrimFuncNode>();
+        if (func == nullptr || func->params.size() < values.size()) return nullptr;
+        size_t offset = func->params.size() - values.size();
+        Map<tir::Var, ObjectRef> param_map;
+        std::ostringstream symbol;
+        symbol << kernel;
+        for (size_t i = 0; i < values.size(); ++i) {
+          const tir::Var& param = func->params[offset + i];
+          param_map.Set(param, IntImm(param->dtype, values[i]));
+          symbol << "_" << values[i];
+        }
+        tir::PrimFunc specialized = tir::Specialize(GetRef<tir::PrimFunc>(func), param_map);
+        specialized = WithAttr(specialized, tvm::attr::kGlobalSymbol, String(symbol.str()));
+        IRModule spec_mod({{GlobalVar(symbol.str()), specialized}});
+        runtime::Module lib = tvm::build(spec_mod, target, Target());
+        // The function keeps the library alive.
+        return lib.GetFunction(symbol.str());
+      });
+}
+
+TVM_REGISTER_GLOBAL("relax.VMShapeJITCompiler").set_body_typed(ShapeJITCompiler);
+
+}  // namespace relax_vm
+}  // namespace relax
+}  // namespace tvm
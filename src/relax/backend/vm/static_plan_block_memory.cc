@@ -0,0 +1,707 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/backend/vm/static_plan_block_memory.cc
+ * \brief Liveness-based static memory planning for the tensors allocated by
+ * relax.builtin.alloc_tensor. Tensors whose lifetimes never overlap share a single
+ * storage per device at different offsets.
+ *
+ * By default the offsets are assigned first-fit in binding order. The pass config
+ * "relax.StaticPlanBlockMemory.algorithm" selects one of the USMP algorithms instead, which
+ * plan the tensors from their liveness conflicts into a few statically sized pools, or
+ * "token_reuse", the storage token reuse of the graph memory planning of Relay, which gives
+ * each tensor a storage of its own, reused by the later tensors of a similar size once it dies.
+ *
+ * Tensors with symbolic shapes are planned at their worst-case size when the function
+ * annotates an upper bound for each symbolic variable of the shape, e.g.
+ * `func.with_attr("tir_var_upper_bound", {"seq_len": 2048})`.
+ *
+ * With the pass config "relax.StaticPlanBlockMemory.vtcm_capacity_bytes", the tensors with the
+ * shortest live intervals, i.e. the intermediates passed between consecutive kernels, are
+ * placed in a "global.vtcm" storage per device within the capacity, so that the kernels on
+ * Hexagon exchange them through the VTCM instead of the DDR.
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/ir/memory_pools.h>
+#include <tvm/relax/attrs/memory.h>
+#include <tvm/relax/backend.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/type.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/usmp/algorithms.h>
+#include <tvm/tir/usmp/utils.h>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../../../relay/backend/token_allocator.h"
+
+namespace tvm {
+namespace relax {
+
+/*! \brief The pass config option selecting the memory planning algorithm. */
+constexpr const char* kStaticPlanAlgorithmOption = "relax.StaticPlanBlockMemory.algorithm";
+/*!
+ * \brief The pass config option bounding the size of the first pool of each device. Tensors
+ * that do not fit are planned into a second, unrestricted pool. Only used by USMP algorithms.
+ */
+constexpr const char* kStaticPlanPoolSizeOption = "relax.StaticPlanBlockMemory.pool_size_bytes";
+/*!
+ * \brief The pass config option giving the VTCM capacity of each device in bytes. The hottest
+ * tensors are placed in the VTCM while they fit. 0, the default, places no tensor in the VTCM.
+ */
+constexpr const char* kStaticPlanVTCMCapacityOption =
+    "relax.StaticPlanBlockMemory.vtcm_capacity_bytes";
+/*! \brief The memory scope of the VTCM of Hexagon. */
+constexpr const char* kVTCMScope = "global.vtcm";
+
+/*! \brief The function attribute mapping the symbolic shape variables to their upper bounds. */
+constexpr const char* kTIRVarUpperBound = "tir_var_upper_bound";
+
+TVM_REGISTER_PASS_CONFIG_OPTION(kStaticPlanAlgorithmOption, String);
+TVM_REGISTER_PASS_CONFIG_OPTION(kStaticPlanPoolSizeOption, Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION(kStaticPlanVTCMCapacityOption, Integer);
+
+/*! \brief The planning decision of a single tensor allocation. */
+struct PlannedAlloc {
+  /*! \brief The runtime device index the tensor is allocated on. */
+  int64_t device_index;
+  /*! \brief The index of the planned storage the tensor is placed in. */
+  int64_t storage_index;
+  /*! \brief The byte offset of the tensor in the shared storage. */
+  int64_t offset;
+  /*! \brief The aligned size of the tensor in bytes. */
+  int64_t size;
+  /*! \brief The dtype of the tensor. */
+  DataType dtype;
+};
+
+/*! \brief The planning decision of the shared storage of one device. */
+struct PlannedStorage {
+  /*! \brief The runtime device index the storage is allocated on. */
+  int64_t device_index{0};
+  /*! \brief The total size of the storage in bytes. */
+  int64_t size{0};
+  /*! \brief The dtype hint passed to the allocator. */
+  DataType dtype;
+  /*! \brief The memory scope of the storage. */
+  std::string mem_scope{"global"};
+};
+
+// ==================
+// StorageLivenessAnalyzer
+// Collect the relax.builtin.alloc_tensor bindings at the top level of a function whose shapes are
+// static or bounded by the upper bounds of their symbolic variables,
+// compute their live intervals in binding order, and reject the ones that may escape the
+// function (returned, captured, packed into tuples, ...). Values that may alias an allocated
+// tensor (the used result of a call taking the tensor, or a plain rebinding) are merged into
+// the tensor's alias set so that the live interval covers all of them.
+class StorageLivenessAnalyzer {
+ public:
+  explicit StorageLivenessAnalyzer(Map<String, IntImm> upper_bounds)
+      : upper_bounds_(std::move(upper_bounds)) {}
+
+  void Analyze(const SeqExprNode* seq) {
+    static const Op& alloc_tensor_op = Op::Get("relax.builtin.alloc_tensor");
+    CollectUsedVars(seq);
+    int64_t index = 0;
+    for (const BindingBlock& block : seq->blocks) {
+      for (const Binding& binding : block->bindings) {
+        if (const auto* var_binding = binding.as<VarBindingNode>()) {
+          const VarNode* var = var_binding->var.get();
+          const auto* call = var_binding->value.as<CallNode>();
+          if (call != nullptr && call->op == alloc_tensor_op) {
+            PlannedAlloc info;
+            if (GetStaticAllocInfo(call, &info)) {
+              alloc_order_.push_back(var);
+              alloc_info_[var] = info;
+              def_index_[var] = index;
+            }
+          } else if (const auto* value_var = var_binding->value.as<VarNode>()) {
+            Union(var, value_var);
+            MarkUse(value_var, index);
+          } else if (call != nullptr) {
+            VisitCallArgs(call, index);
+            // Conservatively assume the call result may alias its tensor arguments. The result
+            // of destination-passing style kernel calls is never used, so they are not merged.
+            if (used_vars_.count(var)) {
+              for (const Expr& arg : call->args) {
+                if (const auto* arg_var = arg.as<VarNode>()) {
+                  Union(var, arg_var);
+                }
+              }
+            }
+          } else {
+            MarkEscape(var_binding->value, index);
+          }
+        } else if (const auto* match_shape = binding.as<MatchShapeNode>()) {
+          MarkEscape(match_shape->value, index);
+        }
+        ++index;
+      }
+    }
+    MarkEscape(seq->body, index);
+  }
+
+  /*!
+   * \brief Assign each plannable tensor a storage and an offset in it.
+   * \param algorithm The planning algorithm, "first_fit" or the name of a USMP algorithm.
+   * \param pool_size_bytes The size bound of the first pool of each device, or -1 if unbounded.
+   * \param vtcm_capacity The VTCM capacity of each device in bytes, 0 to not use the VTCM.
+   * \param allocs The planned allocation of each tensor binding var.
+   * \param storages The planned storage of each storage index.
+   */
+  void Plan(const std::string& algorithm, int64_t pool_size_bytes, int64_t vtcm_capacity,
+            std::unordered_map<const VarNode*, PlannedAlloc>* allocs,
+            std::map<int64_t, PlannedStorage>* storages) {
+    std::vector<LiveTensor> tensors;
+    for (const VarNode* var : alloc_order_) {
+      const VarNode* root = Find(var);
+      if (escaped_.count(root)) continue;
+      int64_t def = def_index_.at(var);
+      int64_t last_use = last_use_.count(root) ? std::max(last_use_.at(root), def) : def;
+      tensors.push_back({var, alloc_info_.at(var), def, last_use});
+    }
+    std::vector<LiveTensor> vtcm_tensors;
+    if (vtcm_capacity > 0) {
+      PlaceInVTCM(vtcm_capacity, &tensors, &vtcm_tensors);
+    }
+    if (algorithm == "first_fit") {
+      PlanFirstFit(&tensors);
+    } else if (algorithm == "token_reuse") {
+      PlanTokenReuse(&tensors);
+    } else {
+      PlanWithUSMP(algorithm, pool_size_bytes, &tensors);
+    }
+    for (const LiveTensor& t : tensors) {
+      PlannedStorage& storage = (*storages)[t.info.storage_index];
+      if (storage.size == 0) {
+        storage.device_index = t.info.device_index;
+        storage.dtype = t.info.dtype;
+      }
+      storage.size = std::max(storage.size, t.info.offset + t.info.size);
+      allocs->emplace(t.var, t.info);
+    }
+    // The VTCM storages come after the global ones, one per device.
+    int64_t next_index = storages->empty() ? 0 : storages->rbegin()->first + 1;
+    std::map<int64_t, int64_t> vtcm_storage_index;
+    for (LiveTensor& t : vtcm_tensors) {
+      auto it = vtcm_storage_index.find(t.info.device_index);
+      if (it == vtcm_storage_index.end()) {
+        it = vtcm_storage_index.emplace(t.info.device_index, next_index++).first;
+      }
+      t.info.storage_index = it->second;
+      PlannedStorage& storage = (*storages)[it->second];
+      storage.device_index = t.info.device_index;
+      storage.dtype = DataType::UInt(8);
+      storage.mem_scope = kVTCMScope;
+      storage.size = std::max(storage.size, t.info.offset + t.info.size);
+      allocs->emplace(t.var, t.info);
+    }
+  }
+
+ private:
+  /*! \brief A plannable tensor with its live interval in binding indices, both inclusive. */
+  struct LiveTensor {
+    const VarNode* var;
+    PlannedAlloc info;
+    int64_t def;
+    int64_t last_use;
+  };
+
+  /*!
+   * \brief Move the hottest tensors, the ones with the shortest live intervals, to the VTCM of
+   *  their device as long as they fit in the capacity. The tensors are placed first-fit among
+   *  the VTCM tensors whose live intervals overlap with their own.
+   */
+  static void PlaceInVTCM(int64_t capacity, std::vector<LiveTensor>* tensors,
+                          std::vector<LiveTensor>* vtcm_tensors) {
+    std::vector<size_t> order(tensors->size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [tensors](size_t a, size_t b) {
+      const LiveTensor& ta = (*tensors)[a];
+      const LiveTensor& tb = (*tensors)[b];
+      return ta.last_use - ta.def < tb.last_use - tb.def;
+    });
+    std::vector<bool> in_vtcm(tensors->size(), false);
+    for (size_t i : order) {
+      LiveTensor& tensor = (*tensors)[i];
+      std::vector<const LiveTensor*> live;
+      for (const LiveTensor& t : *vtcm_tensors) {
+        if (t.info.device_index == tensor.info.device_index && t.def <= tensor.last_use &&
+            tensor.def <= t.last_use) {
+          live.push_back(&t);
+        }
+      }
+      std::sort(live.begin(), live.end(), [](const LiveTensor* a, const LiveTensor* b) {
+        return a->info.offset < b->info.offset;
+      });
+      int64_t offset = 0;
+      for (const LiveTensor* t : live) {
+        if (offset + tensor.info.size <= t->info.offset) break;
+        offset = std::max(offset, t->info.offset + t->info.size);
+      }
+      if (offset + tensor.info.size > capacity) continue;
+      tensor.info.offset = offset;
+      vtcm_tensors->push_back(tensor);
+      in_vtcm[i] = true;
+    }
+    std::vector<LiveTensor> rest;
+    for (size_t i = 0; i < tensors->size(); ++i) {
+      if (!in_vtcm[i]) rest.push_back((*tensors)[i]);
+    }
+    *tensors = std::move(rest);
+  }
+
+  /*! \brief Place the tensors first-fit in binding order, one storage per device. */
+  void PlanFirstFit(std::vector<LiveTensor>* tensors) {
+    std::map<int64_t, std::vector<const LiveTensor*>> live_tensors;
+    for (LiveTensor& tensor : *tensors) {
+      PlannedAlloc& info = tensor.info;
+      int64_t def = tensor.def;
+      // Release the tensors that are dead before this definition.
+      std::vector<const LiveTensor*>& live = live_tensors[info.device_index];
+      live.erase(std::remove_if(live.begin(), live.end(),
+                                [def](const LiveTensor* t) { return t->last_use < def; }),
+                 live.end());
+      std::sort(live.begin(), live.end(), [](const LiveTensor* a, const LiveTensor* b) {
+        return a->info.offset < b->info.offset;
+      });
+      // First-fit search for a gap that is large enough.
+      int64_t offset = 0;
+      for (const LiveTensor* t : live) {
+        if (offset + info.size <= t->info.offset) break;
+        offset = std::max(offset, t->info.offset + t->info.size);
+      }
+      info.offset = offset;
+      info.storage_index = info.device_index;
+      live.push_back(&tensor);
+    }
+  }
+
+  /*!
+   * \brief Place the tensors at the start of storage tokens in binding order, as the graph memory
+   *  planning of Relay does: a tensor takes a dead token of its device whose size is within a
+   *  factor of 16 of its own, growing it if needed, or a new token.
+   */
+  void PlanTokenReuse(std::vector<LiveTensor>* tensors) {
+    struct StorageToken {
+      int64_t device_index;
+      int64_t max_bytes;
+      int64_t storage_index;
+      bool is_compatible(const StorageToken& that) const {
+        return device_index == that.device_index;
+      }
+    };
+    std::vector<std::unique_ptr<StorageToken>> storage_tokens;
+    relay::TokenFreeList<StorageToken> free_list;
+    // The tokens of the live tensors by the last use of the tensors.
+    std::multimap<int64_t, StorageToken*> live;
+    for (LiveTensor& tensor : *tensors) {
+      PlannedAlloc& info = tensor.info;
+      for (auto it = live.begin(); it != live.end() && it->first < tensor.def;) {
+        free_list.Release(it->second);
+        it = live.erase(it);
+      }
+      StorageToken prototype{info.device_index, info.size, -1};
+      StorageToken* tok = free_list.Request(prototype, info.size);
+      if (tok == nullptr) {
+        prototype.storage_index = static_cast<int64_t>(storage_tokens.size());
+        storage_tokens.push_back(std::make_unique<StorageToken>(prototype));
+        tok = storage_tokens.back().get();
+      }
+      info.offset = 0;
+      info.storage_index = tok->storage_index;
+      live.emplace(tensor.last_use, tok);
+    }
+  }
+
+  /*!
+   * \brief Place the tensors with a USMP algorithm. Each tensor becomes a BufferInfo that
+   * conflicts with the tensors on the same device whose live intervals overlap with its own,
+   * and each device gets its own pools.
+   */
+  void PlanWithUSMP(const std::string& algorithm, int64_t pool_size_bytes,
+                    std::vector<LiveTensor>* tensors) {
+    using tir::usmp::BufferInfo;
+    using tir::usmp::PoolAllocation;
+    using FAlgorithm =
+        std::function<Map<BufferInfo, PoolAllocation>(const Array<BufferInfo>&, const Integer&)>;
+    static const std::unordered_map<std::string, FAlgorithm> algorithms = {
+        {"greedy_by_size", tir::usmp::algo::GreedyBySize},
+        {"greedy_by_conflicts", tir::usmp::algo::GreedyByConflicts},
+        {"hill_climb", tir::usmp::algo::HillClimb}};
+    FAlgorithm falgorithm;
+    auto it = algorithms.find(algorithm);
+    if (it != algorithms.end()) {
+      falgorithm = it->second;
+    } else {
+      const runtime::PackedFunc* custom = runtime::Registry::Get("tir.usmp.algo." + algorithm);
+      CHECK(custom) << "The memory planning algorithm " << algorithm
+                    << " is not defined. Please use \"first_fit\", one of the USMP algorithms, "
+                       "or register it as tir.usmp.algo."
+                    << algorithm;
+      falgorithm = *custom;
+    }
+
+    // The pools of each device, and the storage index of each pool.
+    std::map<int64_t, Array<PoolInfo>> device_pools;
+    std::unordered_map<const Object*, int64_t> storage_index;
+    Array<BufferInfo> buffer_infos;
+    for (const LiveTensor& t : *tensors) {
+      int64_t device_index = t.info.device_index;
+      Array<PoolInfo>& pools = device_pools[device_index];
+      if (pools.empty()) {
+        std::string name = "relax_storage_dev" + std::to_string(device_index);
+        if (pool_size_bytes > 0) {
+          pools.push_back(WorkspacePoolInfo(name + "_bounded", {},
+                                            PoolInfoProperties(IntImm(DataType::Int(64),
+                                                                      pool_size_bytes))));
+        }
+        pools.push_back(WorkspacePoolInfo(name, {}));
+        for (const PoolInfo& pool : pools) {
+          int64_t index = storage_index.size();
+          storage_index[pool.get()] = index;
+        }
+      }
+      buffer_infos.push_back(BufferInfo(t.var->name_hint(),
+                                        IntImm(DataType::Int(64), t.info.size), pools,
+                                        Integer(static_cast<int>(runtime::kAllocAlignment))));
+    }
+
+    // The conflict graph, and the memory pressure as the peak total size of the live tensors.
+    int64_t memory_pressure = 0;
+    for (size_t i = 0; i < tensors->size(); ++i) {
+      const LiveTensor& ti = (*tensors)[i];
+      Array<ObjectRef> conflicts;
+      int64_t live_bytes = 0;
+      for (size_t j = 0; j < tensors->size(); ++j) {
+        const LiveTensor& tj = (*tensors)[j];
+        if (ti.info.device_index != tj.info.device_index) continue;
+        if (tj.def <= ti.def && ti.def <= tj.last_use) live_bytes += tj.info.size;
+        if (i != j && ti.def <= tj.last_use && tj.def <= ti.last_use) {
+          conflicts.push_back(buffer_infos[j]);
+        }
+      }
+      buffer_infos[i]->SetConflicts(conflicts);
+      memory_pressure = std::max(memory_pressure, live_bytes);
+    }
+
+    Map<BufferInfo, PoolAllocation> pool_allocations =
+        falgorithm(buffer_infos, IntImm(DataType::Int(64), memory_pressure));
+    for (size_t i = 0; i < tensors->size(); ++i) {
+      PoolAllocation allocation = pool_allocations.at(buffer_infos[i]);
+      PlannedAlloc& info = (*tensors)[i].info;
+      info.offset = allocation->byte_offset.IntValue();
+      info.storage_index = storage_index.at(allocation->pool_info.get());
+    }
+    // Break the reference cycles of the conflict graph.
+    for (const BufferInfo& buffer_info : buffer_infos) {
+      buffer_info->SetConflicts({});
+    }
+  }
+
+  void CollectUsedVars(const SeqExprNode* seq) {
+    auto fvisit = [this](const Expr& e) {
+      if (const auto* var = e.as<VarNode>()) {
+        used_vars_.insert(var);
+      }
+    };
+    for (const BindingBlock& block : seq->blocks) {
+      for (const Binding& binding : block->bindings) {
+        if (const auto* var_binding = binding.as<VarBindingNode>()) {
+          PostOrderVisit(var_binding->value, fvisit);
+        } else if (const auto* match_shape = binding.as<MatchShapeNode>()) {
+          PostOrderVisit(match_shape->value, fvisit);
+        }
+      }
+    }
+    PostOrderVisit(seq->body, fvisit);
+  }
+
+  bool GetStaticAllocInfo(const CallNode* call, PlannedAlloc* info) {
+    const auto* attrs = call->attrs.as<AllocTensorAttrs>();
+    const auto* shape = call->args[0].as<ShapeExprNode>();
+    if (attrs == nullptr || shape == nullptr || attrs->dtype.is_void()) return false;
+    // The storage of other memory scopes than the global one is shaped, and not planned.
+    if (!attrs->mem_scope.empty() && attrs->mem_scope != "global") return false;
+    int64_t num_elem = 1;
+    for (const PrimExpr& dim : shape->values) {
+      int64_t value = 0;
+      if (!GetDimUpperBound(dim, &value)) return false;
+      num_elem *= value;
+    }
+    int64_t elem_bytes = (attrs->dtype.bits() * attrs->dtype.lanes() + 7) / 8;
+    int64_t size = num_elem * elem_bytes;
+    int64_t alignment = runtime::kAllocAlignment;
+    size = std::max<int64_t>((size + alignment - 1) / alignment * alignment, alignment);
+    info->device_index = attrs->runtime_device_index;
+    info->storage_index = attrs->runtime_device_index;
+    info->offset = 0;
+    info->size = size;
+    info->dtype = attrs->dtype;
+    return true;
+  }
+
+  /*! \brief Get the constant value of a dim, or its worst case under the upper bounds. */
+  bool GetDimUpperBound(const PrimExpr& dim, int64_t* value) {
+    if (const int64_t* const_value = tir::as_const_int(dim)) {
+      *value = *const_value;
+      return true;
+    }
+    if (upper_bounds_.empty()) return false;
+    arith::Analyzer analyzer;
+    bool bounded = true;
+    tir::PostOrderVisit(dim, [&](const ObjectRef& obj) {
+      const auto* var = obj.as<tir::VarNode>();
+      if (var == nullptr) return;
+      auto it = upper_bounds_.find(var->name_hint);
+      if (it == upper_bounds_.end()) {
+        bounded = false;
+        return;
+      }
+      int64_t bound = (*it).second->value;
+      analyzer.Bind(GetRef<tir::Var>(var),
+                    Range::FromMinExtent(tir::make_zero(var->dtype),
+                                         tir::make_const(var->dtype, bound + 1)),
+                    /*allow_override=*/true);
+    });
+    if (!bounded) return false;
+    int64_t max_value = analyzer.const_int_bound(dim)->max_value;
+    if (max_value == arith::ConstIntBound::kPosInf) return false;
+    *value = std::max<int64_t>(max_value, 0);
+    return true;
+  }
+
+  void VisitCallArgs(const CallNode* call, int64_t index) {
+    static const Op& call_tir_dyn_op = Op::Get("relax.vm.call_tir_dyn");
+    for (size_t i = 0; i < call->args.size(); ++i) {
+      const Expr& arg = call->args[i];
+      if (const auto* var = arg.as<VarNode>()) {
+        MarkUse(var, index);
+      } else if (call->op == call_tir_dyn_op && i == 1 && arg->IsInstance<TupleNode>()) {
+        // The packed arguments of call_tir_dyn are passed to the kernel directly.
+        for (const Expr& field : Downcast<Tuple>(arg)->fields) {
+          if (const auto* var = field.as<VarNode>()) {
+            MarkUse(var, index);
+          } else {
+            MarkEscape(field, index);
+          }
+        }
+      } else {
+        MarkEscape(arg, index);
+      }
+    }
+  }
+
+  void MarkUse(const VarNode* var, int64_t index) {
+    const VarNode* root = Find(var);
+    auto it = last_use_.find(root);
+    if (it == last_use_.end()) {
+      last_use_[root] = index;
+    } else {
+      it->second = std::max(it->second, index);
+    }
+  }
+
+  void MarkEscape(const Expr& expr, int64_t index) {
+    PostOrderVisit(expr, [this, index](const Expr& e) {
+      if (const auto* var = e.as<VarNode>()) {
+        MarkUse(var, index);
+        escaped_.insert(Find(var));
+      }
+    });
+  }
+
+  const VarNode* Find(const VarNode* var) {
+    auto it = parent_.find(var);
+    if (it == parent_.end() || it->second == var) return var;
+    const VarNode* root = Find(it->second);
+    parent_[var] = root;
+    return root;
+  }
+
+  void Union(const VarNode* lhs, const VarNode* rhs) {
+    const VarNode* lhs_root = Find(lhs);
+    const VarNode* rhs_root = Find(rhs);
+    if (lhs_root == rhs_root) return;
+    parent_[lhs_root] = rhs_root;
+    if (escaped_.count(lhs_root)) escaped_.insert(rhs_root);
+    auto it = last_use_.find(lhs_root);
+    if (it != last_use_.end()) {
+      MarkUse(rhs_root, it->second);
+    }
+  }
+
+  /*! \brief The upper bounds of the symbolic shape variables by name. */
+  Map<String, IntImm> upper_bounds_;
+  /*! \brief The vars that are used at least once in the function. */
+  std::unordered_set<const VarNode*> used_vars_;
+  /*! \brief The static-shape allocations in binding order. */
+  std::vector<const VarNode*> alloc_order_;
+  /*! \brief The size and device of each allocation. */
+  std::unordered_map<const VarNode*, PlannedAlloc> alloc_info_;
+  /*! \brief The binding index at which each allocation is defined. */
+  std::unordered_map<const VarNode*, int64_t> def_index_;
+  /*! \brief The last binding index at which each alias set is used. */
+  std::unordered_map<const VarNode*, int64_t> last_use_;
+  /*! \brief The alias sets that may escape the function. */
+  std::unordered_set<const VarNode*> escaped_;
+  /*! \brief The union-find forest of alias sets. */
+  std::unordered_map<const VarNode*, const VarNode*> parent_;
+};
+
+// ==================
+// StorageAllocationRewriter
+// Rewrite the planned relax.builtin.alloc_tensor to VM builtins on the shared storage.
+// Example:
+// x = relax.builtin.alloc_tensor((2, 3), dtype="float32")
+// ...
+// y = relax.builtin.alloc_tensor((2, 3), dtype="float32")  # x is dead here
+// -->
+// storage = relax.vm.builtin.alloc_storage((128,), dtype="float32")
+// x = relax.vm.builtin.alloc_tensor(storage, (2, 3), offset=0, dtype="float32")
+// ...
+// y = relax.vm.builtin.alloc_tensor(storage, (2, 3), offset=0, dtype="float32")
+class StorageAllocationRewriter : public ExprMutator {
+ public:
+  StorageAllocationRewriter(std::string algorithm, int64_t pool_size_bytes, int64_t vtcm_capacity)
+      : algorithm_(std::move(algorithm)),
+        pool_size_bytes_(pool_size_bytes),
+        vtcm_capacity_(vtcm_capacity) {}
+
+  Expr VisitExpr_(const FunctionNode* func) override {
+    // Only the outermost function is planned; local functions are kept intact.
+    const auto* seq = func->body.as<SeqExprNode>();
+    if (seq == nullptr || in_function_) return GetRef<Expr>(func);
+
+    StorageLivenessAnalyzer analyzer(
+        func->GetAttr<Map<String, IntImm>>(kTIRVarUpperBound).value_or(Map<String, IntImm>()));
+    analyzer.Analyze(seq);
+    planned_allocs_.clear();
+    planned_storages_.clear();
+    storage_vars_.clear();
+    analyzer.Plan(algorithm_, pool_size_bytes_, vtcm_capacity_, &planned_allocs_,
+                  &planned_storages_);
+    if (planned_allocs_.empty()) return GetRef<Expr>(func);
+    in_function_ = true;
+    Expr ret = ExprMutator::VisitExpr_(func);
+    in_function_ = false;
+    return ret;
+  }
+
+  void VisitBinding_(const VarBindingNode* binding) override {
+    auto it = planned_allocs_.find(binding->var.get());
+    if (it == planned_allocs_.end()) {
+      ExprMutator::VisitBinding_(binding);
+      return;
+    }
+    static const Op& vm_alloc_tensor_op = Op::Get("relax.vm.builtin.alloc_tensor");
+    const PlannedAlloc& info = it->second;
+    const auto* alloc_attrs = binding->value.as<CallNode>()->attrs.as<AllocTensorAttrs>();
+    Var storage = GetOrEmitStorage(info.storage_index);
+
+    auto tensor_attr = make_object<VMAllocTensorAttrs>();
+    tensor_attr->offset = info.offset;
+    tensor_attr->dtype = alloc_attrs->dtype;
+    Expr shape = binding->value.as<CallNode>()->args[0];
+    Call tensor(vm_alloc_tensor_op, {storage, shape}, Attrs(tensor_attr));
+    Var new_var = Emit(tensor, binding->var);
+    this->var_remap_[binding->var->vid] = new_var;
+  }
+
+ private:
+  Var GetOrEmitStorage(int64_t storage_index) {
+    auto it = storage_vars_.find(storage_index);
+    if (it != storage_vars_.end()) return it->second;
+
+    static const Op& vm_alloc_storage_op = Op::Get("relax.vm.builtin.alloc_storage");
+    const PlannedStorage& planned = planned_storages_.at(storage_index);
+    auto storage_attr = make_object<VMAllocStorageAttrs>();
+    storage_attr->dtype = planned.dtype;
+    storage_attr->runtime_device_index = planned.device_index;
+    storage_attr->mem_scope = planned.mem_scope;
+    Expr size = ShapeExpr({IntImm(DataType::Int(64), planned.size)});
+    Call storage_call(vm_alloc_storage_op, {size}, Attrs(storage_attr));
+    Var storage = builder_->CurrentBlockIsDataFlow() ? builder_->EmitOutput(storage_call, "storage")
+                                                     : builder_->Emit(storage_call, "storage");
+    storage_vars_[storage_index] = storage;
+    return storage;
+  }
+
+  Var Emit(const Expr& value, const Var& orig_var) {
+    if (builder_->CurrentBlockIsDataFlow() && !orig_var.as<DataflowVarNode>()) {
+      return builder_->EmitOutput(value, orig_var->name_hint());
+    }
+    return builder_->Emit(value, orig_var->name_hint());
+  }
+
+  /*! \brief The planned allocation of the function being rewritten. */
+  std::unordered_map<const VarNode*, PlannedAlloc> planned_allocs_;
+  /*! \brief The planned storage of each storage index. */
+  std::map<int64_t, PlannedStorage> planned_storages_;
+  /*! \brief The emitted storage var of each storage index. */
+  std::unordered_map<int64_t, Var> storage_vars_;
+  /*! \brief The planning algorithm. */
+  std::string algorithm_;
+  /*! \brief The size bound of the first pool of each device, or -1 if unbounded. */
+  int64_t pool_size_bytes_;
+  /*! \brief The VTCM capacity of each device in bytes, 0 to not use the VTCM. */
+  int64_t vtcm_capacity_;
+  /*! \brief Whether the rewriter is inside the function being planned. */
+  bool in_function_{false};
+};
+
+Expr StaticPlanBlockMemory(const Expr& e, const std::string& algorithm, int64_t pool_size_bytes,
+                           int64_t vtcm_capacity) {
+  return StorageAllocationRewriter(algorithm, pool_size_bytes, vtcm_capacity).VisitExpr(e);
+}
+
+namespace transform {
+
+Pass StaticPlanBlockMemory() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        String algorithm =
+            pc->GetConfig<String>(kStaticPlanAlgorithmOption, String("first_fit")).value();
+        int64_t pool_size_bytes =
+            pc->GetConfig<Integer>(kStaticPlanPoolSizeOption, Integer(-1)).value().IntValue();
+        int64_t vtcm_capacity =
+            pc->GetConfig<Integer>(kStaticPlanVTCMCapacityOption, Integer(0)).value().IntValue();
+        return Downcast<Function>(
+            StaticPlanBlockMemory(f, algorithm, pool_size_bytes, vtcm_capacity));
+      };
+  return CreateFunctionPass(pass_func, 0, "StaticPlanBlockMemory", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.StaticPlanBlockMemory").set_body_typed(StaticPlanBlockMemory);
+
+}  // namespace transform
+}  // namespace relax
+}  // namespace tvm
@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/backend/vm/vm_build.cc
+ * \brief Build an IRModule into a Relax VM executable in one call, generating the bytecode of the
+ *  Relax functions while the kernel library is lowered and compiled.
+ */
+
+#include <tvm/driver/driver_api.h>
+#include <tvm/ir/transform.h>
+#include <tvm/relax/backend.h>
+#include <tvm/relax/transform.h>
+#include <tvm/relay/runtime.h>
+#include <tvm/support/with.h>
+#include <tvm/tir/function.h>
+
+#include <exception>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "codegen_vm.h"
+
+namespace tvm {
+namespace relax {
+namespace relax_vm {
+
+/*! \brief Lower the Relax functions to the VM, generating the PrimFuncs they call. */
+static IRModule LowerToVM(IRModule mod) {
+  Array<tvm::transform::Pass> passes = {
+      transform::ToNonDataflow(),         transform::InplaceCallTIR(),
+      transform::CallTIRRewrite(),        transform::HoistWorkspace(),
+      transform::StaticPlanBlockMemory(), transform::VMMemoryLower(),
+      transform::VMShapeLower()};
+  return tvm::transform::Sequential(passes)(std::move(mod));
+}
+
+/*!
+ * \brief Split a module into its Relax functions and its PrimFuncs, the dispatch tables of the
+ *  kernels being handed to the codegen of the Relax functions.
+ */
+static std::pair<IRModule, IRModule> SplitTIRRelax(const IRModule& mod) {
+  Map<GlobalVar, BaseFunc> rx_funcs, tir_funcs;
+  Map<String, ObjectRef> dispatch_tables;
+  for (const auto& kv : mod->functions) {
+    if (const auto* prim_func = kv.second.as<tir::PrimFuncNode>()) {
+      tir_funcs.Set(kv.first, kv.second);
+      if (auto table = prim_func->GetAttr<ObjectRef>(attr::kKernelDispatchTable)) {
+        dispatch_tables.Set(kv.first->name_hint, table.value());
+      }
+    } else if (kv.second->IsInstance<FunctionNode>()) {
+      rx_funcs.Set(kv.first, kv.second);
+    } else {
+      LOG(FATAL) << "TypeError: IRModule is expected to contain PrimFunc or Function, but gets "
+                 << kv.second->GetTypeKey();
+    }
+  }
+  IRModule rx_mod(rx_funcs);
+  if (!dispatch_tables.empty()) {
+    rx_mod = WithAttr(std::move(rx_mod), attr::kKernelDispatchTable, dispatch_tables);
+  }
+  return {rx_mod, IRModule(tir_funcs)};
+}
+
+/*! \brief Build the kernel library like tvm.build, for the C++ runtime. */
+static Module BuildTIR(IRModule tir_mod, Target target) {
+  tir_mod = LowerModule(std::move(tir_mod));
+  tir_mod = WithAttr(std::move(tir_mod), "runtime", relay::Runtime::Create("cpp"));
+  return tvm::build(tir_mod, target, Target());
+}
+
+/*!
+ * \brief Build an IRModule into a Relax VM executable, like relax.vm.build.
+ *
+ *  In the bytecode mode, the bytecode of the Relax functions is generated on a thread of its own
+ *  while the kernels are lowered and compiled on the calling thread, in the pass context of the
+ *  caller. The codegen runs no pass, so its thread enters a copy of the context without the
+ *  instruments, whose pass context callbacks have already run. In the compiled mode, the Relax
+ *  functions are compiled along with the kernels, so the build runs on the calling thread only.
+ *
+ * \param mod The IRModule of the Relax functions and the PrimFuncs they call.
+ * \param target The target of the kernels, with the host of the compiled functions if any.
+ * \param params The parameters bound to the executable.
+ * \param exec_mode The execution mode of the Relax functions, "bytecode" or "compiled".
+ * \return The executable.
+ */
+Module Build(IRModule mod, Target target, Map<String, runtime::NDArray> params,
+             String exec_mode) {
+  Array<Module> ext_libs = mod->GetAttr<Array<Module>>("external_mods").value_or({});
+  std::pair<IRModule, IRModule> split = SplitTIRRelax(LowerToVM(mod));
+  IRModule rx_mod = split.first, tir_mod = split.second;
+
+  if (exec_mode == "compiled") {
+    ExecBuilder builder = ExecBuilderNode::Create();
+    tir_mod->Update(VMTIRCodeGen(builder, rx_mod));
+    return LinkExecutable(builder->Get(), BuildTIR(tir_mod, target), ext_libs, target, params);
+  }
+  CHECK(exec_mode == "bytecode") << "ValueError: Unknown exec_mode " << exec_mode
+                                 << ", expected bytecode or compiled";
+
+  auto ctx_node = make_object<tvm::transform::PassContextNode>(
+      *tvm::transform::PassContext::Current().operator->());
+  ctx_node->instruments = {};
+  tvm::transform::PassContext codegen_ctx(ctx_node);
+  VMCodeGen codegen;
+  std::exception_ptr codegen_error;
+  std::thread codegen_thread([&]() {
+    try {
+      With<tvm::transform::PassContext> scope(codegen_ctx);
+      codegen.CodeGen(rx_mod);
+    } catch (...) {
+      codegen_error = std::current_exception();
+    }
+  });
+  Module lib;
+  try {
+    lib = BuildTIR(tir_mod, target);
+  } catch (...) {
+    codegen_thread.join();
+    throw;
+  }
+  codegen_thread.join();
+  if (codegen_error) std::rethrow_exception(codegen_error);
+  return LinkExecutable(codegen.GetExec(), lib, ext_libs, target, params);
+}
+
+TVM_REGISTER_GLOBAL("relax.VMBuild").set_body_typed(Build);
+
+}  // namespace relax_vm
+}  // namespace relax
+}  // namespace tvm
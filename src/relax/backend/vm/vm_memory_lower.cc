@@ -26,7 +26,10 @@
 #include <tvm/relax/type.h>
 #include <tvm/tir/op.h>
 
+#include <string>
+
 #include "../../../relay/transforms/pattern_utils.h"
+#include "../../../runtime/texture.h"
 
 namespace tvm {
 namespace relax {
@@ -81,10 +84,25 @@ class VMMemLowerMutator : public ExprMutator {
       auto alloc_attrs = call->attrs.as<AllocTensorAttrs>();
       ICHECK(alloc_attrs != nullptr) << "must be AllocTensorAttrs";
       DataType dtype = alloc_attrs->dtype;
-      Expr storage_size = ComputeStorageSize(output_shape, dtype);
       auto storage_attr = make_object<VMAllocStorageAttrs>();
       storage_attr->dtype = dtype;
       storage_attr->runtime_device_index = alloc_attrs->runtime_device_index;
+      storage_attr->mem_scope = alloc_attrs->mem_scope;
+      // The storage of other memory scopes than the global one is allocated by its shape, the
+      // tensor shape for textures, and the flat number of elements for the other scopes.
+      std::string mem_scope = alloc_attrs->mem_scope;
+      Expr storage_size;
+      if (mem_scope.empty() || mem_scope == "global") {
+        storage_size = ComputeStorageSize(output_shape, dtype);
+      } else if (runtime::IsTextureStorage(mem_scope)) {
+        storage_size = output_shape;
+      } else {
+        PrimExpr num_elem = IntImm(DataType::Int(64), 1);
+        for (const PrimExpr& dim : output_shape->values) {
+          num_elem = num_elem * dim;
+        }
+        storage_size = ShapeExpr({num_elem});
+      }
 
       Var storage =
           builder_->Emit(Call(vm_alloc_storage_op, {storage_size}, Attrs(storage_attr)), "storage");
@@ -29,6 +29,11 @@
 #include <tvm/tir/op.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
 namespace tvm {
 namespace relax {
 
@@ -44,6 +49,7 @@ class VMShapeLowerMutator : public ExprMutator {
       if (func->IsInstance<FunctionNode>()) {
         // prepare mapping and heap var
         expr2slot_ = PrepareExpr2Slot(Downcast<Function>(func));
+        computed_.clear();
         heap_size_ = IntImm(ShapeDType(), expr2slot_.size());
         DynTensorType heap_type(1, ShapeDType());
         shape_heap_ = Var("shape_heap", ShapeExpr({heap_size_}), heap_type);
@@ -68,10 +74,19 @@ class VMShapeLowerMutator : public ExprMutator {
     if (IsConstantShape(GetRef<ShapeExpr>(node))) {
       return ExprMutator::VisitExpr_(node);
     }
-    tir::PrimFunc func = CalculateShape(GetRef<ShapeExpr>(node));
-
-    GlobalVar shape_func_var = builder_->AddFunction(func, "shape_func");
-    builder_->Emit(Call(shape_func_var, {shape_heap_}), "_");
+    // Symbolic variables are stored to the heap when they are matched, and the values computed
+    // at function entry stay valid for the whole function, so only the rest is computed here.
+    Array<PrimExpr> values;
+    for (PrimExpr e : node->values) {
+      if (!e->IsInstance<tir::VarNode>() && !computed_.count(e)) {
+        values.push_back(e);
+      }
+    }
+    if (!values.empty()) {
+      tir::PrimFunc func = CalculateShape(values);
+      GlobalVar shape_func_var = builder_->AddFunction(func, "shape_func");
+      builder_->Emit(Call(shape_func_var, {shape_heap_}), "_");
+    }
 
     // construct shape
     Array<Integer> indices;
@@ -91,16 +106,25 @@ class VMShapeLowerMutator : public ExprMutator {
       builder_->Emit(VarBinding(
           shape_heap_, Call(ExternFunc("vm.builtin.alloc_shape_heap"), {ShapeExpr({heap_size_})})));
 
+      std::unordered_set<tir::Var, ObjectPtrHash, ObjectPtrEqual> param_vars;
       for (Var param : node->params) {
         if (param->shape_.operator bool() && param->shape_.value().as<ShapeExprNode>()) {
           if (auto* param_type = param->checked_type_.as<DynTensorTypeNode>()) {
             if (param_type->ndim != 0) {
+              Array<PrimExpr> pattern = Downcast<ShapeExpr>(param->shape_.value())->values;
               Var shape = builder_->Emit(Call(ExternFunc("vm.builtin.shape_of"), {param}), "sh");
-              StoreShape(shape, Downcast<ShapeExpr>(param->shape_.value())->values);
+              StoreShape(shape, pattern);
+              for (PrimExpr e : pattern) {
+                computed_.insert(e);
+                if (const auto* var = e.as<tir::VarNode>()) {
+                  param_vars.insert(GetRef<tir::Var>(var));
+                }
+              }
             }
           }
         }
       }
+      EmitEntryShapeFunc(param_vars);
     }
     Expr new_body = this->VisitExpr(node->body);
 
@@ -130,8 +154,39 @@ class VMShapeLowerMutator : public ExprMutator {
     return Function(node->params, new_body, ret_type, node->attrs);
   }
 
-  tir::PrimFunc CalculateShape(ShapeExpr s) {
-    // TODO(ziheng): avoid generating shape func for known value
+  /*!
+   * \brief Compute every slot whose symbolic variables are all bound by the parameters in a
+   *  single shape function called at function entry.
+   * \param param_vars The symbolic variables bound by the parameter shapes.
+   */
+  void EmitEntryShapeFunc(
+      const std::unordered_set<tir::Var, ObjectPtrHash, ObjectPtrEqual>& param_vars) {
+    std::vector<std::pair<int64_t, PrimExpr>> slots;
+    for (const auto& kv : expr2slot_) {
+      if (kv.first->IsInstance<tir::VarNode>() || computed_.count(kv.first)) continue;
+      bool computable = true;
+      tir::PostOrderVisit(kv.first, [&](const ObjectRef& e) {
+        if (const auto* var = e.as<tir::VarNode>()) {
+          computable = computable && param_vars.count(GetRef<tir::Var>(var));
+        }
+      });
+      if (computable) {
+        slots.emplace_back(kv.second->value, kv.first);
+      }
+    }
+    if (slots.empty()) return;
+    std::sort(slots.begin(), slots.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+    Array<PrimExpr> values;
+    for (const auto& slot : slots) {
+      values.push_back(slot.second);
+      computed_.insert(slot.second);
+    }
+    GlobalVar shape_func_var = builder_->AddFunction(CalculateShape(values), "shape_func");
+    builder_->Emit(Call(shape_func_var, {shape_heap_}), "_");
+  }
+
+  tir::PrimFunc CalculateShape(Array<PrimExpr> values) {
     tir::Var heap("heap", DataType::Handle());
     Array<PrimExpr> buffer_shape{heap_size_};
     tir::Buffer buffer = tir::decl_buffer(buffer_shape, ShapeDType(), "H");
@@ -139,7 +194,7 @@ class VMShapeLowerMutator : public ExprMutator {
     buffer_map.Set(heap, buffer);
 
     Array<tir::Stmt> seq;
-    for (PrimExpr e : s->values) {
+    for (PrimExpr e : values) {
       Map<tir::Var, PrimExpr> var_mapping = BuildVarMapping(e, buffer);
       PrimExpr value = tir::Substitute(e, var_mapping);
       // cast value to shape heap dtype
@@ -221,6 +276,8 @@ class VMShapeLowerMutator : public ExprMutator {
   IntImm heap_size_;
   Var shape_heap_;
   Map<PrimExpr, Integer> expr2slot_;
+  /*! \brief The slot expressions that are stored or computed at function entry. */
+  std::unordered_set<PrimExpr, ObjectPtrHash, ObjectPtrEqual> computed_;
 };
 
 namespace transform {
@@ -175,11 +175,7 @@ class BlockBuilderNode::ExprNormalizer : public ExprFunctor<Expr(const Expr&)> {
       unchanged = false;
     }
 
-    SeqExpr seq_expr;
-    if (unchanged) {
-      seq_expr = GetRef<SeqExpr>(op);
-    }
-    seq_expr = SeqExpr(new_blocks, new_body);
+    SeqExpr seq_expr = unchanged ? GetRef<SeqExpr>(op) : SeqExpr(new_blocks, new_body);
 
     // only do shape/type inference if the SeqExpr does not have shape/type
     if (seq_expr->shape_ && seq_expr->checked_type_.defined()) {
@@ -234,11 +230,8 @@ class BlockBuilderNode::ExprNormalizer : public ExprFunctor<Expr(const Expr&)> {
 
   Expr VisitExpr_(const TupleGetItemNode* op) final {
     Expr new_tuple = this->VisitExpr(op->tuple);
-    TupleGetItem node;
-    if (new_tuple.same_as(op->tuple)) {
-      node = GetRef<TupleGetItem>(op);
-    }
-    node = TupleGetItem(new_tuple, op->index);
+    TupleGetItem node = new_tuple.same_as(op->tuple) ? GetRef<TupleGetItem>(op)
+                                                     : TupleGetItem(new_tuple, op->index);
 
     // only do shape/type inference if the TupleGetItem does not have shape/type
     if (node->shape_ && node->checked_type_.defined()) {
@@ -288,6 +281,25 @@ class BlockBuilderNode::ExprNormalizer : public ExprFunctor<Expr(const Expr&)> {
     return MatchShape(new_value, binding->pattern, binding->var);
   }
 
+  /*!
+   * \brief Check whether \p expr is already in normal form, i.e. it would be returned as it is by
+   * VisitExpr: a call, tuple or tuple item whose shape and type are deduced, and whose operands are
+   * normalized leaves. Such expressions, e.g. those emitted by an upstream builder, skip the
+   * traversal and the shape and type deduction.
+   */
+  bool IsNormalized(const Expr& expr) {
+    if (expr_memo_.Get(expr)) return false;
+    if (const auto* call = expr.as<CallNode>()) {
+      return call->shape_ && call->checked_type_.defined() && IsNormalizedLeaf(call->op) &&
+             std::all_of(call->args.begin(), call->args.end(),
+                         [this](const Expr& arg) { return IsNormalizedLeaf(arg); });
+    } else if (const auto* tuple_get_item = expr.as<TupleGetItemNode>()) {
+      return tuple_get_item->shape_ && tuple_get_item->checked_type_.defined() &&
+             IsNormalizedLeaf(tuple_get_item->tuple);
+    }
+    return IsNormalizedLeaf(expr);
+  }
+
   BindingBlock VisitBindingBlock(const BindingBlock& block) {
     if (block.as<DataflowBlockNode>()) {
       builder_->BeginDataflowBlock();
@@ -499,6 +511,22 @@ class BlockBuilderNode::ExprNormalizer : public ExprFunctor<Expr(const Expr&)> {
            expr.as<ExternFuncNode>() || expr.as<OpNode>() || expr.as<TupleNode>();
   }
 
+  /*! \brief Check whether \p expr is a leaf which needs neither binding nor deduction. */
+  bool IsNormalizedLeaf(const Expr& expr) {
+    if (expr.as<VarNode>() || expr.as<GlobalVarNode>() || expr.as<ShapeExprNode>() ||
+        expr.as<RuntimeDepShapeNode>() || expr.as<ExternFuncNode>() || expr.as<OpNode>()) {
+      return true;
+    }
+    if (!expr->shape_ || !expr->checked_type_.defined()) return false;
+    if (expr.as<ConstantNode>()) return true;
+    if (const auto* tuple = expr.as<TupleNode>()) {
+      return !expr_memo_.Get(expr) &&
+             std::all_of(tuple->fields.begin(), tuple->fields.end(),
+                         [this](const Expr& field) { return IsNormalizedLeaf(field); });
+    }
+    return false;
+  }
+
   Expr VisitWithNewScope(const Expr& expr) {
     builder_->BeginBindingBlock();
     Expr post = this->VisitExpr(expr);
@@ -691,7 +719,7 @@ bool BlockBuilderNode::CanProveShapeEqual(const Expr& lhs, const Expr& rhs) {
 
 // TODO(@altanh, @yuchen): need an internal Emit_ that doesn't call normalize
 Expr BlockBuilderNode::Normalize(const Expr& expr) {
-  // TODO(@altanh): fast path
+  if (normalizer_->IsNormalized(expr)) return expr;
   Expr normalized = normalizer_->VisitExpr(expr);
   return normalized;
 }
@@ -724,6 +752,8 @@ GlobalVar BlockBuilderNode::AddFunction(const BaseFunc& func, const String& func
 }
 
 void BlockBuilderNode::UpdateFunction(const GlobalVar& gv, BaseFunc updated_function) {
+  auto it = context_mod_->functions.find(gv);
+  if (it != context_mod_->functions.end() && (*it).second.same_as(updated_function)) return;
   context_mod_.CopyOnWrite();
   context_mod_->Update(gv, updated_function);
   func_map_[updated_function] = gv;
@@ -29,9 +29,13 @@
 #include <tvm/relax/expr_functor.h>
 #include <tvm/tir/op.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstddef>
+#include <iomanip>
 #include <limits>
+#include <sstream>
 #include <stack>
 #include <type_traits>
 #include <unordered_map>
@@ -507,6 +511,95 @@ bool MatchExpr(DFPattern pattern, Expr expr, Optional<runtime::Map<Var, Expr>> v
 
 TVM_REGISTER_GLOBAL("relax.dpl.match_expr").set_body_typed(MatchExpr);
 
+bool GetPatternRootOps(const DFPattern& pattern, std::unordered_set<String>* ops) {
+  if (const auto* call = pattern.as<CallPatternNode>()) {
+    const auto* expr_pattern = call->op.as<ExprPatternNode>();
+    const auto* op = expr_pattern ? expr_pattern->expr.as<OpNode>() : nullptr;
+    if (op == nullptr) return false;
+    ops->insert(op->name);
+    // Divide and multiply patterns also match their associated forms, see the CallPattern visitor.
+    if (op->name == "relax.divide") ops->insert("relax.multiply");
+    if (op->name == "relax.multiply") ops->insert("relax.divide");
+    return true;
+  } else if (const auto* or_pattern = pattern.as<OrPatternNode>()) {
+    return GetPatternRootOps(or_pattern->left, ops) && GetPatternRootOps(or_pattern->right, ops);
+  } else if (const auto* and_pattern = pattern.as<AndPatternNode>()) {
+    // Either side restricts the match, the first restricting one is kept.
+    std::unordered_set<String> left;
+    if (GetPatternRootOps(and_pattern->left, &left)) {
+      ops->insert(left.begin(), left.end());
+      return true;
+    }
+    return GetPatternRootOps(and_pattern->right, ops);
+  } else if (const auto* attr_pattern = pattern.as<AttrPatternNode>()) {
+    return GetPatternRootOps(attr_pattern->pattern, ops);
+  } else if (const auto* type_pattern = pattern.as<TypePatternNode>()) {
+    return GetPatternRootOps(type_pattern->pattern, ops);
+  } else if (const auto* shape_pattern = pattern.as<ShapePatternNode>()) {
+    return GetPatternRootOps(shape_pattern->pattern, ops);
+  } else if (const auto* dtype_pattern = pattern.as<DataTypePatternNode>()) {
+    return GetPatternRootOps(dtype_pattern->pattern, ops);
+  }
+  return false;
+}
+
+PatternTableMatcher::PatternTableMatcher(Array<DFPattern> patterns)
+    : patterns_(std::move(patterns)), statistics_(patterns_.size()) {
+  std::vector<std::unordered_set<String>> root_ops(patterns_.size());
+  std::vector<bool> restricted(patterns_.size());
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    restricted[i] = GetPatternRootOps(patterns_[i], &root_ops[i]);
+    if (!restricted[i]) unrestricted_.push_back(i);
+    for (const String& op : root_ops[i]) op_candidates_[op];
+  }
+  // The candidates of an op are the patterns of the op and the unrestricted ones, in order.
+  for (auto& kv : op_candidates_) {
+    for (size_t i = 0; i < patterns_.size(); ++i) {
+      if (!restricted[i] || root_ops[i].count(kv.first)) kv.second.push_back(i);
+    }
+  }
+}
+
+const std::vector<int>& PatternTableMatcher::GetCandidates(const Expr& expr) const {
+  if (const auto* call = expr.as<CallNode>()) {
+    if (const auto* op = call->op.as<OpNode>()) {
+      auto it = op_candidates_.find(op->name);
+      if (it != op_candidates_.end()) return it->second;
+    }
+  }
+  return unrestricted_;
+}
+
+bool PatternTableMatcher::Match(int index, const Expr& expr, DFPatternMatcher* matcher) {
+  auto start = std::chrono::steady_clock::now();
+  bool matched = matcher->Match(patterns_[index], expr);
+  auto end = std::chrono::steady_clock::now();
+  Statistics& statistics = statistics_[index];
+  statistics.attempts += 1;
+  statistics.matches += matched;
+  statistics.time_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+  return matched;
+}
+
+std::string PatternTableMatcher::GetStatistics(const Array<String>& names) const {
+  ICHECK_EQ(names.size(), patterns_.size());
+  std::vector<int> order(patterns_.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [this](int lhs, int rhs) {
+    return statistics_[lhs].time_ns > statistics_[rhs].time_ns;
+  });
+  std::ostringstream os;
+  os << std::left << std::setw(40) << "pattern" << std::right << std::setw(12) << "attempts"
+     << std::setw(12) << "matches" << std::setw(12) << "time(us)" << std::endl;
+  for (int i : order) {
+    const Statistics& statistics = statistics_[i];
+    os << std::left << std::setw(40) << names[i] << std::right << std::setw(12)
+       << statistics.attempts << std::setw(12) << statistics.matches << std::setw(12)
+       << statistics.time_ns / 1000 << std::endl;
+  }
+  return os.str();
+}
+
 struct PNode {
   const DFPatternNode* ptr;
   const VarNode* matched = nullptr;
@@ -732,10 +825,21 @@ tvm::runtime::Map<DFPattern, Var> MatchGraph(const PatternContext& ctx, const Da
   }
 
   PNode* pnode_start = &pattern2node.begin()->second;
+  // Only try the start pattern against the bindings calling the ops its matches may call.
+  std::unordered_set<String> start_ops;
+  bool restricted = GetPatternRootOps(GetRef<DFPattern>(pnode_start->ptr), &start_ops);
+  auto may_match_start = [&](const VarNode* var) {
+    if (!restricted) return true;
+    auto value = var2val.Get(GetRef<Var>(var));
+    const auto* call = value.defined() ? value.value().as<CallNode>() : nullptr;
+    const auto* op = call ? call->op.as<OpNode>() : nullptr;
+    return op != nullptr && start_ops.count(op->name);
+  };
 
   if (!pnode_start->matched) {
     for (auto& rpair : var2node) {
       if (start_hint.defined() && start_hint.value().get() == rpair.first) continue;
+      if (!may_match_start(rpair.first)) continue;
       if (try_match(pnode_start, &rpair.second, &matcher, def2use, caller2callees)) {
         for (auto ppair : pattern2node)
           ret.Set(GetRef<DFPattern>(ppair.first), GetRef<Var>(ppair.second.matched));
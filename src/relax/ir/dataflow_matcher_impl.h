@@ -29,7 +29,9 @@
 #include <tvm/relax/dataflow_pattern.h>
 #include <tvm/relax/dataflow_pattern_functor.h>
 
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -82,6 +84,57 @@ class DFPatternMatcher : public DFPatternFunctor<bool(const DFPattern&, const Ex
   bool memoize_ = true;
 };
 
+/*!
+ * \brief Get the ops which the root of an expression matched by \p pattern may call.
+ * \param pattern The pattern.
+ * \param ops The names of the ops, set if the pattern only matches calls to some ops.
+ * \return Whether the pattern only matches calls to the ops.
+ */
+bool GetPatternRootOps(const DFPattern& pattern, std::unordered_set<String>* ops);
+
+/*!
+ * \brief Match a table of patterns against expressions. The patterns are indexed by the ops which
+ * the roots of their matches may call, so that an expression is only tried against the patterns
+ * which can match the op it calls, rather than against every pattern of the table. The attempts,
+ * matches and time spent by each pattern are recorded.
+ */
+class PatternTableMatcher {
+ public:
+  explicit PatternTableMatcher(Array<DFPattern> patterns);
+
+  /*!
+   * \brief Get the patterns which may match \p expr.
+   * \return The indices of the patterns, in order of priority.
+   */
+  const std::vector<int>& GetCandidates(const Expr& expr) const;
+
+  /*! \brief Match the pattern of index \p index against \p expr with \p matcher. */
+  bool Match(int index, const Expr& expr, DFPatternMatcher* matcher);
+
+  /*! \brief Print the statistics of the patterns named \p names, from the most expensive. */
+  std::string GetStatistics(const Array<String>& names) const;
+
+ private:
+  /*! \brief The statistics of a pattern. */
+  struct Statistics {
+    /*! \brief The number of expressions the pattern was tried against. */
+    int64_t attempts = 0;
+    /*! \brief The number of expressions the pattern matched. */
+    int64_t matches = 0;
+    /*! \brief The time spent matching, in nanoseconds. */
+    int64_t time_ns = 0;
+  };
+
+  /*! \brief The patterns, in order of priority. */
+  Array<DFPattern> patterns_;
+  /*! \brief The candidate patterns of the calls to each op occurring in a pattern root. */
+  std::unordered_map<String, std::vector<int>> op_candidates_;
+  /*! \brief The patterns which are not restricted to calls to some ops. */
+  std::vector<int> unrestricted_;
+  /*! \brief The statistics of each pattern. */
+  std::vector<Statistics> statistics_;
+};
+
 }  // namespace relax
 }  // namespace tvm
 
@@ -22,7 +22,15 @@
  */
 #include "./emit_te.h"
 
+#include <tvm/relax/expr_functor.h>
 #include <tvm/relax/type.h>
+#include <tvm/support/parallel_for.h>
+
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+#include "../../te/operation/create_primfunc.h"
 
 namespace tvm {
 namespace relax {
@@ -75,5 +83,43 @@ te::Tensor TETensor(Expr value, std::string name) {
 
 TVM_REGISTER_GLOBAL("relax.TETensor").set_body_typed(TETensor);
 
+/*! \brief Replace the global vars of the deferred computes by the ones of their PrimFuncs. */
+class DeferredGlobalVarBinder : public ExprMutator {
+ public:
+  explicit DeferredGlobalVarBinder(
+      std::unordered_map<GlobalVar, GlobalVar, ObjectPtrHash, ObjectPtrEqual> gvar_map)
+      : gvar_map_(std::move(gvar_map)) {}
+
+  Expr VisitExpr_(const GlobalVarNode* op) final {
+    auto it = gvar_map_.find(GetRef<GlobalVar>(op));
+    return it == gvar_map_.end() ? GetRef<Expr>(op) : it->second;
+  }
+
+ private:
+  std::unordered_map<GlobalVar, GlobalVar, ObjectPtrHash, ObjectPtrEqual> gvar_map_;
+};
+
+Function LowerDeferredTE(BlockBuilder builder, Function func, Array<GlobalVar> gvars,
+                         Array<Array<te::Tensor>> args, Array<Array<tir::Var>> tir_vars) {
+  ICHECK_EQ(gvars.size(), args.size());
+  ICHECK_EQ(gvars.size(), tir_vars.size());
+  int n = gvars.size();
+  if (n == 0) return func;
+  // The lowering of a compute only reads the te tensors, shared by the computes.
+  std::vector<tir::PrimFunc> prim_funcs(n);
+  int num_threads = std::min<int>(n, std::max(1u, std::thread::hardware_concurrency()));
+  support::parallel_for_dynamic(0, n, num_threads, [&](int thread_id, int task_id) {
+    prim_funcs[task_id] = tir::CreatePrimFunc(args[task_id], tir_vars[task_id]);
+  });
+  // The PrimFuncs are added in the order of the calls, so they are named as emit_te names them.
+  std::unordered_map<GlobalVar, GlobalVar, ObjectPtrHash, ObjectPtrEqual> gvar_map;
+  for (int i = 0; i < n; ++i) {
+    gvar_map.emplace(gvars[i], builder->AddFunction(prim_funcs[i], gvars[i]->name_hint));
+  }
+  return Downcast<Function>(DeferredGlobalVarBinder(std::move(gvar_map)).VisitExpr(func));
+}
+
+TVM_REGISTER_GLOBAL("relax.LowerDeferredTE").set_body_typed(LowerDeferredTE);
+
 }  // namespace relax
 }  // namespace tvm
@@ -24,6 +24,7 @@
 #ifndef TVM_RELAX_IR_EMIT_TE_H_
 #define TVM_RELAX_IR_EMIT_TE_H_
 
+#include <tvm/relax/block_builder.h>
 #include <tvm/relax/expr.h>
 #include <tvm/te/operation.h>
 
@@ -60,6 +61,21 @@ class RXPlaceholderOpNode : public te::PlaceholderOpNode {
  */
 te::Tensor TETensor(Expr value, std::string name = "rxplaceholder");
 
+/*!
+ * \brief Lower the TE computes deferred by emit_te in parallel, add the PrimFuncs to the module
+ *  being built, and bind the calls of the function to them.
+ * \param builder The block builder, whose module the PrimFuncs are added to. The identical
+ *  PrimFuncs are added once, as AddFunction does.
+ * \param func The function calling the deferred computes.
+ * \param gvars The global vars the function calls each deferred compute with, named by the
+ *  name hint of its PrimFunc.
+ * \param args The te tensors of the arguments of each compute, as te.create_prim_func takes.
+ * \param tir_vars The unbound tir vars of each compute, the extra parameters of its PrimFunc.
+ * \return The function calling the global vars the PrimFuncs are added with.
+ */
+Function LowerDeferredTE(BlockBuilder builder, Function func, Array<GlobalVar> gvars,
+                         Array<Array<te::Tensor>> args, Array<Array<tir::Var>> tir_vars);
+
 }  // namespace relax
 }  // namespace tvm
 #endif  // TVM_RELAX_IR_EMIT_TE_H_
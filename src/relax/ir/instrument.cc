@@ -0,0 +1,236 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relax/ir/instrument.cc
+ * \brief A pass instrument profiling the compile time, the memory and the IR size of the passes.
+ */
+#include <tvm/ir/instrument.h>
+#include <tvm/ir/transform.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/function.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../../support/table_printer.h"
+
+namespace tvm {
+namespace relax {
+
+/*! \brief The size of an IRModule. */
+struct IRSize {
+  /*! \brief The number of relax functions. */
+  int64_t num_functions = 0;
+  /*! \brief The number of TIR functions. */
+  int64_t num_prim_funcs = 0;
+  /*! \brief The number of bindings of the relax functions, including the nested ones. */
+  int64_t num_bindings = 0;
+};
+
+/*! \brief Count the bindings of an expression. */
+class BindingCounter : public ExprVisitor {
+ public:
+  int64_t num_bindings = 0;
+
+  void VisitBinding(const Binding& binding) final {
+    ++num_bindings;
+    ExprVisitor::VisitBinding(binding);
+  }
+};
+
+static IRSize GetIRSize(const IRModule& mod) {
+  IRSize size;
+  BindingCounter counter;
+  for (const auto& kv : mod->functions) {
+    if (const auto* func = kv.second.as<FunctionNode>()) {
+      ++size.num_functions;
+      counter.VisitExpr(GetRef<Function>(func));
+    } else if (kv.second->IsInstance<tir::PrimFuncNode>()) {
+      ++size.num_prim_funcs;
+    }
+  }
+  size.num_bindings = counter.num_bindings;
+  return size;
+}
+
+/*! \brief Get the peak resident set size of the process in KB, or 0 if unknown. */
+static int64_t GetPeakRSSKB() {
+#if defined(__linux__) || defined(__APPLE__)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+  // ru_maxrss is in bytes on macOS, and in KB on Linux.
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#else
+  return 0;
+#endif
+}
+
+/*!
+ * \brief A pass instrument recording, for each pass run in its PassContext, the wall time, the
+ * peak RSS and the IR size before and after the pass. The nested passes, e.g. those of a
+ * Sequential, are recorded with their depth.
+ */
+class PassProfilingInstrumentNode : public instrument::PassInstrumentNode {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /*! \brief The profile of a pass run. */
+  struct Record {
+    /*! \brief The name of the pass. */
+    std::string name;
+    /*! \brief The depth of the pass in the nested passes. */
+    int depth;
+    /*! \brief The time when the pass started. */
+    Clock::time_point start;
+    /*! \brief The wall time of the pass in ms, including its nested passes. */
+    double time_ms = 0;
+    /*! \brief The peak RSS of the process before and after the pass, in KB. */
+    int64_t peak_rss_before_kb;
+    int64_t peak_rss_after_kb = 0;
+    /*! \brief The size of the input and the output module. */
+    IRSize size_before;
+    IRSize size_after;
+  };
+
+  void VisitAttrs(AttrVisitor* v) { v->Visit("name", &name); }
+
+  void EnterPassContext() const final {
+    records_.clear();
+    running_.clear();
+  }
+
+  void ExitPassContext() const final {}
+
+  bool ShouldRun(const IRModule& mod, const transform::PassInfo& info) const final { return true; }
+
+  void RunBeforePass(const IRModule& mod, const transform::PassInfo& info) const final {
+    Record record;
+    record.name = info->name;
+    record.depth = static_cast<int>(running_.size());
+    record.peak_rss_before_kb = GetPeakRSSKB();
+    record.size_before = GetIRSize(mod);
+    running_.push_back(records_.size());
+    records_.push_back(record);
+    // Start the clock last, so that measuring the input is not counted.
+    records_.back().start = Clock::now();
+  }
+
+  void RunAfterPass(const IRModule& mod, const transform::PassInfo& info) const final {
+    auto end = Clock::now();
+    ICHECK(!running_.empty()) << "Mismatched RunBeforePass and RunAfterPass of " << info->name;
+    Record& record = records_[running_.back()];
+    running_.pop_back();
+    record.time_ms = std::chrono::duration<double, std::milli>(end - record.start).count();
+    record.peak_rss_after_kb = GetPeakRSSKB();
+    record.size_after = GetIRSize(mod);
+  }
+
+  /*! \brief Render the records as a table. */
+  std::string AsTable() const {
+    support::TablePrinter p;
+    p.Row() << "Pass"
+            << "Time (ms)"
+            << "Peak RSS (MB)"
+            << "RSS Growth (MB)"
+            << "Functions"
+            << "PrimFuncs"
+            << "Bindings";
+    p.Separator();
+    for (const Record& record : records_) {
+      p.Row() << std::string(2 * record.depth, ' ') + record.name << record.time_ms
+              << record.peak_rss_after_kb / 1024.0
+              << (record.peak_rss_after_kb - record.peak_rss_before_kb) / 1024.0
+              << Change(record.size_before.num_functions, record.size_after.num_functions)
+              << Change(record.size_before.num_prim_funcs, record.size_after.num_prim_funcs)
+              << Change(record.size_before.num_bindings, record.size_after.num_bindings);
+    }
+    return p.AsStr();
+  }
+
+  /*! \brief Render the records as a JSON list, one object per pass run. */
+  std::string AsJSON() const {
+    std::ostringstream os;
+    os << "[";
+    for (size_t i = 0; i < records_.size(); ++i) {
+      const Record& r = records_[i];
+      os << (i ? "," : "") << "\n  {\"pass\": \"" << r.name << "\", \"depth\": " << r.depth
+         << ", \"time_ms\": " << r.time_ms << ", \"peak_rss_before_kb\": " << r.peak_rss_before_kb
+         << ", \"peak_rss_after_kb\": " << r.peak_rss_after_kb
+         << ", \"functions_before\": " << r.size_before.num_functions
+         << ", \"functions_after\": " << r.size_after.num_functions
+         << ", \"prim_funcs_before\": " << r.size_before.num_prim_funcs
+         << ", \"prim_funcs_after\": " << r.size_after.num_prim_funcs
+         << ", \"bindings_before\": " << r.size_before.num_bindings
+         << ", \"bindings_after\": " << r.size_after.num_bindings << "}";
+    }
+    os << "\n]";
+    return os.str();
+  }
+
+  static constexpr const char* _type_key = "relax.instrument.PassProfilingInstrument";
+  TVM_DECLARE_FINAL_OBJECT_INFO(PassProfilingInstrumentNode, PassInstrumentNode);
+
+ private:
+  static std::string Change(int64_t before, int64_t after) {
+    if (before == after) return std::to_string(after);
+    return std::to_string(before) + " -> " + std::to_string(after);
+  }
+
+  /*! \brief The records of the passes, in the order they started. */
+  mutable std::vector<Record> records_;
+  /*! \brief The indices of the records of the passes running. */
+  mutable std::vector<size_t> running_;
+};
+
+TVM_REGISTER_NODE_TYPE(PassProfilingInstrumentNode);
+
+TVM_REGISTER_GLOBAL("relax.instrument.PassProfilingInstrument").set_body_typed([]() {
+  auto n = make_object<PassProfilingInstrumentNode>();
+  n->name = "PassProfilingInstrument";
+  return instrument::PassInstrument(n);
+});
+
+TVM_REGISTER_GLOBAL("relax.instrument.PassProfilingInstrumentAsTable")
+    .set_body_typed([](instrument::PassInstrument instrument) {
+      const auto* n = instrument.as<PassProfilingInstrumentNode>();
+      ICHECK(n != nullptr) << "Expected a PassProfilingInstrument";
+      return n->AsTable();
+    });
+
+TVM_REGISTER_GLOBAL("relax.instrument.PassProfilingInstrumentAsJSON")
+    .set_body_typed([](instrument::PassInstrument instrument) {
+      const auto* n = instrument.as<PassProfilingInstrumentNode>();
+      ICHECK(n != nullptr) << "Expected a PassProfilingInstrument";
+      return n->AsJSON();
+    });
+
+}  // namespace relax
+}  // namespace tvm
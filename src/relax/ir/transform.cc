@@ -28,11 +28,18 @@
 #include <tvm/relax/transform.h>
 #include <tvm/relay/function.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
+
 namespace tvm {
 namespace relax {
 namespace transform {
 
 TVM_REGISTER_PASS_CONFIG_OPTION("relax.fallback_device_type", IntImm);
+/*!
+ * \brief Whether the function passes run over the functions of a module in parallel, regardless
+ * of the opt level.
+ */
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.FunctionPass.parallel", Bool);
 
 // TODO(@yuchen): will need to dedup with FunctionPass in Relay when we upstream
 class FunctionPass;
@@ -143,15 +150,30 @@ IRModule FunctionPassNode::operator()(IRModule mod, const PassContext& pass_ctx)
   for (const auto& it : updated_mod->functions) {
     // only picks up relax::Function
     if (auto* n = it.second.as<FunctionNode>()) {
-      Function func = GetRef<Function>(n);
-      auto updated_func = SkipFunction(func) ? func : pass_func(func, updated_mod, pass_ctx);
-      updates.push_back({it.first, updated_func});
+      updates.push_back({it.first, GetRef<Function>(n)});
     }
   }
+  // The functions are transformed independently of each other, as the pass cannot update the
+  // module, so they may run in parallel. The results are merged in the order of the functions
+  // in the module either way, keeping the output deterministic.
+  auto run = [&](int i) {
+    Function func = updates[i].second;
+    if (!SkipFunction(func)) updates[i].second = pass_func(func, updated_mod, pass_ctx);
+  };
+  bool parallel = pass_ctx->GetConfig<Bool>("relax.FunctionPass.parallel", Bool(false)).value();
+  if (parallel && updates.size() > 1) {
+    support::parallel_for(0, static_cast<int>(updates.size()), run);
+  } else {
+    for (int i = 0; i < static_cast<int>(updates.size()); ++i) run(i);
+  }
 
+  // only the changed functions are written back, the unchanged ones keep the function map of the
+  // input module shared.
+  Map<GlobalVar, BaseFunc> updated_funcs;
   for (const auto& pair : updates) {
-    updated_mod->Add(pair.first, pair.second, true);
+    updated_funcs.Set(pair.first, pair.second);
   }
+  updated_mod->UpdateFunctions(updated_funcs);
 
   ICHECK(pass_ctx->diag_ctx)
       << "The diagnostic context was set at the top of this block, this is a bug.";
@@ -364,9 +386,11 @@ IRModule DataflowBlockPassNode::operator()(IRModule mod, const PassContext& pass
     }
   }
 
+  Map<GlobalVar, BaseFunc> updated_funcs;
   for (const auto& pair : updates) {
-    updated_mod->Add(pair.first, pair.second, true);
+    updated_funcs.Set(pair.first, pair.second);
   }
+  updated_mod->UpdateFunctions(updated_funcs);
 
   ICHECK(pass_ctx->diag_ctx)
       << "The diagnostic context was set at the top of this block this is a bug.";
@@ -0,0 +1,163 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file nn.cc
+ * \brief neural network operators.
+ */
+
+#include "nn.h"
+
+namespace tvm {
+namespace relax {
+
+RELAX_REGISTER_UNARY_ELEMWISE_OP("nn.relu")
+    .describe("Elementwise rectified linear unit, max(x, 0)")
+    .set_support_level(1);
+
+RELAX_REGISTER_UNARY_ELEMWISE_OP("nn.gelu")
+    .describe("Elementwise Gaussian error linear unit, x * Phi(x)")
+    .set_support_level(1);
+
+RELAY_REGISTER_OP("relax.nn.softmax")
+    .describe("Softmax of the data along an axis")
+    .set_num_inputs(1)
+    .add_argument("data", "Tensor", "The input tensor.")
+    .set_attrs_type<relay::SoftmaxAttrs>()
+    .set_attr<FInferShape>("FInferShape", InferShapeUnaryElemwise)
+    .set_attr<FInferType>("FInferType", InferTypeUnaryElemwise)
+    .set_support_level(1);
+
+Expr MakeSoftmax(Expr data, int axis) {
+  auto attrs = make_object<relay::SoftmaxAttrs>();
+  attrs->axis = axis;
+  static const Op& op = Op::Get("relax.nn.softmax");
+  return Call(op, {data}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.nn.softmax").set_body_typed(MakeSoftmax);
+
+RELAY_REGISTER_OP("relax.nn.conv2d")
+    .describe("2-D convolution of NCHW data with an OIHW weight")
+    .set_num_inputs(2)
+    .add_argument("data", "Tensor", "The input tensor of shape (N, C, H, W).")
+    .add_argument("weight", "Tensor", "The weight of shape (O, C / groups, KH, KW).")
+    .set_attrs_type<relay::Conv2DAttrs>()
+    .set_attr<FInferShape>("FInferShape", InferShapeConv2D)
+    .set_attr<FInferType>("FInferType", InferTypeConv2D)
+    .set_support_level(2);
+
+Expr MakeConv2D(Expr data, Expr weight, Array<PrimExpr> strides, Array<PrimExpr> padding,
+                Array<PrimExpr> dilation, int groups, DataType out_dtype) {
+  CHECK_EQ(strides.size(), 2) << "ValueError: conv2d expects 2 strides";
+  CHECK_EQ(dilation.size(), 2) << "ValueError: conv2d expects 2 dilations";
+  // Normalize the padding to (top, left, bottom, right).
+  if (padding.size() == 1) {
+    padding = {padding[0], padding[0], padding[0], padding[0]};
+  } else if (padding.size() == 2) {
+    padding = {padding[0], padding[1], padding[0], padding[1]};
+  }
+  CHECK_EQ(padding.size(), 4) << "ValueError: conv2d expects 1, 2 or 4 paddings";
+  CHECK_GT(groups, 0) << "ValueError: conv2d expects a positive number of groups";
+  auto attrs = make_object<relay::Conv2DAttrs>();
+  attrs->strides = std::move(strides);
+  attrs->padding = std::move(padding);
+  attrs->dilation = std::move(dilation);
+  attrs->groups = groups;
+  attrs->data_layout = "NCHW";
+  attrs->kernel_layout = "OIHW";
+  attrs->out_layout = "";
+  attrs->out_dtype = out_dtype;
+  static const Op& op = Op::Get("relax.nn.conv2d");
+  return Call(op, {data, weight}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.nn.conv2d").set_body_typed(MakeConv2D);
+
+RELAY_REGISTER_OP("relax.nn.layer_norm")
+    .describe("Layer normalization of the data along an axis, scaled by gamma and offset by beta")
+    .set_num_inputs(3)
+    .add_argument("data", "Tensor", "The input tensor.")
+    .add_argument("gamma", "Tensor", "The 1-D scale, of the length of the normalized axis.")
+    .add_argument("beta", "Tensor", "The 1-D offset, of the length of the normalized axis.")
+    .set_attrs_type<relay::LayerNormAttrs>()
+    .set_attr<FInferShape>("FInferShape", InferShapeLayerNorm)
+    .set_attr<FInferType>("FInferType", InferTypeLayerNorm)
+    .set_support_level(1);
+
+Expr MakeLayerNorm(Expr data, Expr gamma, Expr beta, int axis, double epsilon, bool center,
+                   bool scale) {
+  auto attrs = make_object<relay::LayerNormAttrs>();
+  attrs->axis = axis;
+  attrs->epsilon = epsilon;
+  attrs->center = center;
+  attrs->scale = scale;
+  static const Op& op = Op::Get("relax.nn.layer_norm");
+  return Call(op, {data, gamma, beta}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.nn.layer_norm").set_body_typed(MakeLayerNorm);
+
+TVM_REGISTER_NODE_TYPE(AttentionAttrs);
+
+RELAY_REGISTER_OP("relax.nn.attention")
+    .describe("Attention softmax(query @ key * scale) @ value, with the keys transposed")
+    .set_num_inputs(3)
+    .add_argument("query", "Tensor", "The queries of shape (..., seq_q, head_dim).")
+    .add_argument("key", "Tensor", "The transposed keys of shape (..., head_dim, seq_kv).")
+    .add_argument("value", "Tensor", "The values of shape (..., seq_kv, value_dim).")
+    .set_attrs_type<AttentionAttrs>()
+    .set_attr<FInferShape>("FInferShape", InferShapeAttention)
+    .set_attr<FInferType>("FInferType", InferTypeAttention)
+    .set_support_level(1);
+
+Expr MakeAttention(Expr query, Expr key, Expr value, Optional<FloatImm> scale) {
+  auto attrs = make_object<AttentionAttrs>();
+  attrs->scale = scale;
+  static const Op& op = Op::Get("relax.nn.attention");
+  return Call(op, {query, key, value}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.nn.attention").set_body_typed(MakeAttention);
+
+TVM_REGISTER_NODE_TYPE(EmbeddingBagAttrs);
+
+RELAY_REGISTER_OP("relax.nn.embedding_bag")
+    .describe("The rows of the embedding table at the indices of every bag, pooled per bag")
+    .set_num_inputs(2)
+    .add_argument("weight", "Tensor", "The embedding table of shape (num_embeddings, dim).")
+    .add_argument("indices", "Tensor", "The integer indices of shape (num_bags, bag_size).")
+    .set_attrs_type<EmbeddingBagAttrs>()
+    .set_attr<FInferShape>("FInferShape", InferShapeEmbeddingBag)
+    .set_attr<FInferType>("FInferType", InferTypeEmbeddingBag)
+    .set_support_level(1);
+
+Expr MakeEmbeddingBag(Expr weight, Expr indices, String mode) {
+  CHECK(mode == "sum" || mode == "mean" || mode == "max")
+      << "ValueError: embedding_bag expects the mode sum, mean or max, but got " << mode;
+  auto attrs = make_object<EmbeddingBagAttrs>();
+  attrs->mode = std::move(mode);
+  static const Op& op = Op::Get("relax.nn.embedding_bag");
+  return Call(op, {weight, indices}, Attrs(attrs), {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.nn.embedding_bag").set_body_typed(MakeEmbeddingBag);
+
+}  // namespace relax
+}  // namespace tvm
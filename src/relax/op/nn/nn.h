@@ -0,0 +1,233 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file nn.h
+ * \brief shape and type deduction for neural network operators.
+ */
+#ifndef TVM_RELAX_OP_NN_NN_H_
+#define TVM_RELAX_OP_NN_NN_H_
+
+#include <tvm/relax/attrs/nn.h>
+#include <tvm/relax/expr.h>
+#include <tvm/relax/type.h>
+#include <tvm/relay/attrs/nn.h>
+
+#include "../op_common.h"
+
+namespace tvm {
+namespace relax {
+
+Optional<Expr> InferShapeUnaryElemwise(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 1) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "Unary op should have 1 argument");
+  }
+  Expr shape = call->args[0]->shape();
+  return shape.defined() ? Optional<Expr>(shape) : NullOpt;
+}
+
+Type InferTypeUnaryElemwise(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 1) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "Unary op should have 1 argument");
+  }
+  Type type = call->args[0]->checked_type();
+  if (!type->IsInstance<DynTensorTypeNode>()) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "The operand of an elementwise op should be DynTensor, but got "
+                       << type->GetTypeKey());
+  }
+  return type;
+}
+
+/*! Quick helper macro to register an elementwise unary operator. */
+#define RELAX_REGISTER_UNARY_ELEMWISE_OP(OpName)                                   \
+  TVM_REGISTER_GLOBAL("relax.op." OpName).set_body_typed([](Expr data) {          \
+    static const Op& op = Op::Get("relax." OpName);                               \
+    return Call(op, {data}, Attrs(), {});                                         \
+  });                                                                             \
+  RELAY_REGISTER_OP("relax." OpName)                                              \
+      .set_num_inputs(1)                                                          \
+      .add_argument("data", "Tensor", "The input tensor.")                        \
+      .set_attr<FInferShape>("FInferShape", InferShapeUnaryElemwise)              \
+      .set_attr<FInferType>("FInferType", InferTypeUnaryElemwise)
+
+Optional<Expr> InferShapeConv2D(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "Conv2d op should have 2 arguments");
+  }
+  const auto* attrs = call->attrs.as<relay::Conv2DAttrs>();
+  auto* data_shape = call->args[0]->shape().as<ShapeExprNode>();
+  auto* weight_shape = call->args[1]->shape().as<ShapeExprNode>();
+  if (!data_shape || !weight_shape) return NullOpt;
+  if (data_shape->values.size() != 4 || weight_shape->values.size() != 4) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Conv2d op expects 4-D data and weight in NCHW and OIHW layouts");
+  }
+  const Array<PrimExpr>& data = data_shape->values;
+  const Array<PrimExpr>& weight = weight_shape->values;
+  PrimExpr in_channels = weight[1] * attrs->groups;
+  if (tir::as_const_int(data[1]) && tir::as_const_int(weight[1]) &&
+      !EqualCheck(data[1], in_channels)) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Conv2d op convolves " << data[1] << " channels with a weight of "
+                       << in_channels << " input channels");
+  }
+  arith::Analyzer analyzer;
+  Array<PrimExpr> output_shape{data[0], weight[0]};
+  for (int i = 0; i < 2; ++i) {
+    // The padding is (top, left, bottom, right).
+    PrimExpr padded = data[i + 2] + attrs->padding[i] + attrs->padding[i + 2];
+    PrimExpr dilated_kernel = attrs->dilation[i] * (weight[i + 2] - 1) + 1;
+    output_shape.push_back(
+        analyzer.Simplify(floordiv(padded - dilated_kernel, attrs->strides[i]) + 1));
+  }
+  return ShapeExpr(output_shape);
+}
+
+Type InferTypeConv2D(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "Conv2d op should have 2 arguments");
+  }
+  auto* data_type = call->args[0]->checked_type().as<DynTensorTypeNode>();
+  auto* weight_type = call->args[1]->checked_type().as<DynTensorTypeNode>();
+  if (!data_type || !weight_type) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Both operands of conv2d should be DynTensor");
+  }
+  const auto* attrs = call->attrs.as<relay::Conv2DAttrs>();
+  DataType output_dtype = attrs->out_dtype.is_void() ? data_type->dtype : attrs->out_dtype;
+  return DynTensorType(4, output_dtype);
+}
+
+Optional<Expr> InferShapeLayerNorm(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 3) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "LayerNorm op should have 3 arguments");
+  }
+  Expr shape = call->args[0]->shape();
+  return shape.defined() ? Optional<Expr>(shape) : NullOpt;
+}
+
+Type InferTypeLayerNorm(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 3) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "LayerNorm op should have 3 arguments");
+  }
+  for (const Expr& arg : call->args) {
+    if (!arg->checked_type()->IsInstance<DynTensorTypeNode>()) {
+      diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                         << "The operands of layer_norm should be DynTensor, but got "
+                         << arg->checked_type()->GetTypeKey());
+    }
+  }
+  return call->args[0]->checked_type();
+}
+
+Optional<Expr> InferShapeAttention(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 3) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "Attention op should have 3 arguments");
+  }
+  auto* query_shape = call->args[0]->shape().as<ShapeExprNode>();
+  auto* key_shape = call->args[1]->shape().as<ShapeExprNode>();
+  auto* value_shape = call->args[2]->shape().as<ShapeExprNode>();
+  if (!query_shape || !key_shape || !value_shape) return NullOpt;
+  const Array<PrimExpr>& query = query_shape->values;
+  const Array<PrimExpr>& key = key_shape->values;
+  const Array<PrimExpr>& value = value_shape->values;
+  size_t ndim = query.size();
+  if (ndim < 2 || key.size() != ndim || value.size() != ndim) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Attention op expects the query, the transposed key and the value of "
+                          "the same rank of at least 2");
+  }
+  // The dimensions may be symbolic, e.g. a dynamic sequence length, so only the dimensions known
+  // to differ are rejected.
+  auto f_mismatch = [](const PrimExpr& lhs, const PrimExpr& rhs) {
+    arith::Analyzer analyzer;
+    return tir::as_const_int(analyzer.Simplify(lhs - rhs)) != nullptr && !EqualCheck(lhs, rhs);
+  };
+  // query: (..., seq_q, head_dim), key: (..., head_dim, seq_kv), value: (..., seq_kv, value_dim)
+  for (size_t i = 0; i + 2 < ndim; ++i) {
+    if (f_mismatch(query[i], key[i]) || f_mismatch(query[i], value[i])) {
+      diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                         << "Attention op expects the same batch dimensions, but got "
+                         << query[i] << ", " << key[i] << " and " << value[i]);
+    }
+  }
+  if (f_mismatch(query[ndim - 1], key[ndim - 2]) || f_mismatch(key[ndim - 1], value[ndim - 2])) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Attention op got mismatched shapes of query " << query_shape->values
+                       << ", key " << key_shape->values << " and value " << value_shape->values);
+  }
+  Array<PrimExpr> output_shape{query.begin(), query.end() - 1};
+  output_shape.push_back(value[ndim - 1]);
+  return ShapeExpr(output_shape);
+}
+
+Type InferTypeAttention(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 3) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "Attention op should have 3 arguments");
+  }
+  for (const Expr& arg : call->args) {
+    if (!arg->checked_type()->IsInstance<DynTensorTypeNode>()) {
+      diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                         << "The operands of attention should be DynTensor, but got "
+                         << arg->checked_type()->GetTypeKey());
+    }
+  }
+  return call->args[0]->checked_type();
+}
+
+Optional<Expr> InferShapeEmbeddingBag(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "EmbeddingBag op should have 2 arguments");
+  }
+  auto* weight_shape = call->args[0]->shape().as<ShapeExprNode>();
+  auto* indices_shape = call->args[1]->shape().as<ShapeExprNode>();
+  if (!weight_shape || !indices_shape) return NullOpt;
+  if (weight_shape->values.size() != 2 || indices_shape->values.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "EmbeddingBag op expects the 2-D weight (num_embeddings, embedding_dim) "
+                          "and the 2-D indices (num_bags, bag_size), but got "
+                       << weight_shape->values << " and " << indices_shape->values);
+  }
+  return ShapeExpr({indices_shape->values[0], weight_shape->values[1]});
+}
+
+Type InferTypeEmbeddingBag(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "EmbeddingBag op should have 2 arguments");
+  }
+  auto* weight_type = call->args[0]->checked_type().as<DynTensorTypeNode>();
+  auto* indices_type = call->args[1]->checked_type().as<DynTensorTypeNode>();
+  if (!weight_type || !indices_type) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Both operands of embedding_bag should be DynTensor");
+  }
+  if (!indices_type->IsUnknownDtype() && !indices_type->dtype.is_int() &&
+      !indices_type->dtype.is_uint()) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "EmbeddingBag op expects integer indices, but got "
+                       << indices_type->dtype);
+  }
+  return DynTensorType(2, weight_type->dtype);
+}
+
+}  // namespace relax
+}  // namespace tvm
+
+#endif  // TVM_RELAX_OP_NN_NN_H_
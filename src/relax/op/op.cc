@@ -16,6 +16,7 @@
  * specific language governing permissions and limitations
  * under the License.
  */
+#include <tvm/relax/attrs/call_tir.h>
 #include <tvm/relax/attrs/memory.h>
 #include <tvm/relax/attrs/shape.h>
 #include <tvm/relax/expr.h>
@@ -26,6 +27,8 @@
 namespace tvm {
 namespace relax {
 
+TVM_REGISTER_NODE_TYPE(CallTIRInplaceAttrs);
+TVM_REGISTER_NODE_TYPE(CallTIRDeviceAttrs);
 TVM_REGISTER_NODE_TYPE(AllocTensorAttrs);
 TVM_REGISTER_NODE_TYPE(VMAllocStorageAttrs);
 TVM_REGISTER_NODE_TYPE(VMAllocTensorAttrs);
@@ -85,14 +88,27 @@ RELAY_REGISTER_OP("relax.call_tir")
     .set_attr<FInferType>("FInferType", InferTypeArg);
 
 Expr MakeCallTIR(Expr func, Tuple args, Expr output_shape, Type output_type,
-                 Optional<Expr> packed_ints) {
+                 Optional<Expr> packed_ints, Optional<Array<Integer>> inplace_indices,
+                 Optional<Integer> runtime_device_index) {
   static const Op& op = Op::Get("relax.call_tir");
+  Attrs attrs;
+  ICHECK(!inplace_indices || !runtime_device_index)
+      << "A call_tir computing in place runs on the device of its inputs";
+  if (inplace_indices) {
+    auto inplace_attrs = make_object<CallTIRInplaceAttrs>();
+    inplace_attrs->inplace_indices = inplace_indices.value();
+    attrs = Attrs(inplace_attrs);
+  } else if (runtime_device_index) {
+    auto device_attrs = make_object<CallTIRDeviceAttrs>();
+    device_attrs->runtime_device_index = runtime_device_index.value()->value;
+    attrs = Attrs(device_attrs);
+  }
   Call call;
   if (!packed_ints) {
     // don't use additional optional argument
-    call = Call(op, {func, args, output_shape}, {}, {output_type});
+    call = Call(op, {func, args, output_shape}, attrs, {output_type});
   } else {
-    call = Call(op, {func, args, output_shape, packed_ints.value()}, {}, {output_type});
+    call = Call(op, {func, args, output_shape, packed_ints.value()}, attrs, {output_type});
   }
   return call;
 }
@@ -129,6 +145,39 @@ Expr InvokeClosure(Expr closure, Tuple args) {
 
 TVM_REGISTER_GLOBAL("relax.op.invoke_closure").set_body_typed(InvokeClosure);
 
+// scan
+
+Optional<Expr> InferShapeScan(const Call& call, DiagnosticContext diag_ctx) {
+  // The states keep their shapes across the steps.
+  if (call->args[2]->shape_) {
+    return Downcast<Expr>(call->args[2]->shape_.value());
+  }
+  return NullOpt;
+}
+
+Type InferTypeScan(const Call& call, DiagnosticContext diag_ctx) {
+  if (!call->args[2]->IsInstance<TupleNode>()) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "The initial states of scan should be given as a tuple.");
+  }
+  return call->args[2]->checked_type();
+}
+
+RELAY_REGISTER_OP("relax.scan")
+    .set_num_inputs(3)
+    .add_argument("func", "Expr", "The step function, which maps the states to the next states.")
+    .add_argument("num_steps", "Expr", "The number of steps, a shape of one dimension.")
+    .add_argument("init", "Tuple", "The initial states.")
+    .set_attr<FInferShape>("FInferShape", InferShapeScan)
+    .set_attr<FInferType>("FInferType", InferTypeScan);
+
+Expr MakeScan(Expr func, Expr num_steps, Tuple init) {
+  static const Op& op = Op::Get("relax.scan");
+  return Call(op, {func, num_steps, init}, {}, {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.scan").set_body_typed(MakeScan);
+
 // shape_of
 
 RELAY_REGISTER_OP("relax.shape_of")
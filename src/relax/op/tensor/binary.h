@@ -43,6 +43,13 @@ Optional<Expr> InferShapeBinaryBroadcast(const Call& call, DiagnosticContext dia
   }
   Expr lhs_shape = call->args[0]->shape();
   Expr rhs_shape = call->args[1]->shape();
+  // Operands of the same shape expression, e.g. the same tensor or tensors whose shapes are
+  // both computed by an earlier runtime inference, broadcast to that shape without a runtime
+  // shape inference.
+  if (lhs_shape.defined() && lhs_shape.same_as(rhs_shape) &&
+      !lhs_shape->IsInstance<RuntimeDepShapeNode>()) {
+    return lhs_shape;
+  }
   auto* s0 = lhs_shape.as<ShapeExprNode>();
   auto* s1 = rhs_shape.as<ShapeExprNode>();
   if (s0 && s1) {
@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file linear_algebra.cc
+ * \brief linear algebra operators.
+ */
+
+#include "linear_algebra.h"
+
+namespace tvm {
+namespace relax {
+
+RELAY_REGISTER_OP("relax.matmul")
+    .describe("Matrix product of the last two dimensions, the leading dimensions are batched")
+    .set_num_inputs(2)
+    .add_argument("a", "Tensor", "The left operand of shape (..., M, K).")
+    .add_argument("b", "Tensor", "The right operand of shape (..., K, N).")
+    .set_attr<FInferShape>("FInferShape", InferShapeMatmul)
+    .set_attr<FInferType>("FInferType", InferTypeMatmul)
+    .set_support_level(1);
+
+Expr MakeMatmul(Expr a, Expr b) {
+  static const Op& op = Op::Get("relax.matmul");
+  return Call(op, {a, b}, Attrs(), {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.matmul").set_body_typed(MakeMatmul);
+
+}  // namespace relax
+}  // namespace tvm
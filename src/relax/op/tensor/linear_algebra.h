@@ -0,0 +1,95 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file linear_algebra.h
+ * \brief shape and type deduction for linear algebra operators.
+ */
+#ifndef TVM_RELAX_OP_TENSOR_LINEAR_ALGEBRA_H_
+#define TVM_RELAX_OP_TENSOR_LINEAR_ALGEBRA_H_
+
+#include <tvm/relax/expr.h>
+#include <tvm/relax/type.h>
+
+#include <algorithm>
+
+#include "../op_common.h"
+
+namespace tvm {
+namespace relax {
+
+Optional<Expr> InferShapeMatmul(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "Matmul op should have 2 arguments");
+  }
+  auto* s0 = call->args[0]->shape().as<ShapeExprNode>();
+  auto* s1 = call->args[1]->shape().as<ShapeExprNode>();
+  if (!s0 || !s1) return NullOpt;
+  size_t ndim0 = s0->values.size();
+  size_t ndim1 = s1->values.size();
+  if (ndim0 < 2 || ndim1 < 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Matmul op requires operands of at least 2 dimensions");
+  }
+  PrimExpr k0 = s0->values[ndim0 - 1];
+  PrimExpr k1 = s1->values[ndim1 - 2];
+  if (tir::as_const_int(k0) && tir::as_const_int(k1) && !EqualCheck(k0, k1)) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Matmul op reduces mismatched dimensions " << k0 << " and " << k1);
+  }
+  // The batch dimensions are those of the operand with more dimensions, the other operand is
+  // broadcast.
+  auto& longer_shape = ndim0 >= ndim1 ? s0 : s1;
+  Array<PrimExpr> output_shape;
+  for (size_t i = 0; i + 2 < longer_shape->values.size(); ++i) {
+    output_shape.push_back(longer_shape->values[i]);
+  }
+  output_shape.push_back(s0->values[ndim0 - 2]);
+  output_shape.push_back(s1->values[ndim1 - 1]);
+  return ShapeExpr(output_shape);
+}
+
+Type InferTypeMatmul(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "Matmul op should have 2 arguments");
+  }
+  auto* t0 = call->args[0]->checked_type().as<DynTensorTypeNode>();
+  auto* t1 = call->args[1]->checked_type().as<DynTensorTypeNode>();
+  if (!t0 || !t1) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Both operands of matmul should be DynTensor");
+  }
+  DataType output_dtype;
+  if (t0->IsUnknownDtype() || t1->IsUnknownDtype()) {
+    output_dtype = DataType::Void();
+  } else if (t0->dtype != t1->dtype) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Data types " << t0->dtype << " and " << t1->dtype
+                       << " must be equal for matmul");
+  } else {
+    output_dtype = t0->dtype;
+  }
+  int output_ndim = t0->IsUnknownNdim() || t1->IsUnknownNdim() ? -1 : std::max(t0->ndim, t1->ndim);
+  return DynTensorType(output_ndim, output_dtype);
+}
+
+}  // namespace relax
+}  // namespace tvm
+
+#endif  // TVM_RELAX_OP_TENSOR_LINEAR_ALGEBRA_H_
@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file sparse.cc
+ * \brief sparse operators.
+ */
+
+#include "sparse.h"
+
+namespace tvm {
+namespace relax {
+
+RELAY_REGISTER_OP("relax.sparse_dense")
+    .describe("Matrix product of a dense matrix and the transpose of a CSR or BSR matrix")
+    .set_num_inputs(4)
+    .add_argument("data", "Tensor", "The dense operand of shape (M, K).")
+    .add_argument("weight_data", "Tensor", "The values of the sparse operand of shape (N, K).")
+    .add_argument("weight_indices", "Tensor", "The columns of the values of the sparse operand.")
+    .add_argument("weight_indptr", "Tensor", "The offsets of the rows of the sparse operand.")
+    .set_attr<FInferShape>("FInferShape", InferShapeSparseDense)
+    .set_attr<FInferType>("FInferType", InferTypeSparseDense)
+    .set_support_level(1);
+
+Expr MakeSparseDense(Expr data, Expr weight_data, Expr weight_indices, Expr weight_indptr) {
+  static const Op& op = Op::Get("relax.sparse_dense");
+  return Call(op, {data, weight_data, weight_indices, weight_indptr}, Attrs(), {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.sparse_dense").set_body_typed(MakeSparseDense);
+
+RELAY_REGISTER_OP("relax.sparse_add")
+    .describe("Sum of a dense matrix and a CSR matrix of the same shape")
+    .set_num_inputs(4)
+    .add_argument("dense", "Tensor", "The dense operand of shape (M, N).")
+    .add_argument("sparse_data", "Tensor", "The values of the sparse operand.")
+    .add_argument("sparse_indices", "Tensor", "The columns of the values of the sparse operand.")
+    .add_argument("sparse_indptr", "Tensor", "The offsets of the rows of the sparse operand.")
+    .set_attr<FInferShape>("FInferShape", InferShapeSparseAdd)
+    .set_attr<FInferType>("FInferType", InferTypeSparseAdd)
+    .set_support_level(1);
+
+Expr MakeSparseAdd(Expr dense, Expr sparse_data, Expr sparse_indices, Expr sparse_indptr) {
+  static const Op& op = Op::Get("relax.sparse_add");
+  return Call(op, {dense, sparse_data, sparse_indices, sparse_indptr}, Attrs(), {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.sparse_add").set_body_typed(MakeSparseAdd);
+
+}  // namespace relax
+}  // namespace tvm
@@ -0,0 +1,142 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file sparse.h
+ * \brief shape and type deduction for sparse operators.
+ *
+ * A sparse matrix is represented by the dense tensors of its compressed rows: a CSR matrix of
+ * shape (N, K) by its values of shape (nnz,), the column of each value of shape (nnz,) and the
+ * offsets of the rows of shape (N + 1,); a BSR matrix by its blocks of shape (nnz_blocks, bs_r,
+ * bs_c), the block column of each block and the offsets of the rows of blocks of shape
+ * (N / bs_r + 1,).
+ */
+#ifndef TVM_RELAX_OP_TENSOR_SPARSE_H_
+#define TVM_RELAX_OP_TENSOR_SPARSE_H_
+
+#include <tvm/relax/expr.h>
+#include <tvm/relax/type.h>
+
+#include <string>
+#include <vector>
+
+#include "../op_common.h"
+
+namespace tvm {
+namespace relax {
+
+/*! \brief The number of rows of the sparse matrix given by its compressed rows. */
+Optional<PrimExpr> SparseNumRows(const Call& call, DiagnosticContext diag_ctx, int data_index) {
+  auto* data = call->args[data_index]->shape().as<ShapeExprNode>();
+  auto* indices = call->args[data_index + 1]->shape().as<ShapeExprNode>();
+  auto* indptr = call->args[data_index + 2]->shape().as<ShapeExprNode>();
+  if (!data || !indices || !indptr) return NullOpt;
+  if (data->values.size() != 1 && data->values.size() != 3) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "The sparse data should be of 1 (CSR) or 3 (BSR) dimensions");
+  }
+  if (indices->values.size() != 1 || indptr->values.size() != 1) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "The sparse indices and indptr should be of 1 dimension");
+  }
+  PrimExpr num_rows = indptr->values[0] - 1;
+  if (data->values.size() == 3) {
+    num_rows = num_rows * data->values[1];
+  }
+  arith::Analyzer analyzer;
+  return analyzer.Simplify(num_rows);
+}
+
+/*! \brief Check the types of a dense and a sparse operand, return the dtype of the output. */
+DataType InferTypeSparse(const Call& call, DiagnosticContext diag_ctx, const std::string& name) {
+  if (call->args.size() != 4) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << name << " op should have 4 arguments");
+  }
+  std::vector<const DynTensorTypeNode*> types;
+  for (const Expr& arg : call->args) {
+    auto* type = arg->checked_type().as<DynTensorTypeNode>();
+    if (!type) {
+      diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                         << "The operands of " << name << " should be DynTensor");
+    }
+    types.push_back(type);
+  }
+  for (int i : {2, 3}) {
+    if (!types[i]->IsUnknownDtype() && !types[i]->dtype.is_int()) {
+      diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                         << "The sparse indices and indptr of " << name << " should be integers");
+    }
+  }
+  if (types[0]->IsUnknownDtype() || types[1]->IsUnknownDtype()) return DataType::Void();
+  if (types[0]->dtype != types[1]->dtype) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "Data types " << types[0]->dtype << " and " << types[1]->dtype
+                       << " must be equal for " << name);
+  }
+  return types[0]->dtype;
+}
+
+Optional<Expr> InferShapeSparseDense(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 4) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "SparseDense op should have 4 arguments");
+  }
+  auto* s0 = call->args[0]->shape().as<ShapeExprNode>();
+  Optional<PrimExpr> num_rows = SparseNumRows(call, diag_ctx, 1);
+  if (!s0 || !num_rows.defined()) return NullOpt;
+  if (s0->values.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "SparseDense op requires a dense operand of 2 dimensions");
+  }
+  return ShapeExpr({s0->values[0], num_rows.value()});
+}
+
+Type InferTypeSparseDense(const Call& call, DiagnosticContext diag_ctx) {
+  return DynTensorType(2, InferTypeSparse(call, diag_ctx, "SparseDense"));
+}
+
+Optional<Expr> InferShapeSparseAdd(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 4) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "SparseAdd op should have 4 arguments");
+  }
+  auto* s0 = call->args[0]->shape().as<ShapeExprNode>();
+  Optional<PrimExpr> num_rows = SparseNumRows(call, diag_ctx, 1);
+  if (!s0 || !num_rows.defined()) return NullOpt;
+  if (s0->values.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "SparseAdd op requires a dense operand of 2 dimensions");
+  }
+  if (call->args[1]->shape().as<ShapeExprNode>()->values.size() != 1) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "SparseAdd op only supports CSR");
+  }
+  if (tir::as_const_int(s0->values[0]) && tir::as_const_int(num_rows.value()) &&
+      !EqualCheck(s0->values[0], num_rows.value())) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "SparseAdd op adds mismatched numbers of rows " << s0->values[0]
+                       << " and " << num_rows.value());
+  }
+  return GetRef<ShapeExpr>(s0);
+}
+
+Type InferTypeSparseAdd(const Call& call, DiagnosticContext diag_ctx) {
+  return DynTensorType(2, InferTypeSparse(call, diag_ctx, "SparseAdd"));
+}
+
+}  // namespace relax
+}  // namespace tvm
+
+#endif  // TVM_RELAX_OP_TENSOR_SPARSE_H_
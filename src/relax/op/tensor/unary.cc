@@ -46,11 +46,52 @@ Expr MakeUnique(Expr data, bool sorted, bool return_inverse, bool return_counts,
   attrs->return_inverse = return_inverse;
   attrs->return_counts = return_counts;
   attrs->dim = dim;
-  static const Op& op = Op::Get("unique");
+  static const Op& op = Op::Get("relax.unique");
   return Call(op, {data}, Attrs(attrs));
 }
 
 TVM_REGISTER_GLOBAL("relax.op.unique").set_body_typed(MakeUnique);
 
+RELAY_REGISTER_OP("relax.unique_bounded")
+    .describe(
+        "This operation returns the unique elements of a tensor in a buffer of the size of the "
+        "tensor, with their number in a 1-D extent on the device of the tensor.")
+    .set_num_inputs(1)
+    .add_argument("data", "Tensor", "The input tensor")
+    .set_attrs_type<UniqueAttrs>()
+    .set_attr<FInferShape>("FInferShape", InferShapeUniqueBounded)
+    .set_attr<FInferType>("FInferType", InferTypeUniqueBounded)
+    .set_attr<FCallPacked>("FCallPacked", "relax.run.unique_bounded");
+
+Expr MakeUniqueBounded(Expr data, bool sorted) {
+  auto attrs = make_object<UniqueAttrs>();
+  attrs->sorted = sorted;
+  attrs->return_inverse = false;
+  attrs->return_counts = false;
+  attrs->dim = -1;
+  static const Op& op = Op::Get("relax.unique_bounded");
+  return Call(op, {data}, Attrs(attrs));
+}
+
+TVM_REGISTER_GLOBAL("relax.op.unique_bounded").set_body_typed(MakeUniqueBounded);
+
+RELAY_REGISTER_OP("relax.resolve_bound")
+    .describe(
+        "This operation views the leading entries of a tensor allocated at an upper bound along "
+        "its first axis, their number read from a 1-D extent.")
+    .set_num_inputs(2)
+    .add_argument("data", "Tensor", "The tensor allocated at the bound")
+    .add_argument("extent", "Tensor", "The 1-D int64 number of the valid entries")
+    .set_attr<FInferShape>("FInferShape", InferShapeResolveBound)
+    .set_attr<FInferType>("FInferType", InferTypeResolveBound)
+    .set_attr<FCallPacked>("FCallPacked", "vm.builtin.resolve_bound");
+
+Expr MakeResolveBound(Expr data, Expr extent) {
+  static const Op& op = Op::Get("relax.resolve_bound");
+  return Call(op, {data, extent}, {}, {});
+}
+
+TVM_REGISTER_GLOBAL("relax.op.resolve_bound").set_body_typed(MakeResolveBound);
+
 }  // namespace relax
 }  // namespace tvm
@@ -67,6 +67,47 @@ Type InferTypeUnique(const Call& call, DiagnosticContext diag_ctx) {
   return DynTensorType(/*ndim=*/1, input_ty->dtype);
 }
 
+Optional<Expr> InferShapeUniqueBounded(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 1) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "UniqueBounded op should have 1 argument");
+  }
+  // The elements are allocated at the size of the data, their number is a 1-D extent.
+  auto* shape = call->args[0]->shape().as<ShapeExprNode>();
+  if (!shape) return NullOpt;
+  PrimExpr size = IntImm(DataType::Int(64), 1);
+  for (const PrimExpr& dim : shape->values) {
+    size = size * dim;
+  }
+  return Tuple({ShapeExpr({size}), ShapeExpr({IntImm(DataType::Int(64), 1)})}, call->span);
+}
+
+Type InferTypeUniqueBounded(const Call& call, DiagnosticContext diag_ctx) {
+  Type values_type = InferTypeUnique(call, diag_ctx);
+  return TupleType({values_type, DynTensorType(/*ndim=*/1, DataType::Int(64))});
+}
+
+Optional<Expr> InferShapeResolveBound(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "ResolveBound op should have 2 arguments");
+  }
+  return relax::RuntimeDepShape(call->span);
+}
+
+Type InferTypeResolveBound(const Call& call, DiagnosticContext diag_ctx) {
+  if (call->args.size() != 2) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span) << "ResolveBound op should have 2 arguments");
+  }
+  auto* data_ty = call->args[0]->checked_type().as<DynTensorTypeNode>();
+  auto* extent_ty = call->args[1]->checked_type().as<DynTensorTypeNode>();
+  if (!data_ty || !extent_ty) {
+    diag_ctx.EmitFatal(Diagnostic::Error(call->span)
+                       << "The data and the extent should be DynTensor, but got "
+                       << call->args[0]->checked_type()->GetTypeKey() << " and "
+                       << call->args[1]->checked_type()->GetTypeKey());
+  }
+  return GetRef<DynTensorType>(data_ty);
+}
+
 }  // namespace relax
 }  // namespace tvm
 
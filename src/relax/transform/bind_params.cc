@@ -18,6 +18,7 @@
  */
 
 #include <tvm/driver/driver_api.h>
+#include <tvm/node/serialization.h>
 #include <tvm/relax/attrs/memory.h>
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/transform.h>
@@ -98,6 +99,20 @@ Pass BindParams(String func_name, Map<String, runtime::NDArray> params) {
 
 TVM_REGISTER_GLOBAL("relax.transform.BindParams").set_body_typed(BindParams);
 
+Pass BindParamsFromFile(String func_name, String path) {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func = [=](IRModule mod,
+                                                                            PassContext pc) {
+    // The constants are views of the mapped file, whose pages are read on the first touch.
+    ObjectRef params = LoadBinaryFromFile(path, /*use_mmap=*/true);
+    ICHECK(params->IsInstance<MapNode>())
+        << "ValueError: The param file " << path << " does not hold a map of the params.";
+    return BindParam(std::move(mod), func_name, Downcast<Map<String, runtime::NDArray>>(params));
+  };
+  return CreateModulePass(pass_func, 0, "BindParamsFromFile", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.BindParamsFromFile").set_body_typed(BindParamsFromFile);
+
 }  // namespace transform
 
 }  // namespace relax
@@ -0,0 +1,426 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/bucket_symbolic_dim.cc
+ * \brief Specialize a function for a set of buckets of a symbolic dimension.
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/relax/type.h>
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/function.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+// ==================
+// SymbolicDimSpecializer
+// Substitute a symbolic dimension by a constant in a function, and specialize the call_tir
+// kernels whose argument and output shapes become static.
+// Example (n = 32):
+// lv0: Tensor(n, 4) = rx.call_tir(func, (x), (n, 4), dtype="float32")
+// -->
+// lv0: Tensor(32, 4) = rx.call_tir(func_bucket32, (x), (32, 4), dtype="float32")
+
+class SymbolicDimSpecializer : public ExprMutator {
+ public:
+  SymbolicDimSpecializer(BlockBuilder builder, tir::Var dim, int64_t bucket) : bucket_(bucket) {
+    builder_ = std::move(builder);
+    var_map_.Set(dim, IntImm(dim->dtype, bucket));
+  }
+
+  Expr VisitExpr_(const ShapeExprNode* op) final {
+    Array<PrimExpr> values;
+    bool unchanged = true;
+    for (const PrimExpr& e : op->values) {
+      PrimExpr value = tir::Substitute(e, var_map_);
+      if (!value.same_as(e)) {
+        value = analyzer_.Simplify(value);
+        unchanged = false;
+      }
+      values.push_back(value);
+    }
+    if (unchanged) {
+      return GetRef<Expr>(op);
+    }
+    return ShapeExpr(values, op->span);
+  }
+
+  Expr VisitExpr_(const CallNode* op) final {
+    Call call = Downcast<Call>(ExprMutator::VisitExpr_(op));
+    return SpecializeKernel(call);
+  }
+
+ private:
+  /*!
+   * \brief Replace the kernel of a call_tir by its static-shape specialization.
+   * \return The call itself if its shapes are not all static or the kernel signature does not
+   *  match them.
+   */
+  Call SpecializeKernel(const Call& call) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    if (call->op != call_tir_op) return call;
+    const auto* gv = call->args[0].as<GlobalVarNode>();
+    const auto* args = call->args[1].as<TupleNode>();
+    if (gv == nullptr || args == nullptr) return call;
+    IRModule mod = builder_->GetContextIRModule();
+    auto it_func = mod->functions.find(GetRef<GlobalVar>(gv));
+    if (it_func == mod->functions.end()) return call;
+    const auto* prim_func = (*it_func).second.as<tir::PrimFuncNode>();
+    if (prim_func == nullptr) return call;
+
+    // The kernel parameters are the inputs, the outputs and the unpacked integers in order.
+    std::vector<Array<PrimExpr>> shapes;
+    for (const Expr& arg : args->fields) {
+      const auto* shape = arg->shape_.as<ShapeExprNode>();
+      if (shape == nullptr) return call;
+      shapes.push_back(shape->values);
+    }
+    if (const auto* output_shape = call->args[2].as<ShapeExprNode>()) {
+      shapes.push_back(output_shape->values);
+    } else if (const auto* output_shapes = call->args[2].as<TupleNode>()) {
+      for (const Expr& field : output_shapes->fields) {
+        const auto* shape = field.as<ShapeExprNode>();
+        if (shape == nullptr) return call;
+        shapes.push_back(shape->values);
+      }
+    } else {
+      return call;
+    }
+    Array<PrimExpr> scalars;
+    if (call->args.size() > 3) {
+      const auto* packed_ints = call->args[3].as<ShapeExprNode>();
+      if (packed_ints == nullptr) return call;
+      scalars = packed_ints->values;
+    }
+    if (prim_func->params.size() != shapes.size() + scalars.size()) return call;
+
+    // Bind each symbolic variable of the kernel signature to a consistent constant.
+    std::unordered_map<const tir::VarNode*, int64_t> binding;
+    auto bind = [&binding](const tir::VarNode* var, const PrimExpr& value) {
+      const auto* imm = value.as<IntImmNode>();
+      if (imm == nullptr) return false;
+      auto it = binding.find(var);
+      if (it != binding.end()) return it->second == imm->value;
+      binding[var] = imm->value;
+      return true;
+    };
+    Map<tir::Var, ObjectRef> param_map;
+    for (size_t i = 0; i < shapes.size(); ++i) {
+      const tir::Var& param = prim_func->params[i];
+      auto it_buffer = prim_func->buffer_map.find(param);
+      if (it_buffer == prim_func->buffer_map.end()) return call;
+      const tir::Buffer& buffer = (*it_buffer).second;
+      if (!buffer->strides.empty() || buffer->shape.size() != shapes[i].size()) return call;
+      Array<PrimExpr> static_shape;
+      for (size_t j = 0; j < shapes[i].size(); ++j) {
+        const PrimExpr& dim = buffer->shape[j];
+        if (const auto* imm = dim.as<IntImmNode>()) {
+          const auto* value = shapes[i][j].as<IntImmNode>();
+          if (value == nullptr || value->value != imm->value) return call;
+          static_shape.push_back(dim);
+        } else if (const auto* var = dim.as<tir::VarNode>()) {
+          if (!bind(var, shapes[i][j])) return call;
+          static_shape.push_back(IntImm(var->dtype, binding.at(var)));
+        } else {
+          return call;
+        }
+      }
+      param_map.Set(param, tir::Buffer(tir::Var(buffer->data->name_hint,
+                                                buffer->data->type_annotation),
+                                       buffer->dtype, static_shape, {}, buffer->elem_offset,
+                                       buffer->name, buffer->data_alignment,
+                                       buffer->offset_factor, buffer->buffer_type));
+    }
+    for (size_t i = 0; i < scalars.size(); ++i) {
+      const tir::Var& param = prim_func->params[shapes.size() + i];
+      if (prim_func->buffer_map.count(param) || !bind(param.get(), scalars[i])) return call;
+      param_map.Set(param, IntImm(param->dtype, binding.at(param.get())));
+    }
+    // The kernel is static already.
+    if (binding.empty()) return call;
+
+    tir::PrimFunc specialized = tir::Specialize(GetRef<tir::PrimFunc>(prim_func), param_map);
+    GlobalVar new_gv =
+        builder_->AddFunction(specialized, gv->name_hint + "_bucket" + std::to_string(bucket_));
+    return Call(call->op, {new_gv, call->args[1], call->args[2]}, call->attrs, call->type_args,
+                call->span);
+  }
+
+  /*! \brief The bucket the dimension is specialized to. */
+  int64_t bucket_;
+  /*! \brief The substitution of the symbolic dimension. */
+  Map<tir::Var, PrimExpr> var_map_;
+  /*! \brief The analyzer to fold the substituted shapes. */
+  arith::Analyzer analyzer_;
+};
+
+// ==================
+// SymbolicDimBucketer
+// Specialize a function for every bucket of a symbolic dimension and replace it by a dispatcher
+// that pads the inputs to the smallest fitting bucket, calls the static-shape variant and slices
+// the outputs back. Inputs larger than every bucket fall back to the original function.
+// Example (n in {32, 64}):
+// def main(x: Tensor((n, 4))):
+//   fits = call_packed("vm.builtin.fits_bucket", x, (0, 32))
+//   if fits:
+//     padded = call_packed("vm.builtin.pad_to_bucket", x, (0, 32))
+//     out = main_bucket32(padded)
+//     ret = call_packed("vm.builtin.unpad_from_bucket", out, (0, 0), x)
+//   else:
+//     ...
+//       ret = main_dynamic(x)
+
+class SymbolicDimBucketer {
+ public:
+  SymbolicDimBucketer(IRModule mod, GlobalVar gv, Function func, String dim_name,
+                      std::vector<int64_t> buckets)
+      : builder_(BlockBuilder::Create(mod)),
+        gv_(std::move(gv)),
+        func_(std::move(func)),
+        buckets_(std::move(buckets)) {
+    FindDim(dim_name);
+  }
+
+  IRModule Run() {
+    std::string name = gv_->name_hint;
+    dynamic_gv_ = AddFunction(func_, name + "_dynamic");
+    for (int64_t bucket : buckets_) {
+      Function specialized = Downcast<Function>(
+          SymbolicDimSpecializer(builder_, dim_, bucket).VisitExpr(func_));
+      bucket_gvs_.push_back(AddFunction(specialized, name + "_bucket" + std::to_string(bucket)));
+    }
+
+    for (const Var& param : func_->params) {
+      params_.push_back(
+          Var(param->name_hint(), Downcast<Optional<Expr>>(param->shape_), param->checked_type_));
+    }
+    Expr body = EmitDispatch(0);
+    builder_->UpdateFunction(gv_, Function(params_, body, func_->ret_type, func_->attrs));
+    return builder_->GetContextIRModule();
+  }
+
+ private:
+  /*! \brief Find the dimension among the parameter shapes and the axes it is used at. */
+  void FindDim(const String& dim_name) {
+    for (const Var& param : func_->params) {
+      const auto* shape = param->shape_.as<ShapeExprNode>();
+      if (shape == nullptr) continue;
+      for (const PrimExpr& e : shape->values) {
+        const auto* var = e.as<tir::VarNode>();
+        if (var != nullptr && var->name_hint == dim_name) {
+          dim_ = GetRef<tir::Var>(var);
+        }
+      }
+    }
+    CHECK(dim_.defined()) << "ValueError: The symbolic dimension " << dim_name
+                          << " is not used in the parameter shapes of " << gv_->name_hint;
+
+    for (size_t i = 0; i < func_->params.size(); ++i) {
+      if (const auto* shape = func_->params[i]->shape_.as<ShapeExprNode>()) {
+        int axis = FindAxis(shape->values);
+        if (axis != -1) inputs_.emplace_back(i, axis);
+      }
+    }
+
+    const Optional<ObjectRef>& output_shape = func_->body->shape_;
+    if (const auto* shape = output_shape.as<ShapeExprNode>()) {
+      output_axes_.push_back(FindAxis(shape->values));
+    } else if (const auto* shapes = output_shape.as<TupleNode>()) {
+      tuple_output_ = true;
+      for (const Expr& field : shapes->fields) {
+        const auto* shape = field.as<ShapeExprNode>();
+        CHECK(shape != nullptr) << "ValueError: BucketSymbolicDim requires the output shapes of "
+                                << gv_->name_hint << " to be known, but got " << output_shape;
+        output_axes_.push_back(FindAxis(shape->values));
+      }
+    } else {
+      LOG(FATAL) << "ValueError: BucketSymbolicDim requires the output shape of "
+                 << gv_->name_hint << " to be known, but got " << output_shape;
+    }
+  }
+
+  /*! \brief The axis the dimension is used at in the shape, or -1 if it is not used. */
+  int FindAxis(const Array<PrimExpr>& shape) const {
+    int axis = -1;
+    for (size_t i = 0; i < shape.size(); ++i) {
+      // Padding is only well defined when the dimension is a standalone extent of one axis.
+      if (shape[i].same_as(dim_) && axis == -1) {
+        axis = i;
+      } else {
+        auto is_dim = [this](const tir::VarNode* var) { return var == dim_.get(); };
+        CHECK(!tir::UsesVar(shape[i], is_dim))
+            << "ValueError: BucketSymbolicDim requires " << dim_
+            << " to be the extent of a single axis, but got shape " << shape;
+      }
+    }
+    return axis;
+  }
+
+  /*! \brief Add a Relax function to the module, named after its global symbol. */
+  GlobalVar AddFunction(const Function& func, const std::string& name_hint) {
+    Function named = WithAttr(func, tvm::attr::kGlobalSymbol, String(name_hint));
+    GlobalVar gv = builder_->AddFunction(named, name_hint);
+    if (gv->name_hint != name_hint) {
+      builder_->UpdateFunction(gv, WithAttr(func, tvm::attr::kGlobalSymbol, gv->name_hint));
+    }
+    return gv;
+  }
+
+  /*! \brief Emit the dispatch to the buckets starting from \p index. */
+  Expr EmitDispatch(size_t index) {
+    builder_->BeginBindingBlock();
+    Expr ret;
+    if (index == buckets_.size()) {
+      ret = builder_->Emit(Call(dynamic_gv_, Array<Expr>(params_.begin(), params_.end())), "ret");
+    } else {
+      const Var& ref = params_[inputs_[0].first];
+      ShapeExpr spec({Int(inputs_[0].second), Int(buckets_[index])});
+      Var fits = builder_->Emit(Call(ExternFunc("vm.builtin.fits_bucket"), {ref, spec}, Attrs(),
+                                     {DynTensorType(0, DataType::Bool())}),
+                                "fits");
+      Expr then_branch = EmitBucketCall(index);
+      Expr else_branch = EmitDispatch(index + 1);
+      If dispatch(fits, then_branch, else_branch);
+      dispatch->checked_type_ = func_->ret_type;
+      dispatch->shape_ = RuntimeDepShape();
+      ret = builder_->Emit(VarBinding(Var("ret", RuntimeDepShape(), func_->ret_type), dispatch));
+    }
+    BindingBlock block = builder_->EndBlock();
+    return builder_->Normalize(SeqExpr({block}, ret));
+  }
+
+  /*! \brief Emit the padding, the call to a bucket and the slicing of its outputs. */
+  Expr EmitBucketCall(size_t index) {
+    builder_->BeginBindingBlock();
+    Array<Expr> args(params_.begin(), params_.end());
+    for (const auto& input : inputs_) {
+      const Var& param = params_[input.first];
+      ShapeExpr spec({Int(input.second), Int(buckets_[index])});
+      args.Set(input.first, builder_->Emit(Call(ExternFunc("vm.builtin.pad_to_bucket"),
+                                                {param, spec}, Attrs(), {param->checked_type_}),
+                                           "padded"));
+    }
+    Var out = builder_->Emit(Call(bucket_gvs_[index], args), "out");
+    Expr ret;
+    if (!tuple_output_) {
+      ret = EmitUnpad(out, output_axes_[0], func_->ret_type);
+    } else {
+      const auto* ret_type = func_->ret_type.as<TupleTypeNode>();
+      ICHECK(ret_type != nullptr);
+      Array<Expr> fields;
+      for (size_t i = 0; i < output_axes_.size(); ++i) {
+        Var field = builder_->Emit(TupleGetItem(out, i), "field");
+        fields.push_back(EmitUnpad(field, output_axes_[i], ret_type->fields[i]));
+      }
+      ret = builder_->Emit(Tuple(fields), "ret");
+    }
+    BindingBlock block = builder_->EndBlock();
+    return builder_->Normalize(SeqExpr({block}, ret));
+  }
+
+  /*! \brief Slice the entries along \p axis back to the extent of the reference input. */
+  Expr EmitUnpad(const Var& out, int axis, Type type) {
+    if (axis == -1) return out;
+    ShapeExpr spec({Int(axis), Int(inputs_[0].second)});
+    return builder_->Emit(Call(ExternFunc("vm.builtin.unpad_from_bucket"),
+                               {out, spec, params_[inputs_[0].first]}, Attrs(), {type}),
+                          "unpadded");
+  }
+
+  static PrimExpr Int(int64_t value) { return IntImm(DataType::Int(64), value); }
+
+  /*! \brief The builder of the module. */
+  BlockBuilder builder_;
+  /*! \brief The function to specialize. */
+  GlobalVar gv_;
+  Function func_;
+  /*! \brief The sorted buckets. */
+  std::vector<int64_t> buckets_;
+  /*! \brief The symbolic dimension. */
+  tir::Var dim_;
+  /*! \brief The (parameter index, axis) pairs the dimension is used at. */
+  std::vector<std::pair<int, int>> inputs_;
+  /*! \brief The axis of the dimension in every output, -1 if an output does not use it. */
+  std::vector<int> output_axes_;
+  bool tuple_output_ = false;
+  /*! \brief The specialized functions and the dynamic fallback. */
+  std::vector<GlobalVar> bucket_gvs_;
+  GlobalVar dynamic_gv_;
+  /*! \brief The parameters of the dispatcher. */
+  Array<Var> params_;
+};
+
+/*!
+ * \brief Specialize a function of a module for the buckets of a symbolic dimension.
+ * \param mod The module.
+ * \param func_name The global symbol of the function.
+ * \param dim_name The name of the symbolic dimension in the parameter shapes.
+ * \param buckets The extents the dimension is specialized to.
+ * \return The module after specialization.
+ */
+IRModule BucketSymbolicDim(IRModule mod, String func_name, String dim_name,
+                           Array<Integer> buckets) {
+  std::vector<int64_t> sizes;
+  for (const Integer& bucket : buckets) {
+    CHECK_GT(bucket->value, 0) << "ValueError: The buckets must be positive, but got " << bucket;
+    sizes.push_back(bucket->value);
+  }
+  CHECK(!sizes.empty()) << "ValueError: BucketSymbolicDim expects at least one bucket";
+  std::sort(sizes.begin(), sizes.end());
+  sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+  for (const auto& func_pr : mod->functions) {
+    if (const auto* relax_f = func_pr.second.as<FunctionNode>()) {
+      Optional<String> gsymbol = relax_f->GetAttr<String>(tvm::attr::kGlobalSymbol);
+      if (gsymbol.defined() && gsymbol.value() == func_name) {
+        return SymbolicDimBucketer(mod, func_pr.first, GetRef<Function>(relax_f), dim_name,
+                                   std::move(sizes))
+            .Run();
+      }
+    }
+  }
+  LOG(FATAL) << "ValueError: Cannot find function " << func_name << " in the module";
+  return mod;
+}
+
+namespace transform {
+
+Pass BucketSymbolicDim(String func_name, String dim_name, Array<Integer> buckets) {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule mod, PassContext pc) {
+        return relax::BucketSymbolicDim(std::move(mod), func_name, dim_name, buckets);
+      };
+  return CreateModulePass(pass_func, 0, "BucketSymbolicDim", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.BucketSymbolicDim").set_body_typed(BucketSymbolicDim);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
@@ -20,10 +20,12 @@
  * \file src/relax/transform/call_tir_rewrite.cc
  * \brief Perform explicit tensor allocation for call_tir.
  */
+#include <tvm/relax/attrs/call_tir.h>
 #include <tvm/relax/attrs/memory.h>
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/transform.h>
 #include <tvm/relax/type.h>
+#include <tvm/tir/function.h>
 #include <tvm/tir/op.h>
 
 #include "../../relay/transforms/pattern_utils.h"
@@ -39,9 +41,17 @@ namespace relax {
 // -->
 // gv0 = rx.call("relax.builtin.alloc_tensor", [n, m], dtype="float32")
 // rx.call_packed(func, x, gv0)
+// An output computed in place on an input reuses the input tensor instead:
+// lv0: Tensor(n, m) = rx.call_tir(func, (x), (n, m), dtype="float32", inplace_indices=[0])
+// -->
+// rx.call_packed(func, x, x)
+// An output whose buffer is of another memory scope than the global one in the PrimFunc, e.g.
+// texture memory, is allocated in that scope.
 
 class CallTIRMutator : public ExprMutator {
  public:
+  explicit CallTIRMutator(IRModule mod) : mod_(mod) {}
+
   Expr VisitExpr_(const CallNode* call) override {
     // post-order mutation
     Expr expr = VisitExprPostOrder_(call);
@@ -53,16 +63,50 @@ class CallTIRMutator : public ExprMutator {
 
     if (call->op == call_tir_op) {
       Array<Expr> outs;
+      // The input tensor computed in place for the output, if any.
+      auto inplace_input = [call](size_t output_index) -> Optional<Expr> {
+        const auto* attrs = call->attrs.as<CallTIRInplaceAttrs>();
+        if (attrs == nullptr) return NullOpt;
+        ICHECK_LT(output_index, attrs->inplace_indices.size())
+            << "call_tir expects an inplace index per output, but got " << attrs->inplace_indices;
+        int64_t index = attrs->inplace_indices[output_index]->value;
+        if (index < 0) return NullOpt;
+        const auto* inputs = call->args[1].as<TupleNode>();
+        ICHECK(inputs != nullptr && index < static_cast<int64_t>(inputs->fields.size()))
+            << "The inplace index " << index << " of call_tir is out of its inputs";
+        return inputs->fields[index];
+      };
+      // The memory scope of the output buffer in the callee PrimFunc, if it is in the module.
+      auto output_scope = [this, call](size_t output_index) -> String {
+        const auto* gv = call->args[0].as<GlobalVarNode>();
+        if (gv == nullptr || !mod_.defined() || !mod_->ContainGlobalVar(gv->name_hint)) {
+          return "global";
+        }
+        const auto* func = mod_->Lookup(gv->name_hint).as<tir::PrimFuncNode>();
+        if (func == nullptr) return "global";
+        const auto* inputs = call->args[1].as<TupleNode>();
+        size_t index = (inputs != nullptr ? inputs->fields.size() : 1) + output_index;
+        if (index >= func->params.size()) return "global";
+        auto it = func->buffer_map.find(func->params[index]);
+        if (it == func->buffer_map.end()) return "global";
+        return (*it).second.scope();
+      };
+      // The VM device the outputs are allocated on.
+      const auto* device_attrs = call->attrs.as<CallTIRDeviceAttrs>();
+      int device_index = device_attrs != nullptr ? device_attrs->runtime_device_index : 0;
       if (call->shape_) {
         if (call->shape_.value()->IsInstance<ShapeExprNode>()) {
           // single output case
           ShapeExpr output_shape = Downcast<ShapeExpr>(call->shape_.value());
           auto alloc_tensor_attr = make_object<AllocTensorAttrs>();
 
-          if (call->checked_type_.defined()) {
+          if (Optional<Expr> input = inplace_input(0)) {
+            outs.push_back(input.value());
+          } else if (call->checked_type_.defined()) {
             auto output_type = Downcast<DynTensorType>(call->checked_type_);
             alloc_tensor_attr->dtype = output_type->dtype;
-            alloc_tensor_attr->runtime_device_index = 0;
+            alloc_tensor_attr->runtime_device_index = device_index;
+            alloc_tensor_attr->mem_scope = output_scope(0);
             outs.push_back(builder_->Emit(
                 Call(alloc_tensor_op, {output_shape}, Attrs(alloc_tensor_attr)), "alloc"));
           } else {
@@ -87,10 +131,15 @@ class CallTIRMutator : public ExprMutator {
             ICHECK(output_types->fields[i]->IsInstance<DynTensorTypeNode>())
                 << "call_tir expects TupleType of DynTensorType, but got "
                 << output_types->fields[i] << " as an element of TupleType";
+            if (Optional<Expr> input = inplace_input(i)) {
+              outs.push_back(input.value());
+              continue;
+            }
             auto output_type = Downcast<DynTensorType>(output_types->fields[i]);
             auto alloc_tensor_attr = make_object<AllocTensorAttrs>();
             alloc_tensor_attr->dtype = output_type->dtype;
-            alloc_tensor_attr->runtime_device_index = 0;
+            alloc_tensor_attr->runtime_device_index = device_index;
+            alloc_tensor_attr->mem_scope = output_scope(i);
             outs.push_back(builder_->Emit(
                 Call(alloc_tensor_op, {Downcast<ShapeExpr>(output_shapes->fields[i])},
                      Attrs(alloc_tensor_attr)),
@@ -127,15 +176,21 @@ class CallTIRMutator : public ExprMutator {
 
     return GetRef<Expr>(call);
   }
+
+ private:
+  /*! \brief The module holding the callee PrimFuncs. */
+  IRModule mod_;
 };
 
-Expr CallTIRRewrite(const Expr& e) { return CallTIRMutator().VisitExpr(e); }
+Expr CallTIRRewrite(const Expr& e, IRModule mod) { return CallTIRMutator(mod).VisitExpr(e); }
 
 namespace transform {
 
 Pass CallTIRRewrite() {
   runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
-      [=](Function f, IRModule m, PassContext pc) { return Downcast<Function>(CallTIRRewrite(f)); };
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(CallTIRRewrite(f, m));
+      };
   return CreateFunctionPass(pass_func, 0, "CallTIRRewrite", {});
 }
 
@@ -0,0 +1,255 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/collage_partition.cc
+ * \brief Offload the subgraphs of the dataflow blocks to the codegens, or keep them with TVM, by
+ * their measured latency, after the Collage search of src/relay/collage.
+ */
+#include <tvm/node/structural_equal.h>
+#include <tvm/node/structural_hash.h>
+
+#include <map>
+#include <queue>
+
+#include "pattern_fusor.h"
+
+namespace tvm {
+namespace relax {
+
+// ==================
+// CollagePartitioner
+// Every binding of a dataflow block is covered by a candidate: the matches of the patterns of the
+// codegens, the same bindings compiled by TVM, and every binding alone compiled by TVM. The cost of
+// a candidate is the latency of a module running its bindings only, given by the estimator and
+// cached by the structure of the module. The cheapest covering of the block by non-overlapping
+// candidates is found by a shortest path search whose states are the sets of covered bindings, a
+// step covering the first uncovered binding by a candidate of it, so every covering is reached
+// exactly once. The candidates of the codegens of the covering are grouped like FuseOpsByPattern
+// does, the other bindings are kept for FuseOps.
+
+class CollagePartitioner : public PatternFusor {
+ public:
+  explicit CollagePartitioner(IRModule mod, Array<String> pattern_names, Array<DFPattern> patterns,
+                              Array<String> codegens,
+                              runtime::TypedPackedFunc<double(IRModule)> estimate_latency)
+      : PatternFusor(mod, pattern_names, patterns,
+                     std::vector<Optional<String>>(codegens.begin(), codegens.end())),
+        estimate_latency_(std::move(estimate_latency)) {}
+
+ private:
+  /*! \brief The bindings run by a codegen, or by TVM when the pattern is -1. */
+  struct Candidate {
+    int pattern;
+    std::vector<int> members;
+    double cost;
+  };
+
+  /*! \brief A partial covering of the block, in the search. */
+  struct State {
+    double cost;
+    std::vector<bool> covered;
+  };
+
+  std::vector<Match> SelectMatches(const Array<Binding>& bindings) final {
+    int num_bindings = static_cast<int>(bindings.size());
+    BlockUses uses = AnalyzeUses(bindings);
+    std::vector<Match> pattern_matches;
+    for (int i = 0; i < num_bindings; ++i) {
+      const auto* var_binding = bindings[i].as<VarBindingNode>();
+      if (var_binding == nullptr || !var_binding->value->IsInstance<CallNode>()) continue;
+      for (int p : table_.GetCandidates(var_binding->value)) {
+        Match match;
+        if (MatchAt(bindings, uses, i, p, &match)) pattern_matches.push_back(std::move(match));
+      }
+    }
+    // Nothing to measure when everything runs with TVM.
+    if (pattern_matches.empty()) return {};
+
+    // The candidates covering each binding first, i.e. of which it is the smallest member.
+    std::vector<std::vector<Candidate>> candidates_of(num_bindings);
+    std::set<std::vector<int>> tvm_groups;
+    auto f_add = [&](int pattern, std::vector<int> members) {
+      double cost = Cost(bindings, pattern, members);
+      candidates_of[members.front()].push_back(Candidate{pattern, std::move(members), cost});
+    };
+    for (int i = 0; i < num_bindings; ++i) {
+      const auto* var_binding = bindings[i].as<VarBindingNode>();
+      if (var_binding != nullptr && var_binding->value->IsInstance<CallNode>()) {
+        f_add(-1, {i});
+      } else {
+        // The other bindings are free with TVM.
+        candidates_of[i].push_back(Candidate{-1, {i}, 0.0});
+      }
+    }
+    for (const Match& match : pattern_matches) {
+      f_add(match.pattern, match.members);
+      if (match.members.size() > 1 && tvm_groups.insert(match.members).second) {
+        f_add(-1, match.members);
+      }
+    }
+
+    // The cheapest covering, the states keyed by their covered bindings.
+    std::map<std::vector<bool>, double> best_cost;
+    std::map<std::vector<bool>, std::pair<std::vector<bool>, const Candidate*>> best_step;
+    auto f_greater = [](const State& lhs, const State& rhs) { return lhs.cost > rhs.cost; };
+    std::priority_queue<State, std::vector<State>, decltype(f_greater)> queue(f_greater);
+    std::vector<bool> start(num_bindings, false);
+    best_cost[start] = 0.0;
+    queue.push(State{0.0, start});
+    std::vector<bool> done;
+    while (!queue.empty()) {
+      State state = queue.top();
+      queue.pop();
+      if (state.cost > best_cost[state.covered]) continue;
+      auto first = std::find(state.covered.begin(), state.covered.end(), false);
+      if (first == state.covered.end()) {
+        done = state.covered;
+        break;
+      }
+      for (const Candidate& candidate : candidates_of[first - state.covered.begin()]) {
+        if (std::any_of(candidate.members.begin(), candidate.members.end(),
+                        [&state](int index) { return state.covered[index]; })) {
+          continue;
+        }
+        State next{state.cost + candidate.cost, state.covered};
+        for (int index : candidate.members) next.covered[index] = true;
+        auto it = best_cost.find(next.covered);
+        if (it != best_cost.end() && it->second <= next.cost) continue;
+        best_cost[next.covered] = next.cost;
+        best_step[next.covered] = {state.covered, &candidate};
+        queue.push(std::move(next));
+      }
+    }
+    // Every binding has a candidate of its own, so the block is always covered.
+    ICHECK_EQ(done.size(), bindings.size());
+
+    std::vector<Match> matches;
+    for (std::vector<bool> covered = done; covered != start;) {
+      const auto& step = best_step.at(covered);
+      const Candidate* candidate = step.second;
+      if (candidate->pattern >= 0) matches.push_back(Match{candidate->pattern, candidate->members});
+      VLOG(1) << "CollagePartition runs the bindings " << candidate->members.front() << ".."
+              << candidate->members.back() << " with "
+              << (candidate->pattern >= 0 ? pattern_names_[candidate->pattern] : String("TVM"))
+              << " in " << candidate->cost << "s";
+      covered = step.first;
+    }
+    return matches;
+  }
+
+  /*! \brief The latency of the candidate module of the bindings \p members, cached. */
+  double Cost(const Array<Binding>& bindings, int pattern, const std::vector<int>& members) {
+    IRModule mod = CandidateModule(bindings, pattern, members);
+    auto it = costs_.find(mod);
+    if (it != costs_.end()) return it->second;
+    double cost = estimate_latency_(mod);
+    costs_[mod] = cost;
+    return cost;
+  }
+
+  /*!
+   * \brief The module whose main function runs the bindings \p members only, with the codegen of
+   * \p pattern, or with TVM when it is -1, along with the global functions the bindings call.
+   */
+  IRModule CandidateModule(const Array<Binding>& bindings, int pattern,
+                           const std::vector<int>& members) {
+    Array<Expr> arguments;
+    Function func;
+    if (pattern >= 0) {
+      func = CreateCompositeFunction(bindings, Match{pattern, members}, &arguments);
+    } else {
+      // The bindings run with TVM, which fuses them later on.
+      std::vector<VarBinding> var_bindings;
+      for (int index : members) var_bindings.push_back(Downcast<VarBinding>(bindings[index]));
+      func = CompositeFunctionCreator().Create(var_bindings, &arguments);
+    }
+    BlockBuilder bb = BlockBuilder::Create(IRModule());
+    if (pattern >= 0 && codegens_[pattern].defined()) {
+      Function wrapper = CreateCodegenFunction(func, codegens_[pattern].value());
+      GlobalVar gv = bb->AddFunction(wrapper, FunctionName(pattern));
+      bb->UpdateFunction(gv, WithAttr(std::move(wrapper), tvm::attr::kGlobalSymbol,
+                                      String(gv->name_hint)));
+      // The main function calls the offloaded function.
+      Array<Var> params;
+      for (const Var& param : func->params) {
+        Var new_param(param->name_hint(), NullOpt, param->checked_type_);
+        new_param->shape_ = param->shape_;
+        params.push_back(new_param);
+      }
+      bb->BeginDataflowBlock();
+      Var output = bb->EmitOutput(Call(gv, Array<Expr>(params.begin(), params.end())));
+      BindingBlock block = bb->EndBlock();
+      Expr body = bb->Normalize(SeqExpr({block}, output));
+      func = Function(params, body, body->checked_type_, DictAttrs());
+    } else if (pattern >= 0) {
+      // The composite function runs with TVM.
+      func = Function(func->params, func->body, func->ret_type, DictAttrs());
+    }
+    func = WithAttr(std::move(func), tvm::attr::kGlobalSymbol, String("main"));
+    bb->AddFunction(func, "main");
+    IRModule mod = bb->GetContextIRModule();
+
+    // The global functions called by the bindings, e.g. the PrimFuncs of the call_tirs.
+    std::vector<BaseFunc> worklist{func};
+    while (!worklist.empty()) {
+      BaseFunc base_func = worklist.back();
+      worklist.pop_back();
+      const auto* relax_func = base_func.as<FunctionNode>();
+      if (relax_func == nullptr) continue;
+      PostOrderVisit(relax_func->body, [&](const Expr& e) {
+        const auto* gv = e.as<GlobalVarNode>();
+        if (gv == nullptr || mod->ContainGlobalVar(gv->name_hint) ||
+            !mod_->ContainGlobalVar(gv->name_hint)) {
+          return;
+        }
+        BaseFunc callee = mod_->Lookup(gv->name_hint);
+        mod->Add(GetRef<GlobalVar>(gv), callee);
+        worklist.push_back(callee);
+      });
+    }
+    return mod;
+  }
+
+  /*! \brief The estimator of the latency in seconds of a module, of its main function. */
+  runtime::TypedPackedFunc<double(IRModule)> estimate_latency_;
+  /*! \brief The latency of the candidate modules estimated so far. */
+  std::unordered_map<IRModule, double, StructuralHash, StructuralEqual> costs_;
+};
+
+namespace transform {
+
+Pass CollagePartition(Array<String> pattern_names, Array<DFPattern> patterns,
+                      Array<String> codegens,
+                      runtime::TypedPackedFunc<double(IRModule)> estimate_latency) {
+  CHECK_EQ(codegens.size(), patterns.size())
+      << "ValueError: Every pattern of CollagePartition requires a codegen";
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule m, PassContext pc) {
+        return CollagePartitioner(m, pattern_names, patterns, codegens, estimate_latency)
+            .Transform();
+      };
+  return CreateModulePass(pass_func, 0, "CollagePartition", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.CollagePartition").set_body_typed(CollagePartition);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
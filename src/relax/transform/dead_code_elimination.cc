@@ -0,0 +1,129 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/dead_code_elimination.cc
+ * \brief Remove the bindings of dataflow blocks whose results are never used.
+ */
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+// ==================
+// DeadCodeEliminator
+// Dataflow blocks are side-effect free, so a binding of a dataflow var that no other binding
+// and no output of the block uses can be removed, and so on transitively.
+// Example:
+// with R.dataflow():
+//   lv0 = R.call_tir(exp, (x,), (n, m), dtype="float32")
+//   lv1 = R.call_tir(relu, (x,), (n, m), dtype="float32")
+//   gv = R.call_tir(log, (lv1,), (n, m), dtype="float32")
+//   R.output(gv)
+// -->
+// with R.dataflow():
+//   lv1 = R.call_tir(relu, (x,), (n, m), dtype="float32")
+//   gv = R.call_tir(log, (lv1,), (n, m), dtype="float32")
+//   R.output(gv)
+
+class DeadCodeEliminator : public ExprMutator {
+ public:
+  BindingBlock VisitBindingBlock_(const DataflowBlockNode* block) final {
+    std::unordered_set<const VarNode*> dead = FindDeadVars(GetRef<DataflowBlock>(block));
+    builder_->BeginDataflowBlock();
+    for (const Binding& binding : block->bindings) {
+      if (const auto* var_binding = binding.as<VarBindingNode>()) {
+        if (dead.count(var_binding->var.get())) continue;
+      }
+      this->VisitBinding(binding);
+    }
+    return builder_->EndBlock();
+  }
+
+ private:
+  /*! \brief Collect the distinct vars an expression refers to. */
+  static std::unordered_set<const VarNode*> UsedVars(const Expr& expr) {
+    std::unordered_set<const VarNode*> vars;
+    PostOrderVisit(expr, [&vars](const Expr& e) {
+      if (const auto* var = e.as<VarNode>()) vars.insert(var);
+    });
+    return vars;
+  }
+
+  /*! \brief Find the dataflow vars of the block that do not contribute to its outputs. */
+  static std::unordered_set<const VarNode*> FindDeadVars(const DataflowBlock& block) {
+    Map<Var, Array<Var>> users = UseDefChain(block);
+    Map<Var, Expr> values = AnalyzeVar2Value(block);
+    std::unordered_map<const VarNode*, size_t> num_users;
+    for (const auto& kv : users) {
+      num_users[kv.first.get()] = kv.second.size();
+    }
+    // The use-def chain only records the uses by var bindings, a var matched by a match_shape
+    // is kept alive by it.
+    for (const Binding& binding : block->bindings) {
+      if (const auto* match_shape = binding.as<MatchShapeNode>()) {
+        for (const VarNode* var : UsedVars(match_shape->value)) ++num_users[var];
+      }
+    }
+
+    std::vector<const VarNode*> worklist;
+    for (const auto& kv : values) {
+      const VarNode* var = kv.first.get();
+      if (var->IsInstance<DataflowVarNode>() && num_users[var] == 0) worklist.push_back(var);
+    }
+    std::unordered_set<const VarNode*> dead;
+    while (!worklist.empty()) {
+      const VarNode* var = worklist.back();
+      worklist.pop_back();
+      if (!dead.insert(var).second) continue;
+      for (const VarNode* input : UsedVars(values[GetRef<Var>(var)])) {
+        auto it = num_users.find(input);
+        if (it == num_users.end() || --it->second != 0) continue;
+        if (input->IsInstance<DataflowVarNode>() && values.count(GetRef<Var>(input))) {
+          worklist.push_back(input);
+        }
+      }
+    }
+    return dead;
+  }
+};
+
+Expr DeadCodeElimination(const Expr& e) { return DeadCodeEliminator().VisitExpr(e); }
+
+namespace transform {
+
+Pass DeadCodeElimination() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(relax::DeadCodeElimination(f));
+      };
+  return CreateFunctionPass(pass_func, 0, "DeadCodeElimination", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.DeadCodeElimination").set_body_typed(DeadCodeElimination);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/eliminate_common_subexpr.cc
+ * \brief Reuse the result of an earlier binding of the same value in a dataflow block.
+ */
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+
+#include <unordered_map>
+
+namespace tvm {
+namespace relax {
+
+// ==================
+// CommonSubexprEliminator
+// Dataflow blocks are side-effect free, so a binding whose value is structurally equal to the
+// value of an earlier binding of the same block reuses the earlier var. The duplicate binding of
+// a dataflow var is dropped, the one of an output var binds the earlier var.
+// Example:
+// with R.dataflow():
+//   lv0 = R.call_tir(exp, (x,), (n, m), dtype="float32")
+//   lv1 = R.call_tir(exp, (x,), (n, m), dtype="float32")
+//   gv = R.call_tir(add, (lv0, lv1), (n, m), dtype="float32")
+//   R.output(gv)
+// -->
+// with R.dataflow():
+//   lv0 = R.call_tir(exp, (x,), (n, m), dtype="float32")
+//   gv = R.call_tir(add, (lv0, lv0), (n, m), dtype="float32")
+//   R.output(gv)
+
+class CommonSubexprEliminator : public ExprMutator {
+ public:
+  BindingBlock VisitBindingBlock_(const DataflowBlockNode* block) final {
+    // A function nested in the block has its own blocks, the table of this one is restored
+    // after them.
+    ValueTable outer_table = std::move(table_);
+    bool outer_in_dataflow = in_dataflow_;
+    table_.clear();
+    in_dataflow_ = true;
+    BindingBlock ret = ExprMutator::VisitBindingBlock_(block);
+    table_ = std::move(outer_table);
+    in_dataflow_ = outer_in_dataflow;
+    return ret;
+  }
+
+  BindingBlock VisitBindingBlock_(const BindingBlockNode* block) final {
+    bool outer_in_dataflow = in_dataflow_;
+    in_dataflow_ = false;
+    BindingBlock ret = ExprMutator::VisitBindingBlock_(block);
+    in_dataflow_ = outer_in_dataflow;
+    return ret;
+  }
+
+  void VisitBinding_(const VarBindingNode* binding) final {
+    if (!in_dataflow_ || !IsCandidate(binding->value)) {
+      ExprMutator::VisitBinding_(binding);
+      return;
+    }
+    Expr new_value = this->VisitExpr(binding->value);
+    auto it = table_.find(new_value);
+    if (it == table_.end()) {
+      Var new_var = this->VisitVarDef(binding->var);
+      table_.emplace(new_value, new_var);
+      ReEmit(binding, new_var, new_value);
+      return;
+    }
+    if (binding->var->IsInstance<DataflowVarNode>()) {
+      var_remap_[binding->var->vid] = it->second;
+      return;
+    }
+    ReEmit(binding, this->VisitVarDef(binding->var), it->second);
+  }
+
+ private:
+  using ValueTable = std::unordered_map<Expr, Var, StructuralHash, StructuralEqual>;
+
+  /*! \brief Whether a value is worth deduplicating, i.e. it computes something. */
+  static bool IsCandidate(const Expr& value) {
+    return value->IsInstance<CallNode>() || value->IsInstance<TupleNode>() ||
+           value->IsInstance<TupleGetItemNode>() || value->IsInstance<ShapeExprNode>();
+  }
+
+  void ReEmit(const VarBindingNode* binding, Var var, Expr value) {
+    if (!var.same_as(binding->var) || !value.same_as(binding->value)) {
+      Var temp = WithShapeAndType(var, value->shape_, value->checked_type_);
+      if (!temp.same_as(var)) {
+        var = temp;
+        var_remap_[binding->var->vid] = var;
+      }
+    }
+    VarBinding new_binding(var, value, binding->span);
+    if (var->IsInstance<DataflowVarNode>()) {
+      builder_->Emit(new_binding);
+    } else {
+      builder_->EmitOutput(new_binding);
+    }
+  }
+
+  /*! \brief The vars bound to each value in the current dataflow block. */
+  ValueTable table_;
+  /*! \brief Whether the bindings being visited belong to a dataflow block. */
+  bool in_dataflow_{false};
+};
+
+Expr EliminateCommonSubexpr(const Expr& e) { return CommonSubexprEliminator().VisitExpr(e); }
+
+namespace transform {
+
+Pass EliminateCommonSubexpr() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(relax::EliminateCommonSubexpr(f));
+      };
+  return CreateFunctionPass(pass_func, 0, "EliminateCommonSubexpr", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.EliminateCommonSubexpr")
+    .set_body_typed(EliminateCommonSubexpr);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
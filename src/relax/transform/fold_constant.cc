@@ -17,23 +17,131 @@
  * under the License.
  */
 
+#include <dmlc/memory_io.h>
 #include <tvm/driver/driver_api.h>
 #include <tvm/ir/function.h>
 #include <tvm/relax/attrs/memory.h>
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/transform.h>
 #include <tvm/relax/type.h>
+#include <tvm/runtime/relax_vm/memory_manager.h>
 #include <tvm/tir/function.h>
 #include <tvm/tir/op.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../../runtime/file_utils.h"
+
 namespace tvm {
 namespace relax {
 
 class ConstantFolder : public ExprMutator {
  public:
-  explicit ConstantFolder(IRModule ctx_module) : ctx_module_(ctx_module) {}
+  /*!
+   * \brief Create a folder.
+   * \param ctx_module The module to look the PrimFuncs up.
+   * \param cache_dir The directory caching the folded tensors, empty to disable the cache.
+   */
+  explicit ConstantFolder(IRModule ctx_module, std::string cache_dir = "")
+      : ctx_module_(ctx_module), cache_dir_(std::move(cache_dir)) {}
+
+  /*!
+   * \brief Fold the constants of a function. The PrimFuncs that may be evaluated are built
+   *  together in a single module when the first of them is needed.
+   */
+  Function Fold(const Function& func) {
+    CollectCandidates(func);
+    return Downcast<Function>(VisitExpr(func));
+  }
 
  private:
+  /*!
+   * \brief Collect the PrimFuncs of the call_tirs whose inputs are constants, or become
+   *  constants once the earlier call_tirs are folded.
+   */
+  class CandidateCollector : public ExprVisitor {
+   public:
+    explicit CandidateCollector(ConstantFolder* folder) : folder_(folder) {}
+
+    void VisitBinding_(const VarBindingNode* binding) final {
+      ExprVisitor::VisitBinding_(binding);
+      if (binding->value->IsInstance<ConstantNode>()) {
+        foldable_vars_.insert(binding->var.get());
+        return;
+      }
+      static const Op& call_tir_op = Op::Get("relax.call_tir");
+      const auto* call = binding->value.as<CallNode>();
+      if (call == nullptr || !call->op.same_as(call_tir_op) || call->args.size() < 3 ||
+          call->type_args.size() != 1 || !MatchConstShape(call->args[2])) {
+        return;
+      }
+      Optional<tir::PrimFunc> func = folder_->MatchPrimFunc(call->args[0]);
+      const auto* inputs = call->args[1].as<TupleNode>();
+      if (!func || inputs == nullptr) return;
+      for (const Expr& input : inputs->fields) {
+        if (!input->IsInstance<ConstantNode>() && !foldable_vars_.count(input.get())) return;
+      }
+      foldable_vars_.insert(binding->var.get());
+      funcs.push_back(func.value());
+    }
+
+    /*! \brief The PrimFuncs in binding order, may have duplicates. */
+    std::vector<tir::PrimFunc> funcs;
+
+   private:
+    ConstantFolder* folder_;
+    std::unordered_set<const Object*> foldable_vars_;
+  };
+
+  /*! \brief Collect the PrimFuncs that may be folded in \p func into pending_funcs_. */
+  void CollectCandidates(const Function& func) {
+    CandidateCollector collector(this);
+    collector(func);
+    std::unordered_set<tir::PrimFunc, StructuralHash, StructuralEqual> seen;
+    for (const tir::PrimFunc& candidate : collector.funcs) {
+      if (!func_build_cache_.count(candidate) && seen.insert(candidate).second) {
+        pending_funcs_.push_back(candidate);
+      }
+    }
+  }
+
+  /*!
+   * \brief Build the pending PrimFuncs as one module, so that the code generator runs once
+   *  rather than once per PrimFunc. Nothing is built when every result is cached on disk.
+   */
+  void BuildPendingFuncs() {
+    std::vector<tir::PrimFunc> funcs = std::move(pending_funcs_);
+    pending_funcs_.clear();
+    // A single function is built by GetCachedBuild.
+    if (funcs.size() <= 1) return;
+
+    Target eval_cpu_target{"llvm"};
+    IRModule batch;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < funcs.size(); ++i) {
+      names.push_back("tir_function_" + std::to_string(i));
+      batch->Update(LowerPrimFunc(funcs[i], names.back()));
+    }
+    try {
+      runtime::Module rt_module = build(batch, eval_cpu_target, eval_cpu_target);
+      for (size_t i = 0; i < funcs.size(); ++i) {
+        func_build_cache_[funcs[i]] = rt_module.GetFunction(names[i]);
+      }
+    } catch (const tvm::Error& err) {
+      // Some function cannot be built for the CPU, GetCachedBuild builds the others one by one
+      // and skips the failing ones.
+      DLOG(WARNING) << "Batch build failure of " << funcs.size()
+                    << " functions, Error message: " << err.what();
+    }
+  }
+
   /*!
    * \brief Pattern match expr to a constant shape and get runtime shape tuple from it.
    * \return The runtime shape tuple, or nullopt if it is not a constant shape.
@@ -85,11 +193,15 @@ class ConstantFolder : public ExprMutator {
    * \return The cached func, nullopt if func cannot be built.
    */
   Optional<PackedFunc> GetCachedBuild(tir::PrimFunc func) {
-    // TODO(tvm-team): consider another way of bulk extract and build PrimFunc once
-    // would be helpful for future cases where PrimFunc recursively call into each other
+    // The PrimFuncs found by BuildCandidates are already in the cache, the others, e.g. those
+    // whose batch build failed, are built one by one.
     Target eval_cpu_target{"llvm"};
 
     auto it = func_build_cache_.find(func);
+    if (it == func_build_cache_.end() && !pending_funcs_.empty()) {
+      BuildPendingFuncs();
+      it = func_build_cache_.find(func);
+    }
     if (it != func_build_cache_.end()) {
       return it->second;
     }
@@ -111,10 +223,79 @@ class ConstantFolder : public ExprMutator {
     return build_func;
   }
 
+  /*!
+   * \brief Get the path caching the result of a call, from the structural hash of the PrimFunc
+   *  and a hash of the contents of the inputs and the type of the output.
+   */
+  std::string CachePath(const tir::PrimFunc& func, const Array<runtime::NDArray>& args,
+                        const runtime::ShapeTuple& shape, DataType ret_type) {
+    // FNV-1a, which is stable across processes unlike std::hash.
+    uint64_t hash = 14695981039346656037ULL;
+    auto update = [&hash](const void* data, size_t size) {
+      const auto* bytes = static_cast<const uint8_t*>(data);
+      for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+      }
+    };
+    auto update_type = [&update](const runtime::ShapeTuple& shape, DLDataType dtype) {
+      update(shape.data(), shape.size() * sizeof(int64_t));
+      update(&dtype, sizeof(dtype));
+    };
+    for (const runtime::NDArray& arg : args) {
+      update_type(arg.Shape(), arg->dtype);
+      update(static_cast<const char*>(arg->data) + arg->byte_offset,
+             runtime::GetDataSize(*arg.operator->()));
+    }
+    update_type(shape, ret_type);
+    std::ostringstream os;
+    os << cache_dir_ << "/" << std::hex << std::setfill('0') << std::setw(16)
+       << static_cast<uint64_t>(StructuralHash()(func)) << "_" << std::setw(16) << hash
+       << ".ndarray";
+    return os.str();
+  }
+
+  /*! \brief Load a folded tensor cached on disk, NullOpt if it is absent. */
+  static Optional<runtime::NDArray> LoadCachedResult(const std::string& path) {
+    if (!std::ifstream(path).good()) return NullOpt;
+    std::string data;
+    runtime::LoadBinaryFromFile(path, &data);
+    dmlc::MemoryStringStream strm(&data);
+    runtime::NDArray array;
+    if (!array.Load(&strm)) return NullOpt;
+    return array;
+  }
+
+  /*! \brief Cache a folded tensor on disk, replacing the file atomically. */
+  static void SaveCachedResult(const std::string& path, const runtime::NDArray& array) {
+    std::string data;
+    {
+      dmlc::MemoryStringStream strm(&data);
+      array.Save(&strm);
+    }
+    std::string tmp_path = path + ".tmp";
+    runtime::SaveBinaryToFile(tmp_path, data);
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+      std::remove(tmp_path.c_str());
+      LOG(WARNING) << "Cannot write the constant folding cache file " << path;
+    }
+  }
+
   // Try constant evaluate the function call
   // if failed return NullOpt
   Optional<Expr> ConstEvaluateCallTIR(tir::PrimFunc tir_func, Array<runtime::NDArray> arr_args,
                                       runtime::ShapeTuple shape, DataType ret_type) {
+    std::string cache_path;
+    if (!cache_dir_.empty()) {
+      cache_path = CachePath(tir_func, arr_args, shape, ret_type);
+      Optional<runtime::NDArray> cached = LoadCachedResult(cache_path);
+      // The shape and dtype are checked to guard against hash collisions.
+      if (cached && std::equal(shape.begin(), shape.end(), cached.value().Shape().begin(),
+                               cached.value().Shape().end()) &&
+          DataType(cached.value()->dtype) == ret_type) {
+        return Constant(cached.value());
+      }
+    }
+
     // obtain function from the cache.
     Optional<PackedFunc> func = GetCachedBuild(tir_func);
     if (!func) return NullOpt;
@@ -124,7 +305,11 @@ class ConstantFolder : public ExprMutator {
     std::vector<int> type_codes(arr_args.size() + 1);
 
     DLDevice cpu_dev = {DLDeviceType::kDLCPU, 0};
-    runtime::NDArray ret_tensor = runtime::NDArray::Empty(shape, ret_type, cpu_dev);
+    // The intermediate results of a chain of folds are recycled by the pooled allocator.
+    runtime::NDArray ret_tensor = runtime::NDArray::Empty(
+        shape, ret_type, cpu_dev,
+        runtime::relax_vm::MemoryManager::GetOrCreateAllocator(cpu_dev,
+                                                               runtime::relax_vm::kPooled));
 
     // avoid set rvalue ref which get de-allocated later, store args in a vector
     // where temp_args[i] are lvalue ref that is stable
@@ -140,6 +325,7 @@ class ConstantFolder : public ExprMutator {
     TVMRetValue ret;
     // invoke
     func.value().CallPacked(TVMArgs(values.data(), type_codes.data(), values.size()), &ret);
+    if (!cache_path.empty()) SaveCachedResult(cache_path, ret_tensor);
     return Constant(ret_tensor);
   }
 
@@ -194,6 +380,10 @@ class ConstantFolder : public ExprMutator {
 
   // the context module to lookup functions
   IRModule ctx_module_;
+  // the directory caching the folded tensors, empty if the cache is disabled
+  std::string cache_dir_;
+  // the PrimFuncs that may be folded and are not built yet
+  std::vector<tir::PrimFunc> pending_funcs_;
   // cache for function build, via structural equality
   std::unordered_map<tir::PrimFunc, Optional<runtime::PackedFunc>, StructuralHash, StructuralEqual>
       func_build_cache_;
@@ -201,11 +391,15 @@ class ConstantFolder : public ExprMutator {
 
 namespace transform {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.FoldConstant.cache_dir", String);
+
 Pass FoldConstant() {
   runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
       [=](Function f, IRModule m, PassContext pc) {
-        ConstantFolder folder(m);
-        return Downcast<Function>(folder(f));
+        String cache_dir =
+            pc->GetConfig<String>("relax.FoldConstant.cache_dir", String("")).value();
+        ConstantFolder folder(m, cache_dir);
+        return folder.Fold(f);
       };
   return CreateFunctionPass(pass_func, 0, "FoldConstant", {});
 }
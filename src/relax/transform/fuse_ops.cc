@@ -84,6 +84,7 @@ using support::LinkNode;
 constexpr uint32_t kMaxFusedOps = 256;
 
 TVM_REGISTER_PASS_CONFIG_OPTION("relax.FuseOps.max_depth", Integer);
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.FuseOps.fuse_reduction_chains", Bool);
 
 class GraphCreator : public ExprVisitor {
  public:
@@ -222,6 +223,13 @@ class GraphCreator : public ExprVisitor {
                  const OpPatternKind& pattern) {
     ICHECK_NOTNULL(binding_var_node);
 
+    // Functions and shapes are not dataflow values, e.g. the step function of a scan, there is
+    // nothing to fuse them with.
+    if (leaf_expr->IsInstance<GlobalVarNode>() || leaf_expr->IsInstance<ShapeExprNode>() ||
+        leaf_expr->IsInstance<ExternFuncNode>() || leaf_expr->IsInstance<OpNode>()) {
+      return;
+    }
+
     // Recursive visit if it's Tuple
     if (const auto* tuple = leaf_expr.as<TupleNode>()) {
       for (const Expr& expr : tuple->fields) {
@@ -473,8 +481,7 @@ class FunctionCreator : public ExprMutator {
    */
   void CheckDefAndUpdateParam(const Expr& expr) {
     // If the expression has already served as an argument, no need to create another one for it.
-    auto it = std::find(arguments_.begin(), arguments_.end(), expr);
-    if (it != arguments_.end()) {
+    if (argument_index_.count(expr.get())) {
       return;
     }
 
@@ -493,6 +500,7 @@ class FunctionCreator : public ExprMutator {
                 /*shape_annotation=*/NullOpt,  //
                 /*type_annotation=*/expr->checked_type_);
       param->shape_ = expr->shape_;
+      argument_index_[expr.get()] = arguments_.size();
       arguments_.push_back(expr);
       params_.push_back(param);
     }
@@ -500,15 +508,17 @@ class FunctionCreator : public ExprMutator {
 
   Expr VisitExpr(const Expr& expr) final {
     // If the expression serves as an argument, return its correspondng parameter.
-    auto it = std::find(arguments_.begin(), arguments_.end(), expr);
-    if (it != arguments_.end()) {
-      return params_[it - arguments_.begin()];
+    auto it = argument_index_.find(expr.get());
+    if (it != argument_index_.end()) {
+      return params_[it->second];
     }
     // Otherwise, recurse into this expression.
     return ExprMutator::VisitExpr(expr);
   }
 
  private:
+  /*! \brief The map from each argument to its index, to look the arguments up in constant time */
+  std::unordered_map<const Object*, size_t> argument_index_;
   /*! \brief The variables defined in this function */
   std::unordered_set<const VarNode*> defined_vars_;
   /*! \brief The number of parameters reserved for constants */
@@ -758,7 +768,7 @@ class OperatorFusor : public ExprMutator {
   std::unordered_map<GraphPartitioner::Group*, FunctionCreator> group2func_;
 };
 
-IRModule FuseOps(IRModule mod, int opt_level, size_t max_fuse_depth) {
+IRModule FuseOps(IRModule mod, int opt_level, size_t max_fuse_depth, bool fuse_reduction_chains) {
   support::Arena arena;
 
   // Step 1. Create the indexed-forward graph according to the input IRModule.
@@ -766,7 +776,7 @@ IRModule FuseOps(IRModule mod, int opt_level, size_t max_fuse_depth) {
 
   // Step 2. Partition the graph by applying the fusion algorithm.
   std::vector<GraphPartitioner::Group*> groups =
-      GraphPartitioner(&arena, opt_level, max_fuse_depth).Partition(graph);
+      GraphPartitioner(&arena, opt_level, max_fuse_depth, fuse_reduction_chains).Partition(graph);
 
   // Step 3. Transform the IRModule by fusing the operators in accordance with the graph partition
   // results.
@@ -782,7 +792,10 @@ Pass FuseOps(int fuse_opt_level) {
       [=](IRModule m, PassContext pc) {
         int opt_level = fuse_opt_level == -1 ? pc->opt_level : fuse_opt_level;
         auto max_fuse_depth = pc->GetConfig("relax.FuseOps.max_depth", Integer(kMaxFusedOps));
-        return relax::FuseOps(m, opt_level, max_fuse_depth.value().IntValue());
+        bool fuse_reduction_chains =
+            pc->GetConfig("relax.FuseOps.fuse_reduction_chains", Bool(true)).value();
+        return relax::FuseOps(m, opt_level, max_fuse_depth.value().IntValue(),
+                              fuse_reduction_chains);
       };
   return CreateModulePass(/*pass_function=*/pass_func,  //
                           /*opt_level=*/0,              //
@@ -792,6 +805,17 @@ Pass FuseOps(int fuse_opt_level) {
 
 TVM_REGISTER_GLOBAL("relax.transform.FuseOps").set_body_typed(FuseOps);
 
+// The transformation of a fusion choice of the tuning API: FuseOps with the given settings rather
+// than the ones of the pass context, then FuseTIR, so that a candidate is evaluated by the
+// latency of its fused kernels.
+TVM_REGISTER_GLOBAL("relax.tuning_api.fuse_ops")
+    .set_body_typed([](IRModule mod, Integer opt_level, Integer max_fuse_depth,
+                       Bool fuse_reduction_chains) {
+      mod = relax::FuseOps(mod, opt_level.IntValue(), max_fuse_depth.IntValue(),
+                           fuse_reduction_chains.operator bool());
+      return FuseTIR()(mod);
+    });
+
 }  // namespace transform
 
 }  // namespace relax
@@ -0,0 +1,46 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/fuse_ops_by_pattern.cc
+ * \brief Group the bindings matched by dataflow patterns into composite functions, optionally
+ * annotated with the codegen which offloads them.
+ */
+#include "pattern_fusor.h"
+
+namespace tvm {
+namespace relax {
+
+namespace transform {
+
+Pass FuseOpsByPattern(Array<String> pattern_names, Array<DFPattern> patterns,
+                      Optional<String> codegen) {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule m, PassContext pc) {
+        std::vector<Optional<String>> codegens(patterns.size(), codegen);
+        return PatternFusor(m, pattern_names, patterns, codegens).Transform();
+      };
+  return CreateModulePass(pass_func, 0, "FuseOpsByPattern", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.FuseOpsByPattern").set_body_typed(FuseOpsByPattern);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
@@ -18,8 +18,13 @@
  */
 #include <tvm/relax/expr_functor.h>
 #include <tvm/relax/transform.h>
+#include <tvm/tir/schedule/schedule.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
 #include "../../relay/analysis/graph_partitioner.h"
 #include "../../support/arena.h"
 #include "../../tir/ir/functor_common.h"
@@ -212,6 +217,47 @@ class BlockNameDeduplicator : public tir::StmtMutator {
   std::unordered_map<String, int> name_count_;
 };
 
+/*!
+ * \brief Compute the blocks of a fused reduction chain, e.g. a softmax or a layer norm, at the
+ * outermost loop of its last block, so that an iteration computes a row from end to end. Once the
+ * buffer allocations are compacted, the intermediate buffers hold a row, which stays in registers
+ * or shared memory instead of making a pass over the global memory per reduction.
+ * \param func The fused function.
+ * \return The localized function, or \p func if it holds less than two reductions or its blocks
+ * cannot be computed at a common loop, e.g. the reductions are over different axes.
+ */
+PrimFunc LocalizeReductionChain(const PrimFunc& func) {
+  int num_reductions = 0;
+  PreOrderVisit(func->body, [&num_reductions](const ObjectRef& obj) {
+    if (const auto* block = obj.as<BlockNode>()) {
+      for (const IterVar& iter_var : block->iter_vars) {
+        if (iter_var->iter_type == kCommReduce) {
+          ++num_reductions;
+          break;
+        }
+      }
+    }
+    return true;
+  });
+  if (num_reductions < 2) return func;
+
+  String name = func->GetAttr<String>(tvm::attr::kGlobalSymbol).value();
+  Schedule sch = Schedule::Concrete(IRModule({{GlobalVar(name), func}}), /*seed=*/-1,
+                                    /*debug_mask=*/0, ScheduleErrorRenderLevel::kNone);
+  try {
+    Array<BlockRV> blocks = sch->GetChildBlocks(sch->GetBlock("root", name));
+    Array<LoopRV> loops = sch->GetLoops(blocks.back());
+    if (loops.empty()) return func;
+    // Move the producers in reverse order, so that the consumers of each are already at the loop.
+    for (int i = static_cast<int>(blocks.size()) - 2; i >= 0; --i) {
+      sch->ComputeAt(blocks[i], loops[0], /*preserve_unit_loops=*/true);
+    }
+  } catch (const runtime::Error& e) {
+    return func;
+  }
+  return Downcast<PrimFunc>(sch->mod()->Lookup(name));
+}
+
 }  // namespace tir
 
 namespace relax {
@@ -601,19 +647,32 @@ class FusedTIRConstructor : public ExprVisitor {
  */
 class TIRFuseMutator : public ExprMutator {
  public:
-  static IRModule Transform(const IRModule& mod) {
+  static IRModule Transform(const IRModule& mod, bool localize_reduction_chains) {
     // Since TIRFuseMutator will delete bunch of PrimFunc, we create an empty block builder.
     TIRFuseMutator mutator(mod);
-    // Step 1. Fuse all primitive relax functions, store the result in `fused_tir_funcs_`
+    // Step 1. Fuse all primitive relax functions, store the result in `fused_tir_funcs_`.
+    // The fused functions which only differ in their global symbol, e.g. of identical layers
+    // calling copies of the same kernels, share the first one, so that they are added to the
+    // module, compiled and tuned once.
+    // The functions are visited by name, so that the kept one does not depend on hash order.
+    std::vector<GlobalVar> primitive_gvs;
     for (const auto& kv : mod->functions) {
-      const GlobalVar& gv = kv.first;
       const BaseFunc& func = kv.second;
       // Only fuse primitive relax functions
       if (func->IsInstance<relax::FunctionNode>() && func->HasNonzeroAttr(attr::kPrimitive)) {
-        tir::PrimFunc fused_tir = FusedTIRConstructor::GetFusedTIR(mod, gv);
-        mutator.fused_tir_funcs_.Set(gv, fused_tir);
+        primitive_gvs.push_back(kv.first);
       }
     }
+    std::sort(primitive_gvs.begin(), primitive_gvs.end(),
+              [](const GlobalVar& a, const GlobalVar& b) { return a->name_hint < b->name_hint; });
+    std::unordered_map<tir::PrimFunc, tir::PrimFunc, StructuralHash, StructuralEqual> dedup_map;
+    for (const GlobalVar& gv : primitive_gvs) {
+      tir::PrimFunc fused_tir = FusedTIRConstructor::GetFusedTIR(mod, gv);
+      if (localize_reduction_chains) fused_tir = tir::LocalizeReductionChain(fused_tir);
+      tir::PrimFunc key = WithoutAttr(fused_tir, tvm::attr::kGlobalSymbol);
+      fused_tir = dedup_map.emplace(key, fused_tir).first->second;
+      mutator.fused_tir_funcs_.Set(gv, fused_tir);
+    }
 
     // Step 2. Update all non-primitive relax functions and add it, with the dependent function,
     // into the new IRModule
@@ -692,16 +751,22 @@ class TIRFuseMutator : public ExprMutator {
   Map<GlobalVar, tir::PrimFunc> fused_tir_funcs_;
 };
 
-IRModule FuseTIR(IRModule mod) {
-  mod = TIRFuseMutator::Transform(mod);
+IRModule FuseTIR(IRModule mod, bool localize_reduction_chains) {
+  mod = TIRFuseMutator::Transform(mod, localize_reduction_chains);
   return mod;
 }
 
 namespace transform {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("relax.FuseTIR.localize_reduction_chains", Bool);
+
 Pass FuseTIR() {
   runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =  //
-      [=](IRModule m, PassContext pc) { return relax::FuseTIR(m); };
+      [=](IRModule m, PassContext pc) {
+        bool localize_reduction_chains =
+            pc->GetConfig("relax.FuseTIR.localize_reduction_chains", Bool(true)).value();
+        return relax::FuseTIR(m, localize_reduction_chains);
+      };
   return CreateModulePass(/*pass_function=*/pass_func,  //
                           /*opt_level=*/0,              //
                           /*pass_name=*/"FuseTIR",      //
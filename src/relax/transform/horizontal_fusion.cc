@@ -0,0 +1,257 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/horizontal_fusion.cc
+ * \brief Fuse the independent call_tirs of the same kernel in a dataflow block into one call.
+ */
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace tir {
+
+/*! \brief Append a suffix to the names of the blocks, keeping them unique in a fused kernel. */
+class BlockRenamer : public StmtMutator {
+ public:
+  explicit BlockRenamer(std::string suffix) : suffix_(std::move(suffix)) {}
+
+ private:
+  Stmt VisitStmt_(const BlockNode* op) final {
+    Block block = Downcast<Block>(StmtMutator::VisitStmt_(op));
+    block.CopyOnWrite()->name_hint = block->name_hint + suffix_;
+    return std::move(block);
+  }
+
+  std::string suffix_;
+};
+
+/*!
+ * \brief Fuse the calls of a kernel on different buffers into one kernel. The fused kernel takes
+ * the inputs of every call followed by their outputs, and runs an outer loop over the calls,
+ * whose iteration i runs the body of the kernel on the buffers of call i. Binding the loop to
+ * a thread axis makes the calls a single launch.
+ */
+PrimFunc HorizontallyFuse(const PrimFunc& func, int num_calls, const String& name) {
+  size_t num_inputs = func->params.size() - 1;
+  Array<Var> inputs;
+  Array<Var> outputs;
+  Map<Var, Buffer> buffer_map;
+  Array<Buffer> alloc_buffers;
+  std::vector<Stmt> bodies;
+  for (int i = 0; i < num_calls; ++i) {
+    PrimFunc copy = RenewDefs(func);
+    for (size_t j = 0; j < copy->params.size(); ++j) {
+      const Var& param = copy->params[j];
+      (j < num_inputs ? inputs : outputs).push_back(param);
+      buffer_map.Set(param, copy->buffer_map.at(param));
+    }
+    Block root = Downcast<BlockRealize>(copy->body)->block;
+    alloc_buffers.insert(alloc_buffers.end(), root->alloc_buffers.begin(),
+                         root->alloc_buffers.end());
+    bodies.push_back(BlockRenamer("_" + std::to_string(i))(root->body));
+  }
+
+  Var call_index("call_index", DataType::Int(32));
+  Stmt body = bodies.back();
+  for (int i = num_calls - 2; i >= 0; --i) {
+    body = IfThenElse(call_index == i, bodies[i], body);
+  }
+  body = For(call_index, 0, num_calls, ForKind::kSerial, body);
+  body = BlockRealize({}, Bool(true), Block({}, {}, {}, "root", body, NullOpt, alloc_buffers));
+
+  Array<Var> params = inputs;
+  params.insert(params.end(), outputs.begin(), outputs.end());
+  Map<String, ObjectRef> attrs;
+  attrs.Set("tir.noalias", const_true());
+  attrs.Set(tvm::attr::kGlobalSymbol, name);
+  return PrimFunc(params, body, VoidType(), buffer_map, NullOpt, DictAttrs(attrs));
+}
+
+}  // namespace tir
+
+namespace relax {
+
+// ==================
+// HorizontalFusor
+// Fuse the call_tirs of the same kernel in a dataflow block whose inputs are all defined before
+// the first of them, hence are independent of each other, into one call_tir of a kernel which
+// loops over the calls, so that they take a single launch.
+// Example:
+// lv0 = rx.call_tir(dense, (x, w0), (n, m), dtype="float32")
+// lv1 = rx.call_tir(dense, (x, w1), (n, m), dtype="float32")
+// -->
+// lv2 = rx.call_tir(fused_dense, (x, w0, x, w1), ((n, m), (n, m)), dtype=["float32", "float32"])
+// lv0 = lv2[0]
+// lv1 = lv2[1]
+
+class HorizontalFusor : public ExprMutator {
+ public:
+  explicit HorizontalFusor(IRModule mod) : ExprMutator(mod), mod_(mod) {}
+
+  IRModule Transform() {
+    for (const auto& kv : mod_->functions) {
+      if (const auto* func = kv.second.as<FunctionNode>()) {
+        if (func->HasNonzeroAttr(attr::kPrimitive)) continue;
+        Function new_func = Downcast<Function>(VisitExpr(GetRef<Function>(func)));
+        if (!new_func.same_as(kv.second)) builder_->UpdateFunction(kv.first, new_func);
+      }
+    }
+    return builder_->GetContextIRModule();
+  }
+
+  using ExprMutator::VisitBindingBlock_;
+
+  BindingBlock VisitBindingBlock_(const DataflowBlockNode* block) final {
+    std::vector<std::vector<int>> groups = CollectGroups(block->bindings);
+    if (groups.empty()) return ExprMutator::VisitBindingBlock_(block);
+    // The index of the group which each binding leads or is a later member of.
+    std::unordered_map<int, int> leader_of, member_of;
+    for (int g = 0; g < static_cast<int>(groups.size()); ++g) {
+      leader_of[groups[g][0]] = g;
+      for (int index : groups[g]) member_of[index] = g;
+    }
+
+    builder_->BeginDataflowBlock();
+    for (int i = 0; i < static_cast<int>(block->bindings.size()); ++i) {
+      auto it = leader_of.find(i);
+      if (it != leader_of.end()) {
+        EmitFusedCall(block->bindings, groups[it->second]);
+      } else if (!member_of.count(i)) {
+        VisitBinding(block->bindings[i]);
+      }
+    }
+    return builder_->EndBlock();
+  }
+
+ private:
+  /*! \brief Get the call_tir bound by \p binding if it can be fused, otherwise nullptr. */
+  const CallNode* GetFusibleCall(const Binding& binding) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    const auto* var_binding = binding.as<VarBindingNode>();
+    if (var_binding == nullptr) return nullptr;
+    const auto* call = var_binding->value.as<CallNode>();
+    if (call == nullptr || call->op != call_tir_op || call->attrs.defined() ||
+        call->args.size() != 3 || !call->args[1]->IsInstance<TupleNode>() ||
+        !call->args[2]->IsInstance<ShapeExprNode>()) {
+      return nullptr;
+    }
+    const auto* gv = call->args[0].as<GlobalVarNode>();
+    if (gv == nullptr) return nullptr;
+    auto it = mod_->functions.find(GetRef<GlobalVar>(gv));
+    if (it == mod_->functions.end()) return nullptr;
+    const auto* func = (*it).second.as<tir::PrimFuncNode>();
+    // Only schedulable kernels with one output are fused.
+    if (func == nullptr || !func->body->IsInstance<tir::BlockRealizeNode>() ||
+        func->params.size() != Downcast<Tuple>(call->args[1])->fields.size() + 1) {
+      return nullptr;
+    }
+    return call;
+  }
+
+  /*!
+   * \brief Group the fusible calls of each kernel, greedily in binding order. A call joins the
+   * open group of its kernel if its inputs are defined before the first call of the group.
+   * \return The indices of the bindings of each group of at least two calls.
+   */
+  std::vector<std::vector<int>> CollectGroups(const Array<Binding>& bindings) {
+    std::unordered_map<const VarNode*, int> def_index;
+    std::unordered_map<const GlobalVarNode*, std::vector<int>> open_groups;
+    std::vector<std::vector<int>> groups;
+    auto close = [&groups](std::vector<int>* group) {
+      if (group->size() >= 2) groups.push_back(std::move(*group));
+      group->clear();
+    };
+    for (int i = 0; i < static_cast<int>(bindings.size()); ++i) {
+      if (const CallNode* call = GetFusibleCall(bindings[i])) {
+        std::vector<int>& group = open_groups[call->args[0].as<GlobalVarNode>()];
+        bool independent = !group.empty();
+        for (const Expr& input : Downcast<Tuple>(call->args[1])->fields) {
+          auto it = def_index.find(input.as<VarNode>());
+          if (independent && it != def_index.end() && it->second >= group[0]) independent = false;
+        }
+        if (!independent) close(&group);
+        group.push_back(i);
+      }
+      if (const auto* var_binding = bindings[i].as<VarBindingNode>()) {
+        def_index[var_binding->var.get()] = i;
+      } else if (const auto* match_shape = bindings[i].as<MatchShapeNode>()) {
+        if (match_shape->var.defined()) def_index[match_shape->var.get()] = i;
+      }
+    }
+    for (auto& kv : open_groups) close(&kv.second);
+    return groups;
+  }
+
+  /*! \brief Emit the fused call of a group, and bind the vars of the calls to its outputs. */
+  void EmitFusedCall(const Array<Binding>& bindings, const std::vector<int>& group) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    const auto* first = Downcast<VarBinding>(bindings[group[0]])->value.as<CallNode>();
+    GlobalVar gv = Downcast<GlobalVar>(first->args[0]);
+    int num_calls = static_cast<int>(group.size());
+
+    Array<Expr> inputs;
+    Array<Expr> shapes;
+    Array<Type> types;
+    for (int index : group) {
+      const auto* call = Downcast<VarBinding>(bindings[index])->value.as<CallNode>();
+      for (const Expr& input : Downcast<Tuple>(call->args[1])->fields) {
+        inputs.push_back(VisitExpr(input));
+      }
+      shapes.push_back(VisitExpr(call->args[2]));
+      types.push_back(call->checked_type());
+    }
+    std::string name = "fused_" + std::to_string(num_calls) + "x_" + gv->name_hint;
+    tir::PrimFunc func = Downcast<tir::PrimFunc>(mod_->Lookup(gv));
+    GlobalVar fused_gv = builder_->AddFunction(tir::HorizontallyFuse(func, num_calls, name), name);
+    Call fused(call_tir_op, {fused_gv, Tuple(inputs), Tuple(shapes)}, {}, {TupleType(types)});
+    Var fused_var = builder_->Emit(fused);
+
+    for (int i = 0; i < num_calls; ++i) {
+      const Var& var = Downcast<VarBinding>(bindings[group[i]])->var;
+      TupleGetItem output(fused_var, i);
+      Var new_var = var->IsInstance<DataflowVarNode>()
+                        ? builder_->Emit(output, var->name_hint())
+                        : builder_->EmitOutput(output, var->name_hint());
+      var_remap_[var->vid] = new_var;
+    }
+  }
+
+  /*! \brief The module holding the kernels. */
+  IRModule mod_;
+};
+
+namespace transform {
+
+Pass HorizontalFusion() {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule m, PassContext pc) { return HorizontalFusor(m).Transform(); };
+  return CreateModulePass(pass_func, 0, "HorizontalFusion", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.HorizontalFusion").set_body_typed(HorizontalFusion);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
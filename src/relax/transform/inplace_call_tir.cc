@@ -0,0 +1,215 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/inplace_call_tir.cc
+ * \brief Compute elementwise call_tir in place on inputs that are dead after the call.
+ */
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/attrs/call_tir.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/tir/function.h>
+
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace tvm {
+namespace relax {
+
+// ==================
+// InplaceCallTIRRewriter
+// Mark an elementwise call_tir as in place on an input of the same shape and dtype as its
+// output, when the input is a tensor allocated by an earlier call_tir of the function and has
+// no use after the call.
+// Example:
+// lv0 = rx.call_tir(exp, (x), (n, m), dtype="float32")
+// lv1 = rx.call_tir(relu, (lv0), (n, m), dtype="float32")
+// -->
+// lv0 = rx.call_tir(exp, (x), (n, m), dtype="float32")
+// lv1 = rx.call_tir(relu, (lv0), (n, m), dtype="float32", inplace_indices=[0])
+
+class InplaceCallTIRRewriter {
+ public:
+  explicit InplaceCallTIRRewriter(IRModule mod) : mod_(std::move(mod)) {}
+
+  Function Rewrite(Function func) {
+    const auto* seq = func->body.as<SeqExprNode>();
+    if (seq == nullptr) return func;
+    AnalyzeUses(seq);
+
+    bool changed = false;
+    Array<BindingBlock> blocks;
+    int64_t index = 0;
+    for (const BindingBlock& block : seq->blocks) {
+      Array<Binding> bindings;
+      for (const Binding& binding : block->bindings) {
+        Binding new_binding = binding;
+        if (const auto* var_binding = binding.as<VarBindingNode>()) {
+          if (Optional<Call> call = RewriteCall(var_binding->value, index)) {
+            new_binding = VarBinding(var_binding->var, call.value(), var_binding->span);
+            changed = true;
+          }
+          if (IsCallTIR(var_binding->value)) {
+            // Every call_tir output is a tensor only this function refers to.
+            owned_.insert(var_binding->var.get());
+          }
+        }
+        bindings.push_back(new_binding);
+        ++index;
+      }
+      if (block->IsInstance<DataflowBlockNode>()) {
+        blocks.push_back(DataflowBlock(bindings, block->span));
+      } else {
+        blocks.push_back(BindingBlock(bindings, block->span));
+      }
+    }
+    if (!changed) return func;
+    SeqExpr new_seq = GetRef<SeqExpr>(seq);
+    new_seq.CopyOnWrite()->blocks = blocks;
+    func.CopyOnWrite()->body = new_seq;
+    return func;
+  }
+
+ private:
+  /*!
+   * \brief Record the index of the last binding using each var as a call_tir input. A var used
+   *  in any other way, e.g. packed into a tuple, captured, bound to another var or passed to a
+   *  packed function, may be aliased by another value and is never overwritten.
+   */
+  void AnalyzeUses(const SeqExprNode* seq) {
+    constexpr int64_t kEscaped = std::numeric_limits<int64_t>::max();
+    auto mark_uses = [this](const Expr& e, int64_t index) {
+      PostOrderVisit(e, [this, index](const Expr& e) {
+        if (const auto* var = e.as<VarNode>()) {
+          auto it = last_use_.find(var);
+          last_use_[var] = it == last_use_.end() ? index : std::max(it->second, index);
+        }
+      });
+    };
+    int64_t index = 0;
+    for (const BindingBlock& block : seq->blocks) {
+      for (const Binding& binding : block->bindings) {
+        const auto* var_binding = binding.as<VarBindingNode>();
+        const auto* call = var_binding ? var_binding->value.as<CallNode>() : nullptr;
+        if (call != nullptr && IsCallTIR(var_binding->value)) {
+          for (size_t i = 0; i < call->args.size(); ++i) {
+            const auto* inputs = call->args[i].as<TupleNode>();
+            if (i == 1 && inputs != nullptr) {
+              for (const Expr& field : inputs->fields) {
+                mark_uses(field, field->IsInstance<VarNode>() ? index : kEscaped);
+              }
+            } else {
+              mark_uses(call->args[i], kEscaped);
+            }
+          }
+        } else if (var_binding != nullptr) {
+          mark_uses(var_binding->value, kEscaped);
+        } else if (const auto* match_shape = binding.as<MatchShapeNode>()) {
+          mark_uses(match_shape->value, kEscaped);
+        }
+        ++index;
+      }
+    }
+    mark_uses(seq->body, kEscaped);
+  }
+
+  static bool IsCallTIR(const Expr& e) {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    const auto* call = e.as<CallNode>();
+    return call != nullptr && call->op == call_tir_op;
+  }
+
+  /*! \brief Rewrite the call_tir bound at \p index into its in-place form if it is safe. */
+  Optional<Call> RewriteCall(const Expr& value, int64_t index) {
+    if (!IsCallTIR(value)) return NullOpt;
+    Call call = Downcast<Call>(value);
+    if (call->attrs.defined() || call->args.size() != 3) return NullOpt;
+    const auto* gv = call->args[0].as<GlobalVarNode>();
+    const auto* inputs = call->args[1].as<TupleNode>();
+    const auto* output_shape = call->args[2].as<ShapeExprNode>();
+    const auto* output_type = call->checked_type_.as<DynTensorTypeNode>();
+    if (gv == nullptr || inputs == nullptr || output_shape == nullptr || output_type == nullptr) {
+      return NullOpt;
+    }
+    if (!IsElemwise(GetRef<GlobalVar>(gv))) return NullOpt;
+
+    for (size_t i = 0; i < inputs->fields.size(); ++i) {
+      const auto* input = inputs->fields[i].as<VarNode>();
+      if (input == nullptr || !owned_.count(input) || last_use_.at(input) != index) continue;
+      const auto* input_type = input->checked_type_.as<DynTensorTypeNode>();
+      if (input_type == nullptr || input_type->dtype != output_type->dtype) continue;
+      if (!input->shape_.defined() ||
+          !StructuralEqual()(input->shape_.value(), GetRef<ShapeExpr>(output_shape))) {
+        continue;
+      }
+      auto attrs = make_object<CallTIRInplaceAttrs>();
+      attrs->inplace_indices = {Integer(static_cast<int>(i))};
+      call.CopyOnWrite()->attrs = Attrs(attrs);
+      return call;
+    }
+    return NullOpt;
+  }
+
+  /*! \brief Whether every output element of the kernel only reads the same input elements. */
+  bool IsElemwise(const GlobalVar& gv) {
+    auto it = elemwise_.find(gv.get());
+    if (it != elemwise_.end()) return it->second;
+    bool elemwise = false;
+    auto it_func = mod_->functions.find(gv);
+    if (it_func != mod_->functions.end()) {
+      if (const auto* prim_func = (*it_func).second.as<tir::PrimFuncNode>()) {
+        Optional<Integer> pattern = prim_func->GetAttr<Integer>("op_pattern");
+        int kind = pattern ? static_cast<int>(pattern.value()->value)
+                           : AnalyzeOpPatternKind(GetRef<tir::PrimFunc>(prim_func));
+        elemwise = kind == relay::kElemWise;
+      }
+    }
+    elemwise_[gv.get()] = elemwise;
+    return elemwise;
+  }
+
+  /*! \brief The module holding the kernels. */
+  IRModule mod_;
+  /*! \brief The vars bound to tensors allocated by the function. */
+  std::unordered_set<const VarNode*> owned_;
+  /*! \brief The index of the last binding using each var. */
+  std::unordered_map<const VarNode*, int64_t> last_use_;
+  /*! \brief Whether each kernel is elementwise. */
+  std::unordered_map<const GlobalVarNode*, bool> elemwise_;
+};
+
+namespace transform {
+
+Pass InplaceCallTIR() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return InplaceCallTIRRewriter(m).Rewrite(std::move(f));
+      };
+  return CreateFunctionPass(pass_func, 0, "InplaceCallTIR", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.InplaceCallTIR").set_body_typed(InplaceCallTIR);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
@@ -29,11 +29,109 @@
 #include <tvm/runtime/logging.h>
 
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace tvm {
 namespace relax {
 
+/*!
+ * \brief The free variables and the called global variables of every local function of a module,
+ * computed bottom-up in one traversal, in the order of FreeVars and RecGlobalVars. The variables of
+ * a nested function are only propagated to the function enclosing it when they are free, so the
+ * traversal is linear in the size of the module instead of in the size times the nesting depth.
+ */
+class LocalFunctionAnalyzer : public ExprVisitor {
+ public:
+  struct Info {
+    /*! \brief The free variables of the function, i.e. the ones a closure of it captures. */
+    Array<Var> free_vars;
+    /*! \brief The global variables called by the function, nested functions included. */
+    Array<GlobalVar> called_globals;
+  };
+
+  std::unordered_map<const FunctionNode*, Info> Analyze(const IRModule& mod) {
+    for (const auto& kv : mod->functions) {
+      if (const auto* func = kv.second.as<FunctionNode>()) {
+        // The global functions are not lifted, only their bodies are analyzed.
+        frames_.emplace_back();
+        VisitExpr(func->body);
+        frames_.pop_back();
+      }
+    }
+    return std::move(info_);
+  }
+
+ private:
+  /*! \brief The variables of a function being visited, in the order they are met. */
+  struct Frame {
+    std::vector<Var> vars;
+    std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> seen_vars;
+    std::unordered_set<Var, ObjectPtrHash, ObjectPtrEqual> bound_vars;
+    std::vector<GlobalVar> globals;
+    std::unordered_set<GlobalVar, ObjectPtrHash, ObjectPtrEqual> seen_globals;
+
+    void Use(const Var& var) {
+      if (seen_vars.insert(var).second) vars.push_back(var);
+    }
+    void Bind(const Var& var) {
+      bound_vars.insert(var);
+      Use(var);
+    }
+    void Call(const GlobalVar& gv) {
+      if (seen_globals.insert(gv).second) globals.push_back(gv);
+    }
+  };
+
+  void VisitExpr_(const VarNode* var) final { frames_.back().Use(GetRef<Var>(var)); }
+
+  void VisitExpr_(const FunctionNode* func) final {
+    frames_.emplace_back();
+    for (const Var& param : func->params) {
+      frames_.back().Bind(param);
+    }
+    VisitExpr(func->body);
+    Frame frame = std::move(frames_.back());
+    frames_.pop_back();
+    Info info;
+    for (const Var& var : frame.vars) {
+      if (!frame.bound_vars.count(var)) {
+        info.free_vars.push_back(var);
+        frames_.back().Use(var);
+      }
+    }
+    for (const GlobalVar& gv : frame.globals) {
+      info.called_globals.push_back(gv);
+      frames_.back().Call(gv);
+    }
+    info_[func] = std::move(info);
+  }
+
+  void VisitExpr_(const CallNode* call) final {
+    ExprVisitor::VisitExpr_(call);
+    if (const auto* gv = call->op.as<GlobalVarNode>()) {
+      frames_.back().Call(GetRef<GlobalVar>(gv));
+    }
+  }
+
+  void VisitBinding_(const VarBindingNode* binding) final {
+    frames_.back().Bind(binding->var);
+    VisitExpr(binding->value);
+  }
+
+  void VisitBinding_(const MatchShapeNode* binding) final {
+    VisitExpr(binding->value);
+    if (binding->var.defined()) {
+      frames_.back().Bind(binding->var);
+    }
+  }
+
+  std::vector<Frame> frames_;
+  std::unordered_map<const FunctionNode*, Info> info_;
+};
+
 /* The goal of this class is to lift out any nested functions into top-level
  * functions.
  *
@@ -42,7 +140,10 @@ namespace relax {
  */
 class LambdaLifter : public ExprMutator {
  public:
-  explicit LambdaLifter(const IRModule& module) : ExprMutator(module) { mod_ = module; }
+  explicit LambdaLifter(const IRModule& module) : ExprMutator(module) {
+    mod_ = module;
+    local_funcs_ = LocalFunctionAnalyzer().Analyze(module);
+  }
 
   Expr VisitExpr_(const CallNode* call_node) final {
     auto call = Downcast<Call>(ExprMutator::VisitExpr_(call_node));
@@ -70,8 +171,9 @@ class LambdaLifter : public ExprMutator {
           new_args.push_back(arg);
         }
         if (const auto* nest_call = it->second.as<CallNode>()) {
+          // The captured variables, as remapped in the current scope.
           for (const auto arg : nest_call->args) {
-            new_args.push_back(arg);
+            new_args.push_back(VisitExpr(arg));
           }
           return Call(nest_call->op, new_args, call_node->attrs, call_node->type_args);
         }
@@ -87,31 +189,41 @@ class LambdaLifter : public ExprMutator {
     // TODO(@yongwww): consider appending inner func name into the lifted func name
     String lift_func_name = "lifted_func_" + std::to_string(lift_func_num_++);
     auto global = GlobalVar(lift_func_name);
-    Array<Var> captured_vars = FreeVars(func);
-    recur_vars_ = RecGlobalVars(func);
-    auto all_global_vars = AllGlobalVars(func);
+    Array<Var> captured_vars;
+    Array<GlobalVar> recur_vars;
+    auto info_it = local_funcs_.find(func_node);
+    if (info_it != local_funcs_.end()) {
+      captured_vars = info_it->second.free_vars;
+      recur_vars = info_it->second.called_globals;
+    } else {
+      captured_vars = FreeVars(func);
+      recur_vars = RecGlobalVars(func);
+    }
 
+    // The captured variables become parameters of the lifted function, substituted while its body
+    // is visited, so that the body is not traversed again to rebind them.
     Array<Var> typed_captured_vars;
-    Map<Var, Expr> rebinding_map;
+    std::vector<std::pair<Id, Optional<Var>>> outer_remap;
     for (auto free_var : captured_vars) {
       Var var = Var(free_var->name_hint(), NullOpt, free_var->checked_type_, free_var->span);
       var->shape_ = free_var->shape_;
       typed_captured_vars.push_back(var);
-      rebinding_map.Set(free_var, var);
+      auto remap_it = var_remap_.find(free_var->vid);
+      outer_remap.emplace_back(free_var->vid, remap_it != var_remap_.end()
+                                                  ? Optional<Var>(remap_it->second)
+                                                  : Optional<Var>(NullOpt));
     }
 
     // recursive call
-    if (!recur_vars_.empty()) {
+    if (!recur_vars.empty()) {
       if (!captured_vars.empty()) {
         Array<Expr> fvs;
         for (auto fv : captured_vars) {
           fvs.push_back(fv);
         }
-        lambda_map_.emplace(recur_vars_.back(), Call(global, fvs));
+        lambda_map_.emplace(recur_vars.back(), Call(global, fvs));
       } else {
-        if (recur_vars_.size() > 0) {
-          lambda_map_.emplace(recur_vars_.back(), global);
-        }
+        lambda_map_.emplace(recur_vars.back(), global);
       }
     }
 
@@ -123,7 +235,17 @@ class LambdaLifter : public ExprMutator {
       all_params_unchanged &= param.same_as(new_param);
     }
 
+    for (size_t i = 0; i < captured_vars.size(); ++i) {
+      var_remap_[captured_vars[i]->vid] = typed_captured_vars[i];
+    }
     Expr body = this->VisitWithNewScope(func_node->body);
+    for (const auto& kv : outer_remap) {
+      if (kv.second.defined()) {
+        var_remap_[kv.first] = kv.second.value();
+      } else {
+        var_remap_.erase(kv.first);
+      }
+    }
     Expr visited_func;
 
     if (all_params_unchanged && body.same_as(func_node->body)) {
@@ -157,7 +279,7 @@ class LambdaLifter : public ExprMutator {
       }
 
       lifted_func = Function(/*params=*/closure_params,
-                             /*body=*/Bind(new_func->body, rebinding_map),
+                             /*body=*/new_func->body,
                              /*ret_type=*/new_func->ret_type,
                              /*attrs=*/new_func->attrs,
                              /*span=*/func->span);
@@ -180,10 +302,10 @@ class LambdaLifter : public ExprMutator {
       return std::move(global);
     } else {
       // If we need to allocate a closure,
-      // we pass the variables in its environment here.
+      // we pass the variables in its environment here, as remapped in the enclosing scope.
       Array<Expr> fvs;
       for (auto fv : captured_vars) {
-        fvs.push_back(fv);
+        fvs.push_back(VisitExpr(fv));
       }
       // Call make_closure intrinsic
       return Call(make_closure_op_, {global, Tuple(fvs)}, {}, {});
@@ -238,7 +360,8 @@ class LambdaLifter : public ExprMutator {
 
  private:
   std::unordered_map<GlobalVar, Expr, ObjectPtrHash, ObjectPtrEqual> lambda_map_;
-  Array<GlobalVar> recur_vars_;
+  /*! \brief The free and called global variables of the local functions of the module. */
+  std::unordered_map<const FunctionNode*, LocalFunctionAnalyzer::Info> local_funcs_;
   IRModule mod_;
   size_t lift_func_num_ = 0;
   /*! \brief Cache ops that would be used later to reduce lookup overhead. */
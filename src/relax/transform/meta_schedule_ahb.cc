@@ -23,14 +23,16 @@
  */
 
 #include <tvm/relax/transform.h>
+#include <tvm/relax/tuning_api.h>
 
 namespace tvm {
 namespace relax {
 
 class MetaScheduleAHB {
  public:
-  explicit MetaScheduleAHB(IRModule mod, const tvm::meta_schedule::Database& db, Target target)
-      : mod_(mod), db_(db), target_(target) {}
+  explicit MetaScheduleAHB(IRModule mod, const tvm::meta_schedule::Database& db, Target target,
+                           Optional<Database> relax_db)
+      : mod_(mod), db_(db), target_(target), relax_db_(relax_db) {}
   IRModule Apply() {
     ret_mod_ = IRModule();
     tvm::meta_schedule::ApplyHistoryBest ahb(db_, nullptr, nullptr);
@@ -47,6 +49,8 @@ class MetaScheduleAHB {
           IRModule newmod = Downcast<IRModule>(res);
           ICHECK_EQ(newmod->functions.size(), 1);
           newfunc = (*newmod->functions.begin()).second;
+        } else if (Optional<BaseFunc> tuned = QueryTuningAPI(tir_mod, gv)) {
+          newfunc = tuned.value();
         }
       }
 
@@ -56,9 +60,30 @@ class MetaScheduleAHB {
   }
 
  private:
+  /*!
+   * \brief Look the kernel up in the Relax tuning database, whose workloads are shared with the
+   * MetaSchedule database by the WorkloadRegistry, and replay the decisions of its best record.
+   */
+  Optional<BaseFunc> QueryTuningAPI(const IRModule& tir_mod, const GlobalVar& gv) {
+    if (!relax_db_.defined() || !relax_db_.value()->HasWorkload(tir_mod)) return NullOpt;
+    Database relax_db = relax_db_.value();
+    tvm::meta_schedule::Workload workload = relax_db->CommitWorkload(tir_mod);
+    if (!relax_db->HasTuningRecord(workload, target_)) return NullOpt;
+    Array<TuningRecord> records = relax_db->GetTopK(workload, target_, 1);
+    if (records.empty()) return NullOpt;
+    const Trace& trace = records[0]->trace;
+    IRModule out_mod = Trace(tir_mod, trace->knobs, trace->decisions)->out_mod;
+    Optional<BaseFunc> func = out_mod->functions.Get(gv);
+    if (!func.defined() && out_mod->functions.size() == 1) {
+      func = (*out_mod->functions.begin()).second;
+    }
+    return func;
+  }
+
   IRModule mod_;
   const tvm::meta_schedule::Database& db_;
   Target target_;
+  Optional<Database> relax_db_;
   IRModule ret_mod_;
 };
 
@@ -66,7 +91,16 @@ namespace transform {
 
 Pass MetaScheduleApplyHistoryBest(const tvm::meta_schedule::Database& database, Target target) {
   runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
-      [=](IRModule m, PassContext pc) { return MetaScheduleAHB(m, database, target).Apply(); };
+      [=](IRModule m, PassContext pc) {
+        Optional<Database> relax_db = NullOpt;
+        Optional<ObjectRef> tuning_api_database = pc->GetTuningAPIDatabase();
+        if (tuning_api_database.defined() && tuning_api_database.value().as<DatabaseNode>()) {
+          relax_db = Downcast<Database>(tuning_api_database.value());
+        }
+        IRModule mod = MetaScheduleAHB(m, database, target, relax_db).Apply();
+        // The weights of the kernels tuned with RewriteLayout are rewritten ahead of the calls.
+        return SplitLayoutRewritePreproc()(mod);
+      };
   return CreateModulePass(/*pass function*/ pass_func, /*opt level*/ 0,
                           /*pass name*/ "MetaScheduleApplyHistoryBest",
                           /*required*/ {});
@@ -0,0 +1,361 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/pattern_fusor.h
+ * \brief Group the bindings matched by dataflow patterns into composite functions, shared by
+ * FuseOpsByPattern, which groups the matches greedily, and CollagePartition, which chooses them by
+ * their measured latency.
+ */
+#ifndef TVM_RELAX_TRANSFORM_PATTERN_FUSOR_H_
+#define TVM_RELAX_TRANSFORM_PATTERN_FUSOR_H_
+
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/dataflow_pattern.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "../ir/dataflow_matcher_impl.h"
+
+namespace tvm {
+namespace relax {
+
+/*!
+ * \brief Create a function from a group of bindings whose last binding defines the only var used
+ * outside the group. The vars used by the group but defined outside it become the parameters.
+ */
+class CompositeFunctionCreator : public ExprMutator {
+ public:
+  /*!
+   * \brief Create the function of \p bindings.
+   * \param bindings The bindings of the group, in binding order.
+   * \param arguments The arguments to call the function with, appended by the creator.
+   * \return The function, without attributes.
+   */
+  Function Create(const std::vector<VarBinding>& bindings, Array<Expr>* arguments) {
+    std::unordered_set<const VarNode*> defined;
+    for (const VarBinding& binding : bindings) {
+      PostOrderVisit(binding->value, [&](const Expr& e) {
+        const auto* var = e.as<VarNode>();
+        if (var == nullptr || defined.count(var) || var_remap_.count(var->vid)) return;
+        Var param(var->name_hint(), NullOpt, var->checked_type_);
+        param->shape_ = var->shape_;
+        var_remap_[var->vid] = param;
+        params_.push_back(param);
+        arguments->push_back(GetRef<Var>(var));
+      });
+      defined.insert(binding->var.get());
+    }
+
+    builder_->BeginDataflowBlock();
+    for (size_t i = 0; i + 1 < bindings.size(); ++i) {
+      VisitBinding(bindings[i]);
+    }
+    Var output = builder_->EmitOutput(VisitExpr(bindings.back()->value));
+    BindingBlock block = builder_->EndBlock();
+    Expr body = builder_->Normalize(SeqExpr({block}, output));
+    return Function(params_, body, body->checked_type_, DictAttrs());
+  }
+
+ private:
+  /*! \brief The parameters of the function. */
+  Array<Var> params_;
+};
+
+/*!
+ * \brief Inline a composite function into a function offloaded by \p codegen, with the attribute
+ * Codegen=<codegen> and without a global symbol yet.
+ */
+inline Function CreateCodegenFunction(const Function& composite, const String& codegen) {
+  Array<Var> params;
+  for (const Var& param : composite->params) {
+    Var new_param(param->name_hint(), NullOpt, param->checked_type_);
+    new_param->shape_ = param->shape_;
+    params.push_back(new_param);
+  }
+  Call body(composite, Array<Expr>(params.begin(), params.end()));
+  body->checked_type_ = composite->ret_type;
+  body->shape_ = composite->body->shape_;
+  Function wrapper(params, body, composite->ret_type, DictAttrs());
+  return WithAttr(std::move(wrapper), attr::kCodegen, codegen);
+}
+
+// ==================
+// PatternFusor
+// Match the patterns, in order of priority, against the bindings of each dataflow block from the
+// last binding up, and replace the bindings matched by a pattern with a call to a function of
+// attribute Composite=<pattern name> computing them. A match is only grouped if the vars of its
+// bindings other than the last one are used within the match only, so that the function has a
+// single output. When the pattern has a codegen, the composite function is inlined into a function
+// annotated with Codegen=<codegen>, as expected by RunCodegen and the JSON codegens.
+// Example, with the pattern ("relax.add_relu", relu(add(*, *))):
+// lv0 = relax.add(x, y)
+// lv1 = relax.nn.relu(lv0)
+// -->
+// lv1 = fused_relax_add_relu(x, y)
+// where fused_relax_add_relu has attributes {"Composite": "relax.add_relu", "Primitive": 1}
+
+class PatternFusor : public ExprMutator {
+ public:
+  /*!
+   * \param mod The module to transform.
+   * \param pattern_names The names of the patterns.
+   * \param patterns The patterns, in order of priority.
+   * \param codegens The codegen offloading the matches of each pattern, if any.
+   */
+  explicit PatternFusor(IRModule mod, Array<String> pattern_names, Array<DFPattern> patterns,
+                        std::vector<Optional<String>> codegens)
+      : ExprMutator(mod),
+        mod_(std::move(mod)),
+        pattern_names_(std::move(pattern_names)),
+        patterns_(std::move(patterns)),
+        codegens_(std::move(codegens)),
+        table_(patterns_) {
+    CHECK_EQ(pattern_names_.size(), patterns_.size())
+        << "ValueError: Every pattern of FuseOpsByPattern requires a name";
+    ICHECK_EQ(codegens_.size(), patterns_.size());
+  }
+
+  virtual ~PatternFusor() = default;
+
+  IRModule Transform() {
+    for (const auto& kv : mod_->functions) {
+      if (const auto* func = kv.second.as<FunctionNode>()) {
+        if (func->HasNonzeroAttr(attr::kPrimitive) ||
+            func->GetAttr<String>(attr::kCodegen).defined()) {
+          continue;
+        }
+        var2val_ = AnalyzeVar2Value(GetRef<Function>(func));
+        bound_values_.clear();
+        for (const auto& binding : var2val_) bound_values_.insert(binding.second.get());
+        Function new_func = Downcast<Function>(VisitExpr(GetRef<Function>(func)));
+        if (!new_func.same_as(kv.second)) builder_->UpdateFunction(kv.first, new_func);
+      }
+    }
+    VLOG(1) << "FuseOpsByPattern match statistics:" << std::endl
+            << table_.GetStatistics(pattern_names_);
+    return builder_->GetContextIRModule();
+  }
+
+  using ExprMutator::VisitBindingBlock_;
+
+  BindingBlock VisitBindingBlock_(const DataflowBlockNode* block) final {
+    std::vector<Match> matches = SelectMatches(block->bindings);
+    if (matches.empty()) return ExprMutator::VisitBindingBlock_(block);
+    // The match which each binding is the root or another member of.
+    std::unordered_map<int, int> root_of, member_of;
+    for (int m = 0; m < static_cast<int>(matches.size()); ++m) {
+      root_of[matches[m].members.back()] = m;
+      for (int index : matches[m].members) member_of[index] = m;
+    }
+
+    builder_->BeginDataflowBlock();
+    for (int i = 0; i < static_cast<int>(block->bindings.size()); ++i) {
+      auto it = root_of.find(i);
+      if (it != root_of.end()) {
+        EmitCompositeCall(block->bindings, matches[it->second]);
+      } else if (!member_of.count(i)) {
+        VisitBinding(block->bindings[i]);
+      }
+    }
+    return builder_->EndBlock();
+  }
+
+ protected:
+  /*! \brief The bindings matched by a pattern. */
+  struct Match {
+    /*! \brief The index of the pattern. */
+    int pattern;
+    /*! \brief The indices of the matched bindings in binding order, the last one is the root. */
+    std::vector<int> members;
+  };
+
+  /*! \brief The binding index of each value and the users of each var in a block. */
+  struct BlockUses {
+    std::unordered_map<const Object*, int> value_index;
+    std::unordered_map<const VarNode*, std::vector<int>> users;
+  };
+
+  /*! \brief Whether the expr matched by \p pattern is an operation rather than an input. */
+  static bool IsOperation(const DFPattern& pattern) {
+    return pattern->IsInstance<CallPatternNode>() || pattern->IsInstance<TuplePatternNode>() ||
+           pattern->IsInstance<TupleGetItemPatternNode>() ||
+           pattern->IsInstance<UnorderedTuplePatternNode>();
+  }
+
+  static BlockUses AnalyzeUses(const Array<Binding>& bindings) {
+    BlockUses uses;
+    for (int i = 0; i < static_cast<int>(bindings.size()); ++i) {
+      Expr value;
+      if (const auto* var_binding = bindings[i].as<VarBindingNode>()) {
+        value = var_binding->value;
+        uses.value_index[value.get()] = i;
+      } else {
+        value = Downcast<MatchShape>(bindings[i])->value;
+      }
+      PostOrderVisit(value, [&uses, i](const Expr& e) {
+        if (const auto* var = e.as<VarNode>()) uses.users[var].push_back(i);
+      });
+    }
+    return uses;
+  }
+
+  /*!
+   * \brief Match the pattern \p p rooted at the binding \p i.
+   * \return Whether the pattern matches the binding and its match can be grouped into a function,
+   * regardless of the other matches.
+   */
+  bool MatchAt(const Array<Binding>& bindings, const BlockUses& uses, int i, int p,
+               Match* match) {
+    const auto* var_binding = bindings[i].as<VarBindingNode>();
+    DFPatternMatcher matcher(var2val_);
+    if (!table_.Match(p, var_binding->value, &matcher)) return false;
+    std::set<int> members;
+    for (const auto& kv : matcher.GetMemo()) {
+      if (!IsOperation(kv.first)) continue;
+      for (const Expr& matched : kv.second) {
+        auto it = uses.value_index.find(matched.get());
+        if (it != uses.value_index.end()) {
+          members.insert(it->second);
+        } else if (bound_values_.count(matched.get())) {
+          // Bindings of other blocks cannot be grouped.
+          return false;
+        }
+      }
+    }
+    members.insert(i);
+    for (int index : members) {
+      if (index == i) continue;
+      const Var& var = Downcast<VarBinding>(bindings[index])->var;
+      if (!var->IsInstance<DataflowVarNode>()) return false;
+      auto it = uses.users.find(var.get());
+      if (it == uses.users.end()) continue;
+      for (int user : it->second) {
+        if (!members.count(user)) return false;
+      }
+    }
+    *match = Match{p, std::vector<int>(members.begin(), members.end())};
+    return true;
+  }
+
+  /*!
+   * \brief Select the matches to group, which do not overlap. By default match the patterns
+   * against the bindings, taking the bindings from the last one up so that a pattern covers the
+   * longest chain ending at its root.
+   */
+  virtual std::vector<Match> SelectMatches(const Array<Binding>& bindings) {
+    BlockUses uses = AnalyzeUses(bindings);
+    std::vector<Match> matches;
+    std::unordered_set<int> grouped;
+    for (int i = static_cast<int>(bindings.size()) - 1; i >= 0; --i) {
+      const auto* var_binding = bindings[i].as<VarBindingNode>();
+      if (grouped.count(i) || var_binding == nullptr ||
+          !var_binding->value->IsInstance<CallNode>()) {
+        continue;
+      }
+      // Only the patterns which may match the op called by the binding are tried.
+      for (int p : table_.GetCandidates(var_binding->value)) {
+        Match match;
+        if (!MatchAt(bindings, uses, i, p, &match)) continue;
+        if (std::any_of(match.members.begin(), match.members.end(),
+                        [&grouped](int index) { return grouped.count(index); })) {
+          continue;
+        }
+        grouped.insert(match.members.begin(), match.members.end());
+        matches.push_back(std::move(match));
+        break;
+      }
+    }
+    return matches;
+  }
+
+  /*!
+   * \brief Create the composite function of \p match.
+   * \param arguments The arguments to call the function with, appended.
+   */
+  Function CreateCompositeFunction(const Array<Binding>& bindings, const Match& match,
+                                   Array<Expr>* arguments) {
+    std::vector<VarBinding> members;
+    for (int index : match.members) members.push_back(Downcast<VarBinding>(bindings[index]));
+    Function func = CompositeFunctionCreator().Create(members, arguments);
+    func = WithAttr(std::move(func), attr::kComposite, pattern_names_[match.pattern]);
+    return WithAttr(std::move(func), attr::kPrimitive, Integer(1));
+  }
+
+  /*! \brief The name of the functions of the matches of the pattern \p p. */
+  std::string FunctionName(int p) const {
+    std::string name = pattern_names_[p];
+    std::replace(name.begin(), name.end(), '.', '_');
+    if (codegens_[p].defined()) return std::string(codegens_[p].value()) + "_" + name;
+    return "fused_" + name;
+  }
+
+  /*! \brief Emit the call to the function of \p match, and bind the var of its root to it. */
+  void EmitCompositeCall(const Array<Binding>& bindings, const Match& match) {
+    Array<Expr> arguments;
+    Function func = CreateCompositeFunction(bindings, match, &arguments);
+    const Optional<String>& codegen = codegens_[match.pattern];
+    Expr callee;
+    if (codegen.defined()) {
+      Function wrapper = CreateCodegenFunction(func, codegen.value());
+      GlobalVar gv = builder_->AddFunction(wrapper, FunctionName(match.pattern));
+      builder_->UpdateFunction(gv, WithAttr(std::move(wrapper), tvm::attr::kGlobalSymbol,
+                                            String(gv->name_hint)));
+      callee = gv;
+    } else {
+      callee = builder_->AddFunction(func, FunctionName(match.pattern));
+    }
+
+    for (size_t i = 0; i < arguments.size(); ++i) {
+      arguments.Set(i, VisitExpr(arguments[i]));
+    }
+    const Var& var = Downcast<VarBinding>(bindings[match.members.back()])->var;
+    Call call(callee, arguments);
+    Var new_var = var->IsInstance<DataflowVarNode>() ? builder_->Emit(call, var->name_hint())
+                                                     : builder_->EmitOutput(call, var->name_hint());
+    var_remap_[var->vid] = new_var;
+  }
+
+  /*! \brief The module to transform. */
+  IRModule mod_;
+  /*! \brief The names of the patterns. */
+  Array<String> pattern_names_;
+  /*! \brief The patterns, in order of priority. */
+  Array<DFPattern> patterns_;
+  /*! \brief The codegen offloading the matches of each pattern, if any. */
+  std::vector<Optional<String>> codegens_;
+  /*! \brief The patterns indexed by the ops of their roots. */
+  PatternTableMatcher table_;
+  /*! \brief The value of each var of the function being transformed. */
+  Map<Var, Expr> var2val_;
+  /*! \brief The values bound to the vars of the function being transformed. */
+  std::unordered_set<const Object*> bound_values_;
+};
+
+}  // namespace relax
+}  // namespace tvm
+
+#endif  // TVM_RELAX_TRANSFORM_PATTERN_FUSOR_H_
@@ -0,0 +1,441 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/quantize_weights.cc
+ * \brief Store the constant weights of matmul-like kernels as int8 or int4 with float scales.
+ */
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../../tir/ir/functor_common.h"
+
+namespace tvm {
+namespace tir {
+
+/*!
+ * \brief Find the reduction axis of a 2-D buffer read by a kernel, i.e. the axis indexed by a
+ * reduction block iter in every load, while the other axis is indexed by a spatial iter.
+ */
+class WeightAccessAnalyzer : private StmtExprVisitor {
+ public:
+  /*! \return The reduction axis, or -1 if the buffer is not only read as a matmul weight. */
+  static int GetReductionAxis(const PrimFunc& func, const Buffer& buffer) {
+    WeightAccessAnalyzer analyzer(buffer);
+    analyzer(func->body);
+    return analyzer.failed_ ? -1 : analyzer.reduction_axis_;
+  }
+
+ private:
+  explicit WeightAccessAnalyzer(Buffer buffer) : buffer_(std::move(buffer)) {}
+
+  void VisitStmt_(const BlockNode* op) final {
+    for (const MatchBufferRegion& match_buffer : op->match_buffers) {
+      if (match_buffer->source->buffer.same_as(buffer_)) failed_ = true;
+    }
+    for (const IterVar& iter : op->iter_vars) iter_types_[iter->var.get()] = iter->iter_type;
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const BufferStoreNode* op) final {
+    if (op->buffer.same_as(buffer_)) failed_ = true;
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitExpr_(const VarNode* op) final {
+    if (op == buffer_->data.get()) failed_ = true;
+  }
+
+  void VisitExpr_(const BufferLoadNode* op) final {
+    StmtExprVisitor::VisitExpr_(op);
+    if (!op->buffer.same_as(buffer_)) return;
+    int reduction_axis = -1;
+    int num_spatial = 0;
+    for (int i = 0; i < static_cast<int>(op->indices.size()); ++i) {
+      auto it = iter_types_.find(op->indices[i].as<VarNode>());
+      if (it == iter_types_.end()) {
+        failed_ = true;
+      } else if (it->second == kCommReduce) {
+        reduction_axis = i;
+      } else if (it->second == kDataPar) {
+        ++num_spatial;
+      }
+    }
+    if (reduction_axis == -1 || num_spatial != 1 ||
+        (reduction_axis_ != -1 && reduction_axis_ != reduction_axis)) {
+      failed_ = true;
+    }
+    reduction_axis_ = reduction_axis;
+  }
+
+  /*! \brief The analyzed buffer. */
+  Buffer buffer_;
+  /*! \brief The types of the block iters. */
+  std::unordered_map<const VarNode*, IterVarType> iter_types_;
+  /*! \brief The reduction axis of the loads so far. */
+  int reduction_axis_{-1};
+  /*! \brief Whether the buffer is accessed other than by matmul loads. */
+  bool failed_{false};
+};
+
+/*!
+ * \brief Replace the loads of a float32 weight by the dequantized elements of its quantized
+ * buffer, i.e. the int8 values or the int4 values packed in pairs along the last axis, times the
+ * scale of the channel and group of the element.
+ */
+class WeightDequantizer : private StmtExprMutator {
+ public:
+  static Stmt Rewrite(const Stmt& body, const Buffer& weight, const Buffer& quantized,
+                      const Buffer& scale, int bits, int reduction_axis, int64_t group_size) {
+    WeightDequantizer dequantizer(weight, quantized, scale, bits, reduction_axis, group_size);
+    return dequantizer(body);
+  }
+
+ private:
+  WeightDequantizer(Buffer weight, Buffer quantized, Buffer scale, int bits, int reduction_axis,
+                    int64_t group_size)
+      : weight_(std::move(weight)),
+        quantized_(std::move(quantized)),
+        scale_(std::move(scale)),
+        bits_(bits),
+        reduction_axis_(reduction_axis),
+        group_size_(group_size) {}
+
+  PrimExpr VisitExpr_(const BufferLoadNode* op) final {
+    BufferLoad load = Downcast<BufferLoad>(StmtExprMutator::VisitExpr_(op));
+    if (!load->buffer.same_as(weight_)) return std::move(load);
+    const Array<PrimExpr>& indices = load->indices;
+    PrimExpr value;
+    if (bits_ == 8) {
+      value = Cast(DataType::Float(32), BufferLoad(quantized_, indices));
+    } else {
+      PrimExpr byte = Cast(DataType::Int(32),
+                           BufferLoad(quantized_, {indices[0], floordiv(indices[1], 2)}));
+      PrimExpr shift = Cast(DataType::Int(32), floormod(indices[1], 2)) * 4;
+      PrimExpr nibble = bitwise_and(right_shift(byte, shift), make_const(DataType::Int(32), 15));
+      value = Cast(DataType::Float(32), nibble - make_const(DataType::Int(32), 8));
+    }
+    const PrimExpr& channel = indices[1 - reduction_axis_];
+    const PrimExpr& row = indices[reduction_axis_];
+    PrimExpr group = group_size_ > 0 ? floordiv(row, make_const(row.dtype(), group_size_))
+                                     : make_const(row.dtype(), 0);
+    return value * BufferLoad(scale_, {channel, group});
+  }
+
+  Stmt VisitStmt_(const BlockNode* op) final {
+    Block block = Downcast<Block>(StmtExprMutator::VisitStmt_(op));
+    bool reads_weight = false;
+    Array<BufferRegion> reads;
+    for (const BufferRegion& region : block->reads) {
+      if (region->buffer.same_as(weight_)) {
+        reads_weight = true;
+      } else {
+        reads.push_back(region);
+      }
+    }
+    if (!reads_weight) return std::move(block);
+    reads.push_back(BufferRegion::FullRegion(quantized_));
+    reads.push_back(BufferRegion::FullRegion(scale_));
+    block.CopyOnWrite()->reads = std::move(reads);
+    return std::move(block);
+  }
+
+  Buffer weight_;
+  Buffer quantized_;
+  Buffer scale_;
+  int bits_;
+  int reduction_axis_;
+  int64_t group_size_;
+};
+
+}  // namespace tir
+
+namespace relax {
+
+// ==================
+// WeightQuantizer
+// Replace the constant float32 weight of a matmul-like call_tir by its int8 or int4 values and
+// the float32 scales of its channels, or of groups of rows of each channel, and call a copy of
+// the kernel which dequantizes the weight elements as it loads them. The dequantization happens
+// in the kernel, so only the quantized weight is read from memory.
+// Example:
+// lv0 = rx.call_tir(dense, (x, c0), (n, m), dtype="float32")
+// -->
+// lv0 = rx.call_tir(dense_int8, (x, q0, s0), (n, m), dtype="float32")
+// where q0 and s0 are the quantized values and the scales of c0.
+
+class WeightQuantizer : public ExprMutator {
+ public:
+  WeightQuantizer(IRModule mod, int bits, int group_size, Optional<runtime::PackedFunc> fcalibrate)
+      : ExprMutator(mod),
+        mod_(mod),
+        bits_(bits),
+        group_size_(group_size),
+        fcalibrate_(fcalibrate) {}
+
+  IRModule Rewrite() {
+    for (const auto& kv : mod_->functions) {
+      if (const auto* func = kv.second.as<FunctionNode>()) {
+        Function new_func = Downcast<Function>(VisitExpr(GetRef<Function>(func)));
+        if (!new_func.same_as(kv.second)) builder_->UpdateFunction(kv.first, new_func);
+      }
+    }
+    return builder_->GetContextIRModule();
+  }
+
+  using ExprMutator::VisitExpr_;
+
+  Expr VisitExpr_(const CallNode* op) final {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    Call call = Downcast<Call>(ExprMutator::VisitExpr_(op));
+    if (call->op != call_tir_op || call->attrs.defined() || call->args.size() != 3) return call;
+    const auto* gv = call->args[0].as<GlobalVarNode>();
+    const auto* inputs = call->args[1].as<TupleNode>();
+    if (gv == nullptr || inputs == nullptr) return call;
+    auto it_func = mod_->functions.find(GetRef<GlobalVar>(gv));
+    if (it_func == mod_->functions.end()) return call;
+    const auto* func = (*it_func).second.as<tir::PrimFuncNode>();
+    if (func == nullptr || !IsMatmulLike(GetRef<tir::PrimFunc>(func))) return call;
+
+    for (size_t i = 0; i < inputs->fields.size() && i < func->params.size(); ++i) {
+      const auto* constant = inputs->fields[i].as<ConstantNode>();
+      if (constant == nullptr) continue;
+      const tir::Buffer& buffer = func->buffer_map.at(func->params[i]);
+      int reduction_axis = GetReductionAxis(GetRef<tir::PrimFunc>(func), buffer, constant->data);
+      if (reduction_axis == -1) continue;
+      int64_t group_size = GetGroupSize(gv->name_hint, constant->data, reduction_axis);
+      if (group_size < 0) continue;
+      const QuantizedWeight& weight = Quantize(constant, reduction_axis, group_size);
+      GlobalVar new_gv = GetKernel(GetRef<GlobalVar>(gv), i, reduction_axis, group_size);
+      Array<Expr> new_inputs(inputs->fields.begin(), inputs->fields.begin() + i);
+      new_inputs.push_back(weight.data);
+      new_inputs.push_back(weight.scale);
+      new_inputs.insert(new_inputs.end(), inputs->fields.begin() + i + 1, inputs->fields.end());
+      return Call(call_tir_op, {new_gv, Tuple(new_inputs), call->args[2]}, call->attrs,
+                  call->type_args, call->span);
+    }
+    return call;
+  }
+
+ private:
+  /*! \brief The quantized values and the scales of a weight. */
+  struct QuantizedWeight {
+    Constant data;
+    Constant scale;
+  };
+
+  /*! \brief Whether the kernel is compute-bound, e.g. a dense, matmul or conv. */
+  static bool IsMatmulLike(const tir::PrimFunc& func) {
+    Optional<Integer> pattern = func->GetAttr<Integer>("op_pattern");
+    int kind = pattern ? static_cast<int>(pattern.value()->value) : AnalyzeOpPatternKind(func);
+    return kind == relay::kOutEWiseFusable;
+  }
+
+  /*!
+   * \brief Get the reduction axis of the weight \p data bound to \p buffer.
+   * \return The axis, or -1 if \p data cannot be quantized.
+   */
+  int GetReductionAxis(const tir::PrimFunc& func, const tir::Buffer& buffer,
+                       const runtime::NDArray& data) const {
+    if (data->ndim != 2 || buffer->shape.size() != 2 || data->dtype.code != kDLFloat ||
+        data->dtype.bits != 32 || data->dtype.lanes != 1 || buffer->dtype != DataType::Float(32)) {
+      return -1;
+    }
+    for (int i = 0; i < 2; ++i) {
+      const auto* dim = buffer->shape[i].as<IntImmNode>();
+      if (dim == nullptr || dim->value != data->shape[i]) return -1;
+    }
+    // The int4 values are packed in pairs along the last axis.
+    if (bits_ == 4 && data->shape[1] % 2 != 0) return -1;
+    return tir::WeightAccessAnalyzer::GetReductionAxis(func, buffer);
+  }
+
+  /*!
+   * \brief Get the number of rows sharing a scale, calling the calibration function if any.
+   * \return The group size, 0 for one scale per channel or -1 to keep the weight.
+   */
+  int64_t GetGroupSize(const String& kernel, const runtime::NDArray& data,
+                       int reduction_axis) const {
+    int64_t group_size = group_size_;
+    if (fcalibrate_.defined()) {
+      group_size = fcalibrate_.value()(kernel, data, reduction_axis).operator int64_t();
+    }
+    if (group_size > 0 && data->shape[reduction_axis] % group_size != 0) return -1;
+    return group_size;
+  }
+
+  /*! \brief Quantize a weight, symmetrically to the largest magnitude of each group. */
+  const QuantizedWeight& Quantize(const ConstantNode* constant, int reduction_axis,
+                                  int64_t group_size) {
+    auto it = quantized_.find(constant);
+    if (it != quantized_.end()) return it->second;
+    Device cpu{kDLCPU, 0};
+    runtime::NDArray src = constant->data.CopyTo(cpu);
+    const float* values = static_cast<const float*>(src->data);
+    int64_t num_rows = src->shape[reduction_axis];
+    int64_t num_channels = src->shape[1 - reduction_axis];
+    int64_t num_groups = group_size > 0 ? num_rows / group_size : 1;
+    int64_t rows_per_group = num_rows / num_groups;
+    auto element = [&](int64_t row, int64_t channel) {
+      return reduction_axis == 0 ? row * src->shape[1] + channel : channel * src->shape[1] + row;
+    };
+
+    float max_value = bits_ == 8 ? 127.0f : 7.0f;
+    runtime::NDArray scale =
+        runtime::NDArray::Empty(ShapeTuple({num_channels, num_groups}), DataType::Float(32), cpu);
+    float* scales = static_cast<float*>(scale->data);
+    std::vector<int> levels(num_rows * num_channels);
+    for (int64_t c = 0; c < num_channels; ++c) {
+      for (int64_t g = 0; g < num_groups; ++g) {
+        float amax = 0.0f;
+        for (int64_t r = g * rows_per_group; r < (g + 1) * rows_per_group; ++r) {
+          amax = std::max(amax, std::fabs(values[element(r, c)]));
+        }
+        float s = amax > 0.0f ? amax / max_value : 1.0f;
+        scales[c * num_groups + g] = s;
+        for (int64_t r = g * rows_per_group; r < (g + 1) * rows_per_group; ++r) {
+          float level = std::round(values[element(r, c)] / s);
+          level = std::min(max_value, std::max(-max_value, level));
+          levels[element(r, c)] = static_cast<int>(level);
+        }
+      }
+    }
+
+    runtime::NDArray data;
+    if (bits_ == 8) {
+      data = runtime::NDArray::Empty(src.Shape(), DataType::Int(8), cpu);
+      int8_t* dst = static_cast<int8_t*>(data->data);
+      for (size_t i = 0; i < levels.size(); ++i) dst[i] = static_cast<int8_t>(levels[i]);
+    } else {
+      data = runtime::NDArray::Empty(ShapeTuple({src->shape[0], src->shape[1] / 2}),
+                                     DataType::UInt(8), cpu);
+      uint8_t* dst = static_cast<uint8_t*>(data->data);
+      for (size_t i = 0; i < levels.size(); i += 2) {
+        dst[i / 2] = static_cast<uint8_t>((levels[i] + 8) | ((levels[i + 1] + 8) << 4));
+      }
+    }
+    Device dev = constant->data->device;
+    QuantizedWeight weight{Constant(data.CopyTo(dev)), Constant(scale.CopyTo(dev))};
+    return quantized_.emplace(constant, weight).first->second;
+  }
+
+  /*!
+   * \brief Get the copy of the kernel \p gv dequantizing its input \p index, creating it on the
+   * first call. The quantized values and the scales replace the input in the params.
+   */
+  GlobalVar GetKernel(const GlobalVar& gv, size_t index, int reduction_axis,
+                      int64_t group_size) {
+    std::string key = gv->name_hint + "/" + std::to_string(index) + "/" +
+                      std::to_string(reduction_axis) + "/" + std::to_string(group_size);
+    auto it = kernels_.find(key);
+    if (it != kernels_.end()) return it->second;
+
+    tir::PrimFunc func = Downcast<tir::PrimFunc>(mod_->Lookup(gv));
+    const tir::Var& param = func->params[index];
+    tir::Buffer weight = func->buffer_map.at(param);
+    int64_t num_rows = weight->shape[reduction_axis].as<IntImmNode>()->value;
+    int64_t num_channels = weight->shape[1 - reduction_axis].as<IntImmNode>()->value;
+    int64_t num_groups = group_size > 0 ? num_rows / group_size : 1;
+    Array<PrimExpr> data_shape = weight->shape;
+    DataType data_type = DataType::Int(8);
+    if (bits_ == 4) {
+      int64_t num_columns = weight->shape[1].as<IntImmNode>()->value;
+      data_shape.Set(1, tir::make_const(weight->shape[1].dtype(), num_columns / 2));
+      data_type = DataType::UInt(8);
+    }
+    std::string name = weight->name;
+    tir::Buffer data = tir::decl_buffer(data_shape, data_type, name + "_quantized");
+    tir::Buffer scale = tir::decl_buffer(
+        {tir::make_const(DataType::Int(64), num_channels),
+         tir::make_const(DataType::Int(64), num_groups)},
+        DataType::Float(32), name + "_scale");
+    tir::Var data_param("p_" + name + "_quantized", PrimType(DataType::Handle()));
+    tir::Var scale_param("p_" + name + "_scale", PrimType(DataType::Handle()));
+
+    Array<tir::Var> params;
+    Map<tir::Var, tir::Buffer> buffer_map;
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      if (i == index) {
+        params.push_back(data_param);
+        params.push_back(scale_param);
+        buffer_map.Set(data_param, data);
+        buffer_map.Set(scale_param, scale);
+      } else {
+        params.push_back(func->params[i]);
+        if (func->buffer_map.count(func->params[i])) {
+          buffer_map.Set(func->params[i], func->buffer_map.at(func->params[i]));
+        }
+      }
+    }
+    tir::PrimFuncNode* n = func.CopyOnWrite();
+    n->body = tir::WeightDequantizer::Rewrite(func->body, weight, data, scale, bits_,
+                                              reduction_axis, group_size);
+    n->params = std::move(params);
+    n->buffer_map = std::move(buffer_map);
+
+    GlobalVar new_gv = builder_->AddFunction(func, gv->name_hint + "_int" + std::to_string(bits_));
+    if (func->GetAttr<String>(tvm::attr::kGlobalSymbol).defined()) {
+      builder_->UpdateFunction(
+          new_gv, WithAttr(std::move(func), tvm::attr::kGlobalSymbol, new_gv->name_hint));
+    }
+    kernels_[key] = new_gv;
+    return new_gv;
+  }
+
+  /*! \brief The module holding the kernels. */
+  IRModule mod_;
+  /*! \brief The number of bits of the quantized values, 8 or 4. */
+  int bits_;
+  /*! \brief The default number of rows sharing a scale, 0 for one scale per channel. */
+  int64_t group_size_;
+  /*! \brief The function choosing the group size of each weight. */
+  Optional<runtime::PackedFunc> fcalibrate_;
+  /*! \brief The quantized weights. */
+  std::unordered_map<const ConstantNode*, QuantizedWeight> quantized_;
+  /*! \brief The dequantizing copies of the kernels. */
+  std::unordered_map<std::string, GlobalVar> kernels_;
+};
+
+namespace transform {
+
+Pass QuantizeWeights(int bits, int group_size, Optional<runtime::PackedFunc> fcalibrate) {
+  CHECK(bits == 8 || bits == 4) << "ValueError: QuantizeWeights expects 8 or 4 bits, but got "
+                                << bits;
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule m, PassContext pc) {
+        return WeightQuantizer(m, bits, group_size, fcalibrate).Rewrite();
+      };
+  return CreateModulePass(pass_func, 0, "QuantizeWeights", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.QuantizeWeights").set_body_typed(QuantizeWeights);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
@@ -0,0 +1,262 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/rematerialize.cc
+ * \brief Recompute the cheap intermediate tensors of dataflow blocks instead of keeping them live,
+ * bounding the peak activation memory of a block.
+ */
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/transform.h>
+#include <tvm/relax/utils.h>
+#include <tvm/tir/op.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+// ==================
+// Rematerializer
+// Greedily rematerialize the tensors live across the peak of the memory of a dataflow block, the
+// sum of the sizes of the tensors defined in the block which are live at a binding, until the
+// peak fits in the budget. A tensor T live across the peak is recomputed right before its first
+// use after the peak, so that it is dead at the peak, if it is computed by a call_tir of an
+// elementwise, broadcast or injective kernel whose inputs are live at that use anyway. Cheaper
+// patterns are preferred, then larger tensors.
+// Example, with a budget below the size of lv0 + lv1 + lv2:
+// lv0 = rx.call_tir(exp, (x,), (n, m), dtype="float32")
+// lv1 = rx.call_tir(dense, (lv0, w), (n, m), dtype="float32")
+// lv2 = rx.call_tir(dense, (lv1, w), (n, m), dtype="float32")
+// gv = rx.call_tir(add, (lv0, lv2), (n, m), dtype="float32")
+// -->
+// lv0 = rx.call_tir(exp, (x,), (n, m), dtype="float32")
+// lv1 = rx.call_tir(dense, (lv0, w), (n, m), dtype="float32")
+// lv2 = rx.call_tir(dense, (lv1, w), (n, m), dtype="float32")
+// lv0_remat = rx.call_tir(exp, (x,), (n, m), dtype="float32")
+// gv = rx.call_tir(add, (lv0_remat, lv2), (n, m), dtype="float32")
+
+class Rematerializer {
+ public:
+  Rematerializer(IRModule mod, int64_t memory_budget) : mod_(mod), memory_budget_(memory_budget) {}
+
+  DataflowBlock Transform(const DataflowBlock& block) {
+    bindings_ = std::vector<Binding>(block->bindings.begin(), block->bindings.end());
+    // Every step adds a binding, bound the steps in case the budget cannot be met.
+    size_t max_steps = bindings_.size();
+    bool changed = false;
+    for (size_t step = 0; step < max_steps; ++step) {
+      Analyze();
+      int peak = -1;
+      int64_t peak_bytes = PeakMemory(&peak);
+      if (peak_bytes <= memory_budget_) break;
+      if (!RematerializeAcross(peak)) {
+        VLOG(1) << "Rematerialize: the peak of " << peak_bytes << " bytes at binding " << peak
+                << " cannot be reduced below the budget of " << memory_budget_ << " bytes";
+        break;
+      }
+      changed = true;
+    }
+    if (!changed) return block;
+    return DataflowBlock(bindings_, block->span);
+  }
+
+ private:
+  /*! \brief The definition and uses of the var bound by a binding. */
+  struct VarInfo {
+    Var var;
+    std::vector<int> uses;
+    int64_t bytes = 0;
+    /*! \brief Whether the var is used after the block, hence live until its end. */
+    bool is_output = false;
+  };
+
+  /*! \brief Collect the var defined by every binding and the bindings using it. */
+  void Analyze() {
+    infos_.assign(bindings_.size(), VarInfo());
+    def_index_.clear();
+    for (int i = 0; i < static_cast<int>(bindings_.size()); ++i) {
+      for (const Var& used : FreeVars(BoundValue(bindings_[i]))) {
+        auto it = def_index_.find(used.get());
+        if (it != def_index_.end()) infos_[it->second].uses.push_back(i);
+      }
+      Var var;
+      if (const auto* var_binding = bindings_[i].as<VarBindingNode>()) {
+        var = var_binding->var;
+      } else if (const auto* match_shape = bindings_[i].as<MatchShapeNode>()) {
+        var = match_shape->var;
+      }
+      if (!var.defined()) continue;
+      def_index_[var.get()] = i;
+      infos_[i].var = var;
+      infos_[i].bytes = StaticBytes(var);
+      infos_[i].is_output = !var->IsInstance<DataflowVarNode>();
+    }
+  }
+
+  /*! \brief The index of the last binding at which the var defined by binding i is live. */
+  int LastUse(int i) const {
+    const VarInfo& info = infos_[i];
+    if (info.is_output) return static_cast<int>(bindings_.size()) - 1;
+    return info.uses.empty() ? i : info.uses.back();
+  }
+
+  /*! \brief Get the peak memory of the block and the index of the binding it is reached at. */
+  int64_t PeakMemory(int* peak) const {
+    std::vector<int64_t> delta(bindings_.size() + 1, 0);
+    for (int i = 0; i < static_cast<int>(infos_.size()); ++i) {
+      if (infos_[i].bytes == 0) continue;
+      delta[i] += infos_[i].bytes;
+      delta[LastUse(i) + 1] -= infos_[i].bytes;
+    }
+    int64_t live = 0, peak_bytes = 0;
+    for (int i = 0; i < static_cast<int>(bindings_.size()); ++i) {
+      live += delta[i];
+      if (live > peak_bytes) {
+        peak_bytes = live;
+        *peak = i;
+      }
+    }
+    return peak_bytes;
+  }
+
+  /*!
+   * \brief Rematerialize the best tensor live across a binding.
+   * \return Whether a tensor could be rematerialized.
+   */
+  bool RematerializeAcross(int peak) {
+    int best = -1, best_use = -1, best_pattern = 0;
+    for (int i = 0; i < peak; ++i) {
+      const VarInfo& info = infos_[i];
+      if (info.bytes == 0 || info.is_output) continue;
+      // The tensor should not be used at the peak, and be used after it.
+      auto next = std::upper_bound(info.uses.begin(), info.uses.end(), peak);
+      if (next == info.uses.end() || (next != info.uses.begin() && *(next - 1) == peak)) continue;
+      int pattern = RecomputePattern(bindings_[i]);
+      if (pattern < 0 || !InputsLiveAt(bindings_[i], *next)) continue;
+      if (best == -1 || pattern < best_pattern ||
+          (pattern == best_pattern && info.bytes > infos_[best].bytes)) {
+        best = i;
+        best_use = *next;
+        best_pattern = pattern;
+      }
+    }
+    if (best == -1) return false;
+
+    const Var& var = infos_[best].var;
+    Optional<Expr> shape;
+    if (var->shape_.defined()) shape = Downcast<Expr>(var->shape_.value());
+    DataflowVar remat(var->name_hint() + "_remat", shape, var->checked_type_, var->span);
+    Map<Var, Expr> binds{{var, remat}};
+    for (int i = best_use; i < static_cast<int>(bindings_.size()); ++i) {
+      if (const auto* var_binding = bindings_[i].as<VarBindingNode>()) {
+        bindings_[i] = VarBinding(var_binding->var, Bind(var_binding->value, binds));
+      } else if (const auto* match_shape = bindings_[i].as<MatchShapeNode>()) {
+        bindings_[i] =
+            MatchShape(Bind(match_shape->value, binds), match_shape->pattern, match_shape->var);
+      }
+    }
+    Expr value = Downcast<VarBinding>(bindings_[best])->value;
+    bindings_.insert(bindings_.begin() + best_use, VarBinding(remat, value));
+    return true;
+  }
+
+  /*!
+   * \brief Get the cost of recomputing the value of a binding, the op pattern of its kernel.
+   * \return The op pattern, or -1 if the value is not a call_tir of a cheap kernel.
+   */
+  int RecomputePattern(const Binding& binding) const {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    const auto* var_binding = binding.as<VarBindingNode>();
+    if (var_binding == nullptr) return -1;
+    const auto* call = var_binding->value.as<CallNode>();
+    if (call == nullptr || call->op != call_tir_op) return -1;
+    const auto* gv = call->args[0].as<GlobalVarNode>();
+    if (gv == nullptr) return -1;
+    auto it = mod_->functions.find(GetRef<GlobalVar>(gv));
+    if (it == mod_->functions.end()) return -1;
+    const auto* func = (*it).second.as<tir::PrimFuncNode>();
+    if (func == nullptr) return -1;
+    int pattern;
+    if (Optional<Integer> opt_pattern = func->GetAttr<Integer>("op_pattern")) {
+      pattern = static_cast<int>(opt_pattern.value()->value);
+    } else {
+      pattern = static_cast<int>(AnalyzeOpPatternKind(GetRef<tir::PrimFunc>(func)));
+    }
+    return pattern <= static_cast<int>(relay::kInjective) ? pattern : -1;
+  }
+
+  /*! \brief Whether the inputs of a binding defined in the block are live at binding index. */
+  bool InputsLiveAt(const Binding& binding, int index) const {
+    for (const Var& input : FreeVars(BoundValue(binding))) {
+      auto it = def_index_.find(input.get());
+      if (it != def_index_.end() && LastUse(it->second) < index) return false;
+    }
+    return true;
+  }
+
+  /*! \brief The value bound by a binding. */
+  static Expr BoundValue(const Binding& binding) {
+    if (const auto* var_binding = binding.as<VarBindingNode>()) return var_binding->value;
+    return Downcast<MatchShape>(binding)->value;
+  }
+
+  /*! \brief The size in bytes of a tensor var of static shape, 0 if unknown. */
+  static int64_t StaticBytes(const Var& var) {
+    const auto* type = var->checked_type_.as<DynTensorTypeNode>();
+    const auto* shape = var->shape_.as<ShapeExprNode>();
+    if (type == nullptr || shape == nullptr || type->dtype.is_void()) return 0;
+    int64_t num_elem = 1;
+    for (const PrimExpr& dim : shape->values) {
+      const int64_t* value = tir::as_const_int(dim);
+      if (value == nullptr) return 0;
+      num_elem *= *value;
+    }
+    return num_elem * ((type->dtype.bits() * type->dtype.lanes() + 7) / 8);
+  }
+
+  /*! \brief The module holding the kernels. */
+  IRModule mod_;
+  /*! \brief The maximal number of bytes of the tensors of a block live at once. */
+  int64_t memory_budget_;
+  /*! \brief The bindings of the block being transformed. */
+  std::vector<Binding> bindings_;
+  /*! \brief The var defined by each binding, indexed as bindings_. */
+  std::vector<VarInfo> infos_;
+  /*! \brief The index of the binding defining each var. */
+  std::unordered_map<const VarNode*, int> def_index_;
+};
+
+namespace transform {
+
+Pass Rematerialize(int64_t memory_budget) {
+  runtime::TypedPackedFunc<DataflowBlock(DataflowBlock, IRModule, PassContext)> pass_func =
+      [=](DataflowBlock block, IRModule m, PassContext pc) {
+        return Rematerializer(m, memory_budget).Transform(block);
+      };
+  return CreateDataflowBlockPass(pass_func, 0, "Rematerialize", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.Rematerialize").set_body_typed(Rematerialize);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
@@ -26,6 +26,7 @@
 #include <tvm/relax/expr_functor.h>
 
 #include <iostream>
+#include <unordered_map>
 
 namespace tvm {
 namespace relax {
@@ -64,7 +65,9 @@ class CodeGenRunner : ExprMutator {
       const GlobalVar gvar = GetRef<GlobalVar>(gvarnode);
       // TODO(@sunggg): Is there any better way to get this func?
       Function func = Downcast<Function>(builder_->GetContextIRModule()->Lookup(gvar));
-      Expr new_op = VisitExpr(func);
+      // A function called more than once is only compiled by the first call.
+      auto it = extern_funcs_.find(gvarnode);
+      Expr new_op = it != extern_funcs_.end() ? it->second : VisitExpr(func);
       if (new_op->IsInstance<ExternFuncNode>()) {
         Array<Expr> new_args({new_op});
         Array<Expr> tmp_args;
@@ -84,6 +87,7 @@ class CodeGenRunner : ExprMutator {
         func = (*RemoveFuncAttrFunc)(func, tvm::attr::kGlobalSymbol);
         func = (*RemoveFuncAttrFunc)(func, attr::kCodegen);
         builder_->UpdateFunction(gvar, func);
+        extern_funcs_[gvarnode] = new_op;
 
         return Call(call_op, new_args, tvm::Attrs(), {func->ret_type});
       }
@@ -124,6 +128,8 @@ class CodeGenRunner : ExprMutator {
   Array<runtime::String> entry_functions_;
   std::unordered_set<std::string> target_codegens_;
   Array<runtime::Module> ext_mods_;
+  /*! \brief The external function each offloaded global function was compiled into. */
+  std::unordered_map<const GlobalVarNode*, Expr> extern_funcs_;
 };
 
 }  // namespace relax
@@ -0,0 +1,212 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/simplify_algebra.cc
+ * \brief Remove the arithmetic with identity constants, e.g. x * 1 and x + 0.
+ */
+#include <tvm/arith/analyzer.h>
+#include <tvm/relax/dataflow_matcher.h>
+#include <tvm/relax/dataflow_pattern.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+
+#include <functional>
+#include <vector>
+
+namespace tvm {
+namespace relax {
+
+/*! \brief Whether the expression is a constant tensor whose every element equals \p value. */
+static bool IsConstantOf(const Expr& expr, double value) {
+  const auto* constant = expr.as<ConstantNode>();
+  if (constant == nullptr) return false;
+  runtime::NDArray data = constant->data;
+  if (data->device.device_type != kDLCPU) {
+    data = data.CopyTo(Device{kDLCPU, 0});
+  }
+  int64_t size = 1;
+  for (int i = 0; i < data->ndim; ++i) {
+    size *= data->shape[i];
+  }
+  DataType dtype(data->dtype);
+  auto f_all_of = [&](auto* values) {
+    for (int64_t i = 0; i < size; ++i) {
+      if (static_cast<double>(values[i]) != value) return false;
+    }
+    return true;
+  };
+  void* values = static_cast<char*>(data->data) + data->byte_offset;
+  if (dtype == DataType::Float(32)) return f_all_of(static_cast<float*>(values));
+  if (dtype == DataType::Float(64)) return f_all_of(static_cast<double*>(values));
+  if (dtype == DataType::Int(32)) return f_all_of(static_cast<int32_t*>(values));
+  if (dtype == DataType::Int(64)) return f_all_of(static_cast<int64_t*>(values));
+  return false;
+}
+
+/*!
+ * \brief Whether the result of the call can be replaced by the operand, i.e. the operand has the
+ * same shape and type, so that the constant it is combined with does not broadcast it.
+ */
+static bool IsSameTensor(const Expr& call, const Expr& operand) {
+  const auto* call_type = call->checked_type_.as<DynTensorTypeNode>();
+  const auto* operand_type = operand->checked_type_.as<DynTensorTypeNode>();
+  if (call_type == nullptr || operand_type == nullptr || call_type->dtype != operand_type->dtype) {
+    return false;
+  }
+  const auto* call_shape = call->shape_.as<ShapeExprNode>();
+  const auto* operand_shape = operand->shape_.as<ShapeExprNode>();
+  if (call_shape == nullptr || operand_shape == nullptr ||
+      call_shape->values.size() != operand_shape->values.size()) {
+    return false;
+  }
+  arith::Analyzer analyzer;
+  for (size_t i = 0; i < call_shape->values.size(); ++i) {
+    if (!analyzer.CanProveEqual(call_shape->values[i], operand_shape->values[i])) return false;
+  }
+  return true;
+}
+
+// ==================
+// AlgebraSimplifier
+// Every binding of a call is matched against the dataflow patterns of the rules, seeing through
+// the bindings of the constants, and the first rule which applies rewrites it. A call simplified
+// to one of its operands is dropped when it binds a dataflow var, whose uses are remapped to the
+// operand, so the kernel computing it and the memory pass it costs disappear.
+// Example:
+// with R.dataflow():
+//   lv0 = R.multiply(x, ones)
+//   lv1 = R.add(lv0, zeros)
+//   gv = R.ewise_fma(lv1, ones, y)
+//   R.output(gv)
+// -->
+// with R.dataflow():
+//   gv = R.add(x, y)
+//   R.output(gv)
+
+class AlgebraSimplifier : public ExprMutator {
+ public:
+  AlgebraSimplifier() {
+    DFPattern lhs = Wildcard(), rhs = Wildcard(), third = Wildcard();
+    // x * 1, 1 * x and x + 0, 0 + x are x unless the constant broadcasts x.
+    auto f_identity = [](int kept, int other, double value) {
+      return [=](const Call& call, const Array<Expr>& args) -> Optional<Expr> {
+        if (IsConstantOf(args[other], value) && IsSameTensor(call, call->args[kept])) {
+          return call->args[kept];
+        }
+        return NullOpt;
+      };
+    };
+    rules_.push_back({IsOp("relax.multiply")(lhs, IsConst()), f_identity(0, 1, 1.0)});
+    rules_.push_back({IsOp("relax.multiply")(IsConst(), rhs), f_identity(1, 0, 1.0)});
+    rules_.push_back({IsOp("relax.add")(lhs, IsConst()), f_identity(0, 1, 0.0)});
+    rules_.push_back({IsOp("relax.add")(IsConst(), rhs), f_identity(1, 0, 0.0)});
+    // ewise_fma(a, b, c) with a constant 1 factor is an add, with a constant 0 addend a multiply.
+    static const Op& add_op = Op::Get("relax.add");
+    static const Op& multiply_op = Op::Get("relax.multiply");
+    auto f_fma = [](int constant, double value, Op op, int first, int second) {
+      return [=](const Call& call, const Array<Expr>& args) -> Optional<Expr> {
+        if (IsConstantOf(args[constant], value) &&
+            IsSameTensor(call, call->args[constant == 2 ? 0 : 2])) {
+          return Call(op, {call->args[first], call->args[second]});
+        }
+        return NullOpt;
+      };
+    };
+    DFPattern fma = IsOp("relax.ewise_fma");
+    rules_.push_back({fma(IsConst(), rhs, third), f_fma(0, 1.0, add_op, 1, 2)});
+    rules_.push_back({fma(lhs, IsConst(), third), f_fma(1, 1.0, add_op, 0, 2)});
+    rules_.push_back({fma(lhs, rhs, IsConst()), f_fma(2, 0.0, multiply_op, 0, 1)});
+  }
+
+  void VisitBinding_(const VarBindingNode* binding) final {
+    Expr new_value = this->VisitExpr(binding->value);
+    // A call may simplify to a call which simplifies again, e.g. ewise_fma(x, 1, 0).
+    for (Optional<Expr> simplified; (simplified = Simplify(new_value)).defined();) {
+      new_value = builder_->Normalize(simplified.value());
+      if (!new_value->IsInstance<CallNode>()) break;
+    }
+    if (new_value->IsInstance<VarNode>() && binding->var->IsInstance<DataflowVarNode>()) {
+      var_remap_[binding->var->vid] = Downcast<Var>(new_value);
+      return;
+    }
+    Var var = this->VisitVarDef(binding->var);
+    if (!new_value.same_as(binding->value)) {
+      Var temp = WithShapeAndType(var, new_value->shape_, new_value->checked_type_);
+      if (!temp.same_as(var)) {
+        var = temp;
+        var_remap_[binding->var->vid] = var;
+      }
+    }
+    VarBinding new_binding(var, new_value, binding->span);
+    if (builder_->CurrentBlockIsDataFlow() && !var->IsInstance<DataflowVarNode>()) {
+      builder_->EmitOutput(new_binding);
+    } else {
+      builder_->Emit(new_binding);
+    }
+    var2val_.Set(var, new_value);
+  }
+
+ private:
+  /*! \brief The rewriting of a call matched by a pattern, with the values of its arguments. */
+  using FRewrite = std::function<Optional<Expr>(const Call&, const Array<Expr>&)>;
+
+  struct Rule {
+    DFPattern pattern;
+    FRewrite rewrite;
+  };
+
+  Optional<Expr> Simplify(const Expr& value) {
+    const auto* call = value.as<CallNode>();
+    if (call == nullptr || !call->op->IsInstance<OpNode>()) return NullOpt;
+    Array<Expr> args;
+    for (const Expr& arg : call->args) {
+      const auto* var = arg.as<VarNode>();
+      args.push_back(var != nullptr ? var2val_.Get(GetRef<Var>(var)).value_or(arg) : arg);
+    }
+    for (const Rule& rule : rules_) {
+      if (!MatchExpr(rule.pattern, value, var2val_)) continue;
+      if (Optional<Expr> simplified = rule.rewrite(GetRef<Call>(call), args)) return simplified;
+    }
+    return NullOpt;
+  }
+
+  /*! \brief The rules, tried in order. */
+  std::vector<Rule> rules_;
+  /*! \brief The values of the vars bound so far, to see through the bindings of constants. */
+  Map<Var, Expr> var2val_;
+};
+
+Expr SimplifyAlgebra(const Expr& e) { return AlgebraSimplifier().VisitExpr(e); }
+
+namespace transform {
+
+Pass SimplifyAlgebra() {
+  runtime::TypedPackedFunc<Function(Function, IRModule, PassContext)> pass_func =
+      [=](Function f, IRModule m, PassContext pc) {
+        return Downcast<Function>(relax::SimplifyAlgebra(f));
+      };
+  return CreateFunctionPass(pass_func, 0, "SimplifyAlgebra", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.SimplifyAlgebra").set_body_typed(SimplifyAlgebra);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
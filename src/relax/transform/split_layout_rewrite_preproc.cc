@@ -0,0 +1,307 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/split_layout_rewrite_preproc.cc
+ * \brief Move the weight layout rewrite blocks of the kernels into kernels of their own.
+ */
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace tir {
+
+/*!
+ * \brief Split a kernel scheduled with RewriteLayout into the kernels rewriting the layout of its
+ * weights, i.e. the top-level statements of the root block made of layout rewrite blocks, and
+ * the kernel computing on the rewritten weights, like RemoveWeightLayoutRewriteBlock does.
+ */
+class LayoutRewritePreprocSplitter {
+ public:
+  /*! \brief A kernel rewriting the layout of the weight bound to a param. */
+  struct Preproc {
+    /*! \brief The index of the param. */
+    size_t param_index;
+    /*! \brief The kernel, from the weight to its rewritten layout. */
+    PrimFunc func;
+    /*! \brief The rewritten buffer. */
+    Buffer buffer;
+  };
+
+  /*! \brief The split kernel. */
+  struct Result {
+    PrimFunc compute;
+    std::vector<Preproc> preprocs;
+  };
+
+  /*! \return Whether the kernel rewrites a weight and is split into \p result. */
+  static bool Split(const PrimFunc& func, Result* result) {
+    const auto* realize = func->body.as<BlockRealizeNode>();
+    if (realize == nullptr) return false;
+    const Block& root = realize->block;
+    Array<Stmt> stmts;
+    if (const auto* seq = root->body.as<SeqStmtNode>()) {
+      stmts = seq->seq;
+    } else {
+      stmts = {root->body};
+    }
+
+    std::unordered_map<const BufferNode*, size_t> param_index;
+    for (size_t i = 0; i < func->params.size(); ++i) {
+      if (func->buffer_map.count(func->params[i])) {
+        param_index[func->buffer_map.at(func->params[i]).get()] = i;
+      }
+    }
+    std::unordered_set<const BufferNode*> root_allocs;
+    for (const Buffer& buffer : root->alloc_buffers) root_allocs.insert(buffer.get());
+
+    std::unordered_set<const BufferNode*> rewritten;
+    Map<Buffer, Buffer> buffer_replace;
+    Array<Stmt> compute_stmts;
+    for (const Stmt& stmt : stmts) {
+      std::vector<const BlockNode*> blocks;
+      int num_preproc = 0;
+      PreOrderVisit(stmt, [&](const ObjectRef& node) {
+        if (const auto* block = node.as<BlockNode>()) {
+          blocks.push_back(block);
+          auto it = block->annotations.find(attr::meta_schedule_layout_rewrite_preproc);
+          if (it != block->annotations.end() && is_one(Downcast<PrimExpr>((*it).second))) {
+            ++num_preproc;
+          }
+        }
+        return true;
+      });
+      if (num_preproc == 0) {
+        compute_stmts.push_back(stmt);
+        continue;
+      }
+      if (num_preproc != 1 || blocks.size() != 1) return false;
+      const BlockNode* block = blocks[0];
+      const auto* store = block->body.as<BufferStoreNode>();
+      const auto* load = store ? store->value.as<BufferLoadNode>() : nullptr;
+      if (load == nullptr || !block->alloc_buffers.empty() || !block->match_buffers.empty()) {
+        return false;
+      }
+      auto it_param = param_index.find(load->buffer.get());
+      if (it_param == param_index.end() || !root_allocs.count(store->buffer.get()) ||
+          rewritten.count(store->buffer.get())) {
+        return false;
+      }
+      // The caller allocates the rewritten weight, so its shape has to be known.
+      for (const PrimExpr& dim : store->buffer->shape) {
+        if (!dim->IsInstance<IntImmNode>()) return false;
+      }
+      rewritten.insert(store->buffer.get());
+      buffer_replace.Set(load->buffer, store->buffer);
+      result->preprocs.push_back(
+          {it_param->second, MakePreproc(func->params[it_param->second], load->buffer,
+                                         store->buffer, stmt),
+           store->buffer});
+    }
+    if (result->preprocs.empty()) return false;
+
+    Array<Buffer> alloc_buffers;
+    for (const Buffer& buffer : root->alloc_buffers) {
+      if (!rewritten.count(buffer.get())) alloc_buffers.push_back(buffer);
+    }
+    Block new_root = root;
+    BlockNode* n_root = new_root.CopyOnWrite();
+    n_root->body = compute_stmts.size() == 1 ? compute_stmts[0] : SeqStmt(compute_stmts);
+    n_root->alloc_buffers = std::move(alloc_buffers);
+    BlockRealize new_realize = GetRef<BlockRealize>(realize);
+    new_realize.CopyOnWrite()->block = new_root;
+
+    PrimFunc compute = func;
+    PrimFuncNode* n = compute.CopyOnWrite();
+    n->body = new_realize;
+    Map<Var, Buffer> buffer_map;
+    for (const auto& kv : func->buffer_map) {
+      auto it = buffer_replace.find(kv.second);
+      buffer_map.Set(kv.first, it != buffer_replace.end() ? (*it).second : kv.second);
+    }
+    n->buffer_map = std::move(buffer_map);
+    // The weights of the kernel are in their final layout.
+    result->compute = WithoutAttr(std::move(compute), "layout_free_buffers");
+    return true;
+  }
+
+ private:
+  /*! \brief Make the kernel running the layout rewrite \p stmt from \p src to \p dst. */
+  static PrimFunc MakePreproc(const Var& src_param, const Buffer& src, const Buffer& dst,
+                              const Stmt& stmt) {
+    Var dst_param("p_" + dst->name, PrimType(DataType::Handle()));
+    Block root({}, {}, {}, "root", stmt);
+    PrimFunc func({src_param, dst_param}, BlockRealize({}, Bool(true), root), VoidType(),
+                  {{src_param, src}, {dst_param, dst}});
+    return WithAttr(std::move(func), "tir.noalias", Bool(true));
+  }
+};
+
+}  // namespace tir
+
+namespace relax {
+
+// ==================
+// LayoutRewritePreprocSplitter
+// Call the layout rewrite of each weight of a kernel scheduled with RewriteLayout as a kernel of
+// its own, before the kernel which now takes the rewritten weight. The layout of a constant weight
+// is then rewritten once by FoldConstant instead of on every call of the kernel.
+// Example:
+// lv0 = rx.call_tir(dense, (x, c0), (n, m), dtype="float32")
+// -->
+// c0_packed = rx.call_tir(dense_weight_layout_rewrite0, (c0,), (m // 4, k, 4), dtype="float32")
+// lv0 = rx.call_tir(dense, (x, c0_packed), (n, m), dtype="float32")
+
+class LayoutRewritePreprocSplitter : public ExprMutator {
+ public:
+  explicit LayoutRewritePreprocSplitter(IRModule mod) : ExprMutator(mod), mod_(mod) {}
+
+  IRModule Rewrite() {
+    CountUses();
+    for (const auto& kv : mod_->functions) {
+      if (const auto* func = kv.second.as<FunctionNode>()) {
+        Function new_func = Downcast<Function>(VisitExpr(GetRef<Function>(func)));
+        if (!new_func.same_as(kv.second)) builder_->UpdateFunction(kv.first, new_func);
+      }
+    }
+    for (const auto& kv : split_) {
+      if (kv.second.split) builder_->UpdateFunction(GetRef<GlobalVar>(kv.first), kv.second.compute);
+    }
+    return builder_->GetContextIRModule();
+  }
+
+  using ExprMutator::VisitExpr_;
+
+  Expr VisitExpr_(const CallNode* op) final {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    Call call = Downcast<Call>(ExprMutator::VisitExpr_(op));
+    if (call->op != call_tir_op || call->args.size() != 3) return call;
+    const auto* gv = call->args[0].as<GlobalVarNode>();
+    const auto* inputs = call->args[1].as<TupleNode>();
+    if (gv == nullptr || inputs == nullptr) return call;
+    const SplitKernel& split = GetSplit(GetRef<GlobalVar>(gv));
+    if (!split.split) return call;
+
+    Array<Expr> new_inputs = inputs->fields;
+    for (const Preproc& preproc : split.preprocs) {
+      ICHECK_LT(preproc.param_index, new_inputs.size());
+      const Expr& weight = new_inputs[preproc.param_index];
+      const tir::Buffer& buffer = preproc.buffer;
+      Call rewrite(call_tir_op, {preproc.gv, Tuple({weight}), ShapeExpr(buffer->shape)}, {},
+                   {DynTensorType(buffer->shape.size(), buffer->dtype)});
+      const auto* var = weight.as<VarNode>();
+      new_inputs.Set(preproc.param_index,
+                     builder_->Emit(rewrite, (var ? var->name_hint() : "weight") + "_packed"));
+    }
+    return Call(call_tir_op, {call->args[0], Tuple(new_inputs), call->args[2]}, call->attrs,
+                call->type_args, call->span);
+  }
+
+ private:
+  /*! \brief A layout rewrite kernel added to the module. */
+  struct Preproc {
+    size_t param_index;
+    GlobalVar gv;
+    tir::Buffer buffer;
+  };
+
+  /*! \brief The split of a kernel. */
+  struct SplitKernel {
+    /*! \brief Whether the kernel is split, otherwise it is kept. */
+    bool split{false};
+    tir::PrimFunc compute;
+    std::vector<Preproc> preprocs;
+  };
+
+  /*!
+   * \brief Count the references to the kernels besides being called by a call_tir, as the kernels
+   * are replaced in place and those references would see the kernel taking the rewritten weights.
+   */
+  void CountUses() {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    for (const auto& kv : mod_->functions) {
+      if (!kv.second->IsInstance<FunctionNode>()) continue;
+      PostOrderVisit(Downcast<Function>(kv.second), [this](const Expr& e) {
+        if (const auto* gv = e.as<GlobalVarNode>()) {
+          ++other_uses_[gv];
+        } else if (const auto* call = e.as<CallNode>()) {
+          if (call->op == call_tir_op && !call->args.empty()) {
+            if (const auto* gv = call->args[0].as<GlobalVarNode>()) --other_uses_[gv];
+          }
+        }
+      });
+    }
+  }
+
+  /*! \brief Get the split of the kernel \p gv, splitting it on the first call. */
+  const SplitKernel& GetSplit(const GlobalVar& gv) {
+    auto it = split_.find(gv.get());
+    if (it != split_.end()) return it->second;
+    SplitKernel split;
+    tir::LayoutRewritePreprocSplitter::Result result;
+    auto it_func = mod_->functions.find(gv);
+    const auto* func =
+        it_func != mod_->functions.end() ? (*it_func).second.as<tir::PrimFuncNode>() : nullptr;
+    if (func != nullptr && other_uses_[gv.get()] == 0 &&
+        tir::LayoutRewritePreprocSplitter::Split(GetRef<tir::PrimFunc>(func), &result)) {
+      split.split = true;
+      split.compute = result.compute;
+      for (size_t i = 0; i < result.preprocs.size(); ++i) {
+        const auto& preproc = result.preprocs[i];
+        String name = gv->name_hint + "_weight_layout_rewrite" + std::to_string(i);
+        GlobalVar preproc_gv = builder_->AddFunction(preproc.func, name);
+        builder_->UpdateFunction(preproc_gv, WithAttr(preproc.func, tvm::attr::kGlobalSymbol,
+                                                      preproc_gv->name_hint));
+        split.preprocs.push_back({preproc.param_index, preproc_gv, preproc.buffer});
+      }
+    }
+    return split_.emplace(gv.get(), std::move(split)).first->second;
+  }
+
+  /*! \brief The module holding the kernels. */
+  IRModule mod_;
+  /*! \brief The number of references to each kernel besides the call_tirs. */
+  std::unordered_map<const GlobalVarNode*, int> other_uses_;
+  /*! \brief The split of each called kernel. */
+  std::unordered_map<const GlobalVarNode*, SplitKernel> split_;
+};
+
+namespace transform {
+
+Pass SplitLayoutRewritePreproc() {
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule mod, PassContext pc) {
+        return LayoutRewritePreprocSplitter(std::move(mod)).Rewrite();
+      };
+  return CreateModulePass(pass_func, 0, "SplitLayoutRewritePreproc", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.SplitLayoutRewritePreproc")
+    .set_body_typed(SplitLayoutRewritePreproc);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
@@ -0,0 +1,358 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/relax/transform/to_mixed_precision.cc
+ * \brief Run the compute-bound kernels on fp16 or bf16 inputs with fp32 accumulation.
+ */
+#include <tvm/relax/analysis.h>
+#include <tvm/relax/expr_functor.h>
+#include <tvm/relax/transform.h>
+#include <tvm/relay/op_attr_types.h>
+#include <tvm/runtime/builtin_fp16.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/topi/elemwise.h>
+
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../../te/operation/create_primfunc.h"
+#include "../../tir/ir/functor_common.h"
+
+namespace tvm {
+namespace tir {
+
+/*!
+ * \brief Narrow the float32 input buffers of a PrimFunc to a low precision type. Every load of
+ * such a buffer is cast back to float32, so the arithmetic and the outputs stay in float32.
+ */
+class InputBufferNarrower : private StmtExprMutator {
+ public:
+  /*!
+   * \brief Narrow the inputs of \p func at \p indices to \p dtype.
+   * \return The narrowed function, or NullOpt if a buffer is accessed other than by loads.
+   */
+  static Optional<PrimFunc> Narrow(const PrimFunc& func, const std::vector<int>& indices,
+                                   DataType dtype) {
+    InputBufferNarrower narrower;
+    Map<Var, Buffer> buffer_map = func->buffer_map;
+    for (int index : indices) {
+      const Var& param = func->params[index];
+      Buffer buffer = func->buffer_map.at(param);
+      ObjectPtr<BufferNode> n = make_object<BufferNode>(*buffer.get());
+      n->data = Var(buffer->data->name_hint, PointerType(PrimType(dtype)));
+      n->dtype = dtype;
+      Buffer narrowed(n);
+      narrower.buffer_map_[buffer.get()] = narrowed;
+      narrower.data_vars_.insert(buffer->data.get());
+      buffer_map.Set(param, narrowed);
+    }
+    Stmt body = narrower(func->body);
+    if (narrower.failed_) return NullOpt;
+    PrimFunc new_func = func;
+    PrimFuncNode* n = new_func.CopyOnWrite();
+    n->body = std::move(body);
+    n->buffer_map = std::move(buffer_map);
+    return new_func;
+  }
+
+ private:
+  PrimExpr VisitExpr_(const VarNode* op) final {
+    // The data pointer of a narrowed buffer is used directly, e.g. by an extern call.
+    if (data_vars_.count(op)) failed_ = true;
+    return GetRef<PrimExpr>(op);
+  }
+
+  PrimExpr VisitExpr_(const BufferLoadNode* op) final {
+    BufferLoad load = Downcast<BufferLoad>(StmtExprMutator::VisitExpr_(op));
+    auto it = buffer_map_.find(load->buffer.get());
+    if (it == buffer_map_.end()) return std::move(load);
+    DataType dtype = load->dtype;
+    BufferLoadNode* n = load.CopyOnWrite();
+    n->buffer = it->second;
+    n->dtype = it->second->dtype.with_lanes(dtype.lanes());
+    return Cast(dtype, std::move(load));
+  }
+
+  Stmt VisitStmt_(const BufferStoreNode* op) final {
+    if (buffer_map_.count(op->buffer.get())) failed_ = true;
+    return StmtExprMutator::VisitStmt_(op);
+  }
+
+  Stmt VisitStmt_(const BlockNode* op) final {
+    Block block = Downcast<Block>(StmtExprMutator::VisitStmt_(op));
+    for (const MatchBufferRegion& match_buffer : block->match_buffers) {
+      // A sub-buffer keeps the dtype of its source, narrowing it would change its type.
+      if (buffer_map_.count(match_buffer->source->buffer.get())) failed_ = true;
+    }
+    auto f_mutate_region = [this](const BufferRegion& region) {
+      auto it = buffer_map_.find(region->buffer.get());
+      return it == buffer_map_.end() ? region : BufferRegion(it->second, region->region);
+    };
+    Array<BufferRegion> reads = MutateArray(block->reads, f_mutate_region);
+    Array<BufferRegion> writes = MutateArray(block->writes, f_mutate_region);
+    if (reads.same_as(block->reads) && writes.same_as(block->writes)) return std::move(block);
+    BlockNode* n = block.CopyOnWrite();
+    n->reads = std::move(reads);
+    n->writes = std::move(writes);
+    return std::move(block);
+  }
+
+  /*! \brief The map from the narrowed buffers to their replacements. */
+  std::unordered_map<const BufferNode*, Buffer> buffer_map_;
+  /*! \brief The data vars of the narrowed buffers. */
+  std::unordered_set<const VarNode*> data_vars_;
+  /*! \brief Whether a narrowed buffer is accessed in a way the narrowing cannot handle. */
+  bool failed_{false};
+};
+
+}  // namespace tir
+
+namespace relax {
+
+// ==================
+// MixedPrecisionRewriter
+// Feed the float32 inputs of the compute-bound call_tirs, e.g. dense, matmul or conv, in fp16 or
+// bf16 to a copy of the kernel which casts the loaded elements back to float32. The products are
+// accumulated and written in float32, so the outputs and every other kernel, notably the
+// numerically sensitive ones like softmax, exp or the reductions, are unchanged. The constant
+// inputs are converted ahead of time, the others are cast by an emitted call_tir.
+// Example:
+// lv0 = rx.call_tir(dense, (x, c0), (n, m), dtype="float32")
+// -->
+// lv1 = rx.call_tir(cast, (x), x.shape, dtype="float16")
+// lv0 = rx.call_tir(dense_float16, (lv1, c1), (n, m), dtype="float32")
+// where c1 is the float16 value of c0.
+
+class MixedPrecisionRewriter : public ExprMutator {
+ public:
+  MixedPrecisionRewriter(IRModule mod, DataType dtype, Map<String, String> policy)
+      : ExprMutator(mod), mod_(mod), dtype_(dtype), policy_(policy) {
+    for (const auto& kv : policy) {
+      CHECK(kv.second == "always" || kv.second == "never")
+          << "ValueError: The mixed precision policy of " << kv.first
+          << " must be \"always\" or \"never\", but got " << kv.second;
+    }
+  }
+
+  IRModule Rewrite() {
+    for (const auto& kv : mod_->functions) {
+      if (const auto* func = kv.second.as<FunctionNode>()) {
+        Function new_func = Downcast<Function>(VisitExpr(GetRef<Function>(func)));
+        if (!new_func.same_as(kv.second)) builder_->UpdateFunction(kv.first, new_func);
+      }
+    }
+    return builder_->GetContextIRModule();
+  }
+
+  using ExprMutator::VisitExpr_;
+
+  Expr VisitExpr_(const CallNode* op) final {
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    Call call = Downcast<Call>(ExprMutator::VisitExpr_(op));
+    if (call->op != call_tir_op || call->attrs.defined() || call->args.size() != 3) return call;
+    const auto* gv = call->args[0].as<GlobalVarNode>();
+    const auto* inputs = call->args[1].as<TupleNode>();
+    if (gv == nullptr || inputs == nullptr) return call;
+    const Variant& variant = GetVariant(GetRef<GlobalVar>(gv), inputs->fields.size());
+    if (!variant.gv.defined()) return call;
+
+    for (int index : variant.indices) {
+      if (!CanNarrow(inputs->fields[index])) return call;
+    }
+    Array<Expr> new_inputs = inputs->fields;
+    for (int index : variant.indices) {
+      new_inputs.Set(index, NarrowInput(new_inputs[index]));
+    }
+    return Call(call_tir_op, {variant.gv.value(), Tuple(new_inputs), call->args[2]}, call->attrs,
+                call->type_args, call->span);
+  }
+
+  BindingBlock VisitBindingBlock(const BindingBlock& block) final {
+    BindingBlock ret = ExprMutator::VisitBindingBlock(block);
+    // The casted vars were bound in the block, they are out of scope in the next one.
+    casted_.clear();
+    return ret;
+  }
+
+ private:
+  /*! \brief The low precision copy of a kernel. */
+  struct Variant {
+    /*! \brief The copy, undefined if the kernel is kept as is. */
+    Optional<GlobalVar> gv;
+    /*! \brief The indices of the narrowed inputs. */
+    std::vector<int> indices;
+  };
+
+  /*!
+   * \brief Get the low precision copy of the kernel \p gv taking \p num_inputs inputs, creating
+   * it on the first call.
+   */
+  const Variant& GetVariant(const GlobalVar& gv, size_t num_inputs) {
+    auto it = variants_.find(gv.get());
+    if (it != variants_.end()) return it->second;
+    Variant& variant = variants_[gv.get()];
+    auto it_func = mod_->functions.find(gv);
+    if (it_func == mod_->functions.end()) return variant;
+    const auto* func = (*it_func).second.as<tir::PrimFuncNode>();
+    if (func == nullptr || !IsConverted(gv, GetRef<tir::PrimFunc>(func))) return variant;
+
+    // The params following the inputs are the outputs, they stay float32.
+    for (size_t i = 0; i < num_inputs && i < func->params.size(); ++i) {
+      auto it_buffer = func->buffer_map.find(func->params[i]);
+      if (it_buffer != func->buffer_map.end() &&
+          (*it_buffer).second->dtype == DataType::Float(32)) {
+        variant.indices.push_back(i);
+      }
+    }
+    if (variant.indices.empty()) return variant;
+    Optional<tir::PrimFunc> narrowed =
+        tir::InputBufferNarrower::Narrow(GetRef<tir::PrimFunc>(func), variant.indices, dtype_);
+    if (!narrowed.defined()) return variant;
+    String name = gv->name_hint + "_" + DLDataType2String(dtype_);
+    GlobalVar new_gv = builder_->AddFunction(narrowed.value(), name);
+    if (narrowed.value()->GetAttr<String>(tvm::attr::kGlobalSymbol).defined()) {
+      builder_->UpdateFunction(
+          new_gv, WithAttr(narrowed.value(), tvm::attr::kGlobalSymbol, new_gv->name_hint));
+    }
+    variant.gv = new_gv;
+    return variant;
+  }
+
+  /*! \brief Whether the policy converts the kernel, by default only the compute-bound ones. */
+  bool IsConverted(const GlobalVar& gv, const tir::PrimFunc& func) const {
+    if (Optional<String> policy = policy_.Get(gv->name_hint)) return policy.value() == "always";
+    Optional<Integer> pattern = func->GetAttr<Integer>("op_pattern");
+    int kind = pattern ? static_cast<int>(pattern.value()->value) : AnalyzeOpPatternKind(func);
+    return kind == relay::kOutEWiseFusable;
+  }
+
+  /*! \brief Whether \p input is a constant or a var of known shape. */
+  static bool CanNarrow(const Expr& input) {
+    if (input->IsInstance<ConstantNode>()) return true;
+    return input->IsInstance<VarNode>() && input->shape_.as<ShapeExprNode>() != nullptr &&
+           input->checked_type_.as<DynTensorTypeNode>() != nullptr;
+  }
+
+  /*!
+   * \brief Get the low precision value of a float32 input, converting a constant ahead of time
+   * and casting other values by a call_tir.
+   */
+  Expr NarrowInput(const Expr& input) {
+    if (const auto* constant = input.as<ConstantNode>()) {
+      auto it = narrowed_constants_.find(constant);
+      if (it == narrowed_constants_.end()) {
+        it = narrowed_constants_.emplace(constant, Constant(NarrowNDArray(constant->data))).first;
+      }
+      return it->second;
+    }
+    const auto* var = input.as<VarNode>();
+    const auto* shape = input->shape_.as<ShapeExprNode>();
+    const auto* type = input->checked_type_.as<DynTensorTypeNode>();
+    auto it = casted_.find(var);
+    if (it != casted_.end()) return it->second;
+
+    static const Op& call_tir_op = Op::Get("relax.call_tir");
+    Call cast(call_tir_op, {GetCastFunc(type->ndim), Tuple({input}), GetRef<ShapeExpr>(shape)},
+              {}, {DynTensorType(type->ndim, dtype_)});
+    Var casted = builder_->Emit(cast, var->name_hint() + "_" + DLDataType2String(dtype_));
+    casted_[var] = casted;
+    return casted;
+  }
+
+  /*! \brief Get the kernel casting a float32 tensor of \p ndim dimensions to the low precision. */
+  GlobalVar GetCastFunc(int ndim) {
+    auto it = cast_funcs_.find(ndim);
+    if (it != cast_funcs_.end()) return it->second;
+    Array<PrimExpr> shape;
+    for (int i = 0; i < ndim; ++i) {
+      shape.push_back(tir::Var("n" + std::to_string(i), DataType::Int(64)));
+    }
+    te::Tensor input = te::placeholder(shape, DataType::Float(32), "rxplaceholder");
+    te::Tensor output = topi::cast(input, dtype_);
+    tir::PrimFunc func = tir::CreatePrimFunc({input, output}, NullOpt);
+    GlobalVar gv = builder_->AddFunction(func, "cast_" + DLDataType2String(dtype_));
+    builder_->UpdateFunction(gv, WithAttr(func, tvm::attr::kGlobalSymbol, gv->name_hint));
+    cast_funcs_[ndim] = gv;
+    return gv;
+  }
+
+  /*! \brief Convert a float32 tensor to the low precision on the host. */
+  runtime::NDArray NarrowNDArray(const runtime::NDArray& data) const {
+    CHECK(data->dtype.code == kDLFloat && data->dtype.bits == 32 && data->dtype.lanes == 1)
+        << "TypeError: Expect a float32 constant, but got "
+        << runtime::DLDataType2String(data->dtype);
+    runtime::NDArray src = data.CopyTo(Device{kDLCPU, 0});
+    runtime::NDArray dst = runtime::NDArray::Empty(src.Shape(), dtype_, Device{kDLCPU, 0});
+    const float* src_data = static_cast<const float*>(src->data);
+    uint16_t* dst_data = static_cast<uint16_t*>(dst->data);
+    int64_t size = 1;
+    for (int i = 0; i < src->ndim; ++i) size *= src->shape[i];
+    for (int64_t i = 0; i < size; ++i) {
+      dst_data[i] =
+          dtype_.is_bfloat16() ? FloatToBFloat16(src_data[i]) : __gnu_f2h_ieee(src_data[i]);
+    }
+    return dst.CopyTo(data->device);
+  }
+
+  /*! \brief Round a float to the nearest bfloat16, ties to even. */
+  static uint16_t FloatToBFloat16(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffffu) > 0x7f800000u) return 0x7fc0;  // NaN
+    bits += 0x7fffu + ((bits >> 16) & 1u);
+    return static_cast<uint16_t>(bits >> 16);
+  }
+
+  /*! \brief The module holding the kernels. */
+  IRModule mod_;
+  /*! \brief The low precision type. */
+  DataType dtype_;
+  /*! \brief The map from kernel names to "always" or "never" converting them. */
+  Map<String, String> policy_;
+  /*! \brief The low precision copy of each kernel. */
+  std::unordered_map<const GlobalVarNode*, Variant> variants_;
+  /*! \brief The cast kernel of each number of dimensions. */
+  std::unordered_map<int, GlobalVar> cast_funcs_;
+  /*! \brief The low precision values of the constants. */
+  std::unordered_map<const ConstantNode*, Constant> narrowed_constants_;
+  /*! \brief The low precision values of the vars, cast in the current block. */
+  std::unordered_map<const VarNode*, Var> casted_;
+};
+
+namespace transform {
+
+Pass ToMixedPrecision(String dtype, Map<String, String> policy) {
+  DataType low_precision(String2DLDataType(dtype));
+  CHECK(low_precision == DataType::Float(16) || low_precision == DataType::BFloat(16))
+      << "ValueError: ToMixedPrecision expects float16 or bfloat16, but got " << dtype;
+  runtime::TypedPackedFunc<IRModule(IRModule, PassContext)> pass_func =
+      [=](IRModule m, PassContext pc) {
+        return MixedPrecisionRewriter(m, low_precision, policy).Rewrite();
+      };
+  return CreateModulePass(pass_func, 0, "ToMixedPrecision", {});
+}
+
+TVM_REGISTER_GLOBAL("relax.transform.ToMixedPrecision").set_body_typed(ToMixedPrecision);
+
+}  // namespace transform
+
+}  // namespace relax
+}  // namespace tvm
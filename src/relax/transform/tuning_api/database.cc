@@ -23,6 +23,7 @@
  */
 #include <tvm/relax/tuning_api.h>
 
+#include <algorithm>
 #include <set>
 #include <thread>
 #include <unordered_map>
@@ -128,7 +129,7 @@ class JSONDatabaseNode : public DatabaseNode {
 
  public:
   bool HasWorkload(const IRModule& mod) {
-    return workloads2idx_.find(meta_schedule::Workload(mod, tvm::StructuralHash()(mod))) !=
+    return workloads2idx_.find(meta_schedule::WorkloadRegistry::Intern(mod)) !=
            workloads2idx_.end();
   }
 
@@ -149,7 +150,7 @@ class JSONDatabaseNode : public DatabaseNode {
     decltype(this->workloads2idx_)::iterator it;
     bool inserted = false;
     std::tie(it, inserted) =
-        this->workloads2idx_.emplace(meta_schedule::Workload(mod, tvm::StructuralHash()(mod)), -1);
+        this->workloads2idx_.emplace(meta_schedule::WorkloadRegistry::Intern(mod), -1);
     meta_schedule::Workload workload = it->first;
     // If `mod` is new in `workloads2idx_`, append it to the workload file
     if (inserted) {
@@ -196,18 +197,21 @@ class JSONDatabaseNode : public DatabaseNode {
     if (top_k == 0) {
       return {};
     }
-    Array<TuningRecord> results;
-    results.reserve(top_k);
-    int counter = 0;
     int idx = this->workloads2idx_.at(workload);
-    std::string key = get_database_key(idx, target);
-    for (const TuningRecord& record : this->tuning_records_[key]) {
+    // The records of a key are kept sorted, so only the returned ones are visited, and a lookup
+    // of a missing key does not insert an empty entry.
+    auto it = this->tuning_records_.find(get_database_key(idx, target));
+    if (it == this->tuning_records_.end()) {
+      return {};
+    }
+    Array<TuningRecord> results;
+    results.reserve(std::min<size_t>(top_k, it->second.size()));
+    for (const TuningRecord& record : it->second) {
       results.push_back(record);
-      if (++counter == top_k) {
+      if (static_cast<int>(results.size()) == top_k) {
         break;
       }
     }
-
     return results;
   }
 
@@ -231,7 +235,8 @@ Database Database::JSONDatabase(String path_workload, String path_tuning_record,
     n->workloads2idx_.reserve(n_objs);
     workloads.reserve(n_objs);
     for (int i = 0; i < n_objs; ++i) {
-      meta_schedule::Workload workload = meta_schedule::Workload::FromJSON(json_objs[i]);
+      meta_schedule::Workload workload =
+          meta_schedule::WorkloadRegistry::Intern(meta_schedule::Workload::FromJSON(json_objs[i]));
       n->workloads2idx_.emplace(workload, i);
       workloads.push_back(workload);
     }
@@ -0,0 +1,459 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/relax/transform/tuning_api/indexed_database.cc
+ * \brief An indexed database of tuning APIs, storing binary records in an append-only log.
+ *
+ * The database is a directory of two files:
+ * - "records.bin", the log of the records, each a RecordHeader followed by its payload.
+ * - "index.bin", the IndexEntry of every record of the log, in the order of the log.
+ *
+ * Opening the database only reads the index, whose entries are small and fixed-size, and the
+ * records are read from the log upon lookup. The workloads are keyed by their structural hash,
+ * the measurement and tuning records by a hash of their workload and target. The mean run time of
+ * a tuning record is kept in its entry, so that GetTopK only decodes the records it returns.
+ *
+ * Every access takes an exclusive lock of the index file, and catches up with the records which
+ * other processes appended since. A record is appended to the log before its entry is appended to
+ * the index, so after a crash the entries of the records past the end of the index are recovered
+ * from the log, and an incomplete record at the end of the log is truncated.
+ */
+#include <tvm/node/serialization.h>
+#include <tvm/relax/tuning_api.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../../../meta_schedule/utils.h"
+
+namespace tvm {
+namespace relax {
+
+#ifndef _WIN32
+
+/*! \brief The kinds of records. */
+enum class RecordKind : uint32_t {
+  kWorkload = 1,
+  kMeasurementRecord = 2,
+  kTuningRecord = 3,
+};
+
+/*! \brief The header of a record in the log. */
+struct RecordHeader {
+  /*! \brief kRecordMagic, to tell a record from the garbage of an incomplete write. */
+  uint32_t magic;
+  /*! \brief The RecordKind of the record. */
+  uint32_t kind;
+  /*! \brief The structural hash of a workload, or the hash of the workload and target pair. */
+  uint64_t key;
+  /*! \brief The number of bytes of the payload. */
+  uint64_t size;
+  /*! \brief The mean run time of a tuning record, 0 for others. */
+  double value;
+};
+
+/*! \brief The entry of a record in the index. */
+struct IndexEntry {
+  uint32_t kind;
+  uint32_t reserved;
+  uint64_t key;
+  /*! \brief The offset of the record in the log. */
+  uint64_t offset;
+  uint64_t size;
+  double value;
+};
+
+static constexpr uint32_t kRecordMagic = 0x42445852;  // "RXDB"
+
+/*! \brief An exclusive advisory lock of a file, held in the scope. */
+class FileLock {
+ public:
+  explicit FileLock(int fd) : fd_(fd) { ICHECK_EQ(flock(fd_, LOCK_EX), 0) << "Cannot lock file"; }
+  ~FileLock() { flock(fd_, LOCK_UN); }
+
+ private:
+  int fd_;
+};
+
+/*! \brief Write the whole buffer to a file opened with O_APPEND. */
+inline void AppendAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = write(fd, data.data() + written, data.size() - written);
+    ICHECK_GT(n, 0) << "Cannot write to the database: " << strerror(errno);
+    written += n;
+  }
+}
+
+/*! \brief Read up to \p size bytes at \p offset, returning the bytes read. */
+inline std::string ReadAt(int fd, uint64_t offset, uint64_t size) {
+  std::string data(size, '\0');
+  size_t read_size = 0;
+  while (read_size < size) {
+    ssize_t n = pread(fd, &data[read_size], size - read_size, offset + read_size);
+    if (n <= 0) break;
+    read_size += n;
+  }
+  data.resize(read_size);
+  return data;
+}
+
+inline uint64_t FileSize(int fd) {
+  struct stat st;
+  ICHECK_EQ(fstat(fd, &st), 0) << "Cannot stat the database: " << strerror(errno);
+  return st.st_size;
+}
+
+template <typename T>
+inline void WriteField(std::string* data, const T& value) {
+  data->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+inline void WriteString(std::string* data, const std::string& value) {
+  WriteField<uint64_t>(data, value.size());
+  data->append(value);
+}
+
+/*! \brief The database storing binary records in an append-only log, with a persistent index. */
+class IndexedDatabaseNode : public DatabaseNode {
+ public:
+  /*! \brief The directory of the database. */
+  String path;
+
+  void VisitAttrs(tvm::AttrVisitor* v) {
+    v->Visit("path", &path);
+    // `records_fd_` is not visited
+    // `index_fd_` is not visited
+    // `workloads_` is not visited
+    // `entries_` is not visited
+  }
+
+  static constexpr const char* _type_key = "relax.tuning_api.IndexedDatabase";
+  TVM_DECLARE_FINAL_OBJECT_INFO(IndexedDatabaseNode, DatabaseNode);
+
+  ~IndexedDatabaseNode() {
+    if (records_fd_ >= 0) close(records_fd_);
+    if (index_fd_ >= 0) close(index_fd_);
+  }
+
+  void Open(const std::string& dir, bool allow_missing) {
+    if (allow_missing) mkdir(dir.c_str(), 0755);
+    int flags = O_RDWR | O_APPEND | (allow_missing ? O_CREAT : 0);
+    records_fd_ = open((dir + "/records.bin").c_str(), flags, 0644);
+    CHECK_GE(records_fd_, 0) << "Cannot open the database " << dir << ": " << strerror(errno);
+    index_fd_ = open((dir + "/index.bin").c_str(), flags, 0644);
+    CHECK_GE(index_fd_, 0) << "Cannot open the database " << dir << ": " << strerror(errno);
+    FileLock lock(index_fd_);
+    Refresh();
+  }
+
+  bool HasWorkload(const IRModule& mod) {
+    FileLock lock(index_fd_);
+    Refresh();
+    return FindWorkload(meta_schedule::WorkloadRegistry::Intern(mod)) >= 0;
+  }
+
+  bool HasMeasurementRecord(const meta_schedule::Workload& workload, const Target& target) {
+    FileLock lock(index_fd_);
+    Refresh();
+    return !FindRecords(RecordKind::kMeasurementRecord, GetWorkload(workload), target).empty();
+  }
+
+  bool HasTuningRecord(const meta_schedule::Workload& workload, const Target& target) {
+    FileLock lock(index_fd_);
+    Refresh();
+    return !FindRecords(RecordKind::kTuningRecord, GetWorkload(workload), target).empty();
+  }
+
+  meta_schedule::Workload CommitWorkload(const IRModule& mod) {
+    meta_schedule::Workload workload = meta_schedule::WorkloadRegistry::Intern(mod);
+    FileLock lock(index_fd_);
+    Refresh();
+    if (FindWorkload(workload) < 0) {
+      uint64_t offset = Append(RecordKind::kWorkload, workload->shash, 0.0, SaveBinary(mod));
+      workloads_.emplace(offset, workload);
+    }
+    return workload;
+  }
+
+  void CommitMeasurementRecord(const meta_schedule::Workload& workload, const Target& target,
+                               const Array<FloatImm>& run_secs) {
+    FileLock lock(index_fd_);
+    Refresh();
+    uint64_t workload_offset = GetWorkload(workload);
+    if (!FindRecords(RecordKind::kMeasurementRecord, workload_offset, target).empty()) {
+      LOG(WARNING) << "Measurement record for " << workload_offset << "/" << target->str()
+                   << " already exists. Use the existing one instead.";
+      return;
+    }
+    std::string payload = KeyedPayload(workload_offset, target);
+    for (const FloatImm& sec : run_secs) WriteField<double>(&payload, sec->value);
+    Append(RecordKind::kMeasurementRecord, Key(workload_offset, target), 0.0, payload);
+  }
+
+  void CommitTuningRecord(const meta_schedule::Workload& workload, const Target& target,
+                          const TuningRecord& record) {
+    FileLock lock(index_fd_);
+    Refresh();
+    uint64_t workload_offset = GetWorkload(workload);
+    std::string payload = KeyedPayload(workload_offset, target);
+    payload += meta_schedule::JSONDumps(record->AsJSON());
+    double mean = Mean(record->run_secs.value_or({}));
+    Append(RecordKind::kTuningRecord, Key(workload_offset, target), mean, payload);
+  }
+
+  Array<TuningRecord> GetTopK(const meta_schedule::Workload& workload, const Target& target,
+                              int top_k) {
+    CHECK_GE(top_k, 0) << "ValueError: top_k must be non-negative";
+    if (top_k == 0) {
+      return {};
+    }
+    FileLock lock(index_fd_);
+    Refresh();
+    std::vector<std::pair<IndexEntry, std::string>> records =
+        FindRecords(RecordKind::kTuningRecord, GetWorkload(workload), target);
+    std::stable_sort(records.begin(), records.end(), [](const auto& a, const auto& b) {
+      return a.first.value < b.first.value;
+    });
+    Array<TuningRecord> results;
+    for (const auto& kv : records) {
+      results.push_back(TuningRecord::FromJSON(meta_schedule::JSONLoads(kv.second)));
+      if (static_cast<int>(results.size()) == top_k) break;
+    }
+    return results;
+  }
+
+  Array<FloatImm> GetMeasurementRecord(const meta_schedule::Workload& workload,
+                                       const Target target) {
+    FileLock lock(index_fd_);
+    Refresh();
+    std::vector<std::pair<IndexEntry, std::string>> records =
+        FindRecords(RecordKind::kMeasurementRecord, GetWorkload(workload), target);
+    Array<FloatImm> run_secs;
+    if (records.empty()) return run_secs;
+    const std::string& data = records[0].second;
+    for (size_t pos = 0; pos + sizeof(double) <= data.size(); pos += sizeof(double)) {
+      double sec;
+      std::memcpy(&sec, data.data() + pos, sizeof(double));
+      run_secs.push_back(FloatImm(DataType::Float(32), sec));
+    }
+    return run_secs;
+  }
+
+ private:
+  static double Mean(const Array<FloatImm>& run_secs) {
+    if (run_secs.empty()) return 1e10;
+    double sum = 0.0;
+    for (const FloatImm& sec : run_secs) sum += sec->value;
+    return sum / run_secs.size();
+  }
+
+  /*! \brief The key of the records of a workload and target pair. */
+  static uint64_t Key(uint64_t workload_offset, const Target& target) {
+    uint64_t target_hash = std::hash<std::string>()(target->str());
+    return workload_offset ^ (target_hash + 0x9e3779b97f4a7c15ULL + (workload_offset << 6) +
+                              (workload_offset >> 2));
+  }
+
+  /*! \brief The prefix of the payload of a record of a workload and target pair. */
+  static std::string KeyedPayload(uint64_t workload_offset, const Target& target) {
+    std::string payload;
+    WriteField<uint64_t>(&payload, workload_offset);
+    WriteString(&payload, target->str());
+    return payload;
+  }
+
+  /*! \brief Add an entry to the in-memory index. */
+  void AddEntry(const IndexEntry& entry) {
+    entries_[entry.kind][entry.key].push_back(entry);
+    indexed_end_ = std::max(indexed_end_, entry.offset + sizeof(RecordHeader) + entry.size);
+  }
+
+  /*!
+   * \brief Catch up with the records appended since the last refresh. Requires the lock.
+   * First reads the new entries of the index, then recovers the entries of the records of the log
+   * past the end of the index, appending them to the index.
+   */
+  void Refresh() {
+    uint64_t index_size = FileSize(index_fd_);
+    if (index_size % sizeof(IndexEntry) != 0) {
+      // An incomplete entry of a process which crashed, recovered from the log below.
+      index_size -= index_size % sizeof(IndexEntry);
+      ICHECK_EQ(ftruncate(index_fd_, index_size), 0)
+          << "Cannot truncate the database: " << strerror(errno);
+    }
+    if (index_size > index_read_) {
+      uint64_t size = index_size - index_read_;
+      std::string data = ReadAt(index_fd_, index_read_, size);
+      ICHECK_EQ(data.size(), size) << "Cannot read the index of the database";
+      for (size_t pos = 0; pos < size; pos += sizeof(IndexEntry)) {
+        IndexEntry entry;
+        std::memcpy(&entry, data.data() + pos, sizeof(IndexEntry));
+        AddEntry(entry);
+      }
+      index_read_ += size;
+    }
+
+    uint64_t records_size = FileSize(records_fd_);
+    std::string recovered;
+    while (indexed_end_ < records_size) {
+      std::string data = ReadAt(records_fd_, indexed_end_, sizeof(RecordHeader));
+      RecordHeader header;
+      if (data.size() == sizeof(RecordHeader)) std::memcpy(&header, data.data(), data.size());
+      if (data.size() < sizeof(RecordHeader) || header.magic != kRecordMagic ||
+          indexed_end_ + sizeof(RecordHeader) + header.size > records_size) {
+        // An incomplete write of a process which crashed; no other process writes under the lock.
+        LOG(WARNING) << "Truncating an incomplete record at the end of the database " << path;
+        ICHECK_EQ(ftruncate(records_fd_, indexed_end_), 0)
+            << "Cannot truncate the database: " << strerror(errno);
+        break;
+      }
+      IndexEntry entry{header.kind, 0, header.key, indexed_end_, header.size, header.value};
+      WriteField(&recovered, entry);
+      AddEntry(entry);
+    }
+    if (!recovered.empty()) {
+      AppendAll(index_fd_, recovered);
+      index_read_ += recovered.size();
+    }
+  }
+
+  /*! \brief Append a record to the log and its entry to the index. Requires the lock. */
+  uint64_t Append(RecordKind kind, uint64_t key, double value, const std::string& payload) {
+    uint64_t offset = FileSize(records_fd_);
+    ICHECK_EQ(offset, indexed_end_) << "The database is modified without the lock";
+    RecordHeader header{kRecordMagic, static_cast<uint32_t>(kind), key, payload.size(), value};
+    std::string data;
+    WriteField(&data, header);
+    data += payload;
+    AppendAll(records_fd_, data);
+
+    IndexEntry entry{header.kind, 0, key, offset, payload.size(), value};
+    std::string index_data;
+    WriteField(&index_data, entry);
+    AppendAll(index_fd_, index_data);
+    index_read_ += index_data.size();
+    AddEntry(entry);
+    return offset;
+  }
+
+  std::string ReadPayload(const IndexEntry& entry) {
+    std::string data = ReadAt(records_fd_, entry.offset + sizeof(RecordHeader), entry.size);
+    ICHECK_EQ(data.size(), entry.size) << "Cannot read the record of the database";
+    return data;
+  }
+
+  const std::vector<IndexEntry>* Lookup(RecordKind kind, uint64_t key) {
+    auto it = entries_[static_cast<uint32_t>(kind)].find(key);
+    return it == entries_[static_cast<uint32_t>(kind)].end() ? nullptr : &it->second;
+  }
+
+  /*! \brief The offset of the record of a workload, or -1 if it is not in the database. */
+  int64_t FindWorkload(const meta_schedule::Workload& workload) {
+    const std::vector<IndexEntry>* entries = Lookup(RecordKind::kWorkload, workload->shash);
+    if (entries == nullptr) return -1;
+    // The workloads are only decoded on hash matches, and once.
+    for (const IndexEntry& entry : *entries) {
+      auto it = workloads_.find(entry.offset);
+      if (it == workloads_.end()) {
+        std::string payload = ReadPayload(entry);
+        IRModule mod = Downcast<IRModule>(IsBinaryFormat(payload) ? LoadBinary(payload)
+                                                                  : LoadJSON(payload));
+        meta_schedule::Workload loaded(mod, entry.key);
+        loaded = meta_schedule::WorkloadRegistry::Intern(loaded);
+        it = workloads_.emplace(entry.offset, loaded).first;
+      }
+      if (meta_schedule::WorkloadEqual()(it->second, workload)) return entry.offset;
+    }
+    return -1;
+  }
+
+  uint64_t GetWorkload(const meta_schedule::Workload& workload) {
+    int64_t offset = FindWorkload(workload);
+    CHECK_GE(offset, 0) << "ValueError: The workload is not committed to the database";
+    return offset;
+  }
+
+  /*! \brief The records of a workload and target pair, with their payloads past the prefix. */
+  std::vector<std::pair<IndexEntry, std::string>> FindRecords(RecordKind kind,
+                                                              uint64_t workload_offset,
+                                                              const Target& target) {
+    std::vector<std::pair<IndexEntry, std::string>> results;
+    const std::vector<IndexEntry>* entries = Lookup(kind, Key(workload_offset, target));
+    if (entries == nullptr) return results;
+    std::string prefix = KeyedPayload(workload_offset, target);
+    for (const IndexEntry& entry : *entries) {
+      // Drop the records of a colliding key.
+      std::string payload = ReadPayload(entry);
+      if (payload.compare(0, prefix.size(), prefix) == 0) {
+        results.emplace_back(entry, payload.substr(prefix.size()));
+      }
+    }
+    return results;
+  }
+
+  int records_fd_ = -1;
+  int index_fd_ = -1;
+  /*! \brief The number of bytes of the index read. */
+  uint64_t index_read_ = 0;
+  /*! \brief The end of the last record of the log which is in the index. */
+  uint64_t indexed_end_ = 0;
+  /*! \brief The entries of each kind, by key. */
+  std::unordered_map<uint32_t, std::unordered_map<uint64_t, std::vector<IndexEntry>>> entries_;
+  /*! \brief The decoded workloads, by the offset of their record. */
+  std::unordered_map<uint64_t, meta_schedule::Workload> workloads_;
+};
+
+Database Database::IndexedDatabase(String path, bool allow_missing) {
+  ObjectPtr<IndexedDatabaseNode> n = make_object<IndexedDatabaseNode>();
+  n->path = path;
+  n->Open(path, allow_missing);
+  return Database(n);
+}
+
+TVM_REGISTER_NODE_TYPE(IndexedDatabaseNode);
+
+#else
+
+Database Database::IndexedDatabase(String path, bool allow_missing) {
+  LOG(FATAL) << "The indexed tuning database is not supported on Windows";
+  return Database(ObjectPtr<Object>(nullptr));
+}
+
+#endif  // _WIN32
+
+TVM_REGISTER_GLOBAL("relax.tuning_api.DatabaseIndexedDatabase")
+    .set_body_typed(Database::IndexedDatabase);
+
+}  // namespace relax
+}  // namespace tvm
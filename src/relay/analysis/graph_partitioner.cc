@@ -19,6 +19,7 @@
 
 #include "./graph_partitioner.h"
 
+#include <algorithm>
 #include <vector>
 
 namespace tvm {
@@ -130,8 +131,7 @@ GraphPartitioner::Group* GraphPartitioner::Group::FindRoot() {
 template <typename F>
 bool GraphPartitioner::CheckPath_(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink,
                                   F fcond) {
-  if (visited_.count(src)) return true;
-  visited_.insert(src);
+  if (MarkVisited(src)) return true;
   Group* gnode = groups_[src->index];
   ICHECK(gnode != nullptr);
   gnode = gnode->FindRoot();
@@ -147,7 +147,7 @@ template <typename F>
 bool GraphPartitioner::CheckPath(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink,
                                  F fcond) {
   ICHECK(!src->extern_ref);
-  visited_.clear();
+  ClearVisited();
   ICHECK(src != sink);
   for (auto link = src->outputs.head; link != nullptr; link = link->next) {
     if (!CheckPath_(link->value.node, sink, fcond)) return false;
@@ -181,8 +181,7 @@ void GraphPartitioner::MergeFromTo(Group* child, Group* parent) {
 void GraphPartitioner::CommitFuse_(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink,
                                    Group* target) {
   if (src == sink) return;
-  if (visited_.count(src)) return;
-  visited_.insert(src);
+  if (MarkVisited(src)) return;
   Group* gnode = groups_[src->index];
   ICHECK(gnode != nullptr);
   // merge the current group to the parent if possible.
@@ -194,15 +193,14 @@ void GraphPartitioner::CommitFuse_(IndexedForwardGraph::Node* src, IndexedForwar
 
 void GraphPartitioner::CommitFuse(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink) {
   Group* target = groups_[sink->index];
-  visited_.clear();
+  ClearVisited();
   ICHECK(src != sink);
   CommitFuse_(src, sink, target);
 }
 
 size_t GraphPartitioner::CountNodesUptoSink_(IndexedForwardGraph::Node* src,
                                              IndexedForwardGraph::Node* sink) {
-  if (src == sink || visited_.count(src)) return 0;
-  visited_.insert(src);
+  if (src == sink || MarkVisited(src)) return 0;
   Group* gnode = groups_[src->index];
   ICHECK(gnode != nullptr);
   auto sum = gnode->num_nodes;
@@ -215,13 +213,30 @@ size_t GraphPartitioner::CountNodesUptoSink_(IndexedForwardGraph::Node* src,
 size_t GraphPartitioner::CountFusedNodesWithNewChild(IndexedForwardGraph::Node* child,
                                                      IndexedForwardGraph::Node* dom_parent) {
   Group* target = groups_[dom_parent->index];
-  visited_.clear();
+  ClearVisited();
   ICHECK(child != dom_parent);
   return target->FindRoot()->num_nodes + CountNodesUptoSink_(child, dom_parent);
 }
 
+void GraphPartitioner::ClearVisited() {
+  if (++visit_epoch_ == 0) {
+    // The epoch wrapped around, reset the marks so that no stale mark equals the epoch.
+    std::fill(visit_marks_.begin(), visit_marks_.end(), 0);
+    visit_epoch_ = 1;
+  }
+}
+
+bool GraphPartitioner::MarkVisited(const IndexedForwardGraph::Node* node) {
+  ICHECK_LT(node->index, visit_marks_.size());
+  if (visit_marks_[node->index] == visit_epoch_) return true;
+  visit_marks_[node->index] = visit_epoch_;
+  return false;
+}
+
 void GraphPartitioner::InitGroups(const IndexedForwardGraph& graph) {
   groups_.resize(graph.post_dfs_order.size());
+  visit_marks_.assign(graph.post_dfs_order.size(), 0);
+  visit_epoch_ = 0;
   for (size_t nid = 0; nid < groups_.size(); ++nid) {
     const auto* graph_node = graph.post_dfs_order[nid];
     auto* group_node = arena_->make<Group>();
@@ -251,9 +266,11 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
     ICHECK(!graph_node->extern_ref);
     size_t dom_parent_gindex = dom_node->parent->gnode->index;
 
-    // refuse the fusion if too many ops are going to be fused together
-    if (CountFusedNodesWithNewChild(graph_node, dom_node->parent->gnode) > max_fuse_depth_)
-      continue;
+    // refuse the fusion if too many ops are going to be fused together. The count walks the
+    // paths to the dominator, so it is only taken for the nodes passing the cheaper checks.
+    auto within_max_depth = [&]() {
+      return CountFusedNodesWithNewChild(graph_node, dom_node->parent->gnode) <= max_fuse_depth_;
+    };
 
     if (phase == 2) {
       // Fuse injective ops into intermediate tuples, if any
@@ -267,7 +284,7 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
         auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kInjective; };
         // dom_root_group can also be tuple, as in inception layers
         // CheckPath is needed to avoid fusing two intermediate tuples
-        if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        if (within_max_depth() && CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       }
@@ -290,7 +307,7 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
         ICHECK(dom_node->parent->gnode != nullptr);
         // The fuse can be executed if all the intermediate ops are still broadcast.
         auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kBroadcast; };
-        if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        if (within_max_depth() && CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       }
@@ -298,19 +315,23 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
       // Pre-condition: can only be fused to parent which is injective or reduction.
       if (dom_node->parent != nullptr &&
           (dom_node->pattern <= kInjective || dom_node->pattern == kCommReduce)) {
+        // The reductions of a chain may be on the paths, e.g. the exp of a softmax reaches the
+        // divide directly and through the reduce-sum, unless the sink group has an anchor.
+        bool through_reductions = fuse_reduction_chains_ &&
+                                  groups_[dom_parent_gindex]->FindRoot()->anchor_ref == nullptr;
         // Check if all the intermediate ops are still broadcast.
         // The final terminal node can already be fused to a OutEWiseFusable group.
-        auto fcond = [](OpPatternKind kind, bool is_sink) {
+        auto fcond = [through_reductions](OpPatternKind kind, bool is_sink) {
           if (!is_sink) {
             // Elemwise, broadcast, and injective ops on the parallel branches
             // are allowed be fused to the elemwise/broadcast anchor.
-            return kind <= kInjective;
+            return kind <= kInjective || (through_reductions && kind == kCommReduce);
           } else {
             return (kind <= kBroadcast || kind == kCommReduce || kind == kInjective ||
                     kind == kOutEWiseFusable);
           }
         };
-        if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        if (within_max_depth() && CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
           CommitFuse(graph_node, dom_node->parent->gnode);
         }
       }
@@ -318,9 +339,27 @@ void GraphPartitioner::RunFuse(const IndexedForwardGraph& graph,    //
       // defer injective fusion to second phase.
       // so conv2d always finishes fusing.
       if (phase != 1) continue;
-      // Check if all path are injective.
-      auto fcond = [](OpPatternKind kind, bool is_sink) { return kind <= kInjective; };
-      if (CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+      // Check if all path are injective. A gather may also be fused into the reduction which
+      // consumes it, e.g. the lookup of an embedding bag into its pooling, so that the gathered
+      // rows are never materialized.
+      bool into_reduction = fuse_reduction_chains_ &&
+                            groups_[dom_parent_gindex]->FindRoot()->anchor_ref == nullptr;
+      auto fcond = [into_reduction](OpPatternKind kind, bool is_sink) {
+        return kind <= kInjective || (into_reduction && is_sink && kind == kCommReduce);
+      };
+      if (within_max_depth() && CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
+        CommitFuse(graph_node, dom_node->parent->gnode);
+      }
+    } else if (fuse_reduction_chains_) {
+      ICHECK(group_node->pattern == kCommReduce);
+      if (phase != 0) continue;
+      // Fuse a reduction into its epilogue of elemwise and broadcast ops, which may hold later
+      // reductions of the chain, unless the epilogue is fused to an anchor such as conv2d.
+      if (groups_[dom_parent_gindex]->FindRoot()->anchor_ref != nullptr) continue;
+      auto fcond = [](OpPatternKind kind, bool is_sink) {
+        return kind <= kBroadcast || kind == kCommReduce;
+      };
+      if (within_max_depth() && CheckPath(graph_node, dom_node->parent->gnode, fcond)) {
         CommitFuse(graph_node, dom_node->parent->gnode);
       }
     } else {
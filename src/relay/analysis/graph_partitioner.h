@@ -154,8 +154,21 @@ class DominatorTree {
 
 class GraphPartitioner {
  public:
-  explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth)
-      : arena_(arena), opt_level_(opt_level), max_fuse_depth_(max_fuse_depth) {}
+  /*!
+   * \param arena The arena.
+   * \param opt_level The optimization level of the fusion.
+   * \param max_fuse_depth The maximum number of operations in one fused function.
+   * \param fuse_reduction_chains Whether a reduction is fused with its elementwise epilogue,
+   *  including the later reductions of the epilogue, e.g. the reduce-max, subtract, exp,
+   *  reduce-sum and divide of a softmax become one group, and whether an injective op is fused
+   *  into the reduction which consumes it.
+   */
+  explicit GraphPartitioner(support::Arena* arena, int opt_level, size_t max_fuse_depth,
+                            bool fuse_reduction_chains = false)
+      : arena_(arena),
+        opt_level_(opt_level),
+        max_fuse_depth_(max_fuse_depth),
+        fuse_reduction_chains_(fuse_reduction_chains) {}
   /*!
    * \brief Group as a union find data structure.
    */
@@ -195,10 +208,22 @@ class GraphPartitioner {
   int opt_level_;
   /*! \brief The maximum number of operations in one fused function */
   size_t max_fuse_depth_;
+  /*! \brief Whether the reductions are fused with their epilogues, see the constructor. */
+  bool fuse_reduction_chains_;
   /*! \brief The internal groups. */
   std::vector<Group*> groups_;
-  /*! \brief internal field used for deduplication */
-  std::unordered_set<IndexedForwardGraph::Node*> visited_;
+  /*!
+   * \brief internal field used for deduplication, a node is visited iff its mark is the current
+   *  epoch. Bumping the epoch clears the marks in constant time, unlike clearing a hash set whose
+   *  buckets grew on a long path, which made the partition quadratic on deep graphs.
+   */
+  std::vector<uint32_t> visit_marks_;
+  /*! \brief The epoch of the current traversal. */
+  uint32_t visit_epoch_{0};
+  /*! \brief Start a new traversal, unmarking every node. */
+  void ClearVisited();
+  /*! \brief Mark \p node as visited, return whether it was visited before. */
+  bool MarkVisited(const IndexedForwardGraph::Node* node);
   // Internal implementation of CheckPath
   template <typename F>
   bool CheckPath_(IndexedForwardGraph::Node* src, IndexedForwardGraph::Node* sink, F fcond);
@@ -36,6 +36,7 @@
 #include "../op/call/call.h"
 #include "../op/memory/memory.h"
 #include "../transforms/device_aware_visitors.h"
+#include "./token_allocator.h"
 #include "./utils.h"
 
 namespace tvm {
@@ -410,40 +411,14 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
   StorageToken* Request(StorageToken* prototype) {
     // calculate the size;
     size_t size = GetMemorySize(prototype);
-    // search memory block in [size / match_range_, size * match_range_)
-    if (match_range_ == 0) {
+    StorageToken* tok = free_.Request(*prototype, size);
+    if (tok == nullptr) {
+      // cannot find anything return a new one.
       return this->Alloc(prototype, size);
     }
-    auto begin = free_.lower_bound(size / match_range_);
-    auto mid = free_.lower_bound(size);
-    auto end = free_.upper_bound(size * match_range_);
-    // search for memory blocks larger than requested
-    for (auto it = mid; it != end; ++it) {
-      StorageToken* tok = it->second;
-      if (!tok->is_compatible(*prototype)) continue;
-      ICHECK_EQ(tok->ref_counter, 0);
-      // Use exect matching strategy
-      tok->max_bytes = std::max(size, tok->max_bytes);
-      tok->ref_counter = prototype->ref_counter;
-      // find a exact match, erase from map and return
-      free_.erase(it);
-      return tok;
-    }
-    // then search for memory blocks smaller than requested space
-    for (auto it = mid; it != begin;) {
-      --it;
-      StorageToken* tok = it->second;
-      if (!tok->is_compatible(*prototype)) continue;
-      ICHECK_EQ(tok->ref_counter, 0);
-      // Use exect matching strategy
-      tok->max_bytes = std::max(size, tok->max_bytes);
-      tok->ref_counter = prototype->ref_counter;
-      // erase from map and return
-      free_.erase(it);
-      return tok;
-    }
-    // cannot find anything return a new one.
-    return this->Alloc(prototype, size);
+    ICHECK_EQ(tok->ref_counter, 0);
+    tok->ref_counter = prototype->ref_counter;
+    return tok;
   }
   /*!
    * \brief Allocate a storage token by consuming prototype
@@ -464,17 +439,15 @@ class StorageAllocator : public StorageAllocaBaseVisitor {
     ICHECK_GE(tok->storage_id, 0);
     ICHECK_GE(tok->ref_counter, 0);
     if (tok->ref_counter == 0) {
-      free_.insert({tok->max_bytes, tok});
+      free_.Release(tok);
     }
   }
 
  private:
   // allocator
   support::Arena arena_;
-  // scale used for rough match
-  size_t match_range_{16};
-  // free list of storage entry
-  std::multimap<size_t, StorageToken*> free_;
+  // free list of storage entry, matched within a scale of 16
+  TokenFreeList<StorageToken> free_{16};
   // all the storage resources available
   std::vector<StorageToken*> data_;
   /*! \brief internal prototype token map */
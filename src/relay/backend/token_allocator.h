@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relay/backend/token_allocator.h
+ * \brief The free list of the storage tokens of the graph memory planning, shared by the memory
+ *   planning of Relay graphs and of Relax functions.
+ */
+#ifndef TVM_RELAY_BACKEND_TOKEN_ALLOCATOR_H_
+#define TVM_RELAY_BACKEND_TOKEN_ALLOCATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+
+namespace tvm {
+namespace relay {
+
+/*!
+ * \brief The free storage tokens, by their size. A request takes a free token of a compatible
+ *  device whose size is within a factor of the match range of the requested size, preferring
+ *  the smallest token at least as large as requested, then the largest smaller one, which grows.
+ * \tparam Token The storage token, with a max_bytes field and an is_compatible(other) method.
+ */
+template <typename Token>
+class TokenFreeList {
+ public:
+  /*!
+   * \param match_range The scale of the sizes of the reused tokens, 0 to never reuse tokens.
+   */
+  explicit TokenFreeList(size_t match_range = 16) : match_range_(match_range) {}
+
+  /*!
+   * \brief Take a free token for a storage of the given size.
+   * \param prototype The token requested.
+   * \param size The size of the storage in bytes.
+   * \return The free token, grown to the size, or nullptr if none matches.
+   */
+  Token* Request(const Token& prototype, size_t size) {
+    // search memory block in [size / match_range_, size * match_range_)
+    if (match_range_ == 0) return nullptr;
+    auto begin = free_.lower_bound(size / match_range_);
+    auto mid = free_.lower_bound(size);
+    auto end = free_.upper_bound(size * match_range_);
+    // search for memory blocks larger than requested
+    for (auto it = mid; it != end; ++it) {
+      Token* tok = it->second;
+      if (!tok->is_compatible(prototype)) continue;
+      tok->max_bytes = std::max(size, static_cast<size_t>(tok->max_bytes));
+      free_.erase(it);
+      return tok;
+    }
+    // then search for memory blocks smaller than requested space
+    for (auto it = mid; it != begin;) {
+      --it;
+      Token* tok = it->second;
+      if (!tok->is_compatible(prototype)) continue;
+      tok->max_bytes = std::max(size, static_cast<size_t>(tok->max_bytes));
+      free_.erase(it);
+      return tok;
+    }
+    return nullptr;
+  }
+
+  /*! \brief Release a token whose storage is no longer used. */
+  void Release(Token* tok) { free_.insert({static_cast<size_t>(tok->max_bytes), tok}); }
+
+ private:
+  /*! \brief The scale used for rough match. */
+  size_t match_range_;
+  /*! \brief The free tokens by their size. */
+  std::multimap<size_t, Token*> free_;
+};
+
+}  // namespace relay
+}  // namespace tvm
+
+#endif  // TVM_RELAY_BACKEND_TOKEN_ALLOCATOR_H_
@@ -34,9 +34,11 @@
 #include <tvm/runtime/registry.h>
 
 #include <cstdint>
+#include <mutex>
 #include <sstream>
 
 #include "meta_data.h"
+#include "relax_vm/constant_store.h"
 
 namespace tvm {
 namespace runtime {
@@ -72,9 +74,15 @@ class ConstLoaderModuleNode : public ModuleNode {
     // Initialize and memoize the module.
     // Usually, we have some warmup runs. The module initialization should be
     // done at this stage. Therefore, runtime overhead is not a concern.
-    if (initialized_.count(name) && !initialized_.at(name)) {
-      this->InitSubModule(name);
-      initialized_[name] = true;
+    // Only the submodules of the symbols looked up are initialized, e.g. by the VM sessions of
+    // different threads, so the initialization is guarded.
+    auto it = initialized_.find(name);
+    if (it != initialized_.end()) {
+      std::lock_guard<std::mutex> lock(init_mutex_);
+      if (!it->second) {
+        this->InitSubModule(name);
+        it->second = true;
+      }
     }
 
     // Run the module.
@@ -94,6 +102,9 @@ class ConstLoaderModuleNode : public ModuleNode {
    * \brief Get the list of constants that is required by the given module.
    * \param symbol The symbol that is being queried.
    * \return The list of needed NDArray.
+   * \note The host constants are replaced by the ones of the same content in the constant store
+   *  of the Relax VM, so that the weights held by the VMs or by other libraries of the process
+   *  are not kept twice.
    */
   Array<NDArray> GetRequiredConstants(const std::string& symbol) {
     Array<NDArray> ret;
@@ -103,7 +114,11 @@ class ConstLoaderModuleNode : public ModuleNode {
     for (const auto& var : vars) {
       ICHECK_GT(const_var_ndarray_.count(var), 0U)
           << "No such constant variable '" << var << "' for function '" << symbol << "'";
-      ret.push_back(const_var_ndarray_[var]);
+      NDArray& constant = const_var_ndarray_[var];
+      if (constant->device.device_type == kDLCPU) {
+        constant = relax_vm::ConstantStore::Global()->Share(constant);
+      }
+      ret.push_back(constant);
     }
     return ret;
   }
@@ -223,6 +238,8 @@ class ConstLoaderModuleNode : public ModuleNode {
    * modules using execution engine.
    */
   std::unordered_map<std::string, bool> initialized_;
+  /*! \brief The mutex guarding the initialization of the submodules. */
+  std::mutex init_mutex_;
   /*! \brief Variable name to NDArray mapping. */
   std::unordered_map<std::string, NDArray> const_var_ndarray_;
   /*! \brief Symbol name to required constant variables mapping. */
@@ -91,11 +91,13 @@ TVM_REGISTER_GLOBAL("runtime.GetADTFields").set_body([](TVMArgs args, TVMRetValu
 });
 
 TVM_REGISTER_GLOBAL("runtime.Tuple").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // The Relax VM creates its tuples with this function, so they come from the object pool.
   std::vector<ObjectRef> fields;
+  fields.reserve(args.size());
   for (auto i = 0; i < args.size(); ++i) {
     fields.push_back(args[i]);
   }
-  *rv = ADT::Tuple(fields);
+  *rv = ADT::PooledTuple(fields.begin(), fields.end());
 });
 
 TVM_REGISTER_GLOBAL("runtime.ADT").set_body([](TVMArgs args, TVMRetValue* rv) {
@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/contrib/cublas/cublas_json_runtime.cc
+ * \brief A simple JSON runtime for cuBLASLt, running each matmul with its fused epilogue.
+ */
+
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <string>
+#include <vector>
+
+#include "../../cuda/cuda_common.h"
+#include "../json/json_node.h"
+#include "../json/json_runtime.h"
+#include "cublas_utils.h"
+
+namespace tvm {
+namespace runtime {
+namespace contrib {
+
+using namespace tvm::runtime;
+using namespace tvm::runtime::json;
+
+#if CUDART_VERSION >= 11000
+class CublasJSONRuntime : public JSONRuntimeBase {
+ public:
+  CublasJSONRuntime(const std::string& symbol_name, const std::string& graph_json,
+                    const Array<String> const_names)
+      : JSONRuntimeBase(symbol_name, graph_json, const_names) {}
+
+  const char* type_key() const override { return "cublas_json"; }
+
+  void Init(const Array<NDArray>& consts) override {
+    ICHECK_EQ(consts.size(), const_idx_.size())
+        << "The number of input constants must match the number of required.";
+    SetupConstants(consts);
+  }
+
+  void Run() override {
+    auto* entry = tvm::contrib::CuBlasLtThreadEntry::ThreadLocal();
+    cudaStream_t stream = static_cast<cudaStream_t>(CUDAThreadEntry::ThreadLocal()->stream);
+    for (size_t nid = 0; nid < nodes_.size(); ++nid) {
+      const auto& node = nodes_[nid];
+      if (node.GetOpType() != "kernel") continue;
+      // The shapes are read from the bound tensors, so that a dynamic M is handled by the same
+      // graph.
+      const std::string& name = node.GetOpName();
+      std::vector<JSONGraphNodeEntry> inputs = node.GetInputs();
+      ICHECK(inputs.size() == 2 || inputs.size() == 3) << "Unexpected inputs of " << name;
+      const DLTensor* a = data_entry_[EntryID(inputs[0])];
+      const DLTensor* b = data_entry_[EntryID(inputs[1])];
+      const DLTensor* bias = inputs.size() == 3 ? data_entry_[EntryID(inputs[2])] : nullptr;
+      const DLTensor* out = data_entry_[EntryID(nid, 0)];
+      ICHECK(out != nullptr) << "The output of " << name << " must be an output of the graph";
+      tvm::contrib::CallCublasLt(entry->handle, stream, a, b, bias, out, GetEpilogue(name));
+    }
+  }
+
+ private:
+  /*! \brief Get the cuBLASLt epilogue of a kernel node named cublas.matmul[_bias][_<act>]. */
+  static cublasLtEpilogue_t GetEpilogue(const std::string& name) {
+    if (name == "cublas.matmul") return CUBLASLT_EPILOGUE_DEFAULT;
+    if (name == "cublas.matmul_bias") return CUBLASLT_EPILOGUE_BIAS;
+    if (name == "cublas.matmul_bias_relu") return CUBLASLT_EPILOGUE_RELU_BIAS;
+#if CUDART_VERSION >= 11030
+    if (name == "cublas.matmul_bias_gelu") return CUBLASLT_EPILOGUE_GELU_BIAS;
+#endif
+    LOG(FATAL) << "Unsupported cuBLAS kernel " << name;
+    return CUBLASLT_EPILOGUE_DEFAULT;
+  }
+};
+
+runtime::Module CublasJSONRuntimeCreate(String symbol_name, String graph_json,
+                                        const Array<String>& const_names) {
+  auto n = make_object<CublasJSONRuntime>(symbol_name, graph_json, const_names);
+  return runtime::Module(n);
+}
+
+TVM_REGISTER_GLOBAL("runtime.CublasJSONRuntimeCreate").set_body_typed(CublasJSONRuntimeCreate);
+
+TVM_REGISTER_GLOBAL("runtime.module.loadbinary_cublas_json")
+    .set_body_typed(JSONRuntimeBase::LoadFromBinary<CublasJSONRuntime>);
+#endif  // CUDART_VERSION >= 11000
+
+}  // namespace contrib
+}  // namespace runtime
+}  // namespace tvm
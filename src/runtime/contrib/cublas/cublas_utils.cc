@@ -48,5 +48,87 @@ CuBlasThreadEntry* CuBlasThreadEntry::ThreadLocal() {
   return retval;
 }
 
+#if CUDART_VERSION >= 10010
+CuBlasLtThreadEntry::CuBlasLtThreadEntry() { CHECK_CUBLAS_ERROR(cublasLtCreate(&handle)); }
+
+CuBlasLtThreadEntry::~CuBlasLtThreadEntry() {
+  if (handle) {
+    cublasLtDestroy(handle);
+    handle = nullptr;
+  }
+}
+
+typedef dmlc::ThreadLocalStore<CuBlasLtThreadEntry> CuBlasLtThreadStore;
+
+CuBlasLtThreadEntry* CuBlasLtThreadEntry::ThreadLocal() { return CuBlasLtThreadStore::Get(); }
+
+void CallCublasLt(cublasLtHandle_t hdl, cudaStream_t stream, const DLTensor* A, const DLTensor* B,
+                  const DLTensor* bias, const DLTensor* C, cublasLtEpilogue_t epilogue) {
+  ICHECK_GE(A->ndim, 2);
+  ICHECK_GE(B->ndim, 2);
+  ICHECK_EQ(C->ndim, A->ndim);
+  ICHECK(A->dtype.code == B->dtype.code && A->dtype.bits == B->dtype.bits);
+  ICHECK(A->dtype.code == kDLFloat && (A->dtype.bits == 16 || A->dtype.bits == 32))
+      << "cuBLASLt offload supports float16 and float32 only";
+  int64_t M = A->shape[A->ndim - 2];
+  int64_t K = A->shape[A->ndim - 1];
+  int64_t N = B->shape[B->ndim - 1];
+  ICHECK_EQ(B->shape[B->ndim - 2], K);
+  int64_t batch_count = 1;
+  for (int i = 0; i < A->ndim - 2; ++i) batch_count *= A->shape[i];
+  // A 2-D right operand is shared by every batch.
+  int64_t stride_b = B->ndim == 2 ? 0 : K * N;
+  ICHECK(B->ndim == 2 || B->ndim == A->ndim) << "The batch dims of B must match those of A";
+
+  cudaDataType_t dtype = GetCudaDataType(A->dtype);
+  cublasLtMatmulDesc_t op_desc = nullptr;
+#if CUDART_VERSION >= 11000
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescCreate(&op_desc, CUBLAS_COMPUTE_32F, CUDA_R_32F));
+#else
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescCreate(&op_desc, CUDA_R_32F));
+#endif
+  CHECK_CUBLAS_ERROR(cublasLtMatmulDescSetAttribute(op_desc, CUBLASLT_MATMUL_DESC_EPILOGUE,
+                                                    &epilogue, sizeof(epilogue)));
+  if (bias != nullptr) {
+    ICHECK_EQ(bias->shape[bias->ndim - 1], N);
+    void* bias_data = static_cast<char*>(bias->data) + bias->byte_offset;
+    CHECK_CUBLAS_ERROR(cublasLtMatmulDescSetAttribute(op_desc, CUBLASLT_MATMUL_DESC_BIAS_POINTER,
+                                                      &bias_data, sizeof(bias_data)));
+  }
+
+  // cuBLASLt is column-major, so compute C^T = B^T * A^T whose operands are the row-major
+  // buffers as they are.
+  cublasLtMatrixLayout_t a_desc = nullptr, b_desc = nullptr, c_desc = nullptr;
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&a_desc, dtype, K, M, K));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&b_desc, dtype, N, K, N));
+  CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutCreate(&c_desc, dtype, N, M, N));
+  if (batch_count > 1) {
+    int batch = static_cast<int>(batch_count);
+    int64_t stride_a = M * K, stride_c = M * N;
+    auto set_batch = [batch](cublasLtMatrixLayout_t desc, int64_t stride) {
+      CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutSetAttribute(desc, CUBLASLT_MATRIX_LAYOUT_BATCH_COUNT,
+                                                          &batch, sizeof(batch)));
+      CHECK_CUBLAS_ERROR(cublasLtMatrixLayoutSetAttribute(
+          desc, CUBLASLT_MATRIX_LAYOUT_STRIDED_BATCH_OFFSET, &stride, sizeof(stride)));
+    };
+    set_batch(a_desc, stride_a);
+    set_batch(b_desc, stride_b);
+    set_batch(c_desc, stride_c);
+  }
+
+  float alpha = 1.0f, beta = 0.0f;
+  const void* a_data = static_cast<const char*>(A->data) + A->byte_offset;
+  const void* b_data = static_cast<const char*>(B->data) + B->byte_offset;
+  void* c_data = static_cast<char*>(C->data) + C->byte_offset;
+  CHECK_CUBLAS_ERROR(cublasLtMatmul(hdl, op_desc, &alpha, b_data, b_desc, a_data, a_desc, &beta,
+                                    c_data, c_desc, c_data, c_desc, nullptr, nullptr, 0, stream));
+
+  cublasLtMatrixLayoutDestroy(a_desc);
+  cublasLtMatrixLayoutDestroy(b_desc);
+  cublasLtMatrixLayoutDestroy(c_desc);
+  cublasLtMatmulDescDestroy(op_desc);
+}
+#endif  // CUDART_VERSION >= 10010
+
 }  // namespace contrib
 }  // namespace tvm
@@ -77,6 +77,29 @@ struct CuBlasThreadEntry {
   static CuBlasThreadEntry* ThreadLocal();
 };  // CuBlasThreadEntry
 
+#if CUDART_VERSION >= 10010
+struct CuBlasLtThreadEntry {
+  CuBlasLtThreadEntry();
+  ~CuBlasLtThreadEntry();
+  cublasLtHandle_t handle{nullptr};
+  static CuBlasLtThreadEntry* ThreadLocal();
+};  // CuBlasLtThreadEntry
+
+/*!
+ * \brief Compute the row-major C = epilogue(A * B + bias) with cuBLASLt.
+ * \param hdl The cuBLASLt handle.
+ * \param stream The stream to run on.
+ * \param A The left operand, of shape (..., M, K).
+ * \param B The right operand, of shape (K, N) or of the batch shape of A followed by (K, N).
+ * \param bias The bias of shape (N), or nullptr.
+ * \param C The output, of the batch shape of A followed by (M, N).
+ * \param epilogue The epilogue applied to the product, CUBLASLT_EPILOGUE_BIAS and the like
+ *  requiring \p bias.
+ */
+void CallCublasLt(cublasLtHandle_t hdl, cudaStream_t stream, const DLTensor* A, const DLTensor* B,
+                  const DLTensor* bias, const DLTensor* C, cublasLtEpilogue_t epilogue);
+#endif  // CUDART_VERSION >= 10010
+
 inline cudaDataType_t GetCudaDataType(DLDataType type) {
   if (type.code == kDLInt) {
     switch (type.bits) {
@@ -23,11 +23,15 @@
  */
 
 #include <dmlc/parameter.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/registry.h>
 
+#include <cstdint>
 #include <fstream>
+#include <iomanip>
 #include <memory>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -74,6 +78,7 @@ class TensorRTRuntime : public JSONRuntimeBase {
         max_batch_size_(-1),
         multi_engine_mode_(false),
         use_fp16_(false) {
+    cache_dir_ = dmlc::GetEnv("TVM_TENSORRT_CACHE_DIR", std::string(""));
     const bool use_int8 = dmlc::GetEnv("TVM_TENSORRT_USE_INT8", false);
     multi_engine_mode_ = dmlc::GetEnv("TVM_TENSORRT_MULTI_ENGINE", false);
     num_calibration_batches_remaining_ = dmlc::GetEnv("TENSORRT_NUM_CALI_INT8", 0);
@@ -108,9 +113,28 @@ class TensorRTRuntime : public JSONRuntimeBase {
         << "The number of input constants must match the number of required.";
     LoadGlobalAttributes();
     SetupConstants(consts);
+    subgraph_key_ = GetSubgraphKey(consts);
     GetCachedEnginesFromDisk();
   }
 
+  /*!
+   * \brief Get a packed function. Besides the functions of the JSON runtime, "build_engine" builds
+   * the engine of the subgraph for the input shapes of the JSON graph and caches it to the
+   * directory given as argument, so that a deployment shipping the directory loads the engine
+   * instead of building it on first use.
+   */
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) override {
+    if (name == "build_engine") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        ICHECK(this->initialized_) << "The module has not been initialized";
+        ICHECK_EQ(args.size(), 1U);
+        cache_dir_ = args[0].operator std::string();
+        *rv = PrebuildEngine();
+      });
+    }
+    return JSONRuntimeBase::GetFunction(name, sptr_to_self);
+  }
+
   void LoadGlobalAttributes() {
     // These settings are global to the entire subgraph. Codegen will add them as attributes to all
     // op nodes. Read from first one.
@@ -354,10 +378,8 @@ class TensorRTRuntime : public JSONRuntimeBase {
    * have to be built at first inference.
    */
   bool GetCachedEnginesFromDisk() {
-    std::string cache_dir = dmlc::GetEnv("TVM_TENSORRT_CACHE_DIR", std::string(""));
-    if (cache_dir.empty()) return false;
-    std::string key = GetSubgraphKey();
-    std::string path = cache_dir + "/" + key + ".plan";
+    if (cache_dir_.empty()) return false;
+    std::string path = cache_dir_ + "/" + subgraph_key_ + ".plan";
     // Check if engine is in the cache.
     std::ifstream infile(path, std::ios::binary);
     if (!infile.good()) return false;
@@ -372,7 +394,7 @@ class TensorRTRuntime : public JSONRuntimeBase {
         runtime->deserializeCudaEngine(&serialized_engine[0], serialized_engine.size(), nullptr);
     engine_and_context.context = engine_and_context.engine->createExecutionContext();
     // Load metadata
-    std::string meta_path = cache_dir + "/" + key + ".meta";
+    std::string meta_path = cache_dir_ + "/" + subgraph_key_ + ".meta";
     std::string serialized_meta;
     LoadBinaryFromFile(meta_path, &serialized_meta);
     std::istringstream is(serialized_meta);
@@ -392,12 +414,11 @@ class TensorRTRuntime : public JSONRuntimeBase {
   /*! \brief If TVM_TENSORRT_CACHE_DIR is set, will save the engine to that
    * directory so it can be loaded later.
    */
-  void CacheEngineToDisk() {
-    int batch_size = GetBatchSize();
-    std::string cache_dir = dmlc::GetEnv("TVM_TENSORRT_CACHE_DIR", std::string(""));
-    if (cache_dir.empty()) return;
-    std::string key = GetSubgraphKey();
-    std::string path = cache_dir + "/" + key + ".plan";
+  void CacheEngineToDisk() { CacheEngineToDisk(GetBatchSize()); }
+
+  void CacheEngineToDisk(int batch_size) {
+    if (cache_dir_.empty()) return;
+    std::string path = cache_dir_ + "/" + subgraph_key_ + ".plan";
     DLOG(INFO) << "Caching TensorRT engine to " << path;
     // Serialize engine to disk
     nvinfer1::IHostMemory* serialized_engine =
@@ -415,15 +436,66 @@ class TensorRTRuntime : public JSONRuntimeBase {
                                trt_engine_cache_[std::make_pair(symbol_name_, batch_size)].outputs);
     writer.WriteObjectKeyValue("batch_size", batch_size);
     writer.EndObject();
-    std::string meta_path = cache_dir + "/" + key + ".meta";
+    std::string meta_path = cache_dir_ + "/" + subgraph_key_ + ".meta";
     SaveBinaryToFile(meta_path, os.str());
   }
 
-  std::string GetSubgraphKey() {
-    // Using this key will only allow a single model per TVM_TENSORRT_CACHE_DIR directory. We could
-    // instead use a hash of graph_json and all weights to allow many models in the same directory,
-    // but the cost of computing the hash is high.
-    return symbol_name_ + (dmlc::GetEnv("TVM_TENSORRT_USE_FP16", false) ? "_fp16" : "_fp32");
+  /*!
+   * \brief Build the engine for the batch size of the JSON graph and cache it to disk.
+   * \return Whether the engine was built, which requires the input shapes to be static.
+   */
+  bool PrebuildEngine() {
+    int batch_size = -1;
+    for (uint32_t nid : input_nodes_) {
+      if (nodes_[nid].GetOpType() != "input") continue;
+      for (const std::vector<int64_t>& shape : nodes_[nid].GetOpShape()) {
+        for (int64_t dim : shape) {
+          if (dim < 0) {
+            LOG(WARNING) << "The TensorRT engine of " << symbol_name_
+                         << " is not prebuilt as its input shapes are dynamic";
+            return false;
+          }
+        }
+        if (batch_size == -1) batch_size = shape.empty() ? 1 : static_cast<int>(shape[0]);
+      }
+    }
+    if (!multi_engine_mode_) {
+      DestroyEngines();
+      max_batch_size_ = batch_size;
+    }
+    BuildEngineFromJson(batch_size);
+    CacheEngineToDisk(batch_size);
+    return true;
+  }
+
+  /*!
+   * \brief Get the key of the cached engines of the subgraph. The key identifies the graph and
+   * its weights by their hash, and the GPU architecture and TensorRT version the engine is only
+   * valid for, so that a cache directory can hold the engines of many models and devices.
+   */
+  std::string GetSubgraphKey(const Array<NDArray>& consts) {
+    // FNV-1a over the graph and the bytes of the weights.
+    uint64_t hash = 14695981039346656037ULL;
+    auto update = [&hash](const char* data, size_t size) {
+      for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(data[i])) * 1099511628211ULL;
+      }
+    };
+    update(graph_json_.data(), graph_json_.size());
+    for (const NDArray& value : consts) {
+      NDArray host = value->device.device_type == kDLCPU ? value : value.CopyTo({kDLCPU, 0});
+      const DLTensor* tensor = host.operator->();
+      update(static_cast<const char*>(tensor->data) + tensor->byte_offset, GetDataSize(*tensor));
+    }
+    TVMRetValue arch;
+    Device dev{kDLCUDA, 0};
+    DeviceAPI::Get(dev)->GetAttr(dev, kComputeVersion, &arch);
+    std::ostringstream os;
+    os << symbol_name_ << "_" << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec
+       << "_sm" << arch.operator std::string() << "_trt" << NV_TENSORRT_MAJOR << "."
+       << NV_TENSORRT_MINOR << "." << NV_TENSORRT_PATCH
+       << (dmlc::GetEnv("TVM_TENSORRT_USE_FP16", false) || use_fp16_ ? "_fp16" : "_fp32");
+    return os.str();
   }
 
   /*! \brief Retreive a GPU buffer for input or output or allocate if needed. */
@@ -475,6 +547,9 @@ class TensorRTRuntime : public JSONRuntimeBase {
   /*! \brief TensorRT logger. */
   TensorRTLogger logger_;
 
+  /*! \brief The key of the cached engines of the subgraph. */
+  std::string subgraph_key_;
+
 #else   // TVM_GRAPH_EXECUTOR_TENSORRT
   void Run() override {
     LOG(FATAL) << "TensorRT runtime is not enabled. "
@@ -488,6 +563,14 @@ class TensorRTRuntime : public JSONRuntimeBase {
 
   bool GetCachedEnginesFromDisk() { return false; }
 
+  std::string GetSubgraphKey(const Array<NDArray>& consts) { return symbol_name_; }
+
+  bool PrebuildEngine() {
+    LOG(WARNING) << "TensorRT runtime is not enabled, the engine of " << symbol_name_
+                 << " is not prebuilt";
+    return false;
+  }
+
   void CacheEngineToDisk() {}
 #endif  // TVM_GRAPH_EXECUTOR_TENSORRT
 
@@ -511,6 +594,9 @@ class TensorRTRuntime : public JSONRuntimeBase {
 
   /*! \brief Use auto-conversion to fp16 */
   bool use_fp16_;
+
+  /*! \brief The directory of the cached engines, from TVM_TENSORRT_CACHE_DIR by default. */
+  std::string cache_dir_;
 };
 
 runtime::Module TensorRTRuntimeCreate(const String& symbol_name, const String& graph_json,
@@ -23,10 +23,12 @@
 
 #include <thrust/device_ptr.h>
 #include <thrust/device_vector.h>
+#include <thrust/functional.h>
 #include <thrust/sort.h>
 #include <thrust/gather.h>
 #include <thrust/scan.h>
 #include <thrust/sequence.h>
+#include <thrust/unique.h>
 
 #include <tvm/runtime/registry.h>
 #include <dlpack/dlpack.h>
@@ -390,5 +392,80 @@ TVM_REGISTER_GLOBAL("tvm.contrib.thrust.sum_scan")
   }
 });
 
+// Writes the unique elements of the flattened input to the front of values_out, which holds as
+// many elements as the input, sorted ascending or in the reverse order of their first
+// occurrences, and their number to the int64 scalar extent_out on the device. The number is never
+// read back to the host, so that the later kernels may consume the unique elements at the bound.
+template<typename DataType>
+void thrust_unique(DLTensor* input, DLTensor* values_out, DLTensor* extent_out, bool sorted) {
+  int64_t size = 1;
+  for (int i = 0; i < input->ndim; ++i) size *= input->shape[i];
+  thrust::device_ptr<DataType> input_ptr(static_cast<DataType *>(input->data));
+  thrust::device_ptr<DataType> values_ptr(static_cast<DataType *>(values_out->data));
+  thrust::device_ptr<int64_t> extent_ptr(static_cast<int64_t *>(extent_out->data));
+  if (size == 0) {
+    thrust::fill(extent_ptr, extent_ptr + 1, 0);
+    return;
+  }
+
+  thrust::device_vector<DataType> keys(input_ptr, input_ptr + size);
+  thrust::device_vector<int64_t> first_index(size);
+  thrust::sequence(first_index.begin(), first_index.end());
+  // As the sort is stable, the first element of every run of equal values is its first occurrence.
+  thrust::stable_sort_by_key(keys.begin(), keys.end(), first_index.begin());
+  const DataType* keys_raw = thrust::raw_pointer_cast(keys.data());
+  auto is_head = [keys_raw] __host__ __device__(int64_t i) -> int64_t {
+    return i == 0 || keys_raw[i] != keys_raw[i - 1];
+  }; // NOLINT(*)
+  // The position of every head of a run among the unique elements, plus one.
+  thrust::device_vector<int64_t> position(size);
+  auto counting_iter = thrust::counting_iterator<int64_t>(0);
+  thrust::transform(counting_iter, counting_iter + size, position.begin(), is_head);
+  thrust::inclusive_scan(position.begin(), position.end(), position.begin());
+  thrust::copy(position.end() - 1, position.end(), extent_ptr);
+
+  const int64_t* position_raw = thrust::raw_pointer_cast(position.data());
+  if (sorted) {
+    DataType* values_raw = thrust::raw_pointer_cast(values_ptr);
+    thrust::for_each(counting_iter, counting_iter + size,
+                     [=] __device__(int64_t i) {
+                       if (is_head(i)) values_raw[position_raw[i] - 1] = keys_raw[i];
+                     }); // NOLINT(*)
+  } else {
+    // The heads are ordered by their first index descending, the other elements are moved last.
+    int64_t* first_index_raw = thrust::raw_pointer_cast(first_index.data());
+    thrust::for_each(counting_iter, counting_iter + size,
+                     [=] __device__(int64_t i) {
+                       if (!is_head(i)) first_index_raw[i] = -1;
+                     }); // NOLINT(*)
+    thrust::sort_by_key(first_index.begin(), first_index.end(), keys.begin(),
+                        thrust::greater<int64_t>());
+    thrust::copy(keys.begin(), keys.end(), values_ptr);
+  }
+}
+
+TVM_REGISTER_GLOBAL("tvm.contrib.thrust.unique")
+.set_body([](TVMArgs args, TVMRetValue* ret) {
+  ICHECK_EQ(args.num_args, 4);
+  DLTensor* input = args[0];
+  DLTensor* values_out = args[1];
+  DLTensor* extent_out = args[2];
+  bool sorted = args[3];
+
+  auto data_dtype = DLDataType2String(input->dtype);
+  if (data_dtype == "int32") {
+    thrust_unique<int>(input, values_out, extent_out, sorted);
+  } else if (data_dtype == "int64") {
+    thrust_unique<int64_t>(input, values_out, extent_out, sorted);
+  } else if (data_dtype == "float32") {
+    thrust_unique<float>(input, values_out, extent_out, sorted);
+  } else if (data_dtype == "float64") {
+    thrust_unique<double>(input, values_out, extent_out, sorted);
+  } else {
+    LOG(FATAL) << "Unsupported input dtype: " << data_dtype
+               << ". Supported input dtypes are int32, int64, float32, and float64";
+  }
+});
+
 }  // namespace contrib
 }  // namespace tvm
@@ -24,15 +24,24 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
 
 #include "workspace_pool.h"
 
 #ifdef __ANDROID__
 #include <android/api-level.h>
 #endif
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace tvm {
 namespace runtime {
@@ -45,6 +54,12 @@ class CPUDeviceAPI final : public DeviceAPI {
     }
   }
   void* AllocDataSpace(Device dev, size_t nbytes, size_t alignment, DLDataType type_hint) final {
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+    const std::vector<unsigned int>& numa_nodes = threading::GetMemoryNumaNodes();
+    if (!numa_nodes.empty() && nbytes >= kMinNumaBindBytes) {
+      return AllocNumaLocal(nbytes, alignment, numa_nodes);
+    }
+#endif
     void* ptr;
 #if _MSC_VER
     ptr = _aligned_malloc(nbytes, alignment);
@@ -81,6 +96,32 @@ class CPUDeviceAPI final : public DeviceAPI {
   }
 
  protected:
+#if defined(__linux__) && !defined(__ANDROID__) && defined(SYS_mbind)
+  /*! \brief The min size of an allocation to bind to NUMA nodes, smaller ones share pages */
+  static constexpr size_t kMinNumaBindBytes = 64 * 1024;
+
+  // Allocate whole pages, and bind them to the NUMA nodes before they are touched.
+  void* AllocNumaLocal(size_t nbytes, size_t alignment, const std::vector<unsigned int>& nodes) {
+    static const size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t size = (nbytes + page_size - 1) / page_size * page_size;
+    void* ptr;
+    int ret = posix_memalign(&ptr, std::max(alignment, page_size), size);
+    if (ret != 0) throw std::bad_alloc();
+    constexpr size_t kBitsPerMask = sizeof(unsigned long) * 8;  // NOLINT(runtime/int)
+    unsigned int max_node = *std::max_element(nodes.begin(), nodes.end());
+    std::vector<unsigned long> mask(max_node / kBitsPerMask + 1, 0);  // NOLINT(runtime/int)
+    for (unsigned int node : nodes) {
+      mask[node / kBitsPerMask] |= 1UL << (node % kBitsPerMask);
+    }
+    // MPOL_MF_MOVE also moves the pages the allocator has touched already, e.g. reused ones
+    if (syscall(SYS_mbind, ptr, size, MPOL_BIND, mask.data(), max_node + 2, MPOL_MF_MOVE) != 0) {
+      LOG(WARNING) << "Failed to bind " << size << " bytes to the NUMA nodes: "
+                   << strerror(errno);
+    }
+    return ptr;
+  }
+#endif
+
   void CopyDataFromTo(const void* from, size_t from_offset, void* to, size_t to_offset, size_t size,
                       Device dev_from, Device dev_to, DLDataType type_hint,
                       TVMStreamHandle stream) final {
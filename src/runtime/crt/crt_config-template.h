@@ -54,6 +54,9 @@
 /*! Maximum supported string length in parameter names */
 #define TVM_CRT_MAX_STRLEN_PARAM_NAME 80
 
+/*! \brief Maximum depth of the calls among the Relax functions run by the CRT Relax VM. */
+#define TVM_CRT_RELAX_VM_MAX_CALL_DEPTH 8
+
 /*! \brief Maximum length of a PackedFunc function name. */
 #define TVM_CRT_MAX_FUNCTION_NAME_LENGTH_BYTES 30
 
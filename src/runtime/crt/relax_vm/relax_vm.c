@@ -0,0 +1,458 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+// LINT_C_FILE
+
+/*!
+ * \file relax_vm.c
+ * \brief A minimal interpreter of the Relax VM executables in C.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+#include <tvm/runtime/c_runtime_api.h>
+#include <tvm/runtime/crt/logging.h>
+#include <tvm/runtime/crt/packed_func.h>
+#include <tvm/runtime/crt/platform.h>
+#include <tvm/runtime/crt/relax_vm.h>
+
+#ifndef TVM_CRT_RELAX_VM_MAX_CALL_DEPTH
+#define TVM_CRT_RELAX_VM_MAX_CALL_DEPTH 8
+#endif
+
+// The encoding of the instructions, see include/tvm/runtime/relax_vm/bytecode.h.
+#define RELAX_VM_OP_CALL 1
+#define RELAX_VM_OP_RET 2
+#define RELAX_VM_OP_GOTO 3
+#define RELAX_VM_OP_IF 4
+#define RELAX_VM_OP_KILL_REGISTER 5
+#define RELAX_VM_OP_MOVE 6
+#define RELAX_VM_OP_TAIL_CALL 7
+
+#define RELAX_VM_ARG_REGISTER 0
+#define RELAX_VM_ARG_IMMEDIATE 1
+#define RELAX_VM_ARG_CONST_IDX 2
+#define RELAX_VM_ARG_VALUE_BITS 56
+#define RELAX_VM_ARG_VALUE_MASK ((((uint64_t)1) << RELAX_VM_ARG_VALUE_BITS) - 1)
+
+#define RELAX_VM_VOID_ARG 0x00EC66FE0321975AULL
+#define RELAX_VM_VM_REGISTER 0x008D14FA4379015CULL
+
+static const void* ExecAt(const TVMRelaxVM* vm, uint64_t offset) { return vm->exec + offset; }
+
+static const TVMRelaxVMFunction* GetFunction(const TVMRelaxVM* vm, int64_t index) {
+  return (const TVMRelaxVMFunction*)ExecAt(vm, vm->header->functions_offset) + index;
+}
+
+static const char* GetFuncName(const TVMRelaxVM* vm, int64_t index) {
+  const uint64_t* offsets = (const uint64_t*)ExecAt(vm, vm->header->func_names_offset);
+  return (const char*)ExecAt(vm, offsets[index]);
+}
+
+static const TVMRelaxVMConstant* GetConstant(const TVMRelaxVM* vm, int64_t index) {
+  return (const TVMRelaxVMConstant*)ExecAt(vm, vm->header->constants_offset) + index;
+}
+
+static const int64_t* GetInstr(const TVMRelaxVM* vm, int64_t pc) {
+  const int64_t* offsets = (const int64_t*)ExecAt(vm, vm->header->instr_offsets_offset);
+  return (const int64_t*)ExecAt(vm, vm->header->code_offset) + offsets[pc];
+}
+
+static int32_t GetSlot(const TVMRelaxVM* vm, int64_t pc, int which) {
+  const int32_t* slots = (const int32_t*)ExecAt(vm, vm->header->slots_offset);
+  return slots[pc * 2 + which];
+}
+
+static uint8_t* GetStorage(const TVMRelaxVM* vm, int32_t index) {
+  const uint64_t* offsets = (const uint64_t*)ExecAt(vm, vm->header->storage_offsets_offset);
+  return vm->storage + offsets[index];
+}
+
+static int AllocZeroed(size_t size, DLDevice device, void** out) {
+  *out = NULL;
+  if (size == 0) {
+    return 0;
+  }
+  if (TVMPlatformMemoryAllocate(size, device, out) != kTvmErrorNoError) {
+    return -1;
+  }
+  memset(*out, 0, size);
+  return 0;
+}
+
+static void LoadConstant(const TVMRelaxVM* vm, int64_t index, TVMValue* value, int* tcode) {
+  const TVMRelaxVMConstant* constant = GetConstant(vm, index);
+  switch (constant->kind) {
+    case kTVMRelaxVMConstInt:
+      value->v_int64 = constant->value.v_int64;
+      *tcode = kDLInt;
+      break;
+    case kTVMRelaxVMConstFloat:
+      value->v_float64 = constant->value.v_float64;
+      *tcode = kDLFloat;
+      break;
+    case kTVMRelaxVMConstDataType:
+      value->v_type = constant->dtype;
+      *tcode = kTVMDataType;
+      break;
+    case kTVMRelaxVMConstShape:
+      value->v_handle = (void*)constant;
+      *tcode = kTVMRelaxVMShape;
+      break;
+    case kTVMRelaxVMConstString:
+      value->v_str = (const char*)ExecAt(vm, constant->value.offset);
+      *tcode = kTVMStr;
+      break;
+    default:
+      value->v_handle = &vm->constant_tensors[index];
+      *tcode = kTVMDLTensorHandle;
+      break;
+  }
+}
+
+static void ReadArg(const TVMRelaxVM* vm, int64_t frame, uint64_t word, TVMValue* value,
+                    int* tcode) {
+  if (word == RELAX_VM_VM_REGISTER) {
+    value->v_handle = (void*)vm;
+    *tcode = kTVMOpaqueHandle;
+    return;
+  }
+  uint64_t kind = (word >> RELAX_VM_ARG_VALUE_BITS) & 0xFF;
+  int64_t index = (int64_t)(word & RELAX_VM_ARG_VALUE_MASK);
+  if (kind == RELAX_VM_ARG_REGISTER) {
+    *value = vm->reg_values[frame + index];
+    *tcode = vm->reg_tcodes[frame + index];
+  } else if (kind == RELAX_VM_ARG_IMMEDIATE) {
+    value->v_int64 = index;
+    *tcode = kDLInt;
+  } else {
+    CHECK_EQ(kind, RELAX_VM_ARG_CONST_IDX, "unknown argument kind %" PRIu64, kind);
+    LoadConstant(vm, index, value, tcode);
+  }
+}
+
+static void WriteRegister(TVMRelaxVM* vm, int64_t frame, int64_t reg, TVMValue value, int tcode) {
+  if ((uint64_t)reg == RELAX_VM_VOID_ARG) {
+    return;
+  }
+  vm->reg_values[frame + reg] = value;
+  vm->reg_tcodes[frame + reg] = tcode;
+}
+
+/*! \brief Set up the tensor allocated by an instruction in its statically planned slot. */
+static void AllocTensor(TVMRelaxVM* vm, int64_t pc, void* storage, const TVMValue* args,
+                        const int* tcodes, TVMValue* ret, int* ret_tcode) {
+  // args[0]: offset; args[1]: shape; args[2]: dtype
+  CHECK_EQ(tcodes[1], kTVMRelaxVMShape, "the tensor shape of instruction %" PRId64, pc);
+  const TVMRelaxVMConstant* shape = (const TVMRelaxVMConstant*)args[1].v_handle;
+  int32_t slot = GetSlot(vm, pc, 1);
+  CHECK_GE(slot, 0, "instruction %" PRId64 " has no tensor", pc);
+  DLTensor* tensor = &vm->tensors[slot];
+  tensor->data = (uint8_t*)storage + args[0].v_int64;
+  tensor->device = vm->device;
+  tensor->ndim = (int32_t)shape->ndim;
+  tensor->dtype = args[2].v_type;
+  tensor->shape = (int64_t*)ExecAt(vm, shape->value.offset);
+  tensor->strides = NULL;
+  tensor->byte_offset = 0;
+  ret->v_handle = tensor;
+  *ret_tcode = kTVMDLTensorHandle;
+}
+
+static int64_t ReadIfCond(TVMValue cond, int tcode) {
+  if (tcode == kDLInt) {
+    return cond.v_int64 != 0;
+  }
+  CHECK(tcode == kTVMDLTensorHandle || tcode == kTVMNDArrayHandle);
+  const DLTensor* tensor = (const DLTensor*)cond.v_handle;
+  CHECK_EQ(tensor->ndim, 0, "the condition of an If must be a scalar");
+  const uint8_t* data = (const uint8_t*)tensor->data + tensor->byte_offset;
+  if (tensor->dtype.bits <= 8) {
+    return *(const int8_t*)data != 0;
+  } else if (tensor->dtype.bits == 32) {
+    return *(const int32_t*)data != 0;
+  }
+  CHECK_EQ(tensor->dtype.bits, 64, "unsupported condition type");
+  return *(const int64_t*)data != 0;
+}
+
+static int RunFunction(TVMRelaxVM* vm, int64_t function_index, const TVMValue* args,
+                       const int* tcodes, int num_args, TVMValue* ret, int* ret_tcode);
+
+/*! \brief Run a Call or TailCall instruction. */
+static int RunCall(TVMRelaxVM* vm, int64_t frame, int64_t pc, const int64_t* instr,
+                   TVMValue* ret, int* ret_tcode) {
+  // instr[1]: dst; instr[2]: func_idx; instr[3]: num_args; instr[4, ...]: args
+  int64_t func_idx = instr[2];
+  int64_t num_args = instr[3];
+  TVMValue values[TVM_CRT_MAX_ARGS];
+  int tcodes[TVM_CRT_MAX_ARGS];
+  CHECK_LE(num_args, TVM_CRT_MAX_ARGS, "too many args %" PRId64 "\n", num_args);
+  int64_t i;
+  for (i = 0; i < num_args; ++i) {
+    ReadArg(vm, frame, (uint64_t)instr[4 + i], &values[i], &tcodes[i]);
+  }
+  ret->v_handle = NULL;
+  *ret_tcode = kTVMNullptr;
+  const TVMRelaxVMCallee* callee = &vm->callees[func_idx];
+  switch (callee->kind) {
+    case kTVMRelaxVMCallKernel:
+      return TVMFuncCall(callee->kernel, values, tcodes, (int)num_args, ret, ret_tcode);
+    case kTVMRelaxVMCallFunction:
+      return RunFunction(vm, callee->function_index, values, tcodes, (int)num_args, ret,
+                         ret_tcode);
+    case kTVMRelaxVMCallAllocStorage:
+      // args[0]: vm; args[1]: size; args[2]: device index; args[3]: dtype hint
+      ret->v_handle = GetStorage(vm, GetSlot(vm, pc, 0));
+      *ret_tcode = kTVMOpaqueHandle;
+      return 0;
+    case kTVMRelaxVMCallAllocTensor:
+      // args[0]: storage; args[1, 2, 3]: offset, shape, dtype
+      AllocTensor(vm, pc, values[0].v_handle, &values[1], &tcodes[1], ret, ret_tcode);
+      return 0;
+    case kTVMRelaxVMCallAllocOutputTensor:
+      // args[0]: vm; args[1]: storage; args[2, 3, 4]: offset, shape, dtype; args[5]: output
+      // index. The caller provides no output buffer, the tensor lives in its storage.
+      AllocTensor(vm, pc, values[1].v_handle, &values[2], &tcodes[2], ret, ret_tcode);
+      return 0;
+    case kTVMRelaxVMCallAllocStorageAndTensor:
+      // args[0, ..., 3]: the arguments of alloc_storage; args[4, 5, 6]: offset, shape, dtype
+      AllocTensor(vm, pc, GetStorage(vm, GetSlot(vm, pc, 0)), &values[4], &tcodes[4], ret,
+                  ret_tcode);
+      return 0;
+    case kTVMRelaxVMCallReadIfCond:
+      ret->v_int64 = ReadIfCond(values[0], tcodes[0]);
+      *ret_tcode = kDLInt;
+      return 0;
+    default:
+      CHECK_EQ(callee->kind, kTVMRelaxVMCallCopy, "unknown callee kind %d", callee->kind);
+      *ret = values[0];
+      *ret_tcode = tcodes[0];
+      return 0;
+  }
+}
+
+static int RunFunction(TVMRelaxVM* vm, int64_t function_index, const TVMValue* args,
+                       const int* tcodes, int num_args, TVMValue* ret, int* ret_tcode) {
+  const TVMRelaxVMFunction* func = GetFunction(vm, function_index);
+  CHECK_EQ(num_args, func->num_args, "wrong number of args to %s",
+           (const char*)ExecAt(vm, func->name_offset));
+  int64_t frame = vm->reg_top;
+  if (frame + func->register_file_size > vm->num_registers) {
+    LOG_ERROR("calls are nested deeper than TVM_CRT_RELAX_VM_MAX_CALL_DEPTH\n");
+    return -1;
+  }
+  vm->reg_top = frame + func->register_file_size;
+  int i;
+  for (i = 0; i < num_args; ++i) {
+    vm->reg_values[frame + i] = args[i];
+    vm->reg_tcodes[frame + i] = tcodes[i];
+  }
+
+  int status = 0;
+  int64_t pc = func->start_instr;
+  TVMValue value;
+  int tcode;
+  while (status == 0) {
+    const int64_t* instr = GetInstr(vm, pc);
+    switch (instr[0]) {
+      case RELAX_VM_OP_CALL:
+        status = RunCall(vm, frame, pc, instr, &value, &tcode);
+        WriteRegister(vm, frame, instr[1], value, tcode);
+        pc++;
+        break;
+      case RELAX_VM_OP_TAIL_CALL:
+        // The callee runs in a frame of its own, above the frame of the caller.
+        status = RunCall(vm, frame, pc, instr, ret, ret_tcode);
+        vm->reg_top = frame;
+        return status;
+      case RELAX_VM_OP_RET:
+        *ret = vm->reg_values[frame + instr[1]];
+        *ret_tcode = vm->reg_tcodes[frame + instr[1]];
+        vm->reg_top = frame;
+        return 0;
+      case RELAX_VM_OP_GOTO:
+        pc += instr[1];
+        break;
+      case RELAX_VM_OP_IF:
+        if (vm->reg_values[frame + instr[1]].v_int64 != 0) {
+          pc++;
+        } else {
+          pc += instr[2];
+        }
+        break;
+      case RELAX_VM_OP_KILL_REGISTER:
+        // The storages are statically planned, there is nothing to release.
+        pc++;
+        break;
+      case RELAX_VM_OP_MOVE:
+        ReadArg(vm, frame, (uint64_t)instr[2], &value, &tcode);
+        WriteRegister(vm, frame, instr[1], value, tcode);
+        pc++;
+        break;
+      default:
+        LOG_ERROR("unknown opcode %" PRId64 " at instruction %" PRId64 "\n", instr[0], pc);
+        status = -1;
+        break;
+    }
+  }
+  vm->reg_top = frame;
+  return status;
+}
+
+static int ResolveCallee(TVMRelaxVM* vm, int64_t index) {
+  static const struct {
+    const char* name;
+    int kind;
+  } kBuiltins[] = {
+      {"vm.builtin.alloc_storage", kTVMRelaxVMCallAllocStorage},
+      {"vm.builtin.alloc_tensor", kTVMRelaxVMCallAllocTensor},
+      {"vm.builtin.alloc_storage_and_tensor", kTVMRelaxVMCallAllocStorageAndTensor},
+      {"vm.builtin.alloc_output_tensor", kTVMRelaxVMCallAllocOutputTensor},
+      {"vm.builtin.read_if_cond", kTVMRelaxVMCallReadIfCond},
+      {"vm.builtin.copy", kTVMRelaxVMCallCopy},
+  };
+  const char* name = GetFuncName(vm, index);
+  TVMRelaxVMCallee* callee = &vm->callees[index];
+  size_t i;
+  for (i = 0; i < sizeof(kBuiltins) / sizeof(kBuiltins[0]); ++i) {
+    if (!strcmp(kBuiltins[i].name, name)) {
+      callee->kind = kBuiltins[i].kind;
+      return 0;
+    }
+  }
+  callee->function_index = TVMRelaxVM_GetFunctionIndex(vm, name);
+  if (callee->function_index >= 0) {
+    callee->kind = kTVMRelaxVMCallFunction;
+    return 0;
+  }
+  callee->kind = kTVMRelaxVMCallKernel;
+  if (TVMModGetFunction(vm->module_handle, name, 1, &callee->kernel) != 0 ||
+      callee->kernel == NULL) {
+    LOG_ERROR("cannot find the function %s\n", name);
+    return -1;
+  }
+  return 0;
+}
+
+static int TVMRelaxVM_Init(TVMRelaxVM* vm, TVMModuleHandle module_handle, const uint8_t* exec,
+                           const DLDevice device) {
+  const TVMRelaxVMHeader* header = (const TVMRelaxVMHeader*)exec;
+  if (header->magic != TVM_RELAX_VM_CRT_MAGIC || header->version != TVM_RELAX_VM_CRT_VERSION) {
+    LOG_ERROR("invalid Relax VM executable, magic %" PRIx32 ", version %" PRIu32 "\n",
+              header->magic, header->version);
+    return -1;
+  }
+  vm->exec = exec;
+  vm->header = header;
+  vm->module_handle = module_handle;
+  vm->device = device;
+  vm->num_registers = (int64_t)header->max_num_registers * TVM_CRT_RELAX_VM_MAX_CALL_DEPTH;
+
+  // All the memory of the VM is allocated here.
+  if (AllocZeroed(header->num_func_names * sizeof(TVMRelaxVMCallee), device,
+                  (void**)&vm->callees) != 0 ||
+      AllocZeroed(header->num_constants * sizeof(DLTensor), device,
+                  (void**)&vm->constant_tensors) != 0 ||
+      AllocZeroed(header->num_tensors * sizeof(DLTensor), device, (void**)&vm->tensors) != 0 ||
+      AllocZeroed(vm->num_registers * sizeof(TVMValue), device, (void**)&vm->reg_values) != 0 ||
+      AllocZeroed(vm->num_registers * sizeof(int), device, (void**)&vm->reg_tcodes) != 0) {
+    return -1;
+  }
+  if (header->storage_bytes > 0) {
+    if (TVMPlatformMemoryAllocate(header->storage_bytes + TVM_RELAX_VM_CRT_ALIGNMENT - 1, device,
+                                  &vm->storage_alloc) != kTvmErrorNoError) {
+      return -1;
+    }
+    uintptr_t base = (uintptr_t)vm->storage_alloc;
+    vm->storage = (uint8_t*)((base + TVM_RELAX_VM_CRT_ALIGNMENT - 1) &
+                             ~(uintptr_t)(TVM_RELAX_VM_CRT_ALIGNMENT - 1));
+  }
+
+  uint32_t i;
+  for (i = 0; i < header->num_func_names; ++i) {
+    int status = ResolveCallee(vm, i);
+    if (status != 0) {
+      return status;
+    }
+  }
+  for (i = 0; i < header->num_constants; ++i) {
+    const TVMRelaxVMConstant* constant = GetConstant(vm, i);
+    if (constant->kind != kTVMRelaxVMConstNDArray) {
+      continue;
+    }
+    DLTensor* tensor = &vm->constant_tensors[i];
+    tensor->data = (void*)ExecAt(vm, constant->data_offset);
+    tensor->device = device;
+    tensor->ndim = (int32_t)constant->ndim;
+    tensor->dtype = constant->dtype;
+    tensor->shape = (int64_t*)ExecAt(vm, constant->value.offset);
+  }
+  return 0;
+}
+
+int TVMRelaxVM_Create(TVMModuleHandle module_handle, const uint8_t* exec, const DLDevice device,
+                      TVMRelaxVM** vm) {
+  tvm_crt_error_t err = TVMPlatformMemoryAllocate(sizeof(**vm), device, (void**)vm);
+  if (err != kTvmErrorNoError) {
+    return -1;
+  }
+
+  memset(*vm, 0, sizeof(**vm));
+
+  int status = TVMRelaxVM_Init(*vm, module_handle, exec, device);
+  if (status != 0) {
+    TVMRelaxVM_Release(*vm);
+    *vm = NULL;
+  }
+  return status;
+}
+
+int TVMRelaxVM_Release(TVMRelaxVM* vm) {
+  void* allocs[] = {vm->callees,    vm->constant_tensors, vm->tensors,
+                    vm->reg_values, vm->reg_tcodes,       vm->storage_alloc};
+  size_t i;
+  for (i = 0; i < sizeof(allocs) / sizeof(allocs[0]); ++i) {
+    if (allocs[i] != NULL) {
+      int status = TVMPlatformMemoryFree(allocs[i], vm->device);
+      if (status != 0) {
+        return status;
+      }
+    }
+  }
+  return TVMPlatformMemoryFree(vm, vm->device);
+}
+
+int64_t TVMRelaxVM_GetFunctionIndex(TVMRelaxVM* vm, const char* name) {
+  uint32_t i;
+  for (i = 0; i < vm->header->num_functions; ++i) {
+    if (!strcmp((const char*)ExecAt(vm, GetFunction(vm, i)->name_offset), name)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+int TVMRelaxVM_Invoke(TVMRelaxVM* vm, int64_t function_index, const TVMValue* args,
+                      const int* tcodes, int num_args, TVMValue* ret, int* ret_tcode) {
+  CHECK(function_index >= 0 && function_index < vm->header->num_functions);
+  vm->reg_top = 0;
+  return RunFunction(vm, function_index, args, tcodes, num_args, ret, ret_tcode);
+}
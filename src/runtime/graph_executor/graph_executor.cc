@@ -34,6 +34,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <map>
 #include <memory>
 #include <numeric>
 #include <string>
@@ -53,12 +54,44 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
   return align;
 }
 constexpr auto Is2DStorage = IsTextureStorage;
+/*! \brief Whether the memory of the device can be addressed at a byte offset of a buffer. */
+inline bool IsFlatAddressSpace(const Device& dev) {
+  switch (static_cast<int>(dev.device_type)) {
+    case kDLCPU:
+    case kDLCUDA:
+    case kDLCUDAHost:
+    case kDLCUDAManaged:
+    case kDLROCM:
+    case kDLROCMHost:
+      return true;
+    default:
+      return false;
+  }
+}
 }  // namespace details
 
+void SharedStoragePool::Reserve(Device dev, size_t nbytes) {
+  NDArray& buffer = buffers_[{static_cast<int>(dev.device_type), dev.device_id}];
+  if (buffer.defined() && GetDataSize(*buffer.operator->()) >= nbytes) return;
+  int64_t num_words = static_cast<int64_t>((nbytes + 3) / 4);
+  buffer = NDArray::Empty({num_words}, DLDataType{kDLFloat, 32, 1}, dev);
+  ++generation_;
+}
+
+void* SharedStoragePool::Data(Device dev) const {
+  auto it = buffers_.find({static_cast<int>(dev.device_type), dev.device_id});
+  ICHECK(it != buffers_.end()) << "No shared storage is reserved on " << dev;
+  return it->second->data;
+}
+
 /*!
  * \brief Run all the operations one by one.
  */
 void GraphExecutor::Run() {
+  // Another executor may have grown the shared storage since the last run.
+  if (shared_pool_ != nullptr && shared_pool_generation_ != shared_pool_->generation()) {
+    BindSharedStorage();
+  }
   // setup the array and requirements.
   for (size_t i = 0; i < op_execs_.size(); ++i) {
     if (op_execs_[i]) op_execs_[i]();
@@ -106,7 +139,7 @@ void GraphExecutor::Init(const std::string& graph_json, tvm::runtime::Module mod
  * \param name The name of the input.
  * \return The index of input.
  */
-int GraphExecutor::GetInputIndex(const std::string& name) {
+int GraphExecutor::GetInputIndex(const std::string& name) const {
   auto it = input_map_.find(name);
   if (it != input_map_.end()) {
     return it->second;
@@ -302,11 +335,20 @@ void GraphExecutor::ShareParams(const GraphExecutor& other, dmlc::Stream* strm)
   ICHECK(size == names.size()) << "Invalid parameters file format";
   for (size_t i = 0; i < size; ++i) {
     int in_idx = GetInputIndex(names[i]);
-    if (in_idx < 0) continue;
+    int other_idx = other.GetInputIndex(names[i]);
+    if (in_idx < 0 || other_idx < 0) continue;
     uint32_t eid = this->entry_id(input_nodes_[in_idx], 0);
     ICHECK_LT(eid, data_entry_.size());
+    // A variant of the model may have a parameter of the same name but another shape, which
+    // keeps its own copy.
+    NDArray shared = other.GetInput(other_idx);
+    const DLTensor* own = data_entry_[eid].operator->();
+    if (shared->ndim != own->ndim || !TypeEqual(shared->dtype, own->dtype) ||
+        !std::equal(own->shape, own->shape + own->ndim, shared->shape)) {
+      continue;
+    }
     ICHECK_EQ(data_entry_[eid].use_count(), 1);
-    data_entry_[eid] = other.GetInput(GetInputIndex(names[i]));
+    data_entry_[eid] = shared;
     ICHECK_GT(data_entry_[eid].use_count(), 1);
     const DLTensor* tmp = data_entry_[eid].operator->();
     data_alignment_[eid] = details::GetDataAlignment(*tmp);
@@ -314,6 +356,71 @@ void GraphExecutor::ShareParams(const GraphExecutor& other, dmlc::Stream* strm)
   this->SetupOpExecs();
 }
 
+void GraphExecutor::ShareStorage(GraphExecutor* other) {
+  if (other->shared_pool_ == nullptr) {
+    other->MoveStorageToSharedPool(std::make_shared<SharedStoragePool>());
+  }
+  if (shared_pool_ == other->shared_pool_) return;
+  this->MoveStorageToSharedPool(other->shared_pool_);
+}
+
+void GraphExecutor::MoveStorageToSharedPool(std::shared_ptr<SharedStoragePool> pool) {
+  CHECK(shared_pool_ == nullptr) << "The graph executor already shares its storage";
+  // The storages of the inputs and the outputs are alive across runs, so they are kept private.
+  std::vector<bool> shareable(storage_pool_.size(), true);
+  for (uint32_t nid : input_nodes_) {
+    shareable[attrs_.storage_id[entry_id(nid, 0)]] = false;
+  }
+  for (const NodeEntry& e : outputs_) {
+    shareable[attrs_.storage_id[entry_id(e)]] = false;
+  }
+  std::map<std::pair<int, int>, size_t> device_bytes;
+  std::vector<int64_t> storage_offset(storage_pool_.size(), -1);
+  std::vector<Device> storage_device(storage_pool_.size());
+  for (size_t sid = 0; sid < storage_pool_.size(); ++sid) {
+    const DLTensor* storage = storage_pool_[sid].operator->();
+    if (!shareable[sid] || storage->ndim != 1 || !details::IsFlatAddressSpace(storage->device)) {
+      continue;
+    }
+    size_t& offset = device_bytes[{static_cast<int>(storage->device.device_type),
+                                   storage->device.device_id}];
+    storage_offset[sid] = static_cast<int64_t>(offset);
+    storage_device[sid] = storage->device;
+    offset += (GetDataSize(*storage) + kAllocAlignment - 1) / kAllocAlignment * kAllocAlignment;
+    // The storage does not own its data, which is bound to the shared buffer on every run.
+    auto* container = new NDArray::Container(nullptr, storage_pool_[sid].Shape(),
+                                             storage->dtype, storage->device);
+    container->SetDeleter(GraphExecutor::LinkedNDArrayDeleter);
+    storage_pool_[sid] = NDArray(GetObjectPtr<Object>(container));
+  }
+  if (device_bytes.empty()) return;
+  for (const auto& kv : device_bytes) {
+    Device dev{static_cast<DLDeviceType>(kv.first.first), kv.first.second};
+    pool->Reserve(dev, kv.second);
+  }
+  // Recreate the views, which releases the private storages.
+  for (size_t eid = 0; eid < data_entry_.size(); ++eid) {
+    int sid = attrs_.storage_id[eid];
+    if (storage_offset[sid] < 0) continue;
+    data_entry_[eid] =
+        storage_pool_[sid].CreateView(data_entry_[eid].Shape(), data_entry_[eid]->dtype);
+    shared_entries_.emplace_back(eid, storage_device[sid], storage_offset[sid]);
+  }
+  shared_pool_ = std::move(pool);
+  BindSharedStorage();
+}
+
+void GraphExecutor::BindSharedStorage() {
+  for (const auto& entry : shared_entries_) {
+    char* base = static_cast<char*>(shared_pool_->Data(std::get<1>(entry)));
+    DLTensor* tensor = const_cast<DLTensor*>(data_entry_[std::get<0>(entry)].operator->());
+    tensor->data = base + std::get<2>(entry);
+  }
+  // The operators hold copies of the DLTensors of the data entries.
+  this->SetupOpExecs();
+  shared_pool_generation_ = shared_pool_->generation();
+}
+
 void GraphExecutor::LinkedNDArrayDeleter(Object* container) {
   // container is the NDArray::Container which needs to get deleted.
   // The data member points to global const memory, so it does not need deleting.
@@ -463,6 +570,11 @@ void GraphExecutor::SetupStorage() {
 
 void GraphExecutor::SetupOpExecs() {
   op_execs_.resize(this->GetNumOfNodes());
+  // The executors may be set up again, e.g. after sharing the parameters or the storage, which
+  // invalidates the DLTensors of the previous operators.
+  input_dltensors_.clear();
+  output_dltensors_.clear();
+  both_output_opinput_dltensors_.clear();
   input_dltensors_.resize(num_node_entries());
   output_dltensors_.resize(num_node_entries());
   both_output_opinput_dltensors_.resize(num_node_entries());
@@ -667,6 +779,12 @@ PackedFunc GraphExecutor::GetFunction(const std::string& name,
       dmlc::MemoryStringStream strm(const_cast<std::string*>(&param_blob));
       this->ShareParams(dynamic_cast<const GraphExecutor&>(*module.operator->()), &strm);
     });
+  } else if (name == "share_storage") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      Module module = args[0];
+      ICHECK_EQ(module.operator->()->type_key(), std::string("GraphExecutor"));
+      this->ShareStorage(dynamic_cast<GraphExecutor*>(module.operator->()));
+    });
   } else if (name == "get_input_index") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       CHECK(String::CanConvertFrom(args[0])) << "Input key is not a string";
@@ -31,6 +31,7 @@
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/packed_func.h>
 
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -58,6 +59,35 @@ struct TVMOpParam {
   uint32_t flatten_data;
 };
 
+/*!
+ * \brief The storage of the intermediate tensors shared by graph executors that never run
+ *  concurrently, e.g. the variants of a model served by one thread. Each device has one buffer,
+ *  sized to the largest requirement of the executors sharing it.
+ */
+class SharedStoragePool {
+ public:
+  /*!
+   * \brief Make sure the buffer of a device holds at least the given number of bytes.
+   * \param dev The device.
+   * \param nbytes The number of bytes.
+   */
+  void Reserve(Device dev, size_t nbytes);
+  /*!
+   * \brief Get the base address of the buffer of a device.
+   * \param dev The device.
+   * \return The base address.
+   */
+  void* Data(Device dev) const;
+  /*! \brief The generation, bumped whenever a buffer is reallocated. */
+  uint64_t generation() const { return generation_; }
+
+ private:
+  /*! \brief The buffer of each (device type, device id). */
+  std::map<std::pair<int, int>, NDArray> buffers_;
+  /*! \brief The generation of the buffers. */
+  uint64_t generation_{0};
+};
+
 /*!
  * \brief Tiny graph executor.
  *
@@ -109,7 +139,7 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    * \param name The name of the input.
    * \return The index of input.
    */
-  int GetInputIndex(const std::string& name);
+  int GetInputIndex(const std::string& name) const;
 
   /*!
    * \brief Get the input info of Graph by parsing the input nodes.
@@ -193,6 +223,15 @@ class TVM_DLL GraphExecutor : public ModuleNode {
    */
   void ShareParams(const GraphExecutor& other, dmlc::Stream* strm);
 
+  /*!
+   * \brief Share the storage of the intermediate tensors with another GraphExecutor instance.
+   *  The inputs, the outputs and the parameters keep their own storage. The executors sharing
+   *  the storage must not run concurrently, and the intermediate tensors of an executor are
+   *  clobbered by the runs of the others.
+   * \param other A GraphExecutor instance, which may already share its storage with others.
+   */
+  void ShareStorage(GraphExecutor* other);
+
   /*!
    * \brief Get total number of nodes.
    * \return Total number of nodes.
@@ -415,6 +454,10 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   void SetupStorage();
   /*! \brief Setup the executors. */
   void SetupOpExecs();
+  /*! \brief Move the intermediate storage of the executor to the shared storage pool. */
+  void MoveStorageToSharedPool(std::shared_ptr<SharedStoragePool> pool);
+  /*! \brief Point the shared data entries at the current buffers of the shared storage pool. */
+  void BindSharedStorage();
   /*!
    * \brief Check the legality of external DLTensor*.
    * \param external The external DLTensor*.
@@ -469,6 +512,12 @@ class TVM_DLL GraphExecutor : public ModuleNode {
   std::vector<size_t> data_alignment_;
   /*! \brief Operator on each node. */
   std::vector<std::function<void()>> op_execs_;
+  /*! \brief The storage pool shared with other executors, if any. */
+  std::shared_ptr<SharedStoragePool> shared_pool_;
+  /*! \brief The generation of the shared storage pool the data entries are bound to. */
+  uint64_t shared_pool_generation_{0};
+  /*! \brief The data entries in the shared storage pool with their devices and byte offsets. */
+  std::vector<std::tuple<uint32_t, Device, size_t>> shared_entries_;
   /*! \brief Linked parameter lookup function. */
   PackedFunc lookup_linked_param_;
   /*! \brief Module's _lookup_linked_param function, used by DefaultLookupLinkedParam. */
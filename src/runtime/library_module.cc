@@ -27,7 +27,9 @@
 #include <tvm/runtime/module.h>
 #include <tvm/runtime/registry.h>
 
+#include <cstring>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -38,7 +40,9 @@ namespace runtime {
 class LibraryModuleNode final : public ModuleNode {
  public:
   explicit LibraryModuleNode(ObjectPtr<Library> lib, PackedFuncWrapper wrapper)
-      : lib_(lib), packed_func_wrapper_(wrapper) {}
+      : lib_(lib), packed_func_wrapper_(wrapper) {
+    LoadFuncRegistry();
+  }
 
   const char* type_key() const final { return "library"; }
 
@@ -49,17 +53,58 @@ class LibraryModuleNode final : public ModuleNode {
           reinterpret_cast<const char*>(lib_->GetSymbol(runtime::symbol::tvm_module_main));
       ICHECK(entry_name != nullptr)
           << "Symbol " << runtime::symbol::tvm_module_main << " is not presented";
-      faddr = reinterpret_cast<TVMBackendPackedCFunc>(lib_->GetSymbol(entry_name));
+      faddr = LookupFunction(entry_name);
     } else {
-      faddr = reinterpret_cast<TVMBackendPackedCFunc>(lib_->GetSymbol(name.c_str()));
+      faddr = LookupFunction(name.c_str());
     }
     if (faddr == nullptr) return PackedFunc();
     return packed_func_wrapper_(faddr, sptr_to_self);
   }
 
  private:
+  /*!
+   * \brief The layout of the TVMFuncRegistry of the C runtime exported by the library, see
+   *  include/tvm/runtime/crt/func_registry.h.
+   */
+  struct FuncRegistry {
+    /*! \brief The number of functions on 16 bits, followed by their NUL-terminated names. */
+    const char* names;
+    /*! \brief The functions, in the order of the names. */
+    const TVMBackendPackedCFunc* funcs;
+  };
+
+  /*! \brief Index the functions of the table of the library, when it exports one. */
+  void LoadFuncRegistry() {
+    const auto* registry =
+        reinterpret_cast<const FuncRegistry*>(lib_->GetSymbol(runtime::symbol::tvm_func_registry));
+    if (registry == nullptr) return;
+    uint16_t num_funcs;
+    std::memcpy(&num_funcs, registry->names, sizeof(num_funcs));
+    const char* name = registry->names + sizeof(num_funcs);
+    func_table_.reserve(num_funcs);
+    for (uint16_t i = 0; i < num_funcs; ++i) {
+      size_t length = std::strlen(name);
+      func_table_.emplace(std::string(name, length), registry->funcs[i]);
+      name += length + 1;
+    }
+  }
+
+  /*!
+   * \brief Look up a function in the table, or by symbol for a library without table and for the
+   *  functions of the other modules linked into it.
+   */
+  TVMBackendPackedCFunc LookupFunction(const char* name) {
+    if (!func_table_.empty()) {
+      auto it = func_table_.find(name);
+      if (it != func_table_.end()) return it->second;
+    }
+    return reinterpret_cast<TVMBackendPackedCFunc>(lib_->GetSymbol(name));
+  }
+
   ObjectPtr<Library> lib_;
   PackedFuncWrapper packed_func_wrapper_;
+  /*! \brief The functions of the table of the library, by name. */
+  std::unordered_map<std::string, TVMBackendPackedCFunc> func_table_;
 };
 
 /*!
@@ -26,6 +26,7 @@
 #include <tvm/runtime/logging.h>
 #include <tvm/runtime/ndarray.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/memory_manager.h>
 
 #include "runtime_base.h"
 
@@ -205,6 +206,14 @@ NDArray NDArray::Empty(ShapeTuple shape, DLDataType dtype, Device dev, Optional<
   return ret;
 }
 
+NDArray NDArray::Empty(ShapeTuple shape, DLDataType dtype, Device dev,
+                       relax_vm::Allocator* allocator) {
+  if (allocator == nullptr) {
+    return Empty(shape, dtype, dev);
+  }
+  return allocator->Empty(std::vector<int64_t>(shape.begin(), shape.end()), dtype, dev);
+}
+
 NDArray NDArray::FromExternalDLTensor(const DLTensor& dl_tensor) {
   ICHECK(::tvm::runtime::IsContiguous(dl_tensor)) << "External DLTensor must be contiguous.";
   ICHECK(IsAligned(dl_tensor)) << "Data in DLTensor is not aligned as required by NDArray";
@@ -334,7 +343,11 @@ int TVMArrayAlloc(const tvm_index_t* shape, int ndim, int dtype_code, int dtype_
   API_END();
 }
 
-TVM_REGISTER_GLOBAL("runtime.TVMArrayAllocWithScope").set_body_typed(NDArray::Empty);
+TVM_REGISTER_GLOBAL("runtime.TVMArrayAllocWithScope")
+    .set_body_typed(
+        [](ShapeTuple shape, DLDataType dtype, tvm::Device dev, Optional<String> mem_scope) {
+          return NDArray::Empty(shape, dtype, dev, mem_scope);
+        });
 
 TVM_REGISTER_GLOBAL("runtime.TVMArrayCreateView").set_body_typed([](NDArray arr, ShapeTuple shape) {
   NDArray view = arr.CreateView(shape, arr->dtype);
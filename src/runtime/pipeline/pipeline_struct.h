@@ -187,16 +187,47 @@ class QueueData {
     SetAsDataOwner(false);
   }
   QueueData() { SetAsDataOwner(true); }
-  /*!\brief Doing a deep copy for the 'QueueData' structure.*/
+  /*!
+   * \brief A NDArray which is forwarded by reference instead of by a deep copy. It is used
+   *  when the producer never writes into the NDArray again after forwarding it.
+   */
+  struct SharedNDArray {
+    NDArray array;
+  };
+  /*!
+   * \brief Doing a deep copy for the 'QueueData' structure, the data forwarded by reference
+   *  is shared instead.
+   */
   QueueData& operator=(const QueueData& data) {
-    CreateCopyFrom(data.GetDLData());
+    if (data.IsShared()) {
+      shared_ = data.shared_;
+    } else {
+      shared_ = NDArray();
+      CreateCopyFrom(data.GetDLData());
+    }
+    return *this;
+  }
+  /*!\brief Moving the data forwarded by reference out of 'data', otherwise doing a deep copy.*/
+  QueueData& operator=(QueueData&& data) {
+    if (data.IsShared()) {
+      shared_ = std::move(data.shared_);
+      data.shared_ = NDArray();
+    } else {
+      *this = static_cast<const QueueData&>(data);
+    }
+    return *this;
+  }
+  QueueData& operator=(const SharedNDArray& from) {
+    shared_ = from.array;
     return *this;
   }
   QueueData& operator=(const NDArray& from) {
+    shared_ = NDArray();
     CreateCopyFrom(const_cast<DLTensor*>(from.operator->()));
     return *this;
   }
   QueueData& operator=(const DLTensor* from) {
+    shared_ = NDArray();
     CreateCopyFrom(from);
     return *this;
   }
@@ -225,7 +256,13 @@ class QueueData {
     return data_;
   }
   /*!\brief Return a pointer to the 'DLTensor' data.*/
-  DLTensor* GetDLData() const { return data_; }
+  DLTensor* GetDLData() const {
+    return IsShared() ? const_cast<DLTensor*>(shared_.operator->()) : data_;
+  }
+  /*!\brief Whether the data is forwarded by reference.*/
+  bool IsShared() const { return shared_.defined(); }
+  /*!\brief Return the data forwarded by reference.*/
+  NDArray GetSharedNDArray() const { return shared_; }
   ~QueueData() {
     if (IsDataOwner() && data_) {
       TVMArrayFree(data_);
@@ -236,6 +273,8 @@ class QueueData {
  private:
   /*!\brief Pointer to the forwarding data.*/
   DLTensor* data_ = nullptr;
+  /*!\brief The forwarding data when it is forwarded by reference.*/
+  NDArray shared_;
   /*!\brief Whether this container is the owner of the 'data_'.*/
   bool is_data_owner_ = false;
   /*!\brief Set the current container as the owner of the 'data_'.*/
@@ -738,9 +777,10 @@ class BasicRuntime {
    * \param child_input_index The child runtime index.
    * \param data The data is used for forwarding.
    */
+  template <typename DataType>
   bool ForwardData(const ForwardQueueMap* forward_queue_map,
                    std::shared_ptr<BasicRuntime> child_runtime, int child_input_index,
-                   const DLTensor* data) {
+                   const DataType& data) {
     auto child_runtime_index = child_runtime->GetModuleIndex();
     auto queue_id = GenerateQueueID(child_runtime_index, child_input_index, INPUT);
     if (forward_queue_map->find(queue_id) == forward_queue_map->end()) {
@@ -751,7 +791,7 @@ class BasicRuntime {
     auto forward_queue = forward_queue_map->at(queue_id);
     // If the queue is full, keep try until the push get success or the pipeline run into
     // a STOP state.
-    while (!forward_queue->Push<const DLTensor*>(data)) {
+    while (!forward_queue->Push<DataType>(data)) {
       if (PipelineIsStop()) {
         LOG(INFO) << "The forwarding process is stopped after the pipeline status is changed"
                   << " into stop.";
@@ -825,6 +865,8 @@ class BackendRuntime : public BasicRuntime {
   tvm::runtime::PackedFunc get_num_inputs_;
   tvm::runtime::PackedFunc get_input_index_;
   tvm::runtime::PackedFunc run_;
+  /*!\brief The packed functions to set an input by reference, null if not supported.*/
+  tvm::runtime::PackedFunc set_input_by_reference_;
   /*!\brief The worker thread is used to execute the runtimes in pipeline.*/
   void StartWorkThread() {
     SetPipelineState(RUNNING);
@@ -900,7 +942,11 @@ class BackendRuntime : public BasicRuntime {
     if (!queue->Poll<QueueData>(&data)) {
       return false;
     }
-    SetInput(input_index, data.GetDLData());
+    if (set_input_by_reference_ != nullptr && data.IsShared()) {
+      set_input_by_reference_(input_index, data.GetSharedNDArray());
+    } else {
+      SetInput(input_index, data.GetDLData());
+    }
     return true;
   }
   /*!
@@ -921,8 +967,17 @@ class BackendRuntime : public BasicRuntime {
       for (auto module_pair : child.second) {
         auto child_runtime = module_pair.first;
         auto child_input_index = module_pair.second;
-        auto output_data = const_cast<DLTensor*>(output.operator->());
-        if (!ForwardData(&forward_queue_map, child_runtime, child_input_index, output_data)) {
+        bool forwarded = false;
+        if (set_input_by_reference_ != nullptr) {
+          // The outputs of a stage accepting the data by reference are new in every run.
+          forwarded = ForwardData(&forward_queue_map, child_runtime, child_input_index,
+                                  QueueData::SharedNDArray{output});
+        } else {
+          const DLTensor* output_data = output.operator->();
+          forwarded =
+              ForwardData(&forward_queue_map, child_runtime, child_input_index, output_data);
+        }
+        if (!forwarded) {
           return false;
         }
       }
@@ -993,6 +1048,9 @@ class BackendRuntime : public BasicRuntime {
     get_input_ = module_.GetFunction("get_input");
     get_output_ = module_.GetFunction("get_output");
     run_ = module_.GetFunction("run");
+    // Only the stages whose inputs and outputs are held by reference, e.g. a Relax VM stage,
+    // provide this function.
+    set_input_by_reference_ = module_.GetFunction("set_input_by_reference");
   }
   ~BackendRuntime() {
     for (auto data : input_tensor_local_copy_) {
@@ -1064,6 +1122,10 @@ class BackendRuntime : public BasicRuntime {
   }
   /*!\brief Creating a NDArray containing same shape and data type with a module output. */
   NDArray CreateFromOutput(int idx) {
+    // The outputs forwarded by reference are shared with the global output directly.
+    if (set_input_by_reference_ != nullptr) {
+      return NDArray();
+    }
     NDArray data = get_output_(idx);
     return CreateNDArrayFromDLTensor(const_cast<DLTensor*>(data.operator->()));
   }
@@ -1073,6 +1135,10 @@ class BackendRuntime : public BasicRuntime {
   int NumInputs() const { return get_num_inputs_(); }
   /*!\brief Setting the data to this runtime via input index.*/
   void SetInput(const int index, DLTensor* data_in) {
+    if (set_input_by_reference_ != nullptr) {
+      set_input_(index, data_in);
+      return;
+    }
     NDArray input = get_input_(index);
     DLTensor* dltensor_input = const_cast<DLTensor*>(input.operator->());
     CopyFromTo(data_in, dltensor_input);
@@ -1156,10 +1222,17 @@ class GlobalRuntime : public BasicRuntime {
     for (auto queue_pair : input_queue_) {
       auto output_index = queue_pair.first;
       auto queue = queue_pair.second;
-      QueueData data(const_cast<DLTensor*>(((*outputs)[output_index]).operator->()));
-      if (!queue->Poll<QueueData>(&data)) {
+      NDArray output = (*outputs)[output_index];
+      // The outputs forwarded by reference have no preallocated NDArray before the first run.
+      auto data = output.defined()
+                      ? std::make_unique<QueueData>(const_cast<DLTensor*>(output.operator->()))
+                      : std::make_unique<QueueData>();
+      if (!queue->Poll<QueueData>(data.get())) {
         LOG(FATAL) << "There is no data in the data queue, it should not happen!";
       }
+      if (data->IsShared()) {
+        outputs->Set(output_index, data->GetSharedNDArray());
+      }
     }
     return true;
   }
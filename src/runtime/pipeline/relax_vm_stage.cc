@@ -0,0 +1,168 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file relax_vm_stage.cc
+ * \brief A pipeline stage which runs a function of the Relax virtual machine.
+ */
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+/*!
+ * \brief Exposing one function of an initialized Relax virtual machine through the module
+ *  interface of the graph executor, so that the function can be used as a pipeline stage.
+ *
+ *  The inputs and the outputs of the stage are held by reference. Since the virtual machine
+ *  allocates new outputs in every run, the outputs can be forwarded to the next stage without
+ *  a copy, and the stage receives such forwarded data through 'set_input_by_reference'.
+ */
+class RelaxVMStage : public ModuleNode {
+ public:
+  RelaxVMStage(Module vm, std::string func_name) : vm_(vm), func_name_(func_name) {
+    func_ = vm_.GetFunction(func_name_);
+    ICHECK(func_ != nullptr) << "Can not find the function " << func_name_ << " in the VM.";
+    PackedFunc get_param_name = vm_.GetFunction("get_function_param_name");
+    int num_inputs = vm_.GetFunction("get_function_arity")(func_name_);
+    for (int i = 0; i < num_inputs; i++) {
+      std::string param_name = get_param_name(func_name_, i);
+      input_names_.push_back(param_name);
+    }
+    inputs_.resize(num_inputs);
+  }
+
+  const char* type_key() const final { return "RelaxVMStage"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "get_input_index") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = this->GetInputIndex(args[0].operator String());
+      });
+    } else if (name == "get_num_inputs") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = static_cast<int>(this->inputs_.size());
+      });
+    } else if (name == "get_num_outputs") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = static_cast<int>(this->outputs_.size());
+      });
+    } else if (name == "set_input") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        int index = this->InputIndexFromArg(args[0]);
+        // The caller may reuse the given tensor, so keeping a copy of it.
+        const DLTensor* data = args[1];
+        std::vector<int64_t> shape(data->shape, data->shape + data->ndim);
+        NDArray input = NDArray::Empty(shape, data->dtype, data->device);
+        input.CopyFrom(data);
+        this->inputs_[index] = input;
+      });
+    } else if (name == "set_input_by_reference") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        int index = this->InputIndexFromArg(args[0]);
+        this->inputs_[index] = args[1].operator NDArray();
+      });
+    } else if (name == "get_input") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = this->inputs_[this->InputIndexFromArg(args[0])];
+      });
+    } else if (name == "get_output") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        int index = args[0];
+        ICHECK(index >= 0 && static_cast<size_t>(index) < this->outputs_.size())
+            << "The output index " << index << " is out of the range, the stage has "
+            << this->outputs_.size() << " outputs after the last run.";
+        *rv = this->outputs_[index];
+      });
+    } else if (name == "run") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->Run(); });
+    }
+    return PackedFunc();
+  }
+
+ private:
+  /*!\brief Running the function with the current inputs and keeping the outputs.*/
+  void Run() {
+    std::vector<TVMValue> values(inputs_.size());
+    std::vector<int> tcodes(inputs_.size());
+    TVMArgsSetter setter(values.data(), tcodes.data());
+    for (size_t i = 0; i < inputs_.size(); i++) {
+      ICHECK(inputs_[i].defined()) << "The input " << input_names_[i] << " of the function "
+                                   << func_name_ << " is not set.";
+      setter(i, inputs_[i]);
+    }
+    TVMRetValue ret;
+    func_.CallPacked(TVMArgs(values.data(), tcodes.data(), values.size()), &ret);
+    outputs_.clear();
+    if (ret.type_code() == kTVMNDArrayHandle) {
+      outputs_.push_back(ret.operator NDArray());
+    } else {
+      ADT adt = ret.operator ADT();
+      for (size_t i = 0; i < adt.size(); i++) {
+        outputs_.push_back(Downcast<NDArray>(adt[i]));
+      }
+    }
+  }
+  /*!\brief Returning the index of the input with the given name, or -1 when not found.*/
+  int GetInputIndex(const std::string& name) const {
+    for (size_t i = 0; i < input_names_.size(); i++) {
+      if (input_names_[i] == name) {
+        return i;
+      }
+    }
+    return -1;
+  }
+  /*!\brief Getting the input index from an argument which is either an index or a name.*/
+  int InputIndexFromArg(const TVMArgValue& arg) const {
+    if (arg.type_code() == kTVMStr) {
+      std::string name = arg;
+      int index = GetInputIndex(name);
+      ICHECK_GE(index, 0) << "Can not find the input " << name << " of the function " << func_name_;
+      return index;
+    }
+    int index = arg;
+    ICHECK(index >= 0 && static_cast<size_t>(index) < inputs_.size())
+        << "The input index " << index << " is out of the range of the function " << func_name_;
+    return index;
+  }
+  /*!\brief The Relax virtual machine.*/
+  Module vm_;
+  /*!\brief The name of the function which is run by this stage.*/
+  std::string func_name_;
+  /*!\brief The function which is run by this stage.*/
+  PackedFunc func_;
+  /*!\brief The parameter names of the function.*/
+  std::vector<std::string> input_names_;
+  /*!\brief The inputs of the next run.*/
+  std::vector<NDArray> inputs_;
+  /*!\brief The outputs of the last run.*/
+  std::vector<NDArray> outputs_;
+};
+
+TVM_REGISTER_GLOBAL("tvm.pipeline_executor.relax_vm_stage")
+    .set_body_typed([](Module vm, String func_name) {
+      return Module(make_object<RelaxVMStage>(vm, func_name));
+    });
+}  // namespace runtime
+}  // namespace tvm
@@ -20,6 +20,7 @@
 #define TVM_RUNTIME_PIPELINE_SPSC_QUEUE_H_
 #include <cstddef>
 #include <thread>
+#include <utility>
 /*!\brief A single producer and single consumer lock free queue.
  */
 template <typename SlotType, typename IDType = int, int QueueLength = 1024>
@@ -62,7 +63,7 @@ class SPSCLockFreeQueue {
   template <typename data_type>
   bool Poll(data_type* data) {
     if (Empty()) return false;
-    *data = queue_[head_];
+    *data = std::move(queue_[head_]);
     write_barrier();
     head_ = (head_ + 1) % len_;
     return true;
@@ -0,0 +1,194 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tensor_channel.cc
+ * \brief A socket channel which moves the tensors between the stages of a pipeline running on
+ *  different hosts, without going through the RPC session of the driver.
+ */
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <string>
+#include <vector>
+
+#include "../../support/socket.h"
+
+namespace tvm {
+namespace runtime {
+/*!
+ * \brief One direction of a link between two pipeline stages. The sender connects to the
+ *  receiver, which listens on a port reported to the driver.
+ *
+ *  A message is a group of tensors, each is a header of the dtype and the shape followed by the
+ *  raw bytes. The bytes of the contiguous CPU tensors are sent from and received into the
+ *  tensors themselves, the tensors on the other devices are staged on the host.
+ */
+class TensorChannel : public ModuleNode {
+ public:
+  /*!\brief Creating the receiving side, listening on the first free port from the given one.*/
+  TensorChannel(std::string host, int port, int port_end) {
+    listener_.Create();
+    port_ = listener_.TryBindHost(host, port, port_end);
+    ICHECK_NE(port_, -1) << "Can not bind a port in [" << port << ", " << port_end << ") on "
+                         << host;
+    listener_.Listen(1);
+  }
+  /*!\brief Creating the sending side, connecting to the receiving side.*/
+  explicit TensorChannel(std::string host, int port) {
+    support::SockAddr addr(host.c_str(), port);
+    sock_.Create(addr.ss_family());
+    ICHECK(sock_.Connect(addr)) << "Connect to the tensor channel at " << addr.AsString()
+                                << " failed";
+    port_ = port;
+  }
+
+  ~TensorChannel() {
+    if (!sock_.IsClosed()) sock_.Close();
+    if (!listener_.IsClosed()) listener_.Close();
+  }
+
+  const char* type_key() const final { return "TensorChannel"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "port") {
+      return PackedFunc(
+          [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->port_; });
+    } else if (name == "accept") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        ICHECK(!this->listener_.IsClosed()) << "Only the receiving side accepts the sender.";
+        this->sock_ = this->listener_.Accept();
+        this->listener_.Close();
+      });
+    } else if (name == "close") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        if (!this->sock_.IsClosed()) this->sock_.Close();
+      });
+    } else if (name == "send") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::vector<NDArray> tensors;
+        for (int i = 0; i < args.num_args; ++i) {
+          tensors.push_back(args[i].operator NDArray());
+        }
+        this->Send(tensors);
+      });
+    } else if (name == "recv") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::vector<ObjectRef> tensors;
+        for (NDArray tensor : this->Recv(args[0])) {
+          tensors.push_back(tensor);
+        }
+        *rv = ADT::Tuple(tensors);
+      });
+    } else if (name == "send_outputs") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        Module stage = args[0];
+        int num_outputs = stage.GetFunction("get_num_outputs")();
+        PackedFunc get_output = stage.GetFunction("get_output");
+        std::vector<NDArray> tensors;
+        for (int i = 0; i < num_outputs; ++i) {
+          tensors.push_back(get_output(i));
+        }
+        this->Send(tensors);
+      });
+    } else if (name == "recv_inputs") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        Module stage = args[0];
+        std::vector<NDArray> tensors = this->Recv(args[1]);
+        int num_inputs = stage.GetFunction("get_num_inputs")();
+        ICHECK_EQ(tensors.size(), static_cast<size_t>(num_inputs))
+            << "The previous stage sends " << tensors.size() << " tensors to a stage of "
+            << num_inputs << " inputs.";
+        PackedFunc set_input = stage.GetFunction("set_input_by_reference");
+        for (int i = 0; i < num_inputs; ++i) {
+          set_input(i, tensors[i]);
+        }
+      });
+    }
+    return PackedFunc();
+  }
+
+ private:
+  void SendAll(const void* data, size_t size) {
+    ICHECK_EQ(sock_.SendAll(data, size), size) << "The tensor channel is closed by the peer.";
+  }
+
+  void RecvAll(void* data, size_t size) {
+    ICHECK_EQ(sock_.RecvAll(data, size), size) << "The tensor channel is closed by the peer.";
+  }
+
+  void Send(const std::vector<NDArray>& tensors) {
+    ICHECK(!sock_.IsClosed()) << "The tensor channel is not connected.";
+    uint64_t num_tensors = tensors.size();
+    SendAll(&num_tensors, sizeof(num_tensors));
+    for (const NDArray& tensor : tensors) {
+      const DLTensor* dl = tensor.operator->();
+      int32_t ndim = dl->ndim;
+      SendAll(&ndim, sizeof(ndim));
+      SendAll(&dl->dtype, sizeof(dl->dtype));
+      SendAll(dl->shape, sizeof(int64_t) * ndim);
+      if (dl->device.device_type == kDLCPU && tensor.IsContiguous()) {
+        SendAll(static_cast<char*>(dl->data) + dl->byte_offset, GetDataSize(*dl));
+      } else {
+        NDArray staged = tensor.CopyTo(Device{kDLCPU, 0});
+        SendAll(staged->data, GetDataSize(*staged.operator->()));
+      }
+    }
+  }
+
+  std::vector<NDArray> Recv(Device device) {
+    ICHECK(!sock_.IsClosed()) << "The tensor channel is not connected.";
+    uint64_t num_tensors;
+    RecvAll(&num_tensors, sizeof(num_tensors));
+    std::vector<NDArray> tensors;
+    for (uint64_t i = 0; i < num_tensors; ++i) {
+      int32_t ndim;
+      DLDataType dtype;
+      RecvAll(&ndim, sizeof(ndim));
+      RecvAll(&dtype, sizeof(dtype));
+      std::vector<int64_t> shape(ndim);
+      RecvAll(shape.data(), sizeof(int64_t) * ndim);
+      NDArray host = NDArray::Empty(shape, dtype, Device{kDLCPU, 0});
+      RecvAll(host->data, GetDataSize(*host.operator->()));
+      tensors.push_back(device.device_type == kDLCPU ? host : host.CopyTo(device));
+    }
+    return tensors;
+  }
+
+  /*!\brief The listening socket of the receiving side before the sender connects.*/
+  support::TCPSocket listener_;
+  /*!\brief The connected socket.*/
+  support::TCPSocket sock_;
+  /*!\brief The port of the receiving side.*/
+  int port_;
+};
+
+TVM_REGISTER_GLOBAL("tvm.pipeline_executor.tensor_channel_listen")
+    .set_body_typed([](String host, int port, int port_end) {
+      return Module(make_object<TensorChannel>(host, port, port_end));
+    });
+
+TVM_REGISTER_GLOBAL("tvm.pipeline_executor.tensor_channel_connect")
+    .set_body_typed([](String host, int port) {
+      return Module(make_object<TensorChannel>(host, port));
+    });
+}  // namespace runtime
+}  // namespace tvm
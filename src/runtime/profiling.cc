@@ -370,6 +370,48 @@ String ReportNode::AsJSON() const {
   return s.str();
 }
 
+String ReportNode::AsChromeTrace() const {
+  std::ostringstream s;
+  s << "{\"traceEvents\":[";
+  // The track of each device, and the end of the last call laid out on it.
+  std::vector<std::string> devices;
+  std::vector<double> track_end;
+  for (size_t i = 0; i < calls.size(); i++) {
+    const Map<String, ObjectRef>& call = calls[i];
+    std::string device = call.count("Device") ? Downcast<String>(call["Device"]) : "";
+    size_t tid = std::find(devices.begin(), devices.end(), device) - devices.begin();
+    if (tid == devices.size()) {
+      devices.push_back(device);
+      track_end.push_back(0);
+      s << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid
+        << ",\"args\":{\"name\":\"" << device << "\"}},";
+    }
+    double dur = 0;
+    if (call.count("Duration (us)")) {
+      dur = call["Duration (us)"].as<DurationNode>()->microseconds;
+    }
+    s << "{\"name\":\"" << (call.count("Name") ? Downcast<String>(call["Name"]) : "") << "\"";
+    s << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << tid;
+    s << ",\"ts\":" << std::setprecision(std::numeric_limits<double>::max_digits10) << std::fixed
+      << track_end[tid] << ",\"dur\":" << dur << ",\"args\":{";
+    size_t j = 0;
+    for (const auto& kv : call) {
+      if (kv.first == "Name" || kv.first == "Duration (us)") {
+        continue;
+      }
+      s << (j++ > 0 ? "," : "") << "\"" << kv.first << "\":";
+      metric_as_json(s, kv.second);
+    }
+    s << "}}";
+    if (i < calls.size() - 1) {
+      s << ",";
+    }
+    track_end[tid] += dur;
+  }
+  s << "]}";
+  return s.str();
+}
+
 // Aggregate a set of values for a metric. Computes sum for Duration, Count,
 // and Percent; average for Ratio; and assumes all Strings are the same. All
 // ObjectRefs in metrics must have the same type.
@@ -778,6 +820,9 @@ TVM_REGISTER_OBJECT_TYPE(MetricCollectorNode);
 
 TVM_REGISTER_GLOBAL("runtime.profiling.AsTable").set_body_method<Report>(&ReportNode::AsTable);
 TVM_REGISTER_GLOBAL("runtime.profiling.AsCSV").set_body_typed([](Report n) { return n->AsCSV(); });
+TVM_REGISTER_GLOBAL("runtime.profiling.AsChromeTrace").set_body_typed([](Report n) {
+  return n->AsChromeTrace();
+});
 TVM_REGISTER_GLOBAL("runtime.profiling.AsJSON").set_body_typed([](Report n) {
   return n->AsJSON();
 });
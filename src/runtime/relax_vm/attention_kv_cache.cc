@@ -0,0 +1,247 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/relax_vm/attention_kv_cache.cc
+ * \brief Persistent key/value cache tensors updated in place by VM builtins.
+ */
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*! \brief Print a shape in the form of (2, 3). */
+static std::string ShapeToString(const ShapeTuple& shape) {
+  std::ostringstream os;
+  os << "(";
+  for (size_t i = 0; i < shape.size(); ++i) {
+    os << (i == 0 ? "" : ", ") << shape[i];
+  }
+  os << ")";
+  return os.str();
+}
+
+/*!
+ * \brief A cache whose leading dimension grows as rows are appended, e.g. the keys or values
+ * of the tokens decoded so far.
+ *
+ * The rows live in a buffer reserved for the capacity, so appending a row copies the row only,
+ * and the filled rows are read through a view of the buffer. The capacity doubles when it is
+ * exceeded, which keeps the cost of the copies amortized constant per row.
+ */
+class AttentionKVCacheObj : public Object {
+ public:
+  /*! \brief The buffer, its leading dimension is the capacity. */
+  NDArray data;
+  /*! \brief The number of filled rows. */
+  int64_t fill_count{0};
+
+  /*! \brief The view of the filled rows, \p shape must start with the fill count. */
+  NDArray View(const ShapeTuple& shape) {
+    CHECK_EQ(static_cast<int>(shape.size()), data->ndim)
+        << "ValueError: The view of a KV cache of " << data->ndim
+        << " dimensions is requested with shape " << ShapeToString(shape);
+    CHECK_EQ(shape[0], fill_count) << "ValueError: The KV cache holds " << fill_count
+                                   << " rows but the view requests " << shape[0];
+    for (int i = 1; i < data->ndim; ++i) {
+      CHECK_EQ(shape[i], data->shape[i]) << "ValueError: The view shape " << ShapeToString(shape)
+                                         << " mismatches the KV cache row shape";
+    }
+    return data.CreateView(shape, data->dtype);
+  }
+
+  /*! \brief Copy the rows of \p value after the filled rows. */
+  void Append(const NDArray& value) {
+    CheckRows(value);
+    Reserve(fill_count + value->shape[0]);
+    DLTensor dst = TailOf(value->shape[0]);
+    NDArray::CopyFromTo(value.operator->(), &dst);
+    fill_count += value->shape[0];
+  }
+
+  /*!
+   * \brief Get a tensor of \p shape for the rows following the filled rows, so that a kernel
+   * writes them in place. The rows are filled by Commit.
+   */
+  NDArray Slot(const ShapeTuple& shape) {
+    CHECK_EQ(static_cast<int>(shape.size()), data->ndim)
+        << "ValueError: The slot of a KV cache of " << data->ndim
+        << " dimensions is requested with shape " << ShapeToString(shape);
+    Reserve(fill_count + shape[0]);
+    DLTensor tail = TailOf(shape[0]);
+    Device dev = data->device;
+    bool addressable = dev.device_type == kDLCPU || dev.device_type == kDLCUDA ||
+                       dev.device_type == kDLCUDAHost || dev.device_type == kDLROCM;
+    void* ptr = static_cast<char*>(tail.data) + tail.byte_offset;
+    if (!addressable || reinterpret_cast<uintptr_t>(ptr) % kAllocAlignment != 0) {
+      // The tail cannot be aliased, the kernel writes a scratch tensor copied by Commit.
+      return NDArray::Empty(shape, data->dtype, dev);
+    }
+    // The slot keeps the buffer alive, so it stays valid even if the cache grows meanwhile.
+    struct SlotContext {
+      NDArray buffer;
+      std::vector<int64_t> shape;
+    };
+    SlotContext* ctx = new SlotContext{data, std::vector<int64_t>(shape.begin(), shape.end())};
+    DLManagedTensor* managed = new DLManagedTensor();
+    managed->dl_tensor = tail;
+    managed->dl_tensor.data = ptr;
+    managed->dl_tensor.byte_offset = 0;
+    managed->dl_tensor.shape = ctx->shape.data();
+    managed->manager_ctx = ctx;
+    managed->deleter = [](DLManagedTensor* self) {
+      delete static_cast<SlotContext*>(self->manager_ctx);
+      delete self;
+    };
+    return NDArray::FromDLPack(managed);
+  }
+
+  /*! \brief Mark the rows of a slot as filled, copying them unless they were written in place. */
+  void Commit(const NDArray& slot) {
+    CheckRows(slot);
+    Reserve(fill_count + slot->shape[0]);
+    DLTensor tail = TailOf(slot->shape[0]);
+    if (static_cast<char*>(tail.data) + tail.byte_offset !=
+        static_cast<char*>(slot->data) + slot->byte_offset) {
+      NDArray::CopyFromTo(slot.operator->(), &tail);
+    }
+    fill_count += slot->shape[0];
+  }
+
+  static constexpr const uint32_t _type_index = TypeIndex::kDynamic;
+  static constexpr const char* _type_key = "relax.vm.AttentionKVCache";
+  TVM_DECLARE_FINAL_OBJECT_INFO(AttentionKVCacheObj, Object);
+
+ private:
+  /*! \brief Check that \p value holds rows of the cache. */
+  void CheckRows(const NDArray& value) const {
+    CHECK_EQ(value->ndim, data->ndim)
+        << "ValueError: The rows of a KV cache of " << data->ndim
+        << " dimensions cannot have shape " << ShapeToString(value.Shape());
+    for (int i = 1; i < data->ndim; ++i) {
+      CHECK_EQ(value->shape[i], data->shape[i]) << "ValueError: The rows of shape "
+                                                << ShapeToString(value.Shape())
+                                                << " mismatch the KV cache row shape";
+    }
+    CHECK(value.IsContiguous()) << "ValueError: The rows appended to a KV cache must be compact";
+  }
+
+  /*! \brief Grow the capacity to at least \p num_rows rows, keeping the filled rows. */
+  void Reserve(int64_t num_rows) {
+    if (num_rows <= data->shape[0]) return;
+    std::vector<int64_t> shape(data->shape, data->shape + data->ndim);
+    shape[0] = std::max(num_rows, shape[0] * 2);
+    NDArray new_data = NDArray::Empty(ShapeTuple(shape), data->dtype, data->device);
+    if (fill_count > 0) {
+      NDArray filled = data.CreateView(ShapeTuple(RowsShape(fill_count)), data->dtype);
+      NDArray new_filled = new_data.CreateView(ShapeTuple(RowsShape(fill_count)), data->dtype);
+      filled.CopyTo(new_filled);
+    }
+    data = new_data;
+  }
+
+  /*! \brief The tensor of \p num_rows rows following the filled rows. */
+  DLTensor TailOf(int64_t num_rows) {
+    DLTensor tail = *data.operator->();
+    tail_shape_ = RowsShape(num_rows);
+    tail.shape = tail_shape_.data();
+    tail.strides = nullptr;
+    tail.byte_offset = data->byte_offset + fill_count * RowBytes();
+    return tail;
+  }
+
+  std::vector<int64_t> RowsShape(int64_t num_rows) const {
+    std::vector<int64_t> shape(data->shape, data->shape + data->ndim);
+    shape[0] = num_rows;
+    return shape;
+  }
+
+  size_t RowBytes() const {
+    size_t size = (data->dtype.bits * data->dtype.lanes + 7) / 8;
+    for (int i = 1; i < data->ndim; ++i) size *= data->shape[i];
+    return size;
+  }
+
+  /*! \brief The shape of the last tensor returned by TailOf. */
+  std::vector<int64_t> tail_shape_;
+};
+
+/*! \brief Managed reference to AttentionKVCacheObj. */
+class AttentionKVCache : public ObjectRef {
+ public:
+  /*!
+   * \brief Create a cache.
+   * \param init_data The initial rows.
+   * \param reserve_shape The shape of the buffer, its leading dimension is the capacity.
+   * \param init_fill_count The number of rows of init_data to copy into the cache.
+   */
+  static AttentionKVCache Create(NDArray init_data, ShapeTuple reserve_shape,
+                                 int64_t init_fill_count) {
+    auto n = make_object<AttentionKVCacheObj>();
+    n->data = NDArray::Empty(reserve_shape, init_data->dtype, init_data->device);
+    n->fill_count = 0;
+    if (init_fill_count > 0) {
+      CHECK_LE(init_fill_count, init_data->shape[0])
+          << "ValueError: The initial data of the KV cache has " << init_data->shape[0]
+          << " rows, less than the fill count " << init_fill_count;
+      std::vector<int64_t> shape(init_data->shape, init_data->shape + init_data->ndim);
+      shape[0] = init_fill_count;
+      n->Append(init_data.CreateView(ShapeTuple(shape), init_data->dtype));
+    }
+    return AttentionKVCache(n);
+  }
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(AttentionKVCache, ObjectRef, AttentionKVCacheObj);
+};
+
+TVM_REGISTER_OBJECT_TYPE(AttentionKVCacheObj);
+
+TVM_REGISTER_GLOBAL("vm.builtin.attention_kv_cache_create")
+    .set_body_typed(AttentionKVCache::Create);
+
+TVM_REGISTER_GLOBAL("vm.builtin.attention_kv_cache_append")
+    .set_body_typed([](AttentionKVCache cache, NDArray value) {
+      cache->Append(value);
+      return cache;
+    });
+
+TVM_REGISTER_GLOBAL("vm.builtin.attention_kv_cache_view")
+    .set_body_typed([](AttentionKVCache cache, ShapeTuple shape) { return cache->View(shape); });
+
+TVM_REGISTER_GLOBAL("vm.builtin.attention_kv_cache_slot")
+    .set_body_typed([](AttentionKVCache cache, ShapeTuple shape) { return cache->Slot(shape); });
+
+TVM_REGISTER_GLOBAL("vm.builtin.attention_kv_cache_commit")
+    .set_body_typed([](AttentionKVCache cache, NDArray slot) {
+      cache->Commit(slot);
+      return cache;
+    });
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
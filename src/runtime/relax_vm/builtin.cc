@@ -19,6 +19,7 @@
 /*!
  * \file src/runtime/relax_vm/builtin.cc
  */
+#include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/container/adt.h>
 #include <tvm/runtime/data_type.h>
 #include <tvm/runtime/device_api.h>
@@ -31,31 +32,88 @@
 #include <tvm/runtime/relax_vm/memory_manager.h>
 #include <tvm/runtime/relax_vm/vm.h>
 
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../runtime_base.h"
+#include "kernel_jit.h"
+
 namespace tvm {
 namespace runtime {
 namespace relax_vm {
 
 using tvm::runtime::NDArray;
 
-TVM_REGISTER_GLOBAL("vm.builtin.shape_of").set_body_method(&NDArray::Shape);
+// The builtins called on every invocation of a function have a direct-call entry, see
+// VMBuiltin. The body of each is shared by the PackedFunc and the VMBuiltin, whose arguments are
+// TVMArgs and VMBuiltinArgs respectively.
+#define TVM_REGISTER_VM_BUILTIN_BODY(Name, Body)                                             \
+  TVM_REGISTER_GLOBAL(Name).set_body([](TVMArgs args, TVMRetValue* rv) { Body(args, rv); }); \
+  TVM_REGISTER_VM_BUILTIN(Name, [](VMBuiltinArgs args, RegType* rv) { Body(args, rv); })
+
+template <typename Args>
+static void ShapeOf(const Args& args, TVMRetValue* rv) {
+  // The shape is held by the NDArray, no allocation is made.
+  *rv = args[0].operator NDArray().Shape();
+}
+
+TVM_REGISTER_VM_BUILTIN_BODY("vm.builtin.shape_of", ShapeOf);
+
+TVM_REGISTER_GLOBAL("vm.builtin.copy").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // Any value is passed through, e.g. the result of a branch moved into the merge register.
+  ICHECK_EQ(args.size(), 1);
+  *rv = args[0];
+});
 
-TVM_REGISTER_GLOBAL("vm.builtin.copy").set_body_typed([](NDArray src) { return src; });
+TVM_REGISTER_GLOBAL("vm.builtin.read_if_cond").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // The condition of an If is either an integer or a scalar tensor.
+  int64_t result;
+  if (args[0].type_code() == kDLInt) {
+    result = args[0].operator int64_t();
+  } else {
+    NDArray cond = args[0];
+    ICHECK_EQ(cond->ndim, 0) << "The condition of an If must be a scalar";
+    NDArray host = cond->device.device_type == kDLCPU ? cond : cond.CopyTo(Device{kDLCPU, 0});
+    DataType dtype(host->dtype);
+    if (dtype.is_bool() || dtype.bits() == 8) {
+      result = *static_cast<const int8_t*>(host->data);
+    } else if (dtype.bits() == 32) {
+      result = *static_cast<const int32_t*>(host->data);
+    } else {
+      ICHECK_EQ(dtype.bits(), 64) << "Unsupported condition type " << dtype;
+      result = *static_cast<const int64_t*>(host->data);
+    }
+  }
+  *rv = result != 0;
+});
 
 TVM_REGISTER_GLOBAL("vm.builtin.alloc_shape_heap")
     .set_body_typed([](void* vm_ptr, ShapeTuple size) {
       VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
-      return NDArray::Empty(size, DLDataType{kDLInt, 64, 1}, vm->devices[0]);
+      return vm->AllocShapeHeap(size[0]);
     });
 
 TVM_REGISTER_GLOBAL("vm.builtin.alloc_closure").set_body([](TVMArgs args, TVMRetValue* rv) {
-  std::vector<ObjectRef> cap_vars;
-  for (int i = 1; i < args.size(); ++i) {
+  // The closures emitted by the codegen pass the VM first, so that the function is resolved
+  // once at allocation instead of by name at every invocation.
+  int offset = 0;
+  Index func_idx = -1;
+  if (args[0].type_code() == kTVMOpaqueHandle) {
+    offset = 1;
+  }
+  String func_name = args[offset];
+  if (offset == 1) {
+    VirtualMachine* vm = static_cast<VirtualMachine*>(args[0].operator void*());
+    func_idx = vm->LookupVMFunctionIndex(func_name);
+  }
+  Array<ObjectRef> cap_vars;
+  cap_vars.reserve(args.size() - offset - 1);
+  for (int i = offset + 1; i < args.size(); ++i) {
     cap_vars.push_back(args[i]);
   }
-  String func_name = args[0];
-  VMClosure vm_closure(func_name, cap_vars);
-
-  *rv = std::move(vm_closure);
+  *rv = VMClosure(func_name, std::move(cap_vars), func_idx);
 });
 
 TVM_REGISTER_GLOBAL("vm.builtin.invoke_closure").set_body([](TVMArgs args, TVMRetValue* rv) {
@@ -63,137 +121,432 @@ TVM_REGISTER_GLOBAL("vm.builtin.invoke_closure").set_body([](TVMArgs args, TVMRe
   void* vm_ptr = args[0];
   VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
   VMClosure vm_closure = args[1];
-  runtime::String func_name = vm_closure->func_name;
-
-  PackedFunc func{nullptr};
-  func = vm->GetFunction(func_name, GetObjectPtr<Object>(vm));
-  ICHECK(func != nullptr) << "cannot find closure " << func_name;
-
-  // get closure free_vars
-  Array<ObjectRef> cap_vars = vm_closure->free_vars;
-  size_t num_tensor_args = args.size() - 2;
-  std::vector<TVMValue> values(num_tensor_args + cap_vars.size());
-  std::vector<int> tcodes(num_tensor_args + cap_vars.size());
+  vm->InvokeClosure(vm_closure, TVMArgs(args.values + 2, args.type_codes + 2, args.size() - 2),
+                    rv);
+});
 
-  runtime::TVMArgsSetter setter(values.data(), tcodes.data());
-  for (size_t i = 0; i < num_tensor_args; i++) {
-    NDArray arg = args[i + 2];
-    setter(i, arg);
+TVM_REGISTER_GLOBAL("vm.builtin.scan").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // args[0]: vm; args[1]: the name of the step function; args[2]: the number of steps, given as
+  // a shape of one dimension or an integer; args[3, 4, ...]: the initial states
+  VirtualMachine* vm = static_cast<VirtualMachine*>(args[0].operator void*());
+  String func_name = args[1];
+  int64_t num_steps = args[2].type_code() == kTVMObjectHandle
+                          ? args[2].AsObjectRef<ShapeTuple>()[0]
+                          : args[2].operator int64_t();
+  std::vector<RegType> states(args.size() - 3);
+  for (int i = 3; i < args.size(); ++i) {
+    states[i - 3] = args[i];
   }
-  for (size_t i = 0; i < cap_vars.size(); i++) {
-    setter(i + num_tensor_args, cap_vars[i]);
-  }
-  TVMArgs func_args(values.data(), tcodes.data(), values.size());
-  func.CallPacked(func_args, rv);
+  *rv = vm->Scan(vm->LookupVMFunctionIndex(func_name), num_steps, std::move(states));
+});
+
+TVM_REGISTER_GLOBAL("vm.builtin.dispatch_kernel").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // args[0]: vm; args[1]: the index of the kernel argument and the axis of the dimension which
+  // the kernel is dispatched on; args[2]: the sorted extents of the n variants;
+  // args[3, ..., 3 + n]: the names of the variants and of the kernel serving the larger
+  // dimensions; the remaining args: the kernel arguments
+  VirtualMachine* vm = static_cast<VirtualMachine*>(args[0].operator void*());
+  ShapeTuple dim = args[1].AsObjectRef<ShapeTuple>();
+  ShapeTuple extents = args[2].AsObjectRef<ShapeTuple>();
+  int num_kernels = static_cast<int>(extents.size()) + 1;
+  int offset = 3 + num_kernels;
+  ICHECK_EQ(dim.size(), 2U);
+  ICHECK_LE(offset, args.size());
+  TVMArgs kernel_args(args.values + offset, args.type_codes + offset, args.size() - offset);
+  ICHECK_LT(dim[0], kernel_args.size());
+  DLTensor* tensor = kernel_args[dim[0]];
+  ICHECK_LT(dim[1], tensor->ndim);
+  TVMArgs names(args.values + 3, args.type_codes + 3, num_kernels);
+  vm->LookupKernelVariant(extents, names, tensor->shape[dim[1]]).CallPacked(kernel_args, rv);
 });
 
 TVM_REGISTER_GLOBAL("vm.builtin.store_shape")
     .set_body_typed([](ShapeTuple shape, NDArray heap, ShapeTuple indexes) {
-      int64_t* heap_data = reinterpret_cast<int64_t*>(heap.ToDLPack()->dl_tensor.data);
+      // The heap is a host int64 array, its slots are written in place.
+      int64_t* heap_data = static_cast<int64_t*>(heap->data);
+      int64_t heap_size = heap->shape[0];
       for (size_t i = 0; i < indexes.size(); ++i) {
         int64_t heap_idx = indexes[i];
-        ICHECK(heap_idx >= 0 && heap_idx < heap.Shape()[0]);
+        ICHECK(heap_idx >= 0 && heap_idx < heap_size);
         heap_data[heap_idx] = shape[i];
       }
     });
 
-TVM_REGISTER_GLOBAL("vm.builtin.load_shape").set_body_typed([](NDArray heap, ShapeTuple indexes) {
-  int64_t* heap_data = reinterpret_cast<int64_t*>(heap.ToDLPack()->dl_tensor.data);
-  std::vector<int64_t> shape;
+template <typename Args>
+static void LoadShape(const Args& args, TVMRetValue* rv) {
+  NDArray heap = args[0];
+  ShapeTuple indexes = args[1].template AsObjectRef<ShapeTuple>();
+  const int64_t* heap_data = static_cast<const int64_t*>(heap->data);
+  int64_t heap_size = heap->shape[0];
+  // The shape is loaded on every call, so it is gathered on the stack when it fits and the
+  // ShapeTuple is allocated from the object pool.
+  constexpr size_t kStackDims = 8;
+  int64_t stack_shape[kStackDims];
+  std::vector<int64_t> heap_shape(indexes.size() > kStackDims ? indexes.size() : 0);
+  int64_t* shape = indexes.size() > kStackDims ? heap_shape.data() : stack_shape;
   for (size_t i = 0; i < indexes.size(); ++i) {
     int64_t heap_idx = indexes[i];
-    ICHECK(heap_idx >= 0 && heap_idx < heap.Shape()[0]);
-    shape.push_back(heap_data[heap_idx]);
+    ICHECK(heap_idx >= 0 && heap_idx < heap_size);
+    shape[i] = heap_data[heap_idx];
   }
-  return ShapeTuple(shape);
-});
+  *rv = ShapeTuple::Pooled(shape, shape + indexes.size());
+}
+
+TVM_REGISTER_VM_BUILTIN_BODY("vm.builtin.load_shape", LoadShape);
+
+/*!
+ * \brief Allocate a storage on the given device.
+ * \note The buffer size is the size in bytes for the global memory scope, and the shape of the
+ *  storage for the other scopes, e.g. the shape of the tensor in the 2D image memory of
+ *  "global.texture", or the flat number of elements in the VTCM of "global.vtcm".
+ */
+static Storage AllocStorage(VirtualMachine* vm, ShapeTuple buffer_size, Index device_index,
+                            DLDataType dtype_hint, const std::string& mem_scope) {
+  bool global_scope = mem_scope.empty() || mem_scope == "global";
+  int alignment = runtime::kAllocAlignment;
+  device_index = vm->ResolveDeviceIndex(device_index);
+  if (global_scope) {
+    ICHECK_EQ(buffer_size.size(), 1);
+  }
+
+  auto record = [vm](const Storage& storage) {
+    if (std::vector<Storage>* recorder = vm->storage_recorder()) recorder->push_back(storage);
+    return storage;
+  };
+
+  // Reuse the storage allocated by this instruction in a previous invocation when the
+  // cache holds the only reference, i.e. no tensor allocated from it is alive anymore.
+  Storage& cached = vm->CurrentStorageCacheSlot();
+  if (cached.defined() && cached.use_count() == 1) {
+    const Buffer& buffer = cached->buffer;
+    if (global_scope && buffer.mem_scope.empty() &&
+        buffer.size >= static_cast<size_t>(buffer_size[0])) {
+      return record(cached);
+    }
+    if (!global_scope && buffer.mem_scope == mem_scope &&
+        buffer.shape.size() == buffer_size.size() &&
+        std::equal(buffer_size.begin(), buffer_size.end(), buffer.shape.begin())) {
+      return record(cached);
+    }
+  }
+
+  auto storage_obj = runtime::make_pooled_object<StorageObj>();
+  auto* alloc = vm->allocators[device_index];
+  ICHECK(alloc) << "Did you forget to init the VirtualMachine with devices?";
+  storage_obj->allocator = alloc;
+  if (global_scope) {
+    storage_obj->buffer = alloc->Alloc(buffer_size[0], alignment, dtype_hint);
+  } else {
+    storage_obj->buffer = alloc->Alloc(vm->devices[device_index], buffer_size, dtype_hint,
+                                       mem_scope);
+  }
+  if (VMHooks* hooks = vm->hooks()) {
+    hooks->OnAlloc(vm->devices[device_index], storage_obj->buffer.size, mem_scope);
+  }
+  Storage storage(storage_obj);
+  if (!cached.defined() || cached.use_count() == 1) {
+    cached = storage;
+  }
+  return record(storage);
+}
+
+template <typename Args>
+static void AllocStorageBuiltin(const Args& args, TVMRetValue* rv) {
+  // args[0]: vm; args[1]: buffer size; args[2]: device index; args[3]: dtype hint;
+  // args[4]: the memory scope, optional and global by default
+  ICHECK(args.size() == 4 || args.size() == 5);
+  std::string mem_scope = args.size() == 5 ? args[4].operator std::string() : "";
+  *rv = AllocStorage(static_cast<VirtualMachine*>(args[0].operator void*()),
+                     args[1].template AsObjectRef<ShapeTuple>(), args[2].operator Index(),
+                     args[3].operator DLDataType(), mem_scope);
+}
+
+TVM_REGISTER_VM_BUILTIN_BODY("vm.builtin.alloc_storage", AllocStorageBuiltin);
+
+template <typename Args>
+static void AllocStorageAndTensor(const Args& args, TVMRetValue* rv) {
+  // Fused form of alloc_storage followed by alloc_tensor, used when the storage has no
+  // other use. The tensor keeps the storage alive.
+  // args[0, ..., 3]: the arguments of alloc_storage; args[4]: offset; args[5]: shape;
+  // args[6]: dtype; args[7]: the memory scope of alloc_storage, optional
+  ICHECK(args.size() == 7 || args.size() == 8);
+  std::string mem_scope = args.size() == 8 ? args[7].operator std::string() : "";
+  Storage storage = AllocStorage(static_cast<VirtualMachine*>(args[0].operator void*()),
+                                 args[1].template AsObjectRef<ShapeTuple>(),
+                                 args[2].operator Index(), args[3].operator DLDataType(),
+                                 mem_scope);
+  *rv = storage->AllocNDArray(args[4].operator uint64_t(),
+                              args[5].template AsObjectRef<ShapeTuple>(),
+                              args[6].operator DLDataType());
+}
+
+TVM_REGISTER_VM_BUILTIN_BODY("vm.builtin.alloc_storage_and_tensor", AllocStorageAndTensor);
 
-TVM_REGISTER_GLOBAL("vm.builtin.alloc_storage")
-    .set_body_typed([](void* vm_ptr, ShapeTuple buffer_size, Index device_index,
-                       DLDataType dtype_hint) {
-      ICHECK_EQ(buffer_size.size(), 1);
-      int alignment = runtime::kAllocAlignment;
+TVM_REGISTER_GLOBAL("vm.builtin.to_device")
+    .set_body_typed([](void* vm_ptr, NDArray src, Index device_index) {
       VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
-      ICHECK_LT(device_index, vm->devices.size())
-          << "The device index is out of VM physical devices list";
+      return vm->CopyToDevice(src, device_index);
+    });
 
-      if (device_index == -1) {
-        // Allocate on host. Host is always the last element of vm->devices.
-        device_index = vm->devices.size() - 1;
+TVM_REGISTER_GLOBAL("vm.builtin.alloc_output_tensor")
+    .set_body_typed([](void* vm_ptr, Storage storage, uint64_t offset, ShapeTuple shape,
+                       DLDataType dtype, Index output_index) {
+      // Alias the output buffer provided by the caller when it can hold the tensor, so the
+      // kernel writes the result in place.
+      VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+      NDArray out = vm->GetOutputBuffer(output_index);
+      if (out.defined() && DataType(out->dtype) == DataType(dtype) &&
+          out->device.device_type == storage->buffer.device.device_type &&
+          out->device.device_id == storage->buffer.device.device_id &&
+          out->ndim == static_cast<int>(shape.size()) &&
+          std::equal(shape.begin(), shape.end(), out->shape)) {
+        return out;
       }
+      return storage->AllocNDArray(offset, shape, dtype);
+    });
+
+TVM_REGISTER_GLOBAL("vm.builtin.stream.set")
+    .set_body_typed([](void* vm_ptr, Index device_index, Index stream_index) {
+      // Kernels launched on the device afterwards are queued on the given stream.
+      VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+      TVMStreamHandle stream = vm->GetStream(device_index, stream_index);
+      const Device& dev = vm->devices[vm->ResolveDeviceIndex(device_index)];
+      DeviceAPI::Get(dev)->SetStream(dev, stream);
+    });
 
-      int64_t size_imm = buffer_size[0];
+TVM_REGISTER_GLOBAL("vm.builtin.stream.wait")
+    .set_body_typed([](void* vm_ptr, Index device_index, Index src_stream, Index dst_stream) {
+      // Make dst_stream wait for the work queued on src_stream so far, without blocking the host.
+      VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+      const Device& dev = vm->devices[vm->ResolveDeviceIndex(device_index)];
+      DeviceAPI::Get(dev)->SyncStreamFromTo(dev, vm->GetStream(device_index, src_stream),
+                                            vm->GetStream(device_index, dst_stream));
+    });
 
-      auto storage_obj = runtime::SimpleObjAllocator().make_object<StorageObj>();
-      auto* alloc = vm->allocators[device_index];
-      ICHECK(alloc) << "Did you forget to init the VirtualMachine with devices?";
-      storage_obj->buffer = alloc->Alloc(size_imm, alignment, dtype_hint);
-      Storage storage(storage_obj);
-      return storage;
+TVM_REGISTER_GLOBAL("vm.builtin.stream.sync")
+    .set_body_typed([](void* vm_ptr, Index device_index, Index stream_index) {
+      VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+      const Device& dev = vm->devices[vm->ResolveDeviceIndex(device_index)];
+      DeviceAPI::Get(dev)->StreamSync(dev, vm->GetStream(device_index, stream_index));
     });
 
-TVM_REGISTER_GLOBAL("vm.builtin.alloc_tensor").set_body_method<Storage>(&StorageObj::AllocNDArray);
+template <typename Args>
+static void AllocTensor(const Args& args, TVMRetValue* rv) {
+  // args[0]: storage; args[1]: offset; args[2]: shape; args[3]: dtype
+  ICHECK_EQ(args.size(), 4);
+  *rv = args[0].template AsObjectRef<Storage>()->AllocNDArray(
+      args[1].operator uint64_t(), args[2].template AsObjectRef<ShapeTuple>(),
+      args[3].operator DLDataType());
+}
+
+TVM_REGISTER_VM_BUILTIN_BODY("vm.builtin.alloc_tensor", AllocTensor);
+
+/*! \brief Get the shape of a broadcast operand, which is either a tensor or its shape. */
+inline ShapeTuple BroadcastOperandShape(const TVMArgValue& arg) {
+  if (arg.type_code() == kTVMNDArrayHandle) {
+    return arg.operator NDArray().Shape();
+  }
+  return arg.operator ShapeTuple();
+}
 
 TVM_REGISTER_GLOBAL("vm.binary_broadcast_shape_infer")
-    .set_body_typed([](ShapeTuple lhs_shape, ShapeTuple rhs_shape) {
-      std::vector<int64_t> output_shape;
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      ShapeTuple lhs_shape = BroadcastOperandShape(args[0]);
+      ShapeTuple rhs_shape = BroadcastOperandShape(args[1]);
+      if (lhs_shape.same_as(rhs_shape)) {
+        *rv = lhs_shape;
+        return;
+      }
       size_t ndim0 = lhs_shape.size();
       size_t ndim1 = rhs_shape.size();
+      size_t max_ndim = std::max(ndim0, ndim1);
+      // Fill the output from the innermost dimension, the vector is moved into the result.
+      std::vector<int64_t> output_shape(max_ndim);
       size_t i = 1;
       for (; i <= std::min(ndim0, ndim1); ++i) {
         int64_t lhs_dim = lhs_shape[ndim0 - i];
         int64_t rhs_dim = rhs_shape[ndim1 - i];
-        ICHECK(lhs_dim == rhs_dim || lhs_dim == 1 || rhs_dim == 1);
-        output_shape.push_back(std::max(lhs_dim, rhs_dim));
+        ICHECK(lhs_dim == rhs_dim || lhs_dim == 1 || rhs_dim == 1)
+            << "Cannot broadcast dimension " << lhs_dim << " with dimension " << rhs_dim;
+        output_shape[max_ndim - i] = std::max(lhs_dim, rhs_dim);
       }
-      size_t max_ndim = std::max(ndim0, ndim1);
-      ShapeTuple& longer_shape = (ndim0 > ndim1) ? lhs_shape : rhs_shape;
+      const ShapeTuple& longer_shape = (ndim0 > ndim1) ? lhs_shape : rhs_shape;
       for (; i <= max_ndim; ++i) {
-        output_shape.push_back(longer_shape[max_ndim - i]);
+        output_shape[max_ndim - i] = longer_shape[max_ndim - i];
       }
-      return ShapeTuple(output_shape.rbegin(), output_shape.rend());
+      *rv = ShapeTuple(std::move(output_shape));
     });
 
 TVM_REGISTER_GLOBAL("vm.call_tir_dyn").set_body([](TVMArgs args, TVMRetValue* rv) {
   void* vm_ptr = args[0];
   VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
   runtime::String func_name = args[1];
-
-  PackedFunc func{nullptr};
-  if (vm->lib.defined()) {
-    func = vm->lib.value()->GetFunction(func_name, true);
-  }
-  if (!func.defined()) {
-    const PackedFunc* p_func = Registry::Get(func_name);
-    CHECK(p_func != nullptr);
-    func = *(p_func);
-  }
+  const PackedFunc& func = vm->LookupKernel(func_name);
 
   ShapeTuple to_unpack = args[args.size() - 1];
   size_t num_tensor_args = args.size() - 3;
-  std::vector<TVMValue> values(num_tensor_args + to_unpack.size());
-  std::vector<int> tcodes(num_tensor_args + to_unpack.size());
+  // The kernel specialized for the values of the symbolic variables takes the tensors only.
+  PackedFunc specialized{nullptr};
+  if (KernelJIT* jit = vm->GetKernelJIT()) {
+    specialized = jit->Lookup(func_name, to_unpack);
+  }
+  size_t num_unpacked = specialized != nullptr ? 0 : to_unpack.size();
+  // reuse the kernel argument stack of the current frame to avoid re-allocation
+  VMFrame* frame = vm->CurrentFrame();
+  std::vector<TVMValue>& values = frame->kernel_arg_values;
+  std::vector<int>& tcodes = frame->kernel_arg_tcodes;
+  values.resize(num_tensor_args + num_unpacked);
+  tcodes.resize(num_tensor_args + num_unpacked);
   runtime::TVMArgsSetter setter(values.data(), tcodes.data());
   for (size_t i = 0; i < num_tensor_args; i++) {
     NDArray arg = args[i + 2];
     setter(i, arg);
   }
-  for (size_t i = 0; i < to_unpack.size(); i++) {
+  for (size_t i = 0; i < num_unpacked; i++) {
     setter(i + num_tensor_args, to_unpack[i]);
   }
 
   TVMArgs func_args(values.data(), tcodes.data(), values.size());
-  func.CallPacked(func_args, rv);
+  (specialized != nullptr ? specialized : func).CallPacked(func_args, rv);
 });
 
-TVM_REGISTER_GLOBAL("vm.runtime.TupleGetItem")
-    .set_body_typed([](runtime::ADT adt, ShapeTuple index) {
-      ICHECK_EQ(index.size(), 1);
-      int idx = index[0];
-      ICHECK_LT(idx, adt.size());
-      return adt[idx];
+/*!
+ * \brief Copy the first \p extent entries along \p axis of \p from into \p to.
+ * \note Both tensors are compact and have the same shape except along \p axis.
+ */
+static void CopyLeadingEntries(const DLTensor* from, DLTensor* to, int axis, int64_t extent) {
+  int64_t outer = 1;
+  int64_t inner = 1;
+  for (int i = 0; i < axis; ++i) outer *= from->shape[i];
+  for (int i = axis + 1; i < from->ndim; ++i) inner *= from->shape[i];
+  int64_t num_elems = extent * inner;
+  size_t elem_bytes = (from->dtype.bits * from->dtype.lanes + 7) / 8;
+  for (int64_t i = 0; i < outer; ++i) {
+    // View each contiguous run as a flat tensor so that a single device copy moves it.
+    DLTensor src = *from;
+    src.ndim = 1;
+    src.shape = &num_elems;
+    src.strides = nullptr;
+    src.byte_offset = from->byte_offset + i * from->shape[axis] * inner * elem_bytes;
+    DLTensor dst = *to;
+    dst.ndim = 1;
+    dst.shape = &num_elems;
+    dst.strides = nullptr;
+    dst.byte_offset = to->byte_offset + i * to->shape[axis] * inner * elem_bytes;
+    NDArray::CopyFromTo(&src, &dst);
+  }
+}
+
+TVM_REGISTER_GLOBAL("vm.builtin.fits_bucket").set_body_typed([](NDArray data, ShapeTuple spec) {
+  // spec: (axis, bucket)
+  ICHECK_EQ(spec.size(), 2);
+  ICHECK_LT(spec[0], data->ndim);
+  return data->shape[spec[0]] <= spec[1];
+});
+
+TVM_REGISTER_GLOBAL("vm.builtin.pad_to_bucket").set_body_typed([](NDArray data, ShapeTuple spec) {
+  // spec: (axis, bucket), the padded entries are filled with zeros.
+  ICHECK_EQ(spec.size(), 2);
+  int axis = spec[0];
+  int64_t bucket = spec[1];
+  ICHECK_LT(axis, data->ndim);
+  ICHECK(data.IsContiguous()) << "Only compact tensors can be padded to a bucket";
+  int64_t extent = data->shape[axis];
+  ICHECK_LE(extent, bucket);
+  if (extent == bucket) return data;
+  std::vector<int64_t> shape(data->shape, data->shape + data->ndim);
+  shape[axis] = bucket;
+  NDArray padded = NDArray::Empty(ShapeTuple(shape), data->dtype, Device{kDLCPU, 0});
+  memset(padded->data, 0, GetDataSize(*padded.operator->()));
+  if (data->device.device_type != kDLCPU) {
+    padded = padded.CopyTo(data->device);
+  }
+  CopyLeadingEntries(data.operator->(), const_cast<DLTensor*>(padded.operator->()), axis, extent);
+  return padded;
+});
+
+TVM_REGISTER_GLOBAL("vm.builtin.unpad_from_bucket")
+    .set_body_typed([](NDArray data, ShapeTuple spec, NDArray ref) {
+      // spec: (axis, ref_axis), the result keeps ref->shape[ref_axis] entries along axis.
+      ICHECK_EQ(spec.size(), 2);
+      int axis = spec[0];
+      ICHECK_LT(axis, data->ndim);
+      ICHECK_LT(spec[1], ref->ndim);
+      int64_t extent = ref->shape[spec[1]];
+      ICHECK_LE(extent, data->shape[axis]);
+      if (extent == data->shape[axis]) return data;
+      std::vector<int64_t> shape(data->shape, data->shape + data->ndim);
+      shape[axis] = extent;
+      ICHECK(data.IsContiguous()) << "Only compact tensors can be unpadded from a bucket";
+      bool is_prefix = true;
+      for (int i = 0; i < axis; ++i) is_prefix = is_prefix && data->shape[i] == 1;
+      if (is_prefix) {
+        // The kept entries are a prefix of the data, so a view avoids the copy.
+        return data.CreateView(ShapeTuple(shape), data->dtype);
+      }
+      NDArray result = NDArray::Empty(ShapeTuple(shape), data->dtype, data->device);
+      CopyLeadingEntries(data.operator->(), const_cast<DLTensor*>(result.operator->()), axis,
+                         extent);
+      return result;
     });
 
+template <typename Args>
+static void TupleGetItem(const Args& args, TVMRetValue* rv) {
+  ADT adt = args[0].template AsObjectRef<ADT>();
+  ShapeTuple index = args[1].template AsObjectRef<ShapeTuple>();
+  ICHECK_EQ(index.size(), 1);
+  int idx = index[0];
+  ICHECK_LT(idx, adt.size());
+  *rv = adt[idx];
+}
+
+TVM_REGISTER_VM_BUILTIN_BODY("vm.runtime.TupleGetItem", TupleGetItem);
+
+// runtime.Tuple is registered with the runtime containers, the VM creates its tuples with it.
+TVM_REGISTER_VM_BUILTIN("runtime.Tuple", [](VMBuiltinArgs args, RegType* rv) {
+  std::vector<ObjectRef> fields;
+  fields.reserve(args.size());
+  for (int i = 0; i < args.size(); ++i) {
+    fields.push_back(args[i].AsObjectRef<ObjectRef>());
+  }
+  *rv = ADT::PooledTuple(fields.begin(), fields.end());
+});
+
 }  // namespace relax_vm
 }  // namespace runtime
 }  // namespace tvm
+
+//-------------------------------------------------
+//  AnyList, the register file of compiled functions
+//-------------------------------------------------
+using tvm::runtime::TVMRetValue;
+
+int TVMBackendAnyListSetPackedArg(void* anylist, int index, TVMValue* args, int* type_codes,
+                                  int arg_offset) {
+  API_BEGIN();
+  auto* list = static_cast<TVMRetValue*>(anylist);
+  tvm::runtime::TVMArgsSetter setter(args, type_codes);
+  setter(arg_offset, list[index]);
+  API_END();
+}
+
+int TVMBackendAnyListResetItem(void* anylist, int index) {
+  API_BEGIN();
+  auto* list = static_cast<TVMRetValue*>(anylist);
+  list[index] = nullptr;
+  API_END();
+}
+
+int TVMBackendAnyListMoveFromPackedReturn(void* anylist, int index, TVMValue* args,
+                                          int* type_codes, int ret_offset) {
+  API_BEGIN();
+  auto* list = static_cast<TVMRetValue*>(anylist);
+  ICHECK_NE(type_codes[ret_offset], kTVMBytes) << "Bytes cannot be stored in an anylist";
+  if (type_codes[ret_offset] == kTVMStr) {
+    // Strings are returned in a buffer owned by the callee, copy them.
+    list[index] = std::string(args[ret_offset].v_str);
+  } else {
+    list[index] = TVMRetValue::MoveFromCHost(args[ret_offset], type_codes[ret_offset]);
+  }
+  API_END();
+}
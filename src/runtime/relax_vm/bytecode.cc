@@ -63,6 +63,31 @@ Instruction Instruction::If(RegName cond, Index false_offset) {
   instr.false_offset = false_offset;
   return instr;
 }
+
+Instruction Instruction::KillRegister(RegName reg) {
+  Instruction instr;
+  instr.op = Opcode::KillRegister;
+  instr.dst = reg;
+  return instr;
+}
+
+Instruction Instruction::Move(Arg src, RegName dst) {
+  Instruction instr;
+  instr.op = Opcode::Move;
+  instr.dst = dst;
+  instr.src = src.data;
+  return instr;
+}
+
+Instruction Instruction::TailCall(Index func_idx, Index num_args, Instruction::Arg* args) {
+  Instruction instr;
+  instr.op = Opcode::TailCall;
+  instr.dst = kVoidArg;
+  instr.func_idx = func_idx;
+  instr.num_args = num_args;
+  instr.args = args;
+  return instr;
+}
 }  // namespace relax_vm
 }  // namespace runtime
 }  // namespace tvm
@@ -0,0 +1,417 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/ccl.cc
+ * \brief The collective communication builtins among the devices of a Relax VM.
+ *
+ * In a single process, a group of shards is a tuple whose i-th tensor lives on the i-th device
+ * of the VM. The builtins run on the NCCL backend registered when TVM is built with USE_NCCL
+ * once all the shards are on CUDA devices, and otherwise move the data through the host.
+ *
+ * In a distributed run, vm_initialization creates the communicator of the process among the
+ * processes of the run, and the builtins take the tensor of this process instead of a group.
+ *
+ * The backend runs on the collective stream of each device, ordered after the work queued on
+ * the default stream and before the work queued after the builtin, without blocking the host.
+ */
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/vm.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+namespace {
+
+constexpr Device kHost{kDLCPU, 0};
+
+/*! \brief Get the function of the NCCL backend for a group of shards, nullptr if not built. */
+const PackedFunc* GetNCCLFunc(const char* name, const std::vector<NDArray>& shards) {
+  for (const NDArray& shard : shards) {
+    if (shard->device.device_type != kDLCUDA) return nullptr;
+  }
+  return Registry::Get(std::string("runtime.relax_vm.nccl.") + name);
+}
+
+/*!
+ * \brief The collective streams of the devices of a call to the backend. The streams wait for
+ *  the default streams on construction, and the default streams wait for them on destruction.
+ */
+class CCLStreamScope {
+ public:
+  CCLStreamScope(VirtualMachine* vm, const std::vector<Device>& devices) : vm_(vm) {
+    for (const Device& dev : devices) {
+      Index index = -1;
+      if (vm_ != nullptr) {
+        auto it = std::find_if(vm_->devices.begin(), vm_->devices.end(), [&](const Device& d) {
+          return d.device_type == dev.device_type && d.device_id == dev.device_id;
+        });
+        if (it != vm_->devices.end()) index = it - vm_->devices.begin();
+      }
+      indices_.push_back(index);
+      devices_.push_back(dev);
+      streams.push_back(index == -1 ? nullptr : vm_->GetStream(index, VirtualMachine::kCCLStream));
+      Sync(streams.size() - 1, /*to_ccl=*/true);
+    }
+  }
+
+  ~CCLStreamScope() {
+    for (size_t i = 0; i < streams.size(); ++i) Sync(i, /*to_ccl=*/false);
+  }
+
+  /*! \brief Set the streams as the trailing arguments of a call to the backend. */
+  void SetArgs(TVMArgsSetter* setter, int begin) const {
+    for (size_t i = 0; i < streams.size(); ++i) (*setter)(begin + i, streams[i]);
+  }
+
+  std::vector<TVMStreamHandle> streams;
+
+ private:
+  void Sync(size_t i, bool to_ccl) {
+    if (indices_[i] == -1) return;
+    TVMStreamHandle compute = vm_->GetStream(indices_[i], 0);
+    DeviceAPI* api = DeviceAPI::Get(devices_[i]);
+    if (to_ccl) {
+      api->SyncStreamFromTo(devices_[i], compute, streams[i]);
+    } else {
+      api->SyncStreamFromTo(devices_[i], streams[i], compute);
+    }
+  }
+
+  VirtualMachine* vm_;
+  std::vector<Index> indices_;
+  std::vector<Device> devices_;
+};
+
+/*! \brief Call a function of the NCCL backend with the arguments followed by the streams. */
+template <typename... Args>
+void CallNCCL(const PackedFunc& func, const CCLStreamScope& scope, Args&&... args) {
+  constexpr int kNumArgs = sizeof...(Args);
+  int num_args = kNumArgs + scope.streams.size();
+  std::vector<TVMValue> values(num_args);
+  std::vector<int> tcodes(num_args);
+  TVMArgsSetter setter(values.data(), tcodes.data());
+  detail::for_each(setter, std::forward<Args>(args)...);
+  scope.SetArgs(&setter, kNumArgs);
+  TVMRetValue rv;
+  func.CallPacked(TVMArgs(values.data(), tcodes.data(), num_args), &rv);
+}
+
+std::vector<Device> DevicesOf(const std::vector<NDArray>& tensors) {
+  std::vector<Device> devices;
+  for (const NDArray& tensor : tensors) devices.push_back(tensor->device);
+  return devices;
+}
+
+/*! \brief Get the communicator of a distributed run, undefined in a single process. */
+ObjectRef CommOf(void* vm_ptr) {
+  VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+  return vm == nullptr ? ObjectRef() : vm->ccl_comm;
+}
+
+/*! \brief Get a function of the backend of a distributed run. */
+const PackedFunc& GetCommFunc(const std::string& name) {
+  const PackedFunc* func = Registry::Get("runtime.relax_vm.nccl." + name);
+  ICHECK(func != nullptr) << "The communicator of the distributed run has no " << name;
+  return *func;
+}
+
+std::vector<NDArray> ShardsOf(const ADT& group) {
+  ICHECK_GT(group.size(), 0) << "A group of shards cannot be empty";
+  std::vector<NDArray> shards;
+  for (size_t i = 0; i < group.size(); ++i) {
+    shards.push_back(Downcast<NDArray>(group[i]));
+    ICHECK(shards[i].IsContiguous()) << "The shards must be contiguous";
+    ICHECK_EQ(shards[i]->ndim, shards[0]->ndim) << "The shards must have the same shape";
+    ICHECK(std::equal(shards[i]->shape, shards[i]->shape + shards[i]->ndim, shards[0]->shape))
+        << "The shards must have the same shape";
+  }
+  return shards;
+}
+
+/*! \brief Copy the bytes of a tensor from the given offset into another tensor. */
+void CopyBytes(const NDArray& src, int64_t src_offset, const NDArray& dst, int64_t dst_offset,
+               int64_t num_bytes) {
+  DLTensor src_view = *src.operator->();
+  DLTensor dst_view = *dst.operator->();
+  src_view.ndim = dst_view.ndim = 1;
+  src_view.shape = dst_view.shape = &num_bytes;
+  src_view.dtype = dst_view.dtype = DLDataType{kDLUInt, 8, 1};
+  src_view.byte_offset += src_offset;
+  dst_view.byte_offset += dst_offset;
+  NDArray::CopyFromTo(&src_view, &dst_view);
+}
+
+/*! \brief The number of slices of a tensor before the axis, each split or gathered in turn. */
+int64_t NumOuterSlices(const std::vector<int64_t>& shape, int axis) {
+  int64_t num_slices = 1;
+  for (int i = 0; i < axis; ++i) num_slices *= shape[i];
+  return num_slices;
+}
+
+template <typename T>
+void Accumulate(const NDArray& acc, const NDArray& value) {
+  T* acc_data = static_cast<T*>(acc->data);
+  const T* data = static_cast<const T*>(value->data);
+  int64_t size = GetDataSize(*acc.operator->()) / sizeof(T);
+  for (int64_t i = 0; i < size; ++i) acc_data[i] += data[i];
+}
+
+/*! \brief Sum the shards on the host, for the devices without a collective backend. */
+void HostAllReduce(const std::vector<NDArray>& shards) {
+  NDArray acc = shards[0].CopyTo(kHost);
+  DataType dtype(acc->dtype);
+  for (size_t i = 1; i < shards.size(); ++i) {
+    NDArray value = shards[i].CopyTo(kHost);
+    if (dtype == DataType::Float(32)) {
+      Accumulate<float>(acc, value);
+    } else if (dtype == DataType::Float(64)) {
+      Accumulate<double>(acc, value);
+    } else if (dtype == DataType::Int(32)) {
+      Accumulate<int32_t>(acc, value);
+    } else if (dtype == DataType::Int(64)) {
+      Accumulate<int64_t>(acc, value);
+    } else {
+      LOG(FATAL) << "The all-reduce through the host does not support " << dtype;
+    }
+  }
+  for (NDArray shard : shards) {
+    shard.CopyFrom(acc);
+  }
+}
+
+/*! \brief Gather the shards along the axis into the outputs, through the host when needed. */
+void GatherShards(const std::vector<NDArray>& shards, int axis, const std::vector<NDArray>& outs) {
+  int64_t num_shards = shards.size();
+  std::vector<int64_t> shape(outs[0]->shape, outs[0]->shape + outs[0]->ndim);
+  int64_t num_slices = NumOuterSlices(shape, axis);
+  int64_t slice_bytes = GetDataSize(*shards[0].operator->()) / num_slices;
+  // Gather into the first output, through the host when the shards interleave in it.
+  NDArray gathered = outs[0];
+  if (num_slices != 1) gathered = NDArray::Empty(ShapeTuple(shape), gathered->dtype, kHost);
+  for (int64_t s = 0; s < num_shards; ++s) {
+    NDArray shard = num_slices == 1 ? shards[s] : shards[s].CopyTo(gathered->device);
+    for (int64_t o = 0; o < num_slices; ++o) {
+      CopyBytes(shard, o * slice_bytes, gathered, (o * num_shards + s) * slice_bytes,
+                slice_bytes);
+    }
+  }
+  for (NDArray out : outs) {
+    if (!out.same_as(gathered)) out.CopyFrom(gathered);
+  }
+}
+
+int CheckAxis(const ShapeTuple& axis_tuple, const NDArray& tensor) {
+  ICHECK_EQ(axis_tuple.size(), 1);
+  int axis = axis_tuple[0];
+  ICHECK(axis >= 0 && axis < tensor->ndim) << "The axis " << axis << " is out of range";
+  return axis;
+}
+
+}  // namespace
+
+TVM_REGISTER_GLOBAL("vm.builtin.ccl.allreduce").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // Sum the shards in place, after which every shard holds the total. In a distributed run,
+  // sum the tensors of the processes.
+  void* vm_ptr = args[0];
+  if (args[1].IsObjectRef<NDArray>()) {
+    ObjectRef comm = CommOf(vm_ptr);
+    ICHECK(comm.defined()) << "The all-reduce of a tensor needs the communicator of a "
+                              "distributed run, pass the shards as a tuple in a single process";
+    NDArray tensor = args[1];
+    CCLStreamScope scope(static_cast<VirtualMachine*>(vm_ptr), {tensor->device});
+    CallNCCL(GetCommFunc("comm_allreduce"), scope, comm, tensor);
+    *rv = tensor;
+    return;
+  }
+  ADT group = args[1];
+  std::vector<NDArray> shards = ShardsOf(group);
+  if (const PackedFunc* nccl = GetNCCLFunc("allreduce", shards)) {
+    CCLStreamScope scope(static_cast<VirtualMachine*>(vm_ptr), DevicesOf(shards));
+    CallNCCL(*nccl, scope, group);
+  } else {
+    HostAllReduce(shards);
+  }
+  *rv = group;
+});
+
+TVM_REGISTER_GLOBAL("vm.builtin.ccl.allgather").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // Concatenate the shards along the axis on every device. In a distributed run, concatenate
+  // the tensors of the processes in the order of the ranks.
+  void* vm_ptr = args[0];
+  ShapeTuple axis_tuple = args[2];
+  if (args[1].IsObjectRef<NDArray>()) {
+    ObjectRef comm = CommOf(vm_ptr);
+    ICHECK(comm.defined()) << "The all-gather of a tensor needs the communicator of a "
+                              "distributed run, pass the shards as a tuple in a single process";
+    NDArray tensor = args[1];
+    int axis = CheckAxis(axis_tuple, tensor);
+    int64_t world_size = GetCommFunc("comm_world_size")(comm);
+    std::vector<int64_t> shape(tensor->shape, tensor->shape + tensor->ndim);
+    // The backend gathers the tensors one after another, which are then interleaved along the
+    // axis unless it is the outermost one.
+    std::vector<int64_t> stacked_shape = shape;
+    stacked_shape[0] *= world_size;
+    NDArray stacked = NDArray::Empty(ShapeTuple(stacked_shape), tensor->dtype, tensor->device);
+    {
+      CCLStreamScope scope(static_cast<VirtualMachine*>(vm_ptr), {tensor->device});
+      CallNCCL(GetCommFunc("comm_allgather"), scope, comm, tensor, stacked);
+    }
+    int64_t num_slices = NumOuterSlices(shape, axis);
+    std::vector<int64_t> out_shape = shape;
+    out_shape[axis] *= world_size;
+    if (num_slices == 1) {
+      *rv = stacked.CreateView(ShapeTuple(out_shape), tensor->dtype);
+      return;
+    }
+    int64_t part_bytes = GetDataSize(*tensor.operator->());
+    int64_t slice_bytes = part_bytes / num_slices;
+    NDArray out = NDArray::Empty(ShapeTuple(out_shape), tensor->dtype, tensor->device);
+    for (int64_t r = 0; r < world_size; ++r) {
+      for (int64_t o = 0; o < num_slices; ++o) {
+        CopyBytes(stacked, r * part_bytes + o * slice_bytes, out,
+                  (o * world_size + r) * slice_bytes, slice_bytes);
+      }
+    }
+    *rv = out;
+    return;
+  }
+  ADT group = args[1];
+  std::vector<NDArray> shards = ShardsOf(group);
+  int axis = CheckAxis(axis_tuple, shards[0]);
+  std::vector<int64_t> shape(shards[0]->shape, shards[0]->shape + shards[0]->ndim);
+  int64_t num_slices = NumOuterSlices(shape, axis);
+  shape[axis] *= shards.size();
+  std::vector<NDArray> outs;
+  for (const NDArray& shard : shards) {
+    outs.push_back(NDArray::Empty(ShapeTuple(shape), shard->dtype, shard->device));
+  }
+  ADT out_group(0, std::vector<ObjectRef>(outs.begin(), outs.end()));
+  const PackedFunc* nccl = num_slices == 1 ? GetNCCLFunc("allgather", shards) : nullptr;
+  if (nccl != nullptr) {
+    CCLStreamScope scope(static_cast<VirtualMachine*>(vm_ptr), DevicesOf(shards));
+    CallNCCL(*nccl, scope, group, out_group);
+  } else {
+    GatherShards(shards, axis, outs);
+  }
+  *rv = out_group;
+});
+
+TVM_REGISTER_GLOBAL("vm.builtin.ccl.broadcast")
+    .set_body_typed([](void* vm_ptr, NDArray src, ShapeTuple spec) -> ObjectRef {
+      VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+      ICHECK_EQ(spec.size(), 1);
+      ObjectRef comm = CommOf(vm_ptr);
+      if (comm.defined()) {
+        // spec: the rank whose tensor every process receives, in place.
+        CCLStreamScope scope(vm, {src->device});
+        CallNCCL(GetCommFunc("comm_broadcast"), scope, comm, src, spec[0]);
+        return src;
+      }
+      // spec: the number of shards. Replicate a tensor on the first devices of the VM. The
+      // constants are copied once per device, through the device constant pools.
+      std::vector<ObjectRef> outs;
+      for (int64_t i = 0; i < spec[0]; ++i) {
+        outs.push_back(vm->CopyToDevice(src, i));
+      }
+      return ADT(0, outs);
+    });
+
+TVM_REGISTER_GLOBAL("vm.builtin.ccl.scatter")
+    .set_body_typed([](void* vm_ptr, NDArray src, ShapeTuple spec) {
+      // spec: the split axis and the number of shards, the i-th shard is placed on the i-th
+      // device of the VM.
+      VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+      ICHECK_EQ(spec.size(), 2);
+      int axis = spec[0];
+      int64_t num_shards = spec[1];
+      ICHECK(axis >= 0 && axis < src->ndim) << "The split axis " << axis << " is out of range";
+      ICHECK(src.IsContiguous()) << "Only compact tensors can be scattered";
+      ICHECK_EQ(src->shape[axis] % num_shards, 0)
+          << "The axis " << axis << " of extent " << src->shape[axis] << " cannot be split into "
+          << num_shards << " shards";
+      std::vector<int64_t> shape(src->shape, src->shape + src->ndim);
+      shape[axis] /= num_shards;
+      int64_t num_slices = NumOuterSlices(shape, axis);
+      int64_t slice_bytes = GetDataSize(*src.operator->()) / num_slices / num_shards;
+      // Slice on the host when the shards interleave in the tensor.
+      NDArray staged = num_slices == 1 ? src : src.CopyTo(kHost);
+      std::vector<ObjectRef> outs;
+      for (int64_t s = 0; s < num_shards; ++s) {
+        Device dev = vm->devices[vm->ResolveDeviceIndex(s)];
+        NDArray shard = NDArray::Empty(ShapeTuple(shape), src->dtype,
+                                       num_slices == 1 ? dev : staged->device);
+        for (int64_t o = 0; o < num_slices; ++o) {
+          CopyBytes(staged, (o * num_shards + s) * slice_bytes, shard, o * slice_bytes,
+                    slice_bytes);
+        }
+        outs.push_back(num_slices == 1 ? shard : shard.CopyTo(dev));
+      }
+      return ADT(0, outs);
+    });
+
+TVM_REGISTER_GLOBAL("vm.builtin.ccl.send")
+    .set_body_typed([](void* vm_ptr, NDArray src, ShapeTuple peer) -> ObjectRef {
+      VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+      ICHECK_EQ(peer.size(), 1);
+      ObjectRef comm = CommOf(vm_ptr);
+      if (comm.defined()) {
+        // peer: the rank which receives the tensor through vm.builtin.ccl.recv.
+        CCLStreamScope scope(vm, {src->device});
+        CallNCCL(GetCommFunc("comm_send"), scope, comm, src, peer[0]);
+        return src;
+      }
+      // peer: the device of the VM which receives the tensor, which is returned there.
+      Device dev = vm->devices[vm->ResolveDeviceIndex(peer[0])];
+      NDArray dst = NDArray::Empty(ShapeTuple(src->shape, src->shape + src->ndim), src->dtype, dev);
+      if (const PackedFunc* nccl = GetNCCLFunc("send_recv", {src, dst})) {
+        CCLStreamScope scope(vm, {src->device, dst->device});
+        CallNCCL(*nccl, scope, src, dst);
+      } else {
+        dst.CopyFrom(src);
+      }
+      return dst;
+    });
+
+TVM_REGISTER_GLOBAL("vm.builtin.ccl.recv")
+    .set_body_typed([](void* vm_ptr, ShapeTuple shape, DLDataType dtype, ShapeTuple peer) {
+      // Receive the tensor sent by the rank peer through vm.builtin.ccl.send, on the first
+      // device of this process.
+      VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+      ICHECK_EQ(peer.size(), 1);
+      ObjectRef comm = CommOf(vm_ptr);
+      ICHECK(comm.defined()) << "vm.builtin.ccl.recv needs the communicator of a distributed run";
+      NDArray dst = NDArray::Empty(shape, dtype, vm->devices[0]);
+      CCLStreamScope scope(vm, {dst->device});
+      CallNCCL(GetCommFunc("comm_recv"), scope, comm, dst, peer[0]);
+      return dst;
+    });
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/constant_store.cc
+ * \brief A process-wide store of device copies of VM constants.
+ */
+#include "constant_store.h"
+
+#include <tvm/runtime/registry.h>
+
+#include <cstring>
+#include <sstream>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+namespace {
+
+bool SameContent(const DLTensor& lhs, const DLTensor& rhs) {
+  if (lhs.dtype.code != rhs.dtype.code || lhs.dtype.bits != rhs.dtype.bits ||
+      lhs.dtype.lanes != rhs.dtype.lanes || lhs.ndim != rhs.ndim) {
+    return false;
+  }
+  for (int i = 0; i < lhs.ndim; ++i) {
+    if (lhs.shape[i] != rhs.shape[i]) return false;
+  }
+  if (lhs.data == rhs.data) return true;
+  return std::memcmp(lhs.data, rhs.data, GetDataSize(lhs)) == 0;
+}
+
+}  // namespace
+
+ConstantStore* ConstantStore::Global() {
+  // NOTE: explicitly use new to avoid exit-time destruction of global state
+  // Global state will be recycled by OS as the process exits.
+  static auto* inst = new ConstantStore();
+  return inst;
+}
+
+NDArray ConstantStore::CopyTo(const NDArray& src, Device dev) {
+  ICHECK_EQ(src->device.device_type, kDLCPU) << "The constant store only copies host constants";
+  bool same_device =
+      src->device.device_type == dev.device_type && src->device.device_id == dev.device_id;
+  if (!src.IsContiguous()) return same_device ? src : src.CopyTo(dev);
+  size_t hash =
+      String::HashBytes(static_cast<const char*>(src->data), GetDataSize(*src.operator->()));
+  std::lock_guard<std::mutex> lock(mu_);
+  auto range = entries_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const NDArray& copy = it->second.device_copy;
+    if (copy->device.device_type == dev.device_type && copy->device.device_id == dev.device_id &&
+        SameContent(*it->second.host.operator->(), *src.operator->())) {
+      ++num_hits_;
+      return copy;
+    }
+  }
+  Prune();
+  NDArray copy = same_device ? src : src.CopyTo(dev);
+  entries_.emplace(hash, Entry{src, copy});
+  return copy;
+}
+
+void ConstantStore::Prune() {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    // A shared host constant is referenced twice by its entry.
+    int num_store_refs = it->second.device_copy.same_as(it->second.host) ? 2 : 1;
+    if (it->second.device_copy.use_count() == num_store_refs) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+ConstantStoreStats ConstantStore::Stats() {
+  std::lock_guard<std::mutex> lock(mu_);
+  Prune();
+  ConstantStoreStats stats;
+  stats.num_constants = entries_.size();
+  for (const auto& kv : entries_) {
+    stats.total_bytes += GetDataSize(*kv.second.device_copy.operator->());
+  }
+  stats.num_hits = num_hits_;
+  return stats;
+}
+
+TVM_REGISTER_GLOBAL("relax.VMGetSharedConstantStats").set_body_typed([]() {
+  ConstantStoreStats stats = ConstantStore::Global()->Stats();
+  std::ostringstream os;
+  os << "{\"num_constants\": " << stats.num_constants << ", \"total_bytes\": " << stats.total_bytes
+     << ", \"num_hits\": " << stats.num_hits << "}";
+  return String(os.str());
+});
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/runtime/relax_vm/constant_store.h
+ * \brief A process-wide store of device copies of VM constants.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_CONSTANT_STORE_H_
+#define TVM_RUNTIME_RELAX_VM_CONSTANT_STORE_H_
+
+#include <tvm/runtime/ndarray.h>
+
+#include <mutex>
+#include <unordered_map>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*! \brief The statistics of the constant store. */
+struct ConstantStoreStats {
+  /*! \brief The number of device copies held by the store. */
+  size_t num_constants = 0;
+  /*! \brief The total size of the device copies in bytes. */
+  size_t total_bytes = 0;
+  /*! \brief The number of requests served by an existing device copy. */
+  size_t num_hits = 0;
+};
+
+/*!
+ * \brief A process-wide store that lets VMs share device copies of identical constants.
+ *
+ * Host constants are matched by content, so VMs loaded from different executables built from
+ * the same weights upload each weight once per device, and the host constants themselves can be
+ * shared by content. A device copy is dropped once the store holds the only reference to it.
+ */
+class ConstantStore {
+ public:
+  /*! \brief Get the global constant store. */
+  static ConstantStore* Global();
+  /*!
+   * \brief Get a copy of a host constant on the given device.
+   * \param src The host constant.
+   * \param dev The target device.
+   * \return A device copy shared with all other constants of the same content.
+   */
+  NDArray CopyTo(const NDArray& src, Device dev);
+  /*!
+   * \brief Get the host constant shared by all the host constants of the same content, e.g. by the
+   *  VMs running on the host and the BYOC modules initialized with the same weights.
+   * \param src The host constant.
+   * \return The first host constant of the content still alive, src itself if there is none.
+   */
+  NDArray Share(const NDArray& src) { return CopyTo(src, src->device); }
+  /*! \brief Get the statistics of the store. */
+  ConstantStoreStats Stats();
+
+ private:
+  /*! \brief A device copy and the host constant it was made from, the same for a shared one. */
+  struct Entry {
+    NDArray host;
+    NDArray device_copy;
+  };
+  /*! \brief Drop the entries only referenced by the store, the caller must hold the lock. */
+  void Prune();
+
+  std::mutex mu_;
+  /*! \brief The entries, keyed by the content hash of the host constant. */
+  std::unordered_multimap<size_t, Entry> entries_;
+  size_t num_hits_ = 0;
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_CONSTANT_STORE_H_
@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/constant_uploader.cc
+ * \brief The upload of the constants of the VM in the background of its first invocations.
+ */
+#include "constant_uploader.h"
+
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+ConstantUploader::ConstantUploader(std::vector<TVMRetValue>* constants,
+                                   const std::vector<TVMRetValue>& host_constants,
+                                   std::vector<int64_t> order, FCopy fcopy)
+    : constants_(constants),
+      host_constants_(host_constants),
+      order_(std::move(order)),
+      fcopy_(std::move(fcopy)),
+      ready_(new std::atomic<bool>[constants->size()]) {
+  for (size_t i = 0; i < constants->size(); ++i) {
+    ready_[i].store(true, std::memory_order_relaxed);
+  }
+  for (int64_t index : order_) {
+    ready_[index].store(false, std::memory_order_relaxed);
+  }
+  thread_ = std::thread([this]() { Run(); });
+}
+
+ConstantUploader::~ConstantUploader() {
+  stop_.store(true, std::memory_order_relaxed);
+  thread_.join();
+}
+
+void ConstantUploader::Run() {
+  for (int64_t index : order_) {
+    if (stop_.load(std::memory_order_relaxed)) return;
+    try {
+      (*constants_)[index] = fcopy_(host_constants_[index]);
+    } catch (const std::exception& e) {
+      std::lock_guard<std::mutex> lock(mu_);
+      error_ = e.what();
+      cv_.notify_all();
+      return;
+    }
+    {
+      // The lock orders the flag with the check of a waiter about to sleep.
+      std::lock_guard<std::mutex> lock(mu_);
+      ready_[index].store(true, std::memory_order_release);
+    }
+    cv_.notify_all();
+  }
+  done_.store(true, std::memory_order_release);
+}
+
+void ConstantUploader::WaitSlow(int64_t index) {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [&]() {
+    return ready_[index].load(std::memory_order_acquire) || !error_.empty();
+  });
+  if (!ready_[index].load(std::memory_order_acquire)) {
+    LOG(FATAL) << "The upload of the constant " << index << " failed: " << error_;
+  }
+}
+
+void ConstantUploader::WaitAll() {
+  for (int64_t index : order_) Wait(index);
+}
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/constant_uploader.h
+ * \brief The upload of the constants of the VM in the background of its first invocations.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_CONSTANT_UPLOADER_H_
+#define TVM_RUNTIME_RELAX_VM_CONSTANT_UPLOADER_H_
+
+#include <tvm/runtime/packed_func.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief A thread uploading the constants of the VM one by one, so that the first invocation
+ *  waits for each constant as it is used instead of for all of them.
+ *
+ * The slot of a constant in the constant pool is written once by the thread, then marked ready,
+ * so that the VM reads it without a lock afterwards.
+ */
+class ConstantUploader {
+ public:
+  /*! \brief The copy of a host constant to the device. */
+  using FCopy = std::function<TVMRetValue(const TVMRetValue&)>;
+  /*!
+   * \brief Start the upload.
+   * \param constants The constant pool of the VM, whose slots of the uploaded constants are
+   *  written by the thread.
+   * \param host_constants The host constants of the executable.
+   * \param order The indices of the constants to upload, in the order they are uploaded.
+   * \param fcopy The copy of a constant to the device.
+   */
+  ConstantUploader(std::vector<TVMRetValue>* constants,
+                   const std::vector<TVMRetValue>& host_constants, std::vector<int64_t> order,
+                   FCopy fcopy);
+  /*! \brief Stop the upload, and wait for the constant being uploaded. */
+  ~ConstantUploader();
+  /*! \brief Wait for a constant to be uploaded. */
+  void Wait(int64_t index) {
+    if (!ready_[index].load(std::memory_order_acquire)) WaitSlow(index);
+  }
+  /*! \brief Wait for all the constants to be uploaded. */
+  void WaitAll();
+  /*! \brief Whether all the constants are uploaded. */
+  bool Done() const { return done_.load(std::memory_order_acquire); }
+  /*! \brief The indices of the uploaded constants, in the order they are uploaded. */
+  const std::vector<int64_t>& order() const { return order_; }
+
+ private:
+  void Run();
+  void WaitSlow(int64_t index);
+
+  std::vector<TVMRetValue>* constants_;
+  const std::vector<TVMRetValue>& host_constants_;
+  std::vector<int64_t> order_;
+  FCopy fcopy_;
+  /*! \brief Whether each constant of the pool is ready, the ones not uploaded are. */
+  std::unique_ptr<std::atomic<bool>[]> ready_;
+  std::atomic<bool> done_{false};
+  std::atomic<bool> stop_{false};
+  std::mutex mu_;
+  std::condition_variable cv_;
+  /*! \brief The error of the failed upload, guarded by mu_. */
+  std::string error_;
+  std::thread thread_;
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_CONSTANT_UPLOADER_H_
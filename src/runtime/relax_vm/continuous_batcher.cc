@@ -0,0 +1,299 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/continuous_batcher.cc
+ * \brief A server mode of the Relax VM which batches the decode steps of the sequences being
+ *  generated, the sequences joining and leaving the batch at every step.
+ */
+
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paged_kv_cache.h"
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief Generate the tokens of many requests by steps of a VM decode function over a ragged
+ *  batch of the active sequences.
+ *
+ * The decode function takes the paged KV cache, the ShapeTuple of the ids of the sequences of
+ * the batch, the ShapeTuple of their numbers of new tokens, and the int32 new tokens of the
+ * sequences in order, on the host. It appends the keys and the values of the new tokens to the
+ * cache, e.g. with vm.builtin.paged_kv_cache_append, attends through the block table of the
+ * sequences, and returns the int32 next token of every sequence. The first step of a sequence
+ * feeds its whole prompt, the later steps its last token.
+ *
+ * Before every step, the waiting requests join the batch while it has fewer than max_batch_size
+ * sequences and the cache has the blocks of their prompt and of their maximal number of new
+ * tokens, beyond the blocks the active sequences may still take, so a sequence never runs out
+ * of blocks. A sequence leaves the batch after its maximal number of new tokens or its stop
+ * token, freeing its blocks. The VM function and the cache are only used by the worker, so they
+ * should not be used by other threads meanwhile, e.g. pass a session of the VM.
+ */
+class ContinuousBatcher : public ModuleNode {
+ public:
+  ContinuousBatcher(Module vm, std::string func_name, PagedKVCache cache, int64_t max_batch_size)
+      : vm_(vm), func_(vm.GetFunction(func_name)), cache_(cache), max_batch_size_(max_batch_size) {
+    ICHECK(func_ != nullptr) << "ValueError: Unknown function: " << func_name;
+    CHECK_GT(max_batch_size, 0) << "ValueError: the max batch size must be positive";
+    worker_ = std::thread([this]() { this->RunWorker(); });
+  }
+
+  ~ContinuousBatcher() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      shutdown_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+  }
+
+  const char* type_key() const final { return "relax.vm.ContinuousBatcher"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "generate") {
+      // args: the int32 prompt, the maximal number of new tokens, the stop token or -1.
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        *rv = this->Generate(args[0], args[1], args[2]);
+      });
+    } else if (name == "stats") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto average = [](double total, int64_t count) { return count == 0 ? 0.0 : total / count; };
+        std::ostringstream os;
+        os << "{\"num_requests\": " << stats_.num_requests
+           << ", \"num_steps\": " << stats_.num_steps << ", \"num_tokens\": " << stats_.num_tokens
+           << ", \"avg_batch_size\": " << average(stats_.total_batch_size, stats_.num_steps)
+           << ", \"tokens_per_s\": " << average(stats_.num_tokens * 1e6, stats_.total_step_us)
+           << ", \"avg_queue_us\": " << average(stats_.total_queue_us, stats_.num_requests)
+           << "}";
+        *rv = String(os.str());
+      });
+    }
+    return PackedFunc(nullptr);
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /*! \brief A request of the generation of a sequence. */
+  struct Request {
+    std::vector<int32_t> prompt;
+    int64_t max_new_tokens;
+    int64_t stop_token;
+    Clock::time_point arrival;
+    /*! \brief The id of the sequence in the cache, once it joined the batch. */
+    int64_t seq_id{-1};
+    /*! \brief The generated tokens, the prompt fed while empty. */
+    std::vector<int32_t> output;
+    std::promise<NDArray> result;
+  };
+
+  /*! \brief The accumulated statistics, the latencies in microseconds. */
+  struct Stats {
+    int64_t num_requests{0};
+    int64_t num_steps{0};
+    int64_t num_tokens{0};
+    double total_batch_size{0};
+    double total_step_us{0};
+    double total_queue_us{0};
+  };
+
+  NDArray Generate(NDArray prompt, int64_t max_new_tokens, int64_t stop_token) {
+    CHECK(prompt->ndim == 1 && prompt->shape[0] > 0 &&
+          DataType(prompt->dtype) == DataType::Int(32))
+        << "ValueError: the prompt must be a non-empty 1-D int32 tensor";
+    CHECK_GT(max_new_tokens, 0) << "ValueError: the maximal number of new tokens must be positive";
+    if (prompt->device.device_type != kDLCPU) prompt = prompt.CopyTo(Device{kDLCPU, 0});
+    auto request = std::make_unique<Request>();
+    const int32_t* data = static_cast<const int32_t*>(prompt->data);
+    request->prompt.assign(data, data + prompt->shape[0]);
+    request->max_new_tokens = max_new_tokens;
+    request->stop_token = stop_token;
+    request->arrival = Clock::now();
+    std::future<NDArray> result = request->result.get_future();
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      waiting_.push_back(std::move(request));
+    }
+    cv_.notify_all();
+    return result.get();
+  }
+
+  /*! \brief The number of blocks of the cache a request takes at most. */
+  size_t MaxBlocks(const Request& request) const {
+    return cache_->NumBlocks(request.prompt.size() + request.max_new_tokens);
+  }
+
+  /*! \brief Admit the waiting requests which fit in the batch and in the cache. */
+  void Admit() {
+    // The blocks the active sequences may still take.
+    size_t reserved = 0;
+    for (const auto& request : active_) {
+      reserved += MaxBlocks(*request) - cache_->NumBlocks(cache_->Length(request->seq_id));
+    }
+    Clock::time_point now = Clock::now();
+    while (!waiting_.empty() && static_cast<int64_t>(active_.size()) < max_batch_size_) {
+      std::unique_ptr<Request>& request = waiting_.front();
+      size_t num_blocks = MaxBlocks(*request);
+      size_t num_free = static_cast<size_t>(cache_->NumFreeBlocks());
+      if (num_free < reserved + num_blocks) {
+        if (!active_.empty()) break;
+        // The request does not fit even in the empty cache.
+        std::ostringstream os;
+        os << "ValueError: the request takes up to " << num_blocks << " blocks of the KV cache, "
+           << "which only has " << num_free << " free blocks";
+        request->result.set_exception(std::make_exception_ptr(Error(os.str())));
+        waiting_.pop_front();
+        continue;
+      }
+      reserved += num_blocks;
+      request->seq_id = next_seq_id_++;
+      cache_->AddSequence(request->seq_id);
+      stats_.num_requests += 1;
+      stats_.total_queue_us +=
+          std::chrono::duration<double, std::micro>(now - request->arrival).count();
+      active_.push_back(std::move(request));
+      waiting_.pop_front();
+    }
+  }
+
+  void RunWorker() {
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait(lock, [this]() { return shutdown_ || !waiting_.empty() || !active_.empty(); });
+        if (waiting_.empty() && active_.empty()) return;
+        Admit();
+      }
+      if (!active_.empty()) RunStep();
+    }
+  }
+
+  /*! \brief Run a decode step of the active sequences. */
+  void RunStep() {
+    Clock::time_point start = Clock::now();
+    std::vector<int64_t> seq_ids, lengths;
+    std::vector<int32_t> tokens;
+    for (const auto& request : active_) {
+      seq_ids.push_back(request->seq_id);
+      if (request->output.empty()) {
+        tokens.insert(tokens.end(), request->prompt.begin(), request->prompt.end());
+        lengths.push_back(request->prompt.size());
+      } else {
+        tokens.push_back(request->output.back());
+        lengths.push_back(1);
+      }
+    }
+    NDArray next;
+    try {
+      NDArray input = NDArray::Empty({static_cast<int64_t>(tokens.size())}, DataType::Int(32),
+                                     Device{kDLCPU, 0});
+      input.CopyFromBytes(tokens.data(), tokens.size() * sizeof(int32_t));
+      next = func_(cache_, ShapeTuple(seq_ids), ShapeTuple(lengths), input);
+      CHECK(next->ndim == 1 && next->shape[0] == static_cast<int64_t>(active_.size()) &&
+            DataType(next->dtype) == DataType::Int(32))
+          << "ValueError: the decode function must return the int32 next token of every sequence";
+      if (next->device.device_type != kDLCPU) next = next.CopyTo(Device{kDLCPU, 0});
+    } catch (...) {
+      // The step failed for every sequence of the batch.
+      for (auto& request : active_) {
+        cache_->RemoveSequence(request->seq_id);
+        request->result.set_exception(std::current_exception());
+      }
+      active_.clear();
+      return;
+    }
+    const int32_t* next_tokens = static_cast<const int32_t*>(next->data);
+    std::vector<std::unique_ptr<Request>> still_active;
+    for (size_t i = 0; i < active_.size(); ++i) {
+      Request& request = *active_[i];
+      request.output.push_back(next_tokens[i]);
+      if (static_cast<int64_t>(request.output.size()) < request.max_new_tokens &&
+          next_tokens[i] != request.stop_token) {
+        still_active.push_back(std::move(active_[i]));
+        continue;
+      }
+      cache_->RemoveSequence(request.seq_id);
+      int64_t num_tokens = static_cast<int64_t>(request.output.size());
+      NDArray output = NDArray::Empty({num_tokens}, DataType::Int(32), Device{kDLCPU, 0});
+      output.CopyFromBytes(request.output.data(), num_tokens * sizeof(int32_t));
+      request.result.set_value(output);
+    }
+    active_ = std::move(still_active);
+    Clock::time_point end = Clock::now();
+    std::lock_guard<std::mutex> lock(mu_);
+    stats_.num_steps += 1;
+    stats_.num_tokens += seq_ids.size();
+    stats_.total_batch_size += seq_ids.size();
+    stats_.total_step_us += std::chrono::duration<double, std::micro>(end - start).count();
+  }
+
+  /*! \brief The VM module, kept alive while the batcher runs. */
+  Module vm_;
+  /*! \brief The decode function. */
+  PackedFunc func_;
+  /*! \brief The KV cache of the sequences. */
+  PagedKVCache cache_;
+  /*! \brief The maximal number of sequences of a step. */
+  int64_t max_batch_size_;
+  /*! \brief The id of the next sequence. */
+  int64_t next_seq_id_{0};
+  /*! \brief The requests waiting to join the batch. */
+  std::deque<std::unique_ptr<Request>> waiting_;
+  /*! \brief The requests of the batch, only used by the worker. */
+  std::vector<std::unique_ptr<Request>> active_;
+  /*! \brief The statistics. */
+  Stats stats_;
+  /*! \brief Whether the batcher is being destroyed. */
+  bool shutdown_{false};
+  std::mutex mu_;
+  std::condition_variable cv_;
+  /*! \brief The worker thread running the steps. */
+  std::thread worker_;
+};
+
+TVM_REGISTER_GLOBAL("relax.VMContinuousBatcher")
+    .set_body_typed([](Module vm, String func_name, PagedKVCache cache, int64_t max_batch_size) {
+      return Module(make_object<ContinuousBatcher>(vm, func_name, cache, max_batch_size));
+    });
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
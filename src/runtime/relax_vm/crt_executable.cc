@@ -0,0 +1,349 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/crt_executable.cc
+ * \brief Export the Relax VM executables in the flat format run by the CRT.
+ */
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/crt/relax_vm_format.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/executable.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+namespace {
+
+/*! \brief The builtins the CRT interpreter runs. */
+const std::unordered_set<std::string> kCRTBuiltins = {"vm.builtin.alloc_storage",
+                                                      "vm.builtin.alloc_tensor",
+                                                      "vm.builtin.alloc_storage_and_tensor",
+                                                      "vm.builtin.alloc_output_tensor",
+                                                      "vm.builtin.read_if_cond",
+                                                      "vm.builtin.copy"};
+
+/*! \brief The value of a string constant, held either as a C string or as a String. */
+std::string ConstantString(const TVMRetValue& value) {
+  if (value.IsObjectRef<String>()) return value.AsObjectRef<String>();
+  return value.operator std::string();
+}
+
+/*! \brief A growing byte buffer whose sections are aligned from its start. */
+class FlatWriter {
+ public:
+  uint64_t Align(uint64_t alignment) {
+    data_.resize((data_.size() + alignment - 1) / alignment * alignment, '\0');
+    return data_.size();
+  }
+  uint64_t Write(const void* data, size_t size) {
+    uint64_t offset = data_.size();
+    data_.append(static_cast<const char*>(data), size);
+    return offset;
+  }
+  template <typename T>
+  uint64_t WriteArray(const std::vector<T>& values) {
+    uint64_t offset = Align(8);
+    Write(values.data(), values.size() * sizeof(T));
+    return offset;
+  }
+  uint64_t WriteString(const std::string& value) { return Write(value.c_str(), value.size() + 1); }
+  uint64_t size() const { return data_.size(); }
+  std::string& data() { return data_; }
+
+ private:
+  std::string data_;
+};
+
+/*! \brief The exporter of an executable in the format of relax_vm_format.h. */
+class CRTExporter {
+ public:
+  explicit CRTExporter(Executable* exec) : exec_(exec) {}
+
+  std::string Export() {
+    TVMRelaxVMHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = TVM_RELAX_VM_CRT_MAGIC;
+    header.version = TVM_RELAX_VM_CRT_VERSION;
+    header.num_functions = exec_->global_funcs.size();
+    header.num_func_names = exec_->func_names.size();
+    header.num_constants = exec_->constants.size();
+    header.num_instrs = exec_->instr_offset.size();
+    for (const std::string& name : exec_->func_names) {
+      CHECK(exec_->global_map.count(name) || kCRTBuiltins.count(name) ||
+            name.compare(0, 3, "vm.") != 0)
+          << "The CRT Relax VM does not support " << name
+          << ", only static shapes without tuples or closures are supported";
+    }
+    CheckNoRecursion();
+    PlanSlots();
+    header.num_storages = storage_offsets_.size();
+    header.num_tensors = num_tensors_;
+    header.storage_bytes = storage_bytes_;
+
+    FlatWriter w;
+    w.Write(&header, sizeof(header));
+    // The variable-length data are placed after the fixed-size sections, so that their offsets
+    // are patched once the fixed-size sections are laid out.
+    std::vector<TVMRelaxVMFunction> functions;
+    for (const VMFunction& func : exec_->global_funcs) {
+      CHECK(func.kind == VMFuncKind::kVMFunc)
+          << "The CRT Relax VM only interprets bytecode, but " << func.name << " is compiled";
+      TVMRelaxVMFunction record;
+      record.name_offset = WriteHeapString(func.name);
+      record.start_instr = func.start_instr;
+      record.num_args = func.num_args;
+      record.register_file_size = func.register_file_size;
+      header.max_num_registers =
+          std::max<uint32_t>(header.max_num_registers, func.register_file_size);
+      functions.push_back(record);
+    }
+    std::vector<uint64_t> func_names;
+    for (const std::string& name : exec_->func_names) {
+      func_names.push_back(WriteHeapString(name));
+    }
+    std::vector<TVMRelaxVMConstant> constants;
+    for (size_t i = 0; i < exec_->constants.size(); ++i) {
+      constants.push_back(ExportConstant(i));
+    }
+    header.functions_offset = w.WriteArray(functions);
+    header.func_names_offset = w.WriteArray(func_names);
+    header.constants_offset = w.WriteArray(constants);
+    header.instr_offsets_offset = w.WriteArray(exec_->instr_offset);
+    header.slots_offset = w.WriteArray(slots_);
+    header.storage_offsets_offset = w.WriteArray(storage_offsets_);
+    header.code_offset = w.WriteArray(exec_->instr_data);
+    uint64_t heap_offset = w.Align(TVM_RELAX_VM_CRT_ALIGNMENT);
+    w.Write(heap_.data().data(), heap_.size());
+    w.Align(8);
+
+    // Patch the offsets into the heap.
+    std::string& data = w.data();
+    auto* function_records = reinterpret_cast<TVMRelaxVMFunction*>(&data[header.functions_offset]);
+    for (size_t i = 0; i < functions.size(); ++i) {
+      function_records[i].name_offset += heap_offset;
+    }
+    auto* name_offsets = reinterpret_cast<uint64_t*>(&data[header.func_names_offset]);
+    for (size_t i = 0; i < func_names.size(); ++i) {
+      name_offsets[i] += heap_offset;
+    }
+    auto* constant_records = reinterpret_cast<TVMRelaxVMConstant*>(&data[header.constants_offset]);
+    for (size_t i = 0; i < constants.size(); ++i) {
+      uint32_t kind = constant_records[i].kind;
+      if (kind == kTVMRelaxVMConstShape || kind == kTVMRelaxVMConstString ||
+          kind == kTVMRelaxVMConstNDArray) {
+        constant_records[i].value.offset += heap_offset;
+      }
+      if (kind == kTVMRelaxVMConstNDArray) {
+        constant_records[i].data_offset += heap_offset;
+      }
+    }
+    std::memcpy(&data[0], &header, sizeof(header));
+    return data;
+  }
+
+ private:
+  /*! \brief The constant of an argument, which must be a constant of the given kind. */
+  const TVMRetValue& ConstantArg(Index pc, const Instruction::Arg& arg, const char* what) {
+    CHECK_EQ(arg.kind(), Instruction::kConstIdx)
+        << "The CRT Relax VM requires a constant " << what << " at instruction " << pc
+        << ", only static shapes are supported";
+    return exec_->constants[arg.value()];
+  }
+
+  /*!
+   * \brief Check that no function calls itself, directly or through other functions.
+   * \note The storages and the tensors are planned per instruction, so a function must not
+   *  have two active frames, and a tail call must not replace a frame of its own callee.
+   */
+  void CheckNoRecursion() {
+    const std::vector<VMFunction>& funcs = exec_->global_funcs;
+    // The body of a function spans its start to the start of the function laid out next.
+    std::map<Index, Index> func_of_start;
+    for (size_t i = 0; i < funcs.size(); ++i) {
+      if (funcs[i].kind == VMFuncKind::kVMFunc) func_of_start[funcs[i].start_instr] = i;
+    }
+    Index num_instrs = exec_->instr_offset.size();
+    callees_.assign(funcs.size(), {});
+    for (auto it = func_of_start.begin(); it != func_of_start.end(); ++it) {
+      auto next = std::next(it);
+      Index end = next == func_of_start.end() ? num_instrs : next->first;
+      for (Index pc = it->first; pc < end; ++pc) {
+        Instruction instr = exec_->GetInstruction(pc);
+        if (instr.op != Opcode::Call && instr.op != Opcode::TailCall) continue;
+        auto callee = exec_->global_map.find(exec_->func_names[instr.func_idx]);
+        if (callee != exec_->global_map.end()) callees_[it->second].push_back(callee->second);
+      }
+    }
+    std::vector<int> state(funcs.size(), kUnvisited);
+    for (size_t i = 0; i < funcs.size(); ++i) {
+      if (state[i] == kUnvisited) VisitCallees(i, &state);
+    }
+  }
+
+  /*! \brief The visit states of the functions when checking for recursion. */
+  enum { kUnvisited = 0, kVisiting = 1, kVisited = 2 };
+
+  /*! \brief Visit the functions called by a function, failing on a call back into it. */
+  void VisitCallees(Index func, std::vector<int>* state) {
+    (*state)[func] = kVisiting;
+    for (Index callee : callees_[func]) {
+      CHECK_NE((*state)[callee], kVisiting)
+          << "The CRT Relax VM does not support recursion, but " << exec_->global_funcs[func].name
+          << " calls " << exec_->global_funcs[callee].name
+          << " which is still running. The storages and tensors are planned per instruction, "
+          << "so a function can only have one active frame";
+      if ((*state)[callee] == kUnvisited) VisitCallees(callee, state);
+    }
+    (*state)[func] = kVisited;
+  }
+
+  /*! \brief Assign the storages and the tensors of the allocating instructions. */
+  void PlanSlots() {
+    slots_.assign(exec_->instr_offset.size() * 2, -1);
+    for (size_t pc = 0; pc < exec_->instr_offset.size(); ++pc) {
+      Instruction instr = exec_->GetInstruction(pc);
+      if (instr.op != Opcode::Call) continue;
+      const std::string& name = exec_->func_names[instr.func_idx];
+      bool alloc_storage = false;
+      // The index of the shape argument of the allocated tensor, -1 for none.
+      int shape_arg = -1;
+      if (name == "vm.builtin.alloc_storage") {
+        alloc_storage = true;
+        CheckGlobalScope(pc, instr, 4);
+      } else if (name == "vm.builtin.alloc_storage_and_tensor") {
+        alloc_storage = true;
+        shape_arg = 5;
+        CheckGlobalScope(pc, instr, 7);
+      } else if (name == "vm.builtin.alloc_tensor") {
+        shape_arg = 2;
+      } else if (name == "vm.builtin.alloc_output_tensor") {
+        shape_arg = 3;
+      }
+      if (alloc_storage) {
+        ShapeTuple size = ConstantArg(pc, instr.args[1], "storage size").AsObjectRef<ShapeTuple>();
+        CHECK_EQ(size.size(), 1) << "The CRT Relax VM only supports flat storages";
+        slots_[pc * 2] = storage_offsets_.size();
+        storage_offsets_.push_back(storage_bytes_);
+        storage_bytes_ += (size[0] + TVM_RELAX_VM_CRT_ALIGNMENT - 1) /
+                          TVM_RELAX_VM_CRT_ALIGNMENT * TVM_RELAX_VM_CRT_ALIGNMENT;
+      }
+      if (shape_arg >= 0) {
+        ConstantArg(pc, instr.args[shape_arg], "tensor shape").AsObjectRef<ShapeTuple>();
+        slots_[pc * 2 + 1] = num_tensors_++;
+      }
+    }
+  }
+
+  /*! \brief Check the optional memory scope argument of a storage is the global scope. */
+  void CheckGlobalScope(Index pc, const Instruction& instr, Index scope_arg) {
+    if (instr.num_args <= scope_arg) return;
+    std::string scope = ConstantString(ConstantArg(pc, instr.args[scope_arg], "memory scope"));
+    CHECK(scope.empty() || scope == "global")
+        << "The CRT Relax VM only supports the global memory scope, but instruction " << pc
+        << " allocates in " << scope;
+  }
+
+  uint64_t WriteHeapString(const std::string& value) { return heap_.WriteString(value); }
+
+  TVMRelaxVMConstant ExportConstant(size_t index) {
+    const TVMRetValue& value = exec_->constants[index];
+    TVMRelaxVMConstant record;
+    std::memset(&record, 0, sizeof(record));
+    if (value.type_code() == kDLInt || value.type_code() == kDLUInt) {
+      record.kind = kTVMRelaxVMConstInt;
+      record.value.v_int64 = value.operator int64_t();
+    } else if (value.type_code() == kDLFloat) {
+      record.kind = kTVMRelaxVMConstFloat;
+      record.value.v_float64 = value.operator double();
+    } else if (value.type_code() == kTVMDataType) {
+      record.kind = kTVMRelaxVMConstDataType;
+      record.dtype = value.operator DLDataType();
+    } else if (value.type_code() == kTVMStr || value.IsObjectRef<String>()) {
+      record.kind = kTVMRelaxVMConstString;
+      record.value.offset = heap_.WriteString(ConstantString(value));
+    } else if (value.IsObjectRef<ShapeTuple>()) {
+      ShapeTuple shape = value.AsObjectRef<ShapeTuple>();
+      record.kind = kTVMRelaxVMConstShape;
+      record.ndim = shape.size();
+      record.value.offset = heap_.Align(8);
+      heap_.Write(shape.data(), shape.size() * sizeof(int64_t));
+    } else if (value.type_code() == kTVMNDArrayHandle) {
+      NDArray array = value.operator NDArray();
+      if (array->device.device_type != kDLCPU) {
+        array = array.CopyTo(Device{kDLCPU, 0});
+      }
+      CHECK(array.IsContiguous()) << "The NDArray constant " << index << " is not contiguous";
+      record.kind = kTVMRelaxVMConstNDArray;
+      record.ndim = array->ndim;
+      record.dtype = array->dtype;
+      record.value.offset = heap_.Align(8);
+      heap_.Write(array->shape, array->ndim * sizeof(int64_t));
+      record.data_offset = heap_.Align(TVM_RELAX_VM_CRT_ALIGNMENT);
+      heap_.Write(static_cast<const char*>(array->data) + array->byte_offset,
+                  GetDataSize(*array.operator->()));
+    } else {
+      LOG(FATAL) << "The CRT Relax VM does not support the constant " << index << " of type code "
+                 << value.type_code() << ", only static shapes without tuples are supported";
+    }
+    return record;
+  }
+
+  /*! \brief The exported executable. */
+  Executable* exec_;
+  /*! \brief The variable-length data, aligned from its start. */
+  FlatWriter heap_;
+  /*! \brief The storage index and the tensor index of each instruction. */
+  std::vector<int32_t> slots_;
+  /*! \brief The offset of each storage in the storage memory. */
+  std::vector<uint64_t> storage_offsets_;
+  /*! \brief The total size of the storages. */
+  uint64_t storage_bytes_ = 0;
+  /*! \brief The number of tensors. */
+  int32_t num_tensors_ = 0;
+  /*! \brief The bytecode functions called by each function. */
+  std::vector<std::vector<Index>> callees_;
+};
+
+}  // namespace
+
+TVM_REGISTER_GLOBAL("relax.ExecutableExportCRT").set_body([](TVMArgs args, TVMRetValue* rv) {
+  Module mod = args[0];
+  auto* exec = dynamic_cast<Executable*>(mod.operator->());
+  ICHECK(exec != nullptr) << "The module is not a relax Executable";
+  std::string data = CRTExporter(exec).Export();
+  TVMByteArray bytes;
+  bytes.data = data.data();
+  bytes.size = data.size();
+  *rv = bytes;
+});
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,166 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/relax_vm/cuda/cuda_graph_builtin.cc
+ * \brief The CUDA graph capture and replay builtin of the Relax VM.
+ */
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/vm.h>
+
+#include <vector>
+
+#include "../../cuda/cuda_common.h"
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief A VM function captured as a CUDA graph.
+ *
+ *  A CUDA graph bakes in the device pointers of its kernels, so the inputs are copied into
+ *  static buffers owned by the capture before each replay, and every replay writes the same
+ *  output tensors.
+ */
+class CUDAGraphCaptureObj : public Object {
+ public:
+  /*! \brief The static input buffers the graph reads from. */
+  Array<NDArray> static_inputs;
+  /*! \brief The outputs produced by the captured invocation. */
+  ObjectRef outputs;
+  /*!
+   * \brief The storages of the captured invocation, which the graph keeps reading and writing
+   *  on every replay and so must not be freed or reused by the VM.
+   */
+  std::vector<Storage> storages;
+  /*! \brief The device of the captured kernels. */
+  Device device;
+  /*! \brief The stream the graph is captured on and launched on. */
+  TVMStreamHandle stream{nullptr};
+  /*! \brief The instantiated graph. */
+  cudaGraphExec_t graph_exec{nullptr};
+
+  ~CUDAGraphCaptureObj() {
+    if (graph_exec != nullptr) cudaGraphExecDestroy(graph_exec);
+    if (stream != nullptr) TVMStreamFree(device.device_type, device.device_id, stream);
+  }
+
+  static constexpr const char* _type_key = "relax.vm.CUDAGraphCapture";
+  TVM_DECLARE_FINAL_OBJECT_INFO(CUDAGraphCaptureObj, Object);
+};
+
+TVM_REGISTER_OBJECT_TYPE(CUDAGraphCaptureObj);
+
+/*! \brief Invoke a packed function with the given NDArray arguments. */
+TVMRetValue InvokeWithArgs(const PackedFunc& func, const Array<NDArray>& inputs) {
+  std::vector<TVMValue> values(inputs.size());
+  std::vector<int> tcodes(inputs.size());
+  runtime::TVMArgsSetter setter(values.data(), tcodes.data());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    setter(i, inputs[i]);
+  }
+  TVMRetValue ret;
+  func.CallPacked(TVMArgs(values.data(), tcodes.data(), values.size()), &ret);
+  return ret;
+}
+
+/*!
+ * \brief Capture the kernels launched by a VM function into a CUDA graph.
+ * \note The function is run once before the capture so that the allocators and the storage
+ *  cache of the VM can serve every allocation of the captured run without calling into the
+ *  CUDA driver, which is not allowed while capturing. Host-side work of the function, such
+ *  as shape computation, only runs at capture time, so the function must have static shapes.
+ */
+ObjectPtr<CUDAGraphCaptureObj> CaptureCUDAGraph(VirtualMachine* vm, const PackedFunc& func,
+                                                TVMArgs args) {
+  ICHECK_GT(args.size(), 0) << "ValueError: CUDA graph capture requires at least one input "
+                            << "to determine the device";
+  auto entry = make_object<CUDAGraphCaptureObj>();
+  for (int i = 0; i < args.size(); ++i) {
+    NDArray input = args[i];
+    if (i == 0) entry->device = input->device;
+    entry->static_inputs.push_back(input.CopyTo(entry->device));
+  }
+  ICHECK_EQ(entry->device.device_type, kDLCUDA) << "CUDA graph requires CUDA inputs";
+  const Device& dev = entry->device;
+
+  // warm up
+  InvokeWithArgs(func, entry->static_inputs);
+  DeviceAPI::Get(dev)->StreamSync(dev, nullptr);
+
+  TVMStreamCreate(dev.device_type, dev.device_id, &entry->stream);
+  TVMSetStream(dev.device_type, dev.device_id, entry->stream);
+  cudaStream_t stream = static_cast<cudaStream_t>(entry->stream);
+  CUDA_CALL(cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal));
+  {
+    // stop recording also when the captured invocation throws
+    struct RecorderGuard {
+      VirtualMachine* vm;
+      ~RecorderGuard() { vm->SetStorageRecorder(nullptr); }
+    } guard{vm};
+    vm->SetStorageRecorder(&entry->storages);
+    entry->outputs = InvokeWithArgs(func, entry->static_inputs);
+  }
+  cudaGraph_t graph;
+  CUDA_CALL(cudaStreamEndCapture(stream, &graph));
+  TVMSetStream(dev.device_type, dev.device_id, nullptr);
+
+  CUDA_CALL(cudaGraphInstantiate(&entry->graph_exec, graph, nullptr, nullptr, 0));
+  CUDA_CALL(cudaGraphDestroy(graph));
+  return entry;
+}
+
+TVM_REGISTER_GLOBAL("vm.builtin.cuda_graph.run").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // args[0]: vm; args[1]: function name; args[2, 3, ...]: function arguments
+  void* vm_ptr = args[0];
+  VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+  String func_name = args[1];
+  TVMArgs func_args(args.values + 2, args.type_codes + 2, args.size() - 2);
+
+  ObjectRef& slot = vm->BuiltinStateSlot("cuda_graph." + func_name);
+  if (!slot.defined()) {
+    PackedFunc func = vm->GetFunction(func_name, GetObjectPtr<Object>(vm));
+    ICHECK(func != nullptr) << "cannot find function " << func_name;
+    slot = ObjectRef(CaptureCUDAGraph(vm, func, func_args));
+  } else {
+    const auto* entry = slot.as<CUDAGraphCaptureObj>();
+    ICHECK(entry != nullptr);
+    ICHECK_EQ(func_args.size(), entry->static_inputs.size())
+        << "ValueError: Invoking the CUDA graph of " << func_name << " requires "
+        << entry->static_inputs.size() << " inputs but " << func_args.size() << " are provided.";
+    for (int i = 0; i < func_args.size(); ++i) {
+      NDArray input = func_args[i];
+      entry->static_inputs[i].CopyFrom(input);
+    }
+    // the copies run on the default stream while the graph is launched on its own stream
+    DeviceAPI::Get(entry->device)->StreamSync(entry->device, nullptr);
+  }
+
+  const auto* entry = slot.as<CUDAGraphCaptureObj>();
+  cudaStream_t stream = static_cast<cudaStream_t>(entry->stream);
+  CUDA_CALL(cudaGraphLaunch(entry->graph_exec, stream));
+  CUDA_CALL(cudaStreamSynchronize(stream));
+  *rv = entry->outputs;
+});
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,120 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/relax_vm/cuda/stream_ordered_allocator.cc
+ * \brief An allocator of the Relax VM backed by the stream-ordered allocation of CUDA.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/memory_manager.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#include "../../cuda/cuda_common.h"
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+#if CUDART_VERSION >= 11020
+
+/*!
+ * \brief An allocator whose buffers are allocated and freed in the order of the current stream.
+ *
+ *  The buffers come from the default memory pool of the device with cudaMallocAsync and go back
+ *  to it with cudaFreeAsync, both on the current stream of the calling thread, i.e. the compute
+ *  stream while the VM runs. A buffer freed before the kernels using it complete is only reused
+ *  by the work queued after them, so freeing it needs no device sync. The pool keeps the freed
+ *  memory instead of releasing it to the device at every sync.
+ */
+class StreamOrderedAllocator final : public Allocator {
+ public:
+  explicit StreamOrderedAllocator(Device dev) : Allocator(kStreamOrdered), device_(dev) {
+    CHECK_EQ(dev.device_type, kDLCUDA)
+        << "ValueError: the stream ordered allocator only supports CUDA devices";
+    CUDA_CALL(cudaSetDevice(dev.device_id));
+    int supported = 0;
+    CUDA_CALL(cudaDeviceGetAttribute(&supported, cudaDevAttrMemoryPoolsSupported, dev.device_id));
+    CHECK(supported) << "ValueError: the device " << dev.device_id
+                     << " does not support the stream ordered memory allocation";
+    CUDA_CALL(cudaDeviceGetDefaultMemPool(&pool_, dev.device_id));
+    uint64_t threshold = UINT64_MAX;
+    CUDA_CALL(cudaMemPoolSetAttribute(pool_, cudaMemPoolAttrReleaseThreshold, &threshold));
+  }
+
+  Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
+    // The pool aligns the buffers to 256 bytes at least.
+    ICHECK_LE(alignment, 256U) << "The stream ordered allocator aligns buffers to 256 bytes";
+    CUDA_CALL(cudaSetDevice(device_.device_id));
+    Buffer buf;
+    buf.device = device_;
+    buf.size = nbytes;
+    CUDA_CALL(cudaMallocFromPoolAsync(&buf.data, std::max<size_t>(nbytes, 1), pool_,
+                                      CUDAThreadEntry::ThreadLocal()->stream));
+    size_t live = live_bytes_.fetch_add(nbytes, std::memory_order_relaxed) + nbytes;
+    size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    while (live > peak && !peak_bytes_.compare_exchange_weak(peak, live)) {
+    }
+    num_allocs_.fetch_add(1, std::memory_order_relaxed);
+    return buf;
+  }
+
+  void Free(const Buffer& buffer) override {
+    if (FreeScopedBuffer(buffer)) return;
+    CUDA_CALL(cudaSetDevice(device_.device_id));
+    CUDA_CALL(cudaFreeAsync(buffer.data, CUDAThreadEntry::ThreadLocal()->stream));
+    live_bytes_.fetch_sub(buffer.size, std::memory_order_relaxed);
+  }
+
+  AllocatorStats Stats() override {
+    AllocatorStats stats;
+    stats.live_bytes = live_bytes_.load(std::memory_order_relaxed);
+    uint64_t reserved = 0, used = 0;
+    CUDA_CALL(cudaMemPoolGetAttribute(pool_, cudaMemPoolAttrReservedMemCurrent, &reserved));
+    CUDA_CALL(cudaMemPoolGetAttribute(pool_, cudaMemPoolAttrUsedMemCurrent, &used));
+    stats.cached_bytes = reserved > used ? reserved - used : 0;
+    stats.peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+    stats.num_allocs = num_allocs_.load(std::memory_order_relaxed);
+    // The pool does not report which allocations reuse its memory.
+    stats.num_cache_hits = 0;
+    return stats;
+  }
+
+  // The memory pool of the device is shared by the allocators, only the live bytes are its own.
+  size_t HeldBytes() override { return live_bytes_.load(std::memory_order_relaxed); }
+
+ private:
+  Device device_;
+  /*! \brief The default memory pool of the device. */
+  cudaMemPool_t pool_{nullptr};
+  std::atomic<size_t> live_bytes_{0};
+  std::atomic<size_t> peak_bytes_{0};
+  std::atomic<size_t> num_allocs_{0};
+};
+
+TVM_REGISTER_GLOBAL("relax.vm.CreateStreamOrderedAllocator").set_body_typed([](Device dev) {
+  return static_cast<void*>(static_cast<Allocator*>(new StreamOrderedAllocator(dev)));
+});
+
+#endif  // CUDART_VERSION >= 11020
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
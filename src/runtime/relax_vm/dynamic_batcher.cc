@@ -0,0 +1,326 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/dynamic_batcher.cc
+ * \brief A server mode of the Relax VM which batches the requests of many threads.
+ */
+
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief Batch the calls to a VM function whose inputs and outputs share a symbolic leading
+ *  batch dimension.
+ *
+ * Requests submitted by any thread are queued. A worker thread concatenates the inputs of the
+ * queued requests along the batch dimension, until max_batch_size rows are gathered or the timeout
+ * after the arrival of the first request expires, invokes the function once, and scatters the
+ * rows of the outputs back to the requests. The VM function is only called by the worker, so the
+ * VM should not be used by other threads, e.g. pass a session of the VM.
+ */
+class DynamicBatcher : public ModuleNode {
+ public:
+  DynamicBatcher(Module vm, std::string func_name, int64_t max_batch_size, int64_t timeout_us)
+      : vm_(vm),
+        func_(vm.GetFunction(func_name)),
+        max_batch_size_(max_batch_size),
+        timeout_(timeout_us) {
+    ICHECK(func_ != nullptr) << "ValueError: Unknown function: " << func_name;
+    CHECK_GT(max_batch_size, 0) << "ValueError: the max batch size must be positive";
+    CHECK_GE(timeout_us, 0) << "ValueError: the timeout must be non-negative";
+    worker_ = std::thread([this]() { this->RunWorker(); });
+  }
+
+  ~DynamicBatcher() {
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      shutdown_ = true;
+    }
+    cv_.notify_all();
+    worker_.join();
+  }
+
+  const char* type_key() const final { return "relax.vm.DynamicBatcher"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "submit") {
+      // args: the inputs of the request, batched along their leading dimension.
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::vector<NDArray> inputs;
+        for (int i = 0; i < args.size(); ++i) {
+          inputs.push_back(args[i]);
+        }
+        *rv = this->Submit(std::move(inputs));
+      });
+    } else if (name == "stats") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto average = [](double total, int64_t count) { return count == 0 ? 0.0 : total / count; };
+        std::ostringstream os;
+        os << "{\"num_requests\": " << stats_.num_requests
+           << ", \"num_batches\": " << stats_.num_batches
+           << ", \"avg_batch_size\": " << average(stats_.total_rows, stats_.num_batches)
+           << ", \"avg_queue_us\": " << average(stats_.total_queue_us, stats_.num_requests)
+           << ", \"avg_compute_us\": " << average(stats_.total_compute_us, stats_.num_batches)
+           << "}";
+        *rv = String(os.str());
+      });
+    }
+    return PackedFunc(nullptr);
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /*! \brief A request waiting to be batched. */
+  struct Request {
+    std::vector<NDArray> inputs;
+    int64_t num_rows;
+    Clock::time_point arrival;
+    std::promise<ObjectRef> result;
+  };
+
+  /*! \brief The accumulated latencies, in microseconds. */
+  struct Stats {
+    int64_t num_requests{0};
+    int64_t num_batches{0};
+    double total_rows{0};
+    double total_queue_us{0};
+    double total_compute_us{0};
+  };
+
+  ObjectRef Submit(std::vector<NDArray> inputs) {
+    CHECK(!inputs.empty()) << "ValueError: a request must have at least one input";
+    auto request = std::make_unique<Request>();
+    for (const NDArray& input : inputs) {
+      CHECK_GE(input->ndim, 1) << "ValueError: the inputs must have a batch dimension";
+      CHECK_EQ(input->shape[0], inputs[0]->shape[0])
+          << "ValueError: the inputs of a request must have the same batch size";
+    }
+    request->num_rows = inputs[0]->shape[0];
+    CHECK_LE(request->num_rows, max_batch_size_)
+        << "ValueError: the request has " << request->num_rows
+        << " rows, more than the max batch size " << max_batch_size_;
+    request->inputs = std::move(inputs);
+    request->arrival = Clock::now();
+    std::future<ObjectRef> result = request->result.get_future();
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      queue_.push_back(std::move(request));
+    }
+    cv_.notify_all();
+    return result.get();
+  }
+
+  void RunWorker() {
+    while (true) {
+      std::vector<std::unique_ptr<Request>> batch;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait(lock, [this]() { return shutdown_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+        // Wait for more requests until the batch is full or the first request times out.
+        Clock::time_point deadline = queue_.front()->arrival + timeout_;
+        int64_t num_rows = 0;
+        while (true) {
+          while (!queue_.empty() && num_rows + queue_.front()->num_rows <= max_batch_size_ &&
+                 Compatible(batch, *queue_.front())) {
+            num_rows += queue_.front()->num_rows;
+            batch.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+          }
+          if (!queue_.empty() || num_rows == max_batch_size_ || shutdown_ ||
+              !cv_.wait_until(lock, deadline, [this]() { return shutdown_ || !queue_.empty(); })) {
+            break;
+          }
+        }
+      }
+      RunBatch(&batch);
+    }
+  }
+
+  /*! \brief Whether a request can be concatenated with the requests of a batch. */
+  static bool Compatible(const std::vector<std::unique_ptr<Request>>& batch,
+                         const Request& request) {
+    if (batch.empty()) return true;
+    const std::vector<NDArray>& first = batch[0]->inputs;
+    if (first.size() != request.inputs.size()) return false;
+    for (size_t i = 0; i < first.size(); ++i) {
+      const NDArray& a = first[i];
+      const NDArray& b = request.inputs[i];
+      if (a->ndim != b->ndim || DataType(a->dtype) != DataType(b->dtype) ||
+          a->device.device_type != b->device.device_type ||
+          a->device.device_id != b->device.device_id ||
+          !std::equal(a->shape + 1, a->shape + a->ndim, b->shape + 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void RunBatch(std::vector<std::unique_ptr<Request>>* batch) {
+    Clock::time_point start = Clock::now();
+    try {
+      std::vector<NDArray> inputs;
+      if (batch->size() == 1) {
+        inputs = batch->front()->inputs;
+      } else {
+        for (size_t i = 0; i < batch->front()->inputs.size(); ++i) {
+          std::vector<NDArray> parts;
+          for (const auto& request : *batch) parts.push_back(request->inputs[i]);
+          inputs.push_back(Concat(parts));
+        }
+      }
+      std::vector<TVMValue> values(inputs.size());
+      std::vector<int> tcodes(inputs.size());
+      TVMArgsSetter setter(values.data(), tcodes.data());
+      for (size_t i = 0; i < inputs.size(); ++i) {
+        setter(i, inputs[i]);
+      }
+      TVMRetValue ret;
+      func_.CallPacked(TVMArgs(values.data(), tcodes.data(), values.size()), &ret);
+      ObjectRef outputs = ret.operator ObjectRef();
+      std::vector<ObjectRef> results;
+      int64_t row = 0;
+      for (const auto& request : *batch) {
+        results.push_back(batch->size() == 1 ? outputs : Slice(outputs, row, request->num_rows));
+        row += request->num_rows;
+      }
+      for (size_t i = 0; i < batch->size(); ++i) {
+        (*batch)[i]->result.set_value(results[i]);
+      }
+    } catch (...) {
+      for (auto& request : *batch) {
+        request->result.set_exception(std::current_exception());
+      }
+    }
+    Clock::time_point end = Clock::now();
+    std::lock_guard<std::mutex> lock(mu_);
+    stats_.num_batches += 1;
+    stats_.total_compute_us += std::chrono::duration<double, std::micro>(end - start).count();
+    for (const auto& request : *batch) {
+      stats_.num_requests += 1;
+      stats_.total_rows += request->num_rows;
+      stats_.total_queue_us +=
+          std::chrono::duration<double, std::micro>(start - request->arrival).count();
+    }
+  }
+
+  /*! \brief The number of bytes of a row of a tensor, i.e. excluding the batch dimension. */
+  static int64_t RowBytes(const DLTensor* tensor) {
+    int64_t size = (tensor->dtype.bits * tensor->dtype.lanes + 7) / 8;
+    for (int i = 1; i < tensor->ndim; ++i) {
+      size *= tensor->shape[i];
+    }
+    return size;
+  }
+
+  /*! \brief Concatenate tensors along their batch dimension. */
+  static NDArray Concat(const std::vector<NDArray>& parts) {
+    std::vector<int64_t> shape(parts[0]->shape, parts[0]->shape + parts[0]->ndim);
+    shape[0] = 0;
+    for (const NDArray& part : parts) {
+      CHECK(part.IsContiguous()) << "ValueError: the inputs must be contiguous";
+      shape[0] += part->shape[0];
+    }
+    NDArray out = NDArray::Empty(shape, parts[0]->dtype, parts[0]->device);
+    int64_t row_bytes = RowBytes(out.operator->());
+    int64_t row = 0;
+    for (const NDArray& part : parts) {
+      DLTensor dst = *out.operator->();
+      dst.shape = const_cast<int64_t*>(part->shape);
+      dst.byte_offset = row * row_bytes;
+      NDArray::CopyFromTo(part.operator->(), &dst);
+      row += part->shape[0];
+    }
+    return out;
+  }
+
+  /*! \brief Get the rows [begin, begin + num_rows) of the outputs of a batch. */
+  static ObjectRef Slice(const ObjectRef& outputs, int64_t begin, int64_t num_rows) {
+    if (const auto* adt = outputs.as<ADTObj>()) {
+      std::vector<ObjectRef> fields;
+      for (size_t i = 0; i < adt->size; ++i) {
+        fields.push_back(Slice((*adt)[i], begin, num_rows));
+      }
+      return ADT::Tuple(fields);
+    }
+    NDArray batched = Downcast<NDArray>(outputs);
+    CHECK(batched->ndim >= 1 && batched.IsContiguous())
+        << "ValueError: the outputs must be contiguous tensors with a batch dimension";
+    std::vector<int64_t> shape(batched->shape, batched->shape + batched->ndim);
+    shape[0] = num_rows;
+    NDArray out = NDArray::Empty(shape, batched->dtype, batched->device);
+    DLTensor src = *batched.operator->();
+    src.shape = shape.data();
+    src.byte_offset += begin * RowBytes(batched.operator->());
+    NDArray::CopyFromTo(&src, const_cast<DLTensor*>(out.operator->()));
+    return out;
+  }
+
+  /*! \brief The VM module, kept alive while the batcher runs. */
+  Module vm_;
+  /*! \brief The batched VM function. */
+  PackedFunc func_;
+  /*! \brief The maximal number of rows of a batch. */
+  int64_t max_batch_size_;
+  /*! \brief How long the first request of a batch waits for more requests. */
+  std::chrono::microseconds timeout_;
+  /*! \brief The queued requests. */
+  std::deque<std::unique_ptr<Request>> queue_;
+  /*! \brief The latency statistics. */
+  Stats stats_;
+  /*! \brief Whether the batcher is being destroyed. */
+  bool shutdown_{false};
+  std::mutex mu_;
+  std::condition_variable cv_;
+  /*! \brief The worker thread running the batches. */
+  std::thread worker_;
+};
+
+TVM_REGISTER_GLOBAL("relax.VMDynamicBatcher")
+    .set_body_typed([](Module vm, String func_name, int64_t max_batch_size, int64_t timeout_us) {
+      return Module(make_object<DynamicBatcher>(vm, func_name, max_batch_size, timeout_us));
+    });
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
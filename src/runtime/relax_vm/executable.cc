@@ -22,14 +22,30 @@
  */
 
 #include <dmlc/memory_io.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/logging.h>
+#include <tvm/runtime/registry.h>
 #include <tvm/runtime/relax_vm/executable.h>
 #include <tvm/runtime/relax_vm/vm.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 #include <functional>
+#include <map>
+#include <memory>
+#include <set>
 #include <sstream>
 
 #include "../file_utils.h"
+#include "../../support/mapped_file.h"
 
 namespace tvm {
 namespace runtime {
@@ -38,6 +54,25 @@ namespace relax_vm {
 /*! \brief The magic number for the serialized VM bytecode file  */
 constexpr uint64_t kTVMVMBytecodeMagic = 0xD225DE2F4214151D;
 
+/*! \brief The magic number for the bundle file of an executable and its kernel library  */
+constexpr uint64_t kTVMVMBundleMagic = 0xD225DE2F4214151E;
+
+/*! \brief The magic number for the optional debug section after the code section  */
+constexpr uint64_t kTVMVMDebugSectionMagic = 0xD225DE2F4214151F;
+
+/*!
+ * \brief The alignment of the sections of a bundle file. It is a multiple of the page size, so
+ *  the executable section keeps the constant alignment of a standalone executable file.
+ */
+constexpr uint64_t kBundleSectionAlignment = 4096;
+
+/*! \brief Possible kinds of the kernel library of a bundle file */
+enum BundleLibKind : uint64_t {
+  kNoLib = 0,
+  kSystemLib = 1,
+  kSharedLib = 2,
+};
+
 /*! \brief Possible types in the constant pool */
 enum ConstantType : int {
   kNDArray = 0,
@@ -45,30 +80,97 @@ enum ConstantType : int {
   kShapeTuple = 2,
   kString = 3,
   kInt = 4,
+  kAlignedNDArray = 5,
 };
 
+/*!
+ * \brief The alignment of NDArray data in the constant section of a serialized file.
+ * \note The data of an aligned NDArray constant follows its padding and DLTensor header, and
+ *  is aligned relative to the start of the file, so that a mapped file can reference it in place.
+ */
+constexpr uint64_t kConstantAlignment = kAllocAlignment;
+
+/*! \brief The size of the length prefix written in front of the serialized executable. */
+constexpr uint64_t kBinaryPrefixBytes = sizeof(uint64_t);
+
 #define STREAM_CHECK(val, section)                                          \
   ICHECK(val) << "Invalid VM file format in the " << section << " section." \
               << "\n";
 
+using support::MappedFile;
+
+/*!
+ * \brief Load an NDArray whose data lives in a mapped file.
+ * \param strm The stream over the whole mapping, positioned at the DLTensor header.
+ * \param mapped_file The mapping.
+ * \return An NDArray that references the mapping when the data is suitably aligned, and a
+ *  host copy of the data otherwise.
+ */
+NDArray LoadMappedNDArray(dmlc::SeekStream* strm, const std::shared_ptr<MappedFile>& mapped_file) {
+  uint64_t header, reserved;
+  STREAM_CHECK(strm->Read(&header), "constant");
+  STREAM_CHECK(strm->Read(&reserved), "constant");
+  STREAM_CHECK(header == kTVMNDArrayMagic, "constant");
+  Device dev;
+  int ndim;
+  DLDataType dtype;
+  STREAM_CHECK(strm->Read(&dev), "constant");
+  STREAM_CHECK(strm->Read(&ndim), "constant");
+  STREAM_CHECK(strm->Read(&dtype), "constant");
+  ICHECK_EQ(dev.device_type, kDLCPU) << "Invalid DLTensor device: can only save as CPU tensor";
+  std::vector<int64_t> shape(ndim);
+  if (ndim != 0) {
+    STREAM_CHECK(strm->ReadArray(&shape[0], ndim), "constant");
+  }
+  int64_t num_elems = 1;
+  for (int64_t extent : shape) {
+    num_elems *= extent;
+  }
+  int64_t data_byte_size;
+  STREAM_CHECK(strm->Read(&data_byte_size), "constant");
+  STREAM_CHECK(data_byte_size == num_elems * ((dtype.bits + 7) / 8), "constant");
+  size_t offset = strm->Tell();
+  STREAM_CHECK(offset + data_byte_size <= mapped_file->size, "constant");
+  strm->Seek(offset + data_byte_size);
+
+  char* data = mapped_file->data + offset;
+  if (!DMLC_IO_NO_ENDIAN_SWAP || reinterpret_cast<uintptr_t>(data) % kAllocAlignment != 0) {
+    NDArray ret = NDArray::Empty(ShapeTuple(shape), dtype, dev);
+    ret.CopyFromBytes(data, data_byte_size);
+    if (!DMLC_IO_NO_ENDIAN_SWAP) {
+      dmlc::ByteSwap(ret->data, (dtype.bits + 7) / 8, num_elems);
+    }
+    return ret;
+  }
+  return support::ViewMappedNDArray(mapped_file, data, ShapeTuple(shape), dtype);
+}
+
 TVM_REGISTER_OBJECT_TYPE(VMClosureObj);
 
-VMClosure::VMClosure(String func_name, Array<ObjectRef> free_vars) {
-  auto ptr = make_object<VMClosureObj>();
+VMClosure::VMClosure(String func_name, Array<ObjectRef> free_vars, Index func_idx) {
+  auto ptr = make_pooled_object<VMClosureObj>();
   ptr->func_name = func_name;
   ptr->free_vars = std::move(free_vars);
+  ptr->func_idx = func_idx;
   data_ = std::move(ptr);
 }
 
 PackedFunc Executable::GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) {
   if (name == "stats") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->Stats(); });
+  } else if (name == "stats_json") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->StatsJSON(); });
   } else if (name == "as_text") {
     return PackedFunc(
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->AsText(); });
   } else if (name == "as_python") {
     return PackedFunc(
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = this->AsPython(); });
+  } else if (name == "get_source_location") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = this->GetSourceLocation(args[0].operator int64_t());
+    });
   } else if (name == "vm_load_executable") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       ObjectPtr<VirtualMachine> vm = make_object<VirtualMachine>();
@@ -154,6 +256,78 @@ std::string Executable::Stats() const {
   return oss.str();
 }
 
+std::string Executable::StatsJSON() const {
+  // The instructions of a VM function run from its start to the start of the next one.
+  std::vector<const VMFunction*> vm_funcs;
+  for (const VMFunction& func : global_funcs) {
+    if (func.kind == VMFuncKind::kVMFunc) vm_funcs.push_back(&func);
+  }
+  std::sort(vm_funcs.begin(), vm_funcs.end(), [](const VMFunction* a, const VMFunction* b) {
+    return a->start_instr < b->start_instr;
+  });
+  Index num_instrs = static_cast<Index>(instr_offset.size());
+
+  std::map<std::string, Index> func_num_instrs;
+  int64_t peak_storage_bytes = 0;
+  int64_t num_dynamic_storages = 0;
+  for (size_t i = 0; i < vm_funcs.size(); ++i) {
+    Index end = i + 1 < vm_funcs.size() ? vm_funcs[i + 1]->start_instr : num_instrs;
+    func_num_instrs[vm_funcs[i]->name] = end - vm_funcs[i]->start_instr;
+    // A storage lives until its register is killed or the function returns, so the storage
+    // allocated by a function is an upper bound of its live storage.
+    int64_t storage_bytes = 0;
+    for (Index pc = vm_funcs[i]->start_instr; pc < end; ++pc) {
+      Instruction instr = GetInstruction(pc);
+      if (instr.op != Opcode::Call || instr.num_args < 2) continue;
+      const std::string& func_name = func_names[instr.func_idx];
+      if (func_name != "vm.builtin.alloc_storage" &&
+          func_name != "vm.builtin.alloc_storage_and_tensor") {
+        continue;
+      }
+      Instruction::Arg size = instr.args[1];
+      if (size.kind() == Instruction::kConstIdx &&
+          constants[size.value()].IsObjectRef<ShapeTuple>()) {
+        storage_bytes += constants[size.value()].AsObjectRef<ShapeTuple>()[0];
+      } else {
+        ++num_dynamic_storages;
+      }
+    }
+    peak_storage_bytes = std::max(peak_storage_bytes, storage_bytes);
+  }
+
+  std::map<std::string, int64_t> constant_bytes;
+  for (const TVMRetValue& constant : constants) {
+    if (!constant.IsObjectRef<NDArray>()) continue;
+    NDArray array = constant.AsObjectRef<NDArray>();
+    std::ostringstream dev;
+    dev << array->device;
+    constant_bytes[dev.str()] += static_cast<int64_t>(GetDataSize(*array.operator->()));
+  }
+  std::set<std::string> unique_funcs(func_names.begin(), func_names.end());
+
+  std::ostringstream os;
+  auto write_map = [&os](const char* key, const auto& map) {
+    os << "\"" << key << "\": {";
+    for (auto it = map.begin(); it != map.end(); ++it) {
+      if (it != map.begin()) os << ", ";
+      os << "\"" << it->first << "\": " << it->second;
+    }
+    os << "}, ";
+  };
+  std::map<std::string, Index> register_file_size;
+  for (const VMFunction& func : global_funcs) {
+    register_file_size[func.name] = func.register_file_size;
+  }
+  os << "{";
+  write_map("num_instructions", func_num_instrs);
+  write_map("register_file_size", register_file_size);
+  write_map("constant_bytes", constant_bytes);
+  os << "\"num_packed_funcs\": " << unique_funcs.size()
+     << ", \"peak_storage_bytes\": " << peak_storage_bytes
+     << ", \"num_dynamic_storages\": " << num_dynamic_storages << "}";
+  return os.str();
+}
+
 void Executable::SetInstructionData(Index i, Index j, ExecWord val) {
   Index instr_idx = instr_offset[i];
   instr_data[instr_idx + j] = val;
@@ -183,6 +357,21 @@ Instruction Executable::GetInstruction(Index i) const {
       Index false_offset = instr_data[offset + 2];
       return Instruction::If(cond, false_offset);
     }
+    case Opcode::KillRegister: {
+      RegName reg = instr_data[offset + 1];
+      return Instruction::KillRegister(reg);
+    }
+    case Opcode::Move: {
+      RegName dst = instr_data[offset + 1];
+      Instruction::Arg src(instr_data[offset + 2]);
+      return Instruction::Move(src, dst);
+    }
+    case Opcode::TailCall: {
+      Index func_idx = instr_data[offset + 2];
+      Index num_args = instr_data[offset + 3];
+      ExecWord* args = const_cast<ExecWord*>(&instr_data[offset + 4]);
+      return Instruction::TailCall(func_idx, num_args, reinterpret_cast<Instruction::Arg*>(args));
+    }
     default:
       LOG(FATAL) << "should never hit this case: " << static_cast<int>(op);
       break;
@@ -229,6 +418,9 @@ void Executable::SaveToBinary(dmlc::Stream* stream) {
   // Code section.
   SaveCodeSection(&strm);
 
+  // Optional debug section.
+  SaveDebugSection(&strm);
+
   stream->Write(code);
 }
 
@@ -244,31 +436,47 @@ Module Executable::LoadFromBinary(void* stream) {
   std::string code;
   static_cast<dmlc::Stream*>(stream)->Read(&code);
   dmlc::MemoryStringStream strm(&code);
+  return Module(LoadSections(&strm, nullptr));
+}
 
+ObjectPtr<Executable> Executable::LoadSections(dmlc::SeekStream* strm,
+                                               const std::shared_ptr<MappedFile>& mapped_file) {
   ObjectPtr<Executable> exec = make_object<Executable>();
 
   // Load header.
-  LoadHeader(&strm);
+  LoadHeader(strm);
 
   // Global section.
-  exec->LoadGlobalSection(&strm);
+  exec->LoadGlobalSection(strm);
 
   // Constant section.
-  exec->LoadConstantSection(&strm);
+  exec->LoadConstantSection(strm, mapped_file);
 
   // Packedfunc names section.
-  exec->LoadPackedFuncNames(&strm);
+  exec->LoadPackedFuncNames(strm);
 
   // Code section.
-  exec->LoadCodeSection(&strm);
+  exec->LoadCodeSection(strm);
 
-  return Module(exec);
+  // Optional debug section.
+  exec->LoadDebugSection(strm);
+
+  return exec;
 }
 
 TVM_REGISTER_GLOBAL("runtime.module.loadbinary_relax.Executable")
     .set_body_typed(Executable::LoadFromBinary);
 
 Module Executable::LoadFromFile(const std::string& file_name) {
+  // Map the file when possible, so that NDArray constants are referenced in place rather than
+  // read into and copied out of an intermediate buffer.
+  if (std::shared_ptr<MappedFile> mapped_file = MappedFile::Open(file_name)) {
+    dmlc::MemoryFixedSizeStream strm(mapped_file->data, mapped_file->size);
+    uint64_t code_size;
+    STREAM_CHECK(strm.Read(&code_size), "header");
+    STREAM_CHECK(kBinaryPrefixBytes + code_size <= mapped_file->size, "header");
+    return Module(LoadSections(&strm, mapped_file));
+  }
   std::string data;
   runtime::LoadBinaryFromFile(file_name, &data);
   dmlc::MemoryStringStream reader(&data);
@@ -279,12 +487,154 @@ Module Executable::LoadFromFile(const std::string& file_name) {
 TVM_REGISTER_GLOBAL("runtime.module.loadfile_relax.Executable")
     .set_body_typed(Executable::LoadFromFile);
 
+/*! \brief Round \p offset up to the alignment of the sections of a bundle file. */
+inline uint64_t AlignBundleSection(uint64_t offset) {
+  return (offset + kBundleSectionAlignment - 1) / kBundleSectionAlignment *
+         kBundleSectionAlignment;
+}
+
+void Executable::SaveBundle(const std::string& file_name, const std::string& lib_path) {
+  std::string exec_data;
+  {
+    dmlc::MemoryStringStream writer(&exec_data);
+    SaveToBinary(&writer);
+  }
+  uint64_t lib_kind = kNoLib;
+  std::string lib_data;
+  if (lib_path == "system_lib") {
+    lib_kind = kSystemLib;
+  } else if (!lib_path.empty()) {
+    lib_kind = kSharedLib;
+    runtime::LoadBinaryFromFile(lib_path, &lib_data);
+  }
+  // The header fits in the first page, each section starts at an aligned offset.
+  uint64_t exec_offset = kBundleSectionAlignment;
+  uint64_t lib_offset = AlignBundleSection(exec_offset + exec_data.size());
+  std::string data;
+  {
+    dmlc::MemoryStringStream strm(&data);
+    strm.Write(kTVMVMBundleMagic);
+    strm.Write(lib_kind);
+    strm.Write(exec_offset);
+    strm.Write(static_cast<uint64_t>(exec_data.size()));
+    strm.Write(lib_offset);
+    strm.Write(static_cast<uint64_t>(lib_data.size()));
+  }
+  data.resize(exec_offset, '\0');
+  data += exec_data;
+  data.resize(lib_offset, '\0');
+  data += lib_data;
+  // Write a temporary file first, so a process loading the bundle never sees a partial file.
+  std::string tmp_name = file_name + ".tmp";
+  runtime::SaveBinaryToFile(tmp_name, data);
+  if (std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    std::remove(tmp_name.c_str());
+    LOG(FATAL) << "Cannot replace the bundle file " << file_name;
+  }
+}
+
+/*!
+ * \brief Open a shared library held in memory.
+ * \note On Linux, the library is written to an anonymous memory file and opened from it, so
+ *  it never touches the disk. Elsewhere it is written to a temporary file removed once opened.
+ */
+Module LoadSharedLibraryFromMemory(const char* data, size_t size) {
+#if defined(__linux__) && defined(MFD_CLOEXEC)
+  int fd = memfd_create("relax_vm_kernels", MFD_CLOEXEC);
+  if (fd >= 0) {
+    size_t written = 0;
+    while (written < size) {
+      ssize_t n = write(fd, data + written, size - written);
+      if (n <= 0) break;
+      written += static_cast<size_t>(n);
+    }
+    if (written == size) {
+      Module lib = Module::LoadFromFile("/proc/self/fd/" + std::to_string(fd), "so");
+      close(fd);
+      return lib;
+    }
+    close(fd);
+  }
+#endif
+#ifndef _WIN32
+  const char* tmp_dir = std::getenv("TMPDIR");
+  std::string path = std::string(tmp_dir != nullptr ? tmp_dir : "/tmp") + "/relax_vm_XXXXXX.so";
+  int tmp_fd = mkstemps(&path[0], 3);
+  CHECK_GE(tmp_fd, 0) << "Cannot create a temporary file for the bundled kernel library";
+  close(tmp_fd);
+  runtime::SaveBinaryToFile(path, std::string(data, size));
+  Module lib = Module::LoadFromFile(path, "so");
+  std::remove(path.c_str());
+  return lib;
+#else
+  LOG(FATAL) << "Loading a bundled kernel library is not supported on this platform";
+  return Module();
+#endif
+}
+
+Module Executable::LoadBundle(const std::string& file_name) {
+  std::shared_ptr<MappedFile> mapped_file = MappedFile::Open(file_name);
+  std::string buffer;
+  char* base;
+  size_t size;
+  if (mapped_file != nullptr) {
+    base = mapped_file->data;
+    size = mapped_file->size;
+  } else {
+    runtime::LoadBinaryFromFile(file_name, &buffer);
+    base = &buffer[0];
+    size = buffer.size();
+  }
+
+  dmlc::MemoryFixedSizeStream header(base, size);
+  uint64_t magic, lib_kind, exec_offset, exec_size, lib_offset, lib_size;
+  STREAM_CHECK(header.Read(&magic), "bundle header");
+  STREAM_CHECK(magic == kTVMVMBundleMagic, "bundle header");
+  STREAM_CHECK(header.Read(&lib_kind), "bundle header");
+  STREAM_CHECK(header.Read(&exec_offset), "bundle header");
+  STREAM_CHECK(header.Read(&exec_size), "bundle header");
+  STREAM_CHECK(header.Read(&lib_offset), "bundle header");
+  STREAM_CHECK(header.Read(&lib_size), "bundle header");
+  STREAM_CHECK(lib_kind <= kSharedLib, "bundle header");
+  STREAM_CHECK(exec_offset + exec_size <= size && lib_offset + lib_size <= size, "bundle header");
+
+  // The executable section is exactly a standalone executable file, load it in place.
+  std::shared_ptr<MappedFile> exec_file =
+      mapped_file != nullptr ? MappedFile::Slice(mapped_file, exec_offset, exec_size) : nullptr;
+  dmlc::MemoryFixedSizeStream strm(base + exec_offset, exec_size);
+  uint64_t code_size;
+  STREAM_CHECK(strm.Read(&code_size), "header");
+  STREAM_CHECK(kBinaryPrefixBytes + code_size <= exec_size, "header");
+  ObjectPtr<Executable> exec = LoadSections(&strm, exec_file);
+
+  if (lib_kind == kSystemLib) {
+    const PackedFunc* system_lib = runtime::Registry::Get("runtime.SystemLib");
+    ICHECK(system_lib != nullptr) << "runtime.SystemLib is not registered";
+    exec->Import((*system_lib)());
+  } else if (lib_kind == kSharedLib) {
+    exec->Import(LoadSharedLibraryFromMemory(base + lib_offset, lib_size));
+  }
+  return Module(exec);
+}
+
+TVM_REGISTER_GLOBAL("relax.ExecutableSaveBundle")
+    .set_body_typed([](Module mod, String file_name, String lib_path) {
+      auto* exec = dynamic_cast<Executable*>(mod.operator->());
+      ICHECK(exec != nullptr) << "The module is not a relax Executable";
+      exec->SaveBundle(file_name, lib_path);
+    });
+
+TVM_REGISTER_GLOBAL("relax.ExecutableLoadBundle").set_body_typed(Executable::LoadBundle);
+
+TVM_REGISTER_GLOBAL("runtime.module.loadfile_relaxvm").set_body_typed(Executable::LoadBundle);
+
 void SerializeVMFunc(const VMFunction& func, dmlc::Stream* strm) {
   strm->Write(func.name);
   strm->Write(func.start_instr);
   strm->Write(func.num_args);
   strm->Write(func.register_file_size);
   strm->Write(func.param_names);
+  strm->Write(static_cast<int>(func.kind));
 }
 
 VMFunction DeserializeVMFunc(dmlc::Stream* strm) {
@@ -294,6 +644,9 @@ VMFunction DeserializeVMFunc(dmlc::Stream* strm) {
   STREAM_CHECK(strm->Read(&func.num_args), "vmfunc num_args");
   STREAM_CHECK(strm->Read(&func.register_file_size), "vmfunc register_file_size");
   STREAM_CHECK(strm->Read(&func.param_names), "vmfunc params");
+  int kind;
+  STREAM_CHECK(strm->Read(&kind), "vmfunc kind");
+  func.kind = static_cast<VMFuncKind>(kind);
   return func;
 }
 
@@ -304,12 +657,23 @@ void Executable::SaveGlobalSection(dmlc::Stream* strm) {
   }
 }
 
-void Executable::SaveConstantSection(dmlc::Stream* strm) {
+void Executable::SaveConstantSection(dmlc::SeekStream* strm) {
   strm->Write(static_cast<uint64_t>(this->constants.size()));
   for (const auto& it : this->constants) {
     if (it.IsObjectRef<runtime::NDArray>()) {
-      strm->Write(ConstantType::kNDArray);
-      runtime::SaveDLTensor(strm, it.operator DLTensor*());
+      // Pad the DLTensor so that its data is aligned in the saved file, which starts with the
+      // length prefix of the serialized executable.
+      const DLTensor* tensor = it.operator DLTensor*();
+      strm->Write(ConstantType::kAlignedNDArray);
+      uint64_t header_bytes = sizeof(uint64_t) * 2 + sizeof(DLDevice) + sizeof(int) +
+                              sizeof(DLDataType) + sizeof(int64_t) * (tensor->ndim + 1);
+      uint64_t data_offset = kBinaryPrefixBytes + strm->Tell() + sizeof(uint64_t) + header_bytes;
+      uint64_t padding =
+          (kConstantAlignment - data_offset % kConstantAlignment) % kConstantAlignment;
+      strm->Write(padding);
+      std::vector<char> zeros(padding, 0);
+      strm->Write(zeros.data(), padding);
+      runtime::SaveDLTensor(strm, tensor);
     } else if (it.IsObjectRef<ShapeTuple>()) {
       ShapeTuple shape = it.operator ShapeTuple();
       strm->Write(ConstantType::kShapeTuple);
@@ -359,7 +723,8 @@ void Executable::LoadGlobalSection(dmlc::Stream* strm) {
   }
 }
 
-void Executable::LoadConstantSection(dmlc::Stream* strm) {
+void Executable::LoadConstantSection(dmlc::SeekStream* strm,
+                                     const std::shared_ptr<MappedFile>& mapped_file) {
   uint64_t sz;
   // Load the number of constants.
   STREAM_CHECK(strm->Read(&sz, sizeof(sz)), "constant");
@@ -376,6 +741,18 @@ void Executable::LoadConstantSection(dmlc::Stream* strm) {
       TVMRetValue cell;
       cell = ndarray;
       this->constants.push_back(cell);
+    } else if (constant_type == ConstantType::kAlignedNDArray) {
+      uint64_t padding;
+      STREAM_CHECK(strm->Read(&padding), "constant");
+      strm->Seek(strm->Tell() + padding);
+      TVMRetValue cell;
+      if (mapped_file != nullptr) {
+        cell = LoadMappedNDArray(strm, mapped_file);
+      } else {
+        ndarray.Load(strm);
+        cell = ndarray;
+      }
+      this->constants.push_back(cell);
     } else if (constant_type == ConstantType::kShapeTuple) {
       uint64_t size;
       strm->Read(&size);
@@ -426,6 +803,69 @@ void Executable::LoadCodeSection(dmlc::Stream* strm) {
   STREAM_CHECK(strm->Read(&(this->instr_data)), "instr data");
 }
 
+void Executable::SaveDebugSection(dmlc::Stream* strm) {
+  std::lock_guard<std::mutex> lock(debug_mutex_);
+  if (debug_section_.empty()) {
+    if (location_pcs_.empty()) return;
+    dmlc::MemoryStringStream debug_strm(&debug_section_);
+    debug_strm.Write(source_locations_);
+    debug_strm.Write(location_pcs_);
+    debug_strm.Write(location_ids_);
+  }
+  strm->Write(kTVMVMDebugSectionMagic);
+  strm->Write(debug_section_);
+}
+
+void Executable::LoadDebugSection(dmlc::Stream* strm) {
+  // Executables saved without source locations end right after the code section.
+  uint64_t magic;
+  if (!strm->Read(&magic) || magic != kTVMVMDebugSectionMagic) return;
+  STREAM_CHECK(strm->Read(&debug_section_), "debug section");
+}
+
+void Executable::ParseDebugSection() {
+  if (debug_section_.empty() || !location_pcs_.empty()) return;
+  dmlc::MemoryStringStream strm(&debug_section_);
+  STREAM_CHECK(strm.Read(&source_locations_), "debug section");
+  STREAM_CHECK(strm.Read(&location_pcs_), "debug section");
+  STREAM_CHECK(strm.Read(&location_ids_), "debug section");
+  STREAM_CHECK(location_pcs_.size() == location_ids_.size(), "debug section");
+}
+
+void Executable::SetSourceLocation(Index pc, std::string location) {
+  std::lock_guard<std::mutex> lock(debug_mutex_);
+  ParseDebugSection();
+  debug_section_.clear();
+  if (location_index_.empty()) {
+    for (size_t i = 0; i < source_locations_.size(); ++i) {
+      location_index_[source_locations_[i]] = i;
+    }
+  }
+  auto it = location_index_.find(location);
+  if (it == location_index_.end()) {
+    it = location_index_.emplace(location, source_locations_.size()).first;
+    source_locations_.push_back(location);
+  }
+  if (!location_pcs_.empty() && location_pcs_.back() == pc) {
+    location_ids_.back() = it->second;
+  } else {
+    ICHECK(location_pcs_.empty() || location_pcs_.back() < pc)
+        << "The source locations must be recorded in the ascending order of pc, got " << pc
+        << " after " << location_pcs_.back();
+    location_pcs_.push_back(pc);
+    location_ids_.push_back(it->second);
+  }
+}
+
+std::string Executable::GetSourceLocation(Index pc) {
+  std::lock_guard<std::mutex> lock(debug_mutex_);
+  ParseDebugSection();
+  // Find the last run starting at or before pc.
+  auto it = std::upper_bound(location_pcs_.begin(), location_pcs_.end(), pc);
+  if (it == location_pcs_.begin()) return "";
+  return source_locations_[location_ids_[it - location_pcs_.begin() - 1]];
+}
+
 template <typename T>
 std::string StrJoin(T* items, int offset, int cnt, std::string delim = ", ",
                     std::function<std::string(T)> repr = std::to_string) {
@@ -488,6 +928,10 @@ String Executable::AsText() const {
   for (size_t fidx = 0; fidx < this->global_funcs.size(); ++fidx) {
     const VMFunction& gfunc = this->global_funcs[fidx];
     os << "@" << gfunc.name << ":\n";
+    if (gfunc.kind == VMFuncKind::kVMTIRFunc) {
+      os << "  compiled to " << kVMTIRFuncPrefix << gfunc.name << "\n\n";
+      continue;
+    }
     size_t start_instr = gfunc.start_instr;
     size_t end_instr = this->instr_offset.size();
     if ((fidx + 1) < global_funcs.size()) {
@@ -519,6 +963,22 @@ String Executable::AsText() const {
              << instr.false_offset << "\n";
           break;
         }
+        case Opcode::KillRegister: {
+          os << std::setw(6) << std::left << "kill" << RegNameToStr(instr.dst) << "\n";
+          break;
+        }
+        case Opcode::Move: {
+          os << std::setw(6) << std::left << "move" << InstrArgToStr(Instruction::Arg(instr.src))
+             << ", " << RegNameToStr(instr.dst) << "\n";
+          break;
+        }
+        case Opcode::TailCall: {
+          os << std::setw(6) << std::left << "tail" << std::setw(16) << std::left
+             << this->func_names[instr.func_idx] << " in: "
+             << StrJoin<Instruction::Arg>(instr.args, 0, instr.num_args, ", ", InstrArgToStr)
+             << "\n";
+          break;
+        }
         default:
           LOG(FATAL) << "should never hit this case: " << static_cast<int>(instr.op);
           break;
@@ -536,6 +996,10 @@ String Executable::AsPython() const {
   for (size_t fidx = 0; fidx < this->global_funcs.size(); ++fidx) {
     const VMFunction& gfunc = this->global_funcs[fidx];
     os << "with ib.function(\"" << gfunc.name << "\", num_inputs=" << gfunc.num_args << "):\n";
+    if (gfunc.kind == VMFuncKind::kVMTIRFunc) {
+      os << "    pass  # compiled to " << kVMTIRFuncPrefix << gfunc.name << "\n";
+      continue;
+    }
     size_t start_instr = gfunc.start_instr;
     size_t end_instr = this->instr_offset.size();
     if ((fidx + 1) < global_funcs.size()) {
@@ -564,6 +1028,21 @@ String Executable::AsPython() const {
           os << "    ib.emit_if(ib.r(" << instr.cond << "), " << instr.false_offset << ")\n";
           break;
         }
+        case Opcode::KillRegister: {
+          os << "    ib.emit_kill_register(ib.r(" << instr.dst << "))\n";
+          break;
+        }
+        case Opcode::Move: {
+          os << "    ib.emit_move(" << InstrArgToPyStr(Instruction::Arg(instr.src)) << ", ib.r("
+             << instr.dst << "))\n";
+          break;
+        }
+        case Opcode::TailCall: {
+          os << "    ib.emit_tail_call(\"" << this->func_names[instr.func_idx] << "\", args=["
+             << StrJoin<Instruction::Arg>(instr.args, 0, instr.num_args, ", ", InstrArgToPyStr)
+             << "])\n";
+          break;
+        }
         default:
           LOG(FATAL) << "should never hit this case: " << static_cast<int>(instr.op);
           break;
@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/kernel_capture.cc
+ * \brief The capture of the last outputs of selected kernels of the VM into a ring of slots.
+ */
+#include "kernel_capture.h"
+
+#include <tvm/runtime/container/string.h>
+
+#include <algorithm>
+#include <regex>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+KernelCapture::KernelCapture(const std::vector<std::string>& func_names,
+                             const std::string& pattern, size_t capacity)
+    : func_names_(func_names), selected_(func_names.size(), false), ring_(capacity) {
+  ICHECK_GT(capacity, 0U);
+  std::regex regex(pattern);
+  for (size_t i = 0; i < func_names.size(); ++i) {
+    // The builtins of the VM are not kernels.
+    if (func_names[i].rfind("vm.builtin.", 0) == 0) continue;
+    selected_[i] = std::regex_search(func_names[i], regex);
+  }
+}
+
+void KernelCapture::Capture(int64_t func_idx, TVMArgs args) {
+  if (!selected_[func_idx]) return;
+  const DLTensor* output = nullptr;
+  for (int i = args.size() - 1; i >= 0; --i) {
+    if (args.type_codes[i] == kTVMNDArrayHandle || args.type_codes[i] == kTVMDLTensorHandle) {
+      output = args[i];
+      break;
+    }
+  }
+  if (output == nullptr) return;
+  std::lock_guard<std::mutex> lock(mu_);
+  Slot& slot = ring_[next_];
+  const DLTensor* data = slot.data.defined() ? slot.data.operator->() : nullptr;
+  if (data == nullptr || data->ndim != output->ndim ||
+      !std::equal(output->shape, output->shape + output->ndim, data->shape) ||
+      data->dtype.code != output->dtype.code || data->dtype.bits != output->dtype.bits ||
+      data->dtype.lanes != output->dtype.lanes ||
+      data->device.device_type != output->device.device_type ||
+      data->device.device_id != output->device.device_id) {
+    std::vector<int64_t> shape(output->shape, output->shape + output->ndim);
+    slot.data = NDArray::Empty(ShapeTuple(shape), output->dtype, output->device);
+  }
+  slot.data.CopyFrom(output);
+  slot.func_idx = func_idx;
+  next_ = (next_ + 1) % ring_.size();
+  ++num_captured_;
+}
+
+Array<ObjectRef> KernelCapture::Records() {
+  std::lock_guard<std::mutex> lock(mu_);
+  Array<ObjectRef> records;
+  size_t num_records = std::min<size_t>(num_captured_, ring_.size());
+  size_t first = num_captured_ >= static_cast<int64_t>(ring_.size()) ? next_ : 0;
+  for (size_t i = 0; i < num_records; ++i) {
+    const Slot& slot = ring_[(first + i) % ring_.size()];
+    // The slot is overwritten by the later captures.
+    NDArray data = slot.data.CopyTo(slot.data->device);
+    records.push_back(Array<ObjectRef>{String(func_names_[slot.func_idx]), data});
+  }
+  return records;
+}
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
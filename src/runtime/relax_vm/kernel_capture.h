@@ -0,0 +1,92 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/kernel_capture.h
+ * \brief The capture of the last outputs of selected kernels of the VM into a ring of slots.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_KERNEL_CAPTURE_H_
+#define TVM_RUNTIME_RELAX_VM_KERNEL_CAPTURE_H_
+
+#include <tvm/runtime/container/array.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief A ring of the outputs of the last calls to the kernels whose names match a pattern.
+ *
+ * The output of a kernel called by call_tir is its last tensor argument, which is copied into
+ * the oldest slot of the ring. A slot keeps its array while the outputs it receives have the
+ * same shape, dtype and device, so that the steady state allocates no memory.
+ *
+ * \note The capture is safe from any thread, e.g. the kernels of a parallel region.
+ */
+class KernelCapture {
+ public:
+  /*!
+   * \brief Create the capture.
+   * \param func_names The names of the functions of the function table of the VM.
+   * \param pattern The regular expression searched in the names of the captured kernels.
+   * \param capacity The number of slots of the ring.
+   */
+  KernelCapture(const std::vector<std::string>& func_names, const std::string& pattern,
+                size_t capacity);
+  /*!
+   * \brief Capture the output of a call.
+   * \param func_idx The index of the function in the function table.
+   * \param args The arguments of the call.
+   */
+  void Capture(int64_t func_idx, TVMArgs args);
+  /*!
+   * \brief Get the outputs in the ring, from the oldest one.
+   * \return The name of the kernel and a copy of its output for every captured call.
+   */
+  Array<ObjectRef> Records();
+
+ private:
+  struct Slot {
+    int64_t func_idx{-1};
+    NDArray data;
+  };
+
+  std::vector<std::string> func_names_;
+  /*! \brief Whether the function of each index is captured. */
+  std::vector<bool> selected_;
+  std::vector<Slot> ring_;
+  /*! \brief The slot receiving the next output. */
+  size_t next_{0};
+  /*! \brief The number of outputs captured so far. */
+  int64_t num_captured_{0};
+  std::mutex mu_;
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_KERNEL_CAPTURE_H_
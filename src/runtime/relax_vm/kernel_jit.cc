@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/kernel_jit.cc
+ * \brief A runtime tier which specializes the symbolic kernels for their hot shapes.
+ */
+#include "kernel_jit.h"
+
+#include <tvm/runtime/logging.h>
+
+#include <sstream>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+KernelJIT::KernelJIT(PackedFunc compile, int64_t threshold, int64_t max_shapes)
+    : compile_(compile), threshold_(threshold), max_shapes_(max_shapes) {
+  ICHECK(compile_ != nullptr) << "ValueError: the compile function must be defined";
+  CHECK_GT(threshold, 0) << "ValueError: the threshold must be positive";
+  CHECK_GT(max_shapes, 0) << "ValueError: the maximal number of shapes must be positive";
+  worker_ = std::thread([this]() { this->RunWorker(); });
+}
+
+KernelJIT::~KernelJIT() {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+}
+
+PackedFunc KernelJIT::Lookup(const String& kernel, const ShapeTuple& values) {
+  std::lock_guard<std::mutex> lock(mu_);
+  KernelEntry& shapes = kernels_[kernel];
+  auto it = shapes.find(values);
+  if (it == shapes.end()) {
+    if (shapes.size() >= max_shapes_) {
+      ++num_generic_calls_;
+      return nullptr;
+    }
+    it = shapes.emplace(values, ShapeEntry()).first;
+  }
+  ShapeEntry& entry = it->second;
+  if (entry.state == State::kReady) {
+    ++num_specialized_calls_;
+    return entry.func;
+  }
+  ++num_generic_calls_;
+  if (entry.state == State::kCounting && ++entry.num_calls >= threshold_) {
+    entry.state = State::kQueued;
+    queue_.emplace_back(kernel, values);
+    cv_.notify_all();
+  }
+  return nullptr;
+}
+
+void KernelJIT::RunWorker() {
+  while (true) {
+    std::pair<std::string, ShapeTuple> item;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      cv_.wait(lock, [this]() { return shutdown_ || !queue_.empty(); });
+      if (shutdown_) return;
+      item = std::move(queue_.front());
+      queue_.pop_front();
+      compiling_ = true;
+    }
+    // Compile without the lock, so that the calls keep running the generic kernel meanwhile.
+    PackedFunc func;
+    try {
+      func = compile_(item.first, item.second);
+    } catch (const std::exception& e) {
+      LOG(WARNING) << "Failed to specialize kernel " << item.first << ": " << e.what();
+    }
+    std::lock_guard<std::mutex> lock(mu_);
+    ShapeEntry& entry = kernels_[item.first][item.second];
+    entry.func = func;
+    entry.state = func != nullptr ? State::kReady : State::kFailed;
+    compiling_ = false;
+    // Wake up WaitIdle.
+    cv_.notify_all();
+  }
+}
+
+std::vector<std::pair<std::string, ShapeTuple>> KernelJIT::SpecializedShapes() {
+  std::lock_guard<std::mutex> lock(mu_);
+  std::vector<std::pair<std::string, ShapeTuple>> shapes;
+  for (const auto& kv : kernels_) {
+    for (const auto& shape : kv.second) {
+      if (shape.second.state == State::kReady) shapes.emplace_back(kv.first, shape.first);
+    }
+  }
+  return shapes;
+}
+
+void KernelJIT::Preload(const String& kernel, const ShapeTuple& values) {
+  std::lock_guard<std::mutex> lock(mu_);
+  KernelEntry& shapes = kernels_[kernel];
+  auto it = shapes.find(values);
+  if (it == shapes.end()) {
+    if (shapes.size() >= max_shapes_) return;
+    it = shapes.emplace(values, ShapeEntry()).first;
+  }
+  if (it->second.state != State::kCounting) return;
+  it->second.state = State::kQueued;
+  queue_.emplace_back(kernel, values);
+  cv_.notify_all();
+}
+
+void KernelJIT::WaitIdle() {
+  std::unique_lock<std::mutex> lock(mu_);
+  cv_.wait(lock, [this]() { return shutdown_ || (queue_.empty() && !compiling_); });
+}
+
+std::string KernelJIT::Stats() {
+  std::lock_guard<std::mutex> lock(mu_);
+  int64_t num_shapes = 0, num_ready = 0, num_failed = 0;
+  for (const auto& kv : kernels_) {
+    for (const auto& shape : kv.second) {
+      ++num_shapes;
+      num_ready += shape.second.state == State::kReady;
+      num_failed += shape.second.state == State::kFailed;
+    }
+  }
+  std::ostringstream os;
+  os << "{\"num_kernels\": " << kernels_.size() << ", \"num_shapes\": " << num_shapes
+     << ", \"num_specialized\": " << num_ready << ", \"num_failed\": " << num_failed
+     << ", \"num_pending\": " << queue_.size()
+     << ", \"num_specialized_calls\": " << num_specialized_calls_
+     << ", \"num_generic_calls\": " << num_generic_calls_ << "}";
+  return os.str();
+}
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
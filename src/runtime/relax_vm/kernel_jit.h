@@ -0,0 +1,146 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/kernel_jit.h
+ * \brief A runtime tier which specializes the symbolic kernels for their hot shapes.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_KERNEL_JIT_H_
+#define TVM_RUNTIME_RELAX_VM_KERNEL_JIT_H_
+
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/container/string.h>
+#include <tvm/runtime/packed_func.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief Specialize the kernels called by vm.call_tir_dyn for the shapes they are hot on.
+ *
+ * Every call records the values of the symbolic variables of the kernel. Once a kernel has been
+ * called threshold times with the same values, the values are queued for a worker thread, which
+ * compiles a kernel specialized to them with the compile function. Later calls with the same
+ * values run the specialized kernel, which takes the tensor arguments only, while the calls
+ * which come before it is ready keep running the generic kernel.
+ *
+ * The number of distinct shapes recorded per kernel is bounded, so that a long tail of cold
+ * shapes costs neither memory nor compilation.
+ *
+ * \note The JIT is shared by the sessions of a VM, and is safe to call from any thread.
+ */
+class KernelJIT {
+ public:
+  /*!
+   * \brief Constructor.
+   * \param compile The compile function, taking the kernel name and the values of its symbolic
+   *  variables, and returning the specialized kernel, or nullptr if it cannot be specialized.
+   * \param threshold The number of calls after which a shape is hot.
+   * \param max_shapes The maximal number of shapes recorded per kernel.
+   */
+  KernelJIT(PackedFunc compile, int64_t threshold, int64_t max_shapes);
+  /*! \brief Stop the worker, waiting for the compilation in progress. */
+  ~KernelJIT();
+  /*!
+   * \brief Record a call of a kernel.
+   * \param kernel The kernel name.
+   * \param values The values of the symbolic variables of the kernel.
+   * \return The kernel specialized for the values, nullptr if none is ready.
+   */
+  PackedFunc Lookup(const String& kernel, const ShapeTuple& values);
+  /*! \brief Get the statistics of the JIT, as a JSON string. */
+  std::string Stats();
+  /*!
+   * \brief Get the shapes specialized so far, e.g. to warm up the JIT of another process.
+   * \return The kernel names and the values of their symbolic variables.
+   */
+  std::vector<std::pair<std::string, ShapeTuple>> SpecializedShapes();
+  /*!
+   * \brief Queue the specialization of a kernel for a shape, before the shape gets hot.
+   * \param kernel The kernel name.
+   * \param values The values of the symbolic variables of the kernel.
+   */
+  void Preload(const String& kernel, const ShapeTuple& values);
+  /*! \brief Wait until the queued shapes are compiled. */
+  void WaitIdle();
+
+ private:
+  /*! \brief The compilation state of a shape of a kernel. */
+  enum class State : int { kCounting, kQueued, kReady, kFailed };
+
+  /*! \brief The calls of a kernel with one shape. */
+  struct ShapeEntry {
+    int64_t num_calls = 0;
+    State state = State::kCounting;
+    /*! \brief The specialized kernel, defined once the state is kReady. */
+    PackedFunc func;
+  };
+
+  /*! \brief Order the shapes by their values, not by their identity. */
+  struct ShapeLess {
+    bool operator()(const ShapeTuple& lhs, const ShapeTuple& rhs) const {
+      return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+  };
+
+  using KernelEntry = std::map<ShapeTuple, ShapeEntry, ShapeLess>;
+
+  /*! \brief Compile the queued shapes until the JIT is destroyed. */
+  void RunWorker();
+
+  /*! \brief The compile function. */
+  PackedFunc compile_;
+  /*! \brief The number of calls after which a shape is hot. */
+  int64_t threshold_;
+  /*! \brief The maximal number of shapes recorded per kernel. */
+  size_t max_shapes_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  /*! \brief The recorded shapes of each kernel, keyed by kernel name. */
+  std::unordered_map<std::string, KernelEntry> kernels_;
+  /*! \brief The hot shapes waiting for compilation. */
+  std::deque<std::pair<std::string, ShapeTuple>> queue_;
+  /*! \brief The number of calls run by a specialized kernel and by a generic kernel. */
+  int64_t num_specialized_calls_ = 0;
+  int64_t num_generic_calls_ = 0;
+  /*! \brief Whether the worker is compiling a shape. */
+  bool compiling_ = false;
+  /*! \brief Whether the JIT is being destroyed. */
+  bool shutdown_ = false;
+  /*! \brief The worker thread compiling the hot shapes. */
+  std::thread worker_;
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_KERNEL_JIT_H_
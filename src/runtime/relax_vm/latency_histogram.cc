@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file src/runtime/relax_vm/latency_histogram.cc
+ * \brief Lock-free latency histograms of the functions of the VM.
+ */
+#include "latency_histogram.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+int64_t LatencyHistogram::BucketOf(int64_t nanos) {
+  if (nanos < kNumSubBuckets) {
+    return nanos < 0 ? 0 : nanos;
+  }
+  if ((nanos >> kMaxExponent) != 0) {
+    return kNumBuckets - 1;
+  }
+  int exponent = kSubBucketBits;
+  while ((nanos >> (exponent + 1)) != 0) {
+    ++exponent;
+  }
+  int64_t sub_bucket = (nanos >> (exponent - kSubBucketBits)) - kNumSubBuckets;
+  return kNumSubBuckets + (exponent - kSubBucketBits) * kNumSubBuckets + sub_bucket;
+}
+
+int64_t LatencyHistogram::LowerBound(int64_t bucket) {
+  if (bucket < kNumSubBuckets) {
+    return bucket;
+  }
+  int64_t shift = (bucket - kNumSubBuckets) / kNumSubBuckets;
+  int64_t sub_bucket = (bucket - kNumSubBuckets) % kNumSubBuckets;
+  return (kNumSubBuckets + sub_bucket) << shift;
+}
+
+std::string LatencyHistogram::AsJSON() const {
+  std::vector<int64_t> counts(kNumBuckets);
+  int64_t count = 0;
+  for (int64_t i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    count += counts[i];
+  }
+  int64_t sum_nanos = sum_nanos_.load(std::memory_order_relaxed);
+  // A latency is reported as the upper bound of its bucket.
+  auto upper_us = [](int64_t bucket) { return LowerBound(bucket + 1) / 1e3; };
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{\"count\": " << count << ", \"mean_us\": " << (count ? sum_nanos / 1e3 / count : 0.0);
+  const std::pair<const char*, double> percentiles[] = {
+      {"p50_us", 0.5}, {"p90_us", 0.9}, {"p99_us", 0.99}, {"p999_us", 0.999}};
+  for (const auto& p : percentiles) {
+    int64_t rank = static_cast<int64_t>(p.second * count);
+    int64_t seen = 0;
+    int64_t bucket = 0;
+    while (bucket < kNumBuckets - 1 && seen + counts[bucket] <= rank) {
+      seen += counts[bucket++];
+    }
+    os << ", \"" << p.first << "\": " << (count ? upper_us(bucket) : 0.0);
+  }
+  int64_t max_bucket = kNumBuckets - 1;
+  while (max_bucket > 0 && counts[max_bucket] == 0) {
+    --max_bucket;
+  }
+  os << ", \"max_us\": " << (count ? upper_us(max_bucket) : 0.0) << ", \"buckets\": [";
+  bool first = true;
+  for (int64_t i = 0; i < kNumBuckets; ++i) {
+    if (counts[i] != 0) {
+      os << (first ? "" : ", ") << "[" << upper_us(i) << ", " << counts[i] << "]";
+      first = false;
+    }
+  }
+  os << "]}";
+  return os.str();
+}
+
+std::string FunctionLatencyStats::AsJSON() const {
+  std::ostringstream os;
+  os << "{";
+  bool first = true;
+  for (size_t i = 0; i < histograms.size(); ++i) {
+    if (histograms[i].Count() == 0) continue;
+    os << (first ? "" : ", ") << "\"" << names[i] << "\": " << histograms[i].AsJSON();
+    first = false;
+  }
+  os << "}";
+  return os.str();
+}
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file src/runtime/relax_vm/latency_histogram.h
+ * \brief Lock-free latency histograms of the functions of the VM.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_LATENCY_HISTOGRAM_H_
+#define TVM_RUNTIME_RELAX_VM_LATENCY_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief A histogram of latencies in nanoseconds with HDR-style log-linear buckets.
+ *
+ * The latencies below kNumSubBuckets nanoseconds have a bucket each, every larger power of two
+ * is split into kNumSubBuckets linear buckets, so that a bucket is within 1/kNumSubBuckets of
+ * the latencies it counts. Latencies beyond 2^kMaxExponent nanoseconds fall in the last bucket.
+ *
+ * \note Recording takes three relaxed atomic increments, and is safe from any thread.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr int kSubBucketBits = 4;
+  static constexpr int64_t kNumSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kMaxExponent = 40;
+  static constexpr int64_t kNumBuckets =
+      kNumSubBuckets + (kMaxExponent - kSubBucketBits) * kNumSubBuckets;
+
+  LatencyHistogram() : buckets_(new std::atomic<int64_t>[kNumBuckets]) {
+    for (int64_t i = 0; i < kNumBuckets; ++i) {
+      buckets_[i].store(0, std::memory_order_relaxed);
+    }
+  }
+  /*! \brief Record a latency in nanoseconds. */
+  void Record(int64_t nanos) {
+    buckets_[BucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_nanos_.fetch_add(nanos, std::memory_order_relaxed);
+  }
+  /*! \brief The number of latencies recorded. */
+  int64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  /*! \brief The bucket counting a latency. */
+  static int64_t BucketOf(int64_t nanos);
+  /*! \brief The smallest latency counted by a bucket. */
+  static int64_t LowerBound(int64_t bucket);
+  /*!
+   * \brief Get the statistics as a JSON object: the count, the mean, the percentiles and the
+   *  non-empty buckets, in microseconds.
+   * \note The buckets are read one by one while calls are recorded, so that the statistics are
+   *  consistent up to the calls recorded during the read.
+   */
+  std::string AsJSON() const;
+
+ private:
+  std::unique_ptr<std::atomic<int64_t>[]> buckets_;
+  std::atomic<int64_t> count_{0};
+  std::atomic<int64_t> sum_nanos_{0};
+};
+
+/*! \brief The latency histogram of each function of a VM, shared by its sessions. */
+struct FunctionLatencyStats {
+  explicit FunctionLatencyStats(std::vector<std::string> names)
+      : histograms(names.size()), names(std::move(names)) {}
+  /*! \brief The histograms, indexed by function index. */
+  std::vector<LatencyHistogram> histograms;
+  /*! \brief The function names, indexed by function index. */
+  std::vector<std::string> names;
+  /*! \brief Get the statistics of the called functions as a JSON object keyed by name. */
+  std::string AsJSON() const;
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_LATENCY_HISTOGRAM_H_
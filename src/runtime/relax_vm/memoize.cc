@@ -0,0 +1,210 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/memoize.cc
+ * \brief The memoization of the pure functions of the VM across invocations.
+ */
+#include <tvm/runtime/container/array.h>
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/container/string.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/vm.h>
+
+#include <list>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief The outputs of a pure function of the VM keyed by its inputs, evicted in LRU order.
+ *
+ *  The key of a call holds the type and the value of each input, the device, the dtype, the
+ *  shape and the content of a tensor, so that a hit is exact, the content being hashed by the
+ *  lookup. The calls with a tensor larger than kMaxKeyedBytes bypass the cache, as do the ones
+ *  with inputs of other types. The outputs are shared by the calls hitting them.
+ */
+class MemoCacheObj : public Object {
+ public:
+  /*! \brief The maximal size of a tensor keyed by its content. */
+  static constexpr size_t kMaxKeyedBytes = 4096;
+  /*! \brief The maximal number of entries. */
+  int64_t capacity{0};
+  /*!
+   * \brief The memoized function, resolved when the cache is created.
+   * \note It does not hold the VM, which owns the cache.
+   */
+  PackedFunc func;
+  /*! \brief The buffer the keys are built in, reused across the calls. */
+  std::string key_buffer;
+  int64_t num_hits{0};
+  int64_t num_misses{0};
+  int64_t num_bypasses{0};
+  /*! \brief The keys and the outputs of the entries, the most recently used first. */
+  std::list<std::pair<std::string, TVMRetValue>> entries;
+  /*! \brief The entry of each key. */
+  std::unordered_map<std::string, std::list<std::pair<std::string, TVMRetValue>>::iterator> index;
+
+  static constexpr const char* _type_key = "relax.vm.MemoCache";
+  TVM_DECLARE_FINAL_OBJECT_INFO(MemoCacheObj, Object);
+};
+
+TVM_REGISTER_OBJECT_TYPE(MemoCacheObj);
+
+template <typename T>
+static void AppendBytes(std::string* key, const T& value) {
+  key->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/*! \brief Append the key of an object input to \p key, false if it cannot be keyed. */
+static bool AppendObjectKey(const ObjectRef& obj, std::string* key) {
+  AppendBytes(key, obj->type_index());
+  if (const auto* tensor = obj.as<NDArray::Container>()) {
+    const DLTensor& data = tensor->dl_tensor;
+    size_t nbytes = GetDataSize(data);
+    if (nbytes > MemoCacheObj::kMaxKeyedBytes || !IsContiguous(data)) return false;
+    AppendBytes(key, data.device);
+    AppendBytes(key, data.dtype);
+    AppendBytes(key, data.ndim);
+    key->append(reinterpret_cast<const char*>(data.shape), data.ndim * sizeof(int64_t));
+    size_t offset = key->size();
+    key->resize(offset + nbytes);
+    GetRef<NDArray>(tensor).CopyToBytes(&(*key)[offset], nbytes);
+    return true;
+  }
+  if (const auto* shape = obj.as<ShapeTupleObj>()) {
+    AppendBytes(key, shape->size);
+    key->append(reinterpret_cast<const char*>(shape->data), shape->size * sizeof(int64_t));
+    return true;
+  }
+  if (const auto* str = obj.as<StringObj>()) {
+    AppendBytes(key, str->size);
+    key->append(str->data, str->size);
+    return true;
+  }
+  if (const auto* array = obj.as<ArrayNode>()) {
+    AppendBytes(key, array->size());
+    for (const ObjectRef& field : *array) {
+      if (!field.defined() || !AppendObjectKey(field, key)) return false;
+    }
+    return true;
+  }
+  return false;
+}
+
+/*! \brief Append the key of an input to \p key, false if it cannot be keyed. */
+static bool AppendKey(const TVMArgValue& arg, std::string* key) {
+  int type_code = arg.type_code();
+  AppendBytes(key, type_code);
+  switch (type_code) {
+    case kDLInt:
+      AppendBytes(key, arg.operator int64_t());
+      return true;
+    case kDLFloat:
+      AppendBytes(key, arg.operator double());
+      return true;
+    case kTVMNullptr:
+      return true;
+    case kTVMStr: {
+      std::string str = arg;
+      AppendBytes(key, str.size());
+      key->append(str);
+      return true;
+    }
+    case kTVMNDArrayHandle:
+    case kTVMObjectHandle:
+      return AppendObjectKey(arg.operator ObjectRef(), key);
+    default:
+      return false;
+  }
+}
+
+TVM_REGISTER_GLOBAL("vm.builtin.memoize").set_body([](TVMArgs args, TVMRetValue* rv) {
+  // args[0]: vm; args[1]: function name; args[2]: capacity; args[3, ...]: function arguments
+  void* vm_ptr = args[0];
+  VirtualMachine* vm = static_cast<VirtualMachine*>(vm_ptr);
+  String func_name = args[1];
+  int64_t capacity = args[2];
+  TVMArgs func_args(args.values + 3, args.type_codes + 3, args.size() - 3);
+  CHECK_GT(capacity, 0) << "ValueError: The memoization capacity of " << func_name
+                        << " must be positive";
+
+  ObjectRef& slot = vm->CurrentBuiltinStateSlot("memoize.", func_name);
+  if (!slot.defined()) {
+    auto cache = make_object<MemoCacheObj>();
+    cache->capacity = capacity;
+    cache->func = vm->GetFunction(func_name, ObjectPtr<Object>(nullptr));
+    ICHECK(cache->func != nullptr) << "cannot find function " << func_name;
+    slot = ObjectRef(cache);
+  }
+  auto* cache = static_cast<MemoCacheObj*>(const_cast<Object*>(slot.get()));
+  const PackedFunc& func = cache->func;
+
+  // Only a miss copies the key, the call of the function may reenter and reuse the buffer.
+  std::string& key = cache->key_buffer;
+  key.clear();
+  bool keyed = true;
+  for (int i = 0; i < func_args.size() && keyed; ++i) keyed = AppendKey(func_args[i], &key);
+  if (!keyed) {
+    ++cache->num_bypasses;
+    func.CallPacked(func_args, rv);
+    return;
+  }
+  auto it = cache->index.find(key);
+  if (it != cache->index.end()) {
+    ++cache->num_hits;
+    cache->entries.splice(cache->entries.begin(), cache->entries, it->second);
+    *rv = it->second->second;
+    return;
+  }
+  ++cache->num_misses;
+  std::string entry_key = key;
+  TVMRetValue ret;
+  func.CallPacked(func_args, &ret);
+  if (static_cast<int64_t>(cache->entries.size()) == cache->capacity) {
+    cache->index.erase(cache->entries.back().first);
+    cache->entries.pop_back();
+  }
+  cache->entries.emplace_front(entry_key, ret);
+  cache->index.emplace(std::move(entry_key), cache->entries.begin());
+  *rv = ret;
+});
+
+TVM_REGISTER_GLOBAL("relax.VMGetMemoizeStats").set_body_typed([](Module mod, String func_name) {
+  auto* vm = dynamic_cast<VirtualMachine*>(mod.operator->());
+  ICHECK(vm != nullptr) << "ValueError: The module is not a Relax VM";
+  const auto* cache = vm->BuiltinStateSlot("memoize." + func_name).as<MemoCacheObj>();
+  std::ostringstream os;
+  os << "{\"num_entries\": " << (cache != nullptr ? cache->entries.size() : 0)
+     << ", \"num_hits\": " << (cache != nullptr ? cache->num_hits : 0)
+     << ", \"num_misses\": " << (cache != nullptr ? cache->num_misses : 0)
+     << ", \"num_bypasses\": " << (cache != nullptr ? cache->num_bypasses : 0) << "}";
+  return String(os.str());
+});
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -21,23 +21,35 @@
  * \file tvm/runtime/relax_vm/memory_manager.cc
  * \brief Allocate and manage memory for the Relay VM.
  */
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/registry.h>
 #include <tvm/runtime/relax_vm/memory_manager.h>
 
+#include <algorithm>
 #include <memory>
+#include <sstream>
 #include <utility>
 
 #include "naive_allocator.h"
 #include "pooled_allocator.h"
+#include "quota_allocator.h"
+#include "size_class_allocator.h"
 
 namespace tvm {
 namespace runtime {
 namespace relax_vm {
 
+/*! \brief The buffer of an NDArray created by Allocator::Empty, with the allocator to free it. */
+struct AllocatorBuffer {
+  Buffer buffer;
+  Allocator* allocator;
+};
+
 static void BufferDeleter(Object* obj) {
   auto* ptr = static_cast<runtime::NDArray::Container*>(obj);
   ICHECK(ptr->manager_ctx != nullptr);
-  Buffer* buffer = reinterpret_cast<Buffer*>(ptr->manager_ctx);
-  MemoryManager::GetAllocator(buffer->device)->Free(*(buffer));
+  AllocatorBuffer* buffer = reinterpret_cast<AllocatorBuffer*>(ptr->manager_ctx);
+  buffer->allocator->Free(buffer->buffer);
   delete buffer;
   delete ptr;
 }
@@ -55,7 +67,8 @@ void StorageObj::Deleter(Object* obj) {
   // reference count from allocation.
   StorageObj* storage = reinterpret_cast<StorageObj*>(ptr->manager_ctx);
   storage->DecRef();
-  delete ptr;
+  ptr->~Container();
+  runtime::PoolObjAllocator::Free(ptr, sizeof(runtime::NDArray::Container));
 }
 
 inline void VerifyDataType(DLDataType dtype) {
@@ -78,10 +91,22 @@ inline size_t GetDataAlignment(const DLTensor& arr) {
 
 runtime::NDArray StorageObj::AllocNDArray(uint64_t offset, ShapeTuple shape, DLDataType dtype) {
   VerifyDataType(dtype);
+  if (!this->buffer.mem_scope.empty() && this->buffer.shape.size() != 1) {
+    // The buffer is laid out for one tensor by the device, it cannot be sliced. A 1-D buffer
+    // is flat memory of the scope, e.g. the VTCM, which holds any tensor fitting in it.
+    const ShapeTuple& buffer_shape = this->buffer.shape;
+    ICHECK(offset == 0 && shape.size() == buffer_shape.size() &&
+           std::equal(shape.begin(), shape.end(), buffer_shape.begin()))
+        << "A storage of the memory scope " << this->buffer.mem_scope
+        << " holds a single tensor of its shape at offset 0, but a tensor of another shape at "
+        << "offset " << offset << " is requested";
+  }
 
   // critical zone: allocate header, cannot throw
+  // The header is allocated on every alloc_tensor of the VM, so it comes from the object pool.
+  void* header = runtime::PoolObjAllocator::Alloc(sizeof(runtime::NDArray::Container));
   runtime::NDArray::Container* container =
-      new runtime::NDArray::Container(nullptr, shape, dtype, this->buffer.device);
+      new (header) runtime::NDArray::Container(nullptr, shape, dtype, this->buffer.device);
 
   container->SetDeleter(StorageObj::Deleter);
   size_t needed_size = runtime::GetDataSize(container->dl_tensor);
@@ -117,42 +142,88 @@ MemoryManager* MemoryManager::Global() {
   return inst;
 }
 
+std::atomic<Allocator*>* MemoryManager::TableSlot(Device dev) {
+  int device_type = static_cast<int>(dev.device_type);
+  if (device_type < 0 || device_type >= kMaxDeviceTypes || dev.device_id < 0 ||
+      dev.device_id >= kMaxDeviceIds) {
+    return nullptr;
+  }
+  return &table_[device_type][dev.device_id];
+}
+
+static void WarnAllocatorType(Device dev, Allocator* alloc, AllocatorType type) {
+  if (alloc->type() != type) {
+    LOG(WARNING) << "The type of existing allocator for " << runtime::DeviceName(dev.device_type)
+                 << "(" << dev.device_id << ") is different from the request type ("
+                 << alloc->type() << " vs " << type << ")";
+  }
+}
+
+std::unique_ptr<Allocator> MemoryManager::CreateAllocator(Device dev, AllocatorType type) {
+  std::unique_ptr<Allocator> alloc;
+  switch (type) {
+    case kNaive: {
+      DLOG(INFO) << "New naive allocator for " << runtime::DeviceName(dev.device_type) << "("
+                 << dev.device_id << ")";
+      alloc.reset(new NaiveAllocator(dev));
+      break;
+    }
+    case kPooled: {
+      DLOG(INFO) << "New pooled allocator for " << runtime::DeviceName(dev.device_type) << "("
+                 << dev.device_id << ")";
+      alloc.reset(new PooledAllocator(dev));
+      break;
+    }
+    case kSizeClass: {
+      DLOG(INFO) << "New size class allocator for " << runtime::DeviceName(dev.device_type) << "("
+                 << dev.device_id << ")";
+      alloc.reset(new SizeClassAllocator(dev));
+      break;
+    }
+    case kStreamOrdered: {
+      DLOG(INFO) << "New stream ordered allocator for " << runtime::DeviceName(dev.device_type)
+                 << "(" << dev.device_id << ")";
+      // The allocator is registered by the CUDA runtime.
+      const PackedFunc* fcreate = Registry::Get("relax.vm.CreateStreamOrderedAllocator");
+      CHECK(fcreate != nullptr) << "ValueError: the stream ordered allocator requires TVM to be "
+                                << "built with CUDA 11.2 or later";
+      alloc.reset(static_cast<Allocator*>((*fcreate)(dev).operator void*()));
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unknown allocator type: " << type;
+  }
+  return alloc;
+}
+
 Allocator* MemoryManager::GetOrCreateAllocator(Device dev, AllocatorType type) {
   MemoryManager* m = MemoryManager::Global();
+  std::atomic<Allocator*>* slot = m->TableSlot(dev);
+  if (slot != nullptr) {
+    if (Allocator* alloc = slot->load(std::memory_order_acquire)) {
+      WarnAllocatorType(dev, alloc, type);
+      return alloc;
+    }
+  }
   std::lock_guard<std::mutex> lock(m->mutex_);
   if (m->allocators_.find(dev) == m->allocators_.end()) {
-    std::unique_ptr<Allocator> alloc;
-    switch (type) {
-      case kNaive: {
-        DLOG(INFO) << "New naive allocator for " << runtime::DeviceName(dev.device_type) << "("
-                   << dev.device_id << ")";
-        alloc.reset(new NaiveAllocator(dev));
-        break;
-      }
-      case kPooled: {
-        DLOG(INFO) << "New pooled allocator for " << runtime::DeviceName(dev.device_type) << "("
-                   << dev.device_id << ")";
-        alloc.reset(new PooledAllocator(dev));
-        break;
-      }
-      default:
-        LOG(FATAL) << "Unknown allocator type: " << type;
-    }
+    std::unique_ptr<Allocator> alloc = CreateAllocator(dev, type);
     auto ret = alloc.get();
     m->allocators_.emplace(dev, std::move(alloc));
+    if (slot != nullptr) slot->store(ret, std::memory_order_release);
     return ret;
   }
   auto alloc = m->allocators_.at(dev).get();
-  if (alloc->type() != type) {
-    LOG(WARNING) << "The type of existing allocator for " << runtime::DeviceName(dev.device_type)
-                 << "(" << dev.device_id << ") is different from the request type ("
-                 << alloc->type() << " vs " << type << ")";
-  }
+  WarnAllocatorType(dev, alloc, type);
   return alloc;
 }
 
 Allocator* MemoryManager::GetAllocator(Device dev) {
   MemoryManager* m = MemoryManager::Global();
+  std::atomic<Allocator*>* slot = m->TableSlot(dev);
+  if (slot != nullptr) {
+    if (Allocator* alloc = slot->load(std::memory_order_acquire)) return alloc;
+  }
   std::lock_guard<std::mutex> lock(m->mutex_);
   auto it = m->allocators_.find(dev);
   if (it == m->allocators_.end()) {
@@ -162,6 +233,33 @@ Allocator* MemoryManager::GetAllocator(Device dev) {
   return it->second.get();
 }
 
+Allocator* MemoryManager::GetOrCreateTenantAllocator(const std::string& tenant, Device dev,
+                                                     AllocatorType type, size_t quota_bytes,
+                                                     bool hard) {
+  MemoryManager* m = MemoryManager::Global();
+  std::lock_guard<std::mutex> lock(m->mutex_);
+  std::unique_ptr<Allocator>& alloc = m->tenant_allocators_[tenant][dev];
+  if (alloc == nullptr) {
+    alloc.reset(new QuotaAllocator(CreateAllocator(dev, type), tenant, dev, quota_bytes, hard));
+  } else {
+    WarnAllocatorType(dev, alloc.get(), type);
+    static_cast<QuotaAllocator*>(alloc.get())->SetQuota(quota_bytes, hard);
+  }
+  return alloc.get();
+}
+
+Allocator* MemoryManager::GetTenantAllocator(const std::string& tenant, Device dev) {
+  MemoryManager* m = MemoryManager::Global();
+  std::lock_guard<std::mutex> lock(m->mutex_);
+  auto it = m->tenant_allocators_.find(tenant);
+  if (it == m->tenant_allocators_.end() || it->second.count(dev) == 0) {
+    LOG(FATAL) << "Allocator of the tenant " << tenant << " for "
+               << runtime::DeviceName(dev.device_type) << "(" << dev.device_id
+               << ") has not been created yet.";
+  }
+  return it->second.at(dev).get();
+}
+
 runtime::NDArray Allocator::Empty(std::vector<int64_t> shape, DLDataType dtype, DLDevice dev) {
   VerifyDataType(dtype);
   runtime::NDArray::Container* container =
@@ -169,13 +267,88 @@ runtime::NDArray Allocator::Empty(std::vector<int64_t> shape, DLDataType dtype,
   container->SetDeleter(BufferDeleter);
   size_t size = runtime::GetDataSize(container->dl_tensor);
   size_t alignment = GetDataAlignment(container->dl_tensor);
-  Buffer* buffer = new Buffer;
-  *buffer = this->Alloc(size, alignment, dtype);
+  AllocatorBuffer* buffer = new AllocatorBuffer{this->Alloc(size, alignment, dtype), this};
   container->manager_ctx = reinterpret_cast<void*>(buffer);
-  container->dl_tensor.data = buffer->data;
+  container->dl_tensor.data = buffer->buffer.data;
   return runtime::NDArray(runtime::GetObjectPtr<Object>(container));
 }
 
+Buffer Allocator::Alloc(Device dev, ShapeTuple shape, DLDataType type_hint,
+                        const std::string& mem_scope) {
+  VerifyDataType(type_hint);
+  DLTensor temp;
+  temp.ndim = static_cast<int>(shape.size());
+  temp.shape = const_cast<int64_t*>(shape.data());
+  temp.strides = nullptr;
+  temp.dtype = type_hint;
+  size_t size = runtime::GetDataSize(temp);
+  if (mem_scope.empty() || mem_scope == "global") {
+    return this->Alloc(size, GetDataAlignment(temp), type_hint);
+  }
+  Buffer buf;
+  buf.device = dev;
+  buf.size = size;
+  buf.mem_scope = mem_scope;
+  buf.shape = shape;
+  buf.data = DeviceAPI::Get(dev)->AllocDataSpace(dev, temp.ndim, temp.shape, type_hint,
+                                                 String(mem_scope));
+  return buf;
+}
+
+bool Allocator::FreeScopedBuffer(const Buffer& buffer) {
+  if (buffer.mem_scope.empty()) return false;
+  DeviceAPI::Get(buffer.device)->FreeDataSpace(buffer.device, buffer.data);
+  return true;
+}
+
+TVM_REGISTER_GLOBAL("relax.VMAllocatorEmpty")
+    .set_body_typed([](ShapeTuple shape, DataType dtype, Device dev) {
+      return NDArray::Empty(shape, dtype, dev, MemoryManager::GetOrCreateAllocator(dev, kPooled));
+    });
+
+/*! \brief Print the statistics of an allocator as the fields of a JSON object. */
+static void PrintStats(std::ostream& os, const AllocatorStats& stats) {
+  double hit_rate = stats.num_allocs == 0 ? 0.0
+                                          : static_cast<double>(stats.num_cache_hits) /
+                                                static_cast<double>(stats.num_allocs);
+  os << "\"live_bytes\": " << stats.live_bytes << ", \"cached_bytes\": " << stats.cached_bytes
+     << ", \"peak_bytes\": " << stats.peak_bytes << ", \"num_allocs\": " << stats.num_allocs
+     << ", \"num_cache_hits\": " << stats.num_cache_hits << ", \"hit_rate\": " << hit_rate;
+}
+
+TVM_REGISTER_GLOBAL("relax.VMGetAllocatorStats")
+    .set_body_typed([](int device_type, int device_id) {
+      Device dev{static_cast<DLDeviceType>(device_type), device_id};
+      std::ostringstream os;
+      os << "{";
+      PrintStats(os, MemoryManager::GetAllocator(dev)->Stats());
+      os << "}";
+      return String(os.str());
+    });
+
+TVM_REGISTER_GLOBAL("relax.VMGetTenantAllocatorStats")
+    .set_body_typed([](String tenant, int device_type, int device_id) {
+      Device dev{static_cast<DLDeviceType>(device_type), device_id};
+      auto* alloc = static_cast<QuotaAllocator*>(MemoryManager::GetTenantAllocator(tenant, dev));
+      std::ostringstream os;
+      os << "{";
+      PrintStats(os, alloc->Stats());
+      os << ", \"held_bytes\": " << alloc->HeldBytes() << ", \"quota_bytes\": "
+         << alloc->quota_bytes() << ", \"num_evictions\": " << alloc->num_evictions()
+         << ", \"num_exceeded\": " << alloc->num_exceeded() << "}";
+      return String(os.str());
+    });
+
+TVM_REGISTER_GLOBAL("relax.VMSetAllocatorCacheLimit")
+    .set_body_typed([](int device_type, int device_id, int64_t cache_limit) {
+      Device dev{static_cast<DLDeviceType>(device_type), device_id};
+      Allocator* alloc = MemoryManager::GetAllocator(dev);
+      CHECK_EQ(alloc->type(), kSizeClass)
+          << "ValueError: only the size class allocator supports a cache limit";
+      CHECK_GE(cache_limit, 0) << "ValueError: the cache limit must be non-negative";
+      static_cast<SizeClassAllocator*>(alloc)->SetCacheLimit(static_cast<size_t>(cache_limit));
+    });
+
 }  // namespace relax_vm
 }  // namespace runtime
 }  // namespace tvm
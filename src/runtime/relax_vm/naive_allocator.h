@@ -42,19 +42,34 @@ class NaiveAllocator final : public Allocator {
     buf.size = nbytes;
     buf.data =
         runtime::DeviceAPI::Get(device_)->AllocDataSpace(device_, nbytes, alignment, type_hint);
-    used_memory_.fetch_add(nbytes, std::memory_order_relaxed);
+    size_t used = used_memory_.fetch_add(nbytes, std::memory_order_relaxed) + nbytes;
+    size_t peak = peak_memory_.load(std::memory_order_relaxed);
+    while (used > peak && !peak_memory_.compare_exchange_weak(peak, used)) {
+    }
+    num_allocs_.fetch_add(1, std::memory_order_relaxed);
     DLOG(INFO) << "allocate " << nbytes << " B, used memory " << used_memory_ << " B";
     return buf;
   }
 
   void Free(const Buffer& buffer) override {
+    if (FreeScopedBuffer(buffer)) return;
     runtime::DeviceAPI::Get(device_)->FreeDataSpace(buffer.device, buffer.data);
     used_memory_.fetch_sub(buffer.size, std::memory_order_relaxed);
     DLOG(INFO) << "free " << buffer.size << " B, used memory " << used_memory_ << " B";
   }
 
+  AllocatorStats Stats() override {
+    AllocatorStats stats;
+    stats.live_bytes = used_memory_.load(std::memory_order_relaxed);
+    stats.peak_bytes = peak_memory_.load(std::memory_order_relaxed);
+    stats.num_allocs = num_allocs_.load(std::memory_order_relaxed);
+    return stats;
+  }
+
  private:
   std::atomic<size_t> used_memory_;
+  std::atomic<size_t> peak_memory_{0};
+  std::atomic<size_t> num_allocs_{0};
   Device device_;
 };
 
@@ -0,0 +1,250 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/nccl/nccl.cc
+ * \brief The NCCL backend of the collective communication builtins of the Relax VM.
+ */
+#include <nccl.h>
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/container/string.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../../cuda/cuda_common.h"
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+#define NCCL_CALL(func)                                                  \
+  {                                                                      \
+    ncclResult_t e = (func);                                             \
+    ICHECK(e == ncclSuccess) << "NCCL error: " << ncclGetErrorString(e); \
+  }
+
+/*! \brief The communicators among a group of CUDA devices, created once per group. */
+class NCCLComms {
+ public:
+  static const std::vector<ncclComm_t>& Get(const std::vector<int>& device_ids) {
+    static NCCLComms* inst = new NCCLComms();
+    std::lock_guard<std::mutex> lock(inst->mutex_);
+    auto it = inst->comms_.find(device_ids);
+    if (it == inst->comms_.end()) {
+      std::vector<ncclComm_t> comms(device_ids.size());
+      NCCL_CALL(ncclCommInitAll(comms.data(), comms.size(), device_ids.data()));
+      it = inst->comms_.emplace(device_ids, comms).first;
+    }
+    return it->second;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::vector<int>, std::vector<ncclComm_t>> comms_;
+};
+
+ncclDataType_t NCCLDataType(DLDataType dtype) {
+  DataType t(dtype);
+  if (t == DataType::Float(16)) return ncclFloat16;
+  if (t == DataType::Float(32)) return ncclFloat32;
+  if (t == DataType::Float(64)) return ncclFloat64;
+  if (t == DataType::Int(8)) return ncclInt8;
+  if (t == DataType::UInt(8)) return ncclUint8;
+  if (t == DataType::Int(32)) return ncclInt32;
+  if (t == DataType::Int(64)) return ncclInt64;
+  LOG(FATAL) << "NCCL does not support " << t;
+  return ncclFloat32;
+}
+
+std::vector<NDArray> AsShards(const ADT& group, std::vector<int>* device_ids) {
+  std::vector<NDArray> shards;
+  for (size_t i = 0; i < group.size(); ++i) {
+    shards.push_back(Downcast<NDArray>(group[i]));
+    device_ids->push_back(shards.back()->device.device_id);
+  }
+  return shards;
+}
+
+size_t NumElements(const NDArray& tensor) {
+  return GetDataSize(*tensor.operator->()) / (tensor->dtype.bits / 8);
+}
+
+/*! \brief The stream of the i-th device, passed after the given number of tensor arguments. */
+cudaStream_t StreamArg(const TVMArgs& args, int num_tensor_args, int i) {
+  return static_cast<cudaStream_t>(args[num_tensor_args + i].operator void*());
+}
+
+// The functions of a single process take the streams of the devices after the tensors.
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.allreduce").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::vector<int> device_ids;
+  std::vector<NDArray> shards = AsShards(args[0], &device_ids);
+  const std::vector<ncclComm_t>& comms = NCCLComms::Get(device_ids);
+  NCCL_CALL(ncclGroupStart());
+  for (size_t i = 0; i < shards.size(); ++i) {
+    CUDA_CALL(cudaSetDevice(device_ids[i]));
+    NCCL_CALL(ncclAllReduce(shards[i]->data, shards[i]->data, NumElements(shards[i]),
+                            NCCLDataType(shards[i]->dtype), ncclSum, comms[i],
+                            StreamArg(args, 1, i)));
+  }
+  NCCL_CALL(ncclGroupEnd());
+});
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.allgather").set_body([](TVMArgs args, TVMRetValue* rv) {
+  std::vector<int> device_ids;
+  std::vector<NDArray> shards = AsShards(args[0], &device_ids);
+  ADT outs = args[1];
+  const std::vector<ncclComm_t>& comms = NCCLComms::Get(device_ids);
+  NCCL_CALL(ncclGroupStart());
+  for (size_t i = 0; i < shards.size(); ++i) {
+    CUDA_CALL(cudaSetDevice(device_ids[i]));
+    NDArray out = Downcast<NDArray>(outs[i]);
+    NCCL_CALL(ncclAllGather(shards[i]->data, out->data, NumElements(shards[i]),
+                            NCCLDataType(shards[i]->dtype), comms[i], StreamArg(args, 2, i)));
+  }
+  NCCL_CALL(ncclGroupEnd());
+});
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.send_recv").set_body([](TVMArgs args, TVMRetValue* rv) {
+  NDArray src = args[0];
+  NDArray dst = args[1];
+  std::vector<int> device_ids = {src->device.device_id, dst->device.device_id};
+  const std::vector<ncclComm_t>& comms = NCCLComms::Get(device_ids);
+  ncclDataType_t dtype = NCCLDataType(src->dtype);
+  NCCL_CALL(ncclGroupStart());
+  CUDA_CALL(cudaSetDevice(device_ids[0]));
+  NCCL_CALL(ncclSend(src->data, NumElements(src), dtype, 1, comms[0], StreamArg(args, 2, 0)));
+  CUDA_CALL(cudaSetDevice(device_ids[1]));
+  NCCL_CALL(ncclRecv(dst->data, NumElements(dst), dtype, 0, comms[1], StreamArg(args, 2, 1)));
+  NCCL_CALL(ncclGroupEnd());
+});
+
+/*! \brief The communicator of a process among the processes of a distributed run. */
+class NCCLCommunicatorObj : public Object {
+ public:
+  ncclComm_t comm;
+  int rank;
+  int world_size;
+  Device device;
+
+  ~NCCLCommunicatorObj() { ncclCommDestroy(comm); }
+
+  static constexpr const char* _type_key = "relax_vm.NCCLCommunicator";
+  TVM_DECLARE_FINAL_OBJECT_INFO(NCCLCommunicatorObj, Object);
+};
+
+TVM_REGISTER_OBJECT_TYPE(NCCLCommunicatorObj);
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.unique_id").set_body_typed([]() {
+  // The id is hex encoded, so that it can be handed to the other processes as a string.
+  ncclUniqueId id;
+  NCCL_CALL(ncclGetUniqueId(&id));
+  static const char* kHexDigits = "0123456789abcdef";
+  std::string hex;
+  for (size_t i = 0; i < sizeof(id.internal); ++i) {
+    uint8_t byte = static_cast<uint8_t>(id.internal[i]);
+    hex.push_back(kHexDigits[byte >> 4]);
+    hex.push_back(kHexDigits[byte & 0xf]);
+  }
+  return String(hex);
+});
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.init_comm")
+    .set_body_typed([](ShapeTuple rank_and_world_size, String unique_id, Device device) {
+      ICHECK_EQ(device.device_type, kDLCUDA) << "The NCCL communicator must be on a CUDA device";
+      ncclUniqueId id;
+      std::string hex = unique_id;
+      ICHECK_EQ(hex.size(), sizeof(id.internal) * 2) << "Invalid NCCL unique id";
+      for (size_t i = 0; i < sizeof(id.internal); ++i) {
+        id.internal[i] = static_cast<char>(std::stoi(hex.substr(i * 2, 2), nullptr, 16));
+      }
+      ObjectPtr<NCCLCommunicatorObj> n = make_object<NCCLCommunicatorObj>();
+      n->rank = rank_and_world_size[0];
+      n->world_size = rank_and_world_size[1];
+      n->device = device;
+      CUDA_CALL(cudaSetDevice(device.device_id));
+      NCCL_CALL(ncclCommInitRank(&n->comm, n->world_size, id, n->rank));
+      return ObjectRef(n);
+    });
+
+// The functions of a distributed run take the stream of the communicator after the tensors.
+
+const NCCLCommunicatorObj* CommArg(const TVMArgs& args) {
+  const NCCLCommunicatorObj* comm = args[0].operator ObjectRef().as<NCCLCommunicatorObj>();
+  ICHECK(comm != nullptr) << "The communicator of the VM is not a NCCL communicator";
+  CUDA_CALL(cudaSetDevice(comm->device.device_id));
+  return comm;
+}
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.comm_world_size")
+    .set_body([](TVMArgs args, TVMRetValue* rv) { *rv = CommArg(args)->world_size; });
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.comm_allreduce")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      const NCCLCommunicatorObj* comm = CommArg(args);
+      NDArray tensor = args[1];
+      NCCL_CALL(ncclAllReduce(tensor->data, tensor->data, NumElements(tensor),
+                              NCCLDataType(tensor->dtype), ncclSum, comm->comm,
+                              StreamArg(args, 2, 0)));
+    });
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.comm_allgather")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      const NCCLCommunicatorObj* comm = CommArg(args);
+      NDArray tensor = args[1];
+      NDArray out = args[2];
+      NCCL_CALL(ncclAllGather(tensor->data, out->data, NumElements(tensor),
+                              NCCLDataType(tensor->dtype), comm->comm, StreamArg(args, 3, 0)));
+    });
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.comm_broadcast")
+    .set_body([](TVMArgs args, TVMRetValue* rv) {
+      const NCCLCommunicatorObj* comm = CommArg(args);
+      NDArray tensor = args[1];
+      int root = args[2];
+      NCCL_CALL(ncclBroadcast(tensor->data, tensor->data, NumElements(tensor),
+                              NCCLDataType(tensor->dtype), root, comm->comm,
+                              StreamArg(args, 3, 0)));
+    });
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.comm_send").set_body([](TVMArgs args, TVMRetValue* rv) {
+  const NCCLCommunicatorObj* comm = CommArg(args);
+  NDArray tensor = args[1];
+  int peer = args[2];
+  NCCL_CALL(ncclSend(tensor->data, NumElements(tensor), NCCLDataType(tensor->dtype), peer,
+                     comm->comm, StreamArg(args, 3, 0)));
+});
+
+TVM_REGISTER_GLOBAL("runtime.relax_vm.nccl.comm_recv").set_body([](TVMArgs args, TVMRetValue* rv) {
+  const NCCLCommunicatorObj* comm = CommArg(args);
+  NDArray tensor = args[1];
+  int peer = args[2];
+  NCCL_CALL(ncclRecv(tensor->data, NumElements(tensor), NCCLDataType(tensor->dtype), peer,
+                     comm->comm, StreamArg(args, 3, 0)));
+});
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
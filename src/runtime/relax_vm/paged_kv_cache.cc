@@ -0,0 +1,203 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/relax_vm/paged_kv_cache.cc
+ * \brief Key/value caches of many sequences sharing fixed-size blocks of a device memory pool.
+ */
+#include "paged_kv_cache.h"
+
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+void PagedKVCacheObj::Init(ShapeTuple pool_shape, DLDataType dtype, Device device) {
+  CHECK_EQ(pool_shape.size(), 4U) << "ValueError: The pools of a paged KV cache have the shape "
+                                  << "(num_blocks, block_size, num_heads, head_dim)";
+  k_pool = NDArray::Empty(pool_shape, dtype, device);
+  v_pool = NDArray::Empty(pool_shape, dtype, device);
+  // The blocks are taken from the back, block 0 first.
+  for (int64_t block = pool_shape[0] - 1; block >= 0; --block) {
+    free_blocks_.push_back(static_cast<int32_t>(block));
+  }
+}
+
+void PagedKVCacheObj::AddSequence(int64_t seq_id) {
+  CHECK(sequences_.emplace(seq_id, Sequence()).second)
+      << "ValueError: The sequence " << seq_id << " is already in the paged KV cache";
+}
+
+void PagedKVCacheObj::RemoveSequence(int64_t seq_id) {
+  Sequence& seq = GetSequence(seq_id);
+  free_blocks_.insert(free_blocks_.end(), seq.blocks.rbegin(), seq.blocks.rend());
+  sequences_.erase(seq_id);
+}
+
+/*! \brief Copy the tokens [row, row + num_tokens) of \p src to the slots of \p pool from slot. */
+static void CopyTokens(const NDArray& src, int64_t row, int64_t num_tokens, const NDArray& pool,
+                       int64_t slot) {
+  int64_t token_bytes =
+      (src->dtype.bits * src->dtype.lanes + 7) / 8 * src->shape[1] * src->shape[2];
+  std::vector<int64_t> shape{num_tokens, src->shape[1], src->shape[2]};
+  DLTensor from = *src.operator->();
+  from.shape = shape.data();
+  from.byte_offset += row * token_bytes;
+  DLTensor to = *pool.operator->();
+  to.ndim = 3;
+  to.shape = shape.data();
+  to.strides = nullptr;
+  to.byte_offset += slot * token_bytes;
+  NDArray::CopyFromTo(&from, &to);
+}
+
+void PagedKVCacheObj::Append(const ShapeTuple& seq_ids, const ShapeTuple& lengths,
+                             const NDArray& keys, const NDArray& values) {
+  CHECK_EQ(seq_ids.size(), lengths.size())
+      << "ValueError: Every sequence appended to the paged KV cache requires a length";
+  CheckTokens(keys);
+  CheckTokens(values);
+  CHECK_EQ(keys->shape[0], values->shape[0])
+      << "ValueError: The keys and the values have different numbers of tokens";
+  // Check everything before taking any block, so that a failed append changes nothing.
+  int64_t total_length = 0;
+  size_t num_new_blocks = 0;
+  std::unordered_set<int64_t> seen;
+  for (size_t i = 0; i < seq_ids.size(); ++i) {
+    CHECK(seen.insert(seq_ids[i]).second)
+        << "ValueError: The sequence " << seq_ids[i] << " is appended twice";
+    CHECK_GE(lengths[i], 0) << "ValueError: The appended lengths must be non-negative";
+    const Sequence& seq = GetSequence(seq_ids[i]);
+    num_new_blocks += NumBlocks(seq.length + lengths[i]) - seq.blocks.size();
+    total_length += lengths[i];
+  }
+  CHECK_EQ(keys->shape[0], total_length)
+      << "ValueError: The appended lengths sum to " << total_length << " tokens, but "
+      << keys->shape[0] << " keys are given";
+  CHECK_LE(num_new_blocks, free_blocks_.size())
+      << "ValueError: The paged KV cache is out of blocks, " << num_new_blocks
+      << " are required but " << free_blocks_.size() << " are free";
+
+  int64_t row = 0;
+  for (size_t i = 0; i < seq_ids.size(); ++i) {
+    Sequence& seq = GetSequence(seq_ids[i]);
+    while (seq.blocks.size() < NumBlocks(seq.length + lengths[i])) {
+      seq.blocks.push_back(free_blocks_.back());
+      free_blocks_.pop_back();
+    }
+    // The tokens of a sequence in a block are contiguous in the pools.
+    for (int64_t end = row + lengths[i]; row < end;) {
+      int64_t offset = seq.length % block_size();
+      int64_t num_tokens = std::min(end - row, block_size() - offset);
+      int64_t slot = seq.blocks[seq.length / block_size()] * block_size() + offset;
+      CopyTokens(keys, row, num_tokens, k_pool, slot);
+      CopyTokens(values, row, num_tokens, v_pool, slot);
+      row += num_tokens;
+      seq.length += num_tokens;
+    }
+  }
+}
+
+ADT PagedKVCacheObj::BlockTable(const ShapeTuple& seq_ids) {
+  size_t max_blocks = 1;
+  for (int64_t seq_id : seq_ids) {
+    max_blocks = std::max(max_blocks, GetSequence(seq_id).blocks.size());
+  }
+  int64_t batch = static_cast<int64_t>(seq_ids.size());
+  std::vector<int32_t> table(batch * max_blocks, 0);
+  std::vector<int32_t> lengths(batch);
+  for (int64_t i = 0; i < batch; ++i) {
+    const Sequence& seq = GetSequence(seq_ids[i]);
+    std::copy(seq.blocks.begin(), seq.blocks.end(), table.begin() + i * max_blocks);
+    lengths[i] = static_cast<int32_t>(seq.length);
+  }
+  NDArray table_array = NDArray::Empty({batch, static_cast<int64_t>(max_blocks)},
+                                       DataType::Int(32), k_pool->device);
+  NDArray lengths_array = NDArray::Empty({batch}, DataType::Int(32), k_pool->device);
+  table_array.CopyFromBytes(table.data(), table.size() * sizeof(int32_t));
+  lengths_array.CopyFromBytes(lengths.data(), lengths.size() * sizeof(int32_t));
+  return ADT::Tuple(std::vector<ObjectRef>{table_array, lengths_array});
+}
+
+int64_t PagedKVCacheObj::Length(int64_t seq_id) { return GetSequence(seq_id).length; }
+
+PagedKVCacheObj::Sequence& PagedKVCacheObj::GetSequence(int64_t seq_id) {
+  auto it = sequences_.find(seq_id);
+  CHECK(it != sequences_.end()) << "ValueError: The sequence " << seq_id
+                                << " is not in the paged KV cache";
+  return it->second;
+}
+
+void PagedKVCacheObj::CheckTokens(const NDArray& tokens) const {
+  CHECK(tokens->ndim == 3 && tokens->shape[1] == k_pool->shape[2] &&
+        tokens->shape[2] == k_pool->shape[3])
+      << "ValueError: The tokens appended to the paged KV cache must have the shape (length, "
+      << k_pool->shape[2] << ", " << k_pool->shape[3] << ")";
+  CHECK(DataType(tokens->dtype) == DataType(k_pool->dtype))
+      << "ValueError: The tokens appended to the paged KV cache must have the dtype "
+      << DataType(k_pool->dtype);
+  CHECK(tokens.IsContiguous()) << "ValueError: The tokens appended to a KV cache must be compact";
+}
+
+PagedKVCache PagedKVCache::Create(ShapeTuple pool_shape, DLDataType dtype, Device device) {
+  auto n = make_object<PagedKVCacheObj>();
+  n->Init(pool_shape, dtype, device);
+  return PagedKVCache(n);
+}
+
+TVM_REGISTER_OBJECT_TYPE(PagedKVCacheObj);
+
+TVM_REGISTER_GLOBAL("vm.builtin.paged_kv_cache_create").set_body_typed(PagedKVCache::Create);
+
+TVM_REGISTER_GLOBAL("vm.builtin.paged_kv_cache_add_sequence")
+    .set_body_typed([](PagedKVCache cache, int64_t seq_id) { cache->AddSequence(seq_id); });
+
+TVM_REGISTER_GLOBAL("vm.builtin.paged_kv_cache_remove_sequence")
+    .set_body_typed([](PagedKVCache cache, int64_t seq_id) { cache->RemoveSequence(seq_id); });
+
+TVM_REGISTER_GLOBAL("vm.builtin.paged_kv_cache_append")
+    .set_body_typed([](PagedKVCache cache, ShapeTuple seq_ids, ShapeTuple lengths, NDArray keys,
+                       NDArray values) {
+      cache->Append(seq_ids, lengths, keys, values);
+      return cache;
+    });
+
+TVM_REGISTER_GLOBAL("vm.builtin.paged_kv_cache_block_table")
+    .set_body_typed([](PagedKVCache cache, ShapeTuple seq_ids) {
+      return cache->BlockTable(seq_ids);
+    });
+
+TVM_REGISTER_GLOBAL("vm.builtin.paged_kv_cache_pools").set_body_typed([](PagedKVCache cache) {
+  return ADT::Tuple(std::vector<ObjectRef>{cache->k_pool, cache->v_pool});
+});
+
+TVM_REGISTER_GLOBAL("vm.builtin.paged_kv_cache_length")
+    .set_body_typed([](PagedKVCache cache, int64_t seq_id) { return cache->Length(seq_id); });
+
+TVM_REGISTER_GLOBAL("vm.builtin.paged_kv_cache_num_free_blocks")
+    .set_body_typed([](PagedKVCache cache) { return cache->NumFreeBlocks(); });
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,126 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/relax_vm/paged_kv_cache.h
+ * \brief Key/value caches of many sequences sharing fixed-size blocks of a device memory pool.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_PAGED_KV_CACHE_H_
+#define TVM_RUNTIME_RELAX_VM_PAGED_KV_CACHE_H_
+
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/ndarray.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief The key/value caches of the sequences being decoded, paged into a pool.
+ *
+ * The keys and the values of the tokens live in two pools of shape (num_blocks, block_size,
+ * num_heads, head_dim) allocated once on the device. A sequence holds the blocks its tokens
+ * fill in order, taken from the free blocks as it grows and given back when it is removed, so
+ * the sequences only reserve their length rounded up to a block. The attention kernels, e.g.
+ * topi.nn.paged_attention, find the tokens of a sequence through its row of the block table.
+ */
+class PagedKVCacheObj : public Object {
+ public:
+  /*! \brief The key and value pools. */
+  NDArray k_pool;
+  NDArray v_pool;
+
+  /*! \brief Create the pools, all blocks free. */
+  void Init(ShapeTuple pool_shape, DLDataType dtype, Device device);
+  /*! \brief Start a sequence without any token. */
+  void AddSequence(int64_t seq_id);
+  /*! \brief Remove a sequence, freeing its blocks. */
+  void RemoveSequence(int64_t seq_id);
+  /*!
+   * \brief Append the keys and the values of new tokens to sequences.
+   * \param seq_ids The sequences.
+   * \param lengths The number of the new tokens of every sequence.
+   * \param keys The keys of shape (total_length, num_heads, head_dim), of the sequences in order.
+   * \param values The values of the shape of the keys.
+   */
+  void Append(const ShapeTuple& seq_ids, const ShapeTuple& lengths, const NDArray& keys,
+              const NDArray& values);
+  /*!
+   * \brief Get the block table and the lengths of sequences, on the device of the pools.
+   * \param seq_ids The sequences, e.g. of a decode batch.
+   * \return The tuple of the int32 block table of shape (batch, max_blocks), padded with the
+   *  block 0, and of the int32 lengths of shape (batch,).
+   */
+  ADT BlockTable(const ShapeTuple& seq_ids);
+  /*! \brief The number of the cached tokens of a sequence. */
+  int64_t Length(int64_t seq_id);
+  /*! \brief The number of the free blocks of the pools. */
+  int64_t NumFreeBlocks() const { return static_cast<int64_t>(free_blocks_.size()); }
+  /*! \brief The number of tokens of a block. */
+  int64_t block_size() const { return k_pool->shape[1]; }
+  /*! \brief The number of blocks holding \p length tokens. */
+  size_t NumBlocks(int64_t length) const {
+    return static_cast<size_t>((length + block_size() - 1) / block_size());
+  }
+
+  static constexpr const uint32_t _type_index = TypeIndex::kDynamic;
+  static constexpr const char* _type_key = "relax.vm.PagedKVCache";
+  TVM_DECLARE_FINAL_OBJECT_INFO(PagedKVCacheObj, Object);
+
+ private:
+  struct Sequence {
+    /*! \brief The blocks holding the tokens, in order. */
+    std::vector<int32_t> blocks;
+    /*! \brief The number of the cached tokens. */
+    int64_t length{0};
+  };
+
+  Sequence& GetSequence(int64_t seq_id);
+  /*! \brief Check that \p tokens holds the keys or values of tokens of the pools. */
+  void CheckTokens(const NDArray& tokens) const;
+
+  /*! \brief The free blocks, taken from the back. */
+  std::vector<int32_t> free_blocks_;
+  /*! \brief The sequences by their ids. */
+  std::unordered_map<int64_t, Sequence> sequences_;
+};
+
+/*! \brief Managed reference to PagedKVCacheObj. */
+class PagedKVCache : public ObjectRef {
+ public:
+  /*!
+   * \brief Create a cache.
+   * \param pool_shape The shape of the pools, (num_blocks, block_size, num_heads, head_dim).
+   * \param dtype The dtype of the keys and the values.
+   * \param device The device of the pools.
+   */
+  static PagedKVCache Create(ShapeTuple pool_shape, DLDataType dtype, Device device);
+
+  TVM_DEFINE_MUTABLE_OBJECT_REF_METHODS(PagedKVCache, ObjectRef, PagedKVCacheObj);
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_PAGED_KV_CACHE_H_
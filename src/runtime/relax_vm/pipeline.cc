@@ -0,0 +1,328 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/pipeline.cc
+ * \brief A server mode of the Relax VM which overlaps the host work of a request with the device
+ *  kernels of the previous ones.
+ */
+
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/container/array.h>
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/module.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/vm.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*! \brief A bounded queue handing the requests from a stage of the pipeline to the next. */
+template <typename T>
+class Channel {
+ public:
+  explicit Channel(size_t capacity) : capacity_(capacity) {}
+
+  /*! \brief Push a value, waiting for room, return false if the channel is closed. */
+  bool Push(T value) {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this]() { return closed_ || queue_.size() < capacity_; });
+    if (closed_) return false;
+    queue_.push_back(std::move(value));
+    cv_.notify_all();
+    return true;
+  }
+
+  /*! \brief Pop a value, waiting for one, return false once the channel is closed and drained. */
+  bool Pop(T* value) {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this]() { return closed_ || !queue_.empty(); });
+    if (queue_.empty()) return false;
+    *value = std::move(queue_.front());
+    queue_.pop_front();
+    cv_.notify_all();
+    return true;
+  }
+
+  void Close() {
+    std::lock_guard<std::mutex> lock(mu_);
+    closed_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  size_t capacity_;
+  std::deque<T> queue_;
+  bool closed_{false};
+  std::mutex mu_;
+  std::condition_variable cv_;
+};
+
+/*!
+ * \brief Pipeline the calls to a VM function.
+ *
+ * A request goes through three threads. The prefetch thread copies its inputs to the first device
+ * of the VM on the input copy stream and waits for them. The invoke thread calls the function,
+ * which runs the host instructions, e.g. the shape computations and the tuple constructions, and
+ * launches the kernels on the compute stream without waiting for them. The completion
+ * thread waits for the compute stream and hands the outputs back. So the inputs of the request
+ * N + 2 are copied and the host instructions of the request N + 1 run while the kernels of the
+ * request N are in flight. At most depth requests are queued between two threads. The VM function
+ * is only called by the invoke thread, so the VM should not be used by other threads, e.g. pass a
+ * session of the VM.
+ */
+class VMPipeline : public ModuleNode {
+ public:
+  VMPipeline(Module vm, std::string func_name, int64_t depth)
+      : vm_(vm),
+        func_(vm.GetFunction(func_name)),
+        to_prefetch_(depth),
+        to_invoke_(depth),
+        to_complete_(depth) {
+    ICHECK(func_ != nullptr) << "ValueError: Unknown function: " << func_name;
+    CHECK_GT(depth, 0) << "ValueError: the depth of the pipeline must be positive";
+    CHECK_EQ(std::string(vm->type_key()), "relax.VirtualMachine")
+        << "ValueError: the pipeline expects a VirtualMachine";
+    vm_node_ = static_cast<VirtualMachine*>(vm.operator->());
+    device_ = vm_node_->devices[0];
+    // The streams are created here since the VM does not create them concurrently.
+    copy_stream_ = vm_node_->GetStream(0, VirtualMachine::kInputCopyStream);
+    compute_stream_ = vm_node_->GetStream(0, 0);
+    prefetcher_ = std::thread([this]() { this->RunPrefetch(); });
+    invoker_ = std::thread([this]() { this->RunInvoke(); });
+    completer_ = std::thread([this]() { this->RunComplete(); });
+  }
+
+  ~VMPipeline() {
+    // Every stage drains its channel and closes the next one.
+    to_prefetch_.Close();
+    prefetcher_.join();
+    invoker_.join();
+    completer_.join();
+  }
+
+  const char* type_key() const final { return "relax.vm.VMPipeline"; }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final {
+    if (name == "submit") {
+      // args: the inputs of the request.
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::vector<ObjectRef> inputs;
+        for (int i = 0; i < args.size(); ++i) {
+          inputs.push_back(args[i].operator ObjectRef());
+        }
+        *rv = this->Submit(std::move(inputs)).get();
+      });
+    } else if (name == "run_all") {
+      // args[0]: the inputs of every request, submitted at once so that they overlap.
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        Array<Array<ObjectRef>> requests = args[0];
+        std::vector<std::future<ObjectRef>> results;
+        for (const Array<ObjectRef>& inputs : requests) {
+          results.push_back(this->Submit(std::vector<ObjectRef>(inputs.begin(), inputs.end())));
+        }
+        Array<ObjectRef> outputs;
+        for (std::future<ObjectRef>& result : results) {
+          outputs.push_back(result.get());
+        }
+        *rv = outputs;
+      });
+    } else if (name == "stats") {
+      return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto average = [](double total, int64_t count) { return count == 0 ? 0.0 : total / count; };
+        std::ostringstream os;
+        os << "{\"num_requests\": " << stats_.num_requests
+           << ", \"avg_host_us\": " << average(stats_.total_host_us, stats_.num_requests)
+           << ", \"avg_latency_us\": " << average(stats_.total_latency_us, stats_.num_requests)
+           << "}";
+        *rv = String(os.str());
+      });
+    }
+    return PackedFunc(nullptr);
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /*! \brief A request going through the pipeline. */
+  struct Request {
+    std::vector<ObjectRef> inputs;
+    Clock::time_point arrival;
+    double host_us{0};
+    ObjectRef outputs;
+    std::exception_ptr error;
+    std::promise<ObjectRef> result;
+  };
+
+  /*! \brief The accumulated latencies, in microseconds. */
+  struct Stats {
+    int64_t num_requests{0};
+    double total_host_us{0};
+    double total_latency_us{0};
+  };
+
+  std::future<ObjectRef> Submit(std::vector<ObjectRef> inputs) {
+    auto request = std::make_unique<Request>();
+    request->inputs = std::move(inputs);
+    request->arrival = Clock::now();
+    std::future<ObjectRef> result = request->result.get_future();
+    CHECK(to_prefetch_.Push(std::move(request))) << "ValueError: the pipeline is shut down";
+    return result;
+  }
+
+  /*! \brief Copy an input to the device on the copy stream, recording whether it copied. */
+  ObjectRef Prefetch(const ObjectRef& input, bool* copied) {
+    if (const auto* array = input.as<ArrayNode>()) {
+      std::vector<ObjectRef> fields;
+      for (const ObjectRef& field : *array) fields.push_back(Prefetch(field, copied));
+      return ADT::Tuple(fields);
+    }
+    if (const auto* adt = input.as<ADTObj>()) {
+      std::vector<ObjectRef> fields;
+      for (size_t i = 0; i < adt->size; ++i) fields.push_back(Prefetch((*adt)[i], copied));
+      return ADT(adt->tag, fields.begin(), fields.end());
+    }
+    const auto* tensor = input.as<NDArray::ContainerType>();
+    if (tensor == nullptr || (tensor->dl_tensor.device.device_type == device_.device_type &&
+                              tensor->dl_tensor.device.device_id == device_.device_id)) {
+      return input;
+    }
+    NDArray src = GetRef<NDArray>(tensor);
+    NDArray dst = NDArray::Empty(src.Shape(), src->dtype, device_);
+    NDArray::CopyFromTo(src.operator->(), const_cast<DLTensor*>(dst.operator->()), copy_stream_);
+    *copied = true;
+    return dst;
+  }
+
+  void RunPrefetch() {
+    std::unique_ptr<Request> request;
+    while (to_prefetch_.Pop(&request)) {
+      try {
+        bool copied = false;
+        for (ObjectRef& input : request->inputs) input = Prefetch(input, &copied);
+        if (copied && copy_stream_ != nullptr) {
+          // The copies are complete once the invoke thread queues the kernels after them.
+          DeviceAPI::Get(device_)->StreamSync(device_, copy_stream_);
+        }
+      } catch (...) {
+        request->error = std::current_exception();
+      }
+      to_invoke_.Push(std::move(request));
+    }
+    to_invoke_.Close();
+  }
+
+  void RunInvoke() {
+    std::unique_ptr<Request> request;
+    while (to_invoke_.Pop(&request)) {
+      if (request->error == nullptr) {
+        Clock::time_point start = Clock::now();
+        try {
+          std::vector<TVMValue> values(request->inputs.size());
+          std::vector<int> tcodes(request->inputs.size());
+          TVMArgsSetter setter(values.data(), tcodes.data());
+          for (size_t i = 0; i < request->inputs.size(); ++i) {
+            setter(i, request->inputs[i]);
+          }
+          TVMRetValue ret;
+          func_.CallPacked(TVMArgs(values.data(), tcodes.data(), values.size()), &ret);
+          request->outputs = ret.operator ObjectRef();
+        } catch (...) {
+          request->error = std::current_exception();
+        }
+        request->host_us = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+      }
+      to_complete_.Push(std::move(request));
+    }
+    to_complete_.Close();
+  }
+
+  void RunComplete() {
+    std::unique_ptr<Request> request;
+    while (to_complete_.Pop(&request)) {
+      if (request->error == nullptr) {
+        try {
+          // The stream is in order, so this waits for the kernels of the request, and possibly
+          // of the requests launched since.
+          DeviceAPI::Get(device_)->StreamSync(device_, compute_stream_);
+          request->result.set_value(request->outputs);
+        } catch (...) {
+          request->result.set_exception(std::current_exception());
+        }
+      } else {
+        request->result.set_exception(request->error);
+      }
+      double latency_us =
+          std::chrono::duration<double, std::micro>(Clock::now() - request->arrival).count();
+      std::lock_guard<std::mutex> lock(mu_);
+      stats_.num_requests += 1;
+      stats_.total_host_us += request->host_us;
+      stats_.total_latency_us += latency_us;
+    }
+  }
+
+  /*! \brief The VM module, kept alive while the pipeline runs. */
+  Module vm_;
+  /*! \brief The VM, whose devices and streams the pipeline uses. */
+  VirtualMachine* vm_node_;
+  /*! \brief The pipelined VM function. */
+  PackedFunc func_;
+  /*! \brief The device the inputs are copied to. */
+  Device device_;
+  /*! \brief The stream copying the inputs. */
+  TVMStreamHandle copy_stream_;
+  /*! \brief The stream running the kernels, the default stream when the pipeline is created. */
+  TVMStreamHandle compute_stream_;
+  /*! \brief The channels between the stages. */
+  Channel<std::unique_ptr<Request>> to_prefetch_;
+  Channel<std::unique_ptr<Request>> to_invoke_;
+  Channel<std::unique_ptr<Request>> to_complete_;
+  /*! \brief The latency statistics. */
+  Stats stats_;
+  std::mutex mu_;
+  /*! \brief The threads of the stages. */
+  std::thread prefetcher_;
+  std::thread invoker_;
+  std::thread completer_;
+};
+
+TVM_REGISTER_GLOBAL("relax.VMPipeline")
+    .set_body_typed([](Module vm, String func_name, int64_t depth) {
+      return Module(make_object<VMPipeline>(vm, func_name, depth));
+    });
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -26,32 +26,87 @@
 #include <tvm/runtime/device_api.h>
 #include <tvm/runtime/relax_vm/memory_manager.h>
 
+#include <algorithm>
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace tvm {
 namespace runtime {
 namespace relax_vm {
 
+/*!
+ * \brief An allocator which pools the freed buffers by their page-rounded size.
+ *
+ * Every thread frees into and allocates from a cache of its own first, so that the alloc and
+ * free of same-size intermediates by the VMs of many threads do not contend on the shared pool.
+ * A thread cache holds at most kThreadCacheBlocks blocks of a size and kThreadCacheBytes bytes,
+ * returning half of the blocks of a size to the shared pool once full, and every
+ * kRebalancePeriod operations it returns the blocks of the sizes it did not allocate since.
+ */
 class PooledAllocator final : public Allocator {
  public:
   static constexpr size_t kDefaultPageSize = 4096;
+  /*! \brief The maximal number of blocks of a size in a thread cache. */
+  static constexpr size_t kThreadCacheBlocks = 8;
+  /*! \brief The maximal number of bytes in a thread cache. */
+  static constexpr size_t kThreadCacheBytes = 32 << 20;
+  /*! \brief The number of operations of a thread cache between two rebalancings. */
+  static constexpr size_t kRebalancePeriod = 1024;
 
   explicit PooledAllocator(Device dev, size_t page_size = kDefaultPageSize)
       : Allocator(kPooled), page_size_(page_size), used_memory_(0), device_(dev) {}
 
-  ~PooledAllocator() { ReleaseAll(); }
+  ~PooledAllocator() {
+    {
+      // The caches of the threads still alive free their blocks, the threads drop them on exit.
+      std::lock_guard<std::mutex> lock(RegistryMutex());
+      for (ThreadCache* cache : thread_caches_) {
+        for (auto& kv : cache->free_lists) {
+          for (const Buffer& buf : kv.second.blocks) {
+            runtime::DeviceAPI::Get(buf.device)->FreeDataSpace(buf.device, buf.data);
+          }
+        }
+        cache->free_lists.clear();
+        cache->owner = nullptr;
+      }
+    }
+    ReleaseAll();
+  }
 
   Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
-    std::lock_guard<std::recursive_mutex> lock(mu_);
     size_t size = ((nbytes + page_size_ - 1) / page_size_) * page_size_;
-    auto&& it = memory_pool_.find(size);
-    if (it != memory_pool_.end() && !it->second.empty()) {
-      auto&& pool = it->second;
+    ThreadCache* cache = GetThreadCache();
+    if (cache != nullptr) {
+      Increment(&cache->num_allocs);
+      FreeList& free_list = cache->free_lists[size];
+      free_list.num_allocs += 1;
+      if (!free_list.blocks.empty()) {
+        Buffer ret = free_list.blocks.back();
+        free_list.blocks.pop_back();
+        cache->cached_bytes.store(cache->cached_bytes.load(std::memory_order_relaxed) - size,
+                                  std::memory_order_relaxed);
+        Increment(&cache->num_cache_hits);
+        return ret;
+      }
+    }
+
+    std::lock_guard<std::recursive_mutex> lock(mu_);
+    if (cache == nullptr) ++num_detached_allocs_;
+    auto&& pool_it = memory_pool_.find(size);
+    if (pool_it != memory_pool_.end() && !pool_it->second.empty()) {
+      auto&& pool = pool_it->second;
       auto ret = pool.back();
       pool.pop_back();
+      cached_bytes_ -= size;
+      if (cache != nullptr) {
+        Increment(&cache->num_cache_hits);
+      } else {
+        ++num_detached_cache_hits_;
+      }
       return ret;
     }
     Buffer buf;
@@ -63,26 +118,205 @@ class PooledAllocator final : public Allocator {
     } catch (InternalError& err) {
       LOG(WARNING) << "PooledAllocator got InternalError during allocation: " << err.message();
       LOG(WARNING) << "Trying to release all unused memory and reallocate...";
+      // The other threads return their caches on their next operation.
+      if (cache != nullptr) ReturnBlocks(cache, true);
       ReleaseAll();
+      uint64_t release_epoch = release_epoch_.fetch_add(1, std::memory_order_release) + 1;
+      if (cache != nullptr) cache->release_epoch = release_epoch;
       buf.data =
           runtime::DeviceAPI::Get(device_)->AllocDataSpace(device_, size, alignment, type_hint);
     }
 
     used_memory_.fetch_add(size, std::memory_order_relaxed);
+    peak_memory_ = std::max(peak_memory_, used_memory_.load(std::memory_order_relaxed));
     DLOG(INFO) << "allocate " << size << " B, used memory " << used_memory_ << " B";
     return buf;
   }
 
   void Free(const Buffer& buffer) override {
+    if (FreeScopedBuffer(buffer)) return;
+    ThreadCache* cache = GetThreadCache();
+    if (cache == nullptr) {
+      std::lock_guard<std::recursive_mutex> lock(mu_);
+      memory_pool_[buffer.size].push_back(buffer);
+      cached_bytes_ += buffer.size;
+      return;
+    }
+    FreeList& free_list = cache->free_lists[buffer.size];
+    size_t cached_bytes = cache->cached_bytes.load(std::memory_order_relaxed);
+    if (free_list.blocks.size() < kThreadCacheBlocks &&
+        cached_bytes + buffer.size <= kThreadCacheBytes) {
+      free_list.blocks.push_back(buffer);
+      cache->cached_bytes.store(cached_bytes + buffer.size, std::memory_order_relaxed);
+      return;
+    }
+    // The cache is full, return half of the blocks of the size along with the buffer.
     std::lock_guard<std::recursive_mutex> lock(mu_);
-    if (memory_pool_.find(buffer.size) == memory_pool_.end()) {
-      memory_pool_.emplace(buffer.size, std::vector<Buffer>{});
+    std::vector<Buffer>& pool = memory_pool_[buffer.size];
+    size_t num_kept = free_list.blocks.size() / 2;
+    for (size_t i = num_kept; i < free_list.blocks.size(); ++i) {
+      pool.push_back(free_list.blocks[i]);
+      cached_bytes -= buffer.size;
+      cached_bytes_ += buffer.size;
     }
-    memory_pool_.at(buffer.size).push_back(buffer);
+    free_list.blocks.resize(num_kept);
+    cache->cached_bytes.store(cached_bytes, std::memory_order_relaxed);
+    pool.push_back(buffer);
+    cached_bytes_ += buffer.size;
     DLOG(INFO) << "reclaim buffer " << buffer.size;
   }
 
+  AllocatorStats Stats() override {
+    std::lock_guard<std::mutex> registry_lock(RegistryMutex());
+    std::lock_guard<std::recursive_mutex> lock(mu_);
+    AllocatorStats stats;
+    stats.cached_bytes = cached_bytes_;
+    stats.num_allocs = 0;
+    stats.num_cache_hits = 0;
+    for (const ThreadCache* cache : thread_caches_) {
+      stats.cached_bytes += cache->cached_bytes.load(std::memory_order_relaxed);
+      stats.num_allocs += cache->num_allocs.load(std::memory_order_relaxed);
+      stats.num_cache_hits += cache->num_cache_hits.load(std::memory_order_relaxed);
+    }
+    stats.num_allocs += num_detached_allocs_;
+    stats.num_cache_hits += num_detached_cache_hits_;
+    stats.live_bytes = used_memory_ - stats.cached_bytes;
+    stats.peak_bytes = peak_memory_;
+    return stats;
+  }
+
+  size_t HeldBytes() override { return used_memory_.load(std::memory_order_relaxed); }
+
+  void ReleaseCache() override {
+    // The other threads return their caches to the shared pool on their next operation.
+    ThreadCache* cache = GetThreadCache();
+    if (cache != nullptr) ReturnBlocks(cache, true);
+    ReleaseAll();
+    uint64_t release_epoch = release_epoch_.fetch_add(1, std::memory_order_release) + 1;
+    if (cache != nullptr) cache->release_epoch = release_epoch;
+  }
+
  private:
+  /*! \brief The cached blocks of a size in a thread cache. */
+  struct FreeList {
+    std::vector<Buffer> blocks;
+    /*! \brief The number of allocations of the size since the last rebalancing. */
+    size_t num_allocs{0};
+  };
+
+  /*! \brief The cache of a thread, only used by the thread except for its statistics. */
+  struct ThreadCache {
+    /*! \brief The allocator, nullptr once destroyed, guarded by the registry mutex. */
+    PooledAllocator* owner{nullptr};
+    std::unordered_map<size_t, FreeList> free_lists;
+    /*! \brief The operations since the last rebalancing. */
+    size_t num_ops{0};
+    /*! \brief The release epoch of the allocator the cache has seen. */
+    uint64_t release_epoch{0};
+    /*! \brief The statistics, written by the thread and read by Stats. */
+    std::atomic<size_t> cached_bytes{0};
+    std::atomic<size_t> num_allocs{0};
+    std::atomic<size_t> num_cache_hits{0};
+  };
+
+  /*! \brief The caches of a thread, returned to their allocators when the thread exits. */
+  struct ThreadCaches {
+    std::vector<std::pair<uint64_t, std::unique_ptr<ThreadCache>>> caches;
+
+    ~ThreadCaches() {
+      ThreadExited() = true;
+      std::lock_guard<std::mutex> lock(RegistryMutex());
+      for (auto& kv : caches) {
+        PooledAllocator* owner = kv.second->owner;
+        if (owner == nullptr) continue;
+        owner->ReturnBlocks(kv.second.get(), true);
+        owner->num_detached_allocs_ += kv.second->num_allocs.load(std::memory_order_relaxed);
+        owner->num_detached_cache_hits_ +=
+            kv.second->num_cache_hits.load(std::memory_order_relaxed);
+        auto& registered = owner->thread_caches_;
+        registered.erase(std::find(registered.begin(), registered.end(), kv.second.get()));
+      }
+    }
+  };
+
+  /*! \brief The mutex guarding the registration and the lifetime of the thread caches. */
+  static std::mutex& RegistryMutex() {
+    static std::mutex* mutex = new std::mutex();
+    return *mutex;
+  }
+
+  /*!
+   * \brief Whether the caches of the calling thread are destroyed, e.g. when a thread-local
+   *  object destroyed after them frees a buffer, which then goes to the shared pool.
+   */
+  static bool& ThreadExited() {
+    thread_local bool exited = false;
+    return exited;
+  }
+
+  static void Increment(std::atomic<size_t>* counter) {
+    counter->store(counter->load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  /*!
+   * \brief Get the cache of the calling thread, rebalanced or dropped as required.
+   * \return The cache, nullptr if the thread is exiting.
+   */
+  ThreadCache* GetThreadCache() {
+    if (ThreadExited()) return nullptr;
+    thread_local ThreadCaches thread_caches;
+    ThreadCache* cache = nullptr;
+    for (auto& kv : thread_caches.caches) {
+      if (kv.first == id_) {
+        cache = kv.second.get();
+        break;
+      }
+    }
+    if (cache == nullptr) {
+      auto new_cache = std::make_unique<ThreadCache>();
+      new_cache->owner = this;
+      new_cache->release_epoch = release_epoch_.load(std::memory_order_relaxed);
+      cache = new_cache.get();
+      std::lock_guard<std::mutex> lock(RegistryMutex());
+      thread_caches_.push_back(cache);
+      thread_caches.caches.emplace_back(id_, std::move(new_cache));
+    }
+    uint64_t release_epoch = release_epoch_.load(std::memory_order_acquire);
+    if (cache->release_epoch != release_epoch) {
+      cache->release_epoch = release_epoch;
+      ReturnBlocks(cache, true);
+    } else if (++cache->num_ops == kRebalancePeriod) {
+      ReturnBlocks(cache, false);
+    }
+    return cache;
+  }
+
+  /*!
+   * \brief Return the blocks of a thread cache to the shared pool.
+   * \param cache The cache.
+   * \param all Whether to return every block, otherwise the blocks of the sizes the thread did
+   *  not allocate since the last rebalancing.
+   */
+  void ReturnBlocks(ThreadCache* cache, bool all) {
+    std::lock_guard<std::recursive_mutex> lock(mu_);
+    size_t cached_bytes = cache->cached_bytes.load(std::memory_order_relaxed);
+    for (auto it = cache->free_lists.begin(); it != cache->free_lists.end();) {
+      FreeList& free_list = it->second;
+      if (all || free_list.num_allocs == 0) {
+        std::vector<Buffer>& pool = memory_pool_[it->first];
+        pool.insert(pool.end(), free_list.blocks.begin(), free_list.blocks.end());
+        cached_bytes -= free_list.blocks.size() * it->first;
+        cached_bytes_ += free_list.blocks.size() * it->first;
+        it = cache->free_lists.erase(it);
+      } else {
+        free_list.num_allocs = 0;
+        ++it;
+      }
+    }
+    cache->cached_bytes.store(cached_bytes, std::memory_order_relaxed);
+    cache->num_ops = 0;
+  }
+
   void ReleaseAll() {
     std::lock_guard<std::recursive_mutex> lock(mu_);
     for (auto const& it : memory_pool_) {
@@ -92,16 +326,34 @@ class PooledAllocator final : public Allocator {
       }
     }
     memory_pool_.clear();
-    used_memory_ = 0;
+    used_memory_ -= cached_bytes_;
+    cached_bytes_ = 0;
     DLOG(INFO) << "release all buffers";
   }
 
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> next_id{0};
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+  }
+
  private:
   size_t page_size_;
   std::atomic<size_t> used_memory_;
+  /*! \brief The bytes of the shared pool. */
+  size_t cached_bytes_{0};
+  size_t peak_memory_{0};
+  /*! \brief The statistics of the thread caches of the exited threads. */
+  size_t num_detached_allocs_{0};
+  size_t num_detached_cache_hits_{0};
   std::unordered_map<size_t, std::vector<Buffer> > memory_pool_;
   std::recursive_mutex mu_;
   Device device_;
+  /*! \brief The unique id of the allocator, keying the thread caches, never reused. */
+  uint64_t id_{NextId()};
+  /*! \brief The caches of the threads, bumped to drop them after all memory is released. */
+  std::atomic<uint64_t> release_epoch_{0};
+  /*! \brief The thread caches, guarded by the registry mutex. */
+  std::vector<ThreadCache*> thread_caches_;
 };
 
 }  // namespace relax_vm
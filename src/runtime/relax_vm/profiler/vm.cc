@@ -0,0 +1,201 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/profiler/vm.cc
+ * \brief The Relax profiling virtual machine.
+ */
+
+#include "vm.h"
+
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/registry.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*! \brief The bytes moved from memory per last level cache miss. */
+constexpr double kCacheLineBytes = 64;
+
+/*! \brief Get a count metric of a call, or -1 if the call does not have it. */
+static double GetCount(const Map<String, ObjectRef>& call, const std::string& name) {
+  auto it = call.find(name);
+  if (it == call.end()) return -1;
+  const auto* count = (*it).second.as<profiling::CountNode>();
+  return count ? static_cast<double>(count->value) : -1;
+}
+
+/*!
+ * \brief Derive the throughput metrics of every call from its duration, the bytes of its
+ *  arguments and the hardware counters collected for it, so that memory-bound and
+ *  compute-bound kernels can be told apart.
+ */
+static profiling::Report DeriveThroughputMetrics(const profiling::Report& report) {
+  Array<Map<String, ObjectRef>> calls;
+  for (Map<String, ObjectRef> call : report->calls) {
+    auto it = call.find("Duration (us)");
+    const auto* duration = it == call.end() ? nullptr : (*it).second.as<profiling::DurationNode>();
+    if (duration == nullptr || duration->microseconds <= 0) {
+      calls.push_back(call);
+      continue;
+    }
+    // Bytes (or operations) per microsecond divided by 1e3 is per nanosecond, i.e. G per second.
+    double scale = 1.0 / (duration->microseconds * 1e3);
+    double bytes = GetCount(call, "Argument Bytes");
+    if (bytes >= 0) {
+      call.Set("Argument Bandwidth (GB/s)",
+               ObjectRef(make_object<profiling::RatioNode>(bytes * scale)));
+    }
+    for (const char* name : {"PAPI_FP_OPS", "PAPI_SP_OPS", "PAPI_DP_OPS"}) {
+      double flops = GetCount(call, name);
+      if (flops < 0) continue;
+      call.Set("GFLOPS", ObjectRef(make_object<profiling::RatioNode>(flops * scale)));
+      if (bytes > 0) {
+        call.Set("Arithmetic Intensity (FLOP/Byte)",
+                 ObjectRef(make_object<profiling::RatioNode>(flops / bytes)));
+      }
+      break;
+    }
+    for (const char* name : {"perf::CACHE-MISSES", "PAPI_L3_TCM", "PAPI_L2_TCM"}) {
+      double misses = GetCount(call, name);
+      if (misses < 0) continue;
+      call.Set("Memory Bandwidth (GB/s)",
+               ObjectRef(make_object<profiling::RatioNode>(misses * kCacheLineBytes * scale)));
+      break;
+    }
+    calls.push_back(call);
+  }
+  return profiling::Report(calls, report->device_metrics, report->configuration);
+}
+
+PackedFunc VirtualMachineProfiler::GetFunction(const std::string& name,
+                                               const ObjectPtr<Object>& sptr_to_self) {
+  if (name == "profile") {
+    // args[0]: function name; args[1]: metric collectors or nullptr; args[2, ...]: inputs.
+    // Without inputs, the inputs given by set_input are used.
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ICHECK_GE(args.size(), 2);
+      std::string func_name = args[0];
+      // We cannot send Arrays over rpc, so in order to support profiling
+      // on remotes, we accept a nullptr for collectors.
+      std::vector<profiling::MetricCollector> collectors;
+      if (args[1].type_code() != kTVMNullptr) {
+        Array<profiling::MetricCollector> cs = args[1];
+        collectors = std::vector<profiling::MetricCollector>(cs.begin(), cs.end());
+      }
+
+      PackedFunc invoke = VirtualMachine::GetFunction(func_name, sptr_to_self);
+      TVMArgs inputs(args.values + 2, args.type_codes + 2, args.size() - 2);
+      TVMRetValue ret;
+      // warmup
+      invoke.CallPacked(inputs, &ret);
+
+      prof_ = profiling::Profiler(devices, collectors, {{String("Executor"), String("Relax VM")}});
+      prof_.operator*().Start();
+      invoke.CallPacked(inputs, &ret);
+      prof_.operator*().Stop();
+      profiling::Report report = DeriveThroughputMetrics(prof_.operator*().Report());
+      prof_ = dmlc::optional<profiling::Profiler>();  // releases hardware counters
+      *rv = report;
+    });
+  } else if (name == "profile_rpc") {
+    // We cannot return a Report over RPC because TVM RPC mechanism only
+    // supports a subset of Object classes. Instead we serialize it on the
+    // remote (here) and deserialize it on the other end.
+    return TypedPackedFunc<std::string(std::string)>([sptr_to_self, this](std::string func_name) {
+      PackedFunc profile = GetFunction("profile", sptr_to_self);
+      profiling::Report report = profile(func_name, nullptr);
+      return report->AsJSON();
+    });
+  } else {
+    return VirtualMachine::GetFunction(name, sptr_to_self);
+  }
+}
+
+/*! \brief Collect the NDArrays in a call argument, looking into tuples. */
+static void CollectNDArrays(const TVMArgValue& arg, std::vector<NDArray>* arrays) {
+  if (arg.type_code() == kTVMNDArrayHandle) {
+    arrays->push_back(arg.operator NDArray());
+  } else if (arg.type_code() == kTVMObjectHandle) {
+    ObjectRef obj = arg.operator ObjectRef();
+    if (const auto* adt = obj.as<ADTObj>()) {
+      for (size_t i = 0; i < adt->size; ++i) {
+        if (const auto* nd = (*adt)[i].as<NDArray::ContainerType>()) {
+          arrays->push_back(GetRef<NDArray>(nd));
+        }
+      }
+    }
+  }
+}
+
+void VirtualMachineProfiler::InvokePacked(Index func_idx, const PackedFunc& func, TVMArgs args,
+                                          TVMRetValue* rv) {
+  if (!prof_ || !prof_.operator*().IsRunning()) {
+    VirtualMachine::InvokePacked(func_idx, func, args, rv);
+    return;
+  }
+  std::string name = exec_->func_names[func_idx];
+  int first_tensor_arg = 0;
+  if (exec_->global_map.count(name)) {
+    // Calls to Relax functions are not timed, their kernels are.
+    VirtualMachine::InvokePacked(func_idx, func, args, rv);
+    return;
+  } else if (name == "vm.call_tir_dyn") {
+    // args[0]: vm; args[1]: kernel name; args[2, ...]: tensors and the shape to unpack
+    name = args[1].operator std::string();
+    first_tensor_arg = 2;
+  }
+
+  std::vector<NDArray> arrays;
+  for (int i = first_tensor_arg; i < args.size(); ++i) {
+    CollectNDArrays(args[i], &arrays);
+  }
+  int64_t argument_bytes = 0;
+  for (const NDArray& array : arrays) {
+    argument_bytes += GetDataSize(*array.operator->());
+  }
+  // The device of any input of the call is used for synchronization, host calls such as
+  // shape computations are attributed to the host device.
+  Device dev = arrays.empty() ? devices.back() : arrays[0]->device;
+  std::unordered_map<std::string, ObjectRef> metrics;
+  metrics["Argument Shapes"] = profiling::ShapeString(arrays);
+  metrics["Argument Bytes"] = ObjectRef(make_object<profiling::CountNode>(argument_bytes));
+
+  prof_.operator*().StartCall(name, dev, metrics);
+  VirtualMachine::InvokePacked(func_idx, func, args, rv);
+  prof_.operator*().StopCall();
+}
+
+TVM_REGISTER_GLOBAL("relax.VirtualMachineProfiler").set_body([](TVMArgs args, TVMRetValue* rv) {
+  runtime::Module mod = args[0];
+  auto* exec = dynamic_cast<Executable*>(mod.operator->());
+  ICHECK(exec != nullptr) << "Expect a Relax VM executable";
+  auto vm = make_object<VirtualMachineProfiler>();
+  vm->LoadExecutable(GetObjectPtr<Executable>(exec));
+  *rv = runtime::Module(vm);
+});
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,62 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file src/runtime/relax_vm/profiler/vm.h
+ * \brief The Relax profiling virtual machine.
+ */
+
+#ifndef TVM_RUNTIME_RELAX_VM_PROFILER_VM_H_
+#define TVM_RUNTIME_RELAX_VM_PROFILER_VM_H_
+
+#include <dmlc/optional.h>
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/relax_vm/vm.h>
+
+#include <string>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief A virtual machine that times every packed function call with the profiler.
+ */
+class VirtualMachineProfiler : public VirtualMachine {
+ public:
+  VirtualMachineProfiler() : VirtualMachine(), prof_({}) {
+    // The builtins are timed in InvokePacked like the kernels.
+    direct_builtin_calls_ = false;
+  }
+
+  PackedFunc GetFunction(const std::string& name, const ObjectPtr<Object>& sptr_to_self) final;
+
+  ~VirtualMachineProfiler() {}
+
+ private:
+  void InvokePacked(Index func_idx, const PackedFunc& func, TVMArgs args, TVMRetValue* rv) final;
+
+  dmlc::optional<profiling::Profiler> prof_;
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_PROFILER_VM_H_
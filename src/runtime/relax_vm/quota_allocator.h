@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/runtime/relax_vm/quota_allocator.h
+ * \brief An allocator bounding the device memory held by the allocator of a tenant.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_QUOTA_ALLOCATOR_H_
+#define TVM_RUNTIME_RELAX_VM_QUOTA_ALLOCATOR_H_
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/relax_vm/memory_manager.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief An allocator which keeps the bytes held from the device by the allocator it wraps,
+ *  live and cached, under a quota.
+ *
+ * An allocation taking the held bytes over the quota first evicts the cached buffers, which are
+ * only kept for reuse. If the live buffers alone exceed the quota, a hard quota fails the
+ * allocation, while a soft one logs it and lets it through, and the buffers freed while the
+ * tenant is over its quota go back to the device instead of the cache.
+ */
+class QuotaAllocator final : public Allocator {
+ public:
+  QuotaAllocator(std::unique_ptr<Allocator> inner, std::string tenant, Device dev,
+                 size_t quota_bytes, bool hard)
+      : Allocator(inner->type()),
+        inner_(std::move(inner)),
+        tenant_(std::move(tenant)),
+        device_(dev),
+        quota_bytes_(quota_bytes),
+        hard_(hard) {}
+
+  /*!
+   * \brief Set the quota.
+   * \param quota_bytes The maximal number of bytes held from the device.
+   * \param hard Whether an allocation exceeding the quota fails.
+   */
+  void SetQuota(size_t quota_bytes, bool hard) {
+    quota_bytes_.store(quota_bytes, std::memory_order_relaxed);
+    hard_.store(hard, std::memory_order_relaxed);
+  }
+
+  /*! \brief The maximal number of bytes held from the device. */
+  size_t quota_bytes() const { return quota_bytes_.load(std::memory_order_relaxed); }
+
+  /*! \brief The number of allocations which evicted the cache. */
+  size_t num_evictions() const { return num_evictions_.load(std::memory_order_relaxed); }
+
+  /*! \brief The number of allocations which exceeded the quota after the eviction. */
+  size_t num_exceeded() const { return num_exceeded_.load(std::memory_order_relaxed); }
+
+  Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
+    Buffer buf = inner_->Alloc(nbytes, alignment, type_hint);
+    // A buffer served from the cache holds no more memory, the check only costs a load then.
+    size_t quota = quota_bytes_.load(std::memory_order_relaxed);
+    if (inner_->HeldBytes() <= quota) return buf;
+    inner_->ReleaseCache();
+    num_evictions_.fetch_add(1, std::memory_order_relaxed);
+    size_t held = inner_->HeldBytes();
+    if (held <= quota) return buf;
+    num_exceeded_.fetch_add(1, std::memory_order_relaxed);
+    if (hard_.load(std::memory_order_relaxed)) {
+      inner_->Free(buf);
+      inner_->ReleaseCache();
+      LOG(FATAL) << "MemoryError: allocating " << nbytes << " bytes on "
+                 << runtime::DeviceName(device_.device_type) << "(" << device_.device_id
+                 << ") takes the tenant " << tenant_ << " to " << held
+                 << " bytes, over its quota of " << quota << " bytes";
+    }
+    if (!warned_.exchange(true, std::memory_order_relaxed)) {
+      LOG(WARNING) << "The tenant " << tenant_ << " holds " << held << " bytes on "
+                   << runtime::DeviceName(device_.device_type) << "(" << device_.device_id
+                   << "), over its soft quota of " << quota << " bytes";
+    }
+    return buf;
+  }
+
+  void Free(const Buffer& buffer) override {
+    inner_->Free(buffer);
+    // A tenant over its soft quota keeps no freed buffer for reuse.
+    if (inner_->HeldBytes() > quota_bytes_.load(std::memory_order_relaxed)) {
+      inner_->ReleaseCache();
+    }
+  }
+
+  AllocatorStats Stats() override { return inner_->Stats(); }
+
+  size_t HeldBytes() override { return inner_->HeldBytes(); }
+
+  void ReleaseCache() override { inner_->ReleaseCache(); }
+
+ private:
+  std::unique_ptr<Allocator> inner_;
+  std::string tenant_;
+  Device device_;
+  std::atomic<size_t> quota_bytes_;
+  std::atomic<bool> hard_;
+  std::atomic<size_t> num_evictions_{0};
+  std::atomic<size_t> num_exceeded_{0};
+  /*! \brief Whether exceeding the soft quota was logged, only once to not flood the log. */
+  std::atomic<bool> warned_{false};
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_QUOTA_ALLOCATOR_H_
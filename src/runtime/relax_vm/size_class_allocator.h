@@ -0,0 +1,167 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file tvm/runtime/relax_vm/size_class_allocator.h
+ * \brief A caching allocator that rounds requests up to geometric size classes and serves
+ * them from the best-fitting cached block.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_SIZE_CLASS_ALLOCATOR_H_
+#define TVM_RUNTIME_RELAX_VM_SIZE_CLASS_ALLOCATOR_H_
+
+#include <tvm/runtime/device_api.h>
+#include <tvm/runtime/relax_vm/memory_manager.h>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <mutex>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief A caching allocator for dynamic-shape workloads.
+ *
+ * Requests are rounded up to geometric size classes (four classes per power of two), and a
+ * request is served by the smallest cached block that is at least as large as its class and
+ * at most kMaxSlack times the class. Blocks are not split: device memory handles are not
+ * addressable at arbitrary offsets on every backend, so a cached block is always handed out
+ * whole. The allocator keeps at most cache_limit bytes of freed blocks and releases the
+ * largest ones back to the device once the limit is exceeded.
+ */
+class SizeClassAllocator final : public Allocator {
+ public:
+  /*! \brief The minimal size class granularity in bytes. */
+  static constexpr size_t kMinBlockSize = 256;
+  /*! \brief The number of size classes per power of two. */
+  static constexpr size_t kClassesPerPowerOfTwo = 4;
+  /*! \brief The largest accepted ratio between a cached block and the requested class. */
+  static constexpr size_t kMaxSlack = 2;
+
+  explicit SizeClassAllocator(Device dev,
+                              size_t cache_limit = std::numeric_limits<size_t>::max())
+      : Allocator(kSizeClass), cache_limit_(cache_limit), device_(dev) {}
+
+  ~SizeClassAllocator() { ReleaseCached(0); }
+
+  Buffer Alloc(size_t nbytes, size_t alignment, DLDataType type_hint) override {
+    std::lock_guard<std::mutex> lock(mu_);
+    size_t size = SizeClass(nbytes);
+    ++stats_.num_allocs;
+    auto it = free_blocks_.lower_bound(size);
+    if (it != free_blocks_.end() && it->first <= size * kMaxSlack) {
+      Buffer buf = it->second;
+      free_blocks_.erase(it);
+      stats_.cached_bytes -= buf.size;
+      stats_.live_bytes += buf.size;
+      ++stats_.num_cache_hits;
+      return buf;
+    }
+    Buffer buf;
+    buf.device = device_;
+    buf.size = size;
+    try {
+      buf.data =
+          runtime::DeviceAPI::Get(device_)->AllocDataSpace(device_, size, alignment, type_hint);
+    } catch (InternalError& err) {
+      LOG(WARNING) << "SizeClassAllocator got InternalError during allocation: " << err.message();
+      LOG(WARNING) << "Trying to release all cached memory and reallocate...";
+      ReleaseCached(0);
+      buf.data =
+          runtime::DeviceAPI::Get(device_)->AllocDataSpace(device_, size, alignment, type_hint);
+    }
+    stats_.live_bytes += size;
+    stats_.peak_bytes = std::max(stats_.peak_bytes, stats_.live_bytes + stats_.cached_bytes);
+    DLOG(INFO) << "allocate " << size << " B, live memory " << stats_.live_bytes << " B";
+    return buf;
+  }
+
+  void Free(const Buffer& buffer) override {
+    if (FreeScopedBuffer(buffer)) return;
+    std::lock_guard<std::mutex> lock(mu_);
+    free_blocks_.emplace(buffer.size, buffer);
+    stats_.live_bytes -= buffer.size;
+    stats_.cached_bytes += buffer.size;
+    if (stats_.cached_bytes > cache_limit_) {
+      ReleaseCached(cache_limit_);
+    }
+    DLOG(INFO) << "reclaim buffer " << buffer.size;
+  }
+
+  AllocatorStats Stats() override {
+    std::lock_guard<std::mutex> lock(mu_);
+    return stats_;
+  }
+
+  /*!
+   * \brief Set the maximal number of bytes kept in the cache.
+   * \param cache_limit The cache limit in bytes.
+   */
+  void SetCacheLimit(size_t cache_limit) {
+    std::lock_guard<std::mutex> lock(mu_);
+    cache_limit_ = cache_limit;
+    ReleaseCached(cache_limit_);
+  }
+
+  void ReleaseCache() override {
+    std::lock_guard<std::mutex> lock(mu_);
+    ReleaseCached(0);
+  }
+
+ private:
+  /*! \brief Round the size up to its size class. */
+  static size_t SizeClass(size_t nbytes) {
+    if (nbytes <= kMinBlockSize) return kMinBlockSize;
+    size_t power = 1;
+    while (power * 2 <= nbytes) power *= 2;
+    size_t step = std::max(power / kClassesPerPowerOfTwo, kMinBlockSize);
+    return (nbytes + step - 1) / step * step;
+  }
+
+  /*!
+   * \brief Release the largest cached blocks until the cache holds at most limit bytes.
+   * \note The caller must hold the lock, except in the destructor.
+   */
+  void ReleaseCached(size_t limit) {
+    while (stats_.cached_bytes > limit && !free_blocks_.empty()) {
+      auto it = std::prev(free_blocks_.end());
+      const Buffer& buf = it->second;
+      runtime::DeviceAPI::Get(buf.device)->FreeDataSpace(buf.device, buf.data);
+      stats_.cached_bytes -= it->first;
+      free_blocks_.erase(it);
+    }
+    DLOG(INFO) << "release cached buffers, cached memory " << stats_.cached_bytes << " B";
+  }
+
+ private:
+  size_t cache_limit_;
+  AllocatorStats stats_;
+  std::multimap<size_t, Buffer> free_blocks_;
+  std::mutex mu_;
+  Device device_;
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_SIZE_CLASS_ALLOCATOR_H_
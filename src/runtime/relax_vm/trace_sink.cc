@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file src/runtime/relax_vm/trace_sink.cc
+ * \brief A sink of timeline events of the VM, exported in the Chrome trace event format.
+ */
+#include "trace_sink.h"
+
+#include <tvm/runtime/logging.h>
+
+#include <iomanip>
+#include <sstream>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+TraceSink::TraceSink(int64_t sample_every, int64_t max_events)
+    : sample_every_(sample_every),
+      max_events_(max_events),
+      origin_(std::chrono::steady_clock::now()) {
+  CHECK_GT(sample_every, 0) << "ValueError: the sampling interval must be positive";
+  CHECK_GT(max_events, 0) << "ValueError: the maximal number of events must be positive";
+}
+
+bool TraceSink::Sample() {
+  return num_invocations_.fetch_add(1, std::memory_order_relaxed) % sample_every_ == 0;
+}
+
+double TraceSink::Now() const {
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin_)
+      .count();
+}
+
+void TraceSink::Record(std::string name, const char* cat, int pid, int64_t tid, double ts,
+                       double dur) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (events_.size() >= max_events_) {
+    ++num_dropped_;
+    return;
+  }
+  events_.push_back(Event{std::move(name), cat, pid, tid, ts, dur});
+}
+
+int64_t TraceSink::ThreadId() {
+  // The id is cached per thread, for the last sink the thread has recorded to.
+  thread_local const TraceSink* sink = nullptr;
+  thread_local int64_t tid = 0;
+  if (sink != this) {
+    sink = this;
+    tid = next_thread_id_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return tid;
+}
+
+namespace {
+void WriteString(std::ostream& os, const std::string& str) {
+  os << '"';
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      os << '\\';
+    }
+    os << c;
+  }
+  os << '"';
+}
+}  // namespace
+
+std::string TraceSink::AsJSON() {
+  std::lock_guard<std::mutex> lock(mu_);
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(3);
+  os << "{\"traceEvents\":[";
+  os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kHostPid
+     << ",\"args\":{\"name\":\"host\"}},";
+  os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << kDevicePid
+     << ",\"args\":{\"name\":\"device\"}}";
+  for (const Event& event : events_) {
+    os << ",{\"name\":";
+    WriteString(os, event.name);
+    os << ",\"cat\":\"" << event.cat << "\",\"ph\":\"X\",\"pid\":" << event.pid
+       << ",\"tid\":" << event.tid << ",\"ts\":" << event.ts << ",\"dur\":" << event.dur << "}";
+  }
+  os << "],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":" << num_dropped_
+     << "}}";
+  return os.str();
+}
+
+void TraceSink::Clear() {
+  std::lock_guard<std::mutex> lock(mu_);
+  events_.clear();
+  num_dropped_ = 0;
+}
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
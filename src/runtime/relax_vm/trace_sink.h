@@ -0,0 +1,109 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file src/runtime/relax_vm/trace_sink.h
+ * \brief A sink of timeline events of the VM, exported in the Chrome trace event format.
+ */
+#ifndef TVM_RUNTIME_RELAX_VM_TRACE_SINK_H_
+#define TVM_RUNTIME_RELAX_VM_TRACE_SINK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*!
+ * \brief Record the begin and the end of the instructions of the VM, and the time taken by
+ *  their kernels on the devices, as a timeline which chrome://tracing and Perfetto can load.
+ *
+ * Only one of every sample_every invocations is traced, and the events beyond max_events are
+ * dropped, so that tracing can stay enabled in production with a bounded overhead.
+ *
+ * \note The sink is shared by the sessions of a VM, and is safe to call from any thread.
+ */
+class TraceSink {
+ public:
+  /*! \brief The process id of the host events. */
+  static constexpr int kHostPid = 0;
+  /*! \brief The process id of the device events, whose thread id is the device. */
+  static constexpr int kDevicePid = 1;
+
+  /*!
+   * \brief Constructor.
+   * \param sample_every Trace one of every sample_every invocations.
+   * \param max_events The maximal number of events kept, further events are dropped.
+   */
+  TraceSink(int64_t sample_every, int64_t max_events);
+  /*! \brief Whether to trace the invocation which is starting. */
+  bool Sample();
+  /*! \brief The current time in microseconds since the creation of the sink. */
+  double Now() const;
+  /*!
+   * \brief Record a complete event.
+   * \param name The name of the event.
+   * \param cat The category of the event.
+   * \param pid The process id, kHostPid or kDevicePid.
+   * \param tid The thread id, a host thread or a device.
+   * \param ts The begin time in microseconds, as given by Now.
+   * \param dur The duration in microseconds.
+   */
+  void Record(std::string name, const char* cat, int pid, int64_t tid, double ts, double dur);
+  /*! \brief The id of the calling thread in the timeline, dense from 0. */
+  int64_t ThreadId();
+  /*! \brief Get the recorded events as Chrome trace event JSON. */
+  std::string AsJSON();
+  /*! \brief Drop the recorded events. */
+  void Clear();
+
+ private:
+  struct Event {
+    std::string name;
+    const char* cat;
+    int pid;
+    int64_t tid;
+    double ts;
+    double dur;
+  };
+
+  /*! \brief The number of invocations between two traced ones. */
+  int64_t sample_every_;
+  /*! \brief The maximal number of events kept. */
+  size_t max_events_;
+  std::chrono::steady_clock::time_point origin_;
+  std::atomic<int64_t> num_invocations_{0};
+  std::atomic<int64_t> next_thread_id_{0};
+  std::mutex mu_;
+  std::vector<Event> events_;
+  /*! \brief The number of events dropped since the last Clear. */
+  int64_t num_dropped_ = 0;
+};
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
+
+#endif  // TVM_RUNTIME_RELAX_VM_TRACE_SINK_H_
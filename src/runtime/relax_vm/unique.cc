@@ -0,0 +1,243 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/*!
+ * \file src/runtime/relax_vm/unique.cc
+ * \brief The runtime of relax.unique: hash based and parallel on CPU, sort based with Thrust on
+ *  GPU, so that the unique elements stay on the device of the input. The elements are allocated
+ *  at the upper bound of their number, which the kernels write on the device.
+ */
+#include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/data_type.h>
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/ndarray.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/threading_backend.h>
+
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+
+/*! \brief The minimal number of elements hashed by a task. */
+static constexpr int64_t kMinElemsPerTask = 16384;
+
+/*!
+ * \brief The unique elements of the data, each with the index of its first occurrence.
+ *
+ *  Every task hashes a contiguous chunk of the data into one map per shard of the hash values,
+ *  then every task merges its shard across the chunks in order, so the first index seen is the
+ *  first occurrence and no map is shared between the tasks.
+ */
+template <typename T>
+static std::vector<std::pair<T, int64_t>> UniqueWithFirstIndex(const T* data, int64_t size) {
+  using Map = std::unordered_map<T, int64_t>;
+  struct Task {
+    const T* data;
+    int64_t size;
+    int num_task;
+    // The maps of the chunk of task t and the shard s, at t * num_task + s.
+    std::vector<Map> chunk_maps;
+    std::vector<std::vector<std::pair<T, int64_t>>> shards;
+  };
+  int num_task = static_cast<int>(std::min<int64_t>(
+      threading::MaxConcurrency(), (size + kMinElemsPerTask - 1) / kMinElemsPerTask));
+  num_task = std::max(num_task, 1);
+  Task task{data, size, num_task, std::vector<Map>(num_task * num_task),
+            std::vector<std::vector<std::pair<T, int64_t>>>(num_task)};
+
+  auto f_hash = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+    Task* task = static_cast<Task*>(cdata);
+    int64_t begin = task->size * task_id / task->num_task;
+    int64_t end = task->size * (task_id + 1) / task->num_task;
+    Map* maps = &task->chunk_maps[task_id * task->num_task];
+    std::hash<T> hasher;
+    for (int64_t i = begin; i < end; ++i) {
+      const T& value = task->data[i];
+      maps[hasher(value) % task->num_task].emplace(value, i);
+    }
+    return 0;
+  };
+  auto f_merge = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+    Task* task = static_cast<Task*>(cdata);
+    Map merged;
+    for (int chunk = 0; chunk < task->num_task; ++chunk) {
+      for (const auto& kv : task->chunk_maps[chunk * task->num_task + task_id]) {
+        merged.emplace(kv.first, kv.second);
+      }
+    }
+    task->shards[task_id].assign(merged.begin(), merged.end());
+    return 0;
+  };
+  if (num_task == 1) {
+    f_hash(0, nullptr, &task);
+    f_merge(0, nullptr, &task);
+  } else {
+    ICHECK_EQ(TVMBackendParallelLaunch(f_hash, &task, num_task), 0);
+    ICHECK_EQ(TVMBackendParallelLaunch(f_merge, &task, num_task), 0);
+  }
+  std::vector<std::pair<T, int64_t>> result;
+  for (const auto& shard : task.shards) {
+    result.insert(result.end(), shard.begin(), shard.end());
+  }
+  return result;
+}
+
+static int64_t NumElements(const NDArray& data) {
+  int64_t size = 1;
+  for (int i = 0; i < data->ndim; ++i) {
+    size *= data->shape[i];
+  }
+  return size;
+}
+
+/*! \brief Write the unique elements of the data on CPU to the front of out, return their number. */
+template <typename T>
+static int64_t UniqueCPU(const NDArray& data, bool sorted, const NDArray& out) {
+  int64_t size = NumElements(data);
+  const T* values =
+      reinterpret_cast<const T*>(static_cast<const char*>(data->data) + data->byte_offset);
+  std::vector<std::pair<T, int64_t>> unique = UniqueWithFirstIndex(values, size);
+  if (sorted) {
+    std::sort(unique.begin(), unique.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+  } else {
+    // The unsorted elements are in the reverse order of their first occurrences.
+    std::sort(unique.begin(), unique.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.second > rhs.second; });
+  }
+  T* out_values = static_cast<T*>(out->data);
+  for (size_t i = 0; i < unique.size(); ++i) {
+    out_values[i] = unique[i].first;
+  }
+  return unique.size();
+}
+
+#define TVM_UNIQUE_DISPATCH(DType, ...)                                     \
+  if (DType == DataType::Int(8)) {                                          \
+    using T = int8_t;                                                       \
+    __VA_ARGS__;                                                            \
+  } else if (DType == DataType::Int(16)) {                                  \
+    using T = int16_t;                                                      \
+    __VA_ARGS__;                                                            \
+  } else if (DType == DataType::Int(32)) {                                  \
+    using T = int32_t;                                                      \
+    __VA_ARGS__;                                                            \
+  } else if (DType == DataType::Int(64)) {                                  \
+    using T = int64_t;                                                      \
+    __VA_ARGS__;                                                            \
+  } else if (DType == DataType::UInt(8)) {                                  \
+    using T = uint8_t;                                                      \
+    __VA_ARGS__;                                                            \
+  } else if (DType == DataType::Float(32)) {                                \
+    using T = float;                                                        \
+    __VA_ARGS__;                                                            \
+  } else if (DType == DataType::Float(64)) {                                \
+    using T = double;                                                       \
+    __VA_ARGS__;                                                            \
+  } else {                                                                  \
+    LOG(FATAL) << "TypeError: unique does not support the dtype " << DType; \
+  }
+
+/*!
+ * \brief The unique elements of the flattened data, allocated at the upper bound of their number.
+ * \param data The data.
+ * \param sorted Whether the elements are sorted ascending, otherwise they are in the reverse
+ *  order of their first occurrences.
+ * \return The tuple of the 1-D buffer of the size of the data holding the unique elements first,
+ *  and of the 1-D int64 extent holding their number, both on the device of the data. On GPU the
+ *  extent is only written by the kernels, the host does not wait for it.
+ */
+ADT UniqueBounded(NDArray data, bool sorted) {
+  DataType dtype(data->dtype);
+  int64_t size = NumElements(data);
+  NDArray values = NDArray::Empty({size}, data->dtype, data->device);
+  NDArray extent = NDArray::Empty({1}, DataType::Int(64), data->device);
+  if (data->device.device_type == kDLCPU) {
+    int64_t num_unique = 0;
+    TVM_UNIQUE_DISPATCH(dtype, num_unique = UniqueCPU<T>(data, sorted, values));
+    static_cast<int64_t*>(extent->data)[0] = num_unique;
+    return ADT::Tuple(std::vector<ObjectRef>{values, extent});
+  }
+  static const PackedFunc* thrust_unique = Registry::Get("tvm.contrib.thrust.unique");
+  if (thrust_unique != nullptr && (data->device.device_type == kDLCUDA ||
+                                   data->device.device_type == kDLROCM)) {
+    (*thrust_unique)(data, values, extent, sorted);
+    return ADT::Tuple(std::vector<ObjectRef>{values, extent});
+  }
+  // The other devices compute on the host.
+  Device cpu{kDLCPU, 0};
+  ADT result = UniqueBounded(data.CopyTo(cpu), sorted);
+  return ADT::Tuple(std::vector<ObjectRef>{Downcast<NDArray>(result[0]).CopyTo(data->device),
+                                           Downcast<NDArray>(result[1]).CopyTo(data->device)});
+}
+
+/*!
+ * \brief View the leading entries of the data allocated at an upper bound along its first axis.
+ * \param data The data.
+ * \param extent The 1-D int64 number of the valid entries, read on the host, so this waits for
+ *  the kernels writing it when it is on a GPU.
+ * \return The view of the valid entries.
+ */
+NDArray ResolveBound(NDArray data, NDArray extent) {
+  ICHECK_GE(data->ndim, 1) << "ValueError: resolve_bound expects a tensor of at least one axis";
+  ICHECK(data.IsContiguous()) << "ValueError: resolve_bound expects a compact tensor";
+  if (extent->device.device_type != kDLCPU) {
+    extent = extent.CopyTo(Device{kDLCPU, 0});
+  }
+  ICHECK_EQ(DataType(extent->dtype), DataType::Int(64));
+  int64_t num_valid = static_cast<int64_t*>(extent->data)[0];
+  ICHECK(num_valid >= 0 && num_valid <= data->shape[0])
+      << "ValueError: the extent " << num_valid << " exceeds the bound " << data->shape[0];
+  std::vector<int64_t> shape(data->shape, data->shape + data->ndim);
+  shape[0] = num_valid;
+  return data.CreateView(ShapeTuple(shape), data->dtype);
+}
+
+static void CheckUniqueAttrs(bool return_inverse, bool return_counts, int dim) {
+  CHECK(!return_inverse && !return_counts)
+      << "NotImplementedError: unique does not support return_inverse or return_counts";
+  CHECK_LT(dim, 0) << "NotImplementedError: unique only supports the flattened input";
+}
+
+TVM_REGISTER_GLOBAL("relax.run.unique")
+    .set_body_typed([](NDArray data, bool sorted, bool return_inverse, bool return_counts,
+                       int dim) {
+      CheckUniqueAttrs(return_inverse, return_counts, dim);
+      ADT bounded = UniqueBounded(data, sorted);
+      return ResolveBound(Downcast<NDArray>(bounded[0]), Downcast<NDArray>(bounded[1]));
+    });
+
+TVM_REGISTER_GLOBAL("relax.run.unique_bounded")
+    .set_body_typed([](NDArray data, bool sorted, bool return_inverse, bool return_counts,
+                       int dim) {
+      CheckUniqueAttrs(return_inverse, return_counts, dim);
+      return UniqueBounded(data, sorted);
+    });
+
+TVM_REGISTER_GLOBAL("vm.builtin.resolve_bound").set_body_typed(ResolveBound);
+
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
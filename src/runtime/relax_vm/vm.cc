@@ -21,9 +21,27 @@
  * \file src/runtime/relax_vm/vm.cc
  */
 
+#include <tvm/runtime/c_backend_api.h>
 #include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/packed_func.h>
+#include <tvm/runtime/profiling.h>
+#include <tvm/runtime/registry.h>
 #include <tvm/runtime/relax_vm/vm.h>
+#include <tvm/runtime/threading_backend.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <unordered_set>
+
+#include "../workspace_pool.h"
+#include "constant_store.h"
+#include "constant_uploader.h"
+#include "kernel_capture.h"
+#include "kernel_jit.h"
+#include "latency_histogram.h"
+#include "trace_sink.h"
 
 namespace tvm {
 namespace runtime {
@@ -31,15 +49,78 @@ namespace relax_vm {
 
 inline TVMRetValue CopyConstantTo(TVMRetValue src, const DLDevice& dev) {
   NDArray nd_array = src.operator tvm::runtime::NDArray();
+  TVMRetValue ret;
   if (nd_array->device.device_type == dev.device_type &&
       nd_array->device.device_id == dev.device_id) {
-    return src;
+    if (dev.device_type != kDLCPU) return src;
+    // The host constants are shared with the other VMs and the BYOC modules of the process.
+    ret = ConstantStore::Global()->Share(nd_array);
+    return ret;
+  }
+  if (nd_array->device.device_type == kDLCPU) {
+    // Host constants are uploaded through the constant store, so that identical weights are
+    // shared by all the VMs in the process.
+    ret = ConstantStore::Global()->CopyTo(nd_array, dev);
+  } else {
+    ret = nd_array.CopyTo(dev);
   }
-  TVMRetValue ret;
-  ret = nd_array.CopyTo(dev);
   return ret;
 }
 
+/*!
+ * \brief The value of an object argument of a direct invocation: an Array, e.g. a nested Python
+ *  tuple passed through the FFI as is, becomes an ADT tuple of the values of its fields.
+ */
+static ObjectRef ConvertArgument(ObjectRef arg) {
+  const auto* array = arg.as<ArrayNode>();
+  if (array == nullptr) return arg;
+  std::vector<ObjectRef> fields;
+  fields.reserve(array->size());
+  for (const ObjectRef& field : *array) {
+    fields.push_back(ConvertArgument(field));
+  }
+  return ADT::Tuple(fields);
+}
+
+/*!
+ * \brief The register of an argument of a direct invocation. A DLTensor, e.g. the one of a DLPack
+ *  capsule, is viewed as an NDArray, without a copy unless it is misaligned, so that the callers
+ *  need not wrap the tensors of other frameworks in the Python frontend.
+ */
+static RegType ConvertArgument(const TVMArgValue& arg) {
+  RegType reg;
+  if (arg.type_code() == kTVMDLTensorHandle) {
+    DLTensor* tensor = arg;
+    if (NDArray::AbilityOfZeroCopyForDLTensor(tensor, tensor->device)) {
+      reg = NDArray::FromExternalDLTensor(*tensor);
+    } else {
+      reg = NDArray::NewFromDLTensor(tensor, tensor->device);
+    }
+  } else if (arg.type_code() == kTVMObjectHandle) {
+    reg = ConvertArgument(arg.operator ObjectRef());
+  } else {
+    reg = arg;
+  }
+  return reg;
+}
+
+/*! \brief The direct-call entries of the VM builtins, registered at static initialization. */
+static std::unordered_map<std::string, VMBuiltin>* VMBuiltinRegistry() {
+  static auto* registry = new std::unordered_map<std::string, VMBuiltin>();
+  return registry;
+}
+
+bool RegisterVMBuiltin(const std::string& name, VMBuiltin func) {
+  ICHECK(VMBuiltinRegistry()->emplace(name, func).second)
+      << "The VM builtin " << name << " is already registered";
+  return true;
+}
+
+VMBuiltin GetVMBuiltin(const std::string& name) {
+  auto it = VMBuiltinRegistry()->find(name);
+  return it == VMBuiltinRegistry()->end() ? nullptr : it->second;
+}
+
 VMFunction VirtualMachine::LookupVMFunction(const std::string& func_name) {
   ICHECK(exec_) << "The executable is not created yet.";
   const auto& m = this->exec_->global_map;
@@ -51,17 +132,54 @@ VMFunction VirtualMachine::LookupVMFunction(const std::string& func_name) {
   return vm_func;
 }
 
+/*! \brief The hooks forwarding the events to a packed function, e.g. one defined in Python. */
+class PackedFuncHooks : public VMHooks {
+ public:
+  explicit PackedFuncHooks(PackedFunc callback) : callback_(std::move(callback)) {}
+
+  void OnInvokeBegin(const std::string& func_name) final {
+    callback_("invoke_begin", func_name, 0);
+  }
+  void OnInvokeEnd(const std::string& func_name) final { callback_("invoke_end", func_name, 0); }
+  void OnInstrBegin(int64_t pc, const std::string& name) final {
+    callback_("instr_begin", name, pc);
+  }
+  void OnInstrEnd(int64_t pc, const std::string& name) final { callback_("instr_end", name, pc); }
+  void OnAlloc(Device dev, size_t nbytes, const std::string& mem_scope) final {
+    std::ostringstream os;
+    os << dev;
+    if (!mem_scope.empty()) os << ":" << mem_scope;
+    callback_("alloc", os.str(), static_cast<int64_t>(nbytes));
+  }
+
+ private:
+  PackedFunc callback_;
+};
+
 PackedFunc VirtualMachine::GetFunction(const std::string& name,
                                        const ObjectPtr<Object>& sptr_to_self) {
   if (name == "vm_initialization") {
     // initialize the VirtualMachine, takes variable-length arguments
     // first argument is a runtime::Module, followed by one or more device_type, device_id,
-    // and the AllocatorType associated with the device.
+    // and the AllocatorType associated with the device, and optionally by the options, each
+    // a string key followed by its values:
+    // - "async_constant_upload", whether to upload the constants in the background, in the order
+    //   of their first use, so that the first invocation waits for each constant as it uses it
+    //   instead of for all of them, see ConstantUploader.
+    // - "memory_quota", the tenant, the quota in bytes and the policy, "hard" or "soft": the
+    //   VM allocates from the allocators of the tenant, which hold at most the quota on each
+    //   of its devices, see QuotaAllocator.
+    // - otherwise the backend of the communicator of a distributed run, followed by the rank
+    //   and the world size of this process as a ShapeTuple, and the id shared by the processes.
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
-      ICHECK_EQ(args.size() % 3, 0);
+      int num_device_args = 0;
+      while (num_device_args < args.size() && args[num_device_args].type_code() != kTVMStr) {
+        num_device_args += 3;
+      }
+      ICHECK_LE(num_device_args, args.size());
       std::vector<Device> devices;
       std::vector<AllocatorType> alloc_types;
-      for (int i = 0; i < args.size(); i += 3) {
+      for (int i = 0; i < num_device_args; i += 3) {
         Device dev;
         int device_type = args[i];
         dev.device_type = DLDeviceType(device_type);
@@ -71,16 +189,97 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
         alloc_types.push_back(AllocatorType(type));
       }
       this->Init(devices, alloc_types);
+      int ccl_args = -1;
+      bool async_constant_upload = false;
+      for (int i = num_device_args; i < args.size();) {
+        std::string key = args[i];
+        if (key == "async_constant_upload") {
+          ICHECK_LE(i + 2, args.size()) << "ValueError: async_constant_upload requires a value";
+          async_constant_upload = args[i + 1];
+          i += 2;
+        } else if (key == "memory_quota") {
+          ICHECK_LE(i + 4, args.size()) << "ValueError: memory_quota requires the tenant, the "
+                                        << "quota and the policy";
+          std::string tenant = args[i + 1];
+          int64_t quota_bytes = args[i + 2];
+          std::string policy = args[i + 3];
+          CHECK_GE(quota_bytes, 0) << "ValueError: the memory quota must be non-negative";
+          CHECK(policy == "hard" || policy == "soft")
+              << "ValueError: the memory quota policy must be hard or soft, but got " << policy;
+          for (size_t j = 0; j < devices.size(); ++j) {
+            this->allocators[j] = MemoryManager::GetOrCreateTenantAllocator(
+                tenant, devices[j], alloc_types[j], quota_bytes, policy == "hard");
+          }
+          i += 4;
+        } else {
+          ICHECK_LE(i + 3, args.size());
+          ccl_args = i;
+          i += 3;
+        }
+      }
+      this->InitFuncTable();
 
-      // Copy NDArray constants to the devices
-      // TODO(tvm-team): support multiple devices
+      // Copy NDArray constants to the primary device, copies to the other devices are made
+      // on demand by vm.builtin.to_device and kept in per-device constant pools.
+      this->constant_uploader_.reset();
+      this->constants.clear();
       this->constants.reserve(exec_->constants.size());
+      this->constant_index_.clear();
       for (const auto& constant : exec_->constants) {
         if (constant.type_code() != kTVMNDArrayHandle) {
           this->constants.push_back(constant);
+        } else if (async_constant_upload) {
+          // Filled in by the uploader.
+          this->constants.emplace_back();
         } else {
           this->constants.push_back(CopyConstantTo(constant, devices[0]));
+          this->constant_index_[this->constants.back().operator NDArray().get()] =
+              this->constants.size() - 1;
+        }
+      }
+      this->device_constants_ = std::make_shared<DeviceConstantPools>();
+      this->device_constants_->pools.resize(devices.size());
+      if (async_constant_upload) {
+        // The instructions are laid out function by function, in program order, which
+        // approximates the order in which the constants are first used. The constants not used
+        // by any instruction, e.g. those of the compiled functions, come last.
+        std::vector<int64_t> order;
+        std::vector<bool> ordered(exec_->constants.size(), false);
+        auto f_add = [&](Instruction::Arg arg) {
+          if (arg.kind() != Instruction::kConstIdx || ordered[arg.value()]) return;
+          if (exec_->constants[arg.value()].type_code() != kTVMNDArrayHandle) return;
+          ordered[arg.value()] = true;
+          order.push_back(arg.value());
+        };
+        for (const Instruction& instr : instrs_) {
+          if (instr.op == Opcode::Call) {
+            for (Index i = 0; i < instr.num_args; ++i) f_add(instr.args[i]);
+          } else if (instr.op == Opcode::Move) {
+            f_add(Instruction::Arg(instr.src));
+          }
+        }
+        for (size_t i = 0; i < exec_->constants.size(); ++i) {
+          if (!ordered[i] && exec_->constants[i].type_code() == kTVMNDArrayHandle) {
+            order.push_back(i);
+          }
         }
+        Device dev = devices[0];
+        this->constant_uploader_ = std::make_unique<ConstantUploader>(
+            &this->constants, exec_->constants, std::move(order),
+            [dev](const TVMRetValue& constant) { return CopyConstantTo(constant, dev); });
+      }
+
+      // The id is created once, e.g. by runtime.relax_vm.nccl.unique_id on the first rank, and
+      // handed to the other processes. The communicator of this process is on its first device.
+      if (ccl_args >= 0) {
+        std::string backend = args[ccl_args];
+        const PackedFunc* init_comm = Registry::Get("runtime.relax_vm." + backend + ".init_comm");
+        ICHECK(init_comm != nullptr) << "The collective communication backend " << backend
+                                     << " is not enabled in this build of TVM.";
+        ShapeTuple rank_and_world_size = args[ccl_args + 1];
+        ICHECK_EQ(rank_and_world_size.size(), 2);
+        String unique_id = args[ccl_args + 2];
+        this->ccl_comm = (*init_comm)(rank_and_world_size, unique_id, devices[0]);
       }
     });
   } else if (name == "invoke_closure") {
@@ -88,29 +287,237 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
       ICHECK(exec_) << "The executable is not created yet.";
       VMClosure clo = args[0];
       Array<ObjectRef> func_args = args[1];
-      std::vector<RegType> new_args;
-      for (auto f_arg : func_args) {
-        TVMRetValue arg;
-        arg = f_arg;
-        new_args.push_back(arg);
-      }
-      // Append the free variables of closure
-      auto free_vars = clo->free_vars;
-      for (auto f_var : free_vars) {
-        TVMRetValue arg;
-        arg = f_var;
-        new_args.push_back(arg);
-      }
-
-      String func_name = clo->func_name;
-      auto it = exec_->global_map.find(func_name);
-      ICHECK(it != exec_->global_map.end()) << "No such function " << func_name;
-      Index func_idx = it->second;
-      *rv = Invoke(func_idx, new_args);
+      std::vector<TVMValue> values(func_args.size());
+      std::vector<int> tcodes(func_args.size());
+      runtime::TVMArgsSetter setter(values.data(), tcodes.data());
+      for (size_t i = 0; i < func_args.size(); ++i) {
+        setter(i, func_args[i]);
+      }
+      this->InvokeClosure(clo, TVMArgs(values.data(), tcodes.data(), values.size()), rv);
     });
   } else if (name == "set_input") {
     return PackedFunc(
         [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { SetInput(args[0], args, 1); });
+  } else if (name == "invoke_stateful") {
+    // Invoke a function on the inputs given by set_input and keep the result for get_output,
+    // so that the call takes no tensor argument and can be timed over RPC.
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::string func_name = args[0];
+      const auto& m = exec_->global_map;
+      ICHECK(m.find(func_name) != m.end()) << "ValueError: Unknown function: " << func_name;
+      auto it = inputs_.find(func_name);
+      CHECK(it != inputs_.end()) << "ValueError: No input was set for function " << func_name
+                                 << ", please call set_input first.";
+      outputs_[func_name] = this->Invoke(m.at(func_name), it->second);
+    });
+  } else if (name == "get_output") {
+    // args[0]: function name; args[1]: optional index of a tuple output
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::string func_name = args[0];
+      auto it = outputs_.find(func_name);
+      CHECK(it != outputs_.end()) << "ValueError: No output is recorded for function "
+                                  << func_name << ", please call invoke_stateful first.";
+      if (args.size() == 1) {
+        *rv = it->second;
+      } else {
+        ADT adt = it->second.operator ADT();
+        int index = args[1];
+        CHECK(index >= 0 && static_cast<size_t>(index) < adt.size())
+            << "ValueError: Invalid output index " << index << " of function " << func_name;
+        *rv = adt[index];
+      }
+    });
+  } else if (name == "enable_shape_jit") {
+    // args[0]: compile function; args[1]: threshold; args[2]: maximal number of shapes per kernel
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      PackedFunc compile = args[0];
+      this->kernel_jit_ = std::make_shared<KernelJIT>(compile, args[1], args[2]);
+    });
+  } else if (name == "shape_jit_stats") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK(this->kernel_jit_ != nullptr) << "The shape JIT is not enabled.";
+      *rv = String(this->kernel_jit_->Stats());
+    });
+  } else if (name == "shape_jit_preload") {
+    // args[0]: kernel name; args[1]: the values of its symbolic variables
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK(this->kernel_jit_ != nullptr) << "The shape JIT is not enabled.";
+      this->kernel_jit_->Preload(args[0], args[1]);
+    });
+  } else if (name == "shape_jit_wait") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK(this->kernel_jit_ != nullptr) << "The shape JIT is not enabled.";
+      this->kernel_jit_->WaitIdle();
+    });
+  } else if (name == "get_snapshot") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { *rv = String(this->GetSnapshot()); });
+  } else if (name == "set_trace") {
+    // args[0]: trace one of every args[0] invocations, 0 disables tracing;
+    // args[1]: the maximal number of events kept
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      int64_t sample_every = args[0];
+      CHECK_GE(sample_every, 0) << "ValueError: The sampling interval can not be negative";
+      if (sample_every == 0) {
+        this->trace_sink_ = nullptr;
+      } else {
+        this->trace_sink_ = std::make_shared<TraceSink>(sample_every, args[1]);
+      }
+    });
+  } else if (name == "get_trace") {
+    // args[0]: whether to drop the returned events
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK(this->trace_sink_ != nullptr) << "The tracing is not enabled.";
+      *rv = String(this->trace_sink_->AsJSON());
+      if (args.size() > 0 && args[0].operator bool()) {
+        this->trace_sink_->Clear();
+      }
+    });
+  } else if (name == "set_latency_stats") {
+    // args[0]: whether to record the latency of every function invocation
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ICHECK(exec_) << "The executable is not created yet.";
+      if (args[0].operator bool()) {
+        std::vector<std::string> names;
+        for (const VMFunction& func : exec_->global_funcs) {
+          names.push_back(func.name);
+        }
+        this->latency_stats_ = std::make_shared<FunctionLatencyStats>(std::move(names));
+      } else {
+        this->latency_stats_ = nullptr;
+      }
+    });
+  } else if (name == "get_stats") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK(this->latency_stats_ != nullptr) << "The latency statistics are not enabled.";
+      *rv = String(this->latency_stats_->AsJSON());
+    });
+  } else if (name == "set_kernel_capture") {
+    // args[0]: the regular expression searched in the names of the captured kernels
+    // args[1]: the number of outputs kept, 0 disables the capture
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      ICHECK(exec_) << "The executable is not created yet.";
+      std::string pattern = args[0];
+      int64_t capacity = args[1];
+      CHECK_GE(capacity, 0) << "ValueError: The capacity of the capture can not be negative";
+      if (capacity > 0) {
+        this->kernel_capture_ =
+            std::make_shared<KernelCapture>(exec_->func_names, pattern, capacity);
+      } else {
+        this->kernel_capture_ = nullptr;
+      }
+    });
+  } else if (name == "get_kernel_capture") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      CHECK(this->kernel_capture_ != nullptr) << "The kernel capture is not enabled.";
+      *rv = this->kernel_capture_->Records();
+    });
+  } else if (name == "set_hooks") {
+    // args[0]: the callback of the events, called with the event, the name of the function,
+    //          the instruction or the device, and the pc or the size, null unregisters the hooks
+    // args[1]: whether to report the instructions
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      if (args[0].type_code() == kTVMNullptr) {
+        this->SetHooks(nullptr);
+      } else {
+        auto hooks = std::make_shared<PackedFuncHooks>(args[0].operator PackedFunc());
+        hooks->instruction_hooks = args[1];
+        this->SetHooks(std::move(hooks));
+      }
+    });
+  } else if (name == "set_max_parallelism") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { SetMaxParallelism(args[0]); });
+  } else if (name == "set_persistent_parallel_region") {
+    // args[0]: whether to enable; args[1]: the spin count of the workers, 0 keeps the current one
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      this->persistent_parallel_region_ = args[0];
+      int spin_count = args[1];
+      CHECK_GE(spin_count, 0) << "ValueError: The spin count can not be negative";
+      if (spin_count > 0) {
+        threading::ConfigurePersistentRegion(spin_count);
+      }
+    });
+  } else if (name == "set_workspace_arena") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->workspace_arena_ = args[0]; });
+  } else if (name == "set_stream") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      // args[0]: device index; args[1]: the stream handle, nullptr for the default stream
+      this->SetDefaultStream(args[0], args[1].operator void*());
+    });
+  } else if (name == "invoke_cuda_graph") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      // args[0]: function name; args[1, 2, ...]: function arguments
+      const PackedFunc* f_run = Registry::Get("vm.builtin.cuda_graph.run");
+      ICHECK(f_run != nullptr) << "vm.builtin.cuda_graph.run is not enabled, please build with "
+                                  "USE_CUDA=ON";
+      std::vector<TVMValue> values(args.size() + 1);
+      std::vector<int> tcodes(args.size() + 1);
+      runtime::TVMArgsSetter setter(values.data(), tcodes.data());
+      setter(0, static_cast<void*>(this));
+      for (int i = 0; i < args.size(); ++i) {
+        values[i + 1] = args.values[i];
+        tcodes[i + 1] = args.type_codes[i];
+      }
+      f_run->CallPacked(TVMArgs(values.data(), tcodes.data(), values.size()), rv);
+    });
+  } else if (name == "invoke_with_outputs") {
+    // args[0]: function name; args[1, ..., num_inputs]: inputs; the rest: output buffers.
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      std::string func_name = args[0];
+      const VMFunction& vm_func = LookupVMFunction(func_name);
+      Index gf_idx = exec_->global_map.at(func_name);
+      int num_inputs = vm_func.num_args;
+      ICHECK_GE(args.size() - 1, num_inputs)
+          << "ValueError: Invoking function " << func_name << " requires " << num_inputs
+          << " inputs but only " << args.size() - 1 << " arguments are provided.";
+      // Inputs and outputs given as DLTensors are aliased when possible.
+      std::vector<RegType> inputs(num_inputs);
+      for (int i = 0; i < num_inputs; ++i) {
+        SetInputTensorWithIndex(inputs, args[i + 1], i, devices[0], nullptr);
+      }
+      std::vector<DLTensor*> outputs;
+      output_buffers_.clear();
+      for (int i = num_inputs + 1; i < args.size(); ++i) {
+        DLTensor* out = args[i];
+        outputs.push_back(out);
+        if (args[i].type_code() == kTVMNDArrayHandle) {
+          output_buffers_.push_back(args[i].operator NDArray());
+        } else if (NDArray::AbilityOfZeroCopyForDLTensor(out, out->device)) {
+          output_buffers_.push_back(NDArray::FromExternalDLTensor(*out));
+        } else {
+          output_buffers_.push_back(NDArray());
+        }
+      }
+      RegType ret = this->Invoke(gf_idx, inputs);
+      output_buffers_.clear();
+      // Copy the results that were not computed in place into the output buffers.
+      std::vector<NDArray> results;
+      if (ret.type_code() == kTVMNDArrayHandle) {
+        results.push_back(ret.operator NDArray());
+      } else {
+        ADT adt = ret.operator ADT();
+        for (size_t i = 0; i < adt.size(); ++i) {
+          results.push_back(Downcast<NDArray>(adt[i]));
+        }
+      }
+      ICHECK_EQ(results.size(), outputs.size())
+          << "ValueError: Function " << func_name << " has " << results.size()
+          << " outputs but " << outputs.size() << " output buffers are provided.";
+      for (size_t i = 0; i < outputs.size(); ++i) {
+        if (results[i]->data != outputs[i]->data) {
+          NDArray::CopyFromTo(results[i].operator->(), outputs[i]);
+        }
+      }
+    });
+  } else if (name == "create_session") {
+    return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
+      *rv = Module(this->CreateSession());
+    });
+  } else if (name == "clear_storage_cache") {
+    return PackedFunc(
+        [sptr_to_self, this](TVMArgs args, TVMRetValue* rv) { this->storage_cache_.clear(); });
   } else if (name == "get_function_arity") {
     return PackedFunc([sptr_to_self, this](TVMArgs args, TVMRetValue* rv) {
       std::string func_name = args[0];
@@ -135,12 +542,14 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
     Index gf_idx = m.at(name);
     return PackedFunc([sptr_to_self, this, gf_idx, name](TVMArgs args, TVMRetValue* rv) {
       if (inputs_.count(name)) {
+        this->RecordSignature(gf_idx, inputs_[name]);
         *rv = this->Invoke(gf_idx, inputs_[name]);
       } else {
         std::vector<RegType> inputs(args.size());
         for (int i = 0; i < args.size(); ++i) {
-          inputs[i] = args[i];
+          inputs[i] = ConvertArgument(args[i]);
         }
+        this->RecordSignature(gf_idx, inputs);
         *rv = this->Invoke(gf_idx, inputs);
       }
     });
@@ -150,14 +559,187 @@ PackedFunc VirtualMachine::GetFunction(const std::string& name,
   }
 }
 
+/*!
+ * \brief Write the signature of a register to a JSON stream: an NDArray by its shape, dtype and
+ *  device, an ADT by the list of the signatures of its fields, and the other values as null,
+ *  which the snapshot cannot create.
+ */
+static void WriteSignature(std::ostream& os, const ObjectRef& value) {
+  if (const auto* array = value.as<NDArray::Container>()) {
+    os << "{\"shape\": [";
+    for (int i = 0; i < array->dl_tensor.ndim; ++i) {
+      os << (i ? ", " : "") << array->dl_tensor.shape[i];
+    }
+    os << "], \"dtype\": \"" << DLDataType2String(array->dl_tensor.dtype) << "\", \"device\": ["
+       << array->dl_tensor.device.device_type << ", " << array->dl_tensor.device.device_id << "]}";
+  } else if (const auto* adt = value.as<ADTObj>()) {
+    os << "[";
+    for (size_t i = 0; i < adt->size; ++i) {
+      os << (i ? ", " : "");
+      WriteSignature(os, (*adt)[i]);
+    }
+    os << "]";
+  } else {
+    os << "null";
+  }
+}
+
+void VirtualMachine::RecordSignature(Index gf_idx, const std::vector<RegType>& args) {
+  if (signatures_.size() != exec_->global_funcs.size()) {
+    signatures_.resize(exec_->global_funcs.size());
+  }
+  if (!signatures_[gf_idx].empty()) return;
+  std::ostringstream os;
+  os << "[";
+  for (size_t i = 0; i < args.size(); ++i) {
+    os << (i ? ", " : "");
+    if (args[i].type_code() == kTVMObjectHandle || args[i].type_code() == kTVMNDArrayHandle) {
+      WriteSignature(os, args[i].operator ObjectRef());
+    } else {
+      os << "null";
+    }
+  }
+  os << "]";
+  signatures_[gf_idx] = os.str();
+}
+
+std::string VirtualMachine::GetSnapshot() {
+  std::ostringstream os;
+  os << "{\"version\": 1, \"functions\": {";
+  bool first = true;
+  for (size_t i = 0; i < signatures_.size(); ++i) {
+    if (signatures_[i].empty()) continue;
+    os << (first ? "" : ", ") << "\"" << exec_->global_funcs[i].name << "\": " << signatures_[i];
+    first = false;
+  }
+  os << "}, \"shape_jit\": [";
+  if (kernel_jit_ != nullptr) {
+    first = true;
+    for (const auto& kv : kernel_jit_->SpecializedShapes()) {
+      os << (first ? "" : ", ") << "[\"" << kv.first << "\", [";
+      for (size_t i = 0; i < kv.second.size(); ++i) {
+        os << (i ? ", " : "") << kv.second[i];
+      }
+      os << "]]";
+      first = false;
+    }
+  }
+  os << "]}";
+  return os.str();
+}
+
 void VirtualMachine::LoadExecutable(ObjectPtr<Executable> exec) {
   this->exec_ = exec;
   CHECK_LE(exec_->imports().size(), 1);
   this->lib = exec_->imports().empty() ? Optional<Module>(NullOpt) : exec_->imports()[0];
+  Index num_instrs = exec_->instr_offset.size();
+  this->instrs_.clear();
+  this->instrs_.reserve(num_instrs + 1);
+  for (Index pc = 0; pc < num_instrs; ++pc) {
+    Instruction instr = exec_->GetInstruction(pc);
+    if (instr.op == Opcode::Goto || instr.op == Opcode::If) {
+      Index target = pc + (instr.op == Opcode::Goto ? instr.pc_offset : instr.false_offset);
+      ICHECK(target >= 0 && target < num_instrs)
+          << "The jump at pc " << pc << " targets " << target << ", which is out of the "
+          << num_instrs << " instructions of the executable";
+    }
+    this->instrs_.push_back(instr);
+  }
+  // The sentinel has no valid opcode and is dispatched to the invalid instruction handler.
+  Instruction sentinel;
+  sentinel.op = static_cast<Opcode>(0);
+  this->instrs_.push_back(sentinel);
 }
 
+/*!
+ * \brief Report an invocation to the hooks of the VM, including its end when it throws.
+ *  The functions tail called from its frame end with it.
+ */
+class InvokeHookScope {
+ public:
+  InvokeHookScope(std::shared_ptr<VMHooks> hooks, const std::string& func_name,
+                  std::vector<const std::string*>* tail_calls)
+      : hooks_(std::move(hooks)),
+        func_name_(func_name),
+        tail_calls_(tail_calls),
+        num_tail_calls_(tail_calls->size()) {
+    if (hooks_ != nullptr) hooks_->OnInvokeBegin(func_name_);
+  }
+
+  /*! \brief Report the end of the invocation, which returned. */
+  void End() {
+    ended_ = true;
+    Report();
+  }
+
+  ~InvokeHookScope() {
+    if (!ended_) {
+      // The invocation threw, the hooks must not throw while unwinding.
+      try {
+        Report();
+      } catch (...) {
+      }
+    }
+    if (tail_calls_->size() > num_tail_calls_) tail_calls_->resize(num_tail_calls_);
+  }
+
+ private:
+  void Report() {
+    while (tail_calls_->size() > num_tail_calls_) {
+      const std::string* callee = tail_calls_->back();
+      tail_calls_->pop_back();
+      if (hooks_ != nullptr) hooks_->OnInvokeEnd(*callee);
+    }
+    if (hooks_ != nullptr) hooks_->OnInvokeEnd(func_name_);
+  }
+
+  std::shared_ptr<VMHooks> hooks_;
+  const std::string& func_name_;
+  std::vector<const std::string*>* tail_calls_;
+  size_t num_tail_calls_;
+  bool ended_{false};
+};
+
+/*!
+ * \brief Queue the kernels of an invocation on the default streams replaced by SetDefaultStream,
+ *  and restore the default streams of the devices at the end of the invocation.
+ */
+class DefaultStreamScope {
+ public:
+  explicit DefaultStreamScope(VirtualMachine* vm) {
+    if (vm == nullptr) return;
+    for (size_t i = 0; i < vm->devices.size(); ++i) {
+      TVMStreamHandle stream = vm->GetStream(i, 0);
+      if (stream == nullptr) continue;
+      DeviceAPI::Get(vm->devices[i])->SetStream(vm->devices[i], stream);
+      devices_.push_back(vm->devices[i]);
+    }
+  }
+
+  ~DefaultStreamScope() {
+    for (const Device& dev : devices_) {
+      DeviceAPI::Get(dev)->SetStream(dev, nullptr);
+    }
+  }
+
+ private:
+  /*! \brief The devices whose stream is replaced. */
+  std::vector<Device> devices_;
+};
+
 RegType VirtualMachine::Invoke(Index gf_idx, const std::vector<RegType>& args) {
   const VMFunction& gfunc = exec_->global_funcs[gf_idx];
+  std::chrono::steady_clock::time_point start;
+  if (latency_stats_ != nullptr) {
+    start = std::chrono::steady_clock::now();
+  }
+  // Keep the workers of the thread pool spinning between the kernels of the function
+  threading::PersistentRegionScope region(persistent_parallel_region_);
+  WorkspacePool::ArenaScope arena(workspace_arena_);
+  ICHECK_EQ(func_table_.size(), exec_->func_names.size())
+      << "The function table is not initialized, did you call vm_initialization?";
+  if (constant_uploader_ != nullptr && constant_uploader_->Done()) FinishConstantUpload();
+  InvokeHookScope hook_scope(hooks_, gfunc.name, &hooked_tail_calls_);
   PushFrame(this->pc_, gfunc);
   // load arguments to the register file
   ICHECK_EQ(static_cast<size_t>(gfunc.num_args), args.size())
@@ -166,19 +748,58 @@ RegType VirtualMachine::Invoke(Index gf_idx, const std::vector<RegType>& args) {
   for (size_t i = 0; i < args.size(); ++i) {
     WriteRegister(frames_.back().get(), i, args[i]);
   }
-  // set program counter
-  pc_ = gfunc.start_instr;
-  RunLoop();
+  // The sampling is decided by the outermost invocation, the nested ones follow it.
+  bool outermost = frames_.size() == 1;
+  if (outermost) {
+    tracing_ = trace_sink_ != nullptr && trace_sink_->Sample();
+  }
+  DefaultStreamScope stream_scope(outermost ? this : nullptr);
+  double trace_begin = tracing_ ? trace_sink_->Now() : 0;
+  if (gfunc.kind == VMFuncKind::kVMTIRFunc) {
+    RunCompiledFunction(gf_idx);
+  } else {
+    // set program counter
+    pc_ = gfunc.start_instr;
+    RunLoop();
+  }
+  if (tracing_) {
+    trace_sink_->Record(gfunc.name, "function", TraceSink::kHostPid, trace_sink_->ThreadId(),
+                        trace_begin, trace_sink_->Now() - trace_begin);
+    tracing_ = !outermost;
+  }
+  if (latency_stats_ != nullptr) {
+    latency_stats_->histograms[gf_idx].Record(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                             start)
+            .count());
+  }
+  hook_scope.End();
   return return_value_;
 }
 
+void VirtualMachine::RunCompiledFunction(Index gf_idx) {
+  const VMFunction& gfunc = exec_->global_funcs[gf_idx];
+  const PackedFunc& func = compiled_funcs_[gf_idx];
+  ICHECK(func != nullptr) << "Cannot find the compiled function " << kVMTIRFuncPrefix
+                          << gfunc.name << " in the Relax VM kernel library";
+  // The compiled function reads the constant pool directly.
+  FinishConstantUpload();
+  std::vector<RegType>& registers = frames_.back()->register_file;
+  func(static_cast<void*>(this), static_cast<void*>(registers.data()),
+       static_cast<void*>(this->constants.data()), static_cast<void*>(func_pool_.data()));
+  // The compiled function leaves its result in the register after the parameters.
+  return_value_ = registers[gfunc.num_args];
+  PopFrame();
+}
+
 void VirtualMachine::Init(const std::vector<Device>& devices,
                           const std::vector<AllocatorType>& alloc_types) {
-  // TODO(@yuchen): support multi-device heterogeneous execution
-  ICHECK_LT(devices.size(), 3)
-      << "Currently relax vm only supports at most 2 devices (host + device)";
+  // The host device is always the last element, the others are indexed by runtime_device_index.
+  ICHECK(!devices.empty()) << "The VM requires at least one device";
   ICHECK_EQ(devices.size(), alloc_types.size());
 
+  this->devices.clear();
+  this->allocators.clear();
   this->devices.reserve(devices.size());
   this->allocators.reserve(alloc_types.size());
   for (size_t i = 0; i < devices.size(); i++) {
@@ -188,42 +809,314 @@ void VirtualMachine::Init(const std::vector<Device>& devices,
   }
 }
 
-void VirtualMachine::PrepareFuncTable(Index func_index) {
-  // fast path, function already in cache;
+void VirtualMachine::InitFuncTable() {
+  // Resolve every packed function referenced by the executable up front, so that the
+  // dispatch loop can index the table directly without a lookup on the hot path.
+  func_table_.clear();
+  func_table_.reserve(exec_->func_names.size());
+  builtin_table_.clear();
+  builtin_table_.reserve(exec_->func_names.size());
+  tail_call_targets_.clear();
+  vm_handle_ = static_cast<void*>(this);
+  for (const std::string& func_name : exec_->func_names) {
+    PackedFunc func{nullptr};
+    VMBuiltin builtin = nullptr;
+    Index tail_call_target = func_name == "vm.builtin.invoke_closure" ? kInvokeClosureTarget : -1;
+    if (this->lib.defined()) {
+      func = this->lib.value()->GetFunction(func_name, true);
+    }
+    if (!func.defined()) {
+      const PackedFunc* p_func = Registry::Get(func_name);
+      // A builtin is called directly unless the registered function is overridden.
+      if (p_func != nullptr) builtin = GetVMBuiltin(func_name);
+      if (p_func == nullptr) {
+        const auto& m = exec_->global_map;
+        ICHECK(m.find(func_name) != m.end())
+            << "Error: Cannot find function " << func_name
+            << " in either Relax VM kernel library, or in TVM runtime PackedFunc registry, or in "
+               "global Relax functions of the VM executable";
+        func = this->GetFunction(func_name, GetObjectPtr<Object>(this));
+        tail_call_target = m.at(func_name);
+      } else {
+        func = *(p_func);
+      }
+    }
+    func_table_.push_back(func);
+    builtin_table_.push_back(builtin);
+    tail_call_targets_.push_back(tail_call_target);
+  }
+  compiled_funcs_.clear();
+  func_pool_.clear();
+  compiled_funcs_.reserve(exec_->global_funcs.size());
+  func_pool_.reserve(exec_->global_funcs.size());
+  for (size_t i = 0; i < exec_->global_funcs.size(); ++i) {
+    const VMFunction& gfunc = exec_->global_funcs[i];
+    PackedFunc func{nullptr};
+    if (gfunc.kind == VMFuncKind::kVMTIRFunc && this->lib.defined()) {
+      func = this->lib.value()->GetFunction(kVMTIRFuncPrefix + gfunc.name, true);
+      ICHECK(func != nullptr) << "Cannot find the compiled function " << kVMTIRFuncPrefix
+                              << gfunc.name << " in the Relax VM kernel library";
+    }
+    compiled_funcs_.push_back(func);
+    TVMRetValue closure;
+    closure = VMClosure(gfunc.name, {}, i);
+    func_pool_.push_back(closure);
+  }
+}
 
-  if (static_cast<Index>(func_table_.size()) > func_index && func_table_[func_index] != nullptr)
-    return;
+ObjectPtr<VirtualMachine> VirtualMachine::CreateSession() {
+  ICHECK_EQ(func_table_.size(), exec_->func_names.size())
+      << "The VM must be initialized before creating sessions, did you call vm_initialization?";
+  ObjectPtr<VirtualMachine> session = make_object<VirtualMachine>();
+  session->LoadExecutable(exec_);
+  session->devices = this->devices;
+  session->ccl_comm = this->ccl_comm;
+  session->allocators = this->allocators;
+  // NDArray constants are reference counted, so the copy shares the device memory.
+  FinishConstantUpload();
+  session->constants = this->constants;
+  session->constant_index_ = this->constant_index_;
+  session->device_constants_ = this->device_constants_;
+  // Packed functions are stateless and shared, Relax functions are rebound so that they run
+  // on the frames of the session.
+  session->func_table_ = this->func_table_;
+  session->builtin_table_ = this->builtin_table_;
+  session->vm_handle_ = static_cast<void*>(session.get());
+  session->tail_call_targets_ = this->tail_call_targets_;
+  session->compiled_funcs_ = this->compiled_funcs_;
+  session->func_pool_ = this->func_pool_;
+  session->max_parallelism_ = this->max_parallelism_;
+  session->persistent_parallel_region_ = this->persistent_parallel_region_;
+  session->workspace_arena_ = this->workspace_arena_;
+  session->parallel_regions_ = this->parallel_regions_;
+  session->region_of_pc_ = this->region_of_pc_;
+  session->kernel_jit_ = this->kernel_jit_;
+  session->trace_sink_ = this->trace_sink_;
+  session->latency_stats_ = this->latency_stats_;
+  session->kernel_capture_ = this->kernel_capture_;
+  session->hooks_ = this->hooks_;
+  for (size_t i = 0; i < exec_->func_names.size(); ++i) {
+    const std::string& func_name = exec_->func_names[i];
+    if (exec_->global_map.count(func_name) &&
+        !(this->lib.defined() && this->lib.value()->GetFunction(func_name, true) != nullptr) &&
+        Registry::Get(func_name) == nullptr) {
+      session->func_table_[i] = session->GetFunction(func_name, session);
+    }
+  }
+  return session;
+}
 
-  if (static_cast<Index>(func_table_.size()) <= func_index) {
-    func_table_.resize(func_index + 1, nullptr);
+Index VirtualMachine::ResolveDeviceIndex(Index device_index) const {
+  if (device_index == -1) {
+    // Host is always the last element of devices.
+    return devices.size() - 1;
   }
+  ICHECK(device_index >= 0 && static_cast<size_t>(device_index) < devices.size())
+      << "The device index " << device_index << " is out of VM physical devices list of size "
+      << devices.size();
+  return device_index;
+}
 
-  const std::string& func_name = exec_->func_names[func_index];
+NDArray VirtualMachine::AllocShapeHeap(int64_t size) {
+  NDArray& heap = shape_heap_cache_[pc_];
+  // A heap still referenced elsewhere belongs to an ongoing (e.g. recursive) call.
+  if (!heap.defined() || heap.use_count() != 1 || heap->shape[0] != size) {
+    heap = NDArray::Empty({size}, DLDataType{kDLInt, 64, 1}, devices[ResolveDeviceIndex(-1)]);
+  }
+  return heap;
+}
 
-  // lookup function and populate
+NDArray VirtualMachine::CopyToDevice(NDArray src, Index device_index) {
+  device_index = ResolveDeviceIndex(device_index);
+  const Device& dev = devices[device_index];
+  if (src->device.device_type == dev.device_type && src->device.device_id == dev.device_id) {
+    return src;
+  }
+  auto it = constant_index_.find(src.get());
+  if (it == constant_index_.end()) {
+    return src.CopyTo(dev);
+  }
+  // Constants are copied once per device and served from the device constant pool afterwards.
+  // The pools are shared by all sessions of the VM.
+  std::lock_guard<std::mutex> lock(device_constants_->mu);
+  std::unordered_map<Index, NDArray>& pool = device_constants_->pools[device_index];
+  auto cached = pool.find(it->second);
+  if (cached != pool.end()) return cached->second;
+  NDArray copy = CopyConstantTo(exec_->constants[it->second], dev);
+  pool.emplace(it->second, copy);
+  return copy;
+}
+
+void VirtualMachine::WaitForConstant(Index index) { constant_uploader_->Wait(index); }
+
+void VirtualMachine::FinishConstantUpload() {
+  if (constant_uploader_ == nullptr) return;
+  constant_uploader_->WaitAll();
+  for (int64_t index : constant_uploader_->order()) {
+    constant_index_[this->constants[index].operator NDArray().get()] = index;
+  }
+  constant_uploader_.reset();
+}
+
+ObjectRef& VirtualMachine::CurrentBuiltinStateSlot(const char* prefix, const String& name) {
+  // The references to the elements of an unordered_map stay valid when it rehashes.
+  std::pair<String, ObjectRef*>& slot = builtin_state_cache_[pc_];
+  if (!slot.first.same_as(name)) slot = {name, &builtin_state_[prefix + std::string(name)]};
+  return *slot.second;
+}
+
+const PackedFunc& VirtualMachine::LookupKernel(const String& func_name) {
+  std::pair<String, PackedFunc>& slot = kernel_cache_[pc_];
+  if (slot.first.same_as(func_name)) return slot.second;
+  slot = {func_name, FindKernel(func_name)};
+  return slot.second;
+}
+
+const PackedFunc& VirtualMachine::LookupKernelVariant(const ShapeTuple& extents, TVMArgs names,
+                                                      int64_t dim) {
+  std::pair<ShapeTuple, std::vector<PackedFunc>>& slot = kernel_variant_cache_[pc_];
+  if (!slot.first.same_as(extents)) {
+    ICHECK_EQ(static_cast<size_t>(names.size()), extents.size() + 1)
+        << "ValueError: A dispatch table of " << extents.size() << " extents requires "
+        << extents.size() + 1 << " kernels but " << names.size() << " are provided.";
+    std::vector<PackedFunc> kernels;
+    for (int i = 0; i < names.size(); ++i) {
+      kernels.push_back(FindKernel(names[i].operator String()));
+    }
+    slot = {extents, std::move(kernels)};
+  }
+  // The first variant whose extent is not smaller than the dimension, or the last kernel.
+  size_t index = std::lower_bound(extents.begin(), extents.end(), dim) - extents.begin();
+  return slot.second[index];
+}
+
+PackedFunc VirtualMachine::FindKernel(const String& func_name) {
   PackedFunc func{nullptr};
   if (this->lib.defined()) {
     func = this->lib.value()->GetFunction(func_name, true);
   }
   if (!func.defined()) {
     const PackedFunc* p_func = Registry::Get(func_name);
-    if (p_func == nullptr) {
-      const auto& m = exec_->global_map;
-      ICHECK(m.find(func_name) != m.end())
-          << "Error: Cannot find function " << func_name
-          << " in either Relax VM kernel library, or in TVM runtime PackedFunc registry, or in "
-             "global Relax functions of the VM executable";
-      func = this->GetFunction(func_name, GetObjectPtr<Object>(this));
+    CHECK(p_func != nullptr) << "Error: Cannot find kernel " << func_name
+                             << " in either Relax VM kernel library or TVM runtime PackedFunc "
+                                "registry";
+    func = *(p_func);
+  }
+  return func;
+}
+
+Index VirtualMachine::LookupVMFunctionIndex(const String& func_name) {
+  std::pair<String, Index>& slot = func_index_cache_[pc_];
+  if (slot.first.same_as(func_name)) return slot.second;
+  auto it = exec_->global_map.find(func_name);
+  ICHECK(it != exec_->global_map.end()) << "No such function " << func_name;
+  slot = {func_name, it->second};
+  return slot.second;
+}
+
+void VirtualMachine::InvokeClosure(const VMClosure& closure, TVMArgs args, TVMRetValue* rv) {
+  Index func_idx = closure->func_idx;
+  if (func_idx < 0) {
+    auto it = exec_->global_map.find(closure->func_name);
+    ICHECK(it != exec_->global_map.end()) << "No such function " << closure->func_name;
+    func_idx = it->second;
+  }
+  const VMFunction& gfunc = exec_->global_funcs[func_idx];
+  const Array<ObjectRef>& free_vars = closure->free_vars;
+  size_t num_args = static_cast<size_t>(args.size()) + free_vars.size();
+  ICHECK_EQ(func_table_.size(), exec_->func_names.size())
+      << "The function table is not initialized, did you call vm_initialization?";
+  ICHECK_EQ(static_cast<size_t>(gfunc.num_args), num_args)
+      << "ValueError: Invoking closure " << gfunc.name << " requires " << gfunc.num_args
+      << " inputs but " << num_args << " inputs are provided.";
+  InvokeHookScope hook_scope(hooks_, gfunc.name, &hooked_tail_calls_);
+  PushFrame(this->pc_, gfunc);
+  std::vector<RegType>& registers = frames_.back()->register_file;
+  for (int i = 0; i < args.size(); ++i) {
+    registers[i] = args[i];
+  }
+  for (size_t i = 0; i < free_vars.size(); ++i) {
+    registers[args.size() + i] = free_vars[i];
+  }
+  if (gfunc.kind == VMFuncKind::kVMTIRFunc) {
+    RunCompiledFunction(func_idx);
+    hook_scope.End();
+    *rv = return_value_;
+    return;
+  }
+  pc_ = gfunc.start_instr;
+  RunLoop();
+  hook_scope.End();
+  *rv = return_value_;
+}
+
+RegType VirtualMachine::Scan(Index gf_idx, int64_t num_steps, std::vector<RegType> states) {
+  const VMFunction& gfunc = exec_->global_funcs[gf_idx];
+  CHECK_GE(num_steps, 0) << "ValueError: The number of steps of a scan must be non-negative";
+  ICHECK_EQ(static_cast<size_t>(gfunc.num_args), states.size())
+      << "ValueError: The step function " << gfunc.name << " requires " << gfunc.num_args
+      << " states but " << states.size() << " states are provided.";
+  std::vector<NDArray> saved_buffers = std::move(output_buffers_);
+  size_t saved_depth = output_buffers_depth_;
+  // The states computed two steps ago, whose buffers receive the states of the next step.
+  std::vector<RegType> spare_states;
+  for (int64_t step = 0; step < num_steps; ++step) {
+    output_buffers_.assign(states.size(), NDArray());
+    for (size_t i = 0; i < spare_states.size(); ++i) {
+      if (spare_states[i].type_code() != kTVMNDArrayHandle) continue;
+      // A state passed through by the step is still alive, and must not be overwritten.
+      NDArray buffer = spare_states[i].AsObjectRef<NDArray>();
+      if (buffer.use_count() == 2) output_buffers_[i] = buffer;
+    }
+    output_buffers_depth_ = frames_.size() + 1;
+    RegType ret = Invoke(gf_idx, states);
+    if (states.size() == 1 && !ret.IsObjectRef<ADT>()) {
+      spare_states.resize(1);
+      spare_states[0] = ret;
     } else {
-      func = *(p_func);
+      ADT adt = ret.AsObjectRef<ADT>();
+      ICHECK_EQ(adt.size(), states.size())
+          << "ValueError: The step function " << gfunc.name << " returns " << adt.size()
+          << " states but " << states.size() << " states are carried.";
+      spare_states.resize(adt.size());
+      for (size_t i = 0; i < adt.size(); ++i) spare_states[i] = adt[i];
     }
+    // The user's initial states are never overwritten, the first spare states are returned by
+    // the first step.
+    std::swap(states, spare_states);
+    if (step == 0) spare_states.clear();
   }
-  func_table_[func_index] = func;
+  output_buffers_ = std::move(saved_buffers);
+  output_buffers_depth_ = saved_depth;
+  std::vector<ObjectRef> fields;
+  for (const RegType& state : states) fields.push_back(state.AsObjectRef<ObjectRef>());
+  RegType result;
+  result = ADT::Tuple(fields);
+  return result;
+}
+
+void VirtualMachine::InvokePacked(Index func_idx, const PackedFunc& func, TVMArgs args,
+                                  TVMRetValue* rv) {
+  func.CallPacked(args, rv);
 }
 
-void VirtualMachine::RunInstrCall(VMFrame* curr_frame, Instruction instr) {
+void VirtualMachine::RunInstrCall(VMFrame* curr_frame, const Instruction& instr) {
   DLOG(INFO) << "\n  pc = " << pc_ << ", execute: " << exec_->func_names[instr.func_idx];
+  TVMRetValue ret;
+  InvokeInstr(curr_frame, instr, &ret);
+  if (instr.dst != Instruction::kVoidArg) {
+    WriteRegister(curr_frame, instr.dst, ret);
+  }
+  pc_++;
+}
 
+void VirtualMachine::InvokeInstr(VMFrame* curr_frame, const Instruction& instr, TVMRetValue* rv) {
+  if (VMBuiltin builtin = builtin_table_[instr.func_idx]) {
+    if (direct_builtin_calls_ && !tracing_) {
+      InvokeBuiltin(curr_frame, instr, builtin, rv);
+      return;
+    }
+  }
   // Use the call arg stack from the current frame to increase reuse
   // and avoid re-allocation
   curr_frame->call_arg_values.resize(instr.num_args);
@@ -251,7 +1144,7 @@ void VirtualMachine::RunInstrCall(VMFrame* curr_frame, Instruction instr) {
         break;
       }
       case Instruction::kConstIdx: {
-        setter(i, this->constants[arg.value()]);
+        setter(i, ReadConstant(arg.value()));
         break;
       }
       default: {
@@ -260,70 +1153,577 @@ void VirtualMachine::RunInstrCall(VMFrame* curr_frame, Instruction instr) {
     }
   }
   TVMArgs args(values.data(), tcodes.data(), values.size());
+  // invoke, the function table is resolved in vm_initialization
+  if (tracing_) {
+    InvokeTracedPacked(instr.func_idx, args, rv);
+  } else {
+    InvokePacked(instr.func_idx, func_table_[instr.func_idx], args, rv);
+  }
+  if (kernel_capture_ != nullptr) kernel_capture_->Capture(instr.func_idx, args);
+}
+
+void VirtualMachine::InvokeBuiltin(VMFrame* curr_frame, const Instruction& instr,
+                                   VMBuiltin builtin, TVMRetValue* rv) {
+  // The arguments refer to the registers and constants in place, only the immediates are
+  // materialized, and the builtin is called without packing them.
+  std::vector<const RegType*>& args = curr_frame->builtin_args;
+  std::vector<RegType>& imms = curr_frame->builtin_imms;
+  args.resize(instr.num_args);
+  if (imms.size() < static_cast<size_t>(instr.num_args)) imms.resize(instr.num_args);
+  for (Index i = 0; i < instr.num_args; ++i) {
+    Instruction::Arg arg = instr.args[i];
+    switch (arg.kind()) {
+      case Instruction::kRegister: {
+        args[i] = arg.value() == Instruction::kVMRegister
+                      ? &vm_handle_
+                      : &curr_frame->register_file[arg.value()];
+        break;
+      }
+      case Instruction::kImmediate: {
+        imms[i] = static_cast<int64_t>(arg.value());
+        args[i] = &imms[i];
+        break;
+      }
+      case Instruction::kConstIdx: {
+        args[i] = &ReadConstant(arg.value());
+        break;
+      }
+      default: {
+        LOG(FATAL) << "ValueError: Unknown argument kind: " << int(arg.kind());
+      }
+    }
+  }
+  builtin(VMBuiltinArgs(args.data(), static_cast<int>(args.size())), rv);
+}
+
+bool VirtualMachine::RunInstrTailCall(VMFrame* curr_frame, const Instruction& instr) {
+  DLOG(INFO) << "\n  pc = " << pc_ << ", tail call: " << exec_->func_names[instr.func_idx];
+  Index gf_idx = tail_call_targets_[instr.func_idx];
+  Index first_arg = 0;
+  VMClosure closure;
+  if (gf_idx == kInvokeClosureTarget) {
+    // The arguments of vm.builtin.invoke_closure are the VM, the closure and the call arguments.
+    if (instr.num_args >= 2 && instr.args[1].kind() == Instruction::kRegister) {
+      closure = ReadRegister(curr_frame, instr.args[1].value()).AsObjectRef<VMClosure>();
+      gf_idx = closure->func_idx;
+      if (gf_idx < 0) {
+        auto it = exec_->global_map.find(closure->func_name);
+        ICHECK(it != exec_->global_map.end()) << "No such function " << closure->func_name;
+        gf_idx = it->second;
+      }
+      first_arg = 2;
+    }
+  }
+  if (gf_idx < 0 || exec_->global_funcs[gf_idx].kind != VMFuncKind::kVMFunc) {
+    TVMRetValue ret;
+    InvokeInstr(curr_frame, instr, &ret);
+    return_value_ = ret;
+    return false;
+  }
+  const VMFunction& gfunc = exec_->global_funcs[gf_idx];
+  // Read the arguments out before the registers of the frame are released.
+  tail_call_args_.clear();
+  for (Index i = first_arg; i < instr.num_args; ++i) {
+    Instruction::Arg arg = instr.args[i];
+    switch (arg.kind()) {
+      case Instruction::kRegister: {
+        tail_call_args_.push_back(ReadRegister(curr_frame, arg.value()));
+        break;
+      }
+      case Instruction::kImmediate: {
+        RegType imm;
+        imm = static_cast<int64_t>(arg.value());
+        tail_call_args_.push_back(imm);
+        break;
+      }
+      case Instruction::kConstIdx: {
+        tail_call_args_.push_back(ReadConstant(arg.value()));
+        break;
+      }
+      default: {
+        LOG(FATAL) << "ValueError: Unknown argument kind: " << int(arg.kind());
+      }
+    }
+  }
+  if (closure.defined()) {
+    for (const ObjectRef& free_var : closure->free_vars) {
+      RegType value;
+      value = free_var;
+      tail_call_args_.push_back(value);
+    }
+  }
+  ICHECK_EQ(static_cast<size_t>(gfunc.num_args), tail_call_args_.size())
+      << "ValueError: Invoking function " << gfunc.name << " requires " << gfunc.num_args
+      << " inputs but " << tail_call_args_.size() << " inputs are provided.";
+  // The callee returns to the caller of the current function.
+  std::vector<RegType>& registers = curr_frame->register_file;
+  registers.clear();
+  registers.resize(gfunc.register_file_size);
+  for (size_t i = 0; i < tail_call_args_.size(); ++i) {
+    registers[i] = std::move(tail_call_args_[i]);
+  }
+  tail_call_args_.clear();
+  if (hooks_ != nullptr) {
+    hooks_->OnInvokeBegin(gfunc.name);
+    hooked_tail_calls_.push_back(&gfunc.name);
+  }
+  pc_ = gfunc.start_instr;
+  return true;
+}
+
+void VirtualMachine::InvokeTracedPacked(Index func_idx, TVMArgs args, TVMRetValue* rv) {
+  const PackedFunc& func = func_table_[func_idx];
+  for (int i = 0; i < args.size(); ++i) {
+    if (args.type_codes[i] != kTVMNDArrayHandle && args.type_codes[i] != kTVMDLTensorHandle) {
+      continue;
+    }
+    Device dev = args[i].operator DLTensor*()->device;
+    if (dev.device_type == kDLCPU) {
+      continue;
+    }
+    double begin = trace_sink_->Now();
+    Timer timer = Timer::Start(dev);
+    InvokePacked(func_idx, func, args, rv);
+    timer->Stop();
+    // The device track is keyed by the device, the kernel is laid out from its launch.
+    trace_sink_->Record(exec_->func_names[func_idx], "kernel", TraceSink::kDevicePid,
+                        static_cast<int64_t>(dev.device_type) * 1000 + dev.device_id, begin,
+                        timer->SyncAndGetElapsedNanos() / 1e3);
+    return;
+  }
+  InvokePacked(func_idx, func, args, rv);
+}
+
+const std::string& VirtualMachine::InstrName(Index pc) const {
+  static const std::string kOpcodeNames[] = {"Call",         "Ret",  "Goto",    "If",
+                                             "KillRegister", "Move", "TailCall"};
+  static const std::string kParallelRegion = "ParallelRegion";
+  const Instruction& instr = instrs_[pc];
+  if (instr.op != Opcode::Call) {
+    return kOpcodeNames[static_cast<int>(instr.op) - static_cast<int>(Opcode::Call)];
+  } else if (max_parallelism_ > 1 && region_of_pc_[pc] >= 0) {
+    return kParallelRegion;
+  }
+  return exec_->func_names[instr.func_idx];
+}
+
+double VirtualMachine::BeginTraceInstr(Index pc) {
+  if (HasInstrHooks()) hooks_->OnInstrBegin(pc, InstrName(pc));
+  return tracing_ ? trace_sink_->Now() : 0;
+}
+
+void VirtualMachine::TraceInstr(Index pc, double begin) {
+  if (tracing_) {
+    trace_sink_->Record(InstrName(pc), "instr", TraceSink::kHostPid, trace_sink_->ThreadId(),
+                        begin, trace_sink_->Now() - begin);
+  }
+  if (HasInstrHooks()) hooks_->OnInstrEnd(pc, InstrName(pc));
+}
+
+void VirtualMachine::SetMaxParallelism(int max_parallelism) {
+  CHECK_GE(max_parallelism, 1) << "ValueError: The parallelism limit must be positive";
+  ICHECK_EQ(func_table_.size(), exec_->func_names.size())
+      << "The function table is not initialized, did you call vm_initialization?";
+  if (max_parallelism > 1 && region_of_pc_.size() != exec_->instr_offset.size()) {
+    AnalyzeParallelRegions();
+  }
+  max_parallelism_ = max_parallelism;
+}
+
+void VirtualMachine::AnalyzeParallelRegions() {
+  Index num_instrs = exec_->instr_offset.size();
+  parallel_regions_.clear();
+  region_of_pc_.assign(num_instrs, -1);
+  // A region is a basic block, it neither spans the start of a function nor a jump target.
+  std::vector<bool> func_start(num_instrs + 1, false);
+  std::vector<bool> block_start(num_instrs + 1, false);
+  for (const VMFunction& func : exec_->global_funcs) {
+    if (func.kind == VMFuncKind::kVMFunc && func.start_instr < num_instrs) {
+      func_start[func.start_instr] = block_start[func.start_instr] = true;
+    }
+  }
+  for (Index pc = 0; pc < num_instrs; ++pc) {
+    const Instruction& instr = instrs_[pc];
+    if (instr.op == Opcode::Goto || instr.op == Opcode::If) {
+      block_start[pc + (instr.op == Opcode::Goto ? instr.pc_offset : instr.false_offset)] = true;
+      block_start[pc + 1] = true;
+    }
+  }
+
+  // Only the kernels of the library are run concurrently, the builtins may touch the VM.
+  auto is_kernel = [this](const Instruction& instr) {
+    const std::string& func_name = exec_->func_names[instr.func_idx];
+    if (!this->lib.defined() || exec_->global_map.count(func_name) ||
+        this->lib.value()->GetFunction(func_name, true) == nullptr) {
+      return false;
+    }
+    for (Index i = 0; i < instr.num_args; ++i) {
+      Instruction::Arg arg = instr.args[i];
+      if (arg.kind() == Instruction::kRegister && arg.value() == Instruction::kVMRegister) {
+        return false;
+      }
+    }
+    return true;
+  };
+  // The position of the storage in the arguments of an allocation of a tensor from a storage.
+  auto storage_arg_of = [this](const Instruction& instr) {
+    const std::string& func_name = exec_->func_names[instr.func_idx];
+    if (func_name == "vm.builtin.alloc_tensor") return 0;
+    if (func_name == "vm.builtin.alloc_output_tensor") return 1;
+    return -1;
+  };
+
+  // A kernel writes its outputs in place, an allocated tensor is the output of its first
+  // user and an input of the later ones.
+  std::unordered_set<RegName> unwritten;
+  // Tensors allocated from a storage may share memory, their accesses are tracked on the
+  // register of the storage.
+  std::unordered_map<RegName, RegName> memory_of;
+  auto memory = [&memory_of](RegName reg) {
+    auto it = memory_of.find(reg);
+    return it == memory_of.end() ? reg : it->second;
+  };
+
+  Index pc = 0;
+  while (pc < num_instrs) {
+    if (func_start[pc]) {
+      unwritten.clear();
+      memory_of.clear();
+    }
+    if (instrs_[pc].op != Opcode::Call) {
+      ++pc;
+      continue;
+    }
+    Index start = pc;
+    Index end = pc + 1;
+    while (end < num_instrs && instrs_[end].op == Opcode::Call && !block_start[end]) ++end;
+
+    ParallelRegion region;
+    region.end_pc = end;
+    std::vector<int> level_of(end - start, 0);
+    std::unordered_map<RegName, Index> last_writer;
+    std::unordered_map<RegName, std::vector<Index>> readers;
+    Index last_serial = -1;
+    size_t max_level_kernels = 0;
+    for (pc = start; pc < end; ++pc) {
+      const Instruction& instr = instrs_[pc];
+      bool kernel = is_kernel(instr);
+      std::vector<RegName> reads, writes;
+      // An in-place call_tir passes the tensor it overwrites both as an input and as the
+      // destination, so a register passed more than once to a kernel is written.
+      std::unordered_map<RegName, int> num_uses;
+      for (Index i = 0; i < instr.num_args; ++i) {
+        Instruction::Arg arg = instr.args[i];
+        if (arg.kind() == Instruction::kRegister) ++num_uses[arg.value()];
+      }
+      for (Index i = 0; i < instr.num_args; ++i) {
+        Instruction::Arg arg = instr.args[i];
+        if (arg.kind() != Instruction::kRegister || arg.value() == Instruction::kVMRegister) {
+          continue;
+        }
+        RegName reg = arg.value();
+        // A builtin may update its arguments, e.g. a KV cache, it is treated as writing them.
+        if (!kernel || unwritten.count(reg) || num_uses[reg] > 1) {
+          writes.push_back(memory(reg));
+        } else {
+          reads.push_back(memory(reg));
+        }
+        unwritten.erase(reg);
+      }
+      if (instr.dst != Instruction::kVoidArg) {
+        writes.push_back(instr.dst);
+        memory_of.erase(instr.dst);
+        unwritten.erase(instr.dst);
+        int storage_arg = storage_arg_of(instr);
+        if (storage_arg >= 0 && instr.args[storage_arg].kind() == Instruction::kRegister) {
+          memory_of[instr.dst] = memory(instr.args[storage_arg].value());
+        }
+        if (storage_arg >= 0 ||
+            exec_->func_names[instr.func_idx] == "vm.builtin.alloc_storage_and_tensor") {
+          unwritten.insert(instr.dst);
+        }
+      }
+
+      Index node = pc - start;
+      int level = 0;
+      auto depend_on = [&](Index other) {
+        if (other != node) level = std::max(level, level_of[other] + 1);
+      };
+      // The builtins keep their order.
+      if (!kernel && last_serial >= 0) depend_on(last_serial);
+      for (RegName reg : reads) {
+        auto it = last_writer.find(reg);
+        if (it != last_writer.end()) depend_on(it->second);
+        readers[reg].push_back(node);
+      }
+      for (RegName reg : writes) {
+        auto it = last_writer.find(reg);
+        if (it != last_writer.end()) depend_on(it->second);
+        for (Index reader : readers[reg]) depend_on(reader);
+        last_writer[reg] = node;
+        readers[reg].clear();
+      }
+      level_of[node] = level;
+      if (static_cast<size_t>(level) >= region.levels.size()) region.levels.resize(level + 1);
+      if (kernel) {
+        region.levels[level].kernels.push_back(pc);
+        max_level_kernels = std::max(max_level_kernels, region.levels[level].kernels.size());
+      } else {
+        region.levels[level].serial.push_back(pc);
+        last_serial = node;
+      }
+    }
+    if (max_level_kernels > 1) {
+      region_of_pc_[start] = parallel_regions_.size();
+      parallel_regions_.push_back(std::move(region));
+    }
+    pc = end;
+  }
+}
+
+void VirtualMachine::RunParallelRegion(VMFrame* curr_frame, const ParallelRegion& region) {
+  struct KernelLaunch {
+    VirtualMachine* vm;
+    VMFrame* frame;
+    const std::vector<Index>* kernels;
+    std::vector<std::string> errors;
+  };
+  for (const ParallelRegion::Level& level : region.levels) {
+    for (Index pc : level.serial) {
+      pc_ = pc;
+      RunInstrCall(curr_frame, instrs_[pc]);
+    }
+    if (level.kernels.empty()) continue;
+    int num_task = std::min({static_cast<int>(level.kernels.size()), max_parallelism_,
+                             threading::NumThreads()});
+    if (num_task <= 1) {
+      for (Index pc : level.kernels) {
+        pc_ = pc;
+        RunInstrCall(curr_frame, instrs_[pc]);
+      }
+      continue;
+    }
+    KernelLaunch launch{this, curr_frame, &level.kernels, std::vector<std::string>(num_task)};
+    auto run_task = [](int task_id, TVMParallelGroupEnv* penv, void* cdata) {
+      KernelLaunch* launch = static_cast<KernelLaunch*>(cdata);
+      const std::vector<Index>& kernels = *launch->kernels;
+      for (size_t i = task_id; i < kernels.size(); i += penv->num_task) {
+        try {
+          launch->vm->RunKernelCall(launch->frame, launch->vm->instrs_[kernels[i]]);
+        } catch (const std::exception& e) {
+          launch->errors[task_id] = e.what();
+          return -1;
+        }
+      }
+      return 0;
+    };
+    TVMBackendParallelLaunch(run_task, &launch, num_task);
+    for (const std::string& error : launch.errors) {
+      if (!error.empty()) LOG(FATAL) << error;
+    }
+  }
+  pc_ = region.end_pc;
+}
+
+void VirtualMachine::RunKernelCall(VMFrame* curr_frame, const Instruction& instr) {
+  std::vector<TVMValue> values(instr.num_args);
+  std::vector<int> tcodes(instr.num_args);
+  runtime::TVMArgsSetter setter(values.data(), tcodes.data());
+  for (Index i = 0; i < instr.num_args; ++i) {
+    Instruction::Arg arg = instr.args[i];
+    switch (arg.kind()) {
+      case Instruction::kRegister: {
+        setter(i, ReadRegister(curr_frame, arg.value()));
+        break;
+      }
+      case Instruction::kImmediate: {
+        setter(i, arg.value());
+        break;
+      }
+      case Instruction::kConstIdx: {
+        setter(i, ReadConstant(arg.value()));
+        break;
+      }
+      default: {
+        LOG(FATAL) << "ValueError: Unknown argument kind: " << int(arg.kind());
+      }
+    }
+  }
   TVMRetValue ret;
-  // prepare and invoke
-  this->PrepareFuncTable(instr.func_idx);
+  TVMArgs args(values.data(), tcodes.data(), values.size());
   func_table_[instr.func_idx].CallPacked(args, &ret);
-
+  if (kernel_capture_ != nullptr) kernel_capture_->Capture(instr.func_idx, args);
   if (instr.dst != Instruction::kVoidArg) {
     WriteRegister(curr_frame, instr.dst, ret);
   }
-  pc_++;
 }
 
+// Threaded dispatch through a table of label addresses is a GNU extension, fall back to a
+// switch-based loop on other compilers.
+#if defined(__GNUC__) || defined(__clang__)
+#define TVM_RELAX_VM_COMPUTED_GOTO 1
+#else
+#define TVM_RELAX_VM_COMPUTED_GOTO 0
+#endif
+
 void VirtualMachine::RunLoop() {
+  // The traced loop also reports the instructions to the hooks.
+  if (tracing_ || HasInstrHooks()) {
+    RunLoopImpl<true>();
+  } else {
+    RunLoopImpl<false>();
+  }
+}
+
+template <bool kTrace>
+void VirtualMachine::RunLoopImpl() {
   VMFrame* curr_frame = frames_.back().get();
+  const Instruction* instrs = instrs_.data();
+  // The instruction being traced and the time it began.
+  Index trace_pc = pc_;
+  double trace_begin = kTrace ? this->BeginTraceInstr(pc_) : 0;
 
+  // Record the instruction which has run and start timing the next one.
+#define VM_TRACE_NEXT()                       \
+  if (kTrace) {                               \
+    this->TraceInstr(trace_pc, trace_begin);  \
+    trace_pc = pc_;                           \
+    trace_begin = this->BeginTraceInstr(pc_); \
+  }
+  // Pop the frame of the current function whose result is in return_value_, and when returning
+  // from a local call, write the result to the parent frame.
+#define VM_RETURN()                                                     \
+  if (kTrace) {                                                         \
+    this->TraceInstr(trace_pc, trace_begin);                            \
+  }                                                                     \
+  RegName caller_return_register = curr_frame->caller_return_register; \
+  PopFrame();                                                           \
+  if (frames_.size() != 0) {                                            \
+    curr_frame = frames_.back().get();                                  \
+    WriteRegister(curr_frame, caller_return_register, return_value_);   \
+  }                                                                     \
+  return
+#if TVM_RELAX_VM_COMPUTED_GOTO
+  // Indexed by opcode, every handler jumps straight to the handler of the next instruction.
+  static void* const kDispatchTable[] = {&&L_Invalid, &&L_Call,         &&L_Ret,  &&L_Goto,
+                                         &&L_If,      &&L_KillRegister, &&L_Move, &&L_TailCall};
+#define VM_DISPATCH() \
+  VM_TRACE_NEXT();    \
+  goto* kDispatchTable[static_cast<int>(instrs[pc_].op)]
+#define VM_CASE(op) L_##op:
+#define VM_INVALID_CASE() L_Invalid:
+  goto* kDispatchTable[static_cast<int>(instrs[pc_].op)];
+#else
+#define VM_DISPATCH() \
+  VM_TRACE_NEXT();    \
+  continue
+#define VM_CASE(op) case Opcode::op:
+#define VM_INVALID_CASE() default:
   while (true) {
-    ICHECK_LT(static_cast<size_t>(pc_), exec_->instr_offset.size()) << "run into invalide section";
-    Instruction instr = exec_->GetInstruction(pc_);
-    switch (instr.op) {
-      case Opcode::Call: {
-        this->RunInstrCall(curr_frame, instr);
+    switch (instrs[pc_].op) {
+#endif
+  VM_CASE(Call) {
+    if (max_parallelism_ > 1 && region_of_pc_[pc_] >= 0) {
+      this->RunParallelRegion(curr_frame, parallel_regions_[region_of_pc_[pc_]]);
+    } else {
+      this->RunInstrCall(curr_frame, instrs[pc_]);
+    }
+    VM_DISPATCH();
+  }
+  VM_CASE(Ret) {
+    // If we have hit the point from which we started
+    // running, we should return to the caller breaking
+    // the dispatch loop.
+    return_value_ = ReadRegister(curr_frame, instrs[pc_].result);
+    VM_RETURN();
+  }
+  VM_CASE(Goto) {
+    pc_ += instrs[pc_].pc_offset;
+    VM_DISPATCH();
+  }
+  VM_CASE(If) {
+    const Instruction& instr = instrs[pc_];
+    int64_t cond_val = ReadRegister(curr_frame, instr.cond);
+    if (cond_val != 0) {
+      pc_++;
+    } else {
+      ICHECK_GT(instr.false_offset, 1);
+      pc_ += instr.false_offset;
+    }
+    VM_DISPATCH();
+  }
+  VM_CASE(KillRegister) {
+    WriteRegister(curr_frame, instrs[pc_].dst, RegType());
+    pc_++;
+    VM_DISPATCH();
+  }
+  VM_CASE(Move) {
+    const Instruction& instr = instrs[pc_];
+    Instruction::Arg src(instr.src);
+    switch (src.kind()) {
+      case Instruction::kRegister: {
+        WriteRegister(curr_frame, instr.dst, ReadRegister(curr_frame, src.value()));
         break;
       }
-      case Opcode::Ret: {
-        // If we have hit the point from which we started
-        // running, we should return to the caller breaking
-        // the dispatch loop.
-        return_value_ = ReadRegister(curr_frame, instr.result);
-        RegName caller_return_register = curr_frame->caller_return_register;
-        PopFrame();
-        if (frames_.size() == 0) {
-          // directly return if no frame in the call stack.
-        } else {
-          // return from a local call.
-          // Update the current frame to be the parent frame.
-          curr_frame = frames_.back().get();
-          WriteRegister(curr_frame, caller_return_register, return_value_);
-        }
-        return;
-      }
-      case Opcode::Goto: {
-        pc_ += instr.pc_offset;
+      case Instruction::kImmediate: {
+        RegType imm;
+        imm = static_cast<int64_t>(src.value());
+        WriteRegister(curr_frame, instr.dst, imm);
         break;
       }
-      case Opcode::If: {
-        int64_t cond_val = ReadRegister(curr_frame, instr.cond);
-        if (cond_val != 0) {
-          pc_++;
-        } else {
-          ICHECK_GT(instr.false_offset, 1);
-          pc_ += instr.false_offset;
-        }
+      case Instruction::kConstIdx: {
+        WriteRegister(curr_frame, instr.dst, ReadConstant(src.value()));
         break;
       }
+      default: {
+        LOG(FATAL) << "ValueError: Unknown argument kind: " << int(src.kind());
+      }
     }
+    pc_++;
+    VM_DISPATCH();
   }
+  VM_CASE(TailCall) {
+    if (this->RunInstrTailCall(curr_frame, instrs[pc_])) {
+      VM_DISPATCH();
+    }
+    // The callee was invoked as by a call, return its result.
+    VM_RETURN();
+  }
+  VM_INVALID_CASE() {
+    LOG(FATAL) << "run into invalide section at pc " << pc_;
+  }
+#if !TVM_RELAX_VM_COMPUTED_GOTO
+    }
+  }
+#endif
+#undef VM_TRACE_NEXT
+#undef VM_RETURN
+#undef VM_DISPATCH
+#undef VM_CASE
+#undef VM_INVALID_CASE
 }
 
 void VirtualMachine::PushFrame(Index ret_pc, const VMFunction& vm_func) {
-  frames_.emplace_back(std::make_unique<VMFrame>(ret_pc, vm_func.register_file_size));
+  if (frame_pool_.empty()) {
+    frames_.emplace_back(std::make_unique<VMFrame>(ret_pc, vm_func.register_file_size));
+    return;
+  }
+  std::unique_ptr<VMFrame> frame = std::move(frame_pool_.back());
+  frame_pool_.pop_back();
+  frame->return_pc = ret_pc;
+  frame->caller_return_register = 0;
+  frame->register_file.resize(vm_func.register_file_size);
+  frames_.emplace_back(std::move(frame));
 }
 
 void VirtualMachine::PopFrame() {
   ICHECK_GT(frames_.size(), 0);
   pc_ = frames_.back()->return_pc;
+  if (frame_pool_.size() < kMaxPooledFrames) {
+    // Release the registers now, the capacity of the register file is kept for reuse.
+    frames_.back()->register_file.clear();
+    frame_pool_.emplace_back(std::move(frames_.back()));
+  }
   frames_.pop_back();
 }
 
@@ -344,17 +1744,25 @@ void VirtualMachine::SetInput(std::string func_name, TVMArgs args, int offset) {
     ICHECK_EQ(args.size() - offset, params_num)
         << "The number of provided parameters doesn't match the number of arguments";
     std::vector<RegType> func_args(params_num);
+    // Copy the inputs on a dedicated stream, the compute stream waits for the copies through
+    // an event instead of blocking the host.
+    const Device& dev = devices[0];
+    TVMStreamHandle copy_stream = GetStream(0, kInputCopyStream);
     for (int i = offset; i < args.size(); ++i) {
       int index = i - offset;
-      SetInputTensorWithIndex(func_args, args[i], index, devices[0]);
+      SetInputTensorWithIndex(func_args, args[i], index, dev, copy_stream);
+    }
+    if (copy_stream != nullptr) {
+      DeviceAPI::Get(dev)->SyncStreamFromTo(dev, copy_stream, GetStream(0, 0));
     }
-    inputs_.emplace(func_name, func_args);
+    inputs_[func_name] = std::move(func_args);
   } else {
     LOG(FATAL) << "ValueError: Unknown function: " << func_name;
   }
 }
 
-inline ObjectRef CopyTo(ObjectRef src, const DLDevice& dev) {
+inline ObjectRef CopyTo(ObjectRef src, const DLDevice& dev, TVMStreamHandle stream,
+                        Allocator* allocator) {
   if (src->IsInstance<NDArray::ContainerType>()) {
     auto nd_array = Downcast<NDArray>(src);
     if (nd_array->device.device_type != dev.device_type ||
@@ -362,31 +1770,81 @@ inline ObjectRef CopyTo(ObjectRef src, const DLDevice& dev) {
       VLOG(2) << "copying from " << nd_array->device.device_type << "["
               << nd_array->device.device_id << "] to " << dev.device_type << "[" << dev.device_id
               << "]";
-      return nd_array.CopyTo(dev);
+      NDArray ret = NDArray::Empty(nd_array.Shape(), nd_array->dtype, dev, allocator);
+      NDArray::CopyFromTo(nd_array.operator->(), const_cast<DLTensor*>(ret.operator->()), stream);
+      return ret;
     }
     return src;
+  } else if (src->IsInstance<ArrayNode>()) {
+    return CopyTo(ConvertArgument(src), dev, stream, allocator);
   } else {
     ICHECK(src->IsInstance<ADTObj>())
         << "VM data must be NDArray or a list of NDArray, but received: " << src->_type_key;
     std::vector<ObjectRef> ret;
     ADT adt = Downcast<ADT>(src);
     for (size_t i = 0; i < adt.size(); i++) {
-      ret.push_back(CopyTo(adt[i], dev));
+      ret.push_back(CopyTo(adt[i], dev, stream, allocator));
     }
     return ADT(adt->tag, ret.begin(), ret.end());
   }
 }
 
 void VirtualMachine::SetInputTensorWithIndex(std::vector<RegType>& func_args,
-                                             const TVMArgValue& inp_tensor, int index, Device dev) {
+                                             const TVMArgValue& inp_tensor, int index, Device dev,
+                                             TVMStreamHandle stream) {
+  // The converted inputs share the pooled memory of the VM.
+  Allocator* allocator = nullptr;
+  for (size_t i = 0; i < devices.size() && i < allocators.size(); ++i) {
+    if (devices[i].device_type == dev.device_type && devices[i].device_id == dev.device_id) {
+      allocator = allocators[i];
+      break;
+    }
+  }
   if (inp_tensor.type_code() == kTVMDLTensorHandle) {
     if (NDArray::AbilityOfZeroCopyForDLTensor(inp_tensor, dev)) {
       func_args[index] = NDArray::FromExternalDLTensor(*inp_tensor);
     } else {
-      func_args[index] = NDArray::NewFromDLTensor(inp_tensor, dev);
+      const DLTensor* dl_tensor = inp_tensor;
+      std::vector<int64_t> shape(dl_tensor->shape, dl_tensor->shape + dl_tensor->ndim);
+      NDArray ret = NDArray::Empty(ShapeTuple(shape), dl_tensor->dtype, dev, allocator);
+      NDArray::CopyFromTo(dl_tensor, const_cast<DLTensor*>(ret.operator->()), stream);
+      func_args[index] = ret;
     }
   } else {
-    func_args[index] = CopyTo(inp_tensor, dev);
+    func_args[index] = CopyTo(inp_tensor, dev, stream, allocator);
+  }
+}
+
+TVMStreamHandle VirtualMachine::GetStream(Index device_index, Index stream_index) {
+  device_index = ResolveDeviceIndex(device_index);
+  ICHECK_GE(stream_index, 0) << "The stream index must be non-negative";
+  if (streams_.size() < devices.size()) streams_.resize(devices.size());
+  std::vector<TVMStreamHandle>& streams = streams_[device_index];
+  // stream 0 is the default stream of the device
+  if (streams.empty()) streams.push_back(nullptr);
+  const Device& dev = devices[device_index];
+  while (static_cast<Index>(streams.size()) <= stream_index) {
+    streams.push_back(DeviceAPI::Get(dev)->CreateStream(dev));
+  }
+  return streams[stream_index];
+}
+
+void VirtualMachine::SetDefaultStream(Index device_index, TVMStreamHandle stream) {
+  device_index = ResolveDeviceIndex(device_index);
+  // Create the slot of the default stream.
+  GetStream(device_index, 0);
+  streams_[device_index][0] = stream;
+}
+
+VirtualMachine::VirtualMachine() = default;
+
+VirtualMachine::~VirtualMachine() {
+  for (size_t i = 0; i < streams_.size(); ++i) {
+    for (size_t j = 1; j < streams_[i].size(); ++j) {
+      if (streams_[i][j] != nullptr) {
+        DeviceAPI::Get(devices[i])->FreeStream(devices[i], streams_[i][j]);
+      }
+    }
   }
 }
 
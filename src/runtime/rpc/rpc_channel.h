@@ -45,6 +45,22 @@ class RPCChannel {
    * \return The actual bytes sent.
    */
   virtual size_t Send(const void* data, size_t size) = 0;
+  /*!
+   * \brief Send a list of buffers over to the channel in order, the channels
+   *  supporting scatter-gather IO send them with a single call.
+   *  The default implementation only sends the first non-empty buffer.
+   *
+   * \param data The data pointers.
+   * \param size The sizes of the data.
+   * \param num The number of buffers.
+   * \return The actual bytes sent.
+   */
+  virtual size_t SendGather(const void* const* data, const size_t* size, int num) {
+    for (int i = 0; i < num; ++i) {
+      if (size[i] != 0) return Send(data[i], size[i]);
+    }
+    return 0;
+  }
   /*!
    * \brief Recv data from channel.
    *
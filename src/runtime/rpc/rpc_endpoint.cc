@@ -705,6 +705,34 @@ std::shared_ptr<RPCEndpoint> RPCEndpoint::Create(std::unique_ptr<RPCChannel> cha
 
 RPCEndpoint::~RPCEndpoint() { this->Shutdown(); }
 
+void RPCEndpoint::SendWithPayload(const void* payload, size_t nbytes) {
+  const char* ptr = static_cast<const char*>(payload);
+  // Gather the last part of the pending packet header with the payload, so that they are sent
+  // together and the payload is never copied into the writer.
+  while (writer_.bytes_available() != 0) {
+    writer_.ReadWithCallback(
+        [&](const void* data, size_t size) -> size_t {
+          if (size != writer_.bytes_available()) {
+            return channel_->Send(data, size);
+          }
+          const void* buffers[2] = {data, ptr};
+          size_t sizes[2] = {size, nbytes};
+          size_t n = channel_->SendGather(buffers, sizes, 2);
+          if (n <= size) return n;
+          ptr += n - size;
+          nbytes -= n - size;
+          return size;
+        },
+        writer_.bytes_available());
+  }
+  while (nbytes != 0) {
+    size_t n = channel_->Send(ptr, nbytes);
+    ICHECK_NE(n, 0U) << "Channel closes before the payload is sent";
+    ptr += n;
+    nbytes -= n;
+  }
+}
+
 void RPCEndpoint::Shutdown() {
   if (channel_ != nullptr) {
     RPCCode code = RPCCode::kShutdown;
@@ -817,7 +845,11 @@ void RPCEndpoint::CopyToRemote(void* from_bytes, DLTensor* to, uint64_t nbytes)
   handler_->Write(code);
   RPCReference::SendDLTensor(handler_, to);
   handler_->Write(nbytes);
-  handler_->WriteArray(reinterpret_cast<char*>(from_bytes), nbytes);
+  if (nbytes >= kRPCZeroCopyMinBytes) {
+    SendWithPayload(from_bytes, nbytes);
+  } else {
+    handler_->WriteArray(reinterpret_cast<char*>(from_bytes), nbytes);
+  }
   ICHECK(HandleUntilReturnEvent(true, [](TVMArgs) {}) == RPCCode::kReturn);
 }
 
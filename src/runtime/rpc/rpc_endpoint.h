@@ -48,6 +48,8 @@ const int kRPCTrackerMagic = 0x2f271;
 const int kRPCSuccess = kRPCMagic + 0;
 // cannot found matched key in server
 const int kRPCMismatch = kRPCMagic + 2;
+// the minimum size of the copied data sent from the caller memory instead of the ring buffer
+const uint64_t kRPCZeroCopyMinBytes = 64 << 10;
 
 /*! \brief Enumeration code for the RPC tracker */
 enum class TrackerCode : int {
@@ -179,6 +181,8 @@ class RPCEndpoint {
   void Init();
   // Shutdown
   void Shutdown();
+  // Flush the writer followed by a payload sent directly from the given memory.
+  void SendWithPayload(const void* payload, size_t nbytes);
   // Internal channel.
   std::unique_ptr<RPCChannel> channel_;
 
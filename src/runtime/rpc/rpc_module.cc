@@ -403,6 +403,58 @@ TVM_REGISTER_GLOBAL("runtime.RPCTimeEvaluator")
       }
     });
 
+/*!
+ * \brief Time the entry functions of a batch of modules in one call, so that measuring a batch of
+ *  candidates on a remote device takes a single round trip instead of one per candidate.
+ *  The arguments are (device_type, device_id, number, repeat, min_repeat_ms,
+ *  cooldown_interval_ms, repeats_to_cooldown, f_preproc_name, num_entries), followed by each
+ *  entry as (module, num_args, args...). A module may appear in several entries, e.g. once per
+ *  set of its arguments.
+ * \return The costs of `repeat` runs of each entry in seconds, as an array of doubles.
+ */
+TVM_REGISTER_GLOBAL("runtime.RPCBatchTimeEvaluate").set_body([](TVMArgs args, TVMRetValue* rv) {
+  constexpr int kNumHeaderArgs = 9;
+  ICHECK_GE(args.size(), kNumHeaderArgs) << "ValueError: Incomplete batch timing arguments";
+  Device dev;
+  dev.device_type = static_cast<DLDeviceType>(args[0].operator int());
+  dev.device_id = args[1];
+  int number = args[2];
+  int repeat = args[3];
+  int min_repeat_ms = args[4];
+  int cooldown_interval_ms = args[5];
+  int repeats_to_cooldown = args[6];
+  std::string f_preproc_name = args[7];
+  int num_entries = args[8];
+  PackedFunc f_preproc;
+  if (!f_preproc_name.empty()) {
+    auto* pf_preproc = runtime::Registry::Get(f_preproc_name);
+    ICHECK(pf_preproc != nullptr) << "Cannot find " << f_preproc_name << " in the global function";
+    f_preproc = *pf_preproc;
+  }
+  std::string blob;
+  int offset = kNumHeaderArgs;
+  for (int i = 0; i < num_entries; ++i) {
+    ICHECK_LE(offset + 2, args.size()) << "ValueError: Missing the arguments of entry " << i;
+    Module mod = args[offset];
+    int num_args = args[offset + 1];
+    offset += 2;
+    ICHECK_LE(offset + num_args, args.size()) << "ValueError: Missing the arguments of entry " << i;
+    PackedFunc pf = mod.GetFunction(symbol::tvm_module_main, true);
+    CHECK(pf != nullptr) << "Cannot find the entry function of entry " << i;
+    PackedFunc ftimer = profiling::WrapTimeEvaluator(pf, dev, number, repeat, min_repeat_ms,
+                                                     cooldown_interval_ms, repeats_to_cooldown,
+                                                     f_preproc);
+    TVMRetValue costs;
+    ftimer.CallPacked(TVMArgs(args.values + offset, args.type_codes + offset, num_args), &costs);
+    blob += costs.operator std::string();
+    offset += num_args;
+  }
+  TVMByteArray arr;
+  arr.size = blob.length();
+  arr.data = blob.data();
+  *rv = arr;
+});
+
 TVM_REGISTER_GLOBAL("cache_flush_cpu_non_first_arg").set_body([](TVMArgs args, TVMRetValue* rv) {
   CPUCacheFlush(1, args);
 });
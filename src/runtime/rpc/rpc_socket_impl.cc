@@ -52,6 +52,13 @@ class SockChannel final : public RPCChannel {
     }
     return static_cast<size_t>(n);
   }
+  size_t SendGather(const void* const* data, const size_t* size, int num) final {
+    ssize_t n = sock_.SendV(data, size, num);
+    if (n == -1) {
+      support::Socket::Error("SockChannel::SendGather");
+    }
+    return static_cast<size_t>(n);
+  }
   size_t Recv(void* data, size_t size) final {
     ssize_t n = sock_.Recv(data, size);
     if (n == -1) {
@@ -60,6 +60,27 @@ uint32_t GetSpinCount() {
   return atoi(val);
 }
 
+constexpr uint32_t kDefaultRegionSpinCount = 1 << 22;
+
+uint32_t GetRegionSpinCount() {
+  const char* val = getenv("TVM_THREAD_POOL_REGION_SPIN_COUNT");
+  if (!val) {
+    return kDefaultRegionSpinCount;
+  }
+  return atoi(val);
+}
+
+// A hint to the CPU that this is a spin-wait loop, much cheaper than yielding to the OS.
+inline void SpinPause() {
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield" ::: "memory");
+#else
+  std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
 }  // namespace
 
 // stride in the page, fit to cache line.
@@ -76,6 +97,7 @@ class ParallelLauncher {
     this->cdata = cdata;
     this->flambda = flambda;
     this->env.num_task = num_task;
+    this->work_stealing = false;
     has_error_.store(false);
     // reshape
     if (static_cast<size_t>(num_task) > par_errors_.size()) {
@@ -95,9 +117,39 @@ class ParallelLauncher {
     }
   }
   ~ParallelLauncher() { delete[] sync_counter_; }
+  // Split the tasks of the work-stealing mode evenly into one contiguous range per worker.
+  void InitTaskRanges(int num_task, int num_workers) {
+    if (num_workers > num_task_ranges_) {
+      task_ranges_.reset(new TaskRange[num_workers]);
+      num_task_ranges_ = num_workers;
+    }
+    num_workers_ = num_workers;
+    num_running_workers_.store(num_workers);
+    for (int i = 0; i < num_workers; ++i) {
+      uint32_t begin = static_cast<int64_t>(num_task) * i / num_workers;
+      uint32_t end = static_cast<int64_t>(num_task) * (i + 1) / num_workers;
+      task_ranges_[i].range.store(PackRange(begin, end), std::memory_order_release);
+    }
+    this->work_stealing = true;
+  }
+  // Run the tasks of a worker in the work-stealing mode: first those in its own range from the
+  // front, then those left to the other workers from the back of their ranges.
+  void RunTasks(int worker_id) {
+    int task_id;
+    while (PopTask(worker_id, &task_id) || StealTask(worker_id, &task_id)) {
+      if ((*flambda)(task_id, &env, cdata) == 0) {
+        SignalJobFinish();
+      } else {
+        SignalJobError(task_id);
+      }
+    }
+    num_running_workers_.fetch_sub(1);
+  }
   // Wait n jobs to finish
   int WaitForJobs() {
-    while (num_pending_.load() != 0) {
+    // In the work-stealing mode, the workers may still be looking for tasks to steal, so wait for
+    // them too before the task ranges can be reset by the next job.
+    while (num_pending_.load() != 0 || num_running_workers_.load() != 0) {
       tvm::runtime::threading::Yield();
     }
     if (!has_error_.load()) return 0;
@@ -130,8 +182,57 @@ class ParallelLauncher {
   // Whether this thread is worker of the pool.
   // used to prevent recursive launch.
   bool is_worker{false};
+  // Whether the tasks are distributed in the work-stealing mode,
+  // where the task id of a queued task is the id of the worker.
+  bool work_stealing{false};
 
  private:
+  // The range [begin, end) of the task ids left to a worker, packed as (end << 32 | begin),
+  // so that the owner and the thieves can update it with a single CAS.
+  struct TaskRange {
+    std::atomic<uint64_t> range{0};
+    // the cache line padding is used for avoid false sharing between the workers
+    char pad[kL1CacheBytes - sizeof(std::atomic<uint64_t>)];
+  };
+  static uint64_t PackRange(uint32_t begin, uint32_t end) {
+    return (static_cast<uint64_t>(end) << 32) | begin;
+  }
+  // Take the first task in the range of the worker.
+  bool PopTask(int worker_id, int* task_id) {
+    std::atomic<uint64_t>& range = task_ranges_[worker_id].range;
+    uint64_t old = range.load(std::memory_order_acquire);
+    uint32_t begin, end;
+    do {
+      begin = static_cast<uint32_t>(old);
+      end = static_cast<uint32_t>(old >> 32);
+      if (begin >= end) {
+        return false;
+      }
+    } while (!range.compare_exchange_weak(old, PackRange(begin + 1, end),
+                                          std::memory_order_acq_rel));
+    *task_id = begin;
+    return true;
+  }
+  // Take the last task in the range of another worker, starting from the next worker.
+  bool StealTask(int worker_id, int* task_id) {
+    for (int i = 1; i < num_workers_; ++i) {
+      std::atomic<uint64_t>& range = task_ranges_[(worker_id + i) % num_workers_].range;
+      uint64_t old = range.load(std::memory_order_acquire);
+      while (true) {
+        uint32_t begin = static_cast<uint32_t>(old);
+        uint32_t end = static_cast<uint32_t>(old >> 32);
+        if (begin >= end) {
+          break;
+        }
+        if (range.compare_exchange_weak(old, PackRange(begin, end - 1),
+                                        std::memory_order_acq_rel)) {
+          *task_id = end - 1;
+          return true;
+        }
+      }
+    }
+    return false;
+  }
   // The pending jobs.
   std::atomic<int32_t> num_pending_;
   // Whether error has been countered.
@@ -140,6 +241,14 @@ class ParallelLauncher {
   std::atomic<int32_t>* sync_counter_{nullptr};
   // The error message
   std::vector<std::string> par_errors_;
+  // The task ranges of the workers in the work-stealing mode.
+  std::unique_ptr<TaskRange[]> task_ranges_;
+  // The number of allocated task ranges.
+  int num_task_ranges_{0};
+  // The number of workers in the work-stealing mode.
+  int num_workers_{0};
+  // The number of workers which are still running or stealing tasks.
+  std::atomic<int32_t> num_running_workers_{0};
 };
 
 /*! \brief Lock-free single-producer-single-consumer queue for each thread */
@@ -173,14 +282,26 @@ class SpscTaskQueue {
    * \brief Pop a task out of the queue and condition wait if no tasks.
    * \param output The pointer to the task to be dequeued.
    * \param spin_count The number of iterations to spin before sleep.
+   * \param in_region Whether the producer is in a persistent parallel region, if any.
+   * \param region_spin_count The number of iterations to spin in a persistent parallel region.
    * \return Whether pop is successful (true) or we need to exit now (false).
    */
-  bool Pop(Task* output, uint32_t spin_count) {
+  bool Pop(Task* output, uint32_t spin_count, const std::atomic<bool>* in_region = nullptr,
+           uint32_t region_spin_count = 0) {
     // Busy wait a bit when the queue is empty.
     // If a new task comes to the queue quickly, this wait avoid the worker from sleeping.
-    // The default spin count is set by following the typical omp convention
-    for (uint32_t i = 0; i < spin_count && pending_.load() == 0; ++i) {
-      tvm::runtime::threading::Yield();
+    // The default spin count is set by following the typical omp convention.
+    // In a persistent parallel region, the next task is expected shortly, so keep spinning
+    // without yielding until the region ends or the region spin count runs out.
+    for (uint32_t i = 0; pending_.load() == 0; ++i) {
+      if (in_region != nullptr && i < region_spin_count &&
+          in_region->load(std::memory_order_relaxed)) {
+        SpinPause();
+      } else if (i < spin_count) {
+        tvm::runtime::threading::Yield();
+      } else {
+        break;
+      }
     }
     if (pending_.fetch_sub(1) == 0) {
       std::unique_lock<std::mutex> lock(mutex_);
@@ -288,8 +409,16 @@ class ThreadPool {
     ParallelLauncher* launcher = ParallelLauncher::ThreadLocal();
     ICHECK(!launcher->is_worker)
         << "Cannot launch parallel job inside worker, consider fuse then parallel";
+    bool work_stealing =
+        threading::GetTaskScheduleMode() == threading::TaskScheduleMode::kWorkStealing;
     if (num_task == 0) {
-      num_task = num_workers_used_;
+      num_task = work_stealing ? num_workers_used_ * threading::ChunksPerWorker()
+                               : num_workers_used_;
+    }
+    if (work_stealing) {
+      // The tasks of a job are not guaranteed to run at the same time, so no barrier is set up
+      launcher->Init(flambda, cdata, num_task, false);
+      return LaunchWorkStealing(launcher, num_task);
     }
     if (need_sync != 0) {
       ICHECK_LE(num_task, num_workers_used_)
@@ -307,7 +436,12 @@ class ThreadPool {
     // use the main thread to run task 0
     if (exclude_worker0_) {
       TVMParallelGroupEnv* penv = &(tsk.launcher->env);
-      if ((*tsk.launcher->flambda)(0, penv, cdata) == 0) {
+      // The main thread acts as a worker while it runs task 0, so that a job launched by the
+      // task runs inline instead of reusing the launcher of this job.
+      launcher->is_worker = true;
+      int res = (*tsk.launcher->flambda)(0, penv, cdata);
+      launcher->is_worker = false;
+      if (res == 0) {
         tsk.launcher->SignalJobFinish();
       } else {
         tsk.launcher->SignalJobError(tsk.task_id);
@@ -317,6 +451,25 @@ class ThreadPool {
     return res;
   }
 
+  int LaunchWorkStealing(ParallelLauncher* launcher, int num_task) {
+    int num_workers = std::min(num_task, num_workers_used_);
+    launcher->InitTaskRanges(num_task, num_workers);
+    SpscTaskQueue::Task tsk;
+    tsk.launcher = launcher;
+    // if worker0 is taken by the main, queues_[0] is abandoned
+    for (int i = exclude_worker0_; i < num_workers; ++i) {
+      tsk.task_id = i;
+      queues_[i]->Push(tsk);
+    }
+    // use the main thread as worker 0
+    if (exclude_worker0_) {
+      launcher->is_worker = true;
+      launcher->RunTasks(0);
+      launcher->is_worker = false;
+    }
+    return launcher->WaitForJobs();
+  }
+
   static ThreadPool* ThreadLocal() { return dmlc::ThreadLocalStore<ThreadPool>::Get(); }
 
   void UpdateWorkerConfiguration(threading::ThreadGroup::AffinityMode mode, int nthreads,
@@ -331,6 +484,23 @@ class ThreadPool {
 
   int32_t NumThreads() const { return num_workers_used_; }
 
+  void BeginPersistentRegion() {
+    if (region_depth_++ == 0) {
+      in_region_.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  void EndPersistentRegion() {
+    ICHECK_GT(region_depth_, 0) << "No persistent parallel region to end";
+    if (--region_depth_ == 0) {
+      in_region_.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  void ConfigurePersistentRegion(uint32_t spin_count) {
+    region_spin_count_.store(spin_count, std::memory_order_relaxed);
+  }
+
  private:
   // Shared initialization code
   void Init() {
@@ -354,8 +524,13 @@ class ThreadPool {
     // the global first use of the ThreadPool.
     // TODO(tulloch): should we make this configurable via standard APIs?
     static size_t spin_count = GetSpinCount();
-    while (queue->Pop(&task, spin_count)) {
+    while (queue->Pop(&task, spin_count, &in_region_,
+                      region_spin_count_.load(std::memory_order_relaxed))) {
       ICHECK(task.launcher != nullptr);
+      if (task.launcher->work_stealing) {
+        task.launcher->RunTasks(task.task_id);
+        continue;
+      }
       TVMParallelGroupEnv* penv = &(task.launcher->env);
       void* cdata = task.launcher->cdata;
       if ((*task.launcher->flambda)(task.task_id, penv, cdata) == 0) {
@@ -372,11 +547,18 @@ class ThreadPool {
   bool exclude_worker0_{true};
   std::vector<std::unique_ptr<SpscTaskQueue> > queues_;
   std::unique_ptr<tvm::runtime::threading::ThreadGroup> threads_;
+  // the depth of the nested persistent parallel regions of the launching thread
+  int region_depth_{0};
+  // whether the launching thread is in a persistent parallel region, read by the workers
+  std::atomic<bool> in_region_{false};
+  // the number of iterations the workers spin in a persistent parallel region
+  std::atomic<uint32_t> region_spin_count_{GetRegionSpinCount()};
 };
 
 /*!
  * \brief args[0] is the AffinityMode, args[1] is the number of threads.
- *  args2 is a list of CPUs which is used to set the CPU affinity.
+ *  args2 is a list of CPUs which is used to set the CPU affinity,
+ *  or a list of NUMA nodes when args[0] is kSpecifyNumaNodes.
  */
 TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRetValue* rv) {
   threading::ThreadGroup::AffinityMode mode =
@@ -393,6 +575,24 @@ TVM_REGISTER_GLOBAL("runtime.config_threadpool").set_body([](TVMArgs args, TVMRe
   threading::Configure(mode, nthreads, cpus);
 });
 
+/*!
+ * \brief args[0] is the TaskScheduleMode, args[1] is the number of chunks per worker in the
+ *  work-stealing mode.
+ */
+TVM_REGISTER_GLOBAL("runtime.config_threadpool_schedule")
+    .set_body_typed([](int mode, int chunks_per_worker) {
+      threading::ConfigureTaskSchedule(static_cast<threading::TaskScheduleMode>(mode),
+                                       chunks_per_worker);
+    });
+
+/*!
+ * \brief args[0] is the number of iterations the workers spin in a persistent parallel region.
+ */
+TVM_REGISTER_GLOBAL("runtime.config_persistent_region").set_body_typed([](int spin_count) {
+  CHECK_GE(spin_count, 0) << "ValueError: The spin count can not be negative";
+  threading::ConfigurePersistentRegion(spin_count);
+});
+
 TVM_REGISTER_GLOBAL("runtime.NumThreads").set_body_typed([]() -> int32_t {
   return threading::NumThreads();
 });
@@ -453,13 +653,23 @@ void ResetThreadPool() { tvm::runtime::ThreadPool::ThreadLocal()->Reset(); }
 /*!
  * \brief configure the CPU id affinity
  * \param mode The preferred CPU type (1 = big, -1 = little, -2 = kSpecifyOneCorePerThread,
- *  -3 = kSpecifyThreadShareAllCore).
+ *  -3 = kSpecifyThreadShareAllCore, -4 = kSpecifyNumaNodes).
  * \param nthreads The number of threads to use (0 = use all).
- * \param cpus cpus A list of CPUs is used to set the 'cpu affinity' for the worker threads.
+ * \param cpus cpus A list of CPUs is used to set the 'cpu affinity' for the worker threads, or
+ *  a list of NUMA nodes for kSpecifyNumaNodes.
  *
  */
 void Configure(tvm::runtime::threading::ThreadGroup::AffinityMode mode, int nthreads,
                std::vector<unsigned int> cpus) {
+  if (mode == ThreadGroup::kSpecifyNumaNodes) {
+    // Pin the threads to the cores of the nodes, one per thread, and keep the memory allocated
+    // by this thread, e.g. the workspace and the pooled storage, local to the nodes.
+    SetMemoryNumaNodes(cpus);
+    cpus = NumaNodeCpus(cpus);
+    mode = ThreadGroup::kSpecifyOneCorePerThread;
+  } else {
+    SetMemoryNumaNodes({});
+  }
   tvm::runtime::threading::SetMaxConcurrency(cpus.size());
 #if !TVM_THREADPOOL_USE_OPENMP
   tvm::runtime::ThreadPool::ThreadLocal()->UpdateWorkerConfiguration(mode, nthreads, cpus);
@@ -468,13 +678,44 @@ void Configure(tvm::runtime::threading::ThreadGroup::AffinityMode mode, int nthr
 #endif
 }
 int32_t NumThreads() { return tvm::runtime::ThreadPool::ThreadLocal()->NumThreads(); }
+
+// A worker runs the parallel jobs launched by its tasks inline,
+// so it has no thread pool of its own to keep spinning.
+void BeginPersistentRegion() {
+#if !TVM_THREADPOOL_USE_OPENMP
+  if (!ParallelLauncher::ThreadLocal()->is_worker) {
+    tvm::runtime::ThreadPool::ThreadLocal()->BeginPersistentRegion();
+  }
+#endif
+}
+
+void EndPersistentRegion() {
+#if !TVM_THREADPOOL_USE_OPENMP
+  if (!ParallelLauncher::ThreadLocal()->is_worker) {
+    tvm::runtime::ThreadPool::ThreadLocal()->EndPersistentRegion();
+  }
+#endif
+}
+
+void ConfigurePersistentRegion(uint32_t spin_count) {
+#if !TVM_THREADPOOL_USE_OPENMP
+  tvm::runtime::ThreadPool::ThreadLocal()->ConfigurePersistentRegion(spin_count);
+#endif
+}
 }  // namespace threading
 }  // namespace runtime
 }  // namespace tvm
 
 int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_task) {
   int num_workers = tvm::runtime::threading::MaxConcurrency();
-  if (num_workers == 1) {
+#if !TVM_THREADPOOL_USE_OPENMP
+  // A job launched from a task of another job, e.g. by a kernel run in parallel with other
+  // kernels, runs inline on the thread of the task.
+  bool nested = tvm::runtime::ParallelLauncher::ThreadLocal()->is_worker;
+#else
+  bool nested = false;
+#endif
+  if (num_workers == 1 || nested) {
     std::atomic<int32_t> sync_counter{0};
     TVMParallelGroupEnv env;
     env.num_task = 1;
@@ -506,6 +747,8 @@ int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) {
   using tvm::runtime::kSyncStride;
   int num_task = penv->num_task;
   std::atomic<int>* sync_counter = reinterpret_cast<std::atomic<int>*>(penv->sync_handle);
+  ICHECK(sync_counter != nullptr)
+      << "TVMBackendParallelBarrier is not supported in the work-stealing task schedule mode";
   int old_counter = sync_counter[task_id * kSyncStride].fetch_add(1, std::memory_order_release);
   for (int i = 0; i < num_task; ++i) {
     if (i != task_id) {
@@ -40,6 +40,10 @@
 #define HEXAGON_STACK_ALIGNMENT 32
 #endif
 #include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
 #include <thread>
 #define CURRENT_THREAD_HANDLE (static_cast<std::thread::native_handle_type>(0))
 namespace tvm {
@@ -212,6 +216,8 @@ class ThreadGroup::Impl {
         case kLittle:
         case kBig:
         case kSpecifyOneCorePerThread:
+        // Configure() lowers the NUMA nodes to one core per thread before getting here.
+        case kSpecifyNumaNodes:
           for (unsigned i = 0; i < threads_.size(); ++i) {
             bool reverse = mode == kLittle;
             unsigned core_id;
@@ -250,6 +256,7 @@ class ThreadGroup::Impl {
     std::vector<unsigned> ids;
     switch (mode) {
       case kSpecifyOneCorePerThread:
+      case kSpecifyNumaNodes:
       case kSpecifyThreadShareAllCore:
         for (size_t i = 0; i < sorted_order_.size(); ++i) {
           ids.push_back(sorted_order_[i]);
@@ -354,6 +361,79 @@ void Yield() {
 #endif
 }
 
+namespace {
+
+TaskScheduleMode DefaultTaskScheduleMode() {
+  const char* val = getenv("TVM_THREAD_POOL_SCHEDULE");
+  if (val == nullptr || std::string(val) == "static") {
+    return TaskScheduleMode::kStatic;
+  }
+  if (std::string(val) == "work_stealing") {
+    return TaskScheduleMode::kWorkStealing;
+  }
+  LOG(WARNING) << "Unknown TVM_THREAD_POOL_SCHEDULE '" << val
+               << "', expected 'static' or 'work_stealing'. Using 'static'.";
+  return TaskScheduleMode::kStatic;
+}
+
+int DefaultChunksPerWorker() {
+  constexpr int kDefaultChunksPerWorker = 4;
+  const char* val = getenv("TVM_THREAD_POOL_CHUNKS_PER_WORKER");
+  return val == nullptr ? kDefaultChunksPerWorker : std::max(atoi(val), 1);
+}
+
+thread_local TaskScheduleMode task_schedule_mode = DefaultTaskScheduleMode();
+thread_local int chunks_per_worker = DefaultChunksPerWorker();
+
+thread_local std::vector<unsigned int> memory_numa_nodes;
+
+}  // namespace
+
+void ConfigureTaskSchedule(TaskScheduleMode mode, int chunks) {
+  if (chunks <= 0) {
+    LOG(WARNING) << "The number of chunks per worker '" << chunks << "' should be positive, "
+                 << "the setting of the task schedule is not success.";
+    return;
+  }
+  task_schedule_mode = mode;
+  chunks_per_worker = chunks;
+}
+
+TaskScheduleMode GetTaskScheduleMode() { return task_schedule_mode; }
+
+int ChunksPerWorker() { return chunks_per_worker; }
+
+std::vector<unsigned int> NumaNodeCpus(const std::vector<unsigned int>& nodes) {
+  std::vector<unsigned int> cpus;
+#if defined(__linux__)
+  for (unsigned int node : nodes) {
+    // The format of the list is like "0-3,8-11"
+    std::ostringstream filepath;
+    filepath << "/sys/devices/system/node/node" << node << "/cpulist";
+    std::ifstream ifs(filepath.str());
+    ICHECK(!ifs.fail()) << "ValueError: Cannot find the NUMA node " << node;
+    std::string range;
+    while (std::getline(ifs, range, ',')) {
+      size_t dash = range.find('-');
+      unsigned int begin = std::stoul(range.substr(0, dash));
+      unsigned int end = dash == std::string::npos ? begin : std::stoul(range.substr(dash + 1));
+      for (unsigned int cpu = begin; cpu <= end; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+#else
+  LOG(WARNING) << "NUMA nodes are only supported on Linux";
+#endif
+  return cpus;
+}
+
+void SetMemoryNumaNodes(std::vector<unsigned int> nodes) { memory_numa_nodes = std::move(nodes); }
+
+const std::vector<unsigned int>& GetMemoryNumaNodes() { return memory_numa_nodes; }
+
 /*!
  * \brief Set the maximum number of available cores.
  */
@@ -23,7 +23,13 @@
  */
 #include "workspace_pool.h"
 
+#include <tvm/runtime/registry.h>
+
+#include <algorithm>
 #include <memory>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
 
 namespace tvm {
 namespace runtime {
@@ -31,10 +37,38 @@ namespace runtime {
 // page size.
 constexpr size_t kWorkspacePageSize = 4 << 10;
 
+namespace {
+// The number of open arena scopes over all threads.
+std::atomic<int> arena_depth{0};
+
+// Whether the memory of the device can be addressed at an offset of an allocation.
+bool SupportArena(DLDeviceType device_type) {
+  switch (static_cast<int>(device_type)) {
+    case kDLCPU:
+    case kDLCUDA:
+    case kDLCUDAHost:
+    case kDLROCM:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void UpdatePeak(std::atomic<int64_t>* peak, int64_t value) {
+  int64_t current = peak->load(std::memory_order_relaxed);
+  while (current < value && !peak->compare_exchange_weak(current, value)) {
+  }
+}
+
+size_t RoundUp(size_t nbytes, size_t alignment) {
+  return (nbytes + (alignment - 1)) / alignment * alignment;
+}
+}  // namespace
+
 class WorkspacePool::Pool {
  public:
   // constructor
-  Pool() {
+  Pool(Stats* stats, bool use_arena) : stats_(stats), use_arena_(use_arena) {
     // safe guard header on each list.
     Entry e;
     e.data = nullptr;
@@ -44,26 +78,26 @@ class WorkspacePool::Pool {
   }
   // allocate from pool
   void* Alloc(Device dev, DeviceAPI* device, size_t nbytes) {
+    stats_->num_allocs++;
+    if (use_arena_ && arena_depth.load(std::memory_order_relaxed) > 0) {
+      return ArenaAlloc(dev, device, nbytes);
+    }
     // Allocate align to page.
-    nbytes = (nbytes + (kWorkspacePageSize - 1)) / kWorkspacePageSize * kWorkspacePageSize;
+    nbytes = RoundUp(nbytes, kWorkspacePageSize);
     if (nbytes == 0) nbytes = kWorkspacePageSize;
     Entry e;
-    DLDataType type;
-    type.code = kDLUInt;
-    type.bits = 8;
-    type.lanes = 1;
     if (free_list_.size() == 2) {
       e = free_list_.back();
       free_list_.pop_back();
       if (e.size < nbytes) {
         // resize the page
-        device->FreeDataSpace(dev, e.data);
-        e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
+        FreePage(dev, device, e);
+        e = AllocPage(dev, device, nbytes);
+      } else {
+        stats_->num_hits++;
       }
     } else if (free_list_.size() == 1) {
-      e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-      e.size = nbytes;
+      e = AllocPage(dev, device, nbytes);
     } else {
       if (free_list_.back().size >= nbytes) {
         // find smallest fit
@@ -72,20 +106,24 @@ class WorkspacePool::Pool {
         }
         e = *(it + 1);
         free_list_.erase(it + 1);
+        stats_->num_hits++;
       } else {
         // resize the page
         e = free_list_.back();
         free_list_.pop_back();
-        device->FreeDataSpace(dev, e.data);
-        e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
+        FreePage(dev, device, e);
+        e = AllocPage(dev, device, nbytes);
       }
     }
     allocated_.push_back(e);
+    AddBytesInUse(e.size);
     return e.data;
   }
   // free resource back to pool
-  void Free(void* data) {
+  void Free(Device dev, DeviceAPI* device, void* data) {
+    if (!arena_allocs_.empty() && ArenaFree(dev, device, data)) {
+      return;
+    }
     Entry e;
     if (allocated_.back().data == data) {
       // quick path, last allocated.
@@ -99,6 +137,7 @@ class WorkspacePool::Pool {
       e = allocated_[index];
       allocated_.erase(allocated_.begin() + index);
     }
+    AddBytesInUse(-static_cast<int64_t>(e.size));
     if (free_list_.back().size < e.size) {
       free_list_.push_back(e);
     } else if (free_list_.size() == 2) {
@@ -116,9 +155,13 @@ class WorkspacePool::Pool {
   // Release all resources
   void Release(Device dev, DeviceAPI* device) {
     for (size_t i = 1; i < free_list_.size(); ++i) {
-      device->FreeDataSpace(dev, free_list_[i].data);
+      FreePage(dev, device, free_list_[i]);
     }
     free_list_.clear();
+    for (const Entry& chunk : arena_) {
+      FreePage(dev, device, chunk);
+    }
+    arena_.clear();
   }
 
  private:
@@ -127,12 +170,144 @@ class WorkspacePool::Pool {
     void* data;
     size_t size;
   };
+  /*! \brief an allocation in the arena */
+  struct ArenaEntry {
+    void* data;
+    size_t chunk;
+    size_t offset;
+    size_t size;
+    bool freed;
+  };
+  Entry AllocPage(Device dev, DeviceAPI* device, size_t nbytes) {
+    DLDataType type;
+    type.code = kDLUInt;
+    type.bits = 8;
+    type.lanes = 1;
+    Entry e;
+    e.data = device->AllocDataSpace(dev, nbytes, kTempAllocaAlignment, type);
+    e.size = nbytes;
+    int64_t reserved = stats_->bytes_reserved += nbytes;
+    UpdatePeak(&stats_->peak_bytes_reserved, reserved);
+    return e;
+  }
+  void FreePage(Device dev, DeviceAPI* device, const Entry& e) {
+    device->FreeDataSpace(dev, e.data);
+    stats_->bytes_reserved -= e.size;
+  }
+  void AddBytesInUse(int64_t nbytes) {
+    int64_t in_use = stats_->bytes_in_use += nbytes;
+    UpdatePeak(&stats_->peak_bytes_in_use, in_use);
+  }
+  // allocate from the top of the arena, growing it with a chunk twice as large when full
+  void* ArenaAlloc(Device dev, DeviceAPI* device, size_t nbytes) {
+    nbytes = std::max(RoundUp(nbytes, kTempAllocaAlignment), size_t(kTempAllocaAlignment));
+    stats_->num_arena_allocs++;
+    if (!arena_.empty() && arena_offset_ + nbytes <= arena_[arena_chunk_].size) {
+      stats_->num_hits++;
+    } else {
+      // The chunks after the current one hold no allocation.
+      size_t chunk_size = RoundUp(nbytes, kWorkspacePageSize);
+      if (!arena_.empty()) {
+        chunk_size = std::max(chunk_size, arena_[arena_chunk_].size * 2);
+        while (arena_.size() > arena_chunk_ + 1) {
+          FreePage(dev, device, arena_.back());
+          arena_.pop_back();
+        }
+      }
+      arena_.push_back(AllocPage(dev, device, chunk_size));
+      arena_chunk_ = arena_.size() - 1;
+      arena_offset_ = 0;
+    }
+    void* data = static_cast<char*>(arena_[arena_chunk_].data) + arena_offset_;
+    arena_allocs_.push_back(ArenaEntry{data, arena_chunk_, arena_offset_, nbytes, false});
+    arena_offset_ += nbytes;
+    AddBytesInUse(nbytes);
+    return data;
+  }
+  // free an allocation of the arena, return false if the data is not allocated from the arena
+  bool ArenaFree(Device dev, DeviceAPI* device, void* data) {
+    auto it = arena_allocs_.rbegin();
+    for (; it != arena_allocs_.rend() && (it->freed || it->data != data); ++it) {
+    }
+    if (it == arena_allocs_.rend()) return false;
+    it->freed = true;
+    AddBytesInUse(-static_cast<int64_t>(it->size));
+    // Rewind the bump pointer over the released allocations at the top.
+    while (!arena_allocs_.empty() && arena_allocs_.back().freed) {
+      arena_chunk_ = arena_allocs_.back().chunk;
+      arena_offset_ = arena_allocs_.back().offset;
+      arena_allocs_.pop_back();
+    }
+    // Compact the arena into a single chunk once it is empty.
+    if (arena_allocs_.empty() && arena_.size() > 1) {
+      size_t total_size = 0;
+      for (const Entry& chunk : arena_) {
+        total_size += chunk.size;
+        FreePage(dev, device, chunk);
+      }
+      arena_.clear();
+      arena_.push_back(AllocPage(dev, device, total_size));
+      arena_chunk_ = 0;
+      arena_offset_ = 0;
+    }
+    return true;
+  }
+  /*! \brief The statistics of the device */
+  Stats* stats_;
+  /*! \brief Whether the allocations in an arena scope are served by the arena */
+  bool use_arena_;
   /*! \brief List of free items, sorted from small to big size */
   std::vector<Entry> free_list_;
   /*! \brief List of allocated items */
   std::vector<Entry> allocated_;
+  /*! \brief The chunks of the arena */
+  std::vector<Entry> arena_;
+  /*! \brief The chunk and the offset of the bump pointer */
+  size_t arena_chunk_{0};
+  size_t arena_offset_{0};
+  /*! \brief The allocations of the arena which are not rewound yet, in allocation order */
+  std::vector<ArenaEntry> arena_allocs_;
 };
 
+std::string WorkspacePool::Stats::AsJSON() const {
+  int64_t allocs = num_allocs.load();
+  int64_t peak_reserved = peak_bytes_reserved.load();
+  double hit_rate = allocs > 0 ? static_cast<double>(num_hits.load()) / allocs : 0.0;
+  double fragmentation =
+      peak_reserved > 0 ? 1.0 - static_cast<double>(peak_bytes_in_use.load()) / peak_reserved
+                        : 0.0;
+  std::ostringstream os;
+  os << "{\"num_allocs\": " << allocs << ", \"num_hits\": " << num_hits.load()
+     << ", \"num_arena_allocs\": " << num_arena_allocs.load()
+     << ", \"bytes_in_use\": " << bytes_in_use.load()
+     << ", \"peak_bytes_in_use\": " << peak_bytes_in_use.load()
+     << ", \"bytes_reserved\": " << bytes_reserved.load()
+     << ", \"peak_bytes_reserved\": " << peak_reserved << ", \"hit_rate\": " << hit_rate
+     << ", \"fragmentation\": " << fragmentation << "}";
+  return os.str();
+}
+
+WorkspacePool::ArenaScope::ArenaScope(bool enable) : enable_(enable) {
+  if (enable_) arena_depth++;
+}
+
+WorkspacePool::ArenaScope::~ArenaScope() {
+  if (enable_) arena_depth--;
+}
+
+WorkspacePool::Stats* WorkspacePool::GetStats(Device dev) {
+  // Never destructed, the pools of the exiting threads still update the statistics.
+  static std::mutex* mutex = new std::mutex();
+  static auto* stats = new std::unordered_map<int64_t, std::unique_ptr<Stats>>();
+  int64_t key = (static_cast<int64_t>(dev.device_type) << 32) | dev.device_id;
+  std::lock_guard<std::mutex> lock(*mutex);
+  std::unique_ptr<Stats>& entry = (*stats)[key];
+  if (entry == nullptr) {
+    entry = std::make_unique<Stats>();
+  }
+  return entry.get();
+}
+
 WorkspacePool::WorkspacePool(DLDeviceType device_type, DeviceAPI* device)
     : device_type_(device_type), device_(device) {}
 
@@ -153,15 +328,21 @@ void* WorkspacePool::AllocWorkspace(Device dev, size_t size) {
     array_.resize(dev.device_id + 1, nullptr);
   }
   if (array_[dev.device_id] == nullptr) {
-    array_[dev.device_id] = new Pool();
+    array_[dev.device_id] = new Pool(GetStats(dev), SupportArena(device_type_));
   }
   return array_[dev.device_id]->Alloc(dev, device_, size);
 }
 
 void WorkspacePool::FreeWorkspace(Device dev, void* ptr) {
   ICHECK(static_cast<size_t>(dev.device_id) < array_.size() && array_[dev.device_id] != nullptr);
-  array_[dev.device_id]->Free(ptr);
+  array_[dev.device_id]->Free(dev, device_, ptr);
 }
 
+TVM_REGISTER_GLOBAL("runtime.WorkspacePoolStats")
+    .set_body_typed([](int device_type, int device_id) {
+      Device dev{static_cast<DLDeviceType>(device_type), device_id};
+      return String(WorkspacePool::GetStats(dev)->AsJSON());
+    });
+
 }  // namespace runtime
 }  // namespace tvm
@@ -26,7 +26,10 @@
 
 #include <tvm/runtime/device_api.h>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace tvm {
@@ -41,9 +44,49 @@ namespace runtime {
  *  - Only a few allocation will happen, and space will be released after use.
  *  - The release order is usually in reverse order of allocate
  *  - Repeative pattern of same allocations over different runs.
+ *
+ *  Inside an ArenaScope, the allocations on devices with addressable memory are
+ *  served by a bump pointer in a per-thread arena instead of the free list. The
+ *  arena is compacted into a single chunk once all its allocations are released
+ *  after the scope, e.g. after a VM invocation.
  */
 class TVM_DLL WorkspacePool {
  public:
+  /*!
+   * \brief The statistics of the workspace pools of a device, aggregated over threads.
+   *
+   *  A hit is an allocation which is served without allocating device memory.
+   */
+  struct Stats {
+    std::atomic<int64_t> num_allocs{0};
+    std::atomic<int64_t> num_hits{0};
+    std::atomic<int64_t> num_arena_allocs{0};
+    std::atomic<int64_t> bytes_in_use{0};
+    std::atomic<int64_t> peak_bytes_in_use{0};
+    std::atomic<int64_t> bytes_reserved{0};
+    std::atomic<int64_t> peak_bytes_reserved{0};
+    /*! \brief Return the statistics in JSON, with the hit rate and the fragmentation. */
+    std::string AsJSON() const;
+  };
+  /*!
+   * \brief Serve the workspace allocations with the arena in the lifetime of the object.
+   *  Scopes can be nested, and can be opened on different threads.
+   */
+  class ArenaScope {
+   public:
+    /*! \param enable Whether to open the scope, a disabled scope does nothing. */
+    explicit ArenaScope(bool enable = true);
+    ~ArenaScope();
+
+   private:
+    bool enable_;
+  };
+  /*!
+   * \brief Get the statistics of the workspace pools of a device.
+   * \param dev The device.
+   * \return The statistics, which live until the end of the program.
+   */
+  static Stats* GetStats(Device dev);
   /*!
    * \brief Create pool with specific device type and device.
    * \param device_type The device type.
@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+/*!
+ * \file x86_amx.cc
+ * \brief Enabling the AMX tiles of x86 for the process.
+ *
+ *  Linux only lets a process use the AMX tile data after requesting the permission for it, the
+ *  first AMX instruction of a process without the permission raises SIGILL. The permission is
+ *  requested once when the runtime is loaded, if the CPU has the AMX tiles.
+ */
+#include <tvm/runtime/registry.h>
+
+#if defined(__linux__) && defined(__x86_64__)
+#include <cpuid.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+#if defined(__linux__) && defined(__x86_64__)
+/*! \brief The arch_prctl option requesting the permission of an extended state feature. */
+constexpr int kArchReqXCompPerm = 0x1023;
+/*! \brief The extended state feature of the AMX tile data. */
+constexpr int kXFeatureXTileData = 18;
+#endif
+
+/*!
+ * \brief Request the permission of the AMX tile data.
+ * \return Whether the process is allowed to use AMX.
+ */
+bool RequestAMXPermission() {
+#if defined(__linux__) && defined(__x86_64__)
+  unsigned int eax, ebx, ecx, edx;
+  // CPUID.(EAX=07H, ECX=0):EDX[24] reports AMX-TILE.
+  if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) || !(edx & (1U << 24))) {
+    return false;
+  }
+  return syscall(SYS_arch_prctl, kArchReqXCompPerm, kXFeatureXTileData) == 0;
+#else
+  return false;
+#endif
+}
+
+/*! \brief Whether the process is allowed to use AMX, requested when the runtime is loaded. */
+const bool amx_enabled = RequestAMXPermission();
+
+}  // namespace
+
+TVM_REGISTER_GLOBAL("runtime.amx_enabled").set_body_typed([]() { return amx_enabled; });
+
+}  // namespace runtime
+}  // namespace tvm
@@ -179,6 +179,10 @@
 #define TVM_INFO_USE_SORT "NOT-FOUND"
 #endif
 
+#ifndef TVM_INFO_USE_NCCL
+#define TVM_INFO_USE_NCCL "NOT-FOUND"
+#endif
+
 #ifndef TVM_INFO_USE_NNPACK
 #define TVM_INFO_USE_NNPACK "NOT-FOUND"
 #endif
@@ -269,6 +273,7 @@ TVM_DLL Map<String, String> GetLibInfo() {
       {"USE_DNNL", TVM_INFO_USE_DNNL},
       {"USE_ETHOSN", TVM_INFO_USE_ETHOSN},
       {"USE_FALLBACK_STL_MAP", TVM_INFO_USE_FALLBACK_STL_MAP},
+      {"USE_GOOGLE_BENCHMARK", TVM_INFO_USE_GOOGLE_BENCHMARK},
       {"USE_GRAPH_EXECUTOR_CUDA_GRAPH", TVM_INFO_USE_GRAPH_EXECUTOR_CUDA_GRAPH},
       {"USE_GRAPH_EXECUTOR", TVM_INFO_USE_GRAPH_EXECUTOR},
       {"USE_GTEST", TVM_INFO_USE_GTEST},
@@ -287,6 +292,7 @@ TVM_DLL Map<String, String> GetLibInfo() {
       {"USE_MIOPEN", TVM_INFO_USE_MIOPEN},
       {"USE_MKL", TVM_INFO_USE_MKL},
       {"USE_MSVC_MT", TVM_INFO_USE_MSVC_MT},
+      {"USE_NCCL", TVM_INFO_USE_NCCL},
       {"USE_NNPACK", TVM_INFO_USE_NNPACK},
       {"USE_OPENCL", TVM_INFO_USE_OPENCL},
       {"USE_OPENCL_GTEST", TVM_INFO_USE_OPENCL_GTEST},
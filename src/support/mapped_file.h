@@ -0,0 +1,134 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file mapped_file.h
+ * \brief A memory mapping of a file, shared by the tensors which reference it in place.
+ */
+#ifndef TVM_SUPPORT_MAPPED_FILE_H_
+#define TVM_SUPPORT_MAPPED_FILE_H_
+
+#include <tvm/runtime/logging.h>
+#include <tvm/runtime/ndarray.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <memory>
+#include <string>
+
+namespace tvm {
+namespace support {
+
+/*!
+ * \brief A private, copy-on-write memory mapping of a file.
+ *
+ * NDArrays loaded from a mapped file, e.g. the constants of a VM executable, reference the
+ * mapping in place and keep it alive, so the pages are only read from disk when first touched.
+ */
+class MappedFile {
+ public:
+  /*! \brief The start of the mapping. */
+  char* data{nullptr};
+  /*! \brief The size of the mapping in bytes. */
+  size_t size{0};
+  /*! \brief The mapping this one is a slice of, or nullptr when it owns the pages. */
+  std::shared_ptr<MappedFile> parent{nullptr};
+
+  /*!
+   * \brief Map the given file into memory.
+   * \param file_name The file to be mapped.
+   * \return The mapping, or nullptr when the file cannot be mapped.
+   */
+  static std::shared_ptr<MappedFile> Open(const std::string& file_name) {
+#ifndef _WIN32
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+      close(fd);
+      return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    if (addr == MAP_FAILED) return nullptr;
+    auto mapped_file = std::make_shared<MappedFile>();
+    mapped_file->data = static_cast<char*>(addr);
+    mapped_file->size = size;
+    return mapped_file;
+#else
+    return nullptr;
+#endif
+  }
+
+  /*!
+   * \brief Get a part of a mapping, which keeps the whole mapping alive.
+   * \param parent The mapping.
+   * \param offset The offset of the part in bytes.
+   * \param size The size of the part in bytes.
+   * \return The part of the mapping.
+   */
+  static std::shared_ptr<MappedFile> Slice(const std::shared_ptr<MappedFile>& parent,
+                                           size_t offset, size_t size) {
+    ICHECK_LE(offset + size, parent->size);
+    auto mapped_file = std::make_shared<MappedFile>();
+    mapped_file->data = parent->data + offset;
+    mapped_file->size = size;
+    mapped_file->parent = parent;
+    return mapped_file;
+  }
+
+  ~MappedFile() {
+#ifndef _WIN32
+    if (data != nullptr && parent == nullptr) munmap(data, size);
+#endif
+  }
+};
+
+/*!
+ * \brief Create an NDArray which references its data in a mapped file and keeps it alive.
+ * \param mapped_file The mapping.
+ * \param data The data of the tensor in the mapping.
+ * \param shape The shape of the tensor.
+ * \param dtype The data type of the tensor.
+ * \return The CPU tensor.
+ */
+inline runtime::NDArray ViewMappedNDArray(const std::shared_ptr<MappedFile>& mapped_file,
+                                          char* data, runtime::ShapeTuple shape,
+                                          DLDataType dtype) {
+  using runtime::NDArray;
+  NDArray::Container* container = new NDArray::Container(data, shape, dtype, Device{kDLCPU, 0});
+  container->manager_ctx = new std::shared_ptr<MappedFile>(mapped_file);
+  container->SetDeleter([](runtime::Object* obj) {
+    auto* ptr = static_cast<NDArray::Container*>(obj);
+    delete static_cast<std::shared_ptr<MappedFile>*>(ptr->manager_ctx);
+    delete ptr;
+  });
+  return NDArray(runtime::GetObjectPtr<runtime::Object>(container));
+}
+
+}  // namespace support
+}  // namespace tvm
+#endif  // TVM_SUPPORT_MAPPED_FILE_H_
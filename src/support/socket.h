@@ -46,6 +46,7 @@
 #include <sys/ioctl.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif
 #include <tvm/runtime/logging.h>
@@ -502,6 +503,35 @@ class TCPSocket : public Socket {
     return RetryCallOnEINTR(
         [&]() { return send(sockfd, buf, static_cast<sock_size_t>(len), flag); });
   }
+  /*!
+   * \brief send a list of buffers in order with a single scatter-gather call
+   * \param bufs the pointers to the buffers
+   * \param lens the sizes of the buffers
+   * \param num the number of buffers
+   * \return size of data actually sent
+   *         return -1 if error occurs
+   */
+  ssize_t SendV(const void* const* bufs, const size_t* lens, int num) {
+#ifdef _WIN32
+    std::vector<WSABUF> wsa_bufs(num);
+    for (int i = 0; i < num; ++i) {
+      wsa_bufs[i].buf = const_cast<char*>(reinterpret_cast<const char*>(bufs[i]));
+      wsa_bufs[i].len = static_cast<ULONG>(lens[i]);
+    }
+    DWORD nsent = 0;
+    if (WSASend(sockfd, wsa_bufs.data(), num, &nsent, 0, nullptr, nullptr) == SOCKET_ERROR) {
+      return -1;
+    }
+    return static_cast<ssize_t>(nsent);
+#else
+    std::vector<iovec> iov(num);
+    for (int i = 0; i < num; ++i) {
+      iov[i].iov_base = const_cast<void*>(bufs[i]);
+      iov[i].iov_len = lens[i];
+    }
+    return RetryCallOnEINTR([&]() { return writev(sockfd, iov.data(), num); });
+#endif
+  }
   /*!
    * \brief receive data using the socket
    * \param buf_ the pointer to the buffer
@@ -321,6 +321,14 @@ void CodeGenCPU::AddMainFunction(const std::string& entry_func_name) {
   global->setDLLStorageClass(llvm::GlobalVariable::DLLExportStorageClass);
 }
 
+void CodeGenCPU::AddFunctionRegistry(const Array<String>& func_names) {
+  // The registries of the modules linked into one library are merged into any one of them, the
+  // library module looks up the other functions by name.
+  llvm::GlobalVariable* func_registry = CreateFuncRegistry(
+      func_names, llvm::GlobalValue::WeakAnyLinkage, runtime::symbol::tvm_func_registry);
+  func_registry->setDLLStorageClass(llvm::GlobalVariable::DLLExportStorageClass);
+}
+
 std::unique_ptr<llvm::Module> CodeGenCPU::Finish() {
   // link modules
   if (dbg_info_ != nullptr) {
@@ -1307,16 +1315,17 @@ void CodeGenCPU::DefineMetadata(runtime::metadata::Metadata metadata) {
   builder_->CreateRet(ConstInt32(0));
 }
 
-void CodeGenCPU::DefineFunctionRegistry(Array<String> func_names) {
-  ICHECK(is_system_lib_) << "Loading of --system-lib modules is yet to be defined for C runtime";
-  Array<String> symbols;
+llvm::GlobalVariable* CodeGenCPU::CreateFuncRegistry(const Array<String>& func_names,
+                                                     llvm::GlobalValue::LinkageTypes linkage,
+                                                     const std::string& name) {
   std::vector<llvm::Constant*> funcs;
   for (auto sym : func_names) {
-    symbols.push_back(sym);
-    auto* sym_func =
-        llvm::Function::Create(ftype_tvm_backend_packed_c_func_, llvm::GlobalValue::ExternalLinkage,
-                               sym.operator std::string(), module_.get());
-
+    llvm::Function* sym_func = module_->getFunction(sym.operator std::string());
+    if (sym_func == nullptr) {
+      sym_func = llvm::Function::Create(ftype_tvm_backend_packed_c_func_,
+                                        llvm::GlobalValue::ExternalLinkage,
+                                        sym.operator std::string(), module_.get());
+    }
     funcs.emplace_back(sym_func);
   }
   llvm::ArrayType* t_tvm_crt_func_ptrs =
@@ -1325,7 +1334,7 @@ void CodeGenCPU::DefineFunctionRegistry(Array<String> func_names) {
 
   llvm::GlobalVariable* func_registry_ptrs = new llvm::GlobalVariable(
       *module_, t_tvm_crt_func_ptrs, true, llvm::GlobalValue::InternalLinkage,
-      llvm::ConstantArray::get(t_tvm_crt_func_ptrs, funcs), "_tvm_func_registry_ptrs");
+      llvm::ConstantArray::get(t_tvm_crt_func_ptrs, funcs), name + "_ptrs");
 
   uint64_t align = layout.getTypeAllocSize(ftype_tvm_backend_packed_c_func_->getPointerTo());
 #if TVM_LLVM_VERSION >= 100
@@ -1333,14 +1342,20 @@ void CodeGenCPU::DefineFunctionRegistry(Array<String> func_names) {
 #else
   func_registry_ptrs->setAlignment(align);
 #endif
-  llvm::GlobalVariable* func_registry = new llvm::GlobalVariable(
-      *module_, t_tvm_crt_func_registry_, true, llvm::GlobalVariable::InternalLinkage,
+  return new llvm::GlobalVariable(
+      *module_, t_tvm_crt_func_registry_, true, linkage,
       llvm::ConstantStruct::get(
           t_tvm_crt_func_registry_,
-          {GetConstString(::tvm::target::GenerateFuncRegistryNames(symbols)),
+          {GetConstString(::tvm::target::GenerateFuncRegistryNames(func_names)),
            llvm::ConstantExpr::getBitCast(func_registry_ptrs,
                                           ftype_tvm_backend_packed_c_func_->getPointerTo())}),
-      "_tvm_crt_func_registry");
+      name);
+}
+
+void CodeGenCPU::DefineFunctionRegistry(Array<String> func_names) {
+  ICHECK(is_system_lib_) << "Loading of --system-lib modules is yet to be defined for C runtime";
+  llvm::GlobalVariable* func_registry = CreateFuncRegistry(
+      func_names, llvm::GlobalVariable::InternalLinkage, "_tvm_crt_func_registry");
   llvm::GlobalVariable* module = new llvm::GlobalVariable(
       *module_, t_tvm_crt_module_, true, llvm::GlobalValue::InternalLinkage,
       llvm::ConstantStruct::get(t_tvm_crt_module_, {func_registry}), "_tvm_crt_module");
@@ -1495,6 +1510,8 @@ void CodeGenCPU::VisitStmt_(const AttrStmtNode* op) {
       ICHECK(value != nullptr);
       this->HandleImport(value->value);
       this->VisitStmt(op->body);
+    } else if (op->attr_key == tir::attr::pragma_scalable_vectorize) {
+      CodeGenLLVM::VisitStmt_(op);
     } else {
       LOG(WARNING) << "Unknown pragma " << op->attr_key;
       this->VisitStmt(op->body);
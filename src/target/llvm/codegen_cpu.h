@@ -64,6 +64,7 @@ class CodeGenCPU : public CodeGenLLVM {
             bool system_lib, bool dynamic_lookup, bool target_c_runtime) override;
   void AddFunction(const PrimFunc& f) override;
   void AddMainFunction(const std::string& entry_func_name) override;
+  void AddFunctionRegistry(const Array<String>& func_names) override;
   std::unique_ptr<llvm::Module> Finish() override;
   void VisitStmt_(const AssertStmtNode* op) override;
   void VisitStmt_(const AttrStmtNode* op) override;
@@ -86,6 +87,15 @@ class CodeGenCPU : public CodeGenLLVM {
 
  protected:
   void AddStartupFunction() final;
+  /*!
+   * \brief Create the FuncRegistry of the functions, declaring the ones not in this module.
+   * \param func_names List of functions to be included, in order.
+   * \param linkage The linkage of the FuncRegistry.
+   * \param name The name of the FuncRegistry.
+   */
+  llvm::GlobalVariable* CreateFuncRegistry(const Array<String>& func_names,
+                                           llvm::GlobalValue::LinkageTypes linkage,
+                                           const std::string& name);
   // meta data
   llvm::MDNode* md_tbaa_ctx_ptr_{nullptr};
   // TVM related data types
@@ -309,6 +309,10 @@ void CodeGenLLVM::AddMainFunction(const std::string& entry_func_name) {
   LOG(FATAL) << "not implemented";
 }
 
+void CodeGenLLVM::AddFunctionRegistry(const Array<String>& func_names) {
+  LOG(FATAL) << "not implemented";
+}
+
 llvm::Value* CodeGenLLVM::GetThreadIndex(const IterVar& iv) {
   LOG(FATAL) << "not implemented";
   return nullptr;
@@ -699,7 +703,7 @@ llvm::Value* CodeGenLLVM::CreateVecConcat(std::vector<llvm::Value*> vecs) {
 }
 
 void CodeGenLLVM::CreateSerialFor(llvm::Value* begin, llvm::Value* end, llvm::Value* stride,
-                                  const Var& loop_var, const Stmt& body) {
+                                  const Var& loop_var, const Stmt& body, llvm::MDNode* loop_md) {
   llvm::BasicBlock* pre_block = builder_->GetInsertBlock();
   std::string loop_var_name = loop_var->name_hint;
   auto* for_begin = llvm::BasicBlock::Create(*ctx_, "for_begin_" + loop_var_name, function_);
@@ -719,10 +723,27 @@ void CodeGenLLVM::CreateSerialFor(llvm::Value* begin, llvm::Value* end, llvm::Va
   var_map_.erase(loop_var.get());
   llvm::Value* loop_next = CreateAdd(loop_var.dtype(), loop_value, stride);
   loop_value->addIncoming(loop_next, builder_->GetInsertBlock());
-  builder_->CreateBr(for_begin);
+  llvm::BranchInst* back_edge = builder_->CreateBr(for_begin);
+  if (loop_md != nullptr) {
+    back_edge->setMetadata(llvm::LLVMContext::MD_loop, loop_md);
+  }
   builder_->SetInsertPoint(for_end);
 }
 
+llvm::MDNode* CodeGenLLVM::CreateScalableVectorizeLoopMD() {
+  auto make_flag = [this](const char* name) {
+    llvm::Metadata* ops[] = {llvm::MDString::get(*ctx_, name),
+                             llvm::ConstantAsMetadata::get(llvm::ConstantInt::getTrue(*ctx_))};
+    return llvm::MDNode::get(*ctx_, ops);
+  };
+  // The first operand of a loop id refers to the loop id itself.
+  llvm::Metadata* ops[] = {nullptr, make_flag("llvm.loop.vectorize.enable"),
+                           make_flag("llvm.loop.vectorize.scalable.enable")};
+  llvm::MDNode* loop_id = llvm::MDNode::getDistinct(*ctx_, ops);
+  loop_id->replaceOperandWith(0, loop_id);
+  return loop_id;
+}
+
 // cast operatpr
 llvm::Value* CodeGenLLVM::CreateCast(DataType from, DataType to, llvm::Value* value) {
   llvm::Type* target = DTypeToLLVMType(to);
@@ -1514,8 +1535,13 @@ void CodeGenLLVM::VisitStmt_(const ForNode* op) {
   } else {
     ICHECK(op->kind == ForKind::kSerial);
   }
+  llvm::MDNode* loop_md = nullptr;
+  if (scalable_vectorize_loops_.count(op->loop_var.get())) {
+    loop_md = CreateScalableVectorizeLoopMD();
+  }
   CreateSerialFor(MakeValue(op->min), MakeValue(op->extent),
-                  llvm::ConstantInt::getSigned(GetLLVMType(op->extent), 1), op->loop_var, op->body);
+                  llvm::ConstantInt::getSigned(GetLLVMType(op->extent), 1), op->loop_var, op->body,
+                  loop_md);
 }
 
 void CodeGenLLVM::VisitStmt_(const WhileNode* op) {
@@ -1635,6 +1661,10 @@ void CodeGenLLVM::VisitStmt_(const AttrStmtNode* op) {
     const VarNode* v = op->node.as<VarNode>();
     ICHECK(v);
     volatile_buf_.insert(v);
+  } else if (op->attr_key == tir::attr::pragma_scalable_vectorize) {
+    const VarNode* v = op->node.as<VarNode>();
+    ICHECK(v);
+    scalable_vectorize_loops_.insert(v);
   }
   this->VisitStmt(op->body);
 }
@@ -140,6 +140,12 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
    * \param entry_func_name The name of entry function to be added.
    */
   virtual void AddMainFunction(const std::string& entry_func_name);
+  /*!
+   * \brief Add the exported table of the functions of a shared library.
+   * \param func_names The names of the functions, which may be defined by other modules linked
+   *  with this one.
+   */
+  virtual void AddFunctionRegistry(const Array<String>& func_names);
   /*!
    * \brief Finish current pass of codegen, get the module.
    * \return the created module.
@@ -433,9 +439,11 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   llvm::Value* CreateVecFlip(llvm::Value* vec);
   llvm::Value* CreateVecConcat(std::vector<llvm::Value*> vecs);
   llvm::Value* CreateVecPad(llvm::Value* vec, int target_lanes);
-  // Create serial for
+  // Create serial for, with the optional loop metadata attached to its back edge.
   void CreateSerialFor(llvm::Value* begin, llvm::Value* end, llvm::Value* stride,
-                       const Var& loop_var, const Stmt& body);
+                       const Var& loop_var, const Stmt& body, llvm::MDNode* loop_md = nullptr);
+  // Create the loop metadata requesting the vectorization with scalable vectors.
+  llvm::MDNode* CreateScalableVectorizeLoopMD();
   // add alias information.
   void AddAliasInfo(llvm::Instruction* inst, const VarNode* buffer_var, PrimExpr index,
                     DataType access_dtype);
@@ -512,6 +520,8 @@ class CodeGenLLVM : public ExprFunctor<llvm::Value*(const PrimExpr&)>,
   std::unordered_set<const VarNode*> alias_var_set_;
   // set of volatile buffer.
   std::unordered_set<const VarNode*> volatile_buf_;
+  // The loop variables of the loops marked to be vectorized with scalable vectors.
+  std::unordered_set<const VarNode*> scalable_vectorize_loops_;
   // deep comparison of PrimExpr
   ExprDeepEqual deep_equal_;
   // binding of let variables. Enables duplicate var defs that map to same value
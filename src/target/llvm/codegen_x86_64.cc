@@ -35,6 +35,7 @@
 #include <tvm/runtime/registry.h>
 
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "codegen_cpu.h"
@@ -77,12 +78,74 @@ bool TargetHasFeature(const llvm::TargetMachine& tm, const std::string& feature)
 class CodeGenX86_64 final : public CodeGenCPU {
  public:
   llvm::Value* VisitExpr_(const CastNode* op) override;
+  llvm::Value* CreateIntrinsic(const CallNode* op) override;
 
  private:
   llvm::Value* CallVectorIntrin(llvm::Intrinsic::ID id, size_t intrin_lanes, llvm::Type* result_ty,
                                 const std::vector<llvm::Value*>& args);
+  /*!
+   * \brief Load the AMX tile configuration at the entry of the current function, once per
+   *  function. Every function is configured, since the parallel tasks run in their own functions
+   *  on the worker threads, and the tile configuration is a per-thread state.
+   */
+  void EnsureAMXTileConfig();
+
+  /*! \brief The functions in which the AMX tiles are configured. */
+  std::unordered_set<llvm::Function*> amx_configured_functions_;
 };
 
+llvm::Value* CodeGenX86_64::CreateIntrinsic(const CallNode* op) {
+#if TVM_LLVM_VERSION >= 110
+  if (op->op.same_as(builtin_call_llvm_intrin_) || op->op.same_as(builtin_call_llvm_pure_intrin_)) {
+    auto id = static_cast<llvm::Intrinsic::ID>(Downcast<IntImm>(op->args[0])->value);
+    switch (id) {
+      case llvm::Intrinsic::x86_tileloadd64:
+      case llvm::Intrinsic::x86_tilestored64:
+      case llvm::Intrinsic::x86_tilezero:
+      case llvm::Intrinsic::x86_tdpbssd:
+      case llvm::Intrinsic::x86_tdpbsud:
+      case llvm::Intrinsic::x86_tdpbusd:
+      case llvm::Intrinsic::x86_tdpbuud:
+      case llvm::Intrinsic::x86_tdpbf16ps:
+        EnsureAMXTileConfig();
+        break;
+      default:
+        break;
+    }
+  }
+#endif
+  return CodeGenCPU::CreateIntrinsic(op);
+}
+
+void CodeGenX86_64::EnsureAMXTileConfig() {
+#if TVM_LLVM_VERSION >= 110
+  if (!amx_configured_functions_.insert(function_).second) {
+    return;
+  }
+  llvm::IRBuilderBase::InsertPointGuard guard(*builder_);
+  llvm::BasicBlock& entry = function_->getEntryBlock();
+  builder_->SetInsertPoint(&entry, entry.getFirstInsertionPt());
+  // The 64-byte tile configuration with the palette 1, where all the 8 tiles have the maximum
+  // shape of 16 rows of 64 bytes.
+  llvm::AllocaInst* config = builder_->CreateAlloca(llvm::ArrayType::get(t_int8_, 64));
+  config->setAlignment(llvm::Align(64));
+  llvm::Value* base = builder_->CreatePointerCast(config, t_int8_->getPointerTo());
+  builder_->CreateMemSet(base, builder_->getInt8(0), 64, llvm::MaybeAlign(64));
+  builder_->CreateStore(builder_->getInt8(1), base);
+  for (int tile = 0; tile < 8; ++tile) {
+    llvm::Value* colsb =
+        builder_->CreateInBoundsGEP(t_int8_, base, builder_->getInt32(16 + 2 * tile));
+    builder_->CreateStore(builder_->getInt16(64),
+                          builder_->CreatePointerCast(colsb, t_int16_->getPointerTo()));
+    llvm::Value* rows = builder_->CreateInBoundsGEP(t_int8_, base, builder_->getInt32(48 + tile));
+    builder_->CreateStore(builder_->getInt8(16), rows);
+  }
+  llvm::Function* ldtilecfg =
+      llvm::Intrinsic::getDeclaration(module_.get(), llvm::Intrinsic::x86_ldtilecfg);
+  builder_->CreateCall(ldtilecfg, {base});
+#endif
+}
+
 llvm::Value* CodeGenX86_64::VisitExpr_(const CastNode* op) {
   // LLVM does not automatically generate the correct instruction sequences for
   // half -> float conversion (i.e. using AVX2/AVX-512 vectorized variants of
@@ -28,6 +28,7 @@
 #include <dmlc/io.h>
 #include <llvm/ADT/SmallString.h>
 #include <llvm/ADT/StringRef.h>
+#include <llvm/Bitcode/BitcodeReader.h>
 #include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/MCJIT.h>  // Force linking of MCJIT
@@ -41,13 +42,16 @@
 #include <llvm/IR/Module.h>
 #include <llvm/IR/Verifier.h>
 #include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
 #include <llvm/Support/SourceMgr.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/Transforms/Utils/Cloning.h>
 #include <tvm/ir/module.h>
+#include <tvm/ir/transform.h>
 #include <tvm/relay/runtime.h>
 #include <tvm/runtime/container/array.h>
 #include <tvm/runtime/container/string.h>
@@ -56,15 +60,20 @@
 #include <tvm/runtime/object.h>
 #include <tvm/runtime/packed_func.h>
 #include <tvm/runtime/registry.h>
+#include <tvm/support/parallel_for.h>
 #include <tvm/target/codegen.h>
 #include <tvm/target/target.h>
+#include <tvm/tir/stmt_functor.h>
 
 #include <algorithm>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
 #include <system_error>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -83,6 +92,84 @@ using runtime::PackedFunc;
 using runtime::TVMArgs;
 using runtime::TVMRetValue;
 
+TVM_REGISTER_PASS_CONFIG_OPTION("codegen.llvm.num_partitions", Integer);
+
+namespace {
+// See https://llvm.org/docs/LangRef.html#fast-math-flags for details
+llvm::FastMathFlags GetFastMathFlags(const Target& target) {
+  Bool fast_math_all = target->GetAttr<Bool>("fast-math").value_or(Bool(false));
+  Bool fast_math_nnan = target->GetAttr<Bool>("fast-math-nnan").value_or(Bool(false));
+  Bool fast_math_ninf = target->GetAttr<Bool>("fast-math-ninf").value_or(Bool(false));
+  Bool fast_math_nsz = target->GetAttr<Bool>("fast-math-nsz").value_or(Bool(false));
+  Bool fast_math_arcp = target->GetAttr<Bool>("fast-math-arcp").value_or(Bool(false));
+
+  llvm::FastMathFlags fmf;
+  if (fast_math_all) {
+#if TVM_LLVM_VERSION >= 60
+    fmf.setFast();
+#else
+    fmf.setUnsafeAlgebra();
+#endif
+  }
+
+  if (fast_math_nnan) {
+    fmf.setNoNaNs();
+  }
+  if (fast_math_ninf) {
+    fmf.setNoInfs();
+  }
+  if (fast_math_nsz) {
+    fmf.setNoSignedZeros();
+  }
+  if (fast_math_arcp) {
+    fmf.setAllowReciprocal();
+  }
+
+#if TVM_LLVM_VERSION >= 60
+  Bool fast_math_contract = target->GetAttr<Bool>("fast-math-contract").value_or(Bool(false));
+  Bool fast_math_afn = target->GetAttr<Bool>("fast-math-afn").value_or(Bool(false));
+  Bool fast_math_reassoc = target->GetAttr<Bool>("fast-math-reassoc").value_or(Bool(false));
+  if (fast_math_contract) {
+    fmf.setAllowContract(true);
+  }
+  if (fast_math_afn) {
+    fmf.setApproxFunc();
+  }
+  if (fast_math_reassoc) {
+    fmf.setAllowReassoc();
+  }
+#endif
+  return fmf;
+}
+
+// Split the functions into at most num_parts partitions of balanced sizes, estimating the size
+// of a function by the number of nodes of its body. The order of the functions is kept within
+// each partition.
+std::vector<std::vector<PrimFunc>> PartitionFunctions(const std::vector<PrimFunc>& funcs,
+                                                      int num_parts) {
+  std::vector<std::pair<int64_t, size_t>> sizes;
+  for (size_t i = 0; i < funcs.size(); ++i) {
+    int64_t size = 0;
+    tir::PostOrderVisit(funcs[i]->body, [&size](const ObjectRef&) { ++size; });
+    sizes.emplace_back(size, i);
+  }
+  // Assign the largest function first to the smallest partition.
+  std::sort(sizes.begin(), sizes.end(), std::greater<std::pair<int64_t, size_t>>());
+  std::vector<int64_t> part_sizes(num_parts, 0);
+  std::vector<int> part_of(funcs.size());
+  for (const auto& size : sizes) {
+    int part = std::min_element(part_sizes.begin(), part_sizes.end()) - part_sizes.begin();
+    part_sizes[part] += size.first;
+    part_of[size.second] = part;
+  }
+  std::vector<std::vector<PrimFunc>> parts(num_parts);
+  for (size_t i = 0; i < funcs.size(); ++i) {
+    parts[part_of[i]].push_back(funcs[i]);
+  }
+  return parts;
+}
+}  // namespace
+
 class LLVMModuleNode final : public runtime::ModuleNode {
  public:
   ~LLVMModuleNode() {
@@ -239,7 +326,6 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     InitializeLLVM();
     tm_ = GetLLVMTargetMachine(target);
     ctx_ = std::make_shared<llvm::LLVMContext>();
-    std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm_.get());
 
     std::vector<PrimFunc> funcs;
     std::string entry_func;
@@ -266,62 +352,35 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     }
     // TODO(@jroesch): follow up on this condition.
     // ICHECK(funcs.size() > 0);
-    // TODO(tqchen): remove the entry function behavior as it does not
-    // makes sense when we start to use multiple modules.
-    cg->Init("TVMMod", tm_.get(), ctx_.get(), system_lib, system_lib, target_c_runtime);
-
-    // See https://llvm.org/docs/LangRef.html#fast-math-flags for details
-    Bool fast_math_all = target->GetAttr<Bool>("fast-math").value_or(Bool(false));
-    Bool fast_math_nnan = target->GetAttr<Bool>("fast-math-nnan").value_or(Bool(false));
-    Bool fast_math_ninf = target->GetAttr<Bool>("fast-math-ninf").value_or(Bool(false));
-    Bool fast_math_nsz = target->GetAttr<Bool>("fast-math-nsz").value_or(Bool(false));
-    Bool fast_math_arcp = target->GetAttr<Bool>("fast-math-arcp").value_or(Bool(false));
-
-    llvm::FastMathFlags fmf;
-    if (fast_math_all) {
-#if TVM_LLVM_VERSION >= 60
-      fmf.setFast();
-#else
-      fmf.setUnsafeAlgebra();
-#endif
-    }
-
-    if (fast_math_nnan) {
-      fmf.setNoNaNs();
+    llvm::FastMathFlags fmf = GetFastMathFlags(target);
+    int num_parts = transform::PassContext::Current()
+                        ->GetConfig<Integer>("codegen.llvm.num_partitions", Integer(1))
+                        .value()
+                        ->value;
+    CHECK_GE(num_parts, 0) << "ValueError: codegen.llvm.num_partitions can not be negative";
+    if (num_parts == 0) {
+      num_parts = std::max(1U, std::thread::hardware_concurrency());
     }
-    if (fast_math_ninf) {
-      fmf.setNoInfs();
-    }
-    if (fast_math_nsz) {
-      fmf.setNoSignedZeros();
-    }
-    if (fast_math_arcp) {
-      fmf.setAllowReciprocal();
-    }
-
-#if TVM_LLVM_VERSION >= 60
-    Bool fast_math_contract = target->GetAttr<Bool>("fast-math-contract").value_or(Bool(false));
-    Bool fast_math_afn = target->GetAttr<Bool>("fast-math-afn").value_or(Bool(false));
-    Bool fast_math_reassoc = target->GetAttr<Bool>("fast-math-reassoc").value_or(Bool(false));
-    if (fast_math_contract) {
-      fmf.setAllowContract(true);
-    }
-    if (fast_math_afn) {
-      fmf.setApproxFunc();
-    }
-    if (fast_math_reassoc) {
-      fmf.setAllowReassoc();
-    }
-#endif
-
-    cg->SetFastMathFlag(fmf);
-
-    cg->AddFunctionsOrdered(funcs.begin(), funcs.end());
-    if (entry_func.length() != 0) {
-      cg->AddMainFunction(entry_func);
+    num_parts = std::min<int>(num_parts, funcs.size());
+    // The startup function which registers the functions of a system library, and the function
+    // registry of the C runtime, have to see all the functions in one module.
+    if (num_parts <= 1 || system_lib || target_c_runtime) {
+      std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm_.get());
+      // TODO(tqchen): remove the entry function behavior as it does not
+      // makes sense when we start to use multiple modules.
+      cg->Init("TVMMod", tm_.get(), ctx_.get(), system_lib, system_lib, target_c_runtime);
+      cg->SetFastMathFlag(fmf);
+      cg->AddFunctionsOrdered(funcs.begin(), funcs.end());
+      if (entry_func.length() != 0) {
+        cg->AddMainFunction(entry_func);
+      }
+      if (!system_lib && !target_c_runtime && HasFuncRegistry(tm_.get())) {
+        cg->AddFunctionRegistry(function_names_);
+      }
+      module_ = cg->Finish();
+    } else {
+      module_ = BuildPartitioned(PartitionFunctions(funcs, num_parts), entry_func, target, fmf);
     }
-
-    module_ = cg->Finish();
     module_->addModuleFlag(llvm::Module::Warning, "tvm_target",
                            llvm::MDString::get(*ctx_, LLVMTargetToString(target)));
     module_->addModuleFlag(llvm::Module::Override, "Debug Info Version",
@@ -366,6 +425,12 @@ class LLVMModuleNode final : public runtime::ModuleNode {
     mptr_ = module_.get();
     target_ = Target(target_metadata);
     tm_ = GetLLVMTargetMachine(target_);
+    // The functions generated from the PrimFuncs are the ones visible outside of the module.
+    for (const llvm::Function& f : module_->functions()) {
+      if (!f.isDeclaration() && !f.hasLocalLinkage()) {
+        function_names_.push_back(f.getName().str());
+      }
+    }
   }
 
   void LoadIR(const std::string& file_name) {
@@ -387,6 +452,69 @@ class LLVMModuleNode final : public runtime::ModuleNode {
   }
 
  private:
+  /*!
+   * \brief Generate and optimize each partition of the functions in its own LLVM context on its
+   *  own thread, and link the partitions into one module in the context of this module.
+   */
+  std::unique_ptr<llvm::Module> BuildPartitioned(const std::vector<std::vector<PrimFunc>>& parts,
+                                                 const std::string& entry_func,
+                                                 const Target& target,
+                                                 const llvm::FastMathFlags& fmf) {
+    // The first partition is generated in the context of this module, the others are moved
+    // into it as bitcode.
+    std::unique_ptr<llvm::Module> first;
+    std::vector<std::string> bitcodes(parts.size());
+    support::parallel_for_dynamic(0, parts.size(), parts.size(), [&](int thread_id, int i) {
+      std::shared_ptr<llvm::LLVMContext> ctx =
+          i == 0 ? ctx_ : std::make_shared<llvm::LLVMContext>();
+      std::unique_ptr<llvm::TargetMachine> tm = GetLLVMTargetMachine(target);
+      std::unique_ptr<CodeGenLLVM> cg = CodeGenLLVM::Create(tm.get());
+      cg->Init("TVMMod", tm.get(), ctx.get(), false, false, false);
+      cg->SetFastMathFlag(fmf);
+      cg->AddFunctionsOrdered(parts[i].begin(), parts[i].end());
+      if (i == 0 && entry_func.length() != 0) {
+        cg->AddMainFunction(entry_func);
+      }
+      // The registry refers to the functions of the other partitions, linked below.
+      if (i == 0 && HasFuncRegistry(tm.get())) {
+        cg->AddFunctionRegistry(function_names_);
+      }
+      std::unique_ptr<llvm::Module> module = cg->Finish();
+      if (i == 0) {
+        first = std::move(module);
+        return;
+      }
+      llvm::raw_string_ostream os(bitcodes[i]);
+#if TVM_LLVM_VERSION <= 60
+      llvm::WriteBitcodeToFile(module.get(), os);
+#else
+      llvm::WriteBitcodeToFile(*module, os);
+#endif
+      os.flush();
+    });
+    for (size_t i = 1; i < parts.size(); ++i) {
+      llvm::MemoryBufferRef buffer(bitcodes[i], "TVMMod");
+      llvm::Expected<std::unique_ptr<llvm::Module>> module = llvm::parseBitcodeFile(buffer, *ctx_);
+      ICHECK(module) << "Failed to read the bitcode of a partition: "
+                     << llvm::toString(module.takeError());
+      // The helpers generated in every partition, such as the module context, have a linkage
+      // which the linker merges.
+      ICHECK(!llvm::Linker::linkModules(*first, std::move(module.get())))
+          << "Failed to link the partitions";
+    }
+    return first;
+  }
+
+  /*!
+   * \brief Whether the shared library of the module exports the table of its functions, which the
+   *  library module of the runtime resolves them by, instead of a symbol lookup per function.
+   */
+  bool HasFuncRegistry(llvm::TargetMachine* tm) const {
+    // The names of the table are counted on 16 bits, see GenerateFuncRegistryNames.
+    return tm->getTargetTriple().isOSLinux() &&
+           function_names_.size() <= std::numeric_limits<uint16_t>::max();
+  }
+
   void LazyInitJIT() {
     std::lock_guard<std::mutex> lock(mutex_);
     if (ee_) {
@@ -641,6 +641,16 @@ bool NeedsMultiLevelTiling(const ScheduleState& self, const StmtSRef& block_sref
  */
 bool IsSpatialPrimFunc(const PrimFunc& func);
 
+/*!
+ * \brief Get the cumulative length of the spatial loops and the reduction loops of the block.
+ * \param self The schedule state.
+ * \param block_sref The block to be checked.
+ * \return The cumulative lengths, or (-1, -1) if some loop is dynamic, or neither a spatial loop
+ * nor a reduction loop.
+ */
+std::pair<int64_t, int64_t> GetCumulativeSpaceAndReductionLength(const tir::ScheduleState& self,
+                                                                 const tir::StmtSRef& block_sref);
+
 /*!
  * \brief Checks if the rfactor or cross thread reduction is beneficial to the given block.
  * \param self The schedule state.
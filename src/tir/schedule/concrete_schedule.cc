@@ -68,6 +68,7 @@ class ScheduleCopier {
   /*! \brief Create the copier and properly set up the `old2new_` table */
   explicit ScheduleCopier(const ScheduleState& state) {
     // Create SRef tree without parents
+    old2new_.reserve(state->stmt2ref.size());
     for (const auto& kv : state->stmt2ref) {
       const StmtSRefNode* sref = kv.second.operator->();
       old2new_.emplace(sref,                          // the old StmtSRef
@@ -431,6 +431,26 @@ inline void ReorderAndFuseReductionLoops(const tir::Schedule& sch, const tir::Bl
   }
 }
 
+/******** Trace replay ********/
+
+/*!
+ * \brief Translate the inputs of an instruction of a trace to the random variables of a schedule
+ * \param inputs The inputs of the instruction
+ * \param rv_map The mapping from the random variables of the trace to those of the schedule
+ * \return The translated inputs
+ */
+Array<ObjectRef> TranslateInputRVs(const Array<ObjectRef>& inputs,
+                                   const std::unordered_map<const Object*, const Object*>& rv_map);
+
+/*!
+ * \brief Map the outputs of an instruction of a trace to the outputs of its replay on a schedule
+ * \param old_outputs The outputs of the instruction in the trace
+ * \param new_outputs The outputs of the instruction applied to the schedule
+ * \param rv_map The mapping from the random variables of the trace to those of the schedule
+ */
+void TranslateAddOutputRVs(const Array<ObjectRef>& old_outputs, const Array<ObjectRef>& new_outputs,
+                           std::unordered_map<const Object*, const Object*>* rv_map);
+
 /******** Helper functions for enum conversion ********/
 
 /*!
@@ -290,9 +290,10 @@ class PipelineRewriter : public StmtExprMutator {
       const std::unordered_set<Buffer, ObjectPtrHash, ObjectPtrEqual>& double_buffers,
       const Array<Buffer> pipeline_allocs, const For& pipeline_loop,
       const PipelineInfo& pipeline_info,
-      const std::unordered_map<const VarNode*, FragmentInfo>& fragment_info) {
+      const std::unordered_map<const VarNode*, FragmentInfo>& fragment_info,
+      const std::unordered_set<int>& async_stages) {
     PipelineRewriter rewriter(buffer_data_to_buffer, double_buffers, pipeline_allocs, pipeline_loop,
-                              pipeline_info, fragment_info);
+                              pipeline_info, fragment_info, async_stages);
     return rewriter.BuildPipeline();
   }
 
@@ -301,14 +302,16 @@ class PipelineRewriter : public StmtExprMutator {
                    const std::unordered_set<Buffer, ObjectPtrHash, ObjectPtrEqual>& double_buffers,
                    const Array<Buffer>& pipeline_allocs, const For& pipeline_loop,
                    const PipelineInfo& pipeline_info,
-                   const std::unordered_map<const VarNode*, FragmentInfo>& fragment_info)
+                   const std::unordered_map<const VarNode*, FragmentInfo>& fragment_info,
+                   const std::unordered_set<int>& async_stages)
 
       : buffer_data_to_buffer_(std::move(buffer_data_to_buffer)),
         double_buffers_(double_buffers),
         pipeline_allocs_(pipeline_allocs),
         pipeline_loop_(pipeline_loop),
         pipeline_info_(pipeline_info),
-        fragment_info_(fragment_info) {}
+        fragment_info_(fragment_info),
+        async_stages_(async_stages) {}
 
   Stmt BuildPipeline() {
     // Step 1: Analyze accesses to the buffers in the pipeline and compute the number of versions
@@ -328,6 +331,9 @@ class PipelineRewriter : public StmtExprMutator {
       int order = pair.second.order;
       ordered_stmts_.Set(order, block);
     }
+    if (!async_stages_.empty()) {
+      PlanAsyncCopies();
+    }
 
     // Step 2: Emit the pipeline prologue, body and epilogue.
     Stmt prologue = EmitImpl(pipeline_loop_->min, pipeline_loop_->min + max_stage_, true);
@@ -494,6 +500,47 @@ class PipelineRewriter : public StmtExprMutator {
     return Buffer(new_buffer);
   }
 
+  /*!
+   * \brief Plan the commits and the waits of the async copies.
+   *
+   * The copies of the async stages are committed as one group after the last async statement of
+   * every iteration, including the iterations of the prologue and the epilogue where some of the
+   * statements are out of bound, so that the number of groups committed by each iteration is
+   * the same. The first statement reading the results of the async copies waits until at most the
+   * groups committed after the ones it needs are still in flight.
+   */
+  void PlanAsyncCopies() {
+    std::unordered_set<const BufferNode*> async_buffers;
+    int producer_stage = -1;
+    for (int i = 0, n = ordered_stmts_.size(); i < n; ++i) {
+      const Block& block = ordered_stmts_[i];
+      int stage = pipeline_info_.at(block).stage;
+      if (async_stages_.count(stage)) {
+        async_commit_order_ = i;
+        producer_stage = std::max(producer_stage, stage);
+        for (const BufferRegion& write : block->writes) {
+          async_buffers.insert(write->buffer.get());
+        }
+      }
+    }
+    for (int i = 0, n = ordered_stmts_.size(); i < n && async_wait_order_ == -1; ++i) {
+      const Block& block = ordered_stmts_[i];
+      int stage = pipeline_info_.at(block).stage;
+      if (async_stages_.count(stage)) {
+        continue;
+      }
+      for (const BufferRegion& read : block->reads) {
+        if (async_buffers.count(read->buffer.get())) {
+          async_wait_order_ = i;
+          // The groups of the iterations after the one producing the data read here.
+          async_num_inflight_ = stage - producer_stage - (async_commit_order_ < i ? 0 : 1);
+          async_num_inflight_ = std::max(async_num_inflight_, 0);
+          break;
+        }
+      }
+    }
+  }
+
   /*!
    * \brief Emit the pipeline loop in the given range.
    * \param start The start of the range
@@ -519,29 +566,22 @@ class PipelineRewriter : public StmtExprMutator {
       analyzer_.Bind(Downcast<Var>(new_loop_var), Range(start, end));
     }
 
-    for (const Block& block : ordered_stmts_) {
+    for (int i = 0, n = ordered_stmts_.size(); i < n; ++i) {
+      const Block& block = ordered_stmts_[i];
       int stage = pipeline_info_.at(block).stage;
       PrimExpr skewed_loop_var = new_loop_var - stage;
       PrimExpr inbound = analyzer_.Simplify(pipeline_loop_->min <= skewed_loop_var) &&
                          (skewed_loop_var < pipeline_loop_->min + pipeline_loop_->extent);
-      if (analyzer_.CanProve(!inbound)) {
-        continue;
+      if (!analyzer_.CanProve(!inbound)) {
+        if (i == async_wait_order_) {
+          stmts.push_back(Evaluate(Call(DataType::Void(), builtin::ptx_wait_group(),
+                                        {IntImm(DataType::Int(32), async_num_inflight_)})));
+        }
+        stmts.push_back(EmitBlock(block, stage, new_loop_var, start, inbound, is_unit_loop));
       }
-      Block new_block = Downcast<Block>(PipelineBodyRewriter(buffer_data_to_buffer_, buffer_remap_,
-                                                             pipeline_loop_, max_stage_ != 1,
-                                                             fragment_info_)(block));
-      Map<Var, PrimExpr> subst_map;
-      if (is_unit_loop) {
-        subst_map.Set(pipeline_loop_->loop_var, skewed_loop_var);
-      } else {
-        // normalize loop range
-        PrimExpr delta = start - pipeline_loop_->min;
-        subst_map.Set(pipeline_loop_->loop_var, skewed_loop_var + delta);
-        Var loop_iter = Downcast<Var>(new_loop_var);
-        inbound = Substitute(inbound, Map<Var, PrimExpr>{{loop_iter, loop_iter + delta}});
+      if (i == async_commit_order_) {
+        stmts.push_back(Evaluate(Call(DataType::Void(), builtin::ptx_commit_group(), {})));
       }
-      new_block = Downcast<Block>(Substitute(new_block, subst_map));
-      stmts.push_back(BlockRealize({}, inbound, new_block));
     }
 
     Stmt new_loop{nullptr};
@@ -562,6 +602,41 @@ class PipelineRewriter : public StmtExprMutator {
     return BlockRealize({}, Bool(true), MakeBlock(std::move(new_loop), buffer_data_to_buffer_));
   }
 
+  /*!
+   * \brief Emit a statement of the pipeline body in the emitted loop.
+   * \param block The statement of the pipeline body.
+   * \param stage The stage of the statement.
+   * \param new_loop_var The loop var of the emitted loop, or the constant of a unit loop.
+   * \param start The start of the range of the emitted loop.
+   * \param inbound Whether the statement is executed in the iteration.
+   * \param is_unit_loop Whether the emitted loop is a unit loop.
+   * \return The emitted statement.
+   */
+  Stmt EmitBlock(const Block& block, int stage, const PrimExpr& new_loop_var,
+                 const PrimExpr& start, PrimExpr inbound, bool is_unit_loop) {
+    PrimExpr skewed_loop_var = new_loop_var - stage;
+    Block new_block = Downcast<Block>(PipelineBodyRewriter(buffer_data_to_buffer_, buffer_remap_,
+                                                           pipeline_loop_, max_stage_ != 1,
+                                                           fragment_info_)(block));
+    Map<Var, PrimExpr> subst_map;
+    if (is_unit_loop) {
+      subst_map.Set(pipeline_loop_->loop_var, skewed_loop_var);
+    } else {
+      // normalize loop range
+      PrimExpr delta = start - pipeline_loop_->min;
+      subst_map.Set(pipeline_loop_->loop_var, skewed_loop_var + delta);
+      Var loop_iter = Downcast<Var>(new_loop_var);
+      inbound = Substitute(inbound, Map<Var, PrimExpr>{{loop_iter, loop_iter + delta}});
+    }
+    new_block = Downcast<Block>(Substitute(new_block, subst_map));
+    if (async_stages_.count(stage)) {
+      // The copies in the async scope are lowered to PTX async copies by InjectPTXAsyncCopy.
+      BlockNode* n = new_block.CopyOnWrite();
+      n->body = AttrStmt(make_zero(DataType::Int(32)), attr::async_scope, 1, n->body);
+    }
+    return BlockRealize({}, inbound, new_block);
+  }
+
   arith::Analyzer analyzer_;
   Map<Var, Buffer> buffer_data_to_buffer_;
   const std::unordered_set<Buffer, ObjectPtrHash, ObjectPtrEqual>& double_buffers_;
@@ -569,9 +644,16 @@ class PipelineRewriter : public StmtExprMutator {
   For pipeline_loop_;
   PipelineInfo pipeline_info_;
   const std::unordered_map<const VarNode*, FragmentInfo>& fragment_info_;
+  std::unordered_set<int> async_stages_;
   int max_stage_ = -1;
   Map<Buffer, Buffer> buffer_remap_;
   Array<Block> ordered_stmts_;
+  /*! \brief The order of the statement after which the async copies are committed. */
+  int async_commit_order_ = -1;
+  /*! \brief The order of the statement before which the async copies are waited. */
+  int async_wait_order_ = -1;
+  /*! \brief The number of the groups of async copies allowed in flight by the wait. */
+  int async_num_inflight_ = 0;
 };
 
 /*!
@@ -734,10 +816,18 @@ class PipelineInjector : private StmtExprMutator {
     }
     ValidatePipelineBody(pipeline_info, original_order);
 
+    std::unordered_set<int> async_stages;
+    auto async_it = op->annotations.find(attr::software_pipeline_async_stages);
+    if (async_it != op->annotations.end()) {
+      for (const Integer& stage : Downcast<Array<Integer>>((*async_it).second)) {
+        async_stages.insert(stage->value);
+      }
+    }
+
     // Step 4: Rewrite the pipeline body.
-    Stmt pipeline =
-        PipelineRewriter::Rewrite(buffer_data_to_buffer_, double_buffers, pipeline_allocs,
-                                  GetRef<For>(op), pipeline_info, fragment_info_);
+    Stmt pipeline = PipelineRewriter::Rewrite(buffer_data_to_buffer_, double_buffers,
+                                              pipeline_allocs, GetRef<For>(op), pipeline_info,
+                                              fragment_info_, async_stages);
 
     if (const auto* realize = op->body.as<BlockRealizeNode>()) {
       const auto& block = realize->block;
@@ -0,0 +1,148 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*!
+ * \file inject_software_prefetch.cc
+ * \brief Prefetch the rows gathered by the later iterations of the annotated loops.
+ */
+#include <tvm/runtime/registry.h>
+#include <tvm/tir/analysis.h>
+#include <tvm/tir/builtin.h>
+#include <tvm/tir/op.h>
+#include <tvm/tir/stmt_functor.h>
+#include <tvm/tir/transform.h>
+
+#include <vector>
+
+namespace tvm {
+namespace tir {
+
+/*!
+ * \brief Collect the indirect loads of a loop body, i.e. the loads whose indices load another
+ *  buffer at an index depending on the loop variable, such as weight[indices[b, l], d] in an
+ *  embedding bag reducing over l.
+ */
+class IndirectLoadCollector : public StmtExprVisitor {
+ public:
+  explicit IndirectLoadCollector(const Var& loop_var) : loop_var_(loop_var) {}
+
+  /*! \brief The indirect loads, with the predicates of the blocks they are executed in. */
+  std::vector<std::pair<BufferLoad, PrimExpr>> loads;
+  /*! \brief The min of the loops nested in the body. */
+  Map<Var, PrimExpr> inner_loop_mins;
+
+ private:
+  void VisitStmt_(const ForNode* op) final {
+    inner_loop_mins.Set(op->loop_var, op->min);
+    StmtExprVisitor::VisitStmt_(op);
+  }
+
+  void VisitStmt_(const BlockRealizeNode* op) final {
+    PrimExpr outer = predicate_;
+    predicate_ = predicate_ && op->predicate;
+    StmtExprVisitor::VisitStmt_(op);
+    predicate_ = outer;
+  }
+
+  void VisitExpr_(const BufferLoadNode* op) final {
+    bool indirect = false;
+    for (const PrimExpr& index : op->indices) {
+      PostOrderVisit(index, [&](const ObjectRef& obj) {
+        if (const auto* load = obj.as<BufferLoadNode>()) {
+          indirect = indirect || UsesVar(GetRef<PrimExpr>(load), [this](const VarNode* var) {
+                       return var == loop_var_.get();
+                     });
+        }
+      });
+    }
+    if (indirect) {
+      BufferLoad load = GetRef<BufferLoad>(op);
+      for (const auto& it : loads) {
+        if (StructuralEqual()(it.first, load)) return;
+      }
+      loads.emplace_back(load, predicate_);
+      // The nested loads are read by the prefetch address anyway.
+      return;
+    }
+    StmtExprVisitor::VisitExpr_(op);
+  }
+
+  const Var& loop_var_;
+  PrimExpr predicate_ = Bool(true);
+};
+
+/*!
+ * \brief Prefix the body of the loops annotated with the prefetch distance k with the prefetch of
+ *  the rows their indirect loads read k iterations later. The addresses are the first element of
+ *  the rows, the loops nested in the body taken at their min, so the hardware prefetcher streams
+ *  the rest of the rows once they are touched.
+ */
+class SoftwarePrefetchInjector : public StmtMutator {
+ private:
+  Stmt VisitStmt_(const ForNode* op) final {
+    For loop = Downcast<For>(StmtMutator::VisitStmt_(op));
+    auto it = loop->annotations.find(attr::software_prefetch_distance);
+    if (it == loop->annotations.end()) return std::move(loop);
+    const auto* distance = (*it).second.as<IntImmNode>();
+    ICHECK(distance) << "ValueError: " << attr::software_prefetch_distance
+                     << " expects an integer, but got " << (*it).second;
+    IndirectLoadCollector collector(loop->loop_var);
+    collector(loop->body);
+
+    // The lookahead iteration, clamped to the last one.
+    Map<Var, PrimExpr> vmap = collector.inner_loop_mins;
+    vmap.Set(loop->loop_var,
+             min(loop->loop_var + make_const(loop->loop_var.dtype(), distance->value),
+                 loop->min + loop->extent - 1));
+    Array<Stmt> seq;
+    for (const auto& load_pred : collector.loads) {
+      PrimExpr load = Substitute(load_pred.first, vmap);
+      PrimExpr address = Call(DataType::Handle(), builtin::address_of(), {load});
+      Stmt prefetch = Evaluate(Call(load.dtype(), builtin::prefetch(), {address, 0, 3, 1}));
+      // The indices of the rows out of the predicates of the blocks may be out of bounds.
+      PrimExpr predicate = Substitute(load_pred.second, vmap);
+      seq.push_back(is_one(predicate) ? prefetch : IfThenElse(predicate, prefetch));
+    }
+    For::ContainerType* n = loop.CopyOnWrite();
+    n->annotations.erase(attr::software_prefetch_distance);
+    if (!seq.empty()) {
+      seq.push_back(n->body);
+      n->body = SeqStmt(seq);
+    }
+    return std::move(loop);
+  }
+};
+
+namespace transform {
+
+Pass InjectSoftwarePrefetch() {
+  auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
+    auto* n = f.CopyOnWrite();
+    n->body = SoftwarePrefetchInjector()(std::move(n->body));
+    return f;
+  };
+  return CreatePrimFuncPass(pass_func, 0, "tir.InjectSoftwarePrefetch", {});
+}
+
+TVM_REGISTER_GLOBAL("tir.transform.InjectSoftwarePrefetch").set_body_typed(InjectSoftwarePrefetch);
+
+}  // namespace transform
+
+}  // namespace tir
+}  // namespace tvm
@@ -27,6 +27,7 @@
 #include <tvm/arith/int_solver.h>
 #include <tvm/tir/stmt_functor.h>
 
+#include <cstdlib>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -318,6 +319,32 @@ Bool IsFromLegacyTESchedule(PrimFunc f) {
   return from_legacy_te_schedule.value();
 }
 
+bool TargetHasScalableVectors(const Target& target) {
+  if (!target.defined() || target->kind->name != "llvm") {
+    return false;
+  }
+  std::string triple = target->GetAttr<String>("mtriple").value_or("");
+  bool is_aarch64 = triple.compare(0, 7, "aarch64") == 0;
+  bool is_riscv = triple.compare(0, 5, "riscv") == 0;
+  for (const String& attr : target->GetAttr<Array<String>>("mattr").value_or(Array<String>())) {
+    if ((is_aarch64 && (attr == "+sve" || attr == "+sve2")) || (is_riscv && attr == "+v")) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TargetHasPTXAsyncCopy(const Target& target) {
+  if (!target.defined() || target->kind->name != "cuda") {
+    return false;
+  }
+  std::string arch = target->GetAttr<String>("arch").value_or("");
+  if (arch.compare(0, 3, "sm_") != 0) {
+    return false;
+  }
+  return std::atoi(arch.c_str() + 3) >= 80;
+}
+
 Map<Var, Range> ConditionalBoundsContext::GetVarBoundsFromCondition() {
   // extract equations and related vars from condition expression.
   // currently only extract simple integral equations which could be solvable.
@@ -27,6 +27,7 @@
 #include <tvm/arith/int_set.h>
 #include <tvm/runtime/device_api.h>
 #include <tvm/support/with.h>
+#include <tvm/target/target.h>
 #include <tvm/tir/builtin.h>
 #include <tvm/tir/expr.h>
 #include <tvm/tir/function.h>
@@ -233,6 +234,21 @@ Region ConvertRegion(const MatchBufferRegion& match_buffer, const Region& region
  */
 Bool IsFromLegacyTESchedule(PrimFunc f);
 
+/*!
+ * \brief Check if a target has scalable vectors, i.e. ARM SVE or RISC-V V, whose
+ *  vector length is only known at runtime.
+ * \param target The target to check.
+ * \return Whether the target has scalable vectors.
+ */
+bool TargetHasScalableVectors(const Target& target);
+
+/*!
+ * \brief Check if the target is a CUDA target with the PTX async copies, i.e. sm_80 or newer.
+ * \param target The target.
+ * \return Whether the async copies from global to shared memory are available.
+ */
+bool TargetHasPTXAsyncCopy(const Target& target);
+
 /*!
  *\brief Context helper to update domain map within conditional scope.
  *
@@ -317,6 +317,13 @@ class BuiltinLower : public StmtExprMutator {
       return make_zero(op->dtype);
     } else if (op->op.same_as(builtin::mem_copy())) {
       return MakeMemCopy(op);
+    } else if (op->op.same_as(builtin::anylist_setitem_call_packed())) {
+      return MakeAnyListSetItemCallPacked(op);
+    } else if (op->op.same_as(builtin::anylist_resetitem())) {
+      PrimExpr expr = StmtExprMutator::VisitExpr_(op);
+      op = expr.as<CallNode>();
+      return Call(op->dtype, builtin::call_extern(),
+                  {StringImm("TVMBackendAnyListResetItem"), op->args[0], op->args[1]});
     } else {
       return StmtExprMutator::VisitExpr_(op);
     }
@@ -424,6 +431,15 @@ class BuiltinLower : public StmtExprMutator {
     for (size_t i = 1; i < arg_count; ++i) {
       PrimExpr stack_index = ConstInt32(arg_stack_begin + i - 1);
       PrimExpr arg = op->args[i];
+      const auto* item = arg.as<CallNode>();
+      if (item != nullptr && item->op.same_as(builtin::anylist_getitem())) {
+        // The item sets both the value and the type code of the argument.
+        prep_seq.emplace_back(Evaluate(Call(DataType::Int(32), builtin::call_extern(),
+                                            {StringImm("TVMBackendAnyListSetPackedArg"),
+                                             item->args[0], item->args[1], scope.stack_value,
+                                             scope.stack_tcode->data, stack_index})));
+        continue;
+      }
       DataType t = arg.dtype();
       DataType api_type = APIType(t);
       if (t != api_type) {
@@ -469,6 +485,24 @@ class BuiltinLower : public StmtExprMutator {
     return Call(op->dtype, builtin_call, packed_args);
   }
 
+  // anylist_setitem_call_packed(list, index, name, args...)
+  PrimExpr MakeAnyListSetItemCallPacked(const CallNode* op) {
+    ICHECK_GE(op->args.size(), 3U);
+    PrimExpr list_handle = this->VisitExpr(op->args[0]);
+    PrimExpr list_index = this->VisitExpr(op->args[1]);
+    Array<PrimExpr> call_args(op->args.begin() + 2, op->args.end());
+    Call call_packed(DataType::Int(32), builtin::tvm_call_packed(), call_args);
+    PrimExpr lowered = MakeCallPacked(call_packed.get(), /* use_string_lookup */ true);
+    const auto* lowered_call = lowered.as<CallNode>();
+    ICHECK(lowered_call != nullptr);
+    // The return value is written to the slot after the arguments, move it into the item once
+    // the call is done.
+    prep_seq_stack_.back().emplace_back(Evaluate(lowered));
+    return Call(DataType::Int(32), builtin::call_extern(),
+                {StringImm("TVMBackendAnyListMoveFromPackedReturn"), list_handle, list_index,
+                 lowered_call->args[1], lowered_call->args[2], lowered_call->args[4]});
+  }
+
   PrimExpr MakeCallTracePacked(const CallNode* op) {
     ICHECK(!alloca_scope_.empty());
     auto& scope = alloca_scope_.back();
@@ -35,6 +35,8 @@
 #include <unordered_set>
 #include <vector>
 
+#include "ir_utils.h"
+
 namespace tvm {
 namespace tir {
 
@@ -658,11 +660,24 @@ class Vectorizer : public StmtMutator, public ExprFunctor<PrimExpr(const PrimExp
 
 class LoopVectorizer : public StmtMutator {
  public:
+  /*!
+   * \brief Constructor.
+   * \param symbolic_lanes The number of lanes of the loops with a symbolic extent, 0 to fit the
+   *  widest element accessed in the loop into a 128-bit vector.
+   * \param scalable_vectors Whether the target has scalable vectors, in which case the loops with
+   *  a symbolic extent are left to the backend to vectorize unless the lanes are given.
+   */
+  explicit LoopVectorizer(int symbolic_lanes = 0, bool scalable_vectors = false)
+      : symbolic_lanes_(symbolic_lanes), scalable_vectors_(scalable_vectors) {}
+
   Stmt VisitStmt_(const ForNode* op) final {
     if (op->kind == ForKind::kVectorized) {
       ICHECK(is_zero(op->min));
       auto* extent_as_int = op->extent.as<IntImmNode>();
-      if (!extent_as_int || extent_as_int->value < 1) {
+      if (!extent_as_int) {
+        return VectorizeSymbolicLoop(op);
+      }
+      if (extent_as_int->value < 1) {
         LOG(FATAL) << "Failed to vectorize loop with extent " << op->extent;
       }
       return Vectorizer(op->loop_var, static_cast<int>(extent_as_int->value))(op->body);
@@ -670,6 +685,61 @@ class LoopVectorizer : public StmtMutator {
       return StmtMutator::VisitStmt_(op);
     }
   }
+
+ private:
+  /*!
+   * \brief Vectorize a loop with a symbolic extent by lanes iterations at a time, and run the
+   *  remaining iterations in a scalar epilogue.
+   *
+   *  The loads and stores of TIR carry no predicate, so the tail is not masked even on the
+   *  targets which support masked vector accesses. On the targets with scalable vectors, the
+   *  loop is instead marked for the backend to vectorize with predicated scalable vectors.
+   */
+  Stmt VectorizeSymbolicLoop(const ForNode* op) {
+    if (scalable_vectors_ && symbolic_lanes_ == 0) {
+      // The vector-length-agnostic loop of the backend needs no tail.
+      Stmt loop = For(op->loop_var, op->min, op->extent, ForKind::kSerial,
+                      this->VisitStmt(op->body));
+      return AttrStmt(op->loop_var, attr::pragma_scalable_vectorize, Integer(1), loop);
+    }
+    int lanes = symbolic_lanes_ > 0 ? symbolic_lanes_ : DefaultLanes(op->body);
+    DataType dtype = op->loop_var->dtype;
+    if (lanes <= 1) {
+      return For(op->loop_var, op->min, op->extent, ForKind::kSerial, this->VisitStmt(op->body));
+    }
+    PrimExpr num_lanes = make_const(dtype, lanes);
+    PrimExpr main_extent = floordiv(op->extent, num_lanes);
+    Var outer = op->loop_var.copy_with_suffix(".outer");
+    Var inner = op->loop_var.copy_with_suffix(".inner");
+    Stmt main_body = Substitute(op->body, {{op->loop_var, outer * num_lanes + inner}});
+    Stmt main = For(outer, make_zero(dtype), main_extent, ForKind::kSerial,
+                    Vectorizer(inner, lanes)(main_body));
+    Var tail_var = op->loop_var.copy_with_suffix(".tail");
+    PrimExpr tail_min = main_extent * num_lanes;
+    // The code generators expect the loops to start from zero.
+    Stmt tail_body = this->VisitStmt(Substitute(op->body, {{op->loop_var, tail_min + tail_var}}));
+    Stmt tail =
+        For(tail_var, make_zero(dtype), op->extent - tail_min, ForKind::kSerial, tail_body);
+    return SeqStmt({main, tail});
+  }
+
+  /*! \brief The number of lanes fitting the widest element accessed in a 128-bit vector. */
+  static int DefaultLanes(const Stmt& body) {
+    int max_bits = 0;
+    PostOrderVisit(body, [&max_bits](const ObjectRef& node) {
+      if (const auto* load = node.as<BufferLoadNode>()) {
+        max_bits = std::max(max_bits, load->dtype.bits());
+      } else if (const auto* store = node.as<BufferStoreNode>()) {
+        max_bits = std::max(max_bits, store->value->dtype.bits());
+      }
+    });
+    return max_bits == 0 ? 1 : std::max(1, 128 / max_bits);
+  }
+
+  /*! \brief The number of lanes of the loops with a symbolic extent, 0 for the default. */
+  int symbolic_lanes_;
+  /*! \brief Whether the target has scalable vectors. */
+  bool scalable_vectors_;
 };
 
 Stmt VectorizeLoop(Stmt stmt) { return LoopVectorizer()(std::move(stmt)); }
@@ -691,12 +761,18 @@ Stmt SkipVectorize(Stmt stmt) { return VectorizeSkipper()(std::move(stmt)); }
 
 namespace transform {
 
+TVM_REGISTER_PASS_CONFIG_OPTION("tir.vectorize_symbolic_lanes", Integer);
+
 // TODO(tvm-team): Make it as a target property.
 Pass VectorizeLoop(bool enable_vectorize) {
   auto pass_func = [=](PrimFunc f, IRModule m, PassContext ctx) {
     auto* n = f.CopyOnWrite();
     if (enable_vectorize) {
-      n->body = LoopVectorizer()(std::move(n->body));
+      int symbolic_lanes =
+          ctx->GetConfig<Integer>("tir.vectorize_symbolic_lanes", Integer(0)).value()->value;
+      Target target = f->GetAttr<Target>(tvm::attr::kTarget).value_or(Target::Current(true));
+      bool scalable_vectors = TargetHasScalableVectors(target);
+      n->body = LoopVectorizer(symbolic_lanes, scalable_vectors)(std::move(n->body));
     } else {
       n->body = VectorizeSkipper()(std::move(n->body));
     }
@@ -0,0 +1,68 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include "../../../src/runtime/relax_vm/latency_histogram.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+namespace {
+
+TEST(LatencyHistogram, Buckets) {
+  using H = LatencyHistogram;
+  // The small latencies have a bucket each.
+  for (int64_t nanos = 0; nanos < H::kNumSubBuckets; ++nanos) {
+    EXPECT_EQ(H::BucketOf(nanos), nanos);
+  }
+  // Every bucket counts the latencies from its lower bound to the next one.
+  for (int64_t bucket = 0; bucket < H::kNumBuckets - 1; ++bucket) {
+    int64_t lower = H::LowerBound(bucket);
+    int64_t next = H::LowerBound(bucket + 1);
+    ASSERT_LT(lower, next);
+    EXPECT_EQ(H::BucketOf(lower), bucket);
+    EXPECT_EQ(H::BucketOf(next - 1), bucket);
+    // The width of a bucket is within 1 / kNumSubBuckets of its latencies.
+    EXPECT_LE((next - lower) * H::kNumSubBuckets, std::max<int64_t>(lower, H::kNumSubBuckets));
+  }
+  EXPECT_EQ(H::BucketOf(int64_t(1) << 50), H::kNumBuckets - 1);
+}
+
+TEST(LatencyHistogram, Percentiles) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 99; ++i) {
+    histogram.Record(1000);
+  }
+  histogram.Record(1000000);
+  EXPECT_EQ(histogram.Count(), 100);
+  std::string json = histogram.AsJSON();
+  EXPECT_NE(json.find("\"count\": 100"), std::string::npos);
+  EXPECT_NE(json.find("\"p50_us\": 1.024"), std::string::npos);
+  EXPECT_NE(json.find("\"max_us\": 1015.808"), std::string::npos);
+}
+
+}  // namespace
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,86 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/container/shape_tuple.h>
+#include <tvm/runtime/container/string.h>
+#include <tvm/runtime/memory.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+class PooledTestObj : public Object {
+ public:
+  explicit PooledTestObj(int* num_alive) : num_alive(num_alive) { ++*num_alive; }
+  ~PooledTestObj() { --*num_alive; }
+
+  int* num_alive;
+
+  static constexpr const uint32_t _type_index = TypeIndex::kDynamic;
+  static constexpr const char* _type_key = "test.PooledTestObj";
+  TVM_DECLARE_FINAL_OBJECT_INFO(PooledTestObj, Object);
+};
+
+TVM_REGISTER_OBJECT_TYPE(PooledTestObj);
+
+TEST(ObjectPool, RecycleBlocks) {
+  // Run on a new thread, so that its object pool starts empty.
+  std::thread([]() {
+    int num_alive = 0;
+    const Object* first;
+    {
+      ObjectPtr<PooledTestObj> obj = make_pooled_object<PooledTestObj>(&num_alive);
+      EXPECT_EQ(num_alive, 1);
+      EXPECT_TRUE(obj->IsInstance<PooledTestObj>());
+      first = obj.get();
+    }
+    EXPECT_EQ(num_alive, 0);
+    // The freed block is the first one of its size class to be reused.
+    ObjectPtr<PooledTestObj> obj = make_pooled_object<PooledTestObj>(&num_alive);
+    EXPECT_EQ(obj.get(), first);
+    // A block freed on another thread joins the pool of that thread, released as it exits.
+    std::thread([&obj]() { obj.reset(); }).join();
+    EXPECT_EQ(num_alive, 0);
+  }).join();
+}
+
+TEST(ObjectPool, PooledContainers) {
+  std::vector<int64_t> dims = {2, 3, 5};
+  ShapeTuple shape = ShapeTuple::Pooled(dims.begin(), dims.end());
+  EXPECT_EQ(shape.size(), 3U);
+  EXPECT_TRUE(std::equal(shape.begin(), shape.end(), dims.begin()));
+  EXPECT_TRUE(ShapeTuple::Pooled(dims.begin(), dims.begin()).empty());
+
+  std::vector<ObjectRef> fields = {shape, String("field")};
+  ADT tuple = ADT::PooledTuple(fields.begin(), fields.end());
+  EXPECT_EQ(tuple.tag(), 0);
+  EXPECT_EQ(tuple.size(), 2U);
+  EXPECT_TRUE(tuple[0].same_as(shape));
+  EXPECT_EQ(Downcast<String>(tuple[1]), "field");
+}
+
+}  // namespace
+}  // namespace runtime
+}  // namespace tvm
@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/relax_vm/memory_manager.h>
+
+#include <thread>
+#include <vector>
+
+#include "../../../src/runtime/relax_vm/pooled_allocator.h"
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+namespace {
+
+TEST(RelaxVMMemoryManager, ConcurrentLookup) {
+  Device dev{kDLCPU, 0};
+  Allocator* alloc = MemoryManager::GetOrCreateAllocator(dev, kPooled);
+  std::vector<std::thread> threads;
+  std::vector<Allocator*> found(8, nullptr);
+  for (size_t i = 0; i < found.size(); ++i) {
+    threads.emplace_back([&found, dev, i]() {
+      for (int iter = 0; iter < 1000; ++iter) found[i] = MemoryManager::GetAllocator(dev);
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (Allocator* result : found) EXPECT_EQ(result, alloc);
+}
+
+TEST(RelaxVMMemoryManager, StorageFreesThroughItsAllocator) {
+  Device dev{kDLCPU, 0};
+  Allocator* alloc = MemoryManager::GetOrCreateAllocator(dev, kPooled);
+  size_t live_bytes = alloc->Stats().live_bytes;
+  {
+    auto storage_obj = make_object<StorageObj>();
+    storage_obj->allocator = alloc;
+    storage_obj->buffer = alloc->Alloc(256, 64, DLDataType{kDLFloat, 32, 1});
+    Storage storage(storage_obj);
+    EXPECT_GT(alloc->Stats().live_bytes, live_bytes);
+  }
+  EXPECT_EQ(alloc->Stats().live_bytes, live_bytes);
+}
+
+TEST(RelaxVMPooledAllocator, ThreadCaches) {
+  PooledAllocator alloc(Device{kDLCPU, 0});
+  DLDataType dtype{kDLFloat, 32, 1};
+  Buffer first = alloc.Alloc(4096, 64, dtype);
+  alloc.Free(first);
+  // The block freed by the thread is reused from its cache.
+  Buffer second = alloc.Alloc(4096, 64, dtype);
+  EXPECT_EQ(second.data, first.data);
+  // A block freed by a thread exiting goes back to the shared pool for the other threads.
+  std::thread([&alloc, second]() { alloc.Free(second); }).join();
+  Buffer third = alloc.Alloc(4096, 64, dtype);
+  EXPECT_EQ(third.data, first.data);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&alloc, dtype]() {
+      for (size_t iter = 0; iter < 2 * PooledAllocator::kRebalancePeriod; ++iter) {
+        alloc.Free(alloc.Alloc(8192, 64, dtype));
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  alloc.Free(third);
+  AllocatorStats stats = alloc.Stats();
+  EXPECT_EQ(stats.live_bytes, 0U);
+  EXPECT_EQ(stats.num_allocs, 3U + 4 * 2 * PooledAllocator::kRebalancePeriod);
+  // Every thread allocates from the device once at most.
+  EXPECT_GE(stats.num_cache_hits, stats.num_allocs - 5);
+}
+
+}  // namespace
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
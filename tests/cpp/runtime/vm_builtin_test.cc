@@ -0,0 +1,66 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/container/adt.h>
+#include <tvm/runtime/registry.h>
+#include <tvm/runtime/relax_vm/vm.h>
+
+#include <vector>
+
+namespace tvm {
+namespace runtime {
+namespace relax_vm {
+namespace {
+
+RegType CallBuiltin(const std::string& name, const std::vector<RegType>& args) {
+  VMBuiltin builtin = GetVMBuiltin(name);
+  EXPECT_NE(builtin, nullptr) << name;
+  std::vector<const RegType*> arg_ptrs;
+  for (const RegType& arg : args) arg_ptrs.push_back(&arg);
+  RegType rv;
+  builtin(VMBuiltinArgs(arg_ptrs.data(), static_cast<int>(arg_ptrs.size())), &rv);
+  return rv;
+}
+
+TEST(VMBuiltin, DirectCallMatchesPackedFunc) {
+  std::vector<RegType> args(2);
+  args[0] = NDArray::Empty({2, 3}, DataType::Float(32), Device{kDLCPU, 0});
+  ShapeTuple shape = CallBuiltin("vm.builtin.shape_of", {args[0]}).AsObjectRef<ShapeTuple>();
+  ShapeTuple expected = (*Registry::Get("vm.builtin.shape_of"))(args[0].operator NDArray());
+  EXPECT_TRUE(shape.same_as(expected));
+
+  args[1] = shape;
+  ADT tuple = CallBuiltin("runtime.Tuple", args).AsObjectRef<ADT>();
+  ASSERT_EQ(tuple.size(), 2U);
+  EXPECT_TRUE(tuple[1].same_as(shape));
+
+  std::vector<RegType> get_item(2);
+  get_item[0] = tuple;
+  get_item[1] = ShapeTuple({1});
+  EXPECT_TRUE(CallBuiltin("vm.runtime.TupleGetItem", get_item).AsObjectRef<ObjectRef>().same_as(
+      shape));
+  // The builtins without a direct entry keep going through their PackedFunc.
+  EXPECT_EQ(GetVMBuiltin("vm.builtin.invoke_closure"), nullptr);
+}
+
+}  // namespace
+}  // namespace relax_vm
+}  // namespace runtime
+}  // namespace tvm
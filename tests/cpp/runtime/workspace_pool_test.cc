@@ -0,0 +1,67 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "../../../src/runtime/workspace_pool.h"
+
+#include <gtest/gtest.h>
+#include <tvm/runtime/c_backend_api.h>
+
+#include <thread>
+
+namespace tvm {
+namespace runtime {
+namespace {
+
+TEST(WorkspacePool, ArenaBumpAllocation) {
+  // Run on a new thread, so that its workspace pool starts empty.
+  std::thread([]() {
+    WorkspacePool::Stats* stats = WorkspacePool::GetStats(Device{kDLCPU, 0});
+    int64_t num_arena_allocs = stats->num_arena_allocs;
+    {
+      WorkspacePool::ArenaScope scope;
+      char* a = static_cast<char*>(TVMBackendAllocWorkspace(kDLCPU, 0, 100, 2, 8));
+      char* b = static_cast<char*>(TVMBackendAllocWorkspace(kDLCPU, 0, 300, 2, 8));
+      EXPECT_EQ(b - a, kTempAllocaAlignment);
+      // The bump pointer is rewound over the released top.
+      EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, b), 0);
+      char* c = static_cast<char*>(TVMBackendAllocWorkspace(kDLCPU, 0, 200, 2, 8));
+      EXPECT_EQ(c, b);
+      // Growing the arena with a new chunk, which is compacted once the arena is empty.
+      char* d = static_cast<char*>(TVMBackendAllocWorkspace(kDLCPU, 0, 1 << 20, 2, 8));
+      d[(1 << 20) - 1] = 0;
+      EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, a), 0);
+      EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, d), 0);
+      EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, c), 0);
+      char* e = static_cast<char*>(TVMBackendAllocWorkspace(kDLCPU, 0, 1 << 20, 2, 8));
+      char* f = static_cast<char*>(TVMBackendAllocWorkspace(kDLCPU, 0, 4096, 2, 8));
+      EXPECT_EQ(f - e, 1 << 20);
+      EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, f), 0);
+      EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, e), 0);
+    }
+    // The free list serves the allocations out of the arena scopes.
+    void* g = TVMBackendAllocWorkspace(kDLCPU, 0, 100, 2, 8);
+    EXPECT_EQ(TVMBackendFreeWorkspace(kDLCPU, 0, g), 0);
+    EXPECT_EQ(stats->num_arena_allocs - num_arena_allocs, 6);
+    EXPECT_LE(stats->peak_bytes_in_use.load(), stats->peak_bytes_reserved.load());
+  }).join();
+}
+
+}  // namespace
+}  // namespace runtime
+}  // namespace tvm
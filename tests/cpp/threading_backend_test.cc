@@ -20,16 +20,22 @@
 #include <dmlc/logging.h>
 #include <gtest/gtest.h>
 #include <tvm/runtime/c_backend_api.h>
+#include <tvm/runtime/device_api.h>
 #include <tvm/runtime/threading_backend.h>
 
 #include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <thread>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 constexpr size_t N = 128;
+constexpr int kNumTask = 37;
 void AtomicCompute(int task_id, size_t n, std::atomic<size_t>* acc, TVMParallelGroupEnv* penv) {
   const size_t N_per_task = (n + penv->num_task - 1) / penv->num_task;
   for (size_t i = task_id * N_per_task; i < n && i < (task_id + 1) * N_per_task; ++i) {
@@ -146,6 +152,86 @@ TEST(ThreadingBackend, TVMBackendParallelLaunchMultipleThreads) {
   }
 }
 
+TEST(ThreadingBackend, TVMBackendParallelLaunchWorkStealing) {
+  using tvm::runtime::threading::TaskScheduleMode;
+  tvm::runtime::threading::ConfigureTaskSchedule(TaskScheduleMode::kWorkStealing, 4);
+  std::atomic<size_t> acc(0);
+  TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  if (tvm::runtime::threading::MaxConcurrency() <= 1) {
+    // The tasks run inline as one task when there is only one CPU available.
+    tvm::runtime::threading::ConfigureTaskSchedule(TaskScheduleMode::kStatic, 4);
+    return;
+  }
+  // Imbalanced tasks, more than the workers: each of them runs exactly once
+  std::vector<std::atomic<int>> num_runs(kNumTask);
+  for (std::atomic<int>& n : num_runs) {
+    n.store(0);
+  }
+  static FTVMParallelLambda count_task_id = [](int task_id, TVMParallelGroupEnv* penv,
+                                               void* cdata) -> int {
+    EXPECT_EQ(penv->num_task, kNumTask);
+    if (task_id % 8 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    reinterpret_cast<std::atomic<int>*>(cdata)[task_id].fetch_add(1);
+    return 0;
+  };
+  for (int i = 0; i < 3; ++i) {
+    TVMBackendParallelLaunch(count_task_id, num_runs.data(), kNumTask);
+  }
+  for (const std::atomic<int>& n : num_runs) {
+    EXPECT_EQ(n.load(), 3);
+  }
+  tvm::runtime::threading::ConfigureTaskSchedule(TaskScheduleMode::kStatic, 4);
+}
+
+TEST(ThreadingBackend, TVMBackendParallelLaunchPersistentRegion) {
+  tvm::runtime::threading::ConfigurePersistentRegion(1 << 16);
+  {
+    tvm::runtime::threading::PersistentRegionScope region;
+    for (int i = 0; i < 16; ++i) {
+      // Nested regions end with the outermost one
+      tvm::runtime::threading::PersistentRegionScope nested(i % 2 == 0);
+      std::atomic<size_t> acc(0);
+      TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+      EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+    }
+  }
+  // The workers go back to sleep after the region
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  std::atomic<size_t> acc(0);
+  TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+}
+
+TEST(ThreadingBackend, TVMBackendNumaNodesConfigure) {
+#if defined(__linux__)
+  if (std::ifstream("/sys/devices/system/node/node0/cpulist").fail()) {
+    return;
+  }
+  std::vector<unsigned int> cpus = tvm::runtime::threading::NumaNodeCpus({0});
+  ASSERT_FALSE(cpus.empty());
+  tvm::runtime::threading::Configure(tvm::runtime::threading::ThreadGroup::kSpecifyNumaNodes, 0,
+                                     {0});
+  EXPECT_EQ(tvm::runtime::threading::GetMemoryNumaNodes(), std::vector<unsigned int>{0});
+  EXPECT_EQ(tvm::runtime::threading::MaxConcurrency(), static_cast<int>(cpus.size()));
+  std::atomic<size_t> acc(0);
+  TVMBackendParallelLaunch(atomic_add_task_id, &acc, 0);
+  EXPECT_EQ(acc.load(std::memory_order_relaxed), N * (N - 1) / 2);
+  // The allocations large enough are bound to the node
+  DLDevice dev{kDLCPU, 0};
+  for (size_t nbytes : {size_t(1024), size_t(1 << 20)}) {
+    void* ptr = tvm::runtime::DeviceAPI::Get(dev)->AllocDataSpace(dev, nbytes, 64, {});
+    ASSERT_NE(ptr, nullptr);
+    std::memset(ptr, 0, nbytes);
+    tvm::runtime::DeviceAPI::Get(dev)->FreeDataSpace(dev, ptr);
+  }
+  tvm::runtime::threading::Configure(tvm::runtime::threading::ThreadGroup::kBig, 0, {});
+  EXPECT_TRUE(tvm::runtime::threading::GetMemoryNumaNodes().empty());
+#endif
+}
+
 TEST(ThreadingBackend, TVMBackendAffinityConfigure) {
   int max_concurrency = tvm::runtime::threading::MaxConcurrency();
   std::vector<std::unique_ptr<std::thread>> ts;
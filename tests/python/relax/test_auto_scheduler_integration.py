@@ -0,0 +1,101 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tempfile
+
+import numpy as np
+import pytest
+import tvm
+import tvm.testing
+from tvm import auto_scheduler, relax, te, topi
+from tvm.auto_scheduler import relax_integration
+from tvm.auto_scheduler.relay_integration import traverse_to_get_io_tensors
+
+
+def build_dense_add():
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [16, 32], relax.DynTensorType(2, "float32"))
+    w = relax.Var("w", [64, 32], relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x, w]):
+        with bb.dataflow():
+            dense = bb.emit_te(topi.nn.dense, x, w)
+            out = bb.emit_output(bb.emit_te(topi.add, dense, dense))
+        bb.emit_func_output(out)
+    return bb.get()
+
+
+def relay_workload_key(compute):
+    """The workload key the relay integration records for the compute."""
+    io_tensors, _, _ = traverse_to_get_io_tensors(compute)
+    return auto_scheduler.ComputeDAG(io_tensors).workload_key()
+
+
+def test_prim_func_to_te():
+    mod = build_dense_add()
+    A = te.placeholder((16, 32), name="placeholder")
+    B = te.placeholder((64, 32), name="placeholder")
+    args = relax_integration.prim_func_to_te(mod["dense"])
+    assert [tuple(arg.shape) for arg in args] == [(16, 32), (64, 32), (16, 64)]
+    assert relay_workload_key(args[-1:]) == relay_workload_key([topi.nn.dense(A, B)])
+
+    # the kernels of dynamic shape have no workload
+    bb = relax.BlockBuilder()
+    n = tvm.tir.Var("n", "int64")
+    x = relax.Var("x", [n, 32], relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x]):
+        out = bb.emit_te(topi.nn.relu, x)
+        bb.emit_func_output(out)
+    assert relax_integration.prim_func_to_te(bb.get()["relu"]) is None
+
+
+def test_extract_tasks():
+    mod = build_dense_add()
+    tasks, weights = relax_integration.extract_tasks(mod, "llvm")
+    assert len(tasks) == 1 and weights == [1]
+    assert tasks[0].desc == "dense"
+
+    tasks, weights = relax_integration.extract_tasks(mod, "llvm", include_simple_tasks=True)
+    assert sorted(task.desc for task in tasks) == ["add", "dense"]
+
+
+def test_apply_history_best():
+    mod = build_dense_add()
+    target = tvm.target.Target("llvm")
+    (task,), _ = relax_integration.extract_tasks(mod, target)
+    state = task.compute_dag.get_init_state()
+    dense_op = state.stage_ops[-1]
+    state.split(dense_op, state[dense_op].iters[0], [4])
+
+    with tempfile.NamedTemporaryFile() as log_file:
+        inp = auto_scheduler.MeasureInput(task, state)
+        res = auto_scheduler.MeasureResult([0.1], 0, "", 0.2, 1)
+        auto_scheduler.save_records(log_file.name, [inp], [res])
+        scheduled = relax.transform.AutoSchedulerApplyHistoryBest(log_file.name, target)(mod)
+
+    # the kernel with a record is lowered with its schedule, the other kernels are kept
+    assert scheduled["dense"].attrs["from_legacy_te_schedule"]
+    assert scheduled["add"].same_as(mod["add"])
+
+    ex = relax.vm.build(scheduled, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    x = np.random.rand(16, 32).astype("float32")
+    w = np.random.rand(64, 32).astype("float32")
+    out = vm["main"](tvm.nd.array(x), tvm.nd.array(w))
+    tvm.testing.assert_allclose(out.numpy(), 2 * x @ w.T, rtol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -227,6 +227,81 @@ def test_meta_schedule_extract_task_from_relax():
         assert task.task_name in expected_weights
         assert expected_weights[task.task_name] == task.weight
 
+    # With a profile, the weights are the profiled calls, e.g. of a loop running add2 ten times.
+    duration = tvm.runtime.profiling.Duration(1.0)
+    calls = [{"Name": "add1", "Duration (us)": duration}] * 4
+    calls += [{"Name": "add3", "Duration (us)": duration}] * 2
+    calls += [{"Name": "add2", "Duration (us)": duration}] * 10
+    profile = tvm.runtime.profiling.Report(calls, {}, {})
+    tasks = ms.relax_integration.extract_task_from_relax(
+        Module, Target("llvm --num-cores=16"), profile=profile
+    )
+    expected_weights = {"add1": 6, "add2": 10, "multiply1": 1}
+    assert len(tasks) == len(expected_weights)
+    for task in tasks:
+        assert expected_weights[task.task_name] == task.weight
+
+
+def test_meta_schedule_specialize_symbolic_tasks():
+    @T.prim_func
+    def add(a: T.handle, b: T.handle) -> None:
+        n = T.var("int32")
+        A = T.match_buffer(a, (n, 128), "float32")
+        B = T.match_buffer(b, (n, 128), "float32")
+        for i, j in T.grid(n, 128):
+            with T.block("add"):
+                vi, vj = T.axis.remap("SS", [i, j])
+                B[vi, vj] = A[vi, vj] + 1.0
+
+    mod = tvm.IRModule({"add": add})
+    target = Target("llvm --num-cores=16")
+    task = ms.ExtractedTask("add", mod, target, [mod], 10)
+    assert task.symbolic_vars() == ["n"]
+    distribution = [({"n": 16}, 3.0), ({"n": 256}, 1.0)]
+    tasks, groups = ms.tune.specialize_symbolic_tasks([task], distribution)
+    assert [t.task_name for t in tasks] == ["add_n16", "add_n256"]
+    assert [t.weight for t in tasks] == [8, 2]
+    assert not tasks[0].symbolic_vars()
+    func = tasks[1].dispatched[0]["add"]
+    assert [int(d) for d in func.buffer_map[func.params[0]].shape] == [256, 128]
+    assert len(groups) == 1 and groups[0][0].same_as(task)
+
+
+def test_meta_schedule_query_tuned_tasks():
+    @T.prim_func
+    def add(A: T.Buffer[(128, 128), "float32"], B: T.Buffer[(128, 128), "float32"]):
+        for i, j in T.grid(128, 128):
+            with T.block("add"):
+                vi, vj = T.axis.remap("SS", [i, j])
+                B[vi, vj] = A[vi, vj] + 1.0
+
+    @T.prim_func
+    def multiply(A: T.Buffer[(128, 128), "float32"], B: T.Buffer[(128, 128), "float32"]):
+        for i, j in T.grid(128, 128):
+            with T.block("multiply"):
+                vi, vj = T.axis.remap("SS", [i, j])
+                B[vi, vj] = A[vi, vj] * 2.0
+
+    target = Target("llvm --num-cores=16")
+    add_mod = tvm.IRModule({"main": add})
+    multiply_mod = tvm.IRModule({"main": multiply})
+    tasks = [
+        ms.ExtractedTask("add", add_mod, target, [add_mod], 3),
+        ms.ExtractedTask("multiply", multiply_mod, target, [multiply_mod], 1),
+    ]
+    with tempfile.TemporaryDirectory() as work_dir:
+        database = ms.default_config.database(None, work_dir)
+        sch = tvm.tir.Schedule(add_mod)
+        workload = database.commit_workload(add_mod)
+        database.commit_tuning_record(
+            ms.database.TuningRecord(sch.trace, workload, [1.0], target, None)
+        )
+        tuned = ms.tune.query_tuned_tasks(tasks, database)
+        assert [t.task_name for t in tuned.hits] == ["add"]
+        assert [t.task_name for t in tuned.misses] == ["multiply"]
+        assert tuned.hit_rate == 0.5
+        assert tuned.weighted_hit_rate == 0.75
+
 
 if __name__ == "__main__":
     pytest.main([__file__])
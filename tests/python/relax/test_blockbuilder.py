@@ -249,6 +249,11 @@ def test_binary_shape_type_deduction():
             assert isinstance(lv3.checked_type, rx.DynTensorType)
             assert lv3.checked_type.ndim == 1
             assert lv3.checked_type.dtype == "float16"
+
+            # operands of the same shape do not need another runtime shape inference
+            lv4 = bb.emit(rx.op.add(lv3, lv3))
+            assert lv4.shape.same_as(lv3.shape)
+            assert lv4.checked_type.ndim == 1
             gv0 = bb.emit_output(lv3)
         bb.emit_func_output(gv0)
         assert isinstance(gv0.shape, rx.Call)
@@ -318,6 +323,19 @@ def test_normalize():
     assert add_call.shape[1] == n
 
 
+def test_normalize_normalized():
+    m = tir.Var("m", "int32")
+    n = tir.Var("n", "int32")
+    x = rx.Var("x", [m, n], rx.DynTensorType(ndim=2, dtype="float16"))
+    bb = rx.BlockBuilder()
+
+    add_call = bb.normalize(rx.op.add(x, x))
+    # An already normalized expression is returned as it is.
+    assert bb.normalize(add_call).same_as(add_call)
+    tuple_get_item = bb.normalize(rx.TupleGetItem(rx.Tuple([x, x]), 0))
+    assert bb.normalize(tuple_get_item).same_as(tuple_get_item)
+
+
 def test_call_te():
     bb = rx.BlockBuilder()
     dtype = rx.DynTensorType(ndim=2, dtype="float32")
@@ -434,6 +452,47 @@ def test_emit_te_multiple():
     assert rx_func.body.blocks[0].bindings[2].value.args[0].name_hint == "te_func1"
 
 
+def test_emit_te_deferred_lowering():
+    def build(defer_te_lowering):
+        bb = rx.BlockBuilder(defer_te_lowering=defer_te_lowering)
+        n, m = tir.Var("n", "int64"), tir.Var("m", "int64")
+        type_anno = rx.DynTensorType(2, "float32")
+        x = rx.Var("x", [n, m], type_anno)
+        y = rx.Var("y", [n, m], type_anno)
+        z = rx.Var("z", [128, 128], type_anno)
+
+        def te_func(A):
+            return te.compute(A.shape, lambda i, j: A[i, j] + 1)
+
+        with bb.function("rx_func", [x, y, z]):
+            with bb.dataflow():
+                x1 = bb.emit_te(te_func, x)
+                y1 = bb.emit_te(te_func, y)
+                z1 = bb.emit_te(te_func, z)
+                add = bb.emit_te(topi.add, x1, y1, primfunc_name_hint="add")
+                gv = bb.emit_output(bb.emit_te(topi.sum, z1))
+            bb.emit_func_output([add, gv])
+        return bb.get()
+
+    mod = build(defer_te_lowering=True)
+    assert_structural_equal(mod, build(defer_te_lowering=False))
+    # the identical computes are lowered to one PrimFunc
+    assert sorted(gv.name_hint for gv in mod.get_global_vars()) == [
+        "add",
+        "rx_func",
+        "sum",
+        "te_func",
+        "te_func1",
+    ]
+    bindings = mod["rx_func"].body.blocks[0].bindings
+    assert [binding.value.args[0].name_hint for binding in bindings[:3]] == [
+        "te_func",
+        "te_func",
+        "te_func1",
+    ]
+    assert bindings[0].value.args[0].same_as(mod.get_global_var("te_func"))
+
+
 def test_emit_te_multiple_output():
     bb = rx.BlockBuilder()
     n, m = tir.Var("n", "int64"), tir.Var("m", "int64")
@@ -0,0 +1,104 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+from __future__ import annotations
+import pytest
+import numpy as np
+import tvm
+import tvm.testing
+from tvm import relax, transform
+from tvm.relax.backend.contrib.cublas import partition_for_cublas
+from tvm.script import relax as R
+
+has_cublas = pytest.mark.skipif(
+    not tvm.get_global_func("relax.ext.cublas", True)
+    or not tvm.get_global_func("runtime.CublasJSONRuntimeCreate", True),
+    reason="cuBLAS codegen or runtime not available",
+)
+
+pytestmark = [has_cublas]
+
+
+@tvm.script.ir_module
+class MatmulBiasRelu:
+    @R.function
+    def main(
+        x: Tensor((m, 16), "float32"), w: Tensor((16, 32), "float32"), b: Tensor((32,), "float32")
+    ) -> Tensor:
+        with R.dataflow():
+            lv0 = relax.matmul(x, w)
+            lv1 = relax.add(lv0, b)
+            gv = relax.nn.relu(lv1)
+            R.output(gv)
+        return gv
+
+
+@tvm.script.ir_module
+class BatchMatmul:
+    @R.function
+    def main(x: Tensor((4, 8, 16), "float32"), w: Tensor((4, 16, 32), "float32")) -> Tensor:
+        with R.dataflow():
+            gv = relax.matmul(x, w)
+            R.output(gv)
+        return gv
+
+
+def build_and_run(mod, inputs):
+    seq = transform.Sequential(
+        [relax.transform.RunCodegen(), relax.transform.RemoveUnusedFunctions()]
+    )
+    mod = seq(partition_for_cublas(mod))
+    assert len(mod.attrs["external_mods"]) == 1
+
+    target = tvm.target.Target("cuda", host="llvm")
+    with transform.PassContext(opt_level=0):
+        ex = relax.vm.build(mod, target)
+    dev = tvm.cuda(0)
+    vm = relax.VirtualMachine(ex, dev)
+    return vm["main"](*[tvm.nd.array(data, dev) for data in inputs]).numpy()
+
+
+def test_partition_epilogue():
+    mod = partition_for_cublas(MatmulBiasRelu)
+    composites = [
+        func.body.op.attrs["Composite"]
+        for func in mod.functions.values()
+        if func.attrs is not None and "Codegen" in func.attrs
+    ]
+    assert composites == ["cublas.matmul_bias_relu"]
+
+
+@tvm.testing.requires_cuda
+def test_matmul_bias_relu_dynamic_m():
+    w = np.random.randn(16, 32).astype("float32")
+    b = np.random.randn(32).astype("float32")
+    for m in [1, 7, 64]:
+        x = np.random.randn(m, 16).astype("float32")
+        out = build_and_run(MatmulBiasRelu, [x, w, b])
+        tvm.testing.assert_allclose(out, np.maximum(x @ w + b, 0), rtol=1e-4, atol=1e-4)
+
+
+@tvm.testing.requires_cuda
+def test_batch_matmul():
+    x = np.random.randn(4, 8, 16).astype("float32")
+    w = np.random.randn(4, 16, 32).astype("float32")
+    out = build_and_run(BatchMatmul, [x, w])
+    tvm.testing.assert_allclose(out, x @ w, rtol=1e-4, atol=1e-4)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,76 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+from __future__ import annotations
+import pytest
+import numpy as np
+import tvm
+import tvm.testing
+from tvm import relax, transform
+from tvm.relax.dpl import is_op, wildcard
+from tvm.script import relax as R
+
+has_dnnl = pytest.mark.skipif(
+    not tvm.get_global_func("relax.ext.dnnl", True)
+    or not tvm.get_global_func("runtime.DNNLJSONRuntimeCreate", True),
+    reason="DNNL codegen or runtime not available",
+)
+
+pytestmark = [has_dnnl]
+
+
+@tvm.script.ir_module
+class AddMul:
+    @R.function
+    def main(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+        with R.dataflow():
+            lv0 = relax.add(x, y)
+            lv1 = relax.multiply(lv0, y)
+            gv = relax.add(lv1, x)
+            R.output(gv)
+        return gv
+
+
+def test_offload_patterns():
+    add = is_op("relax.add")(wildcard(), wildcard())
+    patterns = [
+        ("relax.add_multiply", is_op("relax.multiply")(add, wildcard())),
+        ("relax.add", is_op("relax.add")(wildcard(), wildcard())),
+    ]
+    seq = transform.Sequential(
+        [
+            relax.transform.FuseOpsByPattern(patterns, codegen="dnnl"),
+            relax.transform.RunCodegen(),
+            relax.transform.RemoveUnusedFunctions(),
+        ]
+    )
+    mod = seq(AddMul)
+    assert len(mod.attrs["external_mods"]) == 2
+
+    target = tvm.target.Target("llvm")
+    with transform.PassContext(opt_level=0):
+        ex = relax.vm.build(mod, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+
+    x = np.random.rand(2, 3).astype("float32")
+    y = np.random.rand(2, 3).astype("float32")
+    out = vm["main"](tvm.nd.array(x), tvm.nd.array(y))
+    tvm.testing.assert_allclose(out.numpy(), (x + y) * y + x, rtol=1e-5)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,98 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import pytest
+import tvm
+import tvm.testing
+from tvm import relax, te, tir, topi
+import tvm.meta_schedule as ms
+
+
+def matmul(n):
+    A = te.placeholder((n, n), name="A")
+    B = te.placeholder((n, n), name="B")
+    return te.create_prim_func([A, B, topi.nn.matmul(A, B)])
+
+
+def create_database(target, latencies):
+    database = ms.database.MemoryDatabase()
+    for func, secs in latencies:
+        mod = tvm.IRModule({"main": func})
+        workload = database.commit_workload(mod)
+        record = ms.database.TuningRecord(tir.Schedule(mod).trace, workload, [secs], target)
+        database.commit_tuning_record(record)
+    return database
+
+
+def test_measured_latency():
+    target = tvm.target.Target("llvm")
+    database = create_database(target, [(matmul(64), 1e-5), (matmul(128), 8e-5)])
+    model = relax.KernelCostModel(database, target)
+    assert model.num_fit_records == 2
+    tvm.testing.assert_allclose(model.query_measured(matmul(64)), 1e-5)
+    tvm.testing.assert_allclose(model.estimate(matmul(128)), 8e-5)
+    assert model.query_measured(matmul(256)) is None
+
+
+def test_throughput_fit():
+    target = tvm.target.Target("llvm")
+    database = create_database(target, [(matmul(64), 1e-5), (matmul(128), 8e-5)])
+    model = relax.KernelCostModel(database, target)
+    # the latency grows linearly with the flops
+    tvm.testing.assert_allclose(model.exponent, 1.0, rtol=1e-5)
+    tvm.testing.assert_allclose(model.estimate(matmul(256)), 6.4e-4, rtol=1e-5)
+
+    # the records of the other targets are not fit on
+    other = relax.KernelCostModel(database, tvm.target.Target("cuda"))
+    assert other.num_fit_records == 0
+    assert other.estimate(matmul(256)) is None
+
+
+def test_fallback():
+    target = tvm.target.Target("llvm")
+    database = create_database(target, [(matmul(64), 1e-5)])
+    model = relax.KernelCostModel(database, target, lambda func: 1.0)
+    tvm.testing.assert_allclose(model.estimate(matmul(64)), 1e-5)
+    tvm.testing.assert_allclose(model.estimate(matmul(32)), 1.0)
+
+
+def test_estimate_call_tir():
+    target = tvm.target.Target("llvm")
+    database = create_database(target, [(matmul(64), 1e-5)])
+    model = relax.KernelCostModel(database, target)
+
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [64, 64], relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x]):
+        gv = bb.add_func(matmul(64), "matmul")
+        call = relax.call_tir(gv, (x, x), (64, 64), dtype="float32")
+        out = bb.emit(call)
+        bb.emit_func_output(out)
+    mod = bb.get()
+    tvm.testing.assert_allclose(model.estimate_call_tir(mod, call), 1e-5)
+    assert model.estimate_call_tir(mod, relax.op.add(x, x)) is None
+
+
+def test_pass_context():
+    target = tvm.target.Target("llvm")
+    model = relax.KernelCostModel(create_database(target, []), target)
+    assert relax.KernelCostModel.current() is None
+    with tvm.transform.PassContext(config={"relax.kernel_cost_model": model}):
+        assert relax.KernelCostModel.current().same_as(model)
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -138,6 +138,54 @@ def test_function_pass():
     check_equal(After, Expected)
 
 
+def test_parallel_function_pass():
+    bb = relax.BlockBuilder()
+    for i in range(16):
+        x = relax.Var("x", [2, 3], relax.DynTensorType(2, "float32"))
+        with bb.function("f%d" % i, [x]):
+            with bb.dataflow():
+                lv0 = bb.emit(relax.add(x, x))
+                lv1 = bb.emit(relax.add(x, x))
+                gv = bb.emit_output(relax.multiply(lv0, lv1))
+            bb.emit_func_output(gv)
+    mod = bb.get()
+
+    expected = relax.transform.EliminateCommonSubexpr()(mod)
+    with tvm.transform.PassContext(config={"relax.FunctionPass.parallel": True}):
+        after = relax.transform.EliminateCommonSubexpr()(mod)
+    assert [gv.name_hint for gv in after.get_global_vars()] == [
+        gv.name_hint for gv in expected.get_global_vars()
+    ]
+    assert_structural_equal(after, expected)
+
+
+def test_function_pass_shares_unchanged_functions():
+    bb = relax.BlockBuilder()
+    for i in range(4):
+        x = relax.Var("x", [2, 3], relax.DynTensorType(2, "float32"))
+        with bb.function("f%d" % i, [x]):
+            gv = bb.emit(relax.add(x, x))
+            bb.emit_func_output(gv)
+    mod = bb.get()
+
+    @relax.transform.function_pass(opt_level=0)
+    def identity(func, mod, ctx):
+        return func
+
+    after = identity(mod)
+    assert not after.same_as(mod)
+    assert after.functions.same_as(mod.functions)
+
+    # a batch update copies the shared function map once, leaving the input module as is
+    updated = tvm.IRModule(mod.functions)
+    f0, f1 = mod["f0"], mod["f1"]
+    updated.update_funcs({mod.get_global_var("f0"): f1, mod.get_global_var("f2"): mod["f2"]})
+    assert updated["f0"].same_as(f1)
+    assert updated["f2"].same_as(mod["f2"])
+    assert not updated.functions.same_as(mod.functions)
+    assert mod["f0"].same_as(f0)
+
+
 def test_dataflowblock_class_pass():
     @relax.transform.dataflowblock_pass(opt_level=1)
     class TestReplaceBinding:
@@ -238,5 +286,41 @@ def test_dataflowblock_pass():
     check_equal(After, Expected)
 
 
+def test_pass_profiling_instrument():
+    import json
+    from tvm.relax.ir.instrument import PassProfilingInstrument
+
+    @tvm.script.ir_module
+    class Module:
+        @R.function
+        def main(x: Tensor((m, n), "float32")):
+            with relax.dataflow():
+                lv0 = relax.add(x, x)
+                lv1 = relax.add(x, x)
+                gv = relax.multiply(lv0, lv1)
+                relax.output(gv)
+            return gv
+
+    profiler = PassProfilingInstrument()
+    seq = tvm.transform.Sequential(
+        [relax.transform.EliminateCommonSubexpr(), relax.transform.DeadCodeElimination()],
+        name="pipeline",
+    )
+    with tvm.transform.PassContext(instruments=[profiler]):
+        seq(Module)
+        records = json.loads(profiler.as_json())
+        table = profiler.as_table()
+
+    assert [(r["pass"], r["depth"]) for r in records] == [
+        ("pipeline", 0),
+        ("EliminateCommonSubexpr", 1),
+        ("DeadCodeElimination", 1),
+    ]
+    assert records[0]["bindings_before"] == 3
+    assert records[1]["functions_after"] == 1
+    assert all(r["time_ms"] >= 0 and r["peak_rss_after_kb"] >= 0 for r in records)
+    assert "EliminateCommonSubexpr" in table
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -22,6 +22,7 @@ import tvm
 
 from tvm import relax
 from tvm import tir, relay
+from tvm.contrib import utils
 from tvm.ir import structural_equal, assert_structural_equal
 
 import tvm.script
@@ -406,5 +407,31 @@ def test_func_type():
     check_roundtrip(func_type)
 
 
+def test_save_script():
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func
+        def tir_add(x: T.Buffer[(16,), "float32"], y: T.Buffer[(16,), "float32"]) -> None:
+            T.func_attr({"global_symbol": "tir_add"})
+            for i in range(16):
+                with T.block("add"):
+                    vi = T.axis.spatial(16, i)
+                    y[vi] = x[vi] + x[vi]
+
+        @R.function
+        def foo(x: Tensor((16,), "float32")):
+            gv = R.call_tir(tir_add, (x,), (16,), dtype="float32")
+            return gv
+
+    path = utils.tempdir().relpath("mod.py")
+    for show_meta_data in [False, True]:
+        R.parser.save_script(Module, path, show_meta_data=show_meta_data)
+        with open(path) as f:
+            text = f.read()
+        # the streamed script is the same as the one printed to a string
+        assert text == R.parser.astext(Module, show_meta_data=show_meta_data)
+    check_roundtrip(Module)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -18,7 +18,8 @@
 from __future__ import annotations  # must import to defer parsing of annotations
 import pytest
 import tvm
-from tvm import relax
+import tvm.testing
+from tvm import relax, topi
 
 from tvm.script import relax as R
 
@@ -53,5 +54,72 @@ def test_unique():
     np.testing.assert_array_equal(expected_output, result.numpy())
 
 
+def _unique_module(dtype, sorted):
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [tvm.tir.Var("n", "int64")], relax.DynTensorType(1, dtype))
+    with bb.function("main", [x]):
+        gv = bb.emit(relax.unique(x, sorted=sorted))
+        bb.emit_func_output(gv)
+    return bb.get()
+
+
+def _unique_np(data, sorted):
+    expected_sorted, indices = np.unique(data, return_index=True)
+    if sorted:
+        return expected_sorted
+    return data[np.sort(indices)[::-1]]
+
+
+@pytest.mark.parametrize("dtype", ["int32", "int64", "float32"])
+@pytest.mark.parametrize("sorted", [True, False])
+def test_unique_parallel(dtype, sorted):
+    # large enough to be hashed by several threads
+    ex = relax.vm.build(_unique_module(dtype, sorted), tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    for size in [0, 7, 200000]:
+        data = np.random.randint(0, 5000, size).astype(dtype)
+        result = vm["main"](tvm.nd.array(data))
+        np.testing.assert_array_equal(_unique_np(data, sorted), result.numpy())
+
+
+@tvm.testing.requires_cuda
+@pytest.mark.parametrize("sorted", [True, False])
+def test_unique_cuda(sorted):
+    if not tvm.get_global_func("tvm.contrib.thrust.unique", allow_missing=True):
+        pytest.skip("TVM is not built with Thrust")
+    ex = relax.vm.build(_unique_module("int64", sorted), tvm.target.Target("cuda"))
+    vm = relax.VirtualMachine(ex, tvm.cuda())
+    data = np.random.randint(0, 5000, 100000).astype("int64")
+    result = vm["main"](tvm.nd.array(data, tvm.cuda()))
+    assert result.device == tvm.cuda()
+    np.testing.assert_array_equal(_unique_np(data, sorted), result.numpy())
+
+
+@pytest.mark.parametrize("sorted", [True, False])
+def test_unique_bounded(sorted):
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [tvm.tir.Var("n", "int64")], relax.DynTensorType(1, "int64"))
+    with bb.function("main", [x]):
+        bounded = bb.emit(relax.unique_bounded(x, sorted=sorted))
+        values = bb.emit(relax.TupleGetItem(bounded, 0))
+        extent = bb.emit(relax.TupleGetItem(bounded, 1))
+        # the kernels consume the buffer at its bound, only the output is resolved
+        doubled = bb.emit_te(topi.multiply, values, relax.const(2, "int64"))
+        gv = bb.emit(relax.resolve_bound(doubled, extent))
+        bb.emit_func_output(relax.Tuple([gv, extent]))
+    mod = bb.get()
+    # the bound is static in the shape of the data
+    assert isinstance(values.shape, relax.ShapeExpr)
+
+    ex = relax.vm.build(mod, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    for size in [0, 7, 200000]:
+        data = np.random.randint(0, 5000, size).astype("int64")
+        result, extent = vm["main"](tvm.nd.array(data))
+        expected = _unique_np(data, sorted)
+        np.testing.assert_array_equal(extent.numpy(), [len(expected)])
+        np.testing.assert_array_equal(result.numpy(), expected * 2)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -262,6 +262,43 @@ def test_layout_transform():
     verify_vm_outputs([1, 3, 224, 224], relay_vm, relax_vm)
 
 
+def test_convert_layout():
+    data = relay.var("data", shape=(1, 3, 16, 16))
+    weight = relay.var("weight", shape=(8, 3, 3, 3))
+    conv0 = relay.nn.conv2d(data, weight, padding=(1, 1), channels=8, kernel_size=(3, 3))
+    conv1 = relay.nn.conv2d(
+        relay.nn.relu(conv0), relay.var("weight1", shape=(8, 8, 3, 3)), padding=(1, 1)
+    )
+    func = relay.Function(relay.analysis.free_vars(conv1), conv1)
+    params = {
+        "weight": np.random.rand(8, 3, 3, 3).astype("float32"),
+        "weight1": np.random.rand(8, 8, 3, 3).astype("float32"),
+    }
+
+    target = tvm.target.Target("llvm")
+    relax_mod = relay_translator.from_relay(
+        func, target, params, desired_layouts={"nn.conv2d": ["NHWC", "default"]}
+    )
+    # Only the input and the output are transformed, the weight transforms are folded.
+    num_transforms = [0]
+
+    def visit(expr):
+        if isinstance(expr, relax.Call) and isinstance(expr.args[0], tvm.ir.GlobalVar):
+            if expr.args[0].name_hint.startswith("layout_transform"):
+                num_transforms[0] += 1
+
+    relax.analysis.post_order_visit(relax_mod["main"], visit)
+    assert num_transforms[0] == 2
+
+    data_np = np.random.rand(1, 3, 16, 16).astype("float32")
+    relay_mod = tvm.IRModule.from_expr(relay.build_module.bind_params_by_name(func, params))
+    relay_ex = relay.vm.compile(relay_mod, target)
+    relay_out = vm.VirtualMachine(relay_ex, tvm.cpu()).run(data_np)
+    relax_vm = relax.VirtualMachine(relax.vm.build(relax_mod, target), tvm.cpu())
+    relax_out = relax_vm["main"](tvm.nd.array(data_np))
+    tvm.testing.assert_allclose(relay_out.numpy(), relax_out.numpy(), rtol=1e-5, atol=1e-5)
+
+
 def test_translate_op_with_tir():
     @T.prim_func
     def tir_matmul(
@@ -293,5 +330,39 @@ def test_translate_op_with_tir():
     assert_structural_equal(relax_mod["multiply"], tir_matmul)
 
 
+def test_lowering_cache(monkeypatch):
+    num_lowerings = 0
+    select_implementation = relay_translator.select_implementation
+
+    def counted_select_implementation(*args, **kwargs):
+        nonlocal num_lowerings
+        num_lowerings += 1
+        return select_implementation(*args, **kwargs)
+
+    monkeypatch.setattr(relay_translator, "select_implementation", counted_select_implementation)
+    a = relay.var("a", shape=(8, 16))
+    b = relay.var("b", shape=(8, 32))
+    # The exp of b has another input type, and the leaky_relu calls have other attrs.
+    c = relay.exp(relay.exp(relay.exp(a)))
+    d = relay.nn.leaky_relu(relay.nn.leaky_relu(b, alpha=0.1), alpha=0.2)
+    e = relay.exp(b)
+    func = relay.Function([a, b], relay.Tuple([c, d, e]))
+
+    target = tvm.target.Target("llvm")
+    relax_mod = relay_translator.from_relay(func, target)
+    assert num_lowerings == 4
+    prim_funcs = [f for f in relax_mod.functions.values() if isinstance(f, tvm.tir.PrimFunc)]
+    assert len(prim_funcs) == 4
+
+    relax_vm = relax.VirtualMachine(relax.vm.build(relax_mod, target), tvm.cpu())
+    a_np = np.random.rand(8, 16).astype("float32")
+    b_np = np.random.uniform(-1, 1, size=(8, 32)).astype("float32")
+    c_out, d_out, e_out = relax_vm["main"](tvm.nd.array(a_np), tvm.nd.array(b_np))
+    leaky_relu = lambda x, alpha: np.where(x > 0, x, x * alpha)
+    tvm.testing.assert_allclose(c_out.numpy(), np.exp(np.exp(np.exp(a_np))), rtol=1e-5)
+    tvm.testing.assert_allclose(d_out.numpy(), leaky_relu(leaky_relu(b_np, 0.1), 0.2), rtol=1e-5)
+    tvm.testing.assert_allclose(e_out.numpy(), np.exp(b_np), rtol=1e-5)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -16,10 +16,12 @@
 # under the License.
 
 from __future__ import annotations  # must import to defer parsing of annotations
+import numpy as np
 import pytest
 import tvm
 from tvm import relax
 from tvm import tir
+from tvm import topi
 from tvm.ir import structural_equal
 from tvm.ir.base import assert_structural_equal
 from tvm.ir.module import IRModule
@@ -158,6 +160,30 @@ def test_fma_fuse_python():
     assert sub_func_call_var.shape.values[1] == 4
 
 
+def test_simplify_algebra():
+    x = relax.Var("x", [2, 3], relax.DynTensorType(2, "float32"))
+    y = relax.Var("y", [2, 3], relax.DynTensorType(2, "float32"))
+    z = relax.Var("z", [3], relax.DynTensorType(1, "float32"))
+    ones = relax.const(np.ones((2, 3), "float32"))
+    bb = relax.BlockBuilder()
+    with bb.function("main", [x, y, z]):
+        with bb.dataflow():
+            lv0 = bb.emit(relax.op.multiply(x, ones))
+            lv1 = bb.emit(relax.op.add(relax.const(0.0, "float32"), lv0))
+            gv0 = bb.emit_output(relax.Call(tvm.ir.Op.get("relax.ewise_fma"), [lv1, ones, y]))
+            # the constant broadcasts z, so the multiply is kept
+            gv1 = bb.emit_output(relax.op.multiply(z, ones))
+        bb.emit_func_output(relax.Tuple([gv0, gv1]))
+
+    after = relax.transform.SimplifyAlgebra()(bb.get())
+    bindings = after["main"].body.blocks[0].bindings
+    assert len(bindings) == 2
+    assert bindings[0].value.op.same_as(tvm.ir.Op.get("relax.add"))
+    assert bindings[0].value.args[0].same_as(after["main"].params[0])
+    assert bindings[0].value.args[1].same_as(after["main"].params[1])
+    assert bindings[1].value.op.same_as(tvm.ir.Op.get("relax.multiply"))
+
+
 def test_dataflowpass_fail():
     # raise error on rewriting/removing existing Global Vars inside the dataflow block.
     with pytest.raises(tvm.TVMError):
@@ -322,6 +348,75 @@ def test_call_tir_rewrite():
     assert s2.op.global_symbol == "test.op.identity"
 
 
+def test_inplace_call_tir():
+    @tvm.script.ir_module
+    class TestInplaceCallTIR:
+        @T.prim_func
+        def exp(x: T.handle, y: T.handle) -> None:
+            m = T.var("int64")
+            n = T.var("int64")
+            A = T.match_buffer(x, (m, n))
+            B = T.match_buffer(y, (m, n))
+            for i, j in T.grid(m, n):
+                with T.block("exp"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = T.exp(A[vi, vj])
+
+        @R.function
+        def foo(x: Tensor((m, n), "float32")):
+            gv0 = relax.call_tir(exp, (x,), (m, n), dtype="float32")
+            gv1 = relax.call_tir(exp, (gv0,), (m, n), dtype="float32")
+            gv2 = relax.call_tir(exp, (gv1,), (m, n), dtype="float32")
+            gv3 = relax.call_tir(exp, (gv1,), (m, n), dtype="float32")
+            return (gv2, gv3)
+
+    mod = relax.transform.InplaceCallTIR()(TestInplaceCallTIR)
+    bindings = mod["foo"].body.blocks[0].bindings
+    # the parameter belongs to the caller, and gv1 is used again after gv2
+    assert bindings[0].value.attrs is None
+    assert list(bindings[1].value.attrs.inplace_indices) == [0]
+    assert bindings[2].value.attrs is None
+    assert list(bindings[3].value.attrs.inplace_indices) == [0]
+
+    # the in-place output reuses the input tensor
+    new_mod = relax.transform.CallTIRRewrite()(mod)
+    bindings = new_mod["foo"].body.blocks[0].bindings
+    alloc_op = tvm.ir.Op.get("relax.builtin.alloc_tensor")
+    allocs = [b for b in bindings if getattr(b.value, "op", None) == alloc_op]
+    assert len(allocs) == 2
+
+
+def test_call_tir_rewrite_mem_scope():
+    @tvm.script.ir_module
+    class TestCallTIRRewriteMemScope:
+        @T.prim_func
+        def to_texture(x: T.handle, y: T.handle) -> None:
+            A = T.match_buffer(x, (16, 16, 4))
+            B = T.match_buffer(y, (16, 16, 4), scope="global.texture")
+            for i, j, k in T.grid(16, 16, 4):
+                with T.block("copy"):
+                    vi, vj, vk = T.axis.remap("SSS", [i, j, k])
+                    B[vi, vj, vk] = A[vi, vj, vk]
+
+        @R.function
+        def foo(x: Tensor((16, 16, 4), "float32")):
+            gv0 = relax.call_tir(to_texture, (x,), (16, 16, 4), dtype="float32")
+            return gv0
+
+    # the output is allocated in the memory scope of the output buffer of the PrimFunc
+    mod = relax.transform.CallTIRRewrite()(TestCallTIRRewriteMemScope)
+    alloc = mod["foo"].body.blocks[0].bindings[0].value
+    assert alloc.op.name == "relax.builtin.alloc_tensor"
+    assert alloc.attrs.mem_scope == "global.texture"
+
+    # the storage of the scope is allocated by the shape of the tensor
+    mod = relax.transform.VMMemoryLower()(mod)
+    storage = mod["foo"].body.blocks[0].bindings[0].value
+    assert storage.op.name == "relax.vm.builtin.alloc_storage"
+    assert storage.attrs.mem_scope == "global.texture"
+    assert isinstance(storage.args[0], relax.ShapeExpr)
+
+
 def test_vm_memory_lower():
     @tvm.script.ir_module
     class TestVMMemoryLower:
@@ -355,6 +450,227 @@ def test_vm_memory_lower():
     assert s4.op.global_symbol == "test.op.identity"
 
 
+@tvm.script.ir_module
+class StaticPlanBlockMemoryModule:
+    @R.function
+    def foo(x: Tensor((2, 3), "float32")) -> Tensor:
+        alloc0 = relax.builtin.alloc_tensor((2, 3), runtime_device_index=0, dtype="float32")
+        _ = relax.call_packed(
+            "test.op.identity", x, alloc0, type_args=(Tensor(rank=2, dtype="float32"))
+        )
+        alloc1 = relax.builtin.alloc_tensor((2, 3), runtime_device_index=0, dtype="float32")
+        _1 = relax.call_packed(
+            "test.op.identity", alloc0, alloc1, type_args=(Tensor(rank=2, dtype="float32"))
+        )
+        alloc2 = relax.builtin.alloc_tensor((2, 3), runtime_device_index=0, dtype="float32")
+        _2 = relax.call_packed(
+            "test.op.identity", alloc1, alloc2, type_args=(Tensor(rank=2, dtype="float32"))
+        )
+        alloc3 = relax.builtin.alloc_tensor((2, 3), runtime_device_index=0, dtype="float32")
+        _3 = relax.call_packed(
+            "test.op.identity", alloc2, alloc3, type_args=(Tensor(rank=2, dtype="float32"))
+        )
+        gv0 = alloc3
+        return gv0
+
+
+def test_static_plan_block_memory():
+    mod = StaticPlanBlockMemoryModule
+    new_mod = relax.transform.StaticPlanBlockMemory()(mod)
+    block = new_mod["foo"].body.blocks[0]
+
+    # one storage shared by alloc0, alloc1 and alloc2
+    storage = block.bindings[0].value
+    assert storage.op.name == "relax.vm.builtin.alloc_storage"
+    assert storage.args[0].values[0] == 256
+
+    offsets = []
+    for binding in block.bindings[1:]:
+        value = binding.value
+        if isinstance(value, relax.Call) and value.op == tvm.ir.Op.get(
+            "relax.vm.builtin.alloc_tensor"
+        ):
+            assert value.args[0] == block.bindings[0].var
+            offsets.append(value.attrs.offset)
+    assert offsets == [0, 128, 0]
+
+    # the returned tensor escapes the function and is left for VMMemoryLower
+    s = block.bindings[7].value
+    assert s.op.name == "relax.builtin.alloc_tensor"
+
+
+def test_static_plan_block_memory_usmp():
+    def planned_storages(config):
+        with tvm.transform.PassContext(config=config):
+            new_mod = relax.transform.StaticPlanBlockMemory()(StaticPlanBlockMemoryModule)
+        block = new_mod["foo"].body.blocks[0]
+        storage_vars = []
+        sizes = []
+        placements = []
+        for binding in block.bindings:
+            value = binding.value
+            if isinstance(value, relax.Call) and value.op == tvm.ir.Op.get(
+                "relax.vm.builtin.alloc_storage"
+            ):
+                storage_vars.append(binding.var)
+                sizes.append(int(value.args[0].values[0]))
+            elif isinstance(value, relax.Call) and value.op == tvm.ir.Op.get(
+                "relax.vm.builtin.alloc_tensor"
+            ):
+                index = [v.same_as(value.args[0]) for v in storage_vars].index(True)
+                placements.append((index, int(value.attrs.offset)))
+        return sizes, placements
+
+    for algorithm in ["greedy_by_size", "greedy_by_conflicts", "hill_climb"]:
+        sizes, placements = planned_storages({"relax.StaticPlanBlockMemory.algorithm": algorithm})
+        assert sum(sizes) == 256
+        # alloc0 and alloc2 are never live together with each other, only with alloc1
+        assert placements[0] == placements[2]
+        assert placements[0] != placements[1]
+
+    # alloc1 conflicts with alloc0 and overflows the bounded pool.
+    sizes, placements = planned_storages(
+        {
+            "relax.StaticPlanBlockMemory.algorithm": "greedy_by_conflicts",
+            "relax.StaticPlanBlockMemory.pool_size_bytes": 128,
+        }
+    )
+    assert sorted(sizes) == [128, 128]
+    assert placements[0] == placements[2]
+    assert placements[0][0] != placements[1][0]
+
+
+def test_static_plan_block_memory_token_reuse():
+    config = {"relax.StaticPlanBlockMemory.algorithm": "token_reuse"}
+    with tvm.transform.PassContext(config=config):
+        new_mod = relax.transform.StaticPlanBlockMemory()(StaticPlanBlockMemoryModule)
+    block = new_mod["foo"].body.blocks[0]
+    storages = []
+    sizes = []
+    placements = []
+    for binding in block.bindings:
+        value = binding.value
+        if isinstance(value, relax.Call) and value.op == tvm.ir.Op.get(
+            "relax.vm.builtin.alloc_storage"
+        ):
+            storages.append(binding.var)
+            sizes.append(int(value.args[0].values[0]))
+        elif isinstance(value, relax.Call) and value.op == tvm.ir.Op.get(
+            "relax.vm.builtin.alloc_tensor"
+        ):
+            index = [v.same_as(value.args[0]) for v in storages].index(True)
+            placements.append((index, int(value.attrs.offset)))
+    # a storage per token, alloc2 reuses the token of alloc0 which died before it
+    assert sizes == [64, 64]
+    assert placements == [(0, 0), (1, 0), (0, 0)]
+
+
+def test_static_plan_block_memory_vtcm():
+    config = {"relax.StaticPlanBlockMemory.vtcm_capacity_bytes": 128}
+    with tvm.transform.PassContext(config=config):
+        new_mod = relax.transform.StaticPlanBlockMemory()(StaticPlanBlockMemoryModule)
+    block = new_mod["foo"].body.blocks[0]
+    storages = {}
+    placements = []
+    for binding in block.bindings:
+        value = binding.value
+        if isinstance(value, relax.Call) and value.op == tvm.ir.Op.get(
+            "relax.vm.builtin.alloc_storage"
+        ):
+            storages[binding.var] = value.attrs.mem_scope
+        elif isinstance(value, relax.Call) and value.op == tvm.ir.Op.get(
+            "relax.vm.builtin.alloc_tensor"
+        ):
+            placements.append((storages[value.args[0]], int(value.attrs.offset)))
+    # alloc0 and alloc2 share the VTCM, alloc1 is live with both and does not fit
+    assert placements == [("global.vtcm", 0), ("global", 0), ("global.vtcm", 0)]
+
+
+def test_static_plan_block_memory_upper_bound():
+    @tvm.script.ir_module
+    class TestUpperBound:
+        @R.function
+        def foo(x: Tensor((n, 4), "float32")) -> Tensor:
+            alloc0 = relax.builtin.alloc_tensor((n, 4), runtime_device_index=0, dtype="float32")
+            _ = relax.call_packed(
+                "test.op.identity", x, alloc0, type_args=(Tensor(rank=2, dtype="float32"))
+            )
+            alloc1 = relax.builtin.alloc_tensor((n, 4), runtime_device_index=0, dtype="float32")
+            _1 = relax.call_packed(
+                "test.op.identity", alloc0, alloc1, type_args=(Tensor(rank=2, dtype="float32"))
+            )
+            gv0 = alloc1
+            return gv0
+
+    alloc_storage_op = tvm.ir.Op.get("relax.vm.builtin.alloc_storage")
+
+    # Without an upper bound, the symbolic-shape tensors are left for VMMemoryLower.
+    new_mod = relax.transform.StaticPlanBlockMemory()(TestUpperBound)
+    block = new_mod["foo"].body.blocks[0]
+    assert all(binding.value.op != alloc_storage_op for binding in block.bindings)
+
+    # With n <= 16, alloc0 is planned at its worst-case size.
+    mod = tvm.IRModule({"foo": TestUpperBound["foo"].with_attr("tir_var_upper_bound", {"n": 16})})
+    new_mod = relax.transform.StaticPlanBlockMemory()(mod)
+    block = new_mod["foo"].body.blocks[0]
+    storage = block.bindings[0].value
+    assert storage.op == alloc_storage_op
+    assert storage.args[0].values[0] == 16 * 4 * 4
+    tensor = block.bindings[1].value
+    assert tensor.op.name == "relax.vm.builtin.alloc_tensor"
+    assert tensor.args[0] == block.bindings[0].var
+    # the returned tensor still escapes the function
+    assert block.bindings[3].value.op.name == "relax.builtin.alloc_tensor"
+
+
+def test_hoist_workspace():
+    @tvm.script.ir_module
+    class TestHoistWorkspace:
+        @T.prim_func
+        def fused_exp_exp(x: T.Buffer[(4, 4), "float32"], y: T.Buffer[(4, 4), "float32"]) -> None:
+            T.func_attr({"global_symbol": "fused_exp_exp", "tir.noalias": True})
+            t = T.alloc_buffer((4, 4), "float32")
+            for i, j in T.grid(4, 4):
+                with T.block("exp0"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    t[vi, vj] = T.exp(x[vi, vj])
+            for i, j in T.grid(4, 4):
+                with T.block("exp1"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    y[vi, vj] = T.exp(t[vi, vj])
+
+        @R.function
+        def foo(x: Tensor((4, 4), "float32")):
+            gv0 = relax.call_tir(fused_exp_exp, (x,), (4, 4), dtype="float32")
+            gv1 = relax.call_tir(fused_exp_exp, (gv0,), (4, 4), dtype="float32")
+            return gv1
+
+    mod = relax.transform.CallTIRRewrite()(TestHoistWorkspace)
+    mod = relax.transform.HoistWorkspace()(mod)
+
+    # the scratch buffer becomes a trailing parameter of the kernel
+    kernel = mod["fused_exp_exp"]
+    assert len(kernel.params) == 3
+    assert kernel.buffer_map[kernel.params[2]].name == "t"
+    assert len(kernel.body.block.alloc_buffers) == 0
+
+    alloc_op = tvm.ir.Op.get("relax.builtin.alloc_tensor")
+    bindings = mod["foo"].body.blocks[0].bindings
+    workspaces = [b.var for b in bindings if b.var.name_hint == "workspace"]
+    assert len(workspaces) == 2
+    calls = [
+        b.value for b in bindings if isinstance(getattr(b.value, "op", None), tvm.ir.GlobalVar)
+    ]
+    assert [call.args[-1] for call in calls] == workspaces
+    assert all(b.value.op == alloc_op for b in bindings if b.var.name_hint == "workspace")
+
+    # the workspaces share the storage with the other planned tensors
+    mod = relax.transform.StaticPlanBlockMemory()(mod)
+    bindings = mod["foo"].body.blocks[0].bindings
+    alloc_storage_op = tvm.ir.Op.get("relax.vm.builtin.alloc_storage")
+    assert len([b for b in bindings if getattr(b.value, "op", None) == alloc_storage_op]) == 1
+
+
 def test_vm_shape_lowering():
     @tvm.script.ir_module
     class TestVMShapeLower:
@@ -442,7 +758,9 @@ def test_vm_shape_lowering_func_param_with_shape():
     new_mod = relax.transform.VMShapeLower()(mod)
 
     assert isinstance(new_mod, tvm.IRModule)
-    assert isinstance(new_mod["shape_func"], tvm.tir.function.PrimFunc)
+    # (m, k) only consists of variables stored from the parameter shapes, so it is loaded from the
+    # shape heap without calling a shape function
+    assert not any(gv.name_hint.startswith("shape_func") for gv in new_mod.get_global_vars())
     assert isinstance(new_mod["tir_matmul"], tvm.tir.function.PrimFunc)
     func = new_mod["foo"]
     assert isinstance(func, tvm.relax.expr.Function)
@@ -492,6 +810,30 @@ def test_vm_shape_lower_int32_shape():
     assert cast_expr.dtype == "int64"
 
 
+def test_vm_shape_lowering_entry_shape_func():
+    @tvm.script.ir_module
+    class InputModule:
+        @R.function
+        def foo(x: Tensor((n, m), "float32")):
+            gv0 = R.call_tir("my_extern", (x,), (n * 2, m + 1), dtype="float32")
+            gv1 = R.call_tir("my_extern", (gv0,), (n * 2, m + 1), dtype="float32")
+            return gv1
+
+    after_mod = relax.transform.VMShapeLower()(InputModule)
+
+    # both shape expressions only depend on the parameter shape, so all of their values are
+    # computed by a single shape function at function entry
+    shape_funcs = [
+        gv for gv in after_mod.get_global_vars() if gv.name_hint.startswith("shape_func")
+    ]
+    assert len(shape_funcs) == 1
+    bindings = after_mod["foo"].body.blocks[0].bindings
+    assert bindings[2].value.op.name == "relax.vm.builtin.store_shape"
+    assert bindings[3].value.op == shape_funcs[0]
+    calls = [b.value for block in after_mod["foo"].body.blocks for b in block.bindings]
+    assert sum(1 for call in calls if call.op == shape_funcs[0]) == 1
+
+
 def test_to_anf():
     @tvm.script.ir_module
     class TestNormalizeInputModule:
@@ -524,5 +866,62 @@ def test_to_anf_no_op():
     assert_structural_equal(mod, mod_post)
 
 
+def _build_mlp(x_shape, w0_shape, w1_shape):
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", x_shape, relax.DynTensorType(2, "float32"))
+    w0 = relax.Var("w0", w0_shape, relax.DynTensorType(2, "float32"))
+    w1 = relax.Var("w1", w1_shape, relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x, w0, w1]):
+        with bb.dataflow():
+            lv0 = bb.emit_te(topi.nn.matmul, x, w0)
+            lv1 = bb.emit_te(topi.nn.relu, lv0)
+            lv2 = bb.emit_te(topi.nn.matmul, lv1, w1)
+            gv = bb.emit_output(lv2)
+        bb.emit_func_output(gv)
+    mod = bb.get()
+    # The first weight is split by columns and the second by rows, so that the first matmul
+    # and the relu are sharded by columns, and the second matmul computes partial sums.
+    mod["main"] = mod["main"].with_attr("relax.sharding", {"w0": 1, "w1": 0})
+    return mod
+
+
+def test_shard_tensor_parallel():
+    mod = _build_mlp((4, 8), (8, 16), (16, 8))
+    after_mod = relax.transform.ShardTensorParallel(2)(mod)
+
+    main = after_mod["main"]
+    assert "relax.sharding" not in main.attrs
+    assert isinstance(main.params[0].checked_type, relax.DynTensorType)
+    for param in main.params[1:]:
+        assert isinstance(param.checked_type, relax.TupleType)
+        assert len(param.checked_type.fields) == 2
+
+    names = [gv.name_hint for gv in after_mod.get_global_vars()]
+    for name in ["matmul_shard", "relu_shard", "matmul1_shard"]:
+        assert name in names
+    matmul = after_mod["matmul_shard"]
+    assert [int(d) for d in matmul.buffer_map[matmul.params[1]].shape] == [8, 8]
+    assert [int(d) for d in matmul.buffer_map[matmul.params[2]].shape] == [4, 8]
+    matmul1 = after_mod["matmul1_shard"]
+    assert [int(d) for d in matmul1.buffer_map[matmul1.params[0]].shape] == [4, 8]
+    assert [int(d) for d in matmul1.buffer_map[matmul1.params[2]].shape] == [4, 8]
+
+    calls = [b.value for block in main.body.blocks for b in block.bindings]
+    builtins = [
+        c.op.global_symbol for c in calls if isinstance(getattr(c, "op", None), relax.ExternFunc)
+    ]
+    # x is replicated, the shards of the columns feed the second matmul as they are, and its
+    # partial sums are summed up for the result.
+    assert builtins == ["vm.builtin.ccl.broadcast", "vm.builtin.ccl.allreduce"]
+    call_tir_op = tvm.ir.Op.get("relax.call_tir")
+    devices = [
+        c.attrs.runtime_device_index
+        for c in calls
+        if isinstance(c, relax.Call) and c.op == call_tir_op and c.attrs is not None
+    ]
+    assert devices == [0, 1] * 3
+
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
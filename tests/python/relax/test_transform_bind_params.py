@@ -21,6 +21,7 @@ import pytest
 
 import tvm
 import tvm.testing
+from tvm.contrib import utils
 from tvm import relax
 import numpy as np
 
@@ -75,5 +76,29 @@ def test_bind_params(use_np_array):
     tvm.testing.assert_allclose(res_before.numpy(), res_after.numpy())
 
 
+def test_bind_params_from_file():
+    @tvm.script.ir_module
+    class InputModule:
+        @R.function
+        def main(
+            x: Tensor((16, 16), "float32"), w: Tensor((16, 16), "float32")
+        ) -> Tensor((16, 16), "float32"):
+            gv0 = R.add(x, w)
+            return gv0
+
+    w_np = np.random.rand(16, 16).astype(np.float32)
+    path = utils.tempdir().relpath("params.bin")
+    tvm.ir.save_binary_file({"w": tvm.nd.array(w_np), "unused": tvm.nd.array(w_np)}, path)
+    mod = relax.transform.BindParamsFromFile("main", path)(InputModule)
+    assert len(mod["main"].params) == 1
+    expected = relax.transform.BindParams("main", {"w": w_np})(InputModule)
+    tvm.ir.assert_structural_equal(mod, expected)
+
+    x_np = np.random.rand(16, 16).astype(np.float32)
+    ex = relax.vm.build(mod, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    tvm.testing.assert_allclose(vm["main"](tvm.nd.array(x_np)).numpy(), x_np + w_np)
+
+
 if __name__ == "__main__":
     sys.exit(pytest.main([__file__] + sys.argv[1:]))
@@ -24,6 +24,7 @@ from tvm import relax
 import numpy as np
 from tvm.script import relax as R
 from tvm import transform
+from tvm.contrib import utils
 
 env_checker_codegen = tvm.get_global_func("relax.ext.tensorrt", True)
 env_checker_runtime = tvm.get_global_func("relax.is_tensorrt_runtime_enabled", True)
@@ -116,6 +117,37 @@ def test_single_annot_func():
     tvm.ir.assert_structural_equal(mod, new_mod)
 
 
+def test_prebuild_engine():
+    @tvm.script.ir_module
+    class InputModule:
+        @R.function
+        def relax_func(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+            z1 = relax.add(x, y)
+            z2 = relax.add(z1, z1)
+            return z2
+
+        @R.function
+        def main(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+            lv0 = relax_func(x, y)
+            return lv0
+
+    mod = InputModule
+    new_relax_func = mod["relax_func"].with_attr("Codegen", "tensorrt")
+    new_relax_func = new_relax_func.with_attr("global_symbol", "trt_relax_func")
+    mod["relax_func"] = new_relax_func
+
+    temp = utils.tempdir()
+    options = {"relax.ext.tensorrt.options": {"engine_cache_dir": temp.path}}
+    with transform.PassContext(config=options):
+        relax.transform.RunCodegen()(mod)
+    # The engine is cached under a key of the subgraph hash, GPU arch and TensorRT version.
+    plans = [name for name in os.listdir(temp.path) if name.endswith(".plan")]
+    assert len(plans) == 1
+    assert plans[0].startswith("trt_relax_func_")
+    trt_version = ".".join(str(int(v)) for v in tvm.get_global_func("relax.get_tensorrt_version")())
+    assert "_trt" + trt_version + "_" in plans[0]
+
+
 # TODO(@sunggg):  test with more complex patterns (e.g., multiple annots, mixed codegens, different ops, const binding)
 
 if __name__ == "__main__":
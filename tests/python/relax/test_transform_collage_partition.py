@@ -0,0 +1,111 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+from __future__ import annotations
+import pytest
+import tvm
+from tvm import relax
+from tvm.relax.dpl import is_op, wildcard
+from tvm.script import relax as R
+
+
+@tvm.script.ir_module
+class AddMulAdd:
+    @R.function
+    def main(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+        with R.dataflow():
+            lv0 = relax.add(x, y)
+            lv1 = relax.multiply(lv0, y)
+            gv = relax.add(lv1, x)
+            R.output(gv)
+        return gv
+
+
+def _patterns():
+    add = is_op("relax.add")(wildcard(), wildcard())
+    multiply = is_op("relax.multiply")(wildcard(), wildcard())
+    return [
+        ("relax.add_multiply", is_op("relax.multiply")(add, wildcard())),
+        ("relax.multiply_add", is_op("relax.add")(multiply, wildcard())),
+    ]
+
+
+def _estimator(offload_costs, measured):
+    """The latency of the offloaded patterns given by offload_costs, one second per op with TVM."""
+
+    def estimate_latency(mod):
+        measured.append(mod)
+        for gv in mod.get_global_vars():
+            for name, cost in offload_costs.items():
+                if gv.name_hint == "dnnl_" + name.replace(".", "_"):
+                    return cost
+        num_ops = []
+        relax.analysis.post_order_visit(
+            mod["main"].body,
+            lambda e: num_ops.append(e) if isinstance(e, relax.Call) else None,
+        )
+        return float(len(num_ops))
+
+    return estimate_latency
+
+
+def _offloaded(mod):
+    return sorted(
+        gv.name_hint
+        for gv in mod.get_global_vars()
+        if mod[gv].attrs is not None and "Codegen" in mod[gv].attrs
+    )
+
+
+def test_offload_the_cheapest_covering():
+    measured = []
+    costs = {"relax.add_multiply": 0.5, "relax.multiply_add": 1.0}
+    partition = relax.transform.CollagePartition(
+        {"dnnl": _patterns()}, _estimator(costs, measured)
+    )
+    mod = partition(AddMulAdd)
+    # the greedy FuseOpsByPattern takes the match of the last binding, multiply_add
+    assert _offloaded(mod) == ["dnnl_relax_add_multiply"]
+    calls = []
+    relax.analysis.post_order_visit(
+        mod["main"].body, lambda e: calls.append(e) if isinstance(e, relax.Call) else None
+    )
+    assert [call.op.name_hint for call in calls if isinstance(call.op, relax.GlobalVar)] == [
+        "dnnl_relax_add_multiply"
+    ]
+    # the two adds alone are the same module, measured once
+    assert len(measured) == 6
+
+
+def test_keep_with_tvm_when_faster():
+    costs = {"relax.add_multiply": 3.0, "relax.multiply_add": 3.0}
+    mod = relax.transform.CollagePartition({"dnnl": _patterns()}, _estimator(costs, []))(
+        AddMulAdd
+    )
+    assert not _offloaded(mod)
+    tvm.ir.assert_structural_equal(mod, AddMulAdd)
+
+
+def test_offload_all_bindings():
+    costs = {"relax.add_multiply": 0.5, "relax.add": 0.25}
+    add = is_op("relax.add")(wildcard(), wildcard())
+    patterns = [_patterns()[0], ("relax.add", add)]
+    mod = relax.transform.CollagePartition({"dnnl": patterns}, _estimator(costs, []))(AddMulAdd)
+    assert _offloaded(mod) == ["dnnl_relax_add", "dnnl_relax_add_multiply"]
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
@@ -0,0 +1,93 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+from __future__ import annotations  # must import to defer parsing of annotations
+import pytest
+import sys
+import tvm
+import tvm.testing
+from tvm import relax
+import tvm.script
+from tvm.script import tir as T, relax as R
+
+
+def test_remove_unused_chain():
+    @tvm.script.ir_module
+    class Before:
+        @T.prim_func
+        def exp(A: T.Buffer[(2, 3), "float32"], B: T.Buffer[(2, 3), "float32"]):
+            for i, j in T.grid(2, 3):
+                with T.block("exp"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = T.exp(A[vi, vj])
+
+        @R.function
+        def main(x: Tensor((2, 3), "float32")):
+            with R.dataflow():
+                lv0 = R.call_tir(exp, (x,), (2, 3), dtype="float32")
+                lv1 = R.call_tir(exp, (lv0,), (2, 3), dtype="float32")
+                lv2 = R.call_tir(exp, (x,), (2, 3), dtype="float32")
+                gv = R.call_tir(exp, (lv2,), (2, 3), dtype="float32")
+                R.output(gv)
+            return gv
+
+    @tvm.script.ir_module
+    class Expected:
+        @T.prim_func
+        def exp(A: T.Buffer[(2, 3), "float32"], B: T.Buffer[(2, 3), "float32"]):
+            for i, j in T.grid(2, 3):
+                with T.block("exp"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = T.exp(A[vi, vj])
+
+        @R.function
+        def main(x: Tensor((2, 3), "float32")):
+            with R.dataflow():
+                lv2 = R.call_tir(exp, (x,), (2, 3), dtype="float32")
+                gv = R.call_tir(exp, (lv2,), (2, 3), dtype="float32")
+                R.output(gv)
+            return gv
+
+    after = relax.transform.DeadCodeElimination()(Before)
+    tvm.ir.assert_structural_equal(after, Expected)
+
+
+def test_keep_outputs():
+    @tvm.script.ir_module
+    class Before:
+        @T.prim_func
+        def exp(A: T.Buffer[(2, 3), "float32"], B: T.Buffer[(2, 3), "float32"]):
+            for i, j in T.grid(2, 3):
+                with T.block("exp"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = T.exp(A[vi, vj])
+
+        @R.function
+        def main(x: Tensor((2, 3), "float32")):
+            with R.dataflow():
+                lv0 = R.call_tir(exp, (x,), (2, 3), dtype="float32")
+                gv0 = R.call_tir(exp, (lv0,), (2, 3), dtype="float32")
+                gv1 = R.call_tir(exp, (x,), (2, 3), dtype="float32")
+                R.output(gv0, gv1)
+            return gv1
+
+    # The outputs of a block may be used after it, they are never removed.
+    after = relax.transform.DeadCodeElimination()(Before)
+    tvm.ir.assert_structural_equal(after, Before)
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__] + sys.argv[1:]))
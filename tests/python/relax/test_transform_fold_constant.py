@@ -150,6 +150,89 @@ def test_two_hop_addone():
     tvm.ir.assert_structural_equal(after, expected)
 
 
+def test_fold_distinct_funcs():
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func
+        def addone(A: T.Buffer[(2, 3), "float32"], B: T.Buffer[(2, 3), "float32"]) -> None:
+            for i, j in T.grid(2, 3):
+                with T.block("addone"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] + T.float32(1)
+
+        @T.prim_func
+        def transpose(A: T.Buffer[(2, 3), "float32"], B: T.Buffer[(3, 2), "float32"]) -> None:
+            for i, j in T.grid(3, 2):
+                with T.block("transpose"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vj, vi]
+
+        @R.function
+        def before(c0: Tensor((2, 3), "float32")):
+            lv0 = relax.call_tir(addone, (c0,), (2, 3), dtype="float32")
+            lv1 = relax.call_tir(transpose, (lv0,), (3, 2), dtype="float32")
+            return lv1
+
+        @R.function
+        def expected(c1: Tensor((2, 3), "float32"), c2: Tensor((3, 2), "float32")):
+            lv0 = c1
+            lv1 = c2
+            return c2
+
+    # Both functions are built in one module before folding.
+    c0_np = np.arange(2 * 3).astype("float32").reshape(2, 3)
+    c1_np = c0_np + 1
+    c2_np = c1_np.T
+    before = gen_mod(Module, "before", {"c0": c0_np})
+    expected = gen_mod(Module, "expected", {"c1": c1_np, "c2": c2_np})
+
+    after = relax.transform.FoldConstant()(before)
+    tvm.ir.assert_structural_equal(after, expected)
+
+
+def test_fold_disk_cache():
+    import os
+    from tvm.contrib import utils
+
+    @tvm.script.ir_module
+    class Module:
+        @T.prim_func
+        def addone(A: T.Buffer[(2, 2), "float32"], B: T.Buffer[(2, 2), "float32"]) -> None:
+            for i, j in T.grid(2, 2):
+                with T.block("addone"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] + T.float32(1)
+
+        @R.function
+        def before(c0: Tensor((2, 2), "float32")):
+            lv0 = relax.call_tir(addone, (c0,), (2, 2), dtype="float32")
+            lv1 = relax.call_tir(addone, (lv0,), (2, 2), dtype="float32")
+            return lv1
+
+        @R.function
+        def expected(c1: Tensor((2, 2), "float32"), c2: Tensor((2, 2), "float32")):
+            lv0 = c1
+            lv1 = c2
+            return c2
+
+    c0_np = np.arange((2 * 2)).astype("float32").reshape(2, 2)
+    before = gen_mod(Module, "before", {"c0": c0_np})
+    expected = gen_mod(Module, "expected", {"c1": c0_np + 1, "c2": c0_np + 2})
+
+    temp_dir = utils.tempdir()
+    cache_dir = temp_dir.temp_dir
+    config = {"relax.FoldConstant.cache_dir": cache_dir}
+    with tvm.transform.PassContext(config=config):
+        after = relax.transform.FoldConstant()(before)
+    tvm.ir.assert_structural_equal(after, expected)
+    assert len(os.listdir(cache_dir)) == 2
+    # The second run is served from the cache.
+    with tvm.transform.PassContext(config=config):
+        after = relax.transform.FoldConstant()(before)
+    tvm.ir.assert_structural_equal(after, expected)
+    assert len(os.listdir(cache_dir)) == 2
+
+
 def test_dataflow_fold():
     @tvm.script.ir_module
     class Module:
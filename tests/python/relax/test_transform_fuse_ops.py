@@ -16,6 +16,7 @@
 # under the License.
 import sys
 
+import numpy as np
 import pytest
 import tvm
 from tvm import relax, topi
@@ -773,5 +774,119 @@ def test_softmax():
     _check(before(), expected())
 
 
+def test_fuse_softmax_chain():
+    """The reductions and the elementwise ops of a softmax are fused into one kernel."""
+
+    def before():
+        bb = relax.BlockBuilder()
+        x = relax.Var("x", [16, 32], relax.DynTensorType(2, "float32"))
+        with bb.function("main", [x]):
+            with bb.dataflow():
+                lv0 = bb.emit_te(topi.max, x, axis=1, keepdims=True)
+                lv1 = bb.emit_te(topi.subtract, x, lv0)
+                lv2 = bb.emit_te(topi.exp, lv1)
+                lv3 = bb.emit_te(topi.sum, lv2, axis=1, keepdims=True)
+                gv = bb.emit_output(bb.call_te(topi.divide, lv2, lv3))
+            bb.emit_func_output(gv)
+        return bb.get()
+
+    def num_fused(mod):
+        attrs = [func.attrs for func in mod.functions.values()]
+        return len([a for a in attrs if a is not None and "Primitive" in a])
+
+    mod = relax.transform.AnnotateTIROpPattern()(before())
+    fused = relax.transform.FuseOps()(mod)
+    assert num_fused(fused) == 1
+    with tvm.transform.PassContext(config={"relax.FuseOps.fuse_reduction_chains": False}):
+        assert num_fused(relax.transform.FuseOps()(mod)) > 1
+
+    fused = relax.transform.FuseTIR()(fused)
+    ex = relax.vm.build(fused, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    data = np.random.rand(16, 32).astype("float32")
+    res = vm["main"](tvm.nd.array(data))
+    expected = np.exp(data - data.max(axis=1, keepdims=True))
+    expected /= expected.sum(axis=1, keepdims=True)
+    np.testing.assert_allclose(res.numpy(), expected, rtol=1e-5, atol=1e-5)
+
+
+def test_fuse_gather_into_reduction():
+    """The lookup of an embedding bag is fused into its pooling and the following ops."""
+
+    def before():
+        bb = relax.BlockBuilder()
+        w = relax.Var("w", [100, 16], relax.DynTensorType(2, "float32"))
+        idx = relax.Var("idx", [8, 4], relax.DynTensorType(2, "int64"))
+        with bb.function("main", [w, idx]):
+            with bb.dataflow():
+                lv0 = bb.emit_te(topi.take, w, idx, axis=0)
+                lv1 = bb.emit_te(topi.sum, lv0, axis=1)
+                gv = bb.emit_output(bb.call_te(topi.nn.relu, lv1))
+            bb.emit_func_output(gv)
+        return bb.get()
+
+    def num_fused(mod):
+        attrs = [func.attrs for func in mod.functions.values()]
+        return len([a for a in attrs if a is not None and "Primitive" in a])
+
+    mod = relax.transform.AnnotateTIROpPattern()(before())
+    fused = relax.transform.FuseOps()(mod)
+    assert num_fused(fused) == 1
+    with tvm.transform.PassContext(config={"relax.FuseOps.fuse_reduction_chains": False}):
+        assert num_fused(relax.transform.FuseOps()(mod)) > 1
+
+    fused = relax.transform.FuseTIR()(fused)
+    ex = relax.vm.build(fused, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    weight = np.random.rand(100, 16).astype("float32") - 0.5
+    indices = np.random.randint(0, 100, size=(8, 4)).astype("int64")
+    res = vm["main"](tvm.nd.array(weight), tvm.nd.array(indices))
+    expected = np.maximum(weight[indices].sum(axis=1), 0)
+    np.testing.assert_allclose(res.numpy(), expected, rtol=1e-5, atol=1e-5)
+
+
+def test_fuse_deep_diamond_chain():
+    """A deep chain of diamonds is partitioned into the same groups and computes the same."""
+    num_layers = 64
+
+    def before():
+        bb = relax.BlockBuilder()
+        x = relax.Var("x", [8, 16], relax.DynTensorType(2, "float32"))
+        with bb.function("main", [x]):
+            with bb.dataflow():
+                lv = x
+                for _ in range(num_layers):
+                    lv0 = bb.emit_te(topi.add, lv, relax.const(1, "float32"))
+                    lv1 = bb.emit_te(topi.multiply, lv, relax.const(0.5, "float32"))
+                    lv = bb.emit_te(topi.subtract, lv0, lv1)
+                gv = bb.emit_output(lv)
+            bb.emit_func_output(gv)
+        return bb.get()
+
+    def num_fused(mod):
+        attrs = [func.attrs for func in mod.functions.values()]
+        return len([a for a in attrs if a is not None and "Primitive" in a])
+
+    def run(fused):
+        ex = relax.vm.build(relax.transform.FuseTIR()(fused), tvm.target.Target("llvm"))
+        vm = relax.VirtualMachine(ex, tvm.cpu())
+        return vm["main"](tvm.nd.array(data)).numpy()
+
+    data = np.random.rand(8, 16).astype("float32")
+    expected = data
+    for _ in range(num_layers):
+        expected = (expected + 1) - expected * 0.5
+
+    mod = relax.transform.AnnotateTIROpPattern()(before())
+    fused = relax.transform.FuseOps()(mod)
+    assert num_fused(fused) == 1
+    np.testing.assert_allclose(run(fused), expected, rtol=1e-5, atol=1e-5)
+    # every path check of a diamond starts from a clean visit state, also across groups
+    with tvm.transform.PassContext(config={"relax.FuseOps.max_depth": 16}):
+        fused = relax.transform.FuseOps()(mod)
+    assert num_fused(fused) >= 3 * num_layers // 16
+    np.testing.assert_allclose(run(fused), expected, rtol=1e-5, atol=1e-5)
+
+
 if __name__ == "__main__":
     sys.exit(pytest.main([__file__] + sys.argv[1:]))
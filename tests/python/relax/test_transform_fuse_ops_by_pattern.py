@@ -0,0 +1,163 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+from __future__ import annotations
+import pytest
+import tvm
+from tvm import relax
+from tvm.relax.dpl import is_op, wildcard
+from tvm.script import relax as R
+
+
+def _add_mul_pattern():
+    return is_op("relax.multiply")(is_op("relax.add")(wildcard(), wildcard()), wildcard())
+
+
+def _calls(func):
+    calls = []
+
+    def fvisit(e):
+        if isinstance(e, relax.Call):
+            calls.append(e)
+
+    relax.analysis.post_order_visit(func.body, fvisit)
+    return calls
+
+
+def test_fuse_matched_chain():
+    @tvm.script.ir_module
+    class Module:
+        @R.function
+        def main(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+            with R.dataflow():
+                lv0 = relax.add(x, y)
+                lv1 = relax.multiply(lv0, y)
+                gv = relax.add(lv1, x)
+                R.output(gv)
+            return gv
+
+    mod = relax.transform.FuseOpsByPattern([("relax.add_multiply", _add_mul_pattern())])(Module)
+    calls = _calls(mod["main"])
+    assert len(calls) == 2
+    gv = calls[0].op
+    assert isinstance(gv, relax.GlobalVar)
+    assert [arg.name_hint for arg in calls[0].args] == ["x", "y"]
+    func = mod[gv]
+    assert func.attrs["Composite"] == "relax.add_multiply"
+    assert func.attrs["Primitive"] == 1
+    assert [call.op.name for call in _calls(func)] == ["relax.add", "relax.multiply"]
+    assert calls[1].op == tvm.ir.Op.get("relax.add")
+
+
+def test_skip_match_with_external_use():
+    @tvm.script.ir_module
+    class Module:
+        @R.function
+        def main(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+            with R.dataflow():
+                lv0 = relax.add(x, y)
+                lv1 = relax.multiply(lv0, y)
+                gv = relax.add(lv1, lv0)
+                R.output(gv)
+            return gv
+
+    mod = relax.transform.FuseOpsByPattern([("relax.add_multiply", _add_mul_pattern())])(Module)
+    tvm.ir.assert_structural_equal(mod, Module)
+
+
+def test_pattern_priority():
+    @tvm.script.ir_module
+    class Module:
+        @R.function
+        def main(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+            with R.dataflow():
+                lv0 = relax.add(x, y)
+                gv = relax.multiply(lv0, y)
+                R.output(gv)
+            return gv
+
+    patterns = [
+        ("relax.add_multiply", _add_mul_pattern()),
+        ("relax.multiply", is_op("relax.multiply")(wildcard(), wildcard())),
+    ]
+    mod = relax.transform.FuseOpsByPattern(patterns)(Module)
+    calls = _calls(mod["main"])
+    assert len(calls) == 1
+    assert mod[calls[0].op].attrs["Composite"] == "relax.add_multiply"
+
+    mod = relax.transform.FuseOpsByPattern(patterns[::-1])(Module)
+    calls = _calls(mod["main"])
+    assert len(calls) == 2
+    assert calls[0].op == tvm.ir.Op.get("relax.add")
+    assert mod[calls[1].op].attrs["Composite"] == "relax.multiply"
+
+
+def test_pattern_priority_across_ops():
+    @tvm.script.ir_module
+    class Module:
+        @R.function
+        def main(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+            with R.dataflow():
+                lv0 = relax.add(x, y)
+                gv = relax.multiply(lv0, y)
+                R.output(gv)
+            return gv
+
+    # The call pattern of any op is tried against the calls of every op, in order of priority
+    # with the patterns of the op called.
+    patterns = [
+        ("relax.any", wildcard()(wildcard(), wildcard())),
+        ("relax.multiply", is_op("relax.multiply")(wildcard(), wildcard())),
+    ]
+    mod = relax.transform.FuseOpsByPattern(patterns)(Module)
+    calls = _calls(mod["main"])
+    assert [mod[call.op].attrs["Composite"] for call in calls] == ["relax.any", "relax.any"]
+
+    mod = relax.transform.FuseOpsByPattern(patterns[::-1])(Module)
+    calls = _calls(mod["main"])
+    assert [mod[call.op].attrs["Composite"] for call in calls] == ["relax.any", "relax.multiply"]
+
+
+def test_annotate_codegen():
+    @tvm.script.ir_module
+    class Module:
+        @R.function
+        def main(x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")) -> Tensor:
+            with R.dataflow():
+                lv0 = relax.add(x, y)
+                lv1 = relax.multiply(lv0, y)
+                lv2 = relax.add(lv1, x)
+                gv = relax.multiply(lv2, y)
+                R.output(gv)
+            return gv
+
+    patterns = [("relax.add_multiply", _add_mul_pattern())]
+    mod = relax.transform.FuseOpsByPattern(patterns, codegen="tensorrt")(Module)
+    calls = _calls(mod["main"])
+    assert len(calls) == 2
+    # Both matches compute the same function, which is offloaded once.
+    assert calls[0].op.same_as(calls[1].op)
+    func = mod[calls[0].op]
+    assert func.attrs["Codegen"] == "tensorrt"
+    assert func.attrs["global_symbol"] == calls[0].op.name_hint
+    composite = func.body.op
+    assert isinstance(composite, relax.Function)
+    assert composite.attrs["Composite"] == "relax.add_multiply"
+
+
+if __name__ == "__main__":
+    pytest.main([__file__])
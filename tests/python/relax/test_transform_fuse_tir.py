@@ -570,5 +570,37 @@ def test_fuse_return_partial_result():
     _check(before(), expected())
 
 
+def test_fuse_identical_funcs_once():
+    # Two layers calling copies of the same kernels produce structurally equal fused functions,
+    # which only differ in their global symbols.
+    bb = relax.BlockBuilder()
+    x = tvm.te.placeholder((10, 20), "float32")
+    prim_func = tvm.te.create_prim_func([x, topi.exp(x)])
+    layer_gvs = []
+    for suffix in ["a", "b"]:
+        exp_gv = bb.add_func(prim_func.with_attr("global_symbol", "exp_" + suffix), "exp_" + suffix)
+        x1 = relax.Var("x1", [10, 20], relax.DynTensorType(2, "float32"))
+        with bb.function("fused_exp_" + suffix, [x1], attrs={"Primitive": True}):
+            with bb.dataflow():
+                lv = bb.emit(relax.call_tir(exp_gv, [x1], (10, 20), "float32"))
+                gv = bb.emit_output(relax.call_tir(exp_gv, [lv], (10, 20), "float32"))
+            bb.emit_func_output(gv)
+        layer_gvs.append(bb.get().get_global_var("fused_exp_" + suffix))
+
+    x = relax.Var("x", [10, 20], relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x]):
+        with bb.dataflow():
+            lv0 = bb.emit(relax.Call(layer_gvs[0], [x]))
+            lv1 = bb.emit(relax.Call(layer_gvs[1], [lv0]))
+            gv = bb.emit_output(lv1)
+        bb.emit_func_output(gv)
+
+    mod = relax.transform.FuseTIR()(bb.get())
+    prim_funcs = [f for f in mod.functions.values() if isinstance(f, tvm.tir.PrimFunc)]
+    assert len(prim_funcs) == 1
+    bindings = mod["main"].body.blocks[0].bindings
+    assert bindings[0].value.args[0].same_as(bindings[1].value.args[0])
+
+
 if __name__ == "__main__":
     sys.exit(pytest.main([__file__] + sys.argv[1:]))
@@ -0,0 +1,88 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import sys
+import pytest
+
+import numpy as np
+import tvm
+import tvm.testing
+from tvm import relax, topi
+
+
+def _build(fbody):
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [4, 8], relax.DynTensorType(2, "float32"))
+    w0 = relax.Var("w0", [8, 8], relax.DynTensorType(2, "float32"))
+    w1 = relax.Var("w1", [8, 8], relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x, w0, w1]):
+        with bb.dataflow():
+            gv = bb.emit_output(fbody(bb, x, w0, w1))
+        bb.emit_func_output(gv)
+    return bb.get()
+
+
+def _call_tirs(mod):
+    calls = []
+
+    def fvisit(e):
+        if isinstance(e, relax.Call) and e.op == tvm.ir.Op.get("relax.call_tir"):
+            calls.append(e)
+
+    relax.analysis.post_order_visit(mod["main"].body, fvisit)
+    return calls
+
+
+def _run(mod, *args):
+    ex = relax.vm.build(mod, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    return vm["main"](*[tvm.nd.array(a) for a in args]).numpy()
+
+
+def test_fuse_parallel_matmuls():
+    def fbody(bb, x, w0, w1):
+        lv0 = bb.emit_te(topi.nn.matmul, x, w0)
+        lv1 = bb.emit_te(topi.nn.matmul, x, w1)
+        return bb.emit_te(topi.add, lv0, lv1)
+
+    before = _build(fbody)
+    after = relax.transform.HorizontalFusion()(before)
+    fused, add = _call_tirs(after)
+    assert fused.args[0].name_hint == "fused_2x_matmul"
+    assert len(fused.args[1]) == 4
+    assert len(after[fused.args[0]].params) == 6
+
+    x_np = np.random.rand(4, 8).astype("float32")
+    w0_np = np.random.rand(8, 8).astype("float32")
+    w1_np = np.random.rand(8, 8).astype("float32")
+    tvm.testing.assert_allclose(
+        _run(after, x_np, w0_np, w1_np), _run(before, x_np, w0_np, w1_np), rtol=1e-5
+    )
+
+
+def test_dependent_calls_unchanged():
+    def fbody(bb, x, w0, w1):
+        lv0 = bb.emit_te(topi.nn.matmul, x, w0)
+        return bb.emit_te(topi.nn.matmul, lv0, w1)
+
+    before = _build(fbody)
+    after = relax.transform.HorizontalFusion()(before)
+    tvm.ir.assert_structural_equal(after, before)
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__] + sys.argv[1:]))
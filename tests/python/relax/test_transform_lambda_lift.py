@@ -291,5 +291,49 @@ def test_no_local_func():
     _check_save_roundtrip(after)
 
 
+def test_nested_closure_capture():
+    @tvm.script.ir_module
+    class Before:
+        @R.function
+        def main(
+            x: Tensor((2, 3), "float32"), y: Tensor((2, 3), "float32")
+        ) -> Tensor((2, 3), "float32"):
+            @R.function
+            def outer_func(a: Tensor((2, 3), "float32")):
+                @R.function
+                def inner_func(b: Tensor((2, 3), "float32")):
+                    # x is captured from two levels up, through the closure of outer_func
+                    s: Tensor((2, 3), "float32") = relax.add(b, x)
+                    t: Tensor((2, 3), "float32") = relax.add(s, a)
+                    return t
+
+                return inner_func
+
+            in_call = outer_func(y)
+            res = in_call(y)
+            return res
+
+    after = transform.LambdaLift()(Before)
+    assert len(after.functions) == 3
+    assert relax.analysis.well_formed(after)
+    free_vars = tvm.get_global_func("relax.analysis.free_vars")
+    for gv, func in after.functions.items():
+        assert not free_vars(func), gv.name_hint
+    # the closure of inner_func captures the parameters of the lifted outer_func
+    outer = after["lifted_func_0"]
+    closures = []
+    relax.analysis.post_order_visit(
+        outer.body,
+        lambda e: isinstance(e, relax.Call)
+        and e.op.same_as(tvm.ir.Op.get("relax.make_closure"))
+        and closures.append(e),
+    )
+    assert len(closures) == 1
+    captured = closures[0].args[1].fields
+    assert [v.name_hint for v in captured] == ["x", "a"]
+    assert all(any(v.same_as(p) for p in outer.params) for v in captured)
+    _check_save_roundtrip(after)
+
+
 if __name__ == "__main__":
     pytest.main((__file__))
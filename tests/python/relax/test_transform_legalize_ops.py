@@ -0,0 +1,338 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import sys
+import pytest
+
+import numpy as np
+import tvm
+import tvm.testing
+from tvm import relax, tir
+from tvm import meta_schedule as ms
+
+
+def _build(params, fbody):
+    bb = relax.BlockBuilder()
+    args = [
+        relax.Var(name, shape, relax.DynTensorType(len(shape), "float32")) for name, shape in params
+    ]
+    with bb.function("main", args):
+        with bb.dataflow():
+            gv = bb.emit_output(fbody(*args))
+        bb.emit_func_output(gv)
+    return bb.get()
+
+
+def _run(mod, *args):
+    ex = relax.vm.build(mod, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    return vm["main"](*[tvm.nd.array(a) for a in args]).numpy()
+
+
+def _ops(mod):
+    ops = []
+
+    def fvisit(e):
+        if isinstance(e, relax.Call) and isinstance(e.op, tvm.ir.Op):
+            ops.append(e.op.name)
+
+    relax.analysis.post_order_visit(mod["main"].body, fvisit)
+    return ops
+
+
+def test_shape_inference():
+    bb = relax.BlockBuilder()
+    n = tir.Var("n", "int64")
+    x = relax.Var("x", [n, 3, 32, 32], relax.DynTensorType(4, "float32"))
+    w = relax.Var("w", [8, 3, 3, 3], relax.DynTensorType(4, "float32"))
+    with bb.function("main", [x, w]):
+        conv = bb.emit(relax.nn.conv2d(x, w, strides=2, padding=1))
+        softmax = bb.emit(relax.nn.softmax(conv, axis=1))
+        bb.emit_func_output(softmax)
+    tvm.ir.assert_structural_equal(conv.shape, relax.ShapeExpr([n, 8, 16, 16]))
+    tvm.ir.assert_structural_equal(softmax.shape, conv.shape)
+    assert conv.checked_type.ndim == 4 and conv.checked_type.dtype == "float32"
+
+
+def test_legalize_conv2d_relu():
+    mod = _build(
+        [("x", [1, 4, 8, 8]), ("w", [6, 2, 3, 3])],
+        lambda x, w: relax.nn.relu(relax.nn.conv2d(x, w, padding=1, groups=2)),
+    )
+    after = relax.transform.LegalizeOps()(mod)
+    assert _ops(after) == ["relax.call_tir", "relax.call_tir"]
+
+    x_np = np.random.rand(1, 4, 8, 8).astype("float32")
+    w_np = np.random.rand(6, 2, 3, 3).astype("float32") - 0.5
+    padded = np.pad(x_np, ((0, 0), (0, 0), (1, 1), (1, 1)))
+    expected = np.zeros((1, 6, 8, 8), "float32")
+    for o in range(6):
+        g = o // 3
+        for i in range(8):
+            for j in range(8):
+                window = padded[0, 2 * g : 2 * g + 2, i : i + 3, j : j + 3]
+                expected[0, o, i, j] = np.sum(window * w_np[o])
+    tvm.testing.assert_allclose(_run(after, x_np, w_np), np.maximum(expected, 0), rtol=1e-5)
+
+
+def test_legalize_matmul_softmax():
+    mod = _build(
+        [("x", [2, 4, 8]), ("w", [8, 16])],
+        lambda x, w: relax.nn.softmax(relax.matmul(x, w)),
+    )
+    after = relax.transform.LegalizeOps()(mod)
+    x_np = np.random.rand(2, 4, 8).astype("float32")
+    w_np = np.random.rand(8, 16).astype("float32")
+    logits = x_np @ w_np
+    expected = np.exp(logits - logits.max(-1, keepdims=True))
+    expected /= expected.sum(-1, keepdims=True)
+    tvm.testing.assert_allclose(_run(after, x_np, w_np), expected, rtol=1e-5)
+
+
+def test_legalize_layer_norm():
+    mod = _build(
+        [("x", [4, 16]), ("gamma", [16]), ("beta", [16])],
+        lambda x, gamma, beta: relax.nn.layer_norm(x, gamma, beta, epsilon=1e-5),
+    )
+    after = relax.transform.LegalizeOps()(mod)
+    x_np = np.random.rand(4, 16).astype("float32")
+    gamma_np = np.random.rand(16).astype("float32")
+    beta_np = np.random.rand(16).astype("float32")
+    mean = x_np.mean(-1, keepdims=True)
+    var = x_np.var(-1, keepdims=True)
+    expected = (x_np - mean) / np.sqrt(var + 1e-5) * gamma_np + beta_np
+    tvm.testing.assert_allclose(
+        _run(after, x_np, gamma_np, beta_np), expected, rtol=1e-4, atol=1e-5
+    )
+
+
+def _to_bsr(dense, bs_r, bs_c):
+    """The blocks, block columns and row offsets of the nonzero blocks of a dense matrix."""
+    rows, cols = dense.shape
+    blocks = dense.reshape(rows // bs_r, bs_r, cols // bs_c, bs_c).transpose(0, 2, 1, 3)
+    nonzero = np.abs(blocks).sum(axis=(2, 3)) != 0
+    data = blocks[nonzero]
+    indices = np.nonzero(nonzero)[1].astype("int32")
+    indptr = np.concatenate([[0], np.cumsum(nonzero.sum(axis=1))]).astype("int32")
+    return data, indices, indptr
+
+
+def _random_sparse(rows, cols, density, bs_r=1, bs_c=1):
+    mask = np.random.rand(rows // bs_r, cols // bs_c) < density
+    mask = np.repeat(np.repeat(mask, bs_r, axis=0), bs_c, axis=1)
+    return np.random.rand(rows, cols).astype("float32") * mask
+
+
+def _build_sparse(fop, dense_shape, data_shape):
+    bb = relax.BlockBuilder()
+    nnz = tir.Var("nnz", "int64")
+    x = relax.Var("x", dense_shape, relax.DynTensorType(2, "float32"))
+    data_type = relax.DynTensorType(1 + len(data_shape), "float32")
+    data = relax.Var("data", [nnz, *data_shape], data_type)
+    indices = relax.Var("indices", [nnz], relax.DynTensorType(1, "int32"))
+    indptr = relax.Var("indptr", [9], relax.DynTensorType(1, "int32"))
+    with bb.function("main", [x, data, indices, indptr]):
+        with bb.dataflow():
+            gv = bb.emit_output(fop(x, data, indices, indptr))
+        bb.emit_func_output(gv)
+    return gv, relax.transform.LegalizeOps()(bb.get())
+
+
+def test_legalize_sparse_dense_csr():
+    gv, mod = _build_sparse(relax.sparse_dense, [4, 16], [])
+    tvm.ir.assert_structural_equal(gv.shape, relax.ShapeExpr([4, 8]))
+    assert _ops(mod) == ["relax.call_tir"]
+    x_np = np.random.rand(4, 16).astype("float32")
+    # the same kernel runs for any number of nonzeros
+    for density in [0.1, 0.5, 1.0]:
+        w_np = _random_sparse(8, 16, density)
+        data, indices, indptr = _to_bsr(w_np, 1, 1)
+        out = _run(mod, x_np, data.reshape(-1), indices, indptr)
+        tvm.testing.assert_allclose(out, x_np @ w_np.T, rtol=1e-5)
+
+
+def test_legalize_sparse_dense_bsr():
+    gv, mod = _build_sparse(relax.sparse_dense, [4, 16], [2, 4])
+    tvm.ir.assert_structural_equal(gv.shape, relax.ShapeExpr([4, 16]))
+    x_np = np.random.rand(4, 16).astype("float32")
+    w_np = _random_sparse(16, 16, 0.5, 2, 4)
+    out = _run(mod, x_np, *_to_bsr(w_np, 2, 4))
+    tvm.testing.assert_allclose(out, x_np @ w_np.T, rtol=1e-5)
+
+
+def test_legalize_sparse_add():
+    gv, mod = _build_sparse(relax.sparse_add, [8, 16], [])
+    tvm.ir.assert_structural_equal(gv.shape, relax.ShapeExpr([8, 16]))
+    x_np = np.random.rand(8, 16).astype("float32")
+    w_np = _random_sparse(8, 16, 0.3)
+    data, indices, indptr = _to_bsr(w_np, 1, 1)
+    out = _run(mod, x_np, data.reshape(-1), indices, indptr)
+    tvm.testing.assert_allclose(out, x_np + w_np, rtol=1e-5)
+
+
+def _attention_np(q, k_t, v, scale):
+    scores = q @ k_t * scale
+    probs = np.exp(scores - scores.max(-1, keepdims=True))
+    return probs / probs.sum(-1, keepdims=True) @ v
+
+
+def test_legalize_attention():
+    mod = _build(
+        [("q", [2, 100, 16]), ("k", [2, 16, 70]), ("v", [2, 70, 8])],
+        lambda q, k, v: relax.nn.attention(q, k, v),
+    )
+    after = relax.transform.LegalizeOps()(mod)
+    assert _ops(after) == ["relax.call_tir"]
+    q_np = np.random.rand(2, 100, 16).astype("float32")
+    k_np = np.random.rand(2, 16, 70).astype("float32")
+    v_np = np.random.rand(2, 70, 8).astype("float32")
+    expected = _attention_np(q_np, k_np, v_np, 0.25)
+    tvm.testing.assert_allclose(_run(after, q_np, k_np, v_np), expected, rtol=1e-5)
+
+
+def test_legalize_attention_dynamic_sequence():
+    bb = relax.BlockBuilder()
+    n = tir.Var("n", "int64")
+    q = relax.Var("q", [1, n, 16], relax.DynTensorType(3, "float32"))
+    k = relax.Var("k", [1, 16, n], relax.DynTensorType(3, "float32"))
+    v = relax.Var("v", [1, n, 16], relax.DynTensorType(3, "float32"))
+    with bb.function("main", [q, k, v]):
+        with bb.dataflow():
+            gv = bb.emit_output(relax.nn.attention(q, k, v, scale=0.5))
+        bb.emit_func_output(gv)
+    tvm.ir.assert_structural_equal(gv.shape, relax.ShapeExpr([1, n, 16]))
+    after = relax.transform.LegalizeOps()(bb.get())
+    for seq_len in [1, 65, 130]:
+        q_np = np.random.rand(1, seq_len, 16).astype("float32")
+        k_np = np.random.rand(1, 16, seq_len).astype("float32")
+        v_np = np.random.rand(1, seq_len, 16).astype("float32")
+        expected = _attention_np(q_np, k_np, v_np, 0.5)
+        tvm.testing.assert_allclose(_run(after, q_np, k_np, v_np), expected, rtol=1e-5)
+
+
+def test_fuse_attention():
+    scale = relax.const(0.125, "float32")
+    mod = _build(
+        [("q", [4, 32, 64]), ("k", [4, 64, 32]), ("v", [4, 32, 64])],
+        lambda q, k, v: relax.matmul(
+            relax.nn.softmax(relax.multiply(relax.matmul(q, k), scale)), v
+        ),
+    )
+    fused = relax.transform.DeadCodeElimination()(relax.transform.FuseAttention()(mod))
+    assert _ops(fused) == ["relax.nn.attention"]
+    q_np = np.random.rand(4, 32, 64).astype("float32")
+    k_np = np.random.rand(4, 64, 32).astype("float32")
+    v_np = np.random.rand(4, 32, 64).astype("float32")
+    expected = _attention_np(q_np, k_np, v_np, 0.125)
+    after = relax.transform.LegalizeOps()(fused)
+    tvm.testing.assert_allclose(_run(after, q_np, k_np, v_np), expected, rtol=1e-5)
+
+
+def _embedding_bag_np(weight, indices, mode):
+    return {"sum": np.sum, "mean": np.mean, "max": np.max}[mode](weight[indices], axis=1)
+
+
+@pytest.mark.parametrize("mode", ["sum", "mean", "max"])
+def test_legalize_embedding_bag(mode):
+    bb = relax.BlockBuilder()
+    n = tir.Var("n", "int64")
+    w = relax.Var("w", [1000, 32], relax.DynTensorType(2, "float32"))
+    idx = relax.Var("idx", [n, 6], relax.DynTensorType(2, "int64"))
+    with bb.function("main", [w, idx]):
+        with bb.dataflow():
+            gv = bb.emit_output(relax.nn.embedding_bag(w, idx, mode))
+        bb.emit_func_output(gv)
+    tvm.ir.assert_structural_equal(gv.shape, relax.ShapeExpr([n, 32]))
+    after = relax.transform.LegalizeOps()(bb.get())
+    assert _ops(after) == ["relax.call_tir"]
+    weight = np.random.rand(1000, 32).astype("float32")
+    for num_bags in [1, 37]:
+        indices = np.random.randint(0, 1000, size=(num_bags, 6)).astype("int64")
+        expected = _embedding_bag_np(weight, indices, mode)
+        tvm.testing.assert_allclose(_run(after, weight, indices), expected, rtol=1e-5)
+
+
+def test_embedding_bag_cpu_schedule():
+    bb = relax.BlockBuilder()
+    w = relax.Var("w", [1000, 32], relax.DynTensorType(2, "float32"))
+    idx = relax.Var("idx", [50, 8], relax.DynTensorType(2, "int64"))
+    with bb.function("main", [w, idx]):
+        with bb.dataflow():
+            gv = bb.emit_output(relax.nn.embedding_bag(w, idx))
+        bb.emit_func_output(gv)
+    with tvm.target.Target("llvm"):
+        after = relax.transform.LegalizeOps()(bb.get())
+    gv = [gv for gv, func in after.functions.items() if isinstance(func, tir.PrimFunc)][0]
+    sch = tir.Schedule(after[gv])
+    block = sch.get_block("embedding_bag")
+    rule = sch.get(block).annotations["schedule_rule"]
+    assert rule == "meta_schedule.embedding_bag.llvm"
+    (sch,) = tvm.get_global_func(rule)(sch, block)
+    assert "tir.prefetch" in str(tvm.lower(sch.mod))
+    after[gv] = sch.mod["main"]
+    weight = np.random.rand(1000, 32).astype("float32")
+    indices = np.random.randint(0, 1000, size=(50, 8)).astype("int64")
+    expected = _embedding_bag_np(weight, indices, "sum")
+    tvm.testing.assert_allclose(_run(after, weight, indices), expected, rtol=1e-5)
+
+
+def test_customize_legalize_map():
+    mod = _build([("x", [4, 4]), ("y", [4, 4])], relax.add)
+    after = relax.transform.LegalizeOps({"relax.add": lambda bb, call: call.args[0]})(mod)
+    assert "relax.call_tir" not in _ops(after)
+
+
+def test_op_strategy():
+    mod = _build([("x", [4, 4])], relax.nn.relu)
+    target = tvm.target.Target("llvm")
+
+    @relax.transform.register_strategy("relax.nn.relu", "llvm", "test_op_strategy", priority=100)
+    def identity(bb, call, target):  # pylint: disable=unused-argument
+        return call.args[0]
+
+    try:
+        # the target implementation is tried first
+        assert "relax.call_tir" not in _ops(relax.transform.LegalizeOps(target=target)(mod))
+        # the default kernel is kept once it is tuned
+        database = ms.database.MemoryDatabase()
+        default = relax.transform.LegalizeOps()(mod)
+        kernel = [func for func in default.functions.values() if isinstance(func, tir.PrimFunc)]
+        database.commit_workload(tvm.IRModule({"main": kernel[0]}))
+        after = relax.transform.LegalizeOps(target=target, database=database)(mod)
+        assert _ops(after) == ["relax.call_tir"]
+        # the default kernel without a target
+        assert _ops(relax.transform.LegalizeOps()(mod)) == ["relax.call_tir"]
+    finally:
+        strategies = relax.transform.op_strategy.OP_STRATEGY_TABLE[("relax.nn.relu", "llvm")]
+        strategies[:] = [entry for entry in strategies if entry[1] != "test_op_strategy"]
+
+
+def test_op_strategy_cblas():
+    if not tvm.get_global_func("tvm.contrib.cblas.matmul", True):
+        print("skip because extern function is not available")
+        return
+    mod = _build([("x", [16, 32]), ("w", [32, 8])], relax.matmul)
+    after = relax.transform.LegalizeOps(target=tvm.target.Target("llvm"))(mod)
+    kernels = [func for func in after.functions.values() if isinstance(func, tir.PrimFunc)]
+    assert len(kernels) == 1 and "tvm.contrib.cblas.matmul" in str(kernels[0])
+    x_np = np.random.rand(16, 32).astype("float32")
+    w_np = np.random.rand(32, 8).astype("float32")
+    tvm.testing.assert_allclose(_run(after, x_np, w_np), x_np @ w_np, rtol=1e-5)
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__] + sys.argv[1:]))
@@ -0,0 +1,103 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+from __future__ import annotations  # must import to defer parsing of annotations
+import sys
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax
+import numpy as np
+
+import tvm.script
+from tvm.script import tir as T, relax as R
+
+
+@tvm.script.ir_module
+class InputModule:
+    @T.prim_func
+    def tir_matmul(x: T.handle, y: T.handle, z: T.handle) -> None:
+        T.func_attr({"global_symbol": "tir_matmul"})
+        A = T.match_buffer(x, (4, 16))
+        B = T.match_buffer(y, (16, 16))
+        C = T.match_buffer(z, (4, 16))
+        for i, j, k in T.grid(4, 16, 16):
+            with T.block("matmul"):
+                vi, vj, vk = T.axis.remap("SSR", [i, j, k])
+                with T.init():
+                    C[vi, vj] = T.float32(0)
+                C[vi, vj] = C[vi, vj] + A[vi, vk] * B[vk, vj]
+
+    @R.function
+    def main(x: Tensor((4, 16), "float32"), w: Tensor((16, 16), "float32")):
+        gv0 = R.call_tir(tir_matmul, (x, w), (4, 16), dtype="float32")
+        return gv0
+
+
+def _run(mod, x_np):
+    target = tvm.target.Target("llvm")
+    vm = relax.VirtualMachine(relax.vm.build(mod, target), tvm.cpu())
+    return vm["main"](tvm.nd.array(x_np)).numpy()
+
+
+def _dequantize(w_np, bits, group_size):
+    max_value = 127 if bits == 8 else 7
+    groups = w_np.reshape(-1, group_size or 16, 16)
+    scale = np.abs(groups).max(axis=1, keepdims=True) / max_value
+    levels = np.clip(np.round(groups / scale), -max_value, max_value)
+    return (levels * scale).reshape(16, 16)
+
+
+@pytest.mark.parametrize("bits, group_size", [(8, 0), (4, 0), (4, 8)])
+def test_quantize_matmul(bits, group_size):
+    x_np = np.random.rand(4, 16).astype(np.float32)
+    w_np = np.random.uniform(-1, 1, (16, 16)).astype(np.float32)
+    before = relax.transform.BindParams("main", {"w": w_np})(InputModule)
+    after = relax.transform.QuantizeWeights(bits, group_size)(before)
+
+    call = after["main"].body.blocks[0].bindings[0].value
+    assert call.args[0].name_hint == "tir_matmul_int%d" % bits
+    data, scale = call.args[1][1], call.args[1][2]
+    if bits == 8:
+        assert data.data.dtype == "int8" and data.data.shape == (16, 16)
+    else:
+        assert data.data.dtype == "uint8" and data.data.shape == (16, 8)
+    assert scale.data.shape == (16, 16 // group_size if group_size else 1)
+
+    expected = x_np @ _dequantize(w_np, bits, group_size)
+    tvm.testing.assert_allclose(_run(after, x_np), expected, rtol=1e-5, atol=1e-5)
+    tvm.testing.assert_allclose(_run(after, x_np), x_np @ w_np, rtol=0.2, atol=0.2)
+
+
+def test_calibrate():
+    w_np = np.random.uniform(-1, 1, (16, 16)).astype(np.float32)
+    before = relax.transform.BindParams("main", {"w": w_np})(InputModule)
+    calls = []
+
+    def fcalibrate(kernel, weight, reduction_axis):
+        calls.append((kernel, reduction_axis))
+        tvm.testing.assert_allclose(weight.numpy(), w_np)
+        return -1
+
+    after = relax.transform.QuantizeWeights(8, 0, fcalibrate)(before)
+    assert calls == [("tir_matmul", 0)]
+    tvm.ir.assert_structural_equal(after, before)
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__] + sys.argv[1:]))
@@ -0,0 +1,88 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import sys
+import pytest
+
+import numpy as np
+import tvm
+import tvm.testing
+from tvm import relax, topi
+
+
+def _build():
+    # lv0 and lv1 are live across lv3, where four tensors of 128 bytes are live.
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [4, 8], relax.DynTensorType(2, "float32"))
+    w = relax.Var("w", [8, 8], relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x, w]):
+        with bb.dataflow():
+            lv0 = bb.emit_te(topi.exp, x)
+            lv1 = bb.emit_te(topi.nn.matmul, lv0, w)
+            lv2 = bb.emit_te(topi.nn.matmul, lv1, w)
+            lv3 = bb.emit_te(topi.nn.matmul, lv2, w)
+            lv4 = bb.emit_te(topi.add, lv3, lv1)
+            gv = bb.emit_output(bb.emit_te(topi.add, lv4, lv0))
+        bb.emit_func_output(gv)
+    return bb.get()
+
+
+def _kernels(mod):
+    kernels = []
+
+    def fvisit(e):
+        if isinstance(e, relax.Call) and e.op == tvm.ir.Op.get("relax.call_tir"):
+            kernels.append(e.args[0].name_hint)
+
+    relax.analysis.post_order_visit(mod["main"].body, fvisit)
+    return kernels
+
+
+def _run(mod, *args):
+    ex = relax.vm.build(mod, tvm.target.Target("llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    return vm["main"](*[tvm.nd.array(a) for a in args]).numpy()
+
+
+def test_rematerialize_elementwise():
+    before = _build()
+    after = relax.transform.Rematerialize(384)(before)
+    # Only the elementwise exp is recomputed, the matmul producing lv1 is not.
+    assert _kernels(after) == ["exp", "matmul", "matmul", "matmul", "add", "exp", "add"]
+    assert relax.analysis.well_formed(after)
+
+    x_np = np.random.rand(4, 8).astype("float32")
+    w_np = np.random.rand(8, 8).astype("float32")
+    tvm.testing.assert_allclose(_run(after, x_np, w_np), _run(before, x_np, w_np), rtol=1e-5)
+
+
+def test_within_budget_unchanged():
+    before = _build()
+    after = relax.transform.Rematerialize(512)(before)
+    tvm.ir.assert_structural_equal(after, before)
+
+
+def test_unreachable_budget():
+    before = _build()
+    # Recomputing exp is the best the pass can do, the matmuls are not recomputed.
+    after = relax.transform.Rematerialize(128)(before)
+    assert _kernels(after).count("exp") == 2
+    assert _kernels(after).count("matmul") == 3
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__] + sys.argv[1:]))
@@ -0,0 +1,114 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+from __future__ import annotations  # must import to defer parsing of annotations
+import sys
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax
+import numpy as np
+
+import tvm.script
+from tvm.script import tir as T, relax as R
+
+
+@tvm.script.ir_module
+class InputModule:
+    @T.prim_func
+    def tir_matmul(
+        A: T.Buffer[(16, 16), "float32"],
+        B: T.Buffer[(16, 16), "float32"],
+        C: T.Buffer[(16, 16), "float32"],
+    ) -> None:
+        T.func_attr({"global_symbol": "tir_matmul", "layout_free_buffers": [1]})
+        B_ = T.alloc_buffer([16, 4, 4], dtype="float32")
+        for i0_o, i1_o in T.grid(16, 16):
+            with T.block("layout_rewrite"):
+                i0, i1 = T.axis.remap("SS", [i0_o, i1_o])
+                T.reads(B[i0, i1])
+                T.writes(B_[i1, i0 // 4, i0 % 4])
+                T.block_attr({"meta_schedule.layout_rewrite_preproc": True})
+                B_[i1, i0 // 4, i0 % 4] = B[i0, i1]
+        for i0, j, k0, i1, k1 in T.grid(4, 16, 4, 4, 4):
+            with T.block("matmul"):
+                vi = T.axis.spatial(16, i0 * 4 + i1)
+                vj = T.axis.spatial(16, j)
+                vk = T.axis.reduce(16, k0 * 4 + k1)
+                T.reads(A[vi, vk], B_[vj, vk // 4, vk % 4])
+                T.writes(C[vi, vj])
+                with T.init():
+                    C[vi, vj] = T.float32(0)
+                C[vi, vj] = C[vi, vj] + A[vi, vk] * B_[vj, vk // 4, vk % 4]
+
+    @R.function
+    def main(x: Tensor((16, 16), "float32"), w: Tensor((16, 16), "float32")):
+        gv0 = R.call_tir(tir_matmul, (x, w), (16, 16), dtype="float32")
+        return gv0
+
+
+def _run(mod, *args):
+    target = tvm.target.Target("llvm")
+    vm = relax.VirtualMachine(relax.vm.build(mod, target), tvm.cpu())
+    return vm["main"](*[tvm.nd.array(arg) for arg in args]).numpy()
+
+
+def test_split_layout_rewrite():
+    after = relax.transform.SplitLayoutRewritePreproc()(InputModule)
+    compute = after["tir_matmul"]
+    assert "layout_free_buffers" not in compute.attrs
+    assert list(compute.buffer_map[compute.params[1]].shape) == [16, 4, 4]
+    preproc = after["tir_matmul_weight_layout_rewrite0"]
+    assert list(preproc.buffer_map[preproc.params[0]].shape) == [16, 16]
+    assert list(preproc.buffer_map[preproc.params[1]].shape) == [16, 4, 4]
+
+    bindings = after["main"].body.blocks[0].bindings
+    assert len(bindings) == 2
+    assert bindings[0].value.args[0].name_hint == "tir_matmul_weight_layout_rewrite0"
+    assert bindings[1].value.args[1][1].same_as(bindings[0].var)
+
+    x_np = np.random.rand(16, 16).astype(np.float32)
+    w_np = np.random.rand(16, 16).astype(np.float32)
+    tvm.testing.assert_allclose(_run(after, x_np, w_np), x_np @ w_np, rtol=1e-5)
+
+
+def test_fold_layout_rewrite_of_constant():
+    w_np = np.random.rand(16, 16).astype(np.float32)
+    before = relax.transform.BindParams("main", {"w": w_np})(InputModule)
+    after = relax.transform.SplitLayoutRewritePreproc()(before)
+    after = relax.transform.FoldConstant()(after)
+
+    # the folded binding of the packed weight is left to DeadCodeElimination
+    packed = after["main"].body.blocks[0].bindings[-1].value.args[1][1]
+    assert isinstance(packed, relax.Constant)
+    np.testing.assert_array_equal(
+        packed.data.numpy(), w_np.T.reshape(16, 4, 4), "weight is packed at build time"
+    )
+
+    x_np = np.random.rand(16, 16).astype(np.float32)
+    tvm.testing.assert_allclose(_run(after, x_np), x_np @ w_np, rtol=1e-5)
+
+
+def test_keep_kernel_without_layout_rewrite():
+    mod = tvm.tir.transform.RemoveWeightLayoutRewriteBlock()(InputModule)
+    after = relax.transform.SplitLayoutRewritePreproc()(mod)
+    tvm.ir.assert_structural_equal(after, mod)
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__] + sys.argv[1:]))
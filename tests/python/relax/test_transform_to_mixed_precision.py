@@ -0,0 +1,131 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+from __future__ import annotations  # must import to defer parsing of annotations
+import sys
+import pytest
+
+import tvm
+import tvm.testing
+from tvm import relax
+import numpy as np
+
+import tvm.script
+from tvm.script import tir as T, relax as R
+
+
+@tvm.script.ir_module
+class InputModule:
+    @T.prim_func
+    def tir_matmul(x: T.handle, y: T.handle, z: T.handle) -> None:
+        T.func_attr({"global_symbol": "tir_matmul"})
+        A = T.match_buffer(x, (16, 16))
+        B = T.match_buffer(y, (16, 16))
+        C = T.match_buffer(z, (16, 16))
+        for i, j, k in T.grid(16, 16, 16):
+            with T.block("matmul"):
+                vi, vj, vk = T.axis.remap("SSR", [i, j, k])
+                with T.init():
+                    C[vi, vj] = T.float32(0)
+                C[vi, vj] = C[vi, vj] + A[vi, vk] * B[vk, vj]
+
+    @T.prim_func
+    def tir_exp(x: T.handle, y: T.handle) -> None:
+        T.func_attr({"global_symbol": "tir_exp"})
+        A = T.match_buffer(x, (16, 16))
+        B = T.match_buffer(y, (16, 16))
+        for i, j in T.grid(16, 16):
+            with T.block("exp"):
+                vi, vj = T.axis.remap("SS", [i, j])
+                B[vi, vj] = T.exp(A[vi, vj])
+
+    @R.function
+    def main(
+        x: Tensor((16, 16), "float32"), w: Tensor((16, 16), "float32")
+    ) -> Tensor((16, 16), "float32"):
+        with R.dataflow():
+            lv0 = R.call_tir(tir_matmul, (x, w), (16, 16), dtype="float32")
+            lv1 = R.call_tir(tir_exp, (lv0,), (16, 16), dtype="float32")
+            R.output(lv1)
+        return lv1
+
+
+def _bound_module(w_np):
+    return relax.transform.BindParams("main", {"w": w_np})(InputModule)
+
+
+def _call_tirs(func):
+    calls = []
+
+    def fvisit(e):
+        if isinstance(e, relax.Call) and e.op == tvm.ir.Op.get("relax.call_tir"):
+            calls.append(e)
+
+    relax.analysis.post_order_visit(func.body, fvisit)
+    return calls
+
+
+@pytest.mark.parametrize("dtype", ["float16", "bfloat16"])
+def test_convert_matmul(dtype):
+    w_np = np.random.rand(16, 16).astype(np.float32)
+    mod = relax.transform.ToMixedPrecision(dtype)(_bound_module(w_np))
+
+    cast, matmul, exp = _call_tirs(mod["main"])
+    cast_func = mod[cast.args[0]]
+    assert cast_func.buffer_map[cast_func.params[1]].dtype == dtype
+    matmul_func = mod[matmul.args[0]]
+    assert matmul.args[0].name_hint == "tir_matmul_" + dtype
+    assert [matmul_func.buffer_map[p].dtype for p in matmul_func.params] == [
+        dtype,
+        dtype,
+        "float32",
+    ]
+    assert cast.args[1][0].same_as(mod["main"].params[0])
+    assert matmul.args[1][0].checked_type.dtype == dtype
+    assert matmul.args[1][1].data.dtype == dtype
+    assert matmul.checked_type.dtype == "float32"
+    # The exp is numerically sensitive and stays in float32.
+    assert exp.args[0].name_hint == "tir_exp"
+
+
+def test_result_close():
+    x_np = np.random.rand(16, 16).astype(np.float32)
+    w_np = np.random.rand(16, 16).astype(np.float32)
+    mod = relax.transform.ToMixedPrecision()(_bound_module(w_np))
+
+    target = tvm.target.Target("llvm")
+    vm = relax.VirtualMachine(relax.vm.build(mod, target), tvm.cpu())
+    res = vm["main"](tvm.nd.array(x_np))
+    tvm.testing.assert_allclose(res.numpy(), np.exp(x_np @ w_np), rtol=1e-2)
+
+
+def test_policy_never():
+    w_np = np.random.rand(16, 16).astype(np.float32)
+    before = _bound_module(w_np)
+    after = relax.transform.ToMixedPrecision(policy={"tir_matmul": "never"})(before)
+    tvm.ir.assert_structural_equal(after, before)
+
+
+def test_policy_always():
+    w_np = np.random.rand(16, 16).astype(np.float32)
+    mod = relax.transform.ToMixedPrecision(policy={"tir_exp": "always"})(_bound_module(w_np))
+    names = [call.args[0].name_hint for call in _call_tirs(mod["main"])]
+    assert names == ["cast_float16", "tir_matmul_float16", "cast_float16", "tir_exp_float16"]
+
+
+if __name__ == "__main__":
+    sys.exit(pytest.main([__file__] + sys.argv[1:]))
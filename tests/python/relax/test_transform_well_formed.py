@@ -207,5 +207,34 @@ def test_ANF():
     assert not rx.analysis.well_formed(mod)
 
 
+def test_incremental_instrument():
+    from tvm.relax.ir.instrument import IncrementalWellFormedInstrument
+
+    bb = rx.BlockBuilder()
+    y = rx.Var("y", [m, n], type_anno)
+    with bb.function("callee", [y]):
+        gv = bb.emit(rx.op.add(y, y))
+        bb.emit_func_output(gv)
+    callee = bb.get().get_global_var("callee")
+    with bb.function("main", [y]):
+        gv = bb.emit(rx.Call(callee, [y]))
+        bb.emit_func_output(gv)
+    mod = bb.get()
+
+    @tvm.transform.module_pass(opt_level=0)
+    def identity(mod, ctx):
+        return mod
+
+    @tvm.transform.module_pass(opt_level=0)
+    def remove_callee(mod, ctx):
+        return tvm.IRModule({mod.get_global_var("main"): mod["main"]})
+
+    with tvm.transform.PassContext(instruments=[IncrementalWellFormedInstrument()]):
+        identity(identity(mod))
+        # main is unchanged, but the GlobalVar it refers to is no longer defined.
+        with pytest.raises(tvm.TVMError):
+            remove_callee(mod)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
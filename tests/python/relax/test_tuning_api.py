@@ -19,6 +19,7 @@ from __future__ import annotations
 import pytest
 import numpy as np
 import os.path as osp
+import copy
 import tempfile
 from typing import List
 from math import isclose
@@ -30,6 +31,7 @@ from tvm.ir.transform import PassContext
 from tvm.ir.module import IRModule
 from tvm.script import tir as T, relax as R
 from tvm import relax
+from tvm import meta_schedule as ms
 from tvm.relax.expr import Expr, DataflowBlock, Function
 from tvm.relax.transform.tuning_api import (
     Choice,
@@ -37,11 +39,14 @@ from tvm.relax.transform.tuning_api import (
     Trace,
     TuningRecord,
     JSONDatabase,
+    IndexedDatabase,
     default_generate_candidate,
     default_consider_eval_passes,
     default_evaluate,
     select_best_candidate,
     get_trace,
+    fusion_knob,
+    FuseOpsTuningPass,
 )
 
 
@@ -382,6 +387,78 @@ def test_database():
         assert len(new_tuning_records) == 0
 
 
+def test_indexed_database():
+    mod1, mod2 = setup_test_const_folding()
+    knob = Knob("test", {"noapply": Choice()})
+    trace = Trace(mod1, [knob, knob], ["noapply", "noapply"])
+    target = tvm.target.Target("llvm")
+    run_secs = [1.0, 0.9, 0.4]
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        path = osp.join(tmpdir, "db")
+        database = IndexedDatabase(path)
+        workload1 = database.commit_workload(mod1)
+        assert database.has_workload(mod1)
+        assert not database.has_workload(mod2)
+        database.commit_measurement_record(workload1, target, run_secs)
+        database.commit_tuning_record(workload1, target, TuningRecord(trace, [2.0]))
+        database.commit_tuning_record(workload1, target, TuningRecord(trace, run_secs))
+
+        # A second handle, e.g. of a concurrent tuner, sees the records through the index.
+        reopened = IndexedDatabase(path, allow_missing=False)
+        workload2 = reopened.commit_workload(mod2)
+        assert database.has_workload(mod2)
+        assert reopened.has_measurement_record(workload1, target)
+        assert not reopened.has_measurement_record(workload2, target)
+        assert not reopened.has_tuning_record(workload1, tvm.target.Target("cuda"))
+        new_run_secs = reopened.get_measurement_record(workload1, target)
+        assert [round(float(sec), 5) for sec in new_run_secs] == run_secs
+        records = reopened.get_top_k(workload1, target, top_k=2)
+        assert len(records) == 2
+        assert str(records[0].trace) == str(trace)
+        assert isclose(records[0].run_secs[0], 1.0, rel_tol=1e-5)
+        assert isclose(records[1].run_secs[0], 2.0, rel_tol=1e-5)
+
+
+def test_shared_workloads():
+    from tvm import meta_schedule as ms  # pylint: disable=import-outside-toplevel
+
+    mod1, _ = setup_test_const_folding()
+    with tempfile.TemporaryDirectory() as tmpdir:
+        ms_database = ms.database.JSONDatabase(
+            osp.join(tmpdir, "ms_workloads.json"), osp.join(tmpdir, "ms_tuning_records.json")
+        )
+        relax_database = create_tmp_database(tmpdir)
+        indexed_database = IndexedDatabase(osp.join(tmpdir, "db"))
+        workload = ms_database.commit_workload(mod1)
+        size = ms.database.WorkloadRegistry.size()
+        # The databases share the workload of a module, instead of holding a copy each.
+        assert relax_database.commit_workload(mod1).same_as(workload)
+        assert indexed_database.commit_workload(mod1).same_as(workload)
+        assert relax_database.commit_workload(copy.deepcopy(mod1)).same_as(workload)
+        assert ms.database.WorkloadRegistry.size() == size
+
+
+def test_default_evaluate_batched():
+    mod = setup_test()
+    choices = {"apply": Choice("testing.apply_fold_constant"), "noapply": Choice()}
+    knob = Knob("TestKnob", choices)
+    trace = Trace(mod)
+
+    with tempfile.TemporaryDirectory() as tmpdir:
+        database = create_tmp_database(tmpdir)
+        with transform.PassContext(trace=trace, tuning_api_database=database):
+            # Both knobs are the same, so the four candidates hold two distinct workloads.
+            candidates = default_generate_candidate([knob, knob], trace)
+            assert len(candidates) == 4
+            default_evaluate(candidates, "llvm --num-cores=16", max_workers=2)
+            assert PassContext.current().num_evals == 4
+            assert all(candidate.perf != -1 for candidate in candidates)
+            workloads = {tvm.ir.structural_hash(c.out_mod): c.perf for c in candidates}
+            for candidate in candidates:
+                assert candidate.perf == workloads[tvm.ir.structural_hash(candidate.out_mod)]
+
+
 def test_default_functions():
     mod = setup_test()
     assert isinstance(mod, tvm.IRModule)
@@ -779,5 +856,68 @@ def test_passes_with_mixed_granularities():
         assert PassContext.current().get_trace_stack_size() == 1
 
 
+def setup_fusion_test():
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [16, 16], relax.DynTensorType(2, "float32"))
+    w = relax.Var("w", [16, 16], relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x, w]):
+        with bb.dataflow():
+            lv0 = bb.emit_te(tvm.topi.nn.matmul, x, w)
+            lv1 = bb.emit_te(tvm.topi.add, lv0, x)
+            gv = bb.emit_output(bb.emit_te(tvm.topi.nn.relu, lv1))
+        bb.emit_func_output(gv)
+    return relax.transform.AnnotateTIROpPattern()(bb.get())
+
+
+def num_prim_funcs(mod):
+    return sum(isinstance(func, tvm.tir.PrimFunc) for func in mod.functions.values())
+
+
+def test_fusion_knob():
+    mod = setup_fusion_test()
+    knob = fusion_knob()
+    candidates = default_generate_candidate([knob], Trace(mod))
+    assert len(candidates) == len(knob.choices)
+    fused = {trace.decisions[0]: trace.out_mod for trace in candidates}
+    assert num_prim_funcs(fused["no_fusion"]) == 3
+    # the grouped functions are lowered to PrimFuncs by FuseTIR, ready to be tuned
+    assert num_prim_funcs(fused["fuse_all"]) == 1
+    assert len(fused["fuse_all"].functions) == 2
+
+
+def test_fuse_ops_tuning_pass():
+    mod = setup_fusion_test()
+
+    def mock_evaluate(candidates, target):
+        # prefer the candidates with more kernels, the opposite of the greedy fusion
+        for candidate in candidates:
+            candidate.set_perf(1.0 / num_prim_funcs(candidate.out_mod))
+
+    with tempfile.TemporaryDirectory() as work_dir:
+        tuning_pass = FuseOpsTuningPass(
+            "llvm --num-cores=2",
+            ms.TuneConfig(max_trials_global=2, num_trials_per_iter=2),
+            work_dir,
+            f_evaluate=mock_evaluate,
+        )
+        with transform.PassContext(trace=Trace(mod)):
+            after = tuning_pass(mod)
+            assert PassContext.current().get_current_trace().decisions[-1] == "no_fusion"
+        assert num_prim_funcs(after) == 3
+
+        # the candidates evaluated by the tuned latency of their kernels
+        tuning_pass = FuseOpsTuningPass(
+            "llvm --num-cores=2",
+            ms.TuneConfig(max_trials_global=2, num_trials_per_iter=2, max_trials_per_task=2),
+            work_dir,
+            knob=fusion_knob({"no_fusion": (0, 256, False), "fuse_all": (1, 256, True)}),
+        )
+        with transform.PassContext(trace=Trace(mod)):
+            after = tuning_pass(mod)
+            assert PassContext.current().num_evals == 2
+            assert PassContext.current().get_current_trace().perf < 1e100
+        assert len(tuning_pass.database) > 0
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
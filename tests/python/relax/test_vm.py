@@ -15,7 +15,10 @@
 # specific language governing permissions and limitations
 # under the License.
 from __future__ import annotations  # must import to defer parsing of annotations
+import json
 import os
+import threading
+import time
 
 import numpy as np
 import pytest
@@ -23,7 +26,8 @@ import tvm
 import tvm.script
 import tvm.testing
 from tvm import relax, rpc, te, tir, topi, TVMError
-from tvm.contrib import utils
+from tvm.contrib import pipeline_executor, utils
+from tvm.contrib.distributed_pipeline import DistributedPipeline, DistributedStage
 from tvm.relax.testing import nn
 from tvm.script import relax as R, tir as T
 
@@ -136,6 +140,349 @@ def test_vm_exec_serialize_export_library():
     assert ex.as_text() == loaded_exec.as_text()
 
 
+def test_vm_exec_stats_dict():
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        a = ib.emit_constant(tvm.nd.array(np.zeros((3, 4), "float32")))
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.c(a)], dst=ib.r(1))
+        ib.emit_call("test.vm.add", args=[ib.r(1), ib.c(a)], dst=ib.r(2))
+        ib.emit_ret(ib.r(2))
+    with ib.function("copy", num_inputs=1):
+        ib.emit_call("vm.builtin.copy", args=[ib.r(0)], dst=ib.r(1))
+        ib.emit_ret(ib.r(1))
+    stats = ib.get().stats_dict()
+    assert stats["num_instructions"] == {"main": 3, "copy": 2}
+    assert stats["register_file_size"] == {"main": 3, "copy": 2}
+    assert stats["constant_bytes"] == {"cpu(0)": 48}
+    assert stats["num_packed_funcs"] == 2
+    assert stats["peak_storage_bytes"] == 0
+
+
+def test_vm_load_mapped_file():
+    a_np = np.random.rand(3, 4).astype("float32")
+    b_np = np.random.rand(5).astype("float32")
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        a = ib.emit_constant(tvm.nd.array(a_np))
+        ib.emit_constant(tvm.runtime.container.ShapeTuple([1, 2]))
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.c(a)], dst=ib.r(1))
+        ib.emit_ret(ib.r(1))
+    with ib.function("get_b", num_inputs=0):
+        b = ib.emit_constant(tvm.nd.array(b_np))
+        ib.emit_call("vm.builtin.copy", args=[ib.c(b)], dst=ib.r(0))
+        ib.emit_ret(ib.r(0))
+    ex = ib.get()
+
+    from tvm.contrib import utils
+
+    temp_dir = utils.tempdir()
+    path_exec = temp_dir.relpath("exec.bin")
+    ex.mod.save(path_exec)
+    load_from_file = tvm.get_global_func("relax.ExecutableLoadFromFile")
+    loaded_exec = relax.vm.Executable(load_from_file(path_exec))
+    assert ex.as_text() == loaded_exec.as_text()
+
+    x_np = np.random.rand(3, 4).astype("float32")
+    vm = relax.VirtualMachine(loaded_exec, tvm.cpu())
+    res = vm["main"](tvm.nd.array(x_np))
+    tvm.testing.assert_allclose(res.numpy(), x_np + a_np, rtol=1e-7, atol=1e-7)
+    tvm.testing.assert_allclose(vm["get_b"]().numpy(), b_np, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_bundle():
+    @tvm.script.ir_module
+    class TestVMBundle:
+        @T.prim_func
+        def add(A: T.Buffer[(3, 4), "float32"], B: T.Buffer[(3, 4), "float32"]):
+            for i, j in T.grid(3, 4):
+                with T.block("add"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] + T.float32(1)
+
+        @R.function
+        def main(x: Tensor((3, 4), "float32")):
+            gv = R.call_tir(add, (x,), (3, 4), dtype="float32")
+            return gv
+
+    from tvm.contrib import utils
+
+    ex = relax.vm.build(TestVMBundle, tvm.target.Target("llvm", host="llvm"))
+    temp_dir = utils.tempdir()
+    path = temp_dir.relpath("exec.relaxvm")
+    ex.save_bundle(path)
+    # Saving again replaces the file.
+    ex.save_bundle(path)
+    x_np = np.random.rand(3, 4).astype("float32")
+    for loaded_exec in [
+        relax.vm.load_bundle(path),
+        relax.vm.Executable(tvm.runtime.load_module(path)),
+    ]:
+        assert ex.as_text() == loaded_exec.as_text()
+        vm = relax.VirtualMachine(loaded_exec, tvm.cpu())
+        res = vm["main"](tvm.nd.array(x_np))
+        tvm.testing.assert_allclose(res.numpy(), x_np + 1, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_export_crt():
+    @tvm.script.ir_module
+    class TestVMExportCRT:
+        @T.prim_func
+        def add(A: T.Buffer[(3, 4), "float32"], B: T.Buffer[(3, 4), "float32"]):
+            for i, j in T.grid(3, 4):
+                with T.block("add"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] + T.float32(1)
+
+        @R.function
+        def main(x: Tensor((3, 4), "float32")):
+            lv0 = R.call_tir(add, (x,), (3, 4), dtype="float32")
+            gv = R.call_tir(add, (lv0,), (3, 4), dtype="float32")
+            return gv
+
+    import struct
+
+    ex = relax.vm.build(TestVMExportCRT, tvm.target.Target("llvm", host="llvm"))
+    data = bytes(ex.export_crt())
+    header = struct.unpack_from("<10I8Q", data)
+    magic, version, num_functions, num_func_names, _, num_instrs = header[:6]
+    num_storages, num_tensors, storage_bytes = header[6], header[7], header[10]
+    assert magic == 0x4D565852 and version == 1
+    assert num_functions == 1 and num_func_names > 0 and num_instrs > 0
+    # One storage for each of the intermediate and the output tensors, aligned to 128 bytes.
+    assert num_storages == 2 and num_tensors == 2 and storage_bytes == 256
+    assert len(data) % 8 == 0
+
+    @tvm.script.ir_module
+    class TestVMExportCRTDynamic:
+        @T.prim_func
+        def add(x: T.handle, y: T.handle):
+            n = T.var("int64")
+            A = T.match_buffer(x, (n, 4))
+            B = T.match_buffer(y, (n, 4))
+            for i, j in T.grid(n, 4):
+                with T.block("add"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] + T.float32(1)
+
+        @R.function
+        def main(x: Tensor((n, 4), "float32")):
+            gv = R.call_tir(add, (x,), (n, 4), dtype="float32")
+            return gv
+
+    ex = relax.vm.build(TestVMExportCRTDynamic, tvm.target.Target("llvm", host="llvm"))
+    with pytest.raises(tvm.TVMError):
+        ex.export_crt()
+
+    # the slots are planned per instruction, so a function cannot have two active frames
+    ib = relax.ExecBuilder()
+    with ib.function("even", num_inputs=1):
+        ib.emit_call("odd", args=[ib.r(0)], dst=ib.r(1))
+        ib.emit_ret(ib.r(1))
+    with ib.function("odd", num_inputs=1):
+        ib.emit_call("even", args=[ib.r(0)], dst=ib.r(1))
+        ib.emit_ret(ib.r(1))
+    with pytest.raises(tvm.TVMError, match="does not support recursion"):
+        ib.get().export_crt()
+
+
+def test_vm_source_location():
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        ib.emit_call("test.vm.identity", args=[ib.r(0), ib.r(0)])
+        ib.set_source_span(tvm.ir.Span(tvm.ir.SourceName("model.py"), 3, 3, 4, 10))
+        ib.emit_call("test.vm.identity", args=[ib.r(0), ib.r(0)])
+        ib.emit_call("test.vm.identity", args=[ib.r(0), ib.r(0)])
+        ib.set_source_span(None)
+        ib.emit_ret(ib.r(0))
+    ex = ib.get()
+    expected = ["", "model.py:3:4", "model.py:3:4", ""]
+    assert [ex.source_location(pc) for pc in range(4)] == expected
+
+    from tvm.contrib import utils
+
+    temp_dir = utils.tempdir()
+    path_exec = temp_dir.relpath("exec.bin")
+    ex.mod.save(path_exec)
+    load_from_file = tvm.get_global_func("relax.ExecutableLoadFromFile")
+    loaded_exec = relax.vm.Executable(load_from_file(path_exec))
+    assert [loaded_exec.source_location(pc) for pc in range(4)] == expected
+
+    # Executables without source locations have no debug section.
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        ib.emit_ret(ib.r(0))
+    ex = ib.get()
+    ex.mod.save(path_exec)
+    loaded_exec = relax.vm.Executable(load_from_file(path_exec))
+    assert loaded_exec.source_location(0) == ""
+
+
+def test_vm_shape_jit():
+    @T.prim_func
+    def add_one(a: T.handle, b: T.handle, n: T.int64):
+        A = T.match_buffer(a, (n,), "float32")
+        B = T.match_buffer(b, (n,), "float32")
+        for i in T.serial(n):
+            with T.block("add_one"):
+                vi = T.axis.remap("S", [i])
+                B[vi] = A[vi] + T.float32(1)
+
+    bb = relax.BlockBuilder()
+    n = tir.Var("n", "int64")
+    x = relax.Var("x", [n], relax.DynTensorType(1, "float32"))
+    with bb.function("main", [x]):
+        gv = bb.add_func(add_one, "add_one")
+        out = bb.emit(
+            relax.call_tir(gv, (x,), (n,), dtype="float32", tir_vars=relax.ShapeExpr([n]))
+        )
+        bb.emit_func_output(out)
+    mod = bb.get()
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    vm.enable_shape_jit(mod, target, threshold=2)
+    hot = np.random.rand(8).astype("float32")
+    for _ in range(20):
+        res = vm["main"](tvm.nd.array(hot))
+        tvm.testing.assert_allclose(res.numpy(), hot + 1, rtol=1e-7, atol=1e-7)
+        if vm.shape_jit_stats()["num_specialized_calls"] > 0:
+            break
+        time.sleep(0.1)
+    cold = np.random.rand(5).astype("float32")
+    tvm.testing.assert_allclose(vm["main"](tvm.nd.array(cold)).numpy(), cold + 1, rtol=1e-7)
+    stats = vm.shape_jit_stats()
+    assert stats["num_kernels"] == 1 and stats["num_shapes"] == 2
+    assert stats["num_specialized"] == 1 and stats["num_specialized_calls"] > 0
+
+
+def test_vm_snapshot():
+    @T.prim_func
+    def add_one(a: T.handle, b: T.handle, n: T.int64):
+        A = T.match_buffer(a, (n,), "float32")
+        B = T.match_buffer(b, (n,), "float32")
+        for i in T.serial(n):
+            with T.block("add_one"):
+                vi = T.axis.remap("S", [i])
+                B[vi] = A[vi] + T.float32(1)
+
+    bb = relax.BlockBuilder()
+    n = tir.Var("n", "int64")
+    x = relax.Var("x", [n], relax.DynTensorType(1, "float32"))
+    with bb.function("main", [x]):
+        gv = bb.add_func(add_one, "add_one")
+        out = bb.emit(
+            relax.call_tir(gv, (x,), (n,), dtype="float32", tir_vars=relax.ShapeExpr([n]))
+        )
+        bb.emit_func_output(out)
+    mod = bb.get()
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    vm.enable_shape_jit(mod, target, threshold=2)
+    hot = np.random.rand(8).astype("float32")
+    for _ in range(20):
+        vm["main"](tvm.nd.array(hot))
+        if vm.shape_jit_stats()["num_specialized"] > 0:
+            break
+        time.sleep(0.1)
+    snapshot = json.loads(vm.save_snapshot())
+    assert snapshot["functions"] == {"main": [{"shape": [8], "dtype": "float32", "device": [1, 0]}]}
+    assert snapshot["shape_jit"] == [["add_one", [8]]]
+
+    # The restored VM runs the specialized kernel from its first call.
+    restored = relax.VirtualMachine(ex, tvm.cpu())
+    restored.enable_shape_jit(mod, target, threshold=100)
+    restored.load_snapshot(vm.save_snapshot())
+    assert restored.shape_jit_stats()["num_specialized"] == 1
+    res = restored["main"](tvm.nd.array(hot))
+    tvm.testing.assert_allclose(res.numpy(), hot + 1, rtol=1e-7, atol=1e-7)
+    assert restored.shape_jit_stats()["num_specialized_calls"] >= 1
+
+
+def test_vm_parallel_kernels():
+    @tvm.script.ir_module
+    class TestVMParallel:
+        @T.prim_func
+        def add_one(A: T.Buffer[(16,), "float32"], B: T.Buffer[(16,), "float32"]):
+            for i in T.serial(16):
+                with T.block("add_one"):
+                    vi = T.axis.remap("S", [i])
+                    B[vi] = A[vi] + T.float32(1)
+
+        @T.prim_func
+        def add(
+            A: T.Buffer[(16,), "float32"],
+            B: T.Buffer[(16,), "float32"],
+            C: T.Buffer[(16,), "float32"],
+        ):
+            for i in T.serial(16):
+                with T.block("add"):
+                    vi = T.axis.remap("S", [i])
+                    C[vi] = A[vi] + B[vi]
+
+        @R.function
+        def main(x: Tensor((16,), "float32")):
+            lv0 = R.call_tir(add_one, (x,), (16,), dtype="float32")
+            lv1 = R.call_tir(add_one, (x,), (16,), dtype="float32")
+            lv2 = R.call_tir(add_one, (lv0,), (16,), dtype="float32")
+            lv3 = R.call_tir(add_one, (lv1,), (16,), dtype="float32")
+            gv = R.call_tir(add, (lv2, lv3), (16,), dtype="float32")
+            return gv
+
+    ex = relax.vm.build(TestVMParallel, tvm.target.Target("llvm", host="llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    vm.set_max_parallelism(4)
+    x_np = np.random.rand(16).astype("float32")
+    for _ in range(3):
+        res = vm["main"](tvm.nd.array(x_np))
+        tvm.testing.assert_allclose(res.numpy(), (x_np + 2) * 2, rtol=1e-7, atol=1e-7)
+    with pytest.raises(TVMError):
+        vm.set_max_parallelism(0)
+
+
+def test_vm_parallel_inplace_kernels():
+    @tvm.script.ir_module
+    class TestVMParallelInplace:
+        @T.prim_func
+        def add_one(A: T.Buffer[(16,), "float32"], B: T.Buffer[(16,), "float32"]):
+            for i in T.serial(16):
+                with T.block("add_one"):
+                    vi = T.axis.remap("S", [i])
+                    B[vi] = A[vi] + T.float32(1)
+
+        @T.prim_func
+        def add(
+            A: T.Buffer[(16,), "float32"],
+            B: T.Buffer[(16,), "float32"],
+            C: T.Buffer[(16,), "float32"],
+        ):
+            for i in T.serial(16):
+                with T.block("add"):
+                    vi = T.axis.remap("S", [i])
+                    C[vi] = A[vi] + B[vi]
+
+        @R.function
+        def main(x: Tensor((16,), "float32")):
+            lv0 = R.call_tir(add_one, (x,), (16,), dtype="float32")
+            lv1 = R.call_tir(add_one, (lv0,), (16,), dtype="float32")
+            lv2 = R.call_tir(add_one, (lv0,), (16,), dtype="float32")
+            gv = R.call_tir(add, (lv1, lv2), (16,), dtype="float32")
+            return gv
+
+    mod = relax.transform.InplaceCallTIR()(TestVMParallelInplace)
+    # lv2 overwrites lv0, so it must wait for lv1 to read lv0
+    assert list(mod["main"].body.blocks[0].bindings[2].value.attrs.inplace_indices) == [0]
+    ex = relax.vm.build(mod, tvm.target.Target("llvm", host="llvm"))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    vm.set_max_parallelism(4)
+    x_np = np.random.rand(16).astype("float32")
+    for _ in range(10):
+        res = vm["main"](tvm.nd.array(x_np))
+        tvm.testing.assert_allclose(res.numpy(), (x_np + 2) * 2, rtol=1e-7, atol=1e-7)
+
+
 def test_vm_checker():
     ib = relax.ExecBuilder()
     with pytest.raises(TVMError):
@@ -205,6 +552,21 @@ def test_vm_shapeof():
         assert s == shape[i]
 
 
+def test_vm_shape_heap_reuse():
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        ib.emit_call("vm.builtin.alloc_shape_heap", args=[ib.vm_state(), (4,)], dst=ib.r(1))
+        ib.emit_call("vm.builtin.shape_of", args=[ib.r(0)], dst=ib.r(2))
+        ib.emit_call("vm.builtin.store_shape", args=[ib.r(2), ib.r(1), (3, 0)], dst=ib.r(3))
+        ib.emit_call("vm.builtin.load_shape", args=[ib.r(1), (0, 3, 0)], dst=ib.r(4))
+        ib.emit_ret(ib.r(4))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    for shape in [(2, 5), (7, 3), (2, 5)]:
+        res = vm["main"](tvm.nd.array(np.zeros(shape, "float32")))
+        assert list(res) == [shape[1], shape[0], shape[1]]
+
+
 def test_vm_storage():
     dtype = tvm.DataType("float32")
     shape = (4, 6)
@@ -224,6 +586,333 @@ def test_vm_storage():
     assert res.shape == shape
 
 
+@tvm.testing.requires_cuda
+def test_vm_multi_device_to_device():
+    dtype = tvm.DataType("float32")
+    shape = (4, 6)
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        # allocate on the host, then move the input and the result to device 0
+        ib.emit_call(
+            "vm.builtin.alloc_storage", args=[ib.vm_state(), (96,), ib.imm(-1), dtype], dst=ib.r(1)
+        )
+        ib.emit_call(
+            "vm.builtin.alloc_tensor", args=[ib.r(1), ib.imm(0), shape, dtype], dst=ib.r(2)
+        )
+        ib.emit_call("vm.builtin.to_device", args=[ib.vm_state(), ib.r(0), ib.imm(0)], dst=ib.r(3))
+        ib.emit_ret(ib.r(3))
+    ex = ib.get()
+    dev = tvm.cuda(0)
+    vm = relax.VirtualMachine(ex, [dev, tvm.cpu()])
+    inp = tvm.nd.array(np.random.rand(*shape).astype(np.float32))
+    res = vm["main"](inp)
+    assert res.device == dev
+    tvm.testing.assert_allclose(res.numpy(), inp.numpy(), rtol=1e-7, atol=1e-7)
+
+
+@tvm.testing.requires_cuda
+def test_vm_cuda_graph():
+    @tvm.script.ir_module
+    class TestVMCUDAGraph:
+        @T.prim_func
+        def add_one(A: T.Buffer[(16,), "float32"], B: T.Buffer[(16,), "float32"]):
+            T.func_attr({"global_symbol": "add_one"})
+            for i in T.thread_binding(16, thread="threadIdx.x"):
+                with T.block("B"):
+                    vi = T.axis.spatial(16, i)
+                    B[vi] = A[vi] + T.float32(1)
+
+        @R.function
+        def main(x: Tensor((16,), "float32")):
+            y = R.call_tir(add_one, (x,), (16,), dtype="float32")
+            z = R.call_tir(add_one, (y,), (16,), dtype="float32")
+            return z
+
+    target = tvm.target.Target("cuda", host="llvm")
+    ex = relax.vm.build(TestVMCUDAGraph, target)
+    dev = tvm.cuda(0)
+    vm = relax.VirtualMachine(ex, dev)
+    for _ in range(3):
+        inp = np.random.rand(16).astype(np.float32)
+        res = vm.invoke_cuda_graph("main", tvm.nd.array(inp, dev))
+        tvm.testing.assert_allclose(res.numpy(), inp + 2, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_stream_builtins():
+    ib = relax.ExecBuilder()
+    with ib.function("func0", num_inputs=2):
+        ib.emit_call("vm.builtin.stream.set", args=[ib.vm_state(), ib.imm(0), ib.imm(1)])
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.r(1)], dst=ib.r(2))
+        ib.emit_call(
+            "vm.builtin.stream.wait", args=[ib.vm_state(), ib.imm(0), ib.imm(1), ib.imm(0)]
+        )
+        ib.emit_call("vm.builtin.stream.set", args=[ib.vm_state(), ib.imm(0), ib.imm(0)])
+        ib.emit_call("vm.builtin.stream.sync", args=[ib.vm_state(), ib.imm(0), ib.imm(0)])
+        ib.emit_ret(ib.r(2))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a = tvm.nd.array(np.random.rand(4))
+    b = tvm.nd.array(np.random.rand(4))
+    vm.set_input("func0", a, b)
+    res = vm["func0"]()
+    tvm.testing.assert_allclose(res.numpy(), a.numpy() + b.numpy(), rtol=1e-7, atol=1e-7)
+
+
+@pytest.mark.skipif(
+    tvm.get_global_func("relax.VirtualMachineProfiler", True) is None,
+    reason="TVM was not built with the profiler",
+)
+def test_vm_profiler():
+    @tvm.script.ir_module
+    class TestVMProfiler:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                R.output(y)
+            return y
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMProfiler, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu(), profile=True)
+    inp = tvm.nd.array(np.random.rand(32, 16).astype(np.float32))
+    report = vm.profile("foo", inp)
+    assert "test.vm.identity" in str(report)
+    assert "vm.builtin.alloc_storage" in str(report)
+    calls = json.loads(report.json())["calls"]
+    calls = [c for c in calls if c["Name"]["string"] == "test.vm.identity"]
+    # the input and the output of the kernel
+    assert calls[0]["Argument Bytes"]["count"] == 2 * 32 * 16 * 4
+    assert "Argument Bandwidth (GB/s)" in calls[0]
+    events = json.loads(report.chrome_trace())["traceEvents"]
+    kernels = [e for e in events if e["name"] == "test.vm.identity"]
+    assert kernels[0]["ph"] == "X" and kernels[0]["dur"] >= 0
+
+
+def test_vm_trace():
+    @tvm.script.ir_module
+    class TestVMTrace:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                R.output(y)
+            return y
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMTrace, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inp = tvm.nd.array(np.random.rand(32, 16).astype(np.float32))
+    # trace one of every two invocations
+    vm.set_trace(sample_every=2)
+    for _ in range(4):
+        vm["foo"](inp)
+    trace = json.loads(vm.get_trace(clear=True))
+    events = [e for e in trace["traceEvents"] if e["ph"] == "X"]
+    assert len([e for e in events if e["cat"] == "function" and e["name"] == "foo"]) == 2
+    instrs = [e for e in events if e["cat"] == "instr"]
+    assert len([e for e in instrs if e["name"] == "test.vm.identity"]) == 2
+    assert len([e for e in instrs if e["name"] == "Ret"]) == 2
+    for e in instrs:
+        assert e["dur"] >= 0
+    # the events beyond the limit are dropped
+    vm.set_trace(sample_every=1, max_events=3)
+    vm["foo"](inp)
+    trace = json.loads(vm.get_trace())
+    assert len([e for e in trace["traceEvents"] if e["ph"] == "X"]) == 3
+    assert trace["otherData"]["dropped_events"] > 0
+    vm.set_trace(0)
+    res = vm["foo"](inp)
+    tvm.testing.assert_allclose(res.numpy(), inp.numpy())
+
+
+def test_vm_latency_stats():
+    @tvm.script.ir_module
+    class TestVMLatencyStats:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                R.output(y)
+            return y
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMLatencyStats, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inp = tvm.nd.array(np.random.rand(32, 16).astype(np.float32))
+    vm.set_latency_stats(True)
+    for _ in range(10):
+        vm["foo"](inp)
+    stats = vm.get_stats()
+    assert list(stats.keys()) == ["foo"]
+    foo = stats["foo"]
+    assert foo["count"] == 10
+    assert sum(count for _, count in foo["buckets"]) == 10
+    assert 0 < foo["p50_us"] <= foo["p99_us"] <= foo["max_us"]
+    # enabling again resets the histograms
+    vm.set_latency_stats(True)
+    assert vm.get_stats() == {}
+
+
+def test_vm_kernel_capture():
+    @tvm.script.ir_module
+    class TestVMKernelCapture:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                z = R.call_tir("test.vm.tile", (y), (32, 32), dtype="float32")
+                R.output(z)
+            return z
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMKernelCapture, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    vm.set_kernel_capture("tile", 2)
+    inputs = [np.random.rand(32, 16).astype(np.float32) for _ in range(3)]
+    for inp in inputs:
+        vm["foo"](tvm.nd.array(inp))
+    # the ring keeps the outputs of the last two calls to the selected kernel
+    records = vm.get_kernel_capture()
+    assert [name for name, _ in records] == ["test.vm.tile", "test.vm.tile"]
+    for (_, data), inp in zip(records, inputs[1:]):
+        tvm.testing.assert_allclose(data.numpy(), np.tile(inp, (1, 2)), rtol=1e-7, atol=1e-7)
+    # a copy is returned, the slots are reused by the later calls
+    vm["foo"](tvm.nd.array(inputs[0]))
+    tvm.testing.assert_allclose(records[1][1].numpy(), np.tile(inputs[2], (1, 2)), rtol=1e-7)
+
+    vm.set_kernel_capture("identity|tile", 4)
+    vm["foo"](tvm.nd.array(inputs[0]))
+    assert [name for name, _ in vm.get_kernel_capture()] == ["test.vm.identity", "test.vm.tile"]
+    vm.set_kernel_capture("", 0)
+    with pytest.raises(TVMError, match="not enabled"):
+        vm.get_kernel_capture()
+
+
+def test_vm_hooks():
+    @tvm.script.ir_module
+    class TestVMHooks:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                R.output(y)
+            return y
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMHooks, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    events = []
+    vm.set_hooks(lambda event, name, value: events.append((event, name, value)))
+    vm["foo"](tvm.nd.array(np.random.rand(32, 16).astype(np.float32)))
+    assert events[0] == ("invoke_begin", "foo", 0)
+    assert events[-1] == ("invoke_end", "foo", 0)
+    assert all(not event.startswith("instr") for event, _, _ in events)
+    allocs = [value for event, _, value in events if event == "alloc"]
+    assert allocs and all(value >= 32 * 16 * 4 for value in allocs)
+
+    events.clear()
+    vm.set_hooks(lambda event, name, value: events.append((event, name, value)), True)
+    vm["foo"](tvm.nd.array(np.random.rand(32, 16).astype(np.float32)))
+    instrs = [(event, name) for event, name, _ in events if event.startswith("instr")]
+    assert ("instr_begin", "test.vm.identity") in instrs
+    assert ("instr_end", "test.vm.identity") in instrs
+    assert instrs[-1] == ("instr_end", "Ret")
+    # every instruction begins and ends in turn
+    assert [event for event, _ in instrs] == ["instr_begin", "instr_end"] * (len(instrs) // 2)
+
+    events.clear()
+    vm.set_hooks(None)
+    vm["foo"](tvm.nd.array(np.random.rand(32, 16).astype(np.float32)))
+    assert not events
+
+    @tvm.register_func("test.vm.hooks_fail", override=True)
+    def hooks_fail(x):
+        raise ValueError("the kernel failed")
+
+    ib = relax.ExecBuilder()
+    with ib.function("lifted_func", num_inputs=2):
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.r(1)], dst=ib.r(2))
+        ib.emit_ret(ib.r(2))
+    with ib.function("call_closure", num_inputs=2):
+        x = ib.emit_constant("lifted_func")
+        ib.emit_call(
+            "vm.builtin.alloc_closure", args=[ib.vm_state(), ib.c(x), ib.r(1)], dst=ib.r(2)
+        )
+        ib.emit_call(
+            "vm.builtin.invoke_closure", args=[ib.vm_state(), ib.r(2), ib.r(0)], dst=ib.r(3)
+        )
+        ib.emit_ret(ib.r(3))
+    with ib.function("tail_call", num_inputs=2):
+        ib.emit_tail_call("lifted_func", args=[ib.r(0), ib.r(1)])
+    with ib.function("fail", num_inputs=1):
+        ib.emit_call("test.vm.hooks_fail", args=[ib.r(0)], dst=ib.r(1))
+        ib.emit_ret(ib.r(1))
+    vm = relax.VirtualMachine(ib.get(), tvm.cpu())
+    vm.set_hooks(lambda event, name, value: events.append((event, name)))
+    a, b = tvm.nd.array(np.random.rand(4)), tvm.nd.array(np.random.rand(4))
+    # the closures and the tail calls are reported as nested invocations
+    for func_name in ["call_closure", "tail_call"]:
+        events.clear()
+        vm[func_name](a, b)
+        assert events == [
+            ("invoke_begin", func_name),
+            ("invoke_begin", "lifted_func"),
+            ("invoke_end", "lifted_func"),
+            ("invoke_end", func_name),
+        ]
+    # an invocation which throws ends too
+    events.clear()
+    with pytest.raises(Exception, match="the kernel failed"):
+        vm["fail"](a)
+    assert events == [("invoke_begin", "fail"), ("invoke_end", "fail")]
+
+
+def test_vm_memoize():
+    num_calls = [0]
+
+    @tvm.register_func("test.vm.memoize_add_one", override=True)
+    def add_one(x):
+        num_calls[0] += 1
+        return tvm.nd.array(x.numpy() + 1)
+
+    @tvm.script.ir_module
+    class TestVMMemoize:
+        @R.function
+        def embed(x: Tensor((4,), "float32")):
+            y = R.call_packed(
+                "test.vm.memoize_add_one", x, type_args=(Tensor(ndim=1, dtype="float32"))
+            )
+            return y
+
+        @R.function
+        def main(x: Tensor((4,), "float32")):
+            y = embed(x)
+            return y
+
+    mod = TestVMMemoize
+    mod["embed"] = mod["embed"].with_attr("relax.memoize", 2)
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    assert "vm.builtin.memoize" in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inputs = [np.random.rand(4).astype("float32") for _ in range(3)]
+    for inp in [inputs[0], inputs[1], inputs[0], inputs[1]]:
+        res = vm["main"](tvm.nd.array(inp))
+        tvm.testing.assert_allclose(res.numpy(), inp + 1, rtol=1e-7, atol=1e-7)
+    # the calls with the same values hit the cache
+    assert num_calls[0] == 2
+    # the least recently used entry is evicted
+    vm["main"](tvm.nd.array(inputs[2]))
+    vm["main"](tvm.nd.array(inputs[1]))
+    vm["main"](tvm.nd.array(inputs[0]))
+    assert num_calls[0] == 4
+    stats = vm.memoize_stats("embed")
+    assert stats["num_entries"] == 2
+    assert stats["num_hits"] == 3
+    assert stats["num_misses"] == 4
+
+
 def test_vm_copy():
     @tvm.script.ir_module
     class TestVMMove:
@@ -264,6 +953,16 @@ def test_vm_goto():
     tvm.testing.assert_allclose(res.numpy(), a.numpy() + b.numpy(), rtol=1e-7, atol=1e-7)
 
 
+def test_vm_goto_out_of_range():
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=2):
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.r(1)], dst=ib.r(2))
+        ib.emit_goto(3)
+        ib.emit_ret(ib.r(2))
+    with pytest.raises(tvm.TVMError):
+        relax.VirtualMachine(ib.get(), tvm.cpu())
+
+
 def test_vm_if():
     ib = relax.ExecBuilder()
     with ib.function("main", num_inputs=3):
@@ -310,6 +1009,201 @@ def test_vm_compile_if():
     tvm.testing.assert_allclose(res.numpy(), inp.numpy() + inp.numpy(), rtol=1e-7, atol=1e-7)
     res = vm["ife"](0, inp)
     tvm.testing.assert_allclose(res.numpy(), inp.numpy() * inp.numpy(), rtol=1e-7, atol=1e-7)
+    # the branch results are computed into the merge register, without a copy or a move
+    assert "move" not in ex.as_text()
+    assert "vm.builtin.copy" not in ex.as_text()
+    # without the peephole optimization, they are moved into the merge register
+    with tvm.transform.PassContext(config={"relax.VMCodeGen.peephole": False}):
+        ex = relax.vm.build(mod, target)
+    assert "move" in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    res = vm["ife"](True, inp)
+    tvm.testing.assert_allclose(res.numpy(), inp.numpy() + inp.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_peephole():
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=3):
+        ib.emit_if(ib.r(0), 4)
+        ib.emit_call("test.vm.add", args=[ib.r(1), ib.r(2)], dst=ib.r(3))
+        ib.emit_move(ib.r(3), ib.r(4))
+        # a Goto to a Goto to the next instruction
+        ib.emit_goto(3)
+        ib.emit_call("test.vm.mul", args=[ib.r(1), ib.r(2)], dst=ib.r(5))
+        ib.emit_move(ib.r(5), ib.r(4))
+        ib.emit_goto(1)
+        ib.emit_ret(ib.r(4))
+    with ib.function("shape", num_inputs=1):
+        ib.emit_call("vm.builtin.shape_of", args=[ib.r(0)], dst=ib.r(1))
+        ib.emit_call("vm.builtin.shape_of", args=[ib.r(0)], dst=ib.r(2))
+        ib.emit_kill_register(ib.r(1))
+        ib.emit_ret(ib.r(2))
+    ib.optimize()
+    ex = ib.get()
+    stats = ex.stats_dict()
+    assert stats["num_instructions"] == {"main": 5, "shape": 2}
+    assert stats["register_file_size"] == {"main": 4, "shape": 2}
+
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a = tvm.nd.array(np.random.rand(3, 4))
+    b = tvm.nd.array(np.random.rand(3, 4))
+    tvm.testing.assert_allclose(vm["main"](True, a, b).numpy(), a.numpy() + b.numpy())
+    tvm.testing.assert_allclose(vm["main"](False, a, b).numpy(), a.numpy() * b.numpy())
+    assert list(vm["shape"](a)) == [3, 4]
+
+
+def test_vm_register_allocation():
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        for i in range(4):
+            ib.emit_call("test.vm.add", args=[ib.r(i), ib.r(i)], dst=ib.r(i + 1))
+        ib.emit_ret(ib.r(4))
+    ib.allocate_registers()
+    ex = ib.get()
+    assert ex.stats_dict()["register_file_size"] == {"main": 3}
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a = tvm.nd.array(np.random.rand(3, 4))
+    tvm.testing.assert_allclose(vm["main"](a).numpy(), a.numpy() * 16)
+
+    @tvm.script.ir_module
+    class TestVMRegisterAllocation:
+        @R.function
+        def main(x: Tensor((3, 4), "float32")):
+            x1 = relax.call_packed("test.vm.add", x, x, type_args=(Tensor))
+            x2 = relax.call_packed("test.vm.add", x1, x1, type_args=(Tensor))
+            x3 = relax.call_packed("test.vm.add", x2, x2, type_args=(Tensor))
+            x4 = relax.call_packed("test.vm.add", x3, x3, type_args=(Tensor))
+            x5 = relax.call_packed("test.vm.add", x4, x4, type_args=(Tensor))
+            x6 = relax.call_packed("test.vm.add", x5, x5, type_args=(Tensor))
+            return x6
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMRegisterAllocation, target)
+    with tvm.transform.PassContext(config={"relax.VMCodeGen.register_allocation": False}):
+        ex_unallocated = relax.vm.build(TestVMRegisterAllocation, target)
+    # The chain of six values only needs two slots besides the parameter.
+    num_registers = ex.stats_dict()["register_file_size"]["main"]
+    assert num_registers + 4 <= ex_unallocated.stats_dict()["register_file_size"]["main"]
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a = tvm.nd.array(np.random.rand(3, 4).astype("float32"))
+    tvm.testing.assert_allclose(vm["main"](a).numpy(), a.numpy() * 64, rtol=1e-6)
+
+
+def test_vm_emit_move():
+    ib = relax.ExecBuilder()
+    with ib.function("func0", num_inputs=1):
+        ib.emit_move(ib.r(0), ib.r(1))
+        ib.emit_ret(ib.r(1))
+    with ib.function("func1", num_inputs=0):
+        ib.emit_move(ib.imm(42), ib.r(0))
+        ib.emit_ret(ib.r(0))
+    with ib.function("func2", num_inputs=0):
+        ib.emit_move(ib.c(ib.emit_constant(tvm.runtime.ShapeTuple([2, 3]))), ib.r(0))
+        ib.emit_ret(ib.r(0))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a = tvm.nd.array(np.random.rand(4))
+    tvm.testing.assert_allclose(vm["func0"](a).numpy(), a.numpy(), rtol=1e-7, atol=1e-7)
+    assert vm["func1"]() == 42
+    assert list(vm["func2"]()) == [2, 3]
+
+
+def test_vm_compiled_exec_mode():
+    @tvm.script.ir_module
+    class TestVMCompiled:
+        @T.prim_func
+        def add_one(A: T.Buffer[(16,), "float32"], B: T.Buffer[(16,), "float32"]):
+            T.func_attr({"global_symbol": "add_one"})
+            for i in range(16):
+                with T.block("B"):
+                    vi = T.axis.spatial(16, i)
+                    B[vi] = A[vi] + T.float32(1)
+
+        @R.function
+        def main(x: Tensor((16,), "float32")):
+            y = R.call_tir(add_one, (x,), (16,), dtype="float32")
+            z = R.call_tir(add_one, (y,), (16,), dtype="float32")
+            return z
+
+        @R.function
+        def ife(cond: Tensor((), "bool"), x: Tensor((16,), "float32")) -> Tensor:
+            if cond:
+                w = relax.call_packed("test.vm.add", x, x, type_args=(Tensor))
+            else:
+                w = relax.call_packed("test.vm.mul", x, x, type_args=(Tensor))
+            return w
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMCompiled, target, exec_mode="compiled")
+    # the functions are compiled into the kernel library instead of bytecode
+    assert "compiled to __vmtir__main" in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inp = np.random.rand(16).astype(np.float32)
+    res = vm["main"](tvm.nd.array(inp))
+    tvm.testing.assert_allclose(res.numpy(), inp + 2, rtol=1e-7, atol=1e-7)
+    res = vm["ife"](True, tvm.nd.array(inp))
+    tvm.testing.assert_allclose(res.numpy(), inp + inp, rtol=1e-7, atol=1e-7)
+    res = vm["ife"](False, tvm.nd.array(inp))
+    tvm.testing.assert_allclose(res.numpy(), inp * inp, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_build_pass_context():
+    @tvm.script.ir_module
+    class TestVMBuild:
+        @T.prim_func
+        def add_one(A: T.Buffer[(16,), "float32"], B: T.Buffer[(16,), "float32"]):
+            T.func_attr({"global_symbol": "add_one"})
+            for i in range(16):
+                with T.block("B"):
+                    vi = T.axis.spatial(16, i)
+                    B[vi] = A[vi] + T.float32(1)
+
+        @R.function
+        def main(x: Tensor((16,), "float32")):
+            y = R.call_tir(add_one, (x,), (16,), dtype="float32")
+            return y
+
+    @tvm.instrument.pass_instrument
+    class CountPassContexts:
+        def __init__(self):
+            self.num_enters = 0
+
+        def enter_pass_ctx(self):
+            self.num_enters += 1
+
+    # the bytecode is generated on another thread, in the pass context of the caller
+    instrument = CountPassContexts()
+    config = {"relax.VMCodeGen.register_allocation": False}
+    with tvm.transform.PassContext(config=config, instruments=[instrument]):
+        ex = relax.vm.build(TestVMBuild, "llvm")
+    assert instrument.num_enters == 1
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inp = np.random.rand(16).astype(np.float32)
+    tvm.testing.assert_allclose(vm["main"](tvm.nd.array(inp)).numpy(), inp + 1)
+    with pytest.raises(ValueError):
+        relax.vm.build(TestVMBuild, "llvm", exec_mode="interpreted")
+
+
+def test_vm_time_evaluator():
+    @tvm.script.ir_module
+    class TestVMTimeEvaluator:
+        @R.function
+        def foo(x: Tensor((3, 4), "float32"), y: Tensor((3, 4), "float32")):
+            z = R.call_packed("test.vm.add", x, y, type_args=(Tensor(ndim=2, dtype="float32")))
+            return z
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMTimeEvaluator, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a = np.random.rand(3, 4).astype(np.float32)
+    b = np.random.rand(3, 4).astype(np.float32)
+    res = vm.time_evaluator("foo", tvm.cpu(), number=5, repeat=3)(a, b)
+    assert len(res.results) == 3
+    assert res.mean > 0 and res.median > 0 and res.std >= 0
+    tvm.testing.assert_allclose(vm.get_outputs("foo").numpy(), a + b, rtol=1e-7, atol=1e-7)
+    # the inputs set by set_input are reused without arguments
+    res = vm.time_evaluator("foo", tvm.cpu(), number=2)()
+    assert len(res.results) == 1
 
 
 def test_vm_compile_stage0():
@@ -320,99 +1214,625 @@ def test_vm_compile_stage0():
             z = R.call_packed("test.vm.identity", x, y, type_args=(Tensor(ndim=2, dtype="float32")))
             return y
 
-    mod = TestVMCompileStage0
+    mod = TestVMCompileStage0
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    inp1 = tvm.nd.array(np.random.rand(3, 4).astype(np.float32))
+    inp2 = tvm.nd.array(np.random.rand(3, 4).astype(np.float32))
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    vm["foo"](inp1, inp2)
+    tvm.testing.assert_allclose(inp2.numpy(), inp1.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_compile_stage1():
+    @tvm.script.ir_module
+    class TestVMCompileStage1:
+        @T.prim_func
+        def shape_func0(heap: T.handle) -> None:
+            # function attr dict
+            T.func_attr({"global_symbol": "shape_func0"})
+            H = T.match_buffer(
+                heap,
+                [T.int64(4)],
+                dtype="int64",
+                elem_offset=T.int64(0),
+                align=128,
+                offset_factor=1,
+            )
+            # body
+            H[2] = H[0] * T.int64(2)
+            H[3] = H[1] * T.int64(3)
+
+        @R.function
+        def foo(x: Tensor(_, "float32")):
+            shape_heap: Tensor((4,), "int64") = relax.call_packed(
+                "vm.builtin.alloc_shape_heap", (4,), type_args=(Tensor(ndim=1, dtype="int64"))
+            )
+            gv0 = relax.call_packed("vm.builtin.shape_of", x, type_args=(Shape))
+            gv1 = relax.call_packed(
+                "vm.builtin.store_shape", gv0, shape_heap, (0, 1), type_args=(Void)
+            )
+            gv2 = shape_func0(shape_heap)
+            gv3 = relax.call_packed("vm.builtin.load_shape", shape_heap, (2, 3), type_args=(Shape))
+            return gv3
+
+    mod = TestVMCompileStage1
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+
+    shape = (32, 16)
+    arr = tvm.nd.array(np.random.rand(*shape))
+    res = vm["foo"](arr)
+    assert res[0] == shape[0] * 2
+    assert res[1] == shape[1] * 3
+
+
+def test_vm_compile_stage2():
+    @tvm.script.ir_module
+    class TestVMCompileStage2:
+        @R.function
+        def foo(x: Tensor(_, "float32")) -> Shape:
+            R.match_shape(x, (n, m))
+            return (n * 2, m * 3)
+
+    mod = TestVMCompileStage2
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+
+    shape = (32, 16)
+    arr = tvm.nd.array(np.random.rand(*shape))
+    res = vm["foo"](arr)
+    assert res[0] == shape[0] * 2
+    assert res[1] == shape[1] * 3
+
+
+def test_vm_compile_stage3():
+    @tvm.script.ir_module
+    class TestVMCompileStage3:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                R.output(y)
+            return y
+
+    mod = TestVMCompileStage3
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+
+    shape = (32, 16)
+    inp = tvm.nd.array(np.random.rand(*shape).astype(np.float32))
+    res = vm["foo"](inp)
+    tvm.testing.assert_allclose(res.numpy(), inp.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_storage_reuse_across_invocations():
+    @tvm.script.ir_module
+    class TestVMStorageReuse:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                z = R.call_tir("test.vm.identity", (y), (32, 16), dtype="float32")
+                R.output(z)
+            return z
+
+    mod = TestVMStorageReuse
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+
+    shape = (32, 16)
+    inp0 = tvm.nd.array(np.random.rand(*shape).astype(np.float32))
+    inp1 = tvm.nd.array(np.random.rand(*shape).astype(np.float32))
+    res0 = vm["foo"](inp0)
+    res1 = vm["foo"](inp1)
+    # the output of the first invocation is alive, so its storage must not be reused
+    tvm.testing.assert_allclose(res0.numpy(), inp0.numpy(), rtol=1e-7, atol=1e-7)
+    tvm.testing.assert_allclose(res1.numpy(), inp1.numpy(), rtol=1e-7, atol=1e-7)
+    vm["clear_storage_cache"]()
+    res2 = vm["foo"](inp0)
+    tvm.testing.assert_allclose(res2.numpy(), inp0.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_kill_dead_registers():
+    @tvm.script.ir_module
+    class TestVMKillRegister:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                z = R.call_tir("test.vm.identity", (y), (32, 16), dtype="float32")
+                w = R.call_tir("test.vm.identity", (z), (32, 16), dtype="float32")
+                R.output(w)
+            return w
+
+    mod = TestVMKillRegister
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    # the intermediate tensors are released right after their last use
+    assert "kill" in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inp = tvm.nd.array(np.random.rand(32, 16).astype(np.float32))
+    res = vm["foo"](inp)
+    tvm.testing.assert_allclose(res.numpy(), inp.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_emit_kill_register():
+    ib = relax.ExecBuilder()
+    with ib.function("func0", num_inputs=2):
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.r(1)], dst=ib.r(2))
+        ib.emit_kill_register(ib.r(0))
+        ib.emit_ret(ib.r(2))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a = tvm.nd.array(np.random.rand(4))
+    b = tvm.nd.array(np.random.rand(4))
+    res = vm["func0"](a, b)
+    tvm.testing.assert_allclose(res.numpy(), a.numpy() + b.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_alloc_storage_and_tensor():
+    @tvm.script.ir_module
+    class TestVMAllocStorageAndTensor:
+        @R.function
+        def foo(x: Tensor((m, n), "float32")) -> Tensor:
+            y = R.call_tir("test.vm.identity", (x), (m, n), dtype="float32")
+            z = R.call_tir("test.vm.identity", (y), (m, n), dtype="float32")
+            return z
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMAllocStorageAndTensor, target)
+    # the storage of the intermediate tensor is allocated in the same call as the tensor
+    assert "vm.builtin.alloc_storage_and_tensor" in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inp = tvm.nd.array(np.random.rand(8, 4).astype(np.float32))
+    res = vm["foo"](inp)
+    tvm.testing.assert_allclose(res.numpy(), inp.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_invoke_with_outputs():
+    @tvm.script.ir_module
+    class TestVMInvokeWithOutputs:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                z = R.call_tir("test.vm.identity", (y), (32, 16), dtype="float32")
+                R.output(z)
+            return z
+
+        @R.function
+        def bar(x: Tensor((32, 16), "float32")) -> Tensor:
+            return x
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMInvokeWithOutputs, target)
+    # the returned tensor is allocated in the caller's buffer
+    assert "vm.builtin.alloc_output_tensor" in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    inp = tvm.nd.array(np.random.rand(32, 16).astype(np.float32))
+    out = tvm.nd.empty((32, 16), "float32")
+    vm.invoke_with_outputs("foo", [inp], [out])
+    tvm.testing.assert_allclose(out.numpy(), inp.numpy(), rtol=1e-7, atol=1e-7)
+    # results that are not allocated by the function are copied
+    out = tvm.nd.empty((32, 16), "float32")
+    vm.invoke_with_outputs("bar", [inp], [out])
+    tvm.testing.assert_allclose(out.numpy(), inp.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_sessions():
+    @tvm.script.ir_module
+    class TestVMSessions:
+        @R.function
+        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+            with R.dataflow():
+                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                z = R.call_tir("test.vm.identity", (y), (32, 16), dtype="float32")
+                R.output(z)
+            return z
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMSessions, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    sessions = [vm.create_session() for _ in range(4)]
+    inputs = [tvm.nd.array(np.random.rand(32, 16).astype(np.float32)) for _ in sessions]
+    results = [None] * len(sessions)
+
+    def run(i):
+        for _ in range(10):
+            results[i] = sessions[i]["foo"](inputs[i])
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(len(sessions))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for inp, res in zip(inputs, results):
+        tvm.testing.assert_allclose(res.numpy(), inp.numpy(), rtol=1e-7, atol=1e-7)
+
+
+def test_vm_dynamic_batcher():
+    @tvm.script.ir_module
+    class TestVMDynamicBatcher:
+        @R.function
+        def foo(x: Tensor(_, "float32")) -> Tensor:
+            with R.dataflow():
+                R.match_shape(x, (n, m))
+                y = R.call_tir("test.vm.tile", (x), (n, m * 2), dtype="float32")
+                R.output(y)
+            return y
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMDynamicBatcher, target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    # the batch is full once the four requests arrive, before the timeout expires
+    session = vm.create_session()
+    batcher = relax.vm.DynamicBatcher(session, "foo", max_batch_size=8, timeout_us=10**7)
+    inputs = [tvm.nd.array(np.random.rand(2, 16).astype(np.float32)) for _ in range(4)]
+    results = [None] * len(inputs)
+
+    def run(i):
+        results[i] = batcher(inputs[i])
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(len(inputs))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for inp, res in zip(inputs, results):
+        tvm.testing.assert_allclose(res.numpy(), np.tile(inp.numpy(), (1, 2)), rtol=1e-7, atol=1e-7)
+    stats = batcher.stats()
+    assert stats["num_requests"] == 4
+    assert stats["num_batches"] == 1
+    assert stats["avg_batch_size"] == 8
+
+
+def test_vm_pipeline():
+    @tvm.script.ir_module
+    class TestVMPipeline:
+        @R.function
+        def foo(x: Tensor(_, "float32")) -> Tensor:
+            with R.dataflow():
+                R.match_shape(x, (n, m))
+                y = R.call_tir("test.vm.tile", (x), (n, m * 2), dtype="float32")
+                R.output(y)
+            return y
+
     target = tvm.target.Target("llvm", host="llvm")
-    ex = relax.vm.build(mod, target)
-    inp1 = tvm.nd.array(np.random.rand(3, 4).astype(np.float32))
-    inp2 = tvm.nd.array(np.random.rand(3, 4).astype(np.float32))
+    ex = relax.vm.build(TestVMPipeline, target)
     vm = relax.VirtualMachine(ex, tvm.cpu())
-    vm["foo"](inp1, inp2)
-    tvm.testing.assert_allclose(inp2.numpy(), inp1.numpy(), rtol=1e-7, atol=1e-7)
-
-
-def test_vm_compile_stage1():
+    pipeline = relax.vm.VMPipeline(vm.create_session(), "foo", depth=2)
+    inputs = [tvm.nd.array(np.random.rand(i + 1, 16).astype(np.float32)) for i in range(5)]
+    results = pipeline.run_all([[inp] for inp in inputs])
+    assert len(results) == len(inputs)
+    for inp, res in zip(inputs, results):
+        tvm.testing.assert_allclose(res.numpy(), np.tile(inp.numpy(), (1, 2)), rtol=1e-7, atol=1e-7)
+    res = pipeline(inputs[0])
+    expected = np.tile(inputs[0].numpy(), (1, 2))
+    tvm.testing.assert_allclose(res.numpy(), expected, rtol=1e-7, atol=1e-7)
+    stats = pipeline.stats()
+    assert stats["num_requests"] == 6
+    assert stats["avg_latency_us"] >= stats["avg_host_us"]
+
+
+def test_vm_bucket_symbolic_dim():
     @tvm.script.ir_module
-    class TestVMCompileStage1:
+    class TestVMBucketSymbolicDim:
         @T.prim_func
-        def shape_func0(heap: T.handle) -> None:
-            # function attr dict
-            T.func_attr({"global_symbol": "shape_func0"})
-            H = T.match_buffer(
-                heap,
-                [T.int64(4)],
-                dtype="int64",
-                elem_offset=T.int64(0),
-                align=128,
-                offset_factor=1,
-            )
-            # body
-            H[2] = H[0] * T.int64(2)
-            H[3] = H[1] * T.int64(3)
+        def tir_add_one(x: T.handle, y: T.handle) -> None:
+            T.func_attr({"global_symbol": "tir_add_one"})
+            n = T.var("int64")
+            A = T.match_buffer(x, (n, 4))
+            B = T.match_buffer(y, (n, 4))
+            for i, j in T.grid(n, 4):
+                with T.block("add"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] + T.float32(1)
 
         @R.function
-        def foo(x: Tensor(_, "float32")):
-            shape_heap: Tensor((4,), "int64") = relax.call_packed(
-                "vm.builtin.alloc_shape_heap", (4,), type_args=(Tensor(ndim=1, dtype="int64"))
-            )
-            gv0 = relax.call_packed("vm.builtin.shape_of", x, type_args=(Shape))
-            gv1 = relax.call_packed(
-                "vm.builtin.store_shape", gv0, shape_heap, (0, 1), type_args=(Void)
-            )
-            gv2 = shape_func0(shape_heap)
-            gv3 = relax.call_packed("vm.builtin.load_shape", shape_heap, (2, 3), type_args=(Shape))
-            return gv3
+        def main(x: Tensor((n, 4), "float32")) -> Tensor:
+            gv0 = R.call_tir(tir_add_one, (x,), (n, 4), dtype="float32")
+            return gv0
+
+    mod = relax.transform.BucketSymbolicDim("main", "n", [8, 4])(TestVMBucketSymbolicDim)
+    names = [gv.name_hint for gv in mod.get_global_vars()]
+    for name in ["main_bucket4", "main_bucket8", "main_dynamic", "tir_add_one_bucket4"]:
+        assert name in names
+    # the kernel of a bucket is specialized to static shapes
+    kernel = mod["tir_add_one_bucket8"]
+    assert isinstance(kernel.buffer_map[kernel.params[0]].shape[0], tir.IntImm)
 
-    mod = TestVMCompileStage1
     target = tvm.target.Target("llvm", host="llvm")
     ex = relax.vm.build(mod, target)
     vm = relax.VirtualMachine(ex, tvm.cpu())
+    # below, at and beyond the buckets
+    for n in [3, 4, 6, 8, 11]:
+        inp = np.random.rand(n, 4).astype(np.float32)
+        res = vm["main"](tvm.nd.array(inp))
+        assert res.shape == (n, 4)
+        tvm.testing.assert_allclose(res.numpy(), inp + 1, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_attention_kv_cache():
+    fcreate = tvm.get_global_func("vm.builtin.attention_kv_cache_create")
+    fappend = tvm.get_global_func("vm.builtin.attention_kv_cache_append")
+    fview = tvm.get_global_func("vm.builtin.attention_kv_cache_view")
+    fslot = tvm.get_global_func("vm.builtin.attention_kv_cache_slot")
+    fcommit = tvm.get_global_func("vm.builtin.attention_kv_cache_commit")
+
+    init = np.random.rand(2, 16).astype(np.float32)
+    cache = fcreate(tvm.nd.array(init), tvm.runtime.ShapeTuple([2, 16]), 1)
+    rows = [init[:1]]
+    # the capacity grows beyond the reserved rows
+    for _ in range(5):
+        row = np.random.rand(1, 16).astype(np.float32)
+        cache = fappend(cache, tvm.nd.array(row))
+        rows.append(row)
+    view = fview(cache, tvm.runtime.ShapeTuple([6, 16]))
+    tvm.testing.assert_allclose(view.numpy(), np.concatenate(rows), rtol=1e-7, atol=1e-7)
+
+    # a kernel writes the slot in place, the commit marks the rows as filled
+    row = np.random.rand(2, 16).astype(np.float32)
+    slot = fslot(cache, tvm.runtime.ShapeTuple([2, 16]))
+    slot.copyfrom(row)
+    cache = fcommit(cache, slot)
+    rows.append(row)
+    view = fview(cache, tvm.runtime.ShapeTuple([8, 16]))
+    tvm.testing.assert_allclose(view.numpy(), np.concatenate(rows), rtol=1e-7, atol=1e-7)
+    with pytest.raises(TVMError):
+        fview(cache, tvm.runtime.ShapeTuple([7, 16]))
+
+
+def test_vm_paged_kv_cache():
+    fcreate = tvm.get_global_func("vm.builtin.paged_kv_cache_create")
+    fadd = tvm.get_global_func("vm.builtin.paged_kv_cache_add_sequence")
+    fremove = tvm.get_global_func("vm.builtin.paged_kv_cache_remove_sequence")
+    fappend = tvm.get_global_func("vm.builtin.paged_kv_cache_append")
+    fblock_table = tvm.get_global_func("vm.builtin.paged_kv_cache_block_table")
+    fpools = tvm.get_global_func("vm.builtin.paged_kv_cache_pools")
+    fnum_free = tvm.get_global_func("vm.builtin.paged_kv_cache_num_free_blocks")
+
+    num_blocks, block_size, num_heads, head_dim = 8, 4, 2, 8
+    shape = tvm.runtime.ShapeTuple([num_blocks, block_size, num_heads, head_dim])
+    cache = fcreate(shape, "float32", tvm.cpu())
+    seq_ids = [3, 7]
+    for seq_id in seq_ids:
+        fadd(cache, seq_id)
+    tokens = {seq_id: [] for seq_id in seq_ids}
+
+    def append(lengths):
+        kv = [np.random.rand(sum(lengths), num_heads, head_dim).astype("float32") for _ in range(2)]
+        fappend(
+            cache,
+            tvm.runtime.ShapeTuple(seq_ids),
+            tvm.runtime.ShapeTuple(lengths),
+            *map(tvm.nd.array, kv),
+        )
+        begin = 0
+        for seq_id, length in zip(seq_ids, lengths):
+            tokens[seq_id].append([x[begin : begin + length] for x in kv])
+            begin += length
+
+    # prefill, then decode one token per sequence and step
+    append([5, 3])
+    for _ in range(2):
+        append([1, 1])
+    assert fnum_free(cache) == num_blocks - 2 - 2
+
+    query = te.placeholder((2, num_heads, head_dim), "float32", name="query")
+    pool = [te.placeholder(tuple(shape), "float32", name=name) for name in ["k_pool", "v_pool"]]
+    table = te.placeholder((2, te.var("max_blocks")), "int32", name="block_table")
+    lens = te.placeholder((2,), "int32", name="seq_lens")
+    out = topi.nn.paged_attention(query, pool[0], pool[1], table, lens)
+    func = tvm.build(te.create_schedule(out.op), [query, *pool, table, lens, out], "llvm")
+
+    q = np.random.rand(2, num_heads, head_dim).astype("float32")
+    block_table, seq_lens = fblock_table(cache, tvm.runtime.ShapeTuple(seq_ids))
+    k_pool, v_pool = fpools(cache)
+    res = tvm.nd.empty(q.shape, "float32")
+    func(tvm.nd.array(q), k_pool, v_pool, block_table, seq_lens, res)
+    for i, seq_id in enumerate(seq_ids):
+        keys = np.concatenate([k for k, _ in tokens[seq_id]])
+        values = np.concatenate([v for _, v in tokens[seq_id]])
+        assert seq_lens.numpy()[i] == len(keys)
+        scores = np.einsum("hd,thd->ht", q[i], keys) / np.sqrt(head_dim)
+        probs = np.exp(scores - scores.max(axis=1, keepdims=True))
+        probs /= probs.sum(axis=1, keepdims=True)
+        expected = np.einsum("ht,thd->hd", probs, values)
+        tvm.testing.assert_allclose(res.numpy()[i], expected, rtol=1e-5, atol=1e-5)
+
+    # a sequence beyond the free blocks fails without taking any block
+    fadd(cache, 9)
+    with pytest.raises(TVMError):
+        fappend(
+            cache,
+            tvm.runtime.ShapeTuple([9]),
+            tvm.runtime.ShapeTuple([block_size * 5]),
+            *[tvm.nd.array(np.zeros((block_size * 5, num_heads, head_dim), "float32"))] * 2,
+        )
+    assert fnum_free(cache) == 4
+    for seq_id in seq_ids + [9]:
+        fremove(cache, seq_id)
+    assert fnum_free(cache) == num_blocks
+
+
+def test_vm_continuous_batcher():
+    fappend = tvm.get_global_func("vm.builtin.paged_kv_cache_append")
+    fnum_free = tvm.get_global_func("vm.builtin.paged_kv_cache_num_free_blocks")
+    num_blocks, block_size, num_heads, head_dim = 6, 4, 1, 2
+    shape = tvm.runtime.ShapeTuple([num_blocks, block_size, num_heads, head_dim])
+    cache = tvm.get_global_func("vm.builtin.paged_kv_cache_create")(shape, "float32", tvm.cpu())
+    batch_sizes = []
+
+    # the next token of a sequence is its last token plus one
+    @tvm.register_func("test.vm.decode_step", override=True)
+    def decode_step(cache, seq_ids, lengths, tokens):
+        kv = tvm.nd.array(np.zeros((sum(lengths), num_heads, head_dim), "float32"))
+        fappend(cache, seq_ids, lengths, kv, kv)
+        batch_sizes.append(len(seq_ids))
+        last = np.cumsum(list(lengths)) - 1
+        return tvm.nd.array((tokens.numpy()[last] + 1).astype("int32"))
 
-    shape = (32, 16)
-    arr = tvm.nd.array(np.random.rand(*shape))
-    res = vm["foo"](arr)
-    assert res[0] == shape[0] * 2
-    assert res[1] == shape[1] * 3
+    ib = relax.ExecBuilder()
+    with ib.function("decode", num_inputs=4):
+        ib.emit_call("test.vm.decode_step", args=[ib.r(i) for i in range(4)], dst=ib.r(4))
+        ib.emit_ret(ib.r(4))
+    vm = relax.VirtualMachine(ib.get(), tvm.cpu())
+    batcher = relax.vm.ContinuousBatcher(vm, "decode", cache, max_batch_size=2)
+
+    # every request takes up to 2 blocks, so at most 2 of them run at once
+    requests = [([1, 2, 3], 4, -1), ([10], 6, 13), ([20, 21], 5, -1), ([30, 31, 32, 33], 3, -1)]
+    results = [None] * len(requests)
+
+    def run(i):
+        results[i] = batcher.generate(*requests[i]).numpy().tolist()
+
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(len(requests))]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    for (prompt, max_new_tokens, stop_token), result in zip(requests, results):
+        expected = [prompt[-1] + i + 1 for i in range(max_new_tokens)]
+        if stop_token in expected:
+            expected = expected[: expected.index(stop_token) + 1]
+        assert result == expected
+    assert max(batch_sizes) <= 2
+    assert fnum_free(cache) == num_blocks
+    stats = batcher.stats()
+    assert stats["num_requests"] == len(requests)
+    assert stats["num_steps"] == len(batch_sizes)
+    assert stats["num_tokens"] == sum(len(result) for result in results)
+
+    # a request beyond the whole cache fails
+    with pytest.raises(TVMError):
+        batcher.generate([0] * (num_blocks * block_size), 1)
 
 
-def test_vm_compile_stage2():
+def test_vm_size_class_allocator():
     @tvm.script.ir_module
-    class TestVMCompileStage2:
+    class TestVMSizeClassAllocator:
         @R.function
-        def foo(x: Tensor(_, "float32")) -> Shape:
-            R.match_shape(x, (n, m))
-            return (n * 2, m * 3)
+        def foo(x: Tensor(_, "float32")) -> Tensor:
+            with R.dataflow():
+                R.match_shape(x, (n, m))
+                y = R.call_tir("test.vm.tile", (x), (n, m * 2), dtype="float32")
+                R.output(y)
+            return y
 
-    mod = TestVMCompileStage2
+    mod = TestVMSizeClassAllocator
     target = tvm.target.Target("llvm", host="llvm")
     ex = relax.vm.build(mod, target)
-    vm = relax.VirtualMachine(ex, tvm.cpu())
-
-    shape = (32, 16)
-    arr = tvm.nd.array(np.random.rand(*shape))
-    res = vm["foo"](arr)
-    assert res[0] == shape[0] * 2
-    assert res[1] == shape[1] * 3
-
-
-def test_vm_compile_stage3():
+    # use a device id that is not shared with other tests to get a fresh allocator
+    dev = tvm.cpu(1)
+    vm = relax.VirtualMachine(ex, dev, memory_cfg={dev: relax.VirtualMachine.SIZE_CLASS_ALLOCATOR})
+
+    for n in [33, 32, 31]:
+        inp = tvm.nd.array(np.random.rand(n, 16).astype(np.float32), dev)
+        res = vm["foo"](inp)
+        tvm.testing.assert_allclose(res.numpy(), np.tile(inp.numpy(), (1, 2)), rtol=1e-7, atol=1e-7)
+        # return the storage to the allocator instead of keeping it in the VM
+        del res
+        vm["clear_storage_cache"]()
+
+    stats = relax.VirtualMachine.memory_stats(dev)
+    assert stats["num_allocs"] == 3
+    # the smaller outputs reuse the block freed by the first invocation
+    assert stats["num_cache_hits"] == 2
+    assert stats["peak_bytes"] >= 33 * 32 * 4
+    relax.VirtualMachine.set_cache_limit(dev, 0)
+    assert relax.VirtualMachine.memory_stats(dev)["cached_bytes"] == 0
+
+
+def test_vm_memory_quota():
     @tvm.script.ir_module
-    class TestVMCompileStage3:
+    class TestVMMemoryQuota:
         @R.function
-        def foo(x: Tensor((32, 16), "float32")) -> Tensor:
+        def foo(x: Tensor(_, "float32")) -> Tensor:
             with R.dataflow():
-                y = R.call_tir("test.vm.identity", (x), (32, 16), dtype="float32")
+                R.match_shape(x, (n, m))
+                y = R.call_tir("test.vm.tile", (x), (n, m * 2), dtype="float32")
                 R.output(y)
             return y
 
-    mod = TestVMCompileStage3
     target = tvm.target.Target("llvm", host="llvm")
-    ex = relax.vm.build(mod, target)
-    vm = relax.VirtualMachine(ex, tvm.cpu())
-
-    shape = (32, 16)
-    inp = tvm.nd.array(np.random.rand(*shape).astype(np.float32))
+    ex = relax.vm.build(TestVMMemoryQuota, target)
+    dev = tvm.cpu()
+    quota = {"tenant": "test_vm_memory_quota.hard", "quota_bytes": 1 << 16}
+    vm = relax.VirtualMachine(ex, dev, memory_quota=quota)
+    inp = tvm.nd.array(np.random.rand(16, 16).astype(np.float32), dev)
     res = vm["foo"](inp)
-    tvm.testing.assert_allclose(res.numpy(), inp.numpy(), rtol=1e-7, atol=1e-7)
+    tvm.testing.assert_allclose(res.numpy(), np.tile(inp.numpy(), (1, 2)), rtol=1e-7, atol=1e-7)
+    stats = relax.VirtualMachine.tenant_memory_stats(quota["tenant"], dev)
+    assert stats["quota_bytes"] == 1 << 16
+    assert 0 < stats["held_bytes"] <= 1 << 16
+    # the output of the large input does not fit in the quota of the tenant
+    with pytest.raises(TVMError, match="quota"):
+        vm["foo"](tvm.nd.array(np.random.rand(1024, 16).astype(np.float32), dev))
+    assert relax.VirtualMachine.tenant_memory_stats(quota["tenant"], dev)["num_exceeded"] == 1
+
+    # a soft quota lets the allocations through, without caching the freed buffers
+    quota = {"tenant": "test_vm_memory_quota.soft", "quota_bytes": 0, "policy": "soft"}
+    vm = relax.VirtualMachine(ex, dev, memory_quota=quota)
+    for _ in range(2):
+        res = vm["foo"](inp)
+        tvm.testing.assert_allclose(res.numpy(), np.tile(inp.numpy(), (1, 2)), rtol=1e-7)
+        del res
+        vm["clear_storage_cache"]()
+    stats = relax.VirtualMachine.tenant_memory_stats(quota["tenant"], dev)
+    assert stats["num_exceeded"] >= 2
+    assert stats["num_cache_hits"] == 0
+
+
+@tvm.testing.requires_cuda
+def test_vm_stream_ordered_allocator():
+    @tvm.script.ir_module
+    class TestVMStreamOrderedAllocator:
+        @T.prim_func
+        def add_one(A: T.Buffer[(16,), "float32"], B: T.Buffer[(16,), "float32"]):
+            T.func_attr({"global_symbol": "add_one"})
+            for i in T.thread_binding(16, thread="threadIdx.x"):
+                with T.block("B"):
+                    vi = T.axis.spatial(16, i)
+                    B[vi] = A[vi] + T.float32(1)
+
+        @R.function
+        def main(x: Tensor((16,), "float32")):
+            y = R.call_tir(add_one, (x,), (16,), dtype="float32")
+            z = R.call_tir(add_one, (y,), (16,), dtype="float32")
+            return z
+
+    target = tvm.target.Target("cuda", host="llvm")
+    ex = relax.vm.build(TestVMStreamOrderedAllocator, target)
+    dev = tvm.cuda(0)
+    vm = relax.VirtualMachine(ex, dev, memory_cfg="stream_ordered")
+    for _ in range(3):
+        inp = np.random.rand(16).astype(np.float32)
+        res = vm["main"](tvm.nd.array(inp, dev))
+        tvm.testing.assert_allclose(res.numpy(), inp + 2, rtol=1e-7, atol=1e-7)
+        # the intermediate storage is freed in the order of the stream, without a sync
+        del res
+        vm["clear_storage_cache"]()
+    assert relax.VirtualMachine.memory_stats(dev)["num_allocs"] >= 3
+
+
+def test_vm_pooled_empty():
+    # use a device id that is not shared with other tests to get a fresh allocator
+    dev = tvm.cpu(2)
+    for _ in range(3):
+        arr = relax.vm.pooled_empty((256, 256), "float32", dev)
+        arr.copyfrom(np.ones((256, 256), "float32"))
+        assert arr.shape == (256, 256) and arr.dtype == "float32"
+        del arr
+    stats = relax.VirtualMachine.memory_stats(dev)
+    assert stats["num_allocs"] == 3
+    # the later arrays reuse the memory freed by the first one
+    assert stats["num_cache_hits"] == 2
+    assert stats["live_bytes"] == 0
 
 
 def test_vm_compile_e2e():
@@ -654,6 +2074,112 @@ def test_vm_emit_te_constant_param_gpu():
     tvm.testing.assert_allclose(add_res.numpy(), x_np + c_np, rtol=1e-7, atol=1e-7)
 
 
+def test_vm_async_constant_upload():
+    x_np = np.random.rand(2, 2).astype("float32")
+    c_nps = [np.random.rand(2, 2).astype("float32") for _ in range(4)]
+
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", (2, 2), relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x]):
+        with bb.dataflow():
+            lv = x
+            for c_np in c_nps:
+                lv = bb.emit_te(topi.add, lv, relax.const(c_np, "float32"))
+            gv = bb.emit_output(lv)
+        bb.emit_func_output(gv)
+
+    exec = relax.vm.build(bb.get(), "llvm")
+    dev = tvm.cpu()
+    expected = x_np + sum(c_nps)
+    # the first invocation waits for each constant as it uses it
+    vm = relax.VirtualMachine(exec, dev, async_constant_upload=True)
+    res = vm["main"](tvm.nd.array(x_np, dev))
+    tvm.testing.assert_allclose(res.numpy(), expected, rtol=1e-6, atol=1e-6)
+    res = vm["main"](tvm.nd.array(x_np, dev))
+    tvm.testing.assert_allclose(res.numpy(), expected, rtol=1e-6, atol=1e-6)
+    # a session created during the upload waits for all the constants
+    vm = relax.VirtualMachine(exec, dev, async_constant_upload=True)
+    session = vm.create_session()
+    res = session["main"](tvm.nd.array(x_np, dev))
+    tvm.testing.assert_allclose(res.numpy(), expected, rtol=1e-6, atol=1e-6)
+
+
+def test_vm_constant_dedup():
+    c_np = np.random.rand(2, 2).astype("float32")
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        c0 = ib.emit_constant(tvm.nd.array(c_np))
+        c1 = ib.emit_constant(tvm.nd.array(c_np.copy()))
+        c2 = ib.emit_constant(tvm.nd.array(c_np + 1))
+        name0 = ib.emit_constant("test.vm.add")
+        name1 = ib.emit_constant("test.vm.add")
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.c(c1)], dst=ib.r(1))
+        ib.emit_call("test.vm.add", args=[ib.r(1), ib.c(c2)], dst=ib.r(2))
+        ib.emit_ret(ib.r(2))
+    assert c0 == c1 and c0 != c2
+    assert name0 == name1
+    ex = ib.get()
+    assert "Constant pool (# 3)" in ex.stats()
+
+    x_np = np.random.rand(2, 2).astype("float32")
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    res = vm["main"](tvm.nd.array(x_np))
+    tvm.testing.assert_allclose(res.numpy(), x_np + 2 * c_np + 1, rtol=1e-6, atol=1e-6)
+
+
+@tvm.testing.requires_cuda
+def test_vm_shared_constants_across_executables():
+    x_np = np.random.rand(2, 2).astype("float32")
+    c_np = np.random.rand(2, 2).astype("float32")
+
+    def build():
+        bb = relax.BlockBuilder()
+        x = relax.Var("x", (2, 2), relax.DynTensorType(2, "float32"))
+        c = relax.const(c_np.copy(), "float32")
+        with bb.function("main", [x]):
+            with bb.dataflow():
+                lv0 = bb.emit_te(topi.add, x, c)
+                gv = bb.emit_output(lv0)
+            bb.emit_func_output(gv)
+        sch = tvm.tir.Schedule(bb.get(), debug_mask="all")
+        loops = sch.get_loops(sch.get_block(name="T_add", func_name="add"))
+        sch.bind(loops[0], "threadIdx.x")
+        return relax.vm.build(sch.mod, "cuda")
+
+    dev = tvm.cuda()
+    vm0 = relax.VirtualMachine(build(), dev)
+    hits = relax.VirtualMachine.shared_constant_stats()["num_hits"]
+    vm1 = relax.VirtualMachine(build(), dev)
+    assert relax.VirtualMachine.shared_constant_stats()["num_hits"] == hits + 1
+    for vm in [vm0, vm1]:
+        res = vm["main"](tvm.nd.array(x_np, dev))
+        tvm.testing.assert_allclose(res.numpy(), x_np + c_np, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_shared_host_constants_across_executables():
+    x_np = np.random.rand(2, 2).astype("float32")
+    c_np = np.random.rand(2, 2).astype("float32")
+
+    def build():
+        bb = relax.BlockBuilder()
+        x = relax.Var("x", (2, 2), relax.DynTensorType(2, "float32"))
+        c = relax.const(c_np.copy(), "float32")
+        with bb.function("main", [x]):
+            with bb.dataflow():
+                gv = bb.emit_output(bb.emit_te(topi.add, x, c))
+            bb.emit_func_output(gv)
+        return relax.vm.build(bb.get(), "llvm")
+
+    # The second VM holds the host constant of the first one instead of its own copy.
+    vm0 = relax.VirtualMachine(build(), tvm.cpu())
+    hits = relax.VirtualMachine.shared_constant_stats()["num_hits"]
+    vm1 = relax.VirtualMachine(build(), tvm.cpu())
+    assert relax.VirtualMachine.shared_constant_stats()["num_hits"] == hits + 1
+    for vm in [vm0, vm1]:
+        res = vm["main"](tvm.nd.array(x_np))
+        tvm.testing.assert_allclose(res.numpy(), x_np + c_np, rtol=1e-7, atol=1e-7)
+
+
 def test_vm_relax_symbolic_shape():
     bb = relax.BlockBuilder()
     n = tir.Var("n", "int64")
@@ -770,6 +2296,79 @@ def test_vm_tuplegetitem():
     tvm.testing.assert_allclose(res.numpy(), x_inp.numpy() + y_inp.numpy(), rtol=1e-7, atol=1e-7)
 
 
+def test_vm_invoke_fast_path():
+    tensor_type = relax.DynTensorType(2, "float32")
+    t = relax.Var("t", type_annotation=relax.TupleType([tensor_type, tensor_type]))
+    bb = relax.BlockBuilder()
+    with bb.function("main", [t]):
+        a = bb.emit(relax.TupleGetItem(t, 0))
+        b = bb.emit(relax.TupleGetItem(t, 1))
+        c = bb.emit(relax.call_packed("test.vm.add", a, b, type_args=(tensor_type)))
+        bb.emit_func_output(c)
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(bb.get(), target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    # The function is looked up once.
+    assert vm["main"] is vm["main"]
+    x = tvm.nd.array(np.random.rand(2, 3).astype("float32"))
+    y = tvm.nd.array(np.random.rand(2, 3).astype("float32"))
+    expected = x.numpy() + y.numpy()
+    # The nested tuple is converted by the VM.
+    res = vm["main"]((x, y))
+    tvm.testing.assert_allclose(res.numpy(), expected, rtol=1e-7, atol=1e-7)
+    # So is a DLTensor, viewed without a copy.
+    x_view = tvm.runtime.ndarray._make_array(x.handle, True, False)
+    res = vm["main"]([x_view, y])
+    tvm.testing.assert_allclose(res.numpy(), expected, rtol=1e-7, atol=1e-7)
+    # The inputs set by name convert the lists too.
+    vm.set_input("main", t=[x, y])
+    vm.invoke_stateful("main")
+    tvm.testing.assert_allclose(vm.get_outputs("main").numpy(), expected, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_invoke_dlpack():
+    bb = relax.BlockBuilder()
+    n = tir.Var("n", "int64")
+    with bb.function("main"):
+        x = nn.Placeholder((n,), dtype="float32", name="x")
+        y = nn.Placeholder((n,), dtype="float32", name="y")
+        bb.emit_func_output(relax.Tuple([relax.Tuple([x, y]), x]), params=[x, y])
+
+    class Producer:
+        """A tensor of another framework, exported through DLPack only."""
+
+        def __init__(self, array):
+            self.array = array
+            self.streams = []
+
+        def __dlpack__(self, stream=None):
+            self.streams.append(stream)
+            return self.array.to_dlpack()
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(bb.get(), target)
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    x = tvm.nd.array(np.random.rand(4).astype("float32"))
+    y = tvm.nd.array(np.random.rand(4).astype("float32"))
+    producer = Producer(x)
+    (cap_x, cap_y), cap_item = vm.invoke_dlpack("main", producer, y)
+    assert producer.streams == [None]
+
+    def data_ptr(array):
+        return array.handle.contents.data
+
+    # The outputs share the storage of the inputs.
+    out_x, out_y, out_item = [tvm.nd.from_dlpack(cap) for cap in (cap_x, cap_y, cap_item)]
+    assert data_ptr(out_x) == data_ptr(x) and data_ptr(out_item) == data_ptr(x)
+    tvm.testing.assert_allclose(out_y.numpy(), y.numpy())
+    # The inputs are exported to the stream of the VM.
+    vm.set_stream(0)
+    vm.invoke_dlpack("main", producer, y)
+    assert producer.streams == [None, 0]
+    vm.set_stream(None)
+
+
 def test_sub_func_call():
     @tvm.script.ir_module
     class TestVMSubFunction:
@@ -825,6 +2424,33 @@ def test_sub_func_call():
     tvm.testing.assert_allclose(res.numpy(), expected, rtol=1e-6, atol=1e-6)
 
 
+def test_vm_invoke_resolved_closure():
+    ib = relax.ExecBuilder()
+    with ib.function("lifted_func", num_inputs=3):
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.r(1)], dst=ib.r(3))
+        ib.emit_call("test.vm.mul", args=[ib.r(3), ib.r(2)], dst=ib.r(4))
+        ib.emit_ret(ib.r(4))
+    with ib.function("main", num_inputs=3):
+        x = ib.emit_constant("lifted_func")
+        ib.emit_call(
+            "vm.builtin.alloc_closure", args=[ib.vm_state(), ib.c(x), ib.r(2)], dst=ib.r(3)
+        )
+        ib.emit_call(
+            "vm.builtin.invoke_closure",
+            args=[ib.vm_state(), ib.r(3), ib.r(0), ib.r(1)],
+            dst=ib.r(4),
+        )
+        ib.emit_ret(ib.r(4))
+
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a_np, b_np, c_np = np.random.rand(2, 3), np.random.rand(2, 3), np.random.rand(2, 3)
+    a, b, c = tvm.nd.array(a_np), tvm.nd.array(b_np), tvm.nd.array(c_np)
+    for _ in range(2):
+        res = vm["main"](a, b, c)
+        tvm.testing.assert_allclose(res.numpy(), (a_np + b_np) * c_np, rtol=1e-7, atol=1e-7)
+
+
 def test_recursion():
     @tvm.script.ir_module
     class TestVMRecursion:
@@ -856,6 +2482,94 @@ def test_recursion():
     tvm.testing.assert_allclose(res.numpy(), np.power(2.0, recursion_runs), rtol=1e-7, atol=1e-7)
 
 
+def test_vm_tail_call():
+    @tvm.script.ir_module
+    class TestVMTailCall:
+        @R.function
+        def loop(i: Tensor((1,), "float32"), acc: Tensor((1,), "float32")) -> Tensor:
+            cond = relax.call_packed(
+                "test.vm.equal_zero", i, type_args=(Tensor(ndim=1, dtype="float32"))
+            )
+            if cond:
+                res = acc
+            else:
+                i1 = relax.call_packed(
+                    "test.vm.subtract_one", i, type_args=(Tensor(ndim=1, dtype="float32"))
+                )
+                acc1 = relax.call_packed(
+                    "test.vm.add", acc, i, type_args=(Tensor(ndim=1, dtype="float32"))
+                )
+                res = loop(i1, acc1)
+            return res
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(TestVMTailCall, target)
+    # the recursive call reuses the frame of the caller
+    assert "tail" in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    n = 5000
+    res = vm["loop"](tvm.nd.array(np.full(1, n, "float32")), tvm.nd.array(np.zeros(1, "float32")))
+    tvm.testing.assert_allclose(res.numpy(), [n * (n + 1) / 2], rtol=1e-7, atol=1e-7)
+
+    with tvm.transform.PassContext(config={"relax.VMCodeGen.tail_call": False}):
+        ex = relax.vm.build(TestVMTailCall, target)
+    assert "tail" not in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    res = vm["loop"](tvm.nd.array(np.full(1, 10, "float32")), tvm.nd.array(np.zeros(1, "float32")))
+    tvm.testing.assert_allclose(res.numpy(), [55], rtol=1e-7, atol=1e-7)
+
+
+def test_vm_tail_call_closure_and_packed():
+    ib = relax.ExecBuilder()
+    with ib.function("lifted_func", num_inputs=3):
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.r(1)], dst=ib.r(3))
+        ib.emit_call("test.vm.mul", args=[ib.r(3), ib.r(2)], dst=ib.r(4))
+        ib.emit_ret(ib.r(4))
+    with ib.function("main", num_inputs=3):
+        x = ib.emit_constant("lifted_func")
+        ib.emit_call(
+            "vm.builtin.alloc_closure", args=[ib.vm_state(), ib.c(x), ib.r(2)], dst=ib.r(3)
+        )
+        ib.emit_tail_call(
+            "vm.builtin.invoke_closure", args=[ib.vm_state(), ib.r(3), ib.r(0), ib.r(1)]
+        )
+    with ib.function("add", num_inputs=2):
+        # a packed function is called as usual and its result is returned
+        ib.emit_tail_call("test.vm.add", args=[ib.r(0), ib.r(1)])
+
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a_np, b_np, c_np = np.random.rand(2, 3), np.random.rand(2, 3), np.random.rand(2, 3)
+    a, b, c = tvm.nd.array(a_np), tvm.nd.array(b_np), tvm.nd.array(c_np)
+    for _ in range(2):
+        res = vm["main"](a, b, c)
+        tvm.testing.assert_allclose(res.numpy(), (a_np + b_np) * c_np, rtol=1e-7, atol=1e-7)
+    tvm.testing.assert_allclose(vm["add"](a, b).numpy(), a_np + b_np, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_frame_reuse():
+    ib = relax.ExecBuilder()
+    with ib.function("small", num_inputs=2):
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.r(1)], dst=ib.r(2))
+        ib.emit_ret(ib.r(2))
+    with ib.function("big", num_inputs=2):
+        ib.emit_call("small", args=[ib.r(0), ib.r(1)], dst=ib.r(2))
+        ib.emit_call("test.vm.mul", args=[ib.r(2), ib.r(1)], dst=ib.r(3))
+        ib.emit_call("small", args=[ib.r(3), ib.r(0)], dst=ib.r(4))
+        ib.emit_call("test.vm.add", args=[ib.r(4), ib.r(2)], dst=ib.r(5))
+        ib.emit_ret(ib.r(5))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    a_np = np.random.rand(4)
+    b_np = np.random.rand(4)
+    a, b = tvm.nd.array(a_np), tvm.nd.array(b_np)
+    # frames popped by one call are reused by the next, with a different register file size
+    for _ in range(3):
+        tvm.testing.assert_allclose(vm["small"](a, b).numpy(), a_np + b_np, rtol=1e-7, atol=1e-7)
+        expected = (a_np + b_np) * b_np + a_np + (a_np + b_np)
+        tvm.testing.assert_allclose(vm["big"](a, b).numpy(), expected, rtol=1e-7, atol=1e-7)
+
+
 def test_vm_closure():
     @tvm.script.ir_module
     class TestClosure:
@@ -985,5 +2699,327 @@ def test_set_input_rpc():
     check_remote(rpc.Server("127.0.0.1"))
 
 
+@pytest.mark.skipif(
+    not pipeline_executor.pipeline_executor_enabled(), reason="needs the pipeline executor"
+)
+def test_distributed_pipeline():
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", (2, 3), relax.DynTensorType(2, "float32"))
+    y = relax.Var("y", (2, 3), relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x, y]):
+        lv0 = bb.emit_te(topi.add, x, y)
+        lv1 = bb.emit_te(topi.multiply, x, y)
+        gv = bb.emit(relax.Tuple([lv0, lv1]))
+        bb.emit_func_output(gv)
+    ex = relax.vm.build(bb.get(), tvm.target.Target("llvm", host="llvm"))
+    # every stage runs on its own host, the servers stand in for the hosts
+    servers = [rpc.Server("127.0.0.1") for _ in range(3)]
+    sessions = [rpc.connect(server.host, server.port, session_timeout=30) for server in servers]
+    stages = [DistributedStage(session, ex, session.cpu(), "127.0.0.1") for session in sessions]
+    pipeline = DistributedPipeline(stages)
+
+    batches = [[np.random.rand(2, 3).astype(np.float32) for _ in range(2)] for _ in range(4)]
+    outputs = pipeline.run(batches)
+    for (x, y), (res0, res1) in zip(batches, outputs):
+        for _ in stages:
+            x, y = x + y, x * y
+        tvm.testing.assert_allclose(res0, x, rtol=1e-6)
+        tvm.testing.assert_allclose(res1, y, rtol=1e-6)
+
+
+@pytest.mark.skipif(
+    not pipeline_executor.pipeline_executor_enabled(), reason="needs the pipeline executor"
+)
+def test_pipeline_relax_vm_stage():
+    def build_stage(names, fcompute):
+        bb = relax.BlockBuilder()
+        x = relax.Var(names[0], (2, 3), relax.DynTensorType(2, "float32"))
+        y = relax.Var(names[1], (2, 3), relax.DynTensorType(2, "float32"))
+        with bb.function("main", [x, y]):
+            gv = bb.emit(fcompute(bb, x, y))
+            bb.emit_func_output(gv)
+        ex = relax.vm.build(bb.get(), tvm.target.Target("llvm", host="llvm"))
+        return pipeline_executor.relax_vm_stage(relax.VirtualMachine(ex, tvm.cpu()))
+
+    def add_and_multiply(bb, x, y):
+        return relax.Tuple([bb.emit_te(topi.add, x, y), bb.emit_te(topi.multiply, x, y)])
+
+    stages = [
+        build_stage(["x", "y"], add_and_multiply),
+        build_stage(["a", "b"], lambda bb, a, b: bb.emit_te(topi.subtract, a, b)),
+    ]
+    # the outputs of the first stage are forwarded to the inputs a and b of the second one
+    config = {
+        "module_connection": [
+            {
+                "mod_idx": 0,
+                "cpu_affinity": "",
+                "output": [
+                    {"output_idx": 0, "dependencies": [{"mod_idx": 1, "input_name": "a"}]},
+                    {"output_idx": 1, "dependencies": [{"mod_idx": 1, "input_name": "b"}]},
+                ],
+            },
+            {
+                "mod_idx": 1,
+                "cpu_affinity": "",
+                "output": [{"output_idx": 0, "dependencies": [{"global_output_index": 0}]}],
+            },
+        ],
+        "input_connection": [
+            {"global_interface_name": "x", "mod_idx": 0, "module_interface_name": "x"},
+            {"global_interface_name": "y", "mod_idx": 0, "module_interface_name": "y"},
+        ],
+        "param_connection": [],
+    }
+    create = tvm.get_global_func("tvm.pipeline_executor.create")
+    pipeline = pipeline_executor.PipelineModule(create(stages, json.dumps(config)))
+    assert pipeline.num_inputs == 2
+
+    batches = [[np.random.rand(2, 3).astype(np.float32) for _ in range(2)] for _ in range(4)]
+    for x_np, y_np in batches:
+        pipeline.set_input("x", tvm.nd.array(x_np))
+        pipeline.set_input("y", tvm.nd.array(y_np))
+        pipeline.run()
+    for x_np, y_np in batches:
+        outputs = pipeline.get_output()
+        for _ in range(100):
+            if len(outputs) > 0:
+                break
+            time.sleep(0.1)
+            outputs = pipeline.get_output()
+        assert len(outputs) == 1
+        tvm.testing.assert_allclose(outputs[0].numpy(), (x_np + y_np) - x_np * y_np, rtol=1e-6)
+
+
+def test_vm_scan():
+    ib = relax.ExecBuilder()
+    with ib.function("step", num_inputs=2):
+        ib.emit_call("test.vm.add", args=[ib.r(0), ib.r(1)], dst=ib.r(2))
+        ib.emit_call("runtime.Tuple", args=[ib.r(2), ib.r(1)], dst=ib.r(3))
+        ib.emit_ret(ib.r(3))
+    with ib.function("main", num_inputs=2):
+        x = ib.emit_constant("step")
+        ib.emit_call(
+            "vm.builtin.scan",
+            args=[ib.vm_state(), ib.c(x), ib.imm(4), ib.r(0), ib.r(1)],
+            dst=ib.r(2),
+        )
+        ib.emit_ret(ib.r(2))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    h_np, x_np = np.random.rand(3), np.random.rand(3)
+    h, x = tvm.nd.array(h_np), tvm.nd.array(x_np)
+    res = vm["main"](h, x)
+    tvm.testing.assert_allclose(res[0].numpy(), h_np + 4 * x_np, rtol=1e-7, atol=1e-7)
+    tvm.testing.assert_allclose(res[1].numpy(), x_np, rtol=1e-7, atol=1e-7)
+    # the initial states are not overwritten by the steps
+    tvm.testing.assert_allclose(h.numpy(), h_np, rtol=1e-7, atol=1e-7)
+
+
+def test_vm_compile_scan():
+    @tvm.script.ir_module
+    class TestVMScanStep:
+        @R.function
+        def step(h: Tensor((3,), "float32"), x: Tensor((3,), "float32")):
+            h1 = relax.call_packed("test.vm.add", h, x, type_args=(Tensor(ndim=1, dtype="float32")))
+            return (h1, x)
+
+    bb = relax.BlockBuilder(TestVMScanStep)
+    h = relax.Var("h", [3], relax.DynTensorType(1, "float32"))
+    x = relax.Var("x", [3], relax.DynTensorType(1, "float32"))
+    with bb.function("main", [h, x]):
+        step = bb.get().get_global_var("step")
+        out = bb.emit(relax.op.scan(step, [10], [h, x]))
+        bb.emit_func_output(out)
+    mod = bb.get()
+
+    target = tvm.target.Target("llvm", host="llvm")
+    ex = relax.vm.build(mod, target)
+    assert "vm.builtin.scan" in ex.as_text()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    h_np = np.random.rand(3).astype("float32")
+    x_np = np.random.rand(3).astype("float32")
+    res = vm["main"](tvm.nd.array(h_np), tvm.nd.array(x_np))
+    tvm.testing.assert_allclose(res[0].numpy(), h_np + 10 * x_np, rtol=1e-5, atol=1e-5)
+
+
+def test_vm_dispatch_kernel():
+    for i in range(3):
+        tvm.register_func(f"test.vm.variant{i}", lambda x, i=i: i, override=True)
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        dim = ib.emit_constant(tvm.runtime.ShapeTuple([0, 1]))
+        extents = ib.emit_constant(tvm.runtime.ShapeTuple([8, 32]))
+        names = [ib.emit_constant(f"test.vm.variant{i}") for i in range(3)]
+        args = [ib.vm_state(), ib.c(dim), ib.c(extents)] + [ib.c(name) for name in names]
+        ib.emit_call("vm.builtin.dispatch_kernel", args=args + [ib.r(0)], dst=ib.r(1))
+        ib.emit_ret(ib.r(1))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    # the variant serves the dimensions up to its extent, the last kernel the larger ones
+    for n, expected in [(1, 0), (8, 0), (9, 1), (32, 1), (33, 2), (100, 2)]:
+        assert vm["main"](tvm.nd.array(np.zeros((2, n), "float32"))) == expected
+
+
+def test_vm_missing_function_at_init():
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        ib.emit_call("test.vm.not_registered", args=[ib.r(0)], dst=ib.r(1))
+        ib.emit_ret(ib.r(1))
+    ex = ib.get()
+    # the function table is resolved once when the VM is initialized, not on the first call
+    with pytest.raises(TVMError, match="Cannot find function test.vm.not_registered"):
+        relax.VirtualMachine(ex, tvm.cpu())
+
+
+def test_vm_call_tir_dyn():
+    @tvm.register_func("test.vm.fill_offset", override=True)
+    def fill_offset(x, out, n, offset):
+        assert x.shape[0] == n
+        out.copyfrom(x.numpy() + offset)
+
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=3):
+        name = ib.emit_constant("test.vm.fill_offset")
+        ib.emit_call(
+            "vm.call_tir_dyn", args=[ib.vm_state(), ib.c(name), ib.r(0), ib.r(1), ib.r(2)]
+        )
+        ib.emit_ret(ib.r(1))
+    ex = ib.get()
+    vm = relax.VirtualMachine(ex, tvm.cpu())
+    # the kernel and the argument stack are reused across calls with different shapes
+    for n, offset in [(3, 1), (5, 2), (3, 7)]:
+        x_np = np.random.rand(n).astype("float32")
+        out = tvm.nd.empty((n,), "float32")
+        res = vm["main"](tvm.nd.array(x_np), out, tvm.runtime.ShapeTuple([n, offset]))
+        tvm.testing.assert_allclose(res.numpy(), x_np + offset, rtol=1e-6, atol=1e-6)
+
+
+def test_vm_dispatch_kernels_by_shape():
+    from tvm import meta_schedule as ms  # pylint: disable=import-outside-toplevel
+
+    @tvm.script.ir_module
+    class TestVMDispatchKernels:
+        @T.prim_func
+        def add_one(x: T.handle, y: T.handle) -> None:
+            T.func_attr({"global_symbol": "add_one"})
+            n = T.var("int64")
+            A = T.match_buffer(x, (n, 4))
+            B = T.match_buffer(y, (n, 4))
+            for i, j in T.grid(n, 4):
+                with T.block("add"):
+                    vi, vj = T.axis.remap("SS", [i, j])
+                    B[vi, vj] = A[vi, vj] + T.float32(1)
+
+        @R.function
+        def main(x: Tensor((n, 4), "float32")) -> Tensor:
+            gv0 = R.call_tir(add_one, (x,), (n, 4), dtype="float32")
+            return gv0
+
+    target = tvm.target.Target("llvm", host="llvm")
+    database = ms.database.MemoryDatabase()
+    kernel_mod = tvm.IRModule({"main": TestVMDispatchKernels["add_one"]})
+    task = ms.ExtractedTask("add_one", kernel_mod, target, [kernel_mod], 1)
+    for extent, factor in [(16, 2), (64, 8)]:
+        spec_mod = task.specialize({"n": extent}, 1).dispatched[0]
+        sch = tvm.tir.Schedule(spec_mod)
+        (i, _) = sch.get_loops(sch.get_block("add"))
+        sch.split(i, factors=[None, factor])
+        workload = database.commit_workload(spec_mod)
+        database.commit_tuning_record(
+            ms.database.TuningRecord(sch.trace, workload, [1.0], target, None)
+        )
+
+    mod = relax.transform.DispatchKernelsByShape(database, target, "n", [64, 16, 256])(
+        TestVMDispatchKernels
+    )
+    names = [gv.name_hint for gv in mod.get_global_vars()]
+    assert "add_one_n16" in names and "add_one_n64" in names and "add_one_n256" not in names
+    table = mod["add_one"].attrs["relax.kernel_dispatch_table"]
+    assert [int(e) for e in table["extents"]] == [16, 64]
+    assert [int(d) for d in table["dim"]] == [0, 0]
+
+    for exec_mode in ["bytecode", "compiled"]:
+        ex = relax.vm.build(mod, target, exec_mode=exec_mode)
+        vm = relax.VirtualMachine(ex, tvm.cpu())
+        for n in [3, 16, 40, 64, 100]:
+            inp = np.random.rand(n, 4).astype(np.float32)
+            res = vm["main"](tvm.nd.array(inp))
+            tvm.testing.assert_allclose(res.numpy(), inp + 1, rtol=1e-7, atol=1e-7)
+    assert "vm.builtin.dispatch_kernel" in relax.vm.build(mod, target).as_text()
+
+
+def test_vm_ccl_builtins():
+    allreduce = tvm.get_global_func("vm.builtin.ccl.allreduce")
+    allgather = tvm.get_global_func("vm.builtin.ccl.allgather")
+    a = np.random.rand(4, 3).astype(np.float32)
+    b = np.random.rand(4, 3).astype(np.float32)
+
+    def group():
+        return tvm.runtime.container.tuple_object([tvm.nd.array(a), tvm.nd.array(b)])
+
+    # the VM is only used to resolve the devices of the shards on a copy
+    summed = allreduce(None, group())
+    for shard in summed:
+        tvm.testing.assert_allclose(shard.numpy(), a + b, rtol=1e-6, atol=1e-6)
+    gathered = allgather(None, group(), tvm.runtime.ShapeTuple([1]))
+    for shard in gathered:
+        tvm.testing.assert_allclose(shard.numpy(), np.concatenate([a, b], axis=1))
+
+    # without a communicator, the send moves the tensor to a device of the VM
+    ib = relax.ExecBuilder()
+    with ib.function("main", num_inputs=1):
+        peer = ib.emit_constant(tvm.runtime.ShapeTuple([0]))
+        ib.emit_call("vm.builtin.ccl.send", args=[ib.vm_state(), ib.r(0), ib.c(peer)], dst=ib.r(1))
+        ib.emit_ret(ib.r(1))
+    vm = relax.VirtualMachine(ib.get(), tvm.cpu())
+    tvm.testing.assert_allclose(vm["main"](tvm.nd.array(a)).numpy(), a)
+    with pytest.raises(TVMError):
+        allreduce(None, tvm.nd.array(a))
+
+
+@tvm.testing.requires_cuda
+@pytest.mark.skipif(not tvm.cuda(1).exist, reason="needs two GPUs")
+def test_vm_shard_tensor_parallel():
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", (4, 8), relax.DynTensorType(2, "float32"))
+    w0 = relax.Var("w0", (8, 16), relax.DynTensorType(2, "float32"))
+    w1 = relax.Var("w1", (16, 8), relax.DynTensorType(2, "float32"))
+    with bb.function("main", [x, w0, w1]):
+        with bb.dataflow():
+            lv0 = bb.emit_te(topi.nn.matmul, x, w0)
+            lv1 = bb.emit_te(topi.nn.relu, lv0)
+            lv2 = bb.emit_te(topi.nn.matmul, lv1, w1)
+            gv = bb.emit_output(lv2)
+        bb.emit_func_output(gv)
+    mod = bb.get()
+    mod["main"] = mod["main"].with_attr("relax.sharding", {"w0": 1, "w1": 0})
+    mod = relax.transform.ShardTensorParallel(2)(mod)
+
+    sch = tvm.tir.Schedule(mod)
+    for gv in mod.get_global_vars():
+        if isinstance(mod[gv], tir.PrimFunc):
+            sch.work_on(gv.name_hint)
+            block = sch.get_child_blocks(sch.get_block("root"))[0]
+            loops = sch.get_loops(block)
+            spatial = [loop for loop in loops if sch.get(loop).kind == tir.ForKind.SERIAL]
+            num_spatial = len(sch.get(block).iter_vars) - len(
+                [v for v in sch.get(block).iter_vars if v.iter_type == tir.IterVar.CommReduce]
+            )
+            sch.bind(sch.fuse(*spatial[:num_spatial]), "threadIdx.x")
+    ex = relax.vm.build(sch.mod, tvm.target.Target("cuda", host="llvm"))
+    devices = [tvm.cuda(0), tvm.cuda(1)]
+    vm = relax.VirtualMachine(ex, devices + [tvm.cpu()])
+
+    x_np = np.random.rand(4, 8).astype(np.float32)
+    w0_np = np.random.rand(8, 16).astype(np.float32)
+    w1_np = np.random.rand(16, 8).astype(np.float32)
+    w0_shards = relax.transform.shard_tensor(w0_np, 1, devices)
+    w1_shards = relax.transform.shard_tensor(w1_np, 0, devices)
+    res = vm["main"](tvm.nd.array(x_np, devices[0]), w0_shards, w1_shards)
+    expected = np.maximum(x_np @ w0_np, 0) @ w1_np
+    tvm.testing.assert_allclose(res.numpy(), expected, rtol=1e-5, atol=1e-5)
+
+
 if __name__ == "__main__":
     pytest.main([__file__])
@@ -0,0 +1,63 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import tvm
+import tvm.testing
+from tvm import te
+
+
+def test_simplify_cache_hit():
+    ana = tvm.arith.Analyzer()
+    ana.enable_simplify_cache(16)
+    x = te.var("x")
+    expr = (x * 4 + 8) // 4 - x
+    assert ana.simplify(expr).value == 2
+    assert ana.simplify(expr).value == 2
+    assert ana.simplify_cache_stats() == (1, 1)
+
+
+def test_simplify_cache_constraint_scope():
+    ana = tvm.arith.Analyzer()
+    ana.enable_simplify_cache(16)
+    x = te.var("x")
+    expr = tvm.te.max(x, 0)
+    assert not isinstance(ana.simplify(expr), tvm.tir.IntImm)
+    with ana.constraint_scope(x < 0):
+        # the constraint changes the result, the memo is not used
+        assert ana.simplify(expr).value == 0
+    # the state of the enclosing scope is back, so is the memoized result
+    assert not isinstance(ana.simplify(expr), tvm.tir.IntImm)
+    assert ana.simplify_cache_stats() == (1, 2)
+    # a binding invalidates the memo
+    ana.bind(x, 3)
+    assert ana.simplify(expr).value == 3
+
+
+def test_simplify_cache_pass_config():
+    x = te.var("x")
+    with tvm.transform.PassContext(config={"arith.simplify_cache_size": 16}):
+        ana = tvm.arith.Analyzer()
+    ana.simplify(x + 1 - 1)
+    ana.simplify(x + 1 - 1)
+    assert ana.simplify_cache_stats()[0] == 0
+    expr = x + 1 - 1
+    ana.simplify(expr)
+    ana.simplify(expr)
+    assert ana.simplify_cache_stats()[0] == 1
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
@@ -18,6 +18,7 @@
 import numpy as np
 
 import tvm
+import tvm.contrib.utils
 from tvm import te
 from tvm.ir.module import IRModule
 from tvm.script import tir as T
@@ -139,8 +140,28 @@ def test_lower_build_lowered_module():
     _check_module_with_numpy(mod)
 
 
+def test_build_kernel_cache():
+    stats = tvm.get_global_func("driver.kernel_cache_stats")
+    temp = tvm.contrib.utils.tempdir()
+    config = {"driver.kernel_cache_dir": temp.relpath("cache")}
+    start = stats()
+    with tvm.transform.PassContext(config=config):
+        tvm.build(matmul, target="llvm")
+    assert stats()["misses"] == start["misses"] + 1
+    # the second build loads the module built by the first one
+    with tvm.transform.PassContext(config=config):
+        mod = tvm.build(matmul, target="llvm")
+    assert stats()["hits"] == start["hits"] + 1
+    _check_module_with_numpy(mod)
+    # another target does not hit
+    with tvm.transform.PassContext(config=config):
+        tvm.build(matmul, target="llvm -mcpu=core-avx2")
+    assert stats()["misses"] == start["misses"] + 2
+
+
 if __name__ == "__main__":
     test_lower_build_te_schedule()
     test_lower_build_tir_func()
     test_lower_build_tir_module()
     test_lower_build_lowered_module()
+    test_build_kernel_cache()
@@ -26,12 +26,20 @@ import tvm.testing
 
 from tvm import script
 from tvm._ffi import register_func
+from tvm.meta_schedule.arg_info import ArgInfo
 from tvm.meta_schedule.builder import (
     BuilderInput,
     BuilderResult,
+    InProcessBuilder,
     LocalBuilder,
     PyBuilder,
 )
+from tvm.meta_schedule.builder.in_process_builder import (
+    is_in_memory_artifact,
+    load_in_memory_artifact,
+)
+from tvm.meta_schedule.runner import EvaluatorConfig, LocalRunner, RunnerInput
+from tvm.meta_schedule.utils import remove_build_dir
 from tvm.runtime import Module
 from tvm.script import tir as T
 from tvm.target import Target
@@ -134,6 +142,38 @@ def test_meta_schedule_multiple_build():
     _check_build_results(builder_results)
 
 
+def test_meta_schedule_in_process_build():
+    """Test the builder keeping the built modules in memory"""
+    builder = InProcessBuilder(max_workers=2)
+    builder_inputs = [
+        BuilderInput(MatmulModule, Target("llvm")),
+        BuilderInput(MatmulReluModule, Target("llvm")),
+        BuilderInput(BatchMatmulModule, Target("llvm")),
+    ]
+    builder_results = builder.build(builder_inputs)
+    assert len(builder_results) == len(builder_inputs)
+    for result in builder_results:
+        assert result.error_msg is None
+        assert is_in_memory_artifact(result.artifact_path)
+    artifact_paths = {str(result.artifact_path) for result in builder_results}
+    assert len(artifact_paths) == len(builder_inputs)
+
+    runner = LocalRunner(evaluator_config=EvaluatorConfig(number=1, repeat=1, min_repeat_ms=0))
+    runner_inputs = [
+        RunnerInput(result.artifact_path, "llvm", ArgInfo.from_entry_func(build_input.mod))
+        for result, build_input in zip(builder_results, builder_inputs)
+    ]
+    for future in runner.run(runner_inputs):
+        runner_result = future.result()
+        assert runner_result.error_msg is None
+        assert len(runner_result.run_secs) == 1
+
+    for artifact_path in artifact_paths:
+        remove_build_dir(artifact_path)
+    with pytest.raises(tvm.TVMError):
+        load_in_memory_artifact(artifact_paths.pop())
+
+
 def test_meta_schedule_error_handle_test_builder():
     """Test the error handing during building"""
 
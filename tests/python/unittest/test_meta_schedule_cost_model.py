@@ -228,5 +228,31 @@ def test_meta_schedule_xgb_model_reupdate():
     model.predict(TuneContext(), [_dummy_candidate() for i in range(predict_sample_count)])
 
 
+def test_meta_schedule_xgb_model_warm_start():
+    extractor = RandomFeatureExtractor()
+    model = XGBModel(extractor=extractor, num_warmup_samples=10)
+    update_sample_count = 20
+    model.update(
+        TuneContext(),
+        [_dummy_candidate() for i in range(update_sample_count)],
+        [_dummy_result() for i in range(update_sample_count)],
+    )
+    with tempfile.NamedTemporaryFile() as path:
+        model.save(path.name)
+        # A new session warm-starts from the saved model, without retraining it.
+        warm = XGBModel(extractor=RandomFeatureExtractor(), online_fine_tune=False)
+        warm.load(path.name)
+        booster = warm.booster
+        assert booster is not None
+        assert warm.data_size == update_sample_count
+        warm.update(
+            TuneContext(),
+            [_dummy_candidate() for i in range(update_sample_count)],
+            [_dummy_result() for i in range(update_sample_count)],
+        )
+        assert warm.booster is booster
+        assert warm.data_size == 2 * update_sample_count
+
+
 if __name__ == "__main__":
     tvm.testing.main()
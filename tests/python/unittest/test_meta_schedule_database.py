@@ -294,5 +294,45 @@ def test_meta_schedule_database_reload():
             _equal_record(ret[1], records[2])
 
 
+def test_meta_schedule_database_top_k_per_workload():
+    mod: IRModule = Matmul
+    mod_2: IRModule = MatmulRelu
+    with tempfile.TemporaryDirectory() as tmpdir:
+        database = _create_tmp_database(tmpdir)
+        token = database.commit_workload(mod)
+        token_2 = database.commit_workload(mod_2)
+        trace = _create_schedule(mod, _schedule_matmul).trace
+        trace_2 = _create_schedule(mod_2, _schedule_matmul).trace
+        records, records_2 = [], []
+        # the records of the two workloads are interleaved, the ones of mod_2 being faster
+        for run_secs in [[3.0], [1.0], [2.0]]:
+            for workload, mod_trace, committed, scale in [
+                (token, trace, records, 1.0),
+                (token_2, trace_2, records_2, 0.1),
+            ]:
+                record = ms.database.TuningRecord(
+                    mod_trace,
+                    workload,
+                    [run_secs[0] * scale],
+                    tvm.target.Target("llvm"),
+                    ms.arg_info.ArgInfo.from_prim_func(func=workload.mod["main"]),
+                )
+                database.commit_tuning_record(record)
+                committed.append(record)
+        new_database = ms.database.JSONDatabase(
+            path_workload=database.path_workload,
+            path_tuning_record=database.path_tuning_record,
+        )
+        for db in [database, new_database]:
+            ret = db.get_top_k(db.commit_workload(mod), 2)
+            assert len(ret) == 2
+            _equal_record(ret[0], records[1])
+            _equal_record(ret[1], records[2])
+            ret = db.get_top_k(db.commit_workload(mod_2), 5)
+            assert len(ret) == 3
+            for ret_record, record in zip(ret, [records_2[1], records_2[2], records_2[0]]):
+                _equal_record(ret_record, record)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
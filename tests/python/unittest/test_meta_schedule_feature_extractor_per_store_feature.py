@@ -18,6 +18,7 @@
 import sys
 from typing import Callable, List
 
+import numpy as np
 import pytest
 import tvm
 import tvm.testing
@@ -1588,5 +1589,40 @@ def test_cpu_layout_transform():
     )
 
 
+def test_cpu_batched_and_cached():
+    def _create_schedule():
+        sch = tir.Schedule(matmul, debug_mask="all")
+        i, _, _ = sch.get_loops(sch.get_block("C"))
+        sch.parallel(i)
+        return sch
+
+    context = _make_context(tvm.target.Target("llvm"))
+    # The first two candidates are structurally equal and only extracted once
+    candidates = [
+        _make_candidate(_create_schedule),
+        _make_candidate(_create_schedule),
+        _make_candidate(lambda: tir.Schedule(LayoutTransform)),
+    ]
+    uncached = ms.feature_extractor.PerStoreFeature(feature_cache_size=0)
+    expected = [x.numpy() for x in uncached.extract_from(context, candidates)]
+    extractor = ms.feature_extractor.PerStoreFeature(feature_cache_size=2)
+    for _ in range(2):
+        features, row_offsets = extractor.extract_batched_from(context, candidates)
+        features = features.numpy()
+        row_offsets = row_offsets.numpy()
+        assert features.dtype == "float32"
+        assert features.shape == (sum(x.shape[0] for x in expected), N_FEATURES)
+        assert list(row_offsets) == [0] + list(np.cumsum([x.shape[0] for x in expected]))
+        for i, feature in enumerate(expected):
+            assert_allclose(
+                actual=features[row_offsets[i] : row_offsets[i + 1]],
+                desired=feature,
+                rtol=1e-5,
+                atol=1e-5,
+            )
+    for actual, desired in zip(extractor.extract_from(context, candidates), expected):
+        assert_allclose(actual=actual.numpy(), desired=desired, rtol=1e-5, atol=1e-5)
+
+
 if __name__ == "__main__":
     tvm.testing.main()
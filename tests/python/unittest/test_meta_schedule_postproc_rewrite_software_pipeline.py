@@ -0,0 +1,94 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
+# pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
+
+import tvm
+import tvm.testing
+from tvm import tir
+from tvm.meta_schedule import TuneContext
+from tvm.meta_schedule.postproc import RewriteSoftwarePipeline
+from tvm.meta_schedule.testing import te_workload
+from tvm.target import Target
+from tvm.te import create_prim_func
+
+
+def _create_context(mod, target) -> TuneContext:
+    ctx = TuneContext(
+        mod=mod,
+        target=target,
+        postprocs=[
+            RewriteSoftwarePipeline(),
+        ],
+        task_name="test",
+    )
+    return ctx
+
+
+def _schedule_matmul(mod):
+    sch = tir.Schedule(mod, debug_mask="all")
+    # fmt: off
+    # pylint: disable=line-too-long,invalid-name
+    b0 = sch.get_block(name="C", func_name="main")
+    b1 = sch.cache_write(block=b0, write_buffer_index=0, storage_scope="local")
+    l2, l3, l4 = sch.get_loops(block=b0)
+    l10, l11, l12, l13, l14 = sch.split(loop=l2, factors=[1, 16, 1, 2, 16])
+    l20, l21, l22, l23, l24 = sch.split(loop=l3, factors=[16, 1, 8, 2, 2])
+    l28, l29, l30 = sch.split(loop=l4, factors=[16, 4, 8])
+    sch.reorder(l10, l20, l11, l21, l12, l22, l28, l29, l13, l23, l30, l14, l24)
+    l31 = sch.fuse(l10, l20)
+    sch.bind(loop=l31, thread_axis="blockIdx.x")
+    l32 = sch.fuse(l11, l21)
+    sch.bind(loop=l32, thread_axis="vthread.x")
+    l33 = sch.fuse(l12, l22)
+    sch.bind(loop=l33, thread_axis="threadIdx.x")
+    b34 = sch.cache_read(block=b0, read_buffer_index=0, storage_scope="shared")
+    sch.compute_at(block=b34, loop=l28, preserve_unit_loops=True)
+    b44 = sch.cache_read(block=b0, read_buffer_index=1, storage_scope="shared")
+    sch.compute_at(block=b44, loop=l28, preserve_unit_loops=True)
+    sch.reverse_compute_at(block=b1, loop=l33, preserve_unit_loops=True)
+    # pylint: enable=line-too-long,invalid-name
+    # fmt: on
+    return sch
+
+
+def test_rewrite_software_pipeline():
+    mod = create_prim_func(te_workload.matmul(n=512, m=512, k=512))
+    ctx = _create_context(mod, Target("nvidia/nvidia-a100", host="llvm"))
+    sch = _schedule_matmul(mod)
+    sch.enter_postproc()
+    assert ctx.postprocs[0].apply(sch)
+    k0 = sch.get(sch.get_loops(sch.get_block("C"))[3])
+    assert [int(x) for x in k0.annotations["software_pipeline_stage"]] == [0, 0, 1]
+    assert [int(x) for x in k0.annotations["software_pipeline_order"]] == [0, 1, 2]
+    assert [int(x) for x in k0.annotations["software_pipeline_async_stages"]] == [0]
+    # The copies of the pipeline are committed as groups of async copies.
+    assert "ptx_commit_group" in tvm.lower(sch.mod["main"]).script()
+
+
+def test_rewrite_software_pipeline_before_sm80():
+    mod = create_prim_func(te_workload.matmul(n=512, m=512, k=512))
+    ctx = _create_context(mod, Target("nvidia/geforce-rtx-2080-ti", host="llvm"))
+    sch = _schedule_matmul(mod)
+    sch.enter_postproc()
+    assert ctx.postprocs[0].apply(sch)
+    k0 = sch.get(sch.get_loops(sch.get_block("C"))[3])
+    assert "software_pipeline_stage" not in k0.annotations
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
@@ -778,6 +778,16 @@ def GMMCUDATensorCore(
                         )
 
 
+@T.prim_func
+def AddCudaTooManyThreads(A: T.Buffer[(4, 64, 32), "float32"], B: T.Buffer[(4, 64, 32), "float32"]) -> None:
+    for i in T.thread_binding(4, thread="blockIdx.x"):
+        for j in T.thread_binding(64, thread="threadIdx.y"):
+            for k in T.thread_binding(32, thread="threadIdx.x"):
+                with T.block("B"):
+                    vi, vj, vk = T.axis.remap("SSS", [i, j, k])
+                    B[vi, vj, vk] = A[vi, vj, vk] + T.float32(1)
+
+
 # fmt: on
 # pylint: enable=invalid-name,no-member,line-too-long,too-many-nested-blocks,no-self-argument,not-callable,misplaced-comparison-constant
 
@@ -796,6 +806,7 @@ def test_postproc_check_pass(mod):
         Conv2dCuda3,  # Should fail due to too many threads per block (large threadIdx.x extent)
         GmmCuda1,
         GmmCuda2,
+        AddCudaTooManyThreads,  # Rejected before lowering, as it binds 64 * 32 threads per block
     ],
 )
 def test_postproc_check_fail(mod):
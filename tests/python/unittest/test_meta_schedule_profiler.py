@@ -36,6 +36,30 @@ def test_meta_schedule_profiler_context_manager():
     assert 1.9 <= result["Level1"] <= 2.1
 
 
+def test_meta_schedule_profiler_task_breakdown():
+    with ms.Profiler() as profiler:
+        with ms.Profiler.task("A"):
+            with ms.Profiler.timeit("Build"):
+                time.sleep(0.2)
+            with ms.Profiler.task("A"):
+                time.sleep(0.1)
+        with ms.Profiler.task("B"):
+            with ms.Profiler.timeit("Build"):
+                time.sleep(0.1)
+        with ms.Profiler.timeit("Build"):
+            time.sleep(0.1)
+
+    result = profiler.json()
+    assert 0.39 <= result["stats_sec"]["Build"] <= 0.5
+    assert set(result["tasks"]) == {"A", "B"}
+    task_a = result["tasks"]["A"]
+    assert 0.19 <= task_a["stats_sec"]["Build"] <= 0.25
+    # the nested scope of the same task is counted once
+    assert 0.29 <= task_a["stats_sec"]["Total"] <= 0.4
+    assert task_a["num_trials"] == 0
+    assert 0.09 <= result["tasks"]["B"]["stats_sec"]["Build"] <= 0.15
+
+
 def test_meta_schedule_no_context():
     with ms.Profiler.timeit("Level0"):
         assert ms.Profiler.current() is None
@@ -43,4 +67,5 @@ def test_meta_schedule_no_context():
 
 if __name__ == "__main__":
     test_meta_schedule_profiler_context_manager()
+    test_meta_schedule_profiler_task_breakdown()
     test_meta_schedule_no_context()
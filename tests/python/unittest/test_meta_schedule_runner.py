@@ -31,6 +31,7 @@ from tvm.meta_schedule.builder import BuilderInput, LocalBuilder
 from tvm.meta_schedule.runner import (
     EvaluatorConfig,
     LocalRunner,
+    PersistentRPCRunner,
     PyRunner,
     RPCConfig,
     RPCRunner,
@@ -47,6 +48,7 @@ from tvm.meta_schedule.runner.rpc_runner import (
 from tvm.meta_schedule.runner.rpc_runner import (
     default_alloc_argument as rpc_default_alloc_argument,
 )
+from tvm.meta_schedule.runner.utils import BestCostTracker, run_evaluator_common
 from tvm.meta_schedule.testing.local_rpc import LocalRPC
 from tvm.meta_schedule.utils import (
     derived_object,
@@ -295,6 +297,119 @@ def test_meta_schedule_rpc_multiple_runs():
         _clean_build(builder_result.artifact_path)
 
 
+def test_meta_schedule_persistent_rpc_runner():
+    """Test the rpc runner reusing its session across batches"""
+    mods = [MatmulModule, MatmulReluModule, BatchMatmulModule]
+    builder = LocalBuilder()
+    builder_results = builder.build([BuilderInput(mod, Target("llvm")) for mod in mods])
+    for builder_result in builder_results:
+        assert builder_result.artifact_path is not None
+        assert builder_result.error_msg is None
+
+    args_infos = [
+        [TensorInfo("float32", (MATMUL_N, MATMUL_N)) for _ in range(3)],
+        [TensorInfo("float32", (MATMUL_N, MATMUL_N)) for _ in range(3)],
+        [TensorInfo("float32", [16, MATMUL_M, MATMUL_M]) for _ in range(3)],
+    ]
+    runner_inputs = [
+        RunnerInput(builder_results[i].artifact_path, "llvm", args_infos[i])
+        for i in range(len(mods))
+    ]
+
+    num_created_sessions = 0
+
+    def create_session(rpc_config: RPCConfig) -> RPCSession:
+        nonlocal num_created_sessions
+        num_created_sessions += 1
+        return rpc_config.connect_tracker().request(rpc_config.tracker_key)
+
+    with LocalRPC() as rpc:
+        rpc_config = RPCConfig(
+            tracker_host=rpc.tracker_host,
+            tracker_port=rpc.tracker_port,
+            tracker_key=rpc.tracker_key,
+            session_priority=1,
+            session_timeout_sec=100,
+        )
+        evaluator_config = EvaluatorConfig(
+            number=1,
+            repeat=2,
+            min_repeat_ms=0,
+            enable_cpu_cache_flush=False,
+        )
+        runner = PersistentRPCRunner(
+            rpc_config,
+            evaluator_config,
+            alloc_repeat=2,
+            batch_size=2,
+            f_create_session=create_session,
+        )
+        # Two runs of two batches each, all on the same session
+        runner_results = []
+        for _ in range(2):
+            runner_futures = runner.run(runner_inputs)
+            runner_results += [runner_future.result() for runner_future in runner_futures]
+
+    assert num_created_sessions == 1
+    for runner_result in runner_results:
+        assert runner_result.error_msg is None
+        assert len(runner_result.run_secs) == 4
+        for result in runner_result.run_secs:
+            if isinstance(result, FloatImm):
+                result = result.value
+            assert isinstance(result, float)
+            assert result >= 0.0
+
+    for builder_result in builder_results:
+        _clean_build(builder_result.artifact_path)
+
+
+def test_meta_schedule_adaptive_evaluation():
+    """Test stopping the measurement of the clearly slower candidates"""
+
+    class FakeModule:
+        entry_name = "main"
+
+        def __init__(self, cost: float) -> None:
+            self.cost = cost
+            self.num_calls = 0
+
+        def time_evaluator(self, **kwargs):  # pylint: disable=unused-argument
+            def evaluator(*args):  # pylint: disable=unused-argument
+                self.num_calls += 1
+                return tvm.runtime.module.BenchmarkResult([self.cost])
+
+            return evaluator
+
+    class FakeDevice:
+        def sync(self) -> None:
+            pass
+
+    def measure(cost: float, evaluator_config: EvaluatorConfig) -> int:
+        rt_mod = FakeModule(cost)
+        costs = run_evaluator_common(rt_mod, FakeDevice(), evaluator_config, [[], []])
+        assert len(costs) == rt_mod.num_calls
+        return rt_mod.num_calls
+
+    adaptive_config = EvaluatorConfig(repeat=1, adaptive_max_repeat=4, adaptive_margin=0.2)
+    # Without adaptivity, every set of arguments runs once
+    assert measure(5.0, EvaluatorConfig(repeat=1, reference_sec=1.0)) == 2
+    # Without a reference, a candidate runs the maximum number of repeats
+    assert measure(5.0, adaptive_config) == 8
+    # A clearly slower candidate stops after its first measurement
+    assert measure(5.0, adaptive_config._replace(reference_sec=1.0)) == 1
+    # A close contender gets the extra repeats
+    assert measure(1.1, adaptive_config._replace(reference_sec=1.0)) == 8
+
+    tracker = BestCostTracker()
+    key = BestCostTracker.workload_key("llvm", (("TENSOR", "float32", [1]),))
+    assert tracker.config_for(key, adaptive_config).reference_sec is None
+    tracker.update(key, [2.0, 4.0])
+    tracker.update(key, [5.0])
+    assert tracker.config_for(key, adaptive_config).reference_sec == 3.0
+    assert tracker.config_for(key, EvaluatorConfig()).reference_sec is None
+
+
 def test_meta_schedule_local_multiple_runs():
     """Test meta schedule local runner for multiple runs"""
     # Build the module
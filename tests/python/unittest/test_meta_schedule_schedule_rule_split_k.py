@@ -0,0 +1,89 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+# pylint: disable=missing-module-docstring,missing-function-docstring,missing-class-docstring
+
+from tvm.meta_schedule.space_generator.post_order_apply import PostOrderApply
+from tvm.meta_schedule.testing import te_workload
+from tvm.meta_schedule.testing.schedule_rule import split_k
+from tvm.meta_schedule.testing.space_generation import check_trace
+from tvm.meta_schedule.tune_context import TuneContext
+from tvm.target import Target
+from tvm.te.operation import create_prim_func
+
+
+def _create_context(mod, target, rule) -> TuneContext:
+    ctx = TuneContext(
+        mod=mod,
+        target=target,
+        space_generator=PostOrderApply(),
+        sch_rules=[rule],
+        task_name="test",
+    )
+    return ctx
+
+
+def test_gpu_skinny_matmul():
+    expected = [
+        [
+            'b0 = sch.get_block(name="C", func_name="main")',
+            "l1, l2, l3 = sch.get_loops(block=b0)",
+            "v4 = sch.sample_categorical(candidates=[2, 4, 8, 16], probs=[0.25, 0.25, 0.25, 0.25])",
+            "v5 = sch.sample_categorical(candidates=[32, 64, 128, 256], probs=[0.25, 0.25, 0.25, 0.25])",
+            "l6, l7 = sch.split(loop=l3, factors=[v4, None], preserve_unit_iters=True)",
+            "b8 = sch.rfactor(loop=l6, factor_axis=0)",
+            "l9, l10, l11, l12 = sch.get_loops(block=b8)",
+            "sch.reorder(l11, l9, l10)",
+            "l13 = sch.fuse(l9, l10, preserve_unit_iters=True)",
+            "l14, l15 = sch.split(loop=l13, factors=[None, v5], preserve_unit_iters=True)",
+            'sch.bind(loop=l14, thread_axis="blockIdx.x")',
+            'sch.bind(loop=l15, thread_axis="threadIdx.x")',
+            'sch.bind(loop=l11, thread_axis="blockIdx.y")',
+            "l16, l17, l18 = sch.get_loops(block=b0)",
+            "l19 = sch.fuse(l16, l17, preserve_unit_iters=True)",
+            "l20, l21 = sch.split(loop=l19, factors=[None, v5], preserve_unit_iters=True)",
+            'sch.bind(loop=l20, thread_axis="blockIdx.x")',
+            'sch.bind(loop=l21, thread_axis="threadIdx.x")',
+            'sch.annotate(block_or_loop=b0, ann_key="schedule_rule", ann_val="None")',
+        ],
+        [],
+    ]
+    target = Target("nvidia/geforce-rtx-3090", host="llvm")
+    ctx = _create_context(
+        create_prim_func(te_workload.matmul(n=4, m=4096, k=4096)),
+        target=target,
+        rule=split_k(target=target),
+    )
+    spaces = ctx.space_generator.generate_design_space(mod=ctx.mod)
+    assert len(spaces) == 2
+    check_trace(spaces, expected)
+
+
+def test_gpu_square_matmul():
+    target = Target("nvidia/geforce-rtx-3090", host="llvm")
+    ctx = _create_context(
+        create_prim_func(te_workload.matmul(n=512, m=512, k=512)),
+        target=target,
+        rule=split_k(target=target),
+    )
+    spaces = ctx.space_generator.generate_design_space(mod=ctx.mod)
+    assert len(spaces) == 1
+    check_trace(spaces, [[]])
+
+
+if __name__ == "__main__":
+    test_gpu_skinny_matmul()
+    test_gpu_square_matmul()
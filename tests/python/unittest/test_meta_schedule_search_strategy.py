@@ -183,6 +183,100 @@ def test_meta_schedule_evolutionary_search():  # pylint: disable = invalid-name
     assert num_trials_each_iter.count(0) < 5
 
 
+def test_meta_schedule_evolutionary_search_trace_cache():  # pylint: disable = invalid-name
+    sample_init_population = tvm.get_global_func(
+        "meta_schedule.SearchStrategyEvolutionarySearchSampleInitPopulation"
+    )
+    evolve_with_cost_model = tvm.get_global_func(
+        "meta_schedule.SearchStrategyEvolutionarySearchEvolveWithCostModel"
+    )
+    context = ms.TuneContext(
+        mod=Matmul,
+        space_generator=ms.space_generator.ScheduleFn(sch_fn=_schedule_matmul),
+        search_strategy=ms.search_strategy.EvolutionarySearch(
+            num_trials_per_iter=10,
+            max_trials_per_task=100,
+            population_size=16,
+            init_measured_ratio=0.0,
+            genetic_num_iters=3,
+            genetic_mutate_prob=1.0,
+            trace_cache_size=64,
+        ),
+        mutator_probs={
+            ms.mutator.MutateTileSize(): 1.0,
+        },
+        target=tvm.target.Target("llvm"),
+        num_threads=2,
+        rand_state=0,
+    )
+    strategy = context.search_strategy
+    strategy.pre_tuning(
+        context.space_generator.generate_design_space(context.mod),
+        database=ms.database.MemoryDatabase(),
+        cost_model=ms.cost_model.RandomModel(),
+    )
+    population = sample_init_population(strategy, 16)
+    evolved = evolve_with_cost_model(strategy, population, 16)
+    assert len(evolved) > 0
+    # The schedules resumed from the cached prefixes are those of replaying their traces
+    for sch in evolved:
+        replayed = Schedule(Matmul)
+        Trace(sch.trace.insts, sch.trace.decisions).apply_to_schedule(
+            replayed, remove_postproc=True
+        )
+        tvm.ir.assert_structural_equal(sch.mod, replayed.mod)
+    strategy.post_tuning()
+
+
+def test_meta_schedule_evolutionary_search_trace_cache_misses():  # pylint: disable = invalid-name
+    sample_init_population = tvm.get_global_func(
+        "meta_schedule.SearchStrategyEvolutionarySearchSampleInitPopulation"
+    )
+    evolve_with_cost_model = tvm.get_global_func(
+        "meta_schedule.SearchStrategyEvolutionarySearchEvolveWithCostModel"
+    )
+    # A single snapshot makes most replays start from scratch, i.e. from a copy of the
+    # schedule of the module shared by the replays of a thread.
+    context = ms.TuneContext(
+        mod=Matmul,
+        space_generator=ms.space_generator.ScheduleFn(sch_fn=_schedule_matmul),
+        search_strategy=ms.search_strategy.EvolutionarySearch(
+            num_trials_per_iter=10,
+            max_trials_per_task=100,
+            population_size=16,
+            init_measured_ratio=0.0,
+            genetic_num_iters=3,
+            genetic_mutate_prob=1.0,
+            trace_cache_size=1,
+        ),
+        mutator_probs={
+            ms.mutator.MutateTileSize(): 1.0,
+        },
+        target=tvm.target.Target("llvm"),
+        num_threads=2,
+        rand_state=0,
+    )
+    strategy = context.search_strategy
+    strategy.pre_tuning(
+        context.space_generator.generate_design_space(context.mod),
+        database=ms.database.MemoryDatabase(),
+        cost_model=ms.cost_model.RandomModel(),
+    )
+    population = sample_init_population(strategy, 16)
+    evolved = list(evolve_with_cost_model(strategy, population, 16))
+    assert len(evolved) > 0
+    # Each schedule is that of replaying its own trace, the replays do not leak into each other
+    for sch in evolved + list(population):
+        replayed = Schedule(Matmul)
+        Trace(sch.trace.insts, sch.trace.decisions).apply_to_schedule(
+            replayed, remove_postproc=True
+        )
+        tvm.ir.assert_structural_equal(sch.mod, replayed.mod)
+    # The module is left as it was by the replays
+    tvm.ir.assert_structural_equal(context.mod, Matmul)
+    strategy.post_tuning()
+
+
 def test_meta_schedule_evolutionary_search_early_stop():  # pylint: disable = invalid-name
     def _schedule_matmul_empty(sch: Schedule):
         return sch
@@ -395,5 +395,47 @@ def test_meta_schedule_task_scheduler_multiple_gradient_based():
         )
 
 
+def test_meta_schedule_task_scheduler_gradient_based_inflight_tasks():
+    num_trials_per_iter = 6
+    max_trials_per_task = 31
+    tasks = [
+        ms.TuneContext(
+            mod,
+            target=tvm.target.Target("llvm"),
+            space_generator=ms.space_generator.ScheduleFn(sch_fn=sch_fn),
+            search_strategy=ms.search_strategy.ReplayTrace(
+                num_trials_per_iter,
+                max_trials_per_task,
+            ),
+            task_name=name,
+            rand_state=seed,
+        )
+        for mod, sch_fn, name, seed in [
+            (MatmulModule, _schedule_matmul, "Matmul", 42),
+            (MatmulReluModule, _schedule_matmul, "MatmulRelu", 0xDEADBEEF),
+            (BatchMatmulModule, _schedule_batch_matmul, "BatchMatmul", 0x114514),
+        ]
+    ]
+    database = ms.database.MemoryDatabase()
+    gradient_based = ms.task_scheduler.GradientBased(
+        tasks,
+        task_weights=[1.0, 1.0, 1.0],
+        builder=DummyBuilder(),
+        runner=DummyRunner(),
+        database=database,
+        measure_callbacks=[ms.measure_callback.AddToDatabase()],
+        seed=0x20220214,
+        max_trials=max_trials_per_task * len(tasks),
+        num_inflight_tasks=2,
+    )
+    gradient_based.tune()
+    assert len(database) == max_trials_per_task * len(tasks)
+    for task in tasks:
+        assert (
+            len(database.get_top_k(database.commit_workload(task.mod), 10000))
+            == max_trials_per_task
+        )
+
+
 if __name__ == "__main__":
     tvm.testing.main()
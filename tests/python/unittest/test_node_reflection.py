@@ -19,6 +19,7 @@ import tvm.testing
 import sys
 import pytest
 from tvm import te
+from tvm.contrib import utils
 import numpy as np
 
 
@@ -195,5 +196,28 @@ def test_alloc_const():
     np.testing.assert_array_equal(np_data, alloc_const2.data.numpy())
 
 
+def test_saveload_binary():
+    dev = tvm.cpu(0)
+    x = te.var("x")
+    arrays = [
+        tvm.nd.array(np.random.rand(*shape).astype("float32"), dev) for shape in [(3,), (5, 7)]
+    ]
+    node = {"expr": x + tvm.tir.const(1.5) * x, "arrays": arrays, "name": "node"}
+    node2 = tvm.ir.load_binary(tvm.ir.save_binary(node))
+    tvm.ir.assert_structural_equal(node, node2, map_free_vars=True)
+    assert len(tvm.ir.save_binary(node)) < len(tvm.ir.save_json(node))
+
+    temp = utils.tempdir()
+    path = temp.relpath("node.bin")
+    tvm.ir.save_binary_file(node, path)
+    for use_mmap in [True, False]:
+        node3 = tvm.ir.load_binary_file(path, use_mmap=use_mmap)
+        tvm.ir.assert_structural_equal(node, node3, map_free_vars=True)
+        for arr, arr3 in zip(node["arrays"], node3["arrays"]):
+            np.testing.assert_array_equal(arr.numpy(), arr3.numpy())
+            # the payloads are aligned, so that the mapped arrays are usable in place
+            assert arr3.handle.contents.data % 64 == 0
+
+
 if __name__ == "__main__":
     tvm.testing.main()
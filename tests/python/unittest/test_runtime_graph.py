@@ -138,6 +138,36 @@ def test_load_unexpected_params():
     rt_mod.load_params(runtime.save_param_dict(new_params))
 
 
+@tvm.testing.requires_llvm
+def test_share_storage():
+    def build_variant(batch):
+        x = relay.var("x", shape=(batch, 10))
+        w = relay.var("w", shape=(1, 10))
+        y = relay.nn.relu(relay.exp(relay.add(x, w)) - relay.const(2.0))
+        func = relay.Function([x, w], y)
+        # Without fusion, the graph has intermediate tensors to share.
+        with tvm.transform.PassContext(opt_level=0):
+            return relay.build(func, target="llvm", params={"w": np.ones((1, 10), "float32")})
+
+    variants = []
+    for batch in [1, 4, 2]:
+        graph, lib, params = build_variant(batch)
+        mod = graph_executor.create(graph, lib, tvm.cpu(0))
+        mod.load_params(runtime.save_param_dict(params))
+        variants.append((batch, mod, params))
+    for _, mod, params in variants[1:]:
+        mod.share_storage(variants[0][1])
+        mod.share_params(variants[0][1], runtime.save_param_dict(params))
+
+    for _ in range(2):
+        for batch, mod, _ in variants:
+            a = np.random.uniform(size=(batch, 10)).astype("float32")
+            mod.run(x=a)
+            out = mod.get_output(0).numpy()
+            tvm.testing.assert_allclose(out, np.maximum(np.exp(a + 1) - 2, 0), rtol=1e-5)
+
+
 if __name__ == "__main__":
     test_graph_simple()
     test_load_unexpected_params()
+    test_share_storage()
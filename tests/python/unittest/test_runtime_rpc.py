@@ -176,6 +176,18 @@ def test_rpc_large_array():
     check_remote()
 
 
+@tvm.testing.requires_rpc
+def test_rpc_zero_copy_upload():
+    # the uploads from 64KB on are sent from the array memory without a staging copy
+    server = rpc.Server()
+    remote = rpc.connect("127.0.0.1", server.port)
+    dev = remote.cpu(0)
+    for num_elems in [16 * 1024 - 1, 16 * 1024, 16 * 1024 + 3, 1 << 22]:
+        x_np = np.random.uniform(size=num_elems).astype("float32")
+        x = tvm.nd.array(x_np, dev)
+        np.testing.assert_equal(x.numpy(), x_np)
+
+
 @tvm.testing.requires_rpc
 def test_rpc_echo():
     def check(remote):
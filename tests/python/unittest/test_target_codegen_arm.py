@@ -98,6 +98,27 @@ def test_vmlal_s16():
     check_broadcast_correct_assembly(64)
 
 
+def test_scalable_vectorize():
+    if tvm.target.codegen.llvm_version_major() < 13:
+        return
+    target = "llvm -mtriple=aarch64-linux-gnu -mattr=+sve"
+    n = te.var("n")
+    A = te.placeholder((n,), name="A")
+    B = te.placeholder((n,), name="B")
+    C = te.compute((n,), lambda i: A[i] + B[i], name="C")
+    s = te.create_schedule(C.op)
+    s[C].vectorize(C.op.axis[0])
+
+    # The vectorizer sees the target of the current scope.
+    with tvm.target.Target(target):
+        mod = tvm.lower(s, [A, B, C], name="main")
+        assert "pragma_scalable_vectorize" in mod.script()
+        f = tvm.build(s, [A, B, C], target)
+    # The loop is vectorized by LLVM with vectors scaled by the runtime vector length.
+    assert "vscale" in f.get_source("ll")
+
+
 if __name__ == "__main__":
     test_popcount()
     test_vmlal_s16()
+    test_scalable_vectorize()
@@ -978,5 +978,59 @@ def test_llvm_target_attributes():
         assert n in functions_with_target
 
 
+@tvm.testing.requires_llvm
+def test_llvm_partitioned_codegen():
+    n = 16
+    A = te.placeholder((n,), name="A")
+    funcs = {}
+    for i in range(8):
+        B = te.compute((n,), lambda j: A[j] + float(i), name="B")
+        s = te.create_schedule(B.op)
+        funcs["add_%d" % i] = tvm.lower(s, [A, B], name="add_%d" % i)["add_%d" % i]
+    mod = tvm.IRModule(funcs)
+    with tvm.transform.PassContext(config={"codegen.llvm.num_partitions": 3}):
+        lib = tvm.build(mod, target="llvm")
+    dev = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+    b = tvm.nd.empty((n,), A.dtype, dev)
+    for i in range(8):
+        lib["add_%d" % i](a, b)
+        tvm.testing.assert_allclose(b.numpy(), a.numpy() + i)
+    # the partitions are linked into one module, which exports as one object
+    temp = utils.tempdir()
+    lib.export_library(temp.relpath("lib.so"))
+    loaded = tvm.runtime.load_module(temp.relpath("lib.so"))
+    loaded["add_7"](a, b)
+    tvm.testing.assert_allclose(b.numpy(), a.numpy() + 7)
+
+
+@tvm.testing.requires_llvm
+@pytest.mark.skipif(not sys.platform.startswith("linux"), reason="the table is emitted on Linux")
+@pytest.mark.parametrize("num_partitions", [1, 3])
+def test_llvm_func_registry(num_partitions):
+    n = 16
+    A = te.placeholder((n,), name="A")
+    funcs = {}
+    for i in range(8):
+        B = te.compute((n,), lambda j: A[j] + float(i), name="B")
+        s = te.create_schedule(B.op)
+        funcs["add_%d" % i] = tvm.lower(s, [A, B], name="add_%d" % i)["add_%d" % i]
+    with tvm.transform.PassContext(config={"codegen.llvm.num_partitions": num_partitions}):
+        lib = tvm.build(tvm.IRModule(funcs), target="llvm")
+    temp = utils.tempdir()
+    lib.export_library(temp.relpath("lib.so"))
+    # The library exports the table of its functions, which the loaded module resolves them by.
+    assert hasattr(ctypes.CDLL(temp.relpath("lib.so")), "__tvm_func_registry")
+    loaded = tvm.runtime.load_module(temp.relpath("lib.so"))
+    dev = tvm.cpu(0)
+    a = tvm.nd.array(np.random.uniform(size=n).astype(A.dtype), dev)
+    b = tvm.nd.empty((n,), A.dtype, dev)
+    for i in range(8):
+        loaded["add_%d" % i](a, b)
+        tvm.testing.assert_allclose(b.numpy(), a.numpy() + i)
+    with pytest.raises(AttributeError):
+        loaded.get_function("missing")
+
+
 if __name__ == "__main__":
     tvm.testing.main()
@@ -63,5 +63,38 @@ def test_fp16_to_fp32():
     fp16_to_fp32("llvm", 9, not_match="vcvtph2ps")
 
 
+def test_amx_tile_config():
+    if tvm.target.codegen.llvm_version_major() < 12:
+        return
+    from tvm.tir.tensor_intrin.x86 import AMX_DOT_16x16x64_INT8_INTRIN
+
+    A = te.placeholder((32, 64), dtype="uint8", name="A")
+    B = te.placeholder((16, 32, 4), dtype="int8", name="B")
+    k = te.reduce_axis((0, 64), name="k")
+    C = te.compute(
+        (32, 32),
+        lambda i, j: te.sum(
+            A[i, k].astype("int32") * B[k // 4, j, k % 4].astype("int32"),
+            axis=k,
+        ),
+        name="C",
+    )
+    sch = tvm.tir.Schedule(te.create_prim_func([A, B, C]))
+    block = sch.get_block("C")
+    i, j, _ = sch.get_loops(block)
+    io, ii = sch.split(i, factors=[None, 16])
+    jo, ji = sch.split(j, factors=[None, 16])
+    sch.reorder(io, jo, ii, ji)
+    sch.decompose_reduction(block, ii)
+    sch.tensorize(ii, AMX_DOT_16x16x64_INT8_INTRIN)
+    f = tvm.build(sch.mod, target="llvm -mcpu=sapphirerapids")
+
+    # The tiles are configured once at the entry of the function.
+    assembly = f.get_source("asm")
+    assert len(re.findall("ldtilecfg", assembly)) == 1
+    assert "tdpbusd" in assembly
+
+
 if __name__ == "__main__":
     test_fp16_to_fp32()
+    test_amx_tile_config()
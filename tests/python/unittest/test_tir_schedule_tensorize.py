@@ -24,6 +24,7 @@ from tvm.script import tir as T
 from tvm.tir.schedule.testing import verify_trace_roundtrip
 from tvm.tir.tensor_intrin import (
     VNNI_DOT_16x4_INTRIN,
+    AMX_DOT_16x16x64_INT8_INTRIN,
     ARM_DOT_4x4_i8_NEON_INTRIN,
     ARM_DOT_4x4_i8_SDOT_INTRIN,
     AMDGPU_SDOT4_INTRIN,
@@ -577,6 +578,37 @@ def test_tensorize_vnni():
     verify_trace_roundtrip(sch=sch, mod=func)
 
 
+def test_tensorize_amx():
+    m, n, k = 128, 128, 128
+
+    X = te.placeholder((m, k), name="X", dtype="uint8")
+    packed_W = te.placeholder((k // 4, n, 4), name="packedW", dtype="int8")
+    ak = te.reduce_axis((0, k), name="k")
+    matmul = te.compute(
+        (m, n),
+        lambda i, j: te.sum(
+            X[i, ak].astype("int32") * packed_W[ak // 4, j, ak % 4].astype("int32"),
+            axis=ak,
+        ),
+        name="compute",
+    )
+    func = te.create_prim_func([X, packed_W, matmul])
+
+    sch = tir.Schedule(func, debug_mask="all")
+    block = sch.get_block("compute")
+    i, j, k = sch.get_loops(block)
+
+    io, ii = sch.split(i, factors=[None, 16])
+    jo, ji = sch.split(j, factors=[None, 16])
+    ko, ki = sch.split(k, factors=[None, 64])
+    sch.reorder(io, jo, ko, ii, ji, ki)
+
+    sch.decompose_reduction(block, ko)
+    sch.tensorize(ii, AMX_DOT_16x16x64_INT8_INTRIN)
+
+    verify_trace_roundtrip(sch=sch, mod=func)
+
+
 def test_tensorize_arm_dot():
     m, n, k = 128, 128, 128
 
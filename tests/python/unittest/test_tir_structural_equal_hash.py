@@ -208,6 +208,34 @@ def test_while():
     assert consistent_equal(wx, wy, map_free_vars=True)
 
 
+def test_cached_hash():
+    x = tvm.tir.Var("x", "int32")
+    y = tvm.tir.Var("y", "int32")
+    wx = tvm.tir.While(x > 0, tvm.tir.Evaluate(x))
+    wy = tvm.tir.While(y > 0, tvm.tir.Evaluate(y))
+    for map_free_vars in [False, True]:
+        expected = tvm.ir.structural_hash(wx, map_free_vars)
+        assert tvm.ir.structural_hash(wx, map_free_vars, cached=True) == expected
+        # A second query is served from the cache.
+        assert tvm.ir.structural_hash(wx, map_free_vars, cached=True) == expected
+    assert tvm.ir.structural_hash(wy, True, cached=True) == tvm.ir.structural_hash(wx, True)
+    tvm.runtime._ffi_node_api.StructuralHashCacheClear()
+    assert tvm.ir.structural_hash(wx, cached=True) == tvm.ir.structural_hash(wx)
+
+
+def test_cached_equal():
+    x = tvm.tir.Var("x", "int32")
+    y = tvm.tir.Var("y", "int32")
+    wx = tvm.tir.While(x > 0, tvm.tir.Evaluate(x))
+    wy = tvm.tir.While(y > 0, tvm.tir.Evaluate(y))
+    wz = tvm.tir.While(x > 1, tvm.tir.Evaluate(x))
+    for lhs, rhs in [(wx, wx), (wx, wy), (wx, wz), (wx, x)]:
+        for map_free_vars in [False, True]:
+            expected = tvm.ir.structural_equal(lhs, rhs, map_free_vars)
+            assert tvm.ir.structural_equal(lhs, rhs, map_free_vars, cached=True) == expected
+
+
+
 if __name__ == "__main__":
     test_exprs()
     test_prim_func()
@@ -218,3 +246,5 @@ if __name__ == "__main__":
     test_buffer_storage_scope()
     test_buffer_load_store()
     test_while()
+    test_cached_hash()
+    test_cached_equal()
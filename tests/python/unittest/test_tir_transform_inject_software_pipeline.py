@@ -1034,6 +1034,58 @@ def test_error_missing_annotation():
     _check_error(simple_compute_missing_annotation)
 
 
+@T.prim_func
+def simple_async_copy(A: T.Buffer[(16, 16), "float32"], C: T.Buffer[(16, 16), "float32"]):
+    for tx in T.thread_binding(0, 16, thread="threadIdx.x"):
+        for i in T.serial(
+            0,
+            16,
+            annotations={
+                "software_pipeline_stage": [0, 1],
+                "software_pipeline_order": [0, 1],
+                "software_pipeline_async_stages": [0],
+            },
+        ):
+            with T.block():
+                T.reads(A[tx, i])
+                T.writes(C[tx, i])
+                B = T.alloc_buffer((16, 1), dtype="float32", scope="shared")
+                with T.block():
+                    T.reads(A[tx, i])
+                    T.writes(B[tx, 0])
+                    B[tx, 0] = A[tx, i]
+                with T.block():
+                    T.reads(B[tx, 0])
+                    T.writes(C[tx, i])
+                    C[tx, i] = B[tx, 0] + T.float32(1)
+
+
+def test_async_stages():
+    mod = tvm.IRModule.from_expr(simple_async_copy)
+    mod = tvm.tir.transform.InjectSoftwarePipeline()(mod)
+    calls = []
+    num_async_scopes = [0]
+
+    def _visit(node):
+        if isinstance(node, tir.Call) and node.op.name in [
+            "tir.ptx_commit_group",
+            "tir.ptx_wait_group",
+        ]:
+            calls.append(node)
+        if isinstance(node, tir.AttrStmt) and node.attr_key == "async_scope":
+            num_async_scopes[0] += 1
+
+    tvm.tir.stmt_functor.post_order_visit(mod["main"].body, _visit)
+    # The prologue and the body copy asynchronously, the epilogue only consumes the copies.
+    assert num_async_scopes[0] == 2
+    # Each of the prologue, the body and the epilogue commits a group, and the consumers wait for
+    # the copies of the previous iteration, leaving the group of the current iteration in flight.
+    commits = [c for c in calls if c.op.name == "tir.ptx_commit_group"]
+    waits = [c for c in calls if c.op.name == "tir.ptx_wait_group"]
+    assert len(commits) == 3
+    assert [int(w.args[0]) for w in waits] == [1, 1]
+
+
 @tvm.testing.requires_cuda
 def test_three_stage_gemm():
     N = K = M = 4096
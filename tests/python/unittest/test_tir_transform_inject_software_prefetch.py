@@ -0,0 +1,67 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+import numpy as np
+import tvm
+import tvm.testing
+from tvm import te, tir, topi
+
+
+def _embedding_bag(num_bags, bag_size, prefetch_distance=None):
+    weight = te.placeholder((1000, 16), name="weight")
+    indices = te.placeholder((num_bags, bag_size), dtype="int64", name="indices")
+    out = topi.nn.embedding_bag(weight, indices)
+    sch = tir.Schedule(te.create_prim_func([weight, indices, out]))
+    b, d, l = sch.get_loops(sch.get_block("embedding_bag"))
+    b_o, b_i = sch.split(b, [None, 4])
+    sch.reorder(b_o, b_i, l, d)
+    sch.parallel(b_o)
+    sch.vectorize(d)
+    if prefetch_distance is not None:
+        sch.annotate(l, "software_prefetch_distance", prefetch_distance)
+    return sch.mod
+
+
+def _prefetches(mod):
+    calls = []
+
+    def fvisit(node):
+        if isinstance(node, tir.Call) and node.op.same_as(tvm.ir.Op.get("tir.prefetch")):
+            calls.append(node)
+
+    tir.stmt_functor.post_order_visit(tvm.lower(mod)["main"].body, fvisit)
+    return calls
+
+
+def test_prefetch_indirect_rows():
+    assert len(_prefetches(_embedding_bag(10, 8, prefetch_distance=2))) == 1
+    assert not _prefetches(_embedding_bag(10, 8))
+
+
+@tvm.testing.requires_llvm
+def test_prefetch_numerics():
+    # the bags are not a multiple of the batches of rows, so the prefetch is predicated
+    mod = _embedding_bag(10, 8, prefetch_distance=4)
+    func = tvm.build(mod, target="llvm")
+    weight = np.random.rand(1000, 16).astype("float32")
+    indices = np.random.randint(0, 1000, size=(10, 8)).astype("int64")
+    out = tvm.nd.empty((10, 16), "float32")
+    func(tvm.nd.array(weight), tvm.nd.array(indices), out)
+    tvm.testing.assert_allclose(out.numpy(), weight[indices].sum(axis=1), rtol=1e-5)
+
+
+if __name__ == "__main__":
+    tvm.testing.main()
@@ -14,6 +14,7 @@
 # KIND, either express or implied.  See the License for the
 # specific language governing permissions and limitations
 # under the License.
+import numpy as np
 import tvm
 from tvm import te
 
@@ -226,6 +227,55 @@ def test_vectorize_dtype_mismatch():
     tvm.lower(s, [A], "llvm", simple_mode=True)
 
 
+def test_vectorize_symbolic_extent():
+    n = te.var("n")
+    ib = tvm.tir.ir_builder.create()
+    A = ib.pointer("float32", name="A")
+    B = ib.pointer("float32", name="B")
+    with ib.for_range(0, n, kind="vectorize") as i:
+        B[i] = A[i] + tvm.tir.const(1, "float32")
+    mod = tvm.IRModule.from_expr(tvm.tir.PrimFunc([A, B, n], ib.get()))
+
+    with tvm.transform.PassContext(config={"tir.vectorize_symbolic_lanes": 8}):
+        stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+    assert isinstance(stmt, tvm.tir.SeqStmt)
+    main, tail = stmt
+    assert main.kind == tvm.tir.ForKind.SERIAL
+    assert isinstance(main.body.value, tvm.tir.Add)
+    assert main.body.value.dtype == "float32x8"
+    assert tail.kind == tvm.tir.ForKind.SERIAL
+    assert tail.body.value.dtype == "float32"
+
+    # By default the widest element accessed is fitted into a 128-bit vector.
+    stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+    assert stmt[0].body.value.dtype == "float32x4"
+
+
+def test_vectorize_symbolic_extent_build():
+    n = te.size_var("n")
+    A = te.placeholder((n,), name="A", dtype="float32")
+    B = te.compute((n,), lambda i: A[i] + 1, name="B")
+    s = te.create_schedule(B.op)
+    s[B].vectorize(B.op.axis[0])
+    with tvm.transform.PassContext(config={"tir.vectorize_symbolic_lanes": 8}):
+        f = tvm.build(s, [A, B], "llvm")
+
+    dev = tvm.cpu()
+    # the extents cover an empty vector loop, an empty tail, and both of them
+    for extent in [3, 8, 13, 16]:
+        a = tvm.nd.array(np.random.rand(extent).astype("float32"), dev)
+        b = tvm.nd.empty((extent,), "float32", dev)
+        f(a, b)
+        np.testing.assert_allclose(b.numpy(), a.numpy() + 1, rtol=1e-6)
+
+    # The targets with scalable vectors leave the loop to the vector-length-agnostic backend.
+    with tvm.target.Target("llvm -mtriple=aarch64-linux-gnu -mattr=+sve"):
+        stmt = tvm.tir.transform.VectorizeLoop()(mod)["main"].body
+    assert isinstance(stmt, tvm.tir.AttrStmt)
+    assert stmt.attr_key == "pragma_scalable_vectorize"
+    assert stmt.body.kind == tvm.tir.ForKind.SERIAL
+
+
 if __name__ == "__main__":
     test_vectorize_vector()
     test_vectorize_with_if()
@@ -236,3 +286,5 @@ if __name__ == "__main__":
     test_vectorize_let()
     test_vectorize_while_fail()
     test_vectorize_dtype_mismatch()
+    test_vectorize_symbolic_extent()
+    test_vectorize_symbolic_extent_build()
@@ -30,6 +30,7 @@
 
 #include <tvm/runtime/c_runtime_api.h>
 #include <tvm/runtime/logging.h>
+#include <tvm/runtime/threading_backend.h>
 
 #include "src/runtime/c_runtime_api.cc"
 #include "src/runtime/contrib/sort/sort.cc"
@@ -43,6 +44,15 @@
 #include "src/runtime/object.cc"
 #include "src/runtime/profiling.cc"
 #include "src/runtime/registry.cc"
+#include "src/runtime/relax_vm/builtin.cc"
+#include "src/runtime/relax_vm/bytecode.cc"
+#include "src/runtime/relax_vm/constant_store.cc"
+#include "src/runtime/relax_vm/executable.cc"
+#include "src/runtime/relax_vm/kernel_jit.cc"
+#include "src/runtime/relax_vm/latency_histogram.cc"
+#include "src/runtime/relax_vm/memory_manager.cc"
+#include "src/runtime/relax_vm/trace_sink.cc"
+#include "src/runtime/relax_vm/vm.cc"
 #include "src/runtime/rpc/rpc_channel.cc"
 #include "src/runtime/rpc/rpc_endpoint.cc"
 #include "src/runtime/rpc/rpc_event_impl.cc"
@@ -63,6 +73,21 @@ int TVMBackendParallelLaunch(FTVMParallelLambda flambda, void* cdata, int num_ta
 
 int TVMBackendParallelBarrier(int task_id, TVMParallelGroupEnv* penv) { return 0; }
 
+// The wasm runtime runs on a single thread, without the thread pool used by the Relax VM.
+namespace tvm {
+namespace runtime {
+namespace threading {
+void BeginPersistentRegion() {}
+
+void EndPersistentRegion() {}
+
+void ConfigurePersistentRegion(uint32_t spin_count) {}
+
+int32_t NumThreads() { return 1; }
+}  // namespace threading
+}  // namespace runtime
+}  // namespace tvm
+
 // --- Environment PackedFuncs for testing ---
 namespace tvm {
 namespace runtime {
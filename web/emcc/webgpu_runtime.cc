@@ -105,28 +105,21 @@ class WebGPUDeviceAPI : public DeviceAPI {
   }
 
  public:
-  TVMStreamHandle CreateStream(Device dev) final {
-    LOG(FATAL) << "Not implemented";
-    return nullptr;
-  }
+  // All the work is submitted to the default queue of the device, which runs in order, so the
+  // streams are the default queue and need no synchronization among them.
+  TVMStreamHandle CreateStream(Device dev) final { return nullptr; }
 
-  void FreeStream(Device dev, TVMStreamHandle stream) final {
-    LOG(FATAL) << "Not implemented";
-    return;
-  }
+  void FreeStream(Device dev, TVMStreamHandle stream) final {}
 
-  void SyncStreamFromTo(Device dev, TVMStreamHandle event_src, TVMStreamHandle event_dst) {
-    LOG(FATAL) << "Not implemented";
-    return;
-  }
-
-  void StreamSync(Device dev, TVMStreamHandle stream) final { LOG(FATAL) << "Not implemented"; }
+  void SyncStreamFromTo(Device dev, TVMStreamHandle event_src, TVMStreamHandle event_dst) {}
 
-  void SetStream(Device dev, TVMStreamHandle stream) final {
-    LOG(FATAL) << "Not implemented";
-    return;
+  void StreamSync(Device dev, TVMStreamHandle stream) final {
+    // Waiting for the queue would block the JS event loop, the JS side awaits DLDevice.sync.
+    LOG(FATAL) << "WebGPU can only be synchronized asynchronously with DLDevice.sync in JS";
   }
 
+  void SetStream(Device dev, TVMStreamHandle stream) final {}
+
   void* AllocWorkspace(Device dev, size_t size, DLDataType type_hint) final {
     return WebGPUThreadEntry::ThreadLocal()->pool.AllocWorkspace(dev, size);
   }
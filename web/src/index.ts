@@ -19,7 +19,7 @@
 
 export {
   Scalar, DLDevice, DLDataType,
-  PackedFunc, Module, NDArray, Instance,
+  PackedFunc, Module, NDArray, Instance, VirtualMachine,
   instantiate
 } from "./runtime";
 export { Disposable, LibraryProvider } from "./types";
@@ -670,6 +670,47 @@ class GraphExecutor implements Disposable {
   }
 }
 
+/**
+ *  Relax virtual machine.
+ *
+ *  The functions of the VM submit the kernels to the device without waiting for them,
+ *  await {@link sync} before reading the results on WebGPU.
+ */
+export class VirtualMachine implements Disposable {
+  module: Module;
+  private dev: DLDevice;
+
+  /**
+   * Constructor
+   * @param module The underlying VM module.
+   * @param dev The execution device of the VM.
+   */
+  constructor(module: Module, dev: DLDevice) {
+    this.module = module;
+    this.dev = dev;
+  }
+
+  dispose(): void {
+    this.module.dispose();
+  }
+
+  /**
+   * Get a function of the VM.
+   * @param name The name of the function.
+   * @returns The result function.
+   */
+  getFunction(name: string): PackedFunc {
+    return this.module.getFunction(name);
+  }
+
+  /**
+   * Wait for the kernels submitted by the VM functions to complete.
+   */
+  async sync(): Promise<void> {
+    await this.dev.sync();
+  }
+}
+
 /** Code used as the first argument of the async callback. */
 const enum AyncCallbackCode {
   kReturn = 4,
@@ -1001,6 +1042,38 @@ export class Instance implements Disposable {
     return new GraphExecutor(module);
   }
 
+  /**
+   * Create a new Relax virtual machine.
+   *
+   * @param dev The execution device of the VM, which uses the CPU as the host device.
+   * @param exec The Relax executable, the system library by default, from which the
+   *        executable exported as a system library is loaded.
+   */
+  createVirtualMachine(dev: DLDevice, exec: Module | undefined = undefined): VirtualMachine {
+    // The allocator type of all the devices, the pooled allocator.
+    const allocType = this.scalar(2, "int32");
+    const vmExec = exec === undefined ? this.systemLib() : exec;
+    const fload = vmExec.getFunction("vm_load_executable");
+    const module = fload() as Module;
+    fload.dispose();
+    const finit = module.getFunction("vm_initialization");
+    const cpu = this.cpu();
+    if (dev.deviceType == cpu.deviceType) {
+      finit(this.scalar(dev.deviceType, "int32"), this.scalar(dev.deviceId, "int32"), allocType);
+    } else {
+      finit(
+        this.scalar(dev.deviceType, "int32"),
+        this.scalar(dev.deviceId, "int32"),
+        allocType,
+        this.scalar(cpu.deviceType, "int32"),
+        this.scalar(cpu.deviceId, "int32"),
+        allocType
+      );
+    }
+    finit.dispose();
+    return new VirtualMachine(module, dev);
+  }
+
 
   /**
    * Register an asyncfunction to be global function in the server.
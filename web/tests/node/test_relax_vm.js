@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+/* eslint-disable no-undef */
+const path = require("path");
+const fs = require("fs");
+const assert = require("assert");
+const tvmjs = require("../../dist");
+
+const wasmPath = tvmjs.wasmPath();
+const EmccWASI = require(path.join(wasmPath, "tvmjs_runtime.wasi.js"));
+const wasmSource = fs.readFileSync(path.join(wasmPath, "test_relax.wasm"));
+
+const tvm = new tvmjs.Instance(
+  new WebAssembly.Module(wasmSource),
+  new EmccWASI()
+);
+
+function randomArray(length, max) {
+  return Array.apply(null, Array(length)).map(function () {
+    return Math.random() * max;
+  });
+}
+
+test("relax vm add", () => {
+  // load the executable from the system library
+  const vm = tvm.createVirtualMachine(tvm.cpu());
+  const fmain = vm.getFunction("main");
+  assert(tvm.isPackedFunc(fmain));
+  const n = 4;
+  const A = tvm.empty(n).copyFrom(randomArray(n, 1));
+  const B = tvm.empty(n).copyFrom(randomArray(n, 1));
+  // the VM allocates the output and keeps the kernels alive across calls
+  for (let round = 0; round < 2; ++round) {
+    const C = fmain(A, B);
+    const AA = A.toArray();
+    const BB = B.toArray();
+    const CC = C.toArray();
+    for (let i = 0; i < n; ++i) {
+      assert(Math.abs(CC[i] - (AA[i] + BB[i] + 1)) < 1e-5);
+    }
+    C.dispose();
+  }
+  fmain.dispose();
+  vm.dispose();
+});
@@ -17,7 +17,7 @@
 # Prepare test library for standalone wasm runtime test.
 
 import tvm
-from tvm import te
+from tvm import relax, te, topi
 from tvm.contrib import emcc
 from tvm.relay.backend import Runtime
 import os
@@ -38,6 +38,24 @@ def prepare_test_libs(base_path):
     fadd.export_library(wasm_path, emcc.create_tvmjs_wasm)
 
 
+def prepare_relax_lib(base_path):
+    target = tvm.target.Target("llvm -mtriple=wasm32-unknown-unknown-wasm -system-lib")
+    if not tvm.runtime.enabled(target.kind.name):
+        raise RuntimeError("Target %s is not enbaled" % target)
+    bb = relax.BlockBuilder()
+    x = relax.Var("x", [4], relax.DynTensorType(1, "float32"))
+    y = relax.Var("y", [4], relax.DynTensorType(1, "float32"))
+    with bb.function("main", [x, y]):
+        lv0 = bb.emit_te(topi.add, x, y)
+        gv = bb.emit_te(topi.add, lv0, relax.const(1, "float32"))
+        bb.emit_func_output(gv)
+    ex = relax.vm.build(bb.get(), target)
+
+    wasm_path = os.path.join(base_path, "test_relax.wasm")
+    ex.mod.export_library(wasm_path, emcc.create_tvmjs_wasm)
+
+
 if __name__ == "__main__":
     curr_path = os.path.dirname(os.path.abspath(os.path.expanduser(__file__)))
     prepare_test_libs(os.path.join(curr_path, "../../dist/wasm"))
+    prepare_relax_lib(os.path.join(curr_path, "../../dist/wasm"))